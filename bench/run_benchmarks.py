@@ -0,0 +1,310 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# graph_tool -- a general graph manipulation python module
+#
+# Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Reproducible throughput benchmarks of the core C++ kernels.
+
+The graphs are taken from :mod:`graph_tool.collection`, and from synthetic
+SBM and Price networks of configurable size. Every kernel is timed a number of
+times with every requested number of OpenMP threads (sequential kernels are
+only run with one thread), and the results are written as JSON, e.g.::
+
+    python bench/run_benchmarks.py --graphs karate power sbm:100000 \\
+        --threads 1 2 4 8 --output bench.json
+
+The random number generators are seeded, so that the synthetic graphs, the
+sampled sources and pivots, and the initial partitions are the same across
+runs with the same parameters. Use ``--list`` to see the available kernels.
+"""
+
+from __future__ import division, absolute_import, print_function
+
+import sys
+import io
+import json
+import time
+import argparse
+import platform
+import datetime
+import multiprocessing
+
+import numpy
+
+import graph_tool.all as gt
+
+if sys.version_info < (3,):
+    range = xrange
+    clock = time.time
+else:
+    clock = time.perf_counter
+
+
+def get_graph(name, seed):
+    """Return the graph with the given name, which is either a dataset of the
+    collection, or "sbm:N" / "price:N" for a synthetic graph with N
+    vertices."""
+    if ":" not in name:
+        return gt.collection.data[name]
+    kind, N = name.split(":")
+    N = int(N)
+    gt.seed_rng(seed)
+    numpy.random.seed(seed)
+    if kind == "price":
+        return gt.price_network(N, m=4, directed=False)
+    if kind == "sbm":
+        # assortative SBM with average degree 10, and groups of ~1000 vertices
+        B = max(N // 1000, 1)
+        b = numpy.random.randint(0, B, N)
+        E = 5 * N
+        probs = numpy.ones((B, B)) * (.2 * 2 * E) / (B * B)
+        probs += numpy.eye(B) * (.8 * 2 * E) / B
+        g = gt.generate_sbm(b, probs, directed=False)
+        gt.remove_parallel_edges(g)
+        gt.remove_self_loops(g)
+        return g
+    raise ValueError("unknown graph: " + name)
+
+
+def get_weights(g, seed):
+    numpy.random.seed(seed)
+    w = g.new_ep("double")
+    w.a = numpy.random.random(len(w.a)) + 1
+    return w
+
+
+# Each kernel is a function f(g, ctx) returning another function, which
+# performs the timed work and returns the number of work units done in it,
+# from which the throughput is computed. The setup itself is not timed.
+
+def bench_save_load(g, ctx):
+    def run():
+        f = io.BytesIO()
+        g.save(f, fmt="gt")
+        f.seek(0)
+        gt.load_graph(f, fmt="gt")
+        return g.num_edges()
+    return run
+
+
+def bench_bfs(g, ctx):
+    sources = ctx["sources"]
+    def run():
+        for v in sources:
+            gt.shortest_distance(g, source=g.vertex(v))
+        return len(sources) * g.num_edges()
+    return run
+
+
+def bench_dijkstra(g, ctx):
+    sources = ctx["sources"]
+    w = ctx["weights"]
+    def run():
+        for v in sources:
+            gt.shortest_distance(g, source=g.vertex(v), weights=w)
+        return len(sources) * g.num_edges()
+    return run
+
+
+def bench_pagerank(g, ctx):
+    def run():
+        gt.pagerank(g, epsilon=1e-8)
+        return g.num_edges()
+    return run
+
+
+def bench_betweenness(g, ctx):
+    pivots = ctx["pivots"]
+    def run():
+        gt.betweenness(g, pivots=pivots)
+        return len(pivots) * g.num_edges()
+    return run
+
+
+def bench_triangles(g, ctx):
+    def run():
+        gt.global_clustering(g)
+        return g.num_edges()
+    return run
+
+
+def bench_kcore(g, ctx):
+    def run():
+        gt.kcore_decomposition(g)
+        return g.num_edges()
+    return run
+
+
+def bench_components(g, ctx):
+    def run():
+        gt.label_components(g)
+        return g.num_edges()
+    return run
+
+
+def bench_sfdp(g, ctx):
+    niter = 10
+    gt.seed_rng(ctx["seed"])
+    pos = gt.random_layout(g)
+    def run():
+        gt.sfdp_layout(g, pos=pos.copy(), max_iter=niter, multilevel=False)
+        return niter * g.num_vertices()
+    return run
+
+
+def bench_mcmc_sweep(g, ctx):
+    state = gt.BlockState(g, b=ctx["partition"])
+    def run():
+        state.mcmc_sweep(niter=1, beta=numpy.inf)
+        return g.num_vertices()
+    return run
+
+
+def bench_virtual_move(g, ctx):
+    state = gt.BlockState(g, b=ctx["partition"])
+    B = ctx["B"]
+    moves = [(v, numpy.random.randint(B)) for v in ctx["sources"]] * 10
+    def run():
+        for v, s in moves:
+            state.virtual_vertex_move(v, s)
+        return len(moves)
+    return run
+
+
+# name -> (function, is parallel)
+kernels = {"save_load": (bench_save_load, False),
+           "bfs": (bench_bfs, True),
+           "dijkstra": (bench_dijkstra, True),
+           "pagerank": (bench_pagerank, True),
+           "betweenness": (bench_betweenness, True),
+           "triangles": (bench_triangles, True),
+           "kcore": (bench_kcore, False),
+           "components": (bench_components, True),
+           "sfdp": (bench_sfdp, True),
+           "mcmc_sweep": (bench_mcmc_sweep, False),
+           "virtual_move_dS": (bench_virtual_move, False)}
+
+
+def get_context(g, seed, nsources=16, npivots=64, B=16):
+    numpy.random.seed(seed)
+    N = g.num_vertices()
+    b = g.new_vp("int32_t")
+    b.a = numpy.random.randint(0, min(B, N), N)
+    return dict(seed=seed,
+                sources=numpy.random.randint(0, N, min(nsources, N)),
+                pivots=numpy.random.choice(N, min(npivots, N), replace=False),
+                weights=get_weights(g, seed),
+                partition=b, B=min(B, N))
+
+
+def time_kernel(run, repeat, warmup):
+    for i in range(warmup):
+        run()
+    times = []
+    units = 0
+    for i in range(repeat):
+        t = clock()
+        units = run()
+        times.append(clock() - t)
+    return times, units
+
+
+def get_metadata(args):
+    return dict(graph_tool=gt.__version__,
+                python=platform.python_version(),
+                platform=platform.platform(),
+                machine=platform.machine(),
+                cpu_count=multiprocessing.cpu_count(),
+                openmp=gt.openmp_enabled(),
+                date=datetime.datetime.utcnow().isoformat(),
+                seed=args.seed,
+                repeat=args.repeat,
+                warmup=args.warmup)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--graphs", nargs="+",
+                        default=["power", "cond-mat-2005", "as-22july06",
+                                 "pgp-strong-2009", "sbm:100000",
+                                 "price:100000"],
+                        help="collection datasets, or sbm:N / price:N")
+    parser.add_argument("--kernels", nargs="+", default=sorted(kernels.keys()))
+    parser.add_argument("--threads", nargs="+", type=int, default=None,
+                        help="thread counts (default: powers of two up to the "
+                        "number of cores)")
+    parser.add_argument("--repeat", type=int, default=5)
+    parser.add_argument("--warmup", type=int, default=1)
+    parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--output", default="-",
+                        help="output JSON file (default: stdout)")
+    parser.add_argument("--list", action="store_true",
+                        help="list the available kernels and exit")
+    args = parser.parse_args()
+
+    if args.list:
+        for k in sorted(kernels.keys()):
+            print(k, "(parallel)" if kernels[k][1] else "")
+        return
+
+    for k in args.kernels:
+        if k not in kernels:
+            raise ValueError("unknown kernel: " + k)
+
+    threads = args.threads
+    if threads is None:
+        threads = [1]
+        while gt.openmp_enabled() and threads[-1] * 2 <= multiprocessing.cpu_count():
+            threads.append(threads[-1] * 2)
+
+    results = []
+    for name in args.graphs:
+        t = clock()
+        g = get_graph(name, args.seed)
+        load_time = clock() - t
+        ctx = get_context(g, args.seed)
+        print("%s: N = %d, E = %d (%g s)" % (name, g.num_vertices(),
+                                             g.num_edges(), load_time),
+              file=sys.stderr)
+        for k in args.kernels:
+            f, parallel = kernels[k]
+            for nt in (threads if parallel else [1]):
+                if gt.openmp_enabled():
+                    gt.openmp_set_num_threads(nt)
+                gt.seed_rng(args.seed)
+                numpy.random.seed(args.seed)
+                times, units = time_kernel(f(g, ctx), args.repeat, args.warmup)
+                median = float(numpy.median(times))
+                results.append(dict(graph=name, N=g.num_vertices(),
+                                    E=g.num_edges(), kernel=k, threads=nt,
+                                    times=times, min=min(times), median=median,
+                                    units=units, throughput=units / median))
+                print("  %-16s threads = %-3d median = %.4g s (%.4g units/s)" %
+                      (k, nt, median, units / median), file=sys.stderr)
+
+    out = dict(metadata=get_metadata(args), results=results)
+    if args.output == "-":
+        json.dump(out, sys.stdout, indent=2)
+        print()
+    else:
+        with open(args.output, "w") as f:
+            json.dump(out, f, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -189,4 +189,23 @@ for directed in [True, False]:
             legend(loc="best")
         savefig("test_mcmc_directed%s-cum%s.pdf" % (directed, str(cum)))
 
+# the multicanonical state, including the Wang-Landau factor, must survive a
+# checkpoint round trip and pickling
+
+import tempfile, os, pickle
+
+m_state = MulticanonicalState(g, S_min=0, S_max=1000, nbins=100)
+m_state._density.a = numpy.random.random(len(m_state._density.a))
+m_state._f = 0.125
+with tempfile.TemporaryDirectory() as d:
+    fname = os.path.join(d, "mc.ckpt")
+    save_checkpoint(fname, m_state=m_state, rng=False, wait=True)
+    m_state2 = MulticanonicalState(g, S_min=0, S_max=1000, nbins=10)
+    load_checkpoint(fname, m_state=m_state2, rng=False, mmap=False)
+m_state3 = pickle.loads(pickle.dumps(m_state))
+for m in [m_state2, m_state3]:
+    if m._f != m_state._f or any(m._density.a != m_state._density.a):
+        print("Warning, multicanonical state not restored:", m._f,
+              m_state._f)
+
 print("OK")
\ No newline at end of file
@@ -28,6 +28,7 @@
 #include <exception>
 #include <set>
 #include <unordered_set>
+#include <vector>
 
 // Base64 Encoding
 
@@ -346,8 +347,57 @@ std::string print_value(dynamic_property_map& pmap, Descriptor v)
     return val;
 }
 
+// the printers are resolved once per property map, instead of once per value
+typedef std::string (*value_printer_t)(const boost::any&);
+
+template <typename ValueType>
+std::string print_any(const boost::any& val)
+{
+    std::string sval;
+    get_string()(val, sval, ValueType());
+    return sval;
+}
+
+template <typename Types>
+class get_value_printer
+{
+public:
+    get_value_printer(const std::type_info& type, value_printer_t& printer)
+        : m_type(type), m_printer(printer) {}
+    template <typename Type>
+    void operator()(Type)
+    {
+        if (typeid(Type) == m_type)
+            m_printer = &print_any<Type>;
+    }
+private:
+    const std::type_info &m_type;
+    value_printer_t &m_printer;
+};
+
+struct graphml_key
+{
+    dynamic_property_map* pmap;
+    std::string key_id;
+    value_printer_t printer;
+};
+
 std::string protect_xml_string(const std::string& s);
 
+template <typename Descriptor>
+void write_graphml_data(std::ostream& out, const char* indent,
+                        const std::vector<graphml_key>& keys, Descriptor v)
+{
+    for (auto& k : keys)
+    {
+        std::string val = protect_xml_string(k.printer(k.pmap->get(v)));
+        if (val.empty())
+            continue;
+        out << indent << "<data key=\"" << k.key_id << "\">" << val
+            << "</data>\n";
+    }
+}
+
 template <typename Graph, typename VertexIndexMap>
 void
 write_graphml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
@@ -367,43 +417,48 @@ write_graphml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
            "         xsi:schemaLocation=\"http://graphml.graphdrawing.org/xmlns"
            " http://graphml.graphdrawing.org/xmlns/1.0/graphml.xsd\">\n\n";
 
-    std::map<std::string, std::string> graph_key_ids;
-    std::map<std::string, std::string> vertex_key_ids;
-    std::map<std::string, std::string> edge_key_ids;
+    std::vector<graphml_key> graph_keys, vertex_keys, edge_keys;
     int key_count = 0;
 
     out << "  <!-- property keys -->\n";
 
-    bool has_vertex_ids = false;
-    bool has_edge_ids = false;
+    dynamic_property_map* vertex_ids = nullptr;
+    dynamic_property_map* edge_ids = nullptr;
 
     // Output keys
     for (dynamic_properties::const_iterator i = dp.begin(); i != dp.end(); ++i)
     {
         if (i->first == "_graphml_vertex_id")
         {
-            has_vertex_ids = true;
+            vertex_ids = i->second.get();
             continue;
         }
 
         if (i->first == "_graphml_edge_id")
         {
-            has_edge_ids = true;
+            edge_ids = i->second.get();
             continue;
         }
 
         std::string key_id = "key" + lexical_cast<std::string>(key_count++);
+        std::vector<graphml_key>* keys;
         if (i->second->key() == typeid(graph_property_tag))
-            graph_key_ids[i->first] = key_id;
+            keys = &graph_keys;
         else if (i->second->key() == typeid(vertex_descriptor))
-            vertex_key_ids[i->first] = key_id;
+            keys = &vertex_keys;
         else if (i->second->key() == typeid(edge_descriptor))
-            edge_key_ids[i->first] = key_id;
+            keys = &edge_keys;
         else
             continue;
         std::string type_name = "string";
         mpl::for_each<prop_value_types>
             (get_type_name<prop_value_types>(i->second->value(), type_name));
+        value_printer_t printer = nullptr;
+        mpl::for_each<prop_value_types>
+            (get_value_printer<prop_value_types>(i->second->value(), printer));
+        if (printer != nullptr)
+            keys->push_back({i->second.get(), protect_xml_string(key_id),
+                             printer});
         out << "  <key id=\"" << protect_xml_string(key_id) << "\" for=\""
             << (i->second->key() == typeid(graph_property_tag) ? "graph" :
                 (i->second->key() == typeid(vertex_descriptor) ? "node" :
@@ -413,6 +468,8 @@ write_graphml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
             << " />\n";
     }
 
+    bool has_vertex_ids = vertex_ids != nullptr;
+    bool has_edge_ids = edge_ids != nullptr;
     bool canonical_vertices = ordered_vertices && !has_vertex_ids;
     bool canonical_edges = !has_edge_ids;
 
@@ -425,51 +482,28 @@ write_graphml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
 
     out << "   <!-- graph properties -->\n";
     // Output graph data
-    for (dynamic_properties::const_iterator i = dp.begin(); i != dp.end(); ++i)
-    {
-        if (i->second->key() == typeid(graph_property_tag))
-        {
-            std::string val = protect_xml_string
-                (print_value<prop_value_types>(*i->second, graph_property_tag()));
-            if (val.empty())
-                continue;
-            out << "   <data key=\""
-                << protect_xml_string(graph_key_ids[i->first]) << "\">"
-                << val << "</data>\n";
-        }
-    }
+    write_graphml_data(out, "   ", graph_keys, graph_property_tag());
 
     out << "\n   <!-- vertices -->\n";
 
+    auto print_vertex = [&](vertex_descriptor v)
+        {
+            if (has_vertex_ids)
+                out << protect_xml_string(vertex_ids->get_string(v));
+            else
+                out << "n" << get(vertex_index, v);
+        };
+
     typedef typename graph_traits<Graph>::vertex_iterator vertex_iterator;
     vertex_iterator v, v_end;
     for (tie(v, v_end) = vertices(g); v != v_end; ++v)
     {
         out << "    <node id=\"";
-        if (has_vertex_ids)
-            out << protect_xml_string(get("_graphml_vertex_id", dp, *v));
-        else
-            out << "n" << get(vertex_index, *v);
+        print_vertex(*v);
         out << "\">\n";
 
         // Output data
-        for (dynamic_properties::const_iterator i = dp.begin(); i != dp.end();
-             ++i)
-        {
-            if (i->first == "_graphml_vertex_id")
-                continue;
-
-            if (i->second->key() == typeid(vertex_descriptor))
-            {
-                std::string val = protect_xml_string
-                    (print_value<prop_value_types>(*i->second, *v));
-                if (val.empty())
-                    continue;
-                out << "      <data key=\""
-                    << protect_xml_string(vertex_key_ids[i->first]) << "\">"
-                    << val << "</data>\n";
-            }
-        }
+        write_graphml_data(out, "      ", vertex_keys, *v);
         out << "    </node>\n";
     }
 
@@ -481,43 +515,19 @@ write_graphml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
     {
         out << "    <edge id=\"";
         if (has_edge_ids)
-            out << protect_xml_string(get("_graphml_edge_id", dp, *e));
+            out << protect_xml_string(edge_ids->get_string(*e));
         else
             out << "e" << edge_count;
         edge_count++;
 
         out << "\" source=\"";
-        if (has_vertex_ids)
-            out << protect_xml_string(get("_graphml_vertex_id", dp,
-                                           source(*e, g)));
-        else
-            out << "n" << get(vertex_index, source(*e, g));
+        print_vertex(source(*e, g));
         out << "\" target=\"";
-        if (has_vertex_ids)
-            out << protect_xml_string(get("_graphml_vertex_id", dp,
-                                          target(*e, g)));
-        else
-            out << "n" << get(vertex_index, target(*e, g));
+        print_vertex(target(*e, g));
         out<< "\">\n";
 
         // Output data
-        for (dynamic_properties::const_iterator i = dp.begin(); i != dp.end();
-             ++i)
-        {
-            if (i->first == "_graphml_edge_id")
-                continue;
-
-            if (i->second->key() == typeid(edge_descriptor))
-            {
-                std::string val = protect_xml_string
-                    (print_value<prop_value_types>(*i->second, *e));
-                if (val.empty())
-                    continue;
-                out << "      <data key=\""
-                    << protect_xml_string(edge_key_ids[i->first]) << "\">"
-                    << val << "</data>\n";
-            }
-        }
+        write_graphml_data(out, "      ", edge_keys, *e);
         out << "    </edge>\n";
     }
 
@@ -23,6 +23,9 @@
 #include "graph.hh"
 #include "graph_selectors.hh"
 #include "graph_util.hh"
+#include "numpy_bind.hh"
+#include "random.hh"
+#include "graph_betweenness.hh"
 
 using namespace std;
 using namespace boost;
@@ -66,7 +69,7 @@ void normalize_betweenness(const Graph& g,
                  put(vertex_betweenness, v, vfactor * get(vertex_betweenness, v));
          });
 
-    parallel_edge_loop
+    parallel_edge_loop_flat
         (g,
          [&](const auto& e)
          {
@@ -80,24 +83,13 @@ struct get_betweenness
     template <class Graph, class EdgeBetweenness, class VertexBetweenness>
     void operator()(Graph& g,
                     std::vector<size_t>& pivots,
-                    GraphInterface::vertex_index_map_t index_map,
                     EdgeBetweenness edge_betweenness,
                     VertexBetweenness vertex_betweenness,
-                    bool normalize, size_t n) const
+                    bool normalize, size_t n, size_t max_eindex) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<size_t> distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-        brandes_betweenness_centrality
-            (g, pivots, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), index_map),
-             make_iterator_property_map(distance_map.begin(), index_map),
-             make_iterator_property_map(dependency_map.begin(), index_map),
-             make_iterator_property_map(path_count_map.begin(), index_map),
-             index_map);
+        parallel_brandes_betweenness<size_t>
+            (g, pivots, brandes_unit_weight(), edge_betweenness,
+             vertex_betweenness, max_eindex);
         if (normalize)
             normalize_betweenness(g, pivots, edge_betweenness, vertex_betweenness, n);
     }
@@ -106,33 +98,33 @@ struct get_betweenness
 struct get_weighted_betweenness
 {
     typedef void result_type;
-    template <class Graph, class EdgeBetweenness, class VertexBetweenness,
-              class VertexIndexMap>
+    template <class Graph, class EdgeBetweenness, class VertexBetweenness>
     void operator()(Graph& g, std::vector<size_t>& pivots,
-                    VertexIndexMap vertex_index,
                     EdgeBetweenness edge_betweenness,
                     VertexBetweenness vertex_betweenness,
                     boost::any weight_map, bool normalize,
                     size_t n, size_t max_eindex) const
     {
-        vector<vector<typename graph_traits<Graph>::edge_descriptor> >
-            incoming_map(num_vertices(g));
-        vector<typename property_traits<EdgeBetweenness>::value_type>
-            distance_map(num_vertices(g));
-        vector<typename property_traits<VertexBetweenness>::value_type>
-            dependency_map(num_vertices(g));
-        vector<size_t> path_count_map(num_vertices(g));
-
-        typename EdgeBetweenness::checked_t weight =
-            any_cast<typename EdgeBetweenness::checked_t>(weight_map);
-
-        brandes_betweenness_centrality
-            (g, pivots, vertex_betweenness, edge_betweenness,
-             make_iterator_property_map(incoming_map.begin(), vertex_index),
-             make_iterator_property_map(distance_map.begin(), vertex_index),
-             make_iterator_property_map(dependency_map.begin(), vertex_index),
-             make_iterator_property_map(path_count_map.begin(), vertex_index),
-             vertex_index, weight.get_unchecked(max_eindex+1));
+        typedef typename property_traits<EdgeBetweenness>::value_type val_t;
+
+        auto weight = any_cast<typename EdgeBetweenness::checked_t>(weight_map)
+            .get_unchecked(max_eindex + 1);
+
+        bool negative = false;
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 if (weight[e] < 0)
+                     negative = true;
+             });
+        if (negative)
+            throw ValueException("Negative edge weight found in betweenness "
+                                 "computation");
+
+        parallel_brandes_betweenness<val_t>
+            (g, pivots, weight, edge_betweenness, vertex_betweenness,
+             max_eindex);
         if (normalize)
             normalize_betweenness(g, pivots, edge_betweenness, vertex_betweenness, n);
     }
@@ -154,11 +146,10 @@ void betweenness(GraphInterface& g, std::vector<size_t>& pivots,
 
     if (!weight.empty())
     {
-        run_action<>()
+        run_action<>(true)
             (g, std::bind<>(get_weighted_betweenness(),
                             std::placeholders::_1,
                             std::ref(pivots),
-                            g.get_vertex_index(),
                             std::placeholders::_2,
                             std::placeholders::_3, weight, normalize,
                             g.get_num_vertices(), g.get_edge_index_range()),
@@ -168,18 +159,262 @@ void betweenness(GraphInterface& g, std::vector<size_t>& pivots,
     }
     else
     {
-        run_action<>()
+        run_action<>(true)
             (g, std::bind<void>(get_betweenness(), std::placeholders::_1,
-                                std::ref(pivots),
-                                g.get_vertex_index(), std::placeholders::_2,
+                                std::ref(pivots), std::placeholders::_2,
                                 std::placeholders::_3, normalize,
-                                g.get_num_vertices()),
+                                g.get_num_vertices(),
+                                g.get_edge_index_range()),
              edge_floating_properties(),
              vertex_floating_properties())
             (edge_betweenness, vertex_betweenness);
     }
 }
 
+// Upper bound on the number of vertices of a shortest path, from a BFS that
+// ignores the edge directions from one vertex of each component: for
+// undirected graphs it is 2e+1, where e is the eccentricity of that vertex,
+// and for directed graphs the size of the largest component.
+template <class Graph>
+size_t vertex_diameter_bound(const Graph& g)
+{
+    size_t N = num_vertices(g);
+    vector<size_t> dist(N, numeric_limits<size_t>::max());
+    vector<size_t> queue;
+    size_t bound = 0;
+    for (auto r : vertices_range(g))
+    {
+        if (dist[r] != numeric_limits<size_t>::max())
+            continue;
+        queue.assign(1, r);
+        dist[r] = 0;
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            size_t v = queue[i];
+            for (auto u : all_neighbors_range(vertex(v, g), g))
+            {
+                if (dist[u] != numeric_limits<size_t>::max())
+                    continue;
+                dist[u] = dist[v] + 1;
+                queue.push_back(u);
+            }
+        }
+        size_t b = queue.size();
+        if (!graph_tool::is_directed(g))
+            b = std::min(b, 2 * dist[queue.back()] + 1);
+        bound = std::max(bound, b);
+    }
+    return bound;
+}
+
+// Adaptive sampling of the betweenness, following the KADABRA algorithm of
+// Borassi and Natale: random shortest paths between uniformly chosen pairs
+// of vertices are sampled, and the number of times each vertex lies inside
+// them, divided by the number of samples, estimates its betweenness
+// normalized by n(n-1). The sampling stops when the confidence intervals of
+// all vertices (or of those that can be in the top k) are smaller than
+// epsilon, with probability at least 1 - delta, or when the number of samples
+// reaches the bound of Riondato and Kornaropoulos, given by the vertex
+// diameter. Half of delta is spent on that bound, and the rest is divided
+// evenly among the upper and lower bounds of every vertex.
+//
+// The samples are taken in rounds of increasing size, and sample i uses its
+// own random stream, derived from the seed and i, so that the result does not
+// depend on the number of threads.
+struct get_approx_betweenness
+{
+    template <class Graph, class VertexBetweenness>
+    void operator()(Graph& g, VertexBetweenness vertex_betweenness,
+                    double epsilon, double delta, size_t k, bool normalize,
+                    uint64_t seed, size_t& n_samples, vector<size_t>& top)
+        const
+    {
+        typedef typename property_traits<VertexBetweenness>::value_type val_t;
+
+        vector<size_t> vs;
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+        size_t n = vs.size();
+
+        n_samples = 0;
+        top.clear();
+        for (auto v : vs)
+            put(vertex_betweenness, v, 0);
+        if (n < 3)
+        {
+            for (size_t i = 0; i < std::min(k, n); ++i)
+                top.push_back(vs[i]);
+            return;
+        }
+
+        // the guarantee is given for the usual normalization, by (n-1)(n-2)
+        double scale = double(n) / (n - 2);
+        double eps = epsilon / scale;
+
+        size_t vd = std::max(vertex_diameter_bound(g), size_t(3));
+        double omega = 0.5 / (eps * eps) *
+            (std::log2(vd - 2) + 1 + std::log(2 / delta));
+        double log_delta = std::log(4 * n / delta);
+
+        // half-widths of the confidence interval below and above the estimate
+        auto lower = [&](double b, double tau)
+            {
+                double x = omega / tau - 1. / 3;
+                return std::min(log_delta / tau *
+                                (-x + sqrt(x * x + 2 * b * omega / log_delta)),
+                                b);
+            };
+        auto upper = [&](double b, double tau)
+            {
+                double x = omega / tau + 1. / 3;
+                return std::min(log_delta / tau *
+                                (x + sqrt(x * x + 2 * b * omega / log_delta)),
+                                1 - b);
+            };
+
+        size_t N = num_vertices(g);
+        std::unique_ptr<std::atomic<size_t>[]> count
+            (new std::atomic<size_t>[N]);
+        for (size_t v = 0; v < N; ++v)
+            count[v] = 0;
+
+        size_t nt = get_traversal_threads(N);
+        vector<shortest_path_sampler<Graph>> samplers;
+        for (size_t i = 0; i < nt; ++i)
+            samplers.emplace_back(g);
+
+        auto sample = [&](size_t i)
+            {
+                size_t tid = 0;
+#ifdef _OPENMP
+                if (nt > 1)
+                    tid = omp_get_thread_num();
+#endif
+                counter_rng rng(random_priority(seed, i));
+                size_t a = rng() % n;
+                size_t b = rng() % (n - 1);
+                if (b >= a)
+                    ++b;
+                samplers[tid](vs[a], vs[b], rng,
+                              [&](size_t v)
+                              {
+                                  count[v].fetch_add(1,
+                                                     std::memory_order_relaxed);
+                              });
+            };
+
+        auto done = [&](double tau)
+            {
+                auto precise = [&](size_t v)
+                    {
+                        double b = count[v] / tau;
+                        return lower(b, tau) <= eps && upper(b, tau) <= eps;
+                    };
+
+                if (k == 0 || k >= n)
+                {
+                    size_t n_bad = 0;
+                    #pragma omp parallel for if (n > OPENMP_MIN_THRESH) \
+                        reduction(+:n_bad)
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        if (!precise(vs[i]))
+                            ++n_bad;
+                    }
+                    return n_bad == 0;
+                }
+
+                // the top k are either separated from the rest, or known
+                // precisely, together with all the vertices that can replace
+                // them
+                vector<size_t> order(vs);
+                std::nth_element(order.begin(), order.begin() + k - 1,
+                                 order.end(),
+                                 [&](size_t u, size_t v)
+                                 {
+                                     return count[u] > count[v];
+                                 });
+                double min_lower = numeric_limits<double>::max();
+                bool top_precise = true;
+                for (size_t i = 0; i < k; ++i)
+                {
+                    double b = count[order[i]] / tau;
+                    min_lower = std::min(min_lower, b - lower(b, tau));
+                    top_precise = top_precise && precise(order[i]);
+                }
+                for (size_t i = k; i < n; ++i)
+                {
+                    double b = count[order[i]] / tau;
+                    if (b + upper(b, tau) < min_lower)
+                        continue;
+                    if (!top_precise || !precise(order[i]))
+                        return false;
+                }
+                return true;
+            };
+
+        size_t max_samples = std::ceil(omega);
+        size_t round = 1000;
+        while (n_samples < max_samples)
+        {
+            size_t end = std::min(n_samples + round, max_samples);
+            #pragma omp parallel for num_threads(nt) schedule(runtime)
+            for (size_t i = n_samples; i < end; ++i)
+                sample(i);
+            n_samples = end;
+            round += round / 4;
+            if (done(n_samples))
+                break;
+        }
+
+        double norm = scale;
+        if (!normalize)
+        {
+            norm *= (n - 1) * (n - 2);
+            if (!graph_tool::is_directed(g))
+                norm /= 2;
+        }
+        double tau = n_samples;
+        for (auto v : vs)
+            put(vertex_betweenness, v, val_t(count[v] * norm / tau));
+
+        size_t nk = std::min(k, n);
+        top = vs;
+        std::partial_sort(top.begin(), top.begin() + nk, top.end(),
+                          [&](size_t u, size_t v)
+                          {
+                              return count[u] > count[v] ||
+                                  (count[u] == count[v] && u < v);
+                          });
+        top.resize(nk);
+    }
+};
+
+python::object approx_betweenness(GraphInterface& gi,
+                                  boost::any vertex_betweenness,
+                                  double epsilon, double delta, size_t k,
+                                  bool normalize, rng_t& rng)
+{
+    if (!belongs<vertex_floating_properties>()(vertex_betweenness))
+        throw ValueException("vertex property must be of floating point value"
+                             " type");
+    if (epsilon <= 0 || delta <= 0 || delta >= 1)
+        throw ValueException("epsilon must be positive, and delta must be "
+                             "in (0, 1)");
+
+    uint64_t seed = rng();
+    seed = (seed << 32) | rng();
+
+    size_t n_samples = 0;
+    vector<size_t> top;
+    run_action<>()
+        (gi, std::bind<>(get_approx_betweenness(), std::placeholders::_1,
+                         std::placeholders::_2, epsilon, delta, k, normalize,
+                         seed, std::ref(n_samples), std::ref(top)),
+         vertex_floating_properties())(vertex_betweenness);
+    return python::make_tuple(n_samples, wrap_vector_owned(top));
+}
+
 struct get_central_point_dominance
 {
     template <class Graph, class VertexBetweenness>
@@ -205,5 +440,6 @@ void export_betweenness()
 {
     using namespace boost::python;
     def("get_betweenness", &betweenness);
+    def("get_approx_betweenness", &approx_betweenness);
     def("get_central_point_dominance", &central_point);
 }
@@ -0,0 +1,526 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BETWEENNESS_HH
+#define GRAPH_BETWEENNESS_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_parallel_traversal.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Unit weights, for the unweighted version, which uses BFS instead of
+// Dijkstra's algorithm.
+struct brandes_unit_weight {};
+
+// State of one thread of the Brandes algorithm: the single-source shortest
+// paths, with the number of such paths, and the dependencies accumulated in
+// the reverse order of discovery.
+//
+// The predecessors on the shortest paths are kept in a single flat array,
+// where each vertex has a slot as large as its in-degree (the degree, if the
+// graph is undirected), at offsets shared by all threads, instead of a vector
+// per vertex. Dijkstra's algorithm uses a 4-ary heap with decrease-key, as
+// in Boost, so that vertices at the same distance are visited in the same
+// order. Only the vertices reached from the last source are reset.
+template <class Graph, class Dist, class Dependency, class VCentrality,
+          class ECentrality>
+class brandes_state
+{
+public:
+    brandes_state(const Graph& g, const vector<size_t>& offset,
+                  VCentrality& vcentrality, ECentrality& ecentrality)
+        : _g(g), _offset(offset), _vc(vcentrality), _ec(ecentrality),
+          _dist(num_vertices(g), numeric_limits<Dist>::max()),
+          _sigma(num_vertices(g), 0), _delta(num_vertices(g), 0),
+          _npred(num_vertices(g), 0), _done(num_vertices(g), false),
+          _pred(offset.back()), _hpos(num_vertices(g))
+    {}
+
+    template <class Weight>
+    void operator()(size_t s, Weight& weight)
+    {
+        _order.clear();
+        _dist[s] = 0;
+        _sigma[s] = 1;
+        shortest_paths(s, weight);
+
+        // accumulation of the dependencies, in the reverse order
+        for (auto iter = _order.rbegin(); iter != _order.rend(); ++iter)
+        {
+            size_t w = *iter;
+            size_t pos = _offset[w];
+            for (size_t i = 0; i < _npred[w]; ++i)
+            {
+                auto& p = _pred[pos + i];
+                Dependency factor = Dependency(_sigma[p.v]) /
+                    Dependency(_sigma[w]);
+                factor *= Dependency(1) + _delta[w];
+                _delta[p.v] += factor;
+                _ec[p.e] += factor;
+            }
+            if (w != s)
+                _vc[w] += _delta[w];
+        }
+
+        for (auto w : _order)
+        {
+            _dist[w] = numeric_limits<Dist>::max();
+            _sigma[w] = 0;
+            _delta[w] = 0;
+            _npred[w] = 0;
+            _done[w] = false;
+        }
+    }
+
+private:
+    struct pred_t
+    {
+        size_t v;
+        size_t e;
+    };
+
+    void add_pred(size_t v, size_t w, size_t e)
+    {
+        _pred[_offset[w] + _npred[w]++] = {v, e};
+        _sigma[w] += _sigma[v];
+    }
+
+    void shortest_paths(size_t s, brandes_unit_weight&)
+    {
+        // the BFS queue is also the order of discovery
+        auto eindex = get(edge_index_t(), _g);
+        _done[s] = true;
+        _order.push_back(s);
+        for (size_t i = 0; i < _order.size(); ++i)
+        {
+            size_t v = _order[i];
+            Dist d = _dist[v] + 1;
+            for (auto e : out_edges_range(vertex(v, _g), _g))
+            {
+                size_t w = target(e, _g);
+                if (w == v)
+                    continue;
+                if (!_done[w])
+                {
+                    _done[w] = true;
+                    _dist[w] = d;
+                    _order.push_back(w);
+                }
+                if (_dist[w] == d)
+                    add_pred(v, w, eindex[e]);
+            }
+        }
+    }
+
+    template <class Weight>
+    void shortest_paths(size_t s, Weight& weight)
+    {
+        // Dijkstra's algorithm; the vertices are put in order as they are
+        // removed from the heap
+        auto eindex = get(edge_index_t(), _g);
+        heap_push(s);
+        while (!_heap.empty())
+        {
+            size_t v = heap_pop();
+            _done[v] = true;
+            _order.push_back(v);
+            for (auto e : out_edges_range(vertex(v, _g), _g))
+            {
+                size_t w = target(e, _g);
+                if (w == v || _done[w])
+                    continue;
+                Dist d = combine(_dist[v], Dist(get(weight, e)));
+                if (d == numeric_limits<Dist>::max())
+                    continue;
+                if (d < _dist[w])
+                {
+                    bool queued = _dist[w] != numeric_limits<Dist>::max();
+                    _dist[w] = d;
+                    _npred[w] = 0;
+                    _sigma[w] = 0;
+                    add_pred(v, w, eindex[e]);
+                    if (queued)
+                        heap_up(_hpos[w]);
+                    else
+                        heap_push(w);
+                }
+                else if (d == _dist[w])
+                {
+                    add_pred(v, w, eindex[e]);
+                }
+            }
+        }
+    }
+
+    // 4-ary heap of vertices, ordered by distance, with decrease-key
+
+    void heap_set(size_t i, size_t v)
+    {
+        _heap[i] = v;
+        _hpos[v] = i;
+    }
+
+    void heap_up(size_t i)
+    {
+        size_t v = _heap[i];
+        while (i > 0)
+        {
+            size_t p = (i - 1) / 4;
+            if (!(_dist[v] < _dist[_heap[p]]))
+                break;
+            heap_set(i, _heap[p]);
+            i = p;
+        }
+        heap_set(i, v);
+    }
+
+    void heap_push(size_t v)
+    {
+        _heap.push_back(v);
+        heap_up(_heap.size() - 1);
+    }
+
+    size_t heap_pop()
+    {
+        size_t top = _heap.front();
+        size_t v = _heap.back();
+        _heap.pop_back();
+        size_t n = _heap.size();
+        if (n == 0)
+            return top;
+        size_t i = 0;
+        while (true)
+        {
+            size_t c = i * 4 + 1;
+            if (c >= n)
+                break;
+            size_t end = std::min(c + 4, n);
+            size_t m = c;
+            for (size_t j = c + 1; j < end; ++j)
+            {
+                if (_dist[_heap[j]] < _dist[_heap[m]])
+                    m = j;
+            }
+            if (!(_dist[_heap[m]] < _dist[v]))
+                break;
+            heap_set(i, _heap[m]);
+            i = m;
+        }
+        heap_set(i, v);
+        return top;
+    }
+
+    static Dist combine(Dist a, Dist b)
+    {
+        constexpr Dist inf = numeric_limits<Dist>::max();
+        if (a == inf || b == inf)
+            return inf;
+        return a + b;
+    }
+
+    const Graph& _g;
+    const vector<size_t>& _offset;
+    VCentrality& _vc;
+    ECentrality& _ec;
+
+    vector<Dist> _dist;
+    vector<size_t> _sigma;
+    vector<Dependency> _delta;
+    vector<size_t> _npred;
+    vector<uint8_t> _done;
+    vector<pred_t> _pred;
+    vector<size_t> _order;
+    vector<size_t> _heap;
+    vector<size_t> _hpos;
+};
+
+// Brandes' algorithm for the betweenness of the vertices and edges, with the
+// given pivots as sources, which are distributed among the threads. Each
+// thread accumulates the dependencies in its own arrays, which are summed at
+// the end, so that no atomic operations are needed. The distances are of
+// type Dist, and the weights must be non-negative.
+template <class Dist, class Graph, class Weight, class EdgeBetweenness,
+          class VertexBetweenness>
+void parallel_brandes_betweenness(const Graph& g, const vector<size_t>& pivots,
+                                  Weight weight,
+                                  EdgeBetweenness edge_betweenness,
+                                  VertexBetweenness vertex_betweenness,
+                                  size_t max_eindex)
+{
+    typedef typename property_traits<VertexBetweenness>::value_type vval_t;
+    typedef typename property_traits<EdgeBetweenness>::value_type eval_t;
+    typedef vector<vval_t> vcentrality_t;
+    typedef vector<eval_t> ecentrality_t;
+
+    size_t N = num_vertices(g);
+    size_t E = max_eindex + 1;
+
+    vector<size_t> offset(N + 1, 0);
+    bool directed = graph_tool::is_directed(g);
+    for (auto v : vertices_range(g))
+        offset[v + 1] = directed ? in_degreeS()(v, g) : out_degree(v, g);
+    for (size_t v = 0; v < N; ++v)
+        offset[v + 1] += offset[v];
+
+    size_t nt = get_traversal_threads(N);
+    nt = std::max(std::min(nt, pivots.size()), size_t(1));
+
+    vector<vcentrality_t> vcs(nt);
+    vector<ecentrality_t> ecs(nt);
+
+    #pragma omp parallel num_threads(nt)
+    {
+        size_t tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        auto& vc = vcs[tid];
+        auto& ec = ecs[tid];
+        vc.resize(N, 0);
+        ec.resize(E, 0);
+        brandes_state<Graph, Dist, vval_t, vcentrality_t, ecentrality_t>
+            state(g, offset, vc, ec);
+
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < pivots.size(); ++i)
+        {
+            auto s = vertex(pivots[i], g);
+            if (s == graph_traits<Graph>::null_vertex())
+                continue;
+            state(s, weight);
+        }
+    }
+
+    // the paths of undirected graphs are counted in both directions
+    double norm = directed ? 1 : 2;
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             vval_t c = 0;
+             for (auto& vc : vcs)
+                 c += vc[v];
+             put(vertex_betweenness, v, c / norm);
+         });
+
+    auto eindex = get(edge_index_t(), g);
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             eval_t c = 0;
+             for (auto& ec : ecs)
+                 c += ec[eindex[e]];
+             put(edge_betweenness, e, c / norm);
+         });
+}
+
+// Sampling of a shortest path from s to t, uniformly among all of them, by a
+// balanced bidirectional BFS: at each step the frontier with the smallest sum
+// of degrees is expanded, until a vertex is reached from both sides. Since
+// both searches are complete up to their depths, after the level is finished
+// the vertices reached from both sides are exactly those at distance d(s,t)
+// from s in the forward search and at the depth of the backward one, which
+// are crossed by every shortest path. One of them is chosen with probability
+// proportional to the number of paths through it, and the path is completed
+// backwards to each end, by choosing the predecessors in proportion to their
+// path counts.
+//
+// The workspace is kept between samples, and only the vertices touched by the
+// last one are reset, so that the cost of a sample is proportional only to
+// the size of the searched region.
+template <class Graph>
+class shortest_path_sampler
+{
+public:
+    shortest_path_sampler(const Graph& g)
+        : _g(g), _directed(graph_tool::is_directed(g)),
+          _ds(num_vertices(g), _inf), _dt(num_vertices(g), _inf),
+          _ss(num_vertices(g), 0), _st(num_vertices(g), 0)
+    {}
+
+    // Calls visit(v) for each internal vertex of a random shortest path from
+    // s to t (with s != t). Returns false if t is not reachable from s.
+    template <class Visit>
+    bool operator()(size_t s, size_t t, counter_rng& rng, Visit&& visit)
+    {
+        for (auto v : _touched)
+        {
+            _ds[v] = _dt[v] = _inf;
+            _ss[v] = _st[v] = 0;
+        }
+        _touched.clear();
+        _meet.clear();
+
+        _ds[s] = 0;
+        _ss[s] = 1;
+        _dt[t] = 0;
+        _st[t] = 1;
+        _touched.push_back(s);
+        _touched.push_back(t);
+        _fs.assign(1, s);
+        _ft.assign(1, t);
+        size_t cost_s = out_degree(vertex(s, _g), _g);
+        size_t cost_t = back_degree(t);
+
+        while (!_fs.empty() && !_ft.empty() && _meet.empty())
+        {
+            if (cost_s <= cost_t)
+                cost_s = expand(_fs, _ds, _ss, _dt, true);
+            else
+                cost_t = expand(_ft, _dt, _st, _ds, false);
+        }
+
+        if (_meet.empty())
+            return false;
+
+        double total = 0;
+        for (auto v : _meet)
+            total += _ss[v] * _st[v];
+        double r = rng.uniform() * total;
+        size_t m = _meet.back();
+        for (auto v : _meet)
+        {
+            r -= _ss[v] * _st[v];
+            if (r < 0)
+            {
+                m = v;
+                break;
+            }
+        }
+
+        if (m != s && m != t)
+            visit(m);
+        walk(m, s, _ds, _ss, false, rng, visit);
+        walk(m, t, _dt, _st, true, rng, visit);
+        return true;
+    }
+
+private:
+    size_t back_degree(size_t v) const
+    {
+        auto u = vertex(v, _g);
+        return _directed ? in_degreeS()(u, _g) : out_degree(u, _g);
+    }
+
+    // calls f(u) for the neighbors of v in the given direction
+    template <class F>
+    void for_each_neighbor(size_t v, bool out, F&& f) const
+    {
+        auto u = vertex(v, _g);
+        if (out || !_directed)
+        {
+            for (auto w : out_neighbors_range(u, _g))
+                f(size_t(w));
+        }
+        else
+        {
+            for (auto w : in_neighbors_range(u, _g))
+                f(size_t(w));
+        }
+    }
+
+    // expands one level of the search, and returns the sum of the degrees of
+    // the new frontier
+    size_t expand(vector<size_t>& front, vector<size_t>& d,
+                  vector<double>& sigma, const vector<size_t>& d_other,
+                  bool out)
+    {
+        _next.clear();
+        size_t cost = 0;
+        size_t l = d[front.front()] + 1;
+        for (auto v : front)
+        {
+            for_each_neighbor
+                (v, out,
+                 [&](size_t w)
+                 {
+                     if (d[w] == _inf)
+                     {
+                         if (d_other[w] == _inf)
+                             _touched.push_back(w);
+                         else
+                             _meet.push_back(w);
+                         d[w] = l;
+                         _next.push_back(w);
+                         cost += out ? out_degree(vertex(w, _g), _g) :
+                             back_degree(w);
+                     }
+                     if (d[w] == l)
+                         sigma[w] += sigma[v];
+                 });
+        }
+        front.swap(_next);
+        return cost;
+    }
+
+    // completes the path from v to the end of the search with distances d,
+    // whose predecessors are reached in the given direction
+    template <class Visit>
+    void walk(size_t v, size_t end, const vector<size_t>& d,
+              const vector<double>& sigma, bool out, counter_rng& rng,
+              Visit& visit)
+    {
+        while (v != end)
+        {
+            double r = rng.uniform() * sigma[v];
+            size_t l = d[v] - 1;
+            size_t p = _inf;
+            for_each_neighbor
+                (v, out,
+                 [&](size_t w)
+                 {
+                     if (d[w] != l || (p != _inf && r < 0))
+                         return;
+                     p = w;
+                     r -= sigma[w];
+                 });
+            v = p;
+            if (v != end)
+                visit(v);
+        }
+    }
+
+    static constexpr size_t _inf = numeric_limits<size_t>::max();
+
+    const Graph& _g;
+    bool _directed;
+    vector<size_t> _ds, _dt;
+    vector<double> _ss, _st;
+    vector<size_t> _fs, _ft, _next;
+    vector<size_t> _touched, _meet;
+};
+
+template <class Graph>
+constexpr size_t shortest_path_sampler<Graph>::_inf;
+
+} // graph_tool namespace
+
+#endif // GRAPH_BETWEENNESS_HH
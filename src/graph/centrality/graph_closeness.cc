@@ -21,6 +21,7 @@
 #include "graph_properties.hh"
 
 #include "graph_closeness.hh"
+#include "numpy_bind.hh"
 
 #include <functional>
 #include <boost/python.hpp>
@@ -50,7 +51,23 @@ void do_get_closeness(GraphInterface& gi, boost::any weight,
     }
 }
 
+boost::python::object do_get_top_closeness(GraphInterface& gi, size_t k,
+                                           bool harmonic, bool norm)
+{
+    if (k == 0)
+        throw ValueException("k must be positive");
+    vector<size_t> top;
+    vector<double> vals;
+    run_action<>()(gi, [&](auto& g)
+                   {
+                       top_k_closeness(g, k, harmonic, norm, top, vals);
+                   })();
+    return boost::python::make_tuple(wrap_vector_owned(top),
+                                     wrap_vector_owned(vals));
+}
+
 void export_closeness()
 {
     boost::python::def("closeness", &do_get_closeness);
+    boost::python::def("get_top_closeness", &do_get_top_closeness);
 }
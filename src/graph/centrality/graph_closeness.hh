@@ -18,8 +18,9 @@
 #ifndef GRAPH_CLOSENESS_HH
 #define GRAPH_CLOSENESS_HH
 
-#include <boost/graph/breadth_first_search.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <atomic>
+
+#include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
 
 #include <boost/python/object.hpp>
 #include <boost/python/list.hpp>
@@ -27,6 +28,8 @@
 
 #include "histogram.hh"
 #include "hash_map_wrap.hh"
+#include "graph_parallel_bfs.hh"
+#include "../topology/graph_components.hh"
 
 namespace graph_tool
 {
@@ -49,6 +52,9 @@ struct get_val_type<no_weightS>
 struct get_closeness
 {
     typedef void result_type;
+
+    // weighted version: one Dijkstra search per vertex, with a distance map
+    // per thread, of which only the reached vertices are visited and reset
     template <class Graph, class VertexIndex, class WeightMap, class Closeness>
     void operator()(const Graph& g, VertexIndex vertex_index, WeightMap weights,
                     Closeness closeness, bool harmonic, bool norm)
@@ -56,137 +62,375 @@ struct get_closeness
     {
         using namespace boost;
 
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
 
-        get_vertex_dists_t get_vertex_dists;
+        get_dists_djk get_vertex_dists;
         size_t HN = HardNumVertices()(g);
-        parallel_vertex_loop
-            (g,
-             [&](auto v)
-             {
-                 unchecked_vector_property_map<val_type,VertexIndex>
-                     dist_map(vertex_index, num_vertices(g));
-
-                 for (auto u : vertices_range(g))
-                     dist_map[u] = numeric_limits<val_type>::max();
-
-                 dist_map[v] = 0;
 
-                 size_t comp_size = 0;
-                 get_vertex_dists(g, v, vertex_index, dist_map, weights, comp_size);
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+        {
+            unchecked_vector_property_map<val_type,VertexIndex>
+                dist_map(vertex_index, num_vertices(g));
+            for (auto u : vertices_range(g))
+                dist_map[u] = numeric_limits<val_type>::max();
+            vector<size_t> reached;
 
-                 closeness[v] = 0;
-                 for (auto v2 : vertices_range(g))
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
                  {
-                     if (v2 != v && dist_map[v2] != numeric_limits<val_type>::max())
+                     dist_map[v] = 0;
+                     reached.clear();
+                     get_vertex_dists(g, v, vertex_index, dist_map, weights,
+                                      reached);
+
+                     closeness[v] = 0;
+                     for (auto u : reached)
                      {
-                         if (!harmonic)
-                             closeness[v] += dist_map[v2];
-                         else
-                             closeness[v] += 1. / dist_map[v2];
+                         if (u != v)
+                         {
+                             if (!harmonic)
+                                 closeness[v] += dist_map[u];
+                             else
+                                 closeness[v] += 1. / dist_map[u];
+                         }
+                         dist_map[u] = numeric_limits<val_type>::max();
                      }
-                 }
+                     dist_map[v] = numeric_limits<val_type>::max();
+
+                     normalize(closeness, v, reached.size(), HN, harmonic,
+                               norm);
+                 });
+        }
+    }
+
+    // unweighted version: the distances are accumulated directly from a
+    // multi-source BFS, without storing them
+    template <class Graph, class VertexIndex, class Closeness>
+    void operator()(const Graph& g, VertexIndex, no_weightS,
+                    Closeness closeness, bool harmonic, bool norm)
+        const
+    {
+        size_t HN = HardNumVertices()(g);
 
+        vector<size_t> sources;
+        for (auto v : vertices_range(g))
+        {
+            sources.push_back(v);
+            closeness[v] = 0;
+        }
+
+        vector<size_t> comp_size(num_vertices(g), 1);
+        parallel_multi_source_bfs
+            (g, sources,
+             [&](auto s, auto, size_t d)
+             {
                  if (!harmonic)
-                     closeness[v] = 1 / closeness[v];
+                     closeness[s] += d;
+                 else
+                     closeness[s] += 1. / d;
+                 ++comp_size[s];
+             });
 
-                 if (norm)
-                 {
-                     if (harmonic)
-                         closeness[v] /= HN - 1;
-                     else
-                         closeness[v] *= comp_size - 1;
-                 }
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 normalize(closeness, v, comp_size[v], HN, harmonic, norm);
              });
     }
 
+    template <class Closeness, class Vertex>
+    static void normalize(Closeness& closeness, Vertex v, size_t comp_size,
+                          size_t HN, bool harmonic, bool norm)
+    {
+        if (!harmonic)
+            closeness[v] = 1 / closeness[v];
+
+        if (norm)
+        {
+            if (harmonic)
+                closeness[v] /= HN - 1;
+            else
+                closeness[v] *= comp_size - 1;
+        }
+    }
 
     class component_djk_visitor: public boost::dijkstra_visitor<>
     {
     public:
-        //component_visitor() { }
-        component_djk_visitor(size_t& comp_size)
-            : _comp_size(comp_size) { }
+        component_djk_visitor(vector<size_t>& reached)
+            : _reached(reached) { }
 
         template <class Vertex, class Graph>
-        void discover_vertex(Vertex, const Graph&)
+        void discover_vertex(Vertex v, const Graph&)
         {
-            ++_comp_size;
+            _reached.push_back(v);
         }
 
     private:
-        size_t& _comp_size;
+        vector<size_t>& _reached;
     };
 
-    // weighted version. Use dijkstra_shortest_paths()
+    // weighted version. Use dijkstra_shortest_paths_no_color_map_no_init(),
+    // with the distances of all vertices but the source already set to
+    // infinity, and put the reached vertices (including the source) in
+    // reached
     struct get_dists_djk
     {
         template <class Graph, class Vertex, class VertexIndex,
                   class DistanceMap, class WeightMap>
         void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
                         DistanceMap dist_map, WeightMap weights,
-                        size_t& comp_size) const
+                        vector<size_t>& reached) const
         {
             using namespace boost;
-            component_djk_visitor vis(comp_size);
-            dijkstra_shortest_paths(g, s, vertex_index_map(vertex_index).
-                                    weight_map(weights).distance_map(dist_map).visitor(vis));
+            typedef typename property_traits<DistanceMap>::value_type dist_t;
+            component_djk_visitor vis(reached);
+            dist_t inf = numeric_limits<dist_t>::max();
+            dijkstra_shortest_paths_no_color_map_no_init
+                (g, s, dummy_property_map(), dist_map, weights, vertex_index,
+                 std::less<dist_t>(), closed_plus<dist_t>(inf), inf, dist_t(0),
+                 vis);
         }
     };
+};
+
+// The k vertices of largest closeness (or harmonic centrality) of an
+// unweighted graph, by the pruned searches of E. Bergamini, M. Borassi,
+// P. Crescenzi, A. Marino and H. Meyerhenke, "Computing top-k closeness
+// centrality faster in unweighted graphs", ALENEX 2016. The vertices are
+// searched in decreasing order of the bound below before the search (which
+// for connected graphs is the order of out-degree), since those tend to have
+// the largest values. After each level of the BFS from a vertex, its final
+// value is bounded by assuming that the rest of the vertices it reaches are as
+// close as possible: at most sum_u (k_u - 1) of them (the out-degrees of the
+// current frontier, minus the edges towards the parents, for undirected
+// graphs) at the next distance, and the others just beyond. The search is abandoned as soon
+// as the bound falls below the k-th largest value found so far.
+//
+// The number of vertices reached is also needed for the bounds. For
+// undirected graphs it is the size of the component; for directed graphs, a
+// lower bound is used for the closeness, which decreases with it, and an upper
+// bound for the harmonic centrality, both obtained from the DAG of the strong
+// components.
+//
+// The searches are run in parallel, sharing the current k-th value. The values
+// are the same as those of get_closeness, and the vertices are returned in
+// decreasing order of value (and of index, for ties), but which of the
+// vertices tied at the k-th value are returned may depend on the number of
+// threads. Vertices that reach no other vertex are not considered for the
+// closeness, since it is not defined for them.
+template <class Graph>
+void top_k_closeness(const Graph& g, size_t k, bool harmonic, bool norm,
+                     vector<size_t>& top, vector<double>& vals)
+{
+    size_t N = num_vertices(g);
+    size_t HN = HardNumVertices()(g);
+    bool directed = graph_tool::is_directed(g);
 
-    template <class DistMap>
-    class component_bfs_visitor: public boost::bfs_visitor<>
+    // bounds on the number of vertices reached from each component (indexed
+    // by its representative vertex)
+    vector<size_t> rep, reach_lo(N, 0), reach_hi;
+    if (directed)
+        parallel_strong_components(g, rep);
+    else
+        parallel_connected_components(g, rep);
+    for (auto v : vertices_range(g))
+        ++reach_lo[rep[v]];
+    reach_hi = reach_lo;
+
+    if (directed)
     {
-    public:
-        //component_visitor() { }
-        component_bfs_visitor(DistMap dist_map, size_t& comp_size)
-            : _dist_map(dist_map), _comp_size(comp_size) { }
+        // over the DAG of the strong components, in reverse topological
+        // order: at least the size of the component plus the largest lower
+        // bound of its successors, and at most the size plus the sum of their
+        // upper bounds
+        vector<vector<size_t>> out(N);
+        vector<size_t> in_deg(N, 0);
+        for (auto e : edges_range(g))
+        {
+            size_t cs = rep[source(e, g)], ct = rep[target(e, g)];
+            if (cs == ct)
+                continue;
+            out[cs].push_back(ct);
+            ++in_deg[ct];
+        }
 
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex, const Graph&)
+        vector<size_t> topo;
+        for (auto v : vertices_range(g))
+        {
+            if (rep[v] == v && in_deg[v] == 0)
+                topo.push_back(v);
+        }
+        for (size_t i = 0; i < topo.size(); ++i)
         {
-            ++_comp_size;
+            for (auto c : out[topo[i]])
+            {
+                if (--in_deg[c] == 0)
+                    topo.push_back(c);
+            }
         }
 
-        template <class Edge, class Graph>
-        void tree_edge(Edge e, const Graph& g)
+        for (auto iter = topo.rbegin(); iter != topo.rend(); ++iter)
         {
-            _dist_map[target(e, g)] = _dist_map[source(e, g)] + 1;
+            size_t c = *iter;
+            auto& cs = out[c];
+            std::sort(cs.begin(), cs.end());
+            cs.erase(std::unique(cs.begin(), cs.end()), cs.end());
+            size_t lo = 0, hi = reach_hi[c];
+            for (auto c2 : cs)
+            {
+                lo = std::max(lo, reach_lo[c2]);
+                hi = std::min(hi + reach_hi[c2], HN);
+            }
+            reach_lo[c] += lo;
+            reach_hi[c] = hi;
         }
+    }
 
-    private:
-        DistMap _dist_map;
-        size_t& _comp_size;
-    };
+    // upper bound of the value of a vertex with reach bounds r_lo and r_hi,
+    // after the BFS has found n vertices up to distance d, with a sum S of
+    // the distances (and H of their inverses), and with a next level of at
+    // most gamma vertices
+    auto bound = [&](size_t n, size_t S, double H, size_t d, size_t gamma,
+                     size_t r_lo, size_t r_hi)
+        {
+            size_t R = harmonic ? r_hi : std::max(r_lo, n);
+            size_t m = (R > n) ? R - n : 0;
+            size_t m1 = std::min(gamma, m), m2 = m - m1;
+            if (harmonic)
+            {
+                double b = H + m1 / double(d + 1) + m2 / double(d + 2);
+                return norm ? b / (HN - 1) : b;
+            }
+            double f = S + double(d + 1) * m1 + double(d + 2) * m2;
+            if (f == 0)
+                return numeric_limits<double>::infinity();
+            return norm ? (R - 1) / f : 1. / f;
+        };
+
+    // the vertices are searched in decreasing order of their bound before
+    // the search, and of out-degree
+    vector<size_t> order;
+    vector<double> b0(N);
+    for (auto v : vertices_range(g))
+    {
+        order.push_back(v);
+        b0[v] = bound(1, 0, 0, 0, out_degree(v, g), reach_lo[rep[v]],
+                      reach_hi[rep[v]]);
+    }
+    std::sort(order.begin(), order.end(),
+              [&](size_t u, size_t v)
+              {
+                  if (b0[u] != b0[v])
+                      return b0[u] > b0[v];
+                  auto ku = out_degree(vertex(u, g), g);
+                  auto kv = out_degree(vertex(v, g), g);
+                  return ku > kv || (ku == kv && u < v);
+              });
+
+    // min-heap of the k largest values found so far
+    auto cmp = [](const pair<double, size_t>& a, const pair<double, size_t>& b)
+        {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        };
+    vector<pair<double, size_t>> heap;
+    std::atomic<double> kth(-numeric_limits<double>::infinity());
 
+    auto value = [&](size_t n, size_t S, double H)
+        {
+            if (harmonic)
+                return norm ? H / (HN - 1) : H;
+            return norm ? (n - 1) / double(S) : 1. / S;
+        };
 
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
     {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS, size_t& comp_size) const
+        vector<size_t> mark(N, 0), frontier, next;
+        size_t stamp = 0;
+
+        #pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < order.size(); ++i)
         {
-            using namespace boost;
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef gt_hash_map<vertex_t,default_color_type,
-                                DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-            component_bfs_visitor<DistanceMap> vis(dist_map, comp_size);
-            breadth_first_visit(g, s, visitor(vis).
-                                color_map(color_map));
+            size_t s = order[i];
+            ++stamp;
+            mark[s] = stamp;
+            frontier.assign(1, s);
+
+            size_t n = 1, S = 0, d = 0;
+            double H = 0;
+            size_t r_lo = reach_lo[rep[s]], r_hi = reach_hi[rep[s]];
+            bool pruned = false;
+            while (!frontier.empty())
+            {
+                double t = kth.load(std::memory_order_relaxed);
+                if (t > -numeric_limits<double>::infinity())
+                {
+                    size_t gamma = 0;
+                    for (auto u : frontier)
+                    {
+                        size_t ku = out_degree(vertex(u, g), g);
+                        gamma += (!directed && d > 0 && ku > 0) ? ku - 1 : ku;
+                    }
+
+                    if (bound(n, S, H, d, gamma, r_lo, r_hi) < t)
+                    {
+                        pruned = true;
+                        break;
+                    }
+                }
+
+                ++d;
+                next.clear();
+                for (auto u : frontier)
+                {
+                    for (auto w : out_neighbors_range(vertex(u, g), g))
+                    {
+                        if (mark[w] == stamp)
+                            continue;
+                        mark[w] = stamp;
+                        next.push_back(w);
+                    }
+                }
+                n += next.size();
+                S += d * next.size();
+                H += next.size() / double(d);
+                frontier.swap(next);
+            }
+
+            if (pruned || n == 1)
+                continue;
+
+            double c = value(n, S, H);
+            if (c < kth.load(std::memory_order_relaxed))
+                continue;
+
+            #pragma omp critical (top_k_closeness)
+            {
+                heap.emplace_back(c, s);
+                std::push_heap(heap.begin(), heap.end(), cmp);
+                if (heap.size() > k)
+                {
+                    std::pop_heap(heap.begin(), heap.end(), cmp);
+                    heap.pop_back();
+                }
+                if (heap.size() == k)
+                    kth = heap.front().first;
+            }
         }
-    };
-};
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), cmp);
+    top.clear();
+    vals.clear();
+    for (auto& x : heap)
+    {
+        top.push_back(x.second);
+        vals.push_back(x.first);
+    }
+}
 
 } // boost namespace
 
@@ -0,0 +1,70 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CONVERGENCE_TRACE_HH
+#define GRAPH_CONVERGENCE_TRACE_HH
+
+#include <chrono>
+#include <cstddef>
+
+namespace graph_tool
+{
+
+// Optional record of the convergence of an iterative centrality solver. For
+// each iteration (or restart cycle, for the Krylov solvers) a row is written
+// with the residual, the wall time since the start of the solver, in seconds,
+// and the number of edges processed so far. The rows go into a (n, 3) array
+// allocated in advance by the caller, so that recording costs only a few
+// stores, and nothing at all if the array is empty. Iterations beyond the
+// capacity of the array are not recorded.
+class convergence_trace
+{
+public:
+    convergence_trace()
+        : _data(nullptr), _capacity(0), _n(0), _E(0) {}
+
+    // E is the number of edges processed by a single pass of the solver
+    convergence_trace(double* data, size_t capacity, size_t E)
+        : _data(data), _capacity(capacity), _n(0), _E(E),
+          _start(std::chrono::steady_clock::now()) {}
+
+    // records the residual after a total of n_pass passes over the edges
+    void operator()(double residual, size_t n_pass)
+    {
+        if (_n >= _capacity)
+            return;
+        std::chrono::duration<double> t =
+            std::chrono::steady_clock::now() - _start;
+        double* row = _data + 3 * _n++;
+        row[0] = residual;
+        row[1] = t.count();
+        row[2] = double(n_pass) * _E;
+    }
+
+    size_t size() const { return _n; }
+
+private:
+    double* _data;
+    size_t _capacity;
+    size_t _n;
+    size_t _E;
+    std::chrono::steady_clock::time_point _start;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_CONVERGENCE_TRACE_HH
@@ -21,13 +21,15 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 #include "graph_eigentrust.hh"
 
 using namespace std;
 using namespace graph_tool;
 
 size_t eigentrust(GraphInterface& g, boost::any c, boost::any t,
-                  double epslon, size_t max_iter)
+                  double epslon, size_t max_iter,
+                  boost::python::object otrace)
 {
     if (!belongs<writable_edge_scalar_properties>()(c))
         throw ValueException("edge property must be writable");
@@ -35,11 +37,15 @@ size_t eigentrust(GraphInterface& g, boost::any c, boost::any t,
         throw ValueException("vertex property must be of floating point"
                              " value type");
 
+    auto atrace = get_array<double, 2>(otrace);
+    convergence_trace trace(atrace.data(), atrace.shape()[0],
+                            g.get_num_edges());
+
     size_t iter = 0;
     run_action<>()
         (g, bind(get_eigentrust(),
                  _1, g.get_vertex_index(), g.get_edge_index(), _2,
-                 _3, epslon, max_iter, ref(iter)),
+                 _3, epslon, max_iter, ref(iter), ref(trace)),
          writable_edge_scalar_properties(),
          vertex_floating_properties())(c,t);
     return iter;
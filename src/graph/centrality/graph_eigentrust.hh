@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_convergence_trace.hh"
 
 namespace graph_tool
 {
@@ -33,7 +34,8 @@ struct get_eigentrust
               class InferredTrustMap>
     void operator()(Graph& g, VertexIndex vertex_index,
                     EdgeIndex edge_index, TrustMap c, InferredTrustMap t,
-                    double epslon, size_t max_iter, size_t& iter) const
+                    double epslon, size_t max_iter, size_t& iter,
+                    convergence_trace& trace) const
     {
         using namespace boost;
         typedef typename property_traits<TrustMap>::value_type c_type;
@@ -107,6 +109,7 @@ struct get_eigentrust
             swap(t_temp, t);
 
             ++iter;
+            trace(delta, iter);
             if (max_iter > 0 && iter== max_iter)
                 break;
         }
@@ -17,15 +17,19 @@
 
 #include "graph_filtering.hh"
 
+#include <boost/python.hpp>
+
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 #include "graph_eigenvector.hh"
 
 using namespace std;
 using namespace graph_tool;
 
 long double eigenvector(GraphInterface& g, boost::any w, boost::any c,
-                        double epsilon, size_t max_iter)
+                        double epsilon, size_t max_iter,
+                        boost::python::object otrace)
 {
     if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
         throw ValueException("edge property must be writable");
@@ -40,20 +44,65 @@ long double eigenvector(GraphInterface& g, boost::any w, boost::any c,
     if(w.empty())
         w = weight_map_t();
 
+    auto atrace = get_array<double, 2>(otrace);
+    convergence_trace trace(atrace.data(), atrace.shape()[0],
+                            g.get_num_edges());
+
     long double eig = 0;
     run_action<>()
         (g, std::bind(get_eigenvector(), std::placeholders::_1, g.get_vertex_index(),
                       std::placeholders::_2, std::placeholders::_3, epsilon, max_iter,
-                      std::ref(eig)),
+                      std::ref(eig), std::ref(trace)),
          weight_props_t(),
          vertex_floating_properties())(w, c);
     return eig;
 }
 
-#include <boost/python.hpp>
+boost::python::object eigenvector_krylov(GraphInterface& g, boost::any w,
+                                         boost::any c, double epsilon,
+                                         size_t max_iter, size_t k,
+                                         boost::python::object otrace)
+{
+    if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
+        throw ValueException("edge property must be writable");
+    if (!belongs<vertex_floating_properties>()(c))
+        throw ValueException("vertex property must be of floating point"
+                             " value type");
+    if (k == 0)
+        throw ValueException("the number of eigenvectors must be positive");
+
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<writable_edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if(w.empty())
+        w = weight_map_t();
+
+    auto atrace = get_array<double, 2>(otrace);
+    convergence_trace trace(atrace.data(), atrace.shape()[0],
+                            g.get_num_edges());
+
+    vector<double> evals;
+    vector<vector<double>> evecs;
+    size_t n_matvec = 0;
+    run_action<>()
+        (g, std::bind(get_eigenvector_krylov(), std::placeholders::_1,
+                      std::placeholders::_2, std::placeholders::_3, epsilon,
+                      max_iter, k, std::ref(evals), std::ref(evecs),
+                      std::ref(n_matvec), std::ref(trace)),
+         weight_props_t(),
+         vertex_floating_properties())(w, c);
+
+    vector<double> vecs;
+    for (auto& y : evecs)
+        vecs.insert(vecs.end(), y.begin(), y.end());
+    return boost::python::make_tuple(wrap_vector_owned(evals),
+                                     wrap_vector_owned(vecs), n_matvec);
+}
 
 void export_eigenvector()
 {
     using namespace boost::python;
     def("get_eigenvector", &eigenvector);
+    def("get_eigenvector_krylov", &eigenvector_krylov);
 }
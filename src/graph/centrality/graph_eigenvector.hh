@@ -21,6 +21,9 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_spmv.hh"
+#include "graph_krylov.hh"
+#include "graph_convergence_trace.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -44,7 +47,7 @@ struct get_eigenvector
               class CentralityMap>
     void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
                     CentralityMap c, double epsilon, size_t max_iter,
-                    long double& eig) const
+                    long double& eig, convergence_trace& trace) const
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
@@ -93,6 +96,7 @@ struct get_eigenvector
             swap(c_temp, c);
 
             ++iter;
+            trace(delta, iter);
             if (max_iter > 0 && iter == max_iter)
                 break;
             if (max_iter == 0 && delta >= prev_delta && iter > 100)
@@ -100,12 +104,92 @@ struct get_eigenvector
         }
 
         if (iter % 2 != 0)
-            parallel_vertex_loop(g, [&](auto v) { c[v] = c_temp[v]; });
+            parallel_vertex_loop(g, [&](auto v) { c_temp[v] = c[v]; });
 
         eig = norm;
     }
 };
 
+// Eigenvector centrality by Krylov methods instead of power iteration, with
+// spmv_kernel for the products: thick-restart Lanczos for undirected graphs,
+// which can also give the k leading eigenpairs, and Arnoldi otherwise (for the
+// leading one only). The values in c are used as the starting vector, and are
+// replaced by the leading eigenvector. The eigenvectors are normalized, with
+// non-negative sums. The number of products is put in n_matvec.
+struct get_eigenvector_krylov
+{
+    template <class Graph, class WeightMap, class CentralityMap>
+    void operator()(Graph& g, WeightMap w, CentralityMap c, double epsilon,
+                    size_t max_iter, size_t k, vector<double>& evals,
+                    vector<vector<double>>& evecs, size_t& n_matvec,
+                    convergence_trace& trace) const
+    {
+        if (num_vertices(g) <= numeric_limits<uint32_t>::max())
+            run<uint32_t>(g, w, c, epsilon, max_iter, k, evals, evecs,
+                          n_matvec, trace);
+        else
+            run<size_t>(g, w, c, epsilon, max_iter, k, evals, evecs,
+                        n_matvec, trace);
+    }
+
+    template <class Index, class Graph, class WeightMap, class CentralityMap>
+    void run(Graph& g, WeightMap w, CentralityMap c, double epsilon,
+             size_t max_iter, size_t k, vector<double>& evals,
+             vector<vector<double>>& evecs, size_t& n_matvec,
+             convergence_trace& trace) const
+    {
+        constexpr bool constant_weight =
+            is_constant_property<WeightMap>::type::value;
+        spmv_kernel<Index, double, constant_weight> kernel(g, w);
+        auto matvec = [&](const vector<double>& x, vector<double>& y)
+            {
+                kernel.multiply(x, y);
+            };
+
+        size_t N = num_vertices(g);
+        vector<double> x(N, 0);
+        bool zero = true;
+        for (auto v : vertices_range(g))
+        {
+            x[v] = get(c, v);
+            if (x[v] != 0)
+                zero = false;
+        }
+        if (zero)
+        {
+            for (auto v : vertices_range(g))
+                x[v] = 1;
+        }
+
+        size_t m = std::max(size_t(20), 2 * k + 1);
+        if (graph_tool::is_directed(g))
+        {
+            double eval;
+            n_matvec = krylov_eig(matvec, x, m, epsilon, max_iter, eval,
+                                  trace);
+            evals = {eval};
+            evecs.clear();
+            evecs.push_back(std::move(x));
+        }
+        else
+        {
+            n_matvec = symmetric_krylov_eigs(matvec, x, k, m, epsilon,
+                                             max_iter, evals, evecs, trace);
+        }
+
+        for (auto& y : evecs)
+        {
+            double sum = 0;
+            for (auto v : vertices_range(g))
+                sum += y[v];
+            if (sum < 0)
+                krylov::scale(-1, y);
+        }
+
+        parallel_vertex_loop(g, [&](auto v) { c[v] = evecs[0][v]; });
+    }
+};
+
 }
 
 #endif
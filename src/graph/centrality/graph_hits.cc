@@ -21,6 +21,7 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 #include "graph_hits.hh"
 
 using namespace std;
@@ -33,14 +34,25 @@ struct get_hits_dispatch
               class CentralityMap>
     void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
                     CentralityMap x, boost::any ay, double epsilon,
-                    size_t max_iter, long double& eig) const
+                    size_t max_iter, bool krylov, long double& eig,
+                    convergence_trace& trace) const
     {
         try
         {
             typename CentralityMap::checked_t y = any_cast<typename CentralityMap::checked_t>(ay);
-            get_hits()(g, vertex_index, w, x,
-                       y.get_unchecked(num_vertices(g)), epsilon, max_iter,
-                       eig);
+            if (krylov)
+            {
+                size_t n_matvec;
+                get_hits_krylov()(g, vertex_index, w, x,
+                                  y.get_unchecked(num_vertices(g)), epsilon,
+                                  max_iter, eig, n_matvec, trace);
+            }
+            else
+            {
+                get_hits()(g, vertex_index, w, x,
+                           y.get_unchecked(num_vertices(g)), epsilon, max_iter,
+                           eig, trace);
+            }
         }
         catch (bad_any_cast&)
         {
@@ -51,7 +63,8 @@ struct get_hits_dispatch
 
 
 long double hits(GraphInterface& g, boost::any w, boost::any x, boost::any y,
-                 double epsilon, size_t max_iter)
+                 double epsilon, size_t max_iter, bool krylov,
+                 python::object otrace)
 {
     if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
         throw ValueException("edge property must be writable");
@@ -66,11 +79,15 @@ long double hits(GraphInterface& g, boost::any w, boost::any x, boost::any y,
     if(w.empty())
         w = weight_map_t();
 
+    auto atrace = get_array<double, 2>(otrace);
+    convergence_trace trace(atrace.data(), atrace.shape()[0],
+                            g.get_num_edges());
+
     long double eig = 0;
     run_action<>()
         (g, std::bind(get_hits_dispatch(), std::placeholders::_1, g.get_vertex_index(),
                       std::placeholders::_2,  std::placeholders::_3, y, epsilon, max_iter,
-                      std::ref(eig)),
+                      krylov, std::ref(eig), std::ref(trace)),
          weight_props_t(),
          vertex_floating_properties())(w, x);
     return eig;
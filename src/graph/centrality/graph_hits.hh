@@ -15,12 +15,15 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef GRAPH_EIGENVECTOR_HH
-#define GRAPH_EIGENVECTOR_HH
+#ifndef GRAPH_HITS_HH
+#define GRAPH_HITS_HH
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_spmv.hh"
+#include "graph_krylov.hh"
+#include "graph_convergence_trace.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -44,7 +47,8 @@ struct get_hits
               class CentralityMap>
     void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
                     CentralityMap x, CentralityMap y, double epsilon,
-                    size_t max_iter, long double& eig) const
+                    size_t max_iter, long double& eig,
+                    convergence_trace& trace) const
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
@@ -117,6 +121,7 @@ struct get_hits
             swap(y_temp, y);
 
             ++iter;
+            trace(delta, 2 * iter);
             if (max_iter > 0 && iter== max_iter)
                 break;
         }
@@ -136,6 +141,94 @@ struct get_hits
     }
 };
 
+// HITS by the thick-restart Lanczos method for the leading eigenvector of the
+// symmetric matrix A A^T (the hub centralities y), with spmv_kernel over the
+// in- and out-edges for the products, instead of power iteration. The
+// authority centralities are x = A^T y, normalized, and eig is the largest
+// singular value. The number of products (one for each of A and A^T) is put
+// in n_matvec.
+struct get_hits_krylov
+{
+    template <class Graph, class VertexIndex, class WeightMap,
+              class CentralityMap>
+    void operator()(Graph& g, VertexIndex, WeightMap w, CentralityMap x,
+                    CentralityMap y, double epsilon, size_t max_iter,
+                    long double& eig, size_t& n_matvec,
+                    convergence_trace& trace) const
+    {
+        if (num_vertices(g) <= numeric_limits<uint32_t>::max())
+            run<uint32_t>(g, w, x, y, epsilon, max_iter, eig, n_matvec,
+                          trace);
+        else
+            run<size_t>(g, w, x, y, epsilon, max_iter, eig, n_matvec,
+                        trace);
+    }
+
+    template <class Index, class Graph, class WeightMap, class CentralityMap>
+    void run(Graph& g, WeightMap w, CentralityMap x, CentralityMap y,
+             double epsilon, size_t max_iter, long double& eig,
+             size_t& n_matvec, convergence_trace& trace) const
+    {
+        constexpr bool constant_weight =
+            is_constant_property<WeightMap>::type::value;
+        spmv_kernel<Index, double, constant_weight> in_kernel(g, w),
+            out_kernel(g, w, true);
+
+        size_t N = num_vertices(g);
+        vector<double> t(N), y0(N, 0);
+        auto matvec = [&](const vector<double>& a, vector<double>& b)
+            {
+                in_kernel.multiply(a, t);
+                out_kernel.multiply(t, b);
+            };
+
+        bool empty = true;
+        for (auto v : vertices_range(g))
+        {
+            y0[v] = 1;
+            empty = false;
+        }
+
+        // as with power iteration, a graph without vertices gives eig = 0 and
+        // leaves the centrality maps untouched
+        if (empty)
+        {
+            eig = 0;
+            n_matvec = 0;
+            return;
+        }
+
+        vector<double> evals;
+        vector<vector<double>> evecs;
+        // each product is a pass over the in- and the out-edges
+        auto report = [&](double res, size_t n) { trace(res, 2 * n); };
+        n_matvec = 2 * symmetric_krylov_eigs(matvec, y0, 1, 20, epsilon,
+                                             max_iter / 2, evals, evecs,
+                                             report);
+        auto& yv = evecs[0];
+
+        double sum = 0;
+        for (auto v : vertices_range(g))
+            sum += yv[v];
+        if (sum < 0)
+            krylov::scale(-1, yv);
+
+        in_kernel.multiply(yv, t);
+        double norm = sqrt(krylov::dot(t, t));
+        if (norm > 0)
+            krylov::scale(1. / norm, t);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 x[v] = t[v];
+                 y[v] = yv[v];
+             });
+        eig = norm;
+    }
+};
+
 }
 
 #endif
@@ -21,6 +21,7 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 #include "graph_katz.hh"
 
 using namespace std;
@@ -28,7 +29,8 @@ using namespace boost;
 using namespace graph_tool;
 
 void katz(GraphInterface& g, boost::any w, boost::any c, boost::any beta,
-          long double alpha, double epsilon, size_t max_iter)
+          long double alpha, double epsilon, size_t max_iter, bool krylov,
+          python::object otrace)
 {
     if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
         throw ValueException("edge property must be writable");
@@ -53,16 +55,80 @@ void katz(GraphInterface& g, boost::any w, boost::any c, boost::any beta,
     if(beta.empty())
         beta = beta_map_t();
 
+    auto atrace = get_array<double, 2>(otrace);
+    convergence_trace trace(atrace.data(), atrace.shape()[0],
+                            g.get_num_edges());
+
+    if (krylov)
+    {
+        size_t n_matvec;
+        run_action<>()(g, std::bind(get_katz_krylov(), std::placeholders::_1,
+                                    g.get_vertex_index(), std::placeholders::_2,
+                                    std::placeholders::_3, std::placeholders::_4,
+                                    alpha, epsilon, max_iter, std::ref(n_matvec),
+                                    std::ref(trace)),
+                       weight_props_t(),
+                       vertex_floating_properties(),
+                       beta_props_t())(w, c, beta);
+        return;
+    }
+
     run_action<>()(g, std::bind(get_katz(), std::placeholders::_1, g.get_vertex_index(),
                                 std::placeholders::_2, std::placeholders::_3,
-                                std::placeholders::_4, alpha, epsilon, max_iter),
+                                std::placeholders::_4, alpha, epsilon, max_iter,
+                                std::ref(trace)),
+                   weight_props_t(),
+                   vertex_floating_properties(),
+                   beta_props_t())(w, c, beta);
+}
+
+size_t katz_update(GraphInterface& g, boost::any w, boost::any c,
+                   boost::any beta, long double alpha, double epsilon,
+                   python::object ochanged)
+{
+    if (!w.empty() && !belongs<writable_edge_scalar_properties>()(w))
+        throw ValueException("edge property must be writable");
+    if (!belongs<vertex_floating_properties>()(c))
+        throw ValueException("centrality vertex property must be of floating point"
+                             " value type");
+    if (!beta.empty() && !belongs<vertex_floating_properties>()(beta))
+        throw ValueException("personalization vertex property must be of floating point"
+                             " value type");
+
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<writable_edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if(w.empty())
+        w = weight_map_t();
+
+    typedef UnityPropertyMap<int,GraphInterface::vertex_t> beta_map_t;
+    typedef boost::mpl::push_back<vertex_floating_properties, beta_map_t>::type
+        beta_props_t;
+
+    if(beta.empty())
+        beta = beta_map_t();
+
+    auto achanged = get_array<int64_t, 1>(ochanged);
+    vector<size_t> changed(achanged.begin(), achanged.end());
+
+    // the per-vertex threshold bounds the total residual by epsilon
+    double eps = epsilon / std::max(g.get_num_vertices(), size_t(1));
+
+    size_t n_pushes = 0;
+    run_action<>()(g, std::bind(get_katz_update(), std::placeholders::_1,
+                                std::placeholders::_2, std::placeholders::_3,
+                                std::placeholders::_4, alpha, eps,
+                                std::cref(changed), std::ref(n_pushes)),
                    weight_props_t(),
                    vertex_floating_properties(),
                    beta_props_t())(w, c, beta);
+    return n_pushes;
 }
 
 void export_katz()
 {
     using namespace boost::python;
     def("get_katz", &katz);
+    def("get_katz_update", &katz_update);
 }
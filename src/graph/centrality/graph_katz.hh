@@ -15,12 +15,16 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#ifndef GRAPH_EIGENVECTOR_HH
-#define GRAPH_EIGENVECTOR_HH
+#ifndef GRAPH_KATZ_HH
+#define GRAPH_KATZ_HH
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_push_update.hh"
+#include "graph_spmv.hh"
+#include "graph_krylov.hh"
+#include "graph_convergence_trace.hh"
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -44,7 +48,8 @@ struct get_katz
               class CentralityMap, class PersonalizationMap>
     void operator()(Graph& g, VertexIndex vertex_index, WeightMap w,
                     CentralityMap c, PersonalizationMap beta, long double alpha,
-                    long double epsilon, size_t max_iter) const
+                    long double epsilon, size_t max_iter,
+                    convergence_trace& trace) const
     {
         typedef typename property_traits<CentralityMap>::value_type t_type;
 
@@ -76,6 +81,7 @@ struct get_katz
             swap(c_temp, c);
 
             ++iter;
+            trace(delta, iter);
             if (max_iter > 0 && iter == max_iter)
                 break;
         }
@@ -87,6 +93,97 @@ struct get_katz
     }
 };
 
+// Katz centrality as the solution of the linear system (I - alpha A^T) c =
+// beta, by restarted GMRES with spmv_kernel for the products, instead of the
+// fixed-point iteration. The values in c are used as the starting point. The
+// iteration stops when the norm of the residual is below epsilon, and the
+// number of products is put in n_matvec.
+struct get_katz_krylov
+{
+    template <class Graph, class VertexIndex, class WeightMap,
+              class CentralityMap, class PersonalizationMap>
+    void operator()(Graph& g, VertexIndex, WeightMap w, CentralityMap c,
+                    PersonalizationMap beta, long double alpha,
+                    long double epsilon, size_t max_iter,
+                    size_t& n_matvec, convergence_trace& trace) const
+    {
+        if (num_vertices(g) <= numeric_limits<uint32_t>::max())
+            run<uint32_t>(g, w, c, beta, alpha, epsilon, max_iter, n_matvec,
+                          trace);
+        else
+            run<size_t>(g, w, c, beta, alpha, epsilon, max_iter, n_matvec,
+                        trace);
+    }
+
+    template <class Index, class Graph, class WeightMap, class CentralityMap,
+              class PersonalizationMap>
+    void run(Graph& g, WeightMap w, CentralityMap c, PersonalizationMap beta,
+             double alpha, double epsilon, size_t max_iter,
+             size_t& n_matvec, convergence_trace& trace) const
+    {
+        constexpr bool constant_weight =
+            is_constant_property<WeightMap>::type::value;
+        spmv_kernel<Index, double, constant_weight> kernel(g, w);
+
+        size_t N = num_vertices(g);
+        vector<double> b(N, 0), x(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 b[v] = get(beta, v);
+                 x[v] = c[v];
+             });
+
+        auto matvec = [&](const vector<double>& a, vector<double>& y)
+            {
+                kernel.multiply(a, y);
+                #pragma omp parallel for if (N > OPENMP_MIN_THRESH) \
+                    schedule(static)
+                for (size_t i = 0; i < N; ++i)
+                    y[i] = a[i] - alpha * y[i];
+            };
+
+        n_matvec = gmres(matvec, b, x, 30, epsilon, max_iter, trace);
+
+        parallel_vertex_loop(g, [&](auto v) { c[v] = x[v]; });
+    }
+};
+
+// Incremental update of a previous (unnormalized) Katz solution in c, after
+// the edges between the given pairs of vertices were added or removed, by
+// pushing the residuals of the affected vertices.
+struct get_katz_update
+{
+    template <class Graph, class WeightMap, class CentralityMap,
+              class PersonalizationMap>
+    void operator()(Graph& g, WeightMap w, CentralityMap c,
+                    PersonalizationMap beta, long double alpha,
+                    double epsilon, const vector<size_t>& changed,
+                    size_t& n_pushes) const
+    {
+        auto residual = [&](size_t v)
+            {
+                double r = get(beta, v);
+                for (const auto& e : in_or_out_edges_range(vertex(v, g), g))
+                {
+                    auto s = graph_tool::is_directed(g) ? source(e, g) :
+                        target(e, g);
+                    r += alpha * get(w, e) * c[s];
+                }
+                return r - c[v];
+            };
+
+        auto scale = [&](size_t) { return double(alpha); };
+        auto weight = [&](const auto& e) { return double(get(w, e)); };
+
+        vector<size_t> affected;
+        push_update_affected(g, changed, affected);
+        n_pushes = push_update(g, c, affected, residual, scale, weight,
+                               epsilon);
+    }
+};
+
 }
 
 #endif
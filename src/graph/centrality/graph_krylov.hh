@@ -0,0 +1,623 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_KRYLOV_HH
+#define GRAPH_KRYLOV_HH
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <random>
+#include <cmath>
+
+#include "graph_util.hh"
+
+// Krylov subspace methods for the spectral centralities, on operators given
+// by a function matvec(x, y), which sets y = A x for vectors of size N. Only
+// a few vectors of size N are kept, and all the work on the graph happens in
+// matvec, so that the number of passes over the graph is the number of calls
+// to it, which is what the functions below return.
+
+namespace graph_tool
+{
+using namespace std;
+
+namespace krylov
+{
+
+inline double dot(const vector<double>& x, const vector<double>& y)
+{
+    size_t N = x.size();
+    double d = 0;
+    #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(static) \
+        reduction(+:d)
+    for (size_t i = 0; i < N; ++i)
+        d += x[i] * y[i];
+    return d;
+}
+
+// y += a x
+inline void axpy(double a, const vector<double>& x, vector<double>& y)
+{
+    size_t N = x.size();
+    #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(static)
+    for (size_t i = 0; i < N; ++i)
+        y[i] += a * x[i];
+}
+
+inline void scale(double a, vector<double>& x)
+{
+    size_t N = x.size();
+    #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(static)
+    for (size_t i = 0; i < N; ++i)
+        x[i] *= a;
+}
+
+// Orthogonalizes w against V[0], ..., V[j] by classical Gram-Schmidt, done
+// twice for numerical stability, adding the coefficients to h[0..j]. Returns
+// the norm of what is left of w.
+inline double orthogonalize(const vector<vector<double>>& V, size_t j,
+                            vector<double>& w, double* h)
+{
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        for (size_t i = 0; i <= j; ++i)
+        {
+            double c = dot(V[i], w);
+            h[i] += c;
+            axpy(-c, V[i], w);
+        }
+    }
+    return sqrt(dot(w, w));
+}
+
+// Replaces w by a pseudo-random vector (deterministic, given n), orthogonal
+// to V[0], ..., V[j], and normalized, for when the Krylov subspace becomes
+// invariant. The entries outside the support of the starting vector (e.g. of
+// the vertices filtered out) are kept at zero.
+inline void restart_vector(const vector<vector<double>>& V, size_t j,
+                           size_t n, const vector<uint8_t>& support,
+                           vector<double>& w)
+{
+    std::mt19937_64 rng(n);
+    std::uniform_real_distribution<double> u(-1, 1);
+    for (size_t i = 0; i < w.size(); ++i)
+        w[i] = support[i] ? u(rng) : 0;
+    vector<double> h(j + 1, 0);
+    double beta = orthogonalize(V, j, w, h.data());
+    if (beta > 0)
+        scale(1. / beta, w);
+}
+
+// Eigendecomposition of the symmetric m x m matrix A (row-major) by the
+// cyclic Jacobi method, with the eigenvalues in decreasing order in w, and the
+// corresponding eigenvectors as the columns of Z.
+inline void symmetric_eigen(size_t m, vector<double> A, vector<double>& w,
+                            vector<double>& Z)
+{
+    vector<double> R(m * m, 0);
+    for (size_t i = 0; i < m; ++i)
+        R[i * m + i] = 1;
+
+    for (size_t sweep = 0; sweep < 100; ++sweep)
+    {
+        double off = 0, total = 0;
+        for (size_t i = 0; i < m; ++i)
+        {
+            for (size_t j = 0; j < m; ++j)
+            {
+                double a = A[i * m + j] * A[i * m + j];
+                total += a;
+                if (i != j)
+                    off += a;
+            }
+        }
+        if (off <= total * 1e-32 || off == 0)
+            break;
+
+        for (size_t p = 0; p < m; ++p)
+        {
+            for (size_t q = p + 1; q < m; ++q)
+            {
+                double apq = A[p * m + q];
+                if (apq == 0)
+                    continue;
+                double theta = (A[q * m + q] - A[p * m + p]) / (2 * apq);
+                double t = 1. / (abs(theta) + sqrt(theta * theta + 1));
+                if (theta < 0)
+                    t = -t;
+                double c = 1. / sqrt(t * t + 1), s = t * c;
+
+                auto rotate = [&](double& x, double& y)
+                    {
+                        double xp = x, yq = y;
+                        x = c * xp - s * yq;
+                        y = s * xp + c * yq;
+                    };
+                for (size_t k = 0; k < m; ++k)
+                    rotate(A[k * m + p], A[k * m + q]);
+                for (size_t k = 0; k < m; ++k)
+                    rotate(A[p * m + k], A[q * m + k]);
+                for (size_t k = 0; k < m; ++k)
+                    rotate(R[k * m + p], R[k * m + q]);
+            }
+        }
+    }
+
+    vector<size_t> idx(m);
+    std::iota(idx.begin(), idx.end(), 0);
+    std::sort(idx.begin(), idx.end(),
+              [&](size_t i, size_t j) { return A[i * m + i] > A[j * m + j]; });
+    w.resize(m);
+    Z.resize(m * m);
+    for (size_t i = 0; i < m; ++i)
+    {
+        w[i] = A[idx[i] * m + idx[i]];
+        for (size_t k = 0; k < m; ++k)
+            Z[k * m + i] = R[k * m + idx[i]];
+    }
+}
+
+// Eigenpair of largest real part of the (small, dense, row-major) m x m
+// matrix H, assuming it is real, as for the Perron root of a non-negative
+// matrix. This is done by power iteration of H + sI, with s >= the spectral
+// radius, so that the eigenvalue of largest real part is the largest in
+// magnitude, followed by inverse iteration from the approximate eigenvalue.
+// The eigenvector is put in y, normalized.
+inline double dominant_eigen(size_t m, const vector<double>& H,
+                             vector<double>& y)
+{
+    double s = 0;
+    for (size_t i = 0; i < m; ++i)
+    {
+        double r = 0;
+        for (size_t j = 0; j < m; ++j)
+            r += abs(H[i * m + j]);
+        s = std::max(s, r);
+    }
+
+    auto mult = [&](const vector<double>& x, vector<double>& z)
+        {
+            for (size_t i = 0; i < m; ++i)
+            {
+                z[i] = 0;
+                for (size_t j = 0; j < m; ++j)
+                    z[i] += H[i * m + j] * x[j];
+            }
+        };
+
+    auto normalize = [&](vector<double>& x)
+        {
+            double n = 0;
+            for (auto xi : x)
+                n += xi * xi;
+            n = sqrt(n);
+            if (n > 0)
+                for (auto& xi : x)
+                    xi /= n;
+            return n;
+        };
+
+    y.assign(m, 1);
+    normalize(y);
+    vector<double> z(m);
+    for (size_t iter = 0; iter < 10000; ++iter)
+    {
+        mult(y, z);
+        for (size_t i = 0; i < m; ++i)
+            z[i] += s * y[i];
+        normalize(z);
+        double delta = 0;
+        for (size_t i = 0; i < m; ++i)
+            delta += abs(z[i] - y[i]);
+        y.swap(z);
+        if (delta < 1e-14)
+            break;
+    }
+
+    auto rayleigh = [&]()
+        {
+            mult(y, z);
+            double theta = 0;
+            for (size_t i = 0; i < m; ++i)
+                theta += y[i] * z[i];
+            return theta;
+        };
+
+    double theta = rayleigh();
+    double tiny = std::max(s, 1.) * 1e-14;
+    for (size_t iter = 0; iter < 3; ++iter)
+    {
+        // solve (H - theta I) z = y, by Gaussian elimination with partial
+        // pivoting
+        vector<double> M(H);
+        for (size_t i = 0; i < m; ++i)
+            M[i * m + i] -= theta;
+        z = y;
+        for (size_t c = 0; c < m; ++c)
+        {
+            size_t p = c;
+            for (size_t i = c + 1; i < m; ++i)
+                if (abs(M[i * m + c]) > abs(M[p * m + c]))
+                    p = i;
+            if (p != c)
+            {
+                for (size_t j = 0; j < m; ++j)
+                    std::swap(M[c * m + j], M[p * m + j]);
+                std::swap(z[c], z[p]);
+            }
+            if (abs(M[c * m + c]) < tiny)
+                M[c * m + c] = tiny;
+            for (size_t i = c + 1; i < m; ++i)
+            {
+                double f = M[i * m + c] / M[c * m + c];
+                for (size_t j = c; j < m; ++j)
+                    M[i * m + j] -= f * M[c * m + j];
+                z[i] -= f * z[c];
+            }
+        }
+        for (size_t c = m; c-- > 0;)
+        {
+            for (size_t j = c + 1; j < m; ++j)
+                z[c] -= M[c * m + j] * z[j];
+            z[c] /= M[c * m + c];
+        }
+        if (normalize(z) == 0 || !std::isfinite(z[0]))
+            break;
+        y = z;
+        theta = rayleigh();
+    }
+    return theta;
+}
+
+// Puts V[0..m) Y[:, 0..p) in V[0..p), in place, where Y is m x n row-major.
+inline void rotate_basis(vector<vector<double>>& V, size_t m,
+                         const vector<double>& Y, size_t n, size_t p)
+{
+    size_t N = V[0].size();
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        vector<double> t(p);
+        #pragma omp for schedule(static)
+        for (size_t r = 0; r < N; ++r)
+        {
+            for (size_t i = 0; i < p; ++i)
+            {
+                t[i] = 0;
+                for (size_t l = 0; l < m; ++l)
+                    t[i] += V[l][r] * Y[l * n + i];
+            }
+            for (size_t i = 0; i < p; ++i)
+                V[i][r] = t[i];
+        }
+    }
+}
+
+// default for the optional report(residual, n_matvec) callback of the
+// solvers below, which is called once per restart cycle
+struct no_report
+{
+    void operator()(double, size_t) const {}
+};
+
+} // namespace krylov
+
+// Finds the k eigenpairs of largest eigenvalue of the symmetric operator given
+// by matvec, by the thick-restart Lanczos method (Wu and Simon), which is
+// equivalent to implicitly restarted Lanczos: the Lanczos basis is extended up
+// to m vectors (with full reorthogonalization), and then contracted to the
+// Ritz vectors of the largest Ritz values, plus the last Lanczos vector, from
+// where it is extended again. The iteration stops when the residuals
+// |A y - theta y| of the first k Ritz pairs are below epsilon |theta|, or when
+// max_matvec products were done (if max_matvec > 0). The starting vector is
+// given in x, and the eigenvectors are returned in evecs, normalized, with the
+// eigenvalues in evals, in decreasing order. If x is empty or zero, no
+// eigenpairs are returned.
+template <class MatVec, class Report = krylov::no_report>
+size_t symmetric_krylov_eigs(MatVec&& matvec, const vector<double>& x,
+                             size_t k, size_t m, double epsilon,
+                             size_t max_matvec, vector<double>& evals,
+                             vector<vector<double>>& evecs,
+                             Report&& report = Report())
+{
+    using namespace krylov;
+    size_t N = x.size();
+    double x_norm = sqrt(dot(x, x));
+    if (N == 0 || x_norm == 0)
+    {
+        evals.clear();
+        evecs.clear();
+        return 0;
+    }
+    k = std::min(k, N);
+    m = std::min(std::max(m, 2 * k + 1), N);
+
+    vector<vector<double>> V(m + 1, vector<double>(N, 0));
+    V[0] = x;
+    scale(1. / x_norm, V[0]);
+
+    vector<uint8_t> support(N);
+    for (size_t i = 0; i < N; ++i)
+        support[i] = (x[i] != 0);
+
+    // the projected matrix, with an extra row for the residual couplings
+    vector<double> H((m + 1) * m, 0);
+    vector<double> T(m * m), theta, Y;
+
+    size_t n_matvec = 0, start = 0, stalled = 0;
+    double best = numeric_limits<double>::infinity();
+    while (true)
+    {
+        for (size_t j = start; j < m; ++j)
+        {
+            auto& w = V[j + 1];
+            matvec(V[j], w);
+            ++n_matvec;
+            vector<double> h(j + 1, 0);
+            double beta = orthogonalize(V, j, w, h.data());
+            for (size_t i = 0; i <= j; ++i)
+                H[i * m + j] += h[i];
+            double norm = abs(H[j * m + j]) + beta;
+            if (beta <= norm * 1e-12 || beta == 0)
+            {
+                // invariant subspace: continue in an orthogonal direction
+                restart_vector(V, j, n_matvec, support, w);
+                beta = 0;
+            }
+            else
+            {
+                scale(1. / beta, w);
+            }
+            H[(j + 1) * m + j] = beta;
+        }
+
+        // symmetric projection, from the upper triangle
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = i; j < m; ++j)
+                T[i * m + j] = T[j * m + i] = H[i * m + j];
+        symmetric_eigen(m, T, theta, Y);
+
+        double beta = H[m * m + m - 1];
+        double res = 0;
+        for (size_t i = 0; i < k; ++i)
+        {
+            double r = abs(beta * Y[(m - 1) * m + i]);
+            res = std::max(res, r / std::max(abs(theta[i]), 1e-300));
+        }
+        report(res, n_matvec);
+
+        if (res < best)
+        {
+            best = res;
+            stalled = 0;
+        }
+        else
+        {
+            ++stalled;
+        }
+
+        bool done = (res <= epsilon || (max_matvec > 0 && n_matvec >= max_matvec)
+                     || m == N || stalled > 20);
+
+        // keep more Ritz vectors than requested, to accelerate convergence
+        size_t p = done ? k : std::min(std::max(k + (m - k) / 2, k), m - 1);
+        rotate_basis(V, m, Y, m, p);
+        if (done)
+            break;
+
+        V[p].swap(V[m]);
+        std::fill(H.begin(), H.end(), 0);
+        for (size_t i = 0; i < p; ++i)
+        {
+            H[i * m + i] = theta[i];
+            H[p * m + i] = beta * Y[(m - 1) * m + i];
+        }
+        start = p;
+    }
+
+    evals.assign(theta.begin(), theta.begin() + k);
+    evecs.assign(V.begin(), V.begin() + k);
+    return n_matvec;
+}
+
+// Finds the eigenpair of largest real part of a general (non-symmetric)
+// operator given by matvec, assuming it is real, as for the Perron root of a
+// non-negative matrix, by the Arnoldi method with explicit restarts from the
+// current Ritz vector. The starting vector is given in x, which is replaced by
+// the eigenvector, normalized; if x is empty or zero, it is left unchanged,
+// with eval = 0. The remaining parameters are as in symmetric_krylov_eigs().
+template <class MatVec, class Report = krylov::no_report>
+size_t krylov_eig(MatVec&& matvec, vector<double>& x, size_t m,
+                  double epsilon, size_t max_matvec, double& eval,
+                  Report&& report = Report())
+{
+    using namespace krylov;
+    size_t N = x.size();
+    double x_norm = sqrt(dot(x, x));
+    if (N == 0 || x_norm == 0)
+    {
+        eval = 0;
+        return 0;
+    }
+    m = std::min(std::max(m, size_t(2)), N);
+
+    vector<vector<double>> V(m + 1, vector<double>(N, 0));
+    V[0] = x;
+    scale(1. / x_norm, V[0]);
+
+    vector<double> H((m + 1) * m), Hm(m * m), y;
+
+    size_t n_matvec = 0, stalled = 0;
+    double best = numeric_limits<double>::infinity();
+    while (true)
+    {
+        std::fill(H.begin(), H.end(), 0);
+        size_t n = m;
+        for (size_t j = 0; j < m; ++j)
+        {
+            auto& w = V[j + 1];
+            matvec(V[j], w);
+            ++n_matvec;
+            vector<double> h(j + 1, 0);
+            double beta = orthogonalize(V, j, w, h.data());
+            for (size_t i = 0; i <= j; ++i)
+                H[i * m + j] = h[i];
+            H[(j + 1) * m + j] = beta;
+            double norm = abs(H[j * m + j]) + beta;
+            if (beta <= norm * 1e-12 || beta == 0)
+            {
+                // invariant subspace, containing the eigenvector
+                H[(j + 1) * m + j] = 0;
+                n = j + 1;
+                break;
+            }
+            scale(1. / beta, w);
+        }
+
+        Hm.resize(n * n);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                Hm[i * n + j] = H[i * m + j];
+        eval = dominant_eigen(n, Hm, y);
+
+        double res = abs(H[n * m + n - 1] * y[n - 1]) /
+            std::max(abs(eval), 1e-300);
+        report(res, n_matvec);
+
+        if (res < best)
+        {
+            best = res;
+            stalled = 0;
+        }
+        else
+        {
+            ++stalled;
+        }
+
+        rotate_basis(V, n, y, 1, 1);
+        scale(1. / sqrt(dot(V[0], V[0])), V[0]);
+
+        if (res <= epsilon || n < m ||
+            (max_matvec > 0 && n_matvec >= max_matvec) || stalled > 20)
+            break;
+    }
+
+    x.swap(V[0]);
+    return n_matvec;
+}
+
+// Solves A x = b for a general operator given by matvec, by the restarted
+// GMRES(m) method, starting from the given x. The iteration stops when the
+// residual |b - A x| is below epsilon, or when max_matvec products were done
+// (if max_matvec > 0).
+template <class MatVec, class Report = krylov::no_report>
+size_t gmres(MatVec&& matvec, const vector<double>& b, vector<double>& x,
+             size_t m, double epsilon, size_t max_matvec,
+             Report&& report = Report())
+{
+    using namespace krylov;
+    size_t N = x.size();
+    m = std::max(std::min(m, N), size_t(1));
+
+    vector<vector<double>> V(m + 1, vector<double>(N, 0));
+    vector<double> H((m + 1) * m), cs(m), sn(m), g(m + 1), y(m);
+
+    size_t n_matvec = 0, stalled = 0;
+    double best = numeric_limits<double>::infinity();
+    while (true)
+    {
+        auto& r = V[0];
+        matvec(x, r);
+        ++n_matvec;
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(static)
+        for (size_t i = 0; i < N; ++i)
+            r[i] = b[i] - r[i];
+        double beta = sqrt(dot(r, r));
+        report(beta, n_matvec);
+
+        if (beta < best)
+        {
+            best = beta;
+            stalled = 0;
+        }
+        else
+        {
+            ++stalled;
+        }
+
+        if (beta <= epsilon || (max_matvec > 0 && n_matvec >= max_matvec) ||
+            stalled > 20)
+            break;
+        scale(1. / beta, r);
+
+        std::fill(H.begin(), H.end(), 0);
+        std::fill(g.begin(), g.end(), 0);
+        g[0] = beta;
+
+        size_t n = 0;
+        for (size_t j = 0; j < m; ++j)
+        {
+            auto& w = V[j + 1];
+            matvec(V[j], w);
+            ++n_matvec;
+            vector<double> h(j + 2, 0);
+            h[j + 1] = orthogonalize(V, j, w, h.data());
+            if (h[j + 1] > 0)
+                scale(1. / h[j + 1], w);
+
+            // previous Givens rotations, and a new one to eliminate h[j + 1]
+            for (size_t i = 0; i < j; ++i)
+            {
+                double t = cs[i] * h[i] + sn[i] * h[i + 1];
+                h[i + 1] = -sn[i] * h[i] + cs[i] * h[i + 1];
+                h[i] = t;
+            }
+            double d = sqrt(h[j] * h[j] + h[j + 1] * h[j + 1]);
+            cs[j] = (d > 0) ? h[j] / d : 1;
+            sn[j] = (d > 0) ? h[j + 1] / d : 0;
+            h[j] = d;
+            h[j + 1] = 0;
+            g[j + 1] = -sn[j] * g[j];
+            g[j] = cs[j] * g[j];
+
+            for (size_t i = 0; i <= j; ++i)
+                H[i * m + j] = h[i];
+            n = j + 1;
+
+            if (abs(g[j + 1]) <= epsilon ||
+                (max_matvec > 0 && n_matvec >= max_matvec))
+                break;
+        }
+
+        // back substitution, and the update of x
+        for (size_t i = n; i-- > 0;)
+        {
+            y[i] = g[i];
+            for (size_t j = i + 1; j < n; ++j)
+                y[i] -= H[i * m + j] * y[j];
+            y[i] = (H[i * m + i] != 0) ? y[i] / H[i * m + i] : 0;
+        }
+        for (size_t i = 0; i < n; ++i)
+            axpy(y[i], V[i], x);
+    }
+    return n_matvec;
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_KRYLOV_HH
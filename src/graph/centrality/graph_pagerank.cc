@@ -22,6 +22,7 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 #include "graph_pagerank.hh"
 
 using namespace std;
@@ -29,7 +30,8 @@ using namespace boost;
 using namespace graph_tool;
 
 size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
-                boost::any weight, double d, double epsilon, size_t max_iter)
+                boost::any weight, double d, double epsilon, size_t max_iter,
+                python::object otrace, bool mixed)
 {
     if (!belongs<vertex_floating_properties>()(rank))
         throw ValueException("rank vertex property must have a floating-point value type");
@@ -54,20 +56,120 @@ size_t pagerank(GraphInterface& g, boost::any rank, boost::any pers,
     if(weight.empty())
         weight = weight_map_t();
 
+    auto atrace = get_array<double, 2>(otrace);
+    convergence_trace trace(atrace.data(), atrace.shape()[0],
+                            g.get_num_edges());
+
     size_t iter;
-    run_action<>()
+    run_action<with_frozen<all_graph_views>>(true)
         (g, std::bind(get_pagerank(),
                       std::placeholders::_1, g.get_vertex_index(), std::placeholders::_2,
                       std::placeholders::_3, std::placeholders::_4, d,
-                      epsilon, max_iter, std::ref(iter)),
+                      epsilon, max_iter, std::ref(iter), std::ref(trace), mixed),
          vertex_floating_properties(),
          pers_props_t(), weight_props_t())(rank, pers, weight);
     return iter;
 }
 
+typedef UnityPropertyMap<int,GraphInterface::edge_t> unity_weight_t;
+typedef boost::mpl::push_back<edge_scalar_properties, unity_weight_t>::type
+    pr_weight_props_t;
+
+size_t batch_pagerank(GraphInterface& g, python::object opers,
+                      python::object orank, boost::any weight, double d,
+                      double epsilon, size_t max_iter, bool mixed)
+{
+    auto pers = get_array<double, 2>(opers);
+    auto rank = get_array<double, 2>(orank);
+    size_t N = g.get_num_vertices(false);
+    if (pers.shape()[0] != N || rank.shape()[0] != N ||
+        pers.shape()[1] != rank.shape()[1])
+        throw ValueException("personalization and rank arrays must have "
+                             "shape (N, K), with N the number of vertices");
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+    if (weight.empty())
+        weight = unity_weight_t();
+
+    size_t iter = 0;
+    run_action<with_frozen<all_graph_views>>(true)
+        (g, std::bind(get_batch_pagerank(), std::placeholders::_1,
+                      std::placeholders::_2, pers.data(), rank.data(),
+                      size_t(pers.shape()[1]), d, epsilon, max_iter,
+                      std::ref(iter), mixed),
+         pr_weight_props_t())(weight);
+    return iter;
+}
+
+python::object local_pagerank(GraphInterface& g, python::object oseeds,
+                              python::object ovals, boost::any weight,
+                              double d, double epsilon)
+{
+    auto aseeds = get_array<int64_t, 1>(oseeds);
+    auto avals = get_array<double, 1>(ovals);
+    vector<size_t> seeds(aseeds.begin(), aseeds.end());
+    vector<double> vals(avals.begin(), avals.end());
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+    if (weight.empty())
+        weight = unity_weight_t();
+
+    vector<size_t> vs;
+    vector<double> ps;
+    run_action<>(true)
+        (g, std::bind(get_local_pagerank(), std::placeholders::_1,
+                      std::placeholders::_2, std::cref(seeds), std::cref(vals),
+                      d, epsilon, std::ref(vs), std::ref(ps)),
+         pr_weight_props_t())(weight);
+    return python::make_tuple(wrap_vector_owned(vs), wrap_vector_owned(ps));
+}
+
+size_t pagerank_update(GraphInterface& g, boost::any rank, boost::any pers,
+                       boost::any weight, double d, double epsilon,
+                       python::object ochanged)
+{
+    if (!belongs<vertex_floating_properties>()(rank))
+        throw ValueException("rank vertex property must have a floating-point value type");
+
+    if (!pers.empty() && !belongs<vertex_scalar_properties>()(pers))
+        throw ValueException("personalization vertex property must have a scalar value type");
+
+    typedef ConstantPropertyMap<double, GraphInterface::vertex_t> pers_map_t;
+    typedef boost::mpl::push_back<vertex_scalar_properties, pers_map_t>::type
+        pers_props_t;
+
+    if(pers.empty())
+        pers = pers_map_t(1.0 / g.get_num_vertices());
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+    if (weight.empty())
+        weight = unity_weight_t();
+
+    auto achanged = get_array<int64_t, 1>(ochanged);
+    vector<size_t> changed(achanged.begin(), achanged.end());
+
+    // the per-vertex threshold bounds the total residual by epsilon
+    double eps = epsilon / std::max(g.get_num_vertices(), size_t(1));
+
+    size_t n_pushes = 0;
+    run_action<>(true)
+        (g, std::bind(get_pagerank_update(), std::placeholders::_1,
+                      std::placeholders::_2, std::placeholders::_3,
+                      std::placeholders::_4, d, eps, std::cref(changed),
+                      std::ref(n_pushes)),
+         vertex_floating_properties(),
+         pers_props_t(), pr_weight_props_t())(rank, pers, weight);
+    return n_pushes;
+}
 
 void export_pagerank()
 {
     using namespace boost::python;
     def("get_pagerank", &pagerank);
+    def("get_batch_pagerank", &batch_pagerank);
+    def("get_local_pagerank", &local_pagerank);
+    def("get_pagerank_update", &pagerank_update);
 }
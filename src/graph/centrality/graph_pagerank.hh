@@ -21,77 +21,414 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "hash_map_wrap.hh"
+#include "graph_push_update.hh"
+#include "graph_spmv.hh"
+#include "graph_convergence_trace.hh"
+#include "graph_scratch.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
+// The PageRank iteration is a sparse matrix-vector product, done with
+// spmv_kernel over the in-edges. Before each iteration, the rank of every
+// vertex is divided by its weighted out-degree into a contiguous array, so
+// that the inner loop has no divisions.
+//
+// As before, vertices with zero out-degree (dangling) contribute nothing to
+// the others, i.e. their rank mass is not redistributed.
 struct get_pagerank
 {
     template <class Graph, class VertexIndex, class RankMap, class PerMap,
               class Weight>
-    void operator()(Graph& g, VertexIndex vertex_index, RankMap rank,
-                    PerMap pers, Weight weight, double damping, double epsilon,
-                    size_t max_iter, size_t& iter) const
+    void operator()(Graph& g, VertexIndex, RankMap rank, PerMap pers,
+                    Weight weight, double damping, double epsilon,
+                    size_t max_iter, size_t& iter, convergence_trace& trace,
+                    bool mixed) const
+    {
+        typedef typename property_traits<RankMap>::value_type rank_type;
+        iter = 0;
+        if (num_vertices(g) <= numeric_limits<uint32_t>::max())
+        {
+            if (mixed)
+                run<uint32_t, float>(g, rank, pers, weight, damping, epsilon,
+                                     max_iter, iter, trace, mixed);
+            else
+                run<uint32_t, rank_type>(g, rank, pers, weight, damping,
+                                         epsilon, max_iter, iter, trace, mixed);
+        }
+        else
+        {
+            if (mixed)
+                run<size_t, float>(g, rank, pers, weight, damping, epsilon,
+                                   max_iter, iter, trace, mixed);
+            else
+                run<size_t, rank_type>(g, rank, pers, weight, damping,
+                                       epsilon, max_iter, iter, trace, mixed);
+        }
+    }
+
+    // In mixed precision, the edge weights are stored with single precision,
+    // and the iteration is done first with single-precision values, which
+    // halves the memory traffic. When it converges, or stalls because of the
+    // limited precision, the result is checked, and refined if necessary, by
+    // iterating with the value type of the rank map.
+    // Since the ranks sum to one, the single-precision iteration cannot get
+    // much below a few float ulps in the L1 delta, so it stops there.
+    static constexpr double float_epsilon()
+    {
+        return 16 * numeric_limits<float>::epsilon();
+    }
+
+    template <class Index, class Val, class Graph, class RankMap,
+              class PerMap, class Weight>
+    void run(Graph& g, RankMap rank, const PerMap& pers, Weight weight,
+             double damping, double epsilon, size_t max_iter, size_t& iter,
+             convergence_trace& trace, bool mixed) const
     {
         typedef typename property_traits<RankMap>::value_type rank_type;
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        constexpr bool constant_weight =
+            is_constant_property<Weight>::type::value;
 
-        RankMap r_temp(vertex_index, num_vertices(g));
-        RankMap deg(vertex_index, num_vertices(g));
+        spmv_kernel<Index, Val, constant_weight> kernel(g, weight);
 
-        // init degs
+        size_t N = num_vertices(g);
+        rank_type d = damping;
+
+        // the constant weight, if any, is absorbed into the scaled ranks
+        vector<rank_type> scale(N, 0), base(N, 0), r(N, 0);
         parallel_vertex_loop
             (g,
              [&](auto v)
              {
-                 put(deg, v, out_degreeS()(v, g, weight));
+                 rank_type k = out_degreeS()(v, g, weight);
+                 if (k != 0)
+                 {
+                     scale[v] = 1 / k;
+                     if (constant_weight)
+                         scale[v] *= get(weight, edge_t());
+                 }
+                 base[v] = (1 - d) * get(pers, v);
+                 r[v] = get(rank, v);
              });
 
-        rank_type delta = epsilon + 1;
-        rank_type d = damping;
-        iter = 0;
+        if (mixed)
+        {
+            vector<float> fscale(scale.begin(), scale.end()),
+                fbase(base.begin(), base.end()), fr(r.begin(), r.end());
+            iterate(kernel, fscale, fbase, fr, float(d),
+                    std::max(epsilon, float_epsilon()), max_iter, 10, iter,
+                    trace);
+            r.assign(fr.begin(), fr.end());
+        }
+
+        if (!mixed || max_iter == 0 || iter < max_iter)
+            iterate(kernel, scale, base, r, d, epsilon, max_iter, 0, iter,
+                    trace);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 put(rank, v, r[v]);
+             });
+    }
+
+    // Iterates with values of type T, until the delta is below epsilon, the
+    // total number of iterations reaches max_iter (if max_iter > 0), or the
+    // delta did not improve for max_stall iterations (if max_stall > 0).
+    template <class Kernel, class T>
+    void iterate(Kernel& kernel, const vector<T>& scale, const vector<T>& base,
+                 vector<T>& r, T d, double epsilon, size_t max_iter,
+                 size_t max_stall, size_t& iter, convergence_trace& trace) const
+    {
+        typedef spmv_acc_t<T> acc_t;
+        size_t N = r.size();
+
+        // the temporary vectors are reused between calls on the same thread
+        auto r_buf = get_scratch<vector<T>>();
+        auto x_buf = get_scratch<vector<T>>();
+        auto& r_temp = *r_buf;
+        auto& x = *x_buf;
+        r_temp.assign(N, 0);
+        x.assign(N, 0);
+
+        acc_t delta = epsilon + 1;
+        acc_t best = numeric_limits<acc_t>::infinity();
+        size_t stalled = 0;
         while (delta >= epsilon)
         {
-            delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     rank_type r = 0;
-                     for (const auto& e : in_or_out_edges_range(v, g))
-                     {
-                         typename graph_traits<Graph>::vertex_descriptor s;
-                         if (graph_tool::is_directed(g))
-                             s = source(e, g);
-                         else
-                             s = target(e, g);
-                         r += (get(rank, s) * get(weight, e)) / get(deg, s);
-                     }
-
-                     put(r_temp, v, (1.0 - d) * get(pers, v) + d * r);
-
-                     delta += abs(get(r_temp, v) - get(rank, v));
-                 });
-            swap(r_temp, rank);
+            GT_TRACE_PHASE("pagerank_iteration");
+            #pragma omp parallel for if (N > OPENMP_MIN_THRESH) \
+                schedule(runtime)
+            for (size_t v = 0; v < N; ++v)
+                x[v] = r[v] * scale[v];
+
+            delta = kernel(x, base, r, d, r_temp);
+            r.swap(r_temp);
             ++iter;
+            trace(delta, iter);
             if (max_iter > 0 && iter == max_iter)
                 break;
+            if (delta < best)
+            {
+                best = delta;
+                stalled = 0;
+            }
+            else if (max_stall > 0 && ++stalled >= max_stall)
+            {
+                break;
+            }
         }
+    }
+};
 
-        if (iter % 2 != 0)
+// Incremental update of a previous PageRank solution in rank, after the edges
+// between the given pairs of vertices were added or removed, by pushing the
+// residuals of the affected vertices. Returns the number of pushes.
+struct get_pagerank_update
+{
+    template <class Graph, class RankMap, class PerMap, class Weight>
+    void operator()(Graph& g, RankMap rank, PerMap pers, Weight weight,
+                    double d, double epsilon, const vector<size_t>& changed,
+                    size_t& n_pushes) const
+    {
+        auto deg = [&](auto u)
+            {
+                return double(out_degreeS()(u, g, weight));
+            };
+
+        auto residual = [&](size_t v)
+            {
+                double r = 0;
+                for (const auto& e : in_or_out_edges_range(vertex(v, g), g))
+                {
+                    auto s = graph_tool::is_directed(g) ? source(e, g) :
+                        target(e, g);
+                    double k = deg(s);
+                    if (k > 0)
+                        r += get(rank, s) * get(weight, e) / k;
+                }
+                return (1 - d) * get(pers, v) + d * r - get(rank, v);
+            };
+
+        auto scale = [&](size_t u)
+            {
+                double k = deg(vertex(u, g));
+                return (k > 0) ? d / k : 0.;
+            };
+
+        auto w = [&](const auto& e) { return double(get(weight, e)); };
+
+        vector<size_t> affected;
+        push_update_affected(g, changed, affected);
+        n_pushes = push_update(g, rank, affected, residual, scale, w, epsilon);
+    }
+};
+
+// PageRank for K personalization vectors at once, given as the rows of the
+// row-major V x K array pers (indexed by the vertex index), with the initial
+// and final values in the array rank, of the same shape. The iteration stops
+// when the total delta of every vector is below epsilon.
+struct get_batch_pagerank
+{
+    template <class Graph, class Weight>
+    void operator()(Graph& g, Weight weight, const double* pers, double* rank,
+                    size_t K, double damping, double epsilon, size_t max_iter,
+                    size_t& iter, bool mixed) const
+    {
+        iter = 0;
+        if (num_vertices(g) <= numeric_limits<uint32_t>::max())
         {
-            parallel_vertex_loop
-                (g,
-                 [&](auto v)
+            if (mixed)
+                run<uint32_t, float>(g, weight, pers, rank, K, damping,
+                                     epsilon, max_iter, iter, mixed);
+            else
+                run<uint32_t, double>(g, weight, pers, rank, K, damping,
+                                      epsilon, max_iter, iter, mixed);
+        }
+        else
+        {
+            if (mixed)
+                run<size_t, float>(g, weight, pers, rank, K, damping, epsilon,
+                                   max_iter, iter, mixed);
+            else
+                run<size_t, double>(g, weight, pers, rank, K, damping, epsilon,
+                                    max_iter, iter, mixed);
+        }
+    }
+
+    // mixed precision is done as in get_pagerank
+    template <class Index, class Val, class Graph, class Weight>
+    void run(Graph& g, Weight weight, const double* pers, double* rank,
+             size_t K, double damping, double epsilon, size_t max_iter,
+             size_t& iter, bool mixed) const
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        constexpr bool constant_weight =
+            is_constant_property<Weight>::type::value;
+
+        spmv_kernel<Index, Val, constant_weight> kernel(g, weight);
+
+        size_t N = num_vertices(g);
+        double d = damping;
+
+        vector<double> scale(N, 0), base(N * K, 0), r(N * K, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 double k = out_degreeS()(v, g, weight);
+                 if (k != 0)
+                 {
+                     scale[v] = 1 / k;
+                     if (constant_weight)
+                         scale[v] *= get(weight, edge_t());
+                 }
+                 for (size_t i = v * K; i < (v + 1) * K; ++i)
                  {
-                     put(rank, v, get(r_temp, v));
-                 });
+                     base[i] = (1 - d) * pers[i];
+                     r[i] = rank[i];
+                 }
+             });
+
+        if (mixed)
+        {
+            vector<float> fscale(scale.begin(), scale.end()),
+                fbase(base.begin(), base.end()), fr(r.begin(), r.end());
+            iterate(kernel, fscale, fbase, fr, K, float(d),
+                    std::max(epsilon, get_pagerank::float_epsilon()),
+                    max_iter, 10, iter);
+            r.assign(fr.begin(), fr.end());
+        }
+
+        if (!mixed || max_iter == 0 || iter < max_iter)
+            iterate(kernel, scale, base, r, K, d, epsilon, max_iter, 0, iter);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 for (size_t i = v * K; i < (v + 1) * K; ++i)
+                     rank[i] = r[i];
+             });
+    }
+
+    // as in get_pagerank, with the largest delta of the K vectors
+    template <class Kernel, class T>
+    void iterate(Kernel& kernel, const vector<T>& scale, const vector<T>& base,
+                 vector<T>& r, size_t K, T d, double epsilon, size_t max_iter,
+                 size_t max_stall, size_t& iter) const
+    {
+        typedef spmv_acc_t<T> acc_t;
+        size_t N = scale.size();
+        auto r_buf = get_scratch<vector<T>>();
+        auto x_buf = get_scratch<vector<T>>();
+        auto& r_temp = *r_buf;
+        auto& x = *x_buf;
+        r_temp.assign(N * K, 0);
+        x.assign(N * K, 0);
+        vector<acc_t> delta(K, 0);
+
+        acc_t best = numeric_limits<acc_t>::infinity();
+        size_t stalled = 0;
+        while (true)
+        {
+            GT_TRACE_PHASE("batch_pagerank_iteration");
+            #pragma omp parallel for if (N > OPENMP_MIN_THRESH) \
+                schedule(runtime)
+            for (size_t v = 0; v < N; ++v)
+            {
+                for (size_t i = v * K; i < (v + 1) * K; ++i)
+                    x[i] = r[i] * scale[v];
+            }
+
+            kernel(x, base, r, d, r_temp, K, delta);
+            r.swap(r_temp);
+            ++iter;
+            acc_t max_delta = *std::max_element(delta.begin(), delta.end());
+            if (max_delta < epsilon)
+                break;
+            if (max_iter > 0 && iter == max_iter)
+                break;
+            if (max_delta < best)
+            {
+                best = max_delta;
+                stalled = 0;
+            }
+            else if (max_stall > 0 && ++stalled >= max_stall)
+            {
+                break;
+            }
         }
     }
 };
 
+// Local approximation of the personalized PageRank, given by the seed
+// vertices and their personalization values, by the push algorithm of
+// Andersen, Chung and Lang. The estimate p and the residual r are kept in
+// hash maps, and a vertex u is pushed when r[u] >= epsilon * d(u), where d(u)
+// is its weighted out-degree: (1 - damping) r[u] is added to p[u], and the
+// rest is spread to the out-neighbors in proportion to the edge weights.
+// Since p + PR(r) is invariant, where PR(r) is the PageRank personalized by
+// r, the result is the PageRank personalized by the seeds, minus PR(r). Each
+// push removes at least (1 - damping) epsilon d(u) from the total residual,
+// so that the total degree of the pushed vertices is at most
+// sum(vals) / (epsilon (1 - damping)), regardless of the size of the graph.
+struct get_local_pagerank
+{
+    template <class Graph, class Weight>
+    void operator()(Graph& g, Weight weight, const vector<size_t>& seeds,
+                    const vector<double>& vals, double damping, double epsilon,
+                    vector<size_t>& vs, vector<double>& ps) const
+    {
+        gt_hash_map<size_t, double> p, r;
+        vector<size_t> queue;
+
+        // the residual of u is added to x, and u is queued if it was not
+        // eligible for a push before, but is now
+        auto add = [&](size_t u, double& x, double dx)
+            {
+                double t = epsilon * out_degreeS()(vertex(u, g), g, weight);
+                bool before = x > 0 && x >= t;
+                x += dx;
+                if (!before && x > 0 && x >= t)
+                    queue.push_back(u);
+            };
+
+        for (size_t i = 0; i < seeds.size(); ++i)
+            add(seeds[i], r[seeds[i]], vals[i]);
+
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            size_t u = queue[i];
+            double ru = r[u];
+            r[u] = 0;
+            p[u] += (1 - damping) * ru;
+
+            double k = out_degreeS()(vertex(u, g), g, weight);
+            if (k == 0)
+                continue;
+            double c = damping * ru / k;
+            for (const auto& e : out_edges_range(vertex(u, g), g))
+            {
+                size_t v = target(e, g);
+                add(v, r[v], c * get(weight, e));
+            }
+        }
+
+        vs.clear();
+        ps.clear();
+        for (auto& vp : p)
+            vs.push_back(vp.first);
+        std::sort(vs.begin(), vs.end());
+        for (auto v : vs)
+            ps.push_back(p[v]);
+    }
+};
+
 }
 #endif // GRAPH_PAGERANK_HH
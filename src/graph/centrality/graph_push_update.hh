@@ -0,0 +1,118 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PUSH_UPDATE_HH
+#define GRAPH_PUSH_UPDATE_HH
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Vertices whose equation in a linear centrality x = b + T x (PageRank,
+// Katz) can change when the edges between the given pairs of vertices
+// (s, t) are added or removed: the targets, and every out-neighbor of the
+// sources, since their out-degrees change. For undirected graphs the same is
+// done in both directions.
+template <class Graph>
+void push_update_affected(const Graph& g, const vector<size_t>& changed,
+                          vector<size_t>& affected)
+{
+    affected.clear();
+    auto add = [&](size_t s, size_t t)
+        {
+            affected.push_back(t);
+            auto u = vertex(s, g);
+            if (u == graph_traits<Graph>::null_vertex())
+                return;
+            for (auto w : out_neighbors_range(u, g))
+                affected.push_back(w);
+        };
+    for (size_t i = 0; i + 1 < changed.size(); i += 2)
+    {
+        add(changed[i], changed[i + 1]);
+        if (!graph_tool::is_directed(g))
+            add(changed[i + 1], changed[i]);
+    }
+    std::sort(affected.begin(), affected.end());
+    affected.erase(std::unique(affected.begin(), affected.end()),
+                   affected.end());
+    affected.erase(std::remove_if(affected.begin(), affected.end(),
+                                  [&](size_t v)
+                                  {
+                                      return (vertex(v, g) ==
+                                              graph_traits<Graph>::null_vertex());
+                                  }),
+                   affected.end());
+}
+
+// Updates a solution x of x = b + T x after a local change of the system,
+// where T has non-negative entries and spectral radius below one, by pushing
+// residuals only from the affected vertices, instead of iterating over the
+// whole graph. The residuals r = b + T x - x are computed for the affected
+// vertices by residual(v), and are zero elsewhere, if x was a solution
+// before. The entries of T are given by scale(u) * weight(e) for each out-edge
+// e of u. A vertex u with |r[u]| >= epsilon is pushed by adding r[u] to x[u],
+// and scale(u) weight(e) r[u] to the residual of the target of each out-edge
+// e, which keeps x + (I - T)^{-1} r invariant. Since the residuals can be
+// negative (e.g. after edge removals), they are compared in absolute value.
+// Returns the number of pushes.
+template <class Graph, class X, class Residual, class Scale, class Weight>
+size_t push_update(const Graph& g, X& x, const vector<size_t>& affected,
+                   Residual&& residual, Scale&& scale, Weight&& weight,
+                   double epsilon)
+{
+    vector<double> r(num_vertices(g), 0);
+    vector<size_t> queue;
+
+    // v is queued if its residual becomes large enough
+    auto add = [&](size_t v, double dr)
+        {
+            auto& rv = r[v];
+            bool before = std::abs(rv) >= epsilon;
+            rv += dr;
+            if (!before && std::abs(rv) >= epsilon)
+                queue.push_back(v);
+        };
+
+    for (auto v : affected)
+        add(v, residual(v));
+
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        size_t u = queue[i];
+        double ru = r[u];
+        r[u] = 0;
+        x[u] += ru;
+        double c = scale(u) * ru;
+        if (c == 0)
+            continue;
+        for (const auto& e : out_edges_range(vertex(u, g), g))
+            add(target(e, g), c * weight(e));
+    }
+    return queue.size();
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_PUSH_UPDATE_HH
@@ -0,0 +1,239 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SPMV_HH
+#define GRAPH_SPMV_HH
+
+#include <vector>
+#include <type_traits>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Sparse matrix-vector product with the (weighted) adjacency matrix, done in
+// "pull" style over a compressed copy of the in-edges (the out-edges, for
+// undirected graphs, or if out == true): the neighbor of each edge, and its
+// weight unless the weights are constant, are stored contiguously for each
+// vertex, so that the inner loop is a sum of gathered values, without
+// property-map lookups, which is vectorized by the compiler where possible.
+// No atomic operations are needed, since each vertex is updated only by the
+// thread that owns it.
+//
+// The weights are stored with type Val, but the PageRank products below can
+// be done with vectors of another type T, so that the same copy can be used
+// for single- and double-precision iterations. The deltas are accumulated in
+// (at least) double precision.
+template <class T>
+using spmv_acc_t = typename std::conditional<std::is_same<T, float>::value,
+                                             double, T>::type;
+
+template <class Index, class Val, bool constant_weight>
+class spmv_kernel
+{
+public:
+    template <class Graph, class Weight>
+    spmv_kernel(const Graph& g, Weight weight, bool out = false)
+        : _offset(num_vertices(g) + 1, 0), _valid(num_vertices(g), false),
+          _cweight(1)
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        if (constant_weight)
+            _cweight = get(weight, edge_t());
+
+        bool in = graph_tool::is_directed(g) && !out;
+
+        size_t N = num_vertices(g);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 _offset[v + 1] = in ? in_degreeS()(v, g) : out_degree(v, g);
+                 _valid[v] = true;
+             });
+        for (size_t v = 0; v < N; ++v)
+            _offset[v + 1] += _offset[v];
+
+        _source.resize(_offset[N]);
+        if (!constant_weight)
+            _weight.resize(_offset[N]);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t pos = _offset[v];
+                 auto put_edge = [&](const auto& e, size_t s)
+                     {
+                         _source[pos] = s;
+                         if (!constant_weight)
+                             _weight[pos] = get(weight, e);
+                         ++pos;
+                     };
+                 if (in)
+                 {
+                     for (const auto& e : in_edges_range(v, g))
+                         put_edge(e, source(e, g));
+                 }
+                 else
+                 {
+                     for (const auto& e : out_edges_range(v, g))
+                         put_edge(e, target(e, g));
+                 }
+             });
+    }
+
+    // Computes y[v] = sum_e w_e x[s_e] for every vertex, including the
+    // constant weight, if any.
+    void multiply(const vector<Val>& x, vector<Val>& y) const
+    {
+        size_t N = _valid.size();
+        const Index* src = _source.data();
+        const Val* w = _weight.data();
+        const Val* xs = x.data();
+
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (!_valid[v])
+            {
+                y[v] = 0;
+                continue;
+            }
+            size_t begin = _offset[v], end = _offset[v + 1];
+            Val sum = 0;
+            if (constant_weight)
+            {
+                #pragma omp simd reduction(+:sum)
+                for (size_t j = begin; j < end; ++j)
+                    sum += xs[src[j]];
+                sum *= _cweight;
+            }
+            else
+            {
+                #pragma omp simd reduction(+:sum)
+                for (size_t j = begin; j < end; ++j)
+                    sum += w[j] * xs[src[j]];
+            }
+            y[v] = sum;
+        }
+    }
+
+    // Computes r[v] = base[v] + d * sum_e w_e x[s_e] for every vertex,
+    // without the constant weight, if any, and returns the sum of
+    // |r[v] - rank[v]|.
+    template <class T>
+    spmv_acc_t<T> operator()(const vector<T>& x, const vector<T>& base,
+                             const vector<T>& rank, T d, vector<T>& r) const
+    {
+        typedef spmv_acc_t<T> acc_t;
+        size_t N = _valid.size();
+        const Index* src = _source.data();
+        const Val* w = _weight.data();
+        const T* xs = x.data();
+
+        acc_t delta = 0;
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) \
+            schedule(runtime) reduction(+:delta)
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (!_valid[v])
+                continue;
+            size_t begin = _offset[v], end = _offset[v + 1];
+            T sum = 0;
+            if (constant_weight)
+            {
+                #pragma omp simd reduction(+:sum)
+                for (size_t j = begin; j < end; ++j)
+                    sum += xs[src[j]];
+            }
+            else
+            {
+                #pragma omp simd reduction(+:sum)
+                for (size_t j = begin; j < end; ++j)
+                    sum += w[j] * xs[src[j]];
+            }
+            r[v] = base[v] + d * sum;
+            delta += abs(acc_t(r[v]) - acc_t(rank[v]));
+        }
+        return delta;
+    }
+
+    // The same, for K vectors at once, stored as rows of K contiguous values
+    // per vertex, so that each edge updates all of them; the sums of
+    // |r[v] - rank[v]| are put in delta, for each vector.
+    template <class T>
+    void operator()(const vector<T>& x, const vector<T>& base,
+                    const vector<T>& rank, T d, vector<T>& r, size_t K,
+                    vector<spmv_acc_t<T>>& delta) const
+    {
+        typedef spmv_acc_t<T> acc_t;
+        size_t N = _valid.size();
+        delta.assign(K, 0);
+
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+        {
+            vector<T> sum(K);
+            vector<acc_t> ldelta(K, 0);
+            T* acc = sum.data();
+
+            #pragma omp for schedule(runtime)
+            for (size_t v = 0; v < N; ++v)
+            {
+                if (!_valid[v])
+                    continue;
+                std::fill(sum.begin(), sum.end(), 0);
+                for (size_t j = _offset[v]; j < _offset[v + 1]; ++j)
+                {
+                    const T* xs = x.data() + size_t(_source[j]) * K;
+                    T w = constant_weight ? 1 : _weight[j];
+                    #pragma omp simd
+                    for (size_t k = 0; k < K; ++k)
+                        acc[k] += w * xs[k];
+                }
+
+                size_t pos = v * K;
+                for (size_t k = 0; k < K; ++k)
+                {
+                    r[pos + k] = base[pos + k] + d * acc[k];
+                    ldelta[k] += abs(acc_t(r[pos + k]) -
+                                     acc_t(rank[pos + k]));
+                }
+            }
+
+            #pragma omp critical
+            for (size_t k = 0; k < K; ++k)
+                delta[k] += ldelta[k];
+        }
+    }
+
+    bool valid(size_t v) const { return _valid[v]; }
+
+private:
+    vector<size_t> _offset;
+    vector<uint8_t> _valid;
+    vector<Index> _source;
+    vector<Val> _weight;
+    Val _cweight;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_SPMV_HH
@@ -21,6 +21,7 @@
 
 #include "graph.hh"
 #include "graph_selectors.hh"
+#include "numpy_bind.hh"
 
 #include "graph_trust_transitivity.hh"
 
@@ -28,19 +29,29 @@ using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
-void trust_transitivity(GraphInterface& g, int64_t source, int64_t target,
-                    boost::any c, boost::any t)
+python::object trust_transitivity(GraphInterface& g, int64_t source,
+                                  int64_t target, boost::any c, boost::any t,
+                                  double min_trust, size_t n_top)
 {
     if (!belongs<edge_floating_properties>()(c))
         throw ValueException("edge property must be of floating point value type");
     if (!belongs<vertex_floating_vector_properties>()(t))
         throw ValueException("vertex property must be of floating point valued vector type");
 
+    vector<int64_t> rtgt, rsrc;
+    vector<double> rval;
     run_action<>()(g,
-                   bind<void>(get_trust_transitivity(), _1, g.get_vertex_index(),
-                              source, target, _2, _3),
+                   [&](auto& graph, auto c, auto t)
+                   {
+                       get_trust_transitivity()
+                           (graph, g.get_vertex_index(), source, target, c, t,
+                            min_trust, n_top, rtgt, rsrc, rval);
+                   },
                    edge_floating_properties(),
                    vertex_floating_vector_properties())(c,t);
+
+    return python::make_tuple(wrap_vector_owned(rtgt), wrap_vector_owned(rsrc),
+                              wrap_vector_owned(rval));
 }
 
 void export_trust_transitivity()
@@ -24,9 +24,7 @@
 
 #include <algorithm>
 
-#include <boost/graph/dijkstra_shortest_paths.hpp>
-
-#include <iostream>
+#include <tuple>
 
 namespace graph_tool
 {
@@ -34,194 +32,379 @@ using namespace std;
 using namespace boost;
 
 
-struct stop_search {}; // exception to be thrown to stop search
-
-template <class SourceMap, class WeightMap>
-class source_counter:
-    public boost::dijkstra_visitor<null_visitor>
+// Single-source searches for the paths with maximum trust, i.e. the largest
+// product of the edge trust values, which are assumed to lie in [0,1]. Since
+// the trust can only decrease along a path, this is done with Dijkstra's
+// algorithm, which visits the vertices in decreasing order of trust. The
+// buffers are kept between searches, and only the vertices reached by the last
+// search are reset, so that many searches on the same graph do not pay O(N)
+// each. Paths with trust below min_trust are not followed, so the search only
+// explores the part of the graph that can contribute noticeably.
+template <class Val>
+class trust_search
 {
 public:
-    source_counter(SourceMap source_map, WeightMap weight_map, size_t n_sources)
-        : _source_map(source_map), _weight_map(weight_map),
-          _n_sources(n_sources) {}
+    trust_search(size_t N) : _dist(N, 0), _pred(N), _pos(N, _null) {}
 
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor u,
-                        Graph&)
+    // Computes the maximum trust from s to every vertex, ignoring the vertex
+    // skip. If reversed is true, the edges are followed backwards. The search
+    // is interrupted as soon as stop(v) returns true for a visited vertex v.
+    template <bool reversed, class Graph, class TrustMap, class Stop>
+    void run(const Graph& g, size_t s, size_t skip, TrustMap c,
+             Val min_trust, Stop&& stop)
     {
-        // stop if all sources are found
-        if (_source_map[u])
+        _dist[s] = 1;
+        _reached.push_back(s);
+        push(s);
+        while (!_heap.empty())
         {
-            _n_sources--;
-            if (_n_sources == 0)
-                throw stop_search();
+            size_t v = pop();
+            if (stop(v))
+                break;
+
+            auto relax = [&](size_t u, Val w)
+                {
+                    Val d = _dist[v] * w;
+                    if (d <= _dist[u] || d < min_trust || u == skip)
+                        return;
+                    if (_dist[u] == 0)
+                        _reached.push_back(u);
+                    _dist[u] = d;
+                    _pred[u] = v;
+                    if (_pos[u] == _null)
+                        push(u);
+                    else if (_pos[u] != _done)
+                        sift_up(_pos[u]);
+                };
+
+            if (reversed)
+            {
+                for (const auto& e : in_edges_range(vertex(v, g), g))
+                    relax(source(e, g), c[e]);
+            }
+            else
+            {
+                for (const auto& e : out_edges_range(vertex(v, g), g))
+                    relax(target(e, g), c[e]);
+            }
         }
+        for (auto v : _heap)
+            _pos[v] = _done;
+        _heap.clear();
+    }
+
+    // vertices with non-zero trust found by the last search
+    const vector<size_t>& reached() const { return _reached; }
+
+    Val operator[](size_t v) const { return _dist[v]; }
+
+    // predecessor of a reached vertex in the maximum trust path
+    size_t pred(size_t v) const { return _pred[v]; }
+
+    void reset()
+    {
+        for (auto v : _reached)
+        {
+            _dist[v] = 0;
+            _pos[v] = _null;
+        }
+        _reached.clear();
     }
 
 private:
-    SourceMap _source_map;
-    WeightMap _weight_map;
-    size_t _n_sources;
-};
+    // 4-ary max-heap on _dist, with the positions of the vertices kept in
+    // _pos, so that their keys can be increased in place
+    void push(size_t v)
+    {
+        _heap.push_back(v);
+        sift_up(_heap.size() - 1);
+    }
 
-struct dist_compare
-{
-    template <class Type1, class Type2>
-    bool operator()(const Type1& d1, const Type2& d2) const
+    size_t pop()
     {
-        return d1 > d2; // we want trust paths with _maximum_ "distance"
+        size_t v = _heap.front();
+        _pos[v] = _done;
+        if (_heap.size() > 1)
+        {
+            _heap.front() = _heap.back();
+            _heap.pop_back();
+            sift_down(0);
+        }
+        else
+        {
+            _heap.pop_back();
+        }
+        return v;
     }
-};
 
-struct dist_combine
-{
-    template <class DistType, class WeightType>
-    DistType operator()(const DistType& d, const WeightType& w) const
+    void sift_up(size_t i)
     {
-        return DistType(d * w);
+        size_t v = _heap[i];
+        Val d = _dist[v];
+        while (i > 0)
+        {
+            size_t p = (i - 1) / 4;
+            if (_dist[_heap[p]] >= d)
+                break;
+            _heap[i] = _heap[p];
+            _pos[_heap[i]] = i;
+            i = p;
+        }
+        _heap[i] = v;
+        _pos[v] = i;
     }
-};
 
-// predicate to filter a single vertex from the graph
-struct filter_vertex_pred
-{
-    filter_vertex_pred() {}
-    filter_vertex_pred(size_t v): _v(v) {}
-    template <class Vertex>
-    bool operator()(const Vertex& v) const { return v != _v; }
-    size_t _v;
+    void sift_down(size_t i)
+    {
+        size_t v = _heap[i];
+        Val d = _dist[v];
+        size_t n = _heap.size();
+        while (true)
+        {
+            size_t j = 4 * i + 1;
+            if (j >= n)
+                break;
+            size_t m = j;
+            for (size_t k = j + 1; k < std::min(j + 4, n); ++k)
+            {
+                if (_dist[_heap[k]] > _dist[_heap[m]])
+                    m = k;
+            }
+            if (_dist[_heap[m]] <= d)
+                break;
+            _heap[i] = _heap[m];
+            _pos[_heap[i]] = i;
+            i = m;
+        }
+        _heap[i] = v;
+        _pos[v] = i;
+    }
+
+    static constexpr size_t _null = numeric_limits<size_t>::max();
+    static constexpr size_t _done = _null - 1;
+
+    vector<Val> _dist;
+    vector<size_t> _pred;
+    vector<size_t> _pos;
+    vector<size_t> _reached;
+    vector<size_t> _heap;
 };
 
+// Computes the pervasive trust transitivity of [richters-trust-2010]. If
+// n_top > 0, and no source is given, the trust values are not stored in t,
+// but only the n_top most trusted sources of each target (excluding itself)
+// are appended to (rtgt, rsrc, rval), ordered by target and decreasing trust.
 struct get_trust_transitivity
 {
     template <class Graph, class VertexIndex, class TrustMap,
               class InferredTrustMap>
     void operator()(Graph& g, VertexIndex vertex_index, int64_t source,
-                    int64_t target, TrustMap c, InferredTrustMap t) const
+                    int64_t target, TrustMap c, InferredTrustMap t,
+                    double min_trust, size_t n_top, vector<int64_t>& rtgt,
+                    vector<int64_t>& rsrc, vector<double>& rval) const
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
         typedef typename
             property_traits<InferredTrustMap>::value_type::value_type t_type;
 
         size_t N = (target == -1) ? num_vertices(g) : target + 1;
+        bool sparse = (n_top > 0 && source == -1);
 
-        parallel_vertex_loop
-            (g,
-             [&](auto v)
-             {
-                 t[v].resize((source == -1 && target == -1) ? N : 1);
-             });
+        if (!sparse)
+        {
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     t[v].resize((source == -1 && target == -1) ? N : 1);
+                 });
+        }
 
-        #pragma omp parallel for if (num_vertices(g) > OPENMP_MIN_THRESH)
-        for (size_t i = (target == -1) ? 0 : target; i < N; ++i)
+        // The maximum trust paths from the source, with no vertex removed. The
+        // removal of a target changes the trust of its in-neighbors only if
+        // they lie below it in this tree, otherwise no new search is needed.
+        // The subtree of v is given by the preorder interval [pre[v], end[v]).
+        vector<t_type> tree_dist;
+        vector<size_t> pre, end;
+        if (source != -1)
         {
-            vertex_t tgt = vertex(i, g);
-            if (!is_valid_vertex(tgt, g))
-                continue;
-
-            // mark the sources
-            typedef unchecked_vector_property_map<uint8_t, VertexIndex>
-                source_map_t;
-            source_map_t source_map(vertex_index, num_vertices(g));
-
-            typename in_edge_iteratorS<Graph>::type e, e_end;
-            for (tie(e, e_end) = in_edge_iteratorS<Graph>::get_edges(tgt, g);
-                 e != e_end; ++e)
-                source_map[boost::source(*e,g)] = true;
-
-            // filter vertex w out of the graph
-            typedef filt_graph<Graph, boost::keep_all, filter_vertex_pred>
-                fg_t;
-            fg_t fg(g, boost::keep_all(), filter_vertex_pred(tgt));
-
-            // distance map (target weight map)
-            typedef unchecked_vector_property_map<t_type, VertexIndex>
-                dist_map_t;
-            dist_map_t dist_map(vertex_index, num_vertices(g));
-
-            // color map
-            typedef unchecked_vector_property_map<default_color_type, VertexIndex>
-                color_map_t;
-            color_map_t color_map(vertex_index, num_vertices(g));
+            size_t null = numeric_limits<size_t>::max();
+            trust_search<t_type> search(num_vertices(g));
+            search.template run<false>(g, source, null, c, min_trust,
+                                       [](size_t) { return false; });
 
-            if (source != -1)
+            tree_dist.resize(num_vertices(g), 0);
+            vector<size_t> child(num_vertices(g), null),
+                sibling(num_vertices(g), null);
+            for (auto v : search.reached())
             {
-                vertex_t src = vertex(source, g);
+                tree_dist[v] = search[v];
+                if (v == size_t(source))
+                    continue;
+                auto u = search.pred(v);
+                sibling[v] = child[u];
+                child[u] = v;
+            }
 
-                // compute the targets weights
-                try
+            pre.resize(num_vertices(g), null);
+            end.resize(num_vertices(g), null);
+            size_t pos = 0;
+            vector<size_t> stack = {size_t(source)};
+            while (!stack.empty())
+            {
+                auto v = stack.back();
+                if (pre[v] == null)
                 {
-                    size_t k = in_degreeS()(tgt, g);
-                    source_counter<source_map_t,dist_map_t>
-                        visitor(source_map, dist_map, k);
-                    dijkstra_shortest_paths(fg, src, weight_map(c).
-                                            vertex_index_map(vertex_index).
-                                            color_map(color_map).
-                                            distance_map(dist_map).
-                                            distance_compare(dist_compare()).
-                                            distance_combine(dist_combine()).
-                                            distance_inf(t_type(0)).
-                                            distance_zero(t_type(1)).
-                                            visitor(visitor));
+                    pre[v] = pos++;
+                    for (auto u = child[v]; u != null; u = sibling[u])
+                        stack.push_back(u);
                 }
-                catch (const stop_search&) {}
-
-                // compute the target's trust
-                t_type sum_w = 0, avg = 0;
-                for (auto e : in_edges_range(tgt, g))
+                else
                 {
-                    t_type weight = dist_map[boost::source(e, g)];
-                    sum_w += weight;
-                    avg += c[e]*weight*weight;
+                    end[v] = pos;
+                    stack.pop_back();
                 }
-                if (sum_w > 0)
-                    t[tgt][0] = avg/sum_w;
-                if (tgt == src)
-                    t[tgt][0] = 1.0;
             }
+        }
+
+        vector<std::tuple<int64_t, t_type, int64_t>> top;
+
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+        {
+            trust_search<t_type> search(num_vertices(g));
+            vector<uint8_t> is_source;
+            vector<t_type> sum_w, avg;
+            if (source != -1)
+                is_source.resize(num_vertices(g), false);
             else
             {
-                typedef typename
-                    mpl::if_<typename is_directed::apply<Graph>::type,
-                             reversed_graph<fg_t>,
-                             fg_t>::type rg_t;
-                rg_t rg(fg);
-                dist_map_t sum_w(vertex_index, num_vertices(g));
-                for (auto e : in_edges_range(tgt, g))
+                sum_w.resize(num_vertices(g), 0);
+                avg.resize(num_vertices(g), 0);
+            }
+            vector<size_t> touched;
+            vector<pair<t_type, size_t>> ttop;
+            vector<std::tuple<int64_t, t_type, int64_t>> ltop;
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = (target == -1) ? 0 : target; i < N; ++i)
+            {
+                vertex_t tgt = vertex(i, g);
+                if (!is_valid_vertex(tgt, g))
+                    continue;
+
+                if (source != -1)
                 {
-                    // compute the weights to all sources
-                    dijkstra_shortest_paths
-                        (rg, boost::source(e, g), weight_map(c).
-                         vertex_index_map(vertex_index).
-                         color_map(color_map).
-                         distance_map(dist_map).
-                         distance_compare(dist_compare()).
-                         distance_combine(dist_combine()).
-                         distance_inf(t_type(0)).
-                         distance_zero(t_type(1)));
-
-                    parallel_vertex_loop
-                        (g,
-                         [&](auto src)
-                         {
-                             t_type weight = dist_map[src];
-                             sum_w[src] += weight;
-                             size_t tidx = (target == -1) ? vertex_index[tgt] : 0;
-                             t[src][tidx] += c[e]*weight*weight;
-                         });
+                    // mark the sources that lie below the target in the tree,
+                    // and stop the search when they are all found
+                    vertex_t src = vertex(source, g);
+                    size_t k = 0;
+                    for (auto e : in_edges_range(tgt, g))
+                    {
+                        auto s = boost::source(e, g);
+                        if (is_source[s] || s == tgt || src == tgt ||
+                            tree_dist[s] == 0 || pre[s] < pre[tgt] ||
+                            pre[s] >= end[tgt])
+                            continue;
+                        is_source[s] = true;
+                        k++;
+                    }
+
+                    if (k > 0)
+                        search.template run<false>
+                            (g, src, tgt, c, min_trust,
+                             [&](size_t v)
+                             {
+                                 return (is_source[v] && --k == 0);
+                             });
+
+                    // compute the target's trust
+                    t_type s_w = 0, a = 0;
+                    for (auto e : in_edges_range(tgt, g))
+                    {
+                        auto s = boost::source(e, g);
+                        t_type weight = is_source[s] ? search[s] :
+                            ((s == tgt) ? 0 : tree_dist[s]);
+                        s_w += weight;
+                        a += c[e] * weight * weight;
+                    }
+                    t[tgt][0] = (s_w > 0) ? a / s_w : 0;
+                    if (tgt == src)
+                        t[tgt][0] = 1.0;
+
+                    for (auto e : in_edges_range(tgt, g))
+                        is_source[boost::source(e, g)] = false;
+                    search.reset();
                 }
+                else
+                {
+                    // compute the weights from all sources, by searching
+                    // backwards from each in-neighbor of the target
+                    for (auto e : in_edges_range(tgt, g))
+                    {
+                        auto s = boost::source(e, g);
+                        if (s == tgt)
+                            continue;
+                        search.template run<true>
+                            (g, s, tgt, c, min_trust,
+                             [](size_t) { return false; });
+                        for (auto src : search.reached())
+                        {
+                            t_type weight = search[src];
+                            if (sum_w[src] == 0)
+                                touched.push_back(src);
+                            sum_w[src] += weight;
+                            avg[src] += c[e] * weight * weight;
+                        }
+                        search.reset();
+                    }
+
+                    size_t tidx = (target == -1) ? vertex_index[tgt] : 0;
+                    if (!sparse)
+                    {
+                        for (auto src : touched)
+                            t[src][tidx] = avg[src] / sum_w[src];
+                        t[tgt][tidx] = 1.0;
+                    }
+                    else
+                    {
+                        for (auto src : touched)
+                            ttop.emplace_back(avg[src] / sum_w[src], src);
+                        auto pos = ttop.begin() + std::min(n_top, ttop.size());
+                        std::partial_sort(ttop.begin(), pos, ttop.end(),
+                                          [](const auto& a, const auto& b)
+                                          {
+                                              return a.first > b.first;
+                                          });
+                        for (auto iter = ttop.begin(); iter != pos; ++iter)
+                            ltop.emplace_back(i, iter->first, iter->second);
+                        ttop.clear();
+                    }
 
-                parallel_vertex_loop
-                    (g,
-                     [&](auto src)
-                     {
-                         size_t tidx = (target == -1) ? vertex_index[tgt] : 0;
-                         if (sum_w[src] > 0)
-                             t[src][tidx] /= sum_w[src];
-                         if (src == tgt)
-                             t[src][tidx] = 1.0;
-                     });
+                    for (auto src : touched)
+                        sum_w[src] = avg[src] = 0;
+                    touched.clear();
+                }
             }
+
+            #pragma omp critical (trust_top)
+            top.insert(top.end(), ltop.begin(), ltop.end());
+        }
+
+        if (!sparse)
+            return;
+
+        std::sort(top.begin(), top.end(),
+                  [](const auto& a, const auto& b)
+                  {
+                      if (std::get<0>(a) != std::get<0>(b))
+                          return std::get<0>(a) < std::get<0>(b);
+                      return std::get<1>(a) > std::get<1>(b);
+                  });
+        for (auto& x : top)
+        {
+            rtgt.push_back(std::get<0>(x));
+            rval.push_back(std::get<1>(x));
+            rsrc.push_back(std::get<2>(x));
         }
     }
 };
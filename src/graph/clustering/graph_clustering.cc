@@ -24,6 +24,7 @@
 #include "graph_clustering.hh"
 
 #include "random.hh"
+#include "numpy_bind.hh"
 
 #include <boost/python.hpp>
 
@@ -40,15 +41,93 @@ boost::python::tuple global_clustering(GraphInterface& g)
     return boost::python::make_tuple(c, c_err);
 }
 
+boost::python::tuple sampled_clustering(GraphInterface& g, bool local,
+                                        double epsilon, size_t max_samples,
+                                        rng_t& rng)
+{
+    double c, c_err;
+    size_t n_samples;
+    run_action<graph_tool::detail::never_directed>()
+        (g, [&](auto& graph)
+            {
+                get_sampled_clustering()(graph, local, epsilon, max_samples,
+                                         rng, c, c_err, n_samples);
+            })();
+    return boost::python::make_tuple(c, c_err, n_samples);
+}
+
 void local_clustering(GraphInterface& g, boost::any prop)
 {
-    run_action<>()
+    run_action<with_frozen<all_graph_views>>()
         (g, std::bind(set_clustering_to_property(),
                       std::placeholders::_1,
                       std::placeholders::_2),
          writable_vertex_scalar_properties())(prop);
 }
 
+typedef vprop_map_t<int64_t>::type tri_map_t;
+
+void local_triangles(GraphInterface& g, boost::any atri, boost::any adeg)
+{
+    tri_map_t tri = any_cast<tri_map_t>(atri);
+    tri_map_t deg = any_cast<tri_map_t>(adeg);
+    run_action<graph_tool::detail::never_directed>()
+        (g, [&](auto& graph)
+            {
+                vector<size_t> vtri, vdeg;
+                get_all_simple_triangles(graph, vtri, vdeg);
+                auto utri = tri.get_unchecked(num_vertices(graph));
+                auto udeg = deg.get_unchecked(num_vertices(graph));
+                for (auto v : vertices_range(graph))
+                {
+                    utri[v] = vtri[v];
+                    udeg[v] = vdeg[v];
+                }
+            })();
+}
+
+boost::python::object edge_triangles_update(GraphInterface& g,
+                                            boost::any atri, boost::any adeg,
+                                            size_t s, size_t t, int sign)
+{
+    tri_map_t tri = any_cast<tri_map_t>(atri);
+    tri_map_t deg = any_cast<tri_map_t>(adeg);
+    size_t N = g.get_num_vertices(false);
+    vector<int64_t> affected;
+    run_action<graph_tool::detail::never_directed>()
+        (g, [&](auto& graph)
+            {
+                for (auto v : {s, t})
+                {
+                    if (v >= N ||
+                        !is_valid_vertex(vertex(v, graph), graph))
+                        throw ValueException("Invalid vertex index: " +
+                                             std::to_string(v));
+                }
+                update_edge_triangles()(graph, tri.get_unchecked(N),
+                                        deg.get_unchecked(N), s, t, sign,
+                                        affected);
+            })();
+    return wrap_vector_owned(affected);
+}
+
+void clustering_from_triangles(GraphInterface& g, boost::any atri,
+                               boost::any adeg, boost::any clust,
+                               boost::python::object ovs)
+{
+    tri_map_t tri = any_cast<tri_map_t>(atri);
+    tri_map_t deg = any_cast<tri_map_t>(adeg);
+    auto avs = get_array<int64_t, 1>(ovs);
+    vector<int64_t> vs(avs.begin(), avs.end());
+    run_action<graph_tool::detail::never_directed>()
+        (g, [&](auto&, auto c)
+            {
+                set_clustering_from_triangles()(tri.get_unchecked(),
+                                                deg.get_unchecked(), c, vs);
+            },
+         writable_vertex_scalar_properties())(clust);
+}
+
 using namespace boost::python;
 
 void extended_clustering(GraphInterface& g, boost::python::list props);
@@ -59,7 +138,11 @@ void get_motifs(GraphInterface& g, size_t k, boost::python::list subgraph_list,
 BOOST_PYTHON_MODULE(libgraph_tool_clustering)
 {
     def("global_clustering", &global_clustering);
+    def("sampled_clustering", &sampled_clustering);
     def("local_clustering", &local_clustering);
+    def("local_triangles", &local_triangles);
+    def("edge_triangles_update", &edge_triangles_update);
+    def("clustering_from_triangles", &clustering_from_triangles);
     def("extended_clustering", &extended_clustering);
     def("get_motifs", &get_motifs);
 }
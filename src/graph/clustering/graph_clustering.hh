@@ -21,12 +21,16 @@
 #include "config.h"
 
 #include "hash_map_wrap.hh"
+#include "graph_triangles.hh"
 #include <boost/mpl/if.hpp>
 
 #ifdef _OPENMP
 #include "omp.h"
 #endif
 
+#include "random.hh"
+#include "../inference/support/parallel_rng.hh"
+
 #ifndef __clang__
 #include <ext/numeric>
 using __gnu_cxx::power;
@@ -43,7 +47,8 @@ namespace graph_tool
 using namespace boost;
 using namespace std;
 
-// calculates the number of triangles to which v belongs
+// calculates the number of triangles to which v belongs (see
+// get_all_triangles() for all vertices at once)
 template <class Graph, class VProp>
 pair<int,int>
 get_triangles(typename graph_traits<Graph>::vertex_descriptor v, VProp& mark,
@@ -88,18 +93,18 @@ struct get_global_clustering
     template <class Graph>
     void operator()(const Graph& g, double& c, double& c_err) const
     {
-        size_t triangles = 0, n = 0;
-        vector<bool> mask(num_vertices(g), false);
+        vector<size_t> tri, pairs;
+        get_all_triangles(g, tri, pairs);
 
+        size_t triangles = 0, n = 0;
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask) reduction(+:triangles, n)
+            reduction(+:triangles, n)
         parallel_vertex_loop_no_spawn
                 (g,
                  [&](auto v)
                  {
-                     auto temp = get_triangles(v, mask, g);
-                     triangles += temp.first;
-                     n += temp.second;
+                     triangles += tri[v];
+                     n += pairs[v];
                  });
         c = double(triangles) / n;
 
@@ -107,14 +112,13 @@ struct get_global_clustering
         c_err = 0.0;
         double cerr = 0.0;
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask) reduction(+:cerr)
+            reduction(+:cerr)
         parallel_vertex_loop_no_spawn
                 (g,
                  [&](auto v)
                  {
-                     auto temp = get_triangles(v, mask, g);
-                     double cl = double(triangles - temp.first) /
-                         (n - temp.second);
+                     double cl = double(triangles - tri[v]) /
+                         (n - pairs[v]);
                      cerr += power(c - cl, 2);
                  });
         c_err = sqrt(cerr);
@@ -128,17 +132,15 @@ struct set_clustering_to_property
     void operator()(const Graph& g, ClustMap clust_map) const
     {
         typedef typename property_traits<ClustMap>::value_type c_type;
-        vector<bool> mask(num_vertices(g), false);
+        vector<size_t> tri, pairs;
+        get_all_triangles(g, tri, pairs);
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(mask)
-        parallel_vertex_loop_no_spawn
+        parallel_vertex_loop
             (g,
              [&](auto v)
              {
-                 auto triangles = get_triangles(v, mask, g);
-                 double clustering = (triangles.second > 0) ?
-                     double(triangles.first)/triangles.second :
+                 double clustering = (pairs[v] > 0) ?
+                     double(tri[v]) / pairs[v] :
                      0.0;
                  clust_map[v] = c_type(clustering);
              });
@@ -155,6 +157,231 @@ struct set_clustering_to_property
     };
 };
 
+// Estimates the global clustering coefficient (if local == false) or the
+// average local clustering coefficient (if local == true) of an undirected
+// graph by wedge sampling. A wedge is a pair of distinct edges incident on the
+// same vertex, and the estimate is the fraction of the sampled wedges that are
+// closed by a third edge. For the global coefficient the wedges are picked
+// uniformly from all wedges in the graph, so that their central vertex v is
+// chosen with probability proportional to k_v(k_v-1)/2. For the average local
+// coefficient the vertex is chosen uniformly, and contributes zero if it has
+// fewer than two neighbors. The samples are taken in rounds, until the
+// standard error falls below epsilon, or max_samples is reached (if
+// max_samples > 0). Parallel edges and self-loops produce wedges that are
+// never closed, so the estimate is only exact in expectation for simple
+// graphs.
+struct get_sampled_clustering
+{
+    template <class Graph, class RNG>
+    void operator()(const Graph& g, bool local, double epsilon,
+                    size_t max_samples, RNG& rng, double& c, double& c_err,
+                    size_t& n_samples) const
+    {
+        if (num_vertices(g) <= numeric_limits<uint32_t>::max())
+            run<uint32_t>(g, local, epsilon, max_samples, rng, c, c_err,
+                          n_samples);
+        else
+            run<size_t>(g, local, epsilon, max_samples, rng, c, c_err,
+                        n_samples);
+    }
+
+    template <class Index, class Graph, class RNG>
+    void run(const Graph& g, bool local, double epsilon, size_t max_samples,
+             RNG& rng, double& c, double& c_err, size_t& n_samples) const
+    {
+        // contiguous copy of the adjacency, for constant-time random access
+        vector<Index> vs;
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+        size_t N = vs.size();
+        vector<size_t> pos(N + 1, 0);
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t i = 0; i < N; ++i)
+            pos[i + 1] = out_degree(vs[i], g);
+        for (size_t i = 0; i < N; ++i)
+            pos[i + 1] += pos[i];
+
+        vector<Index> idx(num_vertices(g), 0);
+        vector<Index> adj(pos[N]);
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t i = 0; i < N; ++i)
+        {
+            idx[vs[i]] = i;
+            size_t j = pos[i];
+            for (auto u : out_neighbors_range(vs[i], g))
+                adj[j++] = u;
+        }
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t j = 0; j < adj.size(); ++j)
+            adj[j] = idx[adj[j]];
+        idx.clear();
+        idx.shrink_to_fit();
+
+        // cumulative number of wedges, to sample their central vertices
+        vector<double> cum_wedges;
+        if (!local)
+        {
+            cum_wedges.resize(N + 1, 0);
+            for (size_t i = 0; i < N; ++i)
+            {
+                double k = pos[i + 1] - pos[i];
+                cum_wedges[i + 1] = cum_wedges[i] + k * (k - 1) / 2;
+            }
+        }
+
+        c = 0;
+        c_err = 0;
+        n_samples = 0;
+        if (N == 0 || (!local && cum_wedges[N] == 0))
+            return;
+
+        auto is_adjacent = [&](size_t u, size_t w)
+            {
+                if (pos[u + 1] - pos[u] > pos[w + 1] - pos[w])
+                    std::swap(u, w);
+                for (size_t j = pos[u]; j < pos[u + 1]; ++j)
+                {
+                    if (adj[j] == w)
+                        return true;
+                }
+                return false;
+            };
+
+        vector<std::shared_ptr<RNG>> rngs;
+        init_rngs(rngs, rng);
+
+        size_t n_threads = rngs.size();
+        size_t round = std::max(size_t(1024), 256 * n_threads);
+        size_t closed = 0;
+        while (max_samples == 0 || n_samples < max_samples)
+        {
+            size_t n_round = round;
+            if (max_samples > 0)
+                n_round = std::min(n_round, max_samples - n_samples);
+
+            size_t n_closed = 0;
+            #pragma omp parallel for if (n_threads > 1) schedule(static) \
+                reduction(+:n_closed)
+            for (size_t i = 0; i < n_round; ++i)
+            {
+                auto& trng = get_rng(rngs, rng);
+                size_t v;
+                if (local)
+                {
+                    v = uniform_int_distribution<size_t>(0, N - 1)(trng);
+                }
+                else
+                {
+                    double x = uniform_real_distribution<>(0, cum_wedges[N])(trng);
+                    v = std::upper_bound(cum_wedges.begin(), cum_wedges.end(),
+                                         x) - cum_wedges.begin() - 1;
+                    v = std::min(v, N - 1);
+                }
+
+                size_t k = pos[v + 1] - pos[v];
+                if (k < 2)
+                    continue;
+                size_t a = uniform_int_distribution<size_t>(0, k - 1)(trng);
+                size_t b = uniform_int_distribution<size_t>(0, k - 2)(trng);
+                if (b >= a)
+                    ++b;
+                size_t u = adj[pos[v] + a];
+                size_t w = adj[pos[v] + b];
+                if (u == v || w == v || u == w)
+                    continue;
+                if (is_adjacent(u, w))
+                    ++n_closed;
+            }
+
+            closed += n_closed;
+            n_samples += n_round;
+
+            // the error is computed with one pseudo-count for each outcome,
+            // so that it does not vanish when the estimate is 0 or 1
+            double p = (closed + 1.) / (n_samples + 2.);
+            c_err = sqrt(p * (1 - p) / n_samples);
+            if (c_err < epsilon)
+                break;
+        }
+        c = double(closed) / n_samples;
+    }
+};
+
+// Incremental maintenance of the number of triangles tri[v] to which each
+// vertex of an undirected graph belongs, and of its number of distinct
+// neighbors deg[v], under the addition (sign = 1) or removal (sign = -1) of an
+// edge (s, t). The counts are those of the simple graph obtained by merging
+// the parallel edges and ignoring the self-loops, as computed initially by
+// get_all_simple_triangles(). This must be called before the graph itself is
+// changed. Only the common neighbors of s and t gain or lose a triangle, and
+// they are found by storing the neighbors of the endpoint of smaller degree in
+// a hash set and scanning the other, in O(k_s + k_t) time. Nothing changes if
+// the edge has a parallel edge, or is a self-loop. The vertices whose triangle
+// counts or degrees change are returned in affected.
+struct update_edge_triangles
+{
+    template <class Graph, class TriMap>
+    void operator()(const Graph& g, TriMap tri, TriMap deg, size_t s,
+                    size_t t, int sign, vector<int64_t>& affected) const
+    {
+        affected.clear();
+        if (s == t)
+            return;
+
+        size_t u = s, w = t;
+        if (out_degree(u, g) > out_degree(w, g))
+            std::swap(u, w);
+
+        gt_hash_set<size_t> ns;
+        size_t m = 0;
+        for (auto x : out_neighbors_range(u, g))
+        {
+            if (x == w)
+                ++m;
+            else if (x != u)
+                ns.insert(x);
+        }
+
+        // the adjacency changes only for the first added, or the last removed,
+        // edge between s and t
+        if ((sign > 0 && m > 0) || (sign < 0 && m != 1))
+            return;
+
+        affected.push_back(s);
+        affected.push_back(t);
+        deg[s] += sign;
+        deg[t] += sign;
+
+        for (auto x : out_neighbors_range(w, g))
+        {
+            if (x == u || x == w || ns.erase(x) == 0)
+                continue;
+            tri[x] += sign;
+            tri[s] += sign;
+            tri[t] += sign;
+            affected.push_back(x);
+        }
+    }
+};
+
+// sets the local clustering coefficients of the given vertices from their
+// triangle counts and numbers of distinct neighbors
+struct set_clustering_from_triangles
+{
+    template <class TriMap, class ClustMap>
+    void operator()(TriMap tri, TriMap deg, ClustMap clust_map,
+                    const vector<int64_t>& vs) const
+    {
+        typedef typename property_traits<ClustMap>::value_type c_type;
+        for (auto v : vs)
+        {
+            size_t k = deg[v];
+            size_t pairs = (k * (k - 1)) / 2;
+            clust_map[v] = c_type((pairs > 0) ? double(tri[v]) / pairs : 0.);
+        }
+    }
+};
+
 } //graph-tool namespace
 
 #endif // GRAPH_CLUSTERING_HH
@@ -20,9 +20,11 @@
 #ifndef GRAPH_EXTENDED_CLUSTERING_HH
 #define GRAPH_EXTENDED_CLUSTERING_HH
 
-#include "hash_map_wrap.hh"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
-#include <boost/graph/breadth_first_search.hpp>
+#include "graph_util.hh"
 
 namespace graph_tool
 {
@@ -30,166 +32,148 @@ namespace graph_tool
 using namespace std;
 using namespace boost;
 
-// graph filter to remove a single vertex
-
-template <class Vertex>
-struct single_vertex_filter
-{
-    single_vertex_filter() {}
-    single_vertex_filter(Vertex v):_v(v) {}
-
-    bool operator()(Vertex v) const { return v != _v; }
-
-    Vertex _v;
-};
-
-class bfs_stop_exception {};
-
-// this will abort the BFS search when no longer useful
-
-template <class TargetSet, class DistanceMap>
-struct bfs_max_depth_watcher
-{
-    typedef on_tree_edge event_filter;
-
-    bfs_max_depth_watcher(TargetSet& targets, size_t max_depth,
-                          DistanceMap distance)
-        : _targets(targets), _max_depth(max_depth), _distance(distance) {}
-
-    template <class Graph>
-    void operator()(typename graph_traits<Graph>::edge_descriptor e,
-                    const Graph& g)
-    {
-        typename graph_traits<Graph>::vertex_descriptor v = target(e,g);
-        if (get(_distance, v) > _max_depth)
-            throw bfs_stop_exception();
-        if (_targets.find(v) != _targets.end())
-            _targets.erase(v);
-        if (_targets.empty())
-            throw bfs_stop_exception();
-    }
-
-    TargetSet& _targets;
-    size_t _max_depth;
-    DistanceMap _distance;
-};
-
-// abstract target collecting so algorithm works for bidirectional and
-// undirected graphs
-
-template<class Graph, class Vertex, class Targets, class DirectedCategory>
-void collect_targets(Vertex v, Graph& g, Targets& t, DirectedCategory)
-{
-    for (auto u : in_neighbors_range(v, g))
-    {
-        if (u == v) // no self-loops
-            continue;
-        if (t.find(u) != t.end()) // avoid parallel edges
-            continue;
-        t.insert(u);
-    }
-}
-
-template<class Graph, class Vertex, class Targets>
-void collect_targets(Vertex v, Graph& g, Targets& t, undirected_tag)
-{
-    for (auto u : out_neighbors_range(v, g))
-    {
-        if (u == v) // no self-loops
-            continue;
-        if (t.find(u) != t.end()) // avoid parallel edges
-            continue;
-        t.insert(u);
-    }
-}
-
 // get_extended_clustering
+//
+// For every vertex v, and every pair of a distinct out-neighbor u and a
+// distinct in-neighbor t of v (all neighbors, for undirected graphs), a
+// breadth-first search bounded by the maximum depth finds the distance from u
+// to t in the graph without v, and the pair is counted at that distance. Each
+// thread keeps its own flag arrays and a flat queue, which holds the
+// distance-limited frontiers one after the other, so that nothing is
+// allocated per vertex, and the searches are reset by only clearing the
+// vertices they reached. The vertices are processed dynamically in
+// decreasing order of their number of pairs, so that the most expensive ones
+// do not end up last.
 
 struct get_extended_clustering
 {
     template <class Graph, class IndexMap, class ClusteringMap>
-    void operator()(const Graph& g, IndexMap vertex_index,
+    void operator()(const Graph& g, IndexMap,
                     vector<ClusteringMap> cmaps) const
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
 
-        parallel_vertex_loop
-            (g,
-             [&](auto v)
-             {
-                 // We must disconsider paths through the original vertex
-                 typedef single_vertex_filter<vertex_t> filter_t;
-                 typedef filt_graph<Graph, keep_all, filter_t> fg_t;
-                 fg_t fg(g, keep_all(), filter_t(v));
-
-                 typedef DescriptorHash<IndexMap> hasher_t;
-                 typedef gt_hash_set<vertex_t,hasher_t> neighbor_set_t;
-                 neighbor_set_t neighbors(0, hasher_t(vertex_index));
-                 neighbor_set_t targets(0, hasher_t(vertex_index));
-
-                 // collect targets, neighbors and calculate normalization factor
-                 collect_targets(v, g, targets,
-                                 typename graph_traits<Graph>::directed_category());
-                 size_t k_in = targets.size(), k_out, k_inter=0, z;
-                 for (auto u : adjacent_vertices_range(v, g))
-                 {
-                     if (u == v) // no self-loops
-                         continue;
-                     if (neighbors.find(u) != neighbors.end()) // avoid parallel
-                         continue;                               // edges
-
-                     neighbors.insert(u);
-                     if (targets.find(u) != targets.end())
-                         ++k_inter;
-                 }
-
-                 k_out = neighbors.size();
-                 z = (k_in * k_out) - k_inter;
-
-                 // And now we setup and start the BFS bonanza
-                 for (auto u : neighbors)
-                 {
-                     typedef gt_hash_map<vertex_t,size_t,
-                                         DescriptorHash<IndexMap> > dmap_t;
-                     dmap_t dmap(0, DescriptorHash<IndexMap>(vertex_index));
-                     InitializedPropertyMap<dmap_t>
-                         distance_map(dmap, numeric_limits<size_t>::max());
-
-                     typedef gt_hash_map<vertex_t,default_color_type,
-                                         DescriptorHash<IndexMap> > cmap_t;
-                     cmap_t cmap(0, DescriptorHash<IndexMap>(vertex_index));
-                     InitializedPropertyMap<cmap_t>
-                         color_map(cmap, color_traits<default_color_type>::white());
-
-                     try
-                     {
-                         distance_map[u] = 0;
-                         neighbor_set_t specific_targets = targets;
-                         specific_targets.erase(u);
-                         bfs_max_depth_watcher<neighbor_set_t,
-                                               InitializedPropertyMap<dmap_t> >
-                             watcher(specific_targets, cmaps.size(),
-                                     distance_map);
-                         breadth_first_visit(fg, u,
-                                             visitor
-                                             (make_bfs_visitor
-                                              (make_pair(record_distances
-                                                         (distance_map,
-                                                          boost::on_tree_edge()),
-                                                         watcher))).
-                                             color_map(color_map));
-                     }
-                     catch (bfs_stop_exception) {}
-
-                     for (auto t : targets)
-                     {
-                         if (t == u) // no self-loops
-                             continue;
-                         if (distance_map[t] <= cmaps.size())
-                             cmaps[distance_map[t]-1][v] += 1. / z;
-                     }
-                 }
-             });
+        size_t N = num_vertices(g);
+        size_t max_depth = cmaps.size();
+
+        vector<vertex_t> vs;
+        vector<double> work(N, 0);
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t i = 0; i < vs.size(); ++i)
+        {
+            auto v = vs[i];
+            double k = out_degree(v, g);
+            if (graph_tool::is_directed(g))
+                work[v] = k * in_degreeS()(v, g);
+            else
+                work[v] = k * k;
+        }
+        std::sort(vs.begin(), vs.end(),
+                  [&](auto u, auto v)
+                  {
+                      return work[u] > work[v];
+                  });
+        work.clear();
+        work.shrink_to_fit();
+
+        enum : uint8_t { target_flag = 1, neighbor_flag = 2 };
+
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+        {
+            vector<uint8_t> flags(N, 0), visited(N, 0);
+            vector<vertex_t> targets, neighbors, queue;
+
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t i = 0; i < vs.size(); ++i)
+            {
+                auto v = vs[i];
+
+                // collect targets, neighbors and calculate normalization
+                // factor, ignoring self-loops and parallel edges
+                targets.clear();
+                neighbors.clear();
+                auto add_target = [&](auto u)
+                    {
+                        if (u == v || (flags[u] & target_flag))
+                            return;
+                        flags[u] |= target_flag;
+                        targets.push_back(u);
+                    };
+                if (graph_tool::is_directed(g))
+                {
+                    for (auto u : in_neighbors_range(v, g))
+                        add_target(u);
+                }
+                else
+                {
+                    for (auto u : out_neighbors_range(v, g))
+                        add_target(u);
+                }
+
+                size_t k_inter = 0;
+                for (auto u : out_neighbors_range(v, g))
+                {
+                    if (u == v || (flags[u] & neighbor_flag))
+                        continue;
+                    flags[u] |= neighbor_flag;
+                    neighbors.push_back(u);
+                    if (flags[u] & target_flag)
+                        ++k_inter;
+                }
+
+                size_t k_in = targets.size();
+                size_t k_out = neighbors.size();
+                double z = (k_in * k_out) - k_inter;
+
+                // paths through v itself are not considered
+                visited[v] = true;
+                for (auto u : neighbors)
+                {
+                    size_t remaining = k_in;
+                    if (flags[u] & target_flag)
+                        --remaining;
+
+                    queue.clear();
+                    queue.push_back(u);
+                    visited[u] = true;
+                    size_t begin = 0;
+                    for (size_t d = 0; d < max_depth && remaining > 0; ++d)
+                    {
+                        size_t end = queue.size();
+                        if (begin == end)
+                            break;
+                        for (size_t j = begin; j < end && remaining > 0; ++j)
+                        {
+                            for (auto w : out_neighbors_range(queue[j], g))
+                            {
+                                if (visited[w])
+                                    continue;
+                                visited[w] = true;
+                                queue.push_back(w);
+                                if (flags[w] & target_flag)
+                                {
+                                    cmaps[d][v] += 1. / z;
+                                    if (--remaining == 0)
+                                        break;
+                                }
+                            }
+                        }
+                        begin = end;
+                    }
+
+                    for (auto w : queue)
+                        visited[w] = false;
+                }
+                visited[v] = false;
+
+                for (auto u : targets)
+                    flags[u] = 0;
+                for (auto u : neighbors)
+                    flags[u] = 0;
+            }
+        }
     }
 };
 
@@ -23,8 +23,13 @@
 #include <algorithm>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "random.hh"
 #include "hash_map_wrap.hh"
+#include "../inference/support/parallel_rng.hh"
 
 namespace graph_tool
 {
@@ -53,7 +58,7 @@ template <class Graph, class Sampler>
 void get_subgraphs(Graph& g, typename boost::graph_traits<Graph>::vertex_descriptor v,
                    size_t n,
                    std::vector<std::vector<typename boost::graph_traits<Graph>::vertex_descriptor> >& subgraphs,
-                   Sampler sampler)
+                   Sampler& sampler)
 {
     typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
 
@@ -137,30 +142,36 @@ void get_subgraphs(Graph& g, typename boost::graph_traits<Graph>::vertex_descrip
 
 struct sample_all
 {
+    void reset(size_t) {}
+
     template <class val_type>
     void operator()(std::vector<val_type>&, size_t) {}
 };
 
+// Each root vertex draws from its own counter-based stream, keyed by a seed
+// taken from the generator given, so that no locking is needed, and the
+// results are reproducible regardless of the number of threads.
 struct sample_some
 {
-    sample_some(std::vector<double>& p, rng_t& rng): _p(&p), _rng(&rng) {}
+    sample_some(std::vector<double>& p, rng_t& rng)
+        : _p(&p), _seed(draw_seed(rng)) {}
     sample_some() {}
 
+    void reset(size_t v)
+    {
+        _rng = counter_rng(_seed, v);
+    }
+
     template <class val_type>
     void operator()(std::vector<val_type>& extend, size_t d)
     {
-        typedef std::uniform_real_distribution<double> rdist_t;
-        auto random = std::bind(rdist_t(), std::ref(*_rng));
+        auto& rng = _rng;
 
         double pd = (*_p)[d+1];
         size_t nc = extend.size();
         double u = nc*pd - floor(nc*pd);
         size_t n;
-        double r;
-        #pragma omp critical (random)
-        {
-            r = random();
-        }
+        double r = std::uniform_real_distribution<double>()(rng);
         if (r < u)
             n = size_t(ceil(nc*pd));
         else
@@ -177,20 +188,15 @@ struct sample_some
         typedef std::uniform_int_distribution<size_t> idist_t;
         for (size_t i = 0; i < n; ++i)
         {
-            auto random_v = std::bind(idist_t(0, extend.size()-i-1),
-                                      std::ref(*_rng));
-            size_t j;
-            #pragma omp critical (random)
-            {
-                j = i + random_v();
-            }
+            size_t j = i + idist_t(0, extend.size()-i-1)(rng);
             std::swap(extend[i], extend[j]);
         }
         extend.resize(n);
     }
 
-    std::vector<double>* _p;
-    rng_t* _rng;
+    std::vector<double>* _p = nullptr;
+    uint64_t _seed = 0;
+    counter_rng _rng;
 };
 
 
@@ -294,6 +300,191 @@ void get_sig(Graph& g, std::vector<size_t>& sig)
     sort(sig.begin(), sig.end());
 }
 
+// Canonical labeling of small simple graphs, used to classify the subgraphs
+// with a single hash lookup instead of isomorphism tests. A graph with k <= 8
+// vertices is encoded as a k*k adjacency bitmask (with bit i*k+j set if there
+// is an edge i->j, in both directions for undirected graphs), and its
+// canonical code is the smallest encoding over the relabelings that respect
+// a canonical partition of the vertices, obtained by color refinement. For
+// k <= 4 the canonical codes of all possible encodings are tabulated in
+// advance. Graphs with parallel edges, or for which the refined partition
+// still allows more than max_perms relabelings (e.g. large regular graphs),
+// are not handled, and must be compared by isomorphism instead.
+class canonical_form
+{
+public:
+    canonical_form(size_t k, bool directed)
+        : _k(k), _directed(directed), _table(nullptr)
+    {
+        if (_k <= 4)
+        {
+            // the tables are shared by all instances, and built only once
+            static std::vector<uint64_t> tables[5][2];
+            auto& table = tables[_k][_directed];
+            #pragma omp critical (canonical_form_table)
+            {
+                if (table.empty())
+                {
+                    std::vector<uint64_t> t(size_t(1) << (_k * _k), 0);
+                    for (size_t code = 0; code < t.size(); ++code)
+                    {
+                        if (!_directed && !is_symmetric(code))
+                            continue;
+                        search(code, t[code]);
+                    }
+                    table.swap(t);
+                }
+            }
+            _table = &table;
+        }
+    }
+
+    // puts in code the canonical code of the subgraph, and returns true, if
+    // it can be computed
+    template <class Graph>
+    bool operator()(Graph& sub, uint64_t& code) const
+    {
+        if (_k > 8 || num_vertices(sub) != _k)
+            return false;
+        uint64_t adj = 0;
+        for (size_t i = 0; i < _k; ++i)
+        {
+            auto v = vertex(i, sub);
+            for (auto u : out_neighbors_range(v, sub))
+            {
+                uint64_t bit = uint64_t(1) << (i * _k + u);
+                if (adj & bit)
+                    return false; // parallel edges
+                adj |= bit;
+                if (!_directed)
+                    adj |= uint64_t(1) << (u * _k + i);
+            }
+        }
+        if (_table != nullptr)
+        {
+            code = (*_table)[adj];
+            return true;
+        }
+        return search(adj, code);
+    }
+
+private:
+    bool has_edge(uint64_t adj, size_t i, size_t j) const
+    {
+        return (adj >> (i * _k + j)) & 1;
+    }
+
+    bool is_symmetric(uint64_t adj) const
+    {
+        for (size_t i = 0; i < _k; ++i)
+        {
+            if (has_edge(adj, i, i))
+                return false;
+            for (size_t j = i + 1; j < _k; ++j)
+                if (has_edge(adj, i, j) != has_edge(adj, j, i))
+                    return false;
+        }
+        return true;
+    }
+
+    // computes the canonical code by searching the relabelings within the
+    // cells of the refined partition
+    bool search(uint64_t adj, uint64_t& code) const
+    {
+        // color refinement, with the colors identified by their rank among
+        // the (label-independent) signatures
+        std::vector<size_t> color(_k, 0), ncolor(_k);
+        std::vector<std::vector<size_t>> sigs(_k);
+        size_t n_colors = 0;
+        while (true)
+        {
+            for (size_t i = 0; i < _k; ++i)
+            {
+                auto& sig = sigs[i];
+                sig.clear();
+                sig.push_back(color[i]);
+                sig.push_back(has_edge(adj, i, i));
+                size_t pos = sig.size();
+                for (size_t j = 0; j < _k; ++j)
+                    if (j != i && has_edge(adj, i, j))
+                        sig.push_back(color[j]);
+                std::sort(sig.begin() + pos, sig.end());
+                sig.push_back(_k); // separator
+                pos = sig.size();
+                for (size_t j = 0; j < _k; ++j)
+                    if (j != i && has_edge(adj, j, i))
+                        sig.push_back(color[j]);
+                std::sort(sig.begin() + pos, sig.end());
+            }
+            std::vector<std::vector<size_t>> usigs(sigs);
+            std::sort(usigs.begin(), usigs.end());
+            usigs.erase(std::unique(usigs.begin(), usigs.end()), usigs.end());
+            for (size_t i = 0; i < _k; ++i)
+                ncolor[i] = std::lower_bound(usigs.begin(), usigs.end(),
+                                             sigs[i]) - usigs.begin();
+            color.swap(ncolor);
+            if (usigs.size() == n_colors)
+                break;
+            n_colors = usigs.size();
+        }
+
+        // the vertices are placed by color, and permuted within each color
+        std::vector<size_t> order(_k);
+        for (size_t i = 0; i < _k; ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(),
+                  [&](size_t i, size_t j)
+                  {
+                      return std::make_pair(color[i], i) <
+                          std::make_pair(color[j], j);
+                  });
+        std::vector<size_t> cells(1, 0);
+        size_t n_perms = 1;
+        for (size_t p = 1; p <= _k; ++p)
+        {
+            if (p == _k || color[order[p]] != color[order[p - 1]])
+            {
+                for (size_t m = 2; m <= p - cells.back(); ++m)
+                    n_perms *= m;
+                cells.push_back(p);
+                if (n_perms > max_perms)
+                    return false;
+            }
+        }
+
+        std::vector<size_t> label(_k);
+        code = std::numeric_limits<uint64_t>::max();
+        while (true)
+        {
+            for (size_t p = 0; p < _k; ++p)
+                label[order[p]] = p;
+            uint64_t c = 0;
+            for (size_t i = 0; i < _k; ++i)
+                for (size_t j = 0; j < _k; ++j)
+                    if (has_edge(adj, i, j))
+                        c |= uint64_t(1) << (label[i] * _k + label[j]);
+            code = std::min(code, c);
+
+            size_t c_i = cells.size() - 1;
+            for (; c_i > 0; --c_i)
+            {
+                if (std::next_permutation(order.begin() + cells[c_i - 1],
+                                          order.begin() + cells[c_i]))
+                    break;
+            }
+            if (c_i == 0)
+                break;
+        }
+        return true;
+    }
+
+    static constexpr size_t max_perms = 5040;
+
+    size_t _k;
+    bool _directed;
+    const std::vector<uint64_t>* _table;
+};
+
 // gets (or samples) all the subgraphs in graph g
 struct get_all_motifs
 {
@@ -307,6 +498,51 @@ struct get_all_motifs
     bool fill_list;
     rng_t& rng;
 
+    // finds the subgraph in the list by comparing it with the ones of the
+    // same signature, inserting it if it is not there and fill_list == true,
+    // and increments its count; returns false if it is not counted
+    template <class Graph, class USub, class SubList>
+    bool find_subgraph(USub& usub, d_graph_t& sub, std::vector<size_t>& sig,
+                       SubList& sub_list, std::vector<d_graph_t>& subgraph_list,
+                       std::vector<size_t>& hist, size_t& pos) const
+    {
+        auto sl = sub_list.find(sig);
+        if (sl == sub_list.end())
+        {
+            if (!fill_list)
+                return false; // avoid inserting an element in sub_list
+            sl = sub_list.insert({sig, {}}).first;
+        }
+
+        for (auto& mpos : sl->second)
+        {
+            d_graph_t& motif = mpos.second;
+            typename wrap_directed::apply<Graph,d_graph_t>::type
+                umotif(motif);
+            bool found;
+            if (comp_iso)
+                found = isomorphism(umotif, usub,
+                                    vertex_index1_map(get(boost::vertex_index, umotif)).
+                                    vertex_index2_map(get(boost::vertex_index, usub)));
+            else
+                found = graph_cmp(umotif, usub);
+            if (found)
+            {
+                pos = mpos.first;
+                hist[pos]++;
+                return true;
+            }
+        }
+
+        if (!fill_list)
+            return false;
+        subgraph_list.push_back(sub);
+        sl->second.emplace_back(subgraph_list.size() - 1, sub);
+        hist.push_back(1);
+        pos = hist.size() - 1;
+        return true;
+    }
+
     template <class Graph, class Sampler, class VMap>
     void operator()(Graph& g, size_t k, std::vector<d_graph_t>& subgraph_list,
                     std::vector<size_t>& hist, std::vector<std::vector<VMap> >& vmaps,
@@ -318,11 +554,22 @@ struct get_all_motifs
                     std::hash<std::vector<size_t>>> sub_list;
         std::vector<size_t> sig; // current signature
 
+        // this maps the canonical codes of the subgraphs to their positions
+        // in the list, for the subgraphs that have them
+        canonical_form canon(k, graph_tool::is_directed(g));
+        gt_hash_map<uint64_t, size_t> canon_list;
+
         for (size_t i = 0; i < subgraph_list.size(); ++i)
         {
             auto& sub = subgraph_list[i];
             typename wrap_directed::apply<Graph,d_graph_t>::type
                 usub(sub);
+            uint64_t code;
+            if (comp_iso && canon(usub, code))
+            {
+                canon_list.emplace(code, i);
+                continue;
+            }
             get_sig(usub, sig);
             sub_list[sig].emplace_back(i, sub);
         }
@@ -370,7 +617,9 @@ struct get_all_motifs
                 continue;
 
             typename wrap_undirected::apply<Graph>::type ug(g);
-            get_subgraphs(ug, v, k, subgraphs, sampler);
+            auto vsampler = sampler;
+            vsampler.reset(v);
+            get_subgraphs(ug, v, k, subgraphs, vsampler);
 
             for (size_t j = 0; j < subgraphs.size(); ++j)
             {
@@ -378,70 +627,47 @@ struct get_all_motifs
                 typename wrap_directed::apply<Graph,d_graph_t>::type
                     usub(sub);
                 make_subgraph(subgraphs[j], g, usub);
-                get_sig(usub, sig);
+                uint64_t code = 0;
+                bool has_code = comp_iso && canon(usub, code);
+                if (!has_code)
+                    get_sig(usub, sig);
 
                 #pragma omp critical (gather)
                 {
-                    bool skip = false;
-                    auto iter = sub_list.find(sig);
-                    if(iter == sub_list.end())
+                    bool found = false;
+                    size_t pos;
+                    if (has_code)
                     {
-                        if (!fill_list)
-                            skip = true; // avoid inserting an element in sub_list
-                        sub_list[sig].clear();
-                    }
-
-                    if (!skip)
-                    {
-                        bool found = false;
-                        size_t pos;
-                        auto sl = sub_list.find(sig);
-                        if (sl != sub_list.end())
+                        auto iter = canon_list.find(code);
+                        if (iter != canon_list.end())
                         {
-                            for (auto& mpos : sl->second)
-                            {
-                                d_graph_t& motif = mpos.second;
-                                typename wrap_directed::apply<Graph,d_graph_t>::type
-                                    umotif(motif);
-                                if (comp_iso)
-                                {
-                                    if (isomorphism(umotif, usub,
-                                                    vertex_index1_map(get(boost::vertex_index, umotif)).
-                                                    vertex_index2_map(get(boost::vertex_index, usub))))
-                                        found = true;
-                                }
-                                else
-                                {
-                                    if (graph_cmp(umotif, usub))
-                                        found = true;
-                                }
-                                if (found)
-                                {
-                                    pos = mpos.first;
-                                    hist[pos]++;
-                                    break;
-                                }
-                            }
+                            pos = iter->second;
+                            hist[pos]++;
+                            found = true;
                         }
-
-                        if (found == false && fill_list)
+                        else if (fill_list)
                         {
                             subgraph_list.push_back(sub);
-                            sub_list[sig].emplace_back(subgraph_list.size() - 1,
-                                                       sub);
                             hist.push_back(1);
                             pos = hist.size() - 1;
+                            canon_list[code] = pos;
                             found = true;
                         }
+                    }
+                    else
+                    {
+                        found = find_subgraph<Graph>(usub, sub, sig, sub_list,
+                                                     subgraph_list, hist,
+                                                     pos);
+                    }
 
-                        if (found && collect_vmaps)
-                        {
-                            if (pos >= vmaps.size())
-                                vmaps.resize(pos + 1);
-                            vmaps[pos].push_back(VMap(get(boost::vertex_index,sub)));
-                            for (size_t vi = 0; vi < num_vertices(sub); ++vi)
-                                vmaps[pos].back()[vertex(vi, sub)] = subgraphs[j][vi];
-                        }
+                    if (found && collect_vmaps)
+                    {
+                        if (pos >= vmaps.size())
+                            vmaps.resize(pos + 1);
+                        vmaps[pos].push_back(VMap(get(boost::vertex_index,sub)));
+                        for (size_t vi = 0; vi < num_vertices(sub); ++vi)
+                            vmaps[pos].back()[vertex(vi, sub)] = subgraphs[j][vi];
                     }
                 }
             }
@@ -0,0 +1,386 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_TRIANGLES_HH
+#define GRAPH_TRIANGLES_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace boost;
+using namespace std;
+
+// Triangle counting with the "forward" algorithm. Each pair of adjacent
+// vertices is oriented from the vertex of lower degree to the one of higher
+// degree (ties broken by index), which leaves every vertex with O(sqrt(E))
+// out-neighbors, and every triangle is found exactly once, as the
+// intersection of the oriented neighborhoods of the endpoints of its lowest
+// edge. The oriented adjacency is stored in CSR form, with the vertices
+// relabeled by rank and the lists sorted, so that the intersections are
+// linear merges (or galloping searches, when the lists are of very different
+// sizes), and the work is split across threads by blocks of oriented edges,
+// rather than by vertex.
+//
+// The counts follow the same convention as get_triangles(): self-loops are
+// ignored, and parallel edges (and, for directed graphs, the edge directions)
+// are taken into account by storing for each oriented edge the number of
+// edges in each direction.
+template <class Index>
+class triangle_counter
+{
+public:
+    template <class Graph>
+    explicit triangle_counter(const Graph& g)
+        : _directed(graph_tool::is_directed(g))
+    {
+        size_t N = num_vertices(g);
+
+        vector<size_t> deg(N, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 deg[v] = out_degree(v, g);
+                 if (graph_tool::is_directed(g))
+                     deg[v] += in_degreeS()(v, g);
+             });
+
+        // the vertices are relabeled by their rank in the orientation order
+        _order.resize(N);
+        for (size_t v = 0; v < N; ++v)
+            _order[v] = v;
+        std::sort(_order.begin(), _order.end(),
+                  [&](size_t u, size_t v)
+                  {
+                      return (deg[u] < deg[v]) || (deg[u] == deg[v] && u < v);
+                  });
+        vector<Index> rank(N);
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t r = 0; r < N; ++r)
+            rank[_order[r]] = r;
+        deg.clear();
+        deg.shrink_to_fit();
+
+        // first the oriented arcs of each vertex are collected, with parallel
+        // edges repeated, and the direction of the original edge
+        vector<size_t> arc_pos(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t k = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                     k += rank[u] > rank[v];
+                 if (graph_tool::is_directed(g))
+                 {
+                     for (auto e : in_edges_range(v, g))
+                         k += rank[source(e, g)] > rank[v];
+                 }
+                 arc_pos[rank[v] + 1] = k;
+             });
+        for (size_t r = 0; r < N; ++r)
+            arc_pos[r + 1] += arc_pos[r];
+
+        vector<pair<Index, bool>> arcs(arc_pos[N]);
+        vector<size_t> n_out(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t r = rank[v];
+                 size_t pos = arc_pos[r];
+                 for (auto u : out_neighbors_range(v, g))
+                 {
+                     if (rank[u] > r)
+                         arcs[pos++] = {rank[u], true};
+                 }
+                 if (graph_tool::is_directed(g))
+                 {
+                     for (auto e : in_edges_range(v, g))
+                     {
+                         auto s = rank[source(e, g)];
+                         if (s > r)
+                             arcs[pos++] = {s, false};
+                     }
+                 }
+
+                 auto begin = arcs.begin() + arc_pos[r];
+                 auto end = arcs.begin() + pos;
+                 std::sort(begin, end);
+                 size_t k = 0;
+                 for (auto iter = begin; iter != end; ++iter)
+                 {
+                     if (iter == begin || iter->first != (iter - 1)->first)
+                         ++k;
+                 }
+                 n_out[r + 1] = k;
+             });
+
+        _pos.resize(N + 1, 0);
+        for (size_t r = 0; r < N; ++r)
+            _pos[r + 1] = _pos[r] + n_out[r + 1];
+
+        size_t M = _pos[N];
+        _out.resize(M);
+        _fwd.resize(M, 0);
+        if (_directed)
+            _bwd.resize(M, 0);
+
+        // then the repeated arcs are merged into the edge multiplicities
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t r = 0; r < N; ++r)
+        {
+            size_t pos = _pos[r];
+            for (size_t i = arc_pos[r]; i < arc_pos[r + 1]; ++i)
+            {
+                auto& a = arcs[i];
+                if (i > arc_pos[r] && a.first == arcs[i - 1].first)
+                    --pos;
+                _out[pos] = a.first;
+                if (a.second || !_directed)
+                    ++_fwd[pos];
+                else
+                    ++_bwd[pos];
+                ++pos;
+            }
+        }
+    }
+
+    // Puts in tri[v], for every vertex v, the total number of closed paths
+    // v -> u -> w with v -> w, with the edge multiplicities, as computed by
+    // get_triangles() (before the halving done for undirected graphs). If
+    // simple == true, the multiplicities are ignored, i.e. the paths are
+    // counted as in the simple graph with the parallel edges merged.
+    void count(vector<size_t>& tri, bool simple = false) const
+    {
+        size_t N = _pos.size() - 1;
+        size_t M = _pos[N];
+        tri.clear();
+        tri.resize(N, 0);
+
+        constexpr size_t block = 1024;
+        size_t n_blocks = (M + block - 1) / block;
+
+        #pragma omp parallel for if (M > OPENMP_MIN_THRESH) \
+            schedule(dynamic, 1)
+        for (size_t b = 0; b < n_blocks; ++b)
+        {
+            size_t e_begin = b * block;
+            size_t e_end = std::min(e_begin + block, M);
+            size_t v = std::upper_bound(_pos.begin(), _pos.end(), e_begin)
+                - _pos.begin() - 1;
+            for (size_t e = e_begin; e < e_end; ++e)
+            {
+                while (_pos[v + 1] <= e)
+                    ++v;
+                size_t u = _out[e];
+
+                // only the out-neighbors of v after u can also be
+                // out-neighbors of u
+                intersect(e + 1, _pos[v + 1], _pos[u], _pos[u + 1],
+                          [&](size_t ew, size_t uw)
+                          {
+                              add_triangle(v, u, _out[ew], e, ew, uw,
+                                           simple, tri);
+                          });
+            }
+        }
+    }
+
+private:
+    size_t fwd(size_t e) const { return _fwd[e]; }
+    size_t bwd(size_t e) const { return _directed ? _bwd[e] : _fwd[e]; }
+
+    // Adds the contributions of the triangle (v, u, w), given by the vertex
+    // ranks, to its three vertices, where e, ew and uw are the oriented edges v -> u, v -> w and
+    // u -> w, respectively. Vertex x, with the other two being y and z, gets
+    // m(x,y) m(y,z) [m(x,z) > 0] + m(x,z) m(z,y) [m(x,y) > 0], where m(x,y)
+    // is the number of edges from x to y.
+    void add_triangle(size_t v, size_t u, size_t w, size_t e, size_t ew,
+                      size_t uw, bool simple, vector<size_t>& tri) const
+    {
+        size_t m_vu = fwd(e),  m_uv = bwd(e);
+        size_t m_vw = fwd(ew), m_wv = bwd(ew);
+        size_t m_uw = fwd(uw), m_wu = bwd(uw);
+        if (simple)
+        {
+            for (auto m : {&m_vu, &m_uv, &m_vw, &m_wv, &m_uw, &m_wu})
+                *m = (*m > 0);
+        }
+
+        size_t tv = m_vu * m_uw * (m_vw > 0) + m_vw * m_wu * (m_vu > 0);
+        size_t tu = m_uv * m_vw * (m_uw > 0) + m_uw * m_wv * (m_uv > 0);
+        size_t tw = m_wv * m_vu * (m_wu > 0) + m_wu * m_uv * (m_wv > 0);
+
+        #pragma omp atomic
+        tri[_order[v]] += tv;
+        #pragma omp atomic
+        tri[_order[u]] += tu;
+        #pragma omp atomic
+        tri[_order[w]] += tw;
+    }
+
+    // Calls f(i, j) for every pair of positions with _out[i] == _out[j], in
+    // the sorted ranges [a, a_end) and [b, b_end).
+    template <class F>
+    void intersect(size_t a, size_t a_end, size_t b, size_t b_end,
+                   F&& f) const
+    {
+        size_t na = a_end - a;
+        size_t nb = b_end - b;
+        if (na == 0 || nb == 0)
+            return;
+
+        if (na * gallop_ratio < nb)
+        {
+            gallop(a, a_end, b, b_end, f, false);
+            return;
+        }
+        if (nb * gallop_ratio < na)
+        {
+            gallop(b, b_end, a, a_end, f, true);
+            return;
+        }
+
+        // branchless merge
+        const Index* out = _out.data();
+        while (a < a_end && b < b_end)
+        {
+            Index x = out[a];
+            Index y = out[b];
+            if (x == y)
+                f(a, b);
+            a += (x <= y);
+            b += (y <= x);
+        }
+    }
+
+    // For each element of the short range, the long range is searched with
+    // exponentially growing steps from the last position found.
+    template <class F>
+    void gallop(size_t a, size_t a_end, size_t b, size_t b_end, F& f,
+                bool swapped) const
+    {
+        auto out = _out.begin();
+        for (; a < a_end && b < b_end; ++a)
+        {
+            Index x = _out[a];
+            size_t step = 1;
+            size_t hi = b;
+            while (hi < b_end && _out[hi] < x)
+            {
+                b = hi + 1;
+                hi += step;
+                step *= 2;
+            }
+            hi = std::min(hi + 1, b_end);
+            b = std::lower_bound(out + b, out + hi, x) - out;
+            if (b < b_end && _out[b] == x)
+            {
+                if (swapped)
+                    f(b, a);
+                else
+                    f(a, b);
+                ++b;
+            }
+        }
+    }
+
+    static constexpr size_t gallop_ratio = 32;
+
+    bool _directed;
+    vector<Index> _order;
+    vector<size_t> _pos;
+    vector<Index> _out;
+    vector<uint32_t> _fwd;
+    vector<uint32_t> _bwd;
+};
+
+// Puts in tri[v] the number of triangles to which each vertex v belongs, and
+// in pairs[v] its number of pairs of neighbors, in the same convention as
+// get_triangles().
+template <class Graph>
+void get_all_triangles(const Graph& g, vector<size_t>& tri,
+                       vector<size_t>& pairs)
+{
+    size_t N = num_vertices(g);
+    if (N <= numeric_limits<uint32_t>::max())
+        triangle_counter<uint32_t>(g).count(tri);
+    else
+        triangle_counter<size_t>(g).count(tri);
+
+    pairs.clear();
+    pairs.resize(N, 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             size_t k = out_degree(v, g);
+             if (graph_tool::is_directed(g))
+             {
+                 pairs[v] = k * (k - 1);
+             }
+             else
+             {
+                 tri[v] /= 2;
+                 pairs[v] = (k * (k - 1)) / 2;
+             }
+         });
+}
+
+// Puts in tri[v] the number of triangles to which each vertex v of the
+// undirected graph g belongs, and in deg[v] its number of distinct neighbors
+// other than itself, i.e. as in the simple graph obtained by merging the
+// parallel edges and removing the self-loops.
+template <class Graph>
+void get_all_simple_triangles(const Graph& g, vector<size_t>& tri,
+                              vector<size_t>& deg)
+{
+    size_t N = num_vertices(g);
+    if (N <= numeric_limits<uint32_t>::max())
+        triangle_counter<uint32_t>(g).count(tri, true);
+    else
+        triangle_counter<size_t>(g).count(tri, true);
+
+    deg.clear();
+    deg.resize(N, 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             tri[v] /= 2;
+             vector<size_t> ns;
+             for (auto u : out_neighbors_range(v, g))
+             {
+                 if (u != v)
+                     ns.push_back(u);
+             }
+             std::sort(ns.begin(), ns.end());
+             deg[v] = std::unique(ns.begin(), ns.end()) - ns.begin();
+         });
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_TRIANGLES_HH
@@ -27,12 +27,13 @@ using namespace graph_tool;
 
 pair<double,double>
 assortativity_coefficient(GraphInterface& gi,
-                          GraphInterface::deg_t deg)
+                          GraphInterface::deg_t deg, string jackknife)
 {
     double a = 0, a_err = 0;
+    jackknife_t jk = get_jackknife(jackknife);
     run_action<>()(gi,std::bind(get_assortativity_coefficient(),
                                 std::placeholders::_1, std::placeholders::_2,
-                                std::ref(a), std::ref(a_err)),
+                                jk, std::ref(a), std::ref(a_err)),
                    scalar_selectors())
         (degree_selector(deg));
     return make_pair(a, a_err);
@@ -40,12 +41,13 @@ assortativity_coefficient(GraphInterface& gi,
 
 pair<double,double>
 scalar_assortativity_coefficient(GraphInterface& gi,
-                                 GraphInterface::deg_t deg)
+                                 GraphInterface::deg_t deg, string jackknife)
 {
     double a = 0, a_err = 0;
+    jackknife_t jk = get_jackknife(jackknife);
     run_action<>()(gi, std::bind(get_scalar_assortativity_coefficient(),
                                  std::placeholders::_1, std::placeholders::_2,
-                                 std::ref(a), std::ref(a_err)),
+                                 jk, std::ref(a), std::ref(a_err)),
                    scalar_selectors())
         (degree_selector(deg));
     return make_pair(a, a_err);
@@ -21,6 +21,7 @@
 #include "shared_map.hh"
 #include "graph_util.hh"
 #include "hash_map_wrap.hh"
+#include "graph_exceptions.hh"
 
 #if (BOOST_VERSION >= 106000)
 # include <boost/math/special_functions/relative_difference.hpp>
@@ -31,6 +32,29 @@ namespace graph_tool
 using namespace std;
 using namespace boost;
 
+// how the "jackknife" variance of the coefficients is obtained
+enum class jackknife_t
+{
+    none,  // not computed
+    sweep, // with a second pass over all edges
+    pairs  // from the number of edges between each distinct pair of values,
+           // collected during the first pass
+};
+
+inline jackknife_t get_jackknife(const string& jackknife)
+{
+    if (jackknife == "none")
+        return jackknife_t::none;
+    if (jackknife == "sweep")
+        return jackknife_t::sweep;
+    if (jackknife == "pairs")
+        return jackknife_t::pairs;
+    throw ValueException("invalid jackknife method: " + jackknife);
+}
+
+// counts of each pair of values at the endpoints of the edges
+template <class Val>
+using value_pairs_t = gt_hash_map<pair<Val, Val>, size_t>;
 
 // this will calculate the assortativity coefficient, based on the property
 // pointed by 'deg'
@@ -38,8 +62,104 @@ using namespace boost;
 struct get_assortativity_coefficient
 {
     template <class Graph, class DegreeSelector>
-    void operator()(const Graph& g, DegreeSelector deg, double& r,
-                    double& r_err) const
+    void operator()(const Graph& g, DegreeSelector deg, jackknife_t jk,
+                    double& r, double& r_err) const
+    {
+        typedef typename DegreeSelector::value_type val_t;
+        dispatch(g, deg, jk, r, r_err, std::is_integral<val_t>());
+    }
+
+    // For integer values (e.g. degrees) within a range not much larger than
+    // the number of vertices, the counts are kept in dense arrays, indexed
+    // by the value minus the smallest one, instead of hash maps.
+    template <class Graph, class DegreeSelector>
+    void dispatch(const Graph& g, DegreeSelector deg, jackknife_t jk,
+                  double& r, double& r_err, std::true_type) const
+    {
+        typedef typename DegreeSelector::value_type val_t;
+        if (num_vertices(g) == 0)
+        {
+            dispatch(g, deg, jk, r, r_err, std::false_type());
+            return;
+        }
+
+        val_t k_min = numeric_limits<val_t>::max();
+        val_t k_max = numeric_limits<val_t>::lowest();
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            reduction(min:k_min) reduction(max:k_max)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 val_t k = deg(v, g);
+                 k_min = std::min(k_min, k);
+                 k_max = std::max(k_max, k);
+             });
+
+        if (k_max < k_min ||
+            double(k_max) - double(k_min) >= num_vertices(g) + 1024)
+        {
+            dispatch(g, deg, jk, r, r_err, std::false_type());
+            return;
+        }
+
+        size_t R = size_t(k_max - k_min) + 1;
+        vector<size_t> a(R, 0), b(R, 0);
+        size_t n_edges = 0;
+        size_t e_kk = 0;
+
+        value_pairs_t<val_t> pairs;
+        SharedMap<value_pairs_t<val_t>> spairs(pairs);
+        bool count_pairs = (jk == jackknife_t::pairs);
+
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(spairs) reduction(+:e_kk, n_edges)
+        {
+            vector<size_t> la(R, 0), lb(R, 0);
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
+                 {
+                     val_t k1 = deg(v, g);
+                     size_t i1 = k1 - k_min;
+                     size_t n = 0;
+                     for (auto w : out_neighbors_range(v, g))
+                     {
+                         val_t k2 = deg(w, g);
+                         size_t i2 = k2 - k_min;
+                         if (i1 == i2)
+                             e_kk++;
+                         lb[i2]++;
+                         if (count_pairs)
+                             spairs[make_pair(k1, k2)]++;
+                         n++;
+                     }
+                     la[i1] += n;
+                     n_edges += n;
+                 });
+
+            #pragma omp critical
+            for (size_t i = 0; i < R; ++i)
+            {
+                a[i] += la[i];
+                b[i] += lb[i];
+            }
+            spairs.Gather();
+        }
+
+        double t2 = 0;
+        for (size_t i = 0; i < R; ++i)
+            t2 += double(a[i]) * b[i];
+
+        get_coefficient(g, deg, jk, e_kk, n_edges, t2,
+                        [&](val_t k) { return a[k - k_min]; },
+                        [&](val_t k) { return b[k - k_min]; },
+                        pairs, r, r_err);
+    }
+
+    template <class Graph, class DegreeSelector>
+    void dispatch(const Graph& g, DegreeSelector deg, jackknife_t jk,
+                  double& r, double& r_err, std::false_type) const
     {
         size_t n_edges = 0;
         size_t e_kk = 0;
@@ -47,10 +167,13 @@ struct get_assortativity_coefficient
         typedef typename DegreeSelector::value_type val_t;
         typedef gt_hash_map<val_t, size_t> map_t;
         map_t a, b;
+        value_pairs_t<val_t> pairs;
+        bool count_pairs = (jk == jackknife_t::pairs);
 
         SharedMap<map_t> sa(a), sb(b);
+        SharedMap<value_pairs_t<val_t>> spairs(pairs);
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(sa, sb) reduction(+:e_kk, n_edges)
+            firstprivate(sa, sb, spairs) reduction(+:e_kk, n_edges)
         parallel_vertex_loop_no_spawn
             (g,
              [&](auto v)
@@ -63,23 +186,51 @@ struct get_assortativity_coefficient
                          e_kk++;
                      sa[k1]++;
                      sb[k2]++;
+                     if (count_pairs)
+                         spairs[make_pair(k1, k2)]++;
                      n_edges++;
                  }
              });
 
         sa.Gather();
         sb.Gather();
+        spairs.Gather();
 
-        double t1 = double(e_kk) / n_edges, t2 = 0.0;
-
+        double t2 = 0.0;
         for (auto& ai : a)
         {
             auto bi = b.find(ai.first);
             if (bi != b.end())
                 t2 += ai.second * bi->second;
         }
-        t2 /= n_edges * n_edges;
 
+        // the maps are not modified by the lookups, since they are done in
+        // parallel
+        auto count = [](const map_t& m, const val_t& k) -> size_t
+            {
+                auto iter = m.find(k);
+                return (iter != m.end()) ? iter->second : 0;
+            };
+        get_coefficient(g, deg, jk, e_kk, n_edges, t2,
+                        [&](const val_t& k) { return count(a, k); },
+                        [&](const val_t& k) { return count(b, k); },
+                        pairs, r, r_err);
+    }
+
+    // computes the coefficient and its "jackknife" variance from the number
+    // e_kk of edges with equal values at both ends, and t2 = sum_k a_k b_k,
+    // where a(k) and b(k) are the number of edges with value k at the source
+    // and target, respectively
+    template <class Graph, class DegreeSelector, class A, class B,
+              class Pairs>
+    void get_coefficient(const Graph& g, DegreeSelector deg, jackknife_t jk,
+                         size_t e_kk, size_t n_edges, double t2, A&& a, B&& b,
+                         Pairs& pairs, double& r, double& r_err) const
+    {
+        typedef typename DegreeSelector::value_type val_t;
+
+        double t1 = double(e_kk) / n_edges;
+        t2 /= n_edges * n_edges;
 
 #if (BOOST_VERSION >= 106000)
         if (boost::math::relative_difference(1., t2) > 1e-8)
@@ -90,30 +241,50 @@ struct get_assortativity_coefficient
         else
             r = std::numeric_limits<double>::quiet_NaN();
 
-        // "jackknife" variance
-        double err = 0;
+        r_err = std::numeric_limits<double>::quiet_NaN();
+        if (jk == jackknife_t::none)
+            return;
+
+        // "jackknife" variance; the coefficient without a given edge depends
+        // only on the values at its endpoints
         size_t one = (graph_tool::is_directed(g)) ? 1 : 2;
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            reduction(+:err)
-        parallel_vertex_loop_no_spawn
-            (g,
-             [&](auto v)
-             {
-                 val_t k1 = deg(v, g);
-                 for (auto w : out_neighbors_range(v, g))
+        auto rl = [&](const val_t& k1, const val_t& k2)
+            {
+                double tl2 = (t2 * (n_edges * n_edges)
+                              - one * b(k1) - one * a(k2)) /
+                    ((n_edges - one) * (n_edges - one));
+                double tl1 = t1 * n_edges;
+                if (k1 == k2)
+                    tl1 -= one;
+                tl1 /= n_edges - one;
+                return (tl1 - tl2) / (1.0 - tl2);
+            };
+
+        double err = 0;
+        if (jk == jackknife_t::pairs)
+        {
+            for (auto& kn : pairs)
+            {
+                double d = r - rl(kn.first.first, kn.first.second);
+                err += kn.second * d * d;
+            }
+        }
+        else
+        {
+            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+                reduction(+:err)
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
                  {
-                     val_t k2 = deg(w, g);
-                     double tl2 = (t2 * (n_edges * n_edges)
-                                   - one * b[k1] - one * a[k2]) /
-                         ((n_edges - one) * (n_edges - one));
-                     double tl1 = t1 * n_edges;
-                     if (k1 == k2)
-                         tl1 -= one;
-                     tl1 /= n_edges - one;
-                     double rl = (tl1 - tl2) / (1.0 - tl2);
-                     err += (r - rl) * (r - rl);
-                }
-             });
+                     val_t k1 = deg(v, g);
+                     for (auto w : out_neighbors_range(v, g))
+                     {
+                         double d = r - rl(k1, deg(w, g));
+                         err += d * d;
+                     }
+                 });
+        }
         if (!graph_tool::is_directed(g))
             err /= 2;
 #if (BOOST_VERSION >= 106000)
@@ -122,8 +293,6 @@ struct get_assortativity_coefficient
         if (abs(1.-t2) > 1e-8)
 #endif
             r_err = sqrt(err);
-        else
-            r_err = std::numeric_limits<double>::quiet_NaN();
     }
 };
 
@@ -133,15 +302,21 @@ struct get_assortativity_coefficient
 struct get_scalar_assortativity_coefficient
 {
     template <class Graph, class DegreeSelector>
-    void operator()(const Graph& g, DegreeSelector deg, double& r,
-                    double& r_err) const
+    void operator()(const Graph& g, DegreeSelector deg, jackknife_t jk,
+                    double& r, double& r_err) const
     {
+        typedef typename DegreeSelector::value_type val_t;
+
         size_t n_edges = 0;
         double e_xy = 0;
         double a = 0, b = 0, da = 0, db = 0;
 
+        value_pairs_t<val_t> pairs;
+        SharedMap<value_pairs_t<val_t>> spairs(pairs);
+        bool count_pairs = (jk == jackknife_t::pairs);
+
         #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            reduction(+:e_xy,n_edges,a,b,da,db)
+            firstprivate(spairs) reduction(+:e_xy,n_edges,a,b,da,db)
         parallel_vertex_loop_no_spawn
             (g,
              [&](auto v)
@@ -155,10 +330,26 @@ struct get_scalar_assortativity_coefficient
                      b += k2;
                      db += k2 * k2;
                      e_xy += k1 * k2;
+                     if (count_pairs)
+                         spairs[make_pair(k1, k2)]++;
                      n_edges++;
                  }
              });
+        spairs.Gather();
+
+        get_coefficient(g, deg, jk, n_edges, e_xy, a, b, da, db, pairs, r,
+                        r_err);
+    }
 
+    // computes the coefficient and its "jackknife" variance from the sums
+    // over all edges of the source and target values (a and b), of their
+    // squares (da and db), and of their products (e_xy)
+    template <class Graph, class DegreeSelector, class Pairs>
+    void get_coefficient(const Graph& g, DegreeSelector deg, jackknife_t jk,
+                         size_t n_edges, double e_xy, double a, double b,
+                         double da, double db, Pairs& pairs, double& r,
+                         double& r_err) const
+    {
         double t1 = e_xy/n_edges;
         a /= n_edges;
         b /= n_edges;
@@ -190,41 +381,63 @@ struct get_scalar_assortativity_coefficient
         else
             r = std::numeric_limits<double>::quiet_NaN();
 
-        // "jackknife" variance
-        r_err = 0.0;
+        r_err = std::numeric_limits<double>::quiet_NaN();
+        if (jk == jackknife_t::none)
+            return;
 
-        double err = 0.0;
+        // "jackknife" variance
         size_t one = (graph_tool::is_directed(g)) ? 1 : 2;
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            reduction(+:err)
-        parallel_vertex_loop_no_spawn
-            (g,
-             [&](auto v)
-             {
-                 double k1 = double(deg(v, g));
-                 double al = (a * n_edges - k1) / (n_edges - one);
-                 double dal = sqrt((da - k1 * k1) / (n_edges - one) - al * al);
+        auto source_stats = [&](double k1)
+            {
+                double al = (a * n_edges - k1) / (n_edges - one);
+                double dal = sqrt((da - k1 * k1) / (n_edges - one) - al * al);
+                return make_pair(al, dal);
+            };
+        auto rl = [&](double k1, double al, double dal, double k2)
+            {
+                double bl = (b * n_edges - k2 * one) / (n_edges - one);
+                double dbl = sqrt((db - k2 * k2 * one) / (n_edges - one) - bl * bl);
+                double t1l = (e_xy - k1 * k2 * one)/(n_edges - one);
+                if (dal * dbl > 0)
+                    return (t1l - al * bl)/(dal * dbl);
+                else
+                    return (t1l - al * bl);
+            };
 
-                 for (auto u : out_neighbors_range(v, g))
+        double err = 0.0;
+        if (jk == jackknife_t::pairs)
+        {
+            for (auto& kn : pairs)
+            {
+                double k1 = double(kn.first.first);
+                auto s = source_stats(k1);
+                double d = r - rl(k1, s.first, s.second,
+                                  double(kn.first.second));
+                err += kn.second * d * d;
+            }
+        }
+        else
+        {
+            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+                reduction(+:err)
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
                  {
-                     double k2 = deg(u, g);
-                     double bl = (b * n_edges - k2 * one) / (n_edges - one);
-                     double dbl = sqrt((db - k2 * k2 * one) / (n_edges - one) - bl * bl);
-                     double t1l = (e_xy - k1 * k2 * one)/(n_edges - one);
-                     double rl;
-                     if (dal * dbl > 0)
-                         rl = (t1l - al * bl)/(dal * dbl);
-                     else
-                         rl = (t1l - al * bl);
-                     err += (r - rl) * (r - rl);
-                 }
-             });
+                     double k1 = double(deg(v, g));
+                     auto s = source_stats(k1);
+                     for (auto u : out_neighbors_range(v, g))
+                     {
+                         double d = r - rl(k1, s.first, s.second,
+                                           double(deg(u, g)));
+                         err += d * d;
+                     }
+                 });
+        }
         if (!graph_tool::is_directed(g))
             err /= 2;
         if (stda*stdb > 0)
             r_err = sqrt(err);
-        else
-            r_err = std::numeric_limits<double>::quiet_NaN();
     }
 };
 
@@ -413,39 +413,148 @@ struct Converter
 };
 
 
+// index of a vertex or edge in the attribute arrays
+template <class Vertex>
+typename std::enable_if<std::is_integral<Vertex>::value, size_t>::type
+attr_index(Vertex v)
+{
+    return v;
+}
+
+template <class Vertex>
+size_t attr_index(const boost::detail::adj_edge_descriptor<Vertex>& e)
+{
+    return e.idx;
+}
+
+template <class Graph>
+auto attr_range(Graph& g, typename graph_traits<Graph>::vertex_descriptor*)
+{
+    return vertices_range(g);
+}
+
+template <class Graph>
+auto attr_range(Graph& g, typename graph_traits<Graph>::edge_descriptor*)
+{
+    return edges_range(g);
+}
+
+template <class Descriptor, class Range>
+struct fill_attr_array
+{
+    fill_attr_array(int k, boost::any& pmap, boost::any& value, Range& range)
+        : _k(k), _pmap(pmap), _value(value), _range(range) {}
+    int _k;
+    boost::any& _pmap;
+    boost::any& _value;
+    Range& _range;
+
+    template <class ValueType>
+    void operator()(ValueType) const
+    {
+        typedef typename ValueType::second val_t;
+        typedef DynamicPropertyMapWrap<val_t, Descriptor, Converter> pmap_t;
+
+        if (_k != ValueType::first::value)
+            return;
+
+        pmap_t pmap(any_cast<pmap_t>(_pmap));
+        vector<val_t> values;
+        for (auto d : _range)
+        {
+            size_t i = attr_index(d);
+            if (i >= values.size())
+                values.resize(i + 1);
+            values[i] = pmap.get(d);
+        }
+        _value = std::move(values);
+    }
+};
+
+// The attribute values of all the vertices or edges of a graph, resolved once
+// before drawing. The values given by property maps are converted to the
+// attribute type and stored in a contiguous array indexed by the vertex or
+// edge index, and the default values are stored as they are, so that a lookup
+// during drawing amounts to indexing an array. The conversion may involve
+// Python objects, so this must be constructed with the GIL held.
 template <class Descriptor>
-class AttrDict
+class AttrArrays
 {
 public:
-    AttrDict(Descriptor descriptor, attrs_t& attrs, attrs_t& defaults)
-        : _descriptor(descriptor), _attrs(attrs), _defaults(defaults) {}
+    template <class Graph>
+    AttrArrays(Graph& g, attrs_t& attrs, attrs_t& defaults)
+    {
+        for (auto& kv : defaults)
+            slot(kv.first) = kv.second;
+
+        auto range = attr_range(g, (Descriptor*) nullptr);
+        for (auto& kv : attrs)
+            boost::mpl::for_each<attr_types>
+                (fill_attr_array<Descriptor, decltype(range)>
+                     (kv.first, kv.second, slot(kv.first), range));
+    }
 
     template <class Value>
-    Value get(int k)
+    const Value& get(int k, const Descriptor& d) const
     {
-        auto iter = _attrs.find(k);
-        if (iter != _attrs.end())
-        {
-            typedef DynamicPropertyMapWrap<Value, Descriptor, Converter> pmap_t;
-            pmap_t pmap(any_cast<pmap_t>(iter->second));
-            return pmap.get(_descriptor);
-        }
-        try
-        {
-            return any_cast<Value>(_defaults[k]);
-        }
-        catch (bad_any_cast&)
+        const boost::any* a = (size_t(k - _base) < _values.size()) ?
+            &_values[k - _base] : nullptr;
+        if (a != nullptr)
         {
-            throw ValueException("Error getting attribute " + lexical_cast<string>(k) +
-                                 ", wanted: " + name_demangle(typeid(Value).name()) +
-                                 ", got: " + name_demangle(_defaults[k].type().name()));
+            if (auto* values = any_cast<vector<Value>>(a))
+                return (*values)[attr_index(d)];
+            if (auto* value = any_cast<Value>(a))
+                return *value;
         }
+        throw ValueException("Error getting attribute " + lexical_cast<string>(k) +
+                             ", wanted: " + name_demangle(typeid(Value).name()) +
+                             ", got: " + ((a == nullptr) ? string("nothing") :
+                                          name_demangle(a->type().name())));
+    }
+
+    bool has(int k) const
+    {
+        return (size_t(k - _base) < _values.size() &&
+                !_values[k - _base].empty());
+    }
+
+private:
+    boost::any& slot(int k)
+    {
+        // the vertex and edge attributes are numbered from a multiple of 100
+        if (_values.empty())
+            _base = (k / 100) * 100;
+        if (size_t(k - _base) >= _values.size())
+            _values.resize(k - _base + 1);
+        return _values[k - _base];
+    }
+
+    int _base = 0;
+    vector<boost::any> _values;
+};
+
+// The attributes of a single vertex or edge.
+template <class Descriptor>
+class AttrDict
+{
+public:
+    AttrDict(Descriptor descriptor, AttrArrays<Descriptor>& attrs)
+        : _descriptor(descriptor), _attrs(attrs) {}
+
+    template <class Value>
+    const Value& get(int k)
+    {
+        return _attrs.template get<Value>(k, _descriptor);
+    }
+
+    bool has(int k)
+    {
+        return _attrs.has(k);
     }
 
 private:
     Descriptor _descriptor;
-    attrs_t& _attrs;
-    attrs_t& _defaults;
+    AttrArrays<Descriptor>& _attrs;
 };
 
 void draw_polygon(size_t N, double radius, Cairo::Context& cr)
@@ -525,6 +634,48 @@ double get_user_dist(Cairo::Context& cr, double norm = 1.)
     return sqrt(x * x + y * y);
 }
 
+// The visible region of the surface, in user coordinates, and the size of a
+// device pixel in the same units. The elements that fall outside of the region
+// are not drawn. For raster surfaces, level-of-detail simplifications are also
+// done for elements smaller than a pixel; these are disabled for vector
+// surfaces, which may be magnified later.
+struct viewport_t
+{
+    viewport_t(Cairo::Context& cr)
+    {
+        cr.get_clip_extents(x1, y1, x2, y2);
+        pixel = get_user_dist(cr);
+        switch (cairo_surface_get_type(cr.get_target()->cobj()))
+        {
+        case CAIRO_SURFACE_TYPE_PDF:
+        case CAIRO_SURFACE_TYPE_PS:
+        case CAIRO_SURFACE_TYPE_SVG:
+        case CAIRO_SURFACE_TYPE_RECORDING:
+        case CAIRO_SURFACE_TYPE_SCRIPT:
+            lod = false;
+            break;
+        default:
+            lod = true;
+        }
+    }
+
+    // whether the box [bx1, bx2] x [by1, by2] intersects the visible region
+    bool visible(double bx1, double by1, double bx2, double by2) const
+    {
+        return !(bx2 < x1 || bx1 > x2 || by2 < y1 || by1 > y2);
+    }
+
+    bool visible(const pos_t& pos, double r) const
+    {
+        return visible(pos.first - r, pos.second - r, pos.first + r,
+                       pos.second + r);
+    }
+
+    double x1, y1, x2, y2;
+    double pixel;
+    bool lod;
+};
+
 void get_surface_size(Cairo::RefPtr<Cairo::Surface> sfc,
                       double& width, double& height)
 {
@@ -787,18 +938,28 @@ public:
         return _pos;
     }
 
+    // half-width of a box around the position that contains the whole vertex,
+    // or -1 if it is not known, i.e. if the text is placed outside the shape
+    double get_extent(Cairo::Context& cr)
+    {
+        string text = _attrs.template get<string>(VERTEX_TEXT);
+        if (!text.empty() &&
+            _attrs.template get<double>(VERTEX_TEXT_POSITION) != -1)
+            return -1;
+        double r = get_size(cr) / 2;
+        r *= max(_attrs.template get<double>(VERTEX_ASPECT), 1.);
+        if (_attrs.template get<uint8_t>(VERTEX_HALO))
+            r *= max(_attrs.template get<double>(VERTEX_HALO_SIZE), 1.);
+        r += get_user_dist(cr, _attrs.template get<double>(VERTEX_PENWIDTH));
+        return r;
+    }
+
     void draw(Cairo::Context& cr, bool outline=false)
     {
         color_t color, fillcolor;
         double size, pw;
         size = get_size(cr);
 
-        std::array<double, 4> clip;
-        cr.get_clip_extents(clip[0], clip[1], clip[2], clip[3]);
-        if ((_pos.first + 2 * size < clip[0] && _pos.second + 2 * size < clip[1]) ||
-            (_pos.first - 2 * size > clip[2] && _pos.second - 2 * size > clip[3]))
-            return;
-
         double aspect = _attrs.template get<double>(VERTEX_ASPECT);
         double rot = _attrs.template get<double>(VERTEX_ROTATION);
 
@@ -823,7 +984,11 @@ public:
                 cr.restore();
         }
 
-        boost::python::object osrc = _attrs.template get<boost::python::object>(VERTEX_SURFACE);
+        // the surface is not touched if it is not set, so that no Python
+        // objects are accessed (see cairo_draw_tiled())
+        PyObject* osrc = nullptr;
+        if (_attrs.has(VERTEX_SURFACE))
+            osrc = _attrs.template get<boost::python::object>(VERTEX_SURFACE).ptr();
 
         pw =_attrs.template get<double>(VERTEX_PENWIDTH);
         pw = get_user_dist(cr, pw);
@@ -937,10 +1102,10 @@ public:
             cr.stroke();
         }
 
-        if (osrc != boost::python::object() && !outline)
+        if (osrc != nullptr && osrc != Py_None && !outline)
         {
             double swidth, sheight;
-            PycairoSurface* src = (PycairoSurface*) osrc.ptr();
+            PycairoSurface* src = (PycairoSurface*) osrc;
             Cairo::RefPtr<Cairo::Surface> surface(new Cairo::Surface(src->surface));
             get_surface_size(surface, swidth, sheight);
             Cairo::RefPtr<Cairo::SurfacePattern> pat(Cairo::SurfacePattern::create(surface));
@@ -1037,6 +1202,28 @@ protected:
     AttrDict<Descriptor> _attrs;
 };
 
+// Consecutive sloppy edges with the same color and width, and without
+// markers, dashes, gradients or text, are added to a single path, which is
+// stroked at once. The overlaps between the edges in the same path are then
+// not compounded, which matters only for semi-transparent colors.
+struct edge_batch_t
+{
+    void flush(Cairo::Context& cr)
+    {
+        if (count == 0)
+            return;
+        cr.set_source_rgba(get<0>(color), get<1>(color), get<2>(color),
+                           get<3>(color));
+        cr.set_line_width(pw);
+        cr.stroke();
+        count = 0;
+    }
+
+    color_t color;
+    double pw = 0;
+    size_t count = 0;
+};
+
 template <class Descriptor, class VertexShape>
 class EdgeShape
 {
@@ -1044,6 +1231,117 @@ public:
     EdgeShape(VertexShape& s, VertexShape& t, AttrDict<Descriptor> attrs)
         : _s(s), _t(t), _attrs(attrs) {}
 
+    // bounding box of the edge in user coordinates; returns false if it is not
+    // known, i.e. if the edge has text
+    bool get_bbox(Cairo::Context& cr, double& x1, double& y1, double& x2,
+                  double& y2)
+    {
+        if (!_attrs.template get<string>(EDGE_TEXT).empty())
+            return false;
+
+        pos_t pos_begin = _s.get_pos();
+        pos_t pos_end = _t.get_pos();
+
+        double r = get_user_dist(cr, _attrs.template get<double>(EDGE_PENWIDTH));
+        r += get_user_dist(cr, _attrs.template get<double>(EDGE_MARKER_SIZE));
+
+        const vector<double>& controls =
+            _attrs.template get<vector<double> >(EDGE_CONTROL_POINTS);
+        if (controls.size() >= 8)
+        {
+            // the control points are given relative to the line between the
+            // endpoints, scaled by its length only along the line (see draw())
+            double len, sx = 1;
+            if (pos_begin != pos_end)
+            {
+                len = dist(pos_begin, pos_end);
+            }
+            else
+            {
+                len = max(M_PI * _s.get_size(cr),
+                          6 * get_user_dist(cr, _attrs.template get<double>(EDGE_MARKER_SIZE)));
+                len /= sqrt(2);
+                sx = len;
+            }
+            double R = 0;
+            for (size_t i = 0; i + 1 < controls.size(); i += 2)
+                R = max(R, sqrt(pow(controls[i] * len, 2) +
+                                pow(controls[i + 1] * sx, 2)));
+            r += R;
+            x1 = pos_begin.first - r;
+            y1 = pos_begin.second - r;
+            x2 = pos_begin.first + r;
+            y2 = pos_begin.second + r;
+        }
+        else
+        {
+            x1 = min(pos_begin.first, pos_end.first) - r;
+            y1 = min(pos_begin.second, pos_end.second) - r;
+            x2 = max(pos_begin.first, pos_end.first) + r;
+            y2 = max(pos_begin.second, pos_end.second) + r;
+        }
+        return true;
+    }
+
+    // whether the edge needs to be drawn, i.e. if it may intersect the
+    // visible region, and is not transparent or (for raster surfaces) shorter
+    // than half a pixel; edges with text are always drawn
+    bool is_visible(const viewport_t& vp, Cairo::Context& cr)
+    {
+        double x1, y1, x2, y2;
+        if (!get_bbox(cr, x1, y1, x2, y2))
+            return true;
+        if (!vp.visible(x1, y1, x2, y2))
+            return false;
+
+        pos_t pos_begin = _s.get_pos();
+        pos_t pos_end = _t.get_pos();
+        if (vp.lod && pos_begin != pos_end &&
+            _attrs.template get<vector<double> >(EDGE_CONTROL_POINTS).size() < 8 &&
+            dist(pos_begin, pos_end) < vp.pixel / 2)
+            return false;
+
+        const vector<double>& gradient =
+            _attrs.template get<vector<double> >(EDGE_GRADIENT);
+        if (gradient.empty() && get<3>(_attrs.template get<color_t>(EDGE_COLOR)) == 0)
+            return false;
+        return true;
+    }
+
+    // adds the edge to the batch if it can be drawn as part of it, flushing it
+    // first if its color or width differ, and returns whether it was added
+    bool draw_batched(Cairo::Context& cr, edge_batch_t& batch)
+    {
+        if (!_attrs.template get<uint8_t>(EDGE_SLOPPY) ||
+            _attrs.template get<uint8_t>(EDGE_SEAMLESS) ||
+            _attrs.template get<edge_marker_t>(EDGE_START_MARKER) != MARKER_SHAPE_NONE ||
+            _attrs.template get<edge_marker_t>(EDGE_MID_MARKER) != MARKER_SHAPE_NONE ||
+            _attrs.template get<edge_marker_t>(EDGE_END_MARKER) != MARKER_SHAPE_NONE ||
+            !_attrs.template get<vector<double> >(EDGE_GRADIENT).empty() ||
+            _attrs.template get<vector<double> >(EDGE_DASH_STYLE).size() > 2 ||
+            !_attrs.template get<string>(EDGE_TEXT).empty())
+            return false;
+
+        color_t color = _attrs.template get<color_t>(EDGE_COLOR);
+        double pw = get_user_dist(cr, _attrs.template get<double>(EDGE_PENWIDTH));
+        if (batch.count > 0 && (color != batch.color || pw != batch.pw ||
+                                batch.count >= 4096))
+            batch.flush(cr);
+
+        pos_t pos_begin = _s.get_pos();
+        pos_t pos_end = _t.get_pos();
+        vector<double> controls =
+            _attrs.template get<vector<double> >(EDGE_CONTROL_POINTS);
+        transform_controls(pos_begin, pos_end, 0, MARKER_SHAPE_NONE,
+                           MARKER_SHAPE_NONE, controls, cr);
+        draw_edge_line(pos_begin, pos_end, controls, cr);
+
+        batch.color = color;
+        batch.pw = pw;
+        batch.count++;
+        return true;
+    }
+
     void draw(Cairo::Context& cr, double res = 0.)
     {
         pos_t pos_begin, pos_end;
@@ -1082,42 +1380,8 @@ public:
 
         cr.save();
 
-        if (controls.size() >= 8)
-        {
-            double angle = 0;
-            double len = 0;
-            if (_t.get_pos() != _s.get_pos())
-            {
-                angle = atan2(pos_end.second - pos_begin.second,
-                              pos_end.first - pos_begin.first);
-                len = sqrt(pow(pos_end.first - pos_begin.first, 2) +
-                           pow(pos_end.second - pos_begin.second, 2));
-
-                cr.save();
-                cr.translate(pos_begin.first, pos_begin.second);
-                cr.rotate(angle);
-                cr.scale(len, 1.);
-            }
-            else
-            {
-                pos_begin = _s.get_pos();
-                if (start_marker == MARKER_SHAPE_NONE &&
-                    end_marker == MARKER_SHAPE_NONE)
-                    len = M_PI * _s.get_size(cr);
-                else
-                    len = max(M_PI * _s.get_size(cr), 6 * marker_size);
-                cr.save();
-                cr.translate(pos_begin.first, pos_begin.second);
-                cr.scale(len / sqrt(2), len / sqrt(2));
-            }
-
-            for (size_t i = 0; i < controls.size() / 2; ++i)
-                cr.user_to_device(controls[2 * i], controls[2 * i + 1]);
-            cr.restore();
-
-            for (size_t i = 0; i < controls.size() / 2; ++i)
-                cr.device_to_user(controls[2 * i], controls[2 * i + 1]);
-        }
+        transform_controls(pos_begin, pos_end, marker_size, start_marker,
+                           end_marker, controls, cr);
 
 
         color_t color = _attrs.template get<color_t>(EDGE_COLOR);
@@ -1452,6 +1716,50 @@ public:
         }
     }
 
+    // converts the control points, which are given relative to the line
+    // between the endpoints, to user coordinates
+    void transform_controls(pos_t& pos_begin, pos_t& pos_end,
+                            double marker_size, edge_marker_t start_marker,
+                            edge_marker_t end_marker, vector<double>& controls,
+                            Cairo::Context& cr)
+    {
+        if (controls.size() < 8)
+            return;
+
+        double angle = 0;
+        double len = 0;
+        if (pos_end != pos_begin)
+        {
+            angle = atan2(pos_end.second - pos_begin.second,
+                          pos_end.first - pos_begin.first);
+            len = sqrt(pow(pos_end.first - pos_begin.first, 2) +
+                       pow(pos_end.second - pos_begin.second, 2));
+
+            cr.save();
+            cr.translate(pos_begin.first, pos_begin.second);
+            cr.rotate(angle);
+            cr.scale(len, 1.);
+        }
+        else
+        {
+            if (start_marker == MARKER_SHAPE_NONE &&
+                end_marker == MARKER_SHAPE_NONE)
+                len = M_PI * _s.get_size(cr);
+            else
+                len = max(M_PI * _s.get_size(cr), 6 * marker_size);
+            cr.save();
+            cr.translate(pos_begin.first, pos_begin.second);
+            cr.scale(len / sqrt(2), len / sqrt(2));
+        }
+
+        for (size_t i = 0; i < controls.size() / 2; ++i)
+            cr.user_to_device(controls[2 * i], controls[2 * i + 1]);
+        cr.restore();
+
+        for (size_t i = 0; i < controls.size() / 2; ++i)
+            cr.device_to_user(controls[2 * i], controls[2 * i + 1]);
+    }
+
     void draw_edge_line(pos_t& pos_begin_c, pos_t& pos_end_c,
                         vector<double>& controls, Cairo::Context& cr)
     {
@@ -1547,11 +1855,17 @@ private:
 template <class Graph, class VertexIterator, class PosMap, class Time,
           class Yield>
 void draw_vertices(Graph&, pair<VertexIterator, VertexIterator> v_range,
-                   PosMap pos_map, attrs_t& attrs, attrs_t& defaults,
+                   PosMap pos_map,
+                   AttrArrays<typename graph_traits<Graph>::vertex_descriptor>& attrs,
                    Time max_time, int64_t dt, size_t& count, Cairo::Context& cr,
                    Yield&& yield)
 {
     typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    viewport_t vp(cr);
+
+    // device pixels already covered by a vertex smaller than a pixel
+    gt_hash_set<uint64_t> pixels;
+
     for(VertexIterator v = v_range.first; v != v_range.second; ++v)
     {
         pos_t pos;
@@ -1560,8 +1874,24 @@ void draw_vertices(Graph&, pair<VertexIterator, VertexIterator> v_range,
             pos.first = pos_map[*v][0];
             pos.second = pos_map[*v][1];
         }
-        VertexShape<vertex_t> vs(pos, AttrDict<vertex_t>(*v, attrs, defaults));
-        vs.draw(cr);
+        VertexShape<vertex_t> vs(pos, AttrDict<vertex_t>(*v, attrs));
+
+        bool visible = true;
+        double r = vs.get_extent(cr);
+        if (r >= 0)
+        {
+            visible = vp.visible(pos, r);
+            if (visible && vp.lod && r < vp.pixel / 2)
+            {
+                double x = pos.first, y = pos.second;
+                cr.user_to_device(x, y);
+                uint64_t key = (uint64_t(uint32_t(int32_t(floor(x)))) << 32) |
+                    uint32_t(int32_t(floor(y)));
+                visible = pixels.insert(key).second;
+            }
+        }
+        if (visible)
+            vs.draw(cr);
         count++;
 
         if (std::chrono::high_resolution_clock::now() > max_time)
@@ -1576,12 +1906,16 @@ void draw_vertices(Graph&, pair<VertexIterator, VertexIterator> v_range,
 template <class Graph, class EdgeIterator, class PosMap, class Time,
           class Yield>
 void draw_edges(Graph& g, pair<EdgeIterator, EdgeIterator> e_range,
-                PosMap pos_map, attrs_t& eattrs, attrs_t& edefaults,
-                attrs_t& vattrs, attrs_t& vdefaults, double res, Time max_time,
-                int64_t dt, size_t& count, Cairo::Context& cr, Yield&& yield)
+                PosMap pos_map,
+                AttrArrays<typename graph_traits<Graph>::edge_descriptor>& eattrs,
+                AttrArrays<typename graph_traits<Graph>::vertex_descriptor>& vattrs,
+                double res, Time max_time, int64_t dt, size_t& count,
+                Cairo::Context& cr, Yield&& yield)
 {
     typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
     typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+    viewport_t vp(cr);
+    edge_batch_t batch;
     for(EdgeIterator e = e_range.first; e != e_range.second; ++e)
     {
         vertex_t s, t;
@@ -1606,21 +1940,27 @@ void draw_edges(Graph& g, pair<EdgeIterator, EdgeIterator> e_range,
             continue;
         }
 
-        VertexShape<vertex_t> ss(spos, AttrDict<vertex_t>(s, vattrs, vdefaults));
-        VertexShape<vertex_t> ts(tpos, AttrDict<vertex_t>(t, vattrs, vdefaults));
+        VertexShape<vertex_t> ss(spos, AttrDict<vertex_t>(s, vattrs));
+        VertexShape<vertex_t> ts(tpos, AttrDict<vertex_t>(t, vattrs));
 
         EdgeShape<edge_t,VertexShape<vertex_t> > es(ss, ts,
-                                                    AttrDict<edge_t>(*e, eattrs,
-                                                                     edefaults));
-        es.draw(cr, res);
+                                                    AttrDict<edge_t>(*e, eattrs));
+        if (es.is_visible(vp, cr) && !es.draw_batched(cr, batch))
+        {
+            batch.flush(cr);
+            es.draw(cr, res);
+        }
+        count++;
 
         if (std::chrono::high_resolution_clock::now() > max_time)
         {
+            batch.flush(cr);
             yield(boost::python::object(count));
             max_time = std::chrono::high_resolution_clock::now() +
                 std::chrono::milliseconds(dt);
         }
     }
+    batch.flush(cr);
 }
 
 struct no_order {};
@@ -1759,11 +2099,14 @@ struct do_cairo_draw_edges
                     double res, Time max_time, int64_t dt, size_t& count,
                     Cairo::Context& cr, Yield&& yield) const
     {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        AttrArrays<vertex_t> vattrs_a(g, vattrs, vdefaults);
+        AttrArrays<edge_t> eattrs_a(g, eattrs, edefaults);
         ordered_range<typename graph_traits<Graph>::edge_iterator>
             edge_range(edges(g));
-        draw_edges(g, edge_range.get_range(edge_order), pos, eattrs,
-                   edefaults, vattrs, vdefaults, res, max_time, dt, count, cr,
-                   std::forward<Yield>(yield));
+        draw_edges(g, edge_range.get_range(edge_order), pos, eattrs_a, vattrs_a,
+                   res, max_time, dt, count, cr, std::forward<Yield>(yield));
     }
 };
 
@@ -1776,11 +2119,12 @@ struct do_cairo_draw_vertices
                     Time max_time, int64_t dt, size_t& count,
                     Cairo::Context& cr, Yield&& yield) const
     {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        AttrArrays<vertex_t> vattrs_a(g, vattrs, vdefaults);
         ordered_range<typename graph_traits<Graph>::vertex_iterator>
             vertex_range(vertices(g));
-        draw_vertices(g, vertex_range.get_range(vertex_order), pos, vattrs,
-                      vdefaults, max_time, dt, count, cr,
-                      std::forward<Yield>(yield));
+        draw_vertices(g, vertex_range.get_range(vertex_order), pos, vattrs_a,
+                      max_time, dt, count, cr, std::forward<Yield>(yield));
     }
 };
 
@@ -1868,6 +2212,370 @@ boost::python::object cairo_draw(GraphInterface& gi,
     return boost::python::object(CoroGenerator(dispatch));
 }
 
+// Tiled drawing into an image surface, for large static renders. The part of
+// the surface covered by the clip region is split into square tiles of
+// tile_size pixels, each element is assigned to the tiles its bounding box
+// intersects, and the tiles are drawn in parallel, each with its own context
+// writing directly into the buffer of the target surface. Since the tiles are
+// aligned to pixel boundaries, and the drawing order is the same in every tile,
+// the result is the same as that of cairo_draw(), except for the grouping of
+// sloppy edges.
+//
+// No Python objects can be accessed while drawing, hence vertex surfaces are
+// not supported. The other attributes are converted beforehand (see
+// AttrArrays).
+
+struct get_vertex_order
+{
+    template <class Graph, class Order>
+    void operator()(Graph& g, Order order, vector<size_t>& sorted) const
+    {
+        for (auto v : vertices_range(g))
+            sorted.push_back(v);
+        sort(sorted.begin(), sorted.end(),
+             [&](size_t u, size_t v)
+             { return get(order, vertex(u, g)) < get(order, vertex(v, g)); });
+    }
+};
+
+// the order is given as positions in the edge sequence of edges(g)
+struct get_edge_order
+{
+    template <class Graph, class Order>
+    void operator()(Graph& g, Order order, vector<size_t>& sorted) const
+    {
+        vector<typename property_traits<Order>::value_type> keys;
+        for (auto e : edges_range(g))
+            keys.push_back(get(order, e));
+        sorted.resize(keys.size());
+        for (size_t i = 0; i < sorted.size(); ++i)
+            sorted[i] = i;
+        sort(sorted.begin(), sorted.end(),
+             [&](size_t i, size_t j) { return keys[i] < keys[j]; });
+    }
+};
+
+struct do_cairo_draw_tiled
+{
+    typedef std::array<size_t, 4> trange_t;
+
+    template <class Graph, class PosMap>
+    void operator()(Graph& g, PosMap pos_map, const vector<size_t>& vorder,
+                    const vector<size_t>& eorder, bool nodesfirst,
+                    attrs_t& vattrs, attrs_t& eattrs, attrs_t& vdefaults,
+                    attrs_t& edefaults, double res,
+                    Cairo::ImageSurface& dst, const Cairo::Matrix& m,
+                    const std::array<int, 4>& region, size_t tile_size) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+        AttrArrays<vertex_t> vattrs_a(g, vattrs, vdefaults);
+        AttrArrays<edge_t> eattrs_a(g, eattrs, edefaults);
+
+        vector<vertex_t> vs;
+        if (vorder.empty())
+        {
+            for (auto v : vertices_range(g))
+                vs.push_back(v);
+        }
+        else
+        {
+            for (auto v : vorder)
+                vs.push_back(vertex(v, g));
+        }
+
+        vector<edge_t> es;
+        for (auto e : edges_range(g))
+            es.push_back(e);
+        if (!eorder.empty())
+        {
+            vector<edge_t> ordered;
+            for (auto i : eorder)
+                ordered.push_back(es[i]);
+            es.swap(ordered);
+        }
+
+        auto get_pos = [&](vertex_t v)
+            {
+                pos_t pos;
+                if (pos_map[v].size() >= 2)
+                {
+                    pos.first = pos_map[v][0];
+                    pos.second = pos_map[v][1];
+                }
+                return pos;
+            };
+
+        size_t nx = (region[2] - region[0] + tile_size - 1) / tile_size;
+        size_t ny = (region[3] - region[1] + tile_size - 1) / tile_size;
+        size_t nt = nx * ny;
+
+        // range of tiles covered by a box in user coordinates; empty ranges
+        // have r[0] > r[2]
+        auto get_range = [&](double x1, double y1, double x2, double y2)
+            {
+                double dx1 = numeric_limits<double>::max(), dx2 = -dx1;
+                double dy1 = dx1, dy2 = dx2;
+                std::array<double, 8> corners = {{x1, y1, x2, y1, x1, y2, x2, y2}};
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    double x = corners[2 * i], y = corners[2 * i + 1];
+                    m.transform_point(x, y);
+                    dx1 = min(dx1, x);
+                    dx2 = max(dx2, x);
+                    dy1 = min(dy1, y);
+                    dy2 = max(dy2, y);
+                }
+                if (dx2 < region[0] || dx1 > region[2] ||
+                    dy2 < region[1] || dy1 > region[3])
+                    return trange_t({{1, 0, 0, 0}});
+                auto tile = [&](double x, int x0, size_t n)
+                    {
+                        double t = floor((x - x0) / tile_size);
+                        return size_t(max(min(t, double(n - 1)), 0.));
+                    };
+                return trange_t({{tile(dx1, region[0], nx),
+                                  tile(dy1, region[1], ny),
+                                  tile(dx2, region[0], nx),
+                                  tile(dy2, region[1], ny)}});
+            };
+
+        trange_t all = {{0, 0, nx - 1, ny - 1}};
+        vector<trange_t> vrange(vs.size()), erange(es.size());
+        string err;
+
+        #pragma omp parallel if (vs.size() + es.size() > OPENMP_MIN_THRESH)
+        {
+            auto sfc = Cairo::ImageSurface::create(dst.get_format(), 1, 1);
+            auto cr = Cairo::Context::create(sfc);
+            cr->set_matrix(m);
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < vs.size(); ++i)
+            {
+                try
+                {
+                    pos_t pos = get_pos(vs[i]);
+                    VertexShape<vertex_t> vshape(pos,
+                                                 AttrDict<vertex_t>(vs[i], vattrs_a));
+                    double r = vshape.get_extent(*cr);
+                    if (r < 0)
+                        vrange[i] = all;
+                    else
+                        vrange[i] = get_range(pos.first - r, pos.second - r,
+                                              pos.first + r, pos.second + r);
+                }
+                catch (std::exception& e)
+                {
+                    #pragma omp critical (cairo_draw_tiled)
+                    err = e.what();
+                }
+            }
+
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < es.size(); ++i)
+            {
+                try
+                {
+                    vertex_t s = source(es[i], g);
+                    vertex_t t = target(es[i], g);
+                    pos_t spos = get_pos(s), tpos = get_pos(t);
+                    if (spos == tpos && s != t)
+                    {
+                        erange[i] = trange_t({{1, 0, 0, 0}});
+                        continue;
+                    }
+                    VertexShape<vertex_t> ss(spos, AttrDict<vertex_t>(s, vattrs_a));
+                    VertexShape<vertex_t> ts(tpos, AttrDict<vertex_t>(t, vattrs_a));
+                    EdgeShape<edge_t,VertexShape<vertex_t> >
+                        eshape(ss, ts, AttrDict<edge_t>(es[i], eattrs_a));
+                    double x1, y1, x2, y2;
+                    if (eshape.get_bbox(*cr, x1, y1, x2, y2))
+                        erange[i] = get_range(x1, y1, x2, y2);
+                    else
+                        erange[i] = all;
+                }
+                catch (std::exception& e)
+                {
+                    #pragma omp critical (cairo_draw_tiled)
+                    err = e.what();
+                }
+            }
+        }
+        if (!err.empty())
+            throw GraphException(err);
+
+        // elements of each tile, in drawing order
+        vector<vector<vertex_t>> tvs(nt);
+        vector<vector<edge_t>> tes(nt);
+        for (size_t i = 0; i < vs.size(); ++i)
+        {
+            auto& r = vrange[i];
+            for (size_t y = r[1]; r[0] <= r[2] && y <= r[3]; ++y)
+                for (size_t x = r[0]; x <= r[2]; ++x)
+                    tvs[y * nx + x].push_back(vs[i]);
+        }
+        for (size_t i = 0; i < es.size(); ++i)
+        {
+            auto& r = erange[i];
+            for (size_t y = r[1]; r[0] <= r[2] && y <= r[3]; ++y)
+                for (size_t x = r[0]; x <= r[2]; ++x)
+                    tes[y * nx + x].push_back(es[i]);
+        }
+
+        dst.flush();
+        unsigned char* data = dst.get_data();
+        int stride = dst.get_stride();
+        auto format = dst.get_format();
+
+        {
+            GILRelease gil;
+
+            #pragma omp parallel for schedule(dynamic) if (nt > 1)
+            for (size_t t = 0; t < nt; ++t)
+            {
+                try
+                {
+                    int x0 = region[0] + (t % nx) * tile_size;
+                    int y0 = region[1] + (t / nx) * tile_size;
+                    int w = min(int(tile_size), region[2] - x0);
+                    int h = min(int(tile_size), region[3] - y0);
+
+                    // both supported formats have four bytes per pixel
+                    auto sfc = Cairo::ImageSurface::create(data + y0 * stride + x0 * 4,
+                                                           format, w, h, stride);
+                    auto cr = Cairo::Context::create(sfc);
+                    cr->translate(-x0, -y0);
+                    cr->transform(m);
+
+                    size_t count = 0;
+                    auto max_time = std::chrono::high_resolution_clock::time_point::max();
+                    auto yield = [](const boost::python::object&) {};
+                    auto& tv = tvs[t];
+                    auto& te = tes[t];
+
+                    if (nodesfirst)
+                        draw_vertices(g, make_pair(tv.begin(), tv.end()),
+                                      pos_map, vattrs_a, max_time, 0, count,
+                                      *cr, yield);
+                    draw_edges(g, make_pair(te.begin(), te.end()), pos_map,
+                               eattrs_a, vattrs_a, res, max_time, 0, count,
+                               *cr, yield);
+                    if (!nodesfirst)
+                        draw_vertices(g, make_pair(tv.begin(), tv.end()),
+                                      pos_map, vattrs_a, max_time, 0, count,
+                                      *cr, yield);
+                    sfc->flush();
+                }
+                catch (std::exception& e)
+                {
+                    #pragma omp critical (cairo_draw_tiled)
+                    err = e.what();
+                }
+            }
+        }
+
+        dst.mark_dirty();
+        if (!err.empty())
+            throw GraphException(err);
+    }
+};
+
+void cairo_draw_tiled(GraphInterface& gi,
+                      boost::any pos,
+                      boost::any vorder,
+                      boost::any eorder,
+                      bool nodesfirst,
+                      boost::python::dict ovattrs,
+                      boost::python::dict oeattrs,
+                      boost::python::dict ovdefaults,
+                      boost::python::dict oedefaults,
+                      double res,
+                      size_t tile_size,
+                      boost::python::object ocr)
+{
+    if (tile_size == 0)
+        throw ValueException("The tile size must be positive.");
+
+    attrs_t vattrs, eattrs, vdefaults, edefaults;
+    typedef graph_traits<GraphInterface::multigraph_t>::vertex_descriptor vertex_t;
+    populate_attrs<vertex_t, vertex_properties>(ovattrs, vattrs);
+    populate_defaults(ovdefaults, vdefaults);
+    run_action<>()
+        (gi, std::bind(populate_edge_attrs(), std::placeholders::_1,
+                       oeattrs, std::ref(eattrs), oedefaults,
+                       std::ref(edefaults)))();
+
+    if (vattrs.find(VERTEX_SURFACE) != vattrs.end())
+        throw ValueException("Vertex surfaces are not supported by tiled "
+                             "drawing.");
+    auto iter = vdefaults.find(VERTEX_SURFACE);
+    if (iter != vdefaults.end())
+    {
+        if (any_cast<boost::python::object>(iter->second) !=
+            boost::python::object())
+            throw ValueException("Vertex surfaces are not supported by tiled "
+                                 "drawing.");
+        vdefaults.erase(iter);
+    }
+
+    Cairo::Context cr(PycairoContext_GET(ocr.ptr()));
+    cairo_surface_t* csfc = cairo_get_target(cr.cobj());
+    if (cairo_surface_get_type(csfc) != CAIRO_SURFACE_TYPE_IMAGE ||
+        (cairo_image_surface_get_format(csfc) != CAIRO_FORMAT_ARGB32 &&
+         cairo_image_surface_get_format(csfc) != CAIRO_FORMAT_RGB24))
+        throw ValueException("Tiled drawing requires an ARGB32 or RGB24 "
+                             "image surface.");
+    Cairo::ImageSurface dst(csfc);
+
+    Cairo::Matrix m;
+    cr.get_matrix(m);
+
+    // the clip region in device coordinates
+    double x1, y1, x2, y2;
+    cr.get_clip_extents(x1, y1, x2, y2);
+    double dx1 = numeric_limits<double>::max(), dx2 = -dx1;
+    double dy1 = dx1, dy2 = dx2;
+    std::array<double, 8> corners = {{x1, y1, x2, y1, x1, y2, x2, y2}};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        double x = corners[2 * i], y = corners[2 * i + 1];
+        cr.user_to_device(x, y);
+        dx1 = min(dx1, x);
+        dx2 = max(dx2, x);
+        dy1 = min(dy1, y);
+        dy2 = max(dy2, y);
+    }
+    std::array<int, 4> region =
+        {{max(int(floor(dx1)), 0), max(int(floor(dy1)), 0),
+          min(int(ceil(dx2)), dst.get_width()),
+          min(int(ceil(dy2)), dst.get_height())}};
+    if (region[2] <= region[0] || region[3] <= region[1])
+        return;
+
+    vector<size_t> vsorted, esorted;
+    if (!vorder.empty())
+        run_action<>()
+            (gi, std::bind(get_vertex_order(), std::placeholders::_1,
+                           std::placeholders::_2, std::ref(vsorted)),
+             vertex_scalar_properties())(vorder);
+    if (!eorder.empty())
+        run_action<>()
+            (gi, std::bind(get_edge_order(), std::placeholders::_1,
+                           std::placeholders::_2, std::ref(esorted)),
+             edge_scalar_properties())(eorder);
+
+    run_action<>()
+        (gi, std::bind(do_cairo_draw_tiled(), std::placeholders::_1,
+                       std::placeholders::_2, std::cref(vsorted),
+                       std::cref(esorted), nodesfirst, std::ref(vattrs),
+                       std::ref(eattrs), std::ref(vdefaults),
+                       std::ref(edefaults), res, std::ref(dst),
+                       std::cref(m), std::cref(region), tile_size),
+         vertex_scalar_vector_properties())(pos);
+}
+
 struct do_apply_transforms
 {
     template <class Graph, class PosMap>
@@ -1906,121 +2614,133 @@ struct do_put_parallel_splines
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
         typedef typename property_traits<SplinesMap>::key_type skey_t;
 
-        pair<double, double> cm;
-        cm.first = cm.second = 0;
+        double cm_x = 0, cm_y = 0;
         size_t n = 0;
-        typename graph_traits<Graph>::vertex_iterator v, v_end;
-        for(tie(v, v_end) = vertices(g); v != v_end; ++v)
-        {
-            cm.first += get(pos, *v)[0];
-            cm.second += get(pos, *v)[1];
-            ++n;
-        }
-        cm.first /= n;
-        cm.second /= n;
-
-        typename graph_traits<Graph>::edge_iterator e, e_end;
-        for(tie(e, e_end) = edges(g); e != e_end; ++e)
-        {
-            if (target(*e, g) == source(*e, g))
-            {
-                vertex_t s = source(*e, g);
-                typename graph_traits<Graph>::out_edge_iterator eo, eo_end;
-                vector<edge_t> pes;
-                for (tie(eo, eo_end) = out_edges(s, g); eo != eo_end; ++eo)
-                {
-                    if (target(*eo, g) == source(*eo, g))
-                        pes.push_back(*eo);
-                }
-
-                pair<double, double> dist;
-                dist.first = get(pos, s)[0] - cm.first;
-                dist.second = get(pos, s)[1] - cm.second;
-                double theta = get(loop_angle, s);
-                if (std::isnan(theta))
-                    theta = atan2(dist.second, dist.first) - M_PI / 2;
-                typename property_traits<SplinesMap>::value_type sp(22), sp2(26);
-                for (size_t j = 0; j < pes.size(); ++j)
-                {
-                    double d = 4 * (sqrt(2) - 1) / 3;
-                    double r = (j + 1) / 4.;
-                    double yoff = r / 4;
-
-                    sp[0] = d * r;
-                    sp[1] = 0 + yoff;
-
-                    sp[1 * 2 + 0] = r;
-                    sp[1 * 2 + 1] = r - d * r + yoff;
-
-                    sp[2 * 2 + 0] = r;
-                    sp[2 * 2 + 1] = r + yoff;
-
-                    sp[3 * 2 + 0] = r;
-                    sp[3 * 2 + 1] = r + d * r + yoff;
-
-                    sp[4 * 2 + 0] = d * r;
-                    sp[4 * 2 + 1] = 2 * r + yoff;
-
-                    sp[5 * 2 + 0] = 0;
-                    sp[5 * 2 + 1] = 2 * r + yoff;
-
-                    sp[6 * 2 + 0] = -d * r;
-                    sp[6 * 2 + 1] = 2 * r + yoff;
-
-                    sp[7 * 2 + 0] = - r;
-                    sp[7 * 2 + 1] = r + d * r + yoff;
-
-                    sp[8 * 2 + 0] = -r;
-                    sp[8 * 2 + 1] = r + yoff;
-
-                    sp[9 * 2 + 0] = - r;
-                    sp[9 * 2 + 1] = r - d * r + yoff;
-
-                    sp[10 * 2 + 0] = - d * r;
-                    sp[10 * 2 + 1] = 0 + yoff;
-
-                    for (size_t i = 0; i < 11; ++i)
-                    {
-                        sp2[i * 2 + 2] = sp[i * 2 + 0] * cos(theta) - sp[i * 2 + 1] * sin(theta);
-                        sp2[i * 2 + 3] = sp[i * 2 + 0] * sin(theta) + sp[i * 2 + 1] * cos(theta);
-                    }
-                    put(spline, skey_t(pes[j]), sp2);
-                }
-            }
-            else if (get(l, *e) == 1)
-            {
-                vector<pair<edge_t, bool> > pes;
-                vertex_t s = source(*e, g);
-                typename graph_traits<Graph>::out_edge_iterator eo, eo_end;
-                for (tie(eo, eo_end) = out_edges(s, g); eo != eo_end; ++eo)
-                {
-                    if (target(*eo, g) == target(*e, g))
-                        pes.push_back(make_pair(*eo, true));
-                }
-
-                typename graph_traits<Graph>::in_edge_iterator ei, ei_end;
-                for (tie(ei, ei_end) = in_edges(s, g); ei != ei_end; ++ei)
-                {
-                    if (source(*ei, g) == target(*e, g))
-                        pes.push_back(make_pair(*ei, false));
-                }
-
-                typename property_traits<SplinesMap>::value_type sp(8, 0);
-                double n = (pes.size() - 1.) / 2.;
-                for (size_t j = 0; j < pes.size(); ++j)
-                {
-                    typedef typename property_traits<SplinesMap>::value_type::value_type val_t;
-                    double one = pes[j].second ? 1 : -1;
-                    sp[2] = val_t(0.3);
-                    sp[3] = val_t(one * (j - n) * parallel_distance / n);
-                    sp[4] = val_t(0.7);
-                    sp[5] = val_t(one * (j - n) * parallel_distance / n);
-                    sp[6] = 1;
-                    sp[7] = 0;
-                    put(spline, skey_t(pes[j].first), sp);
-                }
-            }
-        }
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            reduction(+:cm_x, cm_y, n)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 auto p = get(pos, v);
+                 cm_x += p[0];
+                 cm_y += p[1];
+                 ++n;
+             });
+        pair<double, double> cm(cm_x / n, cm_y / n);
+
+        // The self-loops are handled per vertex, and the other parallel
+        // edges per group, via the edge labelled 1, so that every spline is
+        // written only once, and by a single thread.
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto s)
+             {
+                 typename graph_traits<Graph>::out_edge_iterator eo, eo_end;
+                 vector<edge_t> pes;
+                 for (tie(eo, eo_end) = out_edges(s, g); eo != eo_end; ++eo)
+                 {
+                     if (target(*eo, g) == source(*eo, g))
+                         pes.push_back(*eo);
+                 }
+                 if (pes.empty())
+                     return;
+
+                 pair<double, double> dist;
+                 dist.first = get(pos, s)[0] - cm.first;
+                 dist.second = get(pos, s)[1] - cm.second;
+                 double theta = get(loop_angle, s);
+                 if (std::isnan(theta))
+                     theta = atan2(dist.second, dist.first) - M_PI / 2;
+                 typename property_traits<SplinesMap>::value_type sp(22), sp2(26);
+                 for (size_t j = 0; j < pes.size(); ++j)
+                 {
+                     double d = 4 * (sqrt(2) - 1) / 3;
+                     double r = (j + 1) / 4.;
+                     double yoff = r / 4;
+
+                     sp[0] = d * r;
+                     sp[1] = 0 + yoff;
+
+                     sp[1 * 2 + 0] = r;
+                     sp[1 * 2 + 1] = r - d * r + yoff;
+
+                     sp[2 * 2 + 0] = r;
+                     sp[2 * 2 + 1] = r + yoff;
+
+                     sp[3 * 2 + 0] = r;
+                     sp[3 * 2 + 1] = r + d * r + yoff;
+
+                     sp[4 * 2 + 0] = d * r;
+                     sp[4 * 2 + 1] = 2 * r + yoff;
+
+                     sp[5 * 2 + 0] = 0;
+                     sp[5 * 2 + 1] = 2 * r + yoff;
+
+                     sp[6 * 2 + 0] = -d * r;
+                     sp[6 * 2 + 1] = 2 * r + yoff;
+
+                     sp[7 * 2 + 0] = - r;
+                     sp[7 * 2 + 1] = r + d * r + yoff;
+
+                     sp[8 * 2 + 0] = -r;
+                     sp[8 * 2 + 1] = r + yoff;
+
+                     sp[9 * 2 + 0] = - r;
+                     sp[9 * 2 + 1] = r - d * r + yoff;
+
+                     sp[10 * 2 + 0] = - d * r;
+                     sp[10 * 2 + 1] = 0 + yoff;
+
+                     for (size_t i = 0; i < 11; ++i)
+                     {
+                         sp2[i * 2 + 2] = sp[i * 2 + 0] * cos(theta) - sp[i * 2 + 1] * sin(theta);
+                         sp2[i * 2 + 3] = sp[i * 2 + 0] * sin(theta) + sp[i * 2 + 1] * cos(theta);
+                     }
+                     put(spline, skey_t(pes[j]), sp2);
+                 }
+             });
+
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+        parallel_edge_loop_no_spawn
+            (g,
+             [&](const auto& e)
+             {
+                 if (target(e, g) == source(e, g) || get(l, e) != 1)
+                     return;
+
+                 vector<pair<edge_t, bool> > pes;
+                 vertex_t s = source(e, g);
+                 typename graph_traits<Graph>::out_edge_iterator eo, eo_end;
+                 for (tie(eo, eo_end) = out_edges(s, g); eo != eo_end; ++eo)
+                 {
+                     if (target(*eo, g) == target(e, g))
+                         pes.push_back(make_pair(*eo, true));
+                 }
+
+                 typename graph_traits<Graph>::in_edge_iterator ei, ei_end;
+                 for (tie(ei, ei_end) = in_edges(s, g); ei != ei_end; ++ei)
+                 {
+                     if (source(*ei, g) == target(e, g))
+                         pes.push_back(make_pair(*ei, false));
+                 }
+
+                 typename property_traits<SplinesMap>::value_type sp(8, 0);
+                 double n = (pes.size() - 1.) / 2.;
+                 for (size_t j = 0; j < pes.size(); ++j)
+                 {
+                     typedef typename property_traits<SplinesMap>::value_type::value_type val_t;
+                     double one = pes[j].second ? 1 : -1;
+                     sp[2] = val_t(0.3);
+                     sp[3] = val_t(one * (j - n) * parallel_distance / n);
+                     sp[4] = val_t(0.7);
+                     sp[5] = val_t(one * (j - n) * parallel_distance / n);
+                     sp[6] = 1;
+                     sp[7] = 0;
+                     put(spline, skey_t(pes[j].first), sp);
+                 }
+             });
     }
 };
 
@@ -2167,6 +2887,7 @@ void get_cts(GraphInterface& gi, GraphInterface& tgi, boost::any otpos,
 BOOST_PYTHON_MODULE(libgraph_tool_draw)
 {
     def("cairo_draw", &cairo_draw);
+    def("cairo_draw_tiled", &cairo_draw_tiled);
     def("put_parallel_splines", &put_parallel_splines);
     def("apply_transforms", &apply_transforms);
 
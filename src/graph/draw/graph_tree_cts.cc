@@ -21,6 +21,8 @@
 
 #include "graph_selectors.hh"
 #include "graph_properties.hh"
+#include "graph_util.hh"
+#include "hash_map_wrap.hh"
 
 #include <boost/mpl/quote.hpp>
 #include <boost/graph/breadth_first_search.hpp>
@@ -203,35 +205,117 @@ void pack(vector<point_t>& cp, vector<T>& ncp)
     }
 }
 
+// The path between s and t in the tree is [s] + tree_path(p(s), p(t)) + [t],
+// where p() is the parent, unless p(s) == p(t) or max_depth <= 1. The inner
+// paths, which are shared by all the edges between the same pair of parents,
+// are memoized.
+class tree_path_cache
+{
+public:
+    template <class Graph>
+    void operator()(Graph& g, size_t s, size_t t, vector<size_t>& path,
+                    size_t max_depth)
+    {
+        if (max_depth <= 1)
+        {
+            tree_path(g, s, t, path, max_depth);
+            return;
+        }
+
+        size_t ps = parent(g, s);
+        size_t pt = parent(g, t);
+
+        path.clear();
+        path.push_back(s);
+        if (ps == pt)
+        {
+            path.push_back(ps);
+        }
+        else
+        {
+            auto iter = _paths.find(make_pair(ps, pt));
+            if (iter == _paths.end())
+            {
+                vector<size_t> inner;
+                tree_path(g, ps, pt, inner, max_depth - 1);
+                iter = _paths.insert(make_pair(make_pair(ps, pt),
+                                               std::move(inner))).first;
+            }
+            path.insert(path.end(), iter->second.begin(), iter->second.end());
+        }
+        path.push_back(t);
+    }
+
+private:
+    template <class Graph>
+    size_t parent(Graph& g, size_t v)
+    {
+        typename graph_traits<Graph>::in_edge_iterator e, e_end;
+        tie(e, e_end) = in_edges(v, g);
+        if (e == e_end)
+            throw GraphException("Invalid hierarchical tree: No path from source to target.");
+        return source(*e, g);
+    }
+
+    gt_hash_map<pair<size_t, size_t>, vector<size_t>> _paths;
+};
+
 struct do_get_cts
 {
     template <class Graph, class Tree, class PosProp, class BProp, class CMap>
     void operator()(Graph& g, Tree& t, PosProp tpos, BProp beta, CMap cts,
                     bool is_tree, size_t max_depth) const
     {
+        // the positions are read concurrently below, so they must not be
+        // resized there
+        for (auto v : vertices_range(t))
+        {
+            if (tpos[v].size() < 2)
+                tpos[v].resize(2);
+        }
+
         vector<size_t> path;
         vector<point_t> cp;
         vector<point_t> ncp;
-
-        for (auto e : edges_range(g))
-        {
-            auto u = source(e, g);
-            auto v = target(e, g);
-            if (u == v)
-                continue;
-
-            path.clear();
-            if (is_tree)
-                tree_path(t, u, v, path, max_depth);
-            else
-                graph_path(t, u, v, path);
-            cp.clear();
-            get_control_points(path, tpos, beta[e], cp);
-            ncp.clear();
-            to_bezier(cp, ncp);
-            transform(ncp);
-            pack(ncp, cts[e]);
-        }
+        tree_path_cache cache;
+        string err;
+
+        #pragma omp parallel if (num_edges(g) > OPENMP_MIN_THRESH) \
+            firstprivate(path, cp, ncp, cache)
+        parallel_edge_loop_no_spawn
+            (g,
+             [&](const auto& e)
+             {
+                 auto u = source(e, g);
+                 auto v = target(e, g);
+                 if (u == v)
+                     return;
+
+                 try
+                 {
+                     path.clear();
+                     if (is_tree)
+                         cache(t, u, v, path, max_depth);
+                     else
+                         graph_path(t, u, v, path);
+                 }
+                 catch (GraphException& exc)
+                 {
+                     #pragma omp critical (get_cts)
+                     err = exc.what();
+                     return;
+                 }
+
+                 cp.clear();
+                 get_control_points(path, tpos, beta[e], cp);
+                 ncp.clear();
+                 to_bezier(cp, ncp);
+                 transform(ncp);
+                 pack(ncp, cts[e]);
+             });
+
+        if (!err.empty())
+            throw GraphException(err);
     }
 };
 
@@ -244,9 +328,11 @@ void get_cts(GraphInterface& gi, GraphInterface& tgi, boost::any otpos,
     eprop_t cts = boost::any_cast<eprop_t>(octs);
     beprop_t beta = boost::any_cast<beprop_t>(obeta);
 
+    size_t E = gi.get_edge_index_range();
     gt_dispatch<>()
         (std::bind(do_get_cts(), std::placeholders::_1, std::placeholders::_2,
-                   std::placeholders::_3, beta, cts, is_tree, max_depth),
+                   std::placeholders::_3, beta.get_unchecked(E),
+                   cts.get_unchecked(E), is_tree, max_depth),
          graph_tool::all_graph_views(),
          graph_tool::always_directed(),
          vertex_scalar_vector_properties())
@@ -38,6 +38,8 @@
 #else
 #   include <boost/property_map.hpp>
 #endif
+
+#include "numa.hh"
 #include <memory>
 #include <vector>
 
@@ -97,12 +99,12 @@ public:
     void reserve(size_t size) const
     {
         if (size > store->size())
-            store->resize(size);
+            graph_tool::numa_resize(*store, size);
     }
 
     void resize(size_t size) const
     {
-        store->resize(size);
+        graph_tool::numa_resize(*store, size);
     }
 
     void shrink_to_fit() const
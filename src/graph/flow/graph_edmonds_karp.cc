@@ -20,47 +20,37 @@
 #include "graph_properties.hh"
 #include "graph.hh"
 
-#include "graph_augment.hh"
+#include "graph_residual_network.hh"
 
 #include <boost/graph/edmonds_karp_max_flow.hpp>
 
-#include <boost/bind.hpp>
-
 using namespace graph_tool;
 using namespace boost;
 
 struct get_edmonds_karp_max_flow
 {
-    template <class Graph, class VertexIndex, class EdgeIndex, class CapacityMap,
+    template <class Graph, class EdgeIndex, class CapacityMap,
               class ResidualMap>
-    void operator()(Graph& g, VertexIndex vertex_index, EdgeIndex edge_index,
-                    size_t max_e, size_t src, size_t sink, CapacityMap cm,
-                    ResidualMap res) const
+    void operator()(Graph& g, EdgeIndex edge_index, size_t max_e, size_t src,
+                    size_t sink, CapacityMap cm, ResidualMap res) const
     {
-        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
-        unchecked_vector_property_map<bool,EdgeIndex>
-            augmented(edge_index, max_e);
-        unchecked_vector_property_map<edge_t,EdgeIndex>
-            reverse_map(edge_index, max_e);
-        unchecked_vector_property_map<default_color_type,VertexIndex>
-            color(vertex_index, num_vertices(g));
-        unchecked_vector_property_map<edge_t,VertexIndex>
-            pred(vertex_index, num_vertices(g));
+        typedef typename property_traits<CapacityMap>::value_type val_t;
+        residual_network<val_t> net(g, edge_index, max_e);
+        net.set_capacity(g, edge_index, cm);
 
-        typedef typename std::remove_const<Graph>::type GT;
-        GT& u = const_cast<GT&>(g);
-        augment_graph(u,
-                      augmented.get_checked(),
-                      get_checked(cm),
-                      reverse_map.get_checked(),
-                      get_checked(res));
+        typedef typename residual_network<val_t>::index_map_t index_map_t;
+        size_t N = num_vertices(net);
+        unchecked_vector_property_map<default_color_type,index_map_t>
+            color(net.get_index_map(), N);
+        unchecked_vector_property_map<size_t,index_map_t>
+            pred(net.get_index_map(), N);
 
-        boost::edmonds_karp_max_flow(g, vertex(src, g), vertex(sink, g),
-                                     get_unchecked(cm),
-                                     get_unchecked(res),
-                                     reverse_map, color, pred);
+        boost::edmonds_karp_max_flow(net, src, sink,
+                                     net.get_capacity_map(),
+                                     net.get_residual_map(),
+                                     net.get_reverse_map(), color, pred);
 
-        deaugment_graph(u, augmented.get_checked());
+        net.get_residual(g, edge_index, res);
     }
 };
 
@@ -70,7 +60,7 @@ void edmonds_karp_max_flow(GraphInterface& gi, size_t src, size_t sink,
 {
     run_action<graph_tool::detail::always_directed>()
         (gi, std::bind(get_edmonds_karp_max_flow(),
-                       std::placeholders::_1, gi.get_vertex_index(), gi.get_edge_index(),
+                       std::placeholders::_1, gi.get_edge_index(),
                        gi.get_edge_index_range(),
                        src, sink, std::placeholders::_2, std::placeholders::_3),
          writable_edge_scalar_properties(), writable_edge_scalar_properties())
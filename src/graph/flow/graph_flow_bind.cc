@@ -16,6 +16,7 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "graph.hh"
+#include "random.hh"
 
 using namespace graph_tool;
 using namespace boost;
@@ -28,8 +29,11 @@ void kolmogorov_max_flow(GraphInterface& gi, size_t src, size_t sink,
                          boost::any capacity, boost::any res);
 bool max_cardinality_matching(GraphInterface& gi, boost::any match);
 double min_cut(GraphInterface& gi, boost::any weight, boost::any part_map);
-void get_residual_graph(GraphInterface& gi, boost::any capacity, boost::any res,
-                        boost::any oaugment);
+double min_cut_karger_stein(GraphInterface& gi, boost::any weight,
+                            boost::any part_map, size_t trials, rng_t& rng);
+void min_st_cut(GraphInterface& gi, size_t src, boost::any capacity,
+                boost::any res, boost::any opart);
+void export_gomory_hu();
 
 #include <boost/python.hpp>
 using namespace boost::python;
@@ -41,5 +45,7 @@ BOOST_PYTHON_MODULE(libgraph_tool_flow)
     def("kolmogorov_max_flow", &kolmogorov_max_flow);
     def("max_cardinality_matching", &max_cardinality_matching);
     def("min_cut", &min_cut);
-    def("residual_graph", &get_residual_graph);
+    def("min_cut_karger_stein", &min_cut_karger_stein);
+    def("min_st_cut", &min_st_cut);
+    export_gomory_hu();
 }
@@ -0,0 +1,128 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "numpy_bind.hh"
+
+#include "graph_gomory_hu.hh"
+
+#include <fstream>
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+constexpr size_t GomoryHuTree::_null;
+constexpr char GomoryHuTree::_magic[4];
+constexpr uint32_t GomoryHuTree::_version;
+
+void gh_build(GomoryHuTree& gh, GraphInterface& gi, boost::any capacity)
+{
+    if (capacity.empty())
+    {
+        run_action<graph_tool::detail::never_directed>()
+            (gi, [&](auto& g)
+             {
+                 gh.build(g, UnityPropertyMap<size_t,
+                                              GraphInterface::edge_t>());
+             })();
+    }
+    else
+    {
+        run_action<graph_tool::detail::never_directed>()
+            (gi, [&](auto& g, auto c) { gh.build(g, c); },
+             edge_scalar_properties())(capacity);
+    }
+}
+
+// minimum cuts between the pairs (sources[i], targets[i]), which are split
+// among the threads
+python::object gh_min_cut(GomoryHuTree& gh, python::object osources,
+                          python::object otargets)
+{
+    auto sources = get_array<int64_t, 1>(osources);
+    auto targets = get_array<int64_t, 1>(otargets);
+    if (sources.size() != targets.size())
+        throw ValueException("the numbers of sources and targets differ");
+
+    size_t n = sources.size();
+    vector<GomoryHuTree::cap_t> cut(n);
+    string err;
+    #pragma omp parallel for schedule(runtime) if (n > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < n; ++i)
+    {
+        try
+        {
+            if (sources[i] < 0 || targets[i] < 0)
+                throw ValueException("Invalid vertex index: " +
+                                     to_string(min(sources[i], targets[i])));
+            cut[i] = gh.min_cut(sources[i], targets[i]);
+        }
+        catch (ValueException& e)
+        {
+            #pragma omp critical
+            err = e.what();
+        }
+    }
+    if (!err.empty())
+        throw ValueException(err);
+    return wrap_vector_owned(cut);
+}
+
+python::object gh_tree(GomoryHuTree& gh)
+{
+    auto& parent = gh.get_parent();
+    vector<int64_t> p(parent.size());
+    for (size_t v = 0; v < parent.size(); ++v)
+        p[v] = (parent[v] == numeric_limits<size_t>::max()) ?
+            -1 : int64_t(parent[v]);
+    vector<GomoryHuTree::cap_t> w = gh.get_weight();
+    return python::make_tuple(wrap_vector_owned(p), wrap_vector_owned(w));
+}
+
+void gh_save(GomoryHuTree& gh, string fname)
+{
+    ofstream s(fname, ios::binary);
+    if (!s)
+        throw IOException("error opening file '" + fname + "' for writing");
+    gh.save(s);
+}
+
+void gh_load(GomoryHuTree& gh, string fname)
+{
+    ifstream s(fname, ios::binary);
+    if (!s)
+        throw IOException("error opening file '" + fname + "' for reading");
+    gh.load(s);
+}
+
+void export_gomory_hu()
+{
+    using namespace boost::python;
+    class_<GomoryHuTree, std::shared_ptr<GomoryHuTree>,
+           boost::noncopyable>("GomoryHuTree")
+        .def("build", &gh_build)
+        .def("min_cut", &gh_min_cut)
+        .def("tree", &gh_tree)
+        .def("save", &gh_save)
+        .def("load", &gh_load)
+        .def("num_vertices", &GomoryHuTree::num_vertices);
+}
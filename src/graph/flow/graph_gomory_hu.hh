@@ -0,0 +1,305 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_GOMORY_HU_HH
+#define GRAPH_GOMORY_HU_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_exceptions.hh"
+#include "graph_residual_network.hh"
+
+#if (BOOST_VERSION >= 104400)
+# include <boost/graph/boykov_kolmogorov_max_flow.hpp>
+# define KOLMOGOROV_MAX_FLOW boost::boykov_kolmogorov_max_flow
+#else
+# include <boost/graph/kolmogorov_max_flow.hpp>
+# define KOLMOGOROV_MAX_FLOW boost::kolmogorov_max_flow
+#endif
+
+namespace graph_tool
+{
+
+// Flow-equivalent tree of an undirected graph (D. Gusfield, "Very simple
+// methods for all pairs network flow analysis", SIAM J. Comput. 19, 1990): a
+// tree on the same vertices, such that the minimum cut between any two
+// vertices is the smallest weight on the tree path between them. It is built
+// with N - 1 minimum s-t cuts, done with the Boykov-Kolmogorov algorithm.
+//
+// In Gusfield's algorithm the cut for the i-th vertex s is taken between s and
+// its current parent p[s], and then re-parents the later vertices on its side
+// of the cut. The cuts are computed speculatively in parallel for a window of
+// the next vertices, using their current parents, and are then committed in
+// order; a cut whose parent was changed meanwhile by an earlier commit is
+// computed again in the next batch. In practice most parents do not change,
+// and the result is the same as that of the sequential algorithm, independently
+// of the number of threads. Each thread has its own residual network.
+class GomoryHuTree
+{
+public:
+    typedef double cap_t;
+
+    GomoryHuTree() {}
+
+    template <class Graph, class CapacityMap>
+    void build(const Graph& g, CapacityMap capacity)
+    {
+        size_t N = boost::num_vertices(g);
+        _N = N;
+        _parent.clear();
+        _parent.resize(N, _null);
+        _weight.clear();
+        _weight.resize(N, 0);
+        _depth.clear();
+        _depth.resize(N, _null);
+
+        std::vector<size_t> vs;
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+        size_t n = vs.size();
+        if (n == 0)
+            return;
+        std::vector<size_t> pos(N, _null);
+        for (size_t i = 0; i < n; ++i)
+            pos[vs[i]] = i;
+        for (size_t i = 1; i < n; ++i)
+            _parent[vs[i]] = vs[0];
+
+        size_t nt = 1;
+#ifdef _OPENMP
+        if (n > 1 && !omp_in_parallel())
+            nt = omp_get_max_threads();
+#endif
+
+        // the cuts being computed: vertex, parent used, value and the
+        // vertices on the side of the vertex
+        struct cut_t
+        {
+            size_t t = _null;
+            cap_t value = 0;
+            std::vector<size_t> side;
+        };
+        size_t W = 2 * nt;
+        std::vector<cut_t> window(W);
+
+        auto eindex = get(boost::edge_index_t(), g);
+        size_t max_e = 0;
+        for (auto e : edges_range(g))
+            max_e = std::max(max_e, size_t(eindex[e]) + 1);
+
+        std::string err;
+        size_t next = 1;
+        #pragma omp parallel num_threads(nt) if (nt > 1)
+        {
+            typedef residual_network<cap_t> net_t;
+            typedef typename net_t::index_map_t index_map_t;
+            net_t net(g, eindex, max_e);
+            net.set_symmetric_capacity(g, eindex, capacity);
+            boost::unchecked_vector_property_map<size_t, index_map_t>
+                pred(net.get_index_map(), N), color(net.get_index_map(), N),
+                dist(net.get_index_map(), N);
+            boost::unchecked_vector_property_map<uint8_t, index_map_t>
+                part(net.get_index_map(), N);
+
+            while (next < n)
+            {
+                size_t end = std::min(next + W, n);
+
+                #pragma omp for schedule(dynamic, 1)
+                for (size_t i = next; i < end; ++i)
+                {
+                    size_t s = vs[i];
+                    auto& c = window[i % W];
+                    if (c.t == _parent[s])
+                        continue;
+                    try
+                    {
+                        c.t = _parent[s];
+                        c.value = KOLMOGOROV_MAX_FLOW(net,
+                                                      net.get_capacity_map(),
+                                                      net.get_residual_map(),
+                                                      net.get_reverse_map(),
+                                                      pred, color, dist,
+                                                      net.get_index_map(),
+                                                      s, c.t);
+                        for (auto v : vs)
+                            part[v] = false;
+                        residual_reach(net, s, part);
+                        c.side.clear();
+                        for (auto v : vs)
+                        {
+                            if (part[v])
+                                c.side.push_back(v);
+                        }
+                    }
+                    catch (std::exception& e)
+                    {
+                        #pragma omp critical (gomory_hu)
+                        err = e.what();
+                    }
+                }
+
+                // commit the cuts in order, while their parents are current
+                #pragma omp single
+                {
+                    if (!err.empty())
+                        next = n;
+                    for (; next < end; ++next)
+                    {
+                        size_t s = vs[next];
+                        auto& c = window[next % W];
+                        if (c.t != _parent[s])
+                            break;
+                        _weight[s] = c.value;
+                        for (auto v : c.side)
+                        {
+                            if (pos[v] > next && _parent[v] == c.t)
+                                _parent[v] = s;
+                        }
+                        c.t = _null;
+                    }
+                }
+            }
+        }
+
+        if (!err.empty())
+            throw GraphException(err);
+
+        // the parents always come earlier in the order
+        _depth[vs[0]] = 0;
+        for (size_t i = 1; i < n; ++i)
+            _depth[vs[i]] = _depth[_parent[vs[i]]] + 1;
+    }
+
+    // value of the minimum cut between u and v, i.e. the smallest weight in
+    // the tree path between them; this is infinite if u == v
+    cap_t min_cut(size_t u, size_t v) const
+    {
+        check_vertex(u);
+        check_vertex(v);
+        cap_t c = std::numeric_limits<cap_t>::infinity();
+        while (u != v)
+        {
+            if (_depth[u] < _depth[v])
+                std::swap(u, v);
+            c = std::min(c, _weight[u]);
+            u = _parent[u];
+        }
+        return c;
+    }
+
+    size_t num_vertices() const { return _N; }
+
+    // the parent of each vertex in the tree (or the maximum value of size_t,
+    // for the root and the vertices not in the graph), and the weight of the
+    // edge to it
+    const std::vector<size_t>& get_parent() const { return _parent; }
+    const std::vector<cap_t>& get_weight() const { return _weight; }
+
+    // The tree is stored in a binary format, in host byte order.
+    void save(std::ostream& s) const
+    {
+        s.write(_magic, sizeof(_magic));
+        write(s, _version);
+        write(s, uint64_t(_N));
+        write(s, _parent);
+        write(s, _weight);
+        write(s, _depth);
+        if (!s)
+            throw IOException("error writing Gomory-Hu tree");
+    }
+
+    void load(std::istream& s)
+    {
+        char magic[sizeof(_magic)];
+        s.read(magic, sizeof(magic));
+        if (!s || !std::equal(magic, magic + sizeof(magic), _magic))
+            throw IOException("not a Gomory-Hu tree file");
+        uint32_t version;
+        read(s, version);
+        if (version != _version)
+            throw IOException("unsupported Gomory-Hu tree version: " +
+                              std::to_string(version));
+        uint64_t N;
+        read(s, N);
+        read(s, _parent);
+        read(s, _weight);
+        read(s, _depth);
+        if (!s || _parent.size() != N || _weight.size() != N ||
+            _depth.size() != N)
+            throw IOException("truncated or corrupted Gomory-Hu tree file");
+        _N = N;
+    }
+
+private:
+    void check_vertex(size_t v) const
+    {
+        if (v >= _N || _depth[v] == _null)
+            throw ValueException("Invalid vertex index: " + std::to_string(v));
+    }
+
+    template <class T>
+    static void write(std::ostream& s, const T& x)
+    {
+        s.write(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+
+    template <class T>
+    static void write(std::ostream& s, const std::vector<T>& x)
+    {
+        write(s, uint64_t(x.size()));
+        s.write(reinterpret_cast<const char*>(x.data()), x.size() * sizeof(T));
+    }
+
+    template <class T>
+    static void read(std::istream& s, T& x)
+    {
+        s.read(reinterpret_cast<char*>(&x), sizeof(T));
+    }
+
+    template <class T>
+    static void read(std::istream& s, std::vector<T>& x)
+    {
+        uint64_t n = 0;
+        read(s, n);
+        if (!s)
+            return;
+        x.resize(n);
+        s.read(reinterpret_cast<char*>(x.data()), n * sizeof(T));
+    }
+
+    static constexpr size_t _null = std::numeric_limits<size_t>::max();
+    static constexpr char _magic[4] = {'g', 't', 'g', 'h'};
+    static constexpr uint32_t _version = 1;
+
+    size_t _N = 0;
+    std::vector<size_t> _parent;
+    std::vector<cap_t> _weight;
+    std::vector<size_t> _depth;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_GOMORY_HU_HH
@@ -0,0 +1,309 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_KARGER_STEIN_HH
+#define GRAPH_KARGER_STEIN_HH
+
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_exceptions.hh"
+#include "random.hh"
+#include "../inference/support/parallel_rng.hh"
+
+namespace graph_tool
+{
+
+// Recursive contraction algorithm for the global minimum cut (D. R. Karger and
+// C. Stein, "A new approach to the minimum cut problem", J. ACM 43, 1996).
+//
+// The graph is kept as a flat list of weighted edges between the vertices
+// 0..n-1, without self-loops or parallel edges. A contraction down to t
+// vertices merges the endpoints of the edges in random order, with
+// probability proportional to their weights; this is done by sorting the
+// edges by exponentially distributed keys with rate equal to their weights, and
+// merging them with a union-find structure until t components remain. Each
+// level contracts twice, independently, down to 1 + n/sqrt(2) vertices, and
+// recurses on both; graphs with at most six vertices are solved exactly.
+class karger_stein
+{
+public:
+    struct edge_t
+    {
+        size_t u, v;
+        double w;
+    };
+
+    // minimum cut found by one run of the recursion; side[v] tells the side
+    // of v
+    template <class RNG>
+    double operator()(const std::vector<edge_t>& es, size_t n,
+                      std::vector<uint8_t>& side, RNG& rng)
+    {
+        side.clear();
+        side.resize(n, false);
+        if (n <= _base)
+            return brute_force(es, n, side);
+
+        size_t t = std::ceil(1 + n / std::sqrt(2.));
+        double best = std::numeric_limits<double>::infinity();
+        std::vector<edge_t> ces;
+        std::vector<size_t> label;
+        std::vector<uint8_t> cside;
+        for (size_t i = 0; i < 2; ++i)
+        {
+            contract(es, n, t, ces, label, rng);
+            double c = (*this)(ces, t, cside, rng);
+            if (c < best)
+            {
+                best = c;
+                for (size_t v = 0; v < n; ++v)
+                    side[v] = cside[label[v]];
+            }
+        }
+        return best;
+    }
+
+    // lower bound on the probability that one run finds a minimum cut of a
+    // graph with n vertices, obtained from the recurrence p' >= p - p^2/4 on
+    // the depth of the recursion (R. Motwani and P. Raghavan, "Randomized
+    // algorithms", 1995, Sec. 10.2)
+    static double success_probability(size_t n)
+    {
+        if (n <= _base)
+            return 1;
+        size_t depth = std::ceil(2 * std::log2(double(n)));
+        double q = 3;  // q = 4 / p - 1, with p = 1 at the leaves
+        for (size_t k = 0; k < depth; ++k)
+            q += 1 + 1 / q;
+        return 4 / (q + 1);
+    }
+
+private:
+    // contracts the graph to t vertices; label[v] is the new vertex of v
+    template <class RNG>
+    void contract(const std::vector<edge_t>& es, size_t n, size_t t,
+                  std::vector<edge_t>& ces, std::vector<size_t>& label,
+                  RNG& rng)
+    {
+        std::uniform_real_distribution<double> unif;
+        _keys.resize(es.size());
+        for (size_t i = 0; i < es.size(); ++i)
+            _keys[i] = {-std::log1p(-unif(rng)) / es[i].w, i};
+        std::sort(_keys.begin(), _keys.end());
+
+        label.resize(n);
+        for (size_t v = 0; v < n; ++v)
+            label[v] = v;
+        auto find = [&](size_t v)
+            {
+                while (label[v] != v)
+                {
+                    label[v] = label[label[v]];
+                    v = label[v];
+                }
+                return v;
+            };
+
+        size_t nc = n;
+        for (size_t i = 0; i < _keys.size() && nc > t; ++i)
+        {
+            auto& e = es[_keys[i].second];
+            size_t u = find(e.u);
+            size_t v = find(e.v);
+            if (u == v)
+                continue;
+            label[std::max(u, v)] = std::min(u, v);
+            --nc;
+        }
+
+        // compact labels; the roots come before the rest of their components
+        for (size_t v = 0; v < n; ++v)
+            label[v] = find(v);
+        size_t c = 0;
+        for (size_t v = 0; v < n; ++v)
+            label[v] = (label[v] == v) ? c++ : label[label[v]];
+
+        ces.clear();
+        for (auto& e : es)
+        {
+            size_t u = label[e.u];
+            size_t v = label[e.v];
+            if (u == v)
+                continue;
+            if (u > v)
+                std::swap(u, v);
+            ces.push_back({u, v, e.w});
+        }
+        merge_edges(ces);
+    }
+
+    static double brute_force(const std::vector<edge_t>& es, size_t n,
+                              std::vector<uint8_t>& side)
+    {
+        double best = std::numeric_limits<double>::infinity();
+        size_t best_mask = 0;
+        // vertex n - 1 is always on side 0
+        for (size_t mask = 1; mask < (size_t(1) << (n - 1)); ++mask)
+        {
+            double c = 0;
+            for (auto& e : es)
+            {
+                if (((mask >> e.u) & 1) != ((mask >> e.v) & 1))
+                    c += e.w;
+            }
+            if (c < best)
+            {
+                best = c;
+                best_mask = mask;
+            }
+        }
+        for (size_t v = 0; v < n; ++v)
+            side[v] = (best_mask >> v) & 1;
+        return best;
+    }
+
+public:
+    // sorts the edges, which must have u < v, and merges the parallel ones
+    static void merge_edges(std::vector<edge_t>& es)
+    {
+        std::sort(es.begin(), es.end(),
+                  [](const edge_t& a, const edge_t& b)
+                  { return std::make_pair(a.u, a.v) <
+                           std::make_pair(b.u, b.v); });
+        size_t j = 0;
+        for (size_t i = 0; i < es.size(); ++i)
+        {
+            if (j > 0 && es[j - 1].u == es[i].u && es[j - 1].v == es[i].v)
+                es[j - 1].w += es[i].w;
+            else
+                es[j++] = es[i];
+        }
+        es.resize(j);
+    }
+
+private:
+    static constexpr size_t _base = 6;
+
+    std::vector<std::pair<double, size_t>> _keys;
+};
+
+// Runs the given number of independent Karger-Stein trials in parallel, and
+// returns the smallest cut found, with its sides in part. Edges with
+// non-positive weights are ignored, so that a disconnected graph has a cut of
+// zero, which is returned directly.
+template <class Graph, class WeightMap, class PartMap, class RNG>
+double karger_stein_min_cut(const Graph& g, WeightMap weight, PartMap part,
+                            size_t trials, RNG& rng)
+{
+    typedef karger_stein::edge_t edge_t;
+
+    std::vector<size_t> vs, idx(num_vertices(g));
+    for (auto v : vertices_range(g))
+    {
+        idx[v] = vs.size();
+        vs.push_back(v);
+    }
+    size_t n = vs.size();
+    if (n < 2)
+        throw ValueException("Graph has less than 2 vertices.");
+
+    std::vector<edge_t> es;
+    for (auto e : edges_range(g))
+    {
+        size_t u = idx[source(e, g)];
+        size_t v = idx[target(e, g)];
+        double w = get(weight, e);
+        if (u == v || !(w > 0))
+            continue;
+        if (u > v)
+            std::swap(u, v);
+        es.push_back({u, v, w});
+    }
+    karger_stein::merge_edges(es);
+
+    // disconnected graphs have a trivial cut
+    std::vector<size_t> comp(n);
+    for (size_t v = 0; v < n; ++v)
+        comp[v] = v;
+    auto find = [&](size_t v)
+        {
+            while (comp[v] != v)
+            {
+                comp[v] = comp[comp[v]];
+                v = comp[v];
+            }
+            return v;
+        };
+    size_t nc = n;
+    for (auto& e : es)
+    {
+        size_t u = find(e.u);
+        size_t v = find(e.v);
+        if (u == v)
+            continue;
+        comp[std::max(u, v)] = std::min(u, v);
+        --nc;
+    }
+    if (nc > 1)
+    {
+        for (size_t v = 0; v < n; ++v)
+            part[vs[v]] = (find(v) == 0);
+        return 0;
+    }
+
+    std::vector<std::shared_ptr<RNG>> rngs;
+    init_rngs(rngs, rng);
+
+    double best = std::numeric_limits<double>::infinity();
+    std::vector<uint8_t> best_side;
+    #pragma omp parallel if (trials > 1)
+    {
+        karger_stein ks;
+        std::vector<uint8_t> side;
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t i = 0; i < trials; ++i)
+        {
+            auto& trng = get_rng(rngs, rng);
+            double c = ks(es, n, side, trng);
+            #pragma omp critical (karger_stein)
+            {
+                if (c < best)
+                {
+                    best = c;
+                    best_side = side;
+                }
+            }
+        }
+    }
+
+    for (size_t v = 0; v < n; ++v)
+        part[vs[v]] = best_side[v];
+    return best;
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_KARGER_STEIN_HH
@@ -20,31 +20,7 @@
 #include "graph_properties.hh"
 #include "graph.hh"
 
-#include "graph_augment.hh"
-
-#include <boost/mpl/if.hpp>
-#include <boost/mpl/or.hpp>
-namespace std
-{
-using namespace boost;
-
-// we need a min() function with arguments of different types
-
-template <class T1, class T2>
-typename boost::mpl::if_<
-    typename boost::mpl::or_<typename std::is_floating_point<T1>::type,
-                             typename std::is_floating_point<T2>::type>::type,
-    double, int>::type
-min(const T1& v1, const T2& v2)
-{
-    if (v1 <= T1(v2))
-        return v1;
-    else
-        return v2;
-}
-}
-
-#include <boost/bind.hpp>
+#include "graph_residual_network.hh"
 
 using namespace graph_tool;
 using namespace boost;
@@ -59,35 +35,30 @@ using namespace boost;
 
 struct get_kolmogorov_max_flow
 {
-    template <class Graph, class EdgeIndex, class VertexIndex,
-              class CapacityMap, class ResidualMap>
-    void operator()(Graph& g, EdgeIndex edge_index, size_t,
-                    VertexIndex vertex_index, size_t src, size_t sink,
-                    CapacityMap cm, ResidualMap res) const
+    template <class Graph, class EdgeIndex, class CapacityMap,
+              class ResidualMap>
+    void operator()(Graph& g, EdgeIndex edge_index, size_t max_e, size_t src,
+                    size_t sink, CapacityMap cm, ResidualMap res) const
     {
-        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
-        checked_vector_property_map<uint8_t,EdgeIndex>
-            augmented(edge_index);
-        checked_vector_property_map<edge_t,EdgeIndex>
-            reverse_map(edge_index);
-        unchecked_vector_property_map<edge_t,VertexIndex>
-            pred_map(vertex_index, num_vertices(g));
-        unchecked_vector_property_map<size_t,VertexIndex>
-            color_map(vertex_index, num_vertices(g));
-        unchecked_vector_property_map<size_t,VertexIndex>
-            dist_map(vertex_index, num_vertices(g));
-
-        typedef typename std::remove_const<Graph>::type GT;
-        GT& u = const_cast<GT&>(g);
-
-        augment_graph(u, augmented, cm, reverse_map, res, true);
-
-        KOLMOGOROV_MAX_FLOW(g, cm, res, reverse_map, pred_map, color_map,
-                            dist_map, vertex_index, vertex(src, g),
-                            vertex(sink, g));
-
-        deaugment_graph(u, augmented);
-
+        typedef typename property_traits<CapacityMap>::value_type val_t;
+        residual_network<val_t> net(g, edge_index, max_e);
+        net.set_capacity(g, edge_index, cm);
+
+        typedef typename residual_network<val_t>::index_map_t index_map_t;
+        size_t N = num_vertices(net);
+        unchecked_vector_property_map<size_t,index_map_t>
+            pred_map(net.get_index_map(), N);
+        unchecked_vector_property_map<size_t,index_map_t>
+            color_map(net.get_index_map(), N);
+        unchecked_vector_property_map<size_t,index_map_t>
+            dist_map(net.get_index_map(), N);
+
+        KOLMOGOROV_MAX_FLOW(net, net.get_capacity_map(),
+                            net.get_residual_map(), net.get_reverse_map(),
+                            pred_map, color_map, dist_map,
+                            net.get_index_map(), src, sink);
+
+        net.get_residual(g, edge_index, res);
     }
 };
 
@@ -95,11 +66,11 @@ struct get_kolmogorov_max_flow
 void kolmogorov_max_flow(GraphInterface& gi, size_t src, size_t sink,
                          boost::any capacity, boost::any res)
 {
-    run_action<graph_tool::detail::always_directed, boost::mpl::true_>()
+    run_action<graph_tool::detail::always_directed>()
         (gi, std::bind(get_kolmogorov_max_flow(),
-                       std::placeholders::_1, gi.get_edge_index(), gi.get_edge_index_range(),
-                       gi.get_vertex_index(), src, sink,  std::placeholders::_2,
-                       std::placeholders::_3),
+                       std::placeholders::_1, gi.get_edge_index(),
+                       gi.get_edge_index_range(),
+                       src, sink,  std::placeholders::_2, std::placeholders::_3),
          writable_edge_scalar_properties(), writable_edge_scalar_properties())
         (capacity,res);
 }
@@ -20,7 +20,6 @@
 #include "graph_properties.hh"
 #include "graph.hh"
 
-#include "graph_augment.hh"
 
 #include <boost/graph/max_cardinality_matching.hpp>
 
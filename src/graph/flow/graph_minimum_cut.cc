@@ -19,7 +19,8 @@
 #include "graph.hh"
 #include "graph_properties.hh"
 
-#include "graph_augment.hh"
+#include "graph_residual_network.hh"
+#include "graph_karger_stein.hh"
 #include <boost/graph/stoer_wagner_min_cut.hpp>
 
 using namespace std;
@@ -62,24 +63,53 @@ double min_cut(GraphInterface& gi, boost::any weight, boost::any part_map)
     return mc;
 }
 
-struct do_get_residual_graph
+double min_cut_karger_stein(GraphInterface& gi, boost::any weight,
+                            boost::any part_map, size_t trials, rng_t& rng)
 {
-    template <class Graph, class CapacityMap, class ResidualMap,
-              class AugmentedMap>
-    void operator()(Graph& g, CapacityMap capacity, ResidualMap res,
-                    AugmentedMap augmented) const
+    double mc = 0;
+
+    typedef UnityPropertyMap<size_t,GraphInterface::edge_t> cweight_t;
+
+    if (weight.empty())
+        weight = cweight_t();
+
+    typedef boost::mpl::push_back<writable_edge_scalar_properties, cweight_t>::type
+        weight_maps;
+
+    run_action<graph_tool::detail::never_directed>()
+        (gi, [&](auto& g, auto w, auto part)
+         {
+             mc = karger_stein_min_cut(g, w, part, trials, rng);
+         },
+         weight_maps(), writable_vertex_scalar_properties())(weight, part_map);
+    return mc;
+}
+
+struct do_min_st_cut
+{
+    template <class Graph, class EdgeIndex, class CapacityMap,
+              class ResidualMap, class PartMap>
+    void operator()(Graph& g, EdgeIndex edge_index, size_t max_e, size_t src,
+                    CapacityMap capacity, ResidualMap res, PartMap part) const
     {
-        residual_graph(g, capacity, res, augmented);
+        typedef typename property_traits<CapacityMap>::value_type val_t;
+        residual_network<val_t> net(g, edge_index, max_e);
+        net.set_residual(g, edge_index, capacity, res);
+        residual_reach(net, src, part);
     }
 };
 
-void get_residual_graph(GraphInterface& gi, boost::any capacity,
-                        boost::any res, boost::any oaugment)
+void min_st_cut(GraphInterface& gi, size_t src, boost::any capacity,
+                boost::any res, boost::any opart)
 {
-    typedef eprop_map_t<uint8_t>::type emap_t;
-    emap_t augment = boost::any_cast<emap_t>(oaugment);
-    run_action<>()
-        (gi, std::bind(do_get_residual_graph(), std::placeholders::_1,
-                       std::placeholders::_2, std::placeholders::_3, augment),
+    if (src >= gi.get_num_vertices(false))
+        throw ValueException("Invalid vertex index: " + std::to_string(src));
+    typedef vprop_map_t<uint8_t>::type vmap_t;
+    vmap_t part = boost::any_cast<vmap_t>(opart);
+    run_action<graph_tool::detail::always_directed>()
+        (gi, std::bind(do_min_st_cut(), std::placeholders::_1,
+                       gi.get_edge_index(), gi.get_edge_index_range(), src,
+                       std::placeholders::_2, std::placeholders::_3,
+                       part.get_unchecked(num_vertices(gi.get_graph()))),
          edge_scalar_properties(), edge_scalar_properties())(capacity, res);
 }
@@ -0,0 +1,367 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PARALLEL_PUSH_RELABEL_HH
+#define GRAPH_PARALLEL_PUSH_RELABEL_HH
+
+#include <vector>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_residual_network.hh"
+
+namespace graph_tool
+{
+
+// Synchronous parallel push-relabel (N. Baumstark, G. Blelloch and J. Shun,
+// "Efficient implementation of a synchronous parallel push-relabel algorithm",
+// ESA 2015), on a residual_network.
+//
+// In each round all active vertices are discharged in parallel, reading only
+// the labels and excesses of the previous round; the new labels and the excess
+// received are applied once the round is over. Two neighbouring active vertices
+// could otherwise push to each other along the same edge, which is avoided by
+// letting only the "winner" of the pair push.
+//
+// The labels are kept exact by periodic global relabeling, i.e. a parallel
+// reverse BFS from the sink, followed by one from the source with labels
+// starting at N, for the vertices that can no longer reach the sink. This way
+// the excess that cannot reach the sink is returned to the source in the same
+// pass, and the residual capacities describe a valid maximum flow at the end.
+// A gap in the labels below N, detected by counting the vertices of each
+// label, triggers an immediate global relabeling, which lifts every vertex
+// above the gap.
+//
+// The residual capacities are modified in place; they should be initialized
+// with the capacities.
+class parallel_push_relabel
+{
+public:
+    template <class Value>
+    void operator()(residual_network<Value>& net, size_t s, size_t t)
+    {
+        size_t N = num_vertices(net);
+        if (s == t)
+            return;
+        _N = N;
+        _nt = 1;
+#ifdef _OPENMP
+        if (!omp_in_parallel())
+            _nt = omp_get_max_threads();
+#endif
+        _buffers.clear();
+        _buffers.resize(_nt);
+
+        auto res = net.get_residual_map();
+
+        std::vector<Value> excess(N), added(N), rem(N);
+        _label.clear();
+        _label.resize(N, 2 * N);
+        _new_label.clear();
+        _new_label.resize(N, 2 * N);
+        _count.clear();
+        _count.resize(N, 0);
+        _in_next.clear();
+        _in_next.resize(N, false);
+
+        size_t M = num_edges(net);
+        size_t threshold = _alpha * N + M / 2;
+        size_t work = 0;
+        bool relabel = true;
+
+        _active.clear();
+        while (true)
+        {
+            bool fresh = relabel || work > threshold;
+            if (fresh)
+            {
+                global_relabel(net, s, t);
+                work = 0;
+                relabel = false;
+
+                // (re)saturate the arcs leaving the source towards vertices
+                // that can reach the sink; the labels of a synchronous round
+                // are not always exact, so this is repeated after each global
+                // relabeling, and there is no augmenting path left once no
+                // such arc exists and no vertex is active
+                for (auto a = net.out_begin(s); a != net.out_end(s); ++a)
+                {
+                    size_t w = net.head(*a);
+                    Value r = res[*a];
+                    if (r <= 0 || _label[w] >= N)
+                        continue;
+                    res[*a] = 0;
+                    res[*a ^ 1] += r;
+                    if (w != t)
+                        excess[w] += r;
+                }
+
+                _active.clear();
+                for (size_t v = 0; v < N; ++v)
+                {
+                    if (excess[v] > 0 && _label[v] < 2 * N)
+                        _active.push_back(v);
+                }
+            }
+
+            if (_active.empty())
+            {
+                // confirm with exact labels
+                if (fresh)
+                    break;
+                relabel = true;
+                continue;
+            }
+
+            size_t A = _active.size();
+
+            // discharge the active vertices, with the labels and excesses of
+            // the previous round
+            #pragma omp parallel for schedule(runtime) num_threads(_nt) \
+                reduction(+:work) if (A > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < A; ++i)
+            {
+                size_t tid = 0;
+#ifdef _OPENMP
+                tid = omp_get_thread_num();
+#endif
+                auto& buf = _buffers[tid];
+                size_t v = _active[i];
+                Value e = excess[v];
+                size_t d = _label[v];
+                size_t dv = d;
+
+                while (e > 0)
+                {
+                    size_t new_label = 2 * N;
+                    bool skipped = false;
+                    for (auto a = net.out_begin(v); a != net.out_end(v); ++a)
+                    {
+                        if (e == 0)
+                            break;
+                        ++work;
+                        Value r;
+                        #pragma omp atomic read
+                        r = res[*a];
+                        if (r <= 0)
+                            continue;
+                        size_t w = net.head(*a);
+                        size_t dw = _label[w];
+                        bool admissible = (d == dw + 1);
+                        if (excess[w] > 0)
+                        {
+                            bool win = (dv == dw + 1 || dv + 1 < dw ||
+                                        (dv == dw && v < w));
+                            if (admissible && !win)
+                            {
+                                skipped = true;
+                                continue;
+                            }
+                        }
+                        if (admissible)
+                        {
+                            Value delta = std::min(r, e);
+                            #pragma omp atomic
+                            res[*a] -= delta;
+                            #pragma omp atomic
+                            res[*a ^ 1] += delta;
+                            e -= delta;
+                            r -= delta;
+                            if (w != s && w != t)
+                            {
+                                Value old;
+                                #pragma omp atomic capture
+                                { old = added[w]; added[w] += delta; }
+                                if (old == 0)
+                                    buf.push_back(w);
+                            }
+                        }
+                        if (r > 0 && dw >= d)
+                            new_label = std::min(new_label, dw + 1);
+                    }
+                    if (e == 0 || skipped)
+                        break;
+                    d = new_label;
+                    work += _beta;
+                    if (d >= 2 * N)
+                        break;
+                }
+                _new_label[v] = d;
+                rem[v] = e;
+            }
+
+            // apply the new labels and excesses, counting the vertices that
+            // leave each label
+            size_t gap = N;
+            #pragma omp parallel for schedule(runtime) num_threads(_nt) \
+                reduction(min:gap) if (A > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < A; ++i)
+            {
+                size_t v = _active[i];
+                size_t d = _label[v];
+                size_t nd = _new_label[v];
+                if (nd == d)
+                    continue;
+                _label[v] = nd;
+                if (nd < N)
+                {
+                    #pragma omp atomic
+                    _count[nd]++;
+                }
+                if (d < N)
+                {
+                    size_t c;
+                    #pragma omp atomic capture
+                    c = --_count[d];
+                    if (c == 0 && nd < N)
+                        gap = std::min(gap, d);
+                }
+            }
+
+            // collect the next active set
+            _next.clear();
+            for (auto v : _active)
+            {
+                excess[v] = rem[v] + added[v];
+                added[v] = 0;
+                if (excess[v] > 0 && _label[v] < 2 * N)
+                {
+                    _in_next[v] = true;
+                    _next.push_back(v);
+                }
+            }
+            for (auto& buf : _buffers)
+            {
+                for (auto w : buf)
+                {
+                    if (added[w] != 0)
+                    {
+                        excess[w] += added[w];
+                        added[w] = 0;
+                    }
+                    if (_in_next[w] || _label[w] >= 2 * N)
+                        continue;
+                    _in_next[w] = true;
+                    _next.push_back(w);
+                }
+                buf.clear();
+            }
+            for (auto v : _next)
+                _in_next[v] = false;
+            _active.swap(_next);
+
+            if (gap < N)
+                relabel = true;
+        }
+    }
+
+private:
+    // exact labels: distance to the sink in the residual network, or N plus
+    // the distance to the source for the vertices that cannot reach the sink,
+    // or 2N for those that reach neither
+    template <class Value>
+    void global_relabel(residual_network<Value>& net, size_t s, size_t t)
+    {
+        size_t N = _N;
+        auto res = net.get_residual_map();
+
+        #pragma omp parallel for schedule(runtime) num_threads(_nt) \
+            if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            _label[v] = 2 * N;
+            _count[v] = 0;
+        }
+
+        _label[s] = N;
+        reverse_bfs(net, res, t, 0);
+        reverse_bfs(net, res, s, N);
+    }
+
+    // labels the vertices that reach r via residual arcs, with base + their
+    // distance to r
+    template <class Value, class ResMap>
+    void reverse_bfs(residual_network<Value>& net, ResMap res, size_t r,
+                     size_t base)
+    {
+        size_t N = _N;
+        _label[r] = base;
+        if (base < N)
+            _count[base]++;
+        _frontier.clear();
+        _frontier.push_back(r);
+        for (size_t d = base + 1; !_frontier.empty(); ++d)
+        {
+            size_t F = _frontier.size();
+            #pragma omp parallel for schedule(runtime) num_threads(_nt) \
+                if (F > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < F; ++i)
+            {
+                size_t tid = 0;
+#ifdef _OPENMP
+                tid = omp_get_thread_num();
+#endif
+                auto& buf = _buffers[tid];
+                size_t v = _frontier[i];
+                for (auto a = net.out_begin(v); a != net.out_end(v); ++a)
+                {
+                    size_t u = net.head(*a);
+                    if (_label[u] == 2 * N && res[*a ^ 1] > 0)
+                        buf.push_back(u);
+                }
+            }
+
+            _frontier.clear();
+            for (auto& buf : _buffers)
+            {
+                for (auto u : buf)
+                {
+                    if (_label[u] != 2 * N)
+                        continue;
+                    _label[u] = d;
+                    if (d < N)
+                        _count[d]++;
+                    _frontier.push_back(u);
+                }
+                buf.clear();
+            }
+        }
+    }
+
+    // global relabeling frequency, and the work assigned to each relabel, as
+    // suggested by Baumstark et al.
+    static constexpr size_t _alpha = 6;
+    static constexpr size_t _beta = 12;
+
+    size_t _N = 0;
+    size_t _nt = 1;
+    std::vector<size_t> _label;
+    std::vector<size_t> _new_label;
+    std::vector<size_t> _count;
+    std::vector<uint8_t> _in_next;
+    std::vector<size_t> _active;
+    std::vector<size_t> _next;
+    std::vector<size_t> _frontier;
+    std::vector<std::vector<size_t>> _buffers;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_PARALLEL_PUSH_RELABEL_HH
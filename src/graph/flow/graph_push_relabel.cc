@@ -20,64 +20,45 @@
 #include "graph_properties.hh"
 #include "graph.hh"
 
-#include "graph_augment.hh"
-
-#include <boost/mpl/if.hpp>
-#include <boost/mpl/or.hpp>
-namespace std
-{
-using namespace boost;
-
-// we need a min() function with arguments of different types
-
-template <class T1, class T2>
-typename boost::mpl::if_<
-    typename boost::mpl::or_<typename std::is_floating_point<T1>::type,
-                             typename std::is_floating_point<T2>::type>::type,
-    double, int>::type
-min(const T1& v1, const T2& v2)
-{
-    if (v1 <= T1(v2))
-        return v1;
-    else
-        return v2;
-}
-}
+#include "graph_residual_network.hh"
+#include "graph_parallel_push_relabel.hh"
 
 #include <boost/graph/push_relabel_max_flow.hpp>
 
-#include <boost/bind.hpp>
-
 using namespace graph_tool;
 using namespace boost;
 
-
-
 struct get_push_relabel_max_flow
 {
-    template <class Graph, class VertexIndex, class EdgeIndex, class CapacityMap,
+    template <class Graph, class EdgeIndex, class CapacityMap,
               class ResidualMap>
-    void operator()(Graph& g, VertexIndex vertex_index, EdgeIndex edge_index,
-                    size_t max_e, size_t src, size_t sink, CapacityMap cm,
-                    ResidualMap res) const
+    void operator()(Graph& g, EdgeIndex edge_index, size_t max_e, size_t src,
+                    size_t sink, CapacityMap cm, ResidualMap res) const
     {
-        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
-        checked_vector_property_map<bool,EdgeIndex>
-            augmented(edge_index);
-        unchecked_vector_property_map<edge_t,EdgeIndex>
-            reverse_map(edge_index, max_e);
-
-        typedef typename std::remove_const<Graph>::type GT;
-        GT& u = const_cast<GT&>(g);
-
-        augment_graph(u, augmented, cm,
-                      reverse_map.get_checked(), res);
-
-        boost::push_relabel_max_flow(g, vertex(src, g), vertex(sink, g),
-                                     get_unchecked(cm),
-                                     res.get_unchecked(),
-                                     reverse_map, vertex_index);
-        deaugment_graph(u, augmented);
+        typedef typename property_traits<CapacityMap>::value_type val_t;
+        residual_network<val_t> net(g, edge_index, max_e);
+        net.set_capacity(g, edge_index, cm);
+
+        // the synchronous rounds only pay off for large graphs
+        size_t n_threads = 1;
+#ifdef _OPENMP
+        n_threads = omp_get_max_threads();
+#endif
+        if (num_vertices(net) > OPENMP_MIN_THRESH && n_threads > 1)
+        {
+            net.reset_residual();
+            parallel_push_relabel()(net, src, sink);
+        }
+        else
+        {
+            boost::push_relabel_max_flow(net, src, sink,
+                                         net.get_capacity_map(),
+                                         net.get_residual_map(),
+                                         net.get_reverse_map(),
+                                         net.get_index_map());
+        }
+
+        net.get_residual(g, edge_index, res);
     }
 };
 
@@ -85,9 +66,9 @@ struct get_push_relabel_max_flow
 void push_relabel_max_flow(GraphInterface& gi, size_t src, size_t sink,
                            boost::any capacity, boost::any res)
 {
-    run_action<graph_tool::detail::always_directed, boost::mpl::true_>()
+    run_action<graph_tool::detail::always_directed>()
         (gi, std::bind(get_push_relabel_max_flow(),
-                       std::placeholders::_1, gi.get_vertex_index(), gi.get_edge_index(),
+                       std::placeholders::_1, gi.get_edge_index(),
                        gi.get_edge_index_range(),
                        src, sink,  std::placeholders::_2,  std::placeholders::_3),
          writable_edge_scalar_properties(), writable_edge_scalar_properties())
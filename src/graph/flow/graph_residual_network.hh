@@ -0,0 +1,309 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_RESIDUAL_NETWORK_HH
+#define GRAPH_RESIDUAL_NETWORK_HH
+
+#include <vector>
+
+#include <boost/graph/graph_traits.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Residual network used by the max-flow algorithms, built as a compact
+// snapshot of a directed graph, so that the graph itself does not need to be
+// augmented with reverse edges. The edge with index i gives two arcs: the
+// forward arc 2i, with the capacity of the edge, and the reverse arc 2i + 1,
+// with capacity zero, so that the reverse of arc a is always a ^ 1. The arcs
+// are grouped by their tail in a CSR layout. The arc ids are the edge
+// descriptors of the BGL interface below, and index the capacity and residual
+// maps directly.
+template <class Value>
+class residual_network
+{
+public:
+    typedef size_t vertex_t;
+    typedef size_t arc_t;
+    typedef boost::typed_identity_property_map<size_t> index_map_t;
+    typedef boost::unchecked_vector_property_map<Value, index_map_t> cap_map_t;
+
+    // reverse arc, computed on the fly
+    struct reverse_map_t
+    {
+        typedef size_t key_type;
+        typedef size_t value_type;
+        typedef size_t reference;
+        typedef boost::readable_property_map_tag category;
+
+        friend size_t get(const reverse_map_t&, size_t a) { return a ^ 1; }
+    };
+
+    template <class Graph, class EdgeIndex>
+    residual_network(const Graph& g, EdgeIndex eindex, size_t max_e)
+        : _capacity(index_map_t(), 2 * max_e),
+          _residual(index_map_t(), 2 * max_e),
+          _head(2 * max_e, 0)
+    {
+        size_t N = num_vertices(g);
+        _offset.resize(N + 1, 0);
+        for (auto e : edges_range(g))
+        {
+            size_t i = eindex[e];
+            _offset[source(e, g) + 1]++;
+            _offset[target(e, g) + 1]++;
+            _head[2 * i] = target(e, g);
+            _head[2 * i + 1] = source(e, g);
+        }
+        for (size_t v = 0; v < N; ++v)
+            _offset[v + 1] += _offset[v];
+
+        _out.resize(_offset[N]);
+        std::vector<size_t> pos(_offset.begin(), _offset.end() - 1);
+        for (auto e : edges_range(g))
+        {
+            size_t i = eindex[e];
+            _out[pos[source(e, g)]++] = 2 * i;
+            _out[pos[target(e, g)]++] = 2 * i + 1;
+        }
+    }
+
+    // sets the capacities of the forward arcs from the edges, and zero for the
+    // reverse ones
+    template <class Graph, class EdgeIndex, class CapacityMap>
+    void set_capacity(const Graph& g, EdgeIndex eindex, CapacityMap capacity)
+    {
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 size_t i = eindex[e];
+                 _capacity[2 * i] = get(capacity, e);
+                 _capacity[2 * i + 1] = 0;
+             });
+    }
+
+    // same as above, but for undirected graphs, where both arcs of an edge
+    // have its capacity
+    template <class Graph, class EdgeIndex, class CapacityMap>
+    void set_symmetric_capacity(const Graph& g, EdgeIndex eindex,
+                                CapacityMap capacity)
+    {
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 size_t i = eindex[e];
+                 _capacity[2 * i] = _capacity[2 * i + 1] = get(capacity, e);
+             });
+    }
+
+    // sets the residual capacities of both arcs of each edge from the residual
+    // capacities of the edges, as returned by get_residual()
+    template <class Graph, class EdgeIndex, class CapacityMap, class ResidualMap>
+    void set_residual(const Graph& g, EdgeIndex eindex, CapacityMap capacity,
+                      ResidualMap res)
+    {
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 size_t i = eindex[e];
+                 _residual[2 * i] = get(res, e);
+                 _residual[2 * i + 1] = get(capacity, e) - get(res, e);
+             });
+    }
+
+    // resets the residual capacities to the capacities, as expected by the
+    // algorithms that do not initialize them themselves
+    void reset_residual()
+    {
+        size_t A = num_arcs();
+        #pragma omp parallel for schedule(runtime) if (A > OPENMP_MIN_THRESH)
+        for (size_t a = 0; a < A; ++a)
+            _residual[a] = _capacity[a];
+    }
+
+    // copies the residual capacities of the forward arcs back to the edges
+    template <class Graph, class EdgeIndex, class ResidualMap>
+    void get_residual(const Graph& g, EdgeIndex eindex, ResidualMap res)
+    {
+        typedef typename boost::property_traits<ResidualMap>::value_type val_t;
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 put(res, e, val_t(_residual[2 * eindex[e]]));
+             });
+    }
+
+    cap_map_t get_capacity_map() { return _capacity; }
+    cap_map_t get_residual_map() { return _residual; }
+    reverse_map_t get_reverse_map() { return reverse_map_t(); }
+    index_map_t get_index_map() { return index_map_t(); }
+
+    size_t num_nodes() const { return _offset.size() - 1; }
+    size_t num_arcs() const { return _head.size(); }
+    size_t head(size_t a) const { return _head[a]; }
+    size_t tail(size_t a) const { return _head[a ^ 1]; }
+
+    typedef std::vector<size_t>::const_iterator out_iterator;
+    out_iterator out_begin(size_t v) const
+    { return _out.begin() + _offset[v]; }
+    out_iterator out_end(size_t v) const
+    { return _out.begin() + _offset[v + 1]; }
+
+private:
+    cap_map_t _capacity;
+    cap_map_t _residual;
+    std::vector<size_t> _head;
+    std::vector<size_t> _offset;
+    std::vector<size_t> _out;
+};
+
+// Marks the vertices reachable from s via arcs with positive residual
+// capacity, i.e. the source side of the minimum cut.
+template <class Value, class PartMap>
+void residual_reach(residual_network<Value>& net, size_t s, PartMap part)
+{
+    auto res = net.get_residual_map();
+    std::vector<size_t> stack = {s};
+    part[s] = true;
+    while (!stack.empty())
+    {
+        size_t v = stack.back();
+        stack.pop_back();
+        for (auto a = net.out_begin(v); a != net.out_end(v); ++a)
+        {
+            size_t u = net.head(*a);
+            if (res[*a] > 0 && !part[u])
+            {
+                part[u] = true;
+                stack.push_back(u);
+            }
+        }
+    }
+}
+
+} // namespace graph_tool
+
+namespace boost
+{
+
+struct residual_network_traversal_tag
+    : public virtual incidence_graph_tag,
+      public virtual vertex_list_graph_tag,
+      public virtual edge_list_graph_tag {};
+
+template <class Value>
+struct graph_traits<graph_tool::residual_network<Value>>
+{
+    typedef size_t vertex_descriptor;
+    typedef size_t edge_descriptor;
+    typedef directed_tag directed_category;
+    typedef allow_parallel_edge_tag edge_parallel_category;
+    typedef residual_network_traversal_tag traversal_category;
+
+    typedef counting_iterator<size_t> vertex_iterator;
+    typedef counting_iterator<size_t> edge_iterator;
+    typedef typename graph_tool::residual_network<Value>::out_iterator
+        out_edge_iterator;
+    // only needed to instantiate filtered_graph, in-edges are not available
+    typedef out_edge_iterator in_edge_iterator;
+
+    typedef size_t vertices_size_type;
+    typedef size_t edges_size_type;
+    typedef size_t degree_size_type;
+
+    static vertex_descriptor null_vertex()
+    {
+        return std::numeric_limits<size_t>::max();
+    }
+};
+
+template <class Value>
+struct graph_traits<const graph_tool::residual_network<Value>>
+    : public graph_traits<graph_tool::residual_network<Value>> {};
+
+} // namespace boost
+
+namespace graph_tool
+{
+
+template <class Value>
+inline size_t num_vertices(const residual_network<Value>& g)
+{
+    return g.num_nodes();
+}
+
+template <class Value>
+inline size_t num_edges(const residual_network<Value>& g)
+{
+    return g.num_arcs();
+}
+
+template <class Value>
+inline std::pair<boost::counting_iterator<size_t>,
+                 boost::counting_iterator<size_t>>
+vertices(const residual_network<Value>& g)
+{
+    return std::make_pair(boost::counting_iterator<size_t>(0),
+                          boost::counting_iterator<size_t>(g.num_nodes()));
+}
+
+// the arcs of edges that are filtered out are isolated, with capacity zero
+template <class Value>
+inline std::pair<boost::counting_iterator<size_t>,
+                 boost::counting_iterator<size_t>>
+edges(const residual_network<Value>& g)
+{
+    return std::make_pair(boost::counting_iterator<size_t>(0),
+                          boost::counting_iterator<size_t>(g.num_arcs()));
+}
+
+template <class Value>
+inline std::pair<typename residual_network<Value>::out_iterator,
+                 typename residual_network<Value>::out_iterator>
+out_edges(size_t v, const residual_network<Value>& g)
+{
+    return std::make_pair(g.out_begin(v), g.out_end(v));
+}
+
+template <class Value>
+inline size_t out_degree(size_t v, const residual_network<Value>& g)
+{
+    return g.out_end(v) - g.out_begin(v);
+}
+
+template <class Value>
+inline size_t source(size_t a, const residual_network<Value>& g)
+{
+    return g.tail(a);
+}
+
+template <class Value>
+inline size_t target(size_t a, const residual_network<Value>& g)
+{
+    return g.head(a);
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_RESIDUAL_NETWORK_HH
@@ -20,6 +20,8 @@
 
 #include "random.hh"
 #include <functional>
+#include <tuple>
+#include <algorithm>
 #include <boost/mpl/if.hpp>
 
 namespace graph_tool
@@ -37,8 +39,7 @@ public:
                    const vector<double>& probs)
         : _back(0), _n_items(0)
     {
-        for (size_t i = 0; i < items.size(); ++i)
-            insert(items[i], probs[i]);
+        build(items, probs);
     }
 
     typedef Value value_type;
@@ -72,6 +73,49 @@ public:
         return _items[i];
     }
 
+    // Samples n items independently, and appends them to out. The uniform
+    // variates are sorted, and the tree is traversed only once, splitting them
+    // between the subtrees; hence the samples are appended in the order of the
+    // tree leaves, not in random order.
+    template <class RNG>
+    void sample_n(RNG& rng, size_t n, vector<Value>& out) const
+    {
+        if (n == 0)
+            return;
+        uniform_real_distribution<> sample(0, 1);
+        vector<double> us(n);
+        for (auto& u : us)
+            u = _tree[0] * sample(rng);
+        std::sort(us.begin(), us.end());
+
+        // stack of (node, first variate, last variate, offset)
+        vector<std::tuple<size_t, size_t, size_t, double>> stack;
+        stack.emplace_back(0, 0, n, 0.);
+        while (!stack.empty())
+        {
+            size_t pos, begin, end;
+            double c;
+            std::tie(pos, begin, end, c) = stack.back();
+            stack.pop_back();
+
+            if (_idx[pos] != numeric_limits<size_t>::max())
+            {
+                out.insert(out.end(), end - begin, _items[_idx[pos]]);
+                continue;
+            }
+
+            size_t l = get_left(pos);
+            double a = _tree[l];
+            size_t mid = std::lower_bound(us.begin() + begin,
+                                          us.begin() + end, a + c)
+                - us.begin();
+            if (mid < end)
+                stack.emplace_back(get_right(pos), mid, end, c + a);
+            if (begin < mid)
+                stack.emplace_back(l, begin, mid, c);
+        }
+    }
+
     size_t insert(const Value& v, double w)
     {
         size_t pos;
@@ -116,6 +160,19 @@ public:
         return _idx[pos];
     }
 
+    // changes the weight of item i to w
+    void update(size_t i, double w)
+    {
+        size_t pos = _ipos[i];
+        double delta = w - _tree[pos];
+        _tree[pos] = w;
+        while (pos > 0)
+        {
+            pos = get_parent(pos);
+            _tree[pos] += delta;
+        }
+    }
+
     void remove(size_t i)
     {
         size_t pos = _ipos[i];
@@ -129,13 +186,46 @@ public:
     void clear()
     {
         _items.clear();
+        _ipos.clear();
         _tree.clear();
         _idx.clear();
         _back = 0;
         _free.clear();
+        _valid.clear();
         _n_items = 0;
     }
 
+    // Replaces the contents with the given items, in time O(N). The items are
+    // put in the leaves in order, which occupy the positions [N - 1, 2N - 1),
+    // like after N insertions, and the sums are computed bottom up.
+    void build(const vector<Value>& items, const vector<double>& probs)
+    {
+        clear();
+
+        size_t N = items.size();
+        if (N == 0)
+            return;
+
+        _items = items;
+        _valid.resize(N, true);
+        _ipos.resize(N);
+        check_size(2 * N - 1);
+        for (size_t i = 0; i < N; ++i)
+        {
+            size_t pos = N - 1 + i;
+            _idx[pos] = i;
+            _ipos[i] = pos;
+            _tree[pos] = probs[i];
+        }
+        for (size_t pos = N - 1; pos > 0; --pos)
+        {
+            size_t i = pos - 1;
+            _tree[i] = _tree[get_left(i)] + _tree[get_right(i)];
+        }
+        _back = 2 * N - 1;
+        _n_items = N;
+    }
+
     void rebuild()
     {
         vector<Value> items;
@@ -145,14 +235,13 @@ public:
         {
             if (_idx[i] == numeric_limits<size_t>::max())
                 continue;
+            if (!_valid[_idx[i]])
+                continue;
             items.push_back(_items[_idx[i]]);
             probs.push_back(_tree[i]);
         }
 
-        clear();
-
-        for (size_t i = 0; i < items.size(); ++i)
-            insert(items[i], probs[i]);
+        build(items, probs);
     }
 
     const Value& operator[](size_t i) const
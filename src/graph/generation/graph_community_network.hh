@@ -19,6 +19,7 @@
 #define GRAPH_COMMUNITY_NETWORK_HH
 
 #include "hash_map_wrap.hh"
+#include "graph_util.hh"
 
 #include <iostream>
 #include <iomanip>
@@ -31,6 +32,156 @@ using namespace boost;
 
 // retrieves the network of communities given a community structure
 
+// Runs f(v) for every vertex (or edge) in parallel, unless the values involved
+// are python objects, which are not thread-safe.
+template <class Value, class Graph, class F>
+void community_vertex_loop(const Graph& g, F&& f)
+{
+    if (std::is_same<Value, boost::python::object>::value)
+    {
+        for (auto v : vertices_range(g))
+            f(v);
+    }
+    else
+    {
+        parallel_vertex_loop(g, f);
+    }
+}
+
+template <class Value, class Graph, class F>
+void community_edge_loop(const Graph& g, F&& f)
+{
+    if (std::is_same<Value, boost::python::object>::value)
+    {
+        for (auto e : edges_range(g))
+            f(e);
+    }
+    else
+    {
+        parallel_edge_loop(g, f);
+    }
+}
+
+// Returns the vertex of cg of the community of each vertex of g (or zero, if
+// the community is not in cg).
+template <class Graph, class CommunityGraph, class CommunityMap,
+          class CCommunityMap>
+vector<size_t> get_vertex_communities(const Graph& g, const CommunityGraph& cg,
+                                      CommunityMap s_map, CCommunityMap cs_map)
+{
+    typedef typename boost::property_traits<CommunityMap>::value_type s_type;
+
+    unordered_map<s_type, size_t> comms;
+    for (auto v : vertices_range(cg))
+        comms[cs_map[v]] = v;
+
+    vector<size_t> comm(num_vertices(g), 0);
+    community_vertex_loop<s_type>
+        (g,
+         [&](auto v)
+         {
+             auto iter = comms.find(get(s_map, v));
+             if (iter != comms.end())
+                 comm[v] = iter->second;
+         });
+    return comm;
+}
+
+// Lists the edges of g, in order, with the communities of their endpoints,
+// skipping the self-loops between communities if self_loops is false.
+template <class Graph>
+void get_community_edges(const Graph& g, const vector<size_t>& comm,
+                         bool self_loops,
+                         vector<typename graph_traits<Graph>::edge_descriptor>& es,
+                         vector<std::array<size_t, 2>>& ends)
+{
+    for (auto e : edges_range(g))
+    {
+        size_t cs = comm[source(e, g)];
+        size_t ct = comm[target(e, g)];
+        if (cs == ct && !self_loops)
+            continue;
+        es.push_back(e);
+        ends.push_back({cs, ct});
+    }
+}
+
+// Sorts the items [0, M) by their keys key(i) = (a, b), with a < N, and then
+// by i, with a counting sort on a, followed by a sort of each bucket in
+// parallel. The sorted items are put in order, and the start of each run of
+// items with the same key in start, which ends with M.
+template <class Key>
+void sort_by_community_pair(size_t M, size_t N, Key&& key,
+                            vector<size_t>& order, vector<size_t>& start)
+{
+    vector<size_t> pos(N + 1, 0);
+    #pragma omp parallel for schedule(static) if (M > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < M; ++i)
+    {
+        #pragma omp atomic
+        pos[key(i).first + 1]++;
+    }
+    std::partial_sum(pos.begin(), pos.end(), pos.begin());
+
+    order.resize(M);
+    vector<size_t> cursor(pos.begin(), pos.end() - 1);
+    #pragma omp parallel for schedule(static) if (M > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < M; ++i)
+    {
+        size_t p;
+        #pragma omp atomic capture
+        p = cursor[key(i).first]++;
+        order[p] = i;
+    }
+
+    auto new_run = [&](size_t a, size_t p)
+        {
+            return (p == pos[a] ||
+                    key(order[p]).second != key(order[p - 1]).second);
+        };
+
+    vector<size_t> nruns(N + 1, 0);
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+    for (size_t a = 0; a < N; ++a)
+    {
+        std::sort(order.begin() + pos[a], order.begin() + pos[a + 1],
+                  [&](size_t i, size_t j)
+                  {
+                      return (std::make_pair(key(i).second, i) <
+                              std::make_pair(key(j).second, j));
+                  });
+        for (size_t p = pos[a]; p < pos[a + 1]; ++p)
+        {
+            if (new_run(a, p))
+                nruns[a + 1]++;
+        }
+    }
+    std::partial_sum(nruns.begin(), nruns.end(), nruns.begin());
+
+    start.resize(nruns[N] + 1);
+    start[nruns[N]] = M;
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+    for (size_t a = 0; a < N; ++a)
+    {
+        size_t r = nruns[a];
+        for (size_t p = pos[a]; p < pos[a + 1]; ++p)
+        {
+            if (new_run(a, p))
+                start[r++] = p;
+        }
+    }
+}
+
+// The key of an edge between communities, which ignores the direction for
+// undirected graphs.
+inline std::pair<size_t, size_t>
+community_edge_key(const std::array<size_t, 2>& ends, bool directed)
+{
+    if (directed || ends[0] <= ends[1])
+        return {ends[0], ends[1]};
+    return {ends[1], ends[0]};
+}
+
 struct get_community_network_vertices
 {
     template <class Graph, class CommunityGraph, class CommunityMap,
@@ -89,6 +240,10 @@ struct get_community_network_vertices
 
 };
 
+// The edges of g are grouped by the pair of communities of their endpoints,
+// and the condensed edges are created in the order of the first edge of each
+// group, and inserted in bulk. The counts are then summed in parallel for each
+// group, in the order of the edges.
 struct get_community_network_edges
 {
     template <class Graph, class CommunityGraph, class CommunityMap,
@@ -99,73 +254,87 @@ struct get_community_network_edges
                     EdgeWeightMap eweight, EdgeProperty edge_count,
                     bool self_loops, bool parallel_edges) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-        typedef typename graph_traits<CommunityGraph>::vertex_descriptor
-            cvertex_t;
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
         typedef typename graph_traits<CommunityGraph>::edge_descriptor
             cedge_t;
-        typedef typename boost::property_traits<CommunityMap>::value_type
-            s_type;
-
-        typedef unordered_map<s_type, vertex_t> comms_t;
-        comms_t comms;
-        typedef unordered_map<cvertex_t, cedge_t> ecomms_t;
 
-        auto index_map = get(vertex_index_t(), cg);
-        unchecked_vector_property_map<ecomms_t, decltype(index_map)>
-            comm_edges(index_map, num_vertices(cg));
+        auto comm = get_vertex_communities(g, cg, s_map, cs_map);
 
-        for (auto v : vertices_range(cg))
-            comms[cs_map[v]] = v;
+        vector<edge_t> es;
+        vector<std::array<size_t, 2>> ends;
+        get_community_edges(g, comm, self_loops, es, ends);
+        size_t M = es.size();
 
-        // create edges
-        for (auto e : edges_range(g))
+        // groups of edges, as ranges of order given by start
+        vector<size_t> order, start;
+        if (parallel_edges)
         {
-            cvertex_t cs = comms[get(s_map, source(e, g))];
-            cvertex_t ct = comms[get(s_map, target(e, g))];
-            if (ct == cs && !self_loops)
-                continue;
-            cedge_t ce;
+            order.resize(M);
+            start.resize(M + 1);
+            std::iota(order.begin(), order.end(), 0);
+            std::iota(start.begin(), start.end(), 0);
+        }
+        else
+        {
+            bool directed = graph_tool::is_directed(g);
+            sort_by_community_pair(M, num_vertices(cg),
+                                   [&](size_t i)
+                                   {
+                                       return community_edge_key(ends[i],
+                                                                 directed);
+                                   },
+                                   order, start);
+        }
 
-            if (parallel_edges)
-            {
-                ce = add_edge(cs, ct, cg).first;
-            }
-            else
+        // rank of the groups by their first edges
+        size_t R = start.size() - 1;
+        vector<size_t> rank(R);
+        if (parallel_edges)
+        {
+            std::iota(rank.begin(), rank.end(), 0);
+        }
+        else
+        {
+            vector<size_t> first(M, R);
+            #pragma omp parallel for schedule(static) if (R > OPENMP_MIN_THRESH)
+            for (size_t r = 0; r < R; ++r)
+                first[order[start[r]]] = r;
+            size_t k = 0;
+            for (size_t i = 0; i < M; ++i)
             {
-                auto iter = comm_edges[cs].find(ct);
-                if (iter != comm_edges[cs].end())
-                {
-                    ce = iter->second;
-                }
-                else
-                {
-                    if (!graph_tool::is_directed(g))
-                    {
-                        iter = comm_edges[ct].find(cs);
-                        if (iter != comm_edges[ct].end())
-                        {
-                            ce = iter->second;
-                        }
-                        else
-                        {
-                            ce = add_edge(cs, ct, cg).first;
-                            comm_edges[cs][ct] = ce;
-                        }
-                    }
-                    else
-                    {
-                        ce = add_edge(cs, ct, cg).first;
-                        comm_edges[cs][ct] = ce;
-                    }
-                }
+                if (first[i] < R)
+                    rank[first[i]] = k++;
             }
-            put(edge_count, ce, get(edge_count, ce) + get(eweight, e));
+        }
+
+        vector<std::array<size_t, 2>> cedges(R);
+        #pragma omp parallel for schedule(static) if (R > OPENMP_MIN_THRESH)
+        for (size_t r = 0; r < R; ++r)
+            cedges[rank[r]] = ends[order[start[r]]];
+
+        vector<cedge_t> ces(R);
+        auto cindex = get(edge_index_t(), cg);
+        size_t max_idx = 0;
+        add_edges(cedges, cg,
+                  [&](size_t i, const auto& ce)
+                  {
+                      ces[i] = ce;
+                      max_idx = std::max(max_idx, size_t(get(cindex, ce)) + 1);
+                  });
+
+        edge_count.reserve(max_idx);
+        auto count = edge_count.get_unchecked();
+
+        #pragma omp parallel for schedule(runtime) if (R > OPENMP_MIN_THRESH)
+        for (size_t r = 0; r < R; ++r)
+        {
+            auto& ce = ces[rank[r]];
+            for (size_t p = start[r]; p < start[r + 1]; ++p)
+                put(count, ce, get(count, ce) + get(eweight, es[order[p]]));
         }
     }
 };
 
-
 template <class T1, class T2>
 inline vector<T1> operator*(const vector<T1>& v, const T2& c)
 {
@@ -197,7 +366,6 @@ inline void operator/=(vector<T1>& v1, const vector<T2>& v2)
     v1.resize(max(v1.size(), v2.size()));
     for (size_t i = 0; i < v2.size(); ++i)
         v1[i] /= v2[i];
-    return v1;
 }
 
 template <class T1, class T2>
@@ -217,12 +385,18 @@ struct get_weighted_vertex_property
     void operator()(const Graph& g, VertexWeightMap vweight, Vprop vprop,
                     Vprop temp) const
     {
-        for (auto vi : vertices_range(g))
-            temp[vi] = vprop[vi] * get(vweight, vi);
+        typedef typename property_traits<Vprop>::value_type val_t;
+        community_vertex_loop<val_t>
+            (g,
+             [&](auto vi)
+             {
+                 temp[vi] = vprop[vi] * get(vweight, vi);
+             });
     }
 };
 
-
+// The vertices of g are grouped by community, and the values are summed in
+// parallel for each community, in the order of the vertices.
 struct get_vertex_community_property_sum
 {
     template <class Graph, class CommunityGraph, class CommunityMap,
@@ -231,18 +405,37 @@ struct get_vertex_community_property_sum
                     CCommunityMap cs_map, Vprop vprop, Vprop cvprop) const
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-        typedef typename boost::property_traits<CommunityMap>::value_type
-            s_type;
+        typedef typename property_traits<Vprop>::value_type val_t;
 
-        unordered_map<s_type, vertex_t> comms;
+        auto comm = get_vertex_communities(g, cg, s_map, cs_map);
 
-        for (auto v : vertices_range(cg))
-            comms[cs_map[v]] = v;
+        if (std::is_same<val_t, boost::python::object>::value)
+        {
+            for (auto v : vertices_range(g))
+                cvprop[comm[v]] += vprop[v];
+            return;
+        }
 
+        vector<vertex_t> vs;
         for (auto v : vertices_range(g))
+            vs.push_back(v);
+
+        vector<size_t> order, start;
+        sort_by_community_pair(vs.size(), num_vertices(cg),
+                               [&](size_t i)
+                               {
+                                   return std::make_pair(comm[vs[i]],
+                                                         size_t(0));
+                               },
+                               order, start);
+
+        size_t R = start.size() - 1;
+        #pragma omp parallel for schedule(runtime) if (R > OPENMP_MIN_THRESH)
+        for (size_t r = 0; r < R; ++r)
         {
-            s_type s = get(s_map, v);
-            cvprop[comms[s]] += vprop[v];
+            auto& x = cvprop[comm[vs[order[start[r]]]]];
+            for (size_t p = start[r]; p < start[r + 1]; ++p)
+                x += vprop[vs[order[p]]];
         }
     }
 };
@@ -253,11 +446,23 @@ struct get_weighted_edge_property
     void operator()(const Graph& g, EdgeWeightMap eweight, Eprop eprop,
                     Eprop temp) const
     {
-        for (auto e : edges_range(g))
-            temp[e] = eprop[e] * get(eweight, e);
+        typedef typename property_traits<Eprop>::value_type val_t;
+        community_edge_loop<val_t>
+            (g,
+             [&](const auto& e)
+             {
+                 temp[e] = eprop[e] * get(eweight, e);
+             });
     }
 };
 
+// The edges of g and of cg are both grouped by the pair of communities of
+// their endpoints (in the order of g, and in the order of the edge indexes of
+// cg, respectively), and each group of g is matched with the corresponding
+// group of cg by binary search. The values of a group are summed to the last
+// condensed edge of its group, or, if parallel edges are kept, the i-th edge
+// of the group of g is summed to the i-th condensed edge, i.e. the one created
+// from it.
 struct get_edge_community_property_sum
 {
     template <class Graph, class CommunityGraph, class CommunityMap,
@@ -266,48 +471,101 @@ struct get_edge_community_property_sum
                     CCommunityMap cs_map, Eprop eprop, CEprop ceprop,
                     bool self_loops, bool parallel_edges) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-        typedef typename graph_traits<CommunityGraph>::vertex_descriptor
-            cvertex_t;
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
         typedef typename graph_traits<CommunityGraph>::edge_descriptor
             cedge_t;
-        typedef typename boost::property_traits<CommunityMap>::value_type
-            s_type;
+        typedef typename property_traits<Eprop>::value_type val_t;
 
-        unordered_map<s_type, vertex_t> comms;
+        bool directed = graph_tool::is_directed(g);
+        size_t NC = num_vertices(cg);
 
-        for (auto v : vertices_range(cg))
-            comms[cs_map[v]] = v;
+        auto comm = get_vertex_communities(g, cg, s_map, cs_map);
 
-        gt_hash_map<pair<size_t, size_t>, vector<cedge_t>> comm_edges;
+        vector<edge_t> es;
+        vector<std::array<size_t, 2>> ends;
+        get_community_edges(g, comm, self_loops, es, ends);
 
+        // condensed edges in index order
+        auto cindex = get(edge_index_t(), cg);
+        size_t max_idx = 0;
+        for (auto e : edges_range(cg))
+            max_idx = std::max(max_idx, size_t(get(cindex, e)) + 1);
+        vector<cedge_t> cidx(max_idx);
+        vector<uint8_t> present(max_idx, false);
         for (auto e : edges_range(cg))
         {
-            cvertex_t cs = comms[get(cs_map, source(e, cg))];
-            cvertex_t ct = comms[get(cs_map, target(e, cg))];
-            comm_edges[make_pair(cs, ct)].push_back(e);
+            cidx[get(cindex, e)] = e;
+            present[get(cindex, e)] = true;
         }
-
-        for (auto e : edges_range(g))
+        vector<cedge_t> ces;
+        vector<std::array<size_t, 2>> cends;
+        for (size_t i = 0; i < max_idx; ++i)
         {
-            cvertex_t cs = comms[get(s_map, source(e, g))];
-            cvertex_t ct = comms[get(s_map, target(e, g))];
-            if (cs == ct && !self_loops)
-                continue;  // self-loops not allowed
-
-            auto* ces = &comm_edges[make_pair(cs, ct)];
-            if (ces->empty() && !graph_tool::is_directed(g))
-                ces = &comm_edges[make_pair(ct, cs)];
-            if (ces->empty())
+            if (!present[i])
+                continue;
+            auto& e = cidx[i];
+            ces.push_back(e);
+            cends.push_back({size_t(source(e, cg)), size_t(target(e, cg))});
+        }
+
+        vector<size_t> order, start, corder, cstart;
+        auto key = [&](size_t i) { return community_edge_key(ends[i], directed); };
+        auto ckey = [&](size_t i) { return community_edge_key(cends[i], directed); };
+        sort_by_community_pair(es.size(), NC, key, order, start);
+        sort_by_community_pair(ces.size(), NC, ckey, corder, cstart);
+
+        size_t R = start.size() - 1;
+        size_t CR = cstart.size() - 1;
+        auto sum = [&](size_t r, bool& missing)
             {
-                throw GraphException("Bug: condensed edge not found! " +
-                                     lexical_cast<string>(cs) +  " " +
-                                     lexical_cast<string>(ct));
-            }
-            ceprop[ces->back()] += eprop[e];
-            if (parallel_edges)
-                ces->pop_back();
+                auto k = key(order[start[r]]);
+                size_t lo = 0, hi = CR;
+                while (lo < hi)
+                {
+                    size_t mid = (lo + hi) / 2;
+                    if (ckey(corder[cstart[mid]]) < k)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                if (lo == CR || ckey(corder[cstart[lo]]) != k)
+                {
+                    missing = true;
+                    return;
+                }
+                size_t n = cstart[lo + 1] - cstart[lo];
+                for (size_t p = start[r]; p < start[r + 1]; ++p)
+                {
+                    size_t j = n - 1;
+                    if (parallel_edges)
+                    {
+                        j = p - start[r];
+                        if (j >= n)
+                        {
+                            missing = true;
+                            return;
+                        }
+                    }
+                    ceprop[ces[corder[cstart[lo] + j]]] += eprop[es[order[p]]];
+                }
+            };
+
+        bool missing = false;
+        if (std::is_same<val_t, boost::python::object>::value)
+        {
+            for (size_t r = 0; r < R && !missing; ++r)
+                sum(r, missing);
         }
+        else
+        {
+            #pragma omp parallel for schedule(runtime) \
+                if (R > OPENMP_MIN_THRESH) reduction(||:missing)
+            for (size_t r = 0; r < R; ++r)
+                sum(r, missing);
+        }
+
+        if (missing)
+            throw GraphException("Bug: condensed edge not found!");
     }
 };
 
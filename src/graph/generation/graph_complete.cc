@@ -19,6 +19,7 @@
 #include "graph_filtering.hh"
 
 #include "graph_complete.hh"
+#include "graph_edge_stream.hh"
 
 #include <boost/python.hpp>
 
@@ -37,3 +38,21 @@ void circular(GraphInterface& gi, size_t N, size_t k, bool directed,
 {
     get_circular()(gi.get_graph(), N, k, directed, self_loops);
 }
+
+boost::python::tuple stream_complete(string file, size_t width, size_t N,
+                                     bool directed, bool self_loops)
+{
+    edge_stream es(file, width);
+    get_complete()(es, N, directed, self_loops);
+    es.close();
+    return boost::python::make_tuple(es.num_vertices(), es.num_edges());
+}
+
+boost::python::tuple stream_circular(string file, size_t width, size_t N,
+                                     size_t k, bool directed, bool self_loops)
+{
+    edge_stream es(file, width);
+    get_circular()(es, N, k, directed, self_loops);
+    es.close();
+    return boost::python::make_tuple(es.num_vertices(), es.num_edges());
+}
@@ -0,0 +1,224 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_EDGE_STREAM_HH
+#define GRAPH_EDGE_STREAM_HH
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#ifdef HAVE_BOOST_IOSTREAMS_ZSTD
+#include <boost/iostreams/filter/zstd.hpp>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Writes the edges of a generated graph directly to a file, without storing
+// the graph, in one of the formats read by load_graph_from_edge_list(): lines
+// with the source and target separated by a space (width == 0), or pairs of
+// native integers of 4 or 8 bytes. The file is compressed according to its
+// extension (".gz", ".bz2" or ".zst").
+//
+// Each thread appends the edges to its own buffer, which is encoded and written
+// once it reaches the chunk size, so the memory used does not depend on the
+// number of edges. The order of the edges in the file is that of the sequence
+// of each thread, interleaved chunk by chunk.
+//
+// An edge_stream can also be used as the graph of the generators which only
+// call add_vertex(g), vertex(i, g) and add_edge(u, v, g).
+class edge_stream
+{
+public:
+    edge_stream(const string& file, size_t width, size_t chunk = 1 << 20)
+        : _file(file), _width(width), _chunk(chunk)
+    {
+        if (width != 0 && width != 4 && width != 8)
+            throw ValueException("invalid binary width: " +
+                                 std::to_string(width));
+        try
+        {
+            _file_stream.open(file.c_str(), std::ios_base::out |
+                              std::ios_base::binary);
+            _file_stream.exceptions(ios_base::badbit | ios_base::failbit);
+            if (boost::ends_with(file, ".gz"))
+                _stream.push(boost::iostreams::gzip_compressor());
+            if (boost::ends_with(file, ".bz2"))
+                _stream.push(boost::iostreams::bzip2_compressor());
+            if (boost::ends_with(file, ".zst"))
+            {
+#ifdef HAVE_BOOST_IOSTREAMS_ZSTD
+                _stream.push(boost::iostreams::zstd_compressor());
+#else
+                throw IOException("error writing to file '" + file +
+                                  "': zstd compression is not supported");
+#endif
+            }
+            _stream.push(_file_stream);
+            _stream.exceptions(ios_base::badbit | ios_base::failbit);
+        }
+        catch (ios_base::failure& e)
+        {
+            throw IOException("error writing to file '" + file + "': " +
+                              e.what());
+        }
+
+        size_t nt = 1;
+#ifdef _OPENMP
+        nt = omp_get_max_threads();
+#endif
+        _bufs.resize(nt);
+    }
+
+    size_t add_vertex() { return _N++; }
+
+    // may be called concurrently from different threads
+    void add_edge(size_t s, size_t t)
+    {
+        size_t tid = 0;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+#endif
+        auto& buf = _bufs[tid];
+        buf.push_back({s, t});
+        if (buf.size() >= _chunk)
+            flush(buf);
+    }
+
+    // writes out the remaining edges; must be called outside of a parallel
+    // region, and throws if any of the writes have failed
+    void close()
+    {
+        for (auto& buf : _bufs)
+            flush(buf);
+        if (_failed)
+            throw IOException("error writing to file '" + _file + "'");
+        try
+        {
+            _stream.reset();
+            _file_stream.close();
+        }
+        catch (ios_base::failure& e)
+        {
+            throw IOException("error writing to file '" + _file + "': " +
+                              e.what());
+        }
+    }
+
+    size_t num_vertices() const { return _N; }
+    size_t num_edges() const { return _E; }
+
+private:
+    void flush(vector<std::array<size_t, 2>>& buf)
+    {
+        if (buf.empty())
+            return;
+
+        string out;
+        switch (_width)
+        {
+        case 0:
+            for (auto& e : buf)
+            {
+                out += std::to_string(e[0]);
+                out += ' ';
+                out += std::to_string(e[1]);
+                out += '\n';
+            }
+            break;
+        case 4:
+            encode<uint32_t>(buf, out);
+            break;
+        case 8:
+            encode<uint64_t>(buf, out);
+        }
+
+        // exceptions cannot escape a parallel region, so a failed write is
+        // only recorded, and reported by close()
+        #pragma omp critical (edge_stream)
+        {
+            if (!_failed)
+            {
+                try
+                {
+                    _stream.write(out.data(), out.size());
+                }
+                catch (ios_base::failure&)
+                {
+                    _failed = true;
+                }
+            }
+            _E += buf.size();
+        }
+        buf.clear();
+    }
+
+    template <class Val>
+    void encode(const vector<std::array<size_t, 2>>& buf, string& out)
+    {
+        out.resize(buf.size() * 2 * sizeof(Val));
+        Val* pos = reinterpret_cast<Val*>(&out[0]);
+        for (auto& e : buf)
+        {
+            *pos++ = e[0];
+            *pos++ = e[1];
+        }
+    }
+
+    string _file;
+    size_t _width;
+    size_t _chunk;
+    std::ofstream _file_stream;
+    boost::iostreams::filtering_stream<boost::iostreams::output> _stream;
+    vector<vector<std::array<size_t, 2>>> _bufs;
+    size_t _N = 0;
+    size_t _E = 0;
+    bool _failed = false;
+};
+
+inline size_t add_vertex(edge_stream& g)
+{
+    return g.add_vertex();
+}
+
+inline size_t vertex(size_t i, const edge_stream&)
+{
+    return i;
+}
+
+inline void add_edge(size_t s, size_t t, edge_stream& g)
+{
+    g.add_edge(s, t);
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_EDGE_STREAM_HH
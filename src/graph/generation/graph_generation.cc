@@ -23,6 +23,7 @@
 #include "graph_generation.hh"
 #include "sampler.hh"
 #include "dynamic_sampler.hh"
+#include "numpy_bind.hh"
 #include <boost/python.hpp>
 
 using namespace std;
@@ -53,7 +54,7 @@ private:
 void generate_graph(GraphInterface& gi, size_t N,
                     boost::python::object deg_sample, bool no_parallel,
                     bool no_self_loops, bool undirected, rng_t& rng,
-                    bool verbose, bool verify)
+                    bool verbose, bool verify, bool parallel)
 {
     typedef graph_tool::detail::get_all_graph_views::apply<
     graph_tool::detail::filt_scalar_type, boost::mpl::bool_<false>,
@@ -63,24 +64,37 @@ void generate_graph(GraphInterface& gi, size_t N,
     if (undirected)
         gi.set_directed(false);
 
-    run_action<graph_views>()
-        (gi, std::bind(gen_graph(), std::placeholders::_1, N,
-                       PythonFuncWrap(deg_sample),
-                       no_parallel, no_self_loops,
-                       std::ref(rng), verbose, verify))();
+    if (parallel)
+        run_action<graph_views>()
+            (gi, std::bind(gen_graph_parallel(), std::placeholders::_1, N,
+                           PythonFuncWrap(deg_sample),
+                           no_parallel, no_self_loops,
+                           std::ref(rng), verbose, verify))();
+    else
+        run_action<graph_views>()
+            (gi, std::bind(gen_graph(), std::placeholders::_1, N,
+                           PythonFuncWrap(deg_sample),
+                           no_parallel, no_self_loops,
+                           std::ref(rng), verbose, verify))();
 }
 
 void generate_sbm(GraphInterface& gi, boost::any ab, boost::python::object ors,
                   boost::python::object oss, boost::python::object oprobs,
                   boost::any ain_deg, boost::any aout_deg, bool micro_ers,
-                  bool micro_degs, rng_t& rng);
+                  bool micro_degs, bool parallel, rng_t& rng);
+boost::python::tuple stream_sbm(GraphInterface& gi, string file, size_t width,
+                                boost::any ab, boost::python::object ors,
+                                boost::python::object oss,
+                                boost::python::object oprobs,
+                                boost::any ain_deg, boost::any aout_deg,
+                                bool micro_ers, rng_t& rng);
 
 size_t random_rewire(GraphInterface& gi, string strat, size_t niter,
                      bool no_sweep, bool self_loops, bool parallel_edges,
                      bool configuration, bool traditional, bool micro,
                      bool persist, boost::python::object corr_prob,
                      boost::any apin, boost::any block, bool cache, rng_t& rng,
-                     bool verbose);
+                     bool verbose, bool parallel);
 void predecessor_graph(GraphInterface& gi, GraphInterface& gpi,
                        boost::any pred_map);
 void line_graph(GraphInterface& gi, GraphInterface& lgi,
@@ -96,13 +110,20 @@ void edge_property_union(GraphInterface& ugi, GraphInterface& gi,
 void triangulation(GraphInterface& gi, boost::python::object points,
                    boost::any pos, string type, bool periodic);
 void lattice(GraphInterface& gi, boost::python::object oshape, bool periodic);
+boost::python::tuple stream_lattice(string file, size_t width,
+                                    boost::python::object oshape,
+                                    bool periodic);
 void geometric(GraphInterface& gi, boost::python::object opoints, double r,
                boost::python::object orange, bool periodic, boost::any pos);
 void price(GraphInterface& gi, size_t N, double gamma, double c, size_t m,
-           rng_t& rng);
+           bool fast, rng_t& rng);
 void complete(GraphInterface& gi, size_t N, bool directed, bool self_loops);
 void circular(GraphInterface& gi, size_t N, size_t k, bool directed,
               bool self_loops);
+boost::python::tuple stream_complete(string file, size_t width, size_t N,
+                                     bool directed, bool self_loops);
+boost::python::tuple stream_circular(string file, size_t width, size_t N,
+                                     size_t k, bool directed, bool self_loops);
 
 void community_network(GraphInterface& gi, GraphInterface& cgi,
                        boost::any community_property,
@@ -122,12 +143,22 @@ void community_network_eavg(GraphInterface& gi, GraphInterface& cgi,
                             boost::any eweight, boost::python::list aeprops,
                             bool self_loops, bool parallel_edges);
 
+template <class Value>
+boost::python::object dynamic_sampler_sample_n(DynamicSampler<Value>& sampler,
+                                               size_t n, rng_t& rng)
+{
+    vector<Value> out;
+    sampler.sample_n(rng, n, out);
+    return wrap_vector_owned(out);
+}
+
 using namespace boost::python;
 
 BOOST_PYTHON_MODULE(libgraph_tool_generation)
 {
     def("gen_graph", &generate_graph);
     def("gen_sbm", &generate_sbm);
+    def("stream_sbm", &stream_sbm);
     def("random_rewire", &random_rewire);
     def("predecessor_graph", &predecessor_graph);
     def("line_graph", &line_graph);
@@ -136,10 +167,13 @@ BOOST_PYTHON_MODULE(libgraph_tool_generation)
     def("edge_property_union", &edge_property_union);
     def("triangulation", &triangulation);
     def("lattice", &lattice);
+    def("stream_lattice", &stream_lattice);
     def("geometric", &geometric);
     def("price", &price);
     def("complete", &complete);
     def("circular", &circular);
+    def("stream_complete", &stream_complete);
+    def("stream_circular", &stream_circular);
     def("community_network", &community_network);
     def("community_network_vavg", &community_network_vavg);
     def("community_network_eavg", &community_network_eavg);
@@ -154,7 +188,9 @@ BOOST_PYTHON_MODULE(libgraph_tool_generation)
                                      const vector<double>&>())
         .def("sample", &DynamicSampler<int>::sample<rng_t>,
              return_value_policy<copy_const_reference>())
+        .def("sample_n", &dynamic_sampler_sample_n<int>)
         .def("insert", &DynamicSampler<int>::insert)
+        .def("update", &DynamicSampler<int>::update)
         .def("remove", &DynamicSampler<int>::remove)
         .def("clear", &DynamicSampler<int>::clear)
         .def("rebuild", &DynamicSampler<int>::rebuild);
@@ -27,6 +27,7 @@
 #include "graph_util.hh"
 #include "random.hh"
 #include "hash_map_wrap.hh"
+#include "../inference/support/parallel_rng.hh"
 
 namespace graph_tool
 {
@@ -644,6 +645,294 @@ struct gen_graph
     }
 };
 
+//
+// Parallel generation
+// ===================
+//
+// The graph is obtained by shuffling the list of stubs (half-edges) and pairing
+// them in sequence, i.e. it is a sample of the configuration model, with the
+// same degree sequence as above. If self-loops or parallel edges are not
+// allowed, the offending edges are then repeatedly swapped with randomly
+// chosen edges, until none remain, and all edges are finally inserted in bulk.
+
+// Uniform shuffle of x, done in parallel by sending each element to a random
+// bucket, with the buckets placed in sequence and then shuffled individually,
+// each by a single thread. The result is deterministic for a given seed and
+// number of threads.
+template <class Vec, class RNG>
+void parallel_shuffle(Vec& x, vector<std::shared_ptr<RNG>>& rngs, RNG& rng)
+{
+    size_t n = x.size();
+    size_t T = rngs.size();
+    if (T < 2 || n <= OPENMP_MIN_THRESH)
+    {
+        std::shuffle(x.begin(), x.end(), rng);
+        return;
+    }
+
+    size_t K = 4 * T;
+    vector<uint32_t> bucket(n);
+    vector<size_t> pos(K * T + 1, 0), bstart(K + 1);
+    Vec y(n);
+
+    #pragma omp parallel num_threads(T)
+    {
+        size_t t = 0, nt = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        auto& r = *rngs[t];
+        size_t begin = (t * n) / nt, end = ((t + 1) * n) / nt;
+
+        std::uniform_int_distribution<uint32_t> sample(0, K - 1);
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto b = sample(r);
+            bucket[i] = b;
+            pos[b * T + t + 1]++;
+        }
+
+        #pragma omp barrier
+        #pragma omp single
+        {
+            std::partial_sum(pos.begin(), pos.end(), pos.begin());
+            for (size_t k = 0; k <= K; ++k)
+                bstart[k] = pos[k * T];
+        }
+
+        for (size_t i = begin; i < end; ++i)
+            y[pos[bucket[i] * T + t]++] = x[i];
+
+        // the static schedule assigns the buckets to the threads, and hence to
+        // their RNGs, in the same way in every run
+        #pragma omp barrier
+        #pragma omp for schedule(static)
+        for (size_t k = 0; k < K; ++k)
+            std::shuffle(y.begin() + bstart[k], y.begin() + bstart[k + 1], r);
+    }
+
+    x.swap(y);
+}
+
+// Puts in bad the (sorted) indexes of the edges which are self-loops, if
+// self_loops is false, or which are parallel to an edge of smaller index, if
+// parallel_edges is false. The edges are grouped by their source (or smallest
+// endpoint, if undirected), and sorted within each group.
+template <class EdgeList>
+void find_bad_edges(const EdgeList& edges, size_t N, bool directed,
+                    bool self_loops, bool parallel_edges, vector<size_t>& bad)
+{
+    size_t E = edges.size();
+    bad.clear();
+
+    auto key = [&](size_t i)
+        {
+            auto s = edges[i][0], t = edges[i][1];
+            return directed ? s : std::min(s, t);
+        };
+    auto other = [&](size_t i)
+        {
+            auto s = edges[i][0], t = edges[i][1];
+            return directed ? t : std::max(s, t);
+        };
+
+    if (parallel_edges)
+    {
+        if (self_loops)
+            return;
+        #pragma omp parallel if (E > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> tbad;
+            #pragma omp for schedule(static) nowait
+            for (size_t i = 0; i < E; ++i)
+            {
+                if (edges[i][0] == edges[i][1])
+                    tbad.push_back(i);
+            }
+            #pragma omp critical (find_bad_edges)
+            bad.insert(bad.end(), tbad.begin(), tbad.end());
+        }
+        std::sort(bad.begin(), bad.end());
+        return;
+    }
+
+    vector<size_t> pos(N + 1, 0);
+    #pragma omp parallel for schedule(static) if (E > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < E; ++i)
+    {
+        #pragma omp atomic
+        pos[key(i) + 1]++;
+    }
+    std::partial_sum(pos.begin(), pos.end(), pos.begin());
+
+    vector<size_t> es(E), cursor(pos.begin(), pos.end() - 1);
+    #pragma omp parallel for schedule(static) if (E > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < E; ++i)
+    {
+        size_t p;
+        #pragma omp atomic capture
+        p = cursor[key(i)]++;
+        es[p] = i;
+    }
+
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        vector<size_t> tbad;
+        #pragma omp for schedule(runtime) nowait
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto begin = es.begin() + pos[v], end = es.begin() + pos[v + 1];
+            std::sort(begin, end,
+                      [&](size_t i, size_t j)
+                      {
+                          return std::make_pair(other(i), i) <
+                              std::make_pair(other(j), j);
+                      });
+            for (auto iter = begin; iter != end; ++iter)
+            {
+                size_t i = *iter;
+                if ((!self_loops && edges[i][0] == edges[i][1]) ||
+                    (iter != begin && other(*(iter - 1)) == other(i)))
+                    tbad.push_back(i);
+            }
+        }
+        #pragma omp critical (find_bad_edges)
+        bad.insert(bad.end(), tbad.begin(), tbad.end());
+    }
+    std::sort(bad.begin(), bad.end());
+}
+
+struct gen_graph_parallel
+{
+    template <class Graph, class DegSample>
+    void operator()(Graph& g, size_t N, DegSample& deg_sample, bool no_parallel,
+                    bool no_self_loops, rng_t& rng, bool verbose, bool verify)
+        const
+    {
+        typename property_map<Graph,vertex_index_t>::type vertex_index =
+            get(vertex_index_t(), g);
+
+        typedef typename mpl::if_<typename is_directed::apply<Graph>::type,
+                                  DirectedStrat,
+                                  UndirectedStrat>::type gen_strat_t;
+
+        gen_strat_t gen_strat(N, no_parallel, no_self_loops);
+
+        if (verbose)
+            cout << "adding vertices: " << flush;
+
+        vector<dvertex_t> vertices(N);
+        for(size_t i = 0; i < N; ++i)
+            vertices[i].index = vertex_index[add_vertex(g)];
+
+        // the degrees are sampled sequentially, since the sampler may be a
+        // python function
+        size_t E = gen_strat.SampleDegrees(vertices, deg_sample, rng, verbose);
+
+        if (verbose)
+            cout << endl << "pairing stubs..." << endl;
+
+        vector<std::shared_ptr<rng_t>> rngs;
+        init_rngs(rngs, rng);
+
+        bool directed = graph_tool::is_directed(g);
+
+        // stubs are laid out in vertex order: in the directed case, the
+        // out-stubs are the sources and the shuffled in-stubs the targets,
+        // and in the undirected case consecutive stubs are paired
+        auto get_stubs = [&](auto&& deg, vector<size_t>& stubs)
+            {
+                vector<size_t> pos(N + 1, 0);
+                for (size_t i = 0; i < N; ++i)
+                    pos[i + 1] = pos[i] + deg(vertices[i]);
+                stubs.resize(pos[N]);
+                #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+                for (size_t i = 0; i < N; ++i)
+                    std::fill(stubs.begin() + pos[i], stubs.begin() + pos[i + 1],
+                              vertices[i].index);
+            };
+
+        vector<std::array<size_t, 2>> edges(E);
+        vector<size_t> stubs;
+        if (directed)
+        {
+            get_stubs([](auto& v) { return v.in_degree; }, stubs);
+            parallel_shuffle(stubs, rngs, rng);
+            #pragma omp parallel for schedule(static) if (E > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < E; ++i)
+                edges[i][1] = stubs[i];
+            get_stubs([](auto& v) { return v.out_degree; }, stubs);
+            #pragma omp parallel for schedule(static) if (E > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < E; ++i)
+                edges[i][0] = stubs[i];
+        }
+        else
+        {
+            get_stubs([](auto& v) { return v.out_degree; }, stubs);
+            parallel_shuffle(stubs, rngs, rng);
+            #pragma omp parallel for schedule(static) if (E > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < E; ++i)
+                edges[i] = {stubs[2 * i], stubs[2 * i + 1]};
+        }
+        vector<size_t>().swap(stubs);
+
+        if (no_parallel || no_self_loops)
+        {
+            // swap the endpoints of the offending edges with random edges; only
+            // the classes of the stubs change, so the degrees are preserved
+            std::uniform_int_distribution<size_t> sample(0, E - 1);
+            std::bernoulli_distribution coin(.5);
+            vector<size_t> bad;
+            size_t nrounds = 0, max_rounds = 1000;
+            while (true)
+            {
+                find_bad_edges(edges, N, directed, !no_self_loops,
+                               !no_parallel, bad);
+                if (verbose)
+                    cout << "round " << nrounds << ": " << bad.size()
+                         << " rejected edges" << endl;
+                if (bad.empty())
+                    break;
+                if (nrounds++ == max_rounds)
+                    throw GraphException("Unable to remove the self-loops and "
+                                         "parallel edges after " +
+                                         lexical_cast<string>(max_rounds) +
+                                         " rounds. Try the sequential "
+                                         "algorithm instead.");
+                for (auto i : bad)
+                {
+                    size_t j = sample(rng);
+                    if (!directed && coin(rng))
+                        std::swap(edges[i][1], edges[j][0]);
+                    else
+                        std::swap(edges[i][1], edges[j][1]);
+                }
+            }
+        }
+
+        if (verbose)
+            cout << "adding " << E << " edges..." << endl;
+
+        add_edges(edges, g);
+
+        if (verify)
+        {
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                auto v = vertex(vertices[i].index, g);
+                if ((directed && (size_t(in_degreeS()(v, g)) !=
+                                  size_t(vertices[i].in_degree))) ||
+                    out_degree(v, g) != vertices[i].out_degree)
+                    throw GraphException("Graph does not match the desired "
+                                         "sequence! Vertex " +
+                                         lexical_cast<string>(i) +
+                                         " This is a bug.");
+            }
+        }
+    }
+};
+
 } // graph_tool namespace
 
 #endif // GRAPH_GENERATION_HH
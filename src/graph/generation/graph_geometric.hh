@@ -19,153 +19,299 @@
 #define GRAPH_GEOMETRIC_HH
 
 #include <iostream>
-#include <unordered_map>
+#include <array>
 
-#include <boost/functional/hash.hpp>
 #include "graph_util.hh"
 
-#ifndef __clang__
-#include <ext/numeric>
-using __gnu_cxx::power;
-#else
-template <class Value>
-Value power(Value value, int n)
-{
-    return pow(value, n);
-}
-#endif
-
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
-
-template <class Point, class Range>
-void get_box(const Point& p, double w, vector<int>& box,
-             const Range& ranges, bool periodic)
+// Squared distance between points i and j, with periodic boundaries given by
+// the lengths L, if non-empty.
+template <class Points>
+double get_dist2(const Points& x, size_t i, size_t j, const vector<double>& L)
 {
-    if (box.size() != p.size())
-        box.resize(p.size());
-    for (size_t i = 0; i < p.size(); ++i)
+    double r = 0;
+    for (size_t k = 0; k < x.shape()[1]; ++k)
     {
-        box[i] = int(floor(p[i] / w));
-        if (periodic && p[i] == ranges[i].second)
-            box[i] -= 1;
+        double diff = abs(x[i][k] - x[j][k]);
+        if (!L.empty())
+            diff = min(diff, abs(diff - L[k]));
+        r += diff * diff;
     }
+    return r;
 }
 
-template <class Point, class Range>
-double get_dist(const Point& p1, const Point& p2,
-                const Range& ranges, bool periodic)
+// Flat cell list, where the space is divided into cells of width at least r,
+// along at most three dimensions (those with the largest number of cells, so
+// that the number of neighboring cells remains bounded in high dimensions,
+// while the true distance is still used to decide on the edges). The total
+// number of cells is kept below the number of points. The points are sorted by
+// cell with a counting sort, so that the points in cell c are
+// order[pos[c]...pos[c+1]-1], in increasing order.
+struct geometric_cells
 {
-    double r = 0, diff, size;
-    for (size_t i = 0; i < p1.size(); ++i)
+    template <class Points>
+    geometric_cells(const Points& x, const vector<pair<double, double>>& ranges,
+                    double r, bool periodic)
+        : _periodic(periodic)
     {
-        diff = abs(p1[i] - p2[i]);
+        size_t N = x.shape()[0];
+        size_t D = x.shape()[1];
+
+        vector<double> x0(D), x1(D);
         if (periodic)
         {
-            size = abs(ranges[i].second - ranges[i].first);
-            diff = min(diff, abs(diff - size));
+            for (size_t k = 0; k < D; ++k)
+                tie(x0[k], x1[k]) = ranges[k];
+        }
+        else
+        {
+            std::fill(x0.begin(), x0.end(), numeric_limits<double>::infinity());
+            std::fill(x1.begin(), x1.end(), -numeric_limits<double>::infinity());
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+            {
+                vector<double> y0(x0), y1(x1);
+                #pragma omp for schedule(static) nowait
+                for (size_t i = 0; i < N; ++i)
+                {
+                    for (size_t k = 0; k < D; ++k)
+                    {
+                        y0[k] = min(y0[k], x[i][k]);
+                        y1[k] = max(y1[k], x[i][k]);
+                    }
+                }
+                #pragma omp critical (geometric_cells)
+                for (size_t k = 0; k < D; ++k)
+                {
+                    x0[k] = min(x0[k], y0[k]);
+                    x1[k] = max(x1[k], y1[k]);
+                }
+            }
+        }
+
+        vector<size_t> n(D, 1);
+        for (size_t k = 0; k < D && N > 0; ++k)
+        {
+            double c = (x1[k] - x0[k]) / r;
+            if (std::isnan(c) || c >= N)
+                n[k] = N;
+            else
+                n[k] = max(size_t(1), size_t(floor(c)));
+        }
+
+        vector<size_t> dims(D);
+        std::iota(dims.begin(), dims.end(), 0);
+        std::stable_sort(dims.begin(), dims.end(),
+                         [&](size_t i, size_t j) { return n[i] > n[j]; });
+        dims.resize(min(D, size_t(3)));
+
+        auto ncells = [&]()
+            {
+                double c = 1;
+                for (auto k : dims)
+                    c *= n[k];
+                return c;
+            };
+        while (ncells() > max(N, size_t(1)))
+        {
+            auto k = *std::max_element(dims.begin(), dims.end(),
+                                       [&](size_t i, size_t j)
+                                       { return n[i] < n[j]; });
+            n[k] = (n[k] + 1) / 2;
+        }
+
+        _ncells = 1;
+        for (auto k : dims)
+        {
+            _dims.push_back(k);
+            _n.push_back(n[k]);
+            _x0.push_back(x0[k]);
+            _w.push_back((x1[k] - x0[k]) / n[k]);
+            _ncells *= n[k];
+        }
+
+        // counting sort
+        vector<size_t> cell(N);
+        _pos.resize(_ncells + 1, 0);
+        #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            cell[i] = get_cell(x, i);
+            #pragma omp atomic
+            _pos[cell[i] + 1]++;
         }
-        r += pow(diff, 2);
+        std::partial_sum(_pos.begin(), _pos.end(), _pos.begin());
+
+        _order.resize(N);
+        vector<size_t> cursor(_pos.begin(), _pos.end() - 1);
+        #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            size_t p;
+            #pragma omp atomic capture
+            p = cursor[cell[i]]++;
+            _order[p] = i;
+        }
+
+        #pragma omp parallel for schedule(runtime) if (_ncells > OPENMP_MIN_THRESH)
+        for (size_t c = 0; c < _ncells; ++c)
+            std::sort(_order.begin() + _pos[c], _order.begin() + _pos[c + 1]);
     }
-    return sqrt(r);
-}
 
-void periodic(vector<int>& box, const vector<pair<int,int> >& ranges)
-{
-    for (size_t i = 0; i < box.size(); ++i)
+    template <class Points>
+    size_t get_cell(const Points& x, size_t i) const
     {
-        if (box[i] >= ranges[i].second)
-            box[i] = ranges[i].first;
-        if (box[i] < ranges[i].first)
-            box[i] = ranges[i].second - 1;
+        size_t c = 0;
+        for (size_t j = 0; j < _dims.size(); ++j)
+        {
+            double y = (x[i][_dims[j]] - _x0[j]) / _w[j];
+            size_t b = (_w[j] > 0 && y > 0) ? size_t(floor(y)) : 0;
+            c = c * _n[j] + min(b, _n[j] - 1);
+        }
+        return c;
     }
-}
 
+    // The distinct cells adjacent to cell c (including itself), with
+    // wrap-around if the boundaries are periodic.
+    void get_neighbors(size_t c, vector<size_t>& ns) const
+    {
+        size_t d = _dims.size();
+        std::array<size_t, 3> b;
+        for (size_t j = d; j-- > 0;)
+        {
+            b[j] = c % _n[j];
+            c /= _n[j];
+        }
 
-template <class Graph>
-bool is_adjacent(typename graph_traits<Graph>::vertex_descriptor v1,
-                 typename graph_traits<Graph>::vertex_descriptor v2,
-                 Graph& g)
-{
-    typename graph_traits<Graph>::out_edge_iterator e, e_end;
-    for (tie(e, e_end) = out_edges(v1, g); e != e_end; ++e)
-        if (target(*e, g) == v2)
-            return true;
-    return false;
-}
+        ns.clear();
+        size_t M = 1;
+        for (size_t j = 0; j < d; ++j)
+            M *= 3;
+        for (size_t m = 0; m < M; ++m)
+        {
+            size_t u = 0, k = m;
+            bool valid = true;
+            for (size_t j = 0; j < d; ++j)
+            {
+                int64_t y = int64_t(b[j]) + int64_t(k % 3) - 1;
+                k /= 3;
+                int64_t n = _n[j];
+                if (y < 0 || y >= n)
+                {
+                    if (!_periodic)
+                    {
+                        valid = false;
+                        break;
+                    }
+                    y = (y + n) % n;
+                }
+                u = u * _n[j] + y;
+            }
+            if (valid)
+                ns.push_back(u);
+        }
+        std::sort(ns.begin(), ns.end());
+        ns.erase(std::unique(ns.begin(), ns.end()), ns.end());
+    }
 
+    bool _periodic;
+    vector<size_t> _dims, _n;
+    vector<double> _x0, _w;
+    size_t _ncells;
+    vector<size_t> _pos, _order;
+};
+
+// Connects all pairs of points at a distance not larger than r. The cells are
+// split into blocks, which are processed in parallel, with the edges of each
+// block written to its own list. The lists are then concatenated in order,
+// and inserted in bulk, so the result does not depend on the number of
+// threads.
 struct get_geometric
 {
-    template <class Graph, class Pos>
-    void operator()(Graph& g, Pos upos, vector<vector<double> >& points,
-                    vector<pair<double, double> >& ranges,
+    template <class Graph, class Pos, class Points>
+    void operator()(Graph& g, Pos pos, Points& points,
+                    vector<pair<double, double>>& ranges,
                     double r, bool periodic_boundary) const
     {
-        int N = points.size();
-        typename Pos::checked_t pos = upos.get_checked();
-        vector<int> box;
-        vector<pair<int, int> > box_ranges;
+        size_t N = points.shape()[0];
+        size_t D = points.shape()[1];
+
+        for (size_t i = 0; i < N; ++i)
+            add_vertex(g);
 
-        double w = 2 * r;
+        pos.reserve(num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto& p = pos[v];
+                 p.resize(D);
+                 for (size_t k = 0; k < D; ++k)
+                     p[k] = points[v][k];
+             });
+
+        vector<double> L;
         if (periodic_boundary)
         {
-            box_ranges.resize(ranges.size());
-            for (size_t i = 0; i < ranges.size(); ++i)
+            for (auto& range : ranges)
+                L.push_back(abs(range.second - range.first));
+        }
+
+        geometric_cells cells(points, ranges, r, periodic_boundary);
+
+        size_t C = cells._ncells;
+        size_t nblocks = min(C, size_t(1024));
+        vector<vector<std::array<size_t, 2>>> bedges(nblocks);
+        double r2 = r * r;
+
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+        {
+            vector<size_t> ns;
+            #pragma omp for schedule(dynamic, 1)
+            for (size_t b = 0; b < nblocks; ++b)
             {
-                box_ranges[i].first = floor(ranges[i].first / w);
-                box_ranges[i].second = ceil(ranges[i].second / w);
+                auto& es = bedges[b];
+                for (size_t c = (b * C) / nblocks; c < ((b + 1) * C) / nblocks;
+                     ++c)
+                {
+                    if (cells._pos[c] == cells._pos[c + 1])
+                        continue;
+                    cells.get_neighbors(c, ns);
+                    for (size_t i = cells._pos[c]; i < cells._pos[c + 1]; ++i)
+                    {
+                        size_t v = cells._order[i];
+                        for (auto nc : ns)
+                        {
+                            for (size_t j = cells._pos[nc];
+                                 j < cells._pos[nc + 1]; ++j)
+                            {
+                                size_t u = cells._order[j];
+                                if (u <= v || get_dist2(points, v, u, L) > r2)
+                                    continue;
+                                es.push_back({v, u});
+                            }
+                        }
+                    }
+                }
             }
         }
 
-        std::unordered_multimap<vector<int>,
-                                typename graph_traits<Graph>::vertex_descriptor> boxes;
-
-        for (int i = 0; i < N; ++i)
+        vector<size_t> epos(nblocks + 1, 0);
+        for (size_t b = 0; b < nblocks; ++b)
+            epos[b + 1] = epos[b] + bedges[b].size();
+        vector<std::array<size_t, 2>> edges(epos[nblocks]);
+        #pragma omp parallel for schedule(dynamic, 1) if (N > OPENMP_MIN_THRESH)
+        for (size_t b = 0; b < nblocks; ++b)
         {
-            typename graph_traits<Graph>::vertex_descriptor v = add_vertex(g);
-            pos[v].resize(points[i].size());
-            copy(points[i].begin(), points[i].end(), pos[v].begin());
-            get_box(points[i], w, box, ranges, periodic_boundary);
-            boxes.insert(make_pair(box, v));
+            std::copy(bedges[b].begin(), bedges[b].end(),
+                      edges.begin() + epos[b]);
+            vector<std::array<size_t, 2>>().swap(bedges[b]);
         }
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            private(box)
-        parallel_vertex_loop_no_spawn
-            (g,
-             [&](auto v)
-             {
-                 size_t i = v;
-                 get_box(points[i], w, box, ranges, periodic_boundary);
-                 for (int k = 0; k < power(3, int(box.size())); ++k)
-                 {
-                     for (int j = 0; j < int(box.size()); ++j)
-                         box[j] += ((k / power(3, j)) % 3) - 1;
-
-                     if (periodic_boundary)
-                         periodic(box, box_ranges);
-
-                     decltype(boxes.begin()) iter, end;
-                     for (tie(iter, end) = boxes.equal_range(box);
-                          iter != end; ++iter)
-                     {
-                         auto w = iter->second;
-                         double d = get_dist(pos[v], pos[w], ranges,
-                                             periodic_boundary);
-
-                         if (w > v && d <= r &&
-                             (!periodic_boundary || !is_adjacent(v, w, g)))
-                         {
-                             #pragma omp critical
-                             add_edge(v, w, g);
-                         }
-                     }
-                     get_box(points[i], w, box, ranges, periodic_boundary);
-                 }
-             });
+        add_edges(edges, g);
     }
 };
 
@@ -19,6 +19,7 @@
 #include "graph_filtering.hh"
 
 #include "graph_lattice.hh"
+#include "graph_edge_stream.hh"
 
 #include <boost/python.hpp>
 
@@ -33,3 +34,16 @@ void lattice(GraphInterface& gi, boost::python::object oshape, bool periodic)
         shape[i] = python::extract<size_t>(oshape[i]);
     get_lattice()(gi.get_graph(), shape, periodic);
 }
+
+boost::python::tuple stream_lattice(string file, size_t width,
+                                    boost::python::object oshape,
+                                    bool periodic)
+{
+    vector<size_t> shape(boost::python::len(oshape));
+    for(size_t i = 0; i < shape.size(); ++i)
+        shape[i] = python::extract<size_t>(oshape[i]);
+    edge_stream es(file, width);
+    get_lattice()(es, shape, periodic);
+    es.close();
+    return boost::python::make_tuple(es.num_vertices(), es.num_edges());
+}
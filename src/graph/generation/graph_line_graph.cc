@@ -25,6 +25,36 @@ using namespace graph_tool;
 
 // retrieves the line graph
 
+// Calls f(e1, e2) for every edge of the line graph that is listed by vertex v,
+// i.e. every pair of edges v -> u -> w, or every pair of distinct edges
+// incident on v, for undirected graphs.
+template <class Graph, class F>
+void line_graph_pairs(const Graph& g,
+                      typename graph_traits<Graph>::vertex_descriptor v, F&& f)
+{
+    if (graph_tool::is_directed(g))
+    {
+        for (auto e1 : out_edges_range(v, g))
+            for (auto e2 : out_edges_range(target(e1, g), g))
+                f(e1, e2);
+    }
+    else
+    {
+        typename graph_traits<Graph>::out_edge_iterator e1, e2, e_end;
+        for (tie(e1, e_end) = out_edges(v, g); e1 != e_end; ++e1)
+        {
+            for (e2 = e1; e2 != e_end; ++e2)
+            {
+                if (*e1 != *e2)
+                    f(*e1, *e2);
+            }
+        }
+    }
+}
+
+// The edges are counted for each vertex in a first pass, which gives their
+// position in a single list, filled in parallel in a second pass, and
+// inserted in bulk. The result is identical to adding the edges in sequence.
 struct get_line_graph
 {
     template <class Graph, class VertexIndex, class LineGraph,
@@ -34,9 +64,8 @@ struct get_line_graph
                     LGVertexIndex vmap) const
     {
         typedef typename graph_traits<LineGraph>::vertex_descriptor lg_vertex_t;
-        typedef HashedDescriptorMap<EdgeIndexMap,lg_vertex_t>
-            edge_to_vertex_map_t;
-        edge_to_vertex_map_t edge_to_vertex_map(edge_index);
+        checked_vector_property_map<lg_vertex_t, EdgeIndexMap>
+            edge_to_vertex_map(edge_index);
 
         typename LGVertexIndex::checked_t vertex_map = vmap.get_checked();
 
@@ -47,40 +76,34 @@ struct get_line_graph
             vertex_map[v] = edge_index[e];
         }
 
-        if (graph_tool::is_directed(g))
-        {
-            for (auto v : vertices_range(g))
-            {
-                for (auto e1 : out_edges_range(v, g))
-                {
-                    for (auto e2 : out_edges_range(target(e1, g), g))
-                    {
-                        add_edge(edge_to_vertex_map[e1],
-                                 edge_to_vertex_map[e2],
-                                 line_graph);
-                    }
-                }
-            }
-        }
-        else
-        {
-            for (auto v : vertices_range(g))
-            {
-                typename graph_traits<Graph>::out_edge_iterator e1, e2, e_end;
-                for (tie(e1, e_end) = out_edges(v, g); e1 != e_end; ++e1)
-                {
-                    for (e2 = e1; e2 != e_end; ++e2)
-                    {
-                        if (*e1 != *e2)
-                        {
-                            add_edge(edge_to_vertex_map[*e1],
-                                     edge_to_vertex_map[*e2],
-                                     line_graph);
-                        }
-                    }
-                }
-            }
-        }
+        auto e2v = edge_to_vertex_map.get_unchecked();
+
+        size_t N = num_vertices(g);
+        vector<size_t> pos(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t k = 0;
+                 line_graph_pairs(g, v, [&](auto&&, auto&&) { ++k; });
+                 pos[v + 1] = k;
+             });
+        std::partial_sum(pos.begin(), pos.end(), pos.begin());
+
+        vector<std::array<lg_vertex_t, 2>> edges(pos[N]);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t p = pos[v];
+                 line_graph_pairs(g, v,
+                                  [&](const auto& e1, const auto& e2)
+                                  {
+                                      edges[p++] = {e2v[e1], e2v[e2]};
+                                  });
+             });
+
+        add_edges(edges, line_graph);
     }
 };
 
@@ -24,6 +24,7 @@
 #include "random.hh"
 
 #include "hash_map_wrap.hh"
+#include "dynamic_sampler.hh"
 
 #include <map>
 #include <iostream>
@@ -33,32 +34,184 @@ namespace graph_tool
 using namespace std;
 using namespace boost;
 
+// The samplers below give the targets of the new edges with probability
+// proportional to pow(k + c, gamma), where k is the (in-)degree. Only the
+// vertices with positive probability are considered. sample() draws a target,
+// update(w) is called after the degree of target w is incremented, and add(v)
+// after all the edges of the new vertex v were connected, returning whether
+// it can be sampled.
+
+// Cumulative distribution in a map, where every degree increment inserts a
+// new entry, with the probability difference.
+template <class Graph, class DegSelector>
+class price_map_sampler
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    price_map_sampler(Graph& g, double gamma, double c)
+        : _g(g), _gamma(gamma), _c(c) {}
+
+    bool add(vertex_t v)
+    {
+        double p = pow(DegSelector()(v, _g) + _c, _gamma);
+        if (p <= 0)
+            return false;
+        _probs.insert(make_pair(total() + p, v));
+        return true;
+    }
+
+    void update(vertex_t w)
+    {
+        double p = abs(pow(DegSelector()(w, _g) + _c, _gamma)
+                       - pow(DegSelector()(w, _g) + _c - 1, _gamma));
+        if (p > 0)
+            _probs.insert(make_pair(total() + p, w));
+    }
+
+    vertex_t sample(rng_t& rng)
+    {
+        uniform_real_distribution<> sample(0, total());
+        return _probs.lower_bound(sample(rng))->second;
+    }
+
+private:
+    double total() const
+    {
+        return _probs.empty() ? 0 : _probs.rbegin()->first;
+    }
+
+    Graph& _g;
+    double _gamma, _c;
+    map<double, vertex_t> _probs;
+};
+
+// Binary tree of the vertex weights, with O(log N) updates and draws.
+template <class Graph, class DegSelector>
+class price_tree_sampler
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    price_tree_sampler(Graph& g, double gamma, double c)
+        : _g(g), _gamma(gamma), _c(c) {}
+
+    bool add(vertex_t v)
+    {
+        double p = pow(DegSelector()(v, _g) + _c, _gamma);
+        if (p <= 0)
+            return false;
+        if (v >= _pos.size())
+            _pos.resize(v + 1);
+        _pos[v] = _sampler.insert(v, p);
+        return true;
+    }
+
+    void update(vertex_t w)
+    {
+        _sampler.update(_pos[w], pow(DegSelector()(w, _g) + _c, _gamma));
+    }
+
+    vertex_t sample(rng_t& rng)
+    {
+        return _sampler.sample(rng);
+    }
+
+private:
+    Graph& _g;
+    double _gamma, _c;
+    DynamicSampler<vertex_t> _sampler;
+    vector<size_t> _pos;
+};
+
+// Linear preferential attachment (gamma == 1, c >= 0) in O(1) time per draw:
+// every vertex appears k times in the list of edge endpoints, so that a
+// target is either a uniform entry of this list, or with probability
+// proportional to c times the number of vertices, a uniform vertex.
+template <class Graph, class DegSelector>
+class price_endpoint_sampler
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    price_endpoint_sampler(Graph& g, double, double c)
+        : _g(g), _c(c) {}
+
+    bool add(vertex_t v)
+    {
+        size_t k = DegSelector()(v, _g);
+        for (size_t i = 0; i < k; ++i)
+            _endpoints.push_back(v);
+        if (k + _c <= 0)
+            return false;
+        _vertices.push_back(v);
+        return true;
+    }
+
+    void update(vertex_t w)
+    {
+        _endpoints.push_back(w);
+    }
+
+    vertex_t sample(rng_t& rng)
+    {
+        size_t K = _endpoints.size();
+        uniform_real_distribution<> sample(0, K + _c * _vertices.size());
+        double r = sample(rng);
+        if (r < K)
+            return _endpoints[std::min(size_t(r), K - 1)];
+        size_t i = (r - K) / _c;
+        return _vertices[std::min(i, _vertices.size() - 1)];
+    }
+
+private:
+    Graph& _g;
+    double _c;
+    vector<vertex_t> _endpoints;
+    vector<vertex_t> _vertices;
+};
+
+// If fast is true, the targets are sampled with price_endpoint_sampler if
+// gamma == 1 and c >= 0, or with price_tree_sampler otherwise, instead of
+// price_map_sampler. The distribution of the result is the same.
 struct get_price
 {
     template <class Graph>
     void operator()(Graph& g, size_t N, double gamma, double c, size_t m,
-                    rng_t& rng) const
+                    bool fast, rng_t& rng) const
     {
         typedef typename mpl::if_<typename is_directed::apply<Graph>::type,
                                   in_degreeS, out_degreeS>::type DegSelector;
 
-        map<double, typename graph_traits<Graph>::vertex_descriptor> probs;
+        if (!fast)
+        {
+            price_map_sampler<Graph, DegSelector> sampler(g, gamma, c);
+            attach(g, N, m, sampler, rng);
+        }
+        else if (gamma == 1 && c >= 0)
+        {
+            price_endpoint_sampler<Graph, DegSelector> sampler(g, gamma, c);
+            attach(g, N, m, sampler, rng);
+        }
+        else
+        {
+            price_tree_sampler<Graph, DegSelector> sampler(g, gamma, c);
+            attach(g, N, m, sampler, rng);
+        }
+    }
 
+    template <class Graph, class Sampler>
+    void attach(Graph& g, size_t N, size_t m, Sampler& sampler,
+                rng_t& rng) const
+    {
         size_t n_possible = 0;
-        double cp = 0, p = 0;
-        typename graph_traits<Graph>::vertex_iterator vi, vi_end;
-        for (tie(vi, vi_end) = vertices(g); vi != vi_end; ++vi)
+        for (auto v : vertices_range(g))
         {
-            p = pow(DegSelector()(*vi, g) + c, gamma);
-            cp += p;
-            if (p > 0)
-            {
-                probs.insert(make_pair(cp, *vi));
+            if (sampler.add(v))
                 ++n_possible;
-            }
         }
 
-        if (probs.empty() || probs.rbegin()->first <= 0)
+        if (n_possible == 0)
             throw GraphException("Cannot connect edges: probabilities are <= 0!");
 
         gt_hash_set<typename graph_traits<Graph>::vertex_descriptor> visited;
@@ -68,11 +221,7 @@ struct get_price
             typename graph_traits<Graph>::vertex_descriptor v = add_vertex(g);
             for (size_t j = 0; j < min(m, n_possible); ++j)
             {
-                uniform_real_distribution<> sample(0, probs.rbegin()->first);
-                double r = sample(rng);
-                auto iter = probs.lower_bound(r);
-                typename graph_traits<Graph>::vertex_descriptor w =
-                    iter->second;
+                auto w = sampler.sample(rng);
 
                 if (visited.find(w) != visited.end())
                 {
@@ -81,18 +230,10 @@ struct get_price
                 }
                 visited.insert(w);
                 add_edge(v, w, g);
-
-                p = abs(pow(DegSelector()(w, g) + c, gamma)
-                        - pow(DegSelector()(w, g) + c - 1, gamma));
-                if (p > 0)
-                    probs.insert(make_pair(probs.rbegin()->first + p, w));
+                sampler.update(w);
             }
-            p = pow(DegSelector()(v, g) + c, gamma);
-            if (p > 0)
-            {
-                probs.insert(make_pair(probs.rbegin()->first + p, v));
+            if (sampler.add(v))
                 n_possible += 1;
-            }
         }
     }
 };
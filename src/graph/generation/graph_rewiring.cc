@@ -23,6 +23,7 @@
 #include <boost/python.hpp>
 
 #include "graph_rewiring.hh"
+#include "graph_rewiring_parallel.hh"
 
 using namespace graph_tool;
 using namespace boost;
@@ -135,7 +136,7 @@ size_t random_rewire(GraphInterface& gi, string strat, size_t niter,
                      bool configuration, bool traditional, bool micro,
                      bool persist, boost::python::object corr_prob,
                      boost::any apin, boost::any block, bool cache, rng_t& rng,
-                     bool verbose)
+                     bool verbose, bool parallel)
 {
     PythonFuncWrap corr(corr_prob);
     size_t pcount = 0;
@@ -145,6 +146,45 @@ size_t random_rewire(GraphInterface& gi, string strat, size_t niter,
     emap_t::unchecked_t pin =
         any_cast<emap_t>(apin).get_unchecked(gi.get_edge_index_range());
 
+    if (parallel && !no_sweep)
+    {
+        rewire_strat_t pstrat;
+        if (strat == "erdos")
+            pstrat = rewire_strat_t::erdos;
+        else if (strat == "configuration")
+            pstrat = rewire_strat_t::configuration;
+        else if (strat == "constrained-configuration")
+            pstrat = rewire_strat_t::correlated;
+        else
+            throw ValueException("parallel rewiring is not available for "
+                                 "the random rewire strategy: " + strat);
+
+        if (pstrat == rewire_strat_t::correlated && !block.empty())
+        {
+            run_action<graph_tool::detail::never_reversed>()
+                (gi, [&](auto& g, auto b)
+                     {
+                         parallel_rewire(g, pin, pstrat, self_loops,
+                                         parallel_edges, configuration, niter,
+                                         persist, verbose, pcount, rng,
+                                         PropertyBlock<decltype(b)>(b));
+                     },
+                 vertex_properties())(block);
+        }
+        else
+        {
+            run_action<graph_tool::detail::never_reversed>()
+                (gi, [&](auto& g)
+                     {
+                         parallel_rewire(g, pin, pstrat, self_loops,
+                                         parallel_edges, configuration, niter,
+                                         persist, verbose, pcount, rng,
+                                         DegreeBlock());
+                     })();
+        }
+        return pcount;
+    }
+
     if (strat == "erdos")
     {
         run_action<graph_tool::detail::never_reversed>()
@@ -61,6 +61,16 @@ target(const pair<size_t, bool>& e,
 }
 
 
+// Edge multiplicities, kept by all strategies as a hash map per vertex, keyed
+// by the other endpoint (the smallest endpoint holds the entry in undirected
+// graphs). This takes O(E) memory, and gives O(1) expected time for the
+// parallel edge checks, independently of the degrees involved.
+template <class Graph>
+using edge_count_map_t =
+    typename property_map_type::apply<gt_hash_map<size_t, size_t>,
+                                      typename property_map<Graph, vertex_index_t>::type>
+    ::type::unchecked_t;
+
 template <class Nmap, class Graph>
 void add_count(size_t s, size_t t, Nmap& nvmap, Graph& g)
 {
@@ -379,7 +389,8 @@ public:
 
     ErdosRewireStrategy(Graph& g, EdgeIndexMap edge_index,
                         vector<edge_t>& edges, CorrProb, BlockDeg,
-                        bool, rng_t& rng, bool, bool configuration)
+                        bool, rng_t& rng, bool parallel_edges,
+                        bool configuration)
         : _g(g), _edge_index(edge_index), _edges(edges),
           _vertices(HardNumVertices()(g)), _rng(rng),
           _configuration(configuration),
@@ -390,7 +401,7 @@ public:
         for (tie(v, v_end) = vertices(_g); v != v_end; ++v)
             *(viter++) = *v;
 
-        if (!configuration)
+        if (!configuration || !parallel_edges)
         {
             for (size_t i = 0; i < edges.size(); ++i)
                 add_count(source(edges[i], g), target(edges[i], g), _nmap, g);
@@ -436,7 +447,7 @@ public:
             return false;
 
         // reject parallel edges if not allowed
-        if (!parallel_edges && is_adjacent(s, t, _g))
+        if (!parallel_edges && get_count(s, t, _nmap, _g) > 0)
             return false;
 
         if (!_configuration)
@@ -455,7 +466,7 @@ public:
         edge_t ne = add_edge(s, t, _g).first;
         _edges[ei] = ne;
 
-        if (!_configuration)
+        if (!_configuration || !parallel_edges)
         {
             remove_count(e_s, e_t, _nmap, _g);
             add_count(s, t, _nmap, _g);
@@ -471,10 +482,7 @@ private:
     vector<typename graph_traits<Graph>::vertex_descriptor> _vertices;
     rng_t& _rng;
     bool _configuration;
-    typedef gt_hash_map<size_t, size_t> nmapv_t;
-    typedef typename property_map_type::apply<nmapv_t,
-                                              typename property_map<Graph, vertex_index_t>::type>
-        ::type::unchecked_t nmap_t;
+    typedef edge_count_map_t<Graph> nmap_t;
     nmap_t _nmap;
 };
 
@@ -601,10 +609,7 @@ protected:
     vector<edge_t>& _edges;
     rng_t& _rng;
 
-    typedef gt_hash_map<size_t, size_t> nmapv_t;
-    typedef typename property_map_type::apply<nmapv_t,
-                                              typename property_map<Graph, vertex_index_t>::type>
-        ::type::unchecked_t nmap_t;
+    typedef edge_count_map_t<Graph> nmap_t;
     nmap_t _nmap;
     bool _configuration;
 };
@@ -1061,10 +1066,7 @@ private:
 
     bool _configuration;
 
-    typedef gt_hash_map<size_t, size_t> nmapv_t;
-    typedef typename property_map_type::apply<nmapv_t,
-                                              typename property_map<Graph, vertex_index_t>::type>
-        ::type::unchecked_t nmap_t;
+    typedef edge_count_map_t<Graph> nmap_t;
     nmap_t _nmap;
 };
 
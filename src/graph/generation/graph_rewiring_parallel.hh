@@ -0,0 +1,442 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_REWIRING_PARALLEL_HH
+#define GRAPH_REWIRING_PARALLEL_HH
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+#include "graph_rewiring.hh"
+#include "../inference/support/parallel_rng.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Parallel version of graph_rewire, for the strategies which only move the
+// endpoints of the edges, with the same proposals and acceptance
+// probabilities: "erdos" (ErdosRewireStrategy), "configuration"
+// (RandomRewireStrategy) and "constrained-configuration"
+// (CorrelatedRewireStrategy).
+//
+// The endpoints of the rewired edges are kept in a separate list, and the
+// graph itself is only modified at the end. At each sweep, the edges are split
+// into disjoint contiguous ranges, one per thread, which are visited in
+// random order, each thread with its own RNG. Every proposal involves at most
+// four vertices (the endpoints of the edge and of the target edge, or of the
+// new edge), which are locked with atomic flags, without blocking. If any of
+// them is already locked, or if the endpoints have changed by the time they
+// are locked, the locks are released and the proposal is tried again. Since
+// the parallel-edge counts are indexed by one of the endpoints, and the blocks
+// of the endpoints of every edge are invariant under the moves, the locked
+// vertices are all the state that a proposal reads or writes.
+//
+// As a consequence, every move is done atomically with the acceptance
+// probability of the sequential chain, given the current state. However, the
+// order of the moves depends on the scheduling of the threads, so the result
+// is not reproducible, even with a fixed seed.
+enum class rewire_strat_t { erdos, configuration, correlated };
+
+template <class Graph>
+class parallel_rewire_state
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+    parallel_rewire_state(Graph& g, const vector<edge_t>& edges, bool counts)
+        : _g(g), _E(edges.size()), _src(new std::atomic<size_t>[_E]),
+          _tgt(new std::atomic<size_t>[_E]),
+          _lock(new std::atomic<bool>[num_vertices(g)]), _counts(counts)
+    {
+        size_t N = num_vertices(g);
+        for (size_t v = 0; v < N; ++v)
+            _lock[v] = false;
+        if (counts)
+            _nmap.resize(N);
+        for (size_t i = 0; i < _E; ++i)
+        {
+            _src[i] = source(edges[i], g);
+            _tgt[i] = target(edges[i], g);
+            if (counts)
+                add_count(_src[i], _tgt[i], _nmap, g);
+        }
+    }
+
+    // endpoints of edge e, inverted if e.second is true, as in source() and
+    // target() of graph_rewiring.hh
+    size_t get_source(const pair<size_t, bool>& e) const
+    {
+        return (e.second ? _tgt[e.first] : _src[e.first])
+            .load(std::memory_order_relaxed);
+    }
+
+    size_t get_target(const pair<size_t, bool>& e) const
+    {
+        return (e.second ? _src[e.first] : _tgt[e.first])
+            .load(std::memory_order_relaxed);
+    }
+
+    void set_target(const pair<size_t, bool>& e, size_t v)
+    {
+        (e.second ? _src[e.first] : _tgt[e.first])
+            .store(v, std::memory_order_relaxed);
+    }
+
+    void set_edge(size_t e, size_t s, size_t t)
+    {
+        _src[e].store(s, std::memory_order_relaxed);
+        _tgt[e].store(t, std::memory_order_relaxed);
+    }
+
+    // locks the n vertices in vs (which may repeat), or none of them,
+    // returning false, if any is already locked
+    bool try_lock(std::array<size_t, 4>& vs, size_t& n)
+    {
+        std::sort(vs.begin(), vs.begin() + n);
+        n = std::unique(vs.begin(), vs.begin() + n) - vs.begin();
+        for (size_t i = 0; i < n; ++i)
+        {
+            bool expected = false;
+            if (!_lock[vs[i]].compare_exchange_strong(expected, true,
+                                                      std::memory_order_acquire))
+            {
+                unlock(vs, i);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unlock(const std::array<size_t, 4>& vs, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            _lock[vs[i]].store(false, std::memory_order_release);
+    }
+
+    // parallel-edge counts, only touched under the lock of the endpoints
+    size_t get(size_t s, size_t t) { return get_count(s, t, _nmap, _g); }
+    void add(size_t s, size_t t) { if (_counts) add_count(s, t, _nmap, _g); }
+    void remove(size_t s, size_t t) { if (_counts) remove_count(s, t, _nmap, _g); }
+
+    size_t size() const { return _E; }
+
+private:
+    Graph& _g;
+    size_t _E;
+    std::unique_ptr<std::atomic<size_t>[]> _src, _tgt;
+    std::unique_ptr<std::atomic<bool>[]> _lock;
+    bool _counts;
+    vector<gt_hash_map<size_t, size_t>> _nmap;
+};
+
+template <class Graph, class PinMap, class BlockDeg>
+void parallel_rewire(Graph& g, PinMap pin, rewire_strat_t strat,
+                     bool self_loops, bool parallel_edges, bool configuration,
+                     size_t niter, bool persist, bool verbose, size_t& pcount,
+                     rng_t& rng, BlockDeg bd)
+{
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+    typedef typename BlockDeg::block_t block_t;
+    bool directed = graph_tool::is_directed(g);
+
+    vector<edge_t> edges;
+    for (auto e : edges_range(g))
+    {
+        if (pin[e])
+            continue;
+        edges.push_back(e);
+    }
+    size_t E = edges.size();
+    if (E == 0)
+        return;
+
+    parallel_rewire_state<Graph> state(g, edges,
+                                       !parallel_edges || !configuration);
+
+    // edges grouped by the block of their targets (both ends, if undirected),
+    // as in CorrelatedRewireStrategy, with the blocks mapped to integers
+    vector<size_t> vblock;
+    vector<vector<pair<size_t, bool>>> edges_by_target;
+    if (strat == rewire_strat_t::correlated)
+    {
+        std::unordered_map<block_t, size_t> bmap;
+        vblock.resize(num_vertices(g));
+        for (auto v : vertices_range(g))
+        {
+            auto iter = bmap.insert({bd.get_block(v, g), bmap.size()}).first;
+            vblock[v] = iter->second;
+        }
+        edges_by_target.resize(bmap.size());
+        for (size_t ei = 0; ei < E; ++ei)
+        {
+            edges_by_target[vblock[state.get_target({ei, false})]]
+                .emplace_back(ei, false);
+            if (!directed)
+                edges_by_target[vblock[state.get_source({ei, false})]]
+                    .emplace_back(ei, true);
+        }
+    }
+
+    vector<typename graph_traits<Graph>::vertex_descriptor> vertices;
+    if (strat == rewire_strat_t::erdos)
+    {
+        for (auto v : vertices_range(g))
+            vertices.push_back(v);
+    }
+
+    auto rewire_erdos = [&](size_t ei, rng_t& rng) -> bool
+        {
+            std::uniform_int_distribution<size_t> sample(0, vertices.size() - 1);
+            size_t s, t;
+            while (true)
+            {
+                s = vertices[sample(rng)];
+                t = vertices[sample(rng)];
+                if (s == t)
+                {
+                    if (!self_loops)
+                        continue;
+                }
+                else if (!directed && self_loops)
+                {
+                    std::bernoulli_distribution reject(.5);
+                    if (reject(rng))
+                        continue;
+                }
+                break;
+            }
+
+            if (!directed && s > t)
+                std::swap(s, t);
+
+            std::array<size_t, 4> vs;
+            size_t n, e_s, e_t;
+            while (true)
+            {
+                e_s = state.get_source({ei, false});
+                e_t = state.get_target({ei, false});
+                vs = {{e_s, e_t, s, t}};
+                n = 4;
+                if (!state.try_lock(vs, n))
+                    continue;
+                if (e_s == state.get_source({ei, false}) &&
+                    e_t == state.get_target({ei, false}))
+                    break;
+                state.unlock(vs, n);
+            }
+
+            if (!directed && e_s > e_t)
+                std::swap(e_s, e_t);
+
+            bool accept = !(s == e_s && t == e_t);
+
+            if (accept && !parallel_edges && state.get(s, t) > 0)
+                accept = false;
+
+            if (accept && !configuration)
+            {
+                double a = (state.get(s, t) + 1) / double(state.get(e_s, e_t));
+                std::bernoulli_distribution coin(std::min(a, 1.));
+                accept = coin(rng);
+            }
+
+            if (accept)
+            {
+                state.remove(e_s, e_t);
+                state.set_edge(ei, s, t);
+                state.add(s, t);
+            }
+
+            state.unlock(vs, n);
+            return accept;
+        };
+
+    auto rewire_swap = [&](size_t ei, rng_t& rng) -> bool
+        {
+            // the target edge, as in the get_target_edge() of the strategies
+            pair<size_t, bool> e = {ei, false}, et;
+            if (strat == rewire_strat_t::configuration)
+            {
+                std::uniform_int_distribution<size_t> sample(0, E - 1);
+                et = {sample(rng), false};
+                if (!directed)
+                {
+                    std::bernoulli_distribution coin(0.5);
+                    et.second = coin(rng);
+                    e.second = coin(rng);
+                }
+            }
+            else
+            {
+                if (!directed)
+                {
+                    std::bernoulli_distribution coin(0.5);
+                    e.second = coin(rng);
+                }
+                size_t r = vblock[state.get_target(e)];
+                auto& elist = edges_by_target[r];
+                std::uniform_int_distribution<size_t> sample(0, elist.size() - 1);
+                et = elist[sample(rng)];
+                if (vblock[state.get_target(et)] != r)
+                    et.second = !et.second;
+            }
+
+            if (et.first == ei)
+                return false;
+
+            std::array<size_t, 4> vs;
+            size_t n, s, t, ts, tt;
+            while (true)
+            {
+                s = state.get_source(e);
+                t = state.get_target(e);
+                ts = state.get_source(et);
+                tt = state.get_target(et);
+                vs = {{s, t, ts, tt}};
+                n = 4;
+                if (!state.try_lock(vs, n))
+                    continue;
+                if (s == state.get_source(e) && t == state.get_target(e) &&
+                    ts == state.get_source(et) && tt == state.get_target(et))
+                    break;
+                state.unlock(vs, n);
+            }
+
+            bool accept = true;
+            if (!self_loops && (s == tt || ts == t))
+                accept = false;
+
+            if (accept && !parallel_edges &&
+                (state.get(s, tt) > 0 || state.get(ts, t) > 0))
+                accept = false;
+
+            if (accept)
+            {
+                double a = 0;
+                if (!directed)
+                {
+                    a -= log(2 + (s == t) + (ts == tt));
+                    a += log(2 + (s == tt) + (ts == t));
+                }
+
+                if (!configuration)
+                {
+                    map<std::pair<size_t, size_t>, int> delta;
+                    delta[std::make_pair(s, t)] -= 1;
+                    delta[std::make_pair(ts, tt)] -= 1;
+                    delta[std::make_pair(s, tt)] += 1;
+                    delta[std::make_pair(ts, t)] += 1;
+
+                    for (auto& e_d : delta)
+                    {
+                        auto u = e_d.first.first;
+                        auto v = e_d.first.second;
+                        int d = e_d.second;
+                        size_t m = state.get(u, v);
+                        a -= lgamma(m + 1) - lgamma((m + 1) + d);
+                        if (!directed && u == v)
+                            a += d * log(2);
+                    }
+                }
+
+                std::bernoulli_distribution coin(std::min(exp(a), 1.));
+                accept = coin(rng);
+            }
+
+            if (accept)
+            {
+                state.remove(s, t);
+                state.remove(ts, tt);
+                state.set_target(e, tt);
+                state.set_target(et, t);
+                state.add(s, tt);
+                state.add(ts, t);
+            }
+
+            state.unlock(vs, n);
+            return accept;
+        };
+
+    vector<std::shared_ptr<rng_t>> rngs;
+    init_rngs(rngs, rng);
+
+    vector<size_t> order(E);
+    std::iota(order.begin(), order.end(), 0);
+
+    pcount = 0;
+    if (verbose)
+        cout << "rewiring edges: ";
+    stringstream str;
+    for (size_t i = 0; i < niter; ++i)
+    {
+        size_t count = 0;
+        #pragma omp parallel reduction(+:count)
+        {
+            size_t tid = 0, nt = 1;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+            nt = omp_get_num_threads();
+#endif
+            auto& rng_ = get_rng(rngs, rng);
+            auto begin = order.begin() + (E * tid) / nt;
+            auto end = order.begin() + (E * (tid + 1)) / nt;
+            std::shuffle(begin, end, rng_);
+            for (auto iter = begin; iter != end; ++iter)
+            {
+                bool success = false;
+                do
+                {
+                    if (strat == rewire_strat_t::erdos)
+                        success = rewire_erdos(*iter, rng_);
+                    else
+                        success = rewire_swap(*iter, rng_);
+                }
+                while (persist && !success);
+
+                if (!success)
+                    ++count;
+            }
+        }
+        pcount += count;
+        if (verbose)
+            print_progress(i, niter, E - 1, E, str);
+    }
+    if (verbose)
+        cout << endl;
+
+    // the modified edges are removed first, so that the new ones take their
+    // indexes in the same order
+    vector<size_t> moved;
+    for (size_t ei = 0; ei < E; ++ei)
+    {
+        if (state.get_source({ei, false}) != source(edges[ei], g) ||
+            state.get_target({ei, false}) != target(edges[ei], g))
+            moved.push_back(ei);
+    }
+    for (auto ei : moved)
+        remove_edge(edges[ei], g);
+    for (auto ei : moved)
+        add_edge(state.get_source({ei, false}), state.get_target({ei, false}), g);
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_REWIRING_PARALLEL_HH
@@ -25,7 +25,7 @@ using namespace graph_tool;
 void generate_sbm(GraphInterface& gi, boost::any ab, boost::python::object ors,
                   boost::python::object oss, boost::python::object oprobs,
                   boost::any ain_deg, boost::any aout_deg, bool micro_ers,
-                  bool micro_degs, rng_t& rng)
+                  bool micro_degs, bool parallel, rng_t& rng)
 {
     auto rs = get_array<int64_t, 1>(ors);
     auto ss = get_array<int64_t, 1>(oss);
@@ -41,7 +41,8 @@ void generate_sbm(GraphInterface& gi, boost::any ab, boost::python::object ors,
         auto out_deg = any_cast<dmap_t>(aout_deg).get_unchecked();
         run_action<>()
             (gi, [&](auto& g) { gen_sbm<true>(g, b, rs, ss, probs, in_deg,
-                                              out_deg, true, rng); })();
+                                              out_deg, true, false,
+                                              rng); })();
     }
     else
     {
@@ -51,6 +52,33 @@ void generate_sbm(GraphInterface& gi, boost::any ab, boost::python::object ors,
         auto out_deg = any_cast<dmap_t>(aout_deg).get_unchecked();
         run_action<>()
             (gi, [&](auto& g) { gen_sbm<false>(g, b, rs, ss, probs, in_deg,
-                                               out_deg, micro_ers, rng); })();
+                                               out_deg, micro_ers,
+                                               parallel, rng); })();
     }
 }
+
+boost::python::tuple stream_sbm(GraphInterface& gi, string file, size_t width,
+                                boost::any ab, boost::python::object ors,
+                                boost::python::object oss,
+                                boost::python::object oprobs,
+                                boost::any ain_deg, boost::any aout_deg,
+                                bool micro_ers, rng_t& rng)
+{
+    auto rs = get_array<int64_t, 1>(ors);
+    auto ss = get_array<int64_t, 1>(oss);
+    auto probs = get_array<double, 1>(oprobs);
+
+    typedef vprop_map_t<int32_t>::type bmap_t;
+    auto b = any_cast<bmap_t>(ab).get_unchecked();
+
+    typedef vprop_map_t<double>::type dmap_t;
+    auto in_deg = any_cast<dmap_t>(ain_deg).get_unchecked();
+    auto out_deg = any_cast<dmap_t>(aout_deg).get_unchecked();
+
+    edge_stream es(file, width);
+    run_action<>()
+        (gi, [&](auto& g) { stream_sbm(g, b, rs, ss, probs, in_deg, out_deg,
+                                       micro_ers, es, rng); })();
+    es.close();
+    return boost::python::make_tuple(es.num_vertices(), es.num_edges());
+}
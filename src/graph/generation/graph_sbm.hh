@@ -29,21 +29,131 @@
 #include "urn_sampler.hh"
 
 #include "random.hh"
+#include "../inference/support/parallel_rng.hh"
 
 #include "hash_map_wrap.hh"
+#include "graph_edge_stream.hh"
 
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
-template <bool micro_deg, class Graph, class VProp, class IVec, class FVec,
-          class VDProp, class RNG>
-void gen_sbm(Graph& g, VProp b, IVec& rs, IVec& ss, FVec probs, VDProp in_deg,
-             VDProp out_deg, bool micro_ers, RNG& rng)
+// Inserts the edges of the (source, target) list in sequence, in bulk if
+// possible.
+template <class Graph, class EdgeList>
+void sbm_add_edges(Graph& g, const EdgeList& edges)
 {
-    typedef typename std::conditional_t<micro_deg,size_t,double> dtype;
-    vector<vector<size_t>> rvs;
+    for (auto& e : edges)
+        add_edge(e[0], e[1], g);
+}
+
+template <class Vertex, class EdgeList>
+void sbm_add_edges(adj_list<Vertex>& g, const EdgeList& edges)
+{
+    add_edges(edges, g);
+}
+
+template <class Vertex, class EdgeList>
+void sbm_add_edges(undirected_adaptor<adj_list<Vertex>>& g,
+                   const EdgeList& edges)
+{
+    sbm_add_edges(g.original_graph(), edges);
+}
+
+template <class Graph, class IVec, class FVec, class Sampler, class RNG>
+void gen_sbm_parallel(std::true_type, Graph& g, IVec& rs, IVec& ss,
+                      FVec& probs, bool micro_ers,
+                      const vector<Sampler>& v_in_sampler,
+                      const vector<Sampler>& v_out_sampler, RNG& rng)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    // each block pair draws from a counter-based stream keyed by (seed, pair),
+    // so the result does not depend on the number of threads
+    uint64_t seed = draw_seed(rng);
+
+    size_t M = rs.shape()[0];
+    vector<size_t> pos(M + 1, 0);
+    bool inconsistent = false;
+
+    #pragma omp parallel for schedule(static) reduction(||:inconsistent)
+    for (size_t i = 0; i < M; ++i)
+    {
+        size_t r = rs[i];
+        size_t s = ss[i];
+        double p = probs[i];
+
+        if (p == 0)
+            continue;
+
+        if (!graph_tool::is_directed(g) && r == s)
+            p /= 2;
+
+        auto& r_sampler = v_out_sampler[r];
+        auto& s_sampler = v_in_sampler[s];
+
+        size_t mrs;
+        if (micro_ers)
+        {
+            mrs = p;
+        }
+        else
+        {
+            counter_rng rng_(seed, i, 0);
+            std::poisson_distribution<> poi(p);
+            mrs = poi(rng_);
+        }
+
+        size_t ers = (&r_sampler != &s_sampler) ? mrs : 2 * mrs;
+        if (!r_sampler.has_n(ers) || !s_sampler.has_n(ers))
+            inconsistent = true;
+        pos[i + 1] = mrs;
+    }
+
+    if (inconsistent)
+        throw GraphException("Inconsistent SBM parameters: node degrees do not agree with matrix of edge counts between groups");
+
+    std::partial_sum(pos.begin(), pos.end(), pos.begin());
+    vector<std::array<vertex_t, 2>> edges(pos[M]);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < M; ++i)
+    {
+        auto& r_sampler = v_out_sampler[rs[i]];
+        auto& s_sampler = v_in_sampler[ss[i]];
+        counter_rng rng_(seed, i, 1);
+        for (size_t j = pos[i]; j < pos[i + 1]; ++j)
+        {
+            edges[j][0] = r_sampler.sample(rng_);
+            edges[j][1] = s_sampler.sample(rng_);
+        }
+    }
+
+    sbm_add_edges(g, edges);
+}
+
+template <class Graph, class IVec, class FVec, class Sampler, class RNG>
+void gen_sbm_parallel(std::false_type, Graph&, IVec&, IVec&, FVec&, bool,
+                      const vector<Sampler>&, const vector<Sampler>&, RNG&)
+{
+    throw GraphException("Parallel SBM generation is not available with "
+                         "microcanonical degrees");
+}
+
+// Builds the samplers of the vertices of each group, given in rvs,
+// proportionally to their in- and out-degree propensities (the in-samplers are
+// only built for directed graphs). The samplers refer to rvs, which must
+// outlive them.
+template <class Graph, class VProp, class VDProp, class Sampler>
+void get_sbm_samplers(Graph& g, VProp b, VDProp in_deg, VDProp out_deg,
+                      vector<vector<size_t>>& rvs,
+                      vector<Sampler>& v_in_sampler,
+                      vector<Sampler>& v_out_sampler)
+{
+    typedef typename property_traits<VDProp>::value_type dval_t;
+    typedef typename std::conditional_t<std::is_integral<dval_t>::value,
+                                        size_t, double> dtype;
     vector<vector<dtype>> v_in_probs, v_out_probs;
     for (auto v : vertices_range(g))
     {
@@ -61,19 +171,43 @@ void gen_sbm(Graph& g, VProp b, IVec& rs, IVec& ss, FVec probs, VDProp in_deg,
         v_out_probs[r].push_back(out_deg[v]);
     }
 
-    typedef std::conditional_t<micro_deg,
-                               UrnSampler<size_t, false>,
-                               Sampler<size_t>> vsampler_t;
-    vector<vsampler_t> v_in_sampler_, v_out_sampler;
     for (size_t r = 0; r < rvs.size(); ++r)
     {
         if (graph_tool::is_directed(g))
-            v_in_sampler_.emplace_back(rvs[r], v_in_probs[r]);
+            v_in_sampler.emplace_back(rvs[r], v_in_probs[r]);
         v_out_sampler.emplace_back(rvs[r], v_out_probs[r]);
     }
+}
+
+// If parallel is true (which requires micro_deg == false, since the urn
+// samplers are consumed), the block pairs are split statically among the
+// threads, each with its own RNG seeded from rng. The edge counts are drawn
+// first, giving the position of the edges of every pair in a single list,
+// which is then filled in parallel by sampling the endpoints, and inserted in
+// bulk. The result is deterministic for a given seed and number of threads.
+template <bool micro_deg, class Graph, class VProp, class IVec, class FVec,
+          class VDProp, class RNG>
+void gen_sbm(Graph& g, VProp b, IVec& rs, IVec& ss, FVec probs, VDProp in_deg,
+             VDProp out_deg, bool micro_ers, bool parallel, RNG& rng)
+{
+    typedef std::conditional_t<micro_deg,
+                               UrnSampler<size_t, false>,
+                               Sampler<size_t>> vsampler_t;
+    vector<vector<size_t>> rvs;
+    vector<vsampler_t> v_in_sampler_, v_out_sampler;
+    get_sbm_samplers(g, b, in_deg, out_deg, rvs, v_in_sampler_,
+                     v_out_sampler);
 
     auto& v_in_sampler = (graph_tool::is_directed(g)) ? v_in_sampler_ : v_out_sampler;
 
+    if (parallel)
+    {
+        gen_sbm_parallel(std::integral_constant<bool, !micro_deg>(), g, rs,
+                         ss, probs, micro_ers, v_in_sampler, v_out_sampler,
+                         rng);
+        return;
+    }
+
     for (size_t i = 0; i < rs.shape()[0]; ++i)
     {
         size_t r = rs[i];
@@ -114,6 +248,74 @@ void gen_sbm(Graph& g, VProp b, IVec& rs, IVec& ss, FVec probs, VDProp in_deg,
 }
 
 
+// Samples the edges like gen_sbm_parallel(), i.e. with canonical degrees, but
+// writes them to the edge stream as they are sampled, instead of storing
+// them. The graph g is only used for its vertices, and is not modified.
+template <class Graph, class VProp, class IVec, class FVec, class VDProp,
+          class RNG>
+void stream_sbm(Graph& g, VProp b, IVec& rs, IVec& ss, FVec probs,
+                VDProp in_deg, VDProp out_deg, bool micro_ers,
+                edge_stream& es, RNG& rng)
+{
+    vector<vector<size_t>> rvs;
+    vector<Sampler<size_t>> v_in_sampler_, v_out_sampler;
+    get_sbm_samplers(g, b, in_deg, out_deg, rvs, v_in_sampler_,
+                     v_out_sampler);
+
+    auto& v_in_sampler = (graph_tool::is_directed(g)) ? v_in_sampler_ : v_out_sampler;
+
+    for (size_t i = 0; i < num_vertices(g); ++i)
+        add_vertex(es);
+
+    uint64_t seed = draw_seed(rng);
+
+    size_t M = rs.shape()[0];
+    bool inconsistent = false;
+    #pragma omp parallel for schedule(static) reduction(||:inconsistent)
+    for (size_t i = 0; i < M; ++i)
+    {
+        size_t r = rs[i];
+        size_t s = ss[i];
+        double p = probs[i];
+        if (p == 0)
+            continue;
+        if (!graph_tool::is_directed(g) && r == s)
+            p /= 2;
+
+        auto& r_sampler = v_out_sampler[r];
+        auto& s_sampler = v_in_sampler[s];
+        counter_rng rng_(seed, i);
+
+        size_t mrs;
+        if (micro_ers)
+        {
+            mrs = p;
+        }
+        else
+        {
+            std::poisson_distribution<> poi(p);
+            mrs = poi(rng_);
+        }
+
+        size_t ers = (&r_sampler != &s_sampler) ? mrs : 2 * mrs;
+        if (!r_sampler.has_n(ers) || !s_sampler.has_n(ers))
+        {
+            inconsistent = true;
+            continue;
+        }
+
+        for (size_t j = 0; j < mrs; ++j)
+        {
+            size_t u = r_sampler.sample(rng_);
+            size_t v = s_sampler.sample(rng_);
+            add_edge(u, v, es);
+        }
+    }
+
+    if (inconsistent)
+        throw GraphException("Inconsistent SBM parameters: node degrees do not agree with matrix of edge counts between groups");
+}
+
 } // graph_tool namespace
 
 #endif // GRAPH_SBM_HH
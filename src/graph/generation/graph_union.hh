@@ -27,6 +27,24 @@ namespace graph_tool
 using namespace std;
 using namespace boost;
 
+// Adds the edges of the (source, target) list to ug, calling f(i, e) for the
+// new descriptor e of the i-th edge, in bulk if possible.
+template <class Graph, class EdgeList, class F>
+void union_add_edges(Graph& ug, const EdgeList& edges, F&& f)
+{
+    for (size_t i = 0; i < edges.size(); ++i)
+        f(i, add_edge(edges[i][0], edges[i][1], ug).first);
+}
+
+template <class Vertex, class EdgeList, class F>
+void union_add_edges(adj_list<Vertex>& ug, const EdgeList& edges, F&& f)
+{
+    add_edges(edges, ug, f);
+}
+
+// The vertices are mapped sequentially, and the edges of g are then listed in
+// parallel, in the order of the out-edges of each vertex, and inserted in
+// bulk, if ug is not a filtered or reversed view.
 struct graph_union
 {
     template <class UnionGraph, class Graph, class VertexMap, class EdgeMap>
@@ -49,13 +67,43 @@ struct graph_union
             }
         }
 
-        for (auto e : edges_range(g))
-            emap[e] = add_edge(vertex(vmap[source(e, g)], ug),
-                               vertex(vmap[target(e, g)], ug), ug).first;
+        typedef typename graph_traits<UnionGraph>::vertex_descriptor u_vertex_t;
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+        size_t N = num_vertices(g);
+        vector<size_t> pos(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 pos[v + 1] = out_degree(v, g);
+             });
+        std::partial_sum(pos.begin(), pos.end(), pos.begin());
+
+        auto uvmap = vmap.get_unchecked();
+        vector<std::array<u_vertex_t, 2>> edges(pos[N]);
+        vector<edge_t> es(pos[N]);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t p = pos[v];
+                 for (auto e : out_edges_range(v, g))
+                 {
+                     edges[p] = {u_vertex_t(vertex(uvmap[v], ug)),
+                                 u_vertex_t(vertex(uvmap[target(e, g)], ug))};
+                     es[p++] = e;
+                 }
+             });
+
+        union_add_edges(ug, edges,
+                        [&](size_t i, const auto& ue) { emap[es[i]] = ue; });
     }
 };
 
-
+// The values are copied in parallel, after the storage of uprop is reserved,
+// or with a single copy of the whole array if the values are trivially
+// copyable, and the descriptors of g are mapped to a contiguous range.
 struct property_union
 {
     template <class UnionGraph, class Graph, class VertexMap, class EdgeMap,
@@ -74,19 +122,86 @@ struct property_union
     void dispatch(UnionGraph& ug, Graph& g, VertexMap vmap, EdgeMap,
                   UnionProp uprop, Prop prop, std::true_type) const
     {
-        for (auto v : vertices_range(g))
-            uprop[vertex(vmap[v], ug)] = prop[v];
+        auto uvmap = vmap.get_unchecked();
+        auto index = get(vertex_index_t(), g);
+        auto uindex = get(vertex_index_t(), ug);
+        copy_values(vertices_range(g),
+                    [&](auto v) { return get(index, v); },
+                    [&](auto v) { return vertex(uvmap[v], ug); },
+                    [&](auto u) { return get(uindex, u); },
+                    [&](auto&& f) { parallel_vertex_loop(g, f); },
+                    uprop, prop);
     }
 
     template <class UnionGraph, class Graph, class VertexMap, class EdgeMap,
               class UnionProp, class Prop>
-    void dispatch(UnionGraph&, Graph& g, VertexMap, EdgeMap emap,
+    void dispatch(UnionGraph& ug, Graph& g, VertexMap, EdgeMap emap,
                   UnionProp uprop, Prop prop, std::false_type) const
     {
-        for (auto e : edges_range(g))
-            uprop[emap[e]] = prop[e];
+        auto uemap = emap.get_unchecked();
+        auto index = get(edge_index_t(), g);
+        auto uindex = get(edge_index_t(), ug);
+        copy_values(edges_range(g),
+                    [&](const auto& e) { return get(index, e); },
+                    [&](const auto& e) { return uemap[e]; },
+                    [&](const auto& e) { return get(uindex, e); },
+                    [&](auto&& f) { parallel_edge_loop(g, f); },
+                    uprop, prop);
     }
 
+    // Copies prop[x] to uprop[ukey(x)] for every x in range. If the value type
+    // is trivially copyable, and the indexes of the keys in g are [0, n), and
+    // shifted by a constant in ug, a single copy is done. Python objects are
+    // copied sequentially.
+    template <class Range, class Index, class UKey, class UIndex, class Loop,
+              class UnionProp, class Prop>
+    void copy_values(Range&& range, Index&& index, UKey&& ukey,
+                     UIndex&& uindex, Loop&& loop, UnionProp uprop,
+                     Prop prop) const
+    {
+        typedef typename property_traits<UnionProp>::value_type val_t;
+        constexpr bool trivial =
+            std::is_trivially_copyable<val_t>::value &&
+            std::is_same<val_t,
+                         typename property_traits<Prop>::value_type>::value;
+
+        size_t M = 0, n = 0, m = 0;
+        int64_t offset = 0;
+        bool shifted = true;
+        for (auto&& x : range)
+        {
+            size_t i = index(x), j = uindex(ukey(x));
+            if (n == 0)
+                offset = int64_t(j) - int64_t(i);
+            shifted = shifted && (int64_t(j) - int64_t(i) == offset);
+            M = std::max(M, j + 1);
+            m = std::max(m, i + 1);
+            ++n;
+        }
+
+        uprop.reserve(M);
+
+        if (trivial && shifted && n > 0 && m == n &&
+            prop.get_storage().size() >= n)
+        {
+            auto& src = prop.get_storage();
+            auto& tgt = uprop.get_storage();
+            std::copy(src.begin(), src.begin() + n, tgt.begin() + offset);
+            return;
+        }
+
+        auto prop_u = prop.get_unchecked();
+        auto copy = [&](auto&& x) { uprop[ukey(x)] = prop_u[x]; };
+        if (std::is_same<val_t, boost::python::object>::value)
+        {
+            for (auto&& x : range)
+                copy(x);
+        }
+        else
+        {
+            loop(copy);
+        }
+    }
 };
 
 } // graph_tool namespace
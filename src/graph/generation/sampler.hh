@@ -82,10 +82,13 @@ public:
 
     Sampler() {}
 
+    // the sampler is not modified, so that it can be called concurrently
+    // from several threads
     template <class RNG>
-    const Value& sample(RNG& rng)
+    const Value& sample(RNG& rng) const
     {
-        size_t i = _sample(rng);
+        uniform_int_distribution<size_t> sample(_sample.param());
+        size_t i = sample(rng);
         bernoulli_distribution coin(_probs[i]);
         if (coin(rng))
             return _items[i];
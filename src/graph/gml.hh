@@ -18,16 +18,8 @@
 #ifndef GML_HH
 #define GML_HH
 
-#include <boost/config/warning_disable.hpp>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/spirit/include/phoenix_core.hpp>
-#include <boost/spirit/include/phoenix_operator.hpp>
-#include <boost/spirit/include/phoenix_fusion.hpp>
-#include <boost/spirit/include/phoenix_stl.hpp>
-#include <boost/fusion/include/adapt_struct.hpp>
 #include <boost/variant/recursive_variant.hpp>
 #include <boost/variant/get.hpp>
-#include <boost/spirit/include/support_istream_iterator.hpp>
 #include <boost/foreach.hpp>
 #include <boost/type_traits.hpp>
 
@@ -45,6 +37,11 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <locale>
+#include <sstream>
 
 #include <unordered_map>
 
@@ -283,63 +280,210 @@ private:
 };
 
 
-template <class Iterator, class Graph, class Skipper>
-struct gml : spirit::qi::grammar<Iterator, void(), Skipper>
+// Hand-written tokenizer for the GML syntax. The input is read in large
+// blocks, and the keys and values are passed to gml_state as they are found.
+template <class Graph>
+class gml_reader
 {
-    gml(Graph& g, dynamic_properties& dp,
-        const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
-        const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>(),
-        const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>())
-        : gml::base_type(start), _state(g, dp, ignore_vp, ignore_ep, ignore_gp)
+public:
+    gml_reader(istream& in, gml_state<Graph>& state)
+        : _in(in), _state(state), _pos(0)
     {
-        using namespace spirit;
-        using spirit::ascii::char_;
-
-        unesc_str = spirit::lexeme['"' >> *(unesc_char | (spirit::qi::graph - "\"") |
-                                            spirit::qi::space | "\\x" >> qi::hex) >> '"'];
-        unesc_char.add("\\a", '\a')("\\b", '\b')("\\f", '\f')("\\n", '\n')
-            ("\\r", '\r')("\\t", '\t')("\\v", '\v')("\\\\", '\\')
-            ("\\\'", '\'')("\\\"", '\"');
-        key_identifier %= spirit::lexeme[((+((spirit::qi::alnum | "_") | "-")) >> *spirit::qi::alnum)];
-        key = key_identifier
-            [boost::bind(&gml_state<Graph>::push_key, &_state, ::_1)];
-        value_identifier %= (spirit::lexeme[spirit::qi::double_] | unesc_str);
-        value %= value_identifier
-            [boost::bind(&gml_state<Graph>::push_value, &_state, ::_1)];
-        list_identifier = *(key >> (value | "[" >> list >> "]"));
-        list = list_identifier
-            [boost::bind(&gml_state<Graph>::finish_list, &_state)];
-        start = list;
+        // numbers always use a decimal point, regardless of the global locale
+        _num.imbue(std::locale::classic());
     }
 
-    typedef boost::variant<std::string, double> val_t;
+    void parse()
+    {
+        size_t depth = 0;
+        while (true)
+        {
+            skip_space();
+            if (eof())
+                break;
+            char c = peek();
+            if (c == ']')
+            {
+                if (depth == 0)
+                    throw gml_parse_error("invalid syntax: unbalanced ']'");
+                get();
+                _state.finish_list();
+                depth--;
+                continue;
+            }
 
-    spirit::qi::rule<Iterator, std::string(), Skipper> unesc_str;
-    spirit::qi::symbols<char const, char const> unesc_char;
-    spirit::qi::rule<Iterator, std::string(), Skipper> key, key_identifier;
-    spirit::qi::rule<Iterator, val_t(), Skipper> value, value_identifier;
-    spirit::qi::rule<Iterator, void(), Skipper> list, list_identifier;
-    spirit::qi::rule<Iterator, void(), Skipper> start;
+            _state.push_key(read_key());
 
-    gml_state<Graph> _state;
-};
+            skip_space();
+            if (eof())
+                throw gml_parse_error("invalid syntax: missing value");
+            c = peek();
+            if (c == '[')
+            {
+                get();
+                depth++;
+            }
+            else if (c == '"')
+            {
+                get();
+                _state.push_value(read_string());
+            }
+            else
+            {
+                _state.push_value(read_number());
+            }
+        }
+        if (depth != 0)
+            throw gml_parse_error("invalid syntax: unbalanced '['");
+        _state.finish_list();
+    }
 
-template <class Iterator, class Graph, class Skipper>
-bool parse_grammar(Iterator begin, Iterator end, Graph& g,
-                   dynamic_properties& dp, Skipper skip,
-                   const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
-                   const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>(),
-                   const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>())
-{
-    using namespace spirit;
-    gml<spirit::istream_iterator, Graph, Skipper> parser(g, dp, ignore_vp,
-                                                         ignore_ep, ignore_gp);
-    bool ok = qi::phrase_parse(begin, end, parser, skip);
-    if (!ok)
-        throw gml_parse_error("invalid syntax");
-    return parser._state.is_directed();
-}
+private:
+    bool eof()
+    {
+        if (_pos < _buf.size())
+            return false;
+        _buf.resize(_block_size);
+        _in.read(&_buf[0], _block_size);
+        _buf.resize(_in.gcount());
+        _pos = 0;
+        return _buf.empty();
+    }
+
+    char peek() { return _buf[_pos]; }
+    char get() { return _buf[_pos++]; }
+
+    void skip_space()
+    {
+        while (!eof())
+        {
+            char c = peek();
+            if (c == '#')
+            {
+                while (!eof() && get() != '\n');
+            }
+            else if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                _pos++;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
 
+    static bool is_key_char(char c)
+    {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+            c == '-';
+    }
+
+    std::string read_key()
+    {
+        std::string key;
+        while (!eof() && is_key_char(peek()))
+            key.push_back(get());
+        if (key.empty())
+            throw gml_parse_error("invalid syntax: expected key, got '" +
+                                  std::string(1, peek()) + "'");
+        return key;
+    }
+
+    std::string read_string()
+    {
+        std::string val;
+        while (true)
+        {
+            if (eof())
+                throw gml_parse_error("invalid syntax: unterminated string");
+            char c = get();
+            if (c == '"')
+                break;
+            if (c != '\\' || eof())
+            {
+                val.push_back(c);
+                continue;
+            }
+            switch (peek())
+            {
+            case 'a':  val.push_back('\a'); break;
+            case 'b':  val.push_back('\b'); break;
+            case 'f':  val.push_back('\f'); break;
+            case 'n':  val.push_back('\n'); break;
+            case 'r':  val.push_back('\r'); break;
+            case 't':  val.push_back('\t'); break;
+            case 'v':  val.push_back('\v'); break;
+            case '\\': val.push_back('\\'); break;
+            case '\'': val.push_back('\''); break;
+            case '"':  val.push_back('"');  break;
+            case 'x':
+                {
+                    get();
+                    unsigned int x = 0;
+                    while (!eof() && std::isxdigit(static_cast<unsigned char>(peek())))
+                    {
+                        char d = get();
+                        x = x * 16 + (std::isdigit(static_cast<unsigned char>(d)) ?
+                                      d - '0' : std::tolower(d) - 'a' + 10);
+                    }
+                    val.push_back(char(x));
+                    continue;
+                }
+            default:
+                // not an escape sequence
+                val.push_back(c);
+                continue;
+            }
+            get();
+        }
+        return val;
+    }
+
+    double read_number()
+    {
+        std::string tok;
+        while (!eof())
+        {
+            char c = peek();
+            if (std::isspace(static_cast<unsigned char>(c)) || c == '[' ||
+                c == ']' || c == '"' || c == '#')
+                break;
+            tok.push_back(get());
+        }
+        double x;
+        _num.clear();
+        _num.str(tok);
+        if (!(_num >> x) || _num.get() != std::char_traits<char>::eof())
+        {
+            // the special values accepted by strtod()
+            std::string t = tok;
+            bool neg = !t.empty() && t[0] == '-';
+            if (!t.empty() && (t[0] == '-' || t[0] == '+'))
+                t.erase(0, 1);
+            for (auto& c : t)
+                c = std::tolower(static_cast<unsigned char>(c));
+            if (t == "inf" || t == "infinity")
+                x = std::numeric_limits<double>::infinity();
+            else if (t == "nan")
+                x = std::numeric_limits<double>::quiet_NaN();
+            else
+                throw gml_parse_error("invalid syntax: invalid value '" +
+                                      tok + "'");
+            if (neg)
+                x = -x;
+        }
+        return x;
+    }
+
+    static constexpr size_t _block_size = 1 << 20;
+
+    istream& _in;
+    gml_state<Graph>& _state;
+    std::string _buf;
+    size_t _pos;
+    std::istringstream _num;
+};
 
 template <class Graph>
 bool read_gml(istream& in, Graph& g, dynamic_properties& dp,
@@ -347,18 +491,10 @@ bool read_gml(istream& in, Graph& g, dynamic_properties& dp,
               const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>(),
               const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>())
 {
-    using namespace spirit;
-
-    in >> std::noskipws;
-    spirit::istream_iterator begin(in);
-    spirit::istream_iterator end;
-
-    bool directed =
-        parse_grammar(begin, end, g, dp,
-                      (ascii::space |'#' >> *(ascii::char_ - qi::eol) >> qi::eol),
-                      ignore_vp, ignore_ep, ignore_gp);
-
-    return directed;
+    gml_state<Graph> state(g, dp, ignore_vp, ignore_ep, ignore_gp);
+    gml_reader<Graph> reader(in, state);
+    reader.parse();
+    return state.is_directed();
 }
 
 struct get_str
@@ -422,10 +558,10 @@ void write_gml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
                           (std::is_convertible<directed_category*,
                                                directed_tag*>::value));
 
-    out << "graph [" << endl;
+    out << "graph [" << "\n";
 
     if (graph_is_directed)
-        out << "   directed " << 1 << endl;
+        out << "   directed " << 1 << "\n";
 
     for (auto& i : dp)
     {
@@ -435,14 +571,14 @@ void write_gml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
                                                      graph_property_tag());
             if (val.empty())
                 continue;
-            out << "   " << i.first << " " << val << endl;
+            out << "   " << i.first << " " << val << "\n";
         }
     }
 
     for (auto v : vertices_range(g))
     {
-        out << "   node [" << endl;
-        out << "      id " << get(vertex_index, v) << endl;
+        out << "   node [" << "\n";
+        out << "      id " << get(vertex_index, v) << "\n";
 
         for (auto& i : dp)
         {
@@ -451,19 +587,19 @@ void write_gml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
                 std::string val = print_val<value_types>(*i.second, v);
                 if (val.empty())
                     continue;
-                out << "      " << i.first << " " << val << endl;
+                out << "      " << i.first << " " << val << "\n";
             }
         }
-        out << "   ]" << endl;
+        out << "   ]" << "\n";
     }
 
     typename graph_traits<Graph>::edges_size_type edge_count = 0;
     for (auto e : edges_range(g))
     {
-        out << "   edge [" << endl;
-        out << "      id " << edge_count++ << endl;
-        out << "      source " << get(vertex_index, source(e, g)) << endl;
-        out << "      target " << get(vertex_index, target(e, g)) << endl;
+        out << "   edge [" << "\n";
+        out << "      id " << edge_count++ << "\n";
+        out << "      source " << get(vertex_index, source(e, g)) << "\n";
+        out << "      target " << get(vertex_index, target(e, g)) << "\n";
 
         for (auto& i : dp)
         {
@@ -472,12 +608,12 @@ void write_gml(std::ostream& out, const Graph& g, VertexIndexMap vertex_index,
                 std::string val = print_val<value_types>(*i.second, e);
                 if (val.empty())
                     continue;
-                out << "      " << i.first << " " << val << endl;
+                out << "      " << i.first << " " << val << "\n";
             }
         }
-        out << "   ]" << endl;
+        out << "   ]" << "\n";
     }
-    out << "]" << endl;
+    out << "]" << "\n";
 }
 
 
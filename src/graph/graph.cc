@@ -113,3 +113,18 @@ void GraphInterface::clear_edges()
 {
     run_action<>()(*this, std::bind(do_clear_edges(), std::placeholders::_1))();
 }
+
+// memory held by the graph structure, the filters and the frozen snapshot, in
+// bytes; property maps are accounted for separately
+python::dict GraphInterface::memory_usage() const
+{
+    python::dict usage;
+    _mg->get_memory_usage([&](const char* name, size_t n)
+                          { usage[name] = n; });
+    usage["vertex_filter"] =
+        _vertex_filter_map.get_storage().capacity() * sizeof(uint8_t);
+    usage["edge_filter"] =
+        _edge_filter_map.get_storage().capacity() * sizeof(uint8_t);
+    usage["frozen"] = (_frozen != nullptr) ? _frozen->get_memory_usage() : 0;
+    return usage;
+}
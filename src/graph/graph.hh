@@ -26,6 +26,7 @@
 #include <deque>
 
 #include "graph_adjacency.hh"
+#include "graph_csr.hh"
 
 #include <boost/graph/graph_traits.hpp>
 
@@ -85,6 +86,8 @@ public:
     bool get_reversed() {return _reversed;}
     void set_keep_epos(bool keep) {_mg->set_keep_epos(keep);}
     bool get_keep_epos() {return _mg->get_keep_epos();}
+    void set_keep_out_index(bool keep) {_mg->set_keep_out_index(keep);}
+    bool get_keep_out_index() {return _mg->get_keep_out_index();}
 
 
     // graph filtering
@@ -95,6 +98,7 @@ public:
 
     // graph modification
     void re_index_edges();
+    void compact_edges(boost::python::object eprops, bool ordered);
     void purge_vertices(boost::any old_index); // removes filtered vertices
     void purge_edges();    // removes filtered edges
     void clear();
@@ -107,6 +111,16 @@ public:
     void copy_edge_property(const GraphInterface& src, boost::any prop_src,
                             boost::any prop_tgt);
     void shrink_to_fit() { _mg->shrink_to_fit(); }
+    void numa_localize() { _mg->numa_localize(); }
+    void reserve(size_t n_vertices, size_t n_edges)
+    { _mg->reserve(n_vertices, n_edges); }
+    boost::python::dict memory_usage() const; // in bytes, per component
+    void materialize(GraphInterface& tgt, boost::any vmap, boost::any emap);
+
+    // frozen CSR snapshot, used by read-only algorithms when available
+    void freeze();
+    void unfreeze();
+    bool is_frozen() const;
 
     //
     // python interface
@@ -119,18 +133,30 @@ public:
 
     // I/O
     void write_to_file(std::string s, boost::python::object pf, std::string format,
-                       boost::python::list properties);
+                       boost::python::list properties, bool compact_adjacency);
     boost::python::tuple read_from_file(std::string s, boost::python::object pf,
                                         std::string format,
                                         boost::python::list ignore_vp,
                                         boost::python::list ignore_ep,
-                                        boost::python::list ignore_gp);
+                                        boost::python::list ignore_gp,
+                                        bool lazy);
+    boost::python::object read_property_from_file(std::string s,
+                                                  int64_t offset);
 
     //
     // Internal types
     //
 
-    typedef boost::adj_list<size_t> multigraph_t;
+    // integer type used for the vertex and edge indexes (see the
+    // --enable-32bit-index configure option)
+#ifdef GRAPH_INDEX_32BIT
+    typedef uint32_t index_t;
+#else
+    typedef size_t index_t;
+#endif
+
+    typedef boost::adj_list<index_t> multigraph_t;
+    typedef boost::csr_adj_list<index_t> frozen_graph_t;
     typedef boost::graph_traits<multigraph_t>::vertex_descriptor vertex_t;
     typedef boost::graph_traits<multigraph_t>::edge_descriptor edge_t;
 
@@ -142,14 +168,18 @@ public:
 
     multigraph_t&      get_graph() {return *_mg;}
     std::shared_ptr<multigraph_t> get_graph_ptr() {return _mg;}
+    std::shared_ptr<frozen_graph_t> get_frozen_graph_ptr() {return _frozen;}
     vertex_index_map_t get_vertex_index()   {return _vertex_index;}
     edge_index_map_t   get_edge_index()     {return _edge_index;}
     size_t             get_edge_index_range() {return _mg->get_edge_index_range();}
+    size_t             get_modification_count() {return _mg->get_modification_count();}
 
     graph_index_map_t  get_graph_index()  {return graph_index_map_t(0);}
 
-    // Gets the encapsulated graph view. See graph_filtering.cc for details
-    boost::any get_graph_view() const;
+    // Gets the encapsulated graph view. See graph_filtering.cc for details. If
+    // allow_frozen is true, the view will be based on the frozen snapshot,
+    // if it exists and no filters are active.
+    boost::any get_graph_view(bool allow_frozen = false) const;
     std::vector<boost::any>& get_graph_views() {return _graph_views;}
 
 private:
@@ -161,6 +191,9 @@ private:
     // this is the main graph
     std::shared_ptr<multigraph_t> _mg;
 
+    // frozen snapshot of the main graph (may be empty)
+    std::shared_ptr<frozen_graph_t> _frozen;
+
     // vertex index map
     vertex_index_map_t _vertex_index;
 
@@ -218,6 +251,39 @@ struct gprop_map_t
         type;
 };
 
+// releases the GIL for the lifetime of the object, if it is held by the
+// calling thread (and release == true)
+class GILRelease
+{
+public:
+    GILRelease(bool release = true)
+        : _state((release && PyGILState_Check()) ? PyEval_SaveThread() : nullptr)
+    {}
+    ~GILRelease() { restore(); }
+
+    void restore()
+    {
+        if (_state == nullptr)
+            return;
+        PyEval_RestoreThread(_state);
+        _state = nullptr;
+    }
+
+private:
+    PyThreadState* _state;
+};
+
+// re-acquires the GIL for the lifetime of the object; this must wrap any
+// access to python objects (e.g. callbacks) from code that may run with the
+// GIL released
+class GILAcquire
+{
+public:
+    GILAcquire() : _state(PyGILState_Ensure()) {}
+    ~GILAcquire() { PyGILState_Release(_state); }
+private:
+    PyGILState_STATE _state;
+};
 
 } //namespace graph_tool
 
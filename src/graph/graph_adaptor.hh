@@ -442,6 +442,15 @@ add_edge(typename graph_traits<undirected_adaptor<Graph> >::vertex_descriptor u,
     return add_edge(u, v, ep, g.original_graph());
 }
 
+//==============================================================================
+// add_edges(edges, g)
+//==============================================================================
+template <class Graph, class EdgeList>
+inline void add_edges(const EdgeList& edges, undirected_adaptor<Graph>& g)
+{
+    add_edges(edges, g.original_graph());
+}
+
 //==============================================================================
 // remove_edge(u,v,g)
 //==============================================================================
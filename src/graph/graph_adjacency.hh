@@ -18,6 +18,8 @@
 #ifndef GRAPH_ADJACENCY_HH
 #define GRAPH_ADJACENCY_HH
 
+#include "config.h"
+
 #include <vector>
 #include <deque>
 #include <utility>
@@ -34,6 +36,7 @@
 #include <boost/iterator/iterator_facade.hpp>
 
 #include "transform_iterator.hh"
+#include "graph_adjacency_alloc.hh"
 
 namespace boost
 {
@@ -45,6 +48,12 @@ namespace boost
 template <class Vertex>
 class adj_list;
 
+// The vertex arguments of the functions below are not used for template
+// argument deduction, so that they can be called with any integer type,
+// independently of the Vertex type of the graph.
+template <class Vertex>
+using adj_vertex_t = typename adj_list<Vertex>::vertex_t;
+
 // forward declaration of manipulation functions
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::vertex_iterator,
@@ -58,66 +67,66 @@ edges(const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-edge(Vertex s, Vertex t, const adj_list<Vertex>& g);
+edge(adj_vertex_t<Vertex> s, adj_vertex_t<Vertex> t, const adj_list<Vertex>& g);
 
 template <class Vertex>
-size_t out_degree(Vertex v, const adj_list<Vertex>& g);
+size_t out_degree(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
-size_t in_degree(Vertex v, const adj_list<Vertex>& g);
+size_t in_degree(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
-size_t degree(Vertex v, const adj_list<Vertex>& g);
+size_t degree(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::out_edge_iterator,
           typename adj_list<Vertex>::out_edge_iterator>
-out_edges(Vertex v, const adj_list<Vertex>& g);
+out_edges(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::in_edge_iterator,
           typename adj_list<Vertex>::in_edge_iterator>
-in_edges(Vertex v, const adj_list<Vertex>& g);
+in_edges(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::out_edge_iterator,
           typename adj_list<Vertex>::out_edge_iterator>
-_all_edges_out(Vertex v, const adj_list<Vertex>& g);
+_all_edges_out(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::in_edge_iterator,
           typename adj_list<Vertex>::in_edge_iterator>
-_all_edges_in(Vertex v, const adj_list<Vertex>& g);
+_all_edges_in(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::all_edge_iterator,
           typename adj_list<Vertex>::all_edge_iterator>
-all_edges(Vertex v, const adj_list<Vertex>& g);
+all_edges(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::all_edge_iterator_reversed,
           typename adj_list<Vertex>::all_edge_iterator_reversed>
-_all_edges_reversed(Vertex v, const adj_list<Vertex>& g);
+_all_edges_reversed(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-adjacent_vertices(Vertex v, const adj_list<Vertex>& g);
+adjacent_vertices(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-out_neighbors(Vertex v, const adj_list<Vertex>& g);
+out_neighbors(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-in_neighbors(Vertex v, const adj_list<Vertex>& g);
+in_neighbors(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-all_neighbors(Vertex v, const adj_list<Vertex>& g);
+all_neighbors(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g);
 
 template <class Vertex>
 size_t num_vertices(const adj_list<Vertex>& g);
@@ -129,23 +138,30 @@ template <class Vertex>
 Vertex add_vertex(adj_list<Vertex>& g);
 
 template <class Vertex>
-void clear_vertex(Vertex v, adj_list<Vertex>& g);
+void clear_vertex(adj_vertex_t<Vertex> v, adj_list<Vertex>& g);
 
 template <class Vertex, class Pred>
-void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred);
+void clear_vertex(adj_vertex_t<Vertex> v, adj_list<Vertex>& g, Pred&& pred);
 
 template <class Vertex>
-void remove_vertex(Vertex v, adj_list<Vertex>& g);
+void remove_vertex(adj_vertex_t<Vertex> v, adj_list<Vertex>& g);
 
 template <class Vertex>
-void remove_vertex_fast(Vertex v, adj_list<Vertex>& g);
+void remove_vertex_fast(adj_vertex_t<Vertex> v, adj_list<Vertex>& g);
 
 template <class Vertex>
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-add_edge(Vertex s, Vertex t, adj_list<Vertex>& g);
+add_edge(adj_vertex_t<Vertex> s, adj_vertex_t<Vertex> t, adj_list<Vertex>& g);
+
+template <class Vertex, class EdgeList, class F>
+void add_edges(const EdgeList& edges, adj_list<Vertex>& g, F&& f);
+
+template <class Vertex, class Pred>
+size_t remove_edges_if(Pred&& pred, adj_list<Vertex>& g);
 
 template <class Vertex>
-void remove_edge(Vertex s, Vertex t, adj_list<Vertex>& g);
+void remove_edge(adj_vertex_t<Vertex> s, adj_vertex_t<Vertex> t,
+                 adj_list<Vertex>& g);
 
 template <class Vertex>
 void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
@@ -164,7 +180,10 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
 // (same) edge index in both lists. The integer type is given by the Vertex
 // template parameter. It achieves about half as much memory as
 // boost::adjacency_list with an edge index property map and the same integer
-// type.
+// type. (The main graph uses size_t by default, or uint32_t if graph-tool is
+// configured with --enable-32bit-index, which halves the memory again.) The
+// per-vertex edge lists can be allocated from a huge-page arena instead of the
+// global heap, with --enable-edge-arena (see graph_adjacency_alloc.hh).
 
 // The complexity guarantees and iterator invalidation rules are the same as
 // boost::adjacency_list with vector storage selectors for both vertex and edge
@@ -208,11 +227,13 @@ public:
 
     typedef detail::adj_edge_descriptor<Vertex> edge_descriptor;
 
-    typedef std::vector<std::pair<vertex_t, vertex_t> > edge_list_t;
+    typedef std::vector<std::pair<vertex_t, vertex_t>,
+                        edge_allocator<std::pair<vertex_t, vertex_t>>> edge_list_t;
     typedef std::vector<std::pair<size_t, edge_list_t>> vertex_list_t;
     typedef typename integer_range<Vertex>::iterator vertex_iterator;
 
-    adj_list(): _n_edges(0), _edge_index_range(0), _keep_epos(false) {}
+    adj_list(): _n_edges(0), _edge_index_range(0), _mod_count(0),
+                _keep_epos(false), _keep_out_index(false) {}
 
     struct get_vertex
     {
@@ -398,6 +419,7 @@ public:
 
     void reindex_edges()
     {
+        ++_mod_count;
         _free_indexes.clear();
         _edge_index_range = 0;
         for (auto& es : _edges)
@@ -418,6 +440,103 @@ public:
 
         if (_keep_epos)
             rebuild_epos();
+        if (_keep_out_index)
+            rebuild_out_index();
+    }
+
+    // Renumber the edge indexes densely in the [0, E) range, preserving their
+    // relative order and the adjacency lists, and release all unused
+    // capacity. The vector old_index is filled with the previous index of each
+    // edge, indexed by its new one, so that edge property maps can be
+    // remapped. O(V + E + I), where I is the edge index range.
+    void compact(std::vector<Vertex>& old_index)
+    {
+        ++_mod_count;
+        size_t N = _edges.size();
+        std::vector<Vertex> new_index(_edge_index_range, null_vertex());
+
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto pos = _edges[v].first;
+            auto& es = _edges[v].second;
+            for (size_t j = 0; j < pos; ++j)
+                new_index[es[j].second] = 0;
+        }
+
+        old_index.clear();
+        old_index.reserve(_n_edges);
+        for (size_t i = 0; i < _edge_index_range; ++i)
+        {
+            if (new_index[i] == null_vertex())
+                continue;
+            new_index[i] = old_index.size();
+            old_index.push_back(i);
+        }
+
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto& es = _edges[v].second;
+            for (auto& e : es)
+                e.second = new_index[e.second];
+            es.shrink_to_fit();
+        }
+        _edges.shrink_to_fit();
+
+        if (_keep_epos)
+        {
+            // the positions in the lists are unchanged, and old_index[i] >= i
+            for (size_t i = 0; i < old_index.size(); ++i)
+                _epos[i] = _epos[old_index[i]];
+            _epos.resize(old_index.size());
+            _epos.shrink_to_fit();
+            //check_epos();
+        }
+
+        _edge_index_range = _n_edges;
+        _free_indexes.clear();
+        _free_indexes.shrink_to_fit();
+
+        if (_keep_out_index)
+            rebuild_out_index();
+    }
+
+    // Like compact(), but the edges are renumbered in the order of the
+    // adjacency lists, i.e. in the order they are traversed by edges(), which
+    // is also the order in which they are stored in files.
+    void compact_ordered(std::vector<Vertex>& old_index)
+    {
+        old_index.clear();
+        old_index.reserve(_n_edges);
+        for (auto& es : _edges)
+            for (size_t j = 0; j < es.first; ++j)
+                old_index.push_back(es.second[j].second);
+
+        reindex_edges();
+
+        for (auto& es : _edges)
+            es.second.shrink_to_fit();
+        _edges.shrink_to_fit();
+        _free_indexes.shrink_to_fit();
+        if (_keep_epos)
+            _epos.shrink_to_fit();
+    }
+
+    // Reallocate the edge lists of the vertices in parallel, with the same
+    // static partition of the vertices used by the parallel loops, so that
+    // (with threads pinned to CPUs) each list is placed on the NUMA node of
+    // the thread which will traverse it.
+    void numa_localize()
+    {
+        size_t N = _edges.size();
+        #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            auto& es = _edges[v].second;
+            edge_list_t nes(es.begin(), es.end());
+            es.swap(nes);
+        }
     }
 
     void set_keep_epos(bool keep)
@@ -439,15 +558,82 @@ public:
         return _keep_epos;
     }
 
+    // If enabled, the out-edges of vertices with large out-degree are kept
+    // in a sorted index, so that edge(s, t, g) becomes O(log k) instead of
+    // O(k). This requires an additional O(E) memory, and the insertion and
+    // removal of edges for these vertices becomes O(k).
+    void set_keep_out_index(bool keep)
+    {
+        if (keep)
+        {
+            if (!_keep_out_index)
+            {
+                _keep_out_index = true;
+                rebuild_out_index();
+            }
+        }
+        else
+        {
+            _out_index.clear();
+            _out_index.shrink_to_fit();
+            _keep_out_index = false;
+        }
+    }
+
+    bool get_keep_out_index()
+    {
+        return _keep_out_index;
+    }
+
     size_t get_edge_index_range() const { return _edge_index_range; }
 
+    // incremented by every operation that changes the vertices, the edges or
+    // the edge indices
+    size_t get_modification_count() const { return _mod_count; }
+
+    // reports the memory held by each internal container, as f(name, bytes),
+    // including any capacity that is allocated but unused
+    template <class F>
+    void get_memory_usage(F&& f) const
+    {
+        size_t n = _edges.capacity() * sizeof(typename vertex_list_t::value_type);
+        for (auto& es : _edges)
+            n += es.second.capacity() * sizeof(typename edge_list_t::value_type);
+        f("edge_lists", n);
+        f("edge_positions", _epos.capacity() * sizeof(typename decltype(_epos)::value_type));
+        f("free_indexes", _free_indexes.size() * sizeof(size_t));
+        n = _out_index.capacity() * sizeof(edge_list_t);
+        for (auto& es : _out_index)
+            n += es.capacity() * sizeof(typename edge_list_t::value_type);
+        f("out_index", n);
+    }
+
     static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
 
+    // reserve space for n_vertices vertices and n_edges edges in total, to
+    // avoid reallocation while the graph is built incrementally; the
+    // individual adjacency lists still grow on demand
+    void reserve(size_t n_vertices, size_t n_edges)
+    {
+        _edges.reserve(n_vertices);
+        if (_keep_epos)
+            _epos.reserve(n_edges);
+        if (_keep_out_index)
+            _out_index.reserve(n_vertices);
+    }
+
     void shrink_to_fit()
     {
         _edges.shrink_to_fit();
-        std::for_each(_edges.begin(), _edges.end(),
-                      [](auto &es){es.second.shrink_to_fit();});
+        size_t N = _edges.size();
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            _edges[i].second.shrink_to_fit();
+            if (i < _out_index.size())
+                _out_index[i].shrink_to_fit();
+        }
+        _out_index.shrink_to_fit();
         auto erange = boost::edges(*this);
         auto iter = std::max_element(erange.first, erange.second,
                                      [](const auto &a, const auto& b) -> bool
@@ -499,12 +685,91 @@ private:
     vertex_list_t _edges;
     size_t _n_edges;
     size_t _edge_index_range;
+    size_t _mod_count;
     std::deque<size_t> _free_indexes; // indexes of deleted edges to be used up
                                       // for new edges to avoid very large
                                       // indexes, and unnecessary property map
                                       // memory use
     bool _keep_epos;
     std::vector<std::pair<uint32_t, uint32_t>> _epos; // out, in
+    bool _keep_out_index;
+    std::vector<edge_list_t> _out_index; // sorted (target, idx) pairs
+    static constexpr size_t _out_index_min_degree = 64;
+
+    void rebuild_out_index(size_t v)
+    {
+        auto& oes = _out_index[v];
+        auto pos = _edges[v].first;
+        if (pos < _out_index_min_degree)
+        {
+            oes.clear();
+            oes.shrink_to_fit();
+            return;
+        }
+        auto& es = _edges[v].second;
+        oes.assign(es.begin(), es.begin() + pos);
+        std::sort(oes.begin(), oes.end());
+    }
+
+    void rebuild_out_index()
+    {
+        size_t N = _edges.size();
+        _out_index.resize(N);
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+            rebuild_out_index(v);
+    }
+
+    void out_index_insert(Vertex s, Vertex t, Vertex idx)
+    {
+        if (_out_index[s].empty())
+        {
+            if (_edges[s].first >= _out_index_min_degree)
+                rebuild_out_index(s);
+            return;
+        }
+        auto& oes = _out_index[s];
+        std::pair<Vertex, Vertex> e(t, idx);
+        oes.insert(std::upper_bound(oes.begin(), oes.end(), e), e);
+    }
+
+    void out_index_erase(Vertex s, Vertex t, Vertex idx)
+    {
+        if (_out_index[s].empty())
+            return;
+        auto& oes = _out_index[s];
+        if (_edges[s].first < _out_index_min_degree)
+        {
+            oes.clear();
+            oes.shrink_to_fit();
+            return;
+        }
+        std::pair<Vertex, Vertex> e(t, idx);
+        auto iter = std::lower_bound(oes.begin(), oes.end(), e);
+        assert(iter != oes.end() && *iter == e);
+        oes.erase(iter);
+    }
+
+    // relabel target "old" as "new" in the index of vertex s, assuming s has
+    // no out-edges to "new"
+    void out_index_relabel(Vertex s, Vertex old, Vertex new_)
+    {
+        auto& oes = _out_index[s];
+        auto cmp = [](const auto& a, const auto& b) { return a.first < b.first; };
+        auto r = std::equal_range(oes.begin(), oes.end(),
+                                  std::make_pair(old, Vertex(0)), cmp);
+        if (r.first == r.second)
+            return;
+        for (auto iter = r.first; iter != r.second; ++iter)
+            iter->first = new_;
+        auto e = std::make_pair(new_, Vertex(0));
+        if (new_ < old)
+            std::rotate(std::lower_bound(oes.begin(), r.first, e, cmp),
+                        r.first, r.second);
+        else
+            std::rotate(r.first, r.second,
+                        std::lower_bound(r.second, oes.end(), e, cmp));
+    }
 
     void rebuild_epos()
     {
@@ -597,7 +862,7 @@ private:
     friend Vertex add_vertex<>(adj_list<Vertex>& g);
 
     template <class V, class Pred>
-    friend void clear_vertex(V v, adj_list<V>& g, Pred&& pred);
+    friend void clear_vertex(adj_vertex_t<V> v, adj_list<V>& g, Pred&& pred);
 
     friend void remove_vertex<>(Vertex v, adj_list<Vertex>& g);
 
@@ -606,6 +871,12 @@ private:
     friend std::pair<edge_descriptor, bool>
     add_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
 
+    template <class V, class EdgeList, class F>
+    friend void add_edges(const EdgeList& edges, adj_list<V>& g, F&& f);
+
+    template <class V, class Pred>
+    friend size_t remove_edges_if(Pred&& pred, adj_list<V>& g);
+
     friend void remove_edge<>(Vertex s, Vertex t, adj_list<Vertex>& g);
 
     friend void remove_edge<>(const edge_descriptor& e, adj_list<Vertex>& g);
@@ -735,9 +1006,18 @@ Vertex vertex(size_t i, const adj_list<Vertex>&)
 template <class Vertex>
 inline
 std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-edge(Vertex s, Vertex t, const adj_list<Vertex>& g)
+edge(adj_vertex_t<Vertex> s, adj_vertex_t<Vertex> t, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
+    if (g._keep_out_index && !g._out_index[s].empty())
+    {
+        const auto& oes = g._out_index[s];
+        auto iter = std::lower_bound(oes.begin(), oes.end(),
+                                     std::make_pair(Vertex(t), Vertex(0)));
+        if (iter != oes.end() && iter->first == t)
+            return {edge_descriptor(s, t, iter->second), true};
+        return {edge_descriptor(), false};
+    }
     const auto& pes = g._edges[s];
     auto pos = pes.first;
     const auto& es = pes.second;
@@ -751,7 +1031,7 @@ edge(Vertex s, Vertex t, const adj_list<Vertex>& g)
 
 template <class Vertex>
 inline __attribute__((always_inline))
-size_t out_degree(Vertex v, const adj_list<Vertex>& g)
+size_t out_degree(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     const auto& pes = g._edges[v];
     return pes.first;
@@ -759,7 +1039,7 @@ size_t out_degree(Vertex v, const adj_list<Vertex>& g)
 
 template <class Vertex>
 inline __attribute__((always_inline))
-size_t in_degree(Vertex v, const adj_list<Vertex>& g)
+size_t in_degree(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     const auto& pes = g._edges[v];
     auto pos = pes.first;
@@ -769,7 +1049,7 @@ size_t in_degree(Vertex v, const adj_list<Vertex>& g)
 
 template <class Vertex>
 inline __attribute__((always_inline))
-size_t degree(Vertex v, const adj_list<Vertex>& g)
+size_t degree(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     return g._edges[v].second.size();
 }
@@ -778,7 +1058,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::out_edge_iterator,
           typename adj_list<Vertex>::out_edge_iterator>
-out_edges(Vertex v, const adj_list<Vertex>& g)
+out_edges(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::out_edge_iterator ei_t;
     const auto& pes = g._edges[v];
@@ -791,7 +1071,7 @@ template <class Vertex>
 inline  __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::in_edge_iterator,
           typename adj_list<Vertex>::in_edge_iterator>
-in_edges(Vertex v, const adj_list<Vertex>& g)
+in_edges(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::in_edge_iterator ei_t;
     const auto& pes = g._edges[v];
@@ -804,7 +1084,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::out_edge_iterator,
           typename adj_list<Vertex>::out_edge_iterator>
-_all_edges_out(Vertex v, const adj_list<Vertex>& g)
+_all_edges_out(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::out_edge_iterator ei_t;
     const auto& pes = g._edges[v];
@@ -816,7 +1096,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::in_edge_iterator,
           typename adj_list<Vertex>::in_edge_iterator>
-_all_edges_in(Vertex v, const adj_list<Vertex>& g)
+_all_edges_in(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::in_edge_iterator ei_t;
     const auto& pes = g._edges[v];
@@ -828,7 +1108,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::all_edge_iterator,
           typename adj_list<Vertex>::all_edge_iterator>
-all_edges(Vertex v, const adj_list<Vertex>& g)
+all_edges(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::all_edge_iterator ei_t;
     const auto& pes = g._edges[v];
@@ -841,7 +1121,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::all_edge_iterator_reversed,
           typename adj_list<Vertex>::all_edge_iterator_reversed>
-_all_edges_reversed(Vertex v, const adj_list<Vertex>& g)
+_all_edges_reversed(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::all_edge_iterator_reversed ei_t;
     const auto& pes = g._edges[v];
@@ -854,7 +1134,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-out_neighbors(Vertex v, const adj_list<Vertex>& g)
+out_neighbors(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::adjacency_iterator ai_t;
     const auto& pes = g._edges[v];
@@ -867,7 +1147,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-in_neighbors(Vertex v, const adj_list<Vertex>& g)
+in_neighbors(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::adjacency_iterator ai_t;
     const auto& pes = g._edges[v];
@@ -880,7 +1160,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-all_neighbors(Vertex v, const adj_list<Vertex>& g)
+all_neighbors(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     typedef typename adj_list<Vertex>::adjacency_iterator ai_t;
     const auto& pes = g._edges[v];
@@ -892,7 +1172,7 @@ template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 std::pair<typename adj_list<Vertex>::adjacency_iterator,
           typename adj_list<Vertex>::adjacency_iterator>
-adjacent_vertices(Vertex v, const adj_list<Vertex>& g)
+adjacent_vertices(adj_vertex_t<Vertex> v, const adj_list<Vertex>& g)
 {
     return out_neighbors(v, g);
 }
@@ -915,8 +1195,10 @@ size_t num_edges(const adj_list<Vertex>& g)
 
 template <class Vertex>
 typename std::pair<typename adj_list<Vertex>::edge_descriptor, bool>
-add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
+add_edge(adj_vertex_t<Vertex> s, adj_vertex_t<Vertex> t, adj_list<Vertex>& g)
 {
+    ++g._mod_count;
+
     // get index from free list, if available
     Vertex idx;
     if (g._free_indexes.empty())
@@ -967,12 +1249,178 @@ add_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
         //g.check_epos();
     }
 
+    if (g._keep_out_index)
+        g.out_index_insert(s, t, idx);
+
     typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
     return {edge_descriptor(s, t, idx), true};
 }
 
+// Bulk insertion of the edges given by the (source, target) pairs in the
+// random-access container "edges", such that edges[i][0] and edges[i][1] are
+// the source and target of the i-th edge. All vertices must already exist. The
+// result is identical to calling add_edge() for every pair in sequence, i.e.
+// the edges obtain the same indexes and appear in the same order in the
+// adjacency lists, but the per-vertex lists are reserved exactly and filled in
+// parallel. After insertion, f(i, e) is called sequentially for every new edge
+// descriptor e, in the order of the list. O(V + E)
+template <class Vertex, class EdgeList, class F>
+void add_edges(const EdgeList& edges, adj_list<Vertex>& g, F&& f)
+{
+    typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
+
+    ++g._mod_count;
+
+    size_t N = g._edges.size();
+    size_t E = edges.size();
+    if (E == 0)
+        return;
+
+    // the i-th new edge takes the i-th free index, if available, as add_edge()
+    // would
+    size_t n_free = std::min(g._free_indexes.size(), E);
+    std::vector<size_t> free_idx(g._free_indexes.begin(),
+                                 g._free_indexes.begin() + n_free);
+    size_t range = g._edge_index_range;
+    auto get_idx = [&](size_t i) -> size_t
+        {
+            return (i < n_free) ? free_idx[i] : range + (i - n_free);
+        };
+
+    // count the new out- and in-edges of each vertex
+    std::vector<size_t> k_out(N), k_in(N);
+    for (size_t i = 0; i < E; ++i)
+    {
+        Vertex s = edges[i][0];
+        Vertex t = edges[i][1];
+        k_out[s]++;
+        k_in[t]++;
+    }
+
+    // reserve exactly, and append the new out-edges followed by the new
+    // in-edges at the end of each list; the position in the edge list is
+    // stored temporarily in place of the edge index
+    std::vector<size_t> o_out(N), o_in(N);
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (k_out[v] + k_in[v] == 0)
+            continue;
+        auto& es = g._edges[v].second;
+        o_out[v] = es.size();
+        o_in[v] = o_out[v] + k_out[v];
+        es.reserve(o_in[v] + k_in[v]);
+        es.resize(o_in[v] + k_in[v]);
+    }
+
+    for (size_t i = 0; i < E; ++i)
+    {
+        Vertex s = edges[i][0];
+        Vertex t = edges[i][1];
+        g._edges[s].second[o_out[s]++] = {t, i};
+        g._edges[t].second[o_in[t]++] = {s, i};
+    }
+
+    g._n_edges += E;
+    g._free_indexes.erase(g._free_indexes.begin(),
+                          g._free_indexes.begin() + n_free);
+    g._edge_index_range += E - n_free;
+    if (g._keep_epos)
+        g._epos.resize(g._edge_index_range);
+
+    // replay the insertions of each vertex in the order of the list, exactly
+    // as add_edge() does it
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        typename adj_list<Vertex>::edge_list_t new_es;
+
+        #pragma omp for schedule(runtime)
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (k_out[v] + k_in[v] == 0)
+                continue;
+
+            auto& pos = g._edges[v].first;
+            auto& es = g._edges[v].second;
+
+            size_t n_new = k_out[v] + k_in[v];
+            new_es.assign(es.end() - n_new, es.end());
+            es.resize(es.size() - n_new);
+
+            auto out_iter = new_es.begin();
+            auto out_end = out_iter + k_out[v];
+            auto in_iter = out_end;
+            auto in_end = new_es.end();
+
+            while (out_iter != out_end || in_iter != in_end)
+            {
+                // for self-loops the out-edge is inserted first
+                if (in_iter == in_end ||
+                    (out_iter != out_end && out_iter->second <= in_iter->second))
+                {
+                    auto oe = *out_iter++;
+                    oe.second = get_idx(oe.second);
+                    if (pos < es.size())
+                    {
+                        es.push_back(es[pos]);
+                        es[pos] = oe;
+                    }
+                    else
+                    {
+                        es.push_back(oe);
+                    }
+                    pos++;
+                }
+                else
+                {
+                    auto ie = *in_iter++;
+                    ie.second = get_idx(ie.second);
+                    es.push_back(ie);
+                }
+            }
+
+            if (g._keep_out_index && k_out[v] > 0)
+                g.rebuild_out_index(v);
+        }
+    }
+
+    if (g._keep_epos)
+    {
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            if (k_out[v] + k_in[v] == 0)
+                continue;
+            auto pos = g._edges[v].first;
+            auto& es = g._edges[v].second;
+            for (size_t j = 0; j < es.size(); ++j)
+            {
+                if (j < pos)
+                    g._epos[es[j].second].first = j;
+                else
+                    g._epos[es[j].second].second = j;
+            }
+        }
+        //g.check_epos();
+    }
+
+    for (size_t i = 0; i < E; ++i)
+    {
+        Vertex s = edges[i][0];
+        Vertex t = edges[i][1];
+        f(i, edge_descriptor(s, t, get_idx(i)));
+    }
+}
+
+template <class Vertex, class EdgeList>
+void add_edges(const EdgeList& edges, adj_list<Vertex>& g)
+{
+    add_edges(edges, g, [](size_t, const auto&){});
+}
+
 template <class Vertex>
-void remove_edge(Vertex s, Vertex t, adj_list<Vertex>& g)
+void remove_edge(adj_vertex_t<Vertex> s, adj_vertex_t<Vertex> t,
+                 adj_list<Vertex>& g)
 {
     remove_edge(edge(s, t, g).first, g);
 }
@@ -981,6 +1429,7 @@ template <class Vertex>
 void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
                  adj_list<Vertex>& g)
 {
+    ++g._mod_count;
     auto s = e.s;
     auto t = e.t;
     auto idx = e.idx;
@@ -1042,21 +1491,108 @@ void remove_edge(const typename adj_list<Vertex>::edge_descriptor& e,
         //g.check_epos();
     }
 
+    if (g._keep_out_index)
+        g.out_index_erase(s, t, idx);
+
     g._free_indexes.push_back(idx);
     g._n_edges--;
 }
 
+// Remove all edges e for which pred(e) is true, and return how many were
+// removed. The predicate is evaluated exactly once for every edge, in parallel,
+// so it must be thread-safe. The lists of all vertices are then compacted in a
+// single parallel sweep, preserving the relative order of the remaining
+// edges. O(V + E)
+template <class Vertex, class Pred>
+size_t remove_edges_if(Pred&& pred, adj_list<Vertex>& g)
+{
+    typedef typename adj_list<Vertex>::edge_descriptor edge_descriptor;
+
+    ++g._mod_count;
+
+    size_t N = g._edges.size();
+    std::vector<uint8_t> removed(g._edge_index_range, false);
+
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+    for (size_t v = 0; v < N; ++v)
+    {
+        auto pos = g._edges[v].first;
+        auto& es = g._edges[v].second;
+        for (size_t j = 0; j < pos; ++j)
+        {
+            auto& e = es[j];
+            if (pred(edge_descriptor(v, e.first, e.second)))
+                removed[e.second] = true;
+        }
+    }
+
+    size_t k = 0;
+    for (size_t i = 0; i < removed.size(); ++i)
+    {
+        if (!removed[i])
+            continue;
+        g._free_indexes.push_back(i);
+        k++;
+    }
+    if (k == 0)
+        return 0;
+    g._n_edges -= k;
+
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+    for (size_t v = 0; v < N; ++v)
+    {
+        auto& pos = g._edges[v].first;
+        auto& es = g._edges[v].second;
+        auto is_removed = [&](const auto& e) { return removed[e.second]; };
+        auto iter = std::remove_if(es.begin(), es.begin() + pos, is_removed);
+        size_t k_out = (es.begin() + pos) - iter;
+        if (k_out > 0)
+        {
+            iter = std::move(es.begin() + pos, es.end(), iter);
+            es.erase(iter, es.end());
+            pos -= k_out;
+        }
+        iter = std::remove_if(es.begin() + pos, es.end(), is_removed);
+        size_t k_in = es.end() - iter;
+        es.erase(iter, es.end());
+
+        if (k_out + k_in == 0)
+            continue;
+
+        if (g._keep_epos)
+        {
+            for (size_t j = 0; j < es.size(); ++j)
+            {
+                if (j < pos)
+                    g._epos[es[j].second].first = j;
+                else
+                    g._epos[es[j].second].second = j;
+            }
+        }
+
+        if (g._keep_out_index && k_out > 0)
+            g.rebuild_out_index(v);
+    }
+
+    //g.check_epos();
+    return k;
+}
+
 template <class Vertex>
 inline __attribute__((always_inline)) __attribute__((flatten))
 Vertex add_vertex(adj_list<Vertex>& g)
 {
+    ++g._mod_count;
     g._edges.emplace_back();
+    if (g._keep_out_index)
+        g._out_index.emplace_back();
     return g._edges.size() - 1;
 }
 
 template <class Vertex, class Pred>
-void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
+void clear_vertex(adj_vertex_t<Vertex> v, adj_list<Vertex>& g, Pred&& pred)
 {
+    ++g._mod_count;
     typename adj_list<Vertex>::make_out_edge mk_out_edge;
     typename adj_list<Vertex>::make_in_edge mk_in_edge;
 
@@ -1102,6 +1638,8 @@ void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
                                            });
                 u_es.erase(iter, u_es.begin() + u_pos);
                 u_pos = iter - u_es.begin();
+                if (g._keep_out_index)
+                    g.rebuild_out_index(u);
             }
         }
         auto iter =
@@ -1123,6 +1661,8 @@ void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
         es.erase(iter, es.begin() + pos);
         pos = iter - es.begin();
         g._n_edges -= k;
+        if (g._keep_out_index)
+            g.rebuild_out_index(v);
     }
     else
     {
@@ -1147,7 +1687,7 @@ void clear_vertex(Vertex v, adj_list<Vertex>& g, Pred&& pred)
 }
 
 template <class Vertex>
-void clear_vertex(Vertex v, adj_list<Vertex>& g)
+void clear_vertex(adj_vertex_t<Vertex> v, adj_list<Vertex>& g)
 {
     clear_vertex(v, g, [](auto&&){ return true; });
 }
@@ -1155,10 +1695,13 @@ void clear_vertex(Vertex v, adj_list<Vertex>& g)
 
 // O(V + E)
 template <class Vertex>
-void remove_vertex(Vertex v, adj_list<Vertex>& g)
+void remove_vertex(adj_vertex_t<Vertex> v, adj_list<Vertex>& g)
 {
+    ++g._mod_count;
     clear_vertex(v, g);
     g._edges.erase(g._edges.begin() + v);
+    if (g._keep_out_index)
+        g._out_index.erase(g._out_index.begin() + v);
 
     size_t N = g._edges.size();
     #pragma omp parallel for schedule(runtime) if (N > 100)
@@ -1169,13 +1712,23 @@ void remove_vertex(Vertex v, adj_list<Vertex>& g)
             if (e.first > v)
                 e.first--;
         }
+        if (g._keep_out_index)
+        {
+            // the relabeling preserves the order
+            for (auto& e : g._out_index[i])
+            {
+                if (e.first > v)
+                    e.first--;
+            }
+        }
     }
 }
 
 // O(k + k_last)
 template <class Vertex>
-void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
+void remove_vertex_fast(adj_vertex_t<Vertex> v, adj_list<Vertex>& g)
 {
+    ++g._mod_count;
     Vertex back = g._edges.size() - 1;
 
     clear_vertex(v, g);
@@ -1218,10 +1771,20 @@ void remove_vertex_fast(Vertex v, adj_list<Vertex>& g)
                     assert(g._edges[u].second[u_pos].first == back);
                     g._edges[u].second[u_pos].first = v;
                 }
+                if (g._keep_out_index && i >= pos)
+                    g.out_index_relabel(u, back, v);
             }
         }
+
+        if (g._keep_out_index)
+        {
+            g._out_index[v] = std::move(g._out_index[back]);
+            g.out_index_relabel(v, back, v); // self-loops
+        }
     }
     g._edges.pop_back();
+    if (g._keep_out_index)
+        g._out_index.pop_back();
 }
 
 
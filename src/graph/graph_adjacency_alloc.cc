@@ -0,0 +1,306 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph.hh"
+#include "graph_adjacency_alloc.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+#include <sys/mman.h>
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+
+namespace
+{
+
+constexpr size_t min_block = 16;
+constexpr size_t num_classes = 13;        // 16 bytes, ..., 64KB
+constexpr size_t max_block = min_block << (num_classes - 1);
+constexpr size_t chunk_size = size_t(1) << 21;   // 2MB, the huge page size
+
+size_t size_class(size_t bytes)
+{
+    size_t c = 0;
+    while ((min_block << c) < bytes)
+        ++c;
+    return c;
+}
+
+// aligned to huge pages, if at least as large as one
+void* huge_alloc(size_t bytes)
+{
+    void* p = nullptr;
+    size_t align = (bytes >= chunk_size) ? chunk_size : min_block;
+    if (posix_memalign(&p, align, bytes) != 0)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    if (bytes >= chunk_size)
+        madvise(p, bytes - bytes % chunk_size, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+
+// Blocks are moved between the thread caches (see below) and the shared arena
+// in batches of this many, so that the lock is taken only once per batch.
+size_t batch_size(size_t c)
+{
+    size_t n = (size_t(1) << 14) / (min_block << c);   // 16KB per batch
+    return std::max(size_t(1), std::min(n, size_t(32)));
+}
+
+struct free_block
+{
+    free_block* next;
+};
+
+class edge_arena
+{
+public:
+    // Moves up to n free blocks of size class c to the list l, and returns how
+    // many were moved (at least one).
+    size_t get_batch(size_t c, size_t n, free_block*& l)
+    {
+        size_t size = min_block << c;
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t i = 0;
+        for (; i < n && _free[c] != nullptr; ++i)
+        {
+            auto b = _free[c];
+            _free[c] = b->next;
+            b->next = l;
+            l = b;
+        }
+        if (i == 0)
+        {
+            if (size_t(_end - _pos) < size)
+                new_chunk();
+            for (; i < n && size_t(_end - _pos) >= size; ++i)
+            {
+                auto b = reinterpret_cast<free_block*>(_pos);
+                _pos += size;
+                b->next = l;
+                l = b;
+            }
+        }
+        _live += i;
+        return i;
+    }
+
+    // Returns the first n blocks of the list l, of size class c.
+    void put_batch(size_t c, size_t n, free_block*& l)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto b = l;
+            l = b->next;
+            push(b, c);
+        }
+        _live -= n;
+        if (_live == 0)
+            release();
+    }
+
+    python::dict get_info()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        python::dict info;
+        info["chunks"] = _chunks.size();
+        info["chunk_size"] = chunk_size;
+        info["live_blocks"] = _live;
+        return info;
+    }
+
+private:
+    void push(void* p, size_t c)
+    {
+        auto b = static_cast<free_block*>(p);
+        b->next = _free[c];
+        _free[c] = b;
+    }
+
+    void new_chunk()
+    {
+        // the tail of the current chunk is split into smaller free blocks
+        for (size_t c = num_classes; c > 0; --c)
+        {
+            size_t size = min_block << (c - 1);
+            while (size_t(_end - _pos) >= size)
+            {
+                push(_pos, c - 1);
+                _pos += size;
+            }
+        }
+        _pos = static_cast<char*>(huge_alloc(chunk_size));
+        _end = _pos + chunk_size;
+        _chunks.push_back(_pos);
+    }
+
+    // When no block is in use, all chunks but one are returned to the system,
+    // and the remaining one is reused from the start. Keeping it avoids
+    // mapping a new chunk every time a small graph is created and destroyed.
+    void release()
+    {
+        for (size_t i = 1; i < _chunks.size(); ++i)
+            free(_chunks[i]);
+        _chunks.resize(std::min(_chunks.size(), size_t(1)));
+        for (auto& b : _free)
+            b = nullptr;
+        if (_chunks.empty())
+            return;
+        _pos = _chunks.front();
+        _end = _pos + chunk_size;
+    }
+
+    std::mutex _mutex;
+    std::vector<char*> _chunks;
+    free_block* _free[num_classes] = {};
+    char* _pos = nullptr;
+    char* _end = nullptr;
+    size_t _live = 0;   // blocks held outside the arena, including the caches
+};
+
+// never destroyed, since graphs may outlive the static objects at exit
+edge_arena& get_edge_arena()
+{
+    static edge_arena* arena = new edge_arena();
+    return *arena;
+}
+
+// Each thread keeps a small cache of free blocks per size class, which serves
+// most requests without touching the shared arena, e.g. during the parallel
+// bulk insertion of edges or in numa_localize(). The caches hold at most two
+// batches per size class; when that is exceeded, one batch is returned to the
+// arena.
+//
+// The cache is trivially destructible, so that it remains usable if blocks are
+// freed after the thread-local destructors have run (e.g. at exit). A separate
+// object returns the cached blocks to the arena when the thread exits; after
+// that the blocks go directly to the arena.
+struct thread_cache
+{
+    free_block* free[num_classes];
+    size_t count[num_classes];
+    bool init;
+    bool done;
+
+    void flush()
+    {
+        for (size_t c = 0; c < num_classes; ++c)
+        {
+            if (count[c] > 0)
+                get_edge_arena().put_batch(c, count[c], free[c]);
+            count[c] = 0;
+        }
+        done = true;
+    }
+};
+
+thread_local thread_cache tcache;
+
+struct thread_cache_flusher
+{
+    ~thread_cache_flusher() { tcache.flush(); }
+};
+
+thread_local thread_cache_flusher tcache_flusher;
+
+thread_cache& get_thread_cache()
+{
+    auto& cache = tcache;
+    if (!cache.init)
+    {
+        cache.init = true;
+        (void) &tcache_flusher; // registers the flush at thread exit
+    }
+    return cache;
+}
+
+} // anonymous namespace
+
+void* boost::edge_arena_allocate(size_t bytes)
+{
+    if (bytes > max_block)
+        return huge_alloc(bytes);
+    size_t c = size_class(bytes);
+    auto& cache = get_thread_cache();
+    if (cache.done)
+    {
+        free_block* l = nullptr;
+        get_edge_arena().get_batch(c, 1, l);
+        return l;
+    }
+    if (cache.count[c] == 0)
+        cache.count[c] = get_edge_arena().get_batch(c, batch_size(c),
+                                                    cache.free[c]);
+    auto b = cache.free[c];
+    cache.free[c] = b->next;
+    --cache.count[c];
+    return b;
+}
+
+void boost::edge_arena_deallocate(void* p, size_t bytes)
+{
+    if (bytes > max_block)
+    {
+        free(p);
+        return;
+    }
+    size_t c = size_class(bytes);
+    auto b = static_cast<free_block*>(p);
+    auto& cache = get_thread_cache();
+    if (cache.done)
+    {
+        b->next = nullptr;
+        get_edge_arena().put_batch(c, 1, b);
+        return;
+    }
+    b->next = cache.free[c];
+    cache.free[c] = b;
+    if (++cache.count[c] > 2 * batch_size(c))
+    {
+        size_t n = batch_size(c);
+        get_edge_arena().put_batch(c, n, cache.free[c]);
+        cache.count[c] -= n;
+    }
+}
+
+bool graph_edge_arena_enabled()
+{
+#ifdef GRAPH_EDGE_ARENA
+    return true;
+#else
+    return false;
+#endif
+}
+
+python::dict edge_arena_info()
+{
+    return get_edge_arena().get_info();
+}
+
+void export_edge_arena()
+{
+    using namespace boost::python;
+    def("graph_edge_arena_enabled", &graph_edge_arena_enabled);
+    def("edge_arena_info", &edge_arena_info);
+}
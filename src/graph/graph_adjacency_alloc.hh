@@ -0,0 +1,103 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_ADJACENCY_ALLOC_HH
+#define GRAPH_ADJACENCY_ALLOC_HH
+
+#include "config.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace boost
+{
+
+// Allocator of the per-vertex edge lists of adj_list
+// ==================================================
+//
+// A graph with millions of vertices has millions of small edge vectors. With
+// the global allocator, each of them carries its own malloc header, and they
+// are scattered over the whole heap, which is costly in TLB misses during
+// traversals. If graph-tool is configured with --enable-edge-arena, the edge
+// lists are instead allocated from a shared arena (see
+// graph_adjacency_alloc.cc), which:
+//
+// - serves the requests in power-of-two size classes (which match the growth
+//   of std::vector), without any per-block header, since the size is always
+//   known on deallocation;
+// - carves the blocks from 2MB chunks, which are advised to be backed by
+//   transparent huge pages;
+// - recycles the freed blocks within each size class, first through small
+//   per-thread caches, so that concurrent insertions rarely contend for the
+//   shared arena;
+// - returns all the chunks but one to the system at once when every block is
+//   back in the arena (the thread caches are bounded, and are emptied when
+//   their threads exit).
+//
+// Requests larger than the largest size class (such as the edge array of a
+// frozen graph) are allocated directly, aligned to huge pages if they are at
+// least as large.
+
+void* edge_arena_allocate(std::size_t bytes);
+void edge_arena_deallocate(void* p, std::size_t bytes);
+
+template <class T>
+class edge_arena_allocator
+{
+public:
+    typedef T value_type;
+
+    edge_arena_allocator() noexcept {}
+    template <class U>
+    edge_arena_allocator(const edge_arena_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(edge_arena_allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        edge_arena_deallocate(p, n * sizeof(T));
+    }
+};
+
+// the arena is global, hence all instances are interchangeable
+template <class T, class U>
+bool operator==(const edge_arena_allocator<T>&, const edge_arena_allocator<U>&)
+{
+    return true;
+}
+
+template <class T, class U>
+bool operator!=(const edge_arena_allocator<T>&, const edge_arena_allocator<U>&)
+{
+    return false;
+}
+
+#ifdef GRAPH_EDGE_ARENA
+template <class T>
+using edge_allocator = edge_arena_allocator<T>;
+#else
+template <class T>
+using edge_allocator = std::allocator<T>;
+#endif
+
+} // namespace boost
+
+#endif // GRAPH_ADJACENCY_ALLOC_HH
@@ -0,0 +1,259 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BELLMAN_FORD_PARALLEL_HH
+#define GRAPH_BELLMAN_FORD_PARALLEL_HH
+
+#include <vector>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+
+// Parallel shortest paths with arbitrary edge weights, via Bellman-Ford with
+// frontier-based relaxation: in each round only the out-edges of the vertices
+// whose distance changed in the previous round are relaxed, so that the cost
+// of a round is proportional to the active part of the graph, instead of E.
+//
+// As in delta_stepping, the vertices are partitioned among the threads by
+// index, and each thread owns the distances, predecessors and frontier entries
+// of its vertices; relaxations of the vertices of other threads are passed to
+// their owners as requests, so that no locks or atomics are needed.
+//
+// Negative cycles are detected early, by checking whether the predecessor
+// graph has a cycle, which can only happen if there is a negative one in the
+// graph (since every predecessor was set by a strict improvement). The check
+// costs O(V), and is done whenever V relaxations happened since the last one,
+// so that it adds at most a constant factor. The search also stops as a
+// negative cycle after V rounds, as in the sequential algorithm.
+//
+// The distances must be initialized to inf, except for the sources, which can
+// carry any initial value (e.g. zero for all vertices, to get the potentials
+// of a virtual source connected to all of them), and the predecessors to the
+// identity. Returns false if a negative cycle is reachable from the sources.
+class parallel_bellman_ford
+{
+public:
+    template <class Graph, class DistMap, class PredMap, class WeightMap>
+    bool operator()(const Graph& g, const std::vector<size_t>& sources,
+                    DistMap dist, PredMap pred, WeightMap weight)
+    {
+        typedef typename boost::property_traits<DistMap>::value_type dist_t;
+
+        size_t N = num_vertices(g);
+        if (N == 0)
+            return true;
+
+        size_t nt = 1;
+#ifdef _OPENMP
+        if (N > OPENMP_MIN_THRESH && !omp_in_parallel())
+            nt = omp_get_max_threads();
+#endif
+
+        _in_next.clear();
+        _in_next.resize(N, false);
+        _reached.clear();
+        _reached.resize(N, false);
+
+        std::vector<thread_state<dist_t>> state;
+
+        auto owner = [&](size_t v) { return (v * nt) / N; };
+
+        size_t round = 0;
+        size_t since_check = 0;
+        bool done = false;
+        bool cycle = false;
+
+        #pragma omp parallel num_threads(nt) if (nt > 1)
+        {
+            size_t t = 0;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+#endif
+
+            #pragma omp single
+            {
+#ifdef _OPENMP
+                nt = omp_get_num_threads();
+#endif
+                state.resize(nt);
+                for (auto& st : state)
+                    st.requests.resize(nt);
+                for (auto s : sources)
+                {
+                    if (_in_next[s])
+                        continue;
+                    _in_next[s] = _reached[s] = true;
+                    state[owner(s)].next.push_back(s);
+                    _reached_list.push_back(s);
+                }
+            }
+
+            auto& st = state[t];
+
+            auto update = [&](size_t u, dist_t d, size_t v)
+            {
+                if (!(d < dist[u]))
+                    return;
+                dist[u] = d;
+                pred[u] = v;
+                ++st.relaxed;
+                if (!_reached[u])
+                {
+                    _reached[u] = true;
+                    st.reached.push_back(u);
+                }
+                if (!_in_next[u])
+                {
+                    _in_next[u] = true;
+                    st.next.push_back(u);
+                }
+            };
+
+            while (true)
+            {
+                st.current.swap(st.next);
+                st.next.clear();
+                for (auto v : st.current)
+                    _in_next[v] = false;
+
+                for (auto v : st.current)
+                {
+                    dist_t d = dist[v];
+                    for (auto e : out_edges_range(vertex(v, g), g))
+                    {
+                        size_t u = target(e, g);
+                        dist_t du = d + get(weight, e);
+                        size_t o = owner(u);
+                        if (o == t)
+                            update(u, du, v);
+                        else
+                            st.requests[o].push_back({u, du, v});
+                    }
+                }
+                st.current.clear();
+
+                #pragma omp barrier
+
+                for (auto& ost : state)
+                {
+                    for (auto& r : ost.requests[t])
+                        update(r.v, r.d, r.pred);
+                    ost.requests[t].clear();
+                }
+
+                #pragma omp barrier
+
+                #pragma omp master
+                {
+                    done = true;
+                    for (auto& ost : state)
+                    {
+                        done = done && ost.next.empty();
+                        since_check += ost.relaxed;
+                        ost.relaxed = 0;
+                        _reached_list.insert(_reached_list.end(),
+                                             ost.reached.begin(),
+                                             ost.reached.end());
+                        ost.reached.clear();
+                    }
+                    if (!done && ++round >= N)
+                        cycle = done = true;
+                    if (!done && since_check >= N)
+                    {
+                        since_check = 0;
+                        cycle = done = has_pred_cycle(pred);
+                    }
+                }
+
+                #pragma omp barrier
+
+                if (done)
+                    break;
+            }
+        }
+
+        _reached_list.clear();
+        return !cycle;
+    }
+
+private:
+    // Is there a cycle in the predecessor graph? Each reached vertex is
+    // followed towards its root, until a vertex already seen is found, which
+    // closes a cycle if it was seen in the same walk.
+    template <class PredMap>
+    bool has_pred_cycle(PredMap pred)
+    {
+        _walk.resize(_reached.size());
+        for (auto v : _reached_list)
+            _walk[v] = 0;
+        bool cycle = false;
+        size_t w = 0;
+        for (auto v : _reached_list)
+        {
+            ++w;
+            size_t u = v;
+            while (_walk[u] == 0)
+            {
+                _walk[u] = w;
+                size_t p = pred[u];
+                if (p == u)
+                    break;
+                u = p;
+            }
+            if (_walk[u] == w && size_t(pred[u]) != u)
+            {
+                cycle = true;
+                break;
+            }
+        }
+        return cycle;
+    }
+
+    template <class Dist>
+    struct request
+    {
+        size_t v;
+        Dist d;
+        size_t pred;
+    };
+
+    template <class Dist>
+    struct thread_state
+    {
+        std::vector<std::vector<request<Dist>>> requests;
+        std::vector<size_t> current;
+        std::vector<size_t> next;
+        std::vector<size_t> reached;
+        size_t relaxed = 0;
+    };
+
+    std::vector<uint8_t> _in_next;
+    std::vector<uint8_t> _reached;
+    std::vector<size_t> _reached_list;
+    std::vector<size_t> _walk;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_BELLMAN_FORD_PARALLEL_HH
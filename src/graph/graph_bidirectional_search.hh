@@ -0,0 +1,259 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BIDIRECTIONAL_SEARCH_HH
+#define GRAPH_BIDIRECTIONAL_SEARCH_HH
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+#include "graph_util.hh"
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+
+// Point-to-point shortest paths, by searching simultaneously forward from the
+// source and backward from the target, until the two searches meet. This is
+// done with BFS for unweighted graphs, and with Dijkstra's algorithm for
+// non-negative weights. In both cases the side with the smaller frontier is
+// expanded first.
+//
+// The object is meant to be kept and reused between queries: the per-vertex
+// buffers are allocated only once, and after each query only the entries of
+// the vertices that were actually touched are reset, so that a query costs
+// time proportional to the explored region, instead of O(V).
+template <class Dist>
+class bidirectional_search
+{
+public:
+    static constexpr Dist inf = std::is_floating_point<Dist>::value ?
+        std::numeric_limits<Dist>::infinity() :
+        std::numeric_limits<Dist>::max();
+
+    // Returns the distance from s to t (inf if it is unreachable), and puts
+    // the vertices of a shortest path in path, if it is not null.
+    template <class Graph>
+    Dist bfs(const Graph& g, size_t s, size_t t, std::vector<size_t>* path)
+    {
+        init(g, s, t);
+        if (s == t)
+            return finish(s, path);
+
+        std::vector<size_t>* front[2] = {&_front[0], &_front[1]};
+        front[0]->push_back(s);
+        front[1]->push_back(t);
+
+        Dist best = inf;
+        size_t meet = 0;
+        while (!front[0]->empty() && !front[1]->empty())
+        {
+            size_t d = (front[0]->size() <= front[1]->size()) ? 0 : 1;
+            auto& side = _side[d];
+            auto& other = _side[1 - d];
+
+            _next.clear();
+            for (auto u : *front[d])
+            {
+                Dist du = side.dist[u];
+                expand(g, u, d,
+                       [&](size_t w, auto)
+                       {
+                           if (side.dist[w] != inf)
+                               return;
+                           side.set(w, du + 1, u);
+                           _next.push_back(w);
+                           if (other.dist[w] != inf &&
+                               side.dist[w] + other.dist[w] < best)
+                           {
+                               best = side.dist[w] + other.dist[w];
+                               meet = w;
+                           }
+                       });
+            }
+
+            // a meeting found while expanding a whole level is optimal
+            if (best != inf)
+                break;
+            front[d]->swap(_next);
+        }
+
+        return finish((best != inf) ? meet : size_t(_null), path);
+    }
+
+    template <class Graph, class WeightMap>
+    Dist dijkstra(const Graph& g, size_t s, size_t t, WeightMap weight,
+                  std::vector<size_t>* path)
+    {
+        init(g, s, t);
+        if (s == t)
+            return finish(s, path);
+
+        for (auto& q : _queue)
+        {
+            while (!q.empty())
+                q.pop();
+        }
+        _queue[0].emplace(0, s);
+        _queue[1].emplace(0, t);
+
+        Dist best = inf;
+        size_t meet = _null;
+        while (!_queue[0].empty() && !_queue[1].empty())
+        {
+            // no path through an unsettled vertex can be shorter than this
+            if (!(_queue[0].top().first + _queue[1].top().first < best))
+                break;
+
+            size_t d = (_queue[0].top().first <= _queue[1].top().first) ?
+                0 : 1;
+            auto& side = _side[d];
+            auto& other = _side[1 - d];
+            auto& q = _queue[d];
+
+            Dist du;
+            size_t u;
+            std::tie(du, u) = q.top();
+            q.pop();
+            if (du > side.dist[u])
+                continue;
+
+            expand(g, u, d,
+                   [&](size_t w, const auto& e)
+                   {
+                       auto ew = get(weight, e);
+                       if (ew < 0)
+                           throw ValueException("Negative edge weight "
+                                                "found in bidirectional "
+                                                "search");
+                       Dist dw = du + ew;
+                       if (!(dw < side.dist[w]))
+                           return;
+                       side.set(w, dw, u);
+                       q.emplace(dw, w);
+                       if (other.dist[w] != inf &&
+                           side.dist[w] + other.dist[w] < best)
+                       {
+                           best = side.dist[w] + other.dist[w];
+                           meet = w;
+                       }
+                   });
+        }
+
+        return finish(meet, path);
+    }
+
+private:
+    struct side_t
+    {
+        std::vector<Dist> dist;
+        std::vector<size_t> pred;
+        std::vector<size_t> touched;
+
+        void set(size_t v, Dist d, size_t u)
+        {
+            if (dist[v] == inf)
+                touched.push_back(v);
+            dist[v] = d;
+            pred[v] = u;
+        }
+
+        void reset()
+        {
+            for (auto v : touched)
+                dist[v] = inf;
+            touched.clear();
+        }
+    };
+
+    template <class Graph>
+    void init(const Graph& g, size_t s, size_t t)
+    {
+        size_t N = num_vertices(g);
+        for (auto& side : _side)
+        {
+            side.reset();
+            if (side.dist.size() < N)
+            {
+                side.dist.resize(N, inf);
+                side.pred.resize(N);
+            }
+        }
+        _front[0].clear();
+        _front[1].clear();
+        _side[0].set(s, 0, s);
+        _side[1].set(t, 0, t);
+    }
+
+    // calls f(w, e) for the neighbours w of u, following the edges forward
+    // (d == 0) or backward (d == 1)
+    template <class Graph, class F>
+    void expand(const Graph& g, size_t u, size_t d, F&& f)
+    {
+        if (d == 0)
+        {
+            for (auto e : out_edges_range(vertex(u, g), g))
+                f(target(e, g), e);
+        }
+        else
+        {
+            for (auto e : in_or_out_edges_range(vertex(u, g), g))
+                f(graph_tool::is_directed(g) ? source(e, g) : target(e, g), e);
+        }
+    }
+
+    Dist finish(size_t meet, std::vector<size_t>* path)
+    {
+        if (meet == _null)
+            return inf;
+        if (path != nullptr)
+        {
+            path->clear();
+            for (size_t v = meet; ; v = _side[0].pred[v])
+            {
+                path->push_back(v);
+                if (_side[0].pred[v] == v)
+                    break;
+            }
+            std::reverse(path->begin(), path->end());
+            for (size_t v = meet; _side[1].pred[v] != v; )
+            {
+                v = _side[1].pred[v];
+                path->push_back(v);
+            }
+        }
+        return _side[0].dist[meet] + _side[1].dist[meet];
+    }
+
+    static constexpr size_t _null = std::numeric_limits<size_t>::max();
+
+    side_t _side[2];
+    std::vector<size_t> _front[2];
+    std::vector<size_t> _next;
+    std::priority_queue<std::pair<Dist, size_t>,
+                        std::vector<std::pair<Dist, size_t>>,
+                        std::greater<std::pair<Dist, size_t>>> _queue[2];
+};
+
+template <class Dist>
+constexpr Dist bidirectional_search<Dist>::inf;
+
+} // namespace graph_tool
+
+#endif // GRAPH_BIDIRECTIONAL_SEARCH_HH
@@ -415,9 +415,36 @@ void ungroup_vector_property(GraphInterface& g, boost::any vector_prop,
                              boost::any prop, size_t pos, bool edge);
 void group_vector_property(GraphInterface& g, boost::any vector_prop,
                            boost::any prop, size_t pos, bool edge);
+void vector_property_get_2d(GraphInterface&, boost::any prop,
+                            boost::python::object oidx,
+                            boost::python::object opos,
+                            boost::python::object oa, bool edge);
+void vector_property_set_2d(GraphInterface&, boost::any prop,
+                            boost::python::object oidx,
+                            boost::python::object opos,
+                            boost::python::object oa, bool edge);
+boost::python::object
+vector_property_get_ragged(GraphInterface&, boost::any prop,
+                           boost::python::object oidx, bool edge);
+void vector_property_set_ragged(GraphInterface&, boost::any prop,
+                                boost::python::object oidx,
+                                boost::python::object ovals,
+                                boost::python::object ooffsets, bool edge);
 void property_map_values(GraphInterface& g, boost::any src_prop,
                          boost::any tgt_prop, boost::python::object mapper,
                          bool edge);
+void property_transform_values(GraphInterface& g, boost::any src_prop,
+                               boost::any tgt_prop, std::string op,
+                               boost::python::object params, bool edge);
+boost::python::list encode_string_property(boost::any src, boost::any tgt,
+                                          bool edge);
+void decode_string_property(boost::any src, boost::any tgt,
+                            boost::python::object labels, bool edge);
+void read_edge_list(GraphInterface& gi, std::string file,
+                    boost::python::object pfile, std::string delim,
+                    std::string comment, bool skip_first, size_t scol,
+                    size_t tcol, size_t binary_width, bool hashed,
+                    boost::any avname, boost::python::object oeprops);
 void infect_vertex_property(GraphInterface& gi, boost::any prop,
                             boost::python::object val);
 void edge_endpoint(GraphInterface& gi, boost::any prop,
@@ -440,6 +467,12 @@ void export_python_interface();
 
 void export_openmp();
 
+void export_trace();
+
+void export_edge_arena();
+
+void export_search_workspace();
+
 BOOST_PYTHON_MODULE(libgraph_tool_core)
 {
     using namespace boost::python;
@@ -449,8 +482,11 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
     export_python_interface();
 
     // random numbers
-    class_<rng_t>("rng_t");
+    class_<rng_t>("rng_t")
+        .def("get_state", get_rng_state)
+        .def("set_state", set_rng_state);
     def("get_rng", get_rng);
+    def("split_rng", split_rng);
 
     register_exception_translator<GraphException>
         (graph_exception_translator<GraphException>);
@@ -471,7 +507,11 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
     def("name_demangle", &name_demangle);
 
     def("graph_filtering_enabled", &graph_filtering_enabled);
+    def("graph_slim_dispatch_enabled", &graph_slim_dispatch_enabled);
     export_openmp();
+    export_trace();
+    export_edge_arena();
+    export_search_workspace();
 
     boost::mpl::for_each<boost::mpl::push_back<scalar_types,string>::type>(export_vector_types());
     export_vector_types()(size_t(), "size_t");
@@ -488,6 +528,8 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("get_reversed", &GraphInterface::get_reversed)
         .def("set_keep_epos", &GraphInterface::set_keep_epos)
         .def("get_keep_epos", &GraphInterface::get_keep_epos)
+        .def("set_keep_out_index", &GraphInterface::set_keep_out_index)
+        .def("get_keep_out_index", &GraphInterface::get_keep_out_index)
         .def("set_vertex_filter_property",
              &GraphInterface::set_vertex_filter_property)
         .def("is_vertex_filter_active", &GraphInterface::is_vertex_filter_active)
@@ -501,14 +543,26 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
         .def("re_index_vertex_property",  &GraphInterface::re_index_vertex_property)
         .def("write_to_file", &GraphInterface::write_to_file)
         .def("read_from_file",&GraphInterface::read_from_file)
+        .def("read_property_from_file",
+             &GraphInterface::read_property_from_file)
         .def("degree_map", &GraphInterface::degree_map)
         .def("clear", &GraphInterface::clear)
         .def("clear_edges", &GraphInterface::clear_edges)
         .def("get_vertex_index", &GraphInterface::get_vertex_index)
         .def("get_edge_index", &GraphInterface::get_edge_index)
         .def("get_edge_index_range", &GraphInterface::get_edge_index_range)
+        .def("get_modification_count",
+             &GraphInterface::get_modification_count)
         .def("re_index_edges", &GraphInterface::re_index_edges)
+        .def("compact_edges", &GraphInterface::compact_edges)
         .def("shrink_to_fit", &GraphInterface::shrink_to_fit)
+        .def("numa_localize", &GraphInterface::numa_localize)
+        .def("reserve", &GraphInterface::reserve)
+        .def("materialize", &GraphInterface::materialize)
+        .def("memory_usage", &GraphInterface::memory_usage)
+        .def("freeze", &GraphInterface::freeze)
+        .def("unfreeze", &GraphInterface::unfreeze)
+        .def("is_frozen", &GraphInterface::is_frozen)
         .def("get_graph_index", &GraphInterface::get_graph_index)
         .def("copy_vertex_property", &GraphInterface::copy_vertex_property)
         .def("copy_edge_property", &GraphInterface::copy_edge_property)
@@ -554,7 +608,15 @@ BOOST_PYTHON_MODULE(libgraph_tool_core)
 
     def("group_vector_property", &group_vector_property);
     def("ungroup_vector_property", &ungroup_vector_property);
+    def("vector_property_get_2d", &vector_property_get_2d);
+    def("vector_property_set_2d", &vector_property_set_2d);
+    def("vector_property_get_ragged", &vector_property_get_ragged);
+    def("vector_property_set_ragged", &vector_property_set_ragged);
     def("property_map_values", &property_map_values);
+    def("property_transform_values", &property_transform_values);
+    def("encode_string_property", &encode_string_property);
+    def("decode_string_property", &decode_string_property);
+    def("read_edge_list", &read_edge_list);
     def("infect_vertex_property", &infect_vertex_property);
     def("edge_endpoint", &edge_endpoint);
     def("out_edges_op", &out_edges_op);
@@ -24,6 +24,9 @@
 #include <boost/mpl/contains.hpp>
 #include <boost/python/extract.hpp>
 
+#include <array>
+#include <numeric>
+
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
@@ -234,6 +237,7 @@ GraphInterface::GraphInterface(const GraphInterface& gi, bool keep_ref,
                                python::object ovprops, python::object oeprops,
                                python::object vorder)
     :_mg(keep_ref ? gi._mg : std::make_shared<multigraph_t>()),
+     _frozen(keep_ref ? gi._frozen : nullptr),
      _vertex_index(get(vertex_index, *_mg)),
      _edge_index(get(edge_index_t(), *_mg)),
      _reversed(gi._reversed),
@@ -279,3 +283,89 @@ GraphInterface::GraphInterface(const GraphInterface& gi, bool keep_ref,
          vertex_scalar_properties())(avorder);
     // filters will be copied in python
 }
+
+// this will copy only the vertices and edges which are not filtered out into
+// the (empty) graph tgt, with contiguous indexes, and will store the original
+// vertex and edge indexes in vmap and emap, respectively. Differently from the
+// generic copy above, the filters are evaluated only once, and the adjacency
+// lists are filled in bulk, in parallel.
+void GraphInterface::materialize(GraphInterface& tgt, boost::any avmap,
+                                 boost::any aemap)
+{
+    typedef vprop_map_t<int64_t>::type vmap_t;
+    typedef eprop_map_t<int64_t>::type emap_t;
+    vmap_t vmap = any_cast<vmap_t>(avmap);
+    emap_t emap = any_cast<emap_t>(aemap);
+
+    auto& g = *_mg;
+    auto& u = *tgt._mg;
+    if (num_vertices(u) > 0)
+        throw ValueException("target graph must be empty");
+
+    auto keep_v = [&](auto v)
+        {
+            return (!_vertex_filter_active ||
+                    (_vertex_filter_map[v] ^ _vertex_filter_invert));
+        };
+    auto keep_e = [&](const auto& e)
+        {
+            return (!_edge_filter_active ||
+                    (_edge_filter_map[e] ^ _edge_filter_invert));
+        };
+
+    size_t N = num_vertices(g);
+    vector<size_t> vindex(N);
+    vector<size_t> vorig;
+    for (size_t v = 0; v < N; ++v)
+    {
+        if (!keep_v(v))
+            continue;
+        vindex[v] = vorig.size();
+        vorig.push_back(v);
+    }
+    size_t M = vorig.size();
+
+    // the new edges are ordered by their sources, as they appear in the
+    // out-lists
+    vector<size_t> offset(M + 1, 0);
+    parallel_loop(vorig,
+                  [&](size_t i, auto v)
+                  {
+                      size_t k = 0;
+                      for (auto e : out_edges_range(v, g))
+                      {
+                          if (keep_e(e) && keep_v(target(e, g)))
+                              k++;
+                      }
+                      offset[i + 1] = k;
+                  });
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    size_t E = offset[M];
+    vector<std::array<size_t, 2>> elist(E);
+    vector<size_t> eorig(E);
+    parallel_loop(vorig,
+                  [&](size_t i, auto v)
+                  {
+                      size_t j = offset[i];
+                      for (auto e : out_edges_range(v, g))
+                      {
+                          auto w = target(e, g);
+                          if (!keep_e(e) || !keep_v(w))
+                              continue;
+                          elist[j] = {{i, vindex[w]}};
+                          eorig[j] = e.idx;
+                          j++;
+                      }
+                  });
+
+    for (size_t i = 0; i < M; ++i)
+        add_vertex(u);
+    add_edges(elist, u); // the new edge indexes are [0, E)
+
+    auto uvmap = vmap.get_unchecked(M);
+    parallel_loop(vorig, [&](size_t i, auto v) { uvmap[i] = v; });
+    auto& estorage = emap.get_storage();
+    estorage.resize(E);
+    parallel_loop(eorig, [&](size_t i, auto ei) { estorage[i] = ei; });
+}
@@ -0,0 +1,483 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CSR_HH
+#define GRAPH_CSR_HH
+
+#include "graph_adjacency.hh"
+
+namespace boost
+{
+
+// ========================================================================
+// csr_adj_list<Vertex>
+// ========================================================================
+//
+// csr_adj_list is an immutable, compressed-sparse-row snapshot of an
+// adj_list<Vertex>. The edge lists of all vertices are stored contiguously in
+// a single array, with the same per-vertex layout as adj_list (out-edges
+// first, followed by in-edges), and are delimited by a single offset array,
+// together with the position of the out/in boundary of each vertex. Edge
+// descriptors, and therefore edge indexes, are identical to those of the
+// original graph, so that all existing vertex and edge property maps can be
+// used with the snapshot.
+//
+// The snapshot is not updated when the original graph is modified, and it
+// does not provide any of the manipulation functions.
+
+template <class Vertex = size_t>
+class csr_adj_list
+{
+public:
+    struct graph_tag {};
+    typedef Vertex vertex_t;
+
+    typedef adj_list<Vertex> base_graph_t;
+    typedef typename base_graph_t::edge_descriptor edge_descriptor;
+    typedef typename base_graph_t::edge_list_t edge_list_t;
+    typedef typename base_graph_t::vertex_iterator vertex_iterator;
+    typedef typename base_graph_t::adjacency_iterator adjacency_iterator;
+    typedef typename base_graph_t::in_adjacency_iterator in_adjacency_iterator;
+    typedef typename base_graph_t::out_edge_iterator out_edge_iterator;
+    typedef typename base_graph_t::in_edge_iterator in_edge_iterator;
+    typedef typename base_graph_t::all_edge_iterator all_edge_iterator;
+    typedef typename base_graph_t::all_edge_iterator_reversed
+        all_edge_iterator_reversed;
+
+    csr_adj_list()
+        : _offsets(1, 0), _n_edges(0), _edge_index_range(0), _mod_count(0) {}
+
+    // O(V + E)
+    explicit csr_adj_list(const base_graph_t& g)
+        : _n_edges(num_edges(g)),
+          _edge_index_range(g.get_edge_index_range()),
+          _mod_count(g.get_modification_count())
+    {
+        size_t N = num_vertices(g);
+        _offsets.resize(N + 1);
+        _out_end.resize(N);
+        _offsets[0] = 0;
+        for (size_t v = 0; v < N; ++v)
+            _offsets[v + 1] = _offsets[v] + degree(Vertex(v), g);
+        _edges.resize(_offsets[N]);
+
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t v = 0; v < N; ++v)
+        {
+            size_t pos = _offsets[v];
+            _out_end[v] = pos + out_degree(Vertex(v), g);
+            auto es = _all_edges_out(Vertex(v), g);
+            for (auto ei = es.first; ei != es.second; ++ei)
+            {
+                auto e = *ei;
+                _edges[pos++] = {e.t, e.idx};
+            }
+        }
+    }
+
+    class edge_iterator:
+        public boost::iterator_facade<edge_iterator,
+                                      edge_descriptor,
+                                      boost::forward_traversal_tag,
+                                      edge_descriptor>
+    {
+    public:
+        edge_iterator() : _g(nullptr), _v(0), _i(0) {}
+        explicit edge_iterator(const csr_adj_list& g, size_t v, size_t i)
+            : _g(&g), _v(v), _i(i)
+        {
+            // move position to first edge
+            skip();
+        }
+
+    private:
+        friend class boost::iterator_core_access;
+
+        void skip()
+        {
+            //skip in-edges and empty vertices
+            size_t N = _g->_out_end.size();
+            while (_v < N && _i == _g->_out_end[_v])
+            {
+                ++_v;
+                _i = (_v < N) ? _g->_offsets[_v] : _g->_edges.size();
+            }
+        }
+
+        void increment()
+        {
+            ++_i;
+            skip();
+        }
+
+        bool equal(edge_iterator const& other) const
+        {
+            return _v == other._v && _i == other._i;
+        }
+
+        edge_descriptor dereference() const
+        {
+            auto& e = _g->_edges[_i];
+            return edge_descriptor(vertex_t(_v), e.first, e.second);
+        }
+
+        const csr_adj_list* _g;
+        size_t _v;
+        size_t _i;
+    };
+
+    size_t get_edge_index_range() const { return _edge_index_range; }
+
+    static Vertex null_vertex() { return std::numeric_limits<Vertex>::max(); }
+
+    // returns true if g was not modified after the snapshot was created
+    bool is_snapshot_of(const base_graph_t& g) const
+    {
+        return _mod_count == g.get_modification_count();
+    }
+
+    // raw access to the compressed storage
+    typedef typename edge_list_t::const_iterator iter_t;
+
+    __attribute__((always_inline))
+    iter_t begin(Vertex v) const { return _edges.begin() + _offsets[v]; }
+
+    __attribute__((always_inline))
+    iter_t pos(Vertex v) const { return _edges.begin() + _out_end[v]; }
+
+    __attribute__((always_inline))
+    iter_t end(Vertex v) const { return _edges.begin() + _offsets[v + 1]; }
+
+    size_t get_num_vertices() const { return _out_end.size(); }
+    size_t get_num_edges() const { return _n_edges; }
+    size_t get_edge_list_size() const { return _edges.size(); }
+
+    size_t get_memory_usage() const
+    {
+        return (_offsets.capacity() + _out_end.capacity()) * sizeof(size_t) +
+            _edges.capacity() * sizeof(typename edge_list_t::value_type);
+    }
+
+private:
+    std::vector<size_t> _offsets;  // beginning of each vertex's edge list
+    std::vector<size_t> _out_end;  // end of each vertex's out-edges
+    edge_list_t _edges;            // (neighbor, edge index) pairs
+    size_t _n_edges;
+    size_t _edge_index_range;
+    size_t _mod_count;
+};
+
+//========================================================================
+// Graph traits and BGL scaffolding
+//========================================================================
+
+template <class Vertex>
+struct graph_traits<csr_adj_list<Vertex> >
+{
+    typedef Vertex vertex_descriptor;
+    typedef typename csr_adj_list<Vertex>::edge_descriptor edge_descriptor;
+    typedef typename csr_adj_list<Vertex>::edge_iterator edge_iterator;
+    typedef typename csr_adj_list<Vertex>::adjacency_iterator adjacency_iterator;
+
+    typedef typename csr_adj_list<Vertex>::out_edge_iterator out_edge_iterator;
+    typedef typename csr_adj_list<Vertex>::in_edge_iterator in_edge_iterator;
+
+    typedef typename csr_adj_list<Vertex>::vertex_iterator vertex_iterator;
+
+    typedef bidirectional_tag directed_category;
+    typedef allow_parallel_edge_tag edge_parallel_category;
+    typedef adj_list_traversal_tag traversal_category;
+
+    typedef Vertex vertices_size_type;
+    typedef Vertex edges_size_type;
+    typedef size_t degree_size_type;
+
+    static Vertex null_vertex() { return csr_adj_list<Vertex>::null_vertex(); }
+};
+
+template <class Vertex>
+struct graph_traits<const csr_adj_list<Vertex> >
+    : public graph_traits<csr_adj_list<Vertex> >
+{
+};
+
+template <class Vertex>
+struct edge_property_type<csr_adj_list<Vertex> >
+{
+    typedef void type;
+};
+
+template <class Vertex>
+struct vertex_property_type<csr_adj_list<Vertex> >
+{
+    typedef void type;
+};
+
+template <class Vertex>
+struct graph_property_type<csr_adj_list<Vertex> >
+{
+    typedef void type;
+};
+
+//========================================================================
+// Graph access functions
+//========================================================================
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::vertex_iterator,
+          typename csr_adj_list<Vertex>::vertex_iterator>
+vertices(const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::vertex_iterator vi_t;
+    return {vi_t(0), vi_t(g.get_num_vertices())};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::edge_iterator,
+          typename csr_adj_list<Vertex>::edge_iterator>
+edges(const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::edge_iterator ei_t;
+    return {ei_t(g, 0, 0),
+            ei_t(g, g.get_num_vertices(), g.get_edge_list_size())};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+Vertex vertex(size_t i, const csr_adj_list<Vertex>&)
+{
+    return i;
+}
+
+template <class Vertex>
+inline
+std::pair<typename csr_adj_list<Vertex>::edge_descriptor, bool>
+edge(adj_vertex_t<Vertex> s, adj_vertex_t<Vertex> t,
+     const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::edge_descriptor edge_descriptor;
+    auto end = g.pos(s);
+    auto iter = std::find_if(g.begin(s), end,
+                             [&](const auto& e) -> bool {return e.first == t;});
+    if (iter != end)
+        return {edge_descriptor(s, t, iter->second), true};
+    return {edge_descriptor(), false};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t out_degree(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    return g.pos(v) - g.begin(v);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t in_degree(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    return g.end(v) - g.pos(v);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t degree(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    return g.end(v) - g.begin(v);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::out_edge_iterator,
+          typename csr_adj_list<Vertex>::out_edge_iterator>
+out_edges(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::out_edge_iterator ei_t;
+    return {ei_t(v, g.begin(v)), ei_t(v, g.pos(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::in_edge_iterator,
+          typename csr_adj_list<Vertex>::in_edge_iterator>
+in_edges(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::in_edge_iterator ei_t;
+    return {ei_t(v, g.pos(v)), ei_t(v, g.end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::out_edge_iterator,
+          typename csr_adj_list<Vertex>::out_edge_iterator>
+_all_edges_out(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::out_edge_iterator ei_t;
+    return {ei_t(v, g.begin(v)), ei_t(v, g.end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::in_edge_iterator,
+          typename csr_adj_list<Vertex>::in_edge_iterator>
+_all_edges_in(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::in_edge_iterator ei_t;
+    return {ei_t(v, g.begin(v)), ei_t(v, g.end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::all_edge_iterator,
+          typename csr_adj_list<Vertex>::all_edge_iterator>
+all_edges(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::all_edge_iterator ei_t;
+    auto pos = g.pos(v);
+    return {ei_t(v, g.begin(v), pos), ei_t(v, g.end(v), pos)};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::all_edge_iterator_reversed,
+          typename csr_adj_list<Vertex>::all_edge_iterator_reversed>
+_all_edges_reversed(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::all_edge_iterator_reversed ei_t;
+    auto pos = g.pos(v);
+    return {ei_t(v, g.begin(v), pos), ei_t(v, g.end(v), pos)};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+out_neighbors(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::adjacency_iterator ai_t;
+    return {ai_t(g.begin(v)), ai_t(g.pos(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+in_neighbors(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::adjacency_iterator ai_t;
+    return {ai_t(g.pos(v)), ai_t(g.end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+all_neighbors(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    typedef typename csr_adj_list<Vertex>::adjacency_iterator ai_t;
+    return {ai_t(g.begin(v)), ai_t(g.end(v))};
+}
+
+template <class Vertex>
+inline __attribute__((always_inline)) __attribute__((flatten))
+std::pair<typename csr_adj_list<Vertex>::adjacency_iterator,
+          typename csr_adj_list<Vertex>::adjacency_iterator>
+adjacent_vertices(adj_vertex_t<Vertex> v, const csr_adj_list<Vertex>& g)
+{
+    return out_neighbors(v, g);
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t num_vertices(const csr_adj_list<Vertex>& g)
+{
+    return g.get_num_vertices();
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+size_t num_edges(const csr_adj_list<Vertex>& g)
+{
+    return g.get_num_edges();
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+Vertex source(const typename csr_adj_list<Vertex>::edge_descriptor& e,
+              const csr_adj_list<Vertex>&)
+{
+    return e.s;
+}
+
+template <class Vertex>
+inline __attribute__((always_inline))
+Vertex target(const typename csr_adj_list<Vertex>::edge_descriptor& e,
+              const csr_adj_list<Vertex>&)
+{
+    return e.t;
+}
+
+//========================================================================
+// Vertex and edge index property maps
+//========================================================================
+
+template <class Vertex>
+struct property_map<csr_adj_list<Vertex>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+struct property_map<const csr_adj_list<Vertex>, vertex_index_t>
+{
+    typedef identity_property_map type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+inline identity_property_map
+get(vertex_index_t, csr_adj_list<Vertex>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex>
+inline identity_property_map
+get(vertex_index_t, const csr_adj_list<Vertex>&)
+{
+    return identity_property_map();
+}
+
+template <class Vertex>
+struct property_map<csr_adj_list<Vertex>, edge_index_t>
+{
+    typedef adj_edge_index_property_map<Vertex> type;
+    typedef type const_type;
+};
+
+template <class Vertex>
+inline adj_edge_index_property_map<Vertex>
+get(edge_index_t, const csr_adj_list<Vertex>&)
+{
+    return adj_edge_index_property_map<Vertex>();
+}
+
+} // namespace boost
+
+#endif //GRAPH_CSR_HH
@@ -0,0 +1,361 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_DELTA_STEPPING_HH
+#define GRAPH_DELTA_STEPPING_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+
+// Parallel single-source shortest paths with non-negative weights, via
+// delta-stepping (U. Meyer and P. Sanders, "Delta-stepping: a parallelizable
+// shortest path algorithm", J. Algorithms 49, 2003).
+//
+// The tentative distances are kept in buckets of width delta, which are
+// processed in increasing order. The vertices of the current bucket are
+// relaxed all at once, first through their light edges (w <= delta), which
+// may reinsert vertices into the same bucket, and then, once the bucket is
+// settled, through their heavy edges. The vertices are partitioned among the
+// threads by index, and each thread owns the distances, predecessors and
+// bucket entries of its vertices, so that relaxations are passed to the owner
+// as requests, and no locks or atomics are needed.
+//
+// The distance map must be initialized to inf, and the predecessor map to the
+// identity. The search stops when every vertex in targets is settled (if
+// targets is not empty), or when the distances exceed max_dist; the vertices
+// found beyond max_dist get their distances set back to inf. Every vertex
+// whose distance was set is appended to reached.
+class delta_stepping
+{
+public:
+    // Returns a bucket width suitable for the weight distribution: the mean
+    // edge weight, scaled up by 2/<k> if the mean degree <k> is below two,
+    // following the choice delta = O(1/k) of Meyer and Sanders for uniform
+    // random weights. The mean is estimated from the out-edges of an evenly
+    // spaced sample of the vertices, since a full pass over the weights would
+    // cost a sizeable fraction of the search itself.
+    template <class Graph, class WeightMap>
+    static double get_delta(const Graph& g, WeightMap weight)
+    {
+        size_t N = num_vertices(g);
+        size_t step = std::max(N / _n_samples, size_t(1));
+        double W = 0;
+        size_t E = 0, n = 0;
+        for (size_t i = 0; i < N; i += step)
+        {
+            auto v = vertex(i, g);
+            if (!is_valid_vertex(v, g))
+                continue;
+            for (auto e : out_edges_range(v, g))
+            {
+                double w = get(weight, e);
+                if (w < 0)
+                    throw ValueException("delta-stepping requires "
+                                         "non-negative edge weights");
+                W += w;
+                ++E;
+            }
+            ++n;
+        }
+        if (E == 0 || W == 0)
+            return 1;
+        double k = E / double(n);
+        return (W / E) * std::max(1., 2. / k);
+    }
+
+    template <class Graph, class DistMap, class PredMap, class WeightMap>
+    void operator()(const Graph& g, size_t s, DistMap dist, PredMap pred,
+                    WeightMap weight, double delta,
+                    typename boost::property_traits<DistMap>::value_type max_dist,
+                    typename boost::property_traits<DistMap>::value_type inf,
+                    const std::vector<size_t>& targets,
+                    std::vector<size_t>& reached)
+    {
+        typedef typename boost::property_traits<DistMap>::value_type dist_t;
+
+        size_t N = num_vertices(g);
+
+        size_t nt = 1;
+#ifdef _OPENMP
+        if (N > OPENMP_MIN_THRESH && !omp_in_parallel())
+            nt = omp_get_max_threads();
+#endif
+
+        // the buckets are kept in a circular array, whose slots may be shared
+        // by buckets farther apart than its size
+        size_t nb = _n_buckets;
+
+        const size_t none = std::numeric_limits<size_t>::max();
+        _bucket_of.clear();
+        _bucket_of.resize(N, none);
+        _in_settled.clear();
+        _in_settled.resize(N, false);
+
+        std::vector<thread_state<dist_t>> state;
+
+        auto owner = [&](size_t v) { return (v * nt) / N; };
+        auto bucket = [&](dist_t d) { return size_t(d / delta); };
+
+        size_t cur = 0, from = 0;
+        bool done = false;
+        bool any_light = false;
+        bool negative = false;
+
+        #pragma omp parallel num_threads(nt) if (nt > 1)
+        {
+            size_t t = 0;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+#endif
+
+            #pragma omp single
+            {
+#ifdef _OPENMP
+                nt = omp_get_num_threads();
+#endif
+                state.resize(nt);
+                for (auto& st : state)
+                {
+                    st.buckets.resize(nb);
+                    st.requests.resize(nt);
+                }
+                dist[s] = 0;
+                reached.push_back(s);
+                _bucket_of[s] = 0;
+                state[owner(s)].buckets[0].push_back(s);
+            }
+
+            auto& st = state[t];
+
+            auto update = [&](size_t u, dist_t d, size_t v)
+            {
+                if (!(d < dist[u]))
+                    return;
+                if (dist[u] == inf)
+                    st.reached.push_back(u);
+                dist[u] = d;
+                pred[u] = v;
+                size_t b = bucket(d);
+                if (_bucket_of[u] != b)
+                {
+                    _bucket_of[u] = b;
+                    st.buckets[b % nb].push_back(u);
+                }
+                if (b == cur)
+                    st.found_current = true;
+            };
+
+            // relaxations of vertices owned by other threads are deferred
+            // to apply()
+            auto relax = [&](size_t v, bool light)
+            {
+                dist_t d = dist[v];
+                for (auto e : out_edges_range(vertex(v, g), g))
+                {
+                    auto w = get(weight, e);
+                    if (w < 0)
+                    {
+                        // not relaxed, since a negative distance has no
+                        // bucket; the search is aborted below
+                        st.negative = true;
+                        continue;
+                    }
+                    if ((w <= delta) != light)
+                        continue;
+                    size_t u = target(e, g);
+                    size_t o = owner(u);
+                    if (o == t)
+                        update(u, dist_t(d + w), v);
+                    else
+                        st.requests[o].push_back({u, dist_t(d + w), v});
+                }
+            };
+
+            auto apply = [&]()
+            {
+                for (auto& ost : state)
+                {
+                    for (auto& r : ost.requests[t])
+                        update(r.v, r.d, r.pred);
+                    ost.requests[t].clear();
+                }
+            };
+
+            while (true)
+            {
+                // find the next non-empty bucket
+                st.next = none;
+                for (size_t j = from; j < from + nb; ++j)
+                {
+                    if (!st.buckets[j % nb].empty())
+                    {
+                        st.next = j;
+                        break;
+                    }
+                }
+
+                #pragma omp barrier
+
+                #pragma omp master
+                {
+                    cur = none;
+                    for (auto& ost : state)
+                        cur = std::min(cur, ost.next);
+                    for (auto& ost : state)
+                        negative = negative || ost.negative;
+                    done = (cur == none || cur * delta > max_dist || negative);
+                    if (!done && !targets.empty())
+                    {
+                        done = true;
+                        for (auto v : targets)
+                        {
+                            if (dist[v] == inf || bucket(dist[v]) >= from)
+                            {
+                                done = false;
+                                break;
+                            }
+                        }
+                    }
+                    from = cur + 1;
+                }
+
+                #pragma omp barrier
+
+                if (done)
+                    break;
+
+                // light edges, until the current bucket stays empty
+                do
+                {
+                    st.found_current = false;
+                    auto& b = st.buckets[cur % nb];
+                    st.current.swap(b);
+                    for (auto v : st.current)
+                    {
+                        if (_bucket_of[v] != cur)
+                        {
+                            // entries of later buckets that share this slot
+                            if (_bucket_of[v] != none &&
+                                _bucket_of[v] % nb == cur % nb)
+                                b.push_back(v);
+                            continue;
+                        }
+                        _bucket_of[v] = none;
+                        if (!_in_settled[v])
+                        {
+                            _in_settled[v] = true;
+                            st.settled.push_back(v);
+                        }
+                        relax(v, true);
+                    }
+                    st.current.clear();
+
+                    #pragma omp barrier
+
+                    apply();
+
+                    #pragma omp barrier
+
+                    #pragma omp master
+                    {
+                        any_light = false;
+                        for (auto& ost : state)
+                            any_light = any_light || ost.found_current;
+                    }
+
+                    #pragma omp barrier
+                }
+                while (any_light);
+
+                // heavy edges of the settled vertices
+                for (auto v : st.settled)
+                {
+                    _in_settled[v] = false;
+                    relax(v, false);
+                }
+                st.settled.clear();
+
+                #pragma omp barrier
+
+                apply();
+
+                #pragma omp barrier
+            }
+        }
+
+        for (auto& st : state)
+            reached.insert(reached.end(), st.reached.begin(),
+                           st.reached.end());
+
+        if (negative)
+            throw ValueException("delta-stepping requires non-negative "
+                                 "edge weights");
+
+        if (max_dist < inf)
+        {
+            for (auto v : reached)
+            {
+                if (dist[v] > max_dist)
+                    dist[v] = inf;
+            }
+        }
+    }
+
+private:
+    template <class Dist>
+    struct request
+    {
+        size_t v;
+        Dist d;
+        size_t pred;
+    };
+
+    template <class Dist>
+    struct thread_state
+    {
+        std::vector<std::vector<size_t>> buckets;
+        std::vector<std::vector<request<Dist>>> requests;
+        std::vector<size_t> current;
+        std::vector<size_t> settled;
+        std::vector<size_t> reached;
+        size_t next;
+        bool found_current;
+        bool negative = false;
+    };
+
+    static constexpr size_t _n_buckets = 1 << 12;
+    static constexpr size_t _n_samples = 1 << 12;
+
+    std::vector<size_t> _bucket_of;
+    std::vector<uint8_t> _in_settled;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_DELTA_STEPPING_HH
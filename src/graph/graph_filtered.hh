@@ -95,6 +95,64 @@ namespace detail {
 
 } // namespace detail
 
+// Advances iter up to the first element that satisfies the predicate, or
+// end. This is found via ADL, so that it can be overloaded for specific
+// predicates to skip many elements at once (see MaskFilter in
+// graph_filtering.hh).
+template <class Predicate, class Iterator>
+inline void skip_filtered(const Predicate& pred, Iterator& iter,
+                          const Iterator& end)
+{
+    while (iter != end && !pred(*iter))
+        ++iter;
+}
+
+// The same as boost::filter_iterator, except that the filtered elements are
+// skipped with skip_filtered().
+template <class Predicate, class Iterator>
+class filt_vertex_iterator
+    : public iterator_adaptor<filt_vertex_iterator<Predicate, Iterator>,
+                              Iterator, use_default,
+                              bidirectional_traversal_tag>
+{
+    typedef iterator_adaptor<filt_vertex_iterator<Predicate, Iterator>,
+                             Iterator, use_default,
+                             bidirectional_traversal_tag> super_t;
+    friend class iterator_core_access;
+
+public:
+    filt_vertex_iterator() {}
+
+    filt_vertex_iterator(Predicate pred, Iterator x, Iterator end = Iterator())
+        : super_t(x), _pred(pred), _end(end)
+    {
+        satisfy_predicate();
+    }
+
+    Predicate predicate() const { return _pred; }
+    Iterator end() const { return _end; }
+
+private:
+    void increment()
+    {
+        ++(this->base_reference());
+        satisfy_predicate();
+    }
+
+    void decrement()
+    {
+        while (!_pred(*--(this->base_reference())));
+    }
+
+    void satisfy_predicate()
+    {
+        skip_filtered(_pred, this->base_reference(), _end);
+    }
+
+    Predicate _pred;
+    Iterator _end;
+};
+
 
 //===========================================================================
 // Filtered Graph
@@ -185,7 +243,7 @@ public:
         in_adjacency_iterator;
 
     // VertexListGraph requirements
-    typedef filter_iterator<
+    typedef filt_vertex_iterator<
         VertexPredicate, typename Traits::vertex_iterator
         > vertex_iterator;
     typedef typename Traits::vertices_size_type        vertices_size_type;
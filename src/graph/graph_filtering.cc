@@ -28,6 +28,15 @@ bool graph_tool::graph_filtering_enabled()
     return true;
 }
 
+bool graph_tool::graph_slim_dispatch_enabled()
+{
+#ifdef GRAPH_SLIM_DISPATCH
+    return true;
+#else
+    return false;
+#endif
+}
+
 // Whenever no implementation is called, the following exception is thrown
 graph_tool::ActionNotFound::ActionNotFound(const type_info& action,
                                            const vector<const type_info*>& args)
@@ -100,7 +109,16 @@ check_filtered(const Graph& g, const EdgeFilter& edge_filter,
                                      reversed_graph<g_t> >::type
                     reversed_graph_t;
                 reversed_graph_t rg(u);
+#ifdef GRAPH_SLIM_DISPATCH
+                if (e_active || v_active)
+                    throw GraphException("Filtered reversed graph views are "
+                                         "not available, since graph-tool "
+                                         "was compiled with "
+                                         "--enable-slim-dispatch.");
+                return std::ref(*retrieve_graph_view(gi, rg));
+#else
                 return check_filt(*retrieve_graph_view(gi, rg));
+#endif
             }
             return check_filt(u);
         };
@@ -119,9 +137,32 @@ check_filtered(const Graph& g, const EdgeFilter& edge_filter,
     return check_directed(g);
 }
 
+// this will return the proper view of the frozen snapshot, encapsulated
+template <class Graph>
+boost::any
+check_frozen(const Graph& g, GraphInterface& gi, bool reverse, bool directed)
+{
+    if (!directed)
+    {
+        undirected_adaptor<Graph> ug(g);
+        return std::ref(*retrieve_graph_view(gi, ug));
+    }
+    if (reverse)
+    {
+        reversed_graph<Graph> rg(g);
+        return std::ref(*retrieve_graph_view(gi, rg));
+    }
+    return std::ref(const_cast<Graph&>(g));
+}
+
 // gets the correct graph view at run time
-boost::any GraphInterface::get_graph_view() const
+boost::any GraphInterface::get_graph_view(bool allow_frozen) const
 {
+    if (allow_frozen && !_edge_filter_active && !_vertex_filter_active &&
+        is_frozen())
+        return check_frozen(*_frozen, const_cast<GraphInterface&>(*this),
+                            _reversed, _directed);
+
     boost::any graph =
         check_filtered(*_mg, _edge_filter_map, _edge_filter_invert,
                        _edge_filter_active, _mg->get_edge_index_range(),
@@ -140,10 +181,33 @@ bool GraphInterface::is_edge_filter_active() const
 { return _edge_filter_active; }
 
 
+// this will create an immutable CSR snapshot of the graph, which will be used
+// by the algorithms that support it, until the graph is modified
+void GraphInterface::freeze()
+{
+    unfreeze();
+    _frozen = std::make_shared<frozen_graph_t>(*_mg);
+}
+
+void GraphInterface::unfreeze()
+{
+    // drop the cached views which refer to the old snapshot
+    if (_graph_views.size() > n_views::value)
+        _graph_views.resize(n_views::value);
+    _frozen.reset();
+}
+
+// the snapshot is considered stale if the graph was modified after it was made
+bool GraphInterface::is_frozen() const
+{
+    return _frozen != nullptr && _frozen->is_snapshot_of(*_mg);
+}
+
 // this function will reindex all the edges, in the order in which they are
 // found
 void GraphInterface::re_index_edges()
 {
+    unfreeze();
     _mg->reindex_edges();
 }
 
@@ -154,17 +218,9 @@ void GraphInterface::purge_edges()
     if (!is_edge_filter_active())
         return;
 
+    unfreeze();
     MaskFilter<edge_filter_t> filter(_edge_filter_map, _edge_filter_invert);
-    vector<graph_traits<multigraph_t>::edge_descriptor> deleted_edges;
-    for (auto v : vertices_range(*_mg))
-    {
-        for (auto e : out_edges_range(v, *_mg))
-            if (!filter(e))
-                deleted_edges.push_back(e);
-        for (auto& e  : deleted_edges)
-            remove_edge(e, *_mg);
-        deleted_edges.clear();
-    }
+    remove_edges_if([&](const auto& e) { return !filter(e); }, *_mg);
 }
 
 
@@ -19,6 +19,7 @@
 #define FILTERING_HH
 
 #include "graph.hh"
+#include <cstring>
 #include <boost/version.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/mpl/vector.hpp>
@@ -42,15 +43,21 @@
 #include <boost/mpl/quote.hpp>
 #include <boost/mpl/range_c.hpp>
 #include <boost/mpl/print.hpp>
+#include <boost/mpl/copy.hpp>
+#include <boost/mpl/remove_if.hpp>
+#include <boost/mpl/find_if.hpp>
+#include <boost/mpl/contains.hpp>
 
 #include "graph_adaptor.hh"
 #include "graph_filtered.hh"
 #include "graph_reverse.hh"
 #include "graph_selectors.hh"
+#include "graph_trace.hh"
 #include "graph_util.hh"
 #include "mpl_nested_loop.hh"
 
 #include <type_traits>
+#include <typeinfo>
 
 namespace graph_tool
 {
@@ -149,14 +156,55 @@ public:
         // edge in the graph, every time they're iterated through.
     }
 
-    DescriptorProperty& get_filter() { return *_filtered_property; }
-    bool is_inverted() { return *_invert; }
+    DescriptorProperty& get_filter() const { return *_filtered_property; }
+    bool is_inverted() const { return *_invert; }
 
 private:
     DescriptorProperty* _filtered_property;
     bool* _invert;
 };
 
+// When iterating over the vertices of a filtered graph, the masked vertices
+// are skipped eight at a time, by comparing whole words of the mask, so that
+// long filtered-out ranges do not cost one predicate call per vertex.
+template <class Value, class Index, class Iterator>
+inline typename std::enable_if<
+    sizeof(Value) == 1 &&
+    std::is_integral<typename std::iterator_traits<Iterator>::value_type>::value &&
+    std::is_convertible<typename std::iterator_traits<Iterator>::iterator_category,
+                        std::random_access_iterator_tag>::value>::type
+skip_filtered(const MaskFilter<boost::unchecked_vector_property_map<Value, Index>>& pred,
+              Iterator& iter, const Iterator& end)
+{
+    // a word where every entry is masked
+    const uint64_t masked = pred.is_inverted() ? 0x0101010101010101ULL : 0;
+    auto& mask = pred.get_filter().get_storage();
+    while (iter != end)
+    {
+        size_t i = *iter;
+        if (i % 8 == 0 && i < mask.size())
+        {
+            size_t n = std::min(size_t(end - iter), mask.size() - i);
+            size_t k = 0;
+            for (; k + 8 <= n; k += 8)
+            {
+                uint64_t w;
+                std::memcpy(&w, mask.data() + i + k, sizeof(w));
+                if (w != masked)
+                    break;
+            }
+            if (k > 0)
+            {
+                iter += k;
+                continue;
+            }
+        }
+        if (pred(*iter))
+            return;
+        ++iter;
+    }
+}
+
 
 // Metaprogramming
 // ---------------
@@ -263,6 +311,13 @@ struct get_graph_filtered
     };
 };
 
+// metafunction to tell whether a graph view is reversed
+template <class Graph>
+struct is_reversed_view: std::false_type {};
+
+template <class Graph>
+struct is_reversed_view<boost::reversed_graph<Graph>>: std::true_type {};
+
 // this metafunction returns all the possible graph views
 struct get_all_graph_views
 {
@@ -313,12 +368,25 @@ struct get_all_graph_views
                                 >::type
                             >::type {};
 
+        // graphs which have a filtered version; in the slim dispatch mode
+        // (see --enable-slim-dispatch) the filtered reversed graphs are
+        // omitted, since they are rarely used
+#ifdef GRAPH_SLIM_DISPATCH
+        struct filterable_graphs:
+            boost::mpl::remove_if<
+                undirected_graphs,
+                is_reversed_view<boost::mpl::_1>,
+                boost::mpl::back_inserter<boost::mpl::vector0<>>>::type {};
+#else
+        struct filterable_graphs: undirected_graphs {};
+#endif
+
         // filtered graphs
         struct filtered_graphs:
             boost::mpl::if_<NeverFiltered,
                             undirected_graphs,
                             typename boost::mpl::transform<
-                                undirected_graphs,
+                                filterable_graphs,
                                 get_graph_filtered,
                                 boost::mpl::back_inserter<undirected_graphs>>::type
                             >::type {};
@@ -367,17 +435,142 @@ struct never_filtered_never_reversed:
 
 // sanity check
 typedef boost::mpl::size<all_graph_views>::type n_views;
+#ifdef GRAPH_SLIM_DISPATCH
+BOOST_MPL_ASSERT_RELATION(n_views::value, == , boost::mpl::int_<5>::value);
+#else
 BOOST_MPL_ASSERT_RELATION(n_views::value, == , boost::mpl::int_<6>::value);
+#endif
+
+// Frozen graph views
+// ------------------
+//
+// These are the views based on the frozen CSR snapshot of the main graph (see
+// graph_csr.hh). They are only dispatched to by algorithms which explicitly
+// request them via with_frozen<> below, and only if the graph is frozen and no
+// filters are active.
+
+// metafunction to get the frozen version of an unfiltered view (or void if
+// there is none)
+template <class Graph>
+struct get_frozen_view
+{
+    typedef void type;
+};
+
+template <>
+struct get_frozen_view<GraphInterface::multigraph_t>
+{
+    typedef GraphInterface::frozen_graph_t type;
+};
+
+template <>
+struct get_frozen_view<boost::reversed_graph<GraphInterface::multigraph_t>>
+{
+    typedef boost::reversed_graph<GraphInterface::frozen_graph_t> type;
+};
+
+template <>
+struct get_frozen_view<boost::undirected_adaptor<GraphInterface::multigraph_t>>
+{
+    typedef boost::undirected_adaptor<GraphInterface::frozen_graph_t> type;
+};
+
+struct frozen_graph_views:
+    boost::mpl::vector<GraphInterface::frozen_graph_t,
+                       boost::reversed_graph<GraphInterface::frozen_graph_t>,
+                       boost::undirected_adaptor<GraphInterface::frozen_graph_t>>
+{};
+
+// this metafunction appends the frozen counterparts of the unfiltered views
+// contained in GraphViews
+template <class GraphViews>
+struct add_frozen_views
+{
+    typedef typename boost::mpl::transform<
+        GraphViews,
+        get_frozen_view<boost::mpl::_1>>::type frozen_t;
+
+    typedef typename boost::mpl::remove_if<
+        frozen_t,
+        std::is_void<boost::mpl::_1>>::type valid_t;
+
+    typedef typename boost::mpl::copy<
+        valid_t,
+        boost::mpl::back_inserter<GraphViews>>::type type;
+};
+
+// returns true if GraphViews contains any frozen view
+template <class GraphViews>
+struct has_frozen_views
+{
+    typedef typename boost::mpl::find_if<
+        GraphViews,
+        boost::mpl::contains<frozen_graph_views, boost::mpl::_1>>::type iter_t;
+    typedef typename boost::mpl::end<GraphViews>::type end_t;
+    static constexpr bool value = !std::is_same<iter_t, end_t>::value;
+};
+
+// returns the position of a graph view in GraphInterface::_graph_views
+template <class Graph>
+constexpr size_t get_graph_view_index(std::false_type)
+{
+    return boost::mpl::find<all_graph_views, Graph>::type::pos::value;
+}
+
+template <class Graph>
+constexpr size_t get_graph_view_index(std::true_type)
+{
+    return (n_views::value +
+            boost::mpl::find<frozen_graph_views, Graph>::type::pos::value);
+}
+
+template <class Graph>
+constexpr size_t get_graph_view_index()
+{
+    typedef typename boost::mpl::contains<frozen_graph_views, Graph>::type
+        is_frozen_t;
+    return get_graph_view_index<Graph>
+        (std::integral_constant<bool, is_frozen_t::value>());
+}
 
 // run_action() and gt_dispatch() implementation
 // =============================================
 
+// determines whether a dispatched argument holds python objects, in which case
+// the GIL cannot be released while the action runs
+template <class... Ts>
+struct make_void { typedef void type; };
+
+template <class T>
+struct is_python_object:
+    std::is_same<typename std::decay<T>::type, boost::python::object> {};
+
+template <class T, class Enable = void>
+struct has_python_value: is_python_object<T> {};
+
+template <class T>
+struct has_python_value
+    <T, typename make_void<typename std::decay<T>::type::value_type>::type>:
+    std::integral_constant
+        <bool, (is_python_object<T>::value ||
+                is_python_object<typename std::decay<T>::type::value_type>::value)>
+{};
+
+template <class... Ts>
+struct any_python_value: std::false_type {};
+
+template <class T, class... Ts>
+struct any_python_value<T, Ts...>:
+    std::integral_constant<bool, (has_python_value<T>::value ||
+                                  any_python_value<Ts...>::value)> {};
+
 // wrap action to be called, to deal with property maps, i.e., return version
 // with no bounds checking.
 template <class Action, class Wrap>
 struct action_wrap
 {
-    action_wrap(Action a) : _a(a) {}
+    action_wrap(Action a, bool gil_release = false)
+        : _a(a), _gil_release(gil_release) {}
 
     template <class Type, class IndexMap>
     auto& uncheck(boost::checked_vector_property_map<Type,IndexMap>& a,
@@ -431,13 +624,18 @@ struct action_wrap
         return a;
     }
 
+    // if requested, the GIL is released while the action runs, unless any of
+    // the dispatched arguments holds python objects
     template <class... Ts>
     void operator()(Ts&&... as) const
     {
+        GILRelease gil(_gil_release && !any_python_value<Ts...>::value);
+        GT_TRACE_SCOPE("kernel", "kernel", typeid(Action).name());
         _a(deference(uncheck(std::forward<Ts>(as), Wrap()))...);
     }
 
     Action _a;
+    bool _gil_release;
 };
 
 // this takes a functor and type ranges and iterates through the type
@@ -446,7 +644,8 @@ struct action_wrap
 template <class Action, class Wrap, class... TRS>
 struct action_dispatch
 {
-    action_dispatch(Action a) : _a(a) {}
+    action_dispatch(Action a, bool gil_release = false)
+        : _a(a, gil_release) {}
 
     template <class... Args>
     void operator()(Args&&... args) const
@@ -466,26 +665,49 @@ struct action_dispatch
 } // details namespace
 
 // dispatch "Action" across all type combinations
+//
+// If gil_release == true, the GIL is released while the action runs, so that
+// other python threads may proceed. In this case the action must not touch any
+// python object, except from within a GILAcquire scope (e.g. for callbacks);
+// python::object values among the dispatched arguments are detected, and
+// disable the release.
 template <class GraphViews = detail::all_graph_views, class Wrap = boost::mpl::false_>
 struct run_action
 {
+    run_action(bool gil_release = false) : _gil_release(gil_release) {}
+
     template <class Action, class... TRS>
     auto operator()(GraphInterface& gi, Action a, TRS...)
     {
-        auto dispatch = detail::action_dispatch<Action,Wrap,GraphViews,TRS...>(a);
-        auto wrap = [dispatch, &gi](auto&&... args) { dispatch(gi.get_graph_view(), args...); };
+        auto dispatch =
+            detail::action_dispatch<Action,Wrap,GraphViews,TRS...>(a, _gil_release);
+        auto wrap = [dispatch, &gi](auto&&... args)
+            {
+                GT_TRACE_SCOPE("run_action", "dispatch");
+                GT_TRACE_COUNTER("vertices", num_vertices(gi.get_graph()));
+                GT_TRACE_COUNTER("edges", num_edges(gi.get_graph()));
+                dispatch(gi.get_graph_view
+                             (detail::has_frozen_views<GraphViews>::value),
+                         args...);
+            };
         return wrap;
     }
+
+    bool _gil_release;
 };
 
 template <class Wrap = boost::mpl::false_>
 struct gt_dispatch
 {
+    gt_dispatch(bool gil_release = false) : _gil_release(gil_release) {}
+
     template <class Action, class... TRS>
     auto operator()(Action a, TRS...)
     {
-        return detail::action_dispatch<Action,Wrap,TRS...>(a);
+        return detail::action_dispatch<Action,Wrap,TRS...>(a, _gil_release);
     }
+
+    bool _gil_release;
 };
 
 typedef detail::all_graph_views all_graph_views;
@@ -497,9 +719,19 @@ typedef detail::always_directed_never_reversed always_directed_never_reversed;
 typedef detail::never_filtered never_filtered;
 typedef detail::never_filtered_never_reversed never_filtered_never_reversed;
 
+// graph views extended with the corresponding frozen views; e.g.
+// run_action<with_frozen<all_graph_views>>() will dispatch to the frozen CSR
+// snapshot of the graph if available. Only read-only algorithms should use
+// this.
+template <class GraphViews>
+struct with_frozen: detail::add_frozen_views<GraphViews>::type {};
+
 // returns true if graph filtering was enabled at compile time
 bool graph_filtering_enabled();
 
+// returns true if the slim dispatch mode was enabled at compile time
+bool graph_slim_dispatch_enabled();
+
 
 template <class Graph, class GraphInit>
 std::shared_ptr<Graph> get_graph_ptr(GraphInterface& gi, GraphInit&, std::true_type)
@@ -513,6 +745,14 @@ std::shared_ptr<Graph> get_graph_ptr(GraphInterface&, GraphInit& g, std::false_t
     return std::make_shared<Graph>(g);
 }
 
+template <class Graph>
+std::shared_ptr<Graph> get_graph_ptr(GraphInterface& gi,
+                                     GraphInterface::frozen_graph_t&,
+                                     std::false_type)
+{
+    return gi.get_frozen_graph_ptr();
+}
+
 // this function retrieves a graph view stored in graph_views, or stores one if
 // non-existent
 template <class Graph>
@@ -520,7 +760,7 @@ typename std::shared_ptr<Graph>
 retrieve_graph_view(GraphInterface& gi, Graph& init)
 {
     typedef typename std::remove_const<Graph>::type g_t;
-    size_t index = boost::mpl::find<detail::all_graph_views,g_t>::type::pos::value;
+    size_t index = detail::get_graph_view_index<g_t>();
     auto& graph_views = gi.get_graph_views();
     if (index >= graph_views.size())
         graph_views.resize(index + 1);
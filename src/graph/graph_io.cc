@@ -22,6 +22,9 @@
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
+#ifdef HAVE_BOOST_IOSTREAMS_ZSTD
+#include <boost/iostreams/filter/zstd.hpp>
+#endif
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/graph/graphml.hpp>
@@ -297,6 +300,15 @@ void build_stream(boost::iostreams::filtering_stream<boost::iostreams::input>& s
                 stream.push(boost::iostreams::gzip_decompressor());
             if (boost::ends_with(file,".bz2"))
                 stream.push(boost::iostreams::bzip2_decompressor());
+            if (boost::ends_with(file,".zst"))
+            {
+#ifdef HAVE_BOOST_IOSTREAMS_ZSTD
+                stream.push(boost::iostreams::zstd_decompressor());
+#else
+                throw IOException("error reading from file '" + file +
+                                  "': zstd compression is not supported");
+#endif
+            }
             stream.push(file_stream);
         }
         else
@@ -314,17 +326,33 @@ boost::python::tuple GraphInterface::read_from_file(string file,
                                                     string format,
                                                     boost::python::list ignore_vp,
                                                     boost::python::list ignore_ep,
-                                                    boost::python::list ignore_gp)
+                                                    boost::python::list ignore_gp,
+                                                    bool lazy)
 {
     if (format != "gt" && format != "dot" && format != "xml" && format != "gml")
         throw ValueException("error reading from file '" + file +
                              "': requested invalid format '" + format + "'");
+
+    // the graph is replaced, and its modification count starts over
+    unfreeze();
     try
     {
         boost::iostreams::filtering_stream<boost::iostreams::input>
             stream;
         std::ifstream file_stream;
-        build_stream(stream, file, pfile, file_stream);
+
+        // lazy loading requires seeking, which is only possible with
+        // uncompressed files
+        lazy = lazy && format == "gt" && file != "-" &&
+            pfile == boost::python::object() &&
+            !boost::ends_with(file, ".gz") &&
+            !boost::ends_with(file, ".bz2") &&
+            !boost::ends_with(file, ".zst");
+        if (lazy)
+            file_stream.open(file.c_str(), std::ios_base::in |
+                             std::ios_base::binary);
+        else
+            build_stream(stream, file, pfile, file_stream);
 
         std::unordered_set<std::string> ivp, iep, igp;
         for (int i = 0; i < len(ignore_vp); ++i)
@@ -350,12 +378,29 @@ boost::python::tuple GraphInterface::read_from_file(string file,
 
 
         boost::python::dict vprops, eprops, gprops;
+        boost::python::list offsets;
         if (format == "gt")
         {
             vector<pair<string, boost::any>> agprops, avprops, aeprops;
-            stream.exceptions(ios_base::badbit | ios_base::failbit | ios_base::eofbit);
-            _directed = read_graph(stream, *_mg, agprops, avprops, aeprops, igp,
-                                   ivp, iep);
+            if (lazy)
+            {
+                vector<property_offset> poffsets;
+                file_stream.exceptions(ios_base::badbit | ios_base::failbit |
+                                       ios_base::eofbit);
+                _directed = read_graph(file_stream, *_mg, agprops, avprops,
+                                       aeprops, igp, ivp, iep, &poffsets);
+                for (auto& p : poffsets)
+                    offsets.append(boost::python::make_tuple
+                                   ((p.type == property_type::Vertex) ? "v" : "e",
+                                    p.name, p.offset));
+            }
+            else
+            {
+                stream.exceptions(ios_base::badbit | ios_base::failbit |
+                                  ios_base::eofbit);
+                _directed = read_graph(stream, *_mg, agprops, avprops, aeprops,
+                                       igp, ivp, iep);
+            }
             for (auto& p : agprops)
                 gprops[p.first] = find_property_map(p.second, _graph_index);
             for (auto& p : avprops)
@@ -378,7 +423,7 @@ boost::python::tuple GraphInterface::read_from_file(string file,
                                                             _graph_index);
             }
         }
-        return boost::python::make_tuple(vprops, eprops, gprops);
+        return boost::python::make_tuple(vprops, eprops, gprops, offsets);
     }
     catch (ios_base::failure &e)
     {
@@ -394,6 +439,45 @@ boost::python::tuple GraphInterface::read_from_file(string file,
     }
 };
 
+boost::python::object GraphInterface::read_property_from_file(string file,
+                                                             int64_t offset)
+{
+    try
+    {
+        std::ifstream file_stream;
+        file_stream.exceptions(ios_base::badbit | ios_base::failbit |
+                               ios_base::eofbit);
+        file_stream.open(file.c_str(), std::ios_base::in |
+                         std::ios_base::binary);
+        auto p = read_property_at(file_stream, *_mg, offset);
+        if (p.first == property_type::Vertex)
+            return find_property_map(p.second, _vertex_index);
+        return find_property_map(p.second, _edge_index);
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+}
+
+void graph_tool::stream_gt_file(const string& file, boost::python::object pfile,
+                                gt_stream_visitor& vis, bool properties)
+{
+    try
+    {
+        boost::iostreams::filtering_stream<boost::iostreams::input> stream;
+        std::ifstream file_stream;
+        build_stream(stream, file, pfile, file_stream);
+        stream.exceptions(ios_base::badbit | ios_base::failbit |
+                          ios_base::eofbit);
+        visit_graph(stream, vis, properties);
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+}
+
 template <class IndexMap>
 string graphviz_insert_index(dynamic_properties& dp, IndexMap index_map,
                              bool insert = true)
@@ -442,9 +526,11 @@ struct do_write_to_binary_file
     void operator()(ostream& stream, Graph& g, IndexMap index_map, size_t N,
                     bool directed, vector<pair<string, boost::any >> & gprops,
                     vector<pair<string, boost::any >> & vprops,
-                    vector<pair<string, boost::any >> & eprops) const
+                    vector<pair<string, boost::any >> & eprops,
+                    bool varint) const
     {
-        write_graph(g, index_map, N, directed, gprops, vprops, eprops, stream);
+        write_graph(g, index_map, N, directed, gprops, vprops, eprops, varint,
+                    stream);
     }
 };
 
@@ -461,7 +547,8 @@ struct generate_index
 };
 
 void GraphInterface::write_to_file(string file, boost::python::object pfile,
-                                   string format, boost::python::list props)
+                                   string format, boost::python::list props,
+                                   bool compact_adjacency)
 {
     if (format != "gt" && format != "xml" && format != "dot" && format != "gml")
         throw ValueException("error writing to file '" + file +
@@ -483,6 +570,15 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                     stream.push(boost::iostreams::gzip_compressor());
                 if (boost::ends_with(file,".bz2"))
                     stream.push(boost::iostreams::bzip2_compressor());
+                if (boost::ends_with(file,".zst"))
+                {
+#ifdef HAVE_BOOST_IOSTREAMS_ZSTD
+                    stream.push(boost::iostreams::zstd_compressor());
+#else
+                    throw IOException("error writing to file '" + file +
+                                      "': zstd compression is not supported");
+#endif
+                }
                 stream.push(file_stream);
             }
             else
@@ -530,7 +626,8 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                compact_adjacency))();
             }
             else
             {
@@ -542,7 +639,8 @@ void GraphInterface::write_to_file(string file, boost::python::object pfile,
                                                 directed,
                                                 std::ref(agprops),
                                                 std::ref(avprops),
-                                                std::ref(aeprops)))();
+                                                std::ref(aeprops),
+                                                compact_adjacency))();
             }
 
             _directed = directed;
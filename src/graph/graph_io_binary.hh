@@ -22,7 +22,11 @@
 #include "graph.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "graph_io_stream.hh"
 #include <unordered_set>
+#include <array>
+#include <type_traits>
+#include <tuple>
 
 namespace graph_tool
 {
@@ -31,6 +35,9 @@ const char* _magic = u8"⛾ gt";
 size_t _magic_length = 6;
 const uint8_t _version = 1;
 
+// files in this version store the adjacency as delta-encoded varints
+const uint8_t _version_varint = 2;
+
 // deal with endianness
 
 inline bool is_bigendian()
@@ -165,30 +172,137 @@ void skip(std::istream& s, const boost::python::object&)
     skip<BE>(s, std::string());
 };
 
-template <class Vint, class Graph, class VProp>
-void write_adjacency_dispatch(Graph& g, const VProp& vindex, std::ostream& s)
+template <typename T>
+void append(std::string& buf, T v)
+{
+    buf.append(reinterpret_cast<const char*>(&v), sizeof(T));
+};
+
+// LEB128 encoding of unsigned integers, and zigzag mapping of signed integers
+// to unsigned ones, such that values of small magnitude take few bytes
+
+inline void append_varint(std::string& buf, uint64_t x)
+{
+    while (x >= 0x80)
+    {
+        buf.push_back(char((x & 0x7f) | 0x80));
+        x >>= 7;
+    }
+    buf.push_back(char(x));
+}
+
+inline uint64_t read_varint(std::streambuf& sb)
+{
+    uint64_t x = 0;
+    for (size_t shift = 0; shift < 64; shift += 7)
+    {
+        auto c = sb.sbumpc();
+        if (c == std::streambuf::traits_type::eof())
+            throw IOException("error reading graph: unexpected end of file");
+        x |= uint64_t(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            return x;
+    }
+    throw IOException("error reading graph: invalid varint");
+}
+
+inline uint64_t zigzag_encode(int64_t x)
+{
+    return (uint64_t(x) << 1) ^ uint64_t(x >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t x)
+{
+    return int64_t(x >> 1) ^ -int64_t(x & 1);
+}
+
+// The neighbor lists are encoded in parallel, in blocks of consecutive
+// vertices, which are then written to the stream sequentially, in order. The
+// function encode(i, v, buf) appends the neighbor list of vertex v, with new
+// index i, to buf.
+template <class Graph, class Encode>
+void write_adjacency_blocks(Graph& g, std::ostream& s, Encode&& encode)
 {
-    for (auto v : vertices_range(g))
+    const size_t block_size = 1 << 12;
+    const size_t round_blocks = 256;
+
+    size_t N = num_vertices(g);
+    std::vector<std::string> bufs(round_blocks);
+    for (size_t r = 0; r < N; r += block_size * round_blocks)
     {
-        size_t k = out_degree(v, g);
-        std::vector<Vint> us;
-        us.reserve(k);
-        for (auto e : out_edges_range(v, g))
-            us.push_back(vindex[target(e, g)]);
-        write(s, us);
+        size_t nb = std::min(round_blocks,
+                             (N - r + block_size - 1) / block_size);
+
+        #pragma omp parallel for schedule(dynamic) \
+            if (N - r > OPENMP_MIN_THRESH)
+        for (size_t b = 0; b < nb; ++b)
+        {
+            auto& buf = bufs[b];
+            buf.clear();
+            size_t begin = r + b * block_size;
+            size_t end = std::min(begin + block_size, N);
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto v = vertex(i, g);
+                if (!is_valid_vertex(v, g))
+                    continue;
+                encode(v, buf);
+            }
+        }
+
+        for (size_t b = 0; b < nb; ++b)
+            s.write(bufs[b].data(), bufs[b].size());
     }
 }
 
+template <class Vint, class Graph, class VProp>
+void write_adjacency_dispatch(Graph& g, const VProp& vindex, std::ostream& s)
+{
+    write_adjacency_blocks
+        (g, s,
+         [&](auto v, auto& buf)
+         {
+             uint64_t k = out_degree(v, g);
+             append(buf, k);
+             for (auto e : out_edges_range(v, g))
+                 append(buf, Vint(vindex[target(e, g)]));
+         });
+}
+
+// Each neighbor list is stored as its length, followed by the differences
+// between consecutive neighbors (the first one relative to the source), all
+// as varints. The order of the edges is preserved, so that the edge property
+// values remain aligned.
+template <class Graph, class VProp>
+void write_adjacency_varint(Graph& g, const VProp& vindex, std::ostream& s)
+{
+    write_adjacency_blocks
+        (g, s,
+         [&](auto v, auto& buf)
+         {
+             append_varint(buf, out_degree(v, g));
+             int64_t last = vindex[v];
+             for (auto e : out_edges_range(v, g))
+             {
+                 int64_t u = vindex[target(e, g)];
+                 append_varint(buf, zigzag_encode(u - last));
+                 last = u;
+             }
+         });
+}
+
 
 template <class Graph, class VProp>
 void write_adjacency(Graph& g, const VProp& vindex, uint64_t N,
-                     bool is_directed, std::ostream& s)
+                     bool is_directed, bool varint, std::ostream& s)
 {
     uint8_t directed = is_directed;
     write(s, directed);
     write(s, N);
 
-    if (N <= numeric_limits<uint8_t>::max())
+    if (varint)
+        write_adjacency_varint(g, vindex, s);
+    else if (N <= numeric_limits<uint8_t>::max())
         write_adjacency_dispatch<uint8_t>(g, vindex, s);
     else if (N <= numeric_limits<uint16_t>::max())
         write_adjacency_dispatch<uint16_t>(g, vindex, s);
@@ -198,27 +312,72 @@ void write_adjacency(Graph& g, const VProp& vindex, uint64_t N,
         write_adjacency_dispatch<uint64_t>(g, vindex, s);
 }
 
-template <bool BE, class Vint, class Graph>
-void read_adjacency_dispatch(Graph& g, size_t N, std::istream& s)
+// The neighbor lists are decoded by calling f(v, u) for every edge, in the
+// order in which they are stored.
+template <bool BE, class Vint, class F>
+void visit_adjacency_dispatch(size_t N, std::istream& s, F&& f)
 {
-    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-    for (vertex_t v = 0; v < N; ++v)
+    std::vector<Vint> us;
+    for (size_t v = 0; v < N; ++v)
     {
-        std::vector<Vint> us;
         read<BE>(s, us);
-        for (vertex_t u : us)
+        for (Vint u : us)
         {
             if (u >= N)
                 throw IOException("error reading graph: vertex index not in range");
-            add_edge(v, u, g);
+            f(v, u);
+        }
+    }
+}
+
+template <class F>
+void visit_adjacency_varint(size_t N, std::istream& s, F&& f)
+{
+    std::streambuf& sb = *s.rdbuf();
+    for (size_t v = 0; v < N; ++v)
+    {
+        uint64_t k = read_varint(sb);
+        int64_t u = v;
+        for (size_t i = 0; i < k; ++i)
+        {
+            u += zigzag_decode(read_varint(sb));
+            if (u < 0 || size_t(u) >= N)
+                throw IOException("error reading graph: vertex index not in range");
+            f(v, size_t(u));
         }
     }
 }
 
+template <bool BE, class F>
+void visit_adjacency(size_t N, bool varint, std::istream& s, F&& f)
+{
+    if (varint)
+        visit_adjacency_varint(N, s, f);
+    else if (N <= numeric_limits<uint8_t>::max())
+        visit_adjacency_dispatch<BE, uint8_t>(N, s, f);
+    else if (N <= numeric_limits<uint16_t>::max())
+        visit_adjacency_dispatch<BE, uint16_t>(N, s, f);
+    else if (N <= numeric_limits<uint32_t>::max())
+        visit_adjacency_dispatch<BE, uint32_t>(N, s, f);
+    else
+        visit_adjacency_dispatch<BE, uint64_t>(N, s, f);
+}
+
+template <bool BE, class Vint, class Graph>
+void read_adjacency_dispatch(Graph& g, size_t N, bool varint, std::istream& s)
+{
+    // the edges are collected in a single list, and inserted in bulk
+    std::vector<std::array<Vint, 2>> edges;
+    visit_adjacency<BE>(N, varint, s,
+                        [&](size_t v, size_t u)
+                        {
+                            edges.push_back({{Vint(v), Vint(u)}});
+                        });
+    add_edges(edges, g);
+}
 
 template <bool BE, class Graph>
-bool read_adjacency(Graph& g, std::istream& s)
+bool read_adjacency(Graph& g, bool varint, std::istream& s)
 {
     uint8_t directed = false;
     read<BE>(s, directed);
@@ -230,26 +389,19 @@ bool read_adjacency(Graph& g, std::istream& s)
         add_vertex(g);
 
     if (N <= numeric_limits<uint8_t>::max())
-        read_adjacency_dispatch<BE, uint8_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint8_t>(g, N, varint, s);
     else if (N <= numeric_limits<uint16_t>::max())
-        read_adjacency_dispatch<BE, uint16_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint16_t>(g, N, varint, s);
     else if (N <= numeric_limits<uint32_t>::max())
-        read_adjacency_dispatch<BE, uint32_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint32_t>(g, N, varint, s);
     else
-        read_adjacency_dispatch<BE, uint64_t>(g, N, s);
+        read_adjacency_dispatch<BE, uint64_t>(g, N, varint, s);
 
     return directed;
 }
 
 // Property maps
 
-enum class property_type : uint8_t
-{
-    Graph,
-    Vertex,
-    Edge
-};
-
 using namespace boost;
 
 typedef mpl::joint_view<value_types,
@@ -271,6 +423,9 @@ struct graph_range_traits
     template <class Graph>
     static graph_range get_range(Graph&) { return graph_range(); }
 
+    template <class Graph>
+    static size_t get_size(Graph&) { return 1; }
+
     static property_type get_property_id() { return property_type::Graph; }
 };
 
@@ -285,6 +440,9 @@ struct vertex_range_traits
     IterRange<typename boost::graph_traits<Graph>::vertex_iterator>
     static get_range(Graph& g) { return vertices_range(g); }
 
+    template <class Graph>
+    static size_t get_size(Graph& g) { return num_vertices(g); }
+
     static property_type get_property_id() { return property_type::Vertex; }
 };
 
@@ -299,6 +457,9 @@ struct edge_range_traits
     IterRange<typename boost::graph_traits<Graph>::edge_iterator>
     static get_range(Graph& g) { return edges_range(g); }
 
+    template <class Graph>
+    static size_t get_size(Graph& g) { return num_edges(g); }
+
     static property_type get_property_id() { return property_type::Edge; }
 };
 
@@ -317,13 +478,44 @@ struct write_property_dispatch
             typedef typename mpl::find<val_types, T>::type pos;
             uint8_t val = mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value;
             write(s, val);
-            for (auto x : RangeTraits::get_range(g))
-                write(s, prop[x]);
+            write_values(g, prop, std::is_arithmetic<T>(), s);
             found = true;
         }
         catch (const boost::bad_any_cast&) {}
     }
 
+    // scalar values are gathered in chunks and written in a single call
+    template <class Graph, class PMap>
+    void write_values(Graph& g, PMap& prop, std::true_type,
+                      std::ostream& s) const
+    {
+        typedef typename property_traits<PMap>::value_type val_t;
+        std::vector<val_t> buf;
+        buf.reserve(_chunk_size);
+        for (auto x : RangeTraits::get_range(g))
+        {
+            buf.push_back(prop[x]);
+            if (buf.size() == _chunk_size)
+            {
+                s.write(reinterpret_cast<const char*>(buf.data()),
+                        sizeof(val_t) * buf.size());
+                buf.clear();
+            }
+        }
+        s.write(reinterpret_cast<const char*>(buf.data()),
+                sizeof(val_t) * buf.size());
+    }
+
+    template <class Graph, class PMap>
+    void write_values(Graph& g, PMap& prop, std::false_type,
+                      std::ostream& s) const
+    {
+        for (auto x : RangeTraits::get_range(g))
+            write(s, prop[x]);
+    }
+
+    static constexpr size_t _chunk_size = 1 << 16;
+
 
     template <class Graph>
     void operator()(size_t, Graph& g, boost::any& aprop, bool& found,
@@ -397,34 +589,74 @@ struct read_property_dispatch
             pmap_t prop(RangeTraits::get_index_map(g));
             if (!ignore)
             {
-                for (auto x : RangeTraits::get_range(g))
-                    read<BE>(s, prop[x]);
+                read_values(g, prop, std::is_arithmetic<T>(), s);
                 aprop = prop;
             }
             else
             {
-                T y;
-                for (auto x : RangeTraits::get_range(g))
-                {
-                    (void)x;
-                    skip<BE>(s, y);
-                }
+                skip_values<T>(g, std::is_arithmetic<T>(), s);
             }
             found = true;
         }
     }
+
+    // Since the graph has just been read, the descriptors in the range are
+    // ordered by index, and scalar values can be read directly into the
+    // property map storage, in a single call.
+    template <class Graph, class PMap>
+    void read_values(Graph& g, PMap& prop, std::true_type,
+                     std::istream& s) const
+    {
+        size_t n = RangeTraits::get_size(g);
+        auto& vals = prop.get_storage();
+        vals.resize(n);
+        s.read(reinterpret_cast<char*>(vals.data()),
+               sizeof(typename PMap::value_type) * n);
+        if (BE != is_bigendian())
+        {
+            #pragma omp parallel for schedule(runtime) \
+                if (n > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < n; ++i)
+                byte_swap<BE>(vals[i]);
+        }
+    }
+
+    template <class Graph, class PMap>
+    void read_values(Graph& g, PMap& prop, std::false_type,
+                     std::istream& s) const
+    {
+        for (auto x : RangeTraits::get_range(g))
+            read<BE>(s, prop[x]);
+    }
+
+    template <class T, class Graph>
+    void skip_values(Graph& g, std::true_type, std::istream& s) const
+    {
+        s.ignore(sizeof(T) * RangeTraits::get_size(g));
+    }
+
+    template <class T, class Graph>
+    void skip_values(Graph& g, std::false_type, std::istream& s) const
+    {
+        T y;
+        for (auto x : RangeTraits::get_range(g))
+        {
+            (void)x;
+            skip<BE>(s, y);
+        }
+    }
 };
 
 template <bool BE, class RangeTraits, class Graph>
 std::pair<std::string, boost::any>
 read_property(Graph& g, const std::unordered_set<std::string>& ignore,
-              std::istream& s)
+              std::istream& s, bool lazy = false)
 {
     boost::any prop;
     bool found = false;
     std::string name;
     read<BE>(s, name);
-    bool skip = ignore.find(name) != ignore.end();
+    bool skip = lazy || ignore.find(name) != ignore.end();
     uint8_t val = 0;
     read<BE>(s, val);
     mpl::for_each<val_types>(std::bind(read_property_dispatch<BE, RangeTraits>(),
@@ -442,10 +674,11 @@ template <class Graph, class VProp>
 void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
                  std::vector<std::pair<std::string, boost::any>>& gprops,
                  std::vector<std::pair<std::string, boost::any>>& vprops,
-                 std::vector<std::pair<std::string, boost::any>>& eprops, std::ostream& s)
+                 std::vector<std::pair<std::string, boost::any>>& eprops,
+                 bool varint, std::ostream& s)
 {
     s.write(_magic, _magic_length);
-    write(s, _version);
+    write(s, varint ? _version_varint : _version);
     uint8_t big_end = is_bigendian();
     write(s, big_end);
     string comment = "graph-tool binary file (http:://graph-tool.skewed.de)"
@@ -458,7 +691,7 @@ void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
         lexical_cast<std::string>(eprops.size()) + " edge props";
     write(s, comment);
 
-    write_adjacency(g, vindex, N, directed, s);
+    write_adjacency(g, vindex, N, directed, varint, s);
     uint64_t nprops = gprops.size() + vprops.size() + eprops.size();
     write(s, nprops);
     for (auto& p : gprops)
@@ -469,6 +702,15 @@ void write_graph(Graph& g, const VProp& vindex, size_t N, bool directed,
         write_property<edge_range_traits>(g, p.first, p.second, s);
 }
 
+// Location of a vertex or edge property which was skipped while reading the
+// graph, so that it can be loaded later with read_property_at().
+struct property_offset
+{
+    property_type type;
+    std::string name;
+    int64_t offset;
+};
+
 template <bool BE, class Graph>
 bool read_graph_dispatch(Graph& g,
                          std::vector<std::pair<std::string, boost::any>>& gprops,
@@ -477,13 +719,15 @@ bool read_graph_dispatch(Graph& g,
                          const std::unordered_set<std::string>& ignore_gp,
                          const std::unordered_set<std::string>& ignore_vp,
                          const std::unordered_set<std::string>& ignore_ep,
+                         bool varint, std::vector<property_offset>* lazy,
                          std::istream& s)
 {
-    bool directed = read_adjacency<BE>(g, s);
+    bool directed = read_adjacency<BE>(g, varint, s);
     uint64_t nprops;
     read<BE>(s, nprops);
     for (size_t i = 0; i < nprops; ++i)
     {
+        int64_t offset = (lazy != nullptr) ? int64_t(s.tellg()) : -1;
         property_type pt;
         read<BE>(s, pt);
         std::pair<std::string, boost::any> p;
@@ -495,14 +739,20 @@ bool read_graph_dispatch(Graph& g,
                 gprops.push_back(p);
             break;
         case property_type::Vertex:
-            p = read_property<BE, vertex_range_traits>(g, ignore_vp, s);
+            p = read_property<BE, vertex_range_traits>(g, ignore_vp, s,
+                                                       lazy != nullptr);
             if (!p.second.empty())
                 vprops.push_back(p);
+            else if (lazy != nullptr && ignore_vp.find(p.first) == ignore_vp.end())
+                lazy->push_back({pt, p.first, offset});
             break;
         case property_type::Edge:
-            p = read_property<BE, edge_range_traits>(g, ignore_ep, s);
+            p = read_property<BE, edge_range_traits>(g, ignore_ep, s,
+                                                     lazy != nullptr);
             if (!p.second.empty())
                 eprops.push_back(p);
+            else if (lazy != nullptr && ignore_ep.find(p.first) == ignore_ep.end())
+                lazy->push_back({pt, p.first, offset});
             break;
         default:
             throw IOException("Error reading graph: invalid property type " +
@@ -513,14 +763,9 @@ bool read_graph_dispatch(Graph& g,
 }
 
 
-template <class Graph>
-bool read_graph(std::istream& s, Graph& g,
-                std::vector<std::pair<std::string, boost::any>>& gprops,
-                std::vector<std::pair<std::string, boost::any>>& vprops,
-                std::vector<std::pair<std::string, boost::any>>& eprops,
-                const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>(),
-                const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
-                const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>())
+// Reads the header of the file, and returns whether it is big-endian and
+// whether it uses the variable-length adjacency encoding.
+inline std::pair<bool, bool> read_header(std::istream& s)
 {
     char magic[_magic_length];
     s.read(magic, _magic_length);
@@ -528,20 +773,204 @@ bool read_graph(std::istream& s, Graph& g,
         throw IOException("Error reading graph: Invalid magic number");
     uint8_t version = 0;
     read<false>(s, version);
-    if (version != _version)
+    if (version != _version && version != _version_varint)
         throw IOException("Error reading graph: Invalid format version " +
                           boost::lexical_cast<std::string>(version));
     uint8_t big_end = 0;
     read<false>(s, big_end);
     string comment;
     read<false>(s, comment);
+    return std::make_pair(bool(big_end), version == _version_varint);
+}
 
+// If "lazy" is given, the vertex and edge properties which are not ignored are
+// skipped, and their positions in the stream are recorded instead. This
+// requires a seekable stream.
+template <class Graph>
+bool read_graph(std::istream& s, Graph& g,
+                std::vector<std::pair<std::string, boost::any>>& gprops,
+                std::vector<std::pair<std::string, boost::any>>& vprops,
+                std::vector<std::pair<std::string, boost::any>>& eprops,
+                const std::unordered_set<std::string>& ignore_gp = std::unordered_set<std::string>(),
+                const std::unordered_set<std::string>& ignore_vp = std::unordered_set<std::string>(),
+                const std::unordered_set<std::string>& ignore_ep = std::unordered_set<std::string>(),
+                std::vector<property_offset>* lazy = nullptr)
+{
+    bool big_end, varint;
+    std::tie(big_end, varint) = read_header(s);
     if (big_end)
         return read_graph_dispatch<true>(g, gprops, vprops, eprops, ignore_gp,
-                                         ignore_vp, ignore_ep, s);
+                                         ignore_vp, ignore_ep, varint, lazy, s);
     else
         return read_graph_dispatch<false>(g, gprops, vprops, eprops, ignore_gp,
-                                          ignore_vp, ignore_ep, s);
+                                          ignore_vp, ignore_ep, varint, lazy, s);
+}
+
+template <bool BE, class Graph>
+std::pair<property_type, boost::any>
+read_property_at_dispatch(Graph& g, std::istream& s)
+{
+    property_type pt;
+    read<BE>(s, pt);
+    std::unordered_set<std::string> ignore;
+    std::pair<std::string, boost::any> p;
+    switch (pt)
+    {
+    case property_type::Vertex:
+        p = read_property<BE, vertex_range_traits>(g, ignore, s);
+        break;
+    case property_type::Edge:
+        p = read_property<BE, edge_range_traits>(g, ignore, s);
+        break;
+    default:
+        throw IOException("Error reading graph: invalid property type " +
+                          boost::lexical_cast<std::string>(uint8_t(pt)) +
+                          " at requested offset");
+    }
+    return std::make_pair(pt, p.second);
+}
+
+// Reads a single property, at a position previously recorded by read_graph().
+// The graph must not have been modified since it was read.
+template <class Graph>
+std::pair<property_type, boost::any>
+read_property_at(std::istream& s, Graph& g, int64_t offset)
+{
+    bool big_end = read_header(s).first;
+    s.seekg(offset);
+    if (big_end)
+        return read_property_at_dispatch<true>(g, s);
+    else
+        return read_property_at_dispatch<false>(g, s);
+}
+
+// Reads the n values of a property with value type index val, passing each of
+// them to f(x), if the type is scalar and "visit" is true, or skipping them
+// otherwise.
+template <bool BE>
+struct visit_property_dispatch
+{
+    template <class T, class F>
+    void operator()(T, uint8_t val, size_t n, bool visit, F& f, bool& found,
+                    bool& scalar, std::istream& s) const
+    {
+        typedef typename mpl::find<val_types, T>::type pos;
+        if (mpl::distance<typename mpl::begin<val_types>::type, pos>::type::value != val)
+            return;
+        found = true;
+        scalar = std::is_arithmetic<T>::value;
+        dispatch<T>(n, visit, f, s, std::is_arithmetic<T>());
+    }
+
+    template <class T, class F>
+    void dispatch(size_t n, bool visit, F& f, std::istream& s,
+                  std::true_type) const
+    {
+        if (!visit)
+        {
+            s.ignore(sizeof(T) * n);
+            return;
+        }
+
+        // the values are read in chunks of fixed size
+        std::vector<T> vals(std::min(n, size_t(1) << 16));
+        for (size_t i = 0; i < n; i += vals.size())
+        {
+            size_t m = std::min(vals.size(), n - i);
+            s.read(reinterpret_cast<char*>(vals.data()), sizeof(T) * m);
+            for (size_t j = 0; j < m; ++j)
+            {
+                byte_swap<BE>(vals[j]);
+                f(vals[j]);
+            }
+        }
+    }
+
+    template <class T, class F>
+    void dispatch(size_t n, bool, F&, std::istream& s, std::false_type) const
+    {
+        T y;
+        for (size_t i = 0; i < n; ++i)
+            skip<BE>(s, y);
+    }
+};
+
+template <bool BE, class Visitor>
+bool visit_graph_dispatch(Visitor& vis, bool varint, bool properties,
+                          std::istream& s)
+{
+    uint8_t directed = false;
+    read<BE>(s, directed);
+    uint64_t N = 0;
+    read<BE>(s, N);
+
+    vis.init(directed, N);
+    size_t E = 0;
+    visit_adjacency<BE>(N, varint, s,
+                        [&](size_t v, size_t u)
+                        {
+                            vis.edge(v, u);
+                            ++E;
+                        });
+    if (!properties)
+        return directed;
+
+    uint64_t nprops;
+    read<BE>(s, nprops);
+    for (size_t i = 0; i < nprops; ++i)
+    {
+        property_type pt;
+        read<BE>(s, pt);
+        std::string name;
+        read<BE>(s, name);
+        uint8_t val = 0;
+        read<BE>(s, val);
+
+        size_t n;
+        switch (pt)
+        {
+        case property_type::Graph:
+            n = 1;
+            break;
+        case property_type::Vertex:
+            n = N;
+            break;
+        case property_type::Edge:
+            n = E;
+            break;
+        default:
+            throw IOException("Error reading graph: invalid property type " +
+                              boost::lexical_cast<std::string>(uint8_t(pt)));
+        }
+
+        bool visit = vis.property(pt, name);
+        bool found = false, scalar = false;
+        auto f = [&](auto x) { vis.value(x); };
+        mpl::for_each<val_types>(std::bind(visit_property_dispatch<BE>(),
+                                           std::placeholders::_1, val, n,
+                                           visit, std::ref(f), std::ref(found),
+                                           std::ref(scalar), std::ref(s)));
+        if (!found)
+            throw IOException("Error reading graph: invalid property value type index "
+                              + boost::lexical_cast<std::string>(val));
+        if (visit && !scalar)
+            throw ValueException("property '" + name + "' is not of scalar type");
+    }
+    return directed;
+}
+
+// Reads a graph file as a stream, without building the graph, calling the
+// visitor as described for gt_stream_visitor. Returns whether the graph is
+// directed.
+template <class Visitor>
+bool visit_graph(std::istream& s, Visitor& vis, bool properties = true)
+{
+    bool big_end, varint;
+    std::tie(big_end, varint) = read_header(s);
+    if (big_end)
+        return visit_graph_dispatch<true>(vis, varint, properties, s);
+    else
+        return visit_graph_dispatch<false>(vis, varint, properties, s);
 }
 
 } // namespace graph_tool
@@ -0,0 +1,434 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/python.hpp>
+#include <boost/python/stl_iterator.hpp>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <fstream>
+#include <array>
+#include <cstring>
+#include <limits>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_properties.hh"
+#include "graph_util.hh"
+#include "hash_map_wrap.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+void build_stream(boost::iostreams::filtering_stream<boost::iostreams::input>& stream,
+                  const string& file, boost::python::object& pfile,
+                  std::ifstream& file_stream);
+
+// Streaming reader of edge lists, either from delimiter-separated text files or
+// from binary files containing pairs of fixed-width integers. The input is
+// processed in chunks of complete lines, which are tokenized and converted in
+// parallel; only the mapping of vertex identifiers, and the insertion of the
+// edges, are sequential.
+
+typedef GraphInterface::multigraph_t graph_t;
+typedef GraphInterface::edge_t edge_t;
+typedef vprop_map_t<std::string>::type vname_t;
+typedef vprop_map_t<int64_t>::type vid_t;
+typedef DynamicPropertyMapWrap<std::string, edge_t> eprop_t;
+
+const size_t _chunk_size = 1 << 26;
+
+// largest valid vertex index, since the largest value of size_t is the null
+// vertex
+constexpr size_t _max_index = std::numeric_limits<size_t>::max() - 1;
+
+// parse a non-negative decimal integer in [begin, end), which must not exceed
+// _max_index
+bool parse_index(const char* begin, const char* end, size_t& x)
+{
+    if (begin == end)
+        return false;
+    x = 0;
+    for (; begin != end; ++begin)
+    {
+        if (*begin < '0' || *begin > '9')
+            return false;
+        size_t d = *begin - '0';
+        if (x > (_max_index - d) / 10)
+            return false;
+        x = x * 10 + d;
+    }
+    return true;
+}
+
+class edge_list_text_reader
+{
+public:
+    edge_list_text_reader(graph_t& g, const string& delim,
+                          const string& comment, size_t scol, size_t tcol,
+                          bool hashed, vname_t vname,
+                          vector<eprop_t>& eprops)
+        : _g(g), _delim(delim), _comment(comment), _scol(scol), _tcol(tcol),
+          _hashed(hashed), _vname(vname), _eprops(eprops)
+    {
+        _ncols = std::max(std::max(scol, tcol) + 1, eprops.size() + 2);
+        for (size_t i = 0; i < _ncols && _pcols.size() < eprops.size(); ++i)
+        {
+            if (i != scol && i != tcol)
+                _pcols.push_back(i);
+        }
+    }
+
+    void read(std::istream& s, bool skip_first)
+    {
+        string buf;
+        size_t carry = 0;
+        size_t chunk = _chunk_size;
+        _skip_first = skip_first;
+        while (true)
+        {
+            buf.resize(carry + chunk);
+            s.read(&buf[carry], chunk);
+            size_t n = carry + s.gcount();
+            bool last = size_t(s.gcount()) < chunk;
+            buf.resize(n);
+
+            size_t end = n;
+            if (!last)
+            {
+                end = buf.rfind('\n');
+                if (end == string::npos || end < carry)
+                {
+                    // no complete line in this chunk; read more
+                    carry = n;
+                    chunk *= 2;
+                    continue;
+                }
+                end++;
+            }
+
+            process(buf, end);
+
+            buf.erase(0, end);
+            carry = buf.size();
+            if (last)
+                break;
+        }
+    }
+
+private:
+    bool is_delim(char c) const
+    {
+        if (_delim.empty())
+            return c == ' ' || c == '\t';
+        return _delim.find(c) != string::npos;
+    }
+
+    // tokenize the line [b, e), and return the status of the line: 0 if it
+    // should be skipped, 1 if it is valid, and 2 if it has too few columns
+    uint8_t tokenize(const string& buf, size_t b, size_t e,
+                     pair<size_t, size_t>* toks) const
+    {
+        while (e > b && (buf[e - 1] == '\r' || buf[e - 1] == '\n'))
+            e--;
+        size_t i = b;
+        while (i < e && (buf[i] == ' ' || buf[i] == '\t'))
+            i++;
+        if (i == e || _comment.find(buf[i]) != string::npos)
+            return 0;
+        if (!_delim.empty())
+            i = b;
+
+        size_t k = 0;
+        while (k < _ncols)
+        {
+            size_t j = i;
+            while (j < e && !is_delim(buf[j]))
+                j++;
+            toks[k++] = {i, j};
+            if (j == e)
+                break;
+            i = j + 1;
+            if (_delim.empty())
+            {
+                while (i < e && is_delim(buf[i]))
+                    i++;
+                if (i == e)
+                    break;
+            }
+        }
+        return (k < _ncols) ? 2 : 1;
+    }
+
+    size_t get_vertex(const string& buf, const pair<size_t, size_t>& tok)
+    {
+        string name(buf.data() + tok.first, tok.second - tok.first);
+        auto iter = _vertices.find(name);
+        if (iter != _vertices.end())
+            return iter->second;
+        size_t v = add_vertex(_g);
+        _vname[v] = name;
+        _vertices[name] = v;
+        return v;
+    }
+
+    void process(const string& buf, size_t end)
+    {
+        vector<size_t> lines;
+        size_t pos = 0;
+        while (pos < end)
+        {
+            lines.push_back(pos);
+            auto next = static_cast<const char*>
+                (memchr(buf.data() + pos, '\n', end - pos));
+            pos = (next == nullptr) ? end : (next - buf.data()) + 1;
+        }
+        lines.push_back(end);
+
+        size_t first = 0;
+        if (_skip_first && lines.size() > 1)
+        {
+            first = 1;
+            _skip_first = false;
+        }
+
+        size_t L = lines.size() - 1;
+        vector<pair<size_t, size_t>> toks(L * _ncols);
+        vector<uint8_t> status(L, 0);
+        vector<std::array<size_t, 2>> ids(_hashed ? 0 : L);
+
+        #pragma omp parallel for schedule(runtime) if (L > OPENMP_MIN_THRESH)
+        for (size_t l = first; l < L; ++l)
+        {
+            auto tok = &toks[l * _ncols];
+            status[l] = tokenize(buf, lines[l], lines[l + 1], tok);
+            if (status[l] != 1 || _hashed)
+                continue;
+            for (size_t k = 0; k < 2; ++k)
+            {
+                auto& t = tok[(k == 0) ? _scol : _tcol];
+                if (!parse_index(buf.data() + t.first, buf.data() + t.second,
+                                 ids[l][k]))
+                    status[l] = 3;
+            }
+        }
+
+        vector<std::array<size_t, 2>> edges;
+        vector<size_t> elines;
+        size_t N = num_vertices(_g);
+        for (size_t l = first; l < L; ++l)
+        {
+            switch (status[l])
+            {
+            case 0:
+                continue;
+            case 2:
+                throw IOException("line " + lexical_cast<string>(_line + l + 1) +
+                                  " has fewer than " +
+                                  lexical_cast<string>(_ncols) + " columns");
+            case 3:
+                throw IOException("invalid vertex index in line " +
+                                  lexical_cast<string>(_line + l + 1));
+            }
+
+            auto tok = &toks[l * _ncols];
+            if (_hashed)
+            {
+                size_t s = get_vertex(buf, tok[_scol]);
+                size_t t = get_vertex(buf, tok[_tcol]);
+                edges.push_back({{s, t}});
+            }
+            else
+            {
+                edges.push_back(ids[l]);
+                N = std::max(N, std::max(ids[l][0], ids[l][1]) + 1);
+            }
+            elines.push_back(l);
+        }
+        _line += L;
+
+        while (num_vertices(_g) < N)
+            add_vertex(_g);
+
+        size_t E = edges.size();
+        vector<edge_t> es(E);
+        add_edges(edges, _g, [&](size_t i, const auto& e) { es[i] = e; });
+
+        if (E == 0 || _eprops.empty())
+            return;
+
+        // The property values are converted in parallel. The value of the last
+        // edge is set first, so that the property maps are resized only once,
+        // outside the parallel region.
+        string err;
+        auto put_values = [&](size_t i)
+            {
+                auto tok = &toks[elines[i] * _ncols];
+                for (size_t j = 0; j < _eprops.size(); ++j)
+                {
+                    auto& t = tok[_pcols[j]];
+                    try
+                    {
+                        _eprops[j].put(es[i],
+                                       buf.substr(t.first,
+                                                  t.second - t.first));
+                    }
+                    catch (bad_lexical_cast&)
+                    {
+                        #pragma omp critical
+                        err = "invalid edge property value: " +
+                            buf.substr(t.first, t.second - t.first);
+                    }
+                }
+            };
+
+        put_values(E - 1);
+
+        #pragma omp parallel for schedule(runtime) if (E > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < E - 1; ++i)
+            put_values(i);
+
+        if (!err.empty())
+            throw ValueException(err);
+    }
+
+    graph_t& _g;
+    string _delim;
+    string _comment;
+    size_t _scol;
+    size_t _tcol;
+    bool _hashed;
+    vname_t _vname;
+    vector<eprop_t>& _eprops;
+    size_t _ncols;
+    vector<size_t> _pcols;
+    gt_hash_map<string, size_t> _vertices;
+    bool _skip_first = false;
+    size_t _line = 0;
+};
+
+template <class Val>
+void read_edge_list_binary(graph_t& g, std::istream& s, bool hashed,
+                           vid_t vid)
+{
+    gt_hash_map<Val, size_t> vertices;
+    auto get_vertex = [&](Val x) -> size_t
+        {
+            auto iter = vertices.find(x);
+            if (iter != vertices.end())
+                return iter->second;
+            size_t v = add_vertex(g);
+            vid[v] = x;
+            vertices[x] = v;
+            return v;
+        };
+
+    size_t chunk = _chunk_size / (2 * sizeof(Val));
+    vector<std::array<Val, 2>> buf(chunk);
+    vector<std::array<size_t, 2>> edges;
+    while (true)
+    {
+        s.read(reinterpret_cast<char*>(buf.data()),
+               chunk * 2 * sizeof(Val));
+        size_t n = s.gcount();
+        if (n % (2 * sizeof(Val)) != 0)
+            throw IOException("truncated binary edge list");
+        n /= 2 * sizeof(Val);
+
+        edges.resize(n);
+        size_t N = num_vertices(g);
+        if (hashed)
+        {
+            for (size_t i = 0; i < n; ++i)
+                edges[i] = {{get_vertex(buf[i][0]), get_vertex(buf[i][1])}};
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (uint64_t(buf[i][0]) > _max_index ||
+                    uint64_t(buf[i][1]) > _max_index)
+                    throw IOException("invalid vertex index in binary edge list");
+                edges[i] = {{size_t(buf[i][0]), size_t(buf[i][1])}};
+                N = std::max(N, std::max(edges[i][0], edges[i][1]) + 1);
+            }
+        }
+
+        while (num_vertices(g) < N)
+            add_vertex(g);
+        add_edges(edges, g);
+
+        if (n < chunk)
+            break;
+    }
+}
+
+void read_edge_list(GraphInterface& gi, string file, python::object pfile,
+                    string delim, string comment, bool skip_first,
+                    size_t scol, size_t tcol, size_t binary_width, bool hashed,
+                    boost::any avname, python::object oeprops)
+{
+    boost::iostreams::filtering_stream<boost::iostreams::input> stream;
+    std::ifstream file_stream;
+    try
+    {
+        build_stream(stream, file, pfile, file_stream);
+        file_stream.exceptions(ios_base::badbit);
+
+        auto& g = gi.get_graph();
+        switch (binary_width)
+        {
+        case 0:
+            {
+                vname_t vname;
+                if (hashed)
+                    vname = any_cast<vname_t>(avname);
+                vector<eprop_t> eprops;
+                python::stl_input_iterator<boost::any> piter(oeprops), pend;
+                for (; piter != pend; ++piter)
+                    eprops.emplace_back(*piter, writable_edge_properties());
+                edge_list_text_reader reader(g, delim, comment, scol, tcol,
+                                             hashed, vname, eprops);
+                reader.read(stream, skip_first);
+            }
+            break;
+        case 4:
+        case 8:
+            {
+                vid_t vid;
+                if (hashed)
+                    vid = any_cast<vid_t>(avname);
+                if (binary_width == 4)
+                    read_edge_list_binary<uint32_t>(g, stream, hashed, vid);
+                else
+                    read_edge_list_binary<uint64_t>(g, stream, hashed, vid);
+            }
+            break;
+        default:
+            throw ValueException("invalid binary width: " +
+                                 lexical_cast<string>(binary_width));
+        }
+    }
+    catch (ios_base::failure &e)
+    {
+        throw IOException("error reading from file '" + file + "':" + e.what());
+    }
+    catch (IOException& e)
+    {
+        throw IOException("error reading from file '" + file + "': " + e.what());
+    }
+}
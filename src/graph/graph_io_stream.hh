@@ -0,0 +1,63 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_IO_STREAM_HH
+#define GRAPH_IO_STREAM_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <boost/python/object.hpp>
+
+namespace graph_tool
+{
+
+enum class property_type : uint8_t
+{
+    Graph,
+    Vertex,
+    Edge
+};
+
+// Receives the contents of a graph file in the "gt" format, read as a stream,
+// without building the graph. The methods are called with init(directed, N)
+// once the number of vertices is known, then with edge(v, u) for every edge,
+// in the order stored, and, if the properties are read, with property(type,
+// name) for every property. If the latter returns true, the property must be
+// scalar, and value(x) is called for each of its values, in the order of the
+// vertex or edge indexes.
+class gt_stream_visitor
+{
+public:
+    virtual ~gt_stream_visitor() {}
+
+    virtual void init(bool directed, size_t N) = 0;
+    virtual void edge(size_t v, size_t u) = 0;
+    virtual bool property(property_type t, const std::string& name) = 0;
+    virtual void value(double x) = 0;
+};
+
+// Reads the given file name, or python file object, with the decompression
+// given by the file name extension. The properties are read only if
+// "properties" is true. Defined in graph_io.cc.
+void stream_gt_file(const std::string& file, boost::python::object pfile,
+                    gt_stream_visitor& vis, bool properties);
+
+} // namespace graph_tool
+
+#endif // GRAPH_IO_STREAM_HH
@@ -16,9 +16,28 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "graph.hh"
+#include "numa.hh"
+#include "openmp_tuning.hh"
 
 #include <boost/python.hpp>
 
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
@@ -55,32 +74,45 @@ void openmp_set_num_threads(int n)
 #endif
 }
 
-python::tuple openmp_get_schedule()
-{
 #ifdef _OPENMP
-    omp_sched_t kind;
-    int chunk;
-    omp_get_schedule(&kind, &chunk);
-    string skind;
+static string get_schedule_name(omp_sched_t kind)
+{
     switch (kind)
     {
         case omp_sched_static:
-            skind = "static";
-            break;
+            return "static";
         case omp_sched_dynamic:
-            skind = "dynamic";
-            break;
+            return "dynamic";
         case omp_sched_guided:
-            skind = "guided";
-            break;
+            return "guided";
         case omp_sched_auto:
-            skind = "auto";
-            break;
+            return "auto";
         default:
             throw GraphException("Unknown schedule type");
     }
+}
 
-    return python::make_tuple(skind, chunk);
+static omp_sched_t get_schedule_kind(const string& skind)
+{
+    if (skind == "static")
+        return omp_sched_static;
+    else if (skind == "dynamic")
+        return omp_sched_dynamic;
+    else if (skind == "guided")
+        return omp_sched_guided;
+    else if (skind == "auto")
+        return omp_sched_auto;
+    throw GraphException("Unknown schedule type: " + skind);
+}
+#endif
+
+python::tuple openmp_get_schedule()
+{
+#ifdef _OPENMP
+    omp_sched_t kind;
+    int chunk;
+    omp_get_schedule(&kind, &chunk);
+    return python::make_tuple(get_schedule_name(kind), chunk);
 #else
     throw GraphException("OpenMP was not enabled during compilation");
 #endif
@@ -89,23 +121,405 @@ python::tuple openmp_get_schedule()
 void openmp_set_schedule(string skind, int chunk)
 {
 #ifdef _OPENMP
-    omp_sched_t kind;
-    if (skind == "static")
-        kind = omp_sched_static;
-    else if (skind == "dynamic")
-        kind = omp_sched_dynamic;
-    else if (skind == "guided")
-        kind = omp_sched_guided;
-    else if (skind == "auto")
-        kind = omp_sched_auto;
-    else
-        throw GraphException("Unknown schedule type: " + skind);
+    omp_set_schedule(get_schedule_kind(skind), chunk);
+#else
+    throw GraphException("OpenMP was not enabled during compilation");
+#endif
+}
+
+// Tuning of the parallel loops
+// ============================
+
+namespace graph_tool
+{
+std::atomic<bool> __loop_tuning_enabled(false);
+loop_tuning_t __loop_tuning[NUM_LOOP_CLASSES];
+}
+
+static const char* __loop_class_names[NUM_LOOP_CLASSES] =
+    {"vertex", "edge", "flat_edge", "container"};
+
+static loop_class_t get_loop_class(const string& name)
+{
+    for (size_t l = 0; l < NUM_LOOP_CLASSES; ++l)
+    {
+        if (name == __loop_class_names[l])
+            return loop_class_t(l);
+    }
+    throw ValueException("invalid loop class: " + name);
+}
+
+void openmp_set_loop_tuning(string name, size_t thresh, string skind, int chunk)
+{
+#ifdef _OPENMP
+    auto& t = __loop_tuning[get_loop_class(name)];
+    t.thresh = thresh;
+    t.schedule = (skind == "runtime") ? 0 : int(get_schedule_kind(skind));
+    t.chunk = chunk;
+#else
+    throw GraphException("OpenMP was not enabled during compilation");
+#endif
+}
+
+python::dict openmp_get_loop_tuning()
+{
+    python::dict ret;
+#ifdef _OPENMP
+    for (size_t l = 0; l < NUM_LOOP_CLASSES; ++l)
+    {
+        auto& t = __loop_tuning[l];
+        string skind = (t.schedule == 0) ? "runtime" :
+            get_schedule_name(omp_sched_t(t.schedule));
+        ret[__loop_class_names[l]] = python::make_tuple(t.thresh, skind,
+                                                        t.chunk);
+    }
+#endif
+    return ret;
+}
+
+void openmp_set_loop_tuning_enabled(bool enabled)
+{
+    __loop_tuning_enabled = enabled;
+}
+
+bool openmp_get_loop_tuning_enabled()
+{
+    return __loop_tuning_enabled;
+}
+
+#ifdef _OPENMP
+
+// Best time (over a few repetitions) of a synthetic loop where element i costs
+// work[i] units of a dependent floating-point computation, spawned only if
+// N > thresh, with the given schedule.
+static double time_synthetic_loop(const vector<uint32_t>& work,
+                                  vector<double>& out, size_t N, size_t thresh,
+                                  omp_sched_t kind, int chunk)
+{
+    omp_sched_t okind;
+    int ochunk;
+    omp_get_schedule(&okind, &ochunk);
     omp_set_schedule(kind, chunk);
+
+    // enough repetitions for a total of about 10^6 work units
+    size_t W = 0;
+    for (size_t i = 0; i < N; ++i)
+        W += work[i];
+    size_t reps = std::max(std::min(size_t(1000000) / (W + 1), size_t(1000)),
+                           size_t(5));
+
+    double best = numeric_limits<double>::infinity();
+    for (size_t r = 0; r < reps; ++r)
+    {
+        auto t0 = chrono::steady_clock::now();
+        #pragma omp parallel for schedule(runtime) if (N > thresh)
+        for (size_t i = 0; i < N; ++i)
+        {
+            double x = i;
+            for (uint32_t j = 0; j < work[i]; ++j)
+                x = x * 0.999 + 1;
+            out[i] = x;
+        }
+        auto t1 = chrono::steady_clock::now();
+        best = std::min(best, chrono::duration<double>(t1 - t0).count());
+    }
+
+    omp_set_schedule(okind, ochunk);
+    return best;
+}
+
+// Smallest size, in powers of two, from which the parallel loop is clearly
+// faster than the serial one, for uniform work per element.
+static size_t calibrate_thresh(uint32_t unit)
+{
+    constexpr size_t max_N = 1 << 20;
+    vector<uint32_t> work(max_N, unit);
+    vector<double> out(max_N);
+    size_t thresh = max_N;
+    size_t wins = 0;
+    for (size_t N = 16; N <= max_N; N *= 2)
+    {
+        double ts = time_synthetic_loop(work, out, N,
+                                        numeric_limits<size_t>::max(),
+                                        omp_sched_static, 0);
+        double tp = time_synthetic_loop(work, out, N, 0, omp_sched_static, 0);
+        if (tp < .9 * ts)
+        {
+            // require two consecutive wins, to filter out noise; the
+            // crossover is then between N/4 and N/2
+            if (++wins == 2)
+            {
+                thresh = 3 * N / 8;
+                break;
+            }
+        }
+        else
+        {
+            wins = 0;
+        }
+    }
+    return thresh;
+}
+
+// Fastest schedule for a skewed loop, mimicking the degrees of a scale-free
+// graph with exponent 2.5, where the hubs have the lowest indices, as in
+// networks that grow by preferential attachment. The static schedule is kept
+// unless another one is faster by at least 5%.
+static pair<omp_sched_t, int> calibrate_schedule()
+{
+    constexpr size_t N = 1 << 18;
+    vector<uint32_t> work(N);
+    for (size_t i = 0; i < N; ++i)
+        work[i] = 2 * std::pow(double(N) / (i + 1), 2. / 3);
+    vector<double> out(N);
+
+    pair<omp_sched_t, int> best = {omp_sched_static, 0};
+    double t_best = time_synthetic_loop(work, out, N, 0, omp_sched_static, 0);
+    vector<pair<omp_sched_t, int>> candidates =
+        {{omp_sched_dynamic, 1}, {omp_sched_dynamic, 16},
+         {omp_sched_dynamic, 256}, {omp_sched_guided, 0}};
+    for (auto& c : candidates)
+    {
+        double t = time_synthetic_loop(work, out, N, 0, c.first, c.second);
+        if (t < .95 * t_best)
+        {
+            t_best = t;
+            best = c;
+        }
+    }
+    return best;
+}
+
+#endif // _OPENMP
+
+// Microbenchmarks each loop class with the current number of threads, and
+// enables the resulting tuning. The vertex and edge loops do work proportional
+// to the degree (about 8 units per vertex on average), and may be skewed,
+// whereas the flat edge loops and the container loops do a single unit of
+// balanced work per element.
+void openmp_calibrate_loops()
+{
+#ifdef _OPENMP
+    auto sched = calibrate_schedule();
+    size_t thresh_vertex = calibrate_thresh(8);
+    size_t thresh_flat = calibrate_thresh(1);
+
+    for (size_t l = 0; l < NUM_LOOP_CLASSES; ++l)
+    {
+        auto& t = __loop_tuning[l];
+        if (l == VERTEX_LOOP || l == EDGE_LOOP)
+        {
+            t.thresh = thresh_vertex;
+            t.schedule = int(sched.first);
+            t.chunk = sched.second;
+        }
+        else
+        {
+            t.thresh = thresh_flat;
+            t.schedule = int(omp_sched_static);
+            t.chunk = 0;
+        }
+    }
+    __loop_tuning_enabled = true;
 #else
     throw GraphException("OpenMP was not enabled during compilation");
 #endif
 }
 
+// NUMA placement and thread affinity
+// ==================================
+
+namespace graph_tool
+{
+bool __numa_first_touch = false;
+}
+
+// parses a list of CPUs or nodes in the kernel's format, e.g. "0-31,64-95"
+static vector<int> parse_numa_list(const string& s)
+{
+    vector<int> ret;
+    stringstream ss(s);
+    string r;
+    while (getline(ss, r, ','))
+    {
+        if (r.empty())
+            continue;
+        auto pos = r.find('-');
+        int first = stoi(r.substr(0, pos));
+        int last = (pos == string::npos) ? first : stoi(r.substr(pos + 1));
+        for (int i = first; i <= last; ++i)
+            ret.push_back(i);
+    }
+    return ret;
+}
+
+static string read_sys_file(const string& path)
+{
+    ifstream f(path);
+    string s;
+    getline(f, s);
+    return s;
+}
+
+static vector<int> get_numa_nodes()
+{
+    auto nodes = parse_numa_list(read_sys_file("/sys/devices/system/node/online"));
+    if (nodes.empty())
+        nodes.push_back(0);
+    return nodes;
+}
+
+size_t numa_get_num_nodes()
+{
+    return get_numa_nodes().size();
+}
+
+void graph_tool::numa_release_pages(void* begin, void* end)
+{
+#ifdef __linux__
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t first = (size_t(begin) + page - 1) / page * page;
+    size_t last = size_t(end) / page * page;
+    if (last > first)
+        madvise((void*) first, last - first, MADV_DONTNEED);
+#endif
+}
+
+void graph_tool::numa_interleave(void* ptr, size_t size)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    constexpr int MPOL_INTERLEAVE_ = 3;
+    constexpr unsigned MPOL_MF_MOVE_ = 1 << 1;
+
+    auto nodes = get_numa_nodes();
+    if (nodes.size() < 2)
+        return;
+    size_t max_node = *max_element(nodes.begin(), nodes.end()) + 1;
+    constexpr size_t bits = 8 * sizeof(unsigned long);
+    vector<unsigned long> mask(max_node / bits + 1, 0);
+    for (auto n : nodes)
+        mask[n / bits] |= 1UL << (n % bits);
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t first = (size_t(ptr) + page - 1) / page * page;
+    size_t last = (size_t(ptr) + size) / page * page;
+    if (last <= first)
+        return;
+    if (syscall(SYS_mbind, first, last - first, MPOL_INTERLEAVE_, mask.data(),
+                mask.size() * bits, MPOL_MF_MOVE_) != 0)
+        throw GraphException("error setting the NUMA memory policy: " +
+                             string(strerror(errno)));
+#else
+    (void) ptr;
+    (void) size;
+#endif
+}
+
+void numa_set_first_touch(bool enabled)
+{
+    __numa_first_touch = enabled;
+}
+
+bool numa_get_first_touch()
+{
+    return __numa_first_touch;
+}
+
+static string __thread_affinity = "none";
+
+// Pins the OpenMP threads to CPUs. With "compact", consecutive threads are
+// placed on consecutive CPUs, filling one NUMA node before the next; with
+// "spread", they are distributed in a round-robin fashion between the nodes;
+// "none" restores the initial affinity of the process. Since the OpenMP
+// runtime reuses the same threads between parallel regions of the same size,
+// the placement persists until the number of threads changes.
+void openmp_set_thread_affinity(string policy)
+{
+#if defined(__linux__) && defined(_OPENMP)
+    if (policy != "none" && policy != "compact" && policy != "spread")
+        throw ValueException("invalid thread affinity policy: " + policy);
+
+    // CPUs available to the process, as it was started
+    static cpu_set_t allowed;
+    static bool init = false;
+    if (!init)
+    {
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+            throw GraphException("error obtaining the CPU affinity: " +
+                                 string(strerror(errno)));
+        init = true;
+    }
+
+    // allowed CPUs grouped by node
+    vector<vector<int>> node_cpus;
+    for (auto n : get_numa_nodes())
+    {
+        auto cpus = parse_numa_list(read_sys_file("/sys/devices/system/node/node" +
+                                                  to_string(n) + "/cpulist"));
+        node_cpus.emplace_back();
+        for (auto c : cpus)
+        {
+            if (c < CPU_SETSIZE && CPU_ISSET(c, &allowed))
+                node_cpus.back().push_back(c);
+        }
+        if (node_cpus.back().empty())
+            node_cpus.pop_back();
+    }
+    if (node_cpus.empty())
+    {
+        node_cpus.emplace_back();
+        for (int c = 0; c < CPU_SETSIZE; ++c)
+            if (CPU_ISSET(c, &allowed))
+                node_cpus.back().push_back(c);
+    }
+
+    vector<int> order;
+    if (policy == "compact")
+    {
+        for (auto& cpus : node_cpus)
+            order.insert(order.end(), cpus.begin(), cpus.end());
+    }
+    else if (policy == "spread")
+    {
+        for (size_t i = 0; order.size() < size_t(CPU_COUNT(&allowed)); ++i)
+            for (auto& cpus : node_cpus)
+                if (i < cpus.size())
+                    order.push_back(cpus[i]);
+    }
+
+    bool error = false;
+    #pragma omp parallel
+    {
+        cpu_set_t cpus;
+        if (order.empty())
+        {
+            cpus = allowed;
+        }
+        else
+        {
+            CPU_ZERO(&cpus);
+            CPU_SET(order[omp_get_thread_num() % order.size()], &cpus);
+        }
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+        {
+            #pragma omp atomic write
+            error = true;
+        }
+    }
+    if (error)
+        throw GraphException("error setting the thread affinity");
+    __thread_affinity = policy;
+#else
+    if (policy != "none")
+        throw GraphException("thread affinity is only supported on Linux, "
+                             "with OpenMP enabled");
+#endif
+}
+
+string openmp_get_thread_affinity()
+{
+    return __thread_affinity;
+}
 
 void export_openmp()
 {
@@ -116,4 +530,14 @@ void export_openmp()
     def("openmp_set_num_threads", &openmp_set_num_threads);
     def("openmp_get_schedule", &openmp_get_schedule);
     def("openmp_set_schedule", &openmp_set_schedule);
+    def("openmp_set_loop_tuning", &openmp_set_loop_tuning);
+    def("openmp_get_loop_tuning", &openmp_get_loop_tuning);
+    def("openmp_set_loop_tuning_enabled", &openmp_set_loop_tuning_enabled);
+    def("openmp_get_loop_tuning_enabled", &openmp_get_loop_tuning_enabled);
+    def("openmp_calibrate_loops", &openmp_calibrate_loops);
+    def("openmp_set_thread_affinity", &openmp_set_thread_affinity);
+    def("openmp_get_thread_affinity", &openmp_get_thread_affinity);
+    def("numa_get_num_nodes", &numa_get_num_nodes);
+    def("numa_set_first_touch", &numa_set_first_touch);
+    def("numa_get_first_touch", &numa_get_first_touch);
 };
@@ -0,0 +1,353 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PARALLEL_BFS_HH
+#define GRAPH_PARALLEL_BFS_HH
+
+#include <vector>
+#include <array>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_selectors.hh"
+
+namespace graph_tool
+{
+
+// Level-synchronous, direction-optimizing breadth-first search (S. Beamer,
+// K. Asanović and D. Patterson, "Direction-optimizing breadth-first search",
+// SC '12). Each level is expanded either top-down, from the out-edges of the
+// frontier, or bottom-up, from the in-edges of the vertices not yet visited,
+// whichever is expected to examine fewer edges.
+//
+// The edges are examined in parallel, and the newly found vertices are
+// collected in per-thread buffers, which are then merged sequentially. The
+// function discover(v, u, d) is called during the merge, in discovery order,
+// for every vertex v found at distance d from the source, with parent u in the
+// search tree; if it returns true, the search stops immediately. Only the
+// frontiers of the levels d <= max_level are expanded. The source itself is not
+// passed to discover().
+//
+// During top-down steps the buffers are merged in frontier order, so that the
+// discovery order, and hence the search tree, is the same as with a sequential
+// queue-based BFS. During bottom-up steps the vertices are discovered in index
+// order, with the first parent found in their in-edge list.
+class parallel_bfs
+{
+public:
+    template <class Graph, class Discover>
+    void operator()(const Graph& g, size_t s, Discover&& discover,
+                    size_t max_level = std::numeric_limits<size_t>::max())
+    {
+        size_t N = num_vertices(g);
+        _visited.clear();
+        _visited.resize(N, false);
+        _frontier.clear();
+        for (auto& buf : _buffers)
+            buf.clear();
+
+        size_t n_threads = 1;
+#ifdef _OPENMP
+        if (N > OPENMP_MIN_THRESH && !omp_in_parallel())
+            n_threads = omp_get_max_threads();
+#endif
+        _buffers.resize(n_threads);
+
+        // number of edges that remain to be examined by a top-down step
+        size_t m_u = 0;
+        for (auto v : vertices_range(g))
+            m_u += out_degree(v, g);
+
+        _visited[s] = true;
+        _frontier.push_back(s);
+        size_t m_f = out_degree(vertex(s, g), g);
+        m_u -= m_f;
+
+        bool bottom_up = false;
+        size_t n_visited = 1;
+        for (size_t d = 1; d - 1 <= max_level && !_frontier.empty(); ++d)
+        {
+            if (!bottom_up)
+                bottom_up = m_f > m_u / _alpha && n_visited < N;
+            else
+                bottom_up = _frontier.size() >= N / _beta;
+
+            if (bottom_up)
+                step_bottom_up(g, n_threads);
+            else
+                step_top_down(g, (m_f > OPENMP_MIN_THRESH) ? n_threads : 1);
+
+            _frontier.clear();
+            m_f = 0;
+            for (auto& buf : _buffers)
+            {
+                for (auto& vu : buf)
+                {
+                    auto v = vu.first;
+                    if (_visited[v])
+                        continue;
+                    _visited[v] = true;
+                    ++n_visited;
+                    _frontier.push_back(v);
+                    if (discover(vertex(v, g), vertex(vu.second, g), d))
+                        return;
+                    size_t k = out_degree(vertex(v, g), g);
+                    m_f += k;
+                    m_u -= k;
+                }
+                buf.clear();
+            }
+        }
+    }
+
+private:
+    template <class Graph>
+    void step_top_down(const Graph& g, size_t n_threads)
+    {
+        size_t F = _frontier.size();
+        run_chunks
+            (n_threads,
+             [&](size_t t, size_t nt)
+             {
+                 // contiguous chunks, so that the buffers are in frontier order
+                 auto& buf = _buffers[t];
+                 for (size_t i = (t * F) / nt; i < ((t + 1) * F) / nt; ++i)
+                 {
+                     auto u = vertex(_frontier[i], g);
+                     for (auto w : out_neighbors_range(u, g))
+                     {
+                         if (!_visited[w])
+                             buf.emplace_back(w, _frontier[i]);
+                     }
+                 }
+             });
+    }
+
+    template <class Graph>
+    void step_bottom_up(const Graph& g, size_t n_threads)
+    {
+        size_t N = num_vertices(g);
+        _in_frontier.clear();
+        _in_frontier.resize(N, false);
+        for (auto v : _frontier)
+            _in_frontier[v] = true;
+
+        run_chunks
+            (n_threads,
+             [&](size_t t, size_t nt)
+             {
+                 auto& buf = _buffers[t];
+                 for (size_t i = (t * N) / nt; i < ((t + 1) * N) / nt; ++i)
+                 {
+                     if (_visited[i])
+                         continue;
+                     auto v = vertex(i, g);
+                     if (!is_valid_vertex(v, g))
+                         continue;
+                     for (auto e : in_or_out_edges_range(v, g))
+                     {
+                         auto u = graph_tool::is_directed(g) ? source(e, g) :
+                             target(e, g);
+                         if (_in_frontier[u])
+                         {
+                             buf.emplace_back(i, u);
+                             break;
+                         }
+                     }
+                 }
+             });
+    }
+
+    // calls f(t, nt) from each of the nt threads; no parallel region is opened
+    // for a single thread, since this is done once per level
+    template <class F>
+    static void run_chunks(size_t n_threads, F&& f)
+    {
+        if (n_threads == 1)
+        {
+            f(0, 1);
+            return;
+        }
+        #pragma omp parallel num_threads(n_threads)
+        {
+            size_t t = 0, nt = 1;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+            nt = omp_get_num_threads();
+#endif
+            f(t, nt);
+        }
+    }
+
+    // switching thresholds, as suggested by Beamer et al.
+    static constexpr size_t _alpha = 14;
+    static constexpr size_t _beta = 24;
+
+    std::vector<uint8_t> _visited;
+    std::vector<uint8_t> _in_frontier;
+    std::vector<size_t> _frontier;
+    std::vector<std::vector<std::pair<size_t, size_t>>> _buffers;
+};
+
+// Multi-source breadth-first search (M. Then et al., "The more the merrier:
+// efficient multi-source graph traversal", VLDB 2015). Up to W searches are
+// run at once by keeping, for every vertex, a bitmask of the searches that have
+// already seen it, and of those for which it is in the current frontier. A
+// single pass over the out-edges of a frontier vertex then advances all the
+// searches that share it, which for small-world graphs is most of them.
+//
+// The function visit(i, v, d) is called for every vertex v found at distance
+// d > 0 from sources[i]. The search itself is sequential; the intended use is
+// to run different batches of sources in different threads, as done by
+// parallel_multi_source_bfs() below.
+template <size_t W = 64>
+class multi_source_bfs
+{
+    static_assert(W > 0 && W % 64 == 0,
+                  "the number of simultaneous searches must be a multiple of 64");
+public:
+    static constexpr size_t width = W;
+
+    template <class Graph, class Sources, class Visit>
+    void operator()(const Graph& g, const Sources& sources, Visit&& visit)
+    {
+        size_t N = num_vertices(g);
+        _seen.clear();
+        _seen.resize(N, mask_t());
+        _visit.clear();
+        _visit.resize(N, mask_t());
+        _next.clear();
+        _next.resize(N, mask_t());
+        _frontier.clear();
+        _next_frontier.clear();
+
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            size_t s = sources[i];
+            if (is_empty(_visit[s]))
+                _frontier.push_back(s);
+            _seen[s][i / 64] |= uint64_t(1) << (i % 64);
+            _visit[s][i / 64] |= uint64_t(1) << (i % 64);
+        }
+
+        for (size_t d = 1; !_frontier.empty(); ++d)
+        {
+            for (auto v : _frontier)
+            {
+                auto& m = _visit[v];
+                for (auto u : out_neighbors_range(vertex(v, g), g))
+                {
+                    auto& seen = _seen[u];
+                    auto& next = _next[u];
+                    bool was_empty = is_empty(next);
+                    uint64_t found = 0;
+                    for (size_t k = 0; k < _words; ++k)
+                    {
+                        uint64_t x = m[k] & ~seen[k];
+                        next[k] |= x;
+                        found |= x;
+                    }
+                    if (found != 0 && was_empty)
+                        _next_frontier.push_back(u);
+                }
+            }
+
+            for (auto v : _frontier)
+                _visit[v] = mask_t();
+
+            for (auto u : _next_frontier)
+            {
+                auto& next = _next[u];
+                auto& seen = _seen[u];
+                for (size_t k = 0; k < _words; ++k)
+                {
+                    seen[k] |= next[k];
+                    for (uint64_t x = next[k]; x != 0; x &= x - 1)
+                        visit(k * 64 + __builtin_ctzll(x), vertex(u, g), d);
+                }
+                _visit[u] = next;
+                next = mask_t();
+            }
+
+            std::swap(_frontier, _next_frontier);
+            _next_frontier.clear();
+        }
+    }
+
+private:
+    static constexpr size_t _words = W / 64;
+    typedef std::array<uint64_t, _words> mask_t;
+
+    static bool is_empty(const mask_t& m)
+    {
+        for (auto x : m)
+        {
+            if (x != 0)
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<mask_t> _seen;
+    std::vector<mask_t> _visit;
+    std::vector<mask_t> _next;
+    std::vector<size_t> _frontier;
+    std::vector<size_t> _next_frontier;
+};
+
+// Runs a BFS from every vertex in sources, in batches of W simultaneous
+// searches that are distributed among the threads of the enclosing parallel
+// region. The function visit(s, v, d) is called for every vertex v found at
+// distance d > 0 from source s, from the thread that owns s.
+template <size_t W = 64, class Graph, class Visit>
+void parallel_multi_source_bfs_no_spawn(const Graph& g,
+                                        const std::vector<size_t>& sources,
+                                        Visit&& visit)
+{
+    multi_source_bfs<W> bfs;
+    std::vector<size_t> batch;
+    size_t n_batches = (sources.size() + W - 1) / W;
+    #pragma omp for schedule(runtime)
+    for (size_t i = 0; i < n_batches; ++i)
+    {
+        batch.assign(sources.begin() + i * W,
+                     sources.begin() + std::min((i + 1) * W, sources.size()));
+        bfs(g, batch,
+            [&](size_t j, auto v, size_t d)
+            {
+                visit(batch[j], v, d);
+            });
+    }
+}
+
+template <size_t W = 64, class Graph, class Visit>
+void parallel_multi_source_bfs(const Graph& g,
+                               const std::vector<size_t>& sources,
+                               Visit&& visit)
+{
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH && \
+                             sources.size() > W)
+    parallel_multi_source_bfs_no_spawn<W>(g, sources, visit);
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_PARALLEL_BFS_HH
@@ -0,0 +1,359 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PARALLEL_TRAVERSAL_HH
+#define GRAPH_PARALLEL_TRAVERSAL_HH
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "openmp_lock.hh"
+
+namespace graph_tool
+{
+
+// Number of threads to use for a traversal of a graph with N vertices.
+inline size_t get_traversal_threads(size_t N)
+{
+#ifdef _OPENMP
+    if (N > OPENMP_MIN_THRESH && !omp_in_parallel())
+        return omp_get_max_threads();
+#endif
+    return 1;
+}
+
+// Parallel processing of a dynamic set of work items, by work stealing. The
+// function f(v, push) is called once for every item, starting with those in
+// init, and push(u) adds the item u to the work of the calling thread.
+//
+// Each thread works depth-first through a private stack, and whenever its
+// shared stack is empty, it moves the older half of the private one there, so
+// that it can be taken by idle threads. An idle thread steals half of the
+// shared stack of another thread. There are no barriers, so that the cost does
+// not depend on the depth of the traversal, as with level-synchronous
+// algorithms.
+//
+// The traversal is over when all threads are idle at the same time, which can
+// be tested with a single counter: only the owner adds to a shared stack, and
+// only while it is not idle, and thieves stop being idle while holding the
+// lock of the victim, before taking the items, so if every thread is idle no
+// items are left anywhere.
+template <class Item, class F>
+void work_stealing_loop(const std::vector<Item>& init, size_t n_threads, F&& f)
+{
+    if (n_threads <= 1)
+    {
+        std::vector<Item> stack(init.rbegin(), init.rend());
+        auto push = [&](const Item& u) { stack.push_back(u); };
+        while (!stack.empty())
+        {
+            Item v = stack.back();
+            stack.pop_back();
+            f(v, push);
+        }
+        return;
+    }
+
+    struct worker_t
+    {
+        openmp_mutex lock;
+        std::vector<Item> shared;
+        std::atomic<size_t> n_shared;
+    };
+
+    std::unique_ptr<worker_t[]> workers(new worker_t[n_threads]);
+    for (size_t i = 0; i < init.size(); ++i)
+        workers[i % n_threads].shared.push_back(init[i]);
+    for (size_t i = 0; i < n_threads; ++i)
+        workers[i].n_shared = workers[i].shared.size();
+
+    std::atomic<size_t> idle(0);
+
+    #pragma omp parallel num_threads(n_threads)
+    {
+        size_t t = 0, nt = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        auto& w = workers[t];
+        std::vector<Item> local;
+        auto push = [&](const Item& u) { local.push_back(u); };
+
+        // takes half of the items of a shared stack, the older ones first
+        auto take = [&](worker_t& v, bool is_idle)
+        {
+            scoped_lock lock(v.lock);
+            if (v.shared.empty())
+                return false;
+            if (is_idle)
+                --idle;
+            size_t n = (v.shared.size() + 1) / 2;
+            local.insert(local.end(), v.shared.begin(), v.shared.begin() + n);
+            v.shared.erase(v.shared.begin(), v.shared.begin() + n);
+            v.n_shared = v.shared.size();
+            return true;
+        };
+
+        // the other threads need to be present to be stolen from
+        #pragma omp barrier
+
+        while (true)
+        {
+            if (local.empty() && !take(w, false))
+            {
+                ++idle;
+                bool found = false;
+                while (!found)
+                {
+                    for (size_t i = 1; i < nt && !found; ++i)
+                    {
+                        auto& v = workers[(t + i) % nt];
+                        if (v.n_shared > 0)
+                            found = take(v, true);
+                    }
+                    if (!found)
+                    {
+                        if (idle == nt)
+                            break;
+                        std::this_thread::yield();
+                    }
+                }
+                if (!found)
+                    break;
+            }
+
+            Item v = local.back();
+            local.pop_back();
+            f(v, push);
+
+            if (local.size() > 1 && w.n_shared == 0)
+            {
+                scoped_lock lock(w.lock);
+                size_t n = local.size() / 2;
+                w.shared.insert(w.shared.end(), local.begin(),
+                                local.begin() + n);
+                local.erase(local.begin(), local.begin() + n);
+                w.n_shared = w.shared.size();
+            }
+        }
+    }
+}
+
+// Concurrent union-find over the integers [0, N). Two roots are united with a
+// CAS that links the larger one to the smaller, so that the root of each set
+// is always its smallest element, and the finds use path halving, also via
+// CAS. Both operations can be called from any thread.
+class concurrent_union_find
+{
+public:
+    concurrent_union_find(size_t N)
+        : _parent(new std::atomic<size_t>[N])
+    {
+        #pragma omp parallel for if (N > OPENMP_MIN_THRESH) schedule(runtime)
+        for (size_t i = 0; i < N; ++i)
+            _parent[i] = i;
+    }
+
+    size_t find(size_t v)
+    {
+        while (true)
+        {
+            size_t p = _parent[v];
+            size_t gp = _parent[p];
+            if (p == gp)
+                return p;
+            _parent[v].compare_exchange_weak(p, gp);
+            v = gp;
+        }
+    }
+
+    // Returns true if u and v were in different sets.
+    bool unite(size_t u, size_t v)
+    {
+        u = find(u);
+        v = find(v);
+        while (u != v)
+        {
+            if (u < v)
+                std::swap(u, v);
+            size_t r = u;
+            if (_parent[u].compare_exchange_strong(r, v))
+                return true;
+            u = find(u);
+            v = find(v);
+        }
+        return false;
+    }
+
+private:
+    std::unique_ptr<std::atomic<size_t>[]> _parent;
+};
+
+// Pseudo-random priority of item v for the given seed (by splitmix64), which
+// can be computed independently by any thread, so that randomized parallel
+// algorithms give the same result regardless of the number of threads.
+inline uint64_t random_priority(uint64_t seed, uint64_t v)
+{
+    uint64_t z = seed + (v + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Counter-based random number generator, whose n-th number is
+// random_priority(seed, n), so that one can be created cheaply for each work
+// item, from its index.
+class counter_rng
+{
+public:
+    counter_rng(uint64_t seed) : _seed(seed) {}
+
+    uint64_t operator()() { return random_priority(_seed, _n++); }
+
+    // uniform in [0, 1)
+    double uniform() { return (operator()() >> 11) / 9007199254740992.; }
+
+private:
+    uint64_t _seed;
+    uint64_t _n = 0;
+};
+
+// Marks the vertices reachable from the sources (including them), by calling
+// visit(v) exactly once for each of them, from any thread.
+template <class Graph, class Visit>
+void parallel_reach(const Graph& g, const std::vector<size_t>& sources,
+                    Visit&& visit)
+{
+    size_t N = num_vertices(g);
+    std::unique_ptr<std::atomic<uint8_t>[]> visited
+        (new std::atomic<uint8_t>[N]);
+    for (size_t i = 0; i < N; ++i)
+        visited[i] = false;
+
+    std::vector<size_t> init;
+    for (auto s : sources)
+    {
+        if (visited[s].exchange(true))
+            continue;
+        visit(s);
+        init.push_back(s);
+    }
+
+    work_stealing_loop
+        (init, get_traversal_threads(N),
+         [&](size_t v, auto& push)
+         {
+             for (auto u : out_neighbors_range(vertex(v, g), g))
+             {
+                 if (visited[u].load(std::memory_order_relaxed) ||
+                     visited[u].exchange(true))
+                     continue;
+                 visit(u);
+                 push(u);
+             }
+         });
+}
+
+// Topological sort by Kahn's algorithm, with the vertices processed by work
+// stealing as soon as all their predecessors are done. Each vertex gets the
+// level 1 + the maximum level of its predecessors, and the vertices are put
+// in order of level, and of index within the same level, so that the result
+// does not depend on the number of threads. Returns false if the graph is not
+// acyclic, in which case sort is left empty.
+template <class Graph>
+bool parallel_topological_sort(const Graph& g, std::vector<size_t>& sort)
+{
+    size_t N = num_vertices(g);
+    size_t nt = get_traversal_threads(N);
+
+    std::unique_ptr<std::atomic<size_t>[]> in_deg(new std::atomic<size_t>[N]);
+    std::unique_ptr<std::atomic<size_t>[]> level(new std::atomic<size_t>[N]);
+
+    #pragma omp parallel for num_threads(nt) schedule(runtime)
+    for (size_t i = 0; i < N; ++i)
+    {
+        in_deg[i] = 0;
+        level[i] = 0;
+    }
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             for (auto u : out_neighbors_range(v, g))
+                 in_deg[u].fetch_add(1, std::memory_order_relaxed);
+         });
+
+    std::vector<size_t> init;
+    size_t n_valid = 0;
+    for (auto v : vertices_range(g))
+    {
+        ++n_valid;
+        if (in_deg[v] == 0)
+            init.push_back(v);
+    }
+
+    std::atomic<size_t> n_done(0);
+    std::atomic<size_t> max_level(0);
+
+    work_stealing_loop
+        (init, nt,
+         [&](size_t v, auto& push)
+         {
+             n_done.fetch_add(1, std::memory_order_relaxed);
+             size_t l = level[v] + 1;
+             for (auto u : out_neighbors_range(vertex(v, g), g))
+             {
+                 size_t lu = level[u].load(std::memory_order_relaxed);
+                 while (lu < l && !level[u].compare_exchange_weak(lu, l));
+                 // the last predecessor sees the final level
+                 if (in_deg[u].fetch_sub(1) == 1)
+                     push(u);
+             }
+             size_t ml = max_level.load(std::memory_order_relaxed);
+             while (ml < l - 1 && !max_level.compare_exchange_weak(ml, l - 1));
+         });
+
+    sort.clear();
+    if (n_done != n_valid)
+        return false;
+
+    // counting sort by level, stable in the vertex index
+    size_t L = max_level + 1;
+    std::vector<size_t> pos(L + 1, 0);
+    for (auto v : vertices_range(g))
+        ++pos[level[v] + 1];
+    for (size_t l = 0; l < L; ++l)
+        pos[l + 1] += pos[l];
+    sort.resize(n_valid);
+    for (auto v : vertices_range(g))
+        sort[pos[level[v]]++] = v;
+    return true;
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_PARALLEL_TRAVERSAL_HH
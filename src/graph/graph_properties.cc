@@ -26,6 +26,7 @@
 #include <boost/mpl/for_each.hpp>
 
 #include <boost/python/extract.hpp>
+#include <boost/python/stl_iterator.hpp>
 
 using namespace std;
 using namespace boost;
@@ -148,6 +149,91 @@ void GraphInterface::re_index_vertex_property(boost::any map,
 
 }
 
+struct do_compact_edge_property
+{
+    template <class PropertyMap, class Vec>
+    void operator()(PropertyMap, boost::any map, const Vec& old_index,
+                    bool& found) const
+    {
+        try
+        {
+            PropertyMap pmap = any_cast<PropertyMap>(map);
+            auto& vec = pmap.get_storage();
+            // old_index is monotonically increasing, and old_index[i] >= i;
+            // edges beyond the current size of the storage are left out, as
+            // they still have default values
+            size_t i = 0;
+            for (; i < old_index.size(); ++i)
+            {
+                if (old_index[i] >= vec.size())
+                    break;
+                if (old_index[i] != i)
+                    vec[i] = std::move(vec[old_index[i]]);
+            }
+            vec.resize(i);
+            vec.shrink_to_fit();
+            found = true;
+        }
+        catch (bad_any_cast&) {}
+    }
+};
+
+struct do_permute_edge_property
+{
+    template <class PropertyMap, class Vec>
+    void operator()(PropertyMap, boost::any map, const Vec& old_index,
+                    bool& found) const
+    {
+        try
+        {
+            PropertyMap pmap = any_cast<PropertyMap>(map);
+            auto& vec = pmap.get_storage();
+            std::remove_reference_t<decltype(vec)> nvec(old_index.size());
+            for (size_t i = 0; i < old_index.size(); ++i)
+            {
+                if (old_index[i] < vec.size())
+                    nvec[i] = std::move(vec[old_index[i]]);
+            }
+            vec.swap(nvec);
+            found = true;
+        }
+        catch (bad_any_cast&) {}
+    }
+};
+
+// this will renumber the edge indexes densely, release the unused memory, and
+// remap the given edge property maps accordingly; if "ordered" is true, the
+// edges are renumbered in the order of the adjacency lists
+void GraphInterface::compact_edges(python::object oeprops, bool ordered)
+{
+    vector<boost::any> eprops;
+    python::stl_input_iterator<boost::any> iter(oeprops), end;
+    for (; iter != end; ++iter)
+        eprops.push_back(*iter);
+
+    unfreeze();
+    vector<index_t> old_index;
+    if (ordered)
+        _mg->compact_ordered(old_index);
+    else
+        _mg->compact(old_index);
+
+    for (auto& map : eprops)
+    {
+        bool found = false;
+        if (ordered)
+            mpl::for_each<writable_edge_properties>
+                (std::bind(do_permute_edge_property(), std::placeholders::_1,
+                           map, std::ref(old_index), std::ref(found)));
+        else
+            mpl::for_each<writable_edge_properties>
+                (std::bind(do_compact_edge_property(), std::placeholders::_1,
+                           map, std::ref(old_index), std::ref(found)));
+        if (!found)
+            throw GraphException("invalid writable property map");
+    }
+}
+
 } // graph_tool namespace
 
 
@@ -227,7 +313,7 @@ struct do_mark_edges
     template <class Graph, class EdgePropertyMap>
     void operator()(Graph& g, EdgePropertyMap prop) const
     {
-        parallel_edge_loop
+        parallel_edge_loop_flat
             (g,
              [&](auto e)
              {
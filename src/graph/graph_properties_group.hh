@@ -18,6 +18,10 @@
 #ifndef GRAPH_PROPERTIES_GROUP_HH
 #define GRAPH_PROPERTIES_GROUP_HH
 
+#include <cmath>
+#include <type_traits>
+#include <boost/numeric/conversion/cast.hpp>
+
 namespace graph_tool
 {
 
@@ -29,38 +33,38 @@ struct do_group_vector_property
     void operator()(Graph& g, VectorPropertyMap vector_map, PropertyMap map,
                     size_t pos) const
     {
-        parallel_vertex_loop
-            (g,
-             [&](auto v)
-             {
-                 this->dispatch_descriptor(g, vector_map, map, v, pos, Edge());
-             });
+        dispatch(g, vector_map, map, pos, Edge());
     }
 
-    template <class Graph, class VectorPropertyMap, class PropertyMap,
-              class Descriptor>
-    inline void dispatch_descriptor(Graph& g, VectorPropertyMap& vector_map,
-                                    PropertyMap& map, const Descriptor& v,
-                                    size_t pos, boost::mpl::true_) const
+    template <class Graph, class VectorPropertyMap, class PropertyMap>
+    void dispatch(Graph& g, VectorPropertyMap& vector_map, PropertyMap& map,
+                  size_t pos, boost::mpl::true_) const
     {
-        for (auto e : out_edges_range(v, g))
-        {
-            auto& vec = vector_map[e];
-            if (vec.size() <= pos)
-                vec.resize(pos + 1);
-            group_or_ungroup(vector_map, map, e, pos, Group());
-        }
+        // edges are partitioned evenly among threads, independently of the
+        // degree distribution
+        parallel_edge_loop_flat
+            (g,
+             [&](const auto& e)
+             {
+                 auto& vec = vector_map[e];
+                 if (vec.size() <= pos)
+                     vec.resize(pos + 1);
+                 this->group_or_ungroup(vector_map, map, e, pos, Group());
+             });
     }
 
-    template <class Graph, class VectorPropertyMap, class PropertyMap,
-              class Descriptor>
-    inline void dispatch_descriptor(Graph&, VectorPropertyMap& vector_map,
-                                    PropertyMap& map, const Descriptor& v,
-                                    size_t pos, boost::mpl::false_) const
+    template <class Graph, class VectorPropertyMap, class PropertyMap>
+    void dispatch(Graph& g, VectorPropertyMap& vector_map, PropertyMap& map,
+                  size_t pos, boost::mpl::false_) const
     {
-        if (vector_map[v].size() <= pos)
-            vector_map[v].resize(pos + 1);
-        group_or_ungroup(vector_map, map, v, pos, Group());
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 if (vector_map[v].size() <= pos)
+                     vector_map[v].resize(pos + 1);
+                 this->group_or_ungroup(vector_map, map, v, pos, Group());
+             });
     }
 
     template <class VectorPropertyMap, class PropertyMap, class Descriptor>
@@ -81,6 +85,28 @@ struct do_group_vector_property
 
     template <class RetVal, class Value>
     inline void convert(const Value& v, RetVal& r)  const
+    {
+        convert_dispatch(v, r,
+                         std::integral_constant<bool,
+                                                std::is_arithmetic<Value>::value &&
+                                                std::is_arithmetic<RetVal>::value>());
+    }
+
+    // numeric conversion between arithmetic types, which avoids interpreting
+    // uint8_t values as characters; values that do not fit in the target type
+    // throw boost::numeric::bad_numeric_cast, while widening conversions are
+    // not checked at all
+    template <class RetVal, class Value>
+    inline void convert_dispatch(const Value& v, RetVal& r, std::true_type) const
+    {
+        if (std::is_floating_point<Value>::value &&
+            !std::is_floating_point<RetVal>::value && std::isnan(double(v)))
+            throw boost::numeric::bad_numeric_cast();
+        r = boost::numeric_cast<RetVal>(v);
+    }
+
+    template <class RetVal, class Value>
+    inline void convert_dispatch(const Value& v, RetVal& r, std::false_type) const
     {
         r = boost::lexical_cast<RetVal>(v);
     }
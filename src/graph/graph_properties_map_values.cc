@@ -15,6 +15,9 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
+#include <limits>
+#include <unordered_map>
+
 #include "graph.hh"
 #include "graph_properties.hh"
 #include "graph_filtering.hh"
@@ -31,6 +34,10 @@ using namespace graph_tool;
 void edge_property_map_values(GraphInterface& g, boost::any src_prop,
                               boost::any tgt_prop, boost::python::object mapper);
 
+void edge_property_transform_values(GraphInterface& g, boost::any src_prop,
+                                    boost::any tgt_prop,
+                                    const transform_params& t);
+
 void property_map_values(GraphInterface& g, boost::any src_prop,
                          boost::any tgt_prop, boost::python::object mapper,
                          bool edge)
@@ -48,3 +55,153 @@ void property_map_values(GraphInterface& g, boost::any src_prop,
         edge_property_map_values(g, src_prop, tgt_prop, mapper);
     }
 }
+
+void property_transform_values(GraphInterface& g, boost::any src_prop,
+                               boost::any tgt_prop, std::string op,
+                               boost::python::object params, bool edge)
+{
+    transform_params t;
+    size_t nparams = 0;
+    if (op == "affine")
+    {
+        t.op = value_transform::affine;
+        nparams = 2;
+    }
+    else if (op == "log")
+    {
+        t.op = value_transform::log;
+    }
+    else if (op == "clip")
+    {
+        t.op = value_transform::clip;
+        nparams = 2;
+    }
+    else if (op == "lut")
+    {
+        t.op = value_transform::lut;
+        for (long i = 0; i < python::len(params); ++i)
+            t.lut.push_back(python::extract<double>(params[i]));
+    }
+    else
+    {
+        throw ValueException("invalid transform: " + op);
+    }
+
+    if (nparams > 0)
+    {
+        if (size_t(python::len(params)) != nparams)
+            throw ValueException("transform '" + op + "' requires " +
+                                 lexical_cast<string>(nparams) + " parameters");
+        t.a = python::extract<double>(params[0]);
+        t.b = python::extract<double>(params[1]);
+    }
+
+    if (!edge)
+    {
+        run_action<graph_tool::detail::always_directed_never_reversed>()
+            (g, std::bind(do_transform_values(), std::placeholders::_1,
+                          std::placeholders::_2, std::placeholders::_3,
+                          std::ref(t)),
+             vertex_scalar_properties(), writable_vertex_scalar_properties())
+            (src_prop, tgt_prop);
+    }
+    else
+    {
+        edge_property_transform_values(g, src_prop, tgt_prop, t);
+    }
+}
+
+// Dictionary encoding of string properties: each distinct string is replaced by
+// an integer code, given by the order of its first appearance.
+
+template <class IndexMap>
+struct writable_integer_properties:
+        property_map_types::apply<integer_types, IndexMap,
+                                  boost::mpl::bool_<false> >::type {};
+
+template <class IndexMap>
+python::list do_encode_strings(boost::any& asrc, boost::any& atgt)
+{
+    typedef typename property_map_type::apply<std::string, IndexMap>::type
+        sprop_t;
+    auto src = any_cast<sprop_t>(asrc);
+    auto& sstorage = src.get_storage();
+
+    python::list labels;
+    gt_dispatch<>()
+        ([&](auto& tgt)
+         {
+             typedef typename std::remove_reference<decltype(tgt)>::type
+                 ::value_type val_t;
+             size_t N = sstorage.size();
+             tgt.reserve(N);
+             auto& tstorage = tgt.get_storage();
+             std::unordered_map<std::string, val_t> codes;
+             for (size_t i = 0; i < N; ++i)
+             {
+                 auto iter = codes.find(sstorage[i]);
+                 if (iter == codes.end())
+                 {
+                     if (codes.size() >
+                         size_t(std::numeric_limits<val_t>::max()))
+                         throw ValueException("too many distinct values for "
+                                              "the chosen integer type");
+                     val_t c = codes.size();
+                     iter = codes.emplace(sstorage[i], c).first;
+                     labels.append(sstorage[i]);
+                 }
+                 tstorage[i] = iter->second;
+             }
+         },
+         writable_integer_properties<IndexMap>())(atgt);
+    return labels;
+}
+
+template <class IndexMap>
+void do_decode_strings(boost::any& asrc, boost::any& atgt,
+                       python::object olabels)
+{
+    typedef typename property_map_type::apply<std::string, IndexMap>::type
+        sprop_t;
+    auto tgt = any_cast<sprop_t>(atgt);
+
+    std::vector<std::string> labels;
+    for (long i = 0; i < python::len(olabels); ++i)
+        labels.push_back(python::extract<std::string>(olabels[i]));
+
+    gt_dispatch<>()
+        ([&](auto& src)
+         {
+             auto& cstorage = src.get_storage();
+             size_t N = cstorage.size();
+             for (auto c : cstorage)
+             {
+                 if (c < 0 || size_t(c) >= labels.size())
+                     throw ValueException("invalid code: " +
+                                          lexical_cast<string>(int64_t(c)));
+             }
+             tgt.reserve(N);
+             auto& tstorage = tgt.get_storage();
+             #pragma omp parallel for schedule(runtime) \
+                 if (N > OPENMP_MIN_THRESH)
+             for (size_t i = 0; i < N; ++i)
+                 tstorage[i] = labels[cstorage[i]];
+         },
+         writable_integer_properties<IndexMap>())(asrc);
+}
+
+python::list encode_string_property(boost::any src, boost::any tgt, bool edge)
+{
+    if (edge)
+        return do_encode_strings<GraphInterface::edge_index_map_t>(src, tgt);
+    return do_encode_strings<GraphInterface::vertex_index_map_t>(src, tgt);
+}
+
+void decode_string_property(boost::any src, boost::any tgt,
+                            python::object labels, bool edge)
+{
+    if (edge)
+        do_decode_strings<GraphInterface::edge_index_map_t>(src, tgt, labels);
+    else
+        do_decode_strings<GraphInterface::vertex_index_map_t>(src, tgt, labels);
+}
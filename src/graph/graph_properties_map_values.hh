@@ -19,6 +19,7 @@
 #define GRAPH_PROPERTIES_MAP_VALUES_HH
 
 #include <unordered_map>
+#include <cmath>
 #include <boost/python/extract.hpp>
 
 namespace graph_tool
@@ -79,6 +80,93 @@ struct do_map_values
     }
 };
 
+// Element-wise numeric transforms, computed in C++ without calling back into
+// python, i.e. tgt[v] = f(src[v]), with f given by:
+//
+//     affine: a * x + b
+//     log:    log(x)
+//     clip:   min(max(x, a), b)
+//     lut:    lut[x], for integer x in [0, len(lut))
+
+enum class value_transform { affine, log, clip, lut };
+
+struct transform_params
+{
+    value_transform op;
+    double a = 1;
+    double b = 0;
+    std::vector<double> lut;
+};
+
+struct do_transform_values
+{
+    template <class Graph, class SrcProp, class TgtProp>
+    void operator()(Graph& g, SrcProp src, TgtProp tgt,
+                    const transform_params& t) const
+    {
+        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+        typedef typename property_traits<SrcProp>::key_type key_type;
+        typedef typename property_traits<SrcProp>::value_type src_value_t;
+        typedef typename property_traits<TgtProp>::value_type tgt_value_t;
+
+        bool out_of_range = false;
+        auto f = [&](const auto& d)
+            {
+                double x = src[d];
+                double y;
+                switch (t.op)
+                {
+                case value_transform::affine:
+                    y = t.a * x + t.b;
+                    break;
+                case value_transform::log:
+                    y = std::log(x);
+                    break;
+                case value_transform::clip:
+                    y = std::min(std::max(x, t.a), t.b);
+                    break;
+                case value_transform::lut:
+                    {
+                        auto i = src[d];
+                        if (std::is_floating_point<src_value_t>::value ||
+                            i < 0 || size_t(i) >= t.lut.size())
+                        {
+                            out_of_range = true;
+                            return;
+                        }
+                        y = t.lut[size_t(i)];
+                    }
+                    break;
+                default:
+                    y = x;
+                }
+                tgt[d] = static_cast<tgt_value_t>(y);
+            };
+
+        dispatch(g, f, std::is_same<key_type, vertex_t>());
+
+        if (out_of_range)
+        {
+            if (std::is_floating_point<src_value_t>::value)
+                throw ValueException("lookup table transform requires integer "
+                                     "source values");
+            throw ValueException("source value out of range of lookup table");
+        }
+    }
+
+    template <class Graph, class F>
+    void dispatch(Graph& g, F& f, std::true_type) const
+    {
+        parallel_vertex_loop(g, f);
+    }
+
+    template <class Graph, class F>
+    void dispatch(Graph& g, F& f, std::false_type) const
+    {
+        parallel_edge_loop_flat(g, f);
+    }
+};
+
 } // namespace graph_tool
 
 #endif // GRAPH_PROPERTIES_MAP_VALUES_HH
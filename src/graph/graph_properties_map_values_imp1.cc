@@ -38,3 +38,15 @@ void edge_property_map_values(GraphInterface& g, boost::any src_prop,
          edge_properties(), writable_edge_properties())
         (src_prop, tgt_prop);
 }
+
+void edge_property_transform_values(GraphInterface& g, boost::any src_prop,
+                                    boost::any tgt_prop,
+                                    const transform_params& t)
+{
+    run_action<graph_tool::detail::always_directed_never_reversed>()
+        (g, std::bind(do_transform_values(), std::placeholders::_1,
+                      std::placeholders::_2, std::placeholders::_3,
+                      std::ref(t)),
+         edge_scalar_properties(), writable_edge_scalar_properties())
+        (src_prop, tgt_prop);
+}
@@ -0,0 +1,198 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_filtering.hh"
+#include "graph_selectors.hh"
+
+#include "numpy_bind.hh"
+
+#include <boost/python/extract.hpp>
+
+// Bulk transfer between scalar vector-valued property maps and contiguous
+// numpy buffers, either as a fixed-width 2D array (one row per vector
+// position), or as a ragged pair (values, offsets) in CSR layout. Both avoid
+// the creation of one intermediary scalar property map per position done by
+// ungroup_vector_property().
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+template <class Action>
+void dispatch_vector_property(boost::any& prop, bool edge, Action&& a)
+{
+    if (edge)
+        gt_dispatch<>()(a, edge_scalar_vector_properties())(prop);
+    else
+        gt_dispatch<>()(a, vertex_scalar_vector_properties())(prop);
+}
+
+template <class Prop>
+void reserve_indexes(Prop& prop, const multi_array_ref<int64_t,1>& idx)
+{
+    int64_t M = -1;
+    for (auto i : idx)
+    {
+        if (i < 0)
+            throw ValueException("invalid descriptor index: " +
+                                 lexical_cast<string>(i));
+        M = std::max(M, i);
+    }
+    prop.reserve(M + 1);
+}
+
+void vector_property_get_2d(GraphInterface&, boost::any prop,
+                            python::object oidx, python::object opos,
+                            python::object oa, bool edge)
+{
+    auto idx = get_array<int64_t,1>(oidx);
+    auto pos = get_array<int64_t,1>(opos);
+    dispatch_vector_property
+        (prop, edge,
+         [&](auto& vprop)
+         {
+             typedef typename std::remove_reference<decltype(vprop)>::type
+                 ::value_type::value_type val_t;
+             auto a = get_array<val_t,2>(oa);
+             if (a.shape()[0] != pos.size() || a.shape()[1] != idx.size())
+                 throw ValueException("invalid output array shape");
+             reserve_indexes(vprop, idx);
+             auto& storage = vprop.get_storage();
+             size_t N = idx.size();
+             #pragma omp parallel for schedule(runtime) \
+                 if (N > OPENMP_MIN_THRESH)
+             for (size_t i = 0; i < N; ++i)
+             {
+                 auto& vec = storage[idx[i]];
+                 for (size_t j = 0; j < pos.size(); ++j)
+                 {
+                     size_t k = pos[j];
+                     a[j][i] = (k < vec.size()) ? vec[k] : val_t(0);
+                 }
+             }
+         });
+}
+
+void vector_property_set_2d(GraphInterface&, boost::any prop,
+                            python::object oidx, python::object opos,
+                            python::object oa, bool edge)
+{
+    auto idx = get_array<int64_t,1>(oidx);
+    auto pos = get_array<int64_t,1>(opos);
+    dispatch_vector_property
+        (prop, edge,
+         [&](auto& vprop)
+         {
+             typedef typename std::remove_reference<decltype(vprop)>::type
+                 ::value_type::value_type val_t;
+             auto a = get_array<val_t,2>(oa);
+             if (a.shape()[0] != pos.size() || a.shape()[1] != idx.size())
+                 throw ValueException("invalid input array shape");
+             size_t kmax = 0;
+             for (auto k : pos)
+             {
+                 if (k < 0)
+                     throw ValueException("invalid vector position: " +
+                                          lexical_cast<string>(k));
+                 kmax = std::max(kmax, size_t(k) + 1);
+             }
+             reserve_indexes(vprop, idx);
+             auto& storage = vprop.get_storage();
+             size_t N = idx.size();
+             #pragma omp parallel for schedule(runtime) \
+                 if (N > OPENMP_MIN_THRESH)
+             for (size_t i = 0; i < N; ++i)
+             {
+                 auto& vec = storage[idx[i]];
+                 if (vec.size() < kmax)
+                     vec.resize(kmax);
+                 for (size_t j = 0; j < pos.size(); ++j)
+                     vec[pos[j]] = a[j][i];
+             }
+         });
+}
+
+python::object vector_property_get_ragged(GraphInterface&, boost::any prop,
+                                          python::object oidx, bool edge)
+{
+    auto idx = get_array<int64_t,1>(oidx);
+    python::object ret;
+    dispatch_vector_property
+        (prop, edge,
+         [&](auto& vprop)
+         {
+             typedef typename std::remove_reference<decltype(vprop)>::type
+                 ::value_type::value_type val_t;
+             reserve_indexes(vprop, idx);
+             auto& storage = vprop.get_storage();
+             size_t N = idx.size();
+             vector<int64_t> offsets(N + 1, 0);
+             for (size_t i = 0; i < N; ++i)
+                 offsets[i + 1] = offsets[i] + storage[idx[i]].size();
+             vector<val_t> vals(offsets[N]);
+             #pragma omp parallel for schedule(runtime) \
+                 if (N > OPENMP_MIN_THRESH)
+             for (size_t i = 0; i < N; ++i)
+             {
+                 auto& vec = storage[idx[i]];
+                 std::copy(vec.begin(), vec.end(), vals.begin() + offsets[i]);
+             }
+             ret = python::make_tuple(wrap_vector_owned(vals),
+                                      wrap_vector_owned(offsets));
+         });
+    return ret;
+}
+
+void vector_property_set_ragged(GraphInterface&, boost::any prop,
+                                python::object oidx, python::object ovals,
+                                python::object ooffsets, bool edge)
+{
+    auto idx = get_array<int64_t,1>(oidx);
+    auto offsets = get_array<int64_t,1>(ooffsets);
+    if (offsets.size() != idx.size() + 1)
+        throw ValueException("offsets array must have length len(idx) + 1");
+    if (offsets[0] < 0)
+        throw ValueException("invalid offsets array");
+    dispatch_vector_property
+        (prop, edge,
+         [&](auto& vprop)
+         {
+             typedef typename std::remove_reference<decltype(vprop)>::type
+                 ::value_type::value_type val_t;
+             auto vals = get_array<val_t,1>(ovals);
+             size_t N = idx.size();
+             for (size_t i = 0; i < N; ++i)
+             {
+                 if (offsets[i + 1] < offsets[i] ||
+                     size_t(offsets[i + 1]) > vals.size())
+                     throw ValueException("invalid offsets array");
+             }
+             reserve_indexes(vprop, idx);
+             auto& storage = vprop.get_storage();
+             #pragma omp parallel for schedule(runtime) \
+                 if (N > OPENMP_MIN_THRESH)
+             for (size_t i = 0; i < N; ++i)
+             {
+                 auto& vec = storage[idx[i]];
+                 vec.assign(vals.begin() + offsets[i],
+                            vals.begin() + offsets[i + 1]);
+             }
+         });
+}
@@ -23,6 +23,7 @@
 #include <boost/python.hpp>
 #include <boost/python/stl_iterator.hpp>
 #include <set>
+#include <numeric>
 
 
 using namespace std;
@@ -148,6 +149,12 @@ struct add_new_vertex
 
 python::object add_vertex(GraphInterface& gi, size_t n)
 {
+    typedef GraphInterface::index_t index_t;
+    if (n >= numeric_limits<index_t>::max() - gi.get_num_vertices(false))
+        throw GraphException("too many vertices for the configured index "
+                             "type (" +
+                             lexical_cast<string>(sizeof(index_t) * 8) +
+                             " bits)");
     python::object v;
     run_action<>()(gi, std::bind(add_new_vertex(), std::placeholders::_1,
                                  std::ref(gi), n, std::ref(v)))();
@@ -212,6 +219,12 @@ struct add_new_edge
 
 python::object add_edge(GraphInterface& gi, size_t s, size_t t)
 {
+    typedef GraphInterface::index_t index_t;
+    if (gi.get_edge_index_range() >= numeric_limits<index_t>::max() - 1)
+        throw GraphException("too many edges for the configured index "
+                             "type (" +
+                             lexical_cast<string>(sizeof(index_t) * 8) +
+                             " bits)");
     python::object new_e;
     run_action<>()(gi, std::bind(add_new_edge(), std::placeholders::_1, std::ref(gi),
                                  s, t, std::ref(new_e)))();
@@ -233,6 +246,14 @@ struct get_edge_dispatch
                     bool all_edges, boost::python::list& es) const
     {
         auto gp = retrieve_graph_view<Graph>(gi, g);
+        if (!all_edges && gi.get_keep_out_index() &&
+            !gi.is_vertex_filter_active() && !gi.is_edge_filter_active())
+        {
+            auto e = edge(vertex(s, g), vertex(t, g), g);
+            if (e.second)
+                es.append(PythonEdge<Graph>(gp, e.first));
+            return;
+        }
         size_t k_t = graph_tool::is_directed(g) ?
             in_degreeS()(t, g) : out_degree(t, g);
         if (out_degree(s, g) <= k_t)
@@ -341,19 +362,82 @@ python::object get_vertex_list(GraphInterface& gi)
     return wrap_vector_owned(vlist);
 }
 
+// Edges are visited by edges() one vertex at a time, following the out-edges
+// of the underlying directed graph (or the in-edges, for reversed views). This
+// computes the position of each vertex's edges in that sequence, calls init(E)
+// with the total number of edges, and then calls f(pos, e) in parallel.
+
+template <class Graph>
+struct is_reversed_graph: detail::is_reversed_view<Graph> {};
+
+template <class Graph, class EPred, class VPred>
+struct is_reversed_graph<filt_graph<Graph, EPred, VPred>>:
+        detail::is_reversed_view<Graph> {};
+
+template <class Graph, class Range, class Init, class F>
+void do_edge_pos_loop(const Graph& g, Range&& vedges, Init&& init, F&& f)
+{
+    size_t N = num_vertices(g);
+    std::vector<size_t> offset(N + 1, 0);
+
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto v = vertex(i, g);
+        if (!is_valid_vertex(v, g))
+            continue;
+        auto r = vedges(v);
+        offset[i + 1] = std::distance(r.first, r.second);
+    }
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    init(offset[N]);
+
+    #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto v = vertex(i, g);
+        if (!is_valid_vertex(v, g))
+            continue;
+        size_t pos = offset[i];
+        auto r = vedges(v);
+        for (auto e = r.first; e != r.second; ++e)
+            f(pos++, *e);
+    }
+}
+
+template <class Graph, class Init, class F>
+void edge_pos_loop(const Graph& g, Init&& init, F&& f, std::true_type)
+{
+    do_edge_pos_loop(g, [&](auto v) { return in_edges(v, g); }, init, f);
+}
+
+template <class Graph, class Init, class F>
+void edge_pos_loop(const Graph& g, Init&& init, F&& f, std::false_type)
+{
+    auto&& u = get_dir(g, typename is_directed::apply<Graph>::type());
+    do_edge_pos_loop(g, [&](auto v) { return out_edges(v, u); }, init, f);
+}
+
 python::object get_edge_list(GraphInterface& gi)
 {
     std::vector<size_t> elist;
     run_action<>()(gi,
                    [&](auto& g)
                    {
+                       typedef typename std::remove_reference
+                           <decltype(g)>::type g_t;
                        auto edge_index = get(edge_index_t(), g);
-                       for (auto e: edges_range(g))
-                       {
-                           elist.push_back(source(e, g));
-                           elist.push_back(target(e, g));
-                           elist.push_back(edge_index[e]);
-                       }
+                       edge_pos_loop
+                           (g,
+                            [&](size_t E) { elist.resize(3 * E); },
+                            [&](size_t pos, const auto& e)
+                            {
+                                elist[3 * pos] = source(e, g);
+                                elist[3 * pos + 1] = target(e, g);
+                                elist[3 * pos + 2] = edge_index[e];
+                            },
+                            typename is_reversed_graph<g_t>::type());
                    })();
     return wrap_vector_owned(elist);
 }
@@ -432,8 +516,18 @@ python::object get_in_neighbors_list(GraphInterface& gi, size_t v)
     return wrap_vector_owned(vlist);
 }
 
+template <class Graph, class VList>
+void check_vertex_list(const Graph& g, const VList& vlist)
+{
+    for (auto v : vlist)
+    {
+        if (!is_valid_vertex(v, g))
+            throw ValueException("invalid vertex: " + lexical_cast<string>(v));
+    }
+}
+
 python::object get_degree_list(GraphInterface& gi, python::object ovlist,
-                               boost::any eprop, bool out)
+                               boost::any eprop, string deg)
 {
     python::object ret;
     auto vlist = get_array<uint64_t,1>(ovlist);
@@ -461,24 +555,77 @@ python::object get_degree_list(GraphInterface& gi, python::object ovlist,
                            {
                                typedef typename std::remove_reference
                                    <decltype(ew)>::type::value_type val_t;
-                               std::vector<val_t> dlist;
-                               dlist.reserve(vlist.size());
-                               for (auto v : vlist)
-                               {
-                                   if (!is_valid_vertex(v, g))
-                                       throw ValueException("invalid vertex: " +
-                                                            lexical_cast<string>(v));
-                                   dlist.push_back(val_t(deg(v, g, ew)));
-                               }
+                               check_vertex_list(g, vlist);
+                               std::vector<val_t> dlist(vlist.size());
+                               size_t N = vlist.size();
+                               #pragma omp parallel for schedule(runtime) \
+                                   if (N > OPENMP_MIN_THRESH)
+                               for (size_t i = 0; i < N; ++i)
+                                   dlist[i] = val_t(deg(vlist[i], g, ew));
                                ret = wrap_vector_owned(dlist);
                            }, eprops_t())(eprop);
         };
 
-    if (out)
+    if (deg == "out")
         get_degs(out_degreeS());
-    else
+    else if (deg == "in")
         get_degs(in_degreeS());
+    else if (deg == "total")
+        get_degs(total_degreeS());
+    else
+        throw ValueException("invalid degree type: " + deg);
+
+    return ret;
+}
 
+python::object get_neighbors_lists(GraphInterface& gi, python::object ovlist,
+                                   bool out)
+{
+    python::object ret;
+    auto vlist = get_array<uint64_t,1>(ovlist);
+    run_action<>()(gi,
+                   [&](auto& g)
+                   {
+                       check_vertex_list(g, vlist);
+                       size_t N = vlist.size();
+                       std::vector<uint64_t> offsets(N + 1, 0);
+                       #pragma omp parallel for schedule(runtime) \
+                           if (N > OPENMP_MIN_THRESH)
+                       for (size_t i = 0; i < N; ++i)
+                       {
+                           if (out)
+                           {
+                               auto r = out_neighbors_range(vlist[i], g);
+                               offsets[i + 1] = std::distance(r.begin(), r.end());
+                           }
+                           else
+                           {
+                               auto r = in_neighbors_range(vlist[i], g);
+                               offsets[i + 1] = std::distance(r.begin(), r.end());
+                           }
+                       }
+                       std::partial_sum(offsets.begin(), offsets.end(),
+                                        offsets.begin());
+                       std::vector<uint64_t> ulist(offsets[N]);
+                       #pragma omp parallel for schedule(runtime) \
+                           if (N > OPENMP_MIN_THRESH)
+                       for (size_t i = 0; i < N; ++i)
+                       {
+                           size_t pos = offsets[i];
+                           if (out)
+                           {
+                               for (auto u : out_neighbors_range(vlist[i], g))
+                                   ulist[pos++] = u;
+                           }
+                           else
+                           {
+                               for (auto u : in_neighbors_range(vlist[i], g))
+                                   ulist[pos++] = u;
+                           }
+                       }
+                       ret = python::make_tuple(wrap_vector_owned(ulist),
+                                                wrap_vector_owned(offsets));
+                   })();
     return ret;
 }
 
@@ -714,6 +861,7 @@ void export_python_interface()
     def("get_out_neighbors_list", get_out_neighbors_list);
     def("get_in_neighbors_list", get_in_neighbors_list);
     def("get_degree_list", get_degree_list);
+    def("get_neighbors_lists", get_neighbors_lists);
 
     def("get_vertex_index", get_vertex_index);
     def("get_edge_index", do_get_edge_index);
@@ -540,6 +540,124 @@ public:
         return boost::python::object();
     }
 
+    // Batched access by vertex or edge index, i.e. the same positions as in
+    // the array returned by get_array(). Scalar values are exchanged via numpy
+    // arrays, and the remaining types via python lists.
+
+    typedef typename boost::mpl::or_<
+        std::is_same<PropertyMap,
+                     GraphInterface::vertex_index_map_t>,
+        std::is_same<PropertyMap,
+                     GraphInterface::edge_index_map_t> >::type is_index_map;
+
+    typedef typename boost::mpl::has_key<numpy_types, value_type>::type
+        is_numpy_value;
+
+    template <class IndexArray>
+    size_t get_index_range(const IndexArray& idx)
+    {
+        size_t M = 0;
+        for (auto i : idx)
+        {
+            if (i < 0)
+                throw ValueException("invalid index: " +
+                                     boost::lexical_cast<std::string>(i));
+            M = std::max(M, size_t(i) + 1);
+        }
+        return M;
+    }
+
+    boost::python::object get_values(boost::python::object oidx)
+    {
+        auto idx = ::get_array<int64_t,1>(oidx);
+        size_t M = get_index_range(idx);
+        return get_values_dispatch(idx, M, is_index_map(), is_numpy_value());
+    }
+
+    template <class IndexArray, class IsNumpy>
+    boost::python::object get_values_dispatch(const IndexArray& idx, size_t,
+                                              boost::mpl::bool_<true>, IsNumpy)
+    {
+        std::vector<value_type> vals(idx.begin(), idx.end());
+        return wrap_vector_owned(vals);
+    }
+
+    template <class IndexArray>
+    boost::python::object get_values_dispatch(const IndexArray& idx, size_t M,
+                                              boost::mpl::bool_<false>,
+                                              boost::mpl::bool_<true>)
+    {
+        _pmap.reserve(M);
+        auto& storage = _pmap.get_storage();
+        size_t N = idx.size();
+        std::vector<value_type> vals(N);
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+            vals[i] = storage[idx[i]];
+        return wrap_vector_owned(vals);
+    }
+
+    template <class IndexArray>
+    boost::python::object get_values_dispatch(const IndexArray& idx, size_t M,
+                                              boost::mpl::bool_<false>,
+                                              boost::mpl::bool_<false>)
+    {
+        _pmap.reserve(M);
+        auto& storage = _pmap.get_storage();
+        boost::python::list vals;
+        for (auto i : idx)
+            vals.append(boost::python::object(storage[i]));
+        return vals;
+    }
+
+    void set_values(boost::python::object oidx, boost::python::object ovals)
+    {
+        auto idx = ::get_array<int64_t,1>(oidx);
+        if (size_t(boost::python::len(ovals)) != idx.size())
+            throw ValueException("number of values (" +
+                                 boost::lexical_cast<std::string>(boost::python::len(ovals)) +
+                                 ") does not match the number of indexes (" +
+                                 boost::lexical_cast<std::string>(idx.size()) + ")");
+        size_t M = get_index_range(idx);
+        typename boost::mpl::and_<
+            typename boost::mpl::not_<is_index_map>::type,
+            std::is_convertible<typename boost::property_traits<PropertyMap>::category,
+                                boost::writable_property_map_tag>>::type writable;
+        set_values_dispatch(idx, ovals, M, writable, is_numpy_value());
+    }
+
+    template <class IndexArray, class IsNumpy>
+    void set_values_dispatch(const IndexArray&, boost::python::object, size_t,
+                             boost::mpl::bool_<false>, IsNumpy)
+    {
+        throw ValueException("property is read-only");
+    }
+
+    template <class IndexArray>
+    void set_values_dispatch(const IndexArray& idx, boost::python::object ovals,
+                             size_t M, boost::mpl::bool_<true>,
+                             boost::mpl::bool_<true>)
+    {
+        auto vals = ::get_array<value_type,1>(ovals);
+        _pmap.reserve(M);
+        auto& storage = _pmap.get_storage();
+        size_t N = idx.size();
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+            storage[idx[i]] = vals[i];
+    }
+
+    template <class IndexArray>
+    void set_values_dispatch(const IndexArray& idx, boost::python::object ovals,
+                             size_t M, boost::mpl::bool_<true>,
+                             boost::mpl::bool_<false>)
+    {
+        _pmap.reserve(M);
+        auto& storage = _pmap.get_storage();
+        for (size_t i = 0; i < idx.size(); ++i)
+            storage[idx[i]] = boost::python::extract<value_type>(ovals[i]);
+    }
+
     bool is_writable() const
     {
         return std::is_convertible<typename boost::property_traits<PropertyMap>::category,
@@ -603,6 +721,27 @@ public:
     {
     }
 
+    void numa_interleave()
+    {
+        typename boost::mpl::or_<
+            std::is_same<PropertyMap,
+                         GraphInterface::vertex_index_map_t>,
+            std::is_same<PropertyMap,
+                         GraphInterface::edge_index_map_t> >::type is_index;
+        numa_interleave_dispatch(is_index);
+    }
+
+    void numa_interleave_dispatch(boost::mpl::bool_<false>)
+    {
+        auto& store = _pmap.get_storage();
+        graph_tool::numa_interleave(store.data(),
+                                    store.size() * sizeof(value_type));
+    }
+
+    void numa_interleave_dispatch(boost::mpl::bool_<true>)
+    {
+    }
+
     size_t data_ptr()
     {
         typename boost::mpl::or_<
@@ -623,6 +762,56 @@ public:
         return size_t(_pmap.get_storage().data());
     }
 
+    // memory held by the property values, in bytes, including the heap
+    // storage of vector and string values, and unused capacity
+    size_t memory_usage()
+    {
+        typename boost::mpl::or_<
+            std::is_same<PropertyMap,
+                         GraphInterface::vertex_index_map_t>,
+            std::is_same<PropertyMap,
+                         GraphInterface::edge_index_map_t> >::type is_index;
+        return memory_usage_dispatch(is_index);
+    }
+
+    size_t memory_usage_dispatch(boost::mpl::bool_<true>)
+    {
+        return 0;
+    }
+
+    size_t memory_usage_dispatch(boost::mpl::bool_<false>)
+    {
+        auto& storage = _pmap.get_storage();
+        size_t n = storage.capacity() * sizeof(value_type);
+        size_t N = storage.size();
+        #pragma omp parallel for schedule(runtime) reduction(+:n) \
+            if (N > OPENMP_MIN_THRESH && !std::is_arithmetic<value_type>::value)
+        for (size_t i = 0; i < N; ++i)
+            n += heap_usage(storage[i]);
+        return n;
+    }
+
+    template <class T>
+    static size_t heap_usage(const T&)
+    {
+        return 0;
+    }
+
+    static size_t heap_usage(const std::string& s)
+    {
+        // short strings are stored inline
+        return (s.capacity() > std::string().capacity()) ? s.capacity() + 1 : 0;
+    }
+
+    template <class T>
+    static size_t heap_usage(const std::vector<T>& v)
+    {
+        size_t n = v.capacity() * sizeof(T);
+        for (auto& x : v)
+            n += heap_usage(x);
+        return n;
+    }
+
 private:
     PropertyMap _pmap; // hold an internal copy, since it's cheap
 };
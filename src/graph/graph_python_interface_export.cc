@@ -62,11 +62,15 @@ struct export_vertex_property_map
             .def("get_map", &pmap_t::get_map)
             .def("get_dynamic_map", &pmap_t::get_dynamic_map)
             .def("get_array", &pmap_t::get_array)
+            .def("get_values", &pmap_t::get_values)
+            .def("set_values", &pmap_t::set_values)
             .def("is_writable", &pmap_t::is_writable)
             .def("reserve", &pmap_t::reserve)
             .def("resize", &pmap_t::resize)
             .def("shrink_to_fit", &pmap_t::shrink_to_fit)
-            .def("data_ptr", &pmap_t::data_ptr);
+            .def("numa_interleave", &pmap_t::numa_interleave)
+            .def("data_ptr", &pmap_t::data_ptr)
+            .def("memory_usage", &pmap_t::memory_usage);
 
         typedef boost::mpl::transform<graph_tool::all_graph_views,
                                       boost::mpl::quote1<std::add_const> >::type const_graph_views;
@@ -145,11 +149,15 @@ struct export_edge_property_map
             .def("get_map", &pmap_t::get_map)
             .def("get_dynamic_map", &pmap_t::get_dynamic_map)
             .def("get_array", &pmap_t::get_array)
+            .def("get_values", &pmap_t::get_values)
+            .def("set_values", &pmap_t::set_values)
             .def("is_writable", &pmap_t::is_writable)
             .def("reserve", &pmap_t::reserve)
             .def("resize", &pmap_t::resize)
             .def("shrink_to_fit", &pmap_t::shrink_to_fit)
-            .def("data_ptr", &pmap_t::data_ptr);
+            .def("numa_interleave", &pmap_t::numa_interleave)
+            .def("data_ptr", &pmap_t::data_ptr)
+            .def("memory_usage", &pmap_t::memory_usage);
 
 
         typedef boost::mpl::transform<graph_tool::all_graph_views,
@@ -197,7 +205,9 @@ struct export_graph_property_map
             .def("is_writable", &pmap_t::is_writable)
             .def("reserve", &pmap_t::reserve)
             .def("resize", &pmap_t::resize)
-            .def("shrink_to_fit", &pmap_t::shrink_to_fit);
+            .def("shrink_to_fit", &pmap_t::shrink_to_fit)
+            .def("numa_interleave", &pmap_t::numa_interleave)
+            .def("memory_usage", &pmap_t::memory_usage);
     }
 };
 
@@ -32,6 +32,54 @@ using namespace graph_tool;
 namespace graph_tool
 {
 
+// Add the edges in the (E, 2+) array "edge_list", creating missing vertices,
+// and call f(i, e) for each new edge. The unfiltered graphs are populated in
+// bulk, with exactly reserved adjacency lists.
+template <class Graph, class EdgeList, class F>
+void add_edge_array(Graph& g, const EdgeList& edge_list, F&& f)
+{
+    for (size_t i = 0; i < edge_list.size(); ++i)
+    {
+        const auto& e = edge_list[i];
+        size_t s = e[0];
+        size_t t = e[1];
+        while (s >= num_vertices(g) || t >= num_vertices(g))
+            add_vertex(g);
+        f(i, add_edge(vertex(s, g), vertex(t, g), g).first);
+    }
+}
+
+template <class Vertex, class EdgeList, class F>
+void add_edge_array(adj_list<Vertex>& g, const EdgeList& edge_list, F&& f)
+{
+    size_t N = num_vertices(g);
+    for (size_t i = 0; i < edge_list.size(); ++i)
+    {
+        const auto& e = edge_list[i];
+        N = std::max({N, size_t(e[0]) + 1, size_t(e[1]) + 1});
+    }
+
+    typedef GraphInterface::index_t index_t;
+    if (N >= numeric_limits<index_t>::max() ||
+        edge_list.size() >= (numeric_limits<index_t>::max() -
+                             g.get_edge_index_range()))
+        throw GraphException("too many vertices or edges for the configured "
+                             "index type (" +
+                             lexical_cast<string>(sizeof(index_t) * 8) +
+                             " bits)");
+
+    while (num_vertices(g) < N)
+        add_vertex(g);
+    add_edges(edge_list, g, f);
+}
+
+template <class Vertex, class EdgeList, class F>
+void add_edge_array(undirected_adaptor<adj_list<Vertex>>& g,
+                    const EdgeList& edge_list, F&& f)
+{
+    add_edge_array(g.original_graph(), edge_list, f);
+}
+
 template <class ValueList>
 struct add_edge_list
 {
@@ -69,26 +117,23 @@ struct add_edge_list
 
                 size_t n_props = std::min(eprops.size(), edge_list.shape()[1] - 2);
 
-                for (const auto& e : edge_list)
-                {
-                    size_t s = e[0];
-                    size_t t = e[1];
-                    while (s >= num_vertices(g) || t >= num_vertices(g))
-                        add_vertex(g);
-                    auto ne = add_edge(vertex(s, g), vertex(t, g), g).first;
-                    for (size_t i = 0; i < n_props; ++i)
-                    {
-                        try
-                        {
-                            put(eprops[i], ne, e[i + 2]);
-                        }
-                        catch(bad_lexical_cast&)
-                        {
-                            throw ValueException("Invalid edge property value: " +
-                                                 lexical_cast<string>(e[i + 2]));
-                        }
-                    }
-                }
+                add_edge_array(g, edge_list,
+                               [&](size_t j, const edge_t& ne)
+                               {
+                                   const auto& e = edge_list[j];
+                                   for (size_t i = 0; i < n_props; ++i)
+                                   {
+                                       try
+                                       {
+                                           put(eprops[i], ne, e[i + 2]);
+                                       }
+                                       catch(bad_lexical_cast&)
+                                       {
+                                           throw ValueException("Invalid edge property value: " +
+                                                                lexical_cast<string>(e[i + 2]));
+                                       }
+                                   }
+                               });
                 found = true;
             }
             catch (InvalidNumpyConversion& e) {}
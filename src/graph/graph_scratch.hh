@@ -0,0 +1,205 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SCRATCH_HH
+#define GRAPH_SCRATCH_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/property_map/property_map.hpp>
+
+namespace graph_tool
+{
+
+// Scratch buffers
+// ===============
+//
+// Many algorithms need temporary per-vertex or per-edge arrays, which would
+// otherwise be allocated and zero-filled on every call, which dominates the
+// cost of many calls on small graphs. Instead, they can be borrowed from a
+// per-thread pool with get_scratch<T>(), which returns a handle to an object
+// of type T that is given back to the pool when the handle is destroyed, with
+// its memory intact, so that the next call on the same thread can reuse it.
+//
+// The handles must be destroyed by the same thread that obtained them (which
+// happens naturally if they are local variables), and are not copyable, i.e.
+// each thread inside a parallel region needs to borrow its own.
+//
+// The pooled objects are kept until the thread exits, with the largest size
+// they were ever grown to. Arrays that need to start zeroed should be
+// borrowed as a stamped_buffer (see below), which is reset in O(1), e.g.
+//
+//     auto buf = get_scratch<stamped_buffer<uint8_t>>();
+//     auto mark = buf->get_map(num_vertices(g), false);
+//
+// so that the cost of each call is proportional only to the part of the array
+// it actually touches.
+
+template <class T>
+class scratch_t
+{
+public:
+    typedef std::vector<std::unique_ptr<T>> pool_t;
+
+    scratch_t(pool_t& pool)
+        : _pool(&pool)
+    {
+        if (pool.empty())
+        {
+            _obj.reset(new T());
+        }
+        else
+        {
+            _obj = std::move(pool.back());
+            pool.pop_back();
+        }
+    }
+
+    scratch_t(scratch_t&& other) = default;
+    scratch_t(const scratch_t&) = delete;
+    scratch_t& operator=(const scratch_t&) = delete;
+
+    ~scratch_t()
+    {
+        if (_obj)
+            _pool->push_back(std::move(_obj));
+    }
+
+    T& operator*() { return *_obj; }
+    T* operator->() { return _obj.get(); }
+
+private:
+    pool_t* _pool;
+    std::unique_ptr<T> _obj;
+};
+
+template <class T>
+scratch_t<T> get_scratch()
+{
+    static thread_local typename scratch_t<T>::pool_t pool;
+    return scratch_t<T>(pool);
+}
+
+// Vertex property map over a buffer that is reused across searches. Every
+// entry carries the generation in which it was last written, and reads as
+// the initial value if that is not the current one, so that starting a new
+// search resets the whole map in O(1). If a touched list is given, the vertices
+// are appended to it the first time they are written in a generation.
+template <class Value>
+class stamped_vector_property_map
+{
+public:
+    typedef size_t key_type;
+    typedef Value value_type;
+    typedef Value reference;
+    typedef boost::read_write_property_map_tag category;
+
+    stamped_vector_property_map() {}
+    stamped_vector_property_map(Value* vals, uint32_t* stamps, uint32_t gen,
+                                Value init, std::vector<size_t>* touched)
+        : _vals(vals), _stamps(stamps), _gen(gen), _init(init),
+          _touched(touched) {}
+
+    Value get(size_t v) const
+    {
+        return (_stamps[v] == _gen) ? _vals[v] : _init;
+    }
+
+    void put(size_t v, const Value& x)
+    {
+        (*this)[v] = x;
+    }
+
+    // the entry of v, which is marked as written in the current generation
+    Value& operator[](size_t v) const
+    {
+        if (_stamps[v] != _gen)
+        {
+            _stamps[v] = _gen;
+            _vals[v] = _init;
+            if (_touched != nullptr)
+                _touched->push_back(v);
+        }
+        return _vals[v];
+    }
+
+    bool is_set(size_t v) const { return _stamps[v] == _gen; }
+
+private:
+    Value* _vals = nullptr;
+    uint32_t* _stamps = nullptr;
+    uint32_t _gen = 0;
+    Value _init = Value();
+    std::vector<size_t>* _touched = nullptr;
+};
+
+template <class Value>
+Value get(const stamped_vector_property_map<Value>& m, size_t v)
+{
+    return m.get(v);
+}
+
+template <class Value>
+void put(stamped_vector_property_map<Value>& m, size_t v,
+         const typename stamped_vector_property_map<Value>::value_type& x)
+{
+    m.put(v, x);
+}
+
+template <class Value>
+void put(stamped_vector_property_map<Value>&& m, size_t v,
+         const typename stamped_vector_property_map<Value>::value_type& x)
+{
+    m.put(v, x);
+}
+
+template <class Value>
+class stamped_buffer
+{
+public:
+    // returns a map for a new generation, covering at least N vertices
+    stamped_vector_property_map<Value>
+    get_map(size_t N, Value init, std::vector<size_t>* touched = nullptr)
+    {
+        if (_vals.size() < N)
+        {
+            _vals.resize(N);
+            _stamps.resize(N, 0);
+        }
+        if (++_gen == 0)
+        {
+            // wrapped around: clear the stamps once every 2^32 searches
+            std::fill(_stamps.begin(), _stamps.end(), 0);
+            _gen = 1;
+        }
+        return stamped_vector_property_map<Value>(_vals.data(),
+                                                  _stamps.data(), _gen,
+                                                  init, touched);
+    }
+
+private:
+    std::vector<Value> _vals;
+    std::vector<uint32_t> _stamps;
+    uint32_t _gen = 0;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_SCRATCH_HH
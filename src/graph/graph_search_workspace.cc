@@ -0,0 +1,65 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph.hh"
+#include "graph_search_workspace.hh"
+#include "numpy_bind.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+boost::python::object SearchWorkspace::get_dist(python::object ovs) const
+{
+    if (!_get_dist)
+        throw ValueException("No distances were computed in the last search");
+    return _get_dist(ovs);
+}
+
+boost::python::object SearchWorkspace::get_pred(python::object ovs) const
+{
+    if (!_pred_set)
+        throw ValueException("No predecessors were computed in the last "
+                             "search");
+    auto vs = get_array<int64_t, 1>(ovs);
+    vector<int64_t> pred(vs.size());
+    for (size_t i = 0; i < vs.size(); ++i)
+    {
+        check_vertex(vs[i], _N);
+        size_t v = vs[i];
+        pred[i] = _pred_map.is_set(v) ? _pred_map.get(v) : v;
+    }
+    return wrap_vector_owned(pred);
+}
+
+boost::python::object SearchWorkspace::get_reached() const
+{
+    return wrap_vector_owned(_reached);
+}
+
+void export_search_workspace()
+{
+    using namespace boost::python;
+    class_<SearchWorkspace, std::shared_ptr<SearchWorkspace>,
+           boost::noncopyable>("SearchWorkspace")
+        .def("get_dist", &SearchWorkspace::get_dist)
+        .def("get_pred", &SearchWorkspace::get_pred)
+        .def("get_reached", &SearchWorkspace::get_reached)
+        .def("num_vertices", &SearchWorkspace::num_vertices);
+}
@@ -0,0 +1,141 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SEARCH_WORKSPACE_HH
+#define GRAPH_SEARCH_WORKSPACE_HH
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <typeindex>
+#include <algorithm>
+
+#include <boost/any.hpp>
+#include <boost/property_map/property_map.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/python/object.hpp>
+
+#include "numpy_bind.hh"
+#include "graph_exceptions.hh"
+#include "graph_scratch.hh"
+
+namespace graph_tool
+{
+
+// Color, predecessor and distance buffers that are kept between successive
+// searches, so that each search only costs the part of the graph it
+// explores, instead of allocating and initializing O(V) maps. The results of
+// the last search remain available via get_dist(), get_pred() and
+// get_reached().
+class SearchWorkspace
+{
+public:
+    typedef stamped_vector_property_map<boost::default_color_type> color_map_t;
+    typedef stamped_vector_property_map<int64_t> pred_map_t;
+
+    // starts a new search on a graph with N vertices
+    void start(size_t N)
+    {
+        _N = N;
+        _reached.clear();
+        _color_set = _pred_set = false;
+        _get_dist = nullptr;
+    }
+
+    // the reached vertices are recorded by the color map, if the search uses
+    // one, or by the distance map otherwise
+    color_map_t get_color_map()
+    {
+        _color_set = true;
+        return _color.get_map(_N, boost::white_color, &_reached);
+    }
+
+    pred_map_t get_pred_map()
+    {
+        _pred_set = true;
+        _pred_map = _pred.get_map(_N, -1);
+        return _pred_map;
+    }
+
+    template <class Value>
+    stamped_vector_property_map<Value> get_dist_map(Value inf)
+    {
+        auto m = get_buffer<Value>(_dist).get_map(_N, inf, _color_set ?
+                                                  nullptr : &_reached);
+        size_t N = _N;
+        _get_dist = [m, N](boost::python::object ovs)
+            {
+                auto vs = get_array<int64_t, 1>(ovs);
+                std::vector<Value> d(vs.size());
+                for (size_t i = 0; i < vs.size(); ++i)
+                {
+                    check_vertex(vs[i], N);
+                    d[i] = m.get(vs[i]);
+                }
+                return wrap_vector_owned(d);
+            };
+        return m;
+    }
+
+    // estimated total costs, as used by A*
+    template <class Value>
+    stamped_vector_property_map<Value> get_cost_map(Value inf)
+    {
+        return get_buffer<Value>(_cost).get_map(_N, inf);
+    }
+
+    size_t num_vertices() const { return _N; }
+
+    boost::python::object get_dist(boost::python::object vs) const;
+    boost::python::object get_pred(boost::python::object vs) const;
+    boost::python::object get_reached() const;
+
+    static void check_vertex(int64_t v, size_t N)
+    {
+        if (v < 0 || size_t(v) >= N)
+            throw ValueException("Invalid vertex index: " +
+                                 std::to_string(v));
+    }
+
+private:
+    typedef std::unordered_map<std::type_index, boost::any> buffers_t;
+
+    template <class Value>
+    static stamped_buffer<Value>& get_buffer(buffers_t& bufs)
+    {
+        auto& buf = bufs[std::type_index(typeid(Value))];
+        if (buf.empty())
+            buf = std::make_shared<stamped_buffer<Value>>();
+        return *boost::any_cast<std::shared_ptr<stamped_buffer<Value>>&>(buf);
+    }
+
+    size_t _N = 0;
+    stamped_buffer<boost::default_color_type> _color;
+    stamped_buffer<int64_t> _pred;
+    pred_map_t _pred_map;
+    buffers_t _dist;
+    buffers_t _cost;
+    std::function<boost::python::object(boost::python::object)> _get_dist;
+    std::vector<size_t> _reached;
+    bool _color_set = false;
+    bool _pred_set = false;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_SEARCH_WORKSPACE_HH
@@ -0,0 +1,115 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph.hh"
+#include "graph_trace.hh"
+#include "demangle.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+namespace graph_tool
+{
+
+std::atomic<bool> __trace_enabled(false);
+
+TraceBuffer& get_trace_buffer()
+{
+    static TraceBuffer buffer;
+    return buffer;
+}
+
+uint32_t get_trace_tid()
+{
+    static std::atomic<uint32_t> next(0);
+    thread_local uint32_t tid = next++;
+    return tid;
+}
+
+} // graph_tool namespace
+
+bool graph_tracing_enabled()
+{
+#ifdef GRAPH_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void trace_set_enabled(bool enabled)
+{
+    if (enabled && !graph_tracing_enabled())
+        throw GraphException("tracing was not enabled during compilation");
+    __trace_enabled = enabled;
+}
+
+bool trace_get_enabled()
+{
+    return __trace_enabled;
+}
+
+void trace_set_capacity(size_t n)
+{
+    get_trace_buffer().resize(n);
+}
+
+size_t trace_get_capacity()
+{
+    return get_trace_buffer().capacity();
+}
+
+void trace_clear()
+{
+    get_trace_buffer().clear();
+}
+
+// returns the number of events recorded, including the overwritten ones, and
+// a list with the retained events, as tuples (name, category, phase, argument,
+// timestamp, duration, counter value, thread id), with times in nanoseconds
+python::tuple trace_get_events()
+{
+    auto& buffer = get_trace_buffer();
+    python::list events;
+    buffer.for_each
+        ([&](auto& e)
+         {
+             string arg;
+             if (e.arg != nullptr)
+                 arg = (string(e.cat) == "kernel") ?
+                     name_demangle(e.arg) : string(e.arg);
+             events.append(python::make_tuple(string(e.name), string(e.cat),
+                                              string(1, e.ph), arg, e.ts,
+                                              e.dur, e.value, e.tid));
+         });
+    return python::make_tuple(buffer.count(), events);
+}
+
+void export_trace()
+{
+    using namespace boost::python;
+    def("graph_tracing_enabled", &graph_tracing_enabled);
+    def("trace_set_enabled", &trace_set_enabled);
+    def("trace_get_enabled", &trace_get_enabled);
+    def("trace_set_capacity", &trace_set_capacity);
+    def("trace_get_capacity", &trace_get_capacity);
+    def("trace_clear", &trace_clear);
+    def("trace_get_events", &trace_get_events);
+}
@@ -0,0 +1,172 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_TRACE_HH
+#define GRAPH_TRACE_HH
+
+#include "config.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace graph_tool
+{
+
+// Tracing of the algorithm dispatch
+// =================================
+//
+// If compiled with --enable-tracing, the following events are recorded in a
+// global ring buffer, when tracing is enabled at run time:
+//
+//   - "dispatch": a call of run_action(), from entry to exit, which includes
+//     the selection of the graph view and property map types;
+//   - "kernel": the call of the action itself, with the type of the action as
+//     its argument, so that the dispatch overhead is the difference between
+//     the two;
+//   - "phase": named phases inside the main algorithms;
+//   - "counter": per-call counters, e.g. the number of vertices and edges of
+//     the dispatched graph, or the bytes allocated for property maps.
+//
+// Every event is a fixed-size record with static strings, so that recording
+// it amounts to two clock readings, an atomic increment and a copy. When the
+// buffer is full, the oldest events are overwritten. The buffer should only be
+// read or resized while no algorithm is running.
+//
+// Without --enable-tracing, the GT_TRACE_* macros expand to nothing.
+
+struct trace_event_t
+{
+    const char* name;
+    const char* cat;
+    const char* arg;    // static string, or type name (for "kernel" events)
+    uint64_t ts;        // nanoseconds
+    uint64_t dur;       // nanoseconds ('X' events)
+    int64_t value;      // counter value ('C' events)
+    uint32_t tid;
+    char ph;            // Chrome trace phase: 'X' (complete) or 'C' (counter)
+};
+
+class TraceBuffer
+{
+public:
+    TraceBuffer() : _events(1 << 16), _pos(0) {}
+
+    void push(const trace_event_t& e)
+    {
+        size_t i = _pos.fetch_add(1, std::memory_order_relaxed);
+        _events[i % _events.size()] = e;
+    }
+
+    void resize(size_t n)
+    {
+        _events.clear();
+        _events.resize(std::max(n, size_t(1)));
+        _pos = 0;
+    }
+
+    void clear() { _pos = 0; }
+
+    size_t capacity() const { return _events.size(); }
+
+    // total number of events recorded, including the overwritten ones
+    size_t count() const { return _pos; }
+
+    // calls f(e) for the retained events, from oldest to newest
+    template <class F>
+    void for_each(F&& f) const
+    {
+        size_t n = _pos;
+        size_t first = (n > _events.size()) ? n - _events.size() : 0;
+        for (size_t i = first; i < n; ++i)
+            f(_events[i % _events.size()]);
+    }
+
+private:
+    std::vector<trace_event_t> _events;
+    std::atomic<size_t> _pos;
+};
+
+extern std::atomic<bool> __trace_enabled;
+TraceBuffer& get_trace_buffer();
+
+inline uint64_t trace_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// small sequential thread ids, which are easier to read than the native ones
+uint32_t get_trace_tid();
+
+inline bool trace_enabled()
+{
+    return __trace_enabled.load(std::memory_order_relaxed);
+}
+
+inline void trace_counter(const char* name, int64_t value)
+{
+    if (!trace_enabled())
+        return;
+    get_trace_buffer().push({name, "counter", nullptr, trace_now(), 0, value,
+                             get_trace_tid(), 'C'});
+}
+
+// records the lifetime of the object as a complete event
+class TraceScope
+{
+public:
+    TraceScope(const char* name, const char* cat, const char* arg = nullptr)
+        : _name(name), _cat(cat), _arg(arg),
+          _ts(trace_enabled() ? trace_now() : 0)
+    {}
+
+    ~TraceScope()
+    {
+        if (_ts == 0 || !trace_enabled())
+            return;
+        uint64_t t = trace_now();
+        get_trace_buffer().push({_name, _cat, _arg, _ts, t - _ts, 0,
+                                 get_trace_tid(), 'X'});
+    }
+
+private:
+    const char* _name;
+    const char* _cat;
+    const char* _arg;
+    uint64_t _ts;
+};
+
+} // graph_tool namespace
+
+#ifdef GRAPH_TRACING
+#  define GT_TRACE_CONCAT_(a, b) a ## b
+#  define GT_TRACE_CONCAT(a, b) GT_TRACE_CONCAT_(a, b)
+#  define GT_TRACE_SCOPE(name, cat, ...)                                \
+    graph_tool::TraceScope GT_TRACE_CONCAT(__gt_trace_, __COUNTER__)(name, cat, \
+                                                                  ##__VA_ARGS__)
+#  define GT_TRACE_PHASE(name) GT_TRACE_SCOPE(name, "phase")
+#  define GT_TRACE_COUNTER(name, value) graph_tool::trace_counter(name, value)
+#else
+#  define GT_TRACE_SCOPE(name, cat, ...)
+#  define GT_TRACE_PHASE(name)
+#  define GT_TRACE_COUNTER(name, value)
+#endif
+
+#endif // GRAPH_TRACE_HH
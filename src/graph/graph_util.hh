@@ -44,10 +44,18 @@ namespace boost { namespace python { namespace detail {
 
 #include <functional>
 #include <random>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "graph_selectors.hh"
 #include "graph_reverse.hh"
 #include "graph_filtered.hh"
+#include "openmp_tuning.hh"
 
 namespace graph_tool
 {
@@ -200,7 +208,8 @@ void parallel_vertex_loop_no_spawn(const Graph& g, F&& f)
 template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
 void parallel_vertex_loop(const Graph& g, F&& f)
 {
-    #pragma omp parallel if (num_vertices(g) > thres)
+    loop_schedule_scope<thres> sched(VERTEX_LOOP);
+    #pragma omp parallel if (num_vertices(g) > get_loop_thresh<thres>(VERTEX_LOOP))
     {
         parallel_vertex_loop_no_spawn<Graph, F, thres>(g, std::forward<F>(f));
     }
@@ -246,12 +255,75 @@ void parallel_edge_loop_no_spawn(const Graph& g, F&& f)
 template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
 void parallel_edge_loop(const Graph& g, F&& f)
 {
-    #pragma omp parallel if (num_vertices(g) > thres)
+    loop_schedule_scope<thres> sched(EDGE_LOOP);
+    #pragma omp parallel if (num_vertices(g) > get_loop_thresh<thres>(EDGE_LOOP))
     {
         parallel_edge_loop_no_spawn<Graph, F, thres>(g, std::forward<F>(f));
     }
 }
 
+// Like parallel_edge_loop(), but the edges are partitioned evenly among the
+// threads, regardless of which vertex they belong to. The out-edge lists are
+// laid out contiguously (via a prefix sum of the out-degrees), and each thread
+// takes a contiguous slice of size E/nt, so that the out-edges of hubs get
+// split between threads, instead of leaving all of them behind a single
+// one. This should be preferred when the work done per edge does not depend
+// on the source vertex, and the degree distribution is broad.
+
+template <class Graph, class F, size_t thres = OPENMP_MIN_THRESH>
+void parallel_edge_loop_flat(const Graph& g, F&& f)
+{
+    auto&& u = get_dir(g, typename is_directed::apply<Graph>::type());
+    typedef typename std::remove_const
+        <typename std::remove_reference<decltype(u)>::type>::type graph_t;
+    static_assert(is_directed::apply<graph_t>::type::value,
+                  "graph must be directed at this point");
+
+    size_t N = num_vertices(u);
+    std::vector<size_t> offset(N + 1, 0);
+
+    size_t flat_thres = get_loop_thresh<thres>(FLAT_EDGE_LOOP);
+
+    #pragma omp parallel for schedule(runtime) if (N > flat_thres)
+    for (size_t i = 0; i < N; ++i)
+    {
+        auto v = vertex(i, u);
+        if (!is_valid_vertex(v, u))
+            continue;
+        offset[i + 1] = out_degree(v, u);
+    }
+    std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+    size_t E = offset[N];
+
+    #pragma omp parallel if (E > flat_thres)
+    {
+        size_t nt = 1, t = 0;
+        #ifdef _OPENMP
+        nt = omp_get_num_threads();
+        t = omp_get_thread_num();
+        #endif
+
+        size_t pos = (E * t) / nt;
+        size_t end = (E * (t + 1)) / nt;
+
+        // last vertex whose out-edges start at or before pos
+        size_t i = std::upper_bound(offset.begin(), offset.end(), pos)
+            - offset.begin() - 1;
+        for (; pos < end && i < N; ++i)
+        {
+            if (offset[i + 1] <= pos)
+                continue;
+            auto v = vertex(i, u);
+            auto iter = out_edges(v, u).first;
+            std::advance(iter, pos - offset[i]);
+            size_t last = std::min(end, offset[i + 1]);
+            for (; pos < last; ++pos, ++iter)
+                f(*iter);
+        }
+    }
+}
+
 template <class Container, class F, size_t thres = OPENMP_MIN_THRESH>
 void parallel_loop_no_spawn(Container&& v, F&& f)
 {
@@ -264,7 +336,8 @@ void parallel_loop_no_spawn(Container&& v, F&& f)
 template <class Container, class F, size_t thres = OPENMP_MIN_THRESH>
 void parallel_loop(Container&& v, F&& f)
 {
-    #pragma omp parallel if (v.size() > thres)
+    loop_schedule_scope<thres> sched(CONTAINER_LOOP);
+    #pragma omp parallel if (v.size() > get_loop_thresh<thres>(CONTAINER_LOOP))
     {
         parallel_loop_no_spawn<Container, F, thres>(std::forward<Container>(v),
                                                     std::forward<F>(f));
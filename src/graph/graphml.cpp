@@ -14,10 +14,9 @@
 #include <expat.h>
 #include <boost/graph/graphml.hpp>
 #include <boost/algorithm/string/replace.hpp>
-#include <boost/archive/iterators/xml_escape.hpp>
-#include <boost/archive/iterators/ostream_iterator.hpp>
-#include <boost/archive/iterators/insert_linebreaks.hpp>
 #include <sstream>
+#include <cstring>
+#include <unordered_map>
 
 #include "base64.hh"
 
@@ -33,12 +32,27 @@ const char* prop_type_names[] = {"boolean", "short", "int", "long", "float",
 
 std::string protect_xml_string(const std::string& os)
 {
-    using namespace boost::archive::iterators;
-    std::stringstream s;
-    std::copy(xml_escape<const char*>(os.c_str()),
-              xml_escape<const char*>(os.c_str()+os.size()),
-              ostream_iterator<char>(s));
-    return s.str();
+    // most values need no escaping, and are returned unchanged
+    size_t pos = os.find_first_of("<>&'\"");
+    if (pos == std::string::npos)
+        return os;
+
+    std::string s(os, 0, pos);
+    s.reserve(os.size() + 16);
+    for (; pos < os.size(); ++pos)
+    {
+        char c = os[pos];
+        switch (c)
+        {
+        case '<':  s += "&lt;";   break;
+        case '>':  s += "&gt;";   break;
+        case '&':  s += "&amp;";  break;
+        case '\'': s += "&apos;"; break;
+        case '"':  s += "&quot;"; break;
+        default:   s.push_back(c);
+        }
+    }
+    return s;
 }
 }
 
@@ -54,20 +68,25 @@ public:
 
     void run(std::istream& in)
     {
-        const int buffer_size = 4096;
+        // the input is read directly into expat's own buffer
+        const int buffer_size = 1 << 20;
         m_parser = XML_ParserCreateNS(0,'|');
         XML_SetElementHandler(m_parser, &on_start_element, &on_end_element);
         XML_SetCharacterDataHandler(m_parser, &on_character_data);
         XML_SetUserData(m_parser, this);
-        char buffer[buffer_size];
 
         bool okay = true;
+        bool last = false;
         do
         {
-            in.read(buffer, buffer_size);
-            okay = XML_Parse(m_parser, buffer, in.gcount(), in.gcount() == 0);
+            void* buffer = XML_GetBuffer(m_parser, buffer_size);
+            if (buffer == nullptr)
+                throw parse_error("unable to allocate parser buffer");
+            in.read(static_cast<char*>(buffer), buffer_size);
+            last = !in.good();
+            okay = XML_ParseBuffer(m_parser, in.gcount(), last);
         }
-        while (okay && in.good());
+        while (okay && !last);
 
         if (!okay)
         {
@@ -100,14 +119,22 @@ private:
     };
 
 
+    static std::string strip_namespace(const XML_Char* c_name)
+    {
+        static const char ns[] = "http://graphml.graphdrawing.org/xmlns|";
+        const size_t ns_len = sizeof(ns) - 1;
+        if (strncmp(c_name, ns, ns_len) == 0)
+            return std::string(c_name + ns_len);
+        return std::string(c_name);
+    }
+
     static void
     on_start_element(void* user_data, const XML_Char *c_name,
                      const XML_Char **atts)
     {
         graphml_reader* self = static_cast<graphml_reader*>(user_data);
 
-        std::string name(c_name);
-        replace_first(name, "http://graphml.graphdrawing.org/xmlns|", "");
+        std::string name = strip_namespace(c_name);
 
         if (name == "edge")
         {
@@ -247,8 +274,7 @@ private:
     {
         graphml_reader* self = static_cast<graphml_reader*>(user_data);
 
-        std::string name(c_name);
-        replace_first(name, "http://graphml.graphdrawing.org/xmlns|", "");
+        std::string name = strip_namespace(c_name);
 
         if (name == "data")
         {
@@ -450,11 +476,11 @@ private:
     }
 
     mutate_graph& m_g;
-    std::map<std::string, key_kind> m_keys;
-    std::map<std::string, std::string> m_key_name;
-    std::map<std::string, std::string> m_key_type;
+    std::unordered_map<std::string, key_kind> m_keys;
+    std::unordered_map<std::string, std::string> m_key_name;
+    std::unordered_map<std::string, std::string> m_key_type;
     std::map<std::string, std::string> m_key_default;
-    std::map<std::string, any> m_vertex;
+    std::unordered_map<std::string, any> m_vertex;
     std::vector<any> m_canonical_vertex;
 
     any m_active_descriptor;
@@ -20,6 +20,7 @@
 
 #include "config.h"
 #include <unordered_set>
+#include <string>
 #include <unordered_map>
 #include <tuple>
 #include <vector>
@@ -94,6 +95,15 @@ struct empty_key<std::tuple<>>
     }
 };
 
+template <>
+struct empty_key<std::string>
+{
+    static std::string get()
+    {
+        return std::string("\0\xff__gt_empty__", 14);
+    }
+};
+
 template <class Vertex>
 struct empty_key<boost::detail::adj_edge_descriptor<Vertex>>
 {
@@ -167,6 +177,15 @@ struct deleted_key<std::tuple<>>
     }
 };
 
+template <>
+struct deleted_key<std::string>
+{
+    static std::string get()
+    {
+        return std::string("\0\xff__gt_deleted__", 16);
+    }
+};
+
 template <class Vertex>
 struct deleted_key<boost::detail::adj_edge_descriptor<Vertex>>
 {
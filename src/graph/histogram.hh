@@ -31,6 +31,8 @@
 
 #include <boost/python/object.hpp>
 
+#include "shared_map.hh"
+
 //
 // This is a generic multidimensional histogram type
 //
@@ -171,7 +173,8 @@ protected:
 // This class will encapsulate a histogram, and atomically sum it to a given
 // resulting histogram (which is shared among all copies) after it is
 // destructed, or when the gather() member function is called. This enables, for
-// instance, a histogram to be built in parallel.
+// instance, a histogram to be built in parallel. The copies of a parallel
+// region are combined with tree_gather.
 
 template <class Histogram>
 class SharedHistogram: public Histogram
@@ -188,36 +191,77 @@ public:
     {
         if (_sum != 0)
         {
-            #pragma omp critical
+            tree_gather<SharedHistogram>::run
+                (*this, _sum,
+                 [](SharedHistogram& a, SharedHistogram& b)
+                 {
+                     add_to(a, b);
+                 },
+                 [](SharedHistogram& a)
+                 {
+                     #pragma omp critical
+                     add_to(*a._sum, a);
+                 });
+            _sum = 0;
+        }
+    }
+
+private:
+    // adds the counts of src to dst, growing dst if necessary
+    static void add_to(Histogram& dst, Histogram& src)
+    {
+        auto& dcounts = dst.get_array();
+        auto& scounts = src.get_array();
+        typedef typename Histogram::count_t::index index_t;
+
+        typename Histogram::bin_t shape;
+        bool grow = false;
+        for (size_t i = 0; i < Histogram::dim::value; ++i)
+        {
+            shape[i] = std::max(dcounts.shape()[i], scounts.shape()[i]);
+            grow |= (shape[i] != dcounts.shape()[i]);
+        }
+        if (grow)
+            dcounts.resize(shape);
+
+        bool same = true;
+        for (size_t i = 0; i < Histogram::dim::value; ++i)
+            same &= (dcounts.shape()[i] == scounts.shape()[i]);
+
+        if (same)
+        {
+            // both are stored contiguously with the same layout
+            auto d = dcounts.data();
+            auto s = scounts.data();
+            for (size_t i = 0; i < scounts.num_elements(); ++i)
+                d[i] += s[i];
+        }
+        else if (scounts.num_elements() > 0)
+        {
+            // the indexes of src are enumerated in storage order, with the
+            // last dimension varying fastest
+            std::array<index_t, Histogram::dim::value> idx;
+            idx.fill(0);
+            auto s = scounts.data();
+            for (size_t i = 0; i < scounts.num_elements(); ++i)
             {
-                typename Histogram::bin_t idx;
-
-                typename Histogram::bin_t shape;
-                for (size_t i = 0; i <  this->_counts.num_dimensions(); ++i)
-                    shape[i] = std::max(this->_counts.shape()[i],
-                                        _sum->get_array().shape()[i]);
-                _sum->get_array().resize(shape);
-                for (size_t i = 0; i < this->_counts.num_elements(); ++i)
+                dcounts(idx) += s[i];
+                for (int j = int(Histogram::dim::value) - 1; j >= 0; --j)
                 {
-                    size_t offset = 1;
-                    for (size_t j = 0; j < this->_counts.num_dimensions(); ++j)
-                    {
-                        size_t L = this->_counts.shape()[j];
-                        idx[j] = ((i / offset) % L);
-                        offset *= L;
-                    }
-                    _sum->get_array()(idx) += this->_counts(idx);
-                }
-                for (int i = 0; i < Histogram::dim::value; ++i)
-                {
-                    if (_sum->get_bins()[i].size() < this->_bins[i].size())
-                        _sum->get_bins()[i] = this->_bins[i];
+                    if (++idx[j] < index_t(scounts.shape()[j]))
+                        break;
+                    idx[j] = 0;
                 }
             }
-            _sum = 0;
+        }
+
+        for (size_t i = 0; i < Histogram::dim::value; ++i)
+        {
+            if (dst.get_bins()[i].size() < src.get_bins()[i].size())
+                dst.get_bins()[i] = src.get_bins()[i];
         }
     }
-private:
+
     Histogram* _sum;
 };
 
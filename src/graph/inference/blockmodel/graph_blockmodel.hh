@@ -197,6 +197,9 @@ public:
           _emat(other._emat),
           _egroups_enabled(other._egroups_enabled),
           _neighbor_sampler(other._neighbor_sampler),
+          _nhist(other._nhist),
+          _nhist_enabled(other._nhist_enabled),
+          _prune_bg(other._prune_bg),
           _m_entries(num_vertices(_bg))
     {
         if (other.is_partition_stats_enabled())
@@ -235,13 +238,17 @@ public:
     template <class MEntries>
     void get_move_entries(size_t v, size_t r, size_t nr, MEntries& m_entries)
     {
-        get_move_entries(v, r, nr, m_entries, [](auto) {return false;});
+        if (!_nhist.empty() && _rt == weight_type::NONE)
+            _nhist.move_entries(v, r, nr, num_vertices(_bg), m_entries, _g);
+        else
+            get_move_entries(v, r, nr, m_entries, [](auto) {return false;});
     }
 
 
     template <bool Add, class EFilt>
     void modify_vertex(size_t v, size_t r, EFilt&& efilt)
     {
+        mark_modified();
         if (Add)
             get_move_entries(v, null_group, r, _m_entries,
                              std::forward<EFilt>(efilt));
@@ -285,7 +292,22 @@ public:
 
         if (_rec_types.empty())
         {
-            eops([](auto&, auto&){}, [](auto&, auto&){});
+            if (!Add && prune_block_edges())
+            {
+                eops([](auto&, auto&){},
+                     [&](auto& me, auto&)
+                     {
+                         if (this->_mrs[me] == 0)
+                             this->_bg_pruned.push_back(me);
+                     });
+                for (auto& me : _bg_pruned)
+                    _emat.remove_me(me, _bg);
+                _bg_pruned.clear();
+            }
+            else
+            {
+                eops([](auto&, auto&){}, [](auto&, auto&){});
+            }
         }
         else
         {
@@ -433,6 +455,8 @@ public:
 
     void add_edge(const GraphInterface::edge_t& e)
     {
+        mark_modified();
+        _nhist.clear();
         if (_rec_types.empty())
             return;
         auto crec = _rec[0].get_checked();
@@ -487,6 +511,8 @@ public:
 
     void remove_edge(const GraphInterface::edge_t& e)
     {
+        mark_modified();
+        _nhist.clear();
         if (_rec_types.empty())
             return;
 
@@ -533,6 +559,7 @@ public:
     void update_edge(const GraphInterface::edge_t& e,
                      const std::vector<double>& delta)
     {
+        mark_modified();
         if (_rec_types.empty())
             return;
 
@@ -568,6 +595,9 @@ public:
         if (!_egroups.empty() && _egroups_enabled)
             _egroups.remove_vertex(v, _b, _g);
 
+        if (!_nhist.empty())
+            _nhist.template modify_vertex<false>(v, r, _eweight, _g);
+
         if (is_partition_stats_enabled())
             get_partition_stats(v).remove_vertex(v, r, _deg_corr, _g,
                                                  _vweight, _eweight,
@@ -589,6 +619,9 @@ public:
         if (!_egroups.empty() && _egroups_enabled)
             _egroups.add_vertex(v, _b, _eweight, _g);
 
+        if (!_nhist.empty())
+            _nhist.template modify_vertex<true>(v, r, _eweight, _g);
+
         if (is_partition_stats_enabled())
             get_partition_stats(v).add_vertex(v, r, _deg_corr, _g, _vweight,
                                               _eweight, _degs);
@@ -669,8 +702,8 @@ public:
                 }
             }
 
-            // if (_mrs[me] == 0)
-            //     _emat.remove_me(me, _bg);
+            if (_mrs[me] == 0 && prune_block_edges())
+                _emat.remove_me(me, _bg);
         }
     }
 
@@ -788,6 +821,9 @@ public:
         if (!allow_move(r, nr))
             throw ValueException("cannot move vertex across clabel barriers");
 
+        if (_move_log_enabled)
+            _move_log.emplace_back(v, r);
+
         if (_coupled_state != nullptr && _vweight[v] > 0)
         {
             if (_wr[r] == _vweight[v])
@@ -814,6 +850,40 @@ public:
         move_vertex(v, r, nr);
     }
 
+    // Partition checkpoints: after snapshot() is called, every move done via
+    // move_vertex() is logged with the previous group of the vertex, and
+    // restore() undoes the moves done after the given snapshot, in reverse
+    // order. This costs time proportional to the number of moves undone,
+    // instead of rebuilding the whole state.
+    size_t snapshot()
+    {
+        _move_log_enabled = true;
+        return _move_log.size();
+    }
+
+    void restore(size_t pos)
+    {
+        if (pos > _move_log.size())
+            throw ValueException("invalid snapshot: " +
+                                 lexical_cast<string>(pos));
+        bool enabled = _move_log_enabled;
+        _move_log_enabled = false;
+        while (_move_log.size() > pos)
+        {
+            auto& m = _move_log.back();
+            move_vertex(m.first, m.second);
+            _move_log.pop_back();
+        }
+        _move_log_enabled = enabled;
+    }
+
+    void clear_snapshots()
+    {
+        _move_log_enabled = false;
+        _move_log.clear();
+        _move_log.shrink_to_fit();
+    }
+
     void set_vertex_weight(size_t v, int w)
     {
         set_vertex_weight(v, w, _vweight);
@@ -827,6 +897,7 @@ public:
     template <class VMap>
     void set_vertex_weight(size_t v, int w, VMap&& vweight)
     {
+        mark_modified();
         vweight[v] = w;
     }
 
@@ -903,6 +974,8 @@ public:
     template <class Emap>
     void merge_vertices(size_t u, size_t v, Emap&& ec, std::true_type)
     {
+        mark_modified();
+        _nhist.clear();
         if (u == v)
             return;
 
@@ -1335,6 +1408,33 @@ public:
         return Sf - Si + dS;
     }
 
+    // Gathers the current block-pair covariate statistics and their deltas
+    // for all the entries of a move in a single pass, so that each covariate
+    // term is then evaluated over contiguous arrays.
+    template <class MEntries>
+    rec_stats_t& get_rec_stats(MEntries& m_entries)
+    {
+        auto& rs = m_entries._rec_stats;
+        rs.update_wconst(_rec_types, _wparams);
+        rs.clear(_rec_types.size());
+        entries_op(m_entries, _emat,
+                   [&](auto, auto, auto& me, auto& delta)
+                   {
+                       bool has_me = (me != _emat.get_null_edge());
+                       rs.mrs.push_back(has_me ? this->_mrs[me] : 0);
+                       rs.dm.push_back(get<0>(delta));
+                       for (size_t i = 0; i < _rec_types.size(); ++i)
+                       {
+                           rs.x[i].push_back(has_me ? this->_brec[i][me] : 0);
+                           rs.dx[i].push_back(get<1>(delta)[i]);
+                           if (_rec_types[i] != weight_type::REAL_NORMAL)
+                               continue;
+                           rs.x2[i].push_back(has_me ? this->_bdrec[i][me] : 0);
+                           rs.dx2[i].push_back(get<2>(delta)[i]);
+                       }
+                   });
+        return rs;
+    }
 
     template <class MEntries>
     double virtual_move(size_t v, size_t r, size_t nr, entropy_args_t ea,
@@ -1348,7 +1448,7 @@ public:
         if (r != null_group && nr != null_group && !allow_move(r, nr))
             return std::numeric_limits<double>::infinity();
 
-        get_move_entries(v, r, nr, m_entries, [](auto) { return false; });
+        get_move_entries(v, r, nr, m_entries);
 
         double dS = 0;
         if (ea.adjacency)
@@ -1388,36 +1488,33 @@ public:
         int dL = 0;
         if (ea.recs)
         {
+            auto& rs = get_rec_stats(m_entries);
+            auto& ers = rs.x[0];
+            auto& d = rs.dx[0];
+            size_t n_entries = ers.size();
+
             auto positive_entries_op = [&](size_t i, auto&& w_log_P,
                                            auto&& w_log_prior)
                 {
-                    int dB_E = 0;
-                    entries_op(m_entries, this->_emat,
-                               [&](auto, auto, auto& me, auto& delta)
-                               {
-                                   double ers = 0;
-                                   double xrs = 0;
-                                   if (me != _emat.get_null_edge())
-                                   {
-                                       ers = this->_brec[0][me];
-                                       xrs = this->_brec[i][me];
-                                   }
-                                   auto d = get<1>(delta)[0];
-                                   auto dx = get<1>(delta)[i];
-                                   dS -= -w_log_P(ers, xrs);
-                                   dS += -w_log_P(ers + d, xrs + dx);
+                    auto& xrs = rs.x[i];
+                    auto& dx = rs.dx[i];
+                    for (size_t j = 0; j < n_entries; ++j)
+                    {
+                        dS -= -w_log_P(ers[j], xrs[j]);
+                        dS += -w_log_P(ers[j] + d[j], xrs[j] + dx[j]);
+                    }
 
-                                   if (ea.recs_dl)
-                                   {
-                                       size_t ers = 0;
-                                       if (me != _emat.get_null_edge())
-                                           ers = this->_mrs[me];
-                                       if (ers == 0 && get<0>(delta) > 0)
-                                           dB_E++;
-                                       if (ers > 0 && ers + get<0>(delta) == 0)
-                                           dB_E--;
-                                   }
-                               });
+                    int dB_E = 0;
+                    if (ea.recs_dl)
+                    {
+                        for (size_t j = 0; j < n_entries; ++j)
+                        {
+                            if (rs.mrs[j] == 0 && rs.dm[j] > 0)
+                                dB_E++;
+                            if (rs.mrs[j] > 0 && rs.mrs[j] + rs.dm[j] == 0)
+                                dB_E--;
+                        }
+                    }
                     if (dB_E != 0 && ea.recs_dl && std::isnan(_wparams[i][0])
                         && std::isnan(_wparams[i][1]))
                     {
@@ -1438,20 +1535,23 @@ public:
                                         [&](auto N, auto x)
                                         { return positive_w_log_P(N, x, wp[0],
                                                                   wp[1],
-                                                                  this->_epsilon[i]);
+                                                                  this->_epsilon[i],
+                                                                  rs.wconst[i]);
                                         },
                                         [&](size_t B_E)
                                         { return positive_w_log_P(B_E,
                                                                   _recsum[i],
                                                                   wp[0], wp[1],
-                                                                  this->_epsilon[i]);
+                                                                  this->_epsilon[i],
+                                                                  rs.wconst[i]);
                                         });
                     break;
                 case weight_type::DISCRETE_GEOMETRIC:
                     positive_entries_op(i,
                                         [&](auto N, auto x)
                                         { return geometric_w_log_P(N, x, wp[0],
-                                                                   wp[1]);
+                                                                   wp[1],
+                                                                   rs.wconst[i]);
                                         },
                                         [&](size_t B_E)
                                         { return geometric_w_log_P(B_E,
@@ -1464,7 +1564,8 @@ public:
                     positive_entries_op(i,
                                         [&](auto N, auto x)
                                         { return poisson_w_log_P(N, x, wp[0],
-                                                                 wp[1]);
+                                                                 wp[1],
+                                                                 rs.wconst[i]);
                                         },
                                         [&](size_t B_E)
                                         { return geometric_w_log_P(B_E,
@@ -1477,7 +1578,8 @@ public:
                     positive_entries_op(i,
                                         [&](auto N, auto x)
                                         { return binomial_w_log_P(N, x, wp[0],
-                                                                  wp[1], wp[2]);
+                                                                  wp[1], wp[2],
+                                                                  rs.wconst[i]);
                                         },
                                         [&](size_t B_E)
                                         { return geometric_w_log_P(B_E,
@@ -1492,59 +1594,49 @@ public:
                         int dB_E_D = 0;
                         double dBx2 = 0;
                         _dBdx[i] = 0;
-                        entries_op(m_entries, _emat,
-                                   [&](auto, auto, auto& me, auto& delta)
-                                   {
-                                       double ers = 0;
-                                       double xrs = 0, x2rs = 0;
-                                       if (me != _emat.get_null_edge())
-                                       {
-                                           ers = this->_brec[0][me];
-                                           xrs = this->_brec[i][me];
-                                           x2rs = this->_bdrec[i][me];
-                                       }
-                                       auto d = get<1>(delta)[0];
-                                       auto dx = get<1>(delta)[i];
-                                       auto dx2 = get<2>(delta)[i];
-                                       dS -= -signed_w_log_P(ers, xrs, x2rs,
-                                                             wp[0], wp[1],
-                                                             wp[2], wp[3],
-                                                             this->_epsilon[i]);
-                                       dS += -signed_w_log_P(ers + d,
-                                                             xrs + dx,
-                                                             x2rs + dx2,
-                                                             wp[0], wp[1],
-                                                             wp[2], wp[3],
-                                                             this->_epsilon[i]);
-                                       if (std::isnan(wp[0]) &&
-                                           std::isnan(wp[1]))
-                                       {
-                                           auto n_ers = ers + get<1>(delta)[0];
-                                           if (ers == 0 && n_ers > 0)
-                                               dB_E++;
-                                           if (ers > 0 && n_ers == 0)
-                                               dB_E--;
-                                           if (n_ers > 1)
-                                           {
-                                               if (ers < 2)
-                                                   dB_E_D++;
-                                               _dBdx[i] += \
-                                                   (x2rs + dx2 -
-                                                    std::pow(xrs + dx, 2) / n_ers);
-
-                                           }
-                                           if (ers > 1)
-                                           {
-                                               if (n_ers < 2)
-                                                   dB_E_D--;
-                                               _dBdx[i] -= \
-                                                   (x2rs -
-                                                    std::pow(xrs, 2) / ers);
-                                           }
-                                           dBx2 += (std::pow(xrs + dx, 2) -
-                                                    std::pow(xrs, 2));
-                                       }
-                                   });
+                        auto& xrs = rs.x[i];
+                        auto& dx = rs.dx[i];
+                        auto& x2rs = rs.x2[i];
+                        auto& dx2 = rs.dx2[i];
+                        auto c = rs.wconst[i];
+                        for (size_t j = 0; j < n_entries; ++j)
+                        {
+                            dS -= -signed_w_log_P(ers[j], xrs[j], x2rs[j],
+                                                  wp[0], wp[1], wp[2], wp[3],
+                                                  this->_epsilon[i], c);
+                            dS += -signed_w_log_P(ers[j] + d[j],
+                                                  xrs[j] + dx[j],
+                                                  x2rs[j] + dx2[j],
+                                                  wp[0], wp[1], wp[2], wp[3],
+                                                  this->_epsilon[i], c);
+                        }
+                        if (std::isnan(wp[0]) && std::isnan(wp[1]))
+                        {
+                            for (size_t j = 0; j < n_entries; ++j)
+                            {
+                                auto n_ers = ers[j] + d[j];
+                                auto nx = xrs[j] + dx[j];
+                                if (ers[j] == 0 && n_ers > 0)
+                                    dB_E++;
+                                if (ers[j] > 0 && n_ers == 0)
+                                    dB_E--;
+                                if (n_ers > 1)
+                                {
+                                    if (ers[j] < 2)
+                                        dB_E_D++;
+                                    _dBdx[i] += (x2rs[j] + dx2[j] -
+                                                 (nx * nx) / n_ers);
+                                }
+                                if (ers[j] > 1)
+                                {
+                                    if (n_ers < 2)
+                                        dB_E_D--;
+                                    _dBdx[i] -= (x2rs[j] -
+                                                 (xrs[j] * xrs[j]) / ers[j]);
+                                }
+                                dBx2 += nx * nx - xrs[j] * xrs[j];
+                            }
+                        }
 
                         if (std::isnan(wp[0]) && std::isnan(wp[1]))
                         {
@@ -1684,6 +1776,119 @@ public:
         return virtual_move(v, r, nr, ea, _m_entries);
     }
 
+    // Moves of several vertices at once: the vertices in vs, which must be
+    // sorted and all belong to block r, are moved together to block nr. The
+    // entropy difference is computed without modifying the state, so that
+    // moves can be evaluated concurrently, each with its own m_entries. The
+    // dense adjacency term and edge covariates are not supported, which is
+    // indicated by can_virtual_move_set().
+
+    bool can_virtual_move_set(const entropy_args_t& ea)
+    {
+        return !(ea.adjacency && ea.dense) && (!ea.recs || _rec_types.empty());
+    }
+
+    template <class MEntries>
+    void get_move_set_entries(const std::vector<size_t>& vs, size_t r,
+                              size_t nr, MEntries& m_entries)
+    {
+        move_set_entries(vs, r, nr, _b, _g, _eweight, num_vertices(_bg),
+                         m_entries);
+    }
+
+    template <class MEntries>
+    double virtual_move_set(const std::vector<size_t>& vs, size_t r,
+                            size_t nr, entropy_args_t ea, MEntries& m_entries)
+    {
+        if (r == nr)
+            return 0;
+
+        if (!allow_move(r, nr))
+            return std::numeric_limits<double>::infinity();
+
+        get_move_set_entries(vs, r, nr, m_entries);
+
+        int dw = 0, kout = 0, kin = 0;
+        for (auto v : vs)
+        {
+            assert(size_t(_b[v]) == r);
+            dw += _vweight[v];
+            kout += out_degreeS()(v, _g, _eweight);
+            if (is_directed::apply<g_t>::type::value)
+                kin += in_degreeS()(v, _g, _eweight);
+        }
+        if (!is_directed::apply<g_t>::type::value)
+            kin = kout;
+
+        double dS = 0;
+        if (ea.adjacency)
+        {
+            if (ea.exact)
+                dS = entries_dS<true>(m_entries, _mrs, _emat, _bg);
+            else
+                dS = entries_dS<false>(m_entries, _mrs, _emat, _bg);
+
+            auto vt = [&](auto mrp, auto mrm, auto nr)
+                {
+                    assert(mrp >= 0 && mrm >=0 && nr >= 0);
+                    if (ea.exact)
+                        return vterm_exact(mrp, mrm, nr, _deg_corr, _bg);
+                    else
+                        return vterm(mrp, mrm, nr, _deg_corr, _bg);
+                };
+
+            dS += vt(_mrp[r]  - kout, _mrm[r]  - kin, _wr[r]  - dw);
+            dS -= vt(_mrp[r]        , _mrm[r]       , _wr[r]       );
+            dS += vt(_mrp[nr] + kout, _mrm[nr] + kin, _wr[nr] + dw);
+            dS -= vt(_mrp[nr]       , _mrm[nr]      , _wr[nr]      );
+        }
+
+        if (ea.partition_dl || ea.degree_dl || ea.edges_dl)
+        {
+            enable_partition_stats();
+            auto& ps = get_partition_stats(vs.front());
+            if (ea.partition_dl)
+                dS += ps.get_delta_partition_dl(r, nr, dw);
+            if (_deg_corr && ea.degree_dl)
+                dS += ps.get_delta_deg_dl(vs, r, nr, _vweight, _eweight,
+                                          _degs, _g, ea.degree_dl_kind);
+            if (ea.edges_dl)
+            {
+                size_t actual_B = 0;
+                for (auto& ps : _partition_stats)
+                    actual_B += ps.get_actual_B();
+                dS += ps.get_delta_edges_dl(r, nr, dw, actual_B, _g);
+            }
+        }
+
+        if (_coupled_state != nullptr && dw > 0)
+        {
+            bool r_vacate = (_wr[r] == dw);
+            bool nr_occupy = (_wr[nr] == 0);
+            if (r_vacate != nr_occupy)
+            {
+                scoped_lock lck(_lock);
+                if (r_vacate)
+                {
+                    dS += _coupled_state->virtual_move(r,
+                                                       _bclabel[r],
+                                                       null_group,
+                                                       _coupled_entropy_args);
+                }
+
+                if (nr_occupy)
+                {
+                    dS += _coupled_state->virtual_move(nr,
+                                                       null_group,
+                                                       _bclabel[r],
+                                                       _coupled_entropy_args);
+                }
+            }
+        }
+
+        return dS;
+    }
+
     double recs_dS(size_t u, size_t v,
                    const std::vector<std::tuple<size_t, size_t,
                                                 GraphInterface::edge_t, int,
@@ -1897,8 +2102,7 @@ public:
 
         if (!std::isinf(c) && !_neighbor_sampler.empty(v))
         {
-            auto u = _neighbor_sampler.sample(v, rng);
-            size_t t = _b[u];
+            size_t t = sample_neighbor_block(v, rng);
             double p_rand = 0;
             if (c > 0)
             {
@@ -1931,13 +2135,28 @@ public:
         return sample_block<rng_t>(v, c, d, rng);
     }
 
-    size_t random_neighbor(size_t v, rng_t& rng)
+    // Sample the block of a random neighbor of v
+    template <class RNG>
+    size_t sample_neighbor_block(size_t v, RNG& rng)
+    {
+        if (!_nhist.empty())
+            return _nhist.sample_block(v, rng);
+        return _b[_neighbor_sampler.sample(v, rng)];
+    }
+
+    template <class RNG>
+    size_t random_neighbor(size_t v, RNG& rng)
     {
         if (_neighbor_sampler.empty(v))
             return v;
         return _neighbor_sampler.sample(v, rng);
     }
 
+    size_t random_neighbor(size_t v, rng_t& rng)
+    {
+        return random_neighbor<rng_t>(v, rng);
+    }
+
     // Computes the move proposal probability
     template <class MEntries>
     double get_move_prob(size_t v, size_t r, size_t s, double c, double d,
@@ -1975,12 +2194,8 @@ public:
             kin = in_degreeS()(v, _g, _eweight);
         m_entries.get_mes(_emat);
 
-        auto sum_prob = [&](auto& e, auto u)
+        auto sum_prob = [&](size_t t, size_t ew)
             {
-                size_t t = _b[u];
-                if (u == v)
-                    t = r;
-                size_t ew = _eweight[e];
                 w += ew;
 
                 int mts = 0;
@@ -2036,18 +2251,28 @@ public:
             };
 
         // self-loops are always ignored when sampling neighbors
-        for (auto e : out_edges_range(v, _g))
+        if (!_nhist.empty())
         {
-            if (target(e, _g) == v)
-                continue;
-            sum_prob(e, target(e, _g));
+            for (auto& x : _nhist.get_hist(v))
+                sum_prob(x.r, x.kout + x.kin);
         }
-
-        for (auto e : in_edges_range(v, _g))
+        else
         {
-            if (source(e, _g) == v)
-                continue;
-            sum_prob(e, source(e, _g));
+            for (auto e : out_edges_range(v, _g))
+            {
+                auto u = target(e, _g);
+                if (u == v)
+                    continue;
+                sum_prob(_b[u], _eweight[e]);
+            }
+
+            for (auto e : in_edges_range(v, _g))
+            {
+                auto u = source(e, _g);
+                if (u == v)
+                    continue;
+                sum_prob(_b[u], _eweight[e]);
+            }
         }
 
         if (w > 0)
@@ -2056,6 +2281,139 @@ public:
             return (1. - d) / B;
     }
 
+    // Average proposal probability of the moves of each vertex in vs from r
+    // to nr, or, if reverse == true, of the moves back from nr to r after all
+    // of them have been moved. The state is not modified; m_entries must
+    // contain the entries given by get_move_set_entries().
+    template <class MEntries>
+    double get_move_set_prob(const std::vector<size_t>& vs, size_t r,
+                             size_t nr, double c, double d, bool reverse,
+                             MEntries& m_entries)
+    {
+        double p = 0;
+        if (!reverse)
+        {
+            for (auto v : vs)
+                p += get_move_prob(v, r, nr, c, d, false, m_entries);
+            return p / vs.size();
+        }
+
+        int dw = 0, kout = 0, kin = 0;
+        for (auto v : vs)
+        {
+            dw += _vweight[v];
+            kout += out_degreeS()(v, _g, _eweight);
+            if (is_directed::apply<g_t>::type::value)
+                kin += in_degreeS()(v, _g, _eweight);
+        }
+        if (!is_directed::apply<g_t>::type::value)
+            kin = kout;
+
+        // number of occupied blocks after the move
+        size_t B = _candidate_blocks.size() - 1;
+        if (dw > 0)
+        {
+            if (_wr[r] == dw)
+                B--;
+            if (_wr[nr] == 0)
+                B++;
+        }
+
+        if (_wr[r] == dw)
+            return d;
+
+        if (B == num_vertices(_g))
+            d = 0;
+
+        if (std::isinf(c))
+            return (1. - d) / B;
+
+        m_entries.get_mes(_emat);
+
+        auto get_m = [&](size_t t, size_t s)
+            {
+                int m = 0;
+                const auto& me = m_entries.get_me(t, s, _emat);
+                if (me != _emat.get_null_edge())
+                    m = _mrs[me];
+                return m + get<0>(m_entries.get_delta(t, s));
+            };
+
+        auto get_mp = [&](size_t t)
+            {
+                int m = _mrp[t];
+                if (t == r)
+                    m -= kout;
+                if (t == nr)
+                    m += kout;
+                return m;
+            };
+
+        auto get_mm = [&](size_t t)
+            {
+                int m = _mrm[t];
+                if (t == r)
+                    m -= kin;
+                if (t == nr)
+                    m += kin;
+                return m;
+            };
+
+        for (auto v : vs)
+        {
+            double pv = 0;
+            size_t w = 0;
+
+            auto sum_prob = [&](size_t t, size_t ew)
+                {
+                    w += ew;
+                    int mts = get_m(t, r);
+                    if (is_directed::apply<g_t>::type::value)
+                    {
+                        int mst = get_m(r, t);
+                        pv += ew * ((mts + mst + c) /
+                                    (get_mp(t) + get_mm(t) + c * B));
+                    }
+                    else
+                    {
+                        if (t == r)
+                            mts *= 2;
+                        pv += ew * (mts + c) / (get_mp(t) + c * B);
+                    }
+                };
+
+            // the neighbors in vs have been moved to nr as well
+            auto get_t = [&](size_t u) -> size_t
+                {
+                    if (std::binary_search(vs.begin(), vs.end(), u))
+                        return nr;
+                    return _b[u];
+                };
+
+            for (auto e : out_edges_range(v, _g))
+            {
+                auto u = target(e, _g);
+                if (u == v)
+                    continue;
+                sum_prob(get_t(u), _eweight[e]);
+            }
+
+            for (auto e : in_edges_range(v, _g))
+            {
+                auto u = source(e, _g);
+                if (u == v)
+                    continue;
+                sum_prob(get_t(u), _eweight[e]);
+            }
+
+            if (w > 0)
+                p += (1. - d) * pv / w;
+            else
+                p += (1. - d) / B;
+        }
+        return p / vs.size();
+    }
+
     double get_move_prob(size_t v, size_t r, size_t s, double c, double d,
                          bool reverse)
     {
@@ -2068,6 +2426,18 @@ public:
         return _wr[_b[v]] == _vweight[v];
     }
 
+    // Whether moving v to nr empties its block or occupies an empty one, which
+    // changes the description length of every other move. All moves are
+    // considered global if the state is part of a hierarchy.
+    bool is_global_move(size_t v, size_t nr)
+    {
+        size_t r = _b[v];
+        if (r == nr || _vweight[v] == 0)
+            return false;
+        return (_coupled_state != nullptr || _wr[r] == _vweight[v] ||
+                _wr[nr] == 0);
+    }
+
     size_t node_weight(size_t v)
     {
         return _vweight[v];
@@ -2305,6 +2675,22 @@ public:
         return S;
     }
 
+    // Number of modifications of the state so far; this is used to validate
+    // the cached entropy values on the Python side. Since the coupled state
+    // depends on this one, it is marked as modified as well.
+    size_t get_mod_count()
+    {
+        return _mod_count;
+    }
+
+    void mark_modified()
+    {
+        #pragma omp atomic
+        _mod_count++;
+        if (_coupled_state != nullptr)
+            _coupled_state->mark_modified();
+    }
+
     void enable_partition_stats()
     {
         if (_partition_stats.empty())
@@ -2391,6 +2777,46 @@ public:
     void rebuild_neighbor_sampler()
     {
         _neighbor_sampler = neighbor_sampler_t(_g, _eweight);
+        if (_nhist_enabled)
+            _nhist.init(_b, _eweight, _g);
+    }
+
+    // Keep per-vertex histograms of the neighbors' blocks, which are used to
+    // obtain move proposals and their entries, instead of the edges.
+    void set_neighbor_hist(bool enabled)
+    {
+        _nhist_enabled = enabled;
+        if (enabled)
+            _nhist.init(_b, _eweight, _g);
+        else
+            _nhist.clear();
+    }
+
+    bool get_neighbor_hist()
+    {
+        return _nhist_enabled;
+    }
+
+    // Remove the edges of the block graph whose count drops to zero, so that
+    // the block graph and its edge property maps only hold the occupied block
+    // pairs, and the edge indices are recycled. The block graph should keep
+    // the edge positions (i.e. have fast edge removal enabled), so that each
+    // removal takes O(1) time. This is not done if the block graph is the
+    // graph of a coupled state, or if there are edge covariates.
+    void set_prune_block_edges(bool prune)
+    {
+        _prune_bg = prune;
+    }
+
+    bool get_prune_block_edges()
+    {
+        return _prune_bg;
+    }
+
+    bool prune_block_edges()
+    {
+        return (_prune_bg && _coupled_state == nullptr &&
+                _rec_types.empty());
     }
 
     void sync_emat()
@@ -2536,6 +2962,10 @@ public:
         neighbor_sampler_t;
 
     neighbor_sampler_t _neighbor_sampler;
+    NeighborBlockHist<g_t> _nhist;
+    bool _nhist_enabled = false;
+    bool _prune_bg = false;
+    std::vector<typename graph_traits<bg_t>::edge_descriptor> _bg_pruned;
     std::vector<partition_stats_t> _partition_stats;
     std::vector<size_t> _bmap;
 
@@ -2546,6 +2976,11 @@ public:
     BlockStateVirtualBase* _coupled_state = nullptr;
     entropy_args_t _coupled_entropy_args;
 
+    std::vector<std::pair<size_t, size_t>> _move_log;
+    bool _move_log_enabled = false;
+
+    size_t _mod_count = 0;
+
     openmp_mutex _lock;
 };
 
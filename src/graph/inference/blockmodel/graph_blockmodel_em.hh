@@ -99,36 +99,66 @@ public:
             return _em_t[e];
     }
 
+    // M-step: the group sizes and the block-pair sums are accumulated in a
+    // single parallel pass over the vertices and edges, respectively, with
+    // thread-local accumulators.
     double learn_iter()
     {
         double delta = 0;
+        size_t N = num_vertices(_g);
+
+        vector<double> wr(_B);
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+        {
+            vector<double> wr_t(_B);
+            parallel_vertex_loop_no_spawn
+                (_g,
+                 [&](auto v)
+                 {
+                     auto& m = _vm[v];
+                     for (size_t r = 0; r < _B; ++r)
+                         wr_t[r] += m[r];
+                 });
+            #pragma omp critical (em_learn_iter)
+            for (size_t r = 0; r < _B; ++r)
+                wr[r] += wr_t[r];
+        }
 
         for (size_t r = 0; r < _B; ++r)
         {
-            double& wr_r = _wr[r];
-            double old_wr = wr_r;
-            wr_r = 0;
-            for (auto v : vertices_range(_g))
-                wr_r += _vm[v][r];
-            wr_r /= num_vertices(_g);
-            delta += abs(old_wr - wr_r);
+            double x = wr[r] / N;
+            delta += abs(_wr[r] - x);
+            _wr[r] = x;
         }
 
-        for (auto e : edges_range(_g))
+        // ers[r * B + s] is the sum of m_uv[r] * m_vu[s] / Z_e over all edges
+        vector<double> ers(_B * _B);
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
         {
-            auto u = source(e, _g);
-            auto v = target(e, _g);
-            double& Z_e = _Z[e];
-            Z_e = 0;
-            for (size_t r = 0; r < _B; ++r)
-            {
-                for (size_t s = r + 1; s < _B; ++s)
-                {
-                    Z_e += _prs[r][s] * ((get_m(u, v, e)[r] * get_m(v, u, e)[s]) +
-                                         (get_m(u, v, e)[s] * get_m(v, u, e)[r]));
-                }
-                Z_e += _prs[r][r] * (get_m(u, v, e)[r] * get_m(v, u, e)[r]);
-            }
+            vector<double> ers_t(_B * _B);
+            parallel_edge_loop_no_spawn
+                (_g,
+                 [&](const auto& e)
+                 {
+                     auto u = source(e, _g);
+                     auto v = target(e, _g);
+                     auto& m_u = get_m(u, v, e);
+                     auto& m_v = get_m(v, u, e);
+                     double Z_e = get_Z(m_u, m_v);
+                     _Z[e] = Z_e;
+                     if (Z_e == 0)
+                         return;
+                     for (size_t r = 0; r < _B; ++r)
+                     {
+                         double x = m_u[r] / Z_e;
+                         double* row = &ers_t[r * _B];
+                         for (size_t s = 0; s < _B; ++s)
+                             row[s] += x * m_v[s];
+                     }
+                 });
+            #pragma omp critical (em_learn_iter)
+            for (size_t i = 0; i < ers.size(); ++i)
+                ers[i] += ers_t[i];
         }
 
         for (size_t r = 0; r < _B; ++r)
@@ -137,18 +167,9 @@ public:
             {
                 double& x = _prs[r][s];
                 double p = x;
-                x = 0;
-                for (auto e : edges_range(_g))
-                {
-                    if (_Z[e] == 0)
-                        continue;
-                    auto u = source(e, _g);
-                    auto v = target(e, _g);
-                    x += p * (((get_m(u, v, e)[r] * get_m(v, u, e)[s]) +
-                               (get_m(u, v, e)[s] * get_m(v, u, e)[r]))) / _Z[e];
-                }
+                x = p * (ers[r * _B + s] + ers[s * _B + r]);
                 if (x > 0)
-                    x /= (_wr[r] * _wr[s] * num_vertices(_g));
+                    x /= (_wr[r] * _wr[s] * N);
                 _prs[s][r] = x;
                 delta += abs(x - p);
             }
@@ -156,6 +177,81 @@ public:
         return delta;
     }
 
+    // edge partition function, using only the upper triangle of prs
+    template <class Vec>
+    double get_Z(const Vec& m_u, const Vec& m_v)
+    {
+        double Z = 0;
+        for (size_t r = 0; r < _B; ++r)
+        {
+            auto&& row = _prs[r];
+            double t_u = 0, t_v = 0;
+            for (size_t s = r + 1; s < _B; ++s)
+            {
+                t_u += row[s] * m_v[s];
+                t_v += row[s] * m_u[s];
+            }
+            Z += m_u[r] * t_u + m_v[r] * t_v + row[r] * m_u[r] * m_v[r];
+        }
+        return Z;
+    }
+
+    // T[r] = sum_s prs[s][r] * m[s]
+    template <class Vec>
+    void get_T(const Vec& m, vector<double>& T)
+    {
+        std::fill(T.begin(), T.end(), 0.);
+        for (size_t s = 0; s < _B; ++s)
+        {
+            auto&& row = _prs[s];
+            double m_s = m[s];
+            for (size_t r = 0; r < _B; ++r)
+                T[r] += row[r] * m_s;
+        }
+    }
+
+    // external field h[r] = sum_v sum_s vm[v][s] * prs[s][r] / N
+    void get_h(vector<double>& h)
+    {
+        size_t N = num_vertices(_g);
+        vector<double> ns(_B);
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+        {
+            vector<double> ns_t(_B);
+            parallel_vertex_loop_no_spawn
+                (_g,
+                 [&](auto v)
+                 {
+                     auto& m = _vm[v];
+                     for (size_t s = 0; s < _B; ++s)
+                         ns_t[s] += m[s];
+                 });
+            #pragma omp critical (em_get_h)
+            for (size_t s = 0; s < _B; ++s)
+                ns[s] += ns_t[s];
+        }
+        for (auto& x : ns)
+            x /= _N;
+        h.resize(_B);
+        get_T(ns, h);
+    }
+
+    // Sums of log(T) over the neighbors of u (i.e. the incoming messages),
+    // excluding (L_ex) or including only (L_v) the neighbor v.
+    void get_log_field(size_t u, size_t v, vector<double>& L_ex,
+                       vector<double>& L_v, vector<double>& T)
+    {
+        std::fill(L_ex.begin(), L_ex.end(), 0.);
+        std::fill(L_v.begin(), L_v.end(), 0.);
+        for (auto eo : out_edges_range(u, _g))
+        {
+            auto k = target(eo, _g);
+            get_T(get_m(k, u, eo), T);
+            auto& L = (k == v) ? L_v : L_ex;
+            for (size_t r = 0; r < _B; ++r)
+                L[r] += log(T[r]);
+        }
+    }
 
     template <class Vec>
     void normalize(Vec& vec)
@@ -168,6 +264,34 @@ public:
                       [&](auto& x){ x /= S; });
     };
 
+    // Replaces the log-weights in vec by the normalized probabilities, via
+    // log-sum-exp.
+    template <class Vec>
+    void normalize_log(Vec& vec)
+    {
+        double max_x = -numeric_limits<double>::infinity();
+        for (size_t r = 0; r < _B; ++r)
+            max_x = std::max(max_x, double(vec[r]));
+        if (std::isinf(max_x))
+        {
+            // overflowing or vanishing weights
+            for (size_t r = 0; r < _B; ++r)
+                vec[r] = (max_x < 0 || vec[r] == max_x) ? 1. : 0.;
+        }
+        else
+        {
+            for (size_t r = 0; r < _B; ++r)
+                vec[r] = exp(vec[r] - max_x);
+        }
+        double S = 0;
+        for (size_t r = 0; r < _B; ++r)
+            S += vec[r];
+        for (size_t r = 0; r < _B; ++r)
+            vec[r] /= S;
+    };
+
+    // E-step: asynchronous belief propagation, with the messages updated in
+    // random order.
     double bp_iter(size_t max_iter, double epsilon,
                    bool verbose, rng_t& rng)
     {
@@ -179,21 +303,20 @@ public:
             messages.emplace_back(e, false);
         }
 
-        vector<double> h(_B), h_temp(_B);
-        for (auto v : vertices_range(_g))
-        {
-            for (size_t r = 0; r < _B; ++r)
-                for (size_t s = 0; s < _B; ++s)
-                    h[r] += _vm[v][s] * _prs[s][r] / _N;
-        }
+        vector<double> h;
+        get_h(h);
+
+        vector<double> log_wr(_B);
+        for (size_t r = 0; r < _B; ++r)
+            log_wr[r] = log(_wr[r]);
 
         size_t niter = 0;
         double delta = epsilon + 1;
+        vector<double> temp(_B), L_ex(_B), L_v(_B), T(_B), dm(_B), dh(_B);
         while (delta > epsilon)
         {
             delta = 0;
             std::shuffle(messages.begin(), messages.end(), rng);
-            vector<double> temp(_B);
             for (auto& ei : messages)
             {
                 auto& e = ei.first;
@@ -201,25 +324,12 @@ public:
                 auto v = target(e, _g);
                 if (ei.second)
                     std::swap(u, v);
-                for (size_t r = 0; r < _B; ++r)
-                {
-                    double phi_r = 0;
-                    for (auto eo : out_edges_range(u, _g))
-                    {
-                        auto k = target(eo, _g);
-                        if (k == v)
-                            continue;
-                        double T = 0;
-                        const auto& m = get_m(k, u, eo);
-                        for (size_t s = 0; s < _B; ++s)
-                            T += _prs[s][r] * m[s];
-                        phi_r += log(T);
-                    }
-                    phi_r = exp(phi_r - h[r]) * _wr[r];
-                    temp[r] = phi_r;
-                }
 
-                normalize(temp);
+                get_log_field(u, v, L_ex, L_v, T);
+
+                for (size_t r = 0; r < _B; ++r)
+                    temp[r] = L_ex[r] - h[r] + log_wr[r];
+                normalize_log(temp);
 
                 auto& phi = get_m(u, v, e);
                 for (size_t r = 0; r < _B; ++r)
@@ -231,36 +341,16 @@ public:
                 auto& vm_u = _vm[u];
                 for (size_t r = 0; r < _B; ++r)
                 {
-                    h_temp[r] = h[r];
-                    for (size_t s = 0; s < _B; ++s)
-                        h_temp[r] -= vm_u[s] * _prs[s][r] / _N;
+                    dm[r] = -vm_u[r];
+                    vm_u[r] = L_ex[r] + L_v[r] - h[r] + log_wr[r];
                 }
+                normalize_log(vm_u);
 
                 for (size_t r = 0; r < _B; ++r)
-                {
-                    double& vm_u_r = vm_u[r];
-                    vm_u_r = 0;
-                    for (auto eo : out_edges_range(u, _g))
-                    {
-                        auto k = target(eo, _g);
-                        double T = 0;
-                        auto& m = get_m(k, u, eo);
-                        for (size_t s = 0; s < _B; ++s)
-                            T += _prs[s][r] * m[s];
-                        vm_u_r += log(T);
-                    }
-                    vm_u_r = exp(vm_u_r - h[r]) * _wr[r];
-                }
-
-                normalize(vm_u);
-
+                    dm[r] = (dm[r] + vm_u[r]) / _N;
+                get_T(dm, dh);
                 for (size_t r = 0; r < _B; ++r)
-                {
-                    for (size_t s = 0; s < _B; ++s)
-                        h_temp[r] += (vm_u[s] * _prs[s][r]) / _N;
-                    h[r] = h_temp[r];
-                }
-
+                    h[r] += dh[r];
             }
             niter++;
             if (verbose)
@@ -273,51 +363,37 @@ public:
 
     double bethe_fe()
     {
-        double F = 0;
-        vector<double> h(_B);
-        for (auto v : vertices_range(_g))
-        {
-            for (size_t r = 0; r < _B; ++r)
-                for (size_t s = 0; s < _B; ++s)
-                    h[r] += _vm[v][s] * _prs[s][r] / _N;
-        }
+        vector<double> h;
+        get_h(h);
 
-        for (auto u : vertices_range(_g))
-        {
-            double Z_v = 0;
-            for (size_t r = 0; r < _B; ++r)
-            {
-                double vm_u_r = 0;
-                for (auto eo : out_edges_range(u, _g))
-                {
-                    auto k = target(eo, _g);
-                    double T = 0;
-                    auto& m = get_m(k, u, eo);
-                    for (size_t s = 0; s < _B; ++s)
-                        T += _prs[s][r] * m[s];
-                    vm_u_r += log(T);
-                }
-                vm_u_r = exp(vm_u_r - h[r]) * _wr[r];
-                Z_v += vm_u_r;
-            }
-            F -= log(Z_v) / _N;
-        }
+        vector<double> log_wr(_B);
+        for (size_t r = 0; r < _B; ++r)
+            log_wr[r] = log(_wr[r]);
 
-        for (auto e : edges_range(_g))
+        double F = 0;
+        #pragma omp parallel if (num_vertices(_g) > OPENMP_MIN_THRESH) \
+            reduction(+:F)
         {
-            auto u = source(e, _g);
-            auto v = target(e, _g);
-            double Z_e = 0;
-            for (size_t r = 0; r < _B; ++r)
-            {
-                for (size_t s = r + 1; s < _B; ++s)
-                {
-                    Z_e += _prs[r][s] * ((get_m(u, v, e)[r] * get_m(v, u, e)[s]) +
-                                         (get_m(u, v, e)[s] * get_m(v, u, e)[r]));
-                }
-                Z_e += _prs[r][r] * (get_m(u, v, e)[r] * get_m(v, u, e)[r]);
-            }
-            F += log(Z_e) / _N;
+            vector<double> L_ex(_B), L_v(_B), T(_B);
+            parallel_vertex_loop_no_spawn
+                (_g,
+                 [&](auto u)
+                 {
+                     get_log_field(u, _null, L_ex, L_v, T);
+                     double Z_v = 0;
+                     for (size_t r = 0; r < _B; ++r)
+                         Z_v += exp(L_ex[r] - h[r] + log_wr[r]);
+                     F -= log(Z_v) / _N;
+                 });
+
+            parallel_edge_loop_no_spawn
+                (_g,
+                 [&](const auto& e)
+                 {
+                     auto u = source(e, _g);
+                     auto v = target(e, _g);
+                     F += log(get_Z(get_m(u, v, e), get_m(v, u, e))) / _N;
+                 });
         }
 
         double c = 0;
@@ -329,6 +405,7 @@ public:
         return F;
     }
 
+    static constexpr size_t _null = numeric_limits<size_t>::max();
 
     template <class VMap>
     void get_MAP(VMap&& vmap)
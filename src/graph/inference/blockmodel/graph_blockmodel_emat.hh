@@ -19,6 +19,7 @@
 #define GRAPH_BLOCKMODEL_EMAT_HH
 
 #include <boost/multi_array.hpp>
+#include <limits>
 #include "hash_map_wrap.hh"
 
 namespace graph_tool
@@ -88,70 +89,50 @@ template <class BGraph>
 const typename EMat<BGraph>::edge_t EMat<BGraph>::_null_edge;
 
 
-template <class Key>
-class perfect_hash_t
-{
-public:
-    template <class RNG>
-    perfect_hash_t(size_t N, std::vector<size_t>& index, RNG& rng)
-        : _index(&index)
-    {
-        index.reserve(N);
-        for (size_t i = 0; i < N; ++i)
-            index.push_back(i);
-        std::shuffle(index.begin(), index.end(), rng);
-    }
-    perfect_hash_t(std::vector<size_t>& index)
-        : _index(&index) {}
-    perfect_hash_t() {}
-    size_t operator()(const Key& k) const { return (*_index)[k]; }
-    void resize(size_t N)
-    {
-        auto& index = *_index;
-        for (size_t i = index.size(); i < N; ++i)
-            index.push_back(i);
-    }
-private:
-    std::vector<size_t>* _index;
-};
-
-// this structure speeds up the access to the edges between given blocks, since
-// we're using an adjacency list to store the block structure (this is like
-// EMat above, but takes less space and is slower)
+// this structure speeds up the access to the edges between given blocks when B
+// is large, and the adjacency matrix of EMat above would take too much space.
+// The block edges are kept in a vector indexed by their edge indices, and are
+// found via their 32-bit indices, which are stored either in a dense B x B
+// matrix, if the block graph is dense enough, or otherwise in a single
+// open-addressing hash table with linear probing, keyed by the packed pair
+// (r, s). The layout is chosen again whenever the structure is synchronized
+// with the block graph, i.e. when blocks are added.
 
 template <class BGraph>
 class EHash
 {
 public:
-
     template <class RNG>
-    EHash(BGraph& bg, RNG& rng)
-        : _hash_function(num_vertices(bg), _index, rng),
-          _hash(num_vertices(bg), ehash_t(0, _hash_function))
+    EHash(BGraph& bg, RNG&)
     {
         sync(bg);
     }
 
-    EHash(const EHash& other)
-        : _index(other._index),
-          _hash_function(_index),
-          _hash(other._hash.size(), ehash_t(0, _hash_function))
-    {
-        for (size_t r = 0; r < other._hash.size(); ++r)
-        {
-            auto& h = _hash[r];
-            for (const auto& x : other._hash[r])
-                h[x.first] = x.second;
-        }
-    }
+    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
 
     void sync(BGraph& bg)
     {
-        _hash_function.resize(num_vertices(bg));
-        _hash.clear();
-        _hash.resize(num_vertices(bg), ehash_t(0, _hash_function));
-        for (auto& h : _hash)
-            h.max_load_factor(.3);
+        size_t B = num_vertices(bg);
+        size_t E = num_edges(bg);
+        _B = B;
+        _edges.clear();
+        _dense = (B * B <= _dense_ratio * (E + B));
+        if (_dense)
+        {
+            _mat.clear();
+            _mat.resize(B * B, _null);
+            std::vector<uint64_t>().swap(_keys);
+            std::vector<uint32_t>().swap(_vals);
+        }
+        else
+        {
+            std::vector<uint32_t>().swap(_mat);
+            size_t n = 16;
+            while (n < 2 * E)
+                n *= 2;
+            rehash(n);
+        }
 
         for (auto e : edges_range(bg))
         {
@@ -160,27 +141,31 @@ public:
         }
     }
 
-    typedef typename graph_traits<BGraph>::vertex_descriptor vertex_t;
-    typedef typename graph_traits<BGraph>::edge_descriptor edge_t;
-
     __attribute__((flatten)) __attribute__((hot))
-    const auto& get_me(vertex_t r, vertex_t s) const
+    const edge_t& get_me(vertex_t r, vertex_t s) const
     {
         if (!is_directed::apply<BGraph>::type::value && r > s)
             std::swap(r, s);
-        auto& map = _hash[r];
-        const auto& iter = map.find(s);
-        if (iter == map.end())
+        uint32_t i = _dense ? _mat[r * _B + s] : find(get_key(r, s));
+        if (i == _null)
             return _null_edge;
-        return iter->second;
+        return _edges[i];
     }
 
     void put_me(vertex_t r, vertex_t s, const edge_t& e)
     {
         if (!is_directed::apply<BGraph>::type::value && r > s)
             std::swap(r, s);
-        assert(r < _hash.size());
-        _hash[r][s] = e;
+        assert(r < _B && s < _B);
+        size_t i = _eindex[e];
+        assert(i < _null);
+        if (i >= _edges.size())
+            _edges.resize(i + 1);
+        _edges[i] = e;
+        if (_dense)
+            _mat[r * _B + s] = i;
+        else
+            insert(get_key(r, s), i);
     }
 
     void remove_me(const edge_t& me, BGraph& bg)
@@ -189,23 +174,128 @@ public:
         auto s = target(me, bg);
         if (!is_directed::apply<BGraph>::type::value && r > s)
             std::swap(r, s);
-        assert(r < _hash.size());
-        _hash[r].erase(s);
+        assert(r < _B && s < _B);
+        if (_dense)
+            _mat[r * _B + s] = _null;
+        else
+            erase(get_key(r, s));
         remove_edge(me, bg);
     }
 
     const auto& get_null_edge() const { return _null_edge; }
 
 private:
-    std::vector<size_t> _index;
-    perfect_hash_t<vertex_t> _hash_function;
-    typedef gt_hash_map<vertex_t, edge_t, perfect_hash_t<vertex_t>> ehash_t;
-    std::vector<ehash_t> _hash;
+    static uint64_t get_key(vertex_t r, vertex_t s)
+    {
+        return (uint64_t(r) << 32) | uint64_t(s);
+    }
+
+    size_t get_pos(uint64_t k) const
+    {
+        // Fibonacci hashing, using the highest bits
+        return (k * UINT64_C(0x9E3779B97F4A7C15)) >> _shift;
+    }
+
+    uint32_t find(uint64_t k) const
+    {
+        size_t mask = _keys.size() - 1;
+        for (size_t pos = get_pos(k); ; pos = (pos + 1) & mask)
+        {
+            auto x = _keys[pos];
+            if (x == k)
+                return _vals[pos];
+            if (x == _empty_key)
+                return _null;
+        }
+    }
+
+    void insert(uint64_t k, uint32_t i)
+    {
+        if (2 * (_n + 1) > _keys.size())
+            rehash(2 * _keys.size());
+        size_t mask = _keys.size() - 1;
+        size_t pos = get_pos(k);
+        while (_keys[pos] != k && _keys[pos] != _empty_key)
+            pos = (pos + 1) & mask;
+        if (_keys[pos] == _empty_key)
+        {
+            _keys[pos] = k;
+            _n++;
+        }
+        _vals[pos] = i;
+    }
+
+    // deletion by backward shifting, so that no tombstones are needed
+    void erase(uint64_t k)
+    {
+        size_t mask = _keys.size() - 1;
+        size_t pos = get_pos(k);
+        while (_keys[pos] != k)
+        {
+            if (_keys[pos] == _empty_key)
+                return;
+            pos = (pos + 1) & mask;
+        }
+        size_t hole = pos;
+        for (size_t j = (pos + 1) & mask; _keys[j] != _empty_key;
+             j = (j + 1) & mask)
+        {
+            // the entry can fill the hole if it lies between its home
+            // position and j
+            size_t h = get_pos(_keys[j]);
+            if (((j - h) & mask) >= ((j - hole) & mask))
+            {
+                _keys[hole] = _keys[j];
+                _vals[hole] = _vals[j];
+                hole = j;
+            }
+        }
+        _keys[hole] = _empty_key;
+        _n--;
+    }
+
+    void rehash(size_t n)
+    {
+        std::vector<uint64_t> keys(n, _empty_key);
+        std::vector<uint32_t> vals(n, _null);
+        _keys.swap(keys);
+        _vals.swap(vals);
+        _shift = 64;
+        for (size_t m = n; m > 1; m /= 2)
+            _shift--;
+        _n = 0;
+        for (size_t pos = 0; pos < keys.size(); ++pos)
+        {
+            if (keys[pos] != _empty_key)
+                insert(keys[pos], vals[pos]);
+        }
+    }
+
+    // the dense layout is used if it takes no more space than the hash table,
+    // which has 12 bytes per slot and load factors between 1/4 and 1/2
+    static constexpr size_t _dense_ratio = 8;
+    static constexpr uint32_t _null = std::numeric_limits<uint32_t>::max();
+    static constexpr uint64_t _empty_key =
+        std::numeric_limits<uint64_t>::max();
+
+    typename property_map<BGraph, edge_index_t>::type _eindex;
+    std::vector<edge_t> _edges;
+    size_t _B = 0;
+    bool _dense = true;
+    std::vector<uint32_t> _mat;
+    std::vector<uint64_t> _keys;
+    std::vector<uint32_t> _vals;
+    size_t _n = 0;
+    size_t _shift = 64;
     static const edge_t _null_edge;
 };
 
 template <class BGraph>
 const typename EHash<BGraph>::edge_t EHash<BGraph>::_null_edge;
+template <class BGraph>
+constexpr uint32_t EHash<BGraph>::_null;
+template <class BGraph>
+constexpr uint64_t EHash<BGraph>::_empty_key;
 
 template <class Vertex, class Eprop, class Emat, class BEdge>
 inline auto get_beprop(Vertex r, Vertex s, const Eprop& eprop, const Emat& emat,
@@ -116,8 +116,23 @@ constexpr decltype(auto) tuple_apply(F&& f, Tuple&& t)
          std::make_index_sequence<std::tuple_size<std::decay_t<Tuple>>{}>{});
 }
 
+// sets a value back to zero, keeping the capacity of vectors
+template <class T>
+void reset_value(T& x)
+{
+    x = T();
+}
+
+template <class T>
+void reset_value(std::vector<T>& x)
+{
+    x.clear();
+}
+
 // Manage a set of block pairs and corresponding edge counts that will be
-// updated
+// updated. The deltas are kept allocated across moves, and are only reset when
+// reused, so that their vectors do not need to be allocated again for every
+// move; hence get_delta() may return more elements than get_entries().
 
 template <class Graph, class BGraph, class... EVals>
 class EntrySet
@@ -173,7 +188,14 @@ public:
         {
             f = _entries.size();
             _entries.emplace_back(s, t);
-            _delta.emplace_back();
+            if (f < _delta.size())
+                tuple_apply([](auto&... vals)
+                            {
+                                auto expand = [](auto&&...) {};
+                                expand((reset_value(vals), 0)...);
+                            }, _delta[f]);
+            else
+                _delta.emplace_back();
         }
 
         if (Add)
@@ -202,7 +224,6 @@ public:
             f = _null;
         }
         _entries.clear();
-        _delta.clear();
         _mes.clear();
         _recs_entries.clear();
     }
@@ -238,6 +259,8 @@ public:
                            GraphInterface::edge_t, int, std::vector<double>>>
         _recs_entries;
 
+    rec_stats_t _rec_stats;
+
 private:
     static constexpr size_t _null = numeric_limits<size_t>::max();
     static const std::tuple<EVals...> _null_delta;
@@ -352,6 +375,62 @@ void move_entries(Vertex v, size_t r, size_t nr, VProp& _b, Graph& g,
                              std::forward<IL>(is_loop), eprops...);
 }
 
+// obtain the entries in the e_rs matrix which need to be modified after all
+// the vertices in vs (which must be sorted) are moved from r to nr. The edges
+// between the moved vertices are treated in the same way as self-loops.
+template <class Graph, class VProp, class Eprop, class MEntries>
+void move_set_entries(const std::vector<size_t>& vs, size_t r, size_t nr,
+                      VProp& _b, Graph& g, Eprop& eweights, size_t B,
+                      MEntries& m_entries)
+{
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+
+    m_entries.set_move(r, nr, B);
+
+    auto in_vs = [&](vertex_t u)
+        {
+            return std::binary_search(vs.begin(), vs.end(), u);
+        };
+
+    auto modify = [&](auto Add, size_t t)
+        {
+            constexpr bool add = decltype(Add)::value;
+            int self_weight = 0;
+            for (auto v : vs)
+            {
+                for (auto e : out_edges_range(v, g))
+                {
+                    vertex_t u = target(e, g);
+                    size_t s = _b[u];
+                    int ew = eweights[e];
+                    bool internal = (u == v || in_vs(u));
+                    if (add && internal)
+                        s = t;
+                    m_entries.template insert_delta<add>(t, s, ew);
+                    if (internal && !graph_tool::is_directed(g))
+                        self_weight += ew;
+                }
+
+                if (graph_tool::is_directed(g))
+                {
+                    for (auto e : in_edges_range(v, g))
+                    {
+                        vertex_t u = source(e, g);
+                        if (u == v || in_vs(u))
+                            continue;
+                        m_entries.template insert_delta<add>(_b[u], t,
+                                                             eweights[e]);
+                    }
+                }
+            }
+
+            if (self_weight > 0 && self_weight % 2 == 0)
+                m_entries.template insert_delta<!add>(t, t, self_weight / 2);
+        };
+
+    modify(std::false_type(), r);
+    modify(std::true_type(), nr);
+}
 
 // operation on a set of entries
 template <class MEntries, class EMat, class OP>
@@ -370,24 +449,44 @@ void entries_op(MEntries& m_entries, EMat& emat, OP&& op)
     }
 }
 
-// obtain the entropy difference given a set of entries in the e_rs matrix
+// obtain the entropy difference given a set of entries in the e_rs matrix; the
+// edge counts are gathered in chunks into a buffer on the stack, so that their
+// lookups do not wait for the evaluation of the terms, and vice versa
 template <bool exact, class MEntries, class Eprop, class EMat, class BGraph>
 double entries_dS(MEntries& m_entries, Eprop& mrs, EMat& emat, BGraph& bg)
 {
+    const auto& entries = m_entries.get_entries();
+    const auto& delta = m_entries.get_delta();
+    auto& mes = m_entries.get_mes(emat);
+    const auto& null_edge = emat.get_null_edge();
+
+    constexpr size_t chunk = 64;
+    size_t ers[chunk];
+
     double dS = 0;
-    entries_op(m_entries, emat,
-               [&](auto r, auto s, auto& me, auto& delta)
-               {
-                   size_t ers = 0;
-                   if (me != emat.get_null_edge())
-                       ers = mrs[me];
-                   int d = get<0>(delta);
-                   assert(int(ers) + d >= 0);
-                   if (exact)
-                       dS += eterm_exact(r, s, ers + d, bg) - eterm_exact(r, s, ers, bg);
-                   else
-                       dS += eterm(r, s, ers + d, bg) - eterm(r, s, ers, bg);
-               });
+    for (size_t pos = 0; pos < entries.size(); pos += chunk)
+    {
+        size_t n = std::min(chunk, entries.size() - pos);
+        for (size_t j = 0; j < n; ++j)
+        {
+            const auto& me = mes[pos + j];
+            ers[j] = (me != null_edge) ? size_t(mrs[me]) : 0;
+        }
+
+        for (size_t j = 0; j < n; ++j)
+        {
+            auto& entry = entries[pos + j];
+            auto r = entry.first;
+            auto s = entry.second;
+            int d = get<0>(delta[pos + j]);
+            assert(int(ers[j]) + d >= 0);
+            if (exact)
+                dS += (eterm_exact(r, s, ers[j] + d, bg) -
+                       eterm_exact(r, s, ers[j], bg));
+            else
+                dS += eterm(r, s, ers[j] + d, bg) - eterm(r, s, ers[j], bg);
+        }
+    }
     return dS;
 }
 
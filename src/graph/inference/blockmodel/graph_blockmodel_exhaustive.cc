@@ -96,14 +96,15 @@ python::object do_exhaustive_sweep_iter(python::object oexhaustive_state,
 #endif // HAVE_BOOST_COROUTINE
 }
 
-void do_exhaustive_dens(python::object oexhaustive_state,
-                        python::object oblock_state,
-                        double S_min, double S_max,
-                        python::object ohist)
+double do_exhaustive_dens(python::object oexhaustive_state,
+                         python::object oblock_state,
+                         double S_min, double S_max,
+                         python::object ohist)
 {
     multi_array_ref<uint64_t, 1> hist = get_array<uint64_t, 1>(ohist);
     int N = hist.shape()[0];
     double dS = S_max - S_min;
+    double S_min_ = numeric_limits<double>::infinity();
     auto dispatch = [&](auto& block_state)
     {
         typedef typename std::remove_reference<decltype(block_state)>::type
@@ -113,6 +114,7 @@ void do_exhaustive_dens(python::object oexhaustive_state,
            (oexhaustive_state,
             [&](auto& s)
             {
+                GILRelease gil;
                 exhaustive_sweep(s,
                                  [&](auto& state)
                                  {
@@ -121,9 +123,11 @@ void do_exhaustive_dens(python::object oexhaustive_state,
                                      if (i >= 0 && i < N)
                                          hist[i]++;
                                  });
+                S_min_ = s._S_min;
             });
     };
     block_state::dispatch(oblock_state, dispatch);
+    return S_min_;
 }
 
 
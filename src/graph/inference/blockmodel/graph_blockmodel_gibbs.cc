@@ -48,7 +48,11 @@ python::object do_gibbs_sweep(python::object ogibbs_state,
            (ogibbs_state,
             [&](auto& s)
             {
-                auto ret_ = gibbs_sweep(s, rng);
+                decltype(gibbs_sweep(s, rng)) ret_;
+                {
+                    GILRelease gil;
+                    ret_ = gibbs_sweep(s, rng);
+                }
                 ret = python::make_tuple(get<0>(ret_), get<1>(ret_),
                                          get<2>(ret_));
             });
@@ -78,6 +78,7 @@ void export_sbm_state()
                  .def("entropy", &state_t::entropy)
                  .def("get_partition_dl", &state_t::get_partition_dl)
                  .def("get_deg_dl", &state_t::get_deg_dl)
+                 .def("get_mod_count", &state_t::get_mod_count)
                  .def("get_move_prob", get_move_prob)
                  .def("enable_partition_stats",
                       &state_t::enable_partition_stats)
@@ -97,7 +98,18 @@ void export_sbm_state()
                       &state_t::clear_egroups)
                  .def("rebuild_neighbor_sampler",
                       &state_t::rebuild_neighbor_sampler)
+                 .def("set_neighbor_hist",
+                      &state_t::set_neighbor_hist)
+                 .def("get_neighbor_hist",
+                      &state_t::get_neighbor_hist)
+                 .def("set_prune_block_edges",
+                      &state_t::set_prune_block_edges)
+                 .def("get_prune_block_edges",
+                      &state_t::get_prune_block_edges)
                  .def("sync_emat",
-                      &state_t::sync_emat);
+                      &state_t::sync_emat)
+                 .def("snapshot", &state_t::snapshot)
+                 .def("restore", &state_t::restore)
+                 .def("clear_snapshots", &state_t::clear_snapshots);
          });
 }
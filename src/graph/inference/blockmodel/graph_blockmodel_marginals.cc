@@ -52,10 +52,33 @@ void collect_vertex_marginals(GraphInterface& gi, boost::any ob,
          vertex_scalar_vector_properties())(op);
 }
 
+// Histogram of the block pairs of an edge. Each edge typically sees only a
+// handful of distinct pairs, so these are kept in a small vector with linear
+// search, which is much more compact than a hash table per edge.
 class BlockPairHist
-    : public gt_hash_map<std::pair<int32_t,int32_t>,size_t>
 {
 public:
+    typedef std::pair<int32_t, int32_t> key_t;
+    typedef std::pair<key_t, size_t> value_type;
+    typedef std::vector<value_type>::iterator iterator;
+
+    iterator begin() { return _h.begin(); }
+    iterator end() { return _h.end(); }
+
+    iterator find(const key_t& k)
+    {
+        return std::find_if(_h.begin(), _h.end(),
+                            [&](auto& kv) { return kv.first == k; });
+    }
+
+    size_t& operator[](const key_t& k)
+    {
+        auto iter = find(k);
+        if (iter != _h.end())
+            return iter->second;
+        _h.emplace_back(k, 0);
+        return _h.back().second;
+    }
 
     boost::python::dict get_state()
     {
@@ -99,6 +122,8 @@ public:
         (*this)[make_pair(r, s)] = v;
     }
 
+private:
+    std::vector<value_type> _h;
 };
 
 void collect_edge_marginals(GraphInterface& gi, boost::any ob,
@@ -321,7 +346,7 @@ void collect_hierarchical_partitions(python::object ovb, PartitionHist& h,
         v.reserve(v.size() + vi.size());
         if (unlabel)
         {
-            auto vc = unlabel_partition(v);
+            auto vc = unlabel_partition(vi);
             v.insert(v.end(), vc.begin(), vc.end());
         }
         else
@@ -333,6 +358,136 @@ void collect_hierarchical_partitions(python::object ovb, PartitionHist& h,
     h[v] += update;
 }
 
+// Histogram of partitions keyed only by a 64-bit hash of their labels, which
+// avoids storing a copy of every distinct partition. Each entry keeps the
+// accumulated count and the value of log_n_permutations() of the partition.
+class PartitionHashHist
+    : public gt_hash_map<uint64_t, std::pair<double, double>>
+{
+public:
+
+    boost::python::dict get_state()
+    {
+        boost::python::dict state;
+        for (auto& kv : *this)
+            state[kv.first] = python::make_tuple(kv.second.first,
+                                                 kv.second.second);
+        return state;
+    }
+
+    void set_state(boost::python::dict state)
+    {
+        auto keys = state.keys();
+        for (int i = 0; i < python::len(keys); ++i)
+        {
+            uint64_t k = python::extract<uint64_t>(keys[i]);
+            python::object v = state[keys[i]];
+            (*this)[k] = make_pair(double(python::extract<double>(v[0])),
+                                   double(python::extract<double>(v[1])));
+        }
+    }
+
+    boost::python::dict get_counts()
+    {
+        boost::python::dict counts;
+        for (auto& kv : *this)
+            counts[kv.first] = kv.second.first;
+        return counts;
+    }
+
+    double get_item(uint64_t k)
+    {
+        auto iter = this->find(k);
+        if (iter == this->end())
+            return 0;
+        return iter->second.first;
+    }
+};
+
+inline uint64_t hash_mix(uint64_t h, uint64_t x)
+{
+    uint64_t z = h + (x + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Hashes the partition b into h (optionally after unlabeling it, as done by
+// unlabel_partition()) and adds its log_n_permutations() to lnp, without
+// copying it.
+class partition_hasher
+{
+public:
+    template <class Vec>
+    void operator()(const Vec& b, bool unlabel, uint64_t& h, double& lnp)
+    {
+        size_t N = b.size();
+        size_t B = 0;
+        for (auto bi : b)
+            B = std::max(B, size_t(bi) + 1);
+        _map.clear();
+        _map.resize(B, -1);
+        _count.clear();
+        _count.resize(B, 0);
+        size_t pos = 0;
+        for (auto bi : b)
+        {
+            auto& x = _map[bi];
+            if (x == -1)
+                x = pos++;
+            h = hash_mix(h, unlabel ? x : bi);
+            _count[x]++;
+        }
+        lnp += boost::math::lgamma(N + 1);
+        for (size_t r = 0; r < pos; ++r)
+            lnp -= boost::math::lgamma(_count[r] + 1);
+    }
+
+    // the top bit is cleared, so that the hash never clashes with the empty
+    // and deleted keys of the hash table
+    static uint64_t finish(uint64_t h)
+    {
+        return h & ~(uint64_t(1) << 63);
+    }
+
+private:
+    std::vector<int32_t> _map;
+    std::vector<size_t> _count;
+};
+
+void collect_partitions_hash(boost::any& ob, PartitionHashHist& h,
+                             double update, bool unlabel)
+{
+    typedef vprop_map_t<int32_t>::type vmap_t;
+    auto& b = any_cast<vmap_t&>(ob);
+    uint64_t k = 0;
+    double lnp = 0;
+    partition_hasher()(b.get_storage(), unlabel, k, lnp);
+    auto& x = h[partition_hasher::finish(k)];
+    x.first += update;
+    x.second = lnp;
+}
+
+void collect_hierarchical_partitions_hash(python::object ovb,
+                                          PartitionHashHist& h, size_t update,
+                                          bool unlabel)
+{
+    typedef vprop_map_t<int32_t>::type vmap_t;
+    partition_hasher hasher;
+    uint64_t k = 0;
+    double lnp = 0;
+    for (int i = 0; i < len(ovb); ++i)
+    {
+        boost::any& ob = python::extract<boost::any&>(ovb[i])();
+        auto& b = any_cast<vmap_t&>(ob);
+        hasher(b.get_storage(), unlabel, k, lnp);
+        k = hash_mix(k, uint64_t(-1));
+    }
+    auto& x = h[partition_hasher::finish(k)];
+    x.first += update;
+    x.second = lnp;
+}
+
 double partitions_entropy(PartitionHist& h, bool unlabeled)
 {
     double S = 0;
@@ -354,6 +509,28 @@ double partitions_entropy(PartitionHist& h, bool unlabeled)
     return S;
 }
 
+double partitions_entropy_hash(PartitionHashHist& h, bool unlabeled)
+{
+    double S = 0;
+    double N = 0;
+    for (auto& kv : h)
+    {
+        double n = kv.second.first;
+        if (n == 0)
+            continue;
+        N += n;
+        S -= n * log(n);
+        if (unlabeled)
+            S += n * kv.second.second;
+    }
+    if (N > 0)
+    {
+        S /= N;
+        S += log(N);
+    }
+    return S;
+}
+
 void export_marginals()
 {
     using namespace boost::python;
@@ -380,11 +557,27 @@ void export_marginals()
         .def("asdict", &PartitionHist::get_state,
              "Return the histogram's contents as a dict.").enable_pickling();
 
+    class_<PartitionHashHist>("PartitionHashHist",
+                              "Histogram of partitions keyed by 64-bit hashes, "
+                              "implemented in C++.\n"
+                              "Interface supports querying using the hashes "
+                              "as keys, and floats as values.")
+        .def("__getitem__", &PartitionHashHist::get_item)
+        .def("__len__", &PartitionHashHist::size)
+        .def("__setstate__", &PartitionHashHist::set_state)
+        .def("__getstate__", &PartitionHashHist::get_state)
+        .def("asdict", &PartitionHashHist::get_counts,
+             "Return the histogram's contents as a dict.").enable_pickling();
+
     def("vertex_marginals", &collect_vertex_marginals);
     def("edge_marginals", &collect_edge_marginals);
     def("mf_entropy", &mf_entropy);
     def("bethe_entropy", &bethe_entropy);
     def("collect_partitions", &collect_partitions);
+    def("collect_partitions", &collect_partitions_hash);
     def("collect_hierarchical_partitions", &collect_hierarchical_partitions);
+    def("collect_hierarchical_partitions",
+        &collect_hierarchical_partitions_hash);
     def("partitions_entropy", &partitions_entropy);
+    def("partitions_entropy", &partitions_entropy_hash);
 }
@@ -48,16 +48,17 @@ python::object do_mcmc_sweep(python::object omcmc_state,
            (omcmc_state,
             [&](auto& s)
             {
-                if (s._parallel)
+                std::pair<double, size_t> ret_;
                 {
-                    auto ret_ = mcmc_sweep_parallel(s, rng);
-                    ret = python::make_tuple(ret_.first, ret_.second);
-                }
-                else
-                {
-                    auto ret_ = mcmc_sweep(s, rng);
-                    ret = python::make_tuple(ret_.first, ret_.second);
+                    GILRelease gil;
+                    if (s._parallel)
+                        ret_ = mcmc_sweep_parallel(s, rng);
+                    else if (s._schedule != sweep_schedule::UNIFORM)
+                        ret_ = mcmc_sweep_weighted(s, rng);
+                    else
+                        ret_ = mcmc_sweep(s, rng);
                 }
+                ret = python::make_tuple(ret_.first, ret_.second);
             });
     };
     block_state::dispatch(oblock_state, dispatch);
@@ -45,6 +45,9 @@ using namespace std;
     ((parallel,, bool, 0))                                                     \
     ((sequential,, bool, 0))                                                   \
     ((deterministic,, bool, 0))                                                \
+    ((schedule,, int, 0))                                                      \
+    ((activity, &, std::vector<double>&, 0))                                   \
+    ((min_weight,, double, 0))                                                 \
     ((verbose,, bool, 0))                                                      \
     ((niter,, size_t, 0))
 
@@ -111,6 +114,41 @@ struct MCMC
             return s;
         }
 
+        // Called before each batch of mcmc_sweep_parallel(), so that the
+        // proposals do not need to modify the state: an empty block is made
+        // available beforehand.
+        void init_parallel_batch()
+        {
+            if (_d > 0 && _state._empty_blocks.empty() &&
+                _state._candidate_blocks.size() - 1 < num_vertices(_g))
+                _state.add_block();
+        }
+
+        // Whether a proposal made before other moves were committed is still
+        // allowed.
+        bool check_proposal(size_t v, size_t)
+        {
+            return _allow_vacate || !_state.is_last(v);
+        }
+
+        // The blocks whose counts are read or modified by the move of v to nr,
+        // i.e. its current and new blocks, and those of its neighbors. Moves
+        // with disjoint blocks do not change each other's entropy differences,
+        // unless one of them is global (see BlockState::is_global_move()).
+        template <class F>
+        void for_each_move_block(size_t v, size_t nr, F&& f)
+        {
+            f(_state._b[v]);
+            f(nr);
+            for (auto u : all_neighbors_range(v, _g))
+                f(_state._b[u]);
+        }
+
+        bool is_global_move(size_t v, size_t nr)
+        {
+            return _state.is_global_move(v, nr);
+        }
+
         std::tuple<double, double>
         virtual_move_dS(size_t v, size_t nr)
         {
@@ -48,7 +48,11 @@ python::object do_merge_sweep(python::object omerge_state,
            (omerge_state,
             [&](auto& s)
             {
-                auto ret_ = merge_sweep(s, rng);
+                decltype(merge_sweep(s, rng)) ret_;
+                {
+                    GILRelease gil;
+                    ret_ = merge_sweep(s, rng);
+                }
                 ret = python::make_tuple(ret_.first, ret_.second);
             });
     };
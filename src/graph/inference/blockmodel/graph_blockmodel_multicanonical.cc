@@ -63,7 +63,11 @@ python::object do_multicanonical_sweep(python::object omulticanonical_state,
                      (omulticanonical_state,
                       [&](auto& mc_state)
                       {
-                          auto ret_ = mcmc_sweep(mc_state, rng);
+                          std::pair<double, size_t> ret_;
+                          {
+                              GILRelease gil;
+                              ret_ = mcmc_sweep(mc_state, rng);
+                          }
                           ret = python::make_tuple(ret_.first, ret_.second);
                       });
              });
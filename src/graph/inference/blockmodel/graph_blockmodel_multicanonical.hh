@@ -39,6 +39,8 @@ using namespace std;
     ((dens, &, std::vector<double>&, 0))                                       \
     ((S_min, , double, 0))                                                     \
     ((S_max, , double, 0))                                                     \
+    ((w_min, , double, 0))                                                     \
+    ((w_max, , double, 0))                                                     \
     ((f, , double, 0))                                                         \
     ((S, , double, 0))                                                         \
     ((E,, size_t, 0))                                                          \
@@ -99,18 +101,40 @@ struct Multicanonical
             return _state.move_proposal(v, rng);
         }
 
+        // Several walkers may share the same histogram and density (parallel
+        // Wang-Landau), each restricted to its own energy window [w_min,
+        // w_max). A walker outside its window only accepts moves that do not
+        // take it further away from it, and does not update the density.
+        double window_dist(double S)
+        {
+            if (S < _w_min)
+                return _w_min - S;
+            if (S >= _w_max)
+                return S - _w_max;
+            return 0;
+        }
+
+        double get_dens(int i)
+        {
+            double d;
+            #pragma omp atomic read
+            d = _dens[i];
+            return d;
+        }
+
         auto virtual_move_dS(size_t v, size_t nr)
         {
             auto dS = _state.virtual_move_dS(v, nr);
             double nS = _S + get<0>(dS);
-            if (nS < _S_min || nS >= _S_max)
+            if (nS < _S_min || nS >= _S_max ||
+                window_dist(nS) > window_dist(_S))
             {
                 get<0>(dS) = numeric_limits<double>::infinity();
             }
             else
             {
                 int j = get_bin(nS);
-                get<1>(dS) += _dens[_i] - _dens[j];
+                get<1>(dS) += get_dens(_i) - get_dens(j);
             }
             _dS = get<0>(dS);
             return dS;
@@ -150,7 +174,11 @@ struct Multicanonical
 
         void step(size_t, size_t)
         {
+            if (window_dist(_S) > 0)
+                return;
+            #pragma omp atomic
             _hist[_i]++;
+            #pragma omp atomic
             _dens[_i] += _f;
         }
     };
@@ -48,7 +48,14 @@ python::object do_multiflip_mcmc_sweep(python::object omcmc_state,
            (omcmc_state,
             [&](auto& s)
             {
-                auto ret_ = mcmc_sweep(s, rng);
+                decltype(mcmc_sweep(s, rng)) ret_;
+                {
+                    GILRelease gil;
+                    if (s._parallel)
+                        ret_ = mcmc_sweep_parallel_groups(s, rng);
+                    else
+                        ret_ = mcmc_sweep(s, rng);
+                }
                 ret = python::make_tuple(ret_.first, ret_.second);
             });
     };
@@ -45,9 +45,20 @@ using namespace std;
     ((mproposals, & ,std::vector<size_t>&, 0))                                 \
     ((maccept, & ,std::vector<size_t>&, 0))                                    \
     ((allow_vacate,, bool, 0))                                                 \
+    ((parallel,, bool, 0))                                                     \
     ((verbose,, bool, 0))                                                      \
     ((niter,, size_t, 0))
 
+// Only the plain BlockState implements virtual_move_set(); the layered and
+// overlapping states always evaluate multiple moves by performing them.
+template <class... Ts>
+class BlockState;
+
+template <class State>
+struct has_virtual_move_set: std::false_type {};
+
+template <class... Ts>
+struct has_virtual_move_set<BlockState<Ts...>>: std::true_type {};
 
 template <class State>
 struct MCMC
@@ -75,6 +86,7 @@ struct MCMC
             _rpos(get(vertex_index_t(), _state._bg),
                   num_vertices(_state._bg)),
             _mprobs(num_vertices(_state._g) + 1),
+            _m_entries(num_vertices(_state._bg)),
             _sequential(false),
             _deterministic(false)
         {
@@ -103,12 +115,28 @@ struct MCMC
         typename vprop_map_t<size_t>::type::unchecked_t _rpos;
 
         std::vector<size_t> _vlist;
-        std::vector<size_t> _vs;
         std::vector<double> _mprobs;
 
+        // A multiple move: the vertices of a group that are moved together,
+        // in sorted order.
+        struct move_t
+        {
+            std::vector<size_t> vs;
+        };
+
+        move_t _move;
+
+        typedef typename state_t::m_entries_t m_entries_t;
+        m_entries_t _m_entries;
+
         bool _sequential;
         bool _deterministic;
 
+        m_entries_t make_m_entries()
+        {
+            return m_entries_t(num_vertices(_state._bg));
+        }
+
         size_t node_state(size_t r)
         {
             return r;
@@ -121,7 +149,17 @@ struct MCMC
 
         size_t node_weight(size_t)
         {
-            return _vs.size();
+            return _move.vs.size();
+        }
+
+        size_t node_weight(size_t, const move_t& move)
+        {
+            return move.vs.size();
+        }
+
+        size_t group_size(size_t r)
+        {
+            return (r < _groups.size()) ? _groups[r].size() : 0;
         }
 
         template <class RNG>
@@ -150,95 +188,252 @@ struct MCMC
 
             assert(m <= _groups[r].size());
 
-            _vs.clear();
+            auto& vs = _move.vs;
+            vs.clear();
 
-            while (_vs.size() < m)
+            while (vs.size() < m)
             {
                 size_t v = uniform_sample(_groups[r], rng);
-                _vs.push_back(v);
+                vs.push_back(v);
                 remove_element(_groups[r], _vpos, v);
             }
 
-            for (auto v : _vs)
+            for (auto v : vs)
                 add_element(_groups[r], _vpos, v);
 
-            size_t v = uniform_sample(_vs, rng);
-            size_t s = _state.sample_block(v, _c, _d, rng);
+            return sample_target(r, vs, rng);
+        }
+
+        // Same as above, but without modifying the sampler, so that it can be
+        // called concurrently; the vertices are chosen by a partial shuffle of
+        // a copy of the group.
+        template <class RNG>
+        size_t move_proposal(size_t r, RNG& rng, move_t& move)
+        {
+            size_t m = sample_m(_groups[r].size(), rng);
+
+            if (!_allow_vacate && _groups[r].size() == m)
+                return null_group;
 
-            if (s >= _groups.size())
+            auto& vs = move.vs;
+            vs = _groups[r];
+            for (size_t i = 0; i < m; ++i)
             {
-                _groups.resize(s + 1);
-                _rpos.resize(s + 1);
+                std::uniform_int_distribution<size_t> sample(i, vs.size() - 1);
+                std::swap(vs[i], vs[sample(rng)]);
             }
+            vs.resize(m);
+
+            return sample_target(r, vs, rng);
+        }
+
+        template <class RNG>
+        size_t sample_target(size_t r, std::vector<size_t>& vs, RNG& rng)
+        {
+            size_t v = uniform_sample(vs, rng);
+            size_t s = _state.sample_block(v, _c, _d, rng);
+
+            std::sort(vs.begin(), vs.end());
 
             if (!_state.allow_move(r, s) || s == r)
                 return null_group;
 
-            if (_groups[s].empty())
-                _state._bclabel[s] = _state._bclabel[r];
-
-            if (!_groups[s].empty() || _groups[r].size() > m)
-                _mproposals[m]++;
+            if (group_size(s) > 0 || _groups[r].size() > vs.size())
+            {
+                #pragma omp atomic
+                _mproposals[vs.size()]++;
+            }
             return s;
         }
 
         std::tuple<double, double>
         virtual_move_dS(size_t r, size_t nr)
+        {
+            return virtual_move_dS(r, nr, _move, _m_entries);
+        }
+
+        std::tuple<double, double>
+        virtual_move_dS(size_t r, size_t nr, move_t& move,
+                        m_entries_t& m_entries)
         {
             double dS = 0, a = 0;
-            size_t m = _vs.size();
+            auto& vs = move.vs;
+            size_t m = vs.size();
 
             a -= log_pm(m, _groups[r].size());
-            a += log_pm(m, _groups[nr].size() + m);
+            a += log_pm(m, group_size(nr) + m);
             a -= -lbinom(_groups[r].size(), m);
-            a += -lbinom(_groups[nr].size() + m, m);
+            a += -lbinom(group_size(nr) + m, m);
 
             size_t B = _vlist.size();
             a -= -log(B);
             if (_groups[r].size() == m)
                 B--;
-            if (_groups[nr].empty())
+            if (group_size(nr) == 0)
                 B++;
             a += -log(B);
 
             if (m == 1)
             {
-                auto v = _vs.front();
-                dS = _state.virtual_move(v, r, nr, _entropy_args);
-                double pf = _state.get_move_prob(v, r, nr, _c, _d, false);
-                double pb = _state.get_move_prob(v, nr, r, _c, _d, true);
+                auto v = vs.front();
+                dS = _state.virtual_move(v, r, nr, _entropy_args, m_entries);
+                double pf = _state.get_move_prob(v, r, nr, _c, _d, false,
+                                                 m_entries);
+                double pb = _state.get_move_prob(v, nr, r, _c, _d, true,
+                                                 m_entries);
                 a += log(pb) - log(pf);
             }
+            else if (can_virtual_move_set())
+            {
+                dS = virtual_move_set_dS(r, nr, vs, a, m_entries,
+                                         has_virtual_move_set<state_t>());
+            }
             else
             {
                 _state._egroups_enabled = false;
                 double pf = 0, pb = 0;
-                for (auto v : _vs)
+                for (auto v : vs)
                     pf += _state.get_move_prob(v, r, nr, _c, _d, false);
                 pf /= m;
-                for (auto v : _vs)
+                for (auto v : vs)
                 {
                     dS += _state.virtual_move(v, r, nr, _entropy_args);
                     _state.move_vertex(v, nr);
                 }
-                for (auto v : _vs)
+                for (auto v : vs)
                     pb += _state.get_move_prob(v, nr, r, _c, _d, false);
                 pb /= m;
                 a += log(pb) - log(pf);
-                for (auto v : _vs)
+                for (auto v : vs)
                     _state.move_vertex(v, r);
                 _state._egroups_enabled = true;
             }
             return std::make_tuple(dS, a);
         }
 
+        bool can_virtual_move_set()
+        {
+            return can_virtual_move_set(has_virtual_move_set<state_t>());
+        }
+
+        bool can_virtual_move_set(std::true_type)
+        {
+            return _state.can_virtual_move_set(_entropy_args);
+        }
+
+        bool can_virtual_move_set(std::false_type)
+        {
+            return false;
+        }
+
+        double virtual_move_set_dS(size_t r, size_t nr, std::vector<size_t>& vs,
+                                   double& a, m_entries_t& m_entries,
+                                   std::true_type)
+        {
+            double dS = _state.virtual_move_set(vs, r, nr, _entropy_args,
+                                                m_entries);
+            double pf = _state.get_move_set_prob(vs, r, nr, _c, _d, false,
+                                                 m_entries);
+            double pb = _state.get_move_set_prob(vs, r, nr, _c, _d, true,
+                                                 m_entries);
+            a += log(pb) - log(pf);
+            return dS;
+        }
+
+        double virtual_move_set_dS(size_t, size_t, std::vector<size_t>&,
+                                   double&, m_entries_t&, std::false_type)
+        {
+            return numeric_limits<double>::quiet_NaN();
+        }
+
+        // Whether the move can be evaluated concurrently with others, i.e.
+        // without performing it.
+        bool is_parallel_safe(const move_t& move)
+        {
+            return move.vs.size() == 1 || can_virtual_move_set();
+        }
+
+        // Called before each batch of a parallel sweep, so that the proposals
+        // do not need to modify the state: the edge sampler is initialized, an
+        // empty block is made available beforehand, and the group lists cover
+        // all blocks.
+        void init_parallel_batch()
+        {
+            if (!std::isinf(_c) && _state._egroups.empty())
+                _state._egroups.init(_state._b, _state._eweight, _state._g,
+                                     _state._bg);
+            if (_d > 0 && _state._empty_blocks.empty() &&
+                _state._candidate_blocks.size() - 1 < num_vertices(_g))
+            {
+                size_t r = _state.add_block();
+                for (auto& ps : _state._partition_stats)
+                    ps.get_r(r);
+            }
+            size_t B = num_vertices(_state._bg);
+            if (_groups.size() < B)
+            {
+                _groups.resize(B);
+                _rpos.resize(B);
+            }
+        }
+
+        // Whether a proposal made before other moves were committed is still
+        // valid, i.e. its vertices have not left the group.
+        bool check_proposal(size_t r, size_t, const move_t& move)
+        {
+            for (auto v : move.vs)
+            {
+                if (size_t(_state._b[v]) != r)
+                    return false;
+            }
+            return _allow_vacate || _groups[r].size() > move.vs.size();
+        }
+
+        // The blocks whose counts are read or modified by the move, i.e. the
+        // current and new blocks, and those of the neighbors of the moved
+        // vertices.
+        template <class F>
+        void for_each_move_block(size_t r, size_t nr, const move_t& move,
+                                 F&& f)
+        {
+            f(r);
+            f(nr);
+            for (auto v : move.vs)
+                for (auto u : all_neighbors_range(v, _g))
+                    f(_state._b[u]);
+        }
+
+        bool is_global_move(size_t r, size_t nr, const move_t& move)
+        {
+            size_t w = 0;
+            for (auto v : move.vs)
+                w += _state._vweight[v];
+            if (w == 0)
+                return false;
+            return (_state._coupled_state != nullptr ||
+                    size_t(_state._wr[r]) == w || _state._wr[nr] == 0);
+        }
+
         void perform_move(size_t r, size_t nr)
         {
-            if (!_groups[nr].empty() || _groups[r].size() > _vs.size())
-                _maccept[_vs.size()]++;
+            perform_move(r, nr, _move);
+        }
+
+        void perform_move(size_t r, size_t nr, const move_t& move)
+        {
+            auto& vs = move.vs;
+            if (nr >= _groups.size())
+            {
+                _groups.resize(nr + 1);
+                _rpos.resize(nr + 1);
+            }
+            if (!_groups[nr].empty() || _groups[r].size() > vs.size())
+                _maccept[vs.size()]++;
+            if (_groups[nr].empty())
+                _state._bclabel[nr] = _state._bclabel[r];
             if (_state._wr[nr] == 0)
                 add_element(_vlist, _rpos, nr);
-            for (auto v : _vs)
+            for (auto v : vs)
             {
                 _state.move_vertex(v, nr);
                 remove_element(_groups[r], _vpos, v);
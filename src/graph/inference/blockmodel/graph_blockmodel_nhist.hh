@@ -0,0 +1,231 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_BLOCKMODEL_NHIST_HH
+#define GRAPH_BLOCKMODEL_NHIST_HH
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace graph_tool
+{
+
+// ===============================================
+// Per-vertex histograms of the neighbors' blocks
+// ===============================================
+
+// For every vertex v, this keeps the total weight of the edges between v and
+// its neighbors belonging to each block, as an array of bins sorted by block
+// label. Self-loops are kept separately. The histograms are updated whenever a
+// vertex changes its block, so that move proposals, their probabilities, and
+// the entries of the edge count matrix affected by a move can be obtained in
+// time proportional to the number of distinct neighbor blocks, instead of the
+// degree of the vertex.
+
+template <class Graph>
+class NeighborBlockHist
+{
+public:
+    struct bin_t
+    {
+        size_t r;
+        int kout;
+        int kin;
+    };
+
+    template <class Vprop, class Eprop>
+    void init(Vprop& b, Eprop& eweight, Graph& g)
+    {
+        size_t N = num_vertices(g);
+        _hist.clear();
+        _hist.resize(N);
+        _self.clear();
+        _self.resize(N, 0);
+        for (auto v : vertices_range(g))
+        {
+            for (auto e : out_edges_range(v, g))
+            {
+                auto u = target(e, g);
+                if (u == v)
+                {
+                    _self[v] += eweight[e];
+                    continue;
+                }
+                get_bin(v, b[u]).kout += eweight[e];
+            }
+
+            if (!graph_tool::is_directed(g))
+                continue;
+
+            for (auto e : in_edges_range(v, g))
+            {
+                auto u = source(e, g);
+                if (u == v)
+                    continue;
+                get_bin(v, b[u]).kin += eweight[e];
+            }
+        }
+    }
+
+    void clear()
+    {
+        _hist.clear();
+        _self.clear();
+    }
+
+    bool empty()
+    {
+        return _hist.empty();
+    }
+
+    const std::vector<bin_t>& get_hist(size_t v)
+    {
+        return _hist[v];
+    }
+
+    // update the histograms of the neighbors of v, after v has been added to
+    // (or removed from) block r
+    template <bool Add, class Eprop>
+    void modify_vertex(size_t v, size_t r, Eprop& eweight, Graph& g)
+    {
+        for (auto e : out_edges_range(v, g))
+        {
+            auto u = target(e, g);
+            if (u == v)
+                continue;
+            int ew = eweight[e];
+            if (graph_tool::is_directed(g))
+                update_bin<Add>(u, r, 0, ew);
+            else
+                update_bin<Add>(u, r, ew, 0);
+        }
+
+        if (!graph_tool::is_directed(g))
+            return;
+
+        for (auto e : in_edges_range(v, g))
+        {
+            auto u = source(e, g);
+            if (u == v)
+                continue;
+            update_bin<Add>(u, r, eweight[e], 0);
+        }
+    }
+
+    // sample the block of a neighbor of v, chosen with a probability
+    // proportional to the edge weight
+    template <class RNG>
+    size_t sample_block(size_t v, RNG& rng)
+    {
+        auto& h = _hist[v];
+        size_t k = 0;
+        for (auto& x : h)
+            k += x.kout + x.kin;
+        std::uniform_int_distribution<size_t> sample(0, k - 1);
+        size_t i = sample(rng);
+        for (auto& x : h)
+        {
+            size_t w = x.kout + x.kin;
+            if (i < w)
+                return x.r;
+            i -= w;
+        }
+        return h.back().r;
+    }
+
+    bool has_neighbors(size_t v)
+    {
+        for (auto& x : _hist[v])
+        {
+            if (x.kout + x.kin > 0)
+                return true;
+        }
+        return false;
+    }
+
+    // equivalent to move_entries() with no edge filter and no edge covariates,
+    // using the histograms instead of the edges of v
+    template <class MEntries>
+    void move_entries(size_t v, size_t r, size_t nr, size_t B,
+                      MEntries& m_entries, Graph& g)
+    {
+        m_entries.set_move(r, nr, B);
+        if (r != null_group)
+            modify_entries<false>(v, r, m_entries, g);
+        if (nr != null_group)
+            modify_entries<true>(v, nr, m_entries, g);
+    }
+
+private:
+    template <bool Add, class MEntries>
+    void modify_entries(size_t v, size_t r, MEntries& m_entries, Graph& g)
+    {
+        for (auto& x : _hist[v])
+        {
+            if (x.kout != 0)
+                m_entries.template insert_delta<Add>(r, x.r, x.kout);
+            if (x.kin != 0)
+                m_entries.template insert_delta<Add>(x.r, r, x.kin);
+        }
+
+        int ks = _self[v];
+        if (ks == 0)
+            return;
+        m_entries.template insert_delta<Add>(r, r, ks);
+        if (!graph_tool::is_directed(g) && ks % 2 == 0)
+            m_entries.template insert_delta<!Add>(r, r, ks / 2);
+    }
+
+    bin_t& get_bin(size_t v, size_t r)
+    {
+        auto& h = _hist[v];
+        auto iter = std::lower_bound(h.begin(), h.end(), r,
+                                     [](auto& x, size_t r) { return x.r < r; });
+        if (iter == h.end() || iter->r != r)
+            iter = h.insert(iter, {r, 0, 0});
+        return *iter;
+    }
+
+    template <bool Add>
+    void update_bin(size_t v, size_t r, int kout, int kin)
+    {
+        auto& x = get_bin(v, r);
+        if (Add)
+        {
+            x.kout += kout;
+            x.kin += kin;
+        }
+        else
+        {
+            x.kout -= kout;
+            x.kin -= kin;
+            if (x.kout == 0 && x.kin == 0)
+            {
+                auto& h = _hist[v];
+                h.erase(h.begin() + (&x - h.data()));
+            }
+        }
+    }
+
+    std::vector<std::vector<bin_t>> _hist;
+    std::vector<int> _self;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_BLOCKMODEL_NHIST_HH
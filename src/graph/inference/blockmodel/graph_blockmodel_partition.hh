@@ -58,12 +58,167 @@ void degs_op(size_t v, Vprop& vweight, Eprop& eweight,
     }
 }
 
-class partition_stats_t
+// Histogram of the (kin, kout) degree classes of a block, stored as a flat
+// open-addressing hash table with linear probing. Classes whose count drops to
+// zero are removed, using backward-shift deletion (i.e. without tombstones), so
+// that the table size is always proportional to the number of occupied
+// classes. Each entry takes 16 bytes, with the degrees packed in a single key.
+
+class deg_hist_t
 {
 public:
+    typedef pair<size_t, size_t> deg_t;
+
+    int get(const deg_t& deg) const
+    {
+        if (_size == 0)
+            return 0;
+        auto key = get_key(deg);
+        size_t mask = _table.size() - 1;
+        for (size_t i = get_slot(key); ; i = (i + 1) & mask)
+        {
+            auto& x = _table[i];
+            if (x.key == key)
+                return x.count;
+            if (x.key == _empty)
+                return 0;
+        }
+    }
+
+    // adds delta to the count of deg, and returns the previous count
+    int add(const deg_t& deg, int delta)
+    {
+        if (delta == 0)
+            return get(deg);
+
+        if (2 * (_size + 1) > _table.size())
+            rehash(std::max(size_t(4), 2 * _table.size()));
+
+        auto key = get_key(deg);
+        size_t mask = _table.size() - 1;
+        size_t i = get_slot(key);
+        for (; ; i = (i + 1) & mask)
+        {
+            auto& x = _table[i];
+            if (x.key == key)
+                break;
+            if (x.key == _empty)
+            {
+                assert(delta > 0);
+                x.key = key;
+                x.count = delta;
+                _size++;
+                return 0;
+            }
+        }
+
+        int n = _table[i].count;
+        assert(n + delta >= 0);
+        _table[i].count += delta;
+        if (_table[i].count == 0)
+            erase(i);
+        return n;
+    }
+
+    template <class F>
+    void for_each(F&& f) const
+    {
+        if (_size == 0)
+            return;
+        for (auto& x : _table)
+        {
+            if (x.key != _empty)
+                f(x.key >> 32, x.key & 0xffffffff, x.count);
+        }
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+private:
+    struct entry_t
+    {
+        uint64_t key;
+        int count;
+    };
+
+    static constexpr uint64_t _empty = std::numeric_limits<uint64_t>::max();
 
-    typedef gt_hash_map<pair<size_t,size_t>, int> map_t;
+    static uint64_t get_key(const deg_t& deg)
+    {
+        assert(deg.first < 0xffffffff && deg.second < 0xffffffff);
+        return (uint64_t(deg.first) << 32) | uint64_t(deg.second);
+    }
+
+    size_t get_slot(uint64_t key) const
+    {
+        // Fibonacci hashing
+        key *= UINT64_C(0x9e3779b97f4a7c15);
+        return key >> (64 - _bits);
+    }
+
+    void rehash(size_t n)
+    {
+        std::vector<entry_t> table(n, entry_t{_empty, 0});
+        std::swap(table, _table);
+        _bits = 0;
+        while ((size_t(1) << _bits) < n)
+            _bits++;
+        size_t mask = n - 1;
+        for (auto& x : table)
+        {
+            if (x.key == _empty)
+                continue;
+            size_t i = get_slot(x.key);
+            while (_table[i].key != _empty)
+                i = (i + 1) & mask;
+            _table[i] = x;
+        }
+    }
+
+    void erase(size_t i)
+    {
+        size_t mask = _table.size() - 1;
+        size_t j = i;
+        while (true)
+        {
+            j = (j + 1) & mask;
+            if (_table[j].key == _empty)
+                break;
+            // move entry j back into the hole at i, unless its home slot lies
+            // cyclically in (i, j]
+            size_t k = get_slot(_table[j].key);
+            if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j)))
+            {
+                _table[i] = _table[j];
+                i = j;
+            }
+        }
+        _table[i] = entry_t{_empty, 0};
+        _size--;
+        if (_size == 0)
+        {
+            _table.clear();
+            _table.shrink_to_fit();
+            _bits = 0;
+        }
+    }
 
+    std::vector<entry_t> _table;
+    size_t _size = 0;
+    size_t _bits = 0;
+};
+
+class partition_stats_t
+{
+public:
     template <class Graph, class Vprop, class VWprop, class Eprop, class Degs,
               class Mprop, class Vlist>
     partition_stats_t(Graph& g, Vprop& b, Vlist& vlist, size_t E, size_t B,
@@ -89,7 +244,7 @@ public:
                             kout = 0;
                         if (_ignore_degree[v] != 1)
                         {
-                            _hist[r][make_pair(kin, kout)] += n;
+                            _hist[r].add(make_pair(kin, kout), n);
                             _em[r] += kin * n;
                             _ep[r] += kout * n;
                         }
@@ -145,11 +300,11 @@ public:
         for (size_t r = 0; r < _ep.size(); ++r)
         {
             size_t total = 0;
-            for (auto& k_c : _hist[r])
-            {
-                S -= xlogx(k_c.second);
-                total += k_c.second;
-            }
+            _hist[r].for_each([&](size_t, size_t, int n)
+                              {
+                                  S -= xlogx(n);
+                                  total += n;
+                              });
             S += xlogx(total);
         }
         return S;
@@ -175,11 +330,11 @@ public:
             S += log_q(_em[r], _total[r]);
 
             size_t total = 0;
-            for (auto& k_c : _hist[r])
-            {
-                S -= lgamma_fast(k_c.second + 1);
-                total += k_c.second;
-            }
+            _hist[r].for_each([&](size_t, size_t, int n)
+                              {
+                                  S -= lgamma_fast(n + 1);
+                                  total += n;
+                              });
             S += lgamma_fast(total + 1);
         }
         return S;
@@ -206,12 +361,6 @@ public:
         if (r == nr)
             return 0;
 
-        if (r != null_group)
-            r = get_r(r);
-
-        if (nr != null_group)
-            nr = get_r(nr);
-
         int n = vweight[v];
         if (n == 0)
         {
@@ -221,6 +370,22 @@ public:
                 return 0;
         }
 
+        return get_delta_partition_dl(r, nr, n);
+    }
+
+    // partition description length difference of moving a total vertex weight
+    // n from r to nr
+    double get_delta_partition_dl(size_t r, size_t nr, int n)
+    {
+        if (r == nr || n == 0)
+            return 0;
+
+        if (r != null_group)
+            r = get_r(r);
+
+        if (nr != null_group)
+            nr = get_r(nr);
+
         double S_b = 0, S_a = 0;
 
         if (r != null_group)
@@ -272,13 +437,6 @@ public:
         if (r == nr || _allow_empty)
             return 0;
 
-        if (r != null_group)
-            r = get_r(r);
-        if (nr != null_group)
-            nr = get_r(nr);
-
-        double S_b = 0, S_a = 0;
-
         int n = vweight[v];
 
         if (n == 0)
@@ -289,6 +447,25 @@ public:
                 return 0;
         }
 
+        return get_delta_edges_dl(r, nr, n, actual_B, g);
+    }
+
+    // edge description length difference of moving a total vertex weight n
+    // from r to nr
+    template <class Graph>
+    double get_delta_edges_dl(size_t r, size_t nr, int n, size_t actual_B,
+                              Graph& g)
+    {
+        if (r == nr || _allow_empty || n == 0)
+            return 0;
+
+        if (r != null_group)
+            r = get_r(r);
+        if (nr != null_group)
+            nr = get_r(nr);
+
+        double S_b = 0, S_a = 0;
+
         int dB = 0;
         if (r != null_group && _total[r] == n)
             dB--;
@@ -352,15 +529,72 @@ public:
             break;
         case deg_dl_kind::UNIFORM:
             if (r != null_group)
-                dS += get_delta_deg_dl_uniform_change(v, r,  dop, -1);
+                dS += get_delta_deg_dl_uniform_change(r,  dop, -1);
             if (nr != null_group)
-                dS += get_delta_deg_dl_uniform_change(v, nr, dop, +1);
+                dS += get_delta_deg_dl_uniform_change(nr, dop, +1);
             break;
         case deg_dl_kind::DIST:
             if (r != null_group)
-                dS += get_delta_deg_dl_dist_change(v, r,  dop, -1);
+                dS += get_delta_deg_dl_dist_change(r,  dop, -1);
             if (nr != null_group)
-                dS += get_delta_deg_dl_dist_change(v, nr, dop, +1);
+                dS += get_delta_deg_dl_dist_change(nr, dop, +1);
+            break;
+        default:
+            dS = numeric_limits<double>::quiet_NaN();
+        }
+        return dS;
+    }
+
+    // degree description length difference of moving all vertices in vs,
+    // which belong to r, to nr; the degrees are first collected in a
+    // histogram, so that each degree class is only changed once
+    template <class Graph, class VProp, class EProp, class Degs>
+    double get_delta_deg_dl(const std::vector<size_t>& vs, size_t r,
+                            size_t nr, VProp& vweight, EProp& eweight,
+                            Degs& degs, Graph& g, int kind)
+    {
+        if (r == nr)
+            return 0;
+        r = get_r(r);
+        nr = get_r(nr);
+
+        deg_hist_t hist;
+        for (auto v : vs)
+        {
+            if (_ignore_degree[v] == 1 || vweight[v] == 0)
+                continue;
+            degs_op(v, vweight, eweight, degs, g,
+                    [&](auto kin, auto kout, auto n)
+                    {
+                        if (_ignore_degree[v] == 2)
+                            kout = 0;
+                        hist.add(make_pair(kin, kout), n);
+                    });
+        }
+
+        if (hist.empty())
+            return 0;
+
+        auto dop =
+            [&](auto&& f)
+            {
+                hist.for_each(f);
+            };
+
+        double dS = 0;
+        switch (kind)
+        {
+        case deg_dl_kind::ENT:
+            dS += get_delta_deg_dl_ent_change(r,  dop, -1);
+            dS += get_delta_deg_dl_ent_change(nr, dop, +1);
+            break;
+        case deg_dl_kind::UNIFORM:
+            dS += get_delta_deg_dl_uniform_change(r,  dop, -1);
+            dS += get_delta_deg_dl_uniform_change(nr, dop, +1);
+            break;
+        case deg_dl_kind::DIST:
+            dS += get_delta_deg_dl_dist_change(r,  dop, -1);
+            dS += get_delta_deg_dl_dist_change(nr, dop, +1);
             break;
         default:
             dS = numeric_limits<double>::quiet_NaN();
@@ -372,15 +606,7 @@ public:
     double get_delta_deg_dl_ent_change(size_t r, DegOP&& dop, int diff)
     {
         int nr = _total[r];
-        auto get_Sk = [&](size_t s, pair<size_t, size_t>& deg, int delta)
-            {
-                int nd = 0;
-                auto iter = _hist[s].find(deg);
-                if (iter != _hist[s].end())
-                    nd = iter->second;
-                assert(nd + delta >= 0);
-                return -xlogx(nd + delta);
-            };
+        auto& hist = _hist[r];
 
         double S_b = 0, S_a = 0;
         int dn = 0;
@@ -388,9 +614,10 @@ public:
         dop([&](size_t kin, size_t kout, int nk)
             {
                 dn += diff * nk;
-                auto deg = make_pair(kin, kout);
-                S_b += get_Sk(r, deg,         0);
-                S_a += get_Sk(r, deg, diff * nk);
+                int nd = hist.get(make_pair(kin, kout));
+                assert(nd + diff * nk >= 0);
+                S_b += -xlogx(nd);
+                S_a += -xlogx(nd + diff * nk);
             });
 
         S_b += xlogx(nr);
@@ -399,9 +626,10 @@ public:
         return S_a - S_b;
     }
 
+    // the out-degrees of vertices with _ignore_degree == 2 are already zeroed
+    // by dop
     template <class DegOP>
-    double get_delta_deg_dl_uniform_change(size_t v, size_t r, DegOP&& dop,
-                                           int diff)
+    double get_delta_deg_dl_uniform_change(size_t r, DegOP&& dop, int diff)
     {
         auto get_Se = [&](int dn, int dkin, int dkout)
             {
@@ -416,8 +644,7 @@ public:
         dop([&](auto kin, auto kout, int nk)
             {
                 tkin += kin * nk;
-                if (_ignore_degree[v] != 2)
-                    tkout += kout * nk;
+                tkout += kout * nk;
                 n += nk;
             });
 
@@ -427,8 +654,7 @@ public:
     }
 
     template <class DegOP>
-    double get_delta_deg_dl_dist_change(size_t v, size_t r, DegOP&& dop,
-                                        int diff)
+    double get_delta_deg_dl_dist_change(size_t r, DegOP&& dop, int diff)
     {
         auto get_Se = [&](int delta, int kin, int kout)
             {
@@ -447,28 +673,20 @@ public:
                 return lgamma_fast(_total[r] + delta + 1);
             };
 
-        auto get_Sk = [&](pair<size_t, size_t>& deg, int delta)
-            {
-                int nd = 0;
-                auto iter = _hist[r].find(deg);
-                if (iter != _hist[r].end())
-                    nd = iter->second;
-                assert(nd + delta >= 0);
-                return -lgamma_fast(nd + delta + 1);
-            };
+        auto& hist = _hist[r];
 
         double S_b = 0, S_a = 0;
         int tkin = 0, tkout = 0, n = 0;
         dop([&](size_t kin, size_t kout, int nk)
             {
                 tkin += kin * nk;
-                if (_ignore_degree[v] != 2)
-                    tkout += kout * nk;
+                tkout += kout * nk;
                 n += nk;
 
-                auto deg = make_pair(kin, kout);
-                S_b += get_Sk(deg,         0);
-                S_a += get_Sk(deg, diff * nk);
+                int nd = hist.get(make_pair(kin, kout));
+                assert(nd + diff * nk >= 0);
+                S_b += -lgamma_fast(nd + 1);
+                S_a += -lgamma_fast(nd + diff * nk + 1);
             });
 
         S_b += get_Se(       0,           0,            0);
@@ -531,7 +749,7 @@ public:
             if (_ignore_degree[v] == 2)
                 kout = 0;
             auto deg = make_pair(kin, kout);
-            _hist[r][deg] += diff * vweight;
+            _hist[r].add(deg, diff * vweight);
             _em[r] += diff * deg.first * vweight;
             _ep[r] += diff * deg.second * vweight;
         }
@@ -560,7 +778,7 @@ private:
     size_t _actual_B;
     size_t _total_B;
     bool _allow_empty;
-    vector<map_t> _hist;
+    vector<deg_hist_t> _hist;
     vector<int> _total;
     vector<int> _ep;
     vector<int> _em;
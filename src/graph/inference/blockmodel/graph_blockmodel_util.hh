@@ -22,10 +22,11 @@
 
 #include "graph_blockmodel_entropy.hh"
 #include "graph_blockmodel_partition.hh"
+#include "graph_blockmodel_weights.hh"
 #include "graph_blockmodel_entries.hh"
 #include "graph_blockmodel_emat.hh"
 #include "graph_blockmodel_elist.hh"
-#include "graph_blockmodel_weights.hh"
+#include "graph_blockmodel_nhist.hh"
 #include "../support/graph_neighbor_sampler.hh"
 
 namespace graph_tool
@@ -50,6 +51,7 @@ public:
                                              std::vector<double>>>&,
                            std::vector<double>&, int) = 0;
     virtual bool check_edge_counts(bool emat=true) = 0;
+    virtual void mark_modified() = 0;
 };
 
 
@@ -36,10 +36,15 @@ enum weight_type
     DELTA_T
 };
 
+// Each log-likelihood takes an optional constant c, which is the part that
+// depends only on the hyperparameters, as returned by w_log_P_const() below; if
+// it is NaN, it is computed on the fly.
+
 // exponential
 template <class DT>
 double positive_w_log_P(DT N, double x, double alpha, double beta,
-                        double epsilon)
+                        double epsilon,
+                        double c = std::numeric_limits<double>::quiet_NaN())
 {
     if (N == 0)
         return 0.;
@@ -50,14 +55,16 @@ double positive_w_log_P(DT N, double x, double alpha, double beta,
         else
             return lgamma(N) - (N - 1) * log(x);
     }
-    return lgamma(N + alpha) - lgamma(alpha) + alpha * log(beta) -
-        (alpha + N) * log(beta + x);
+    if (std::isnan(c))
+        c = alpha * log(beta) - lgamma(alpha);
+    return lgamma(N + alpha) - (alpha + N) * log(beta + x) + c;
 }
 
 // normal
 template <class DT>
 double signed_w_log_P(DT N, double x, double x2, double m0, double k0, double v0,
-                      double nu0, double epsilon)
+                      double nu0, double epsilon,
+                      double c = std::numeric_limits<double>::quiet_NaN())
 {
     if (N == 0)
         return 0.;
@@ -76,45 +83,121 @@ double signed_w_log_P(DT N, double x, double x2, double m0, double k0, double v0
     auto k_n = k0 + N;
     auto nu_n = nu0 + N;
     auto v_n = (v0 * nu0 + v + ((N * k0)/(k0 + N)) * pow(m0 - x/N, 2)) / nu_n;
-    return lgamma(nu_n / 2.) - lgamma(nu0 / 2.) + (log(k0) - log(k_n)) / 2. +
-        (nu0 / 2.) * log(nu0 * v0) - (nu_n / 2.) * log(nu_n * v_n) - (N / 2.) *
-        log(M_PI);
+    if (std::isnan(c))
+        c = log(k0) / 2. + (nu0 / 2.) * log(nu0 * v0) - lgamma(nu0 / 2.);
+    return lgamma(nu_n / 2.) - log(k_n) / 2. - (nu_n / 2.) * log(nu_n * v_n)
+        - (N / 2.) * log(M_PI) + c;
 }
 
 // discrete: geometric
 template <class DT>
-double geometric_w_log_P(DT N, double x, double alpha, double beta)
+double geometric_w_log_P(DT N, double x, double alpha, double beta,
+                         double c = std::numeric_limits<double>::quiet_NaN())
 {
     if (N == 0)
         return 0.;
     if (std::isnan(alpha) && std::isnan(beta))
         return -lbinom((N - 1) + x, x);
-    return lbeta(N + alpha, x + beta) - lbeta(alpha, beta);
+    if (std::isnan(c))
+        c = -lbeta(alpha, beta);
+    return lbeta(N + alpha, x + beta) + c;
 }
 
 // discrete: binomial
 template <class DT>
-double binomial_w_log_P(DT N, double x, int n, double alpha, double beta)
+double binomial_w_log_P(DT N, double x, int n, double alpha, double beta,
+                        double c = std::numeric_limits<double>::quiet_NaN())
 {
     if (N == 0)
         return 0.;
     if (std::isnan(alpha) && std::isnan(beta))
         return -lbinom(N * n, x);
-    return lbeta(x + alpha, N * n - x + beta) - lbeta(alpha, beta);
+    if (std::isnan(c))
+        c = -lbeta(alpha, beta);
+    return lbeta(x + alpha, N * n - x + beta) + c;
 }
 
 // discrete: Poisson
 template <class DT>
-double poisson_w_log_P(DT N, double x, double alpha, double beta)
+double poisson_w_log_P(DT N, double x, double alpha, double beta,
+                       double c = std::numeric_limits<double>::quiet_NaN())
 {
     if (N == 0)
         return 0.;
     if (std::isnan(alpha) && std::isnan(beta))
         return lgamma(x+1) - x * log(N);
-    return lgamma(x + alpha) - (x + alpha) * log(N + beta) - lgamma(alpha) +
-        alpha * log(beta);
+    if (std::isnan(c))
+        c = alpha * log(beta) - lgamma(alpha);
+    return lgamma(x + alpha) - (x + alpha) * log(N + beta) + c;
+}
+
+// hyperparameter-dependent constant of the block-pair log-likelihood of a
+// covariate of type rt, with hyperparameters wp
+inline double w_log_P_const(int rt, const std::vector<double>& wp)
+{
+    switch (rt)
+    {
+    case weight_type::REAL_EXPONENTIAL:
+    case weight_type::DISCRETE_POISSON:
+        return wp[0] * log(wp[1]) - lgamma(wp[0]);
+    case weight_type::REAL_NORMAL:
+        return log(wp[1]) / 2. + (wp[3] / 2.) * log(wp[3] * wp[2]) -
+            lgamma(wp[3] / 2.);
+    case weight_type::DISCRETE_GEOMETRIC:
+        return -lbeta(wp[0], wp[1]);
+    case weight_type::DISCRETE_BINOMIAL:
+        return -lbeta(wp[1], wp[2]);
+    default:
+        return 0;
+    }
 }
 
+// Sufficient statistics of the block-pair entries affected by a move, stored
+// contiguously for each edge covariate, so that the covariate terms of the
+// entropy difference can be evaluated in tight loops. Index 0 holds the edge
+// counts. This lives alongside the (per-thread) move entries, and also
+// memoizes the hyperparameter constants of each covariate.
+struct rec_stats_t
+{
+    std::vector<int> mrs, dm;                 // multiplicities and deltas
+    std::vector<std::vector<double>> x, dx;   // covariate sums and deltas
+    std::vector<std::vector<double>> x2, dx2; // squared sums and deltas
+
+    std::vector<std::vector<double>> wparams;
+    std::vector<double> wconst;
+
+    void clear(size_t L)
+    {
+        mrs.clear();
+        dm.clear();
+        for (auto* xs : {&x, &dx, &x2, &dx2})
+        {
+            xs->resize(L);
+            for (auto& y : *xs)
+                y.clear();
+        }
+    }
+
+    // recomputes the constants only if the hyperparameters have changed
+    void update_wconst(const std::vector<int32_t>& rec_types,
+                       const std::vector<std::vector<double>>& wps)
+    {
+        auto same = [](double a, double b)
+            { return a == b || (std::isnan(a) && std::isnan(b)); };
+        wparams.resize(wps.size());
+        wconst.resize(wps.size());
+        for (size_t i = 0; i < wps.size(); ++i)
+        {
+            if (wparams[i].size() == wps[i].size() &&
+                std::equal(wps[i].begin(), wps[i].end(), wparams[i].begin(),
+                           same))
+                continue;
+            wparams[i] = wps[i];
+            wconst[i] = w_log_P_const(rec_types[i], wps[i]);
+        }
+    }
+};
+
 } //namespace graph_tool
 
 #endif // GRAPH_BLOCKMODEL_WEIGHTS_HH
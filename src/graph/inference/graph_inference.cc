@@ -106,6 +106,8 @@ extern void export_layered_blockmodel_exhaustive();
 extern void export_layered_overlap_blockmodel_exhaustive();
 extern void export_marginals();
 extern void export_modularity();
+extern void export_checkpoint();
+extern void export_sweep_stats();
 
 BOOST_PYTHON_MODULE(libgraph_tool_inference)
 {
@@ -147,6 +149,8 @@ BOOST_PYTHON_MODULE(libgraph_tool_inference)
     export_layered_overlap_blockmodel_exhaustive();
     export_marginals();
     export_modularity();
+    export_checkpoint();
+    export_sweep_stats();
 
     def("vector_map", vector_map<int32_t>);
     def("vector_map64", vector_map<int64_t>);
@@ -43,9 +43,27 @@ double modularity(GraphInterface& gi, boost::any weight, boost::any property)
     return Q;
 }
 
+void maximize_modularity(GraphInterface& gi, boost::any weight,
+                         boost::any property, double gamma, bool refine)
+{
+    typedef UnityPropertyMap<int, GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        edge_props_t;
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    run_action<>()
+        (gi, [&](auto& g, auto& w, auto& b)
+             { get_max_modularity(g, w, b, gamma, refine); },
+         edge_props_t(), writable_vertex_scalar_properties())
+        (weight, property);
+}
+
 using namespace boost::python;
 
 void export_modularity()
 {
     def("modularity", &modularity);
+    def("maximize_modularity", &maximize_modularity);
 }
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 #include "graph_tool.hh"
 #include "hash_map_wrap.hh"
@@ -69,6 +70,493 @@ double get_modularity(const Graph& g, WeightMap weights, CommunityMap b)
     return Q;
 };
 
+// Multilevel modularity maximization
+// ==================================
+//
+// This is the Louvain method, optionally with the refinement step of the Leiden
+// method, which guarantees that the communities are internally connected. At
+// each level the graph is kept as a symmetric weighted adjacency in CSR form,
+// with the self-loops stored separately; the weights of the self-loops, and of
+// the internal edges of the aggregated nodes, are counted twice.
+
+struct modularity_graph_t
+{
+    std::vector<size_t> pos;
+    std::vector<size_t> nbr;
+    std::vector<double> w;
+    std::vector<double> self;
+    std::vector<double> k;
+    double W = 0;  // total weight, counted twice
+
+    size_t size() const { return k.size(); }
+};
+
+template <class Graph, class WeightMap>
+void build_modularity_graph(const Graph& g, WeightMap weights,
+                            modularity_graph_t& G)
+{
+    size_t N = num_vertices(g);
+    G.pos.clear();
+    G.pos.resize(N + 1);
+    G.self.clear();
+    G.self.resize(N);
+    G.k.clear();
+    G.k.resize(N);
+
+    std::vector<size_t> deg(N);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             for (auto e : all_edges_range(v, g))
+             {
+                 auto u = target(e, g);
+                 if (u == v)
+                     u = source(e, g);
+                 if (u != v)
+                     deg[v]++;
+             }
+         });
+
+    for (size_t v = 0; v < N; ++v)
+        G.pos[v + 1] = G.pos[v] + deg[v];
+
+    G.nbr.resize(G.pos[N]);
+    G.w.resize(G.pos[N]);
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             size_t i = G.pos[v];
+             for (auto e : all_edges_range(v, g))
+             {
+                 auto u = target(e, g);
+                 if (u == v)
+                     u = source(e, g);
+                 double w = get(weights, e);
+                 G.k[v] += w;
+                 if (u == v)
+                 {
+                     G.self[v] += w;
+                     continue;
+                 }
+                 G.nbr[i] = u;
+                 G.w[i] = w;
+                 i++;
+             }
+         });
+
+    G.W = 0;
+    for (auto k : G.k)
+        G.W += k;
+}
+
+// Relabel the communities as contiguous integers, and return their number.
+inline size_t compact_communities(std::vector<size_t>& c)
+{
+    std::vector<size_t> idx(c.size(), std::numeric_limits<size_t>::max());
+    size_t B = 0;
+    for (auto& r : c)
+    {
+        if (idx[r] == std::numeric_limits<size_t>::max())
+            idx[r] = B++;
+        r = idx[r];
+    }
+    return B;
+}
+
+inline double get_modularity(const modularity_graph_t& G,
+                             const std::vector<size_t>& c,
+                             const std::vector<double>& tot, double gamma)
+{
+    size_t n = G.size();
+    double Ein = 0;
+    #pragma omp parallel for if (n > OPENMP_MIN_THRESH) \
+        schedule(runtime) reduction(+:Ein)
+    for (size_t i = 0; i < n; ++i)
+    {
+        Ein += G.self[i];
+        for (size_t j = G.pos[i]; j < G.pos[i + 1]; ++j)
+        {
+            if (c[G.nbr[j]] == c[i])
+                Ein += G.w[j];
+        }
+    }
+
+    double Q = Ein / G.W;
+    for (auto t : tot)
+        Q -= gamma * (t / G.W) * (t / G.W);
+    return Q;
+}
+
+// Find the best community for node i, given the current state. If
+// 'sync' is true, the moves are applied simultaneously after all nodes are
+// considered; in this case, to avoid two singletons swapping their labels, a
+// singleton can only join another singleton with a smaller label.
+inline size_t get_modularity_move(const modularity_graph_t& G, size_t i,
+                                  const std::vector<size_t>& c,
+                                  const std::vector<double>& tot,
+                                  const std::vector<size_t>& size,
+                                  double gamma, bool sync,
+                                  std::vector<double>& kin,
+                                  std::vector<size_t>& touched)
+{
+    size_t r = c[i];
+    for (size_t j = G.pos[i]; j < G.pos[i + 1]; ++j)
+    {
+        size_t s = c[G.nbr[j]];
+        if (kin[s] == 0)
+            touched.push_back(s);
+        kin[s] += G.w[j];
+    }
+
+    double ki = G.k[i];
+    double base = kin[r] - gamma * ki * (tot[r] - ki) / G.W;
+    size_t best = r;
+    double best_dQ = 0;
+    for (auto s : touched)
+    {
+        if (s == r)
+            continue;
+        if (sync && size[r] == 1 && size[s] == 1 && s > r)
+            continue;
+        double dQ = kin[s] - gamma * ki * tot[s] / G.W - base;
+        if (dQ > best_dQ)
+        {
+            best = s;
+            best_dQ = dQ;
+        }
+    }
+
+    for (auto s : touched)
+        kin[s] = 0;
+    touched.clear();
+    return best;
+}
+
+// Move the nodes until the modularity no longer increases. Large graphs are
+// swept in parallel, with all moves applied simultaneously; if such a sweep
+// fails to increase the modularity, it is undone and replaced by a sequential
+// one. Returns true if any node was moved.
+inline bool modularity_local_moves(const modularity_graph_t& G,
+                                   std::vector<size_t>& c, double gamma)
+{
+    size_t n = G.size();
+    std::vector<double> tot(n);
+    std::vector<size_t> size(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        tot[c[i]] += G.k[i];
+        size[c[i]]++;
+    }
+
+    auto move = [&](size_t i, size_t s)
+        {
+            size_t r = c[i];
+            tot[r] -= G.k[i];
+            size[r]--;
+            tot[s] += G.k[i];
+            size[s]++;
+            c[i] = s;
+        };
+
+    std::vector<size_t> c_orig = c, nc(n);
+    std::vector<double> kin(n);
+    std::vector<size_t> touched;
+
+    double Q = get_modularity(G, c, tot, gamma);
+    while (true)
+    {
+        if (n > OPENMP_MIN_THRESH)
+        {
+            std::vector<size_t> c_prev = c;
+
+            #pragma omp parallel
+            {
+                std::vector<double> tkin(n);
+                std::vector<size_t> ttouched;
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < n; ++i)
+                    nc[i] = get_modularity_move(G, i, c, tot, size, gamma,
+                                                true, tkin, ttouched);
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (nc[i] != c[i])
+                    move(i, nc[i]);
+            }
+
+            double nQ = get_modularity(G, c, tot, gamma);
+            if (nQ > Q + 1e-10)
+            {
+                Q = nQ;
+                continue;
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (c_prev[i] != c[i])
+                    move(i, c_prev[i]);
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            size_t s = get_modularity_move(G, i, c, tot, size, gamma, false,
+                                           kin, touched);
+            if (s != c[i])
+                move(i, s);
+        }
+
+        double nQ = get_modularity(G, c, tot, gamma);
+        if (nQ <= Q + 1e-10)
+            break;
+        Q = nQ;
+    }
+
+    return c != c_orig;
+}
+
+// Leiden refinement: each community is split into well-connected
+// subcommunities, by merging its nodes greedily, starting from singletons. The
+// subcommunities are labeled by one of their nodes.
+inline void modularity_refine(const modularity_graph_t& G,
+                              const std::vector<size_t>& c, size_t B,
+                              std::vector<size_t>& rc, double gamma)
+{
+    size_t n = G.size();
+
+    std::vector<size_t> cpos(B + 1), members(n);
+    for (size_t i = 0; i < n; ++i)
+        cpos[c[i] + 1]++;
+    for (size_t r = 0; r < B; ++r)
+        cpos[r + 1] += cpos[r];
+    std::vector<size_t> cfill(cpos.begin(), cpos.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+        members[cfill[c[i]]++] = i;
+
+    std::vector<double> ctot(B);
+    for (size_t i = 0; i < n; ++i)
+        ctot[c[i]] += G.k[i];
+
+    rc.resize(n);
+    std::vector<double> rtot(G.k), rext(n);
+    std::vector<size_t> rsize(n, 1);
+
+    #pragma omp parallel if (n > OPENMP_MIN_THRESH)
+    {
+        std::vector<double> kin(n);
+        std::vector<size_t> touched;
+
+        #pragma omp for schedule(dynamic)
+        for (size_t r = 0; r < B; ++r)
+        {
+            for (size_t m = cpos[r]; m < cpos[r + 1]; ++m)
+            {
+                size_t i = members[m];
+                rc[i] = i;
+                for (size_t j = G.pos[i]; j < G.pos[i + 1]; ++j)
+                {
+                    if (c[G.nbr[j]] == r)
+                        rext[i] += G.w[j];
+                }
+            }
+
+            double K = ctot[r];
+            for (size_t m = cpos[r]; m < cpos[r + 1]; ++m)
+            {
+                size_t i = members[m];
+                if (rsize[rc[i]] > 1)
+                    continue;
+
+                double ki = G.k[i];
+                if (rext[i] < gamma * ki * (K - ki) / G.W)
+                    continue;
+
+                for (size_t j = G.pos[i]; j < G.pos[i + 1]; ++j)
+                {
+                    size_t u = G.nbr[j];
+                    if (c[u] != r)
+                        continue;
+                    size_t s = rc[u];
+                    if (kin[s] == 0)
+                        touched.push_back(s);
+                    kin[s] += G.w[j];
+                }
+
+                size_t best = i;
+                double best_dQ = 0;
+                for (auto s : touched)
+                {
+                    if (s == i)
+                        continue;
+                    if (rext[s] < gamma * rtot[s] * (K - rtot[s]) / G.W)
+                        continue;
+                    double dQ = kin[s] - gamma * ki * rtot[s] / G.W;
+                    if (dQ > best_dQ)
+                    {
+                        best = s;
+                        best_dQ = dQ;
+                    }
+                }
+
+                if (best != i)
+                {
+                    rext[best] += rext[i] - 2 * kin[best];
+                    rtot[best] += ki;
+                    rsize[best]++;
+                    rsize[i]--;
+                    rc[i] = best;
+                }
+
+                for (auto s : touched)
+                    kin[s] = 0;
+                touched.clear();
+            }
+        }
+    }
+}
+
+// Collapse the nodes with the same label in p (which must be contiguous, from
+// 0 to B-1) into single nodes.
+inline void aggregate_modularity_graph(const modularity_graph_t& G,
+                                       const std::vector<size_t>& p, size_t B,
+                                       modularity_graph_t& nG)
+{
+    size_t n = G.size();
+
+    std::vector<size_t> cpos(B + 1), members(n);
+    for (size_t i = 0; i < n; ++i)
+        cpos[p[i] + 1]++;
+    for (size_t r = 0; r < B; ++r)
+        cpos[r + 1] += cpos[r];
+    std::vector<size_t> cfill(cpos.begin(), cpos.end() - 1);
+    for (size_t i = 0; i < n; ++i)
+        members[cfill[p[i]]++] = i;
+
+    std::vector<std::vector<std::pair<size_t, double>>> adj(B);
+    nG.self.clear();
+    nG.self.resize(B);
+    nG.k.clear();
+    nG.k.resize(B);
+
+    #pragma omp parallel if (n > OPENMP_MIN_THRESH)
+    {
+        std::vector<double> ew(B);
+        std::vector<size_t> touched;
+
+        #pragma omp for schedule(runtime)
+        for (size_t r = 0; r < B; ++r)
+        {
+            for (size_t m = cpos[r]; m < cpos[r + 1]; ++m)
+            {
+                size_t i = members[m];
+                nG.self[r] += G.self[i];
+                nG.k[r] += G.k[i];
+                for (size_t j = G.pos[i]; j < G.pos[i + 1]; ++j)
+                {
+                    size_t s = p[G.nbr[j]];
+                    if (s == r)
+                    {
+                        nG.self[r] += G.w[j];
+                        continue;
+                    }
+                    if (ew[s] == 0)
+                        touched.push_back(s);
+                    ew[s] += G.w[j];
+                }
+            }
+
+            auto& es = adj[r];
+            for (auto s : touched)
+            {
+                es.emplace_back(s, ew[s]);
+                ew[s] = 0;
+            }
+            touched.clear();
+        }
+    }
+
+    nG.pos.clear();
+    nG.pos.resize(B + 1);
+    for (size_t r = 0; r < B; ++r)
+        nG.pos[r + 1] = nG.pos[r] + adj[r].size();
+    nG.nbr.resize(nG.pos[B]);
+    nG.w.resize(nG.pos[B]);
+
+    #pragma omp parallel for if (B > OPENMP_MIN_THRESH) schedule(runtime)
+    for (size_t r = 0; r < B; ++r)
+    {
+        size_t j = nG.pos[r];
+        for (auto& sw : adj[r])
+        {
+            nG.nbr[j] = sw.first;
+            nG.w[j] = sw.second;
+            ++j;
+        }
+    }
+
+    nG.W = G.W;
+}
+
+// find a partition with high modularity, which is written into b
+template <class Graph, class WeightMap, class CommunityMap>
+void get_max_modularity(const Graph& g, WeightMap weights, CommunityMap b,
+                        double gamma, bool refine)
+{
+    modularity_graph_t G;
+    build_modularity_graph(g, weights, G);
+
+    size_t N = num_vertices(g);
+    std::vector<size_t> vmap(N), c(N);
+    for (size_t v = 0; v < N; ++v)
+        vmap[v] = c[v] = v;
+
+    if (G.W > 0)
+    {
+        std::vector<size_t> p;
+        modularity_graph_t nG;
+        while (true)
+        {
+            bool moved = modularity_local_moves(G, c, gamma);
+            size_t B = compact_communities(c);
+            if (!moved)
+                break;
+
+            size_t nB = B;
+            if (refine)
+            {
+                modularity_refine(G, c, B, p, gamma);
+                nB = compact_communities(p);
+            }
+            else
+            {
+                p = c;
+            }
+
+            if (nB == G.size())
+                break;
+
+            // the aggregated nodes start in the community of their members
+            std::vector<size_t> nc(nB);
+            for (size_t i = 0; i < G.size(); ++i)
+                nc[p[i]] = c[i];
+
+            for (auto& u : vmap)
+                u = p[u];
+
+            aggregate_modularity_graph(G, p, nB, nG);
+            std::swap(G, nG);
+            c.swap(nc);
+        }
+    }
+
+    for (auto v : vertices_range(g))
+        put(b, v, c[vmap[v]]);
+}
+
 } // graph_tool namespace
 
 #endif //GRAPH_MODULARITY_HH
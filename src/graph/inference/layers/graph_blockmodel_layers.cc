@@ -167,17 +167,13 @@ void split_layers(GraphInterface& gi, boost::any& aec, boost::any& ab,
                                        block_map.resize(l + 1);
 
                                    auto& bmap = block_map[l];
-                                   auto riter = bmap.find(r);
-                                   if (riter == bmap.end())
+                                   u_r = bmap.find(r);
+                                   if (u_r == bmap_t::null)
                                    {
                                        u_r = bmap.size();
-                                       bmap[r] = u_r;
+                                       bmap.set(r, u_r);
                                        block_rmap[l].get()[u_r] = r;
                                    }
-                                   else
-                                   {
-                                       u_r = riter->second;
-                                   }
                                    ub[l].get()[u] = u_r;
                                    return u;
                                }
@@ -254,17 +250,13 @@ void split_groups(boost::any& ab, boost::any& avc, boost::any& avmap,
 
             size_t u_r;
 
-            auto riter = bmap.find(r);
-            if (riter == bmap.end())
+            u_r = bmap.find(r);
+            if (u_r == bmap_t::null)
             {
                 u_r = bmap.size();
-                bmap[r] = u_r;
+                bmap.set(r, u_r);
                 brmap[u_r] = r;
             }
-            else
-            {
-                u_r = riter->second;
-            }
 
             ub_l[w] = u_r;
         }
@@ -375,28 +367,25 @@ bool bmap_has(const vbmap_t& bmap, size_t c, size_t r)
 {
     if (c > bmap.size())
         throw GraphException("invalid covariate value:" + lexical_cast<string>(c));
-    auto iter = bmap[c].find(r);
-    if (iter == bmap[c].end())
-        return false;
-    return true;
+    return bmap[c].has(r);
 }
 
 size_t bmap_get(const vbmap_t& bmap, size_t c, size_t r)
 {
     if (c > bmap.size())
         throw GraphException("invalid covariate value:" + lexical_cast<string>(c));
-    auto iter = bmap[c].find(r);
-    if (iter == bmap[c].end())
+    size_t r_u = bmap[c].find(r);
+    if (r_u == bmap_t::null)
         throw GraphException("no mapping for block " + lexical_cast<string>(r)
                              + " in layer " + lexical_cast<string>(c));
-    return iter->second;
+    return r_u;
 }
 
 void bmap_set(vbmap_t& bmap, size_t c, size_t r, size_t r_u)
 {
     if (c > bmap.size())
         throw GraphException("invalid covariate value:" + lexical_cast<string>(c));
-    bmap[c][r] = r_u;
+    bmap[c].set(r, r_u);
 }
 
 void bmap_del_c(vbmap_t& bmap, size_t c)
@@ -34,7 +34,39 @@ using namespace std;
 typedef eprop_map_t<int32_t>::type emap_t;
 typedef vprop_map_t<std::vector<int32_t>>::type vcvmap_t;
 
-typedef gt_hash_map<size_t, size_t> bmap_t;
+// Map from the blocks of the union state to the blocks of a layer, stored as a
+// dense array indexed by the union block label.
+class bmap_t
+{
+public:
+    static constexpr size_t null = std::numeric_limits<size_t>::max();
+
+    size_t find(size_t r) const
+    {
+        if (r >= _map.size())
+            return null;
+        return _map[r];
+    }
+
+    bool has(size_t r) const { return find(r) != null; }
+
+    void set(size_t r, size_t r_u)
+    {
+        if (r >= _map.size())
+            _map.resize(r + 1, size_t(null));
+        if (_map[r] == null)
+            _size++;
+        _map[r] = r_u;
+    }
+
+    // number of mapped blocks
+    size_t size() const { return _size; }
+
+private:
+    std::vector<size_t> _map;
+    size_t _size = 0;
+};
+
 typedef std::vector<bmap_t> vbmap_t;
 
 #define LAYERED_BLOCK_STATE_params                                             \
@@ -120,9 +152,8 @@ struct Layers
 
             size_t get_block_map(size_t r, bool put_new=true)
             {
-                size_t r_u;
-                auto iter = _block_map.find(r);
-                if (iter == _block_map.end())
+                size_t r_u = _block_map.find(r);
+                if (r_u == bmap_t::null)
                 {
                     if (_free_blocks.empty())
                         _free_blocks.push_back(_block_map.size());
@@ -133,7 +164,7 @@ struct Layers
 
                     if (put_new)
                     {
-                        _block_map[r] = r_u;
+                        _block_map.set(r, r_u);
                         _block_rmap[r_u] = r;
                         if (_lstate->_lcoupled_state != nullptr)
                         {
@@ -156,7 +187,6 @@ struct Layers
                 }
                 else
                 {
-                    r_u = iter->second;
                     assert(size_t(_block_rmap[r_u]) == r);
                     assert(_lstate->_lcoupled_state == nullptr ||
                            r_u == _lstate->_lcoupled_state->get_layer_node(_l, r));
@@ -167,7 +197,7 @@ struct Layers
 
             bool has_block_map(size_t r)
             {
-                return _block_map.find(r) != _block_map.end();
+                return _block_map.has(r);
             }
 
         };
@@ -224,6 +254,35 @@ struct Layers
         typename vc_t::checked_t _vc_c;
         typename vmap_t::checked_t _vmap_c;
         openmp_mutex _llock;
+        std::vector<size_t> _s_us;
+
+        // The move is also global if it changes the occupied blocks of any
+        // of the layers.
+        bool is_global_move(size_t v, size_t s)
+        {
+            if (BaseState::is_global_move(v, s))
+                return true;
+
+            if (BaseState::_vweight[v] == 0 || size_t(_b[v]) == s)
+                return false;
+
+            if (_lcoupled_state != nullptr)
+                return true;
+
+            auto& ls = _vc[v];
+            auto& vs = _vmap[v];
+            for (size_t j = 0; j < ls.size(); ++j)
+            {
+                auto& state = _layers[ls[j]];
+                size_t u = vs[j];
+                if (state._vweight[u] == 0)
+                    continue;
+                if (state.is_last(u) || !state.has_block_map(s) ||
+                    state._wr[state.get_block_map(s, false)] == 0)
+                    return true;
+            }
+            return false;
+        }
 
         void move_vertex(size_t v, size_t s)
         {
@@ -511,28 +570,58 @@ struct Layers
 
                 auto& ls = _vc[v];
                 auto& vs = _vmap[v];
+
+                // The layer blocks are looked up (and possibly created)
+                // first, so that the layers can be evaluated independently;
+                // if the vertex has enough edges, this is done in parallel,
+                // with each layer using its own move entries.
+                _s_us.resize(ls.size());
                 for (size_t j = 0; j < ls.size(); ++j)
                 {
-                    size_t l = ls[j];
+                    auto& state = _layers[ls[j]];
                     size_t u = vs[j];
-
-                    auto& state = _layers[l];
-
                     if (state._vweight[u] == 0)
                         continue;
-
-                    size_t s_u = (s != null_group) ?
+                    _s_us[j] = (s != null_group) ?
                         state.get_block_map(s, false) : null_group;
-                    size_t r_u = (r != null_group) ?
-                        state._b[u] : null_group;
-
                     assert(r == null_group || state.has_block_map(r));
-                    assert(r == null_group || r_u == state.get_block_map(r, false));
+                    assert(r == null_group ||
+                           size_t(state._b[u]) == state.get_block_map(r, false));
+                }
 
-                    if (_master && ea.adjacency)
-                        dS += virtual_move_covariate(u, r_u, s_u, state,
-                                                     m_entries, true);
-                    dS += state.virtual_move(u, r_u, s_u, lea, m_entries);
+                auto layer_dS = [&](size_t j, auto& m_entries)
+                    {
+                        auto& state = _layers[ls[j]];
+                        size_t u = vs[j];
+
+                        if (state._vweight[u] == 0)
+                            return 0.;
+
+                        size_t s_u = _s_us[j];
+                        size_t r_u = (r != null_group) ?
+                            state._b[u] : null_group;
+
+                        double ldS = 0;
+                        if (_master && ea.adjacency)
+                            ldS += virtual_move_covariate(u, r_u, s_u, state,
+                                                          m_entries, true);
+                        ldS += state.virtual_move(u, r_u, s_u, lea, m_entries);
+                        return ldS;
+                    };
+
+                if (ls.size() > 1 &&
+                    total_degreeS()(v, _g) > OPENMP_MIN_THRESH)
+                {
+                    double ldS = 0;
+                    #pragma omp parallel for schedule(runtime) reduction(+:ldS)
+                    for (size_t j = 0; j < ls.size(); ++j)
+                        ldS += layer_dS(j, _layers[ls[j]]._m_entries);
+                    dS += ldS;
+                }
+                else
+                {
+                    for (size_t j = 0; j < ls.size(); ++j)
+                        dS += layer_dS(j, m_entries);
                 }
             }
 
@@ -972,6 +1061,13 @@ struct Layers
             return true;
         }
 
+        void mark_modified()
+        {
+            BaseState::mark_modified();
+            if (_lcoupled_state != nullptr)
+                _lcoupled_state->mark_modified();
+        }
+
         bool check_layers()
         {
             scoped_lock lck(_llock);
@@ -100,6 +100,7 @@ void export_layered_overlap_blockmodel_state()
                           .def("entropy", &state_t::entropy)
                           .def("get_partition_dl", &state_t::get_partition_dl)
                           .def("get_deg_dl", &state_t::get_deg_dl)
+                          .def("get_mod_count", &state_t::get_mod_count)
                           .def("get_move_prob", get_move_prob)
                           .def("couple_state", couple_state)
                           .def("decouple_state",
@@ -77,7 +77,11 @@ multicanonical_layered_overlap_multiflip_sweep(python::object omulticanonical_st
                               (omulticanonical_state,
                                [&](auto& mc_state)
                                {
-                                   auto ret_ = mcmc_sweep(mc_state, rng);
+                                   std::pair<double, size_t> ret_;
+                                   {
+                                       GILRelease gil;
+                                       ret_ = mcmc_sweep(mc_state, rng);
+                                   }
                                    ret = python::make_tuple(ret_.first, ret_.second);
                                });
                       });
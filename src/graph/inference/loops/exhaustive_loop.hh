@@ -35,6 +35,10 @@ void exhaustive_sweep(ExhaustiveState& state, Callback&& callback)
     size_t B = state.get_B();
     size_t count = 0;
 
+    parallel_vertex_loop
+        (state._g,
+         [&](auto v){ state._b_min[v] = state.node_state(v); });
+
     callback(state);
     while (pos < vlist.size())
     {
@@ -42,8 +46,8 @@ void exhaustive_sweep(ExhaustiveState& state, Callback&& callback)
         size_t r = state.node_state(v);
         if (r < B - 1)
         {
-            S += state.virtual_move_dS(pos, r + 1);
-            state.perform_move(pos, r + 1);
+            S += state.virtual_move_dS(v, r + 1);
+            state.perform_move(v, r + 1);
             if (S < S_min)
             {
                 S_min = S;
@@ -59,8 +63,8 @@ void exhaustive_sweep(ExhaustiveState& state, Callback&& callback)
         }
         else
         {
-            S += state.virtual_move_dS(pos, 0);
-            state.perform_move(pos, 0);
+            S += state.virtual_move_dS(v, 0);
+            state.perform_move(v, 0);
             pos++;
         }
     }
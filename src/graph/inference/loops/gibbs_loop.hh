@@ -27,6 +27,7 @@
 
 #include "hash_map_wrap.hh"
 #include "../support/parallel_rng.hh"
+#include "../support/sweep_stats.hh"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -39,12 +40,15 @@ auto gibbs_sweep(GibbsState state, RNG& rng_)
 {
     auto& g = state._g;
 
-    vector<std::shared_ptr<RNG>> rngs;
     std::vector<std::pair<size_t, double>> best_move;
 
+    // in parallel mode, each vertex draws from a counter-based stream keyed by
+    // (seed, sweep, vertex), so that the results do not depend on the number
+    // of threads
+    uint64_t seed = 0;
     if (state._parallel)
     {
-        init_rngs(rngs, rng_);
+        seed = draw_seed(rng_);
         init_cache(state._E);
         best_move.resize(num_vertices(g));
     }
@@ -84,87 +88,115 @@ auto gibbs_sweep(GibbsState state, RNG& rng_)
             (vlist,
              [&](size_t, auto v)
              {
-                 auto& rng = get_rng(rngs, rng_);
-
-                 if (!state._sequential)
-                     v = uniform_sample(vlist, rng);
+                 auto sweep_vertex = [&](auto& rng)
+                 {
+                     if (!state._sequential)
+                         v = uniform_sample(vlist, rng);
 
-                 if (state.node_weight(v) == 0)
-                     return;
+                     if (state.node_weight(v) == 0)
+                         return;
 
-                 auto& moves = state.get_moves(v);
+                     SweepProbe probe;
+                     probe.start();
+                     auto& moves = state.get_moves(v);
+                     probe.lap(&sweep_stats_t::proposal_time);
+                     probe.count(&sweep_stats_t::proposals);
 
-                 nattempts += moves.size();
+                     nattempts += moves.size();
 
-                 probs.resize(moves.size());
-                 deltas.resize(moves.size());
-                 idx.resize(moves.size());
+                     probs.resize(moves.size());
+                     deltas.resize(moves.size());
+                     idx.resize(moves.size());
 
-                 double dS_min = numeric_limits<double>::max();
-                 for (size_t j = 0; j < moves.size(); ++j)
-                 {
-                     size_t s = moves[j];
-                     double dS = state.virtual_move_dS(v, s);
-                     dS_min = std::min(dS, dS_min);
-                     deltas[j] = dS;
-                     idx[j] = j;
-                 }
-
-                 if (!std::isinf(beta))
-                 {
+                     double dS_min = numeric_limits<double>::max();
                      for (size_t j = 0; j < moves.size(); ++j)
                      {
-                         if (std::isinf(deltas[j]))
-                             probs[j] = 0;
-                         else
-                             probs[j] = exp((-deltas[j] + dS_min) * beta);
+                         size_t s = moves[j];
+                         double dS = state.virtual_move_dS(v, s);
+                         dS_min = std::min(dS, dS_min);
+                         deltas[j] = dS;
+                         idx[j] = j;
+                         probe.add_dS(dS);
                      }
-                 }
-                 else
-                 {
-                     for (size_t j = 0; j < moves.size(); ++j)
-                         probs[j] = (deltas[j] == dS_min) ? 1 : 0;
-                 }
+                     probe.lap(&sweep_stats_t::dS_time);
 
-                 Sampler<size_t> sampler(idx, probs);
+                     if (!std::isinf(beta))
+                     {
+                         for (size_t j = 0; j < moves.size(); ++j)
+                         {
+                             if (std::isinf(deltas[j]))
+                                 probs[j] = 0;
+                             else
+                                 probs[j] = exp((-deltas[j] + dS_min) * beta);
+                         }
+                     }
+                     else
+                     {
+                         for (size_t j = 0; j < moves.size(); ++j)
+                             probs[j] = (deltas[j] == dS_min) ? 1 : 0;
+                     }
 
-                 size_t j = sampler.sample(rng);
+                     Sampler<size_t> sampler(idx, probs);
 
-                 assert(probs[j] > 0);
+                     size_t j = sampler.sample(rng);
+
+                     assert(probs[j] > 0);
+
+                     size_t s = moves[j];
+                     size_t r = state.node_state(v);
 
-                 size_t s = moves[j];
-                 size_t r = state.node_state(v);
+                     if (s == r)
+                     {
+                         probe.count(&sweep_stats_t::self_moves);
+                         return;
+                     }
 
-                 if (s == r)
-                     return;
+                     if (!state._parallel)
+                     {
+                         probe.start();
+                         state.perform_move(v, s, rng);
+                         probe.lap(&sweep_stats_t::move_time);
+                         probe.count(&sweep_stats_t::accepted);
+                         nmoves += state.node_weight(v);
+                         S += deltas[j];
+                     }
+                     else
+                     {
+                         best_move[v].first = s;
+                         best_move[v].second = deltas[j];
+                     }
+                 };
 
-                 if (!state._parallel)
+                 if (state._parallel)
                  {
-                     state.perform_move(v, s, rng);
-                     nmoves += state.node_weight(v);
-                     S += deltas[j];
+                     counter_rng rng(seed, iter, v);
+                     sweep_vertex(rng);
                  }
                  else
                  {
-                     best_move[v].first = s;
-                     best_move[v].second = deltas[j];
+                     sweep_vertex(rng_);
                  }
              });
 
         if (state._parallel)
         {
+            SweepProbe probe;
             for (auto v : vlist)
             {
                 auto s = best_move[v].first;
                 double dS = best_move[v].second;
                 if (dS != numeric_limits<double>::max())
                 {
+                    probe.start();
                     dS = state.virtual_move_dS(v, s);
+                    probe.lap(&sweep_stats_t::dS_time);
 
                     if (dS > 0 && std::isinf(beta))
                         continue;
 
-                    state.perform_move(v, s, get_rng(rngs, rng_));
+                    state.perform_move(v, s, rng_);
+                    probe.lap(&sweep_stats_t::move_time);
+                    probe.count(&sweep_stats_t::accepted);
                     nmoves++;
                     S += dS;
                 }
@@ -26,7 +26,10 @@
 #include <tuple>
 
 #include "hash_map_wrap.hh"
+#include "../generation/dynamic_sampler.hh"
 #include "../support/parallel_rng.hh"
+#include "../support/sweep_stats.hh"
+#include "graph_trace.hh"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -67,8 +70,11 @@ auto mcmc_sweep(MCMCState state, RNG& rng)
     double S = 0;
     size_t nmoves = 0;
 
+    SweepProbe probe;
+
     for (size_t iter = 0; iter < state.get_niter(); ++iter)
     {
+        GT_TRACE_PHASE("mcmc_sweep");
         if (state.is_sequential() && !state.is_deterministic())
             std::shuffle(vlist.begin(), vlist.end(), rng);
 
@@ -84,17 +90,32 @@ auto mcmc_sweep(MCMCState state, RNG& rng)
                 continue;
 
             auto r = state.node_state(v);
+
+            probe.start();
             auto s = state.move_proposal(v, rng);
+            probe.lap(&sweep_stats_t::proposal_time);
+            probe.count(&sweep_stats_t::proposals);
 
             if (s == null_group)
+            {
+                probe.count(&sweep_stats_t::null_moves);
                 continue;
+            }
+
+            if (s == r)
+                probe.count(&sweep_stats_t::self_moves);
 
             double dS, mP;
             std::tie(dS, mP) = state.virtual_move_dS(v, s);
+            probe.lap(&sweep_stats_t::dS_time);
+            probe.add_dS(dS);
 
             if (metropolis_accept(dS, mP, beta, rng))
             {
+                probe.start();
                 state.perform_move(v, s);
+                probe.lap(&sweep_stats_t::move_time);
+                probe.count(&sweep_stats_t::accepted);
                 nmoves += state.node_weight(v);
                 S += dS;
             }
@@ -112,83 +133,455 @@ auto mcmc_sweep(MCMCState state, RNG& rng)
 }
 
 
+// Sweep where the vertices are sampled with probabilities proportional to
+// their recent activity. The activity of a vertex is set to one when it or one
+// of its neighbors is moved, and is halved whenever a move attempt of the
+// vertex is rejected, so that frozen vertices are visited at a rate that
+// decreases geometrically towards the minimum weight _min_weight, relative to
+// the vertices at the boundaries of the groups that are still changing. The
+// activities are kept in _activity between calls.
+//
+// With _schedule == sweep_schedule::ADAPTIVE the sampling weights are only
+// updated at the end of each sweep, so that within a sweep the vertex
+// selection does not depend on the current state, and each move satisfies
+// detailed balance. With sweep_schedule::GREEDY, the weights are updated
+// immediately after every move attempt.
+
+// the enumerators are kept in their own namespace, since e.g. UNIFORM is also
+// used by deg_dl_kind
+namespace sweep_schedule
+{
+enum { UNIFORM = 0, ADAPTIVE, GREEDY };
+}
+
 template <class MCMCState, class RNG>
-auto mcmc_sweep_parallel(MCMCState state, RNG& rng_)
+auto mcmc_sweep_weighted(MCMCState state, RNG& rng)
 {
     auto& g = state._g;
+    auto& vlist = state.get_vlist();
+    auto beta = state.get_beta();
+    auto& activity = state._activity;
+    double min_weight = state._min_weight;
+    bool greedy = (state._schedule == sweep_schedule::GREEDY);
+
+    if (activity.size() < num_vertices(g))
+        activity.resize(num_vertices(g), 1.);
+
+    std::vector<size_t> vidx(num_vertices(g),
+                             std::numeric_limits<size_t>::max());
+    std::vector<double> ws(vlist.size());
+    for (size_t i = 0; i < vlist.size(); ++i)
+    {
+        auto v = vlist[i];
+        vidx[v] = i;
+        ws[i] = min_weight + activity[v];
+    }
+    DynamicSampler<size_t> sampler(vlist, ws);
+
+    std::vector<size_t> modified;
+    auto set_activity = [&](size_t v, double a)
+        {
+            if (activity[v] == a)
+                return;
+            activity[v] = a;
+            if (vidx[v] == std::numeric_limits<size_t>::max())
+                return;
+            if (greedy)
+                sampler.update(vidx[v], min_weight + a);
+            else
+                modified.push_back(v);
+        };
+    auto cool = [&](size_t v)
+        {
+            double a = activity[v] / 2;
+            set_activity(v, (a < 1e-6) ? 0. : a);
+        };
+
+    double S = 0;
+    size_t nmoves = 0;
+
+    SweepProbe probe;
+
+    for (size_t iter = 0; iter < state.get_niter(); ++iter)
+    {
+        for (size_t vi = 0; vi < vlist.size(); ++vi)
+        {
+            size_t v = sampler.sample(rng);
+
+            if (state.skip_node(v))
+                continue;
+
+            auto r = state.node_state(v);
+
+            probe.start();
+            auto s = state.move_proposal(v, rng);
+            probe.lap(&sweep_stats_t::proposal_time);
+            probe.count(&sweep_stats_t::proposals);
+
+            if (s == null_group)
+            {
+                probe.count(&sweep_stats_t::null_moves);
+                cool(v);
+                continue;
+            }
+
+            if (s == r)
+                probe.count(&sweep_stats_t::self_moves);
+
+            double dS, mP;
+            std::tie(dS, mP) = state.virtual_move_dS(v, s);
+            probe.lap(&sweep_stats_t::dS_time);
+            probe.add_dS(dS);
+
+            bool moved = false;
+            if (metropolis_accept(dS, mP, beta, rng))
+            {
+                probe.start();
+                state.perform_move(v, s);
+                probe.lap(&sweep_stats_t::move_time);
+                probe.count(&sweep_stats_t::accepted);
+                nmoves += state.node_weight(v);
+                S += dS;
+                moved = (s != r);
+            }
+
+            if (moved)
+            {
+                set_activity(v, 1.);
+                for (auto u : all_neighbors_range(v, g))
+                    set_activity(u, 1.);
+            }
+            else
+            {
+                cool(v);
+            }
+
+            if (state._verbose)
+                cout << v << ": " << r << " -> " << s << " " << S << endl;
+        }
 
-    vector<std::shared_ptr<RNG>> rngs;
-    std::vector<std::pair<size_t, double>> best_move;
+        for (auto v : modified)
+            sampler.update(vidx[v], min_weight + activity[v]);
+        modified.clear();
+    }
+    return make_pair(S, nmoves);
+}
+
+// Parallel sweep, where the vertices are split into batches of non-adjacent
+// vertices, given by a greedy coloring of the graph, which are visited in
+// order. The moves of the vertices in a batch are proposed and evaluated in
+// parallel, without locks, against the state left by the previous batches, and
+// are then committed in order. A move that shares a block with a move already
+// committed in the same batch, or that comes after a move that changes the
+// number of occupied blocks, is evaluated again before it is accepted or
+// rejected, since its entropy difference may have changed. The sweep is then
+// equivalent to a sequential one in batch order, except that the proposals are
+// made with the state at the start of each batch.
+template <class MCMCState, class RNG>
+auto mcmc_sweep_parallel(MCMCState state, RNG& rng_)
+{
+    auto& g = state._g;
 
-    init_rngs(rngs, rng_);
     init_cache(state._E);
-    best_move.resize(num_vertices(g));
 
     auto& vlist = state._vlist;
     auto& beta = state._beta;
 
+    // proposals draw from a counter-based stream keyed by (seed, sweep,
+    // vertex), so that they do not depend on the number of threads
+    uint64_t seed = draw_seed(rng_);
+
+    // greedy coloring; mark[c] == v if color c is used by a neighbor of v
+    std::vector<std::vector<size_t>> batches;
+    {
+        std::vector<size_t> color(num_vertices(g), null_group);
+        std::vector<size_t> mark;
+        for (auto v : vlist)
+        {
+            for (auto u : all_neighbors_range(v, g))
+            {
+                size_t c = color[u];
+                if (c < mark.size())
+                    mark[c] = v;
+            }
+            size_t c = 0;
+            while (c < mark.size() && mark[c] == v)
+                ++c;
+            if (c == mark.size())
+            {
+                mark.push_back(null_group);
+                batches.emplace_back();
+            }
+            color[v] = c;
+            batches[c].push_back(v);
+        }
+    }
+
+    // proposed move, entropy difference and acceptance
+    std::vector<std::tuple<size_t, double, bool>> moves;
+    gt_hash_set<size_t> touched;
 
     double S = 0;
     size_t nmoves = 0;
 
     for (size_t iter = 0; iter < state._niter; ++iter)
     {
-        parallel_loop(vlist,
-                      [&](size_t, auto v)
-                      {
-                          best_move[v] =
-                              std::make_pair(state.node_state(v),
-                                             numeric_limits<double>::max());
-                      });
-
-        #pragma omp parallel firstprivate(state)
-        parallel_loop_no_spawn
-            (vlist,
-             [&](size_t, auto v)
-             {
-                 auto& rng = get_rng(rngs, rng_);
-
-                 if (state.node_weight(v) == 0)
-                     return;
-
-                 auto r = state.node_state(v);
-
-                 decltype(r) s;
-                 #pragma omp critical (mcmc_move_proposal)
+        for (auto& batch : batches)
+        {
+            state.init_parallel_batch();
+            moves.resize(batch.size());
+
+            #pragma omp parallel firstprivate(state) \
+                if (batch.size() > OPENMP_MIN_THRESH)
+            parallel_loop_no_spawn
+                (batch,
+                 [&](size_t i, auto v)
                  {
-                      s = state.move_proposal(v, rng);
-                 }
+                     counter_rng rng(seed, iter, v);
+                     auto& m = moves[i];
+                     get<0>(m) = null_group;
+
+                     if (state.skip_node(v))
+                         return;
+
+                     SweepProbe probe;
+                     probe.start();
+                     auto s = state.move_proposal(v, rng);
+                     probe.lap(&sweep_stats_t::proposal_time);
+                     probe.count(&sweep_stats_t::proposals);
+
+                     if (s == null_group)
+                     {
+                         probe.count(&sweep_stats_t::null_moves);
+                         return;
+                     }
+
+                     if (s == state.node_state(v))
+                         probe.count(&sweep_stats_t::self_moves);
+
+                     double dS, mP;
+                     std::tie(dS, mP) = state.virtual_move_dS(v, s);
+                     probe.lap(&sweep_stats_t::dS_time);
+                     probe.add_dS(dS);
+                     m = std::make_tuple(s, dS,
+                                         metropolis_accept(dS, mP, beta, rng));
+                 });
+
+            SweepProbe probe;
+            touched.clear();
+            bool global = false;
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                size_t v = batch[i];
+                size_t s;
+                double dS;
+                bool accept;
+                std::tie(s, dS, accept) = moves[i];
 
-                 if (s == null_group)
-                     return;
+                if (s == null_group)
+                    continue;
 
-                 double dS, mP;
-                 std::tie(dS, mP) = state.virtual_move_dS(v, s);
+                bool stale = global;
+                if (!stale)
+                {
+                    state.for_each_move_block
+                        (v, s,
+                         [&](size_t r)
+                         {
+                             if (touched.find(r) != touched.end())
+                                 stale = true;
+                         });
+                }
+
+                if (stale)
+                {
+                    if (!state.check_proposal(v, s))
+                        continue;
+                    double mP;
+                    probe.start();
+                    std::tie(dS, mP) = state.virtual_move_dS(v, s);
+                    probe.lap(&sweep_stats_t::dS_time);
+                    accept = metropolis_accept(dS, mP, beta, rng_);
+                }
+
+                if (!accept)
+                    continue;
 
-                 if (metropolis_accept(dS, mP, beta, rng))
-                 {
-                     best_move[v].first = s;
-                     best_move[v].second = dS;
-                 }
+                auto r = state.node_state(v);
+                if (state.is_global_move(v, s))
+                    global = true;
+                state.for_each_move_block(v, s,
+                                          [&](size_t t) { touched.insert(t); });
 
-                 if (state._verbose)
-                     cout << v << ": " << r << " -> " << s << " " << S << endl;
-             });
+                probe.start();
+                state.perform_move(v, s);
+                probe.lap(&sweep_stats_t::move_time);
+                probe.count(&sweep_stats_t::accepted);
+                nmoves += state.node_weight(v);
+                S += dS;
 
-        for (auto v : vlist)
+                if (state._verbose)
+                    cout << v << ": " << r << " -> " << s << " " << S << endl;
+            }
+        }
+    }
+    return make_pair(S, nmoves);
+}
+
+
+// Parallel sweep over groups of vertices, used for the merge-split moves of
+// the multiflip sampler. The groups are visited in random order, in batches,
+// and the moves of each batch are proposed and evaluated in parallel against
+// the state at the start of the batch, without modifying it, and are then
+// committed in order. As in mcmc_sweep_parallel(), a move that involves a
+// block touched by a move already committed in the same batch, or that comes
+// after a move that changes the number of occupied blocks, is evaluated again
+// before it is accepted or rejected. Moves that can only be evaluated by
+// performing them are deferred to the commit phase.
+template <class MCMCState, class RNG>
+auto mcmc_sweep_parallel_groups(MCMCState& state, RNG& rng_)
+{
+    typedef typename MCMCState::move_t move_t;
+
+    auto vlist = state.get_vlist();
+    auto beta = state.get_beta();
+
+    uint64_t seed = draw_seed(rng_);
+
+    // proposed move, entropy difference, acceptance, and whether it has been
+    // evaluated
+    std::vector<std::tuple<size_t, double, bool, bool>> moves;
+    std::vector<move_t> proposals;
+    gt_hash_set<size_t> touched;
+
+    double S = 0;
+    size_t nmoves = 0;
+
+    size_t nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    size_t batch_size = 4 * nthreads;
+
+    for (size_t iter = 0; iter < state.get_niter(); ++iter)
+    {
+        vlist = state.get_vlist();
+        std::shuffle(vlist.begin(), vlist.end(), rng_);
+
+        for (size_t pos = 0; pos < vlist.size(); pos += batch_size)
         {
-            auto s = best_move[v].first;
-            double dS = best_move[v].second;
-            if (dS != numeric_limits<double>::max())
+            size_t end = std::min(pos + batch_size, vlist.size());
+            size_t n = end - pos;
+
+            state.init_parallel_batch();
+            moves.resize(n);
+            proposals.resize(n);
+
+            #pragma omp parallel if (n > 1)
             {
-                auto ddS = state.virtual_move_dS(v, s);
+                auto m_entries = state.make_m_entries();
+
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < n; ++i)
+                {
+                    size_t r = vlist[pos + i];
+                    counter_rng rng(seed, iter, r);
+                    auto& m = moves[i];
+                    get<0>(m) = null_group;
+
+                    if (state.skip_node(r))
+                        continue;
+
+                    SweepProbe probe;
+                    probe.start();
+                    auto& move = proposals[i];
+                    auto s = state.move_proposal(r, rng, move);
+                    probe.lap(&sweep_stats_t::proposal_time);
+                    probe.count(&sweep_stats_t::proposals);
+
+                    if (s == null_group)
+                    {
+                        probe.count(&sweep_stats_t::null_moves);
+                        continue;
+                    }
+
+                    if (!state.is_parallel_safe(move))
+                    {
+                        m = std::make_tuple(s, 0., false, false);
+                        continue;
+                    }
+
+                    double dS, mP;
+                    std::tie(dS, mP) = state.virtual_move_dS(r, s, move,
+                                                             m_entries);
+                    probe.lap(&sweep_stats_t::dS_time);
+                    probe.add_dS(dS);
+                    m = std::make_tuple(s, dS,
+                                        metropolis_accept(dS, mP, beta, rng),
+                                        true);
+                }
+            }
 
-                if (get<0>(ddS) > 0 && std::isinf(beta))
+            SweepProbe probe;
+            touched.clear();
+            bool global = false;
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t r = vlist[pos + i];
+                size_t s;
+                double dS;
+                bool accept, evaluated;
+                std::tie(s, dS, accept, evaluated) = moves[i];
+
+                if (s == null_group)
                     continue;
 
-                state.perform_move(v, s);
-                nmoves++;
-                S += get<0>(ddS);
+                auto& move = proposals[i];
+
+                bool stale = global || !evaluated;
+                if (!stale)
+                {
+                    state.for_each_move_block
+                        (r, s, move,
+                         [&](size_t t)
+                         {
+                             if (touched.find(t) != touched.end())
+                                 stale = true;
+                         });
+                }
+
+                if (stale)
+                {
+                    if (!state.check_proposal(r, s, move))
+                        continue;
+                    double mP;
+                    probe.start();
+                    std::tie(dS, mP) = state.virtual_move_dS(r, s, move,
+                                                             state._m_entries);
+                    probe.lap(&sweep_stats_t::dS_time);
+                    if (!evaluated)
+                        probe.add_dS(dS);
+                    accept = metropolis_accept(dS, mP, beta, rng_);
+                }
+
+                if (!accept)
+                    continue;
+
+                if (state.is_global_move(r, s, move))
+                    global = true;
+                state.for_each_move_block(r, s, move,
+                                          [&](size_t t) { touched.insert(t); });
+
+                probe.start();
+                state.perform_move(r, s, move);
+                probe.lap(&sweep_stats_t::move_time);
+                probe.count(&sweep_stats_t::accepted);
+                nmoves += state.node_weight(r, move);
+                S += dS;
+
+                if (state._verbose)
+                    cout << r << " -> " << s << " (" << move.vs.size()
+                         << ") " << S << endl;
             }
         }
     }
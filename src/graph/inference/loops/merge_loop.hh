@@ -27,6 +27,7 @@
 
 #include "hash_map_wrap.hh"
 #include "../support/parallel_rng.hh"
+#include "../support/sweep_stats.hh"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -37,12 +38,12 @@ namespace graph_tool
 template <class MergeState, class RNG>
 auto merge_sweep(MergeState state, RNG& rng_)
 {
-    vector<std::shared_ptr<RNG>> rngs;
     if (state._parallel)
-    {
-        init_rngs(rngs, rng_);
         init_cache(state._E);
-    }
+
+    // candidates draw from a counter-based stream keyed by (seed, vertex), so
+    // that they do not depend on the number of threads
+    uint64_t seed = draw_seed(rng_);
 
     typedef std::tuple<size_t, size_t, double> merge_t;
 
@@ -57,24 +58,36 @@ auto merge_sweep(MergeState state, RNG& rng_)
         (state._available,
          [&](size_t, auto v)
          {
-             auto& rng = get_rng(rngs, rng_);
+             counter_rng rng(seed, v);
 
              if (state.node_weight(v) == 0)
                  return;
 
              gt_hash_set<size_t> past_moves;
+             SweepProbe probe;
 
              auto find_candidates = [&](bool random)
                  {
                      for (size_t iter = 0; iter < state._niter; ++iter)
                      {
+                         probe.start();
                          auto s = state.move_proposal(v, random, rng);
+                         probe.lap(&sweep_stats_t::proposal_time);
+                         probe.count(&sweep_stats_t::proposals);
                          if (s == state._null_move)
+                         {
+                             probe.count(&sweep_stats_t::null_moves);
                              continue;
+                         }
                          if (past_moves.find(s) != past_moves.end())
+                         {
+                             probe.count(&sweep_stats_t::self_moves);
                              continue;
+                         }
                          past_moves.insert(s);
                          double dS = state.virtual_move_dS(v, s);
+                         probe.lap(&sweep_stats_t::dS_time);
+                         probe.add_dS(dS);
                          if (dS < get<2>(best_merge[v]))
                              best_merge[v] = make_tuple(v, s, dS);
                      }
@@ -99,6 +112,8 @@ auto merge_sweep(MergeState state, RNG& rng_)
     for (auto& merge : best_merge)
         queue.push(merge);
 
+    SweepProbe probe;
+
     double S = 0;
     size_t nmerges = 0;
     while (nmerges != state._nmerges && !queue.empty())
@@ -111,7 +126,9 @@ auto merge_sweep(MergeState state, RNG& rng_)
         double dS = get<2>(merge);
         if (v == s || dS == numeric_limits<double>::max())
             continue;
+        probe.start();
         double ndS = state.virtual_move_dS(v, s);
+        probe.lap(&sweep_stats_t::dS_time);
         if (!queue.empty() && ndS > get<2>(queue.top()))
         {
             get<2>(merge) = ndS;
@@ -121,7 +138,10 @@ auto merge_sweep(MergeState state, RNG& rng_)
         if (state._verbose)
             cout << "merging " << v << " -> " << s << " : "
                  << dS << " " << ndS << endl;
+        probe.start();
         state.perform_merge(v, s);
+        probe.lap(&sweep_stats_t::move_time);
+        probe.count(&sweep_stats_t::accepted);
         S += ndS;
         nmerges++;
     }
@@ -161,6 +161,7 @@ public:
     template <bool Add, class MOP, class EOP>
     void modify_vertex(size_t v, size_t r, MOP&& mop, EOP&& eop)
     {
+        mark_modified();
         auto u = _overlap_stats.get_out_neighbor(v);
         if (u != _overlap_stats._null)
         {
@@ -1084,6 +1085,14 @@ public:
         return _overlap_stats.virtual_remove_size(v, r) == 0;
     }
 
+    bool is_global_move(size_t v, size_t nr)
+    {
+        size_t r = _b[v];
+        if (r == nr)
+            return false;
+        return (_coupled_state != nullptr || is_last(v) || _wr[nr] == 0);
+    }
+
     size_t node_weight(size_t)
     {
         return 1;
@@ -1260,26 +1269,39 @@ public:
     double get_parallel_entropy() const
     {
         double S = 0;
-        for (const auto& h : _overlap_stats.get_parallel_bundles())
+        for (const auto& x : _overlap_stats.get_parallel_bundles())
         {
-            for (const auto& kc : h)
+            auto m = x.count;
+            if (m == 0)
+                continue;
+            if (x.is_loop)
             {
-                bool is_loop = get<2>(kc.first);
-                auto m = kc.second;
-                if (is_loop)
-                {
-                    assert(m % 2 == 0);
-                    S += lgamma_fast(m/2 + 1) + m * log(2) / 2;
-                }
-                else
-                {
-                    S += lgamma_fast(m + 1);
-                }
+                assert(m % 2 == 0);
+                S += lgamma_fast(m/2 + 1) + m * log(2) / 2;
+            }
+            else
+            {
+                S += lgamma_fast(m + 1);
             }
         }
         return S;
     }
 
+    // Number of modifications of the state so far (see
+    // BlockState::get_mod_count()).
+    size_t get_mod_count()
+    {
+        return _mod_count;
+    }
+
+    void mark_modified()
+    {
+        #pragma omp atomic
+        _mod_count++;
+        if (_coupled_state != nullptr)
+            _coupled_state->mark_modified();
+    }
+
     void enable_partition_stats()
     {
         if (_partition_stats.empty())
@@ -1615,6 +1637,8 @@ public:
     BlockStateVirtualBase* _coupled_state;
     entropy_args_t _coupled_entropy_args;
 
+    size_t _mod_count = 0;
+
     openmp_mutex _lock;
 };
 
@@ -63,7 +63,11 @@ python::object multicanonical_overlap_multiflip_sweep(python::object omulticanon
                          (omulticanonical_state,
                           [&](auto& mc_state)
                           {
-                              auto ret_ = mcmc_sweep(mc_state, rng);
+                              std::pair<double, size_t> ret_;
+                              {
+                                  GILRelease gil;
+                                  ret_ = mcmc_sweep(mc_state, rng);
+                              }
                               ret = python::make_tuple(ret_.first, ret_.second);
                           });
                  });
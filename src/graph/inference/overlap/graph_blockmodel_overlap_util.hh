@@ -76,6 +76,7 @@ public:
 
         // parallel edges
         _mi.resize(num_vertices(g), -1);
+        _bundle_offset.push_back(0);
 
         for (size_t i = 0; i < _N; ++i)
         {
@@ -96,18 +97,22 @@ public:
             {
                 if (uc.second.size() > 1)
                 {
-                    _parallel_bundles.resize(_parallel_bundles.size() + 1);
-                    auto& h = _parallel_bundles.back();
+                    // a bundle of k edges has at most k distinct entries
+                    size_t m = _bundle_offset.size() - 1;
+                    _bundles.resize(_bundles.size() + uc.second.size());
+                    _bundle_offset.push_back(_bundles.size());
                     for (auto u : uc.second)
                     {
                         auto w = _out_neighbors[u];
                         assert(w != _null);
-                        _mi[u] = _mi[w] = _parallel_bundles.size() - 1;
+                        _mi[u] = _mi[w] = m;
                         size_t r = b[u];
                         size_t s = b[w];
                         if (!graph_tool::is_directed(g) && r > s)
                             std::swap(r, s);
-                        h[std::make_tuple(r, s, !graph_tool::is_directed(g) && u == w)]++;
+                        get_bundle_count(m, r, s,
+                                         !graph_tool::is_directed(g) &&
+                                         u == w, true)++;
                     }
                 }
             }
@@ -141,10 +146,10 @@ public:
                 r = v_r;
                 s = b[u];
             }
-            auto& h = _parallel_bundles[m];
             if (!graph_tool::is_directed(g) && r > s)
                 std::swap(r, s);
-            h[std::make_tuple(r, s, !graph_tool::is_directed(g) && u == v)]++;
+            get_bundle_count(m, r, s, !graph_tool::is_directed(g) && u == v,
+                             true)++;
         }
     }
 
@@ -178,14 +183,12 @@ public:
                 r = v_r;
                 s = b[u];
             }
-            auto& h = _parallel_bundles[m];
             if (!graph_tool::is_directed(g) && r > s)
                 std::swap(r, s);
-            auto iter = h.find(std::make_tuple(r, s, !graph_tool::is_directed(g) && u == v));
-            assert(iter->second > 0);
-            iter->second--;
-            if (iter->second == 0)
-                h.erase(iter);
+            auto& c = get_bundle_count(m, r, s,
+                                       !graph_tool::is_directed(g) && u == v);
+            assert(c > 0);
+            c--;
         }
     }
 
@@ -284,19 +287,9 @@ public:
         if (!graph_tool::is_directed(g) && nr > ns)
             std::swap(nr, ns);
 
-        auto& h = _parallel_bundles[m];
-
-        auto get_h = [&](const std::tuple<size_t, size_t, bool>& k) -> int
-            {
-                const auto iter = h.find(k);
-                if (iter == h.end())
-                    return 0;
-                return iter->second;
-            };
-
         bool is_loop = !graph_tool::is_directed(g) && u == v;
-        int c  = get_h(std::make_tuple(r,  s, is_loop));
-        int nc = get_h(std::make_tuple(nr, ns, is_loop));
+        int c  = find_bundle_count(m, r, s, is_loop);
+        int nc = find_bundle_count(m, nr, ns, is_loop);
 
         assert(c > 0);
         assert(nc >= 0);
@@ -328,9 +321,19 @@ public:
     auto get_in_neighbor(size_t v) const { return _in_neighbors[v]; }
 
 
-    typedef gt_hash_map<std::tuple<size_t, size_t, bool>, int> phist_t;
+    // Parallel edge bundles are stored as flat index ranges: the entries of
+    // bundle m, i.e. the number of its edges between each pair of blocks, are
+    // kept in _bundles[_bundle_offset[m]:_bundle_offset[m + 1]], with one slot
+    // per edge of the bundle. Unused slots have a zero count.
+    struct bundle_entry_t
+    {
+        uint32_t r = 0;
+        uint32_t s = 0;
+        int32_t count = 0;
+        bool is_loop = false;
+    };
 
-    const vector<phist_t>& get_parallel_bundles() const { return _parallel_bundles; }
+    const vector<bundle_entry_t>& get_parallel_bundles() const { return _bundles; }
     const vector<int>& get_mi() const { return _mi; }
 
     size_t get_N() const { return _N; }
@@ -356,8 +359,45 @@ private:
     vector<size_t> _in_neighbors;
 
 
+    int find_bundle_count(size_t m, size_t r, size_t s, bool is_loop) const
+    {
+        for (size_t i = _bundle_offset[m]; i < _bundle_offset[m + 1]; ++i)
+        {
+            auto& x = _bundles[i];
+            if (x.count > 0 && x.r == r && x.s == s && x.is_loop == is_loop)
+                return x.count;
+        }
+        return 0;
+    }
+
+    // count of the given entry in bundle m, which is created in a free slot if
+    // it does not exist and insert == true
+    int32_t& get_bundle_count(size_t m, size_t r, size_t s, bool is_loop,
+                              bool insert = false)
+    {
+        bundle_entry_t* free = nullptr;
+        for (size_t i = _bundle_offset[m]; i < _bundle_offset[m + 1]; ++i)
+        {
+            auto& x = _bundles[i];
+            if (x.count == 0)
+            {
+                if (free == nullptr)
+                    free = &x;
+                continue;
+            }
+            if (x.r == r && x.s == s && x.is_loop == is_loop)
+                return x.count;
+        }
+        assert(insert && free != nullptr);
+        free->r = r;
+        free->s = s;
+        free->is_loop = is_loop;
+        return free->count;
+    }
+
     vector<int> _mi;
-    vector<phist_t> _parallel_bundles; // parallel edge bundles
+    vector<bundle_entry_t> _bundles;   // parallel edge bundles
+    vector<size_t> _bundle_offset;
 };
 
 
@@ -22,69 +22,69 @@ namespace graph_tool
 
 using namespace std;
 
-vector<double> __safelog_cache;
-vector<double> __xlogx_cache;
-vector<double> __lgamma_cache;
+segmented_cache::~segmented_cache()
+{
+    for (auto& c : _chunks)
+        delete[] c.load();
+}
 
-void init_safelog(size_t x)
+void segmented_cache::init(size_t x)
 {
-    #pragma omp critical (_safelog_)
+    size_t K = chunk(x + 1);
+    for (size_t k = 0; k <= K; ++k)
     {
-        size_t old_size = __safelog_cache.size();
-        if (x >= old_size)
-        {
-            __safelog_cache.resize(x + 1);
-            for (size_t i = old_size; i < __safelog_cache.size(); ++i)
-                __safelog_cache[i] = safelog(double(i));
-        }
+        if (_chunks[k].load(std::memory_order_acquire) != nullptr)
+            continue;
+
+        // values for x in [2^k - 1, 2^(k+1) - 1)
+        size_t n = size_t(1) << k;
+        double* c = new double[n];
+        #pragma omp parallel for schedule(runtime) if (n > OPENMP_MIN_THRESH)
+        for (size_t j = 0; j < n; ++j)
+            c[j] = _f(n - 1 + j);
+
+        // another thread may have published the same chunk meanwhile
+        double* null = nullptr;
+        if (!_chunks[k].compare_exchange_strong(null, c,
+                                                std::memory_order_acq_rel))
+            delete[] c;
     }
 }
 
-void clear_safelog()
+static double get_safelog(size_t x)
 {
-    vector<double>().swap(__safelog_cache);
+    return safelog(double(x));
 }
 
+static double get_xlogx(size_t x)
+{
+    return x * safelog(double(x));
+}
 
-void init_xlogx(size_t x)
+static double get_lgamma(size_t x)
 {
-    #pragma omp critical (_xlogx_)
-    {
-        size_t old_size = __xlogx_cache.size();
-        if (x >= old_size)
-        {
-            __xlogx_cache.resize(x + 1);
-            for (size_t i = old_size; i < __xlogx_cache.size(); ++i)
-                __xlogx_cache[i] = i * safelog(i);
-        }
-    }
+    if (x == 0)
+        return numeric_limits<double>::infinity();
+    return lgamma(x);
 }
 
-void clear_xlogx()
+segmented_cache __safelog_cache(get_safelog);
+segmented_cache __xlogx_cache(get_xlogx);
+segmented_cache __lgamma_cache(get_lgamma);
+
+void init_safelog(size_t x)
 {
-    vector<double>().swap(__xlogx_cache);
+    __safelog_cache.init(x);
 }
 
-void init_lgamma(size_t x)
+void init_xlogx(size_t x)
 {
-    #pragma omp critical (_lgamma_)
-    {
-        size_t old_size = __lgamma_cache.size();
-        if (x >= old_size)
-        {
-            __lgamma_cache.resize(x + 1);
-            if (old_size == 0)
-                __lgamma_cache[0] = numeric_limits<double>::infinity();
-            for (size_t i = std::max(old_size, size_t(1));
-                 i < __lgamma_cache.size(); ++i)
-                __lgamma_cache[i] = lgamma(i);
-        }
-    }
+    __xlogx_cache.init(x);
 }
 
-void clear_lgamma()
+void init_lgamma(size_t x)
 {
-    vector<double>().swap(__lgamma_cache);
+    __lgamma_cache.init(x);
 }
 
 void init_cache(size_t E)
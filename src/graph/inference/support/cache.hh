@@ -22,6 +22,8 @@
 
 #include <vector>
 #include <cmath>
+#include <atomic>
+#include <limits>
 
 #include <boost/math/special_functions/gamma.hpp>
 
@@ -31,10 +33,51 @@ using namespace std;
 
 // Repeated computation of x*log(x) and log(x) actually adds up to a lot of
 // time. A significant speedup can be made by caching pre-computed values.
+//
+// The values are stored in chunks of increasing powers of two, which are never
+// moved once allocated: chunk k holds the values for x + 1 in [2^k, 2^(k+1)).
+// The chunks are published via atomic pointers, so that lookups need no
+// locking, and are safe while other threads extend the cache.
 
-extern vector<double> __safelog_cache;
-extern vector<double> __xlogx_cache;
-extern vector<double> __lgamma_cache;
+class segmented_cache
+{
+public:
+    typedef double (*func_t)(size_t);
+
+    constexpr segmented_cache(func_t f) : _f(f), _chunks() {}
+    ~segmented_cache();
+
+    // pointer to the cached value for x, or nullptr if it is not yet there
+    const double* find(size_t x) const
+    {
+        size_t i = x + 1;
+        size_t k = chunk(i);
+        const double* c = _chunks[k].load(std::memory_order_acquire);
+        if (c == nullptr)
+            return nullptr;
+        return c + (i - (size_t(1) << k));
+    }
+
+    // computes all the chunks up to the one containing x, in parallel
+    void init(size_t x);
+
+private:
+    static size_t chunk(size_t i)
+    {
+        return std::numeric_limits<unsigned long long>::digits - 1 -
+            __builtin_clzll(i);
+    }
+
+    static constexpr size_t _max_chunks =
+        std::numeric_limits<size_t>::digits;
+
+    func_t _f;
+    std::atomic<double*> _chunks[_max_chunks];
+};
+
+extern segmented_cache __safelog_cache;
+extern segmented_cache __xlogx_cache;
+extern segmented_cache __lgamma_cache;
 
 void init_safelog(size_t x);
 
@@ -48,9 +91,13 @@ inline double safelog(Type x)
 
 inline double safelog(size_t x)
 {
-    if (x >= __safelog_cache.size())
+    auto val = __safelog_cache.find(x);
+    if (val == nullptr)
+    {
         init_safelog(x);
-    return __safelog_cache[x];
+        val = __safelog_cache.find(x);
+    }
+    return *val;
 }
 
 void init_xlogx(size_t x);
@@ -58,9 +105,13 @@ void init_xlogx(size_t x);
 inline double xlogx(size_t x)
 {
     //return x * safelog(x);
-    if (x >= __xlogx_cache.size())
+    auto val = __xlogx_cache.find(x);
+    if (val == nullptr)
+    {
         init_xlogx(x);
-    return __xlogx_cache[x];
+        val = __xlogx_cache.find(x);
+    }
+    return *val;
 }
 
 void init_lgamma(size_t x);
@@ -68,9 +119,13 @@ void init_lgamma(size_t x);
 inline double lgamma_fast(size_t x)
 {
     //return lgamma(x);
-    if (x >= __lgamma_cache.size())
+    auto val = __lgamma_cache.find(x);
+    if (val == nullptr)
+    {
         init_lgamma(x);
-    return __lgamma_cache[x];
+        val = __lgamma_cache.find(x);
+    }
+    return *val;
 }
 
 void init_cache(size_t E);
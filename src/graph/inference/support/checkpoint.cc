@@ -0,0 +1,134 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_tool.hh"
+
+#include <boost/python.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+// Binary checkpoints of inference state.
+//
+// The file starts with an 8-byte magic string and the number of sections, as
+// a 64-bit integer. Each section consists of its name and its numpy dtype
+// string (each preceded by its length), its size in bytes, and the raw data,
+// which is aligned to 16 bytes from the start of the file, so that it can be
+// memory-mapped and viewed in place. All integers are in native byte order.
+//
+// The sections are copied when write() is called, and are written by a
+// background thread to a temporary file, which then replaces the destination,
+// so that an interrupted write never corrupts a previous checkpoint.
+
+class CheckpointWriter
+{
+public:
+    typedef std::tuple<string, string, string> section_t;
+
+    ~CheckpointWriter()
+    {
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    void write(string path, python::object osections)
+    {
+        wait();
+        vector<section_t> sections;
+        for (int i = 0; i < python::len(osections); ++i)
+        {
+            python::object s = osections[i];
+            sections.emplace_back(python::extract<string>(s[0])(),
+                                  python::extract<string>(s[1])(),
+                                  python::extract<string>(s[2])());
+        }
+        _thread = std::thread([this, path, sections]()
+                              { _error = write_file(path, sections); });
+    }
+
+    void wait()
+    {
+        if (_thread.joinable())
+            _thread.join();
+        if (!_error.empty())
+        {
+            string error;
+            std::swap(error, _error);
+            throw IOException(error);
+        }
+    }
+
+    static constexpr char magic[] = "GTCKPT01";
+
+private:
+    static string write_file(const string& path,
+                             const vector<section_t>& sections)
+    {
+        string tmp = path + ".tmp";
+        ofstream f(tmp, ios::binary | ios::trunc);
+        if (!f)
+            return "error opening checkpoint file for writing: " + tmp;
+
+        auto put = [&](uint64_t x)
+            {
+                f.write(reinterpret_cast<const char*>(&x), sizeof(x));
+            };
+        auto put_str = [&](const string& s)
+            {
+                put(s.size());
+                f.write(s.data(), s.size());
+            };
+
+        f.write(magic, 8);
+        put(sections.size());
+        for (auto& s : sections)
+        {
+            put_str(get<0>(s));
+            put_str(get<1>(s));
+            put(get<2>(s).size());
+            size_t pad = (16 - f.tellp() % 16) % 16;
+            for (size_t i = 0; i < pad; ++i)
+                f.put(0);
+            f.write(get<2>(s).data(), get<2>(s).size());
+        }
+        f.close();
+        if (!f)
+            return "error writing checkpoint file: " + tmp;
+
+        if (std::rename(tmp.c_str(), path.c_str()) != 0)
+            return "error replacing checkpoint file: " + path;
+        return "";
+    }
+
+    std::thread _thread;
+    string _error;
+};
+
+constexpr char CheckpointWriter::magic[];
+
+void export_checkpoint()
+{
+    using namespace boost::python;
+    class_<CheckpointWriter, boost::noncopyable>("CheckpointWriter")
+        .def("write", &CheckpointWriter::write)
+        .def("wait", &CheckpointWriter::wait);
+}
@@ -22,12 +22,20 @@
 
 #include "graph_tool.hh"
 
+#include <atomic>
+
 // Sample neighbors efficiently
 // =============================
 
 namespace graph_tool
 {
 
+// Static variant. The neighbors of all vertices are stored contiguously in
+// CSR form, i.e. the neighbors of vertex v occupy the range
+// [_pos[v], _pos[v+1]) of a single array. Unweighted neighbors are sampled
+// uniformly by indexing this array directly. For weighted neighbors, the same
+// ranges hold the alias tables, which are only built when a vertex is first
+// sampled.
 template <class Graph, class Weighted, class Dynamic>
 class NeighborSampler
 {
@@ -36,17 +44,220 @@ public:
 
     template <class Eprop>
     NeighborSampler(Graph& g, Eprop& eweight, bool self_loops=false)
-        : _sampler(get(vertex_index_t(), g), num_vertices(g)),
-          _sampler_pos(get(vertex_index_t(), g), num_vertices(g)),
-          _eindex(get(edge_index_t(), g))
+        : _pos(num_vertices(g) + 1)
+    {
+        size_t N = num_vertices(g);
+
+        std::vector<size_t> k(N);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 get_neighbors(g, v, eweight, self_loops,
+                               [&](auto, auto) { k[v]++; });
+             });
+
+        for (size_t i = 0; i < N; ++i)
+            _pos[i + 1] = _pos[i] + k[i];
+
+        _items.resize(_pos[N]);
+        if (Weighted::value)
+        {
+            _probs.resize(_pos[N]);
+            _alias.resize(_pos[N]);
+        }
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t i = _pos[v];
+                 get_neighbors(g, v, eweight, self_loops,
+                               [&](auto u, double w)
+                               {
+                                   _items[i] = u;
+                                   if (Weighted::value)
+                                       _probs[i] = w;
+                                   i++;
+                               });
+             });
+
+        _built = std::vector<std::atomic<uint8_t>>(Weighted::value ? N : 0);
+        for (auto& b : _built)
+            b.store(UNBUILT, std::memory_order_relaxed);
+    }
+
+    NeighborSampler(const NeighborSampler& other)
+        : _pos(other._pos),
+          _items(other._items),
+          _probs(other._probs),
+          _alias(other._alias),
+          _built(other._built.size())
+    {
+        for (size_t i = 0; i < _built.size(); ++i)
+            _built[i].store(other._built[i].load(std::memory_order_acquire),
+                            std::memory_order_relaxed);
+    }
+
+    NeighborSampler& operator=(NeighborSampler&& other) = default;
+
+    // this can be called concurrently from several threads
+    template <class RNG>
+    vertex_t sample(vertex_t v, RNG& rng)
+    {
+        // Weighted may be a std or an mpl boolean constant
+        return sample(v, rng,
+                      typename boost::mpl::bool_<Weighted::value>::type());
+    }
+
+    bool empty(vertex_t v)
+    {
+        return _pos[v] == _pos[v + 1];
+    }
+
+private:
+    // Calls f(u, w) for every neighbor u of v with nonzero weight w; the
+    // in-neighbors are only visited for directed graphs.
+    template <class Eprop, class F>
+    void get_neighbors(Graph& g, vertex_t v, Eprop& eweight, bool self_loops,
+                       F&& f)
+    {
+        for (auto e : out_edges_range(v, g))
+        {
+            auto u = target(e, g);
+            double w = eweight[e];
+            if (w == 0)
+                continue;
+
+            if (u == v)
+            {
+                if (!self_loops)
+                    continue;
+                if (!graph_tool::is_directed(g))
+                    w /= 2;
+            }
+            f(u, w);
+        }
+
+        for (auto e : in_edges_range(v, g))
+        {
+            auto u = source(e, g);
+            double w = eweight[e];
+            if (w == 0 || u == v)
+                continue;
+            f(u, w);
+        }
+    }
+
+    template <class RNG>
+    vertex_t sample(vertex_t v, RNG& rng, boost::mpl::false_)
+    {
+        std::uniform_int_distribution<size_t> sample(_pos[v], _pos[v + 1] - 1);
+        return _items[sample(rng)];
+    }
+
+    template <class RNG>
+    vertex_t sample(vertex_t v, RNG& rng, boost::mpl::true_)
+    {
+        build(v);
+        size_t pos = _pos[v];
+        std::uniform_int_distribution<size_t> sample(pos, _pos[v + 1] - 1);
+        size_t i = sample(rng);
+        std::bernoulli_distribution coin(_probs[i]);
+        if (coin(rng))
+            return _items[i];
+        else
+            return _items[pos + _alias[i]];
+    }
+
+    // Builds the alias table of vertex v, if it has not been built yet. If
+    // another thread is already building it, we wait until it is done.
+    void build(vertex_t v)
+    {
+        auto& built = _built[v];
+        if (built.load(std::memory_order_acquire) == BUILT)
+            return;
+
+        uint8_t expected = UNBUILT;
+        if (built.compare_exchange_strong(expected, BUILDING,
+                                          std::memory_order_acq_rel))
+        {
+            build_alias(_pos[v], _pos[v + 1]);
+            built.store(BUILT, std::memory_order_release);
+        }
+        else
+        {
+            while (built.load(std::memory_order_acquire) != BUILT);
+        }
+    }
+
+    // Walker's alias method, as in Sampler (see sampler.hh), but with the
+    // table stored in place of the weights in the range [begin, end).
+    void build_alias(size_t begin, size_t end)
     {
-        init(g, eweight, self_loops,
-             typename boost::mpl::and_<Weighted,
-                                       typename boost::mpl::not_<Dynamic>::type>::type());
+        size_t n = end - begin;
+
+        double S = 0;
+        for (size_t i = begin; i < end; ++i)
+            S += _probs[i];
+
+        std::vector<size_t> small;
+        std::vector<size_t> large;
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            _probs[i] *= n / S;
+            _alias[i] = i - begin;
+            if (_probs[i] < 1)
+                small.push_back(i);
+            else
+                large.push_back(i);
+        }
+
+        while (!(small.empty() || large.empty()))
+        {
+            size_t l = small.back();
+            size_t g = large.back();
+            small.pop_back();
+            large.pop_back();
+
+            _alias[l] = g - begin;
+            _probs[g] = (_probs[l] + _probs[g]) - 1;
+            if (_probs[g] < 1)
+                small.push_back(g);
+            else
+                large.push_back(g);
+        }
+
+        // fix numerical instability
+        for (auto i : large)
+            _probs[i] = 1;
+        for (auto i : small)
+            _probs[i] = 1;
     }
 
+    enum : uint8_t { UNBUILT, BUILDING, BUILT };
+
+    std::vector<size_t> _pos;
+    std::vector<vertex_t> _items;
+    std::vector<double> _probs;
+    std::vector<size_t> _alias;
+    std::vector<std::atomic<uint8_t>> _built;
+};
+
+// Dynamic variant, which supports the insertion and removal of edges; it keeps
+// one sampler per vertex.
+template <class Graph, class Weighted>
+class NeighborSampler<Graph, Weighted, boost::mpl::true_>
+{
+public:
+    typedef typename boost::graph_traits<Graph>::vertex_descriptor vertex_t;
+
     template <class Eprop>
-    void init(Graph& g, Eprop& eweight, bool self_loops, boost::mpl::false_)
+    NeighborSampler(Graph& g, Eprop& eweight, bool self_loops=false)
+        : _sampler(get(vertex_index_t(), g), num_vertices(g)),
+          _sampler_pos(get(vertex_index_t(), g), num_vertices(g)),
+          _eindex(get(edge_index_t(), g))
     {
         for (auto e : edges_range(g))
         {
@@ -73,44 +284,6 @@ public:
         }
     }
 
-    template <class Eprop>
-    void init(Graph& g, Eprop& eweight, bool self_loops, boost::mpl::true_)
-    {
-        for (auto v : vertices_range(g))
-        {
-            std::vector<item_t> us;
-            std::vector<double> probs;
-            for (auto e : out_edges_range(v, g))
-            {
-                auto u = target(e, g);
-                double w = eweight[e];
-                if (w == 0)
-                    continue;
-
-                if (u == v)
-                {
-                    if (!self_loops)
-                        continue;
-                    if (!graph_tool::is_directed(g))
-                        w /= 2;
-                }
-                us.emplace_back(u, 0);
-                probs.push_back(w);
-            }
-
-            for (auto e : in_edges_range(v, g))
-            {
-                auto u = source(e, g);
-                double w = eweight[e];
-                if (w == 0 || u == v)
-                    continue;
-                us.emplace_back(u, 0);
-                probs.push_back(w);
-            }
-            _sampler[v] = sampler_t(us, probs);
-        }
-    }
-
     template <class RNG>
     vertex_t sample(vertex_t v, RNG& rng)
     {
@@ -153,8 +326,8 @@ private:
         return uniform_sample(sampler, rng);
     }
 
-    template <class Sampler, class RNG>
-    const item_t& sample_item(Sampler& sampler, RNG& rng)
+    template <class RNG>
+    const item_t& sample_item(DynamicSampler<item_t>& sampler, RNG& rng)
     {
         return sampler.sample(rng);
     }
@@ -170,8 +343,7 @@ private:
         sampler_pos.erase(u);
     }
 
-    template <class Sampler>
-    void remove_item(item_t& u, Sampler& sampler,
+    void remove_item(item_t& u, DynamicSampler<item_t>& sampler,
                      pos_map_t& sampler_pos)
     {
         size_t pos = sampler_pos[u];
@@ -197,10 +369,7 @@ private:
     }
 
     typedef typename std::conditional<Weighted::value,
-                                      typename std::conditional<Dynamic::value,
-                                                                DynamicSampler<item_t>,
-                                                                Sampler<item_t,
-                                                                        boost::mpl::false_>>::type,
+                                      DynamicSampler<item_t>,
                                       vector<item_t>>::type
         sampler_t;
 
@@ -19,6 +19,10 @@
 #define PARALLEL_RNG_HH
 
 #include <vector>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
 
 template <class RNG>
 void init_rngs(std::vector<std::shared_ptr<RNG>>& rngs, RNG& rng)
@@ -48,4 +52,77 @@ RNG& get_rng(std::vector<std::shared_ptr<RNG>>& rngs, RNG& rng)
     return *rngs[tid];
 };
 
+// Counter-based random number generator (Philox4x32-10; Salmon et al., "Parallel
+// random numbers: as easy as 1, 2, 3", SC'11). The output is a bijective
+// function of a 64-bit key and a 128-bit counter, so a generator is nothing
+// more than a (seed, stream) tuple, and can be constructed at no cost wherever
+// it is needed. Parallel algorithms can therefore key one stream per item of
+// work, e.g. (seed, sweep, vertex), and obtain results that do not depend on
+// the number of threads or on the scheduling.
+class counter_rng
+{
+public:
+    typedef uint32_t result_type;
+
+    counter_rng(uint64_t seed = 0, uint64_t stream = 0, uint32_t substream = 0)
+        : _key{{uint32_t(seed), uint32_t(seed >> 32)}},
+          _ctr{{0, substream, uint32_t(stream), uint32_t(stream >> 32)}},
+          _pos(4) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()()
+    {
+        if (_pos == 4)
+        {
+            _out = philox(_ctr, _key);
+            _ctr[0]++;
+            _pos = 0;
+        }
+        return _out[_pos++];
+    }
+
+    void discard(unsigned long long n)
+    {
+        for (; n > 0; --n)
+            (*this)();
+    }
+
+private:
+    typedef std::array<uint32_t, 4> ctr_t;
+    typedef std::array<uint32_t, 2> key_t;
+
+    static ctr_t philox(ctr_t ctr, key_t key)
+    {
+        constexpr uint64_t M0 = 0xD2511F53;
+        constexpr uint64_t M1 = 0xCD9E8D57;
+        for (size_t i = 0; i < 10; ++i)
+        {
+            uint64_t p0 = M0 * ctr[0];
+            uint64_t p1 = M1 * ctr[2];
+            ctr = {{uint32_t(p1 >> 32) ^ ctr[1] ^ key[0], uint32_t(p1),
+                    uint32_t(p0 >> 32) ^ ctr[3] ^ key[1], uint32_t(p0)}};
+            key[0] += 0x9E3779B9;
+            key[1] += 0xBB67AE85;
+        }
+        return ctr;
+    }
+
+    key_t _key;
+    ctr_t _ctr;
+    ctr_t _out;
+    size_t _pos;
+};
+
+// Draws a fresh 64-bit key for counter_rng streams from a sequential RNG.
+template <class RNG>
+uint64_t draw_seed(RNG& rng)
+{
+    return std::uniform_int_distribution<uint64_t>()(rng);
+}
+
 #endif // PARALLEL_RNG_HH
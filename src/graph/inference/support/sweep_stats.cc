@@ -0,0 +1,107 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_tool.hh"
+#include "sweep_stats.hh"
+
+#include <boost/python.hpp>
+
+#include <memory>
+#include <mutex>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+namespace graph_tool
+{
+
+std::atomic<bool> __sweep_stats_enabled(false);
+std::atomic<bool> __sweep_stats_hist(false);
+
+// the instances of all threads, including those that have already exited
+static vector<std::shared_ptr<sweep_stats_t>> __sweep_stats;
+static std::mutex __sweep_stats_mutex;
+
+sweep_stats_t& get_thread_sweep_stats()
+{
+    thread_local std::shared_ptr<sweep_stats_t> stats;
+    if (!stats)
+    {
+        stats = std::make_shared<sweep_stats_t>();
+        std::lock_guard<std::mutex> lock(__sweep_stats_mutex);
+        __sweep_stats.push_back(stats);
+    }
+    return *stats;
+}
+
+} // graph_tool namespace
+
+void set_sweep_stats(bool enabled, bool hist)
+{
+    __sweep_stats_hist = hist;
+    __sweep_stats_enabled = enabled;
+}
+
+void reset_sweep_stats()
+{
+    std::lock_guard<std::mutex> lock(__sweep_stats_mutex);
+    for (auto& stats : __sweep_stats)
+        *stats = sweep_stats_t();
+}
+
+python::dict get_sweep_stats()
+{
+    sweep_stats_t total;
+    {
+        std::lock_guard<std::mutex> lock(__sweep_stats_mutex);
+        for (auto& stats : __sweep_stats)
+        {
+            total.proposals += stats->proposals;
+            total.null_moves += stats->null_moves;
+            total.self_moves += stats->self_moves;
+            total.accepted += stats->accepted;
+            total.proposal_time += stats->proposal_time;
+            total.dS_time += stats->dS_time;
+            total.move_time += stats->move_time;
+            for (size_t i = 0; i < sweep_stats_t::dS_bins; ++i)
+                total.dS_hist[i] += stats->dS_hist[i];
+        }
+    }
+
+    python::dict ret;
+    ret["proposals"] = total.proposals;
+    ret["null_moves"] = total.null_moves;
+    ret["self_moves"] = total.self_moves;
+    ret["accepted"] = total.accepted;
+    ret["proposal_time"] = total.proposal_time;
+    ret["dS_time"] = total.dS_time;
+    ret["move_time"] = total.move_time;
+    python::list hist;
+    for (auto x : total.dS_hist)
+        hist.append(x);
+    ret["dS_hist"] = hist;
+    return ret;
+}
+
+void export_sweep_stats()
+{
+    using namespace boost::python;
+    def("set_sweep_stats", &set_sweep_stats);
+    def("reset_sweep_stats", &reset_sweep_stats);
+    def("get_sweep_stats", &get_sweep_stats);
+}
@@ -0,0 +1,122 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SWEEP_STATS_HH
+#define SWEEP_STATS_HH
+
+#include "config.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+namespace graph_tool
+{
+
+// Telemetry of the sweep loops: counts of the outcomes of the move proposals,
+// the time spent proposing, evaluating and performing moves, and optionally a
+// histogram of the entropy differences.
+//
+// Each thread accumulates into its own instance, so that no synchronization is
+// needed in the loops; the instances are summed when they are read. When the
+// telemetry is disabled, the only cost is a relaxed atomic load per probe.
+
+struct sweep_stats_t
+{
+    size_t proposals = 0;   // calls to move_proposal()
+    size_t null_moves = 0;  // proposals that were skipped (null_group)
+    size_t self_moves = 0;  // proposals of the current state, or repeated
+                            // candidates in merge sweeps
+    size_t accepted = 0;    // moves performed
+    double proposal_time = 0;
+    double dS_time = 0;
+    double move_time = 0;
+
+    // log-binned histogram of dS: bin 32 holds |dS| < 2^-16, and bins 33 + j
+    // (31 - j) hold positive (negative) values with |dS| in [2^(j-16),
+    // 2^(j-15)), with the last bins open-ended
+    static constexpr size_t dS_bins = 65;
+    std::array<size_t, dS_bins> dS_hist = {};
+
+    static size_t get_dS_bin(double dS)
+    {
+        double x = std::abs(dS);
+        if (x < std::ldexp(1., -16))
+            return dS_bins / 2;
+        int e = std::isinf(x) ? 15 : std::min(std::ilogb(x), 15);
+        size_t j = e + 16;
+        return (dS < 0) ? 31 - j : 33 + j;
+    }
+};
+
+extern std::atomic<bool> __sweep_stats_enabled;
+extern std::atomic<bool> __sweep_stats_hist;
+
+// instance of the calling thread
+sweep_stats_t& get_thread_sweep_stats();
+
+class SweepProbe
+{
+public:
+    typedef std::chrono::steady_clock clock_t;
+
+    SweepProbe()
+        : _stats(__sweep_stats_enabled.load(std::memory_order_relaxed) ?
+                 &get_thread_sweep_stats() : nullptr),
+          _hist(_stats != nullptr &&
+                __sweep_stats_hist.load(std::memory_order_relaxed))
+    {}
+
+    void start()
+    {
+        if (_stats != nullptr)
+            _t = clock_t::now();
+    }
+
+    // adds the time since the last call to start() or lap() to the phase
+    void lap(double sweep_stats_t::* phase)
+    {
+        if (_stats == nullptr)
+            return;
+        auto t = clock_t::now();
+        (*_stats).*phase += std::chrono::duration<double>(t - _t).count();
+        _t = t;
+    }
+
+    void count(size_t sweep_stats_t::* counter, size_t n = 1)
+    {
+        if (_stats != nullptr)
+            (*_stats).*counter += n;
+    }
+
+    void add_dS(double dS)
+    {
+        if (_hist && !std::isnan(dS))
+            _stats->dS_hist[sweep_stats_t::get_dS_bin(dS)]++;
+    }
+
+private:
+    sweep_stats_t* _stats;
+    bool _hist;
+    clock_t::time_point _t;
+};
+
+} // graph_tool namespace
+
+#endif // SWEEP_STATS_HH
@@ -22,6 +22,7 @@
 #include <boost/lambda/bind.hpp>
 
 #include "graph_arf.hh"
+#include "graph_layout_stepper.hh"
 
 using namespace std;
 using namespace boost;
@@ -29,7 +30,7 @@ using namespace graph_tool;
 
 void arf_layout(GraphInterface& g, boost::any pos, boost::any weight, double d,
                 double a, double dt, size_t max_iter, double epsilon,
-                size_t dim)
+                size_t dim, double theta, size_t max_level)
 {
     typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
     typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
@@ -39,13 +40,42 @@ void arf_layout(GraphInterface& g, boost::any pos, boost::any weight, double d,
         weight = weight_map_t();
     run_action<graph_tool::detail::never_directed>()
         (g, std::bind(get_arf_layout(), std::placeholders::_1, std::placeholders::_2,
-                      std::placeholders::_3, a, d, dt, epsilon, max_iter, dim),
+                      std::placeholders::_3, a, d, dt, epsilon, max_iter, dim, theta,
+                      max_level),
          vertex_floating_vector_properties(), edge_props_t())(pos, weight);
 }
 
+std::shared_ptr<LayoutStepper>
+arf_layout_stepper(GraphInterface& g, boost::any pos, boost::any weight,
+                   double d, double a, double dt, size_t max_iter,
+                   double epsilon, size_t dim, double theta, size_t max_level)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef boost::mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        edge_props_t;
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    std::shared_ptr<LayoutStepper> stepper;
+    run_action<graph_tool::detail::never_directed>()
+        (g,
+         [&](auto& u, auto upos, auto uweight)
+         {
+             typedef typename std::remove_reference<decltype(u)>::type g_t;
+             typedef ARFState<g_t, decltype(upos), decltype(uweight)> state_t;
+             stepper = std::make_shared<LayoutStepperWrap<g_t, state_t>>
+                 (u, upos, uweight, a, d, dt, epsilon, max_iter, dim, theta,
+                  max_level);
+         },
+         vertex_floating_vector_properties(), edge_props_t())(pos, weight);
+    return stepper;
+}
+
 #include <boost/python.hpp>
 
 void export_arf()
 {
     boost::python::def("arf_layout", &arf_layout);
+    boost::python::def("arf_layout_stepper", &arf_layout_stepper);
 }
@@ -21,88 +21,273 @@
 #include <limits>
 #include <iostream>
 
+#include "graph_sfdp.hh"
+
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
-struct get_arf_layout
+// The force on each vertex is the sum of a linear attraction to every other
+// vertex, of a constant repulsion (of strength r) from every other vertex, and
+// of an attraction to the neighbors. The first term depends only on the sum of
+// the positions, and the second is either computed exactly, in time O(V^2) per
+// iteration, or, if theta > 0 (only for dim == 2), approximated by the
+// Barnes-Hut algorithm with the SFDP quadtree, in time O(V log V). The
+// positions are updated synchronously, from those of the previous iteration,
+// and kept in separate arrays for each coordinate, so that the sums over the
+// vertices can be vectorized.
+//
+// The state of the layout is kept between iterations, so that it can be
+// advanced one iteration at a time, and the positions are only written back
+// to the position map by write_pos().
+template <class Graph, class PosMap, class WeightMap>
+class ARFState
 {
-    template <class Graph, class PosMap, class WeightMap>
-    void operator()(Graph& g, PosMap pos, WeightMap weight, double a, double d,
-                    double dt, double epsilon, size_t max_iter, size_t dim)
-        const
+public:
+    typedef typename property_traits<PosMap>::value_type::value_type pos_t;
+
+    ARFState(Graph& g, PosMap pos, WeightMap weight, double a, double d,
+             double dt, double epsilon, size_t max_iter, size_t dim,
+             double theta, size_t max_level)
+        : _g(g), _pos(pos), _weight(weight), _a(a), _dt(dt),
+          _epsilon(epsilon), _max_iter(max_iter), _dim(dim), _theta(theta),
+          _max_level(max_level)
     {
-        typedef typename property_traits<PosMap>::value_type::value_type pos_t;
+        if (theta > 0 && dim != 2)
+            throw ValueException("the Barnes-Hut approximation is only "
+                                 "supported for dim == 2");
+
+        size_t M = num_vertices(g);
+        _X.resize(dim, vector<pos_t>(M));
+        for (auto v : vertices_range(g))
+        {
+            pos[v].resize(dim);
+            for (size_t j = 0; j < dim; ++j)
+                _X[j][v] = pos[v][j];
+            _vs.push_back(v);
+        }
+        _nX = _X;
 
+        _delta = epsilon + 1;
+        _r = d * sqrt(pos_t(_vs.size()));
+    }
+
+    bool converged() const
+    {
+        return (!(_delta > _epsilon) ||
+                (_max_iter > 0 && _n_iter >= _max_iter));
+    }
+
+    double get_energy() const { return _E; }
+    double get_delta() const { return _delta; }
+    size_t get_iter() const { return _n_iter; }
+
+    void iterate()
+    {
+        auto& g = _g;
+        auto& X = _X;
+        auto& nX = _nX;
+        auto& vs = _vs;
+        auto& qt = _qt;
+        auto& cx = _cx;
+        auto& cy = _cy;
+        auto& weight = _weight;
+        size_t N = vs.size(), dim = _dim;
+        double a = _a, dt = _dt, theta = _theta;
+        pos_t r = _r;
+        auto f_r = [r](double d2) { return -r / max(sqrt(d2), 1e-6); };
+
+        vector<pos_t> sum(dim, 0);
+        for (auto v : vs)
+        {
+            for (size_t j = 0; j < dim; ++j)
+                sum[j] += X[j][v];
+        }
+
+        if (theta > 0)
+        {
+            std::array<double, 2> ll, ur;
+            ll.fill(numeric_limits<double>::max());
+            ur.fill(-numeric_limits<double>::max());
+            for (auto v : vs)
+            {
+                for (size_t j = 0; j < 2; ++j)
+                {
+                    ll[j] = min(double(X[j][v]), ll[j]);
+                    ur[j] = max(double(X[j][v]), ur[j]);
+                }
+            }
+            qt.build(g, X[0], X[1], UnityPropertyMap<int, size_t>(), ll,
+                     ur, _max_level);
+        }
+        else if (dim == 2)
+        {
+            // contiguous copy, for the vectorized sum below
+            cx.resize(N);
+            cy.resize(N);
+            for (size_t i = 0; i < N; ++i)
+            {
+                cx[i] = X[0][vs[i]];
+                cy[i] = X[1][vs[i]];
+            }
+        }
+
+        pos_t delta = 0, E = 0;
+        vector<size_t> Q;
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            private(Q) reduction(+:delta, E)
         parallel_vertex_loop_no_spawn
             (g,
              [&](auto v)
              {
-                 pos[v].resize(dim);
-             });
+                 vector<pos_t> delta_pos(dim, 0);
+                 for (size_t j = 0; j < dim; ++j)
+                     delta_pos[j] = sum[j] - N * X[j][v];
 
-        pos_t delta = epsilon + 1;
-        size_t n_iter = 0;
-        pos_t r = d*sqrt(pos_t(HardNumVertices()(g)));
-        while (delta > epsilon && (max_iter == 0 || n_iter < max_iter))
-        {
-            delta = 0;
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                reduction(+:delta)
-            parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
+                 if (theta > 0)
                  {
-                     vector<pos_t> delta_pos(dim,0);
+                     double xv = X[0][v], yv = X[1][v];
+                     double fx = 0, fy = 0;
+                     Q.push_back(0);
+                     while (!Q.empty())
+                     {
+                         auto& q = qt.get_node(Q.back());
+                         Q.pop_back();
+
+                         if (q.nchildren == 0)
+                         {
+                             qt.sum_forces(q, xv, yv, f_r, fx, fy);
+                             continue;
+                         }
 
-                     for (auto w : vertices_range(g))
+                         double dx = q.cm[0] - xv;
+                         double dy = q.cm[1] - yv;
+                         double d2 = dx * dx + dy * dy;
+                         if (q.w > theta * sqrt(d2))
+                         {
+                             for (size_t c = q.children;
+                                  c < q.children + q.nchildren; ++c)
+                                 Q.push_back(c);
+                         }
+                         else
+                         {
+                             double f = q.count * f_r(d2);
+                             fx += f * dx;
+                             fy += f * dy;
+                         }
+                     }
+                     delta_pos[0] += fx;
+                     delta_pos[1] += fy;
+                 }
+                 else if (dim == 2)
+                 {
+                     const pos_t* xs = cx.data();
+                     const pos_t* ys = cy.data();
+                     pos_t xv = X[0][v], yv = X[1][v];
+                     pos_t fx = 0, fy = 0;
+                     #pragma omp simd reduction(+:fx, fy)
+                     for (size_t i = 0; i < N; ++i)
+                     {
+                         pos_t dx = xs[i] - xv;
+                         pos_t dy = ys[i] - yv;
+                         pos_t diff = sqrt(dx * dx + dy * dy);
+                         pos_t m = r / max(diff, pos_t(1e-6));
+                         fx -= m * dx;
+                         fy -= m * dy;
+                     }
+                     delta_pos[0] += fx;
+                     delta_pos[1] += fy;
+                 }
+                 else
+                 {
+                     for (auto w : vs)
                      {
-                         if (w == v)
+                         if (w == size_t(v))
                              continue;
                          pos_t diff = 0;
                          for (size_t j = 0; j < dim; ++j)
                          {
-                             pos_t dx = pos[w][j] - pos[v][j];
+                             pos_t dx = X[j][w] - X[j][v];
                              diff += dx*dx;
-                             delta_pos[j] += dx;
                          }
                          diff = sqrt(diff);
                          if (diff < 1e-6)
                              diff = 1e-6;
                          pos_t m = r/diff;
                          for (size_t j = 0; j < dim; ++j)
-                         {
-                             pos_t dx = pos[w][j] - pos[v][j];
-                             delta_pos[j] -= m*dx;
-                         }
-                     }
-
-                     for (auto e : out_edges_range(v, g))
-                     {
-                         auto u = target(e, g);
-                         if (u == v)
-                             continue;
-                         pos_t m = a * get(weight, e) - 1;
-                         for (size_t j = 0; j < dim; ++j)
-                         {
-                             pos_t dx = pos[u][j] - pos[v][j];
-                             delta_pos[j] += m * dx;
-                         }
+                             delta_pos[j] -= m * (X[j][w] - X[j][v]);
                      }
+                 }
 
-                     auto dt_ = dt; // workaround clang
+                 for (auto e : out_edges_range(v, g))
+                 {
+                     auto u = target(e, g);
+                     if (u == v)
+                         continue;
+                     pos_t m = a * get(weight, e) - 1;
                      for (size_t j = 0; j < dim; ++j)
-                     {
-                         #pragma omp atomic
-                         pos[v][j] += dt_ * delta_pos[j];
-                         delta += abs(delta_pos[j]);
-                     }
+                         delta_pos[j] += m * (X[j][u] - X[j][v]);
+                 }
+
+                 for (size_t j = 0; j < dim; ++j)
+                 {
+                     nX[j][v] = X[j][v] + dt * delta_pos[j];
+                     delta += abs(delta_pos[j]);
+                     E += delta_pos[j] * delta_pos[j];
+                 }
+             });
 
-                 });
-            n_iter++;
+        X.swap(nX);
+        _delta = delta;
+        _E = E;
+        _n_iter++;
+    }
+
+    void write_pos()
+    {
+        for (auto v : _vs)
+        {
+            for (size_t j = 0; j < _dim; ++j)
+                _pos[v][j] = _X[j][v];
         }
     }
+
+private:
+    Graph& _g;
+    PosMap _pos;
+    WeightMap _weight;
+    double _a, _dt, _epsilon;
+    size_t _max_iter, _dim;
+    double _theta;
+    size_t _max_level;
+
+    // the coordinates, X[j][v], of the current and the next iteration
+    vector<vector<pos_t>> _X, _nX;
+    vector<size_t> _vs;
+    pos_t _r;
+    QuadTree<int> _qt;
+    vector<pos_t> _cx, _cy;
+
+    pos_t _delta, _E = 0;
+    size_t _n_iter = 0;
+};
+
+struct get_arf_layout
+{
+    template <class Graph, class PosMap, class WeightMap>
+    void operator()(Graph& g, PosMap pos, WeightMap weight, double a, double d,
+                    double dt, double epsilon, size_t max_iter, size_t dim,
+                    double theta, size_t max_level)
+        const
+    {
+        ARFState<Graph, PosMap, WeightMap>
+            state(g, pos, weight, a, d, dt, epsilon, max_iter, dim, theta,
+                  max_level);
+        while (!state.converged())
+            state.iterate();
+        state.write_pos();
+    }
 };
 
 } // namespace graph_tool
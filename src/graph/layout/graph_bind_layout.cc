@@ -15,9 +15,12 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
+#include "graph_layout_stepper.hh"
+
 #include <boost/python.hpp>
 
 using namespace boost::python;
+using namespace graph_tool;
 void export_arf();
 void export_fruchterman_reingold();
 void export_sfdp();
@@ -26,6 +29,14 @@ void export_planar();
 
 BOOST_PYTHON_MODULE(libgraph_tool_layout)
 {
+    class_<LayoutStepper, std::shared_ptr<LayoutStepper>,
+           boost::noncopyable>("LayoutStepper", no_init)
+        .def("step", &LayoutStepper::step)
+        .def("converged", &LayoutStepper::converged)
+        .def("get_energy", &LayoutStepper::get_energy)
+        .def("get_delta", &LayoutStepper::get_delta)
+        .def("get_iter", &LayoutStepper::get_iter);
+
     export_arf();
     export_fruchterman_reingold();
     export_sfdp();
@@ -0,0 +1,83 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_LAYOUT_STEPPER_HH
+#define GRAPH_LAYOUT_STEPPER_HH
+
+#include "graph.hh"
+
+namespace graph_tool
+{
+
+// An incremental layout, which is advanced a given number of iterations at a
+// time, keeping its state (e.g. the quadtree buffers and the RNG) between
+// calls. The positions are written back to the position map after each call
+// to step(). The graph must not be modified while the layout is in progress.
+class LayoutStepper
+{
+public:
+    virtual ~LayoutStepper() {}
+
+    // does at most n iterations, or runs until convergence if n == 0, with
+    // the GIL released; returns the number of iterations done
+    size_t step(size_t n)
+    {
+        GILRelease gil;
+        size_t i = 0;
+        for (; (n == 0 || i < n) && !converged(); ++i)
+            iterate();
+        write_pos();
+        return i;
+    }
+
+    virtual bool converged() const = 0;
+    virtual double get_energy() const = 0;
+    virtual double get_delta() const = 0;
+    virtual size_t get_iter() const = 0;
+
+protected:
+    virtual void iterate() = 0;
+    virtual void write_pos() = 0;
+};
+
+// Wraps one of the layout states, which keep a reference to the graph, and
+// owns a copy of the graph view, as the one given by run_action() does not
+// outlive the dispatch.
+template <class Graph, class State>
+class LayoutStepperWrap : public LayoutStepper
+{
+public:
+    template <class... Args>
+    LayoutStepperWrap(Graph& g, Args&&... args)
+        : _g(g), _state(_g, std::forward<Args>(args)...) {}
+
+    bool converged() const { return _state.converged(); }
+    double get_energy() const { return _state.get_energy(); }
+    double get_delta() const { return _state.get_delta(); }
+    size_t get_iter() const { return _state.get_iter(); }
+
+protected:
+    void iterate() { _state.iterate(); }
+    void write_pos() { _state.write_pos(); }
+
+    Graph _g;
+    State _state;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_LAYOUT_STEPPER_HH
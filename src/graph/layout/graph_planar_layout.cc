@@ -42,14 +42,13 @@ void planar_layout(GraphInterface& gi, boost::any aembed_map, boost::any apos)
              typedef typename graph_traits<g_t>::vertex_descriptor vertex_t;
 
              auto eindex = get(edge_index, g);
-             vector<edge_t> edges;
-             for (auto e : edges_range(g))
-             {
-                 auto ei = eindex[e];
-                 if (ei >= edges.size())
-                     edges.resize(ei + 1);
-                 edges[ei] = e;
-             }
+             vector<edge_t> edges(gi.get_edge_index_range());
+             parallel_edge_loop
+                 (g,
+                  [&](auto& e)
+                  {
+                      edges[eindex[e]] = e;
+                  });
 
              typename vprop_map_t<std::vector<edge_t>>::type::unchecked_t
                  embed(get(vertex_index, g), num_vertices(g));
@@ -21,6 +21,7 @@
 
 #include "graph_selectors.hh"
 #include "graph_properties.hh"
+#include "graph_parallel_bfs.hh"
 
 #include <cmath>
 
@@ -29,6 +30,12 @@ using namespace boost;
 using namespace graph_tool;
 
 
+// The tree is split in layers by a parallel BFS from the root, and every pass
+// over it is done layer by layer, in parallel within each layer: the leaf
+// weights (and the propagated orders) of the subtrees are reduced from the
+// deepest layer up, the leaves are given consecutive angular ranges from the
+// root down, in the relative order of the branches, and the angles of the
+// inner vertices are averaged from the deepest layer up.
 struct do_get_radial
 {
     template <class Graph, class PosProp, class LevelMap, class OrderMap,
@@ -39,154 +46,123 @@ struct do_get_radial
     {
         typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
         typedef typename vprop_map_t<typename property_traits<WeightMap>::value_type>::type vcount_t;
-        typename vcount_t::unchecked_t count(get(vertex_index, g), num_vertices(g));
 
-        if (!weighted)
-        {
-            for (auto v : vertices_range(g))
-                count[v] = weight[v];
-        }
-        else
-        {
-            deque<vertex_t> q;
-            for (auto v : vertices_range(g))
-            {
-                if (out_degree(v, g) == 0)
-                {
-                    q.push_back(v);
-                    count[v] = weight[v];
-                }
-            }
-
-            typedef vprop_map_t<uint8_t>::type vmark_t;
-            vmark_t::unchecked_t mark(get(vertex_index, g), num_vertices(g));
+        size_t N = num_vertices(g);
 
-            while (!q.empty())
+        vector<vector<vertex_t>> layers(1);
+        layers[0].push_back(root);
+        parallel_bfs()(g, root,
+                       [&](auto v, auto, size_t d)
+                       {
+                           if (d >= layers.size())
+                               layers.resize(d + 1);
+                           layers[d].push_back(v);
+                           return false;
+                       });
+
+        auto bottom_up = [&](auto&& f)
             {
-                vertex_t v = q.front();
-                q.pop_front();
-                for (auto e : in_edges_range(v, g))
-                {
-                    vertex_t w = source(e, g);
-                    count[w] += count[v];
-                    if (!mark[w])
-                    {
-                        q.push_back(w);
-                        mark[w] = true;
-                    }
-                }
-            }
-        }
+                for (auto l = layers.rbegin(); l != layers.rend(); ++l)
+                    parallel_loop(*l, [&](size_t, auto v) { f(v); });
+            };
+
+        // total weight of the leaves of each subtree
+        typename vcount_t::unchecked_t lweight(get(vertex_index, g), N);
 
         vprop_map_t<double>::type::unchecked_t vorder(get(vertex_index, g));
 
         if (order_propagate)
         {
-            vorder.resize(num_vertices(g));
+            vorder.resize(N);
             std::vector<size_t> vs(vertices(g).first, vertices(g).second);
             std::sort(vs.begin(), vs.end(),
                       [&] (vertex_t u, vertex_t v) { return order[u] < order[v]; });
 
             for (size_t i = 0; i < vs.size(); ++i)
                 vorder[vs[i]] = i;
-
-            std::sort(vs.begin(), vs.end(),
-                      [&] (vertex_t u, vertex_t v) { return level[u] > level[v]; });
-
-            for (auto v : vs)
-            {
-                if (out_degree(v,g) == 0)
-                    continue;
-                vorder[v] = 0;
-                for (auto e : out_edges_range(v, g))
-                    vorder[v] += vorder[target(e,g)];
-                vorder[v] /= out_degree(v,g);
-            }
         }
 
-        vector<vector<vertex_t>> layers(1);
-        layers[0].push_back(root);
-
-        bool last = false;
-        while (!last)
+        bottom_up([&](auto v)
+                  {
+                      if (out_degree(v, g) == 0)
+                      {
+                          lweight[v] = weight[v];
+                          return;
+                      }
+                      lweight[v] = 0;
+                      for (auto w : out_neighbors_range(v, g))
+                          lweight[v] += lweight[w];
+                      if (order_propagate)
+                      {
+                          vorder[v] = 0;
+                          for (auto w : out_neighbors_range(v, g))
+                              vorder[v] += vorder[w];
+                          vorder[v] /= out_degree(v, g);
+                      }
+                  });
+
+        auto count = [&](auto v) { return weighted ? lweight[v] : weight[v]; };
+
+        // start of the angular range of the leaves of each subtree, in units
+        // of leaf weight
+        vector<double> offset(N);
+        offset[root] = 0;
+        vector<vertex_t> children;
+        for (auto& vs : layers)
         {
-            layers.resize(layers.size() + 1);
-            vector<vertex_t>& new_layer = layers[layers.size() - 1];
-            vector<vertex_t>& last_layer = layers[layers.size() - 2];
-
-            last = true;
-            for (size_t i = 0; i < last_layer.size(); ++i)
-            {
-                vertex_t v = last_layer[i];
-                for (auto e : out_edges_range(v, g))
-                {
-                    vertex_t w = target(e, g);
-                    new_layer.push_back(w);
-
-                    if (int(layers.size()) - 1 == int(level[w]))
-                        last = false;
-                }
-
-                if (order_propagate)
-                {
-                    std::sort(new_layer.end() - out_degree(v, g),
-                              new_layer.end(),
-                              [&] (vertex_t u, vertex_t v)
-                              { return vorder[u] < vorder[v]; });
-                }
-                else
-                {
-                    std::sort(new_layer.end() - out_degree(v, g),
-                              new_layer.end(),
-                              [&] (vertex_t u, vertex_t v)
-                              { return order[u] < order[v]; });
-                }
-
-                if (out_degree(v, g) == 0)
-                    new_layer.push_back(v);
-            }
-
-            if (last)
-                layers.pop_back();
+            #pragma omp parallel if (vs.size() > OPENMP_MIN_THRESH) \
+                private(children)
+            parallel_loop_no_spawn
+                (vs,
+                 [&](size_t, auto v)
+                 {
+                     children.clear();
+                     for (auto w : out_neighbors_range(v, g))
+                         children.push_back(w);
+                     if (order_propagate)
+                         std::sort(children.begin(), children.end(),
+                                   [&] (vertex_t u, vertex_t v)
+                                   { return vorder[u] < vorder[v]; });
+                     else
+                         std::sort(children.begin(), children.end(),
+                                   [&] (vertex_t u, vertex_t v)
+                                   { return order[u] < order[v]; });
+                     double o = offset[v];
+                     for (auto w : children)
+                     {
+                         offset[w] = o;
+                         o += lweight[w];
+                     }
+                 });
         }
 
-
         typedef vprop_map_t<double>::type vangle_t;
-        vangle_t::unchecked_t angle(get(vertex_index, g), num_vertices(g));
-
-        double d_sum = 0;
-        vector<vertex_t>& outer_layer = layers.back();
-        for (size_t i = 0; i < outer_layer.size(); ++i)
-            d_sum += count[outer_layer[i]];
-        angle[outer_layer[0]] = (2 * M_PI * count[outer_layer[0]]) / d_sum;
-        for (size_t i = 1; i < outer_layer.size(); ++i)
-            angle[outer_layer[i]] = angle[outer_layer[i-1]] + (2 * M_PI * count[outer_layer[i]]) / d_sum;
-        for (size_t i = 0; i < outer_layer.size(); ++i)
-            angle[outer_layer[i]] -= (2 * M_PI * count[outer_layer[i]]) / (2 * d_sum);
-
-        for (size_t i = 0; i < layers.size(); ++i)
-        {
-            vector<vertex_t>& vs = layers[layers.size() - 1 - i];
-            for (size_t j = 0; j < vs.size(); ++j)
-            {
-                vertex_t v = vs[j];
-                d_sum = 0;
-                for (auto e : out_edges_range(v, g))
-                {
-                    vertex_t w = target(e, g);
-                    d_sum += count[w];
-                }
-                for (auto e : out_edges_range(v, g))
-                {
-                    vertex_t w = target(e, g);
-                    angle[v] += angle[w] * count[w] / d_sum;
-                }
-                double d = level[v] * r;
-                tpos[v].resize(2);
-                tpos[v][0] = d * cos(angle[v]);
-                tpos[v][1] = d * sin(angle[v]);
-            }
-        }
+        vangle_t::unchecked_t angle(get(vertex_index, g), N);
+
+        double d_total = lweight[root];
+        bottom_up([&](auto v)
+                  {
+                      if (out_degree(v, g) == 0)
+                      {
+                          angle[v] = (2 * M_PI * (offset[v] + lweight[v] / 2))
+                              / d_total;
+                      }
+                      else
+                      {
+                          double d_sum = 0;
+                          angle[v] = 0;
+                          for (auto w : out_neighbors_range(v, g))
+                          {
+                              d_sum += count(w);
+                              angle[v] += angle[w] * count(w);
+                          }
+                          angle[v] /= d_sum;
+                      }
+                      double d = level[v] * r;
+                      tpos[v].resize(2);
+                      tpos[v][0] = d * cos(angle[v]);
+                      tpos[v][1] = d * sin(angle[v]);
+                  });
     }
 };
 
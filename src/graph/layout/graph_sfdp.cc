@@ -15,6 +15,8 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
+#define BOOST_PYTHON_MAX_ARITY 40
+
 #include "graph_filtering.hh"
 #include "graph.hh"
 #include "graph_properties.hh"
@@ -23,6 +25,9 @@
 #include <boost/lambda/bind.hpp>
 
 #include "graph_sfdp.hh"
+#include "graph_sfdp_multilevel.hh"
+#include "graph_sfdp_offload.hh"
+#include "graph_layout_stepper.hh"
 #include "random.hh"
 #include "hash_map_wrap.hh"
 
@@ -30,12 +35,23 @@ using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
+void check_offload(bool offload)
+{
+#ifndef HAVE_OPENMP_OFFLOAD
+    if (offload)
+        throw GraphException("OpenMP offloading was not enabled during "
+                             "compilation");
+#endif
+}
+
 void sfdp_layout(GraphInterface& g, boost::any pos, boost::any vweight,
                  boost::any eweight, boost::any pin, python::object spring_parms,
                  double theta, double init_step, double step_schedule,
                  size_t max_level, double epsilon, size_t max_iter,
-                 bool adaptive, bool verbose, rng_t& rng)
+                 bool adaptive, bool offload, bool verbose, rng_t& rng)
 {
+    check_offload(offload);
+
     typedef UnityPropertyMap<int,GraphInterface::vertex_t> vweight_map_t;
     typedef UnityPropertyMap<int,GraphInterface::edge_t> eweight_map_t;
     typedef mpl::push_back<vertex_scalar_properties, vweight_map_t>::type
@@ -62,15 +78,183 @@ void sfdp_layout(GraphInterface& g, boost::any pos, boost::any vweight,
     typedef vprop_map_t<uint8_t>::type pin_map_t;
     pin_map_t pin_map = any_cast<pin_map_t>(pin);
 
+    auto dispatch = [&](auto layout)
+        {
+            run_action<graph_tool::detail::never_directed>(true)
+                (g,
+                 std::bind(layout,
+                           std::placeholders::_1, std::placeholders::_2,
+                           std::placeholders::_3, std::placeholders::_4,
+                           pin_map.get_unchecked(num_vertices(g.get_graph())),
+                           groups.get_unchecked(num_vertices(g.get_graph())),
+                           verbose, std::ref(rng)),
+                 vertex_floating_vector_properties(), vertex_props_t(),
+                 edge_props_t())
+                (pos, vweight, eweight);
+        };
+
+#ifdef HAVE_OPENMP_OFFLOAD
+    if (offload)
+    {
+        dispatch(get_sfdp_layout_offload(C, K, p, theta, gamma, mu, mu_p,
+                                         init_step, step_schedule, max_level,
+                                         epsilon, max_iter, adaptive));
+        return;
+    }
+#endif
+    dispatch(get_sfdp_layout(C, K, p, theta, gamma, mu, mu_p, init_step,
+                             step_schedule, max_level, epsilon, max_iter,
+                             adaptive));
+}
+
+// SFDPState with its own RNG, seeded from the one given, and its verbosity, so
+// that it can be advanced with iterate() alone
+template <class Graph, class PosMap, class VertexWeightMap,
+          class EdgeWeightMap, class GroupMap>
+class SFDPStepState
+    : public SFDPState<Graph, PosMap, VertexWeightMap, EdgeWeightMap, GroupMap>
+{
+public:
+    typedef SFDPState<Graph, PosMap, VertexWeightMap, EdgeWeightMap, GroupMap>
+        base_t;
+
+    template <class PinMap>
+    SFDPStepState(Graph& g, const get_sfdp_layout& parms, PosMap pos,
+                  VertexWeightMap vweight, EdgeWeightMap eweight, PinMap pin,
+                  GroupMap group, bool verbose, rng_t& rng)
+        : base_t(parms, g, pos, vweight, eweight, pin, group),
+          _verbose(verbose), _rng(rng()) {}
+
+    void iterate() { base_t::iterate(_verbose, _rng); }
+
+private:
+    bool _verbose;
+    rng_t _rng;
+};
+
+std::shared_ptr<LayoutStepper>
+sfdp_layout_stepper(GraphInterface& g, boost::any pos, boost::any vweight,
+                    boost::any eweight, boost::any pin,
+                    python::object spring_parms, double theta,
+                    double init_step, double step_schedule, size_t max_level,
+                    double epsilon, size_t max_iter, bool adaptive,
+                    bool verbose, rng_t& rng)
+{
+    typedef UnityPropertyMap<int,GraphInterface::vertex_t> vweight_map_t;
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> eweight_map_t;
+    typedef mpl::push_back<vertex_scalar_properties, vweight_map_t>::type
+        vertex_props_t;
+    typedef mpl::push_back<edge_scalar_properties, eweight_map_t>::type
+        edge_props_t;
+
+    typedef vprop_map_t<int32_t>::type group_map_t;
+
+    double C = python::extract<double>(spring_parms[0]);
+    double K = python::extract<double>(spring_parms[1]);
+    double p = python::extract<double>(spring_parms[2]);
+    double gamma = python::extract<double>(spring_parms[3]);
+    double mu = python::extract<double>(spring_parms[4]);
+    double mu_p = python::extract<double>(spring_parms[5]);
+    group_map_t groups =
+        any_cast<group_map_t>(python::extract<any>(spring_parms[6]));
+
+    if(vweight.empty())
+        vweight = vweight_map_t();
+    if(eweight.empty())
+        eweight = eweight_map_t();
+
+    typedef vprop_map_t<uint8_t>::type pin_map_t;
+    pin_map_t pin_map = any_cast<pin_map_t>(pin);
+
+    get_sfdp_layout parms(C, K, p, theta, gamma, mu, mu_p, init_step,
+                          step_schedule, max_level, epsilon, max_iter,
+                          adaptive);
+
+    std::shared_ptr<LayoutStepper> stepper;
     run_action<graph_tool::detail::never_directed>()
         (g,
-         std::bind(get_sfdp_layout(C, K, p, theta, gamma, mu, mu_p, init_step,
-                                   step_schedule, max_level, epsilon,
-                                   max_iter, adaptive),
+         [&](auto& u, auto upos, auto uvweight, auto ueweight)
+         {
+             typedef typename std::remove_reference<decltype(u)>::type g_t;
+             auto ugroups = groups.get_unchecked(num_vertices(u));
+             typedef SFDPStepState<g_t, decltype(upos), decltype(uvweight),
+                                   decltype(ueweight), decltype(ugroups)>
+                 state_t;
+             stepper = std::make_shared<LayoutStepperWrap<g_t, state_t>>
+                 (u, parms, upos, uvweight, ueweight,
+                  pin_map.get_unchecked(num_vertices(u)), ugroups, verbose,
+                  rng);
+         },
+         vertex_floating_vector_properties(), vertex_props_t(), edge_props_t())
+        (pos, vweight, eweight);
+    return stepper;
+}
+
+void sfdp_layout_multilevel(GraphInterface& g, boost::any pos,
+                            boost::any vweight, boost::any eweight,
+                            boost::any pin, boost::any groups,
+                            python::object spring_parms,
+                            python::object coarse_parms, double theta,
+                            double step_schedule, size_t max_level,
+                            double epsilon, size_t max_iter, bool warm,
+                            bool offload, python::object callback,
+                            bool verbose, rng_t& rng)
+{
+    check_offload(offload);
+
+    typedef UnityPropertyMap<int,GraphInterface::vertex_t> vweight_map_t;
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> eweight_map_t;
+    typedef mpl::vector<vprop_map_t<double>::type, vweight_map_t>
+        vertex_props_t;
+    typedef mpl::vector<eprop_map_t<double>::type, eweight_map_t>
+        edge_props_t;
+
+    typedef vprop_map_t<int32_t>::type group_map_t;
+    typedef vprop_map_t<uint8_t>::type pin_map_t;
+
+    double C = python::extract<double>(spring_parms[0]);
+    double p = python::extract<double>(spring_parms[1]);
+    double gamma = python::extract<double>(spring_parms[2]);
+    double mu = python::extract<double>(spring_parms[3]);
+    double mu_p = python::extract<double>(spring_parms[4]);
+
+    string method = python::extract<string>(coarse_parms[0]);
+    double mivs_thres = python::extract<double>(coarse_parms[1]);
+    double ec_thres = python::extract<double>(coarse_parms[2]);
+    bool weighted = python::extract<bool>(coarse_parms[3]);
+
+    if(vweight.empty())
+        vweight = vweight_map_t();
+    if(eweight.empty())
+        eweight = eweight_map_t();
+
+    pin_map_t pin_map = any_cast<pin_map_t>(pin);
+    bool has_groups = !groups.empty();
+    group_map_t group_map;
+    if (has_groups)
+        group_map = any_cast<group_map_t>(groups);
+
+    auto level_callback = [&](size_t level, size_t N, size_t E, double K)
+        {
+            GILAcquire gil;
+            if (callback != python::object())
+                callback(level, N, E, K);
+        };
+
+    size_t N = g.get_num_vertices();
+    size_t E = g.get_num_edges();
+    run_action<graph_tool::detail::never_directed>(true)
+        (g,
+         std::bind(get_sfdp_multilevel_layout(C, p, theta, gamma, mu, mu_p,
+                                              step_schedule, max_level,
+                                              epsilon, max_iter, method,
+                                              mivs_thres, ec_thres, weighted,
+                                              warm, offload),
                    std::placeholders::_1, std::placeholders::_2,
                    std::placeholders::_3, std::placeholders::_4,
                    pin_map.get_unchecked(num_vertices(g.get_graph())),
-                   groups.get_unchecked(num_vertices(g.get_graph())), verbose,
+                   group_map.get_unchecked(num_vertices(g.get_graph())),
+                   has_groups, N, E, std::ref(level_callback), verbose,
                    std::ref(rng)),
          vertex_floating_vector_properties(), vertex_props_t(), edge_props_t())
         (pos, vweight, eweight);
@@ -189,32 +373,6 @@ void propagate_pos_mivs(GraphInterface& gi, boost::any mivs, boost::any pos,
 }
 
 
-struct do_avg_dist
-{
-    template <class Graph, class PosMap>
-    void operator()(Graph& g, PosMap pos, double& ad) const
-    {
-        size_t count = 0;
-        double d = 0;
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            reduction(+: d, count)
-        parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     for (auto a : adjacent_vertices_range(v, g))
-                     {
-                         d += dist(pos[v], pos[a]);
-                         count++;
-                     }
-                 });
-        if (count > 0)
-            d /= count;
-        ad = d;
-    }
-};
-
-
 double avg_dist(GraphInterface& gi, boost::any pos)
 {
     double d;
@@ -253,6 +411,8 @@ void sanitize_pos(GraphInterface& gi, boost::any pos)
 void export_sfdp()
 {
     python::def("sfdp_layout", &sfdp_layout);
+    python::def("sfdp_layout_stepper", &sfdp_layout_stepper);
+    python::def("sfdp_layout_multilevel", &sfdp_layout_multilevel);
     python::def("propagate_pos", &propagate_pos);
     python::def("propagate_pos_mivs", &propagate_pos_mivs);
     python::def("avg_dist", &avg_dist);
@@ -20,6 +20,8 @@
 
 #include <limits>
 #include <iostream>
+#include <array>
+#include <algorithm>
 
 #ifndef __clang__
 #include <ext/numeric>
@@ -37,118 +39,307 @@ namespace graph_tool
 using namespace std;
 using namespace boost;
 
-template <class Pos, class Weight>
+// Quadtree of the vertex positions, stored as flat arrays, which is rebuilt in
+// parallel from scratch at every iteration. The coordinates of the points are
+// kept in separate arrays, so that the forces of the points of a leaf can be
+// summed in vectorized loops (see sum_forces()).
+//
+// The positions are given Morton codes of max_level bits per dimension (at most
+// 31), relative to the bounding box, and the points are sorted by their codes,
+// so that the points of every node lie in a contiguous range. The nodes are
+// created level by level, with the children of each node in consecutive
+// positions, so that only the non-empty children are kept. A node is a leaf if
+// it contains a single point, or is at the maximum level. The weight and
+// center of mass of the nodes are computed from the bottom up.
+template <class Weight>
 class QuadTree
 {
 public:
-    QuadTree(const Pos& ll, const Pos& ur, int max_level)
-        :_ll(ll), _ur(ur), _cm(2, 0), _count(0),
-         _max_level(max_level)
-    {
-        _w = sqrt(power(_ur[0] - _ll[0], 2) +
-                  power(_ur[1] - _ll[1], 2));
-    }
+    typedef std::array<double, 2> pos_t;
 
-    vector<QuadTree>& get_leafs()
+    struct node_t
     {
-        if (_max_level > 0 && _leafs.empty())
+        pos_t cm;             // center of mass
+        Weight count;         // total weight
+        double w;             // diagonal of the box
+        size_t begin, end;    // range of the points
+        size_t children;      // first child
+        uint8_t nchildren;    // number of (non-empty) children
+    };
+
+    // x[v] and y[v] are the coordinates of vertex v
+    template <class Graph, class Coords, class WeightMap, class Pos>
+    void build(Graph& g, const Coords& x, const Coords& y, WeightMap weight,
+               const Pos& ll, const Pos& ur, size_t max_level)
+    {
+        size_t D = std::min(max_level, size_t(31));
+
+        _vs.clear();
+        for (auto v : vertices_range(g))
+            _vs.push_back(v);
+        size_t N = _vs.size();
+
+        _nodes.clear();
+        _levels.clear();
+        if (N == 0)
+            return;
+
+        // Morton codes, with the same convention as splitting the boxes
+        // recursively, where the points on the middle go to the lower half
+        double L = std::pow(2., double(D));
+        uint64_t cmax = (uint64_t(1) << D) - 1;
+        _code.resize(N);
+        #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
         {
-            _leafs.reserve(4);
-            for (size_t i = 0; i < 4; ++i)
+            auto v = _vs[i];
+            pos_t p = {double(x[v]), double(y[v])};
+            uint64_t c = 0;
+            for (size_t j = 0; j < 2; ++j)
             {
-                Pos lll = _ll, lur = _ur;
-                if (i % 2)
-                    lll[0] += (_ur[0] - _ll[0]) / 2;
-                else
-                    lur[0] -= (_ur[0] - _ll[0]) / 2;
-                if (i / 2)
-                    lll[1] += (_ur[1] - _ll[1]) / 2;
-                else
-                    lur[1] -= (_ur[1] - _ll[1]) / 2;
-                _leafs.emplace_back(lll, lur, _max_level - 1);
+                double t = 0;
+                if (ur[j] > ll[j])
+                    t = ceil((p[j] - ll[j]) / (ur[j] - ll[j]) * L) - 1;
+                uint64_t cx = t > 0 ? std::min(uint64_t(t), cmax) : 0;
+                for (size_t k = 0; k < D; ++k)
+                    c |= ((cx >> k) & 1) << (2 * k + j);
             }
+            _code[i] = c;
         }
 
-        return _leafs;
-    }
+        sort_codes(2 * D);
 
-    vector<std::tuple<Pos,Weight> >& get_dense_leafs()
-    {
-        return _dense_leafs;
-    }
-
-    size_t get_branch(Pos& p)
-    {
-        int i = p[0] > (_ll[0] + (_ur[0] - _ll[0]) / 2);
-        int j = p[1] > (_ll[1] + (_ur[1] - _ll[1]) / 2);
-        return i + 2 * j;
-    }
-
-    size_t put_pos(Pos& p, Weight w)
-    {
-        _count += w;
-        _cm[0] += p[0] * w;
-        _cm[1] += p[1] * w;
+        _x.resize(N);
+        _y.resize(N);
+        _w.resize(N);
+        _scode.resize(N);
+        #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = _vs[_order[i]];
+            _x[i] = x[v];
+            _y[i] = y[v];
+            _w[i] = get(weight, v);
+            _scode[i] = _code[_order[i]];
+        }
 
-        if (_max_level == 0 || _count == w)
+        // nodes, level by level
+        node_t root;
+        root.w = sqrt(power(ur[0] - ll[0], 2) + power(ur[1] - ll[1], 2));
+        root.begin = 0;
+        root.end = N;
+        root.nchildren = 0;
+        _nodes.push_back(root);
+        _levels.push_back(0);
+        for (size_t d = 0; _levels.back() < _nodes.size(); ++d)
         {
-            _dense_leafs.emplace_back(p, w);
-            return 1;
+            size_t first = _levels.back();
+            size_t last = _nodes.size();
+            _levels.push_back(last);
+            if (d == D)
+                break;
+
+            size_t shift = 2 * (D - 1 - d);
+            auto get_splits = [&](const node_t& node, std::array<size_t, 5>& split)
+                {
+                    split[0] = node.begin;
+                    split[4] = node.end;
+                    for (size_t b = 1; b < 4; ++b)
+                        split[b] = std::partition_point
+                            (_scode.begin() + split[b - 1],
+                             _scode.begin() + node.end,
+                             [&](uint64_t c) { return ((c >> shift) & 3) < b; })
+                            - _scode.begin();
+                };
+
+            _nchildren.clear();
+            _nchildren.resize(last - first + 1, 0);
+            #pragma omp parallel for schedule(static) \
+                if (last - first > OPENMP_MIN_THRESH)
+            for (size_t i = first; i < last; ++i)
+            {
+                auto& node = _nodes[i];
+                if (node.end - node.begin < 2)
+                    continue;
+                std::array<size_t, 5> split;
+                get_splits(node, split);
+                for (size_t b = 0; b < 4; ++b)
+                {
+                    if (split[b + 1] > split[b])
+                        _nchildren[i - first + 1]++;
+                }
+            }
+            std::partial_sum(_nchildren.begin(), _nchildren.end(),
+                             _nchildren.begin());
+
+            _nodes.resize(last + _nchildren.back());
+            #pragma omp parallel for schedule(static) \
+                if (last - first > OPENMP_MIN_THRESH)
+            for (size_t i = first; i < last; ++i)
+            {
+                auto& node = _nodes[i];
+                node.children = last + _nchildren[i - first];
+                node.nchildren = _nchildren[i - first + 1] - _nchildren[i - first];
+                if (node.nchildren == 0)
+                    continue;
+                std::array<size_t, 5> split;
+                get_splits(node, split);
+                size_t c = node.children;
+                for (size_t b = 0; b < 4; ++b)
+                {
+                    if (split[b + 1] == split[b])
+                        continue;
+                    auto& child = _nodes[c++];
+                    child.w = node.w / 2;
+                    child.begin = split[b];
+                    child.end = split[b + 1];
+                    child.nchildren = 0;
+                }
+            }
         }
-        else
+
+        // weights and centers of mass, from the bottom up
+        for (size_t l = _levels.size() - 1; l > 0; --l)
         {
-            if (!_dense_leafs.empty())
+            size_t first = _levels[l - 1];
+            size_t last = _levels[l];
+            #pragma omp parallel for schedule(static) \
+                if (last - first > OPENMP_MIN_THRESH)
+            for (size_t i = first; i < last; ++i)
             {
-                // move dense leafs down
-                auto& leafs = get_leafs();
-                for (auto& leaf : _dense_leafs)
+                auto& node = _nodes[i];
+                node.count = 0;
+                node.cm = {0, 0};
+                if (node.nchildren == 0)
                 {
-                    auto& lp = get<0>(leaf);
-                    auto& lw = get<1>(leaf);
-                    leafs[get_branch(lp)].put_pos(lp, lw);
+                    for (size_t j = node.begin; j < node.end; ++j)
+                    {
+                        node.count += _w[j];
+                        node.cm[0] += _x[j] * _w[j];
+                        node.cm[1] += _y[j] * _w[j];
+                    }
+                }
+                else
+                {
+                    for (size_t c = node.children;
+                         c < node.children + node.nchildren; ++c)
+                    {
+                        auto& child = _nodes[c];
+                        node.count += child.count;
+                        for (size_t k = 0; k < 2; ++k)
+                            node.cm[k] += child.cm[k];
+                    }
                 }
-                _dense_leafs.clear();
             }
+        }
 
-            size_t sc = (_max_level > 0 && _leafs.empty()) ? 4 : 0;
-            return sc + get_leafs()[get_branch(p)].put_pos(p, w);
+        // the centers of mass were accumulated as weighted sums
+        #pragma omp parallel for schedule(static) \
+            if (_nodes.size() > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < _nodes.size(); ++i)
+        {
+            auto& node = _nodes[i];
+            for (size_t k = 0; k < 2; ++k)
+                node.cm[k] /= node.count;
         }
-        return 0;
     }
 
-    void get_cm(Pos& cm)
-    {
-        for (size_t i = 0; i < 2; ++i)
-            cm[i] = _cm[i] / _count;
-    }
+    bool empty() const { return _nodes.empty(); }
 
-    double get_w() const
-    {
-        return _w;
-    }
+    const node_t& get_node(size_t i) const { return _nodes[i]; }
 
-    Weight get_count()
+    // raw arrays of the nodes and the points, e.g. to be copied to a device
+    size_t num_nodes() const { return _nodes.size(); }
+    size_t num_points() const { return _x.size(); }
+    const node_t* get_nodes() const { return _nodes.data(); }
+    const double* get_x() const { return _x.data(); }
+    const double* get_y() const { return _y.data(); }
+    const Weight* get_w() const { return _w.data(); }
+
+    // Adds to (fx, fy) the sum of w * f(d * d) * (px - x, py - y) over the
+    // points of the node, where (px, py), w and d are their positions, weights
+    // and distances to (x, y).
+    template <class F>
+    void sum_forces(const node_t& node, double x, double y, F&& f, double& fx,
+                    double& fy) const
     {
-        return _count;
+        const double* xs = _x.data();
+        const double* ys = _y.data();
+        const Weight* ws = _w.data();
+        double sx = 0, sy = 0;
+        #pragma omp simd reduction(+:sx, sy)
+        for (size_t j = node.begin; j < node.end; ++j)
+        {
+            double dx = xs[j] - x;
+            double dy = ys[j] - y;
+            double c = ws[j] * f(dx * dx + dy * dy);
+            sx += c * dx;
+            sy += c * dy;
+        }
+        fx += sx;
+        fy += sy;
     }
 
-    int max_level()
+private:
+    // sorts the point indexes by their codes, with a counting sort on the
+    // highest bits, followed by a sort of each bucket, in parallel
+    void sort_codes(size_t bits)
     {
-        return _max_level;
+        size_t N = _code.size();
+        size_t hbits = std::min(bits, size_t(16));
+        size_t shift = bits - hbits;
+        size_t B = size_t(1) << hbits;
+
+        _bpos.clear();
+        _bpos.resize(B + 1, 0);
+        #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            #pragma omp atomic
+            _bpos[(_code[i] >> shift) + 1]++;
+        }
+        std::partial_sum(_bpos.begin(), _bpos.end(), _bpos.begin());
+
+        _order.resize(N);
+        _cursor.assign(_bpos.begin(), _bpos.end() - 1);
+        #pragma omp parallel for schedule(static) if (N > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < N; ++i)
+        {
+            size_t j;
+            #pragma omp atomic capture
+            j = _cursor[_code[i] >> shift]++;
+            _order[j] = i;
+        }
+
+        #pragma omp parallel for schedule(dynamic, 64) if (N > OPENMP_MIN_THRESH)
+        for (size_t b = 0; b < B; ++b)
+        {
+            std::sort(_order.begin() + _bpos[b], _order.begin() + _bpos[b + 1],
+                      [&](size_t i, size_t j)
+                      {
+                          return (std::make_pair(_code[i], i) <
+                                  std::make_pair(_code[j], j));
+                      });
+        }
     }
 
-private:
-    Pos _ll, _ur;
-    vector<QuadTree> _leafs;
-    vector<std::tuple<Pos,Weight> > _dense_leafs;
-    Pos _cm;
-    Weight _count;
-    int _max_level;
-    double _w;
+    vector<node_t> _nodes;
+    vector<size_t> _levels;     // first node of each level
+    vector<double> _x, _y;      // points, in Morton order
+    vector<Weight> _w;
+    vector<uint64_t> _scode;
+
+    // work space
+    vector<size_t> _vs;
+    vector<uint64_t> _code;
+    vector<size_t> _order;
+    vector<size_t> _bpos;
+    vector<size_t> _cursor;
+    vector<size_t> _nchildren;
 };
 
-template <class Pos>
-inline double dist(const Pos& p1, const Pos& p2)
+template <class Pos1, class Pos2>
+inline double dist(const Pos1& p1, const Pos2& p2)
 {
     double r = 0;
     for (size_t i = 0; i < 2; ++i)
@@ -156,8 +347,8 @@ inline double dist(const Pos& p1, const Pos& p2)
     return sqrt(r);
 }
 
-template <class Pos>
-inline double f_r(double C, double K, double p, const Pos& p1, const Pos& p2)
+template <class Pos1, class Pos2>
+inline double f_r(double C, double K, double p, const Pos1& p1, const Pos2& p2)
 {
     double d = dist(p1, p2);
     if (d == 0)
@@ -174,8 +365,8 @@ inline double f_a(double K, const Pos& p1, const Pos& p2)
     return power(dist(p1, p2), 2) / K;
 }
 
-template <class Pos>
-inline double get_diff(const Pos& p1, const Pos& p2, Pos& r)
+template <class Pos1, class Pos2, class Pos>
+inline double get_diff(const Pos1& p1, const Pos2& p2, Pos& r)
 {
     double abs = 0;
     for (size_t i = 0; i < 2; ++i)
@@ -202,6 +393,35 @@ inline double norm(Pos& x)
     return sqrt(abs);
 }
 
+struct do_avg_dist
+{
+    template <class Graph, class PosMap>
+    void operator()(Graph& g, PosMap pos, double& ad) const
+    {
+        size_t count = 0;
+        double d = 0;
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            reduction(+: d, count)
+        parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
+                 {
+                     for (auto a : adjacent_vertices_range(v, g))
+                     {
+                         d += dist(pos[v], pos[a]);
+                         count++;
+                     }
+                 });
+        if (count > 0)
+            d /= count;
+        ad = d;
+    }
+};
+
+template <class Graph, class PosMap, class VertexWeightMap,
+          class EdgeWeightMap, class GroupMap>
+class SFDPState;
+
 struct get_sfdp_layout
 {
     get_sfdp_layout(double C, double K, double p, double theta, double gamma,
@@ -223,263 +443,329 @@ struct get_sfdp_layout
                     EdgeWeightMap eweight, PinMap pin, GroupMap group,
                     bool verbose, RNG& rng) const
     {
-        typedef typename property_traits<PosMap>::value_type pos_t;
-        typedef typename property_traits<PosMap>::value_type::value_type val_t;
-
-        typedef typename property_traits<VertexWeightMap>::value_type vweight_t;
-
-        vector<pos_t> group_cm;
-        vector<vweight_t> group_size;
-        vector<size_t> vertices;
+        SFDPState<Graph, PosMap, VertexWeightMap, EdgeWeightMap, GroupMap>
+            state(*this, g, pos, vweight, eweight, pin, group);
+        while (!state.converged())
+            state.iterate(verbose, rng);
+        state.write_pos();
+    }
+};
 
-        int HN = 0;
+// The state of the SFDP layout between iterations, so that it can be advanced
+// one iteration at a time. During the layout, the coordinates are kept in
+// separate arrays, and only written back to the position map by write_pos().
+template <class Graph, class PosMap, class VertexWeightMap,
+          class EdgeWeightMap, class GroupMap>
+class SFDPState
+{
+public:
+    typedef typename property_traits<PosMap>::value_type::value_type val_t;
+    typedef std::array<val_t, 2> pos_t;
+    typedef typename property_traits<VertexWeightMap>::value_type vweight_t;
+
+    template <class PinMap>
+    SFDPState(const get_sfdp_layout& parms, Graph& g, PosMap pos,
+              VertexWeightMap vweight, EdgeWeightMap eweight, PinMap pin,
+              GroupMap group)
+        : _p(parms), _g(g), _pos(pos), _vweight(vweight), _eweight(eweight),
+          _group(group), _x(num_vertices(g)), _y(num_vertices(g))
+    {
         for (auto v : vertices_range(g))
         {
             if (pin[v] == 0)
-                vertices.push_back(v);
+                _vertices.push_back(v);
             pos[v].resize(2, 0);
-            if (gamma != 0 || mu != 0)
+            _x[v] = pos[v][0];
+            _y[v] = pos[v][1];
+            if (_p.gamma != 0 || _p.mu != 0)
             {
                 size_t s = group[v];
 
-                if (s >= group_cm.size())
+                if (s >= _group_cm.size())
                 {
-                    group_cm.resize(s + 1);
-                    group_size.resize(s + 1, 0);
+                    _group_cm.resize(s + 1, {0, 0});
+                    _group_size.resize(s + 1, 0);
                 }
-                group_cm[s].resize(2, 0);
-                group_size[s] += get(vweight, v);
-
-                for (size_t j = 0; j < 2; ++j)
-                    group_cm[s][j] += pos[v][j] * get(vweight, v);
+                _group_size[s] += get(vweight, v);
             }
-            HN++;
+            _HN++;
         }
 
-        for (size_t s = 0; s < group_size.size(); ++s)
+        double p = _p.p, K = _p.K;
+        _CK = (round(p) == p) ? _p.C * power(K, int(1 + p)) :
+            _p.C * pow(K, 1 + p);
+        _delta = _p.epsilon * K + 1;
+        _E0 = numeric_limits<val_t>::max();
+        _step = _p.init_step;
+    }
+
+    bool converged() const
+    {
+        return (!(_delta > _p.epsilon * _p.K) ||
+                (_p.max_iter > 0 && _n_iter >= _p.max_iter));
+    }
+
+    double get_energy() const { return _E; }
+    double get_delta() const { return _delta; }
+    double get_step() const { return _step; }
+    size_t get_iter() const { return _n_iter; }
+
+    template <class RNG>
+    void iterate(bool verbose, RNG& rng)
+    {
+        auto& g = _g;
+        auto& x = _x;
+        auto& y = _y;
+        auto& qt = _qt;
+        auto& group = _group;
+        auto& group_cm = _group_cm;
+        auto& group_size = _group_size;
+        auto& vweight = _vweight;
+        auto& eweight = _eweight;
+        double K = _p.K, p = _p.p, theta = _p.theta, gamma = _p.gamma,
+            mu = _p.mu, mu_p = _p.mu_p, step = _step;
+        int HN = _HN;
+
+        // repulsive force divided by the distance, as a function of the
+        // squared distance
+        double CK = _CK;
+        auto f_r2 = [CK](double d2) { return d2 > 0 ?
+                                      -CK / (d2 * sqrt(d2)) : 0.; };
+        auto f_rp = [CK, p](double d2)
+            {
+                if (d2 == 0)
+                    return 0.;
+                double d = sqrt(d2);
+                if (round(p) == p)
+                    return -CK / power(d, int(p) + 1);
+                return -CK * pow(d, -(1 + p));
+            };
+
+        val_t delta = 0, E = 0;
+        _E0 = _E;
+
+        pos_t ll, ur;
+        ll.fill(numeric_limits<val_t>::max());
+        ur.fill(-numeric_limits<val_t>::max());
+        for (auto v : vertices_range(g))
         {
-            if (group_size[s] == 0)
-                continue;
-            group_cm[s].resize(2, 0);
-            for (size_t j = 0; j < 2; ++j)
-                group_cm[s][j] /= group_size[s];
+            ll[0] = min(x[v], ll[0]);
+            ll[1] = min(y[v], ll[1]);
+            ur[0] = max(x[v], ur[0]);
+            ur[1] = max(y[v], ur[1]);
         }
 
-        val_t delta = epsilon * K + 1, E = 0, E0;
-        E0 = numeric_limits<val_t>::max();
-        size_t n_iter = 0;
-        val_t step = init_step;
-        size_t progress = 0;
-
-        while (delta > epsilon * K && (max_iter == 0 || n_iter < max_iter))
+        if (gamma != 0 || mu != 0)
         {
-            delta = 0;
-            E0 = E;
-            E = 0;
+            for (size_t s = 0; s < group_size.size(); ++s)
+                group_cm[s] = {0, 0};
 
-            pos_t ll(2, numeric_limits<val_t>::max()),
-                ur(2, -numeric_limits<val_t>::max());
             for (auto v : vertices_range(g))
             {
-                for (size_t j = 0; j < 2; ++j)
-                {
-                    ll[j] = min(pos[v][j], ll[j]);
-                    ur[j] = max(pos[v][j], ur[j]);
-                }
+                size_t s = group[v];
+                group_cm[s][0] += x[v] * get(vweight, v) / group_size[s];
+                group_cm[s][1] += y[v] * get(vweight, v) / group_size[s];
             }
+        }
 
-            if (gamma != 0 || mu != 0)
-            {
-                for (size_t s = 0; s < group_size.size(); ++s)
-                {
-                    if (group_size[s] == 0)
-                        continue;
-                    group_cm[s] = {0, 0};
-                }
-
-                for (auto v : vertices_range(g))
-                {
-                    size_t s = group[v];
-                    for (size_t j = 0; j < 2; ++j)
-                        group_cm[s][j] += pos[v][j] * get(vweight, v) /
-                            group_size[s];
-                }
-            }
+        qt.build(g, x, y, vweight, ll, ur, _p.max_level);
 
-            QuadTree<pos_t, vweight_t> qt(ll, ur, max_level);
-            for (auto v : vertices_range(g))
-                qt.put_pos(pos[v], vweight[v]);
+        std::shuffle(_vertices.begin(), _vertices.end(), rng);
 
-            std::shuffle(vertices.begin(), vertices.end(), rng);
+        size_t nmoves = 0;
+        vector<size_t> Q;
 
-            size_t nmoves = 0;
-            vector<QuadTree<pos_t, vweight_t>*> Q;
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            private(Q) reduction(+:E, delta, nmoves)
+        parallel_loop_no_spawn
+            (_vertices,
+             [&](size_t, auto v)
+             {
+                 double xv = x[v], yv = y[v];
 
-            #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-                private(Q) reduction(+:E, delta, nmoves)
-            parallel_loop_no_spawn
-                (vertices,
-                 [&](size_t, auto v)
+                 // global repulsive forces
+                 double fx = 0, fy = 0;
+                 Q.push_back(0);
+                 while (!Q.empty())
                  {
-                     pos_t diff(2, 0), pos_u(2, 0), ftot(2, 0), cm(2, 0);
+                     auto& q = qt.get_node(Q.back());
+                     Q.pop_back();
 
-                     // global repulsive forces
-                     Q.push_back(&qt);
-                     while (!Q.empty())
+                     if (q.nchildren == 0)
                      {
-                         auto& q = *Q.back();
-                         Q.pop_back();
-
-                         auto& dleafs = q.get_dense_leafs();
-                         if (!dleafs.empty())
-                         {
-                             for (auto& dleaf : dleafs)
-                             {
-                                 val_t d = get_diff(get<0>(dleaf), pos[v], diff);
-                                 if (d == 0)
-                                     continue;
-                                 val_t f = f_r(C, K, p, pos[v], get<0>(dleaf));
-                                 f *= get<1>(dleaf) * get(vweight, v);
-                                 for (size_t l = 0; l < 2; ++l)
-                                     ftot[l] += f * diff[l];
-                             }
-                         }
+                         if (p == 2)
+                             qt.sum_forces(q, xv, yv, f_r2, fx, fy);
                          else
-                         {
-                             double w = q.get_w();
-                             q.get_cm(cm);
-                             double d = get_diff(cm, pos[v], diff);
-                             if (w > theta * d)
-                             {
-                                 for (auto& leaf : q.get_leafs())
-                                 {
-                                     if (leaf.get_count() > 0)
-                                         Q.push_back(&leaf);
-                                 }
-                             }
-                             else
-                             {
-                                 if (d > 0)
-                                 {
-                                     val_t f = f_r(C, K, p, cm, pos[v]);
-                                     f *= q.get_count() * get(vweight, v);
-                                     for (size_t l = 0; l < 2; ++l)
-                                         ftot[l] += f * diff[l];
-                                 }
-                             }
-                         }
+                             qt.sum_forces(q, xv, yv, f_rp, fx, fy);
+                         continue;
                      }
 
-                     // local attractive forces
-                     auto& pos_v = pos[v];
-                     for (auto e : out_edges_range(v, g))
+                     double dx = q.cm[0] - xv;
+                     double dy = q.cm[1] - yv;
+                     double d2 = dx * dx + dy * dy;
+                     double d = (d2 > 0) ? sqrt(d2) : 1;
+                     if (q.w > theta * d)
                      {
-                         auto u = target(e, g);
-                         if (u == v)
-                             continue;
-                         pos_u = pos[u];
-                         get_diff(pos_u, pos_v, diff);
-                         val_t f = f_a(K, pos_u, pos_v);
-                         f *= get(eweight, e) * get(vweight, u) * get(vweight, v);
-                         for (size_t l = 0; l < 2; ++l)
-                             ftot[l] += f * diff[l];
-                     }
-
-                     // inter-group attractive forces
-                     if (gamma > 0)
-                     {
-                         for (size_t s = 0; s < group_cm.size(); ++s)
+                         for (size_t c = q.children;
+                              c < q.children + q.nchildren; ++c)
                          {
-                             if (group_size[s] == 0)
-                                 continue;
-                             if (s == size_t(group[v]))
-                                 continue;
-                             val_t d = get_diff(group_cm[s], pos[v], diff);
-                             if (d == 0)
-                                 continue;
-                             double Kp = K * power(HN, 2);
-                             val_t f = f_a(Kp, group_cm[s], pos[v]) * gamma * \
-                                 group_size[s] * get(vweight, v);
-                             for (size_t l = 0; l < 2; ++l)
-                                 ftot[l] += f * diff[l];
+                             if (qt.get_node(c).count > 0)
+                                 Q.push_back(c);
                          }
                      }
-
-                     // inter-group repulsive forces
-                     if (gamma < 0)
+                     else
                      {
-                         for (size_t s = 0; s < group_cm.size(); ++s)
-                         {
-                             if (group_size[s] == 0)
-                                 continue;
-                             if (s == size_t(group[v]))
-                                 continue;
-                             val_t d = get_diff(group_cm[s], pos[v], diff);
-                             if (d == 0)
-                            continue;
-                             val_t f = f_r(C, K, p, cm, pos[v]);
-                             f *= group_size[s] * get(vweight, v) * abs(gamma);
-                             for (size_t l = 0; l < 2; ++l)
-                                 ftot[l] += f * diff[l];
-                         }
+                         double f = q.count * ((p == 2) ? f_r2(d2) :
+                                               f_rp(d2));
+                         fx += f * dx;
+                         fy += f * dy;
                      }
-
-                     // intra-group attractive forces
-                     if (mu > 0 && group_size[group[v]] > 1)
+                 }
+                 fx *= get(vweight, v);
+                 fy *= get(vweight, v);
+
+                 // attraction to (cx, cy), with a force of strength
+                 // c * d^2 / Kp
+                 auto attract = [&](double cx, double cy, double Kp,
+                                    double c)
                      {
-                         val_t d = get_diff(group_cm[group[v]], pos[v], diff);
-                         if (d > 0)
-                         {
-                             double Kp = K * pow(double(group_size[group[v]]), mu_p);
-                             val_t f = f_a(Kp, group_cm[group[v]], pos[v]) * mu * \
-                                 group_size[group[v]] * get(vweight, v);
-                             for (size_t l = 0; l < 2; ++l)
-                                 ftot[l] += f * diff[l];
-                         }
+                         double dx = cx - xv;
+                         double dy = cy - yv;
+                         double d2 = dx * dx + dy * dy;
+                         if (d2 == 0)
+                             return;
+                         double f = c * sqrt(d2) / Kp;
+                         fx += f * dx;
+                         fy += f * dy;
+                     };
+
+                 // local attractive forces
+                 for (auto e : out_edges_range(v, g))
+                 {
+                     auto u = target(e, g);
+                     if (u == v)
+                         continue;
+                     attract(x[u], y[u], K,
+                             get(eweight, e) * get(vweight, u) *
+                             get(vweight, v));
+                 }
+
+                 // inter-group attractive forces
+                 if (gamma > 0)
+                 {
+                     double Kp = K * power(double(HN), 2);
+                     for (size_t s = 0; s < group_cm.size(); ++s)
+                     {
+                         if (group_size[s] == 0)
+                             continue;
+                         if (s == size_t(group[v]))
+                             continue;
+                         attract(group_cm[s][0], group_cm[s][1], Kp,
+                                 gamma * group_size[s] * get(vweight, v));
                      }
+                 }
 
-                     E += power(norm(ftot), 2);
-
-                     for (size_t l = 0; l < 2; ++l)
+                 // inter-group repulsive forces
+                 if (gamma < 0)
+                 {
+                     for (size_t s = 0; s < group_cm.size(); ++s)
                      {
-                         ftot[l] *= step;
-                         pos[v][l] += ftot[l];
+                         if (group_size[s] == 0)
+                             continue;
+                         if (s == size_t(group[v]))
+                             continue;
+                         double dx = group_cm[s][0] - xv;
+                         double dy = group_cm[s][1] - yv;
+                         double d2 = dx * dx + dy * dy;
+                         double f = ((p == 2) ? f_r2(d2) : f_rp(d2)) *
+                             group_size[s] * get(vweight, v) * abs(gamma);
+                         fx += f * dx;
+                         fy += f * dy;
                      }
+                 }
 
-                     delta += norm(ftot);
-                     nmoves++;
-                 });
-
-            n_iter++;
+                 // intra-group attractive forces
+                 if (mu > 0 && group_size[group[v]] > 1)
+                 {
+                     auto& cm = group_cm[group[v]];
+                     double Kp = K * pow(double(group_size[group[v]]), mu_p);
+                     attract(cm[0], cm[1], Kp,
+                             mu * group_size[group[v]] * get(vweight, v));
+                 }
+
+                 // move by step in the direction of the force
+                 double ftot = sqrt(fx * fx + fy * fy);
+                 E += power(ftot, 2);
+                 if (ftot > 0)
+                 {
+                     x[v] += step * fx / ftot;
+                     y[v] += step * fy / ftot;
+                     delta += step;
+                 }
+                 nmoves++;
+             });
+
+        _n_iter++;
+        if (nmoves > 0)
             delta /= nmoves;
+        _E = E;
+        _delta = delta;
 
-            if (verbose)
-                cout << n_iter << " " << E << " " << step << " "
-                     << delta << " " << max_level << endl;
+        if (verbose)
+            cout << _n_iter << " " << _E << " " << _step << " "
+                 << _delta << " " << _p.max_level << endl;
 
-            if (simple)
+        if (_p.simple)
+        {
+            _step *= _p.step_schedule;
+        }
+        else
+        {
+            if (_E < _E0)
             {
-                step *= step_schedule;
+                ++_progress;
+                if (_progress >= 5)
+                {
+                    _progress = 0;
+                    _step /= _p.step_schedule;
+                }
             }
             else
             {
-                if (E < E0)
-                {
-                    ++progress;
-                    if (progress >= 5)
-                    {
-                        progress = 0;
-                        step /= step_schedule;
-                    }
-                }
-                else
-                {
-                    progress = 0;
-                    step *= step_schedule;
-                }
+                _progress = 0;
+                _step *= _p.step_schedule;
             }
         }
     }
+
+    void write_pos()
+    {
+        for (auto v : vertices_range(_g))
+        {
+            _pos[v][0] = _x[v];
+            _pos[v][1] = _y[v];
+        }
+    }
+
+private:
+    get_sfdp_layout _p;
+    Graph& _g;
+    PosMap _pos;
+    VertexWeightMap _vweight;
+    EdgeWeightMap _eweight;
+    GroupMap _group;
+
+    vector<val_t> _x, _y;
+    vector<pos_t> _group_cm;
+    vector<vweight_t> _group_size;
+    vector<size_t> _vertices;
+    int _HN = 0;
+    double _CK;
+    QuadTree<vweight_t> _qt;
+
+    val_t _delta, _E = 0, _E0, _step;
+    size_t _n_iter = 0;
+    size_t _progress = 0;
 };
 
 } // namespace graph_tool
@@ -0,0 +1,633 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SFDP_MULTILEVEL_HH
+#define GRAPH_SFDP_MULTILEVEL_HH
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <memory>
+
+#include "graph_adaptor.hh"
+#include "graph_parallel_traversal.hh"
+#include "graph_trace.hh"
+#include "hash_map_wrap.hh"
+#include "../topology/graph_components.hh"
+#include "../topology/graph_maximal_vertex_set.hh"
+#include "graph_sfdp.hh"
+#include "graph_sfdp_offload.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// One level of the multilevel hierarchy: the coarse graph (with each edge
+// stored once), its vertex and edge weights, summed over the vertices and
+// edges of the finer level, and the coarse vertex of each vertex of the finer
+// level. If the level was obtained from a MIVS, the vertices of the finer level
+// that belong to it are marked in mivs, which is otherwise empty.
+struct sfdp_level
+{
+    typedef vprop_map_t<double>::type::unchecked_t vcount_t;
+    typedef eprop_map_t<double>::type::unchecked_t ecount_t;
+
+    adj_list<size_t> g;
+    vcount_t vcount;
+    ecount_t ecount;
+    vector<size_t> c;
+    vector<uint8_t> mivs;
+};
+
+// Heavy-edge matching, by handshaking: in each round every unmatched vertex
+// points to the unmatched neighbor with the largest edge weight (with ties
+// broken by a random priority of the pair), and the vertices pointing to each
+// other are matched. The heaviest remaining edge is matched in every round,
+// but on some graphs (e.g. paths with increasing weights) only that one, hence
+// after max_rounds the remaining vertices are matched greedily, in sequence.
+// Unmatched vertices have match[v] == v.
+template <class Graph, class EWeight>
+void sfdp_heavy_edge_matching(const Graph& g, EWeight eweight,
+                              vector<size_t>& match, uint64_t seed,
+                              size_t max_rounds = 8)
+{
+    constexpr size_t null = numeric_limits<size_t>::max();
+    size_t N = num_vertices(g);
+    match.clear();
+    match.resize(N, null);
+    vector<size_t> best(N, null);
+
+    auto get_best = [&](size_t v)
+        {
+            size_t u_max = null;
+            double w_max = 0;
+            uint64_t h_max = 0;
+            for (auto e : out_edges_range(vertex(v, g), g))
+            {
+                size_t u = target(e, g);
+                if (u == v || match[u] != null)
+                    continue;
+                double w = get(eweight, e);
+                uint64_t h = random_priority(random_priority(seed, min(u, v)),
+                                             max(u, v));
+                if (u_max == null || w > w_max || (w == w_max && h > h_max))
+                {
+                    u_max = u;
+                    w_max = w;
+                    h_max = h;
+                }
+            }
+            return u_max;
+        };
+
+    for (size_t r = 0; r < max_rounds; ++r)
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 best[v] = (match[v] == null) ? get_best(v) : null;
+             });
+
+        size_t nmatched = 0;
+        #pragma omp parallel if (N > OPENMP_MIN_THRESH) reduction(+:nmatched)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 size_t u = best[v];
+                 if (u != null && best[u] == size_t(v))
+                 {
+                     match[v] = u;
+                     ++nmatched;
+                 }
+             });
+
+        // if no pair is mutual, no edges are left between unmatched vertices
+        if (nmatched == 0)
+            break;
+    }
+
+    for (auto v : vertices_range(g))
+    {
+        if (match[v] != null)
+            continue;
+        size_t u = get_best(v);
+        if (u != null)
+        {
+            match[v] = u;
+            match[u] = v;
+        }
+    }
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             if (match[v] == null)
+                 match[v] = v;
+         });
+}
+
+// Builds the coarse graph of g for the partition l.c (with labels in [0, Nc)),
+// without self-loops or parallel edges, and with the vertex and edge weights
+// summed over each coarse vertex and edge. The edges are put in buckets by
+// their smallest coarse endpoint, via a counting sort, and then sorted within
+// each bucket by the other endpoint and their weight, so that the result does
+// not depend on the number of threads.
+template <class Graph, class VWeight, class EWeight>
+void sfdp_condense(const Graph& g, VWeight vweight, EWeight eweight,
+                   size_t Nc, sfdp_level& l)
+{
+    auto& c = l.c;
+
+    l.vcount = sfdp_level::vcount_t(typed_identity_property_map<size_t>(), Nc);
+    auto& vcount = l.vcount.get_storage();
+    for (auto v : vertices_range(g))
+        vcount[c[v]] += get(vweight, v);
+
+    std::unique_ptr<std::atomic<size_t>[]> count(new std::atomic<size_t>[Nc]);
+    #pragma omp parallel for if (Nc > OPENMP_MIN_THRESH) schedule(runtime)
+    for (size_t r = 0; r < Nc; ++r)
+        count[r] = 0;
+
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             size_t r = c[source(e, g)];
+             size_t s = c[target(e, g)];
+             if (r != s)
+                 ++count[min(r, s)];
+         });
+
+    vector<size_t> begin(Nc + 1, 0);
+    for (size_t r = 0; r < Nc; ++r)
+    {
+        begin[r + 1] = begin[r] + count[r];
+        count[r] = 0;
+    }
+
+    vector<pair<size_t, double>> es(begin[Nc]);
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             size_t r = c[source(e, g)];
+             size_t s = c[target(e, g)];
+             if (r == s)
+                 return;
+             if (s < r)
+                 std::swap(r, s);
+             es[begin[r] + count[r]++] = {s, double(get(eweight, e))};
+         });
+
+    // distinct coarse edges in each bucket
+    vector<size_t> ne(Nc + 1, 0);
+    #pragma omp parallel for if (Nc > OPENMP_MIN_THRESH) schedule(runtime)
+    for (size_t r = 0; r < Nc; ++r)
+    {
+        auto iter = es.begin() + begin[r];
+        auto end = es.begin() + begin[r + 1];
+        std::sort(iter, end);
+        for (; iter != end; ++iter)
+        {
+            if (iter == es.begin() + begin[r] ||
+                iter->first != (iter - 1)->first)
+                ++ne[r + 1];
+        }
+    }
+    for (size_t r = 0; r < Nc; ++r)
+        ne[r + 1] += ne[r];
+
+    vector<std::array<size_t, 2>> cedges(ne[Nc]);
+    vector<double> ecount(ne[Nc], 0);
+    #pragma omp parallel for if (Nc > OPENMP_MIN_THRESH) schedule(runtime)
+    for (size_t r = 0; r < Nc; ++r)
+    {
+        size_t j = ne[r];
+        for (size_t i = begin[r]; i < begin[r + 1]; ++i)
+        {
+            if (i > begin[r] && es[i].first != es[i - 1].first)
+                ++j;
+            cedges[j] = {r, es[i].first};
+            ecount[j] += es[i].second;
+        }
+    }
+
+    l.g = adj_list<size_t>();
+    for (size_t r = 0; r < Nc; ++r)
+        add_vertex(l.g);
+    add_edges(cedges, l.g);
+
+    l.ecount = sfdp_level::ecount_t(adj_edge_index_property_map<size_t>(),
+                                    ne[Nc]);
+    l.ecount.get_storage().swap(ecount);
+}
+
+// Coarsens g into l, by heavy-edge matching ("edge collapse") if mivs is
+// false, or otherwise by joining each vertex to a neighbor in a maximal
+// independent vertex set (MIVS) of high-degree vertices. If has_groups is true,
+// the coarse vertices are instead the given groups. The coarse vertices are
+// labeled in the order of their first vertex in g.
+template <class Graph, class VWeight, class EWeight, class GroupMap>
+void sfdp_coarsen(const Graph& g, VWeight vweight, EWeight eweight, bool mivs,
+                  GroupMap groups, bool has_groups, uint64_t seed,
+                  sfdp_level& l)
+{
+    size_t N = num_vertices(g);
+    vector<size_t> rep(N);
+
+    l.mivs.clear();
+    if (has_groups)
+    {
+        typedef typename property_traits<GroupMap>::value_type group_t;
+        gt_hash_map<group_t, size_t> first;
+        for (auto v : vertices_range(g))
+        {
+            auto iter = first.find(groups[v]);
+            if (iter == first.end())
+                iter = first.insert({groups[v], v}).first;
+            rep[v] = iter->second;
+        }
+    }
+    else if (mivs)
+    {
+        vprop_map_t<uint8_t>::type::unchecked_t
+            mvs(typed_identity_property_map<size_t>(), N);
+        do_maximal_vertex_set()(g, mvs, true, seed);
+        l.mivs.swap(mvs.get_storage());
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 rep[v] = v;
+                 if (l.mivs[v])
+                     return;
+                 for (auto u : out_neighbors_range(v, g))
+                 {
+                     if (l.mivs[u])
+                     {
+                         rep[v] = u;
+                         break;
+                     }
+                 }
+             });
+    }
+    else
+    {
+        sfdp_heavy_edge_matching(g, eweight, rep, seed);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 rep[v] = min(size_t(v), rep[v]);
+             });
+    }
+
+    vector<size_t> hist;
+    unchecked_vector_property_map<size_t, typed_identity_property_map<size_t>>
+        c(typed_identity_property_map<size_t>(), N);
+    label_by_representative(g, rep, c, hist);
+    l.c.swap(c.get_storage());
+
+    sfdp_condense(g, vweight, eweight, hist.size(), l);
+}
+
+// Sets the finer positions pos from the coarse ones, cpos. Each vertex gets the
+// position of its coarse vertex, moved randomly by up to delta in each
+// direction. If the level was obtained from a MIVS, only its vertices get the
+// coarse positions (without noise), and the others get the average position of
+// their neighbors in it, moved randomly only if there is a single one.
+template <class Graph, class CPosMap, class PosMap>
+void sfdp_prolong(const Graph& g, const sfdp_level& l, CPosMap cpos,
+                  PosMap pos, double delta, uint64_t seed)
+{
+    auto& c = l.c;
+    auto& mivs = l.mivs;
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto& p = pos[v];
+             p.resize(2);
+             bool noise = mivs.empty();
+             if (mivs.empty() || mivs[v])
+             {
+                 for (size_t j = 0; j < 2; ++j)
+                     p[j] = cpos[c[v]][j];
+             }
+             else
+             {
+                 size_t count = 0;
+                 p[0] = p[1] = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                 {
+                     if (!mivs[u])
+                         continue;
+                     for (size_t j = 0; j < 2; ++j)
+                         p[j] += cpos[c[u]][j];
+                     ++count;
+                 }
+                 if (count == 0)
+                 {
+                     for (size_t j = 0; j < 2; ++j)
+                         p[j] = cpos[c[v]][j];
+                 }
+                 for (size_t j = 0; j < 2 && count > 1; ++j)
+                     p[j] /= count;
+                 noise = count <= 1;
+             }
+             if (noise && delta > 0)
+             {
+                 counter_rng rng(random_priority(seed, v));
+                 for (size_t j = 0; j < 2; ++j)
+                     p[j] += delta * (2 * rng.uniform() - 1);
+             }
+         });
+}
+
+// Sets the coarse positions cpos to the average of the finer ones.
+template <class Graph, class PosMap, class CPosMap>
+void sfdp_restrict(const Graph& g, const sfdp_level& l, PosMap pos,
+                   CPosMap cpos)
+{
+    size_t Nc = num_vertices(l.g);
+    vector<size_t> count(Nc, 0);
+    for (size_t r = 0; r < Nc; ++r)
+        cpos[r].assign(2, 0);
+    for (auto v : vertices_range(g))
+    {
+        auto& p = cpos[l.c[v]];
+        for (size_t j = 0; j < 2; ++j)
+            p[j] += pos[v][j];
+        ++count[l.c[v]];
+    }
+    for (size_t r = 0; r < Nc; ++r)
+    {
+        for (size_t j = 0; j < 2; ++j)
+            cpos[r][j] /= count[r];
+    }
+}
+
+template <class Graph, class PosMap>
+double sfdp_avg_dist(Graph& g, PosMap pos)
+{
+    double d;
+    do_avg_dist()(g, pos, d);
+    if (std::isnan(d) || d == 0)
+        d = 1;
+    return d;
+}
+
+// The multilevel SFDP layout of [hu-multilevel-2005]: the graph is coarsened
+// repeatedly, by edge collapse ("ec"), MIVS ("mivs"), or edge collapse until it
+// stops being effective, and then MIVS ("hybrid"), until the relative size of
+// the coarse graphs goes above the respective threshold. The coarsest graph is
+// laid out from random positions (or, if warm is true, from the average of the
+// initial positions), and every finer level is laid out from the positions of
+// the next coarser one, with the optimal edge length scaled by 0.75 at each
+// level, unless the coarse graphs are weighted (in which case the vertex and
+// edge weights are the summed weights of the finer levels).
+//
+// Before each level is laid out, callback(level, N, E, K) is called, with the
+// levels counted from the coarsest one. If offload is true (and offloading
+// was enabled during compilation), every level is laid out with
+// get_sfdp_layout_offload.
+struct get_sfdp_multilevel_layout
+{
+    get_sfdp_multilevel_layout(double C, double p, double theta, double gamma,
+                               double mu, double mu_p, double step_schedule,
+                               size_t max_level, double epsilon,
+                               size_t max_iter, string method,
+                               double mivs_thres, double ec_thres,
+                               bool weighted, bool warm, bool offload)
+        : C(C), p(p), theta(theta), gamma(gamma), mu(mu), mu_p(mu_p),
+          step_schedule(step_schedule), epsilon(epsilon),
+          mivs_thres(mivs_thres), ec_thres(ec_thres), max_level(max_level),
+          max_iter(max_iter), method(method), weighted(weighted), warm(warm),
+          offload(offload) {}
+
+    double C, p, theta, gamma, mu, mu_p, step_schedule, epsilon, mivs_thres,
+        ec_thres;
+    size_t max_level, max_iter;
+    string method;
+    bool weighted, warm, offload;
+
+    template <class Graph, class PosMap, class VertexWeightMap,
+              class EdgeWeightMap, class PinMap, class GroupMap, class Callback,
+              class RNG>
+    void operator()(Graph& g, PosMap pos, VertexWeightMap vweight,
+                    EdgeWeightMap eweight, PinMap pin, GroupMap group,
+                    bool has_groups, size_t N, size_t E, Callback&& callback,
+                    bool verbose, RNG& rng) const
+    {
+        typedef vprop_map_t<vector<double>>::type::unchecked_t cpos_t;
+        typedef undirected_adaptor<adj_list<size_t>> cgraph_t;
+
+        if (method != "hybrid" && method != "ec" && method != "mivs")
+            throw ValueException("invalid coarsening method: " + method);
+
+        if (N <= 1)
+            return;
+        if (N == 2)
+        {
+            vector<size_t> vs;
+            for (auto v : vertices_range(g))
+                vs.push_back(v);
+            pos[vs[0]] = {0, 0};
+            pos[vs[1]] = {1, 1};
+            return;
+        }
+
+        auto get_seed = [&]()
+            {
+                uint64_t seed = rng();
+                return (seed << 32) | rng();
+            };
+
+        vector<std::shared_ptr<sfdp_level>> levels;
+        bool mivs = (method == "mivs");
+        while (true)
+        {
+            auto l = std::make_shared<sfdp_level>();
+            size_t Nf;
+            if (levels.empty())
+            {
+                sfdp_coarsen(g, vweight, eweight, mivs, group, has_groups,
+                             get_seed(), *l);
+                Nf = N;
+            }
+            else
+            {
+                auto& lb = *levels.back();
+                cgraph_t u(lb.g);
+                sfdp_coarsen(u, lb.vcount, lb.ecount, mivs, group, false,
+                             get_seed(), *l);
+                Nf = num_vertices(lb.g);
+            }
+
+            size_t Nc = num_vertices(l->g);
+            double thres = mivs ? mivs_thres : ec_thres;
+            if (Nc >= thres * Nf)
+            {
+                if (method == "hybrid" && !mivs)
+                    mivs = true;
+                else
+                    break;
+            }
+            if (Nc <= 2)
+                break;
+            levels.push_back(l);
+
+            if (verbose)
+                cout << "Coarse level (" << (l->mivs.empty() ? "EC" : "MIVS")
+                     << "): " << levels.size() + 1 << " num vertices: " << Nc
+                     << endl;
+        }
+
+        size_t L = levels.size();
+
+        // positions of the coarse levels, and of the coarsest one
+        vector<cpos_t> cpos(L);
+        for (size_t i = 0; i < L; ++i)
+            cpos[i] = cpos_t(typed_identity_property_map<size_t>(),
+                             num_vertices(levels[i]->g));
+        if (warm)
+        {
+            for (auto v : vertices_range(g))
+                pos[v].resize(2, 0);
+            for (size_t i = 0; i < L; ++i)
+            {
+                if (i == 0)
+                    sfdp_restrict(g, *levels[i], pos, cpos[i]);
+                else
+                    sfdp_restrict(cgraph_t(levels[i - 1]->g), *levels[i],
+                                  cpos[i - 1], cpos[i]);
+            }
+        }
+        else
+        {
+            auto init_pos = [&](auto& u, auto& upos, size_t Nu)
+                {
+                    uniform_real_distribution<double> sample(0, sqrt(Nu));
+                    for (auto v : vertices_range(u))
+                    {
+                        upos[v].resize(2);
+                        for (size_t j = 0; j < 2; ++j)
+                            upos[v][j] = sample(rng);
+                    }
+                };
+            if (L == 0)
+                init_pos(g, pos, N);
+            else
+                init_pos(levels.back()->g, cpos.back(),
+                         num_vertices(levels.back()->g));
+        }
+
+        double K;
+        if (L == 0)
+        {
+            K = sfdp_avg_dist(g, pos);
+        }
+        else
+        {
+            cgraph_t u(levels.back()->g);
+            K = sfdp_avg_dist(u, cpos.back());
+        }
+
+        auto layout = [&](auto& u, auto upos, auto uvweight, auto ueweight,
+                          auto upin, auto ugroup, size_t Nu, size_t Eu,
+                          size_t count)
+            {
+                if (verbose)
+                    cout << "Positioning level: " << count << " " << Nu
+                         << " with K = " << K << " ..." << endl;
+                callback(count, Nu, Eu, K);
+                GT_TRACE_PHASE("sfdp_level");
+                GT_TRACE_COUNTER("sfdp_level_vertices", Nu);
+
+                double init_step = 2 * max(sfdp_avg_dist(u, upos), K);
+                size_t ulevel = (Nu <= 50) ? 0 : max_level;
+#ifdef HAVE_OPENMP_OFFLOAD
+                if (offload)
+                    get_sfdp_layout_offload(C, K, p, theta, gamma, mu, mu_p,
+                                            init_step, step_schedule, ulevel,
+                                            epsilon, max_iter, true)
+                        (u, upos, uvweight, ueweight, upin, ugroup, false,
+                         rng);
+                else
+#endif
+                    get_sfdp_layout(C, K, p, theta, gamma, mu, mu_p, init_step,
+                                    step_schedule, ulevel, epsilon, max_iter,
+                                    true)
+                        (u, upos, uvweight, ueweight, upin, ugroup, false,
+                         rng);
+
+                if (verbose)
+                    cout << "avg edge distance: " << sfdp_avg_dist(u, upos)
+                         << endl;
+            };
+
+        for (size_t count = 0; count < L; ++count)
+        {
+            size_t i = L - 1 - count;
+            auto& l = *levels[i];
+            cgraph_t u(l.g);
+            size_t Nu = num_vertices(l.g);
+
+            vprop_map_t<int32_t>::type::unchecked_t
+                ugroup(typed_identity_property_map<size_t>(), Nu);
+            vector<size_t> hist;
+            label_components()(u, ugroup, hist);
+
+            ConstantPropertyMap<uint8_t, size_t> upin(0);
+            if (weighted)
+                layout(u, cpos[i], l.vcount, l.ecount, upin, ugroup, Nu,
+                       num_edges(l.g), count);
+            else
+                layout(u, cpos[i],
+                       UnityPropertyMap<int, size_t>(),
+                       UnityPropertyMap<int, GraphInterface::edge_t>(),
+                       upin, ugroup, Nu, num_edges(l.g), count);
+
+            if (verbose)
+                cout << "propagating..." << endl;
+
+            if (i > 0)
+                sfdp_prolong(cgraph_t(levels[i - 1]->g), l, cpos[i],
+                             cpos[i - 1], K / 1000., get_seed());
+            else
+                sfdp_prolong(g, l, cpos[i], pos, K / 1000., get_seed());
+
+            if (!weighted)
+                K *= 0.75;
+        }
+
+        if (!has_groups)
+        {
+            vector<size_t> hist;
+            label_components()(g, group, hist);
+        }
+        layout(g, pos, vweight, eweight, pin, group, N, E, L);
+    }
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_SFDP_MULTILEVEL_HH
@@ -0,0 +1,366 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SFDP_OFFLOAD_HH
+#define GRAPH_SFDP_OFFLOAD_HH
+
+#include <vector>
+#include <limits>
+#include <iostream>
+
+#include "graph_sfdp.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+#pragma omp declare target
+
+// repulsive force divided by the distance, as a function of the squared
+// distance; ip is the exponent p if it is an integer, or -1 otherwise
+inline double sfdp_offload_f_r(double d2, double CK, double p, int ip)
+{
+    if (d2 == 0)
+        return 0;
+    if (ip == 2)
+        return -CK / (d2 * sqrt(d2));
+    double d = sqrt(d2);
+    if (ip >= 0)
+    {
+        double r = d;
+        for (int k = 0; k < ip; ++k)
+            r *= d;
+        return -CK / r;
+    }
+    return -CK * pow(d, -(1 + p));
+}
+
+#pragma omp end declare target
+
+// The SFDP layout, with the forces computed on an accelerator device with
+// OpenMP offloading. The parameters and the force model are the same as in
+// get_sfdp_layout, but all vertices are moved simultaneously, from the
+// positions of the previous iteration, instead of one after the other.
+//
+// The graph, the weights, the groups and the positions stay in device memory
+// during the whole layout. The quadtree is still built on the host, so at
+// each iteration the positions are copied from the device, and the tree is
+// copied to it. If no device is available, the same code runs on the host.
+struct get_sfdp_layout_offload : public get_sfdp_layout
+{
+    using get_sfdp_layout::get_sfdp_layout;
+
+    template <class Graph, class PosMap, class VertexWeightMap,
+              class EdgeWeightMap, class PinMap, class GroupMap, class RNG>
+    void operator()(Graph& g, PosMap pos, VertexWeightMap vweight,
+                    EdgeWeightMap eweight, PinMap pin, GroupMap group,
+                    bool verbose, RNG&) const
+    {
+        typedef typename property_traits<VertexWeightMap>::value_type vweight_t;
+        typedef typename QuadTree<vweight_t>::node_t node_t;
+        typedef std::array<double, 2> pos_t;
+
+        size_t N = num_vertices(g);
+        vector<double> x(N), y(N), nx(N), ny(N), vw(N);
+        vector<int32_t> vgroup(N, 0);
+        vector<size_t> vertices;
+        bool has_groups = (gamma != 0 || mu != 0);
+        vector<double> gx, gy, gsize;
+
+        int HN = 0;
+        for (auto v : vertices_range(g))
+        {
+            if (pin[v] == 0)
+                vertices.push_back(v);
+            pos[v].resize(2, 0);
+            x[v] = pos[v][0];
+            y[v] = pos[v][1];
+            vw[v] = get(vweight, v);
+            if (has_groups)
+            {
+                size_t s = group[v];
+                if (s >= gsize.size())
+                    gsize.resize(s + 1, 0);
+                gsize[s] += vw[v];
+                vgroup[v] = s;
+            }
+            HN++;
+        }
+        size_t G = gsize.size();
+        gx.resize(G);
+        gy.resize(G);
+
+        // adjacency list, with the coefficients of the attractive forces
+        vector<size_t> eoffset(N + 1, 0), etarget;
+        vector<double> ecoef;
+        for (auto v : vertices_range(g))
+        {
+            for (auto e : out_edges_range(v, g))
+            {
+                auto u = target(e, g);
+                if (u == v)
+                    continue;
+                etarget.push_back(u);
+                ecoef.push_back(get(eweight, e) * vw[u] * vw[v]);
+            }
+            eoffset[v + 1] = etarget.size();
+        }
+        for (size_t v = 0; v < N; ++v)
+            eoffset[v + 1] = max(eoffset[v + 1], eoffset[v]);
+
+        // the force parameters are copied, since the members cannot be
+        // accessed from the device
+        double C = this->C, K = this->K, p = this->p, theta = this->theta,
+            gamma = this->gamma, mu = this->mu, mu_p = this->mu_p;
+        int ip = (round(p) == p && p >= 0) ? int(p) : -1;
+        double CK = (ip >= 0) ? C * power(K, ip + 1) : C * pow(K, 1 + p);
+        double Kg = K * power(double(HN), 2);
+
+        size_t NV = vertices.size(), NE = etarget.size();
+        double* xp = x.data();
+        double* yp = y.data();
+        double* nxp = nx.data();
+        double* nyp = ny.data();
+        const double* vwp = vw.data();
+        const int32_t* vgp = vgroup.data();
+        const size_t* vsp = vertices.data();
+        const size_t* eop = eoffset.data();
+        const size_t* etp = etarget.data();
+        const double* ecp = ecoef.data();
+        double* gxp = gx.data();
+        double* gyp = gy.data();
+        const double* gsp = gsize.data();
+
+        QuadTree<vweight_t> qt;
+
+        double delta = epsilon * K + 1, E = 0, E0;
+        E0 = numeric_limits<double>::max();
+        size_t n_iter = 0;
+        double step = init_step;
+        size_t progress = 0;
+
+        #pragma omp target data map(to: xp[0:N], yp[0:N], vwp[0:N], \
+                                    vgp[0:N], vsp[0:NV], eop[0:N+1], \
+                                    etp[0:NE], ecp[0:NE]) \
+                                map(alloc: nxp[0:N], nyp[0:N])
+        {
+        while (delta > epsilon * K && (max_iter == 0 || n_iter < max_iter))
+        {
+            delta = 0;
+            E0 = E;
+            E = 0;
+
+            pos_t ll, ur;
+            ll.fill(numeric_limits<double>::max());
+            ur.fill(-numeric_limits<double>::max());
+            for (auto v : vertices_range(g))
+            {
+                ll[0] = min(x[v], ll[0]);
+                ll[1] = min(y[v], ll[1]);
+                ur[0] = max(x[v], ur[0]);
+                ur[1] = max(y[v], ur[1]);
+            }
+
+            if (has_groups)
+            {
+                std::fill(gx.begin(), gx.end(), 0);
+                std::fill(gy.begin(), gy.end(), 0);
+                for (auto v : vertices_range(g))
+                {
+                    size_t s = vgroup[v];
+                    gx[s] += x[v] * vw[v] / gsize[s];
+                    gy[s] += y[v] * vw[v] / gsize[s];
+                }
+            }
+
+            qt.build(g, x, y, vweight, ll, ur, max_level);
+
+            size_t NN = qt.num_nodes(), NP = qt.num_points();
+            const node_t* nodes = qt.get_nodes();
+            const double* qx = qt.get_x();
+            const double* qy = qt.get_y();
+            const vweight_t* qw = qt.get_w();
+
+            #pragma omp target teams distribute parallel for \
+                map(to: nodes[0:NN], qx[0:NP], qy[0:NP], qw[0:NP], \
+                    gxp[0:G], gyp[0:G], gsp[0:G]) \
+                map(tofrom: E, delta) reduction(+:E, delta)
+            for (size_t i = 0; i < NV; ++i)
+            {
+                size_t v = vsp[i];
+                double xv = xp[v], yv = yp[v];
+
+                // global repulsive forces; the depth of the tree is at most
+                // 32, and each node adds at most 3 entries to the stack
+                double fx = 0, fy = 0;
+                size_t Q[128];
+                size_t nq = 0;
+                if (NN > 0)
+                    Q[nq++] = 0;
+                while (nq > 0)
+                {
+                    const node_t& q = nodes[Q[--nq]];
+                    if (q.nchildren == 0)
+                    {
+                        for (size_t j = q.begin; j < q.end; ++j)
+                        {
+                            double dx = qx[j] - xv;
+                            double dy = qy[j] - yv;
+                            double c = qw[j] *
+                                sfdp_offload_f_r(dx * dx + dy * dy, CK, p, ip);
+                            fx += c * dx;
+                            fy += c * dy;
+                        }
+                        continue;
+                    }
+
+                    double dx = q.cm[0] - xv;
+                    double dy = q.cm[1] - yv;
+                    double d2 = dx * dx + dy * dy;
+                    double d = (d2 > 0) ? sqrt(d2) : 1;
+                    if (q.w > theta * d)
+                    {
+                        for (size_t c = q.children;
+                             c < q.children + q.nchildren; ++c)
+                        {
+                            if (nodes[c].count > 0)
+                                Q[nq++] = c;
+                        }
+                    }
+                    else
+                    {
+                        double f = q.count * sfdp_offload_f_r(d2, CK, p, ip);
+                        fx += f * dx;
+                        fy += f * dy;
+                    }
+                }
+                fx *= vwp[v];
+                fy *= vwp[v];
+
+                // local attractive forces
+                for (size_t j = eop[v]; j < eop[v + 1]; ++j)
+                {
+                    size_t u = etp[j];
+                    double dx = xp[u] - xv;
+                    double dy = yp[u] - yv;
+                    double f = ecp[j] * sqrt(dx * dx + dy * dy) / K;
+                    fx += f * dx;
+                    fy += f * dy;
+                }
+
+                // inter-group forces
+                if (gamma != 0)
+                {
+                    for (size_t s = 0; s < G; ++s)
+                    {
+                        if (gsp[s] == 0 || s == size_t(vgp[v]))
+                            continue;
+                        double dx = gxp[s] - xv;
+                        double dy = gyp[s] - yv;
+                        double d2 = dx * dx + dy * dy;
+                        double f;
+                        if (gamma > 0)
+                            f = gamma * gsp[s] * vwp[v] * sqrt(d2) / Kg;
+                        else
+                            f = sfdp_offload_f_r(d2, CK, p, ip) * gsp[s] *
+                                vwp[v] * (-gamma);
+                        fx += f * dx;
+                        fy += f * dy;
+                    }
+                }
+
+                // intra-group attractive forces
+                if (mu > 0 && gsp[vgp[v]] > 1)
+                {
+                    size_t s = vgp[v];
+                    double dx = gxp[s] - xv;
+                    double dy = gyp[s] - yv;
+                    double Kp = K * pow(gsp[s], mu_p);
+                    double f = mu * gsp[s] * vwp[v] *
+                        sqrt(dx * dx + dy * dy) / Kp;
+                    fx += f * dx;
+                    fy += f * dy;
+                }
+
+                // move by step in the direction of the force
+                double ftot = sqrt(fx * fx + fy * fy);
+                E += ftot * ftot;
+                nxp[v] = xv;
+                nyp[v] = yv;
+                if (ftot > 0)
+                {
+                    nxp[v] += step * fx / ftot;
+                    nyp[v] += step * fy / ftot;
+                    delta += step;
+                }
+            }
+
+            #pragma omp target teams distribute parallel for
+            for (size_t i = 0; i < NV; ++i)
+            {
+                size_t v = vsp[i];
+                xp[v] = nxp[v];
+                yp[v] = nyp[v];
+            }
+
+            // the host needs the positions to build the next tree
+            #pragma omp target update from(xp[0:N], yp[0:N])
+
+            n_iter++;
+            if (NV > 0)
+                delta /= NV;
+
+            if (verbose)
+                cout << n_iter << " " << E << " " << step << " "
+                     << delta << " " << max_level << endl;
+
+            if (simple)
+            {
+                step *= step_schedule;
+            }
+            else
+            {
+                if (E < E0)
+                {
+                    ++progress;
+                    if (progress >= 5)
+                    {
+                        progress = 0;
+                        step /= step_schedule;
+                    }
+                }
+                else
+                {
+                    progress = 0;
+                    step *= step_schedule;
+                }
+            }
+        }
+        }
+
+        for (auto v : vertices_range(g))
+        {
+            pos[v][0] = x[v];
+            pos[v][1] = y[v];
+        }
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_SFDP_OFFLOAD_HH
@@ -0,0 +1,106 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef NUMA_HH
+#define NUMA_HH
+
+#include <cstddef>
+#include "graph_trace.hh"
+#include <type_traits>
+#include <vector>
+
+namespace graph_tool
+{
+
+// NUMA placement of large arrays
+// ==============================
+//
+// The kernel places each page of memory on the NUMA node of the thread that
+// first writes to it. Since arrays are normally allocated and zero-filled by
+// the calling thread, they end up entirely on a single node, and the parallel
+// loops access remote memory for the portion handled by the threads on the
+// other nodes.
+//
+// In NUMA mode (which is disabled by default), the newly value-initialized
+// portion of large arrays of scalars is released back to the kernel right after
+// being zero-filled, and written again in parallel, with the same static
+// partition used by the parallel loops with the (default) static schedule. The
+// pages are then placed on the node of the thread which will process them.
+//
+// For arrays which are read by all threads, and modified rarely, interleaving
+// the pages between all nodes via numa_interleave() will instead spread the
+// bandwidth evenly.
+
+extern bool __numa_first_touch;
+
+// arrays smaller than this are not worth the trouble
+constexpr size_t NUMA_MIN_BYTES = 1 << 22;
+
+// releases the pages entirely contained in [begin, end), which must be in
+// private anonymous memory; the contents will read as zero afterwards
+void numa_release_pages(void* begin, void* end);
+
+// interleaves the pages entirely contained in [ptr, ptr + size) between all
+// the NUMA nodes; this is a no-op if NUMA is not supported
+void numa_interleave(void* ptr, size_t size);
+
+template <class T>
+void numa_first_touch(T* begin, T* end, std::true_type)
+{
+    size_t N = end - begin;
+    if (!__numa_first_touch || N * sizeof(T) < NUMA_MIN_BYTES)
+        return;
+    numa_release_pages(begin, end);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < N; ++i)
+        begin[i] = T();
+}
+
+template <class T>
+void numa_first_touch(T*, T*, std::false_type) {}
+
+// places the (value-initialized) elements in [begin, end) by parallel first
+// touch, if in NUMA mode; only scalars are affected, since only their
+// value-initialization is guaranteed to be all-zero
+template <class T>
+void numa_first_touch(T* begin, T* end)
+{
+    numa_first_touch(begin, end, std::is_arithmetic<T>());
+}
+
+// resizes a vector, and places the new elements by parallel first touch
+template <class T, class Alloc>
+void numa_resize(std::vector<T, Alloc>& v, size_t n)
+{
+    size_t old = v.size();
+    v.resize(n);
+    if (n > old)
+    {
+        GT_TRACE_COUNTER("alloc_bytes", (n - old) * sizeof(T));
+        numa_first_touch(v.data() + old, v.data() + n);
+    }
+}
+
+template <class Alloc>
+void numa_resize(std::vector<bool, Alloc>& v, size_t n)
+{
+    v.resize(n);
+}
+
+} // graph_tool namespace
+
+#endif // NUMA_HH
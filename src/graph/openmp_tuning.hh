@@ -0,0 +1,115 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef OPENMP_TUNING_HH
+#define OPENMP_TUNING_HH
+
+#include "config.h"
+
+#include <atomic>
+#include <cstddef>
+
+#ifdef _OPENMP
+# include <omp.h>
+#endif
+
+namespace graph_tool
+{
+
+// Run-time tuning of the parallel loops
+// =====================================
+//
+// By default, the parallel loops of graph_util.hh are only spawned for more
+// than OPENMP_MIN_THRESH elements, and use the global run-time schedule. Since
+// the best values depend on the machine and on the kind of loop, they can
+// instead be taken from a table with one entry per loop class, which is filled
+// by openmp_calibrate() (or set from Python, e.g. from a previous
+// calibration). The table is only used by the loops instantiated with the
+// default threshold, so that explicit choices at the call site are respected.
+//
+// The table should not be modified while algorithms are running.
+
+enum loop_class_t
+{
+    VERTEX_LOOP = 0,    // parallel_vertex_loop()
+    EDGE_LOOP,          // parallel_edge_loop()
+    FLAT_EDGE_LOOP,     // parallel_edge_loop_flat()
+    CONTAINER_LOOP,     // parallel_loop()
+    NUM_LOOP_CLASSES
+};
+
+struct loop_tuning_t
+{
+    size_t thresh = OPENMP_MIN_THRESH;
+    int schedule = 0;   // omp_sched_t, or 0 for the global run-time schedule
+    int chunk = 0;
+};
+
+extern std::atomic<bool> __loop_tuning_enabled;
+extern loop_tuning_t __loop_tuning[NUM_LOOP_CLASSES];
+
+template <size_t thres>
+size_t get_loop_thresh(loop_class_t l)
+{
+    if (thres != OPENMP_MIN_THRESH ||
+        !__loop_tuning_enabled.load(std::memory_order_relaxed))
+        return thres;
+    return __loop_tuning[l].thresh;
+}
+
+// Sets the run-time schedule of the calling thread to the tuned one, during
+// its lifetime. The threads spawned by the calling thread inherit it, so this
+// must be created before the parallel region.
+template <size_t thres>
+class loop_schedule_scope
+{
+public:
+    loop_schedule_scope(loop_class_t l)
+    {
+#ifdef _OPENMP
+        _set = (thres == OPENMP_MIN_THRESH &&
+                __loop_tuning_enabled.load(std::memory_order_relaxed) &&
+                __loop_tuning[l].schedule != 0);
+        if (!_set)
+            return;
+        omp_get_schedule(&_kind, &_chunk);
+        omp_set_schedule(omp_sched_t(__loop_tuning[l].schedule),
+                         __loop_tuning[l].chunk);
+#else
+        (void) l;
+#endif
+    }
+
+    ~loop_schedule_scope()
+    {
+#ifdef _OPENMP
+        if (_set)
+            omp_set_schedule(_kind, _chunk);
+#endif
+    }
+
+private:
+#ifdef _OPENMP
+    bool _set;
+    omp_sched_t _kind;
+    int _chunk;
+#endif
+};
+
+} // graph_tool namespace
+
+#endif // OPENMP_TUNING_HH
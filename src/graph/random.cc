@@ -17,8 +17,29 @@
 
 #include "random.hh"
 
+#include <sstream>
+
 rng_t get_rng(size_t seed)
 {
     std::seed_seq seq{seed, seed + 1, seed + 2, seed + 3, seed + 4};
     return rng_t(seq);
 }
+
+rng_t split_rng(rng_t& rng)
+{
+    std::uniform_int_distribution<size_t> seed;
+    return get_rng(seed(rng));
+}
+
+std::string get_rng_state(const rng_t& rng)
+{
+    std::ostringstream s;
+    s << rng;
+    return s.str();
+}
+
+void set_rng_state(rng_t& rng, const std::string& state)
+{
+    std::istringstream s(state);
+    s >> rng;
+}
@@ -19,9 +19,18 @@
 #define RANDOM_HH
 
 #include <random>
+#include <string>
 
 typedef std::mt19937 rng_t;
 
 rng_t get_rng(size_t seed);
 
+// new generator seeded from the output of an existing one, e.g. to give
+// independent streams to concurrent computations
+rng_t split_rng(rng_t& rng);
+
+// (de)serialization of the generator state, e.g. for checkpointing
+std::string get_rng_state(const rng_t& rng);
+void set_rng_state(rng_t& rng, const std::string& state);
+
 #endif
@@ -29,6 +29,7 @@
 
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_search_workspace.hh"
 
 using namespace std;
 using namespace boost;
@@ -233,6 +234,43 @@ boost::python::object astar_search_array_fast(GraphInterface& g,
     return wrap_vector_owned<size_t,2>(edges);
 }
 
+boost::python::object astar_search_array_ws(GraphInterface& gi,
+                                            size_t source,
+                                            boost::any aweight,
+                                            python::object ozero,
+                                            python::object oinf,
+                                            python::object h,
+                                            SearchWorkspace& ws)
+{
+    std::vector<std::array<size_t, 2>> edges;
+    AStarArrayVisitor vis(edges);
+    ws.start(gi.get_num_vertices(false));
+    run_action<graph_tool::all_graph_views,mpl::true_>()
+        (gi, [&](auto& g, auto weight)
+         {
+             typedef std::remove_reference_t<decltype(g)> g_t;
+             typedef typename property_traits<decltype(weight)>::value_type
+                 dtype_t;
+             dtype_t z = python::extract<dtype_t>(ozero);
+             dtype_t i = python::extract<dtype_t>(oinf);
+             auto color = ws.get_color_map();
+             auto pred = ws.get_pred_map();
+             auto dist = ws.get_dist_map<dtype_t>(i);
+             auto cost = ws.get_cost_map<dtype_t>(i);
+
+             AStarH<g_t, dtype_t> heuristic(gi, g, h);
+             auto s = vertex(source, g);
+             put(dist, s, z);
+             put(cost, s, heuristic(s));
+             astar_search_no_init(g, s, heuristic, vis, pred, cost, dist,
+                                  weight, color, get(vertex_index, g),
+                                  std::less<dtype_t>(),
+                                  boost::closed_plus<dtype_t>(i), i, z);
+         },
+         edge_scalar_properties())(aweight);
+    return wrap_vector_owned<size_t,2>(edges);
+}
+
 void export_astar()
 {
     using namespace boost::python;
@@ -241,4 +279,5 @@ void export_astar()
     def("astar_generator_fast", &astar_search_generator_fast);
     def("astar_array", &astar_search_array);
     def("astar_array_fast", &astar_search_array_fast);
+    def("astar_array_ws", &astar_search_array_ws);
 }
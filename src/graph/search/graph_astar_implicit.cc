@@ -26,6 +26,8 @@
 #include "graph_util.hh"
 
 #include "graph_astar.hh"
+#include "graph_astar_implicit.hh"
+#include "numpy_bind.hh"
 
 using namespace std;
 using namespace boost;
@@ -82,8 +84,75 @@ void a_star_search_implicit(GraphInterface& g, size_t source,
          writable_vertex_properties())(dist_map);
 }
 
+constexpr size_t implicit_astar::_null;
+
+// Compiled callbacks for astar_implicit_cfunc(), as plain C function pointers,
+// which can be obtained e.g. from ctypes or cffi. The successor function
+// writes at most max successors and their costs, and returns the total number
+// of successors; if that is larger than max, it is called again with enough
+// space.
+extern "C"
+{
+    typedef size_t (*astar_succ_t)(uint64_t state, uint64_t* succ,
+                                   double* cost, size_t max, void* data);
+    typedef double (*astar_h_t)(uint64_t state, void* data);
+    typedef int (*astar_goal_t)(uint64_t state, void* data);
+}
+
+python::object astar_implicit_cfunc(uint64_t source, uint64_t target,
+                                    size_t succ_ptr, size_t h_ptr,
+                                    size_t goal_ptr, size_t data,
+                                    size_t max_expansions)
+{
+    auto csucc = reinterpret_cast<astar_succ_t>(succ_ptr);
+    auto ch = reinterpret_cast<astar_h_t>(h_ptr);
+    auto cgoal = reinterpret_cast<astar_goal_t>(goal_ptr);
+    void* udata = reinterpret_cast<void*>(data);
+
+    if (csucc == nullptr)
+        throw ValueException("no successor function given");
+
+    auto succ = [&](uint64_t s, vector<uint64_t>& states, vector<double>& costs)
+        {
+            if (states.capacity() < 16)
+                states.reserve(16);
+            size_t max = states.capacity();
+            states.resize(max);
+            costs.resize(max);
+            size_t n = csucc(s, states.data(), costs.data(), max, udata);
+            if (n > max)
+            {
+                states.resize(n);
+                costs.resize(n);
+                n = csucc(s, states.data(), costs.data(), n, udata);
+            }
+            states.resize(n);
+            costs.resize(n);
+        };
+
+    auto h = [&](uint64_t s) { return (ch == nullptr) ? 0. : ch(s, udata); };
+
+    auto goal = [&](uint64_t s)
+        {
+            if (cgoal == nullptr)
+                return s == target;
+            return cgoal(s, udata) != 0;
+        };
+
+    static thread_local implicit_astar astar;
+    vector<uint64_t> path;
+    double cost;
+    {
+        GILRelease gil;
+        astar(source, succ, h, goal, max_expansions, path, cost);
+    }
+    return python::make_tuple(wrap_vector_owned(path), cost,
+                              astar.num_expanded(), astar.num_generated());
+}
+
 void export_astar_implicit()
 {
     using namespace boost::python;
     def("astar_search_implicit", &a_star_search_implicit);
+    def("astar_implicit_cfunc", &astar_implicit_cfunc);
 }
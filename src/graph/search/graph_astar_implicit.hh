@@ -0,0 +1,223 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_ASTAR_IMPLICIT_HH
+#define GRAPH_ASTAR_IMPLICIT_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+#include "hash_map_wrap.hh"
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+
+// Minimum d-ary heap with lazy deletion: an improved entry is simply pushed
+// again, and the stale copies are skipped by the caller when popped. With
+// D = 4 the tree is half as deep as a binary heap, and the children of a node
+// share a cache line.
+template <class Value, size_t D = 4>
+class d_ary_heap
+{
+public:
+    bool empty() const { return _heap.empty(); }
+    size_t size() const { return _heap.size(); }
+    const Value& top() const { return _heap.front(); }
+    void clear() { _heap.clear(); }
+
+    void push(const Value& x)
+    {
+        size_t i = _heap.size();
+        _heap.push_back(x);
+        while (i > 0)
+        {
+            size_t p = (i - 1) / D;
+            if (!(x < _heap[p]))
+                break;
+            _heap[i] = _heap[p];
+            i = p;
+        }
+        _heap[i] = x;
+    }
+
+    void pop()
+    {
+        Value x = _heap.back();
+        _heap.pop_back();
+        size_t n = _heap.size();
+        if (n == 0)
+            return;
+        size_t i = 0;
+        while (true)
+        {
+            size_t c = i * D + 1;
+            if (c >= n)
+                break;
+            size_t end = std::min(c + D, n);
+            size_t m = c;
+            for (size_t j = c + 1; j < end; ++j)
+            {
+                if (_heap[j] < _heap[m])
+                    m = j;
+            }
+            if (!(_heap[m] < x))
+                break;
+            _heap[i] = _heap[m];
+            i = m;
+        }
+        _heap[i] = x;
+    }
+
+private:
+    std::vector<Value> _heap;
+};
+
+// A* search over an implicit state space, where the states are 64-bit
+// integers that are never stored as a graph. The successors of a state are
+// generated on demand by succ(state, states, costs), which must append the
+// successor states and the (non-negative) costs of reaching them to the given
+// vectors; h(state) is the heuristic estimate of the remaining cost, and
+// goal(state) tells whether the search is over.
+//
+// The generated states are kept in a compact node array, indexed by a
+// gt_hash_map from the states, which serves as both the open and the closed
+// set. The heuristic need not be consistent: closed states whose cost is
+// improved are reopened. The values 2^64-1 and 2^64-2 are reserved by the hash
+// map, and cannot be used as states.
+class implicit_astar
+{
+public:
+    typedef uint64_t state_t;
+
+    template <class Succ, class Heuristic, class Goal>
+    bool operator()(state_t source, Succ&& succ, Heuristic&& h, Goal&& goal,
+                    size_t max_expansions, std::vector<state_t>& path,
+                    double& cost)
+    {
+        clear();
+
+        add_node(source, 0, _null, h(source));
+
+        size_t found = _null;
+        while (!_open.empty())
+        {
+            auto top = _open.top();
+            _open.pop();
+            auto& n = _nodes[top.second];
+            if (n.closed || top.first > n.g + n.h)
+                continue; // stale entry
+            n.closed = true;
+
+            if (goal(n.state))
+            {
+                found = top.second;
+                break;
+            }
+
+            if (_expanded >= max_expansions)
+                break;
+            ++_expanded;
+
+            size_t i = top.second;
+            double g = n.g;
+            _succ.clear();
+            _costs.clear();
+            succ(n.state, _succ, _costs);
+            if (_succ.size() != _costs.size())
+                throw ValueException("the numbers of successors and costs "
+                                     "differ");
+
+            for (size_t j = 0; j < _succ.size(); ++j)
+            {
+                if (_costs[j] < 0)
+                    throw ValueException("Negative edge cost found in A* "
+                                         "search");
+                double ng = g + _costs[j];
+                auto iter = _index.find(_succ[j]);
+                if (iter == _index.end())
+                {
+                    add_node(_succ[j], ng, i, h(_succ[j]));
+                    continue;
+                }
+                auto& m = _nodes[iter->second];
+                if (!(ng < m.g))
+                    continue;
+                m.g = ng;
+                m.parent = i;
+                m.closed = false;
+                _open.push({ng + m.h, iter->second});
+            }
+        }
+
+        path.clear();
+        if (found == _null)
+        {
+            cost = std::numeric_limits<double>::infinity();
+            return false;
+        }
+        cost = _nodes[found].g;
+        for (size_t i = found; i != _null; i = _nodes[i].parent)
+            path.push_back(_nodes[i].state);
+        std::reverse(path.begin(), path.end());
+        return true;
+    }
+
+    // number of states expanded and generated in the last search
+    size_t num_expanded() const { return _expanded; }
+    size_t num_generated() const { return _nodes.size(); }
+
+private:
+    struct node_t
+    {
+        state_t state;
+        double g;
+        double h;
+        size_t parent;
+        bool closed;
+    };
+
+    void clear()
+    {
+        _nodes.clear();
+        _index.clear();
+        _open.clear();
+        _expanded = 0;
+    }
+
+    void add_node(state_t s, double g, size_t parent, double h)
+    {
+        _index[s] = _nodes.size();
+        _nodes.push_back({s, g, h, parent, false});
+        _open.push({g + h, _nodes.size() - 1});
+    }
+
+    static constexpr size_t _null = std::numeric_limits<size_t>::max();
+
+    std::vector<node_t> _nodes;
+    gt_hash_map<state_t, size_t> _index;
+    d_ary_heap<std::pair<double, size_t>> _open;
+    std::vector<state_t> _succ;
+    std::vector<double> _costs;
+    size_t _expanded = 0;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_ASTAR_IMPLICIT_HH
@@ -27,6 +27,8 @@
 
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_search_workspace.hh"
+#include "graph_search_events.hh"
 
 using namespace std;
 using namespace boost;
@@ -106,18 +108,15 @@ private:
     boost::python::object _vis;
 };
 
-template <class Graph, class Visitor>
-void do_bfs(Graph& g, size_t s, Visitor&& vis)
+template <class Graph, class Visitor, class ColorMap>
+void do_bfs(Graph& g, size_t s, Visitor&& vis, ColorMap color)
 {
-    typename vprop_map_t<default_color_type>::type
-        color(get(vertex_index_t(), g));
-
     auto v = vertex(s, g);
     if (v == graph_traits<Graph>::null_vertex())
     {
         for (auto u : vertices_range(g))
         {
-            if (color[u] == color_traits<default_color_type>::black())
+            if (get(color, u) == color_traits<default_color_type>::black())
                 continue;
             breadth_first_visit(g, u, visitor(vis).color_map(color));
         }
@@ -128,6 +127,14 @@ void do_bfs(Graph& g, size_t s, Visitor&& vis)
     }
 }
 
+template <class Graph, class Visitor>
+void do_bfs(Graph& g, size_t s, Visitor&& vis)
+{
+    typename vprop_map_t<default_color_type>::type
+        color(get(vertex_index_t(), g));
+    do_bfs(g, s, vis, color);
+}
+
 void bfs_search(GraphInterface& gi, size_t s, python::object vis)
 {
     run_action<graph_tool::all_graph_views,mpl::true_>()
@@ -192,11 +199,61 @@ boost::python::object bfs_search_array(GraphInterface& g, size_t s)
 {
     std::vector<std::array<size_t, 2>> edges;
     BFSArrayVisitor vis(edges);
-    run_action<graph_tool::all_graph_views,mpl::true_>()
+    run_action<with_frozen<graph_tool::all_graph_views>,mpl::true_>()
         (g, [&](auto &g){ do_bfs(g, s, vis); })();
     return wrap_vector_owned<size_t,2>(edges);
 }
 
+// same as above, but with the color and predecessor maps kept in a reusable
+// workspace, so that the cost does not depend on the size of the graph
+class BFSWorkspaceVisitor : public BFSArrayVisitor
+{
+public:
+    BFSWorkspaceVisitor(std::vector<std::array<size_t, 2>>& edges,
+                        SearchWorkspace::pred_map_t pred)
+        : BFSArrayVisitor(edges), _pred(pred) {}
+
+    template <class Edge, class Graph>
+    void tree_edge(const Edge& e, Graph& g)
+    {
+        BFSArrayVisitor::tree_edge(e, g);
+        put(_pred, target(e, g), source(e, g));
+    }
+
+private:
+    SearchWorkspace::pred_map_t _pred;
+};
+
+boost::python::object bfs_search_array_ws(GraphInterface& g, size_t s,
+                                          SearchWorkspace& ws)
+{
+    std::vector<std::array<size_t, 2>> edges;
+    ws.start(g.get_num_vertices(false));
+    auto color = ws.get_color_map();
+    BFSWorkspaceVisitor vis(edges, ws.get_pred_map());
+    run_action<with_frozen<graph_tool::all_graph_views>,mpl::true_>()
+        (g, [&](auto &g){ do_bfs(g, s, vis, color); })();
+    return wrap_vector_owned<size_t,2>(edges);
+}
+
+// records the selected events into arrays, optionally handed over in chunks
+boost::python::object bfs_search_events(GraphInterface& gi, size_t s,
+                                        uint32_t events, size_t chunk,
+                                        boost::any prune, boost::any efilt)
+{
+    return record_search_events
+        (events, chunk,
+         [=, &gi](auto& vis)
+         {
+             run_action<graph_tool::all_graph_views, mpl::true_>()
+                 (gi, [&](auto& g)
+                  {
+                      auto fg = make_prune_graph(g, prune, efilt);
+                      do_bfs(fg, s, vis);
+                  })();
+         });
+}
+
 
 void export_bfs()
 {
@@ -204,4 +261,6 @@ void export_bfs()
     def("bfs_search", &bfs_search);
     def("bfs_search_generator", &bfs_search_generator);
     def("bfs_search_array", &bfs_search_array);
+    def("bfs_search_array_ws", &bfs_search_array_ws);
+    def("bfs_search_events", &bfs_search_events);
 }
@@ -18,6 +18,7 @@
 
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_search_events.hh"
 
 using namespace std;
 using namespace boost;
@@ -171,6 +172,24 @@ boost::python::object dfs_search_array(GraphInterface& g, size_t s)
         (g, [&](auto &g){ do_dfs(g, s, vis); })();
     return wrap_vector_owned<size_t,2>(edges);
 }
+// records the selected events into arrays, optionally handed over in chunks
+boost::python::object dfs_search_events(GraphInterface& gi, size_t s,
+                                        uint32_t events, size_t chunk,
+                                        boost::any prune, boost::any efilt)
+{
+    return record_search_events
+        (events, chunk,
+         [=, &gi](auto& vis)
+         {
+             run_action<graph_tool::all_graph_views, mpl::true_>()
+                 (gi, [&](auto& g)
+                  {
+                      auto fg = make_prune_graph(g, prune, efilt);
+                      do_dfs(fg, s, vis);
+                  })();
+         });
+}
+
 
 void export_dfs()
 {
@@ -178,4 +197,5 @@ void export_dfs()
     def("dfs_search", &dfs_search);
     def("dfs_search_generator", &dfs_search_generator);
     def("dfs_search_array", &dfs_search_array);
+    def("dfs_search_events", &dfs_search_events);
 }
@@ -27,6 +27,8 @@
 
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_search_workspace.hh"
+#include "graph_search_events.hh"
 
 using namespace std;
 using namespace boost;
@@ -352,6 +354,82 @@ boost::python::object dijkstra_search_array_fast(GraphInterface& g,
     return wrap_vector_owned<size_t,2>(edges);
 }
 
+boost::python::object dijkstra_search_array_ws(GraphInterface& gi,
+                                               size_t source,
+                                               boost::any aweight,
+                                               python::object ozero,
+                                               python::object oinf,
+                                               SearchWorkspace& ws)
+{
+    std::vector<std::array<size_t, 2>> edges;
+    DJKArrayVisitor vis(edges);
+    ws.start(gi.get_num_vertices(false));
+    run_action<graph_tool::all_graph_views, mpl::true_>()
+        (gi, [&](auto& g, auto weight)
+         {
+             typedef std::remove_reference_t<decltype(g)> g_t;
+             typedef typename property_traits<decltype(weight)>::value_type
+                 dtype_t;
+             dtype_t z = python::extract<dtype_t>(ozero);
+             dtype_t i = python::extract<dtype_t>(oinf);
+             auto dist = ws.get_dist_map<dtype_t>(i);
+             auto pred = ws.get_pred_map();
+
+             // the maps need no initialization, as unset entries read as inf
+             // and -1 (i.e. "no predecessor")
+             auto search = [&](auto u)
+             {
+                 put(dist, u, z);
+                 dijkstra_shortest_paths_no_color_map_no_init
+                     (g, u, pred, dist, weight,
+                      get(vertex_index_t(), g), std::less<dtype_t>(),
+                      boost::closed_plus<dtype_t>(i), i, z, vis);
+             };
+
+             if (vertex(source, g) == graph_traits<g_t>::null_vertex())
+             {
+                 for (auto u : vertices_range(g))
+                 {
+                     if (get(dist, u) == i)
+                         search(u);
+                 }
+             }
+             else
+             {
+                 search(vertex(source, g));
+             }
+         },
+         edge_scalar_properties())(aweight);
+    return wrap_vector_owned<size_t,2>(edges);
+}
+// records the selected events into arrays, optionally handed over in chunks
+boost::python::object dijkstra_search_events(GraphInterface& gi,
+                                             size_t source,
+                                             boost::any dist_map,
+                                             boost::any weight,
+                                             python::object zero,
+                                             python::object inf,
+                                             uint32_t events, size_t chunk,
+                                             boost::any prune,
+                                             boost::any efilt)
+{
+    return record_search_events
+        (events, chunk,
+         [=, &gi](auto& vis) mutable
+         {
+             run_action<graph_tool::all_graph_views, mpl::true_>()
+                 (gi, [&](auto& g, auto dist, auto w)
+                  {
+                      auto fg = make_prune_graph(g, prune, efilt);
+                      do_djk_search_fast()(fg, source, dist, w, vis,
+                                           make_pair(zero, inf));
+                  },
+                  writable_vertex_scalar_properties(),
+                  edge_scalar_properties())(dist_map, weight);
+         });
+}
+
+
 void export_dijkstra()
 {
     using namespace boost::python;
@@ -360,4 +438,6 @@ void export_dijkstra()
     def("dijkstra_generator_fast", &dijkstra_search_generator_fast);
     def("dijkstra_array", &dijkstra_search_array);
     def("dijkstra_array_fast", &dijkstra_search_array_fast);
+    def("dijkstra_array_ws", &dijkstra_search_array_ws);
+    def("dijkstra_events", &dijkstra_search_events);
 }
@@ -0,0 +1,256 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SEARCH_EVENTS_HH
+#define GRAPH_SEARCH_EVENTS_HH
+
+#include <vector>
+#include <array>
+#include <functional>
+#include <limits>
+
+#include <boost/python.hpp>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_python_interface.hh"
+#include "coroutine.hh"
+#include "numpy_bind.hh"
+
+namespace graph_tool
+{
+
+// The visitor events that can be recorded. The codes must match the positions
+// in graph_tool.search.search_events.
+enum search_event : int64_t
+{
+    EV_INITIALIZE_VERTEX = 0,
+    EV_START_VERTEX,
+    EV_DISCOVER_VERTEX,
+    EV_EXAMINE_VERTEX,
+    EV_FINISH_VERTEX,
+    EV_EXAMINE_EDGE,
+    EV_TREE_EDGE,
+    EV_NON_TREE_EDGE,
+    EV_GRAY_TARGET,
+    EV_BLACK_TARGET,
+    EV_BACK_EDGE,
+    EV_FORWARD_OR_CROSS_EDGE,
+    EV_EDGE_RELAXED,
+    EV_EDGE_NOT_RELAXED,
+    EV_NUM_EVENTS
+};
+
+typedef std::array<int64_t, 4> event_record_t;
+
+// Visitor that stores the events selected in the bit mask as rows of
+// (event, vertex, target, edge index), with -1 in the columns that do not
+// apply to vertex events. Whenever chunk rows have been stored, flush() is
+// called, which is expected to hand them over and empty the buffer. This
+// replaces one Python call per event by one per chunk.
+class SearchEventRecorder
+{
+public:
+    SearchEventRecorder(uint32_t events, size_t chunk,
+                        std::vector<event_record_t>& rec,
+                        std::function<void()> flush)
+        : _events(events), _chunk(chunk), _rec(rec), _flush(flush) {}
+
+    template <class Vertex, class Graph>
+    void initialize_vertex(Vertex u, Graph&)
+    { put_vertex(EV_INITIALIZE_VERTEX, u); }
+
+    template <class Vertex, class Graph>
+    void start_vertex(Vertex u, Graph&)
+    { put_vertex(EV_START_VERTEX, u); }
+
+    template <class Vertex, class Graph>
+    void discover_vertex(Vertex u, Graph&)
+    { put_vertex(EV_DISCOVER_VERTEX, u); }
+
+    template <class Vertex, class Graph>
+    void examine_vertex(Vertex u, Graph&)
+    { put_vertex(EV_EXAMINE_VERTEX, u); }
+
+    template <class Vertex, class Graph>
+    void finish_vertex(Vertex u, Graph&)
+    { put_vertex(EV_FINISH_VERTEX, u); }
+
+    template <class Edge, class Graph>
+    void examine_edge(const Edge& e, Graph& g)
+    { put_edge(EV_EXAMINE_EDGE, e, g); }
+
+    template <class Edge, class Graph>
+    void tree_edge(const Edge& e, Graph& g)
+    { put_edge(EV_TREE_EDGE, e, g); }
+
+    template <class Edge, class Graph>
+    void non_tree_edge(const Edge& e, Graph& g)
+    { put_edge(EV_NON_TREE_EDGE, e, g); }
+
+    template <class Edge, class Graph>
+    void gray_target(const Edge& e, Graph& g)
+    { put_edge(EV_GRAY_TARGET, e, g); }
+
+    template <class Edge, class Graph>
+    void black_target(const Edge& e, Graph& g)
+    { put_edge(EV_BLACK_TARGET, e, g); }
+
+    template <class Edge, class Graph>
+    void back_edge(const Edge& e, Graph& g)
+    { put_edge(EV_BACK_EDGE, e, g); }
+
+    template <class Edge, class Graph>
+    void forward_or_cross_edge(const Edge& e, Graph& g)
+    { put_edge(EV_FORWARD_OR_CROSS_EDGE, e, g); }
+
+    template <class Edge, class Graph>
+    void edge_relaxed(const Edge& e, Graph& g)
+    { put_edge(EV_EDGE_RELAXED, e, g); }
+
+    template <class Edge, class Graph>
+    void edge_not_relaxed(const Edge& e, Graph& g)
+    { put_edge(EV_EDGE_NOT_RELAXED, e, g); }
+
+    // the remaining Dijkstra event, which is never recorded
+    template <class Edge, class Graph>
+    void edge_minimized(const Edge&, Graph&) {}
+
+private:
+    template <class Vertex>
+    void put_vertex(search_event ev, Vertex u)
+    {
+        if (_events & (1u << ev))
+            put({{ev, int64_t(u), -1, -1}});
+    }
+
+    template <class Edge, class Graph>
+    void put_edge(search_event ev, const Edge& e, Graph& g)
+    {
+        if (_events & (1u << ev))
+            put({{ev, int64_t(source(e, g)), int64_t(target(e, g)),
+                  int64_t(get(get(boost::edge_index_t(), g), e))}});
+    }
+
+    void put(const event_record_t& r)
+    {
+        _rec.push_back(r);
+        if (_rec.size() >= _chunk)
+            _flush();
+    }
+
+    uint32_t _events;
+    size_t _chunk;
+    std::vector<event_record_t>& _rec;
+    std::function<void()> _flush;
+};
+
+// Edge predicate that hides the out-edges of the pruned vertices, and the
+// edges outside of the edge mask, if they are given. A pruned vertex is still
+// reached by the search, but it is not expanded.
+template <class Graph>
+class search_prune_filter
+{
+public:
+    typedef typename vprop_map_t<uint8_t>::type::unchecked_t vmask_t;
+    typedef typename eprop_map_t<uint8_t>::type::unchecked_t emask_t;
+
+    search_prune_filter() {}
+    search_prune_filter(const Graph& g, boost::any aprune, boost::any aefilt)
+        : _g(&g)
+    {
+        if (!aprune.empty())
+        {
+            _prune = boost::any_cast<typename vprop_map_t<uint8_t>::type>
+                (aprune).get_unchecked(num_vertices(g));
+            _has_prune = true;
+        }
+        if (!aefilt.empty())
+        {
+            _efilt = boost::any_cast<typename eprop_map_t<uint8_t>::type>
+                (aefilt).get_unchecked();
+            _has_efilt = true;
+        }
+    }
+
+    template <class Edge>
+    bool operator()(const Edge& e) const
+    {
+        if (_has_prune && _prune[source(e, *_g)])
+            return false;
+        return !_has_efilt || _efilt[e];
+    }
+
+private:
+    const Graph* _g = nullptr;
+    vmask_t _prune;
+    emask_t _efilt;
+    bool _has_prune = false;
+    bool _has_efilt = false;
+};
+
+// Returns the graph filtered by the pruning masks.
+template <class Graph>
+boost::filt_graph<Graph, search_prune_filter<Graph>>
+make_prune_graph(Graph& g, boost::any aprune, boost::any aefilt)
+{
+    return boost::filt_graph<Graph, search_prune_filter<Graph>>
+        (g, search_prune_filter<Graph>(g, aprune, aefilt), boost::keep_all());
+}
+
+// Calls search(vis) with a SearchEventRecorder. If chunk is zero, the whole
+// record is returned as a single array, otherwise a generator is returned
+// which yields arrays of at most chunk rows as the search progresses. The
+// search functor is kept by the generator, and needs to hold copies of
+// whatever it uses.
+template <class Search>
+boost::python::object
+record_search_events(uint32_t events, size_t chunk, Search search)
+{
+    if (chunk == 0)
+    {
+        std::vector<event_record_t> rec;
+        SearchEventRecorder vis(events, std::numeric_limits<size_t>::max(),
+                                rec, [](){});
+        search(vis);
+        return wrap_vector_owned<int64_t, 4>(rec);
+    }
+
+#ifdef HAVE_BOOST_COROUTINE
+    auto dispatch = [=](auto& yield) mutable
+        {
+            std::vector<event_record_t> rec;
+            rec.reserve(chunk);
+            auto flush = [&]()
+                {
+                    yield(wrap_vector_owned<int64_t, 4>(rec));
+                    rec.clear();
+                };
+            SearchEventRecorder vis(events, chunk, rec, flush);
+            search(vis);
+            if (!rec.empty())
+                flush();
+        };
+    return boost::python::object(CoroGenerator(dispatch));
+#else
+    throw GraphException("This functionality is not available because boost::coroutine was not found at compile-time");
+#endif
+}
+
+} // namespace graph_tool
+
+#endif // GRAPH_SEARCH_EVENTS_HH
@@ -18,10 +18,104 @@
 #ifndef SHARED_MAP_HH
 #define SHARED_MAP_HH
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Pairwise tree reduction of the private copies held by the threads of a
+// parallel region into a shared target. If called from within a parallel
+// region, it must be called by every thread of the team for the same target
+// (as happens when the copies are firstprivate, and gathered on destruction).
+// At step s = 1, 2, 4, ..., the thread of number t, with t % 2s == 0, merges
+// the copy of thread t + s into its own, while that thread waits, so that all
+// copies are combined in log2(n) rounds, each done in parallel, and only
+// thread 0 touches the target. Outside of a parallel region the copy is added
+// to the target directly. merge(a, b) adds b to a, and finish(a) adds a to
+// the target.
+
+template <class Shared>
+class tree_gather
+{
+public:
+    template <class Merge, class Finish>
+    static void run(Shared& self, const void* target, Merge&& merge,
+                    Finish&& finish)
+    {
+        size_t n = 1, tid = 0;
+#ifdef _OPENMP
+        if (omp_in_parallel())
+        {
+            n = omp_get_num_threads();
+            tid = omp_get_thread_num();
+        }
+#endif
+        if (n == 1)
+        {
+            finish(self);
+            return;
+        }
+
+        std::shared_ptr<slots_t> slots;
+        #pragma omp critical (tree_gather)
+        {
+            auto& s = registry()[target];
+            if (s == nullptr)
+                s = std::make_shared<slots_t>(n);
+            slots = s;
+            if (++slots->arrived == n)
+                registry().erase(target); // the next region starts anew
+        }
+
+        for (size_t step = 1; step < n; step *= 2)
+        {
+            if (tid % (2 * step) != 0)
+            {
+                slots->copies[tid].store(&self, std::memory_order_release);
+                while (!slots->merged[tid].load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                return;
+            }
+            size_t partner = tid + step;
+            if (partner >= n)
+                continue;
+            Shared* other;
+            while ((other = slots->copies[partner]
+                    .load(std::memory_order_acquire)) == nullptr)
+                std::this_thread::yield();
+            merge(self, *other);
+            slots->merged[partner].store(true, std::memory_order_release);
+        }
+        finish(self);
+    }
+
+private:
+    struct slots_t
+    {
+        slots_t(size_t n) : copies(n), merged(n), arrived(0) {}
+        std::vector<std::atomic<Shared*>> copies;
+        std::vector<std::atomic<bool>> merged;
+        size_t arrived;
+    };
+
+    static std::unordered_map<const void*, std::shared_ptr<slots_t>>&
+    registry()
+    {
+        static std::unordered_map<const void*, std::shared_ptr<slots_t>> r;
+        return r;
+    }
+};
+
 // This class will encapsulate a map, and atomically sum it to a given resulting
 // map (which is shared among all copies) after it is destructed, or when the
 // Gather() member function is called. This enables, for instance, a histogram
-// to built in parallel.
+// to built in parallel. The copies of a parallel region are combined with
+// tree_gather.
 
 template <class Map>
 class SharedMap: public Map
@@ -37,14 +131,21 @@ public:
     {
         if (_sum != 0)
         {
-            for (decltype(this->begin()) iter = this->begin();
-                 iter != this->end(); ++iter)
-            {
-                #pragma omp critical
-                {
-                    (*_sum)[iter->first] += iter->second;
-                }
-            }
+            tree_gather<SharedMap>::run
+                (*this, _sum,
+                 [](SharedMap& a, SharedMap& b)
+                 {
+                     for (auto& kv : b)
+                         a[kv.first] += kv.second;
+                 },
+                 [](SharedMap& a)
+                 {
+                     #pragma omp critical
+                     {
+                         for (auto& kv : a)
+                             (*a._sum)[kv.first] += kv.second;
+                     }
+                 });
             _sum = 0;
         }
     }
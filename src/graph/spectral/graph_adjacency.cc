@@ -32,7 +32,7 @@ using namespace graph_tool;
 
 void adjacency(GraphInterface& g, boost::any index, boost::any weight,
                python::object odata, python::object oi,
-               python::object oj)
+               python::object oj, python::object oindptr)
 {
     if (!belongs<vertex_scalar_properties>()(index))
         throw ValueException("index vertex property must have a scalar value type");
@@ -50,11 +50,39 @@ void adjacency(GraphInterface& g, boost::any index, boost::any weight,
     multi_array_ref<double,1> data = get_array<double,1>(odata);
     multi_array_ref<int32_t,1> i = get_array<int32_t,1>(oi);
     multi_array_ref<int32_t,1> j = get_array<int32_t,1>(oj);
+    multi_array_ref<int64_t,1> indptr = get_array<int64_t,1>(oindptr);
+    sparse_matrix_out out(data, i, j, indptr);
     run_action<>()
         (g, std::bind(get_adjacency(),
                       std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
-                      std::ref(data), std::ref(i), std::ref(j)),
+                      std::ref(out)),
          vertex_scalar_properties(),
          weight_props_t())(index, weight);
 
 }
+
+void adjacency_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                      python::object ox, python::object oret, bool transpose)
+{
+    if (!belongs<vertex_scalar_properties>()(index))
+        throw ValueException("index vertex property must have a scalar value type");
+
+    typedef UnityPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+    typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    multi_array_ref<double,2> x = get_array<double,2>(ox);
+    multi_array_ref<double,2> ret = get_array<double,2>(oret);
+    run_action<>()
+        (g, std::bind(get_adjacency_matmat(),
+                      std::placeholders::_1,  std::placeholders::_2,  std::placeholders::_3,
+                      std::ref(x), std::ref(ret), transpose),
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+}
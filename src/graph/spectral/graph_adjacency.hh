@@ -26,30 +26,161 @@ namespace graph_tool
 {
 using namespace boost;
 
+// Output arrays of the sparse matrices below, either in COO format, with the
+// row and column of every entry given by i and j, or in CSR format if indptr
+// is non-empty, with the row offsets in indptr and i unused. In the latter
+// case the rows are laid out in the order given by the vertex index, which
+// must then map the vertices onto [0, N-1].
+//
+// The entries of each row are computed independently from the edges of its
+// vertex, and the output positions are obtained beforehand via a prefix sum of
+// the number of entries per row, so that all the arrays can be filled in
+// parallel.
+class sparse_matrix_out
+{
+public:
+    sparse_matrix_out(multi_array_ref<double,1>& data,
+                      multi_array_ref<int32_t,1>& i,
+                      multi_array_ref<int32_t,1>& j,
+                      multi_array_ref<int64_t,1>& indptr)
+        : _data(data), _i(i), _j(j), _indptr(indptr) {}
+
+    bool is_csr() const { return _indptr.num_elements() > 0; }
+
+    // Calls f(v, put) for every vertex v in parallel, where count(v) is the
+    // number of entries of its row, and put(col, x) appends x at column col
+    // of that row.
+    template <class Graph, class Index, class Count, class F>
+    void fill(const Graph& g, Index index, Count&& count, F&& f)
+    {
+        size_t N = num_vertices(g);
+        std::vector<size_t> pos(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 pos[v + 1] = count(v);
+             });
+
+        if (is_csr())
+        {
+            _indptr[0] = 0;
+            for (auto v : vertices_range(g))
+                _indptr[get(index, v) + 1] = pos[v + 1];
+            for (size_t r = 1; r < _indptr.num_elements(); ++r)
+                _indptr[r] += _indptr[r - 1];
+            for (auto v : vertices_range(g))
+                pos[v] = _indptr[get(index, v)];
+        }
+        else
+        {
+            std::partial_sum(pos.begin(), pos.end(), pos.begin());
+        }
+
+        bool csr = is_csr();
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t p = pos[v];
+                 int32_t row = get(index, v);
+                 f(v,
+                   [&](int32_t col, double x)
+                   {
+                       _data[p] = x;
+                       if (!csr)
+                           _i[p] = row;
+                       _j[p] = col;
+                       ++p;
+                   });
+             });
+    }
+
+private:
+    multi_array_ref<double,1>& _data;
+    multi_array_ref<int32_t,1>& _i;
+    multi_array_ref<int32_t,1>& _j;
+    multi_array_ref<int64_t,1>& _indptr;
+};
+
+// Number of edges visited by matrix_row_edges() below, without transposition.
+template <class Graph>
+size_t matrix_row_degree(const Graph& g,
+                         typename graph_traits<Graph>::vertex_descriptor v)
+{
+    if (graph_tool::is_directed(g))
+        return in_degreeS()(v, g);
+    return out_degree(v, g);
+}
+
+// Calls f(e, u) for every edge e which contributes to the row of vertex v of
+// the matrices built as above, i.e. the edges u -> v, where u is the other
+// endpoint, or for the transposed matrix, the edges v -> u. For undirected
+// graphs both are the same, and self-loops are visited twice.
+template <class Graph, class F>
+void matrix_row_edges(const Graph& g,
+                      typename graph_traits<Graph>::vertex_descriptor v,
+                      bool transpose, F&& f)
+{
+    if (transpose || !graph_tool::is_directed(g))
+    {
+        for (const auto& e : out_edges_range(v, g))
+            f(e, target(e, g));
+    }
+    else
+    {
+        for (const auto& e : in_or_out_edges_range(v, g))
+            f(e, source(e, g));
+    }
+}
+
 struct get_adjacency
 {
     template <class Graph, class Index, class Weight>
     void operator()(Graph& g, Index index, Weight weight,
-                    multi_array_ref<double,1>& data,
-                    multi_array_ref<int,1>& i,
-                    multi_array_ref<int,1>& j) const
+                    sparse_matrix_out& out) const
     {
-        int pos = 0;
-        for (const auto& e : edges_range(g))
-        {
-            data[pos] = get(weight, e);
-            i[pos] = get(index, target(e, g));
-            j[pos] = get(index, source(e, g));
-
-            ++pos;
-            if (!graph_tool::is_directed(g))
-            {
-                data[pos] = get(weight, e);
-                i[pos] = get(index, source(e, g));
-                j[pos] = get(index, target(e, g));
-                ++pos;
-            }
-        }
+        out.fill(g, index,
+                 [&](auto v) { return matrix_row_degree(g, v); },
+                 [&](auto v, auto&& put)
+                 {
+                     matrix_row_edges(g, v, false,
+                                      [&](const auto& e, auto u)
+                                      {
+                                          put(get(index, u), get(weight, e));
+                                      });
+                 });
+    }
+};
+
+// Matrix-free product ret = A x, or ret = A^T x if transpose is true, for a
+// block of vectors given by the columns of x, with the rows indexed by
+// index. The rows of ret are computed independently in parallel.
+struct get_adjacency_matmat
+{
+    template <class Graph, class Index, class Weight>
+    void operator()(Graph& g, Index index, Weight weight,
+                    multi_array_ref<double,2>& x,
+                    multi_array_ref<double,2>& ret, bool transpose) const
+    {
+        size_t M = x.shape()[1];
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto y = ret[get(index, v)];
+                 for (size_t l = 0; l < M; ++l)
+                     y[l] = 0;
+                 matrix_row_edges
+                     (g, v, transpose,
+                      [&](const auto& e, auto u)
+                      {
+                          double w = get(weight, e);
+                          auto xu = x[get(index, u)];
+                          for (size_t l = 0; l < M; ++l)
+                              y[l] += w * xu[l];
+                      });
+             });
     }
 };
 
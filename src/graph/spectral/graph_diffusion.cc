@@ -0,0 +1,68 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/python.hpp>
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "numpy_bind.hh"
+
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+
+#include "graph_diffusion.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+void diffusion(GraphInterface& g, boost::any index, boost::any weight,
+               bool normalized, bool transpose, size_t t,
+               python::object osteps, python::object ox, python::object oret)
+{
+    if (!belongs<vertex_scalar_properties>()(index))
+        throw ValueException("index vertex property must have a scalar value type");
+
+    typedef UnityPropertyMap<int, GraphInterface::edge_t> weight_map_t;
+    typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    multi_array_ref<int64_t,1> asteps = get_array<int64_t,1>(osteps);
+    vector<int64_t> steps(asteps.begin(), asteps.end());
+    for (size_t i = 0; i < steps.size(); ++i)
+    {
+        if (steps[i] < 1 || size_t(steps[i]) > t ||
+            (i > 0 && steps[i] <= steps[i - 1]))
+            throw ValueException("steps must be increasing, and lie in [1, t]");
+    }
+
+    multi_array_ref<double,2> x = get_array<double,2>(ox);
+    multi_array_ref<double,3> ret = get_array<double,3>(oret);
+    run_action<>()
+        (g, std::bind(get_diffusion(),
+                      std::placeholders::_1,  std::placeholders::_2,  std::placeholders::_3,
+                      normalized, transpose, t, std::cref(steps), std::ref(x),
+                      std::ref(ret)),
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+}
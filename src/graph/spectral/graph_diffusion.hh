@@ -0,0 +1,143 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_DIFFUSION_HH
+#define GRAPH_DIFFUSION_HH
+
+#include <vector>
+#include <numeric>
+#include <cmath>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "graph_adjacency.hh"
+#include "graph_transition.hh"
+
+namespace graph_tool
+{
+using namespace boost;
+
+// Repeated products Y = M^t X, for a block of k vectors given by the N x k
+// array x, where M is either the transition matrix T of get_transition(), or
+// the normalized adjacency matrix D^{-1/2} A D^{-1/2}, with D given by the
+// weighted out-degrees (or their transposes). The matrix is first copied in
+// CSR format, with the rows in the order of the vertex index (which must map
+// the vertices onto [0, N-1]), and then each product pulls the values of the
+// row neighbors from one dense N x k buffer into the other, in parallel over
+// the rows. The result after each step listed in steps (in increasing order,
+// and not larger than t) is copied into the corresponding slice of ret, which
+// has shape S x N x k, where S is the number of such steps.
+struct get_diffusion
+{
+    template <class Graph, class Index, class Weight>
+    void operator()(const Graph& g, Index index, Weight weight,
+                    bool normalized, bool transpose, size_t t,
+                    const std::vector<int64_t>& steps,
+                    multi_array_ref<double,2>& x,
+                    multi_array_ref<double,3>& ret) const
+    {
+        size_t N = x.shape()[0];
+        size_t k = x.shape()[1];
+
+        std::vector<double> ks(num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 ks[v] = sum_degree(g, v, weight);
+             });
+
+        auto coeff = [&](auto v, auto u) -> double
+            {
+                if (normalized)
+                {
+                    double d = ks[u] * ks[v];
+                    return (d > 0) ? 1. / sqrt(d) : 0;
+                }
+                // the column is always that of the source
+                double d = transpose ? ks[v] : ks[u];
+                return (d != 0) ? 1. / d : 0;
+            };
+
+        std::vector<size_t> offset(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t d = 0;
+                 matrix_row_edges(g, v, transpose,
+                                  [&](auto&&, auto) { ++d; });
+                 offset[get(index, v) + 1] = d;
+             });
+        std::partial_sum(offset.begin(), offset.end(), offset.begin());
+
+        std::vector<size_t> col(offset[N]);
+        std::vector<double> w(offset[N]);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t p = offset[get(index, v)];
+                 matrix_row_edges(g, v, transpose,
+                                  [&](const auto& e, auto u)
+                                  {
+                                      col[p] = get(index, u);
+                                      w[p] = get(weight, e) * coeff(v, u);
+                                      ++p;
+                                  });
+             });
+
+        std::vector<double> a(N * k), b(N * k);
+        for (size_t i = 0; i < N; ++i)
+            for (size_t l = 0; l < k; ++l)
+                a[i * k + l] = x[i][l];
+
+        size_t s = 0;
+        for (size_t n = 1; n <= t; ++n)
+        {
+            #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < N; ++i)
+            {
+                double* y = &b[i * k];
+                for (size_t l = 0; l < k; ++l)
+                    y[l] = 0;
+                for (size_t p = offset[i]; p < offset[i + 1]; ++p)
+                {
+                    const double* z = &a[col[p] * k];
+                    double c = w[p];
+                    for (size_t l = 0; l < k; ++l)
+                        y[l] += c * z[l];
+                }
+            }
+            a.swap(b);
+
+            for (; s < steps.size() && size_t(steps[s]) == n; ++s)
+            {
+                auto r = ret[s];
+                #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+                for (size_t i = 0; i < N; ++i)
+                    for (size_t l = 0; l < k; ++l)
+                        r[i][l] = a[i * k + l];
+            }
+        }
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_DIFFUSION_HH
@@ -32,7 +32,7 @@ using namespace graph_tool;
 
 void incidence(GraphInterface& g, boost::any vindex, boost::any eindex,
                python::object odata, python::object oi,
-               python::object oj)
+               python::object oj, python::object oindptr)
 {
     if (!belongs<vertex_scalar_properties>()(vindex))
         throw ValueException("index vertex property must have a scalar value type");
@@ -42,10 +42,12 @@ void incidence(GraphInterface& g, boost::any vindex, boost::any eindex,
     multi_array_ref<double,1> data = get_array<double,1>(odata);
     multi_array_ref<int32_t,1> i = get_array<int32_t,1>(oi);
     multi_array_ref<int32_t,1> j = get_array<int32_t,1>(oj);
+    multi_array_ref<int64_t,1> indptr = get_array<int64_t,1>(oindptr);
+    sparse_matrix_out out(data, i, j, indptr);
     run_action<>()
         (g, std::bind(get_incidence(),
                       std::placeholders::_1,  std::placeholders::_2,  std::placeholders::_3,
-                      std::ref(data), std::ref(i), std::ref(j)),
+                      std::ref(out)),
          vertex_scalar_properties(),
          edge_scalar_properties())(vindex, eindex);
 
@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_adjacency.hh"
 
 namespace graph_tool
 {
@@ -30,32 +31,21 @@ struct get_incidence
 {
     template <class Graph, class VIndex, class EIndex>
     void operator()(Graph& g, VIndex vindex, EIndex eindex,
-                    multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    sparse_matrix_out& out) const
     {
-        int pos = 0;
-        for (auto v : vertices_range(g))
-        {
-            for (const auto& e : out_edges_range(v, g))
-            {
-                if (graph_tool::is_directed(g))
-                    data[pos] = -1;
-                else
-                    data[pos] = 1;
-                i[pos] = get(vindex, v);
-                j[pos] = get(eindex, e);
-                ++pos;
-            }
-
-            for (const auto& e : in_edges_range(v, g))
-            {
-                data[pos] = 1;
-                i[pos] = get(vindex, v);
-                j[pos] = get(eindex, e);
-                ++pos;
-            }
-        }
+        out.fill(g, vindex,
+                 [&](auto v)
+                 {
+                     return out_degreeS()(v, g) + in_degreeS()(v, g);
+                 },
+                 [&](auto v, auto&& put)
+                 {
+                     for (const auto& e : out_edges_range(v, g))
+                         put(get(eindex, e),
+                             graph_tool::is_directed(g) ? -1 : 1);
+                     for (const auto& e : in_edges_range(v, g))
+                         put(get(eindex, e), 1);
+                 });
     }
 };
 
@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_adjacency.hh"
 
 namespace graph_tool
 {
@@ -69,117 +70,169 @@ sum_degree(Graph& g, typename graph_traits<Graph>::vertex_descriptor v,
     return out_degreeS()(v, g);
 }
 
+template <class Graph, class Weight>
+double get_degree(const Graph& g,
+                  typename graph_traits<Graph>::vertex_descriptor v,
+                  Weight weight, deg_t deg)
+{
+    switch (deg)
+    {
+    case OUT_DEG:
+        return sum_degree(g, v, weight, out_edge_iteratorS<Graph>());
+    case IN_DEG:
+        return sum_degree(g, v, weight, in_edge_iteratorS<Graph>());
+    default:
+        return sum_degree(g, v, weight, all_edges_iteratorS<Graph>());
+    }
+}
+
+// Number of entries of the row of vertex v of the Laplacians below, i.e. the
+// edges of the row without the self-loops, plus the diagonal.
+template <class Graph>
+size_t laplacian_row_count(const Graph& g,
+                           typename graph_traits<Graph>::vertex_descriptor v)
+{
+    size_t k = 1;
+    matrix_row_edges(g, v, false,
+                     [&](const auto&, auto u)
+                     {
+                         if (u != v)
+                             ++k;
+                     });
+    return k;
+}
+
 struct get_laplacian
 {
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
-                    multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    sparse_matrix_out& out) const
     {
-        int pos = 0;
-        for (const auto& e : edges_range(g))
-        {
-            if (source(e, g) == target(e, g))
-                continue;
-
-            data[pos] = -get(weight, e);
-            i[pos] = get(index, target(e, g));
-            j[pos] = get(index, source(e, g));
-
-            ++pos;
-            if (!graph_tool::is_directed(g))
-            {
-                data[pos] = -get(weight, e);
-                i[pos] = get(index, source(e, g));
-                j[pos] = get(index, target(e, g));
-                ++pos;
-            }
-        }
-
-        for (auto v : vertices_range(g))
-        {
-            double k = 0;
-            switch (deg)
-            {
-            case OUT_DEG:
-                k = sum_degree(g, v, weight, out_edge_iteratorS<Graph>());
-                break;
-            case IN_DEG:
-                k = sum_degree(g, v, weight, in_edge_iteratorS<Graph>());
-                break;
-            case TOTAL_DEG:
-                k = sum_degree(g, v, weight, all_edges_iteratorS<Graph>());
-            }
-            data[pos] = k;
-            i[pos] = j[pos] = get(index, v);
-            ++pos;
-        }
-
+        out.fill(g, index,
+                 [&](auto v) { return laplacian_row_count(g, v); },
+                 [&](auto v, auto&& put)
+                 {
+                     put(get(index, v), get_degree(g, v, weight, deg));
+                     matrix_row_edges(g, v, false,
+                                      [&](const auto& e, auto u)
+                                      {
+                                          if (u != v)
+                                              put(get(index, u),
+                                                  -get(weight, e));
+                                      });
+                 });
     }
 };
 
-
-
 struct get_norm_laplacian
 {
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
-                    multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    sparse_matrix_out& out) const
     {
-        int pos = 0;
-        for (auto v : vertices_range(g))
-        {
-            double ks = 0;
-            switch (deg)
-            {
-            case OUT_DEG:
-                ks = sum_degree(g, v, weight, out_edge_iteratorS<Graph>());
-                break;
-            case IN_DEG:
-                ks = sum_degree(g, v, weight, in_edge_iteratorS<Graph>());
-                break;
-            case TOTAL_DEG:
-                ks = sum_degree(g, v, weight, all_edges_iteratorS<Graph>());
-            }
-
-            for(const auto& e : out_edges_range(v, g))
-            {
-                if (source(e, g) == target(e, g))
-                    continue;
-                double kt = 0;
-
-                switch (deg)
-                {
-                case OUT_DEG:
-                    kt = sum_degree(g, target(e, g), weight, out_edge_iteratorS<Graph>());
-                    break;
-                case IN_DEG:
-                    kt = sum_degree(g, target(e, g), weight, in_edge_iteratorS<Graph>());
-                    break;
-                case TOTAL_DEG:
-                    kt = sum_degree(g, target(e, g), weight, all_edges_iteratorS<Graph>());
-                }
-
-                if (ks * kt > 0)
-                    data[pos] = -get(weight, e) / sqrt(ks * kt);
-                i[pos] = get(index, target(e, g));
-                j[pos] = get(index, source(e, g));
-
-                ++pos;
-            }
-
-            if (ks > 0)
-                data[pos] = 1;
-            i[pos] = j[pos] = get(index, v);
-            ++pos;
-        }
+        std::vector<double> ks(num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 ks[v] = get_degree(g, v, weight, deg);
+             });
+
+        out.fill(g, index,
+                 [&](auto v) { return laplacian_row_count(g, v); },
+                 [&](auto v, auto&& put)
+                 {
+                     put(get(index, v), (ks[v] > 0) ? 1 : 0);
+                     matrix_row_edges(g, v, false,
+                                      [&](const auto& e, auto u)
+                                      {
+                                          if (u == v)
+                                              return;
+                                          double kk = ks[v] * ks[u];
+                                          put(get(index, u),
+                                              (kk > 0) ?
+                                              -get(weight, e) / sqrt(kk) : 0);
+                                      });
+                 });
+    }
+};
 
+// Matrix-free products ret = L x, or ret = L^T x if transpose is true, for a
+// block of vectors given by the columns of x, with the rows indexed by index,
+// as in get_adjacency_matmat().
+struct get_laplacian_matmat
+{
+    template <class Graph, class Index, class Weight>
+    void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
+                    multi_array_ref<double,2>& x,
+                    multi_array_ref<double,2>& ret, bool transpose) const
+    {
+        size_t M = x.shape()[1];
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto i = get(index, v);
+                 auto y = ret[i];
+                 auto xv = x[i];
+                 double k = get_degree(g, v, weight, deg);
+                 for (size_t l = 0; l < M; ++l)
+                     y[l] = k * xv[l];
+                 matrix_row_edges
+                     (g, v, transpose,
+                      [&](const auto& e, auto u)
+                      {
+                          if (u == v)
+                              return;
+                          double w = get(weight, e);
+                          auto xu = x[get(index, u)];
+                          for (size_t l = 0; l < M; ++l)
+                              y[l] -= w * xu[l];
+                      });
+             });
     }
 };
 
+struct get_norm_laplacian_matmat
+{
+    template <class Graph, class Index, class Weight>
+    void operator()(const Graph& g, Index index, Weight weight, deg_t deg,
+                    multi_array_ref<double,2>& x,
+                    multi_array_ref<double,2>& ret, bool transpose) const
+    {
+        size_t M = x.shape()[1];
+        std::vector<double> ks(num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 ks[v] = get_degree(g, v, weight, deg);
+             });
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto i = get(index, v);
+                 auto y = ret[i];
+                 auto xv = x[i];
+                 for (size_t l = 0; l < M; ++l)
+                     y[l] = (ks[v] > 0) ? xv[l] : 0;
+                 matrix_row_edges
+                     (g, v, transpose,
+                      [&](const auto& e, auto u)
+                      {
+                          double kk = ks[v] * ks[u];
+                          if (u == v || kk <= 0)
+                              return;
+                          double w = get(weight, e) / sqrt(kk);
+                          auto xu = x[get(index, u)];
+                          for (size_t l = 0; l < M; ++l)
+                              y[l] -= w * xu[l];
+                      });
+             });
+    }
+};
 
 } // namespace graph_tool
 
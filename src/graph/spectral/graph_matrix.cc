@@ -17,6 +17,7 @@
 
 #include <boost/python.hpp>
 #include "graph.hh"
+#include "random.hh"
 
 using namespace std;
 using namespace boost;
@@ -24,27 +25,69 @@ using namespace graph_tool;
 
 void adjacency(GraphInterface& g, boost::any index, boost::any weight,
                python::object odata, python::object oi,
-               python::object oj);
+               python::object oj, python::object oindptr);
 
 
 void laplacian(GraphInterface& g, boost::any index, boost::any weight,
                string sdeg,
                python::object odata, python::object oi,
-               python::object oj);
+               python::object oj, python::object oindptr);
 
 
 void norm_laplacian(GraphInterface& g, boost::any index, boost::any weight,
                     string sdeg,
                     python::object odata, python::object oi,
-                    python::object oj);
+                    python::object oj, python::object oindptr);
 
 void incidence(GraphInterface& g, boost::any vindex, boost::any eindex,
                python::object odata, python::object oi,
-               python::object oj);
+               python::object oj, python::object oindptr);
 
 void transition(GraphInterface& g, boost::any index, boost::any weight,
                 python::object odata, python::object oi,
-                python::object oj);
+                python::object oj, python::object oindptr);
+
+void adjacency_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                      python::object ox, python::object oret, bool transpose);
+
+void laplacian_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                      string sdeg, python::object ox, python::object oret,
+                      bool transpose);
+
+void norm_laplacian_matmat(GraphInterface& g, boost::any index,
+                           boost::any weight, string sdeg, python::object ox,
+                           python::object oret, bool transpose);
+
+void transition_matmat(GraphInterface& g, boost::any index, boost::any weight,
+                       python::object ox, python::object oret, bool transpose);
+
+void diffusion(GraphInterface& g, boost::any index, boost::any weight,
+               bool normalized, bool transpose, size_t t,
+               python::object osteps, python::object ox, python::object oret);
+
+size_t randomized_svd(GraphInterface& g, boost::any index, boost::any weight,
+                      bool normalized, size_t l, size_t n_iter,
+                      python::object oU, python::object oS, python::object oV,
+                      rng_t& rng);
+
+python::object nonbacktracking(GraphInterface& gi, boost::any index);
+
+void nonbacktracking_matvec(GraphInterface& gi, boost::any index,
+                            python::object ox, python::object oret,
+                            bool transpose);
+
+void compact_nonbacktracking_matvec(GraphInterface& gi, boost::any index,
+                                    python::object ox, python::object oret,
+                                    bool transpose);
+
+python::object nonbacktracking_eig(GraphInterface& gi, boost::any index,
+                                   bool compact, size_t M, double epsilon,
+                                   size_t max_iter);
+
+python::object spectral_embedding(GraphInterface& gi, boost::any weight,
+                                  boost::any ax, bool normalized, size_t k,
+                                  double epsilon, size_t max_iter,
+                                  bool multilevel, rng_t& rng);
 
 BOOST_PYTHON_MODULE(libgraph_tool_spectral)
 {
@@ -54,4 +97,15 @@ BOOST_PYTHON_MODULE(libgraph_tool_spectral)
     def("norm_laplacian", &norm_laplacian);
     def("incidence", &incidence);
     def("transition", &transition);
+    def("adjacency_matmat", &adjacency_matmat);
+    def("laplacian_matmat", &laplacian_matmat);
+    def("norm_laplacian_matmat", &norm_laplacian_matmat);
+    def("transition_matmat", &transition_matmat);
+    def("diffusion", &diffusion);
+    def("randomized_svd", &randomized_svd);
+    def("nonbacktracking", &nonbacktracking);
+    def("nonbacktracking_matvec", &nonbacktracking_matvec);
+    def("compact_nonbacktracking_matvec", &compact_nonbacktracking_matvec);
+    def("nonbacktracking_eig", &nonbacktracking_eig);
+    def("spectral_embedding", &spectral_embedding);
 }
@@ -0,0 +1,143 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/python.hpp>
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "numpy_bind.hh"
+
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+
+#include "graph_nonbacktracking.hh"
+#include "../centrality/graph_krylov.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+python::object nonbacktracking(GraphInterface& gi, boost::any index)
+{
+    if (!belongs<edge_scalar_properties>()(index))
+        throw ValueException("index edge property must have a scalar value type");
+
+    vector<int64_t> i, j;
+    run_action<>()
+        (gi, [&](auto& g, auto idx)
+             {
+                 get_nonbacktracking()(g, idx, i, j);
+             },
+         edge_scalar_properties())(index);
+    return python::make_tuple(wrap_vector_owned(i), wrap_vector_owned(j));
+}
+
+void nonbacktracking_matvec(GraphInterface& gi, boost::any index,
+                            python::object ox, python::object oret,
+                            bool transpose)
+{
+    if (!belongs<edge_scalar_properties>()(index))
+        throw ValueException("index edge property must have a scalar value type");
+
+    multi_array_ref<double,1> x = get_array<double,1>(ox);
+    multi_array_ref<double,1> ret = get_array<double,1>(oret);
+    run_action<>()
+        (gi, [&](auto& g, auto idx)
+             {
+                 get_nonbacktracking_matvec()(g, idx, x, ret, transpose);
+             },
+         edge_scalar_properties())(index);
+}
+
+void compact_nonbacktracking_matvec(GraphInterface& gi, boost::any index,
+                                    python::object ox, python::object oret,
+                                    bool transpose)
+{
+    if (!belongs<vertex_scalar_properties>()(index))
+        throw ValueException("index vertex property must have a scalar value type");
+
+    multi_array_ref<double,1> x = get_array<double,1>(ox);
+    multi_array_ref<double,1> ret = get_array<double,1>(oret);
+    size_t N = x.shape()[0] / 2;
+    run_action<graph_tool::detail::never_directed>()
+        (gi, [&](auto& g, auto idx)
+             {
+                 get_compact_nonbacktracking_matvec()(g, idx, N, x, ret,
+                                                      transpose);
+             },
+         vertex_scalar_properties())(index);
+}
+
+// Leading eigenpair of B, or of its compact version, with the Arnoldi method
+// of graph_krylov.hh, and the products above. The eigenvector has size M,
+// with the same indexing as the matrix, and a non-negative sum.
+python::object nonbacktracking_eig(GraphInterface& gi, boost::any index,
+                                   bool compact, size_t M, double epsilon,
+                                   size_t max_iter)
+{
+    vector<double> x(M, 0);
+    double eval = 0;
+    size_t n_matvec = 0;
+    auto solve = [&](auto&& matvec)
+        {
+            n_matvec = krylov_eig(matvec, x, 20, epsilon, max_iter, eval);
+        };
+
+    if (compact)
+    {
+        if (!belongs<vertex_scalar_properties>()(index))
+            throw ValueException("index vertex property must have a scalar value type");
+        size_t N = M / 2;
+        run_action<graph_tool::detail::never_directed>()
+            (gi, [&](auto& g, auto idx)
+                 {
+                     for (auto v : vertices_range(g))
+                         x[get(idx, v)] = x[N + get(idx, v)] = 1;
+                     solve([&](const vector<double>& z, vector<double>& y)
+                           {
+                               get_compact_nonbacktracking_matvec()
+                                   (g, idx, N, z, y, false);
+                           });
+                 },
+             vertex_scalar_properties())(index);
+    }
+    else
+    {
+        if (!belongs<edge_scalar_properties>()(index))
+            throw ValueException("index edge property must have a scalar value type");
+        run_action<>()
+            (gi, [&](auto& g, auto idx)
+                 {
+                     for (auto v : vertices_range(g))
+                         matrix_row_edges(g, v, false,
+                                          [&](const auto& e, auto u)
+                                          {
+                                              x[nonbacktracking_index(g, idx, e, u, v)] = 1;
+                                          });
+                     solve([&](const vector<double>& z, vector<double>& y)
+                           {
+                               get_nonbacktracking_matvec()(g, idx, z, y,
+                                                            false);
+                           });
+                 },
+             edge_scalar_properties())(index);
+    }
+
+    if (std::accumulate(x.begin(), x.end(), 0.) < 0)
+        krylov::scale(-1, x);
+    return python::make_tuple(eval, wrap_vector_owned(x), n_matvec);
+}
@@ -0,0 +1,206 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_NONBACKTRACKING_HH
+#define GRAPH_NONBACKTRACKING_HH
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "graph_adjacency.hh"
+
+namespace graph_tool
+{
+using namespace boost;
+
+// The non-backtracking (Hashimoto) matrix B is indexed by the directed edges,
+// with B[u->v][v->w] = 1 if w != u, and 0 otherwise. For directed graphs the
+// directed edges are the edges themselves, with their index given by eindex,
+// and for undirected graphs each edge of index i gives the two directed edges
+// 2 i and 2 i + 1, towards the endpoint of largest and smallest vertex index,
+// respectively. (The two traversals of a self-loop in an undirected graph
+// therefore get the same index.)
+template <class Graph, class EIndex>
+int64_t nonbacktracking_index(const Graph& g, EIndex eindex,
+                              const typename graph_traits<Graph>::edge_descriptor& e,
+                              typename graph_traits<Graph>::vertex_descriptor u,
+                              typename graph_traits<Graph>::vertex_descriptor v)
+{
+    int64_t i = get(eindex, e);
+    if (!graph_tool::is_directed(g))
+        i = (i << 1) + (u > v);
+    return i;
+}
+
+// Calls f(e1, u, e2, w) for every pair of directed edges u -> v, v -> w with
+// w != u, i.e. every non-zero entry of the row of u -> v.
+template <class Graph, class F>
+void nonbacktracking_pairs(const Graph& g,
+                           typename graph_traits<Graph>::vertex_descriptor v,
+                           F&& f)
+{
+    matrix_row_edges(g, v, false,
+                     [&](const auto& e1, auto u)
+                     {
+                         matrix_row_edges(g, v, true,
+                                          [&](const auto& e2, auto w)
+                                          {
+                                              if (w != u)
+                                                  f(e1, u, e2, w);
+                                          });
+                     });
+}
+
+// Builds B in COO format, with the entries (all equal to one) grouped by the
+// middle vertex v of the pairs u -> v -> w, whose number is obtained
+// beforehand, so that the arrays can be filled in parallel.
+struct get_nonbacktracking
+{
+    template <class Graph, class EIndex>
+    void operator()(const Graph& g, EIndex eindex, std::vector<int64_t>& i,
+                    std::vector<int64_t>& j) const
+    {
+        size_t N = num_vertices(g);
+        std::vector<size_t> pos(N + 1, 0);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t k = 0;
+                 nonbacktracking_pairs(g, v,
+                                       [&](auto&&, auto, auto&&, auto) { ++k; });
+                 pos[v + 1] = k;
+             });
+        std::partial_sum(pos.begin(), pos.end(), pos.begin());
+
+        i.resize(pos[N]);
+        j.resize(pos[N]);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t p = pos[v];
+                 nonbacktracking_pairs
+                     (g, v,
+                      [&](const auto& e1, auto u, const auto& e2, auto w)
+                      {
+                          i[p] = nonbacktracking_index(g, eindex, e1, u, v);
+                          j[p] = nonbacktracking_index(g, eindex, e2, v, w);
+                          ++p;
+                      });
+             });
+    }
+};
+
+// Matrix-free product ret = B x, or ret = B^T x if transpose is true, without
+// going over the pairs of edges. Since
+//
+//     (B x)[u->v] = sum_{v->w} x[v->w] - sum_{v->u} x[v->u],
+//
+// this needs, for each vertex v, only the sum of x over its outgoing directed
+// edges, and the same sums for each of its neighbors, which are kept in a
+// thread-local array indexed by the vertices (only the touched entries are
+// reset). The transposed product is the same with the directions swapped.
+// Only O(E) work is done per product, and the rows are computed in parallel,
+// each by a single thread.
+struct get_nonbacktracking_matvec
+{
+    template <class Graph, class EIndex, class Vec>
+    void operator()(const Graph& g, EIndex eindex, const Vec& x, Vec& ret,
+                    bool transpose) const
+    {
+        std::vector<double> t(num_vertices(g), 0);
+
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(t)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 // the pairs are u -> v -> w, where the columns are v -> w,
+                 // or u -> v if transposed
+                 double s = 0;
+                 matrix_row_edges
+                     (g, v, !transpose,
+                      [&](const auto& e, auto w)
+                      {
+                          auto k = transpose ?
+                              nonbacktracking_index(g, eindex, e, w, v) :
+                              nonbacktracking_index(g, eindex, e, v, w);
+                          s += x[k];
+                          t[w] += x[k];
+                      });
+
+                 matrix_row_edges
+                     (g, v, transpose,
+                      [&](const auto& e, auto u)
+                      {
+                          auto k = transpose ?
+                              nonbacktracking_index(g, eindex, e, v, u) :
+                              nonbacktracking_index(g, eindex, e, u, v);
+                          ret[k] = s - t[u];
+                      });
+
+                 matrix_row_edges(g, v, !transpose,
+                                  [&](const auto&, auto w) { t[w] = 0; });
+             });
+    }
+};
+
+// Matrix-free product with the compact 2N x 2N version of B given by the
+// Ihara-Bass formula, for undirected graphs,
+//
+//     B' = | A   -I |
+//          | D-I  0 |,
+//
+// where A is the adjacency matrix, D the diagonal degree matrix and I the
+// identity. The eigenvalues of B are those of B', together with E - N copies
+// of 1 and -1. The vertex v corresponds to the entries index[v] and N +
+// index[v] of x, where the indexes must lie in [0, N-1].
+struct get_compact_nonbacktracking_matvec
+{
+    template <class Graph, class VIndex, class Vec>
+    void operator()(const Graph& g, VIndex index, size_t N, const Vec& x,
+                    Vec& ret, bool transpose) const
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t i = get(index, v);
+                 double k = out_degree(v, g);
+                 double y = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                     y += x[get(index, u)];
+                 if (transpose)
+                 {
+                     ret[i] = y + (k - 1) * x[N + i];
+                     ret[N + i] = -x[i];
+                 }
+                 else
+                 {
+                     ret[i] = y - x[N + i];
+                     ret[N + i] = (k - 1) * x[i];
+                 }
+             });
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_NONBACKTRACKING_HH
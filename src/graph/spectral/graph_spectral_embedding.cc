@@ -0,0 +1,65 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/python.hpp>
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "numpy_bind.hh"
+
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+
+#include "graph_spectral_embedding.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+python::object spectral_embedding(GraphInterface& gi, boost::any weight,
+                                  boost::any ax, bool normalized, size_t k,
+                                  double epsilon, size_t max_iter,
+                                  bool multilevel, rng_t& rng)
+{
+    typedef UnityPropertyMap<double, GraphInterface::edge_t> weight_map_t;
+    typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    if (k == 0)
+        throw ValueException("the number of eigenvectors must be positive");
+
+    typedef vprop_map_t<vector<double>>::type xmap_t;
+    auto x = any_cast<xmap_t>(ax).get_unchecked(num_vertices(gi.get_graph()));
+
+    vector<double> evals;
+    size_t n_matvec = 0;
+    run_action<graph_tool::detail::never_directed>()
+        (gi, [&](auto& g, auto w)
+             {
+                 get_spectral_embedding()(g, w, x, normalized, k, epsilon,
+                                          max_iter, multilevel, rng, evals,
+                                          n_matvec);
+             },
+         weight_props_t())(weight);
+    return python::make_tuple(wrap_vector_owned(evals), n_matvec);
+}
@@ -0,0 +1,426 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SPECTRAL_EMBEDDING_HH
+#define GRAPH_SPECTRAL_EMBEDDING_HH
+
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "random.hh"
+#include "../centrality/graph_krylov.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Symmetric weighted graph in CSR format, over contiguous vertex indexes and
+// without the self-loops, on which the products with the Laplacians are
+// computed, and which is coarsened for the multilevel initial guess. The
+// diagonal of the (combinatorial) Laplacian and the weighted degrees are kept
+// separately, since they differ on the coarse graphs.
+struct sym_csr
+{
+    vector<size_t> offset;
+    vector<size_t> nbr;
+    vector<double> w;
+    vector<double> diag;
+    vector<double> deg;
+
+    size_t size() const { return deg.size(); }
+};
+
+// Builds the above from an undirected graph, with the self-loops contributing
+// only to the diagonal, as in get_laplacian(). The position of each vertex is
+// put in vpos.
+template <class Graph, class Weight>
+void get_sym_csr(const Graph& g, Weight weight, vector<size_t>& vpos,
+                 sym_csr& A)
+{
+    size_t n = 0;
+    vpos.assign(num_vertices(g), numeric_limits<size_t>::max());
+    for (auto v : vertices_range(g))
+        vpos[v] = n++;
+
+    A.offset.assign(n + 1, 0);
+    A.diag.resize(n);
+    A.deg.resize(n);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             size_t k = 0;
+             double d = 0;
+             for (const auto& e : out_edges_range(v, g))
+             {
+                 d += get(weight, e);
+                 if (target(e, g) != v)
+                     ++k;
+             }
+             A.offset[vpos[v] + 1] = k;
+             A.diag[vpos[v]] = A.deg[vpos[v]] = d;
+         });
+    std::partial_sum(A.offset.begin(), A.offset.end(), A.offset.begin());
+
+    A.nbr.resize(A.offset[n]);
+    A.w.resize(A.offset[n]);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             size_t p = A.offset[vpos[v]];
+             for (const auto& e : out_edges_range(v, g))
+             {
+                 auto u = target(e, g);
+                 if (u == v)
+                     continue;
+                 A.nbr[p] = vpos[u];
+                 A.w[p] = get(weight, e);
+                 ++p;
+             }
+         });
+}
+
+// The operator y = s x - L x, where L is the combinatorial (D - A) or
+// normalized (I - D^{-1/2} A D^{-1/2}) Laplacian, and s is the Gershgorin
+// bound on its largest eigenvalue, so that the largest eigenvalues of the
+// former are s minus the smallest ones of L.
+class shifted_laplacian
+{
+public:
+    shifted_laplacian(const sym_csr& A, bool normalized)
+        : _A(A), _normalized(normalized), _dinv(A.size(), 0)
+    {
+        size_t n = A.size();
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (A.deg[i] > 0)
+                _dinv[i] = 1. / sqrt(A.deg[i]);
+        }
+
+        double s = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double r = _normalized ? ((A.deg[i] > 0) ? 1 : 0) : abs(A.diag[i]);
+            for (size_t p = A.offset[i]; p < A.offset[i + 1]; ++p)
+                r += abs(coupling(i, p));
+            s = std::max(s, r);
+        }
+        _shift = s;
+    }
+
+    double shift() const { return _shift; }
+
+    void operator()(const vector<double>& x, vector<double>& y) const
+    {
+        size_t n = _A.size();
+        #pragma omp parallel for schedule(runtime) if (n > OPENMP_MIN_THRESH)
+        for (size_t i = 0; i < n; ++i)
+        {
+            double d = _normalized ? ((_A.deg[i] > 0) ? 1 : 0) : _A.diag[i];
+            double r = (_shift - d) * x[i];
+            for (size_t p = _A.offset[i]; p < _A.offset[i + 1]; ++p)
+                r += coupling(i, p) * x[_A.nbr[p]];
+            y[i] = r;
+        }
+    }
+
+private:
+    // the (negated) off-diagonal entry of L
+    double coupling(size_t i, size_t p) const
+    {
+        if (_normalized)
+            return _A.w[p] * _dinv[i] * _dinv[_A.nbr[p]];
+        return _A.w[p];
+    }
+
+    const sym_csr& _A;
+    bool _normalized;
+    vector<double> _dinv;
+    double _shift;
+};
+
+// Coarsens A by heavy-edge matching: the vertices are visited in random
+// order, and each one which is still unmatched is merged with its unmatched
+// neighbor of largest weight, if there is any. The coarse vertex of each
+// vertex is put in cmap, and the coarse graph in C, with the diagonal of the
+// Laplacian given by P^T L P, where P is the aggregation matrix. Returns the
+// number of coarse vertices.
+inline size_t coarsen(const sym_csr& A, sym_csr& C, vector<size_t>& cmap,
+                      rng_t& rng)
+{
+    constexpr size_t null = numeric_limits<size_t>::max();
+    size_t n = A.size();
+    vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    cmap.assign(n, null);
+    vector<size_t> members;
+    size_t nc = 0;
+    for (auto v : order)
+    {
+        if (cmap[v] != null)
+            continue;
+        size_t best = null;
+        double bw = -numeric_limits<double>::infinity();
+        for (size_t p = A.offset[v]; p < A.offset[v + 1]; ++p)
+        {
+            auto u = A.nbr[p];
+            if (cmap[u] == null && A.w[p] > bw)
+            {
+                best = u;
+                bw = A.w[p];
+            }
+        }
+        cmap[v] = nc;
+        members.push_back(v);
+        if (best != null)
+            cmap[best] = nc;
+        members.push_back(best);
+        ++nc;
+    }
+
+    C.offset.assign(nc + 1, 0);
+    C.diag.assign(nc, 0);
+    C.deg.assign(nc, 0);
+    C.nbr.clear();
+    C.w.clear();
+    vector<size_t> pos(nc, null);
+    for (size_t c = 0; c < nc; ++c)
+    {
+        size_t begin = C.nbr.size();
+        for (size_t l = 0; l < 2; ++l)
+        {
+            auto v = members[2 * c + l];
+            if (v == null)
+                continue;
+            C.diag[c] += A.diag[v];
+            C.deg[c] += A.deg[v];
+            for (size_t p = A.offset[v]; p < A.offset[v + 1]; ++p)
+            {
+                auto u = cmap[A.nbr[p]];
+                if (u == c)
+                {
+                    C.diag[c] -= A.w[p];
+                    continue;
+                }
+                if (pos[u] == null)
+                {
+                    pos[u] = C.nbr.size();
+                    C.nbr.push_back(u);
+                    C.w.push_back(0);
+                }
+                C.w[pos[u]] += A.w[p];
+            }
+        }
+        for (size_t p = begin; p < C.nbr.size(); ++p)
+            pos[C.nbr[p]] = null;
+        C.offset[c + 1] = C.nbr.size();
+    }
+    return nc;
+}
+
+// Smooths the approximate eigenvectors X of L by a few damped Jacobi
+// iterations, which remove the high-frequency errors left by the
+// interpolation from a coarse graph, followed by a Rayleigh-Ritz projection
+// on their span, with the vectors ordered by increasing Rayleigh quotient.
+inline size_t smooth_eigenvectors(const sym_csr& A, bool normalized,
+                                  const shifted_laplacian& op,
+                                  vector<vector<double>>& X)
+{
+    using namespace krylov;
+    constexpr size_t n_smooth = 10;
+    constexpr double omega = 2. / 3;
+
+    size_t n = A.size(), k = X.size(), n_matvec = 0;
+    vector<double> y(n);
+    for (auto& x : X)
+    {
+        for (size_t it = 0; it < n_smooth; ++it)
+        {
+            op(x, y);
+            ++n_matvec;
+            #pragma omp parallel for schedule(runtime) if (n > OPENMP_MIN_THRESH)
+            for (size_t i = 0; i < n; ++i)
+            {
+                double d = normalized ? 1 : A.diag[i];
+                if (d > 0)
+                    x[i] -= omega * (op.shift() * x[i] - y[i]) / d;
+            }
+        }
+    }
+
+    // orthonormalization, dropping the vectors which become dependent
+    size_t m = 0;
+    for (size_t l = 0; l < k; ++l)
+    {
+        for (size_t r = 0; r < m; ++r)
+            axpy(-dot(X[r], X[l]), X[r], X[l]);
+        double norm = sqrt(dot(X[l], X[l]));
+        if (norm < 1e-8)
+            continue;
+        scale(1. / norm, X[l]);
+        X[l].swap(X[m++]);
+    }
+    X.resize(m);
+
+    vector<vector<double>> Y(m, vector<double>(n));
+    for (size_t l = 0; l < m; ++l)
+        op(X[l], Y[l]);
+    n_matvec += m;
+    vector<double> T(m * m), w, Z;
+    for (size_t l = 0; l < m; ++l)
+        for (size_t r = 0; r < m; ++r)
+            T[l * m + r] = dot(X[l], Y[r]);
+    symmetric_eigen(m, T, w, Z);
+    rotate_basis(X, m, Z, m, m);
+    return n_matvec;
+}
+
+// Approximates the k smallest eigenvectors of the Laplacian of A by the
+// multilevel scheme: A is coarsened recursively by heavy-edge matching, until
+// it is small or stops shrinking, where the eigenvectors are found by
+// Lanczos. They are then interpolated back level by level, as piecewise
+// constant (in the degree scaled basis, for the normalized Laplacian), and
+// smoothed at each level as above. Returns the number of products.
+inline size_t multilevel_eigenvectors(const sym_csr& A, bool normalized,
+                                      size_t k, rng_t& rng,
+                                      vector<vector<double>>& X)
+{
+    size_t n = A.size();
+    sym_csr C;
+    vector<size_t> cmap;
+    if (n <= std::max(size_t(100), 4 * k) || coarsen(A, C, cmap, rng) >= 0.9 * n)
+    {
+        vector<double> x(n), evals;
+        std::uniform_real_distribution<double> u(-1, 1);
+        for (auto& y : x)
+            y = u(rng);
+        shifted_laplacian op(A, normalized);
+        return symmetric_krylov_eigs(op, x, k, std::max(size_t(30), 2 * k + 10),
+                                     1e-8, 0, evals, X);
+    }
+
+    vector<vector<double>> Xc;
+    size_t n_matvec = multilevel_eigenvectors(C, normalized, k, rng, Xc);
+
+    X.assign(Xc.size(), vector<double>(n));
+    for (size_t l = 0; l < Xc.size(); ++l)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            auto c = cmap[i];
+            double s = 1;
+            if (normalized)
+                s = (C.deg[c] > 0) ? sqrt(A.deg[i] / C.deg[c]) : 0;
+            X[l][i] = s * Xc[l][c];
+        }
+    }
+
+    shifted_laplacian op(A, normalized);
+    n_matvec += smooth_eigenvectors(A, normalized, op, X);
+    return n_matvec;
+}
+
+// Finds the k smallest eigenpairs of the combinatorial or normalized
+// Laplacian of A, with the thick-restart Lanczos method of graph_krylov.hh on
+// the shifted operator above. If multilevel is true, the starting vector is a
+// combination of the approximate eigenvectors given by
+// multilevel_eigenvectors(), with a small random perturbation, so that no
+// direction is missing from it. Otherwise, it is random. The eigenvalues are
+// put in evals, in increasing order. Returns the number of products done,
+// at all levels.
+inline size_t laplacian_eigs(const sym_csr& A, bool normalized, size_t k,
+                             double epsilon, size_t max_iter, bool multilevel,
+                             rng_t& rng, vector<double>& evals,
+                             vector<vector<double>>& evecs)
+{
+    size_t n = A.size();
+    evals.clear();
+    evecs.clear();
+    if (n == 0)
+        return 0;
+
+    size_t n_matvec = 0;
+    vector<double> x(n);
+    std::uniform_real_distribution<double> u(-1, 1);
+    for (auto& y : x)
+        y = u(rng);
+
+    if (multilevel)
+    {
+        vector<vector<double>> X;
+        n_matvec += multilevel_eigenvectors(A, normalized, k, rng, X);
+        double eps = 1e-3 / sqrt(double(n));
+        for (auto& y : x)
+            y *= eps;
+        for (size_t l = 0; l < X.size(); ++l)
+            krylov::axpy(1. / (l + 1), X[l], x);
+    }
+
+    shifted_laplacian op(A, normalized);
+    size_t m = std::max(size_t(30), 2 * k + 10);
+    n_matvec += symmetric_krylov_eigs(op, x, k, m, epsilon, max_iter, evals,
+                                      evecs);
+    for (auto& l : evals)
+        l = op.shift() - l;
+    return n_matvec;
+}
+
+// Spectral embedding of the vertices, given by the k smallest eigenvectors of
+// the Laplacian, which are put in the vector property map x, with the
+// eigenvalues in evals. The graph is taken as undirected.
+struct get_spectral_embedding
+{
+    template <class Graph, class Weight, class VectorMap>
+    void operator()(const Graph& g, Weight weight, VectorMap x,
+                    bool normalized, size_t k, double epsilon,
+                    size_t max_iter, bool multilevel, rng_t& rng,
+                    vector<double>& evals, size_t& n_matvec) const
+    {
+        sym_csr A;
+        vector<size_t> vpos;
+        get_sym_csr(g, weight, vpos, A);
+
+        vector<vector<double>> evecs;
+        n_matvec = laplacian_eigs(A, normalized, k, epsilon, max_iter,
+                                  multilevel, rng, evals, evecs);
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto& xv = x[v];
+                 xv.resize(evecs.size());
+                 for (size_t l = 0; l < evecs.size(); ++l)
+                     xv[l] = evecs[l][vpos[v]];
+             });
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_SPECTRAL_EMBEDDING_HH
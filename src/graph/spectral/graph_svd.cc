@@ -0,0 +1,67 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/python.hpp>
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "numpy_bind.hh"
+
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+
+#include "graph_svd.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+size_t randomized_svd(GraphInterface& g, boost::any index, boost::any weight,
+                      bool normalized, size_t l, size_t n_iter,
+                      python::object oU, python::object oS, python::object oV,
+                      rng_t& rng)
+{
+    if (!belongs<vertex_scalar_properties>()(index))
+        throw ValueException("index vertex property must have a scalar value type");
+
+    typedef UnityPropertyMap<int, GraphInterface::edge_t> weight_map_t;
+    typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        weight_props_t;
+
+    if (!weight.empty() && !belongs<edge_scalar_properties>()(weight))
+        throw ValueException("weight edge property must have a scalar value type");
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    multi_array_ref<double,2> U = get_array<double,2>(oU);
+    multi_array_ref<double,1> S = get_array<double,1>(oS);
+    multi_array_ref<double,2> V = get_array<double,2>(oV);
+    if (U.shape()[1] > l || l > U.shape()[0])
+        throw ValueException("the sketch size must lie in [k, N]");
+
+    size_t n_matvec = 0;
+    run_action<>()
+        (g, [&](auto& g, auto idx, auto w)
+             {
+                 n_matvec = get_randomized_svd()(g, idx, w, normalized, l,
+                                                 n_iter, rng, U, S, V);
+             },
+         vertex_scalar_properties(),
+         weight_props_t())(index, weight);
+    return n_matvec;
+}
@@ -0,0 +1,223 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SVD_HH
+#define GRAPH_SVD_HH
+
+#include <vector>
+#include <random>
+#include <cmath>
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_util.hh"
+#include "random.hh"
+#include "graph_adjacency.hh"
+#include "../centrality/graph_krylov.hh"
+
+namespace graph_tool
+{
+using namespace boost;
+
+namespace rsvd
+{
+
+// The blocks below are N x l, row-major.
+
+// G = Y^T Y, with the rows of Y split among the threads
+inline void gram(size_t N, size_t l, const std::vector<double>& Y,
+                 std::vector<double>& G)
+{
+    G.assign(l * l, 0);
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        std::vector<double> t(l * l, 0);
+        #pragma omp for schedule(static)
+        for (size_t r = 0; r < N; ++r)
+        {
+            const double* y = &Y[r * l];
+            for (size_t i = 0; i < l; ++i)
+                for (size_t j = i; j < l; ++j)
+                    t[i * l + j] += y[i] * y[j];
+        }
+        #pragma omp critical (rsvd_gram)
+        for (size_t i = 0; i < l; ++i)
+            for (size_t j = i; j < l; ++j)
+                G[i * l + j] += t[i * l + j];
+    }
+    for (size_t i = 0; i < l; ++i)
+        for (size_t j = 0; j < i; ++j)
+            G[i * l + j] = G[j * l + i];
+}
+
+// Y = Y Z[:, 0..p) diag(s), in place, where Z is l x l row-major, and s has
+// size p. Only the first p columns of each row of Y are then used.
+inline void rotate(size_t N, size_t l, std::vector<double>& Y,
+                   const std::vector<double>& Z, const std::vector<double>& s,
+                   size_t p)
+{
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        std::vector<double> t(p);
+        #pragma omp for schedule(static)
+        for (size_t r = 0; r < N; ++r)
+        {
+            double* y = &Y[r * l];
+            for (size_t i = 0; i < p; ++i)
+            {
+                t[i] = 0;
+                for (size_t j = 0; j < l; ++j)
+                    t[i] += y[j] * Z[j * l + i];
+            }
+            for (size_t i = 0; i < p; ++i)
+                y[i] = t[i] * s[i];
+        }
+    }
+}
+
+// Orthonormalizes the columns of Y, via the eigendecomposition of its Gram
+// matrix, done twice for numerical stability (as in CholeskyQR2). The
+// directions which are numerically dependent are set to zero.
+inline void orthonormalize(size_t N, size_t l, std::vector<double>& Y)
+{
+    std::vector<double> G, w, Z, s(l);
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        gram(N, l, Y, G);
+        krylov::symmetric_eigen(l, G, w, Z);
+        for (size_t i = 0; i < l; ++i)
+            s[i] = (w[i] > w[0] * 1e-24 && w[i] > 0) ? 1. / sqrt(w[i]) : 0;
+        rotate(N, l, Y, Z, s, l);
+    }
+}
+
+} // namespace rsvd
+
+// Randomized truncated SVD of the adjacency matrix A (as in get_adjacency()),
+// or of the normalized R A C, where R and C are the diagonal matrices with the
+// inverse square roots of the weighted row and column sums (i.e. the in- and
+// out-degrees, or just the degrees for undirected graphs), with the range
+// finder of Halko, Martinsson and Tropp: the range of M Omega, for a
+// Gaussian N x l matrix Omega, with l = k + oversampling, is refined with
+// n_iter power iterations (M M^T), with orthonormalization in between, giving
+// the orthonormal basis Q. The SVD of the small l x N matrix Q^T M is then
+// obtained from the eigendecomposition of Q^T M M^T Q, which gives the first k
+// singular values in S (in decreasing order), and the corresponding singular
+// vectors in the columns of the N x k arrays U and V. All products with the
+// matrix are done with get_adjacency_matmat(), on the whole block, for a total
+// of 2 (n_iter + 1) passes over the graph, which is returned.
+struct get_randomized_svd
+{
+    template <class Graph, class Index, class Weight, class RNG>
+    size_t operator()(Graph& g, Index index, Weight weight, bool normalized,
+                      size_t l, size_t n_iter, RNG& rng,
+                      multi_array_ref<double,2>& U,
+                      multi_array_ref<double,1>& S,
+                      multi_array_ref<double,2>& V) const
+    {
+        size_t N = U.shape()[0];
+        size_t k = U.shape()[1];
+
+        std::vector<double> rs(N, 1), cs(N, 1);
+        if (normalized)
+        {
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     double r = 0, c = 0;
+                     matrix_row_edges(g, v, false,
+                                      [&](const auto& e, auto)
+                                      { r += get(weight, e); });
+                     matrix_row_edges(g, v, true,
+                                      [&](const auto& e, auto)
+                                      { c += get(weight, e); });
+                     size_t i = get(index, v);
+                     rs[i] = (r > 0) ? 1. / sqrt(r) : 0;
+                     cs[i] = (c > 0) ? 1. / sqrt(c) : 0;
+                 });
+        }
+
+        size_t n_matvec = 0;
+        std::vector<double> t(N * l);
+        auto matmat = [&](std::vector<double>& x, std::vector<double>& y,
+                          bool transpose)
+            {
+                auto& a = transpose ? rs : cs;
+                auto& b = transpose ? cs : rs;
+                #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+                for (size_t r = 0; r < N; ++r)
+                    for (size_t i = 0; i < l; ++i)
+                        t[r * l + i] = a[r] * x[r * l + i];
+                multi_array_ref<double,2> tx(t.data(), extents[N][l]);
+                multi_array_ref<double,2> ty(y.data(), extents[N][l]);
+                get_adjacency_matmat()(g, index, weight, tx, ty, transpose);
+                #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+                for (size_t r = 0; r < N; ++r)
+                    for (size_t i = 0; i < l; ++i)
+                        y[r * l + i] *= b[r];
+                ++n_matvec;
+            };
+
+        std::vector<double> Y(N * l), Z(N * l);
+        std::normal_distribution<double> normal;
+        for (auto& y : Z)
+            y = normal(rng);
+
+        matmat(Z, Y, false);
+        for (size_t it = 0; it < n_iter; ++it)
+        {
+            rsvd::orthonormalize(N, l, Y);
+            matmat(Y, Z, true);
+            rsvd::orthonormalize(N, l, Z);
+            matmat(Z, Y, false);
+        }
+        rsvd::orthonormalize(N, l, Y);
+
+        // W = M^T Q, and W^T W = Q^T M M^T Q = X diag(S^2) X^T, so that
+        // U = Q X and V = W X diag(S)^{-1}
+        std::vector<double>& W = Z;
+        matmat(Y, W, true);
+        std::vector<double> G, w, X;
+        rsvd::gram(N, l, W, G);
+        krylov::symmetric_eigen(l, G, w, X);
+
+        std::vector<double> one(k, 1), sinv(k);
+        for (size_t i = 0; i < k; ++i)
+        {
+            S[i] = sqrt(std::max(w[i], 0.));
+            sinv[i] = (S[i] > sqrt(std::max(w[0], 0.)) * 1e-12) ? 1. / S[i] : 0;
+        }
+        rsvd::rotate(N, l, Y, X, one, k);
+        rsvd::rotate(N, l, W, X, sinv, k);
+
+        #pragma omp parallel for schedule(runtime) if (N > OPENMP_MIN_THRESH)
+        for (size_t r = 0; r < N; ++r)
+        {
+            for (size_t i = 0; i < k; ++i)
+            {
+                U[r][i] = Y[r * l + i];
+                V[r][i] = W[r * l + i];
+            }
+        }
+        return n_matvec;
+    }
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_SVD_HH
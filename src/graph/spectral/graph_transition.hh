@@ -21,6 +21,7 @@
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_util.hh"
+#include "graph_adjacency.hh"
 
 namespace graph_tool
 {
@@ -50,22 +51,68 @@ struct get_transition
 {
     template <class Graph, class Index, class Weight>
     void operator()(const Graph& g, Index index, Weight weight,
-                    multi_array_ref<double,1>& data,
-                    multi_array_ref<int32_t,1>& i,
-                    multi_array_ref<int32_t,1>& j) const
+                    sparse_matrix_out& out) const
     {
-        int pos = 0;
-        for (auto v: vertices_range(g))
-        {
-            auto k = sum_degree(g, v, weight);
-            for (const auto& e: out_edges_range(v, g))
-            {
-                data[pos] = double(weight[e]) / k;
-                j[pos] = get(index, source(e, g));
-                i[pos] = get(index, target(e, g));
-                ++pos;
-            }
-        }
+        std::vector<double> ks(num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 ks[v] = sum_degree(g, v, weight);
+             });
+
+        out.fill(g, index,
+                 [&](auto v) { return matrix_row_degree(g, v); },
+                 [&](auto v, auto&& put)
+                 {
+                     matrix_row_edges(g, v, false,
+                                      [&](const auto& e, auto u)
+                                      {
+                                          put(get(index, u),
+                                              double(get(weight, e)) / ks[u]);
+                                      });
+                 });
+    }
+};
+
+// Matrix-free product ret = T x, or ret = T^T x if transpose is true, for a
+// block of vectors given by the columns of x, with the rows indexed by index,
+// as in get_adjacency_matmat().
+struct get_transition_matmat
+{
+    template <class Graph, class Index, class Weight>
+    void operator()(const Graph& g, Index index, Weight weight,
+                    multi_array_ref<double,2>& x,
+                    multi_array_ref<double,2>& ret, bool transpose) const
+    {
+        size_t M = x.shape()[1];
+        std::vector<double> ks(num_vertices(g));
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 ks[v] = sum_degree(g, v, weight);
+             });
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto y = ret[get(index, v)];
+                 for (size_t l = 0; l < M; ++l)
+                     y[l] = 0;
+                 matrix_row_edges
+                     (g, v, transpose,
+                      [&](const auto& e, auto u)
+                      {
+                          // the column is always that of the source
+                          double w = double(get(weight, e)) /
+                              (transpose ? ks[v] : ks[u]);
+                          auto xu = x[get(index, u)];
+                          for (size_t l = 0; l < M; ++l)
+                              y[l] += w * xu[l];
+                      });
+             });
     }
 };
 
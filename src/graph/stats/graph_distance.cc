@@ -35,14 +35,14 @@ python::object distance_histogram(GraphInterface& gi, boost::any weight,
 
     if (weight.empty())
     {
-        run_action<>()(gi,
+        run_action<with_frozen<all_graph_views>>()(gi,
                        std::bind(get_distance_histogram(), std::placeholders::_1,
                                  gi.get_vertex_index(), no_weightS(),
                                  std::ref(bins), std::ref(ret)))();
     }
     else
     {
-        run_action<>()(gi,
+        run_action<with_frozen<all_graph_views>>()(gi,
                        std::bind(get_distance_histogram(), std::placeholders::_1,
                                  gi.get_vertex_index(), std::placeholders::_2,
                                  std::ref(bins), std::ref(ret)),
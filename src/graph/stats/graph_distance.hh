@@ -18,7 +18,6 @@
 #ifndef GRAPH_DISTANCE_HH
 #define GRAPH_DISTANCE_HH
 
-#include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
 #include <boost/python/object.hpp>
@@ -28,6 +27,7 @@
 #include "histogram.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "graph_parallel_bfs.hh"
 
 namespace graph_tool
 {
@@ -53,15 +53,13 @@ struct get_val_type<no_weightS>
 struct get_distance_histogram
 {
 
+    // weighted version: one Dijkstra search per vertex
     template <class Graph, class VertexIndex, class WeightMap>
     void operator()(const Graph& g, VertexIndex vertex_index, WeightMap weights,
                     const vector<long double>& obins, python::object& phist)
         const
     {
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
+        typedef get_dists_djk get_vertex_dists_t;
 
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
@@ -111,6 +109,45 @@ struct get_distance_histogram
         phist = ret;
     }
 
+    // unweighted version: the histogram is filled directly from a
+    // multi-source BFS, without storing the distances
+    template <class Graph, class VertexIndex>
+    void operator()(const Graph& g, VertexIndex, no_weightS,
+                    const vector<long double>& obins, python::object& phist)
+        const
+    {
+        typedef Histogram<size_t, size_t, 1> hist_t;
+
+        std::array<vector<size_t>,1> bins;
+        bins[0].resize(obins.size());
+        for (size_t i = 0; i < obins.size(); ++i)
+            bins[0][i] = obins[i];
+
+        hist_t hist(bins);
+        SharedHistogram<hist_t> s_hist(hist);
+
+        vector<size_t> sources;
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
+
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(s_hist)
+        parallel_multi_source_bfs_no_spawn
+            (g, sources,
+             [&](auto, auto, size_t d)
+             {
+                 typename hist_t::point_t point;
+                 point[0] = d;
+                 s_hist.put_value(point);
+             });
+        s_hist.gather();
+
+        python::list ret;
+        ret.append(wrap_multi_array_owned<size_t,1>(hist.get_array()));
+        ret.append(wrap_vector_owned<size_t>(hist.get_bins()[0]));
+        phist = ret;
+    }
+
     // weighted version. Use dijkstra_shortest_paths()
     struct get_dists_djk
     {
@@ -123,29 +160,6 @@ struct get_distance_histogram
                                     weight_map(weights).distance_map(dist_map));
         }
     };
-
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
-    {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
-        {
-            typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-            typedef gt_hash_map<vertex_t,default_color_type,
-                                DescriptorHash<VertexIndex> > cmap_t;
-            cmap_t cmap(0, DescriptorHash<VertexIndex>(vertex_index));
-            InitializedPropertyMap<cmap_t>
-                color_map(cmap, color_traits<default_color_type>::white());
-
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
-        }
-    };
 };
 
 } // boost namespace
@@ -59,7 +59,25 @@ python::object sampled_distance_histogram(GraphInterface& gi, boost::any weight,
     return ret;
 }
 
+python::object neighborhood_function(GraphInterface& gi, size_t log2m,
+                                     size_t max_dist, rng_t& rng)
+{
+    if (log2m < 4 || log2m > 16)
+        throw ValueException("the number of registers must be between 2^4 "
+                             "and 2^16");
+    uint64_t seed = (uint64_t(rng()) << 32) | rng();
+    vector<double> nf;
+    run_action<>()(gi,
+                   [&](auto& g)
+                   {
+                       get_neighborhood_function()(g, log2m, max_dist, seed,
+                                                   nf);
+                   })();
+    return wrap_vector_owned(nf);
+}
+
 void export_sampled_distance()
 {
     python::def("sampled_distance_histogram", &sampled_distance_histogram);
+    python::def("neighborhood_function", &neighborhood_function);
 }
@@ -18,8 +18,10 @@
 #ifndef GRAPH_DISTANCE_SAMPLED_HH
 #define GRAPH_DISTANCE_SAMPLED_HH
 
-#include <boost/graph/breadth_first_search.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
+#include <cmath>
+#include <cstring>
+
+#include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
 
 #include <boost/python/object.hpp>
 #include <boost/python/list.hpp>
@@ -28,6 +30,8 @@
 #include "histogram.hh"
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
+#include "graph_parallel_bfs.hh"
+#include "graph_parallel_traversal.hh"
 
 namespace graph_tool
 {
@@ -53,18 +57,14 @@ struct get_val_type<no_weightS>
 struct get_sampled_distance_histogram
 {
 
+    // weighted version: one Dijkstra search per sample, with a distance map
+    // per thread, of which only the reached vertices are visited and reset
     template <class Graph, class VertexIndex, class WeightMap, class RNG>
     void operator()(const Graph& g, VertexIndex vertex_index, WeightMap weights,
                     size_t n_samples, const vector<long double>& obins,
                     python::object& phist, RNG& rng) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-        // select get_vertex_dists based on the existence of weights
-        typedef typename mpl::if_<std::is_same<WeightMap, no_weightS>,
-                                  get_dists_bfs,
-                                  get_dists_djk>::type get_vertex_dists_t;
-
+        typedef get_dists_djk get_vertex_dists_t;
 
         // distance type
         typedef typename get_val_type<WeightMap>::type val_type;
@@ -78,46 +78,39 @@ struct get_sampled_distance_histogram
         hist_t hist(bins);
         SharedHistogram<hist_t> s_hist(hist);
 
-        vector<vertex_t> sources;
-        sources.reserve(num_vertices(g));
-        for (auto v : vertices_range(g))
-            sources.push_back(v);
-        n_samples = min(n_samples, sources.size());
-
-        typename hist_t::point_t point;
+        vector<size_t> samples = get_samples(g, n_samples, rng);
         get_vertex_dists_t get_vertex_dists;
 
-        #pragma omp parallel for default(shared) private(point) \
-            firstprivate(s_hist) schedule(runtime) \
-            if (num_vertices(g) * n_samples > OPENMP_MIN_THRESH)
-        for (size_t i = 0; i < n_samples; ++i)
+        #pragma omp parallel if (num_vertices(g) * samples.size() > \
+                                 OPENMP_MIN_THRESH) \
+            firstprivate(s_hist)
         {
-            vertex_t v;
-            #pragma omp critical
-            {
-                uniform_int_distribution<size_t> randint(0, sources.size()-1);
-                size_t j = randint(rng);
-                v = sources[j];
-                swap(sources[j], sources.back());
-                sources.pop_back();
-            }
-
             unchecked_vector_property_map<val_type,VertexIndex>
                 dist_map(vertex_index, num_vertices(g));
-
             for (auto u : vertices_range(g))
                 dist_map[u] = numeric_limits<val_type>::max();
+            vector<size_t> reached;
 
-            dist_map[v] = 0;
-            get_vertex_dists(g, v, vertex_index, dist_map, weights);
-
-            for (auto v2 : vertices_range(g))
+            typename hist_t::point_t point;
+            #pragma omp for schedule(runtime)
+            for (size_t i = 0; i < samples.size(); ++i)
             {
-                if (v2 != v && dist_map[v2] != numeric_limits<val_type>::max())
+                auto v = vertex(samples[i], g);
+                dist_map[v] = 0;
+                reached.clear();
+                get_vertex_dists(g, v, vertex_index, dist_map, weights,
+                                 reached);
+
+                for (auto u : reached)
                 {
-                    point[0] = dist_map[v2];
-                    s_hist.put_value(point);
+                    if (u != v)
+                    {
+                        point[0] = dist_map[u];
+                        s_hist.put_value(point);
+                    }
+                    dist_map[u] = numeric_limits<val_type>::max();
                 }
+                dist_map[v] = numeric_limits<val_type>::max();
             }
         }
         s_hist.gather();
@@ -128,42 +121,222 @@ struct get_sampled_distance_histogram
         phist = ret;
     }
 
-    // weighted version. Use dijkstra_shortest_paths()
+    // unweighted version: the samples are drawn in advance, and the
+    // histogram is filled directly from a multi-source BFS
+    template <class Graph, class VertexIndex, class RNG>
+    void operator()(const Graph& g, VertexIndex, no_weightS,
+                    size_t n_samples, const vector<long double>& obins,
+                    python::object& phist, RNG& rng) const
+    {
+        typedef Histogram<size_t, size_t, 1> hist_t;
+
+        std::array<vector<size_t>,1> bins;
+        bins[0].resize(obins.size());
+        for (size_t i = 0; i < obins.size(); ++i)
+            bins[0][i] = obins[i];
+
+        hist_t hist(bins);
+        SharedHistogram<hist_t> s_hist(hist);
+
+        vector<size_t> samples = get_samples(g, n_samples, rng);
+
+        #pragma omp parallel if (num_vertices(g) * samples.size() > OPENMP_MIN_THRESH) \
+            firstprivate(s_hist)
+        parallel_multi_source_bfs_no_spawn
+            (g, samples,
+             [&](auto, auto, size_t d)
+             {
+                 typename hist_t::point_t point;
+                 point[0] = d;
+                 s_hist.put_value(point);
+             });
+        s_hist.gather();
+
+        python::list ret;
+        ret.append(wrap_multi_array_owned<size_t,1>(hist.get_array()));
+        ret.append(wrap_vector_owned<size_t>(hist.get_bins()[0]));
+        phist = ret;
+    }
+
+    // The source vertices, sampled without replacement. They are drawn in
+    // advance and in sequence, so that the same samples are obtained
+    // independently of the number of threads.
+    template <class Graph, class RNG>
+    static vector<size_t> get_samples(const Graph& g, size_t n_samples,
+                                      RNG& rng)
+    {
+        vector<size_t> sources;
+        sources.reserve(num_vertices(g));
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
+        n_samples = min(n_samples, sources.size());
+
+        vector<size_t> samples;
+        samples.reserve(n_samples);
+        for (size_t i = 0; i < n_samples; ++i)
+        {
+            uniform_int_distribution<size_t> randint(0, sources.size()-1);
+            size_t j = randint(rng);
+            samples.push_back(sources[j]);
+            swap(sources[j], sources.back());
+            sources.pop_back();
+        }
+        return samples;
+    }
+
+    class djk_reached_visitor: public boost::dijkstra_visitor<>
+    {
+    public:
+        djk_reached_visitor(vector<size_t>& reached)
+            : _reached(reached) { }
+
+        template <class Vertex, class Graph>
+        void discover_vertex(Vertex v, const Graph&)
+        {
+            _reached.push_back(v);
+        }
+
+    private:
+        vector<size_t>& _reached;
+    };
+
+    // weighted version. Use dijkstra_shortest_paths_no_color_map_no_init(),
+    // with the distances of all vertices but the source already set to
+    // infinity, and put the reached vertices (including the source) in
+    // reached
     struct get_dists_djk
     {
         template <class Graph, class Vertex, class VertexIndex,
                   class DistanceMap, class WeightMap>
         void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, WeightMap weights) const
+                        DistanceMap dist_map, WeightMap weights,
+                        vector<size_t>& reached) const
         {
-            dijkstra_shortest_paths(g, s, vertex_index_map(vertex_index).
-                                    weight_map(weights).distance_map(dist_map));
+            typedef typename property_traits<DistanceMap>::value_type dist_t;
+            djk_reached_visitor vis(reached);
+            dist_t inf = numeric_limits<dist_t>::max();
+            dijkstra_shortest_paths_no_color_map_no_init
+                (g, s, dummy_property_map(), dist_map, weights, vertex_index,
+                 std::less<dist_t>(), closed_plus<dist_t>(inf), inf, dist_t(0),
+                 vis);
         }
     };
+};
 
-    // unweighted version. Use BFS.
-    struct get_dists_bfs
+// Approximate neighborhood function of an unweighted graph, with HyperANF (P.
+// Boldi, M. Rosa and S. Vigna, "HyperANF: approximating the neighbourhood
+// function of very large graphs on a budget", WWW '11). Every vertex v keeps a
+// HyperLogLog counter with m = 2^log2m registers of the set of vertices at
+// distance at most t from it, which for t + 1 is obtained as the union of the
+// counters of v and of its out-neighbors, i.e. the register-wise maximum. In
+// nf[t] is put the estimated number of pairs (v, u), including v == u, with u
+// at distance at most t from v, until the counters no longer change, or
+// t == max_dist. The relative standard deviation of each count is about
+// 1.04/sqrt(m).
+//
+// The counters are stored contiguously, with 2 * m * N bytes for the current
+// and next iterations, and every iteration is a parallel pass over the
+// vertices and their out-edges, with the register maxima over contiguous
+// bytes, which are vectorized by the compiler.
+struct get_neighborhood_function
+{
+    template <class Graph>
+    void operator()(const Graph& g, size_t log2m, size_t max_dist,
+                    uint64_t seed, vector<double>& nf) const
     {
-        template <class Graph, class Vertex, class VertexIndex,
-                  class DistanceMap>
-        void operator()(const Graph& g, Vertex s, VertexIndex vertex_index,
-                        DistanceMap dist_map, no_weightS) const
+        size_t N = num_vertices(g);
+        size_t m = size_t(1) << log2m;
+
+        vector<uint8_t> c(N * m, 0), nc(N * m, 0);
+
+        // the counter of each vertex starts with the vertex itself
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 uint64_t h = random_priority(seed, v);
+                 size_t j = h >> (64 - log2m);
+                 uint64_t w = (h << log2m) | (uint64_t(1) << (log2m - 1));
+                 c[v * m + j] = __builtin_clzll(w) + 1;
+             });
+
+        nf.clear();
+        nf.push_back(get_total(g, c, m));
+
+        for (size_t t = 1; t <= max_dist; ++t)
         {
-            typedef typename vprop_map_t<default_color_type>::type::unchecked_t vmap_t;
-            vmap_t color_map(vertex_index, num_vertices(g));
-            parallel_vertex_loop
+            bool changed = false;
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH) \
+                reduction(||:changed)
+            parallel_vertex_loop_no_spawn
                 (g,
                  [&](auto v)
                  {
-                     color_map[v] = color_traits<default_color_type>::white();
+                     uint8_t* x = &nc[v * m];
+                     const uint8_t* y = &c[v * m];
+                     memcpy(x, y, m);
+                     for (auto u : out_neighbors_range(v, g))
+                     {
+                         const uint8_t* z = &c[u * m];
+                         for (size_t j = 0; j < m; ++j)
+                             x[j] = std::max(x[j], z[j]);
+                     }
+                     if (memcmp(x, y, m) != 0)
+                         changed = true;
                  });
-            breadth_first_visit(g, s,
-                                visitor(make_bfs_visitor
-                                        (record_distances(dist_map,
-                                                          on_tree_edge()))).
-                                color_map(color_map));
+
+            if (!changed)
+                break;
+            c.swap(nc);
+            nf.push_back(get_total(g, c, m));
         }
-    };
+    }
+
+    // sum of the HyperLogLog estimates of all counters
+    template <class Graph>
+    static double get_total(const Graph& g, const vector<uint8_t>& c,
+                            size_t m)
+    {
+        double alpha;
+        switch (m)
+        {
+        case 16:
+            alpha = 0.673;
+            break;
+        case 32:
+            alpha = 0.697;
+            break;
+        case 64:
+            alpha = 0.709;
+            break;
+        default:
+            alpha = 0.7213 / (1 + 1.079 / m);
+        }
+
+        double total = 0;
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            reduction(+:total)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 const uint8_t* x = &c[v * m];
+                 double S = 0;
+                 size_t zeros = 0;
+                 for (size_t j = 0; j < m; ++j)
+                 {
+                     S += std::ldexp(1., -int(x[j]));
+                     zeros += (x[j] == 0);
+                 }
+                 double E = alpha * m * m / S;
+
+                 // small range correction, with linear counting
+                 if (E <= 2.5 * m && zeros > 0)
+                     E = m * std::log(double(m) / zeros);
+                 total += E;
+             });
+        return total;
+    }
 };
 
 } // boost namespace
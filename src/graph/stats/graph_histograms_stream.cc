@@ -0,0 +1,347 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_io_stream.hh"
+#include "histogram.hh"
+#include "numpy_bind.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+// Histogram which persists across calls, so that the counts of several
+// graphs, or graph files read as a stream, can be accumulated into it.
+template <size_t Dim>
+class HistogramAccumulator
+{
+public:
+    typedef Histogram<double, size_t, Dim> hist_t;
+
+    HistogramAccumulator(python::list obins)
+        : _hist(get_bins(obins)) {}
+
+    void put_value(const typename hist_t::point_t& x)
+    {
+        _hist.put_value(x);
+    }
+
+    // Adds the counts of a histogram previously computed with compatible
+    // bins, with each bin given by its lower edges.
+    void put_counts(python::object ocounts, python::list obins)
+    {
+        auto counts = get_array<uint64_t, Dim>(ocounts);
+        std::array<vector<double>, Dim> bins = get_bins(obins);
+        std::array<size_t, Dim> idx;
+        idx.fill(0);
+        typename hist_t::point_t x;
+        for (size_t i = 0; i < counts.num_elements(); ++i)
+        {
+            if (counts(idx) > 0)
+            {
+                for (size_t j = 0; j < Dim; ++j)
+                    x[j] = bins[j][idx[j]];
+                _hist.put_value(x, counts(idx));
+            }
+            for (int j = int(Dim) - 1; j >= 0; --j)
+            {
+                if (++idx[j] < counts.shape()[j])
+                    break;
+                idx[j] = 0;
+            }
+        }
+    }
+
+    python::object get_counts()
+    {
+        return wrap_multi_array_owned(_hist.get_array());
+    }
+
+    python::list get_bin_list()
+    {
+        python::list obins;
+        for (auto& b : _hist.get_bins())
+            obins.append(wrap_vector_owned(b));
+        return obins;
+    }
+
+private:
+    static std::array<vector<double>, Dim> get_bins(python::list obins)
+    {
+        if (python::len(obins) != int(Dim))
+            throw ValueException("invalid number of bin lists");
+        std::array<vector<double>, Dim> bins;
+        for (size_t j = 0; j < Dim; ++j)
+        {
+            auto b = get_array<double, 1>(obins[j]);
+            bins[j].assign(b.begin(), b.end());
+        }
+        return bins;
+    }
+
+    hist_t _hist;
+};
+
+// Obtains, with visit_graph(), the value for every vertex of a degree type
+// ("in", "out" or "total"), or of a scalar vertex property with the given
+// name. As for the graph itself, undirected graphs have in-degree zero.
+class gt_vertex_values
+    : public gt_stream_visitor
+{
+public:
+    gt_vertex_values(const string& deg)
+        : _deg(deg), _degree(deg == "in" || deg == "out" || deg == "total") {}
+
+    void init(bool directed, size_t N) override
+    {
+        _x.clear();
+        _x.resize(N, 0);
+        _pos = 0;
+        _found = false;
+        if (directed)
+        {
+            _out = _deg != "in";
+            _in = _deg != "out";
+        }
+        else
+        {
+            _out = _in = _deg != "in";
+        }
+    }
+
+    void edge(size_t v, size_t u) override
+    {
+        if (!_degree)
+            return;
+        if (_out)
+            _x[v]++;
+        if (_in)
+            _x[u]++;
+    }
+
+    bool property(property_type t, const string& name) override
+    {
+        if (_degree || _found || t != property_type::Vertex || name != _deg)
+            return false;
+        _found = true;
+        return true;
+    }
+
+    void value(double x) override
+    {
+        _x[_pos++] = x;
+    }
+
+    // whether the value is a property, and not a degree
+    bool is_property() const { return !_degree; }
+
+    vector<double>& get_values()
+    {
+        if (!_degree && !_found)
+            throw ValueException("vertex property '" + _deg +
+                                 "' not found in file");
+        return _x;
+    }
+
+private:
+    string _deg;
+    bool _degree;
+    bool _out = false, _in = false;
+    bool _found = false;
+    size_t _pos = 0;
+    vector<double> _x;
+};
+
+// Puts the values of the edge property with the given name in the histogram.
+class gt_edge_values
+    : public gt_stream_visitor
+{
+public:
+    gt_edge_values(const string& name, HistogramAccumulator<1>& hist)
+        : _name(name), _hist(hist) {}
+
+    void init(bool, size_t) override {}
+    void edge(size_t, size_t) override {}
+
+    bool property(property_type t, const string& name) override
+    {
+        if (_found || t != property_type::Edge || name != _name)
+            return false;
+        _found = true;
+        return true;
+    }
+
+    void value(double x) override
+    {
+        _x[0] = x;
+        _hist.put_value(_x);
+    }
+
+    bool found() const { return _found; }
+
+private:
+    string _name;
+    HistogramAccumulator<1>& _hist;
+    bool _found = false;
+    std::array<double, 1> _x;
+};
+
+// Obtains the values of both ends of the edges at once.
+class gt_vertex_value_pair
+    : public gt_stream_visitor
+{
+public:
+    gt_vertex_value_pair(gt_vertex_values& source, gt_vertex_values& target)
+        : _source(source), _target(target) {}
+
+    void init(bool directed, size_t N) override
+    {
+        _source.init(directed, N);
+        _target.init(directed, N);
+    }
+
+    void edge(size_t v, size_t u) override
+    {
+        _source.edge(v, u);
+        _target.edge(v, u);
+    }
+
+    bool property(property_type t, const string& name) override
+    {
+        _vs = _source.property(t, name);
+        _vt = _target.property(t, name);
+        return _vs || _vt;
+    }
+
+    void value(double x) override
+    {
+        if (_vs)
+            _source.value(x);
+        if (_vt)
+            _target.value(x);
+    }
+
+private:
+    gt_vertex_values& _source;
+    gt_vertex_values& _target;
+    bool _vs = false, _vt = false;
+};
+
+// Puts the values of the source and target of every edge in the histogram, in
+// both directions if the graph is undirected.
+class gt_edge_value_pairs
+    : public gt_stream_visitor
+{
+public:
+    gt_edge_value_pairs(const vector<double>& xs, const vector<double>& xt,
+                        HistogramAccumulator<2>& hist)
+        : _xs(xs), _xt(xt), _hist(hist) {}
+
+    void init(bool directed, size_t N) override
+    {
+        if (N != _xs.size())
+            throw IOException("error reading graph: file changed between passes");
+        _directed = directed;
+    }
+
+    void edge(size_t v, size_t u) override
+    {
+        _hist.put_value({{_xs[v], _xt[u]}});
+        if (!_directed)
+            _hist.put_value({{_xs[u], _xt[v]}});
+    }
+
+    bool property(property_type, const string&) override { return false; }
+    void value(double) override {}
+
+private:
+    const vector<double>& _xs;
+    const vector<double>& _xt;
+    HistogramAccumulator<2>& _hist;
+    bool _directed = true;
+};
+
+// The properties in the file are only read if they are needed, i.e. if the
+// values are not degrees.
+
+void stream_vertex_histogram(HistogramAccumulator<1>& hist, string file,
+                             python::object pfile, string deg)
+{
+    gt_vertex_values x(deg);
+    stream_gt_file(file, pfile, x, x.is_property());
+    std::array<double, 1> p;
+    for (auto v : x.get_values())
+    {
+        p[0] = v;
+        hist.put_value(p);
+    }
+}
+
+void stream_edge_histogram(HistogramAccumulator<1>& hist, string file,
+                           python::object pfile, string eprop)
+{
+    gt_edge_values x(eprop, hist);
+    stream_gt_file(file, pfile, x, true);
+    if (!x.found())
+        throw ValueException("edge property '" + eprop + "' not found in file");
+}
+
+// This needs two passes over the adjacency: one to obtain the values of the
+// vertices, and another for the edges. A python file object is rewound with
+// seek() for the second one.
+void stream_corr_histogram(HistogramAccumulator<2>& hist, string file,
+                           python::object pfile, string deg_source,
+                           string deg_target)
+{
+    if (file == "-")
+        throw ValueException("correlation histograms cannot be obtained from "
+                             "the standard input");
+    python::object start;
+    if (pfile != python::object())
+        start = pfile.attr("tell")();
+
+    gt_vertex_values xs(deg_source), xt(deg_target);
+    gt_vertex_value_pair x(xs, xt);
+    stream_gt_file(file, pfile, x, xs.is_property() || xt.is_property());
+
+    if (pfile != python::object())
+        pfile.attr("seek")(start);
+
+    gt_edge_value_pairs y(xs.get_values(), xt.get_values(), hist);
+    stream_gt_file(file, pfile, y, false);
+}
+
+void export_histograms_stream()
+{
+    using namespace boost::python;
+
+    class_<HistogramAccumulator<1>>("HistogramAccumulator1", init<python::list>())
+        .def("put_counts", &HistogramAccumulator<1>::put_counts)
+        .def("get_counts", &HistogramAccumulator<1>::get_counts)
+        .def("get_bins", &HistogramAccumulator<1>::get_bin_list);
+    class_<HistogramAccumulator<2>>("HistogramAccumulator2", init<python::list>())
+        .def("put_counts", &HistogramAccumulator<2>::put_counts)
+        .def("get_counts", &HistogramAccumulator<2>::get_counts)
+        .def("get_bins", &HistogramAccumulator<2>::get_bin_list);
+
+    def("stream_vertex_histogram", &stream_vertex_histogram);
+    def("stream_edge_histogram", &stream_edge_histogram);
+    def("stream_corr_histogram", &stream_corr_histogram);
+}
@@ -53,6 +53,11 @@ void do_remove_labeled_edges(GraphInterface& gi, boost::any property)
          edge_scalar_properties())(property);
 }
 
+void do_remove_parallel_edges(GraphInterface& gi)
+{
+    run_action<>()(gi, [&](auto& g) { remove_parallel_edges()(g); })();
+}
+
 using namespace boost::python;
 
 void export_parallel()
@@ -60,4 +65,5 @@ void export_parallel()
     def("label_parallel_edges", &do_label_parallel_edges);
     def("label_self_loops", &do_label_self_loops);
     def("remove_labeled_edges", &do_remove_labeled_edges);
+    def("remove_parallel_edges", &do_remove_parallel_edges);
 }
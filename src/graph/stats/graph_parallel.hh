@@ -18,7 +18,9 @@
 #ifndef GRAPH_PARALLEL_HH
 #define GRAPH_PARALLEL_HH
 
-#include "hash_map_wrap.hh"
+#include <algorithm>
+#include <limits>
+
 #include "graph_util.hh"
 
 namespace graph_tool
@@ -26,57 +28,96 @@ namespace graph_tool
 using namespace std;
 using namespace boost;
 
+// Finds the edges of a vertex which are parallel to a previous one, i.e. whose
+// target was already seen. The edge last seen for each target is stored in a
+// marker array indexed by vertex, which is reset only at the entries which
+// were touched, so that each vertex takes O(k) time without any allocation.
+// Each thread needs its own copy.
+template <class Graph>
+class parallel_edge_marker
+{
+public:
+    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+
+    parallel_edge_marker(const Graph& g)
+        : _pos(num_vertices(g), numeric_limits<size_t>::max()) {}
+
+    // Calls f(e, prev) for every out-edge e of v parallel to a previous edge
+    // prev, which is the last one found with the same target. In undirected
+    // graphs, only edges to targets u >= v are visited, and each self-loop
+    // (which appears twice in the list) only once.
+    template <class F>
+    void operator()(vertex_t v, const Graph& g, F&& f)
+    {
+        auto eidx = get(edge_index_t(), g);
+        for (auto e : out_edges_range(v, g))
+        {
+            vertex_t u = target(e, g);
+
+            // do not visit edges twice in undirected graphs
+            if (!graph_tool::is_directed(g))
+            {
+                if (u < v)
+                    continue;
+                if (u == v)
+                {
+                    // the number of self-loops of a vertex is usually very
+                    // small, so a linear search suffices
+                    size_t idx = eidx[e];
+                    if (std::find(_self_loops.begin(), _self_loops.end(),
+                                  idx) != _self_loops.end())
+                        continue;
+                    _self_loops.push_back(idx);
+                }
+            }
+
+            size_t& pos = _pos[u];
+            if (pos == numeric_limits<size_t>::max())
+            {
+                pos = _last.size();
+                _last.push_back(e);
+            }
+            else
+            {
+                f(e, _last[pos]);
+                _last[pos] = e;
+            }
+        }
+
+        for (auto& e : _last)
+            _pos[target(e, g)] = numeric_limits<size_t>::max();
+        _last.clear();
+        _self_loops.clear();
+    }
+
+private:
+    vector<size_t> _pos;
+    vector<edge_t> _last;
+    vector<size_t> _self_loops;
+};
+
 // label parallel edges in the order they are found, starting from 1
 struct label_parallel_edges
 {
     template <class Graph, class ParallelMap>
     void operator()(const Graph& g, ParallelMap parallel, bool mark_only) const
     {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
-        typename property_map<Graph, edge_index_t>::type eidx = get(edge_index, g);
-
-        parallel_vertex_loop
+        parallel_edge_marker<Graph> marker(g);
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(marker)
+        parallel_vertex_loop_no_spawn
             (g,
              [&](auto v)
              {
-                 gt_hash_map<vertex_t, edge_t> vset;
-                 gt_hash_map<size_t, bool> self_loops;
-
-                 typename graph_traits<Graph>::out_edge_iterator e, e_end;
-                 for (tie(e, e_end) = out_edges(v, g); e != e_end; ++e)
-                 {
-                     vertex_t u = target(*e, g);
-
-                     // do not visit edges twice in undirected graphs
-                     if (!graph_tool::is_directed(g) && u < v)
-                         continue;
-
-                     if (u == v)
-                     {
-                         if (self_loops[eidx[*e]])
-                             continue;
-                         self_loops[eidx[*e]] = true;
-                     }
-
-                     auto iter = vset.find(u);
-                     if (iter == vset.end())
-                     {
-                         vset[u] = *e;
-                     }
-                     else
-                     {
-                         if (mark_only)
-                         {
-                             parallel[*e] = true;
-                         }
-                         else
-                         {
-                             parallel[*e] = parallel[iter->second] + 1;
-                             vset[u] = *e;
-                         }
-                     }
-                 }
+                 marker(v, g,
+                        [&](const auto& e, const auto& prev)
+                        {
+                            if (mark_only)
+                                parallel[e] = true;
+                            else
+                                parallel[e] = parallel[prev] + 1;
+                        });
              });
     }
 };
@@ -124,6 +165,30 @@ struct remove_labeled_edges
     }
 };
 
+// remove all parallel edges, keeping only the first one found of each set, in
+// the same pass which finds them
+struct remove_parallel_edges
+{
+    template <class Graph>
+    void operator()(Graph& g) const
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        parallel_edge_marker<Graph> marker(g);
+        vector<edge_t> r_edges;
+        for (auto v : vertices_range(g))
+        {
+            marker(v, g,
+                   [&](const auto& e, const auto&)
+                   {
+                       r_edges.push_back(e);
+                   });
+            for (auto& e : r_edges)
+                remove_edge(e, g);
+            r_edges.clear();
+        }
+    }
+};
+
 } // graph_tool namespace
 
 #endif //GRAPH_PARALLEL_HH
@@ -0,0 +1,104 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+
+#include "graph_profile.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+unsigned get_profile_stat(const string& name)
+{
+    if (name == "vertex_hist")
+        return get_profile::VERTEX_HIST;
+    if (name == "vertex_average")
+        return get_profile::VERTEX_AVERAGE;
+    if (name == "edge_average")
+        return get_profile::EDGE_AVERAGE;
+    if (name == "assortativity")
+        return get_profile::ASSORTATIVITY;
+    if (name == "scalar_assortativity")
+        return get_profile::SCALAR_ASSORTATIVITY;
+    if (name == "combined_corr")
+        return get_profile::COMBINED_CORR;
+    if (name == "self_loops")
+        return get_profile::SELF_LOOPS;
+    throw ValueException("invalid statistic: " + name);
+}
+
+python::dict
+get_graph_profile(GraphInterface& gi, GraphInterface::deg_t deg,
+                  python::list ostats, boost::any eprop,
+                  GraphInterface::deg_t deg2, string jackknife,
+                  const vector<long double>& bins)
+{
+    unsigned stats = 0;
+    for (int i = 0; i < python::len(ostats); ++i)
+        stats |= get_profile_stat(python::extract<string>(ostats[i]));
+
+    get_profile::edge_value_t eval;
+    if (stats & get_profile::EDGE_AVERAGE)
+    {
+        if (eprop.empty())
+            throw ValueException("an edge property is required for the "
+                                 "edge average");
+        try
+        {
+            eval = get_profile::edge_value_t(eprop, edge_scalar_properties());
+        }
+        catch (bad_lexical_cast&)
+        {
+            throw ValueException("edge property must be of scalar type");
+        }
+    }
+
+    profile_vertex_value val2;
+    if (stats & get_profile::COMBINED_CORR)
+    {
+        try
+        {
+            val2 = profile_vertex_value(deg2);
+        }
+        catch (bad_lexical_cast&)
+        {
+            throw ValueException("vertex property must be of scalar type");
+        }
+    }
+
+    python::dict ret;
+    run_action<>()(gi, std::bind(get_profile(stats, get_jackknife(jackknife),
+                                             bins, ret),
+                                 std::placeholders::_1, std::placeholders::_2,
+                                 eval, std::ref(val2)),
+                   scalar_selectors())
+        (degree_selector(deg));
+    return ret;
+}
+
+using namespace boost::python;
+
+void export_profile()
+{
+    def("get_graph_profile", &get_graph_profile);
+}
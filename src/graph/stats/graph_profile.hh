@@ -0,0 +1,327 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PROFILE_HH
+#define GRAPH_PROFILE_HH
+
+#include <boost/python/dict.hpp>
+#include <boost/python/tuple.hpp>
+
+#include "graph_selectors.hh"
+#include "graph_properties.hh"
+#include "histogram.hh"
+#include "numpy_bind.hh"
+#include "shared_map.hh"
+#include "../correlations/graph_correlations.hh"
+#include "../correlations/graph_assortativity.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// A vertex value which is either a degree or any scalar vertex property,
+// converted to long double. The type is not dispatched, since the value is
+// secondary, i.e. only needed once per vertex.
+class profile_vertex_value
+{
+public:
+    typedef DynamicPropertyMapWrap<long double, GraphInterface::vertex_t>
+        wrapped_t;
+
+    profile_vertex_value() {}
+
+    profile_vertex_value(GraphInterface::deg_t deg)
+    {
+        auto d = boost::get<GraphInterface::degree_t>(&deg);
+        if (d != nullptr)
+        {
+            _degree = true;
+            _deg = *d;
+        }
+        else
+        {
+            _prop = wrapped_t(boost::get<boost::any>(deg),
+                              vertex_scalar_properties());
+        }
+    }
+
+    template <class Graph>
+    long double operator()(typename graph_traits<Graph>::vertex_descriptor v,
+                           const Graph& g) const
+    {
+        if (!_degree)
+            return _prop.get(v);
+        switch (_deg)
+        {
+        case GraphInterface::IN_DEGREE:
+            return in_degreeS()(v, g);
+        case GraphInterface::OUT_DEGREE:
+            return out_degreeS()(v, g);
+        default:
+            return total_degreeS()(v, g);
+        }
+    }
+
+private:
+    bool _degree = false;
+    GraphInterface::degree_t _deg = GraphInterface::TOTAL_DEGREE;
+    wrapped_t _prop;
+};
+
+// Computes several statistics of the (scalar) vertex values given by 'deg' in
+// a single parallel pass over the vertices and their out-edges, with thread
+// local accumulators. The results are put in the dictionary, with the same
+// contents as returned by the corresponding individual functions (see the
+// python module).
+struct get_profile
+{
+    enum stat_t : unsigned
+    {
+        VERTEX_HIST = 1 << 0,          // histogram of deg
+        VERTEX_AVERAGE = 1 << 1,       // average of deg
+        EDGE_AVERAGE = 1 << 2,         // average of eprop
+        ASSORTATIVITY = 1 << 3,        // assortativity of deg
+        SCALAR_ASSORTATIVITY = 1 << 4, // scalar assortativity of deg
+        COMBINED_CORR = 1 << 5,        // average of deg2 as a function of deg
+        SELF_LOOPS = 1 << 6            // number of self-loops
+    };
+
+    typedef DynamicPropertyMapWrap<long double, GraphInterface::edge_t>
+        edge_value_t;
+
+    get_profile(unsigned stats, jackknife_t jk,
+                const vector<long double>& bins, python::dict& ret)
+        : _stats(stats), _jk(jk), _bins(bins), _ret(ret) {}
+
+    template <class Graph, class DegreeSelector>
+    void operator()(const Graph& g, DegreeSelector deg, edge_value_t eprop,
+                    profile_vertex_value& deg2) const
+    {
+        typedef typename DegreeSelector::value_type val_t;
+        typedef Histogram<val_t, size_t, 1> count_t;
+        typedef Histogram<val_t, long double, 1> sum_t;
+
+        unsigned stats = _stats;
+        bool directed = graph_tool::is_directed(g);
+        bool assort = stats & (ASSORTATIVITY | SCALAR_ASSORTATIVITY);
+        bool need_edges =
+            assort || (stats & (EDGE_AVERAGE | SELF_LOOPS));
+
+        std::array<vector<val_t>, 1> bins;
+        if (stats & (VERTEX_HIST | COMBINED_CORR))
+            clean_bins(_bins, bins[0]);
+        else
+            bins[0] = {val_t(0), val_t(1)};
+
+        count_t hist(bins), count(bins);
+        sum_t sum(bins), sum2(bins);
+        SharedHistogram<count_t> s_hist(hist), s_count(count);
+        SharedHistogram<sum_t> s_sum(sum), s_sum2(sum2);
+
+        // vertex and edge averages, with the self-loops of undirected graphs
+        // kept apart, since they are seen twice
+        long double v_a = 0, v_aa = 0, e_a = 0, e_aa = 0, l_a = 0, l_aa = 0;
+        size_t v_count = 0, e_count = 0, l_count = 0;
+
+        // assortativity coefficients
+        typedef gt_hash_map<val_t, size_t> map_t;
+        map_t a, b;
+        value_pairs_t<val_t> pairs;
+        SharedMap<map_t> sa(a), sb(b);
+        SharedMap<value_pairs_t<val_t>> spairs(pairs);
+        bool count_pairs = assort && (_jk == jackknife_t::pairs);
+        size_t n_edges = 0, e_kk = 0;
+        double e_xy = 0, s_a = 0, s_b = 0, s_da = 0, s_db = 0;
+
+        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
+            firstprivate(s_hist, s_count, s_sum, s_sum2, sa, sb, spairs) \
+            reduction(+:v_a, v_aa, e_a, e_aa, l_a, l_aa, v_count, e_count, \
+                      l_count, n_edges, e_kk, e_xy, s_a, s_b, s_da, s_db)
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 val_t k1 = deg(v, g);
+                 typename count_t::point_t p;
+                 p[0] = k1;
+
+                 if (stats & VERTEX_HIST)
+                     s_hist.put_value(p);
+                 if (stats & VERTEX_AVERAGE)
+                 {
+                     v_a += k1;
+                     v_aa += k1 * k1;
+                     v_count++;
+                 }
+                 if (stats & COMBINED_CORR)
+                 {
+                     long double k2 = deg2(v, g);
+                     s_sum.put_value(p, k2);
+                     s_sum2.put_value(p, k2 * k2);
+                     s_count.put_value(p);
+                 }
+
+                 if (!need_edges)
+                     return;
+
+                 for (auto e : out_edges_range(v, g))
+                 {
+                     auto u = target(e, g);
+
+                     if (stats & (EDGE_AVERAGE | SELF_LOOPS))
+                     {
+                         // every edge is counted once, as in the directed
+                         // view used by edge_average()
+                         long double x = 0;
+                         if (stats & EDGE_AVERAGE)
+                             x = eprop.get(e);
+                         if (u == v && !directed)
+                         {
+                             l_a += x;
+                             l_aa += x * x;
+                             l_count++;
+                         }
+                         else if (directed || u > v)
+                         {
+                             e_a += x;
+                             e_aa += x * x;
+                             e_count++;
+                             if (u == v)
+                                 l_count++;
+                         }
+                     }
+
+                     if (!assort)
+                         continue;
+
+                     val_t k2 = deg(u, g);
+                     if (stats & ASSORTATIVITY)
+                     {
+                         if (k1 == k2)
+                             e_kk++;
+                         sa[k1]++;
+                         sb[k2]++;
+                     }
+                     if (stats & SCALAR_ASSORTATIVITY)
+                     {
+                         s_a += k1;
+                         s_da += k1 * k1;
+                         s_b += k2;
+                         s_db += k2 * k2;
+                         e_xy += k1 * k2;
+                     }
+                     if (count_pairs)
+                         spairs[make_pair(k1, k2)]++;
+                     n_edges++;
+                 }
+             });
+
+        s_hist.gather();
+        s_count.gather();
+        s_sum.gather();
+        s_sum2.gather();
+        sa.Gather();
+        sb.Gather();
+        spairs.Gather();
+
+        // the self-loops of undirected graphs were seen from both ends
+        if (!directed)
+        {
+            l_a /= 2;
+            l_aa /= 2;
+            l_count /= 2;
+        }
+
+        if (stats & VERTEX_HIST)
+        {
+            _ret["vertex_hist"] =
+                python::make_tuple(wrap_multi_array_owned(hist.get_array()),
+                                   wrap_vector_owned(hist.get_bins()[0]));
+        }
+
+        if (stats & VERTEX_AVERAGE)
+            _ret["vertex_average"] = python::make_tuple(v_a, v_aa, v_count);
+
+        if (stats & EDGE_AVERAGE)
+        {
+            size_t n_loops = directed ? 0 : l_count;
+            _ret["edge_average"] = python::make_tuple(e_a + l_a, e_aa + l_aa,
+                                                      e_count + n_loops);
+        }
+
+        if (stats & SELF_LOOPS)
+            _ret["self_loops"] = l_count;
+
+        if (stats & ASSORTATIVITY)
+        {
+            double t2 = 0;
+            for (auto& ai : a)
+            {
+                auto bi = b.find(ai.first);
+                if (bi != b.end())
+                    t2 += ai.second * bi->second;
+            }
+            auto lookup = [](const map_t& m, const val_t& k) -> size_t
+                {
+                    auto iter = m.find(k);
+                    return (iter != m.end()) ? iter->second : 0;
+                };
+            double r, r_err;
+            get_assortativity_coefficient()
+                .get_coefficient(g, deg, _jk, e_kk, n_edges, t2,
+                                 [&](const val_t& k) { return lookup(a, k); },
+                                 [&](const val_t& k) { return lookup(b, k); },
+                                 pairs, r, r_err);
+            _ret["assortativity"] = python::make_tuple(r, r_err);
+        }
+
+        if (stats & SCALAR_ASSORTATIVITY)
+        {
+            double r, r_err;
+            get_scalar_assortativity_coefficient()
+                .get_coefficient(g, deg, _jk, n_edges, e_xy, s_a, s_b, s_da,
+                                 s_db, pairs, r, r_err);
+            _ret["scalar_assortativity"] = python::make_tuple(r, r_err);
+        }
+
+        if (stats & COMBINED_CORR)
+        {
+            auto& s = sum.get_array();
+            auto& s2 = sum2.get_array();
+            auto& c = count.get_array();
+            for (size_t i = 0; i < s.size(); ++i)
+            {
+                s[i] /= c[i];
+                s2[i] = sqrt(abs(s2[i] / c[i] - s[i] * s[i])) / sqrt(c[i]);
+            }
+            _ret["combined_corr"] =
+                python::make_tuple(wrap_multi_array_owned(s),
+                                   wrap_multi_array_owned(s2),
+                                   wrap_vector_owned(sum.get_bins()[0]));
+        }
+    }
+
+    unsigned _stats;
+    jackknife_t _jk;
+    const vector<long double>& _bins;
+    python::dict& _ret;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_PROFILE_HH
@@ -21,7 +21,9 @@ using namespace boost;
 
 void export_parallel();
 void export_histograms();
+void export_histograms_stream();
 void export_average();
+void export_profile();
 void export_distance();
 void export_sampled_distance();
 
@@ -29,7 +31,9 @@ BOOST_PYTHON_MODULE(libgraph_tool_stats)
 {
     export_parallel();
     export_histograms();
+    export_histograms_stream();
     export_average();
+    export_profile();
     export_distance();
     export_sampled_distance();
 }
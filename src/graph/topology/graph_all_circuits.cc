@@ -15,33 +15,17 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
-#include <boost/graph/hawick_circuits.hpp>
-
 #include "graph_tool.hh"
 #include "numpy_bind.hh"
 #include "coroutine.hh"
 #include "graph_python_interface.hh"
+#include "graph_all_circuits.hh"
 
 using namespace std;
 using namespace graph_tool;
 
-template <class Yield>
-struct CircuitVisitor
-{
-    CircuitVisitor(Yield& yield)
-        : _yield(yield) {}
-    Yield& _yield;
-
-    template <class Vs, class Graph>
-    void cycle(const Vs& vs, Graph&)
-    {
-        auto c = wrap_vector_owned(vs);
-        _yield(c);
-    }
-};
-
-
-boost::python::object get_all_circuits(GraphInterface& gi, bool unique)
+boost::python::object get_all_circuits(GraphInterface& gi, bool unique,
+                                       int64_t through)
 {
 #ifdef HAVE_BOOST_COROUTINE
     auto dispatch = [&](auto& yield)
@@ -50,11 +34,12 @@ boost::python::object get_all_circuits(GraphInterface& gi, bool unique)
                 (gi,
                  [&](auto& g)
                  {
-                     CircuitVisitor<decltype(yield)> visitor(yield);
-                     if (unique)
-                         hawick_unique_circuits(g, visitor);
-                     else
-                         hawick_circuits(g, visitor);
+                     all_circuits(g, unique, through,
+                                  [&](const auto& path)
+                                  {
+                                      auto c = wrap_vector_owned(path);
+                                      yield(c);
+                                  });
                  })();
         };
     return boost::python::object(CoroGenerator(dispatch));
@@ -63,8 +48,31 @@ boost::python::object get_all_circuits(GraphInterface& gi, bool unique)
 #endif // HAVE_BOOST_COROUTINE
 }
 
+boost::python::object get_all_circuits_count(GraphInterface& gi, bool unique,
+                                             int64_t through,
+                                             boost::any avcount)
+{
+    typedef vprop_map_t<int64_t>::type vcount_t;
+    bool vertex_counts = !avcount.empty();
+    vcount_t vcount = vertex_counts ? any_cast<vcount_t>(avcount) :
+        vcount_t(gi.get_vertex_index());
+
+    vector<uint64_t> hist;
+    run_action<>(true)
+        (gi,
+         [&](auto& g)
+         {
+             count_all_circuits(g, unique, through, hist,
+                                vcount.get_unchecked(vertex_counts ?
+                                                     num_vertices(g) : 0),
+                                vertex_counts);
+         })();
+    return wrap_vector_owned(hist);
+}
+
 
 void export_all_circuits()
 {
     boost::python::def("get_all_circuits", &get_all_circuits);
+    boost::python::def("get_all_circuits_count", &get_all_circuits_count);
 };
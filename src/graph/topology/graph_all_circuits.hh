@@ -0,0 +1,285 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_ALL_CIRCUITS_HH
+#define GRAPH_ALL_CIRCUITS_HH
+
+#include <algorithm>
+#include <vector>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Enumeration of the elementary circuits, with the algorithm of Hawick and
+// James (a variant of Johnson's algorithm which handles self-loops and
+// parallel edges), as in boost::hawick_circuits(), and yielding the circuits
+// in the same order.
+//
+// The circuits are found separately for each starting vertex s, as those
+// whose smallest vertex is s, so that the searches from different starting
+// vertices are independent, and can run in parallel, each with its own
+// circuit_state_t.
+
+// Out-neighbors of every vertex in compressed form. If unique == true, they are
+// sorted and without repetitions, i.e. parallel edges are ignored.
+class circuit_adj_t
+{
+public:
+    template <class Graph>
+    circuit_adj_t(const Graph& g, bool unique)
+        : _offset(num_vertices(g) + 1, 0)
+    {
+        for (size_t v = 0; v < num_vertices(g); ++v)
+        {
+            size_t begin = _offset[v] = _nbrs.size();
+            auto u = vertex(v, g);
+            if (!is_valid_vertex(u, g))
+                continue;
+            for (auto w : out_neighbors_range(u, g))
+                _nbrs.push_back(w);
+            if (unique)
+            {
+                std::sort(_nbrs.begin() + begin, _nbrs.end());
+                _nbrs.erase(std::unique(_nbrs.begin() + begin, _nbrs.end()),
+                            _nbrs.end());
+            }
+        }
+        _offset.back() = _nbrs.size();
+    }
+
+    size_t begin(size_t v) const { return _offset[v]; }
+    size_t end(size_t v) const { return _offset[v + 1]; }
+    size_t get_nbr(size_t pos) const { return _nbrs[pos]; }
+
+private:
+    vector<size_t> _offset;
+    vector<size_t> _nbrs;
+};
+
+// Workspace of the search from one starting vertex. The blocked flags and the
+// closed lists are reset lazily, when first accessed after a new search
+// begins, so that each search costs only as much as the vertices it touches.
+class circuit_state_t
+{
+public:
+    circuit_state_t(size_t N)
+        : _blocked(N, false), _closed(N), _stamp(N, 0) {}
+
+    template <class F>
+    void circuits_from(size_t s, const circuit_adj_t& adj, F&& f)
+    {
+        ++_gen;
+        push(s, adj);
+        while (!_path.empty())
+        {
+            size_t v = _path.back();
+            auto& fr = _frames.back();
+            if (fr.pos < adj.end(v))
+            {
+                size_t w = adj.get_nbr(fr.pos++);
+                if (w < s)
+                    continue;
+                if (w == s)
+                {
+                    f(_path);
+                    fr.found = true;
+                }
+                else if (!is_blocked(w))
+                {
+                    push(w, adj);  // invalidates fr
+                }
+                continue;
+            }
+
+            bool found = fr.found;
+            if (found)
+            {
+                unblock(v);
+            }
+            else
+            {
+                for (size_t pos = adj.begin(v); pos < adj.end(v); ++pos)
+                {
+                    size_t w = adj.get_nbr(pos);
+                    if (w < s)
+                        continue;
+                    auto& cw = get_closed(w);
+                    if (std::find(cw.begin(), cw.end(), v) == cw.end())
+                        cw.push_back(v);
+                }
+            }
+            _path.pop_back();
+            _frames.pop_back();
+            if (found && !_frames.empty())
+                _frames.back().found = true;
+        }
+    }
+
+private:
+    struct frame_t
+    {
+        size_t pos;
+        bool found;
+    };
+
+    void touch(size_t v)
+    {
+        if (_stamp[v] == _gen)
+            return;
+        _stamp[v] = _gen;
+        _blocked[v] = false;
+        _closed[v].clear();
+    }
+
+    bool is_blocked(size_t v)
+    {
+        touch(v);
+        return _blocked[v];
+    }
+
+    vector<size_t>& get_closed(size_t v)
+    {
+        touch(v);
+        return _closed[v];
+    }
+
+    void push(size_t v, const circuit_adj_t& adj)
+    {
+        touch(v);
+        _blocked[v] = true;
+        _path.push_back(v);
+        _frames.push_back({adj.begin(v), false});
+    }
+
+    // unblocks u, and recursively the blocked vertices closed to it
+    void unblock(size_t u)
+    {
+        _unblock.push_back(u);
+        while (!_unblock.empty())
+        {
+            size_t x = _unblock.back();
+            _unblock.pop_back();
+            if (!is_blocked(x))
+                continue;
+            _blocked[x] = false;
+            auto& cx = get_closed(x);
+            while (!cx.empty())
+            {
+                size_t w = cx.back();
+                cx.pop_back();
+                if (is_blocked(w))
+                    _unblock.push_back(w);
+            }
+        }
+    }
+
+    vector<bool> _blocked;
+    vector<vector<size_t>> _closed;
+    vector<size_t> _stamp;
+    size_t _gen = 0;
+    vector<size_t> _path;
+    vector<frame_t> _frames;
+    vector<size_t> _unblock;
+};
+
+// Calls f(path) for every circuit, sequentially. If through is a valid vertex,
+// only the circuits that contain it are considered, which are found among
+// the searches from the vertices with a smaller or equal index.
+template <class Graph, class F>
+void all_circuits(const Graph& g, bool unique, size_t through, F&& f)
+{
+    circuit_adj_t adj(g, unique);
+    circuit_state_t state(num_vertices(g));
+    for (auto s : vertices_range(g))
+    {
+        if (through < num_vertices(g) && s > through)
+            break;
+        state.circuits_from(s, adj,
+                            [&](const auto& path)
+                            {
+                                if (through < num_vertices(g) &&
+                                    std::find(path.begin(), path.end(),
+                                              through) == path.end())
+                                    return;
+                                f(path);
+                            });
+    }
+}
+
+// Counts the circuits by length into hist (which is resized as needed), and
+// the circuits through each vertex into vcount (if non-empty), in parallel
+// over the starting vertices.
+template <class Graph, class VCount>
+void count_all_circuits(const Graph& g, bool unique, size_t through,
+                        vector<uint64_t>& hist, VCount vcount,
+                        bool vertex_counts)
+{
+    circuit_adj_t adj(g, unique);
+    size_t N = num_vertices(g);
+    if (through < N)
+        N = through + 1;
+
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+    {
+        circuit_state_t state(num_vertices(g));
+        vector<uint64_t> lhist;
+        vector<int64_t> lcount(vertex_counts ? num_vertices(g) : 0);
+
+        // the amount of work is very uneven between starting vertices
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t s = 0; s < N; ++s)
+        {
+            if (!is_valid_vertex(vertex(s, g), g))
+                continue;
+            state.circuits_from
+                (s, adj,
+                 [&](const auto& path)
+                 {
+                     if (through < num_vertices(g) &&
+                         std::find(path.begin(), path.end(),
+                                   through) == path.end())
+                         return;
+                     if (lhist.size() <= path.size())
+                         lhist.resize(path.size() + 1);
+                     lhist[path.size()]++;
+                     if (vertex_counts)
+                     {
+                         for (auto v : path)
+                             lcount[v]++;
+                     }
+                 });
+        }
+
+        #pragma omp critical (count_all_circuits)
+        {
+            if (hist.size() < lhist.size())
+                hist.resize(lhist.size());
+            for (size_t l = 0; l < lhist.size(); ++l)
+                hist[l] += lhist[l];
+            for (size_t v = 0; v < lcount.size(); ++v)
+                vcount[v] += lcount[v];
+        }
+    }
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_ALL_CIRCUITS_HH
@@ -19,21 +19,81 @@
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "graph_parallel_bfs.hh"
+#include "graph_bellman_ford_parallel.hh"
 
 #include <boost/python.hpp>
 
-#include <boost/graph/johnson_all_pairs_shortest.hpp>
+#include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
 #include <boost/graph/floyd_warshall_shortest.hpp>
 
 using namespace std;
 using namespace boost;
 using namespace graph_tool;
 
+// Johnson's algorithm: the potentials h are obtained with a single parallel
+// Bellman-Ford search from a virtual source connected to every vertex, which
+// makes the weights w(u,v) + h(u) - h(v) non-negative, so that a Dijkstra
+// search can be done from every vertex, in parallel.
+template <class Graph, class DistMap, class WeightMap>
+void johnson_all_pairs(const Graph& g, DistMap dist_map, WeightMap weight,
+                       size_t edge_index_range)
+{
+    typedef typename property_traits<DistMap>::value_type::value_type dist_t;
+    constexpr dist_t inf = numeric_limits<dist_t>::max();
+
+    size_t N = num_vertices(g);
+    typename vprop_map_t<dist_t>::type h(get(vertex_index_t(), g));
+    typename vprop_map_t<int64_t>::type pred(get(vertex_index_t(), g));
+    auto uh = h.get_unchecked(N);
+    auto upred = pred.get_unchecked(N);
+
+    vector<size_t> sources;
+    for (auto v : vertices_range(g))
+    {
+        uh[v] = 0;
+        upred[v] = v;
+        sources.push_back(v);
+    }
+
+    parallel_bellman_ford bf;
+    if (!bf(g, sources, uh, upred, weight))
+        throw ValueException("Graph contains negative loops");
+
+    typename eprop_map_t<dist_t>::type rw(get(edge_index_t(), g));
+    auto urw = rw.get_unchecked(edge_index_range);
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             dist_t w = get(weight, e) + uh[source(e, g)] - uh[target(e, g)];
+             urw[e] = max(w, dist_t(0)); // guard against round-off
+         });
+
+    parallel_vertex_loop
+        (g,
+         [&](auto s)
+         {
+             auto& dist = dist_map[s];
+             auto dmap = make_iterator_property_map(dist.begin(),
+                                                    get(vertex_index_t(), g));
+             dijkstra_shortest_paths_no_color_map
+                 (g, s, weight_map(urw).distance_map(dmap).distance_inf(inf).
+                  vertex_index_map(get(vertex_index_t(), g)));
+             for (auto v : vertices_range(g))
+             {
+                 if (dist[v] != inf)
+                     dist[v] += uh[v] - uh[s];
+             }
+         });
+}
+
 struct do_all_pairs_search
 {
     template <class Graph, class VertexIndexMap, class DistMap, class WeightMap>
     void operator()(const Graph& g, VertexIndexMap vertex_index,
-                    DistMap dist_map, WeightMap weight, bool dense) const
+                    DistMap dist_map, WeightMap weight, bool dense,
+                    size_t edge_index_range) const
     {
         typedef typename property_traits<DistMap>::value_type::value_type
             dist_t;
@@ -55,75 +115,47 @@ struct do_all_pairs_search
         }
         else
         {
-            johnson_all_pairs_shortest_paths
-                (g, dist_map,
-                 weight_map(ConvertedPropertyMap<WeightMap,dist_t>(weight)).
-                 vertex_index_map(vertex_index));
+            johnson_all_pairs(g, dist_map,
+                              ConvertedPropertyMap<WeightMap,dist_t>(weight),
+                              edge_index_range);
         }
     }
 };
 
 struct do_all_pairs_search_unweighted
 {
-    template <class DistMap, class PredMap>
-    class bfs_visitor: public boost::bfs_visitor<null_visitor>
+    template <class Graph, class DistMap>
+    void operator()(const Graph& g, DistMap dist_map) const
     {
-    public:
-        bfs_visitor(DistMap& dist_map, PredMap& pred, size_t source)
-        : _dist_map(dist_map), _pred(pred), _source(source) {}
-
-        template <class Graph>
-        void initialize_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                               Graph&)
-        {
-            typedef typename DistMap::value_type dist_t;
-            dist_t inf = std::is_floating_point<dist_t>::value ?
-                numeric_limits<dist_t>::infinity() :
-                numeric_limits<dist_t>::max();
-            _dist_map[v] = (v == _source) ? 0 : inf;
-            _pred[v] = v;
-        }
-
-        template <class Graph>
-        void tree_edge(const typename graph_traits<Graph>::edge_descriptor& e,
-                       Graph& g)
-        {
-            _pred[target(e,g)] = source(e,g);
-        }
+        typedef typename property_traits<DistMap>::value_type::value_type
+            dist_t;
+        dist_t inf = std::is_floating_point<dist_t>::value ?
+            numeric_limits<dist_t>::infinity() :
+            numeric_limits<dist_t>::max();
 
-        template <class Graph>
-        void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                             Graph&)
-        {
-            if (size_t(_pred[v]) == v)
-                return;
-            _dist_map[v] = _dist_map[_pred[v]] + 1;
-        }
+        vector<size_t> sources;
+        for (auto v : vertices_range(g))
+            sources.push_back(v);
 
-    private:
-        DistMap& _dist_map;
-        PredMap& _pred;
-        size_t _source;
-    };
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 auto& dist = dist_map[v];
+                 dist.resize(num_vertices(g), 0);
+                 for (auto u : vertices_range(g))
+                     dist[u] = inf;
+                 dist[v] = 0;
+             });
 
-    template <class Graph, class DistMap>
-    void operator()(const Graph& g, DistMap dist_map) const
-    {
-        typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
-
-        vector<vertex_t> pred_map(num_vertices(g));
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            firstprivate(pred_map)
-        parallel_vertex_loop_no_spawn
-                (g,
-                 [&](auto v)
-                 {
-                     dist_map[v].resize(num_vertices(g), 0);
-                     bfs_visitor<typename std::remove_reference<decltype(dist_map[v])>::type,
-                                 vector<size_t>>
-                         vis(dist_map[v], pred_map, v);
-                     breadth_first_search(g, v, visitor(vis));
-                 });
+        // the sources are processed in batches, so that a single traversal of
+        // the graph serves many of them at once
+        parallel_multi_source_bfs
+            (g, sources,
+             [&](auto s, auto v, size_t d)
+             {
+                 dist_map[s][v] = d;
+             });
     }
 };
 
@@ -144,7 +176,8 @@ void get_all_dists(GraphInterface& gi, boost::any dist_map, boost::any weight,
         run_action<>()
             (gi, std::bind(do_all_pairs_search(), std::placeholders::_1,
                            gi.get_vertex_index(), std::placeholders::_2,
-                           std::placeholders::_3, dense),
+                           std::placeholders::_3, dense,
+                           gi.get_edge_index_range()),
              vertex_scalar_vector_properties(),
              edge_scalar_properties())
             (dist_map, weight);
@@ -18,9 +18,15 @@
 #ifndef GRAPH_COMPONENTS_HH
 #define GRAPH_COMPONENTS_HH
 
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/strong_components.hpp>
 #include <boost/graph/biconnected_components.hpp>
+#include "graph_parallel_traversal.hh"
 
 namespace graph_tool
 {
@@ -96,6 +102,191 @@ void put(HistogramPropertyMap<PropertyMap> pmap,
 }
 
 
+// Writes the components given by a representative vertex of each of them,
+// with labels ordered by the first vertex of each component, and the
+// histogram of the labels.
+template <class Graph, class CompMap>
+void label_by_representative(const Graph& g, const vector<size_t>& rep,
+                             CompMap comp_map, vector<size_t>& hist)
+{
+    vector<size_t> label(num_vertices(g), numeric_limits<size_t>::max());
+    hist.clear();
+    for (auto v : vertices_range(g))
+    {
+        auto& l = label[rep[v]];
+        if (l == numeric_limits<size_t>::max())
+        {
+            l = hist.size();
+            hist.push_back(0);
+        }
+        ++hist[l];
+        put(comp_map, v, l);
+    }
+}
+
+// Parallel connected components, by concurrent union-find over the edges.
+// The representative of each vertex is the smallest vertex of its component,
+// hence the labels are the same as those of a sequential search.
+template <class Graph>
+void parallel_connected_components(const Graph& g, vector<size_t>& rep)
+{
+    size_t N = num_vertices(g);
+    concurrent_union_find uf(N);
+    parallel_edge_loop
+        (g,
+         [&](const auto& e)
+         {
+             uf.unite(source(e, g), target(e, g));
+         });
+    rep.resize(N);
+    parallel_vertex_loop(g, [&](auto v) { rep[v] = uf.find(v); });
+}
+
+// Parallel strong components, by the forward-backward algorithm with
+// trimming. First, the vertices with no remaining in- or out-edges are
+// repeatedly removed, in parallel by work stealing, since they are singleton
+// components. Then, the strong component of a pivot is obtained as the
+// intersection of its forward and backward reachable sets, computed in
+// parallel, and the other vertices are split in three subproblems (forward
+// only, backward only and neither), which cannot share any component, and are
+// processed in the same way. Each subproblem is marked with a distinct color,
+// which restricts the traversals to it, and is also used to stamp the
+// reached vertices, so that nothing needs to be reset between them.
+template <class Graph>
+void parallel_strong_components(const Graph& g, vector<size_t>& rep)
+{
+    size_t N = num_vertices(g);
+    rep.resize(N);
+
+    std::unique_ptr<std::atomic<size_t>[]> din(new std::atomic<size_t>[N]);
+    std::unique_ptr<std::atomic<size_t>[]> dout(new std::atomic<size_t>[N]);
+    std::unique_ptr<std::atomic<uint8_t>[]> removed(new std::atomic<uint8_t>[N]);
+    std::unique_ptr<std::atomic<size_t>[]> fw(new std::atomic<size_t>[N]);
+    std::unique_ptr<std::atomic<size_t>[]> bw(new std::atomic<size_t>[N]);
+    vector<size_t> color(N, 0);
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             din[v] = in_degreeS()(v, g);
+             dout[v] = out_degree(v, g);
+             removed[v] = false;
+             fw[v] = bw[v] = 0;
+         });
+
+    // trimming
+    vector<size_t> init;
+    for (auto v : vertices_range(g))
+    {
+        if (din[v] == 0 || dout[v] == 0)
+        {
+            removed[v] = true;
+            init.push_back(v);
+        }
+    }
+
+    work_stealing_loop
+        (init, get_traversal_threads(N),
+         [&](size_t v, auto& push)
+         {
+             rep[v] = v;
+             auto remove = [&](size_t u, auto& deg)
+                 {
+                     if (u == v || removed[u])
+                         return;
+                     if (deg[u].fetch_sub(1) == 1 && !removed[u].exchange(true))
+                         push(u);
+                 };
+             for (auto u : out_neighbors_range(vertex(v, g), g))
+                 remove(u, din);
+             for (auto u : in_neighbors_range(vertex(v, g), g))
+                 remove(u, dout);
+         });
+
+    // forward-backward
+    vector<pair<size_t, vector<size_t>>> subproblems(1);
+    size_t n_colors = 1;
+    subproblems.back().first = n_colors;
+    for (auto v : vertices_range(g))
+    {
+        if (removed[v])
+            continue;
+        color[v] = n_colors;
+        subproblems.back().second.push_back(v);
+    }
+
+    auto reach = [&](size_t c, size_t p, auto& mark, auto&& neighbors,
+                     size_t nt)
+        {
+            mark[p] = c;
+            work_stealing_loop
+                (vector<size_t>({p}), nt,
+                 [&](size_t v, auto& push)
+                 {
+                     for (auto u : neighbors(vertex(v, g)))
+                     {
+                         if (color[u] != c || mark[u] == c ||
+                             mark[u].exchange(c) == c)
+                             continue;
+                         push(u);
+                     }
+                 });
+        };
+
+    while (!subproblems.empty())
+    {
+        size_t c = subproblems.back().first;
+        vector<size_t> vs = std::move(subproblems.back().second);
+        subproblems.pop_back();
+
+        if (vs.empty())
+            continue;
+
+        // the pivot is the vertex with the largest product of in- and
+        // out-degrees, which is likely to be in a large component
+        size_t p = vs[0];
+        size_t kp = 0;
+        for (auto v : vs)
+        {
+            size_t k = din[v] * dout[v];
+            if (k > kp)
+            {
+                kp = k;
+                p = v;
+            }
+        }
+
+        size_t nt = get_traversal_threads(vs.size());
+        reach(c, p, fw,
+              [&](auto v) { return out_neighbors_range(v, g); }, nt);
+        reach(c, p, bw,
+              [&](auto v) { return in_neighbors_range(v, g); }, nt);
+
+        std::array<pair<size_t, vector<size_t>>, 3> parts;
+        for (auto& part : parts)
+            part.first = ++n_colors;
+        for (auto v : vs)
+        {
+            bool f = fw[v] == c;
+            bool b = bw[v] == c;
+            if (f && b)
+            {
+                rep[v] = p;
+                continue;
+            }
+            auto& part = parts[f ? 0 : (b ? 1 : 2)];
+            color[v] = part.first;
+            part.second.push_back(v);
+        }
+        for (auto& part : parts)
+        {
+            if (!part.second.empty())
+                subproblems.push_back(std::move(part));
+        }
+    }
+}
+
 // this will label the components of a graph to a given vertex property, from
 // [0, number of components - 1], and keep an histogram. If the graph is
 // directed the strong components are used.
@@ -107,10 +298,22 @@ struct label_components
     {
         typedef typename graph_traits<Graph>::directed_category
             directed_category;
+        typename std::is_convertible<directed_category, directed_tag>::type
+            directed;
+
+        // large graphs are processed in parallel; the strong components then
+        // get a different (but deterministic) labeling, ordered by their
+        // first vertex
+        if (get_traversal_threads(num_vertices(g)) > 1)
+        {
+            vector<size_t> rep;
+            get_components_parallel(g, rep, directed);
+            label_by_representative(g, rep, comp_map, hist);
+            return;
+        }
+
         HistogramPropertyMap<CompMap> cm(comp_map, num_vertices(g), hist);
-        get_components(g, cm,
-                       typename std::is_convertible<directed_category,
-                                                    directed_tag>::type());
+        get_components(g, cm, directed);
     }
 
     template <class Graph, class CompMap>
@@ -126,6 +329,20 @@ struct label_components
     {
         boost::connected_components(g, comp_map);
     }
+
+    template <class Graph>
+    void get_components_parallel(Graph& g, vector<size_t>& rep,
+                                 std::true_type) const
+    {
+        parallel_strong_components(g, rep);
+    }
+
+    template <class Graph>
+    void get_components_parallel(Graph& g, vector<size_t>& rep,
+                                 std::false_type) const
+    {
+        parallel_connected_components(g, rep);
+    }
 };
 
 struct label_biconnected_components
@@ -164,27 +381,12 @@ struct label_biconnected_components
 
 struct label_out_component
 {
-    template <class CompMap>
-    class marker_visitor: public bfs_visitor<>
-    {
-    public:
-        marker_visitor() { }
-        marker_visitor(CompMap comp) : _comp(comp) { }
-
-        template <class Vertex, class Graph>
-        void discover_vertex(Vertex u, const Graph&)
-        {
-            _comp[u] = true;
-        }
-    private:
-        CompMap _comp;
-    };
-
     template <class Graph, class CompMap>
     void operator()(Graph& g, CompMap comp_map, size_t root) const
     {
-        marker_visitor<CompMap> marker(comp_map);
-        breadth_first_search(g, vertex(root, g), visitor(marker));
+        // no levels are needed, so the traversal is not synchronized by them
+        parallel_reach(g, {root},
+                       [&](auto v) { comp_map[vertex(v, g)] = true; });
     }
 };
 
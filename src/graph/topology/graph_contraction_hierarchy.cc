@@ -0,0 +1,135 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "numpy_bind.hh"
+
+#include "graph_contraction_hierarchy.hh"
+
+#include <fstream>
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+constexpr ContractionHierarchy::dist_t ContractionHierarchy::_inf;
+constexpr size_t ContractionHierarchy::_null;
+constexpr size_t ContractionHierarchy::_max_settled;
+constexpr size_t ContractionHierarchy::_max_settled_estimate;
+constexpr size_t ContractionHierarchy::_max_hops_estimate;
+constexpr char ContractionHierarchy::_magic[4];
+constexpr uint32_t ContractionHierarchy::_version;
+
+void ch_build(ContractionHierarchy& ch, GraphInterface& gi, boost::any weight)
+{
+    if (weight.empty())
+    {
+        run_action<>()
+            (gi, [&](auto& g)
+             {
+                 ch.build(g, UnityPropertyMap<size_t,
+                                              GraphInterface::edge_t>());
+             })();
+    }
+    else
+    {
+        run_action<>()
+            (gi, [&](auto& g, auto w) { ch.build(g, w); },
+             edge_scalar_properties())(weight);
+    }
+}
+
+// distances between the pairs (sources[i], targets[i]), which are split among
+// the threads
+python::object ch_distance(ContractionHierarchy& ch, python::object osources,
+                           python::object otargets)
+{
+    auto sources = get_array<int64_t, 1>(osources);
+    auto targets = get_array<int64_t, 1>(otargets);
+    if (sources.size() != targets.size())
+        throw ValueException("the numbers of sources and targets differ");
+
+    size_t n = sources.size();
+    vector<ContractionHierarchy::dist_t> dist(n);
+    string err;
+    #pragma omp parallel if (n > OPENMP_MIN_THRESH)
+    {
+        static thread_local ContractionHierarchy::query q;
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < n; ++i)
+        {
+            try
+            {
+                if (sources[i] < 0 || targets[i] < 0)
+                    throw ValueException("Invalid vertex index: " +
+                                         to_string(min(sources[i],
+                                                       targets[i])));
+                dist[i] = ch.distance(sources[i], targets[i], q, nullptr);
+            }
+            catch (ValueException& e)
+            {
+                #pragma omp critical
+                err = e.what();
+            }
+        }
+    }
+    if (!err.empty())
+        throw ValueException(err);
+    return wrap_vector_owned(dist);
+}
+
+python::object ch_path(ContractionHierarchy& ch, size_t source, size_t target)
+{
+    static thread_local ContractionHierarchy::query q;
+    vector<size_t> path;
+    auto d = ch.distance(source, target, q, &path);
+    return python::make_tuple(d, wrap_vector_owned(path));
+}
+
+void ch_save(ContractionHierarchy& ch, string fname)
+{
+    ofstream s(fname, ios::binary);
+    if (!s)
+        throw IOException("error opening file '" + fname + "' for writing");
+    ch.save(s);
+}
+
+void ch_load(ContractionHierarchy& ch, string fname)
+{
+    ifstream s(fname, ios::binary);
+    if (!s)
+        throw IOException("error opening file '" + fname + "' for reading");
+    ch.load(s);
+}
+
+void export_contraction_hierarchy()
+{
+    using namespace boost::python;
+    class_<ContractionHierarchy, std::shared_ptr<ContractionHierarchy>,
+           boost::noncopyable>("ContractionHierarchy")
+        .def("build", &ch_build)
+        .def("distance", &ch_distance)
+        .def("path", &ch_path)
+        .def("save", &ch_save)
+        .def("load", &ch_load)
+        .def("num_vertices", &ContractionHierarchy::num_vertices)
+        .def("num_shortcuts", &ContractionHierarchy::num_shortcuts);
+}
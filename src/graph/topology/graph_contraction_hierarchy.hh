@@ -0,0 +1,731 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_CONTRACTION_HIERARCHY_HH
+#define GRAPH_CONTRACTION_HIERARCHY_HH
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_exceptions.hh"
+
+namespace graph_tool
+{
+
+// Contraction hierarchy (R. Geisberger, P. Sanders, D. Schultes and
+// D. Delling, "Contraction hierarchies: faster and simpler hierarchical
+// routing in road networks", WEA 2008), for repeated point-to-point
+// shortest-path queries on a static graph with non-negative weights.
+//
+// The vertices are contracted one by one in order of importance: contracting v
+// removes it from the remaining graph, and adds a shortcut u -> w for every
+// path u -> v -> w that is the only shortest one, as verified by a bounded
+// "witness" search from u that avoids v. A query is then a bidirectional
+// Dijkstra search in which both sides only follow edges towards vertices
+// contracted later, which explores only a tiny part of the graph.
+//
+// The contraction is done in rounds, each of which contracts in parallel an
+// independent set of vertices whose priority is minimal among their
+// neighbours. The priority is the edge difference (shortcuts added minus
+// edges removed), plus the number of contracted neighbours and the depth in
+// the hierarchy, which keep the contraction uniform across the graph. It is
+// estimated with witness searches of limited depth, which is much cheaper and
+// only overestimates the shortcuts needed. The
+// witness searches of a round avoid all the vertices being contracted in it,
+// so that the result does not depend on their order.
+class ContractionHierarchy
+{
+public:
+    typedef double dist_t;
+
+    ContractionHierarchy() {}
+
+    // Reusable buffers for queries; each thread must use its own.
+    class query
+    {
+    private:
+        friend class ContractionHierarchy;
+
+        struct side_t
+        {
+            std::vector<dist_t> dist;
+            std::vector<size_t> pred;
+            std::vector<int64_t> mid;
+            std::vector<size_t> touched;
+            std::priority_queue<std::pair<dist_t, size_t>,
+                                std::vector<std::pair<dist_t, size_t>>,
+                                std::greater<std::pair<dist_t, size_t>>> queue;
+
+            void set(size_t v, dist_t d, size_t u, int64_t m)
+            {
+                if (dist[v] == _inf)
+                    touched.push_back(v);
+                dist[v] = d;
+                pred[v] = u;
+                mid[v] = m;
+                queue.emplace(d, v);
+            }
+        };
+
+        void init(size_t N)
+        {
+            for (auto& side : _side)
+            {
+                for (auto v : side.touched)
+                    side.dist[v] = _inf;
+                side.touched.clear();
+                if (side.dist.size() < N)
+                {
+                    side.dist.resize(N, _inf);
+                    side.pred.resize(N);
+                    side.mid.resize(N);
+                }
+                while (!side.queue.empty())
+                    side.queue.pop();
+            }
+        }
+
+        side_t _side[2];
+    };
+
+    template <class Graph, class WeightMap>
+    void build(const Graph& g, WeightMap weight)
+    {
+        _N = boost::num_vertices(g);
+        _n_shortcuts = 0;
+
+        std::vector<std::vector<arc_t>> out(_N), in(_N);
+        for (auto v : vertices_range(g))
+        {
+            auto& es = out[v];
+            for (auto e : out_edges_range(v, g))
+            {
+                size_t u = target(e, g);
+                if (u == size_t(v))
+                    continue;
+                dist_t w = get(weight, e);
+                if (w < 0)
+                    throw ValueException("contraction hierarchies require "
+                                         "non-negative edge weights");
+                es.push_back({u, w, -1});
+            }
+
+            // only the lightest of parallel edges is kept
+            std::sort(es.begin(), es.end(),
+                      [](auto& a, auto& b)
+                      { return std::tie(a.v, a.w) < std::tie(b.v, b.w); });
+            es.erase(std::unique(es.begin(), es.end(),
+                                 [](auto& a, auto& b) { return a.v == b.v; }),
+                     es.end());
+        }
+        for (size_t v = 0; v < _N; ++v)
+        {
+            for (auto& a : out[v])
+                in[a.v].push_back({v, a.w, -1});
+        }
+
+        size_t nt = 1;
+#ifdef _OPENMP
+        if (_N > OPENMP_MIN_THRESH)
+            nt = omp_get_max_threads();
+#endif
+        std::vector<witness_t> witness(nt);
+        std::vector<std::vector<shortcut_t>> shortcuts(_N);
+
+        std::vector<int64_t> prio(_N), level(_N), deleted(_N);
+        std::vector<uint8_t> contracting(_N, false), affected(_N, false),
+            done(_N, false);
+        std::vector<size_t> last(_N, _null);
+        std::vector<std::vector<arc_t>> up_out(_N), up_in(_N);
+
+        std::vector<size_t> remain;
+        for (auto v : vertices_range(g))
+            remain.push_back(v);
+
+        // the edge difference is weighted above the other terms, after
+        // Geisberger et al.
+        auto get_prio = [&](size_t v, witness_t& ws)
+        {
+            int64_t s = contract(v, out, in, contracting, ws, nullptr);
+            int64_t r = out[v].size() + in[v].size();
+            return 4 * (s - r) + 2 * deleted[v] + level[v];
+        };
+
+        auto update_prio = [&](const std::vector<size_t>& vs)
+        {
+            #pragma omp parallel num_threads(nt) if (nt > 1)
+            {
+                size_t t = 0;
+#ifdef _OPENMP
+                t = omp_get_thread_num();
+#endif
+                auto& ws = witness[t];
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < vs.size(); ++i)
+                    prio[vs[i]] = get_prio(vs[i], ws);
+            }
+        };
+
+        // ties are broken by a hash of the index, instead of the index itself,
+        // so that the selected sets do not follow the vertex numbering
+        auto before = [&](size_t u, size_t v)
+        {
+            return std::make_tuple(prio[u], hash(u), u) <
+                std::make_tuple(prio[v], hash(v), v);
+        };
+
+        update_prio(remain);
+
+        std::vector<size_t> selected, changed;
+        while (!remain.empty())
+        {
+            selected.clear();
+            for (auto v : remain)
+            {
+                bool min = true;
+                for (auto& a : out[v])
+                    min = min && before(v, a.v);
+                for (auto& a : in[v])
+                    min = min && before(v, a.v);
+                if (min)
+                {
+                    selected.push_back(v);
+                    contracting[v] = true;
+                }
+            }
+
+            #pragma omp parallel num_threads(nt) if (nt > 1 && \
+                                                     selected.size() > 1)
+            {
+                size_t t = 0;
+#ifdef _OPENMP
+                t = omp_get_thread_num();
+#endif
+                auto& ws = witness[t];
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < selected.size(); ++i)
+                {
+                    size_t v = selected[i];
+                    contract(v, out, in, contracting, ws, &shortcuts[v]);
+                }
+            }
+
+            changed.clear();
+            auto touch = [&](size_t u, size_t v)
+            {
+                if (last[u] != v)
+                {
+                    last[u] = v;
+                    ++deleted[u];
+                    level[u] = std::max(level[u], level[v] + 1);
+                }
+                if (!affected[u])
+                {
+                    affected[u] = true;
+                    changed.push_back(u);
+                }
+            };
+
+            for (auto v : selected)
+            {
+                for (auto& a : in[v])
+                {
+                    remove_arc(out[a.v], v);
+                    touch(a.v, v);
+                }
+                for (auto& a : out[v])
+                {
+                    remove_arc(in[a.v], v);
+                    touch(a.v, v);
+                }
+                up_out[v].swap(out[v]);
+                up_in[v].swap(in[v]);
+                contracting[v] = false;
+            }
+
+            for (auto v : selected)
+            {
+                for (auto& sc : shortcuts[v])
+                {
+                    if (add_arc(out, in, sc.u, sc.w, sc.d, v))
+                        ++_n_shortcuts;
+                }
+                shortcuts[v].clear();
+                shortcuts[v].shrink_to_fit();
+            }
+
+            for (auto v : selected)
+                done[v] = true;
+            remain.erase(std::remove_if(remain.begin(), remain.end(),
+                                        [&](auto v) { return done[v]; }),
+                         remain.end());
+
+            for (auto v : changed)
+                affected[v] = false;
+            update_prio(changed);
+        }
+
+        to_csr(up_out, _out_pos, _out);
+        to_csr(up_in, _in_pos, _in);
+    }
+
+    // Returns the distance from s to t (inf if it is unreachable), and puts
+    // the vertices of a shortest path in path, if it is not null.
+    dist_t distance(size_t s, size_t t, query& q,
+                    std::vector<size_t>* path) const
+    {
+        if (s >= _N || t >= _N)
+            throw ValueException("Invalid vertex index: " +
+                                 std::to_string(std::max(s, t)));
+        q.init(_N);
+        if (path != nullptr)
+            path->clear();
+        if (s == t)
+        {
+            if (path != nullptr)
+                path->push_back(s);
+            return 0;
+        }
+
+        auto& side = q._side;
+        side[0].set(s, 0, s, -1);
+        side[1].set(t, 0, t, -1);
+
+        dist_t best = _inf;
+        size_t meet = _null;
+        bool active[2] = {true, true};
+        while (true)
+        {
+            // a side is done once nothing it can still reach improves on the
+            // best path found
+            for (size_t d = 0; d < 2; ++d)
+            {
+                if (active[d] && (side[d].queue.empty() ||
+                                  !(side[d].queue.top().first < best)))
+                    active[d] = false;
+            }
+            if (!active[0] && !active[1])
+                break;
+
+            size_t d = (active[0] &&
+                        (!active[1] || (side[0].queue.top().first <=
+                                        side[1].queue.top().first))) ? 0 : 1;
+            auto& this_side = side[d];
+            auto& other = side[1 - d];
+
+            dist_t du;
+            size_t u;
+            std::tie(du, u) = this_side.queue.top();
+            this_side.queue.pop();
+            if (du > this_side.dist[u])
+                continue;
+
+            if (other.dist[u] != _inf && du + other.dist[u] < best)
+            {
+                best = du + other.dist[u];
+                meet = u;
+            }
+
+            // "stall on demand": if u can be reached with a shorter distance
+            // from a vertex above it, it is not on a shortest up-down path,
+            // and need not be expanded
+            bool stalled = false;
+            for_arcs(u, 1 - d,
+                     [&](const arc_t& a)
+                     {
+                         if (this_side.dist[a.v] + a.w < du)
+                             stalled = true;
+                     });
+            if (stalled)
+                continue;
+
+            for_arcs(u, d,
+                     [&](const arc_t& a)
+                     {
+                         dist_t dw = du + a.w;
+                         if (dw < this_side.dist[a.v])
+                             this_side.set(a.v, dw, u, a.mid);
+                     });
+        }
+
+        if (meet == _null)
+            return _inf;
+
+        if (path != nullptr)
+        {
+            std::vector<size_t> up;
+            for (size_t v = meet; v != s; v = side[0].pred[v])
+                up.push_back(v);
+            path->push_back(s);
+            for (auto iter = up.rbegin(); iter != up.rend(); ++iter)
+                unpack(side[0].pred[*iter], *iter, side[0].mid[*iter], *path);
+            for (size_t v = meet; v != t; v = side[1].pred[v])
+                unpack(v, side[1].pred[v], side[1].mid[v], *path);
+        }
+        return best;
+    }
+
+    size_t num_vertices() const { return _N; }
+    size_t num_shortcuts() const { return _n_shortcuts; }
+
+    // The hierarchy is stored in a binary format, in host byte order.
+    void save(std::ostream& s) const
+    {
+        s.write(_magic, sizeof(_magic));
+        write(s, _version);
+        write(s, uint64_t(_N));
+        write(s, uint64_t(_n_shortcuts));
+        write(s, _out_pos);
+        write(s, _out);
+        write(s, _in_pos);
+        write(s, _in);
+        if (!s)
+            throw IOException("error writing contraction hierarchy");
+    }
+
+    void load(std::istream& s)
+    {
+        char magic[sizeof(_magic)];
+        s.read(magic, sizeof(magic));
+        if (!s || !std::equal(magic, magic + sizeof(magic), _magic))
+            throw IOException("not a contraction hierarchy file");
+        uint32_t version;
+        read(s, version);
+        if (version != _version)
+            throw IOException("unsupported contraction hierarchy version: " +
+                              std::to_string(version));
+        uint64_t N, n_shortcuts;
+        read(s, N);
+        read(s, n_shortcuts);
+        read(s, _out_pos);
+        read(s, _out);
+        read(s, _in_pos);
+        read(s, _in);
+        if (!s || _out_pos.size() != N + 1 || _in_pos.size() != N + 1 ||
+            _out_pos.back() != _out.size() || _in_pos.back() != _in.size())
+            throw IOException("truncated or corrupted contraction "
+                              "hierarchy file");
+        _N = N;
+        _n_shortcuts = n_shortcuts;
+    }
+
+private:
+    // an edge to (or from) v; shortcuts bypass the vertex mid, which is -1
+    // for the original edges
+    struct arc_t
+    {
+        size_t v;
+        dist_t w;
+        int64_t mid;
+    };
+
+    struct shortcut_t
+    {
+        size_t u;
+        size_t w;
+        dist_t d;
+    };
+
+    struct witness_t
+    {
+        std::vector<dist_t> dist;
+        std::vector<size_t> hops;
+        std::vector<uint8_t> target;
+        std::vector<size_t> touched;
+        std::priority_queue<std::pair<dist_t, size_t>,
+                            std::vector<std::pair<dist_t, size_t>>,
+                            std::greater<std::pair<dist_t, size_t>>> queue;
+    };
+
+    // Returns the number of shortcuts needed to contract v, and puts them in
+    // shortcuts, if it is not null. Otherwise, the number is only estimated,
+    // with shorter witness searches, which can only overestimate it.
+    size_t contract(size_t v, const std::vector<std::vector<arc_t>>& out,
+                    const std::vector<std::vector<arc_t>>& in,
+                    const std::vector<uint8_t>& contracting, witness_t& ws,
+                    std::vector<shortcut_t>* shortcuts) const
+    {
+        if (ws.dist.size() < _N)
+        {
+            ws.dist.resize(_N, _inf);
+            ws.hops.resize(_N);
+            ws.target.resize(_N, false);
+        }
+        for (auto& b : out[v])
+            ws.target[b.v] = true;
+
+        size_t max_settled = (shortcuts != nullptr) ?
+            _max_settled : _max_settled_estimate;
+        size_t max_hops = (shortcuts != nullptr) ?
+            std::numeric_limits<size_t>::max() : _max_hops_estimate;
+        size_t n = 0;
+        for (auto& a : in[v])
+        {
+            dist_t max_d = -1;
+            for (auto& b : out[v])
+            {
+                if (b.v != a.v)
+                    max_d = std::max(max_d, a.w + b.w);
+            }
+            if (max_d < 0)
+                continue;
+
+            witness_search(a.v, v, max_d, out[v].size(), max_settled,
+                           max_hops, out, contracting, ws);
+
+            for (auto& b : out[v])
+            {
+                if (b.v == a.v)
+                    continue;
+                dist_t d = a.w + b.w;
+                if (ws.dist[b.v] > d)
+                {
+                    ++n;
+                    if (shortcuts != nullptr)
+                        shortcuts->push_back({a.v, b.v, d});
+                }
+            }
+        }
+
+        for (auto& b : out[v])
+            ws.target[b.v] = false;
+        return n;
+    }
+
+    // Dijkstra search from s that avoids v and the vertices being contracted,
+    // bounded by max_d and by the number of settled vertices, and that stops
+    // once the n_targets marked vertices are settled. The distances found are
+    // upper bounds of the shortest ones in the remaining graph.
+    void witness_search(size_t s, size_t v, dist_t max_d, size_t n_targets,
+                        size_t max_settled, size_t max_hops,
+                        const std::vector<std::vector<arc_t>>& out,
+                        const std::vector<uint8_t>& contracting,
+                        witness_t& ws) const
+    {
+        for (auto u : ws.touched)
+            ws.dist[u] = _inf;
+        ws.touched.clear();
+        while (!ws.queue.empty())
+            ws.queue.pop();
+
+        ws.dist[s] = 0;
+        ws.hops[s] = 0;
+        ws.touched.push_back(s);
+        ws.queue.emplace(0, s);
+
+        size_t settled = 0;
+        while (!ws.queue.empty() && settled < max_settled)
+        {
+            dist_t du;
+            size_t u;
+            std::tie(du, u) = ws.queue.top();
+            ws.queue.pop();
+            if (du > ws.dist[u])
+                continue;
+            if (du > max_d)
+                break;
+            if (ws.target[u] && --n_targets == 0)
+                break;
+            ++settled;
+            if (ws.hops[u] >= max_hops)
+                continue;
+            for (auto& a : out[u])
+            {
+                if (a.v == v || contracting[a.v])
+                    continue;
+                dist_t dw = du + a.w;
+                if (dw < ws.dist[a.v])
+                {
+                    if (ws.dist[a.v] == _inf)
+                        ws.touched.push_back(a.v);
+                    ws.dist[a.v] = dw;
+                    ws.hops[a.v] = ws.hops[u] + 1;
+                    ws.queue.emplace(dw, a.v);
+                }
+            }
+        }
+    }
+
+    static void remove_arc(std::vector<arc_t>& arcs, size_t v)
+    {
+        for (size_t i = 0; i < arcs.size(); ++i)
+        {
+            if (arcs[i].v == v)
+            {
+                arcs[i] = arcs.back();
+                arcs.pop_back();
+                return;
+            }
+        }
+    }
+
+    // Adds the arc u -> w, or shortens an existing one. Returns true if a new
+    // arc was added.
+    static bool add_arc(std::vector<std::vector<arc_t>>& out,
+                        std::vector<std::vector<arc_t>>& in,
+                        size_t u, size_t w, dist_t d, size_t mid)
+    {
+        for (auto& a : out[u])
+        {
+            if (a.v != w)
+                continue;
+            if (d < a.w)
+            {
+                a.w = d;
+                a.mid = mid;
+                for (auto& b : in[w])
+                {
+                    if (b.v == u)
+                    {
+                        b.w = d;
+                        b.mid = mid;
+                        break;
+                    }
+                }
+            }
+            return false;
+        }
+        out[u].push_back({w, d, int64_t(mid)});
+        in[w].push_back({u, d, int64_t(mid)});
+        return true;
+    }
+
+    static void to_csr(std::vector<std::vector<arc_t>>& arcs,
+                       std::vector<uint64_t>& pos, std::vector<arc_t>& flat)
+    {
+        pos.clear();
+        flat.clear();
+        pos.push_back(0);
+        for (auto& as : arcs)
+        {
+            flat.insert(flat.end(), as.begin(), as.end());
+            pos.push_back(flat.size());
+            std::vector<arc_t>().swap(as);
+        }
+    }
+
+    // calls f(a) for the arcs from u to the vertices above it (d == 0), or
+    // from the vertices above it to u (d == 1)
+    template <class F>
+    void for_arcs(size_t u, size_t d, F&& f) const
+    {
+        auto& pos = (d == 0) ? _out_pos : _in_pos;
+        auto& arcs = (d == 0) ? _out : _in;
+        for (size_t i = pos[u]; i < pos[u + 1]; ++i)
+            f(arcs[i]);
+    }
+
+    static int64_t find_mid(const std::vector<uint64_t>& pos,
+                            const std::vector<arc_t>& arcs, size_t u,
+                            size_t v)
+    {
+        for (size_t i = pos[u]; i < pos[u + 1]; ++i)
+        {
+            if (arcs[i].v == v)
+                return arcs[i].mid;
+        }
+        throw GraphException("inconsistent contraction hierarchy");
+    }
+
+    // appends the vertices of the original path of the arc u -> v, excluding
+    // u, to path
+    void unpack(size_t u, size_t v, int64_t mid,
+                std::vector<size_t>& path) const
+    {
+        std::vector<std::tuple<size_t, size_t, int64_t>> stack = {{u, v, mid}};
+        while (!stack.empty())
+        {
+            std::tie(u, v, mid) = stack.back();
+            stack.pop_back();
+            if (mid < 0)
+            {
+                path.push_back(v);
+                continue;
+            }
+            // the arcs u -> mid and mid -> v were kept when mid was contracted
+            size_t m = mid;
+            stack.emplace_back(m, v, find_mid(_out_pos, _out, m, v));
+            stack.emplace_back(u, m, find_mid(_in_pos, _in, m, u));
+        }
+    }
+
+    static size_t hash(size_t v)
+    {
+        v ^= v >> 33;
+        v *= 0xff51afd7ed558ccdULL;
+        v ^= v >> 33;
+        return v;
+    }
+
+    template <class T>
+    static void write(std::ostream& s, const T& x)
+    {
+        s.write(reinterpret_cast<const char*>(&x), sizeof(T));
+    }
+
+    template <class T>
+    static void write(std::ostream& s, const std::vector<T>& x)
+    {
+        write(s, uint64_t(x.size()));
+        s.write(reinterpret_cast<const char*>(x.data()), x.size() * sizeof(T));
+    }
+
+    template <class T>
+    static void read(std::istream& s, T& x)
+    {
+        s.read(reinterpret_cast<char*>(&x), sizeof(T));
+    }
+
+    template <class T>
+    static void read(std::istream& s, std::vector<T>& x)
+    {
+        uint64_t n = 0;
+        read(s, n);
+        if (!s)
+            return;
+        x.resize(n);
+        s.read(reinterpret_cast<char*>(x.data()), n * sizeof(T));
+    }
+
+    static constexpr dist_t _inf = std::numeric_limits<dist_t>::infinity();
+    static constexpr size_t _null = std::numeric_limits<size_t>::max();
+    static constexpr size_t _max_settled = 500;
+    static constexpr size_t _max_settled_estimate = 50;
+    static constexpr size_t _max_hops_estimate = 2;
+    static constexpr char _magic[4] = {'g', 't', 'c', 'h'};
+    static constexpr uint32_t _version = 1;
+
+    size_t _N = 0;
+    size_t _n_shortcuts = 0;
+    std::vector<uint64_t> _out_pos;
+    std::vector<arc_t> _out;
+    std::vector<uint64_t> _in_pos;
+    std::vector<arc_t> _in;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_CONTRACTION_HIERARCHY_HH
@@ -19,6 +19,8 @@
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
 #include "graph_selectors.hh"
+#include "graph_parallel_bfs.hh"
+#include "graph_parallel_traversal.hh"
 
 #include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
@@ -142,6 +144,281 @@ struct do_djk_search
     }
 };
 
+// Exact eccentricities and diameter of unweighted graphs, with every BFS done
+// in parallel. The eccentricities are taken within the component of each
+// vertex, and the diameter is the largest of them. Returns the diameter, with
+// its end points in s and t.
+//
+// For undirected graphs, after a BFS from v with eccentricity e, every vertex w
+// at distance d has max(d, e - d) <= ecc(w) <= e + d, and ecc(w) is also
+// bounded by the size of its component. All the eccentricities (all == true)
+// are found by the bounding-diameters algorithm of Takes and Kosters, which
+// chooses the sources alternately as the vertex with largest upper and
+// smallest lower bound (preferring higher degrees), until all bounds meet.
+//
+// The diameter alone is found by the iFUB algorithm of Crescenzi et al.: a
+// BFS from a central vertex u, found by a double sweep, puts the vertices in
+// levels, and the eccentricities of the fringe levels are computed from the
+// outermost inwards, until the diameter found is at least twice the remaining
+// depth, which bounds the distances between the vertices of the inner levels.
+// The vertices whose upper bound does not exceed the diameter found so far
+// are skipped, and so are the components that are too small. Large levels are
+// searched 64 sources at a time, with the multi-source BFS, spread among the
+// threads.
+//
+// The bounds rely on the symmetry of the distances, so that for directed
+// graphs a BFS is done from every vertex.
+struct do_exact_diameter
+{
+    template <class Graph, class EccMap>
+    void operator()(const Graph& g, EccMap ecc, bool all, size_t& diam,
+                    size_t& s, size_t& t, size_t& n_bfs) const
+    {
+        constexpr size_t inf = numeric_limits<size_t>::max();
+        size_t N = num_vertices(g);
+        bool directed = graph_tool::is_directed(g);
+
+        vector<size_t> lower(N, 0), upper(N, inf), dist(N, inf), pred;
+        vector<size_t> vs, reached;
+        for (auto v : vertices_range(g))
+            vs.push_back(v);
+
+        diam = n_bfs = 0;
+        s = t = vs.empty() ? 0 : vs.front();
+
+        auto deg = [&](size_t v) { return total_degreeS()(vertex(v, g), g); };
+
+        parallel_bfs bfs;
+
+        // BFS from v, which updates the bounds and the diameter, and leaves
+        // the distances in dist (and the search tree in pred, if requested)
+        // until the next one. Returns the eccentricity of v and the farthest
+        // vertex.
+        auto search = [&](size_t v, bool tree)
+            {
+                parallel_loop(reached, [&](size_t, size_t w) { dist[w] = inf; });
+                reached.clear();
+                reached.push_back(v);
+                dist[v] = 0;
+                if (tree)
+                {
+                    pred.resize(N);
+                    pred[v] = v;
+                }
+                size_t e = 0, far = v;
+                bfs(g, v,
+                    [&](auto w, auto u, size_t d)
+                    {
+                        dist[w] = d;
+                        if (tree)
+                            pred[w] = u;
+                        reached.push_back(w);
+                        e = d;
+                        far = w;
+                        return false;
+                    });
+                ++n_bfs;
+
+                if (!directed)
+                {
+                    parallel_loop
+                        (reached,
+                         [&](size_t, size_t w)
+                         {
+                             size_t d = dist[w];
+                             lower[w] = std::max(lower[w], std::max(d, e - d));
+                             upper[w] = std::min(upper[w], e + d);
+                         });
+                }
+                lower[v] = upper[v] = e;
+
+                if (e > diam)
+                {
+                    diam = e;
+                    s = v;
+                    t = far;
+                }
+                return make_pair(e, far);
+            };
+
+        vector<size_t> comp_size;
+        vector<size_t> hub(N, inf); // vertex of largest degree, per component
+        vector<size_t> roots;
+        if (!directed)
+        {
+            concurrent_union_find uf(N);
+            parallel_edge_loop
+                (g,
+                 [&](const auto& e)
+                 {
+                     uf.unite(source(e, g), target(e, g));
+                 });
+            comp_size.resize(N, 0);
+            for (auto v : vs)
+            {
+                size_t r = uf.find(v);
+                ++comp_size[r];
+                if (hub[r] == inf)
+                    roots.push_back(r);
+                if (hub[r] == inf || deg(v) > deg(hub[r]))
+                    hub[r] = v;
+            }
+            for (auto v : vs)
+            {
+                upper[v] = comp_size[uf.find(v)] - 1;
+                lower[v] = std::min(upper[v], size_t(1));
+            }
+        }
+
+        if (!all && !directed)
+        {
+            std::sort(roots.begin(), roots.end(),
+                      [&](size_t a, size_t b)
+                      { return comp_size[a] > comp_size[b]; });
+
+            vector<vector<size_t>> levels;
+            vector<size_t> level, far;
+            for (auto r : roots)
+            {
+                if (comp_size[r] - 1 <= diam)
+                    break;
+
+                // double sweep, and the vertex in the middle of the path
+                size_t a = search(hub[r], false).second;
+                auto eb = search(a, true);
+                size_t u = eb.second;
+                for (size_t i = 0; i < eb.first / 2; ++i)
+                    u = pred[u];
+
+                size_t eu = search(u, false).first;
+                levels.clear();
+                levels.resize(eu + 1);
+                for (auto w : reached)
+                    levels[dist[w]].push_back(w);
+
+                for (size_t i = eu; i > 0 && diam < 2 * i; --i)
+                {
+                    level.clear();
+                    for (auto w : levels[i])
+                    {
+                        if (upper[w] > diam)
+                            level.push_back(w);
+                    }
+
+                    if (level.size() < multi_source_bfs<>::width)
+                    {
+                        for (auto w : level)
+                        {
+                            if (upper[w] > diam)
+                                search(w, false);
+                        }
+                        continue;
+                    }
+
+                    // many sources at once, by bit-parallel searches
+                    far.resize(N);
+                    for (auto w : level)
+                    {
+                        lower[w] = 0;
+                        far[w] = w;
+                    }
+                    parallel_multi_source_bfs
+                        (g, level,
+                         [&](size_t w, auto x, size_t d)
+                         {
+                             if (d > lower[w])
+                             {
+                                 lower[w] = d;
+                                 far[w] = x;
+                             }
+                         });
+                    n_bfs += level.size();
+                    for (auto w : level)
+                    {
+                        upper[w] = lower[w];
+                        if (lower[w] > diam)
+                        {
+                            diam = lower[w];
+                            s = w;
+                            t = far[w];
+                        }
+                    }
+                }
+            }
+            return;
+        }
+
+        auto& cands = vs;
+        bool pick_upper = false;
+        size_t v = s;
+        for (auto u : cands)
+        {
+            if (deg(u) > deg(v))
+                v = u;
+        }
+
+        while (!cands.empty())
+        {
+            search(v, false);
+
+            size_t M = 0;
+            for (auto w : cands)
+            {
+                if (lower[w] == upper[w])
+                    continue;
+                cands[M++] = w;
+            }
+            cands.resize(M);
+            if (cands.empty())
+                break;
+
+            pick_upper = !pick_upper;
+            if (directed)
+            {
+                v = cands.back();
+                continue;
+            }
+            v = cands.front();
+            for (auto w : cands)
+            {
+                bool better = pick_upper ?
+                    (upper[w] > upper[v] ||
+                     (upper[w] == upper[v] && deg(w) > deg(v))) :
+                    (lower[w] < lower[v] ||
+                     (lower[w] == lower[v] && deg(w) > deg(v)));
+                if (better)
+                    v = w;
+            }
+        }
+
+        if (all)
+        {
+            parallel_vertex_loop
+                (g,
+                 [&](auto w)
+                 {
+                     ecc[w] = lower[w];
+                 });
+        }
+    }
+};
+
+python::object get_exact_diam(GraphInterface& gi, boost::any ecc)
+{
+    size_t diam = 0, s = 0, t = 0, n_bfs = 0;
+    bool all = !ecc.empty();
+    typedef vprop_map_t<int64_t>::type ecc_t;
+    ecc_t ecc_map = all ? any_cast<ecc_t>(ecc) : ecc_t();
+    run_action<>()
+        (gi,
+         [&](auto& g)
+         {
+             do_exact_diameter()(g, ecc_map.get_unchecked(num_vertices(g)),
+                                 all, diam, s, t, n_bfs);
+         })();
+    return python::make_tuple(diam, s, t, n_bfs);
+}
+
 python::object get_diam(GraphInterface& gi, size_t source, boost::any weight)
 {
     size_t target;
@@ -166,4 +443,5 @@ python::object get_diam(GraphInterface& gi, size_t source, boost::any weight)
 void export_diam()
 {
     python::def("get_diam", &get_diam);
+    python::def("get_exact_diam", &get_exact_diam);
 };
@@ -23,11 +23,14 @@
 #include "numpy_bind.hh"
 #include "hash_map_wrap.hh"
 #include "coroutine.hh"
-#include "graph_python_interface.hh"
+#include "graph_parallel_bfs.hh"
+#include "graph_scratch.hh"
+#include "graph_delta_stepping.hh"
+#include "graph_bellman_ford_parallel.hh"
+#include "graph_bidirectional_search.hh"
+#include "graph_search_workspace.hh"
 
-#include <boost/graph/breadth_first_search.hpp>
 #include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
-#include <boost/graph/bellman_ford_shortest_paths.hpp>
 #include <boost/python/stl_iterator.hpp>
 #include <boost/python.hpp>
 
@@ -41,137 +44,6 @@ using namespace graph_tool;
 
 struct stop_search {};
 
-template <class DistMap, class PredMap>
-class bfs_max_visitor:
-    public boost::bfs_visitor<null_visitor>
-{
-public:
-    bfs_max_visitor(DistMap dist_map, PredMap pred, size_t max_dist,
-                    size_t source, size_t target, std::vector<size_t>& reached)
-        : _dist_map(dist_map), _pred(pred), _max_dist(max_dist),
-          _source(source), _target(target), _dist(0), _reached(reached) {}
-
-    ~bfs_max_visitor()
-    {
-        typedef typename property_traits<DistMap>::value_type dist_t;
-        constexpr dist_t inf = std::is_floating_point<dist_t>::value ?
-            numeric_limits<dist_t>::infinity() :
-            numeric_limits<dist_t>::max();
-        for (auto v : _unreached)
-            _dist_map[v] = inf;
-    }
-
-    template <class Graph>
-    void tree_edge(typename graph_traits<Graph>::edge_descriptor e,
-                   Graph& g)
-    {
-        _pred[target(e,g)] = source(e,g);
-    }
-
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                        Graph&)
-    {
-        if ( _dist_map[v] > _max_dist)
-            throw stop_search();
-    }
-
-    template <class Graph>
-    void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                         Graph&)
-    {
-        auto p = _pred[v];
-        if (size_t(p) == v)
-            return;
-        _dist_map[v] = _dist_map[p] + 1;
-        _reached.push_back(v);
-        if (_dist_map[v] > _max_dist)
-            _unreached.push_back(v);
-        if (v == _target)
-            throw stop_search();
-    }
-
-private:
-    DistMap _dist_map;
-    PredMap _pred;
-    typename property_traits<DistMap>::value_type _max_dist;
-    size_t _source;
-    size_t _target;
-    size_t _dist;
-    std::vector<size_t> _unreached;
-    std::vector<size_t>& _reached;
-};
-
-template <class DistMap, class PredMap>
-class bfs_max_multiple_targets_visitor:
-    public boost::bfs_visitor<null_visitor>
-{
-public:
-    bfs_max_multiple_targets_visitor(DistMap dist_map, PredMap pred,
-                                     size_t max_dist, size_t source,
-                                     gt_hash_set<std::size_t> target,
-                                     std::vector<size_t>& reached)
-        : _dist_map(dist_map), _pred(pred), _max_dist(max_dist),
-          _source(source), _target(target), _dist(0), _reached(reached) {}
-
-    ~bfs_max_multiple_targets_visitor()
-    {
-        typedef typename property_traits<DistMap>::value_type dist_t;
-        constexpr dist_t inf = std::is_floating_point<dist_t>::value ?
-            numeric_limits<dist_t>::infinity() :
-            numeric_limits<dist_t>::max();
-        for (auto v : _unreached)
-            _dist_map[v] = inf;
-    }
-
-    template <class Graph>
-    void tree_edge(typename graph_traits<Graph>::edge_descriptor e,
-                   Graph& g)
-    {
-        _pred[target(e,g)] = source(e,g);
-    }
-
-    template <class Graph>
-    void examine_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                        Graph&)
-    {
-        if ( _dist_map[v] > _max_dist)
-            throw stop_search();
-    }
-
-    template <class Graph>
-    void discover_vertex(typename graph_traits<Graph>::vertex_descriptor v,
-                         Graph&)
-    {
-        auto p = _pred[v];
-        if (size_t(p) == v)
-            return;
-        _dist_map[v] = _dist_map[p] + 1;
-
-        if (_dist_map[v] > _max_dist)
-            _unreached.push_back(v);
-
-        auto iter = _target.find(v);
-        if (iter != _target.end())
-        {
-            _target.erase(iter);
-            if (_target.empty())
-                throw stop_search();
-        };
-    }
-
-private:
-    DistMap _dist_map;
-    PredMap _pred;
-    typename property_traits<DistMap>::value_type _max_dist;
-    size_t _source;
-    gt_hash_set<std::size_t> _target;
-    size_t _dist;
-    std::vector<size_t> _unreached;
-    std::vector<size_t>& _reached;
-};
-
-
 template <class DistMap>
 class djk_max_visitor:
     public boost::dijkstra_visitor<null_visitor>
@@ -187,14 +59,14 @@ public:
     ~djk_max_visitor()
     {
         for (auto v : _unreached)
-            _dist_map[v] = _inf;
+            put(_dist_map, v, _inf);
     }
 
     template <class Graph>
     void examine_vertex(typename graph_traits<Graph>::vertex_descriptor u,
                         Graph&)
     {
-        if (_dist_map[u] > _max_dist)
+        if (get(_dist_map, u) > _max_dist)
             throw stop_search();
 
         if (u == _target)
@@ -205,7 +77,7 @@ public:
     void discover_vertex(typename graph_traits<Graph>::vertex_descriptor u,
                          Graph&)
     {
-        if (_dist_map[u] > _max_dist)
+        if (get(_dist_map, u) > _max_dist)
             _unreached.push_back(u);
         _reached.push_back(u);
     }
@@ -236,14 +108,14 @@ public:
     ~djk_max_multiple_targets_visitor()
     {
         for (auto v : _unreached)
-            _dist_map[v] = _inf;
+            put(_dist_map, v, _inf);
     }
 
     template <class Graph>
     void examine_vertex(typename graph_traits<Graph>::vertex_descriptor u,
                         Graph&)
     {
-        if (_dist_map[u] > _max_dist)
+        if (get(_dist_map, u) > _max_dist)
             throw stop_search();
 
         auto iter = _target.find(u);
@@ -259,7 +131,7 @@ public:
     void discover_vertex(typename graph_traits<Graph>::vertex_descriptor u,
                          Graph&)
     {
-        if (_dist_map[u] > _max_dist)
+        if (get(_dist_map, u) > _max_dist)
             _unreached.push_back(u);
         _reached.push_back(u);
     }
@@ -277,14 +149,13 @@ struct do_bfs_search
 {
     template <class Graph, class VertexIndexMap, class DistMap, class PredMap>
     void operator()(const Graph& g, size_t source,
-                    boost::python::object otarget_list,
-                    VertexIndexMap vertex_index, DistMap dist_map,
+                    const boost::multi_array_ref<int64_t, 1>& target_list,
+                    VertexIndexMap, DistMap dist_map,
                     PredMap pred_map, long double max_dist,
                     std::vector<size_t>& reached) const
     {
         typedef typename property_traits<DistMap>::value_type dist_t;
 
-        auto target_list = get_array<int64_t, 1>(otarget_list);
         gt_hash_set<std::size_t> tgt(target_list.begin(),
                                      target_list.end());
 
@@ -292,38 +163,49 @@ struct do_bfs_search
             numeric_limits<dist_t>::infinity() :
             numeric_limits<dist_t>::max();
 
-        dist_t max_d = (max_dist > 0) ? max_dist : inf;
+        // only the vertices up to distance max_dist are examined; their
+        // neighbors are still discovered, but their distances are left at
+        // infinity
+        size_t max_level = numeric_limits<size_t>::max();
+        if (max_dist > 0 && max_dist < max_level)
+            max_level = max_dist;
 
         dist_map[source] = 0;
 
-        unchecked_vector_property_map<boost::default_color_type, VertexIndexMap>
-        color_map(vertex_index, num_vertices(g));
-        try
+        // the search buffers are reused between calls on the same thread
+        auto bfs_buf = get_scratch<parallel_bfs>();
+        auto& bfs = *bfs_buf;
+        if (tgt.size() <= 1)
         {
-            if (tgt.size() <= 1)
-            {
-                size_t target = tgt.empty() ?
-                    graph_traits<GraphInterface::multigraph_t>::null_vertex() :
-                    *tgt.begin();
-                breadth_first_visit(g, vertex(source, g),
-                                    visitor(bfs_max_visitor<DistMap, PredMap>
-                                            (dist_map, pred_map, max_d,
-                                             source, target, reached)).
-                                    vertex_index_map(vertex_index).
-                                    color_map(color_map));
-            }
-            else
-            {
-                breadth_first_visit(g, vertex(source, g),
-                                    visitor(bfs_max_multiple_targets_visitor<DistMap, PredMap>
-                                            (dist_map, pred_map, max_d,
-                                             source, tgt, reached)).
-                                    vertex_index_map(vertex_index).
-                                    color_map(color_map));
-            }
-
+            size_t target = tgt.empty() ?
+                graph_traits<GraphInterface::multigraph_t>::null_vertex() :
+                *tgt.begin();
+            bfs(g, source,
+                [&](auto v, auto u, size_t d)
+                {
+                    pred_map[v] = u;
+                    dist_map[v] = (d > max_level) ? inf : dist_t(d);
+                    reached.push_back(v);
+                    return size_t(v) == target;
+                }, max_level);
+        }
+        else
+        {
+            bfs(g, source,
+                [&](auto v, auto u, size_t d)
+                {
+                    pred_map[v] = u;
+                    dist_map[v] = (d > max_level) ? inf : dist_t(d);
+                    auto iter = tgt.find(v);
+                    if (iter != tgt.end())
+                    {
+                        tgt.erase(iter);
+                        if (tgt.empty())
+                            return true;
+                    }
+                    return false;
+                }, max_level);
         }
-        catch (stop_search&) {}
     }
 };
 
@@ -332,13 +214,11 @@ struct do_djk_search
     template <class Graph, class VertexIndexMap, class DistMap, class PredMap,
               class WeightMap>
     void operator()(const Graph& g, size_t source,
-                    boost::python::object otarget_list,
+                    const boost::multi_array_ref<int64_t, 1>& target_list,
                     VertexIndexMap vertex_index, DistMap dist_map,
                     PredMap pred_map, WeightMap weight, long double max_dist,
                     std::vector<size_t>& reached) const
     {
-        auto target_list = get_array<int64_t, 1>(otarget_list);
-
         typedef typename property_traits<DistMap>::value_type dist_t;
 
         constexpr dist_t inf = (std::is_floating_point<dist_t>::value) ?
@@ -350,7 +230,7 @@ struct do_djk_search
         gt_hash_set<std::size_t> tgt(target_list.begin(),
                                      target_list.end());
 
-        dist_map[source] = 0;
+        put(dist_map, source, 0);
 
         try
         {
@@ -383,45 +263,77 @@ struct do_djk_search
     }
 };
 
+struct do_delta_search
+{
+    template <class Graph, class DistMap, class PredMap, class WeightMap>
+    void operator()(const Graph& g, size_t source,
+                    const boost::multi_array_ref<int64_t, 1>& target_list,
+                    DistMap dist_map,
+                    PredMap pred_map, WeightMap weight, long double max_dist,
+                    long double delta, std::vector<size_t>& reached) const
+    {
+        typedef typename property_traits<DistMap>::value_type dist_t;
+
+        constexpr dist_t inf = (std::is_floating_point<dist_t>::value) ?
+            numeric_limits<dist_t>::infinity() :
+            numeric_limits<dist_t>::max();
+
+        dist_t max_d = (max_dist > 0) ? max_dist : inf;
+
+        std::vector<size_t> tgt(target_list.begin(), target_list.end());
+
+        if (delta <= 0)
+            delta = delta_stepping::get_delta(g, weight);
+
+        delta_stepping sssp;
+        sssp(g, source, dist_map, pred_map, weight, delta, max_d, inf, tgt,
+             reached);
+    }
+};
+
 struct do_bf_search
 {
     template <class Graph, class DistMap, class PredMap, class WeightMap>
     void operator()(const Graph& g, size_t source, DistMap dist_map,
                     PredMap pred_map, WeightMap weight) const
     {
-        bool ret = bellman_ford_shortest_paths(g, root_vertex(source).
-                                               predecessor_map(pred_map).
-                                               distance_map(dist_map).
-                                               weight_map(weight));
-        if (!ret)
-            throw ValueException("Graph contains negative loops");
+        typedef typename property_traits<DistMap>::value_type dist_t;
 
         // consistency with dijkstra
-        typedef typename property_traits<DistMap>::value_type dist_t;
-        if (std::is_floating_point<dist_t>::value)
-        {
-            for (auto v : vertices_range(g))
-            {
-                if (dist_map[v] == numeric_limits<dist_t>::max())
-                    dist_map[v] = numeric_limits<dist_t>::infinity();
-            }
-        }
+        constexpr dist_t inf = (std::is_floating_point<dist_t>::value) ?
+            numeric_limits<dist_t>::infinity() :
+            numeric_limits<dist_t>::max();
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 dist_map[v] = inf;
+                 pred_map[v] = v;
+             });
+        dist_map[source] = 0;
+
+        parallel_bellman_ford sssp;
+        if (!sssp(g, {source}, dist_map, pred_map, weight))
+            throw ValueException("Graph contains negative loops");
     }
 };
 
 void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
                boost::any dist_map, boost::any weight, boost::any pred_map,
-               long double max_dist, bool bf, std::vector<size_t>& reached)
+               long double max_dist, bool bf, long double delta,
+               std::vector<size_t>& reached)
 {
     typedef property_map_type
         ::apply<int64_t, GraphInterface::vertex_index_map_t>::type pred_map_t;
 
     pred_map_t pmap = any_cast<pred_map_t>(pred_map);
+    auto target_list = get_array<int64_t, 1>(tgt);
 
     if (weight.empty())
     {
-        run_action<>()
-            (gi, std::bind(do_bfs_search(), std::placeholders::_1, source, tgt, gi.get_vertex_index(),
+        run_action<>(true)
+            (gi, std::bind(do_bfs_search(), std::placeholders::_1, source, std::cref(target_list), gi.get_vertex_index(),
                            std::placeholders::_2, pmap.get_unchecked(num_vertices(gi.get_graph())),
                            max_dist, std::ref(reached)),
              writable_vertex_scalar_properties())
@@ -431,7 +343,7 @@ void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
     {
         if (bf)
         {
-            run_action<>()
+            run_action<>(true)
                 (gi, std::bind(do_bf_search(), std::placeholders::_1, source,
                                std::placeholders::_2, pmap.get_unchecked(num_vertices(gi.get_graph())),
                                std::placeholders::_3),
@@ -439,10 +351,20 @@ void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
                  edge_scalar_properties())
                 (dist_map, weight);
         }
+        else if (delta >= 0)
+        {
+            run_action<>(true)
+                (gi, std::bind(do_delta_search(), std::placeholders::_1, source, std::cref(target_list),
+                               std::placeholders::_2, pmap.get_unchecked(num_vertices(gi.get_graph())),
+                               std::placeholders::_3, max_dist, delta, std::ref(reached)),
+                 writable_vertex_scalar_properties(),
+                 edge_scalar_properties())
+                (dist_map, weight);
+        }
         else
         {
-            run_action<>()
-                (gi, std::bind(do_djk_search(), std::placeholders::_1, source, tgt, gi.get_vertex_index(),
+            run_action<>(true)
+                (gi, std::bind(do_djk_search(), std::placeholders::_1, source, std::cref(target_list), gi.get_vertex_index(),
                                std::placeholders::_2, pmap.get_unchecked(num_vertices(gi.get_graph())),
                                std::placeholders::_3, max_dist, std::ref(reached)),
                  writable_vertex_scalar_properties(),
@@ -452,6 +374,128 @@ void get_dists(GraphInterface& gi, size_t source, boost::python::object tgt,
     }
 }
 
+// single-source BFS with the distances and predecessors kept in a reusable
+// workspace; this is sequential, since the point is to make searches that only
+// explore a small part of a large graph cheap
+struct do_bfs_search_ws
+{
+    template <class Graph, class DistMap, class PredMap>
+    void operator()(const Graph& g, size_t source,
+                    const boost::multi_array_ref<int64_t, 1>& target_list,
+                    DistMap dist_map,
+                    PredMap pred_map, long double max_dist) const
+    {
+        typedef typename property_traits<DistMap>::value_type dist_t;
+
+        gt_hash_set<std::size_t> tgt(target_list.begin(),
+                                     target_list.end());
+
+        size_t max_level = numeric_limits<size_t>::max();
+        if (max_dist > 0 && max_dist < max_level)
+            max_level = max_dist;
+
+        dist_t inf = numeric_limits<dist_t>::max();
+
+        std::vector<size_t> queue = {source};
+        put(dist_map, source, 0);
+        if (tgt.erase(source) > 0 && tgt.empty())
+            return;
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            auto u = vertex(queue[i], g);
+            size_t d = get(dist_map, u) + 1;
+            if (d > max_level)
+                break;
+            for (auto w : out_neighbors_range(u, g))
+            {
+                if (get(dist_map, w) != inf)
+                    continue;
+                put(dist_map, w, dist_t(d));
+                put(pred_map, w, u);
+                queue.push_back(w);
+                auto iter = tgt.find(w);
+                if (iter != tgt.end())
+                {
+                    tgt.erase(iter);
+                    if (tgt.empty())
+                        return;
+                }
+            }
+        }
+    }
+};
+
+void get_dists_ws(GraphInterface& gi, size_t source, boost::python::object tgt,
+                  boost::any weight, long double max_dist, SearchWorkspace& ws)
+{
+    ws.start(gi.get_num_vertices(false));
+    auto target_list = get_array<int64_t, 1>(tgt);
+    if (weight.empty())
+    {
+        auto dist = ws.get_dist_map<int32_t>(numeric_limits<int32_t>::max());
+        auto pred = ws.get_pred_map();
+        run_action<>()
+            (gi, [&](auto& g)
+             {
+                 do_bfs_search_ws()(g, source, target_list, dist, pred, max_dist);
+             })();
+    }
+    else
+    {
+        run_action<>()
+            (gi, [&](auto& g, auto w)
+             {
+                 typedef typename property_traits<decltype(w)>::value_type
+                     dist_t;
+                 dist_t inf = (std::is_floating_point<dist_t>::value) ?
+                     numeric_limits<dist_t>::infinity() :
+                     numeric_limits<dist_t>::max();
+                 auto dist = ws.get_dist_map<dist_t>(inf);
+                 auto pred = ws.get_pred_map();
+                 std::vector<size_t> reached;
+                 do_djk_search()(g, source, target_list, gi.get_vertex_index(), dist,
+                                 pred, w, max_dist, reached);
+             }, edge_scalar_properties())(weight);
+    }
+}
+
+// point-to-point distance, via a bidirectional search
+python::object get_point_dist(GraphInterface& gi, size_t source, size_t target,
+                              boost::any weight, bool get_path)
+{
+    bool reached = false;
+    python::object dist;
+    vector<size_t> path;
+
+    if (weight.empty())
+    {
+        run_action<>()
+            (gi, [&](auto& g)
+             {
+                 bidirectional_search<size_t> search;
+                 size_t d = search.bfs(g, source, target,
+                                       get_path ? &path : nullptr);
+                 reached = (d != search.inf);
+                 dist = python::object(d);
+             })();
+    }
+    else
+    {
+        run_action<>()
+            (gi, [&](auto& g, auto w)
+             {
+                 typedef typename property_traits<decltype(w)>::value_type
+                     dist_t;
+                 bidirectional_search<dist_t> search;
+                 dist_t d = search.dijkstra(g, source, target, w,
+                                            get_path ? &path : nullptr);
+                 reached = (d != search.inf);
+                 dist = python::object(d);
+             }, edge_scalar_properties())(weight);
+    }
+    return python::make_tuple(reached, dist, wrap_vector_owned(path));
+}
+
 template <class Graph, class Dist, class Pred, class Weight, class Preds>
 void get_all_preds(Graph g, Dist dist, Pred pred, Weight weight, Preds preds,
                    long double epsilon)
@@ -634,6 +678,8 @@ python::object do_get_all_paths(GraphInterface& gi, size_t s, size_t t,
 void export_dists()
 {
     python::def("get_dists", &get_dists);
+    python::def("get_dists_ws", &get_dists_ws);
+    python::def("get_point_dist", &get_point_dist);
     python::def("get_all_preds", &do_get_all_preds);
     python::def("get_all_shortest_paths", &do_get_all_shortest_paths);
     python::def("get_all_paths", &do_get_all_paths);
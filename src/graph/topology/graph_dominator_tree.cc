@@ -18,8 +18,9 @@
 #include "graph_filtering.hh"
 #include "graph.hh"
 #include "graph_properties.hh"
+#include "numpy_bind.hh"
 
-#include <boost/graph/dominator_tree.hpp>
+#include "graph_dominator_tree.hh"
 
 using namespace std;
 using namespace boost;
@@ -30,7 +31,11 @@ struct get_dominator_tree
     template <class Graph, class PredMap>
     void operator()(const Graph& g, size_t entry, PredMap pred_map) const
     {
-        lengauer_tarjan_dominator_tree(g, vertex(entry,g), pred_map);
+        dominator_adj_t adj;
+        adj.build(g);
+        dominator_state_t state;
+        state.run(adj, entry,
+                  [&](size_t v, size_t d) { pred_map[v] = d; });
     }
 };
 
@@ -41,8 +46,45 @@ typedef property_map_types::apply<mpl::vector<int32_t>,
 
 void dominator_tree(GraphInterface& gi, size_t entry, boost::any pred_map)
 {
-    run_action<graph_tool::detail::always_directed>()
+    run_action<graph_tool::detail::always_directed>(true)
         (gi, std::bind(get_dominator_tree(), std::placeholders::_1, entry,
                        std::placeholders::_2),
          pred_properties())(pred_map);
 }
+
+// Dominator trees of many graphs at once, in parallel. Graph i has the
+// vertices [voffset[i], voffset[i+1]) and the edges [eoffset[i], eoffset[i+1])
+// of the arrays, with vertices indexed locally from zero.
+void dominator_tree_batch(python::object oedges, python::object oeoffset,
+                          python::object ovoffset, python::object oroots,
+                          python::object odom)
+{
+    multi_array_ref<int64_t,2> edges = get_array<int64_t,2>(oedges);
+    multi_array_ref<int64_t,1> eoffset = get_array<int64_t,1>(oeoffset);
+    multi_array_ref<int64_t,1> voffset = get_array<int64_t,1>(ovoffset);
+    multi_array_ref<int64_t,1> roots = get_array<int64_t,1>(oroots);
+    multi_array_ref<int32_t,1> dom = get_array<int32_t,1>(odom);
+
+    GILRelease gil_release;
+
+    size_t B = roots.shape()[0];
+    #pragma omp parallel if (B > 1)
+    {
+        dominator_adj_t adj;
+        dominator_state_t state;
+
+        // the graphs may have very different sizes
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t i = 0; i < B; ++i)
+        {
+            size_t N = voffset[i + 1] - voffset[i];
+            if (N == 0)
+                continue;
+            auto d = dom.data() + voffset[i];
+            std::fill(d, d + N, -1);
+            adj.build(N, edges, eoffset[i], eoffset[i + 1]);
+            state.run(adj, roots[i],
+                      [&](size_t v, size_t u) { d[v] = u; });
+        }
+    }
+}
@@ -0,0 +1,226 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_DOMINATOR_TREE_HH
+#define GRAPH_DOMINATOR_TREE_HH
+
+#include <algorithm>
+#include <vector>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Dominator tree with the Semi-NCA algorithm
+// ==========================================
+//
+// The semidominators are computed as in the algorithm of Lengauer and Tarjan,
+// with path compression but without balancing, and the immediate dominators
+// are then obtained from them with a single pass in DFS order, as the nearest
+// common ancestor of the semidominator and the DFS parent [Georgiadis,
+// Tarjan and Werneck, "Finding dominators in practice", JGAA 10 (2006)].
+//
+// Everything is done over flat arrays indexed by the DFS number, without
+// recursion (the DFS and the path compression use explicit stacks), so that
+// deep graphs cannot overflow the call stack. The workspace can be reused
+// between graphs, which is how many small graphs are processed in parallel.
+
+// Out- and in-neighbors in compressed form, over the vertices [0, N)
+class dominator_adj_t
+{
+public:
+    template <class Graph>
+    void build(const Graph& g)
+    {
+        _N = num_vertices(g);
+        _out_offset.assign(_N + 1, 0);
+        _in_offset.assign(_N + 1, 0);
+        for (auto e : edges_range(g))
+        {
+            _out_offset[source(e, g) + 1]++;
+            _in_offset[target(e, g) + 1]++;
+        }
+        fill([&](auto&& f)
+             {
+                 for (auto e : edges_range(g))
+                     f(source(e, g), target(e, g));
+             });
+    }
+
+    // the edges (s, t) are the pairs edges[i] for i in [begin, end)
+    template <class Edges>
+    void build(size_t N, const Edges& edges, size_t begin, size_t end)
+    {
+        _N = N;
+        _out_offset.assign(_N + 1, 0);
+        _in_offset.assign(_N + 1, 0);
+        for (size_t i = begin; i < end; ++i)
+        {
+            _out_offset[edges[i][0] + 1]++;
+            _in_offset[edges[i][1] + 1]++;
+        }
+        fill([&](auto&& f)
+             {
+                 for (size_t i = begin; i < end; ++i)
+                     f(edges[i][0], edges[i][1]);
+             });
+    }
+
+    size_t size() const { return _N; }
+
+    size_t out_begin(size_t v) const { return _out_offset[v]; }
+    size_t out_end(size_t v) const { return _out_offset[v + 1]; }
+    size_t get_out(size_t pos) const { return _out[pos]; }
+
+    size_t in_begin(size_t v) const { return _in_offset[v]; }
+    size_t in_end(size_t v) const { return _in_offset[v + 1]; }
+    size_t get_in(size_t pos) const { return _in[pos]; }
+
+private:
+    // counting sort of the edges, given the degrees in the offset arrays
+    template <class Iter>
+    void fill(Iter&& iter_edges)
+    {
+        std::partial_sum(_out_offset.begin(), _out_offset.end(),
+                         _out_offset.begin());
+        std::partial_sum(_in_offset.begin(), _in_offset.end(),
+                         _in_offset.begin());
+        _out.resize(_out_offset.back());
+        _in.resize(_in_offset.back());
+        _out_pos.assign(_out_offset.begin(), _out_offset.end() - 1);
+        _in_pos.assign(_in_offset.begin(), _in_offset.end() - 1);
+        iter_edges([&](size_t s, size_t t)
+                   {
+                       _out[_out_pos[s]++] = t;
+                       _in[_in_pos[t]++] = s;
+                   });
+    }
+
+    size_t _N = 0;
+    vector<size_t> _out_offset, _out, _in_offset, _in;
+    vector<size_t> _out_pos, _in_pos;
+};
+
+class dominator_state_t
+{
+public:
+    // Calls f(v, d) with the immediate dominator d of every vertex v that is
+    // reachable from the root (other than the root itself).
+    template <class F>
+    void run(const dominator_adj_t& adj, size_t root, F&& f)
+    {
+        constexpr size_t null = numeric_limits<size_t>::max();
+        size_t N = adj.size();
+
+        // iterative DFS, numbering the vertices in preorder
+        _dfnum.assign(N, null);
+        _order.clear();
+        _parent.clear();
+        _dfnum[root] = 0;
+        _order.push_back(root);
+        _parent.push_back(0);
+        _stack.clear();
+        _stack.emplace_back(root, adj.out_begin(root));
+        while (!_stack.empty())
+        {
+            auto& top = _stack.back();
+            size_t v = top.first;
+            if (top.second == adj.out_end(v))
+            {
+                _stack.pop_back();
+                continue;
+            }
+            size_t w = adj.get_out(top.second++);
+            if (_dfnum[w] != null)
+                continue;
+            _dfnum[w] = _order.size();
+            _order.push_back(w);
+            _parent.push_back(_dfnum[v]);
+            _stack.emplace_back(w, adj.out_begin(w));
+        }
+
+        // semidominators, in reverse preorder
+        size_t n = _order.size();
+        _semi.resize(n);
+        _label.resize(n);
+        _ancestor.assign(n, null);
+        for (size_t i = 0; i < n; ++i)
+            _semi[i] = _label[i] = i;
+        for (size_t i = n - 1; i > 0; --i)
+        {
+            size_t w = _order[i];
+            for (size_t pos = adj.in_begin(w); pos < adj.in_end(w); ++pos)
+            {
+                size_t j = _dfnum[adj.get_in(pos)];
+                if (j == null)
+                    continue;
+                _semi[i] = std::min(_semi[i], _semi[eval(j)]);
+            }
+            _ancestor[i] = _parent[i];
+        }
+
+        // immediate dominators, in preorder
+        _idom.resize(n);
+        _idom[0] = 0;
+        for (size_t i = 1; i < n; ++i)
+        {
+            size_t d = _parent[i];
+            while (d > _semi[i])
+                d = _idom[d];
+            _idom[i] = d;
+            f(_order[i], _order[d]);
+        }
+    }
+
+private:
+    size_t eval(size_t v)
+    {
+        constexpr size_t null = numeric_limits<size_t>::max();
+        if (_ancestor[v] == null)
+            return v;
+
+        // path compression, from the top of the path downwards
+        _cstack.clear();
+        size_t x = v;
+        while (_ancestor[_ancestor[x]] != null)
+        {
+            _cstack.push_back(x);
+            x = _ancestor[x];
+        }
+        while (!_cstack.empty())
+        {
+            size_t y = _cstack.back();
+            _cstack.pop_back();
+            size_t a = _ancestor[y];
+            if (_semi[_label[a]] < _semi[_label[y]])
+                _label[y] = _label[a];
+            _ancestor[y] = _ancestor[a];
+        }
+        return _label[v];
+    }
+
+    vector<size_t> _dfnum, _order, _parent, _semi, _label, _ancestor, _idom;
+    vector<pair<size_t, size_t>> _stack;
+    vector<size_t> _cstack;
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_DOMINATOR_TREE_HH
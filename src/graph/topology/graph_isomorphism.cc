@@ -17,8 +17,10 @@
 
 #include "graph.hh"
 #include "graph_filtering.hh"
+#include "graph_wl_hash.hh"
 
 #include <boost/graph/isomorphism.hpp>
+#include <boost/python.hpp>
 
 using namespace graph_tool;
 using namespace boost;
@@ -112,3 +114,22 @@ bool check_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
 
     return result;
 }
+
+// Refines the colors in place, and returns the graph hash and the number of
+// iterations
+python::tuple wl_hash(GraphInterface& gi, boost::any acolor, size_t max_iter)
+{
+    typedef vprop_map_t<int64_t>::type color_t;
+    auto color = any_cast<color_t>(acolor);
+
+    std::pair<uint64_t, size_t> ret;
+    gt_dispatch<>(true)
+        ([&](auto& g)
+         {
+             ret = wl_refine(g, color.get_unchecked(num_vertices(g)),
+                             max_iter);
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+    return python::make_tuple(ret.first, ret.second);
+}
@@ -30,7 +30,7 @@ using namespace graph_tool;
 
 void do_kcore_decomposition(GraphInterface& gi, boost::any prop)
 {
-    gt_dispatch<>()
+    gt_dispatch<>(true)
         ([](auto& g, auto core)
          {
              kcore_decomposition(g, core);
@@ -18,68 +18,229 @@
 #ifndef GRAPH_KCORE_HH
 #define GRAPH_KCORE_HH
 
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <limits>
+
+#include "graph_parallel_traversal.hh"
+
 namespace graph_tool
 {
 using namespace std;
 using namespace boost;
 
-template <class Graph, class CoreMap>
-void kcore_decomposition(Graph& g, CoreMap core_map)
+// Sequential bin-sort algorithm of Batagelj and Zaversnik, with the bins laid
+// out in a single array of vertices sorted by remaining degree, where bin[k] is
+// the position of the first vertex of degree k, and pos[v] is the position of
+// v. A vertex whose degree is reduced is swapped with the first vertex of its
+// bin, which is then moved by one.
+template <class Graph, class CoreMap, class Removed>
+void kcore_decomposition_sequential(Graph& g, CoreMap core_map,
+                                    Removed&& removed)
 {
-    auto vertex_index = get(vertex_index_t(), g);
+    size_t N = num_vertices(g);
+    vector<size_t> deg(N);  // Remaining degree
+    vector<size_t> pos(N);  // Position in vert
+    vector<size_t> vert;    // Vertices sorted by remaining degree
+    vector<size_t> bin;     // Start of each bin (core) in vert
 
-    typedef typename vprop_map_t<size_t>::type::unchecked_t vmap_t;
+    size_t max_deg = 0;
+    for (auto v : vertices_range(g))
+    {
+        deg[v] = degree(v, g);
+        max_deg = std::max(max_deg, deg[v]);
+        vert.push_back(v);
+    }
 
-    vmap_t deg(vertex_index, num_vertices(g));  // Remaining degree
-    vmap_t pos(vertex_index, num_vertices(g));  // Position in bin (core)
+    bin.resize(max_deg + 2, 0);
+    for (auto v : vert)
+        ++bin[deg[v] + 1];
+    for (size_t k = 0; k <= max_deg; ++k)
+        bin[k + 1] += bin[k];
+    {
+        auto next = bin;
+        for (auto v : vertices_range(g))
+        {
+            pos[v] = next[deg[v]]++;
+            vert[pos[v]] = v;
+        }
+    }
 
-    typedef typename graph_traits<Graph>::vertex_descriptor vertex_t;
+    // Proceed from the smallest degree to the largest. For each vertex, check
+    // the neighbors; if any of them have a larger remaining degree, reduce it
+    // by one, and move it to the previous bin.
+    for (size_t i = 0; i < vert.size(); ++i)
+    {
+        auto v = vert[i];
+        size_t k = deg[v];
+        core_map[v] = k;
+        removed(v, i);
+        for (auto u : all_neighbors_range(v, g))
+        {
+            size_t ku = deg[u];
+            if (ku <= k)
+                continue;
+            size_t pw = bin[ku];
+            size_t w = vert[pw];
+            if (w != size_t(u))
+            {
+                size_t pu = pos[u];
+                vert[pu] = w;
+                pos[w] = pu;
+                vert[pw] = u;
+                pos[u] = pw;
+            }
+            ++bin[ku];
+            --deg[u];
+        }
+    }
+}
 
-    vector<vector<vertex_t>> bins; // Each bin stores the set of vertices of
-                                   // a core
+// Parallel peeling: the vertices of the current minimum degree k form a
+// frontier, which is removed in parallel, with the degrees of the neighbors
+// above k decremented atomically (but never below k). The neighbors that reach
+// k are collected in per-thread buffers, and form the next frontier of the
+// same level. When none are left, the remaining vertices are compacted and
+// scanned for the next minimum degree, so that the cost of a level is
+// proportional to the vertices not yet removed. The core numbers are
+// identical to those of the sequential algorithm.
+template <class Graph, class CoreMap, class Removed>
+void kcore_decomposition_parallel(Graph& g, CoreMap core_map, size_t nt,
+                                  Removed&& removed)
+{
+    size_t N = num_vertices(g);
+    std::unique_ptr<std::atomic<size_t>[]> deg(new std::atomic<size_t>[N]);
+    vector<uint8_t> done(N, false);
 
-    // Put each vertex to the bin corresponding to its degree
+    vector<size_t> remaining;
     for (auto v : vertices_range(g))
-    {
-        size_t k = degree(v, g);
-        deg[v] = k;
-        if (k >= bins.size())
-            bins.resize(k + 1);
-        bins[k].push_back(v);
-        pos[v] = bins[k].size() - 1;
-    }
+        remaining.push_back(v);
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             deg[v].store(degree(v, g), std::memory_order_relaxed);
+         });
+
+    vector<vector<size_t>> buf(nt);
+    vector<size_t> min_deg(nt), kept(nt);
+    vector<size_t> frontier;
+    size_t round = 0;
 
-    // Proceed from smallest bin to largest. For each vertex in bin, check
-    // the neighbors; if any of them have a larger remaining degree, reduce
-    // it by one, and put it in the correct bin.
-    for (size_t k = 0; k < bins.size(); ++k)
+    auto gather = [&](size_t k)
+        {
+            frontier.clear();
+            for (size_t t = 0; t < nt; ++t)
+            {
+                if (min_deg[t] == k)
+                    frontier.insert(frontier.end(), buf[t].begin(),
+                                    buf[t].end());
+            }
+        };
+
+    while (!remaining.empty())
     {
-        auto& bins_k = bins[k];
-        while (!bins_k.empty())
+        // Compact the remaining vertices, and find those of minimum degree.
+        size_t M = remaining.size();
+        #pragma omp parallel for num_threads(nt) schedule(static)
+        for (size_t t = 0; t < nt; ++t)
         {
-            auto v = bins_k.back();
-            bins_k.pop_back();
-            core_map[v] = k;
-            for (auto u : all_neighbors_range(v, g))
+            auto& f = buf[t];
+            f.clear();
+            size_t lo = (M * t) / nt, hi = (M * (t + 1)) / nt;
+            size_t j = lo;
+            size_t m = std::numeric_limits<size_t>::max();
+            for (size_t i = lo; i < hi; ++i)
             {
-                auto& ku = deg[u];
-                if (ku > deg[v])
+                size_t v = remaining[i];
+                if (done[v])
+                    continue;
+                remaining[j++] = v;
+                size_t d = deg[v].load(std::memory_order_relaxed);
+                if (d < m)
                 {
-                    auto& bins_ku = bins[ku];
-                    auto w = bins_ku.back();
-                    auto pos_w = pos[w] = pos[u];
-                    bins_ku[pos_w] = w;
-                    bins_ku.pop_back();
-                    --ku;
-                    auto& bins_ku_m = bins[ku];
-                    bins_ku_m.push_back(u);
-                    pos[u] = bins_ku_m.size() - 1;
+                    m = d;
+                    f.clear();
                 }
+                if (d == m)
+                    f.push_back(v);
             }
+            min_deg[t] = m;
+            kept[t] = j - lo;
+        }
+
+        size_t M_new = 0;
+        for (size_t t = 0; t < nt; ++t)
+        {
+            size_t lo = (M * t) / nt;
+            std::copy(remaining.begin() + lo, remaining.begin() + lo + kept[t],
+                      remaining.begin() + M_new);
+            M_new += kept[t];
+        }
+        remaining.resize(M_new);
+        if (remaining.empty())
+            break;
+
+        size_t k = *std::min_element(min_deg.begin(), min_deg.end());
+        gather(k);
+
+        while (!frontier.empty())
+        {
+            size_t F = frontier.size();
+            #pragma omp parallel for num_threads(nt) schedule(static) \
+                if (F > OPENMP_MIN_THRESH)
+            for (size_t t = 0; t < nt; ++t)
+            {
+                auto& f = buf[t];
+                f.clear();
+                size_t lo = (F * t) / nt, hi = (F * (t + 1)) / nt;
+                for (size_t i = lo; i < hi; ++i)
+                {
+                    size_t v = frontier[i];
+                    core_map[v] = k;
+                    done[v] = true;
+                    removed(v, round);
+                    for (auto u : all_neighbors_range(vertex(v, g), g))
+                    {
+                        auto& ku = deg[u];
+                        size_t d = ku.load(std::memory_order_relaxed);
+                        while (d > k && !ku.compare_exchange_weak(d, d - 1));
+                        if (d == k + 1)
+                            f.push_back(u);
+                    }
+                }
+                min_deg[t] = k;
+            }
+            ++round;
+            gather(k);
         }
     }
 }
 
+// The function removed(v, r) is called for every vertex as it is removed,
+// with a rank r that does not decrease along the removal order: its position,
+// in the sequential algorithm, or the index of its frontier, in the parallel
+// one, where it can be called from any thread. This gives the smallest-last
+// order of the vertices, except that in parallel the ties within a frontier
+// are left unresolved.
+template <class Graph, class CoreMap, class Removed>
+void kcore_decomposition(Graph& g, CoreMap core_map, Removed&& removed)
+{
+    size_t nt = get_traversal_threads(num_vertices(g));
+    if (nt > 1)
+        kcore_decomposition_parallel(g, core_map, nt, removed);
+    else
+        kcore_decomposition_sequential(g, core_map, removed);
+}
+
+template <class Graph, class CoreMap>
+void kcore_decomposition(Graph& g, CoreMap core_map)
+{
+    kcore_decomposition(g, core_map, [](size_t, size_t) {});
+}
+
 } // graph_tool namespace
 
 #endif // GRAPH_KCORE_HH
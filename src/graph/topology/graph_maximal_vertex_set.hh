@@ -0,0 +1,130 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_MAXIMAL_VERTEX_SET_HH
+#define GRAPH_MAXIMAL_VERTEX_SET_HH
+
+#include "graph_util.hh"
+#include "graph_parallel_traversal.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// The greedy (lexicographically first) maximal independent set in a random
+// priority order, computed in parallel as in Blelloch, Fineman and Shun: a
+// vertex joins the set as soon as all its neighbors of higher priority are
+// known to be out of it, and it is out as soon as one of them joins. Each
+// vertex is decided exactly once, by an atomic state, and passed on via work
+// stealing to the thread that propagates the decision to its neighbors of
+// lower priority, so that no locks are needed, and the set is the same as the
+// one obtained by the sequential greedy algorithm, regardless of the number of
+// threads. The priorities are given by the degree (with the vertices of
+// smallest degree first, or largest if high_deg is true), and ties are broken
+// randomly.
+struct do_maximal_vertex_set
+{
+    template <class Graph, class VertexSet>
+    void operator()(const Graph& g, VertexSet mvs, bool high_deg,
+                    uint64_t seed) const
+    {
+        size_t N = num_vertices(g);
+        size_t nt = get_traversal_threads(N);
+
+        vector<size_t> deg(N);
+        vector<uint64_t> h(N);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t k = out_degree(v, g);
+                 deg[v] = high_deg ? numeric_limits<size_t>::max() - k : k;
+                 h[v] = random_priority(seed, v);
+             });
+
+        auto before = [&](size_t u, size_t v)
+            {
+                return (deg[u] < deg[v] ||
+                        (deg[u] == deg[v] &&
+                         (h[u] < h[v] || (h[u] == h[v] && u < v))));
+            };
+
+        enum : uint8_t { UNDECIDED = 0, IN, OUT };
+
+        // number of edges to neighbors of higher priority not yet out
+        std::unique_ptr<std::atomic<size_t>[]> count(new std::atomic<size_t>[N]);
+        std::unique_ptr<std::atomic<uint8_t>[]> state(new std::atomic<uint8_t>[N]);
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t c = 0;
+                 for (auto u : out_neighbors_range(v, g))
+                 {
+                     if (before(u, v))
+                         ++c;
+                 }
+                 count[v].store(c, std::memory_order_relaxed);
+                 state[v].store(c == 0 ? IN : UNDECIDED,
+                                std::memory_order_relaxed);
+             });
+
+        vector<size_t> init;
+        for (auto v : vertices_range(g))
+        {
+            if (count[v] == 0)
+                init.push_back(v);
+        }
+
+        work_stealing_loop
+            (init, nt,
+             [&](size_t v, auto& push)
+             {
+                 bool in = state[v] == IN;
+                 for (auto u : out_neighbors_range(vertex(v, g), g))
+                 {
+                     if (size_t(u) == v || before(u, v))
+                         continue;
+                     if (in)
+                     {
+                         uint8_t s = UNDECIDED;
+                         if (state[u].compare_exchange_strong(s, OUT))
+                             push(u);
+                     }
+                     else if (count[u].fetch_sub(1) == 1)
+                     {
+                         // all the higher neighbors are out, so that none of
+                         // them could have marked u
+                         state[u] = IN;
+                         push(u);
+                     }
+                 }
+             });
+
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 mvs[v] = (state[v] == IN);
+             });
+    }
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_MAXIMAL_VERTEX_SET_HH
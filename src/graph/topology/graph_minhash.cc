@@ -0,0 +1,119 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include <boost/python.hpp>
+
+#include "graph_tool.hh"
+#include "graph_minhash.hh"
+#include "graph_vertex_similarity.hh"
+#include "numpy_bind.hh"
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+void get_vertex_minhash(GraphInterface& gi, boost::any label,
+                        python::object osketch, uint64_t seed, size_t bits,
+                        bool self_loop)
+{
+    multi_array_ref<uint64_t,2> sketch = get_array<uint64_t,2>(osketch);
+    minhash_t mh(sketch.shape()[1], seed, bits);
+
+    gt_dispatch<>(true)
+        ([&](auto& g, auto l)
+         {
+             vertex_minhash(g, l, sketch, mh, self_loop);
+         },
+         all_graph_views(), vertex_scalar_properties())
+        (gi.get_graph_view(), label);
+}
+
+void get_graph_minhash(GraphInterface& gi, boost::any label,
+                       python::object osketch, uint64_t seed, size_t bits)
+{
+    multi_array_ref<uint64_t,1> sketch = get_array<uint64_t,1>(osketch);
+    minhash_t mh(sketch.shape()[0], seed, bits);
+
+    gt_dispatch<>(true)
+        ([&](auto& g, auto l)
+         {
+             graph_minhash(g, l, sketch, mh);
+         },
+         all_graph_views(), vertex_scalar_properties())
+        (gi.get_graph_view(), label);
+}
+
+// similarity between two vertices, from their sketches
+template <class Sketch>
+double sketch_sim(const Sketch& sketch, size_t u, size_t v, size_t bits,
+                  bool dice)
+{
+    double j = minhash_jaccard(sketch[u], sketch[v], sketch.shape()[1], bits);
+    return dice ? 2 * j / (1 + j) : j;
+}
+
+void get_minhash_similarity(GraphInterface& gi, string sim_type,
+                            python::object osketch, size_t bits,
+                            boost::any as)
+{
+    multi_array_ref<uint64_t,2> sketch = get_array<uint64_t,2>(osketch);
+    bool dice = (sim_type == "dice");
+
+    gt_dispatch<>(true)
+        ([&](auto& g, auto& s)
+         {
+             all_pairs_similarity(g, s,
+                                  [&](auto u, auto v, auto&)
+                                  {
+                                      return sketch_sim(sketch, u, v, bits,
+                                                        dice);
+                                  });
+         },
+         all_graph_views(), vertex_floating_vector_properties())
+        (gi.get_graph_view(), as);
+}
+
+void get_minhash_similarity_pairs(GraphInterface& gi, string sim_type,
+                                  python::object osketch, size_t bits,
+                                  python::object opairs, python::object osim)
+{
+    multi_array_ref<uint64_t,2> sketch = get_array<uint64_t,2>(osketch);
+    multi_array_ref<int64_t,2> pairs = get_array<int64_t,2>(opairs);
+    multi_array_ref<double,1> sim = get_array<double,1>(osim);
+    bool dice = (sim_type == "dice");
+
+    gt_dispatch<>(true)
+        ([&](auto& g)
+         {
+             some_pairs_similarity(g, pairs, sim,
+                                   [&](auto u, auto v, auto&)
+                                   {
+                                       return sketch_sim(sketch, u, v, bits,
+                                                         dice);
+                                   });
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+}
+
+void export_minhash()
+{
+    python::def("vertex_minhash", &get_vertex_minhash);
+    python::def("graph_minhash", &get_graph_minhash);
+    python::def("minhash_similarity", &get_minhash_similarity);
+    python::def("minhash_similarity_pairs", &get_minhash_similarity_pairs);
+};
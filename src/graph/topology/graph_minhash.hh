@@ -0,0 +1,194 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_MINHASH_HH
+#define GRAPH_MINHASH_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// MinHash sketches
+// ================
+//
+// The sketch of a set X is the vector of the minima of k independent hash
+// functions over its elements, h_i(X) = min_{x in X} h_i(x). The probability
+// that h_i(X) = h_i(Y) is the Jaccard similarity |X & Y| / |X | Y|, which can
+// therefore be estimated in O(k) from the fraction of equal entries. If only
+// the lowest b bits of each entry are kept (b-bit MinHash), the entries of
+// dissimilar sets also collide with probability ~2^-b, which is corrected for
+// in minhash_jaccard().
+//
+// The sketches are computed for the sets of neighbor labels of each vertex,
+// and for the set of (labelled) edges of the whole graph. An empty set has all
+// entries equal to the maximum value.
+
+// SplitMix64 finalizer
+inline uint64_t minhash_mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+template <class T>
+uint64_t minhash_key(T x, std::true_type)
+{
+    return uint64_t(int64_t(x));
+}
+
+template <class T>
+uint64_t minhash_key(T x, std::false_type)
+{
+    // floating point labels are hashed by their bit pattern
+    double y = x;
+    uint64_t r;
+    std::memcpy(&r, &y, sizeof(r));
+    return r;
+}
+
+template <class T>
+uint64_t minhash_key(T x)
+{
+    return minhash_key(x, std::is_integral<T>());
+}
+
+class minhash_t
+{
+public:
+    minhash_t(size_t k, uint64_t seed, size_t bits)
+        : _seeds(k),
+          _mask((bits >= 64) ? numeric_limits<uint64_t>::max() :
+                (uint64_t(1) << bits) - 1)
+    {
+        for (size_t i = 0; i < k; ++i)
+            _seeds[i] = minhash_mix(seed + i);
+    }
+
+    size_t size() const { return _seeds.size(); }
+
+    template <class Sketch>
+    void clear(Sketch&& s) const
+    {
+        for (size_t i = 0; i < _seeds.size(); ++i)
+            s[i] = numeric_limits<uint64_t>::max();
+    }
+
+    template <class Sketch>
+    void insert(Sketch&& s, uint64_t x) const
+    {
+        for (size_t i = 0; i < _seeds.size(); ++i)
+        {
+            uint64_t h = minhash_mix(x ^ _seeds[i]);
+            if (h < s[i])
+                s[i] = h;
+        }
+    }
+
+    // the lowest bits of the minima are kept only after all insertions, since
+    // the truncation does not commute with the minimum
+    template <class Sketch>
+    void truncate(Sketch&& s) const
+    {
+        for (size_t i = 0; i < _seeds.size(); ++i)
+            s[i] &= _mask;
+    }
+
+private:
+    vector<uint64_t> _seeds;
+    uint64_t _mask;
+};
+
+template <class Graph, class Label, class Sketch>
+void vertex_minhash(Graph& g, Label label, Sketch& sketch,
+                    const minhash_t& mh, bool self_loop)
+{
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             auto s = sketch[v];
+             mh.clear(s);
+             for (auto w : adjacent_vertices_range(v, g))
+                 mh.insert(s, minhash_key(label[w]));
+             if (self_loop)
+                 mh.insert(s, minhash_key(label[v]));
+             mh.truncate(s);
+         });
+}
+
+template <class Graph, class Label, class Sketch>
+void graph_minhash(Graph& g, Label label, Sketch& sketch, const minhash_t& mh)
+{
+    mh.clear(sketch);
+
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+    {
+        vector<uint64_t> s(mh.size());
+        mh.clear(s);
+        parallel_edge_loop_no_spawn
+            (g,
+             [&](const auto& e)
+             {
+                 uint64_t u = minhash_key(label[source(e, g)]);
+                 uint64_t v = minhash_key(label[target(e, g)]);
+                 if (!graph_tool::is_directed(g) && u > v)
+                     std::swap(u, v);
+                 mh.insert(s, minhash_mix(u) ^ v);
+             });
+
+        #pragma omp critical (graph_minhash)
+        for (size_t i = 0; i < s.size(); ++i)
+            sketch[i] = std::min(uint64_t(sketch[i]), s[i]);
+    }
+
+    mh.truncate(sketch);
+}
+
+// Estimate of the Jaccard similarity from two b-bit sketches
+template <class Sketch1, class Sketch2>
+double minhash_jaccard(const Sketch1& s1, const Sketch2& s2, size_t k,
+                       size_t bits)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < k; ++i)
+    {
+        if (s1[i] == s2[i])
+            count++;
+    }
+    double f = count / double(k);
+    if (bits >= 64)
+        return f;
+    double c = std::ldexp(1., -int(bits));
+    return std::max((f - c) / (1 - c), 0.);
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_MINHASH_HH
@@ -18,6 +18,7 @@
 #include "graph_filtering.hh"
 #include "graph.hh"
 #include "graph_properties.hh"
+#include "graph_parallel_traversal.hh"
 
 #include <boost/graph/kruskal_min_spanning_tree.hpp>
 #include <boost/graph/prim_minimum_spanning_tree.hpp>
@@ -59,6 +60,107 @@ struct get_kruskal_min_span_tree
     }
 };
 
+// Parallel Boruvka: in each round, every vertex finds its lightest edge to
+// another component, the lightest of them is selected for each component with
+// a CAS on its representative, and the selected edges are added to the tree,
+// with the components merged by concurrent union-find. Ties are broken by the
+// edge index, so that the selected edges always form a forest, and a tree
+// edge is marked only by the union that succeeded. The number of components is
+// at least halved in each round, so that there are at most O(log V) rounds.
+struct get_boruvka_min_span_tree
+{
+    template <class Graph, class WeightMap, class TreeMap>
+    void operator()(const Graph& g, WeightMap weights, TreeMap tree_map) const
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        typedef typename property_traits<WeightMap>::value_type val_t;
+
+        size_t N = num_vertices(g);
+        constexpr size_t null = numeric_limits<size_t>::max();
+
+        auto eindex = get(boost::edge_index_t(), g);
+
+        concurrent_union_find uf(N);
+        vector<size_t> comp(N);
+        vector<val_t> lw(N);
+        vector<edge_t> le(N);
+        vector<uint8_t> has_edge(N);
+        std::unique_ptr<std::atomic<size_t>[]> best(new std::atomic<size_t>[N]);
+
+        parallel_vertex_loop(g, [&](auto v) { comp[v] = v; best[v] = null; });
+
+        // vertex u's candidate is better than v's
+        auto better = [&](size_t u, size_t v)
+            {
+                if (lw[u] != lw[v])
+                    return lw[u] < lw[v];
+                return eindex[le[u]] < eindex[le[v]];
+            };
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     auto c = comp[v];
+                     bool found = false;
+                     for (auto e : out_edges_range(v, g))
+                     {
+                         if (comp[target(e, g)] == c)
+                             continue;
+                         val_t w = get(weights, e);
+                         if (!found || w < lw[v] ||
+                             (w == lw[v] && eindex[e] < eindex[le[v]]))
+                         {
+                             lw[v] = w;
+                             le[v] = e;
+                             found = true;
+                         }
+                     }
+                     has_edge[v] = found;
+                 });
+
+            parallel_vertex_loop
+                (g,
+                 [&](auto v)
+                 {
+                     if (!has_edge[v])
+                         return;
+                     auto& b = best[comp[v]];
+                     size_t u = b;
+                     while ((u == null || better(v, u)) &&
+                            !b.compare_exchange_weak(u, v));
+                 });
+
+            #pragma omp parallel if (N > OPENMP_MIN_THRESH) \
+                reduction(||:changed)
+            parallel_vertex_loop_no_spawn
+                (g,
+                 [&](auto v)
+                 {
+                     if (comp[v] != size_t(v))
+                         return;
+                     size_t u = best[v];
+                     if (u == null)
+                         return;
+                     best[v] = null;
+                     auto& e = le[u];
+                     if (uf.unite(source(e, g), target(e, g)))
+                     {
+                         tree_map[e] = 1;
+                         changed = true;
+                     }
+                 });
+
+            parallel_vertex_loop(g, [&](auto v) { comp[v] = uf.find(v); });
+        }
+    }
+};
+
 struct get_prim_min_span_tree
 {
     template <class Graph, class IndexMap, class WeightMap, class TreeMap>
@@ -119,6 +221,17 @@ void get_kruskal_spanning_tree(GraphInterface& gi, boost::any weight_map,
     typedef mpl::push_back<writable_edge_scalar_properties, cweight_t>::type
         weight_maps;
 
+    // large graphs are processed in parallel, if possible
+    if (get_traversal_threads(gi.get_num_vertices()) > 1)
+    {
+        run_action<graph_tool::detail::never_directed>()
+            (gi, std::bind(get_boruvka_min_span_tree(), std::placeholders::_1,
+                           std::placeholders::_2, std::placeholders::_3),
+             weight_maps(), writable_edge_scalar_properties())
+            (weight_map, tree_map);
+        return;
+    }
+
     run_action<graph_tool::detail::never_directed>()
         (gi, std::bind(get_kruskal_min_span_tree(), std::placeholders::_1, gi.get_vertex_index(),
                        std::placeholders::_2, std::placeholders::_3),
@@ -0,0 +1,60 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph.hh"
+#include "graph_filtering.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "graph_util.hh"
+#include "graph_parallel_matching.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+void bipartite_matching(GraphInterface& gi, boost::any part, boost::any match)
+{
+    run_action<graph_tool::detail::never_directed>()
+        (gi, std::bind(do_bipartite_matching(), std::placeholders::_1,
+                       std::placeholders::_2, std::placeholders::_3),
+         vertex_scalar_properties(), writable_edge_scalar_properties())
+        (part, match);
+}
+
+void locally_dominant_matching(GraphInterface& gi, boost::any weight,
+                               boost::any match)
+{
+    typedef UnityPropertyMap<int,GraphInterface::edge_t> weight_map_t;
+    typedef mpl::push_back<edge_scalar_properties, weight_map_t>::type
+        edge_props_t;
+
+    if(weight.empty())
+        weight = weight_map_t();
+
+    run_action<graph_tool::detail::never_directed>()
+        (gi, std::bind(do_locally_dominant_matching(), std::placeholders::_1,
+                       std::placeholders::_2, std::placeholders::_3),
+         edge_props_t(), writable_edge_scalar_properties())(weight, match);
+}
+
+void export_parallel_matching()
+{
+    python::def("bipartite_matching", &bipartite_matching);
+    python::def("locally_dominant_matching", &locally_dominant_matching);
+}
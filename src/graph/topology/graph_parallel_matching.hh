@@ -0,0 +1,492 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_PARALLEL_MATCHING_HH
+#define GRAPH_PARALLEL_MATCHING_HH
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <limits>
+
+#include "graph_util.hh"
+#include "graph_parallel_traversal.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Maximum cardinality matching of a bipartite graph, with the parallel
+// Pothen-Fan algorithm (A. Azad, M. Halappanavar, S. Rajamanickam, E. Boman,
+// A. Khan and A. Pothen, "Multithreaded algorithms for maximum matching in
+// bipartite graphs", IPDPS 2012), starting from a Karp-Sipser matching.
+//
+// The search starts from the unmatched vertices of the smallest side (the
+// "left" side), which are processed in parallel in phases. Each one does a
+// depth-first search for an augmenting path, and every right vertex can be
+// visited only once per phase, which is enforced by an atomic flag, so that the
+// paths found are vertex-disjoint and can be augmented right away by the thread
+// that found them. Each left vertex first looks ahead for an unmatched
+// neighbour, from where the previous lookahead stopped, and the neighbours are
+// scanned in alternating directions in each phase ("fairness"). The matching is
+// maximum once a phase finds no augmenting path.
+//
+// The edges between vertices on the same side are ignored.
+struct do_bipartite_matching
+{
+    template <class Graph, class PartMap, class MatchMap>
+    void operator()(const Graph& g, PartMap part, MatchMap match) const
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        constexpr size_t null = numeric_limits<size_t>::max();
+
+        size_t N = num_vertices(g);
+        size_t nt = get_traversal_threads(N);
+
+        size_t n_true = 0, n_false = 0;
+        for (auto v : vertices_range(g))
+        {
+            if (part[v])
+                ++n_true;
+            else
+                ++n_false;
+        }
+        bool left_side = n_true <= n_false;
+
+        // adjacency of the left vertices, to the right ones
+        vector<size_t> left;
+        vector<size_t> pos(N + 1, 0);
+        for (auto v : vertices_range(g))
+        {
+            if (bool(part[v]) != left_side)
+                continue;
+            left.push_back(v);
+            for (auto e : out_edges_range(v, g))
+            {
+                if (bool(part[target(e, g)]) != left_side)
+                    pos[v + 1]++;
+            }
+        }
+        for (size_t v = 0; v < N; ++v)
+            pos[v + 1] += pos[v];
+        vector<size_t> adj(pos[N]);
+        vector<edge_t> adj_e(pos[N]);
+        #pragma omp parallel for schedule(runtime) num_threads(nt)
+        for (size_t i = 0; i < left.size(); ++i)
+        {
+            size_t v = left[i];
+            size_t j = pos[v];
+            for (auto e : out_edges_range(v, g))
+            {
+                auto u = target(e, g);
+                if (bool(part[u]) == left_side)
+                    continue;
+                adj[j] = u;
+                adj_e[j] = e;
+                ++j;
+            }
+        }
+
+        // mates of all vertices, and the matched edges of the left ones
+        unique_ptr<atomic<size_t>[]> mate(new atomic<size_t>[N]);
+        for (size_t v = 0; v < N; ++v)
+            mate[v].store(null, memory_order_relaxed);
+        vector<size_t> medge(N, null);
+
+        karp_sipser(g, part, left_side, left, pos, adj, mate, medge);
+
+        unique_ptr<atomic<uint8_t>[]> visited(new atomic<uint8_t>[N]);
+        vector<size_t> lookahead(pos.begin(), pos.end() - 1);
+        vector<size_t> free;
+        for (auto v : left)
+        {
+            if (mate[v] == null)
+                free.push_back(v);
+        }
+
+        for (size_t phase = 0; !free.empty(); ++phase)
+        {
+            #pragma omp parallel for schedule(runtime) num_threads(nt)
+            for (size_t v = 0; v < N; ++v)
+                visited[v].store(false, memory_order_relaxed);
+
+            bool forward = phase % 2 == 0;
+            bool augmented = false;
+
+            #pragma omp parallel num_threads(nt) reduction(||:augmented)
+            {
+                // (left vertex, position of the next neighbour to try, and of
+                // the edge that leads to the right vertex being explored)
+                struct frame_t { size_t v, next, j; };
+                vector<frame_t> stack;
+
+                #pragma omp for schedule(dynamic, 64)
+                for (size_t i = 0; i < free.size(); ++i)
+                {
+                    stack.clear();
+                    size_t s = free[i];
+                    stack.push_back({s, forward ? pos[s] : pos[s + 1], null});
+                    while (!stack.empty())
+                    {
+                        auto& f = stack.back();
+                        size_t v = f.v;
+
+                        // lookahead for an unmatched neighbour
+                        size_t found = null;
+                        for (; lookahead[v] < pos[v + 1]; ++lookahead[v])
+                        {
+                            size_t j = lookahead[v];
+                            size_t u = adj[j];
+                            if (mate[u].load(memory_order_relaxed) == null &&
+                                !visited[u].exchange(true))
+                            {
+                                found = j;
+                                ++lookahead[v];
+                                break;
+                            }
+                        }
+                        if (found != null)
+                        {
+                            f.j = found;
+                            augment(stack, adj, mate, medge);
+                            augmented = true;
+                            break;
+                        }
+
+                        // descend into the first unvisited neighbour
+                        bool descended = false;
+                        while (forward ? f.next < pos[v + 1] : f.next > pos[v])
+                        {
+                            size_t j = forward ? f.next++ : --f.next;
+                            size_t u = adj[j];
+                            if (visited[u].load(memory_order_relaxed) ||
+                                visited[u].exchange(true))
+                                continue;
+                            size_t w = mate[u].load(memory_order_relaxed);
+                            if (w == null)
+                            {
+                                // normally found by the lookahead already
+                                f.j = j;
+                                augment(stack, adj, mate, medge);
+                                augmented = true;
+                                stack.clear();
+                                descended = true;
+                                break;
+                            }
+                            f.j = j;
+                            stack.push_back({w, forward ? pos[w] : pos[w + 1],
+                                             null});
+                            descended = true;
+                            break;
+                        }
+                        if (!descended)
+                            stack.pop_back();
+                    }
+                }
+            }
+
+            if (!augmented)
+                break;
+
+            size_t k = 0;
+            for (auto v : free)
+            {
+                if (mate[v] == null)
+                    free[k++] = v;
+            }
+            free.resize(k);
+        }
+
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 match[e] = false;
+             });
+        #pragma omp parallel for schedule(runtime) num_threads(nt)
+        for (size_t i = 0; i < left.size(); ++i)
+        {
+            size_t v = left[i];
+            if (medge[v] != null)
+                match[adj_e[medge[v]]] = true;
+        }
+    }
+
+    // flips the augmenting path given by the stack, which ends at an
+    // unmatched right vertex, through the edge j of the top frame
+    template <class Stack, class Mate>
+    static void augment(Stack& stack, const vector<size_t>& adj, Mate& mate,
+                        vector<size_t>& medge)
+    {
+        for (auto& f : stack)
+        {
+            size_t u = adj[f.j];
+            mate[u].store(f.v, memory_order_relaxed);
+            mate[f.v].store(u, memory_order_relaxed);
+            medge[f.v] = f.j;
+        }
+    }
+
+    // greedy initial matching, which matches first the vertices that have a
+    // single unmatched neighbour (R. M. Karp and M. Sipser, "Maximum matchings
+    // in sparse random graphs", FOCS 1981)
+    template <class Graph, class PartMap, class Mate>
+    static void karp_sipser(const Graph& g, PartMap part, bool left_side,
+                            const vector<size_t>& left,
+                            const vector<size_t>& pos,
+                            const vector<size_t>& adj, Mate& mate,
+                            vector<size_t>& medge)
+    {
+        constexpr size_t null = numeric_limits<size_t>::max();
+        size_t N = num_vertices(g);
+
+        // number of edges to unmatched vertices on the other side
+        vector<size_t> deg(N, 0);
+        for (auto v : left)
+        {
+            for (size_t j = pos[v]; j < pos[v + 1]; ++j)
+            {
+                ++deg[v];
+                ++deg[adj[j]];
+            }
+        }
+
+        vector<size_t> ones;
+        for (auto v : vertices_range(g))
+        {
+            if (deg[v] == 1)
+                ones.push_back(v);
+        }
+
+        auto is_left = [&](size_t v) { return bool(part[v]) == left_side; };
+
+        // matches v with an unmatched neighbour, if any
+        auto match_vertex = [&](size_t v)
+            {
+                size_t l = null, j = null;
+                if (is_left(v))
+                {
+                    for (size_t k = pos[v]; k < pos[v + 1]; ++k)
+                    {
+                        if (mate[adj[k]] == null)
+                        {
+                            l = v;
+                            j = k;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    for (auto w : out_neighbors_range(v, g))
+                    {
+                        if (!is_left(w) || mate[w] != null)
+                            continue;
+                        for (size_t k = pos[w]; k < pos[w + 1]; ++k)
+                        {
+                            if (adj[k] == v)
+                            {
+                                l = w;
+                                j = k;
+                                break;
+                            }
+                        }
+                        break;
+                    }
+                }
+                if (j == null)
+                    return;
+                size_t r = adj[j];
+                mate[l] = r;
+                mate[r] = l;
+                medge[l] = j;
+                for (auto x : {l, r})
+                {
+                    for (auto w : out_neighbors_range(vertex(x, g), g))
+                    {
+                        if (is_left(w) == is_left(x) || mate[w] != null)
+                            continue;
+                        if (--deg[w] == 1)
+                            ones.push_back(w);
+                    }
+                }
+            };
+
+        size_t next = 0;
+        auto vs = vertices_range(g);
+        auto vi = vs.begin();
+        while (true)
+        {
+            while (next < ones.size())
+            {
+                size_t v = ones[next++];
+                if (mate[v] == null && deg[v] > 0)
+                    match_vertex(v);
+            }
+            for (; vi != vs.end(); ++vi)
+            {
+                if (mate[*vi] == null && deg[*vi] > 0)
+                    break;
+            }
+            if (vi == vs.end())
+                break;
+            match_vertex(*vi);
+        }
+    }
+};
+
+// Half-approximate maximum weight matching of a general graph, given by the
+// locally dominant edges (R. Preis, "Linear time 1/2-approximation algorithm
+// for maximum weighted matching in general graphs", STACS 1999; F. Manne and
+// R. H. Bisseling, "A parallel approximation algorithm for the weighted
+// maximum matching problem", PPAM 2007).
+//
+// Every vertex points to its heaviest neighbour that is still unmatched, and
+// the edges whose endpoints point to each other are matched. This is repeated
+// in rounds, in parallel, and only the vertices whose candidate was matched
+// look for a new one. The edges are ordered by weight, and then by index, so
+// that the result is the same as that of the sequential greedy algorithm,
+// independently of the number of threads. With unit weights the result is a
+// maximal matching.
+struct do_locally_dominant_matching
+{
+    template <class Graph, class WeightMap, class MatchMap>
+    void operator()(const Graph& g, WeightMap weight, MatchMap match) const
+    {
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        typedef typename property_traits<WeightMap>::value_type val_t;
+        constexpr size_t null = numeric_limits<size_t>::max();
+
+        size_t N = num_vertices(g);
+        size_t nt = get_traversal_threads(N);
+        auto eindex = get(edge_index_t(), g);
+
+        vector<size_t> cand(N, null);
+        vector<edge_t> cand_e(N);
+        vector<uint8_t> matched(N, false);
+        unique_ptr<atomic<uint8_t>[]> queued(new atomic<uint8_t>[N]);
+        for (size_t v = 0; v < N; ++v)
+            queued[v].store(false, memory_order_relaxed);
+
+        vector<size_t> active;
+        for (auto v : vertices_range(g))
+            active.push_back(v);
+
+        vector<vector<size_t>> buffers(nt);
+
+        while (!active.empty())
+        {
+            size_t A = active.size();
+
+            // new candidates
+            #pragma omp parallel for schedule(runtime) num_threads(nt)
+            for (size_t i = 0; i < A; ++i)
+            {
+                size_t v = active[i];
+                queued[v] = true;
+                size_t best = null;
+                edge_t best_e = edge_t();
+                val_t best_w = val_t();
+                for (auto e : out_edges_range(vertex(v, g), g))
+                {
+                    size_t u = target(e, g);
+                    if (u == v || matched[u])
+                        continue;
+                    val_t w = get(weight, e);
+                    if (best == null || w > best_w ||
+                        (w == best_w && eindex[e] > eindex[best_e]))
+                    {
+                        best = u;
+                        best_e = e;
+                        best_w = w;
+                    }
+                }
+                cand[v] = best;
+                cand_e[v] = best_e;
+            }
+
+            // mutual candidates are matched, and their neighbours need new
+            // candidates; pairs with both ends active are handled by the
+            // smallest one
+            #pragma omp parallel num_threads(nt)
+            {
+                size_t t = 0;
+#ifdef _OPENMP
+                t = omp_get_thread_num();
+#endif
+                auto& buf = buffers[t];
+                #pragma omp for schedule(runtime)
+                for (size_t i = 0; i < A; ++i)
+                {
+                    size_t v = active[i];
+                    size_t u = cand[v];
+                    if (u == null || cand[u] != v || (queued[u] && u < v))
+                        continue;
+                    matched[v] = matched[u] = true;
+                    for (auto x : {v, u})
+                    {
+                        for (auto w : out_neighbors_range(vertex(x, g), g))
+                        {
+                            if (size_t(w) != v && size_t(w) != u &&
+                                cand[w] == x)
+                                buf.push_back(w);
+                        }
+                    }
+                }
+            }
+
+            #pragma omp parallel for schedule(runtime) num_threads(nt)
+            for (size_t i = 0; i < A; ++i)
+                queued[active[i]] = false;
+
+            active.clear();
+            for (auto& buf : buffers)
+            {
+                for (auto w : buf)
+                {
+                    if (matched[w] || queued[w])
+                        continue;
+                    queued[w] = true;
+                    active.push_back(w);
+                }
+                buf.clear();
+            }
+            for (auto v : active)
+                queued[v] = false;
+        }
+
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 match[e] = false;
+             });
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 size_t u = cand[v];
+                 if (matched[v] && u != null && v < u && cand[u] == v)
+                     match[cand_e[v]] = true;
+             });
+    }
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_PARALLEL_MATCHING_HH
@@ -17,6 +17,7 @@
 
 #include "graph_tool.hh"
 #include "numpy_bind.hh"
+#include "random.hh"
 
 #include "graph_percolation.hh"
 
@@ -107,6 +108,119 @@ void percolate_vertex(GraphInterface& gi, boost::any tree, boost::any size,
                                             ms, vs); })();
 }
 
+// Returns a function that fills the order of sample r, either from the rows
+// of the given orders, or with a random permutation of [0, L) obtained from
+// its own seed, so that the result does not depend on the number of threads.
+template <class Orders>
+auto get_order_function(Orders& os, bool random_order, size_t L,
+                        size_t n_samples, rng_t& rng, vector<size_t>& seeds)
+{
+    if (random_order)
+    {
+        seeds.resize(n_samples);
+        for (auto& seed : seeds)
+            seed = rng();
+    }
+    else
+    {
+        for (size_t r = 0; r < os.shape()[0]; ++r)
+        {
+            for (size_t i = 0; i < os.shape()[1]; ++i)
+            {
+                if (os[r][i] < 0 || size_t(os[r][i]) >= L)
+                    throw ValueException("invalid order position: " +
+                                         lexical_cast<string>(os[r][i]));
+            }
+        }
+    }
+
+    return [&, random_order, L](size_t r, vector<size_t>& order)
+        {
+            if (random_order)
+            {
+                order.resize(L);
+                for (size_t i = 0; i < L; ++i)
+                    order[i] = i;
+                rng_t rng_r(seeds[r]);
+                std::shuffle(order.begin(), order.end(), rng_r);
+            }
+            else
+            {
+                auto row = os[r];
+                order.assign(row.begin(), row.end());
+            }
+        };
+}
+
+void percolate_edge_batch(GraphInterface& gi, python::object edges,
+                          python::object orders, bool random_order,
+                          python::object max_size, rng_t& rng)
+{
+    multi_array_ref<uint64_t, 2> es = get_array<uint64_t, 2>(edges);
+    multi_array_ref<int64_t, 2> os = get_array<int64_t, 2>(orders);
+    multi_array_ref<uint64_t, 2> ms = get_array<uint64_t, 2>(max_size);
+
+    size_t N = gi.get_num_vertices(false);
+    for (size_t i = 0; i < es.shape()[0]; ++i)
+    {
+        if (es[i][0] >= N || es[i][1] >= N)
+            throw ValueException("invalid vertex in edge list: " +
+                                 lexical_cast<string>(std::max(es[i][0],
+                                                               es[i][1])));
+    }
+
+    size_t n_samples = ms.shape()[0];
+    vector<size_t> seeds;
+    auto get_order = get_order_function(os, random_order, es.shape()[0],
+                                        n_samples, rng, seeds);
+
+    run_action<graph_tool::detail::never_directed>()
+        (gi,
+         [&](auto& g)
+         {
+             if (N < size_t(numeric_limits<int32_t>::max()))
+                 edge_percolate_batch<int32_t>(g, es, n_samples, get_order,
+                                               ms);
+             else
+                 edge_percolate_batch<int64_t>(g, es, n_samples, get_order,
+                                               ms);
+         })();
+}
+
+void percolate_vertex_batch(GraphInterface& gi, python::object vertices,
+                            python::object orders, bool random_order,
+                            python::object max_size, rng_t& rng)
+{
+    multi_array_ref<uint64_t, 1> vs = get_array<uint64_t, 1>(vertices);
+    multi_array_ref<int64_t, 2> os = get_array<int64_t, 2>(orders);
+    multi_array_ref<uint64_t, 2> ms = get_array<uint64_t, 2>(max_size);
+
+    size_t N = gi.get_num_vertices(false);
+    for (auto v : vs)
+    {
+        if (v >= N)
+            throw ValueException("invalid vertex: " +
+                                 lexical_cast<string>(v));
+    }
+
+    size_t n_samples = ms.shape()[0];
+    vector<size_t> seeds;
+    auto get_order = get_order_function(os, random_order, vs.shape()[0],
+                                        n_samples, rng, seeds);
+
+    run_action<graph_tool::detail::never_directed>()
+        (gi,
+         [&](auto& g)
+         {
+             if (N < size_t(numeric_limits<int32_t>::max()))
+                 vertex_percolate_batch<int32_t>(g, vs, n_samples, get_order,
+                                                 ms);
+             else
+                 vertex_percolate_batch<int64_t>(g, vs, n_samples, get_order,
+                                                 ms);
+         })();
+}
+
 #include <boost/python.hpp>
 
 void export_percolation()
@@ -115,4 +229,6 @@ void export_percolation()
 
     def("percolate_edge", percolate_edge);
     def("percolate_vertex", percolate_vertex);
+    def("percolate_edge_batch", percolate_edge_batch);
+    def("percolate_vertex_batch", percolate_vertex_batch);
 };
@@ -18,6 +18,9 @@
 #ifndef GRAPH_PERCOLATION_HH
 #define GRAPH_PERCOLATION_HH
 
+#include <vector>
+#include <cstdint>
+
 namespace graph_tool
 {
 using namespace std;
@@ -123,6 +126,130 @@ void vertex_percolate(Graph& g, TreeMap tree, SizeMap size, VisitedMap visited,
     }
 }
 
+// Compact union-find for percolation sweeps, as in Newman and Ziff: a single
+// array where a negative entry marks a root, and holds minus the size of its
+// cluster, and any other entry is the parent of the vertex. This keeps both in
+// the same cache line, and with 32-bit entries (for graphs with fewer than
+// 2^31 vertices) the whole structure takes 4 bytes per vertex. Union is by
+// size, and the finds use path halving.
+template <class Idx>
+class percolation_clusters
+{
+public:
+    void reset(size_t N)
+    {
+        _p.assign(N, -1);
+    }
+
+    Idx find(Idx v)
+    {
+        while (_p[v] >= 0)
+        {
+            Idx p = _p[v];
+            if (_p[p] < 0)
+                return p;
+            _p[v] = _p[p];
+            v = _p[v];
+        }
+        return v;
+    }
+
+    // joins the clusters of u and v, and returns the size of the result
+    size_t join(Idx u, Idx v)
+    {
+        u = find(u);
+        v = find(v);
+        if (u != v)
+        {
+            if (_p[u] > _p[v])
+                std::swap(u, v);
+            _p[u] += _p[v];
+            _p[v] = u;
+        }
+        return -_p[u];
+    }
+
+private:
+    vector<Idx> _p;
+};
+
+// Many independent edge percolation sweeps, run in parallel, one per thread at
+// a time, each with its own private clusters. For each sample r, get_order(r,
+// order) must fill order with the positions in edges of the edges to be
+// added, and the size of the largest cluster after each addition is stored in
+// max_size[r][i], as in edge_percolate().
+template <class Idx, class Graph, class Edges, class GetOrder, class MaxSize>
+void edge_percolate_batch(Graph& g, Edges& edges, size_t n_samples,
+                          GetOrder&& get_order, MaxSize& max_size)
+{
+    size_t N = num_vertices(g);
+    #pragma omp parallel if (n_samples > 1)
+    {
+        percolation_clusters<Idx> clusters;
+        vector<size_t> order;
+
+        #pragma omp for schedule(runtime)
+        for (size_t r = 0; r < n_samples; ++r)
+        {
+            clusters.reset(N);
+            get_order(r, order);
+            size_t ms = 0;
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                size_t j = order[i];
+                size_t s = clusters.join(edges[j][0], edges[j][1]);
+                ms = std::max(ms, s);
+                max_size[r][i] = ms;
+            }
+        }
+    }
+}
+
+// The same as edge_percolate_batch(), but with vertices being added, as in
+// vertex_percolate().
+template <class Idx, class Graph, class Vertices, class GetOrder,
+          class MaxSize>
+void vertex_percolate_batch(Graph& g, Vertices& vertices, size_t n_samples,
+                            GetOrder&& get_order, MaxSize& max_size)
+{
+    size_t N = num_vertices(g);
+    #pragma omp parallel if (n_samples > 1)
+    {
+        percolation_clusters<Idx> clusters;
+        vector<uint8_t> visited;
+        vector<size_t> order;
+
+        #pragma omp for schedule(runtime)
+        for (size_t r = 0; r < n_samples; ++r)
+        {
+            clusters.reset(N);
+            visited.assign(N, false);
+            get_order(r, order);
+            size_t ms = 0;
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+                auto v = vertex(vertices[order[i]], g);
+                if (v == graph_traits<Graph>::null_vertex())
+                {
+                    max_size[r][i] = ms;
+                    continue;
+                }
+
+                for (auto a : adjacent_vertices_range(v, g))
+                {
+                    if (!visited[a])
+                        continue;
+                    size_t s = clusters.join(v, a);
+                    ms = std::max(ms, s);
+                }
+                ms = std::max(ms, size_t(1));
+                max_size[r][i] = ms;
+                visited[v] = true;
+            }
+        }
+    }
+}
+
 } // graph_tool namespace
 
 #endif // GRAPH_PERCOLATION_HH
@@ -20,8 +20,12 @@
 #include "graph_properties.hh"
 
 #include "random.hh"
+#include "numpy_bind.hh"
+
+#include "graph_random_spanning_tree.hh"
 
 #include <boost/graph/random_spanning_tree.hpp>
+#include <boost/python.hpp>
 
 using namespace std;
 using namespace boost;
@@ -93,3 +97,64 @@ void get_random_spanning_tree(GraphInterface& gi, size_t root,
             std::placeholders::_2, std::placeholders::_3, std::ref(rng)),
          weight_maps(), tree_properties())(weight_map, tree_map);
 }
+
+typedef UnityPropertyMap<size_t,GraphInterface::edge_t> rst_cweight_t;
+typedef mpl::push_back<edge_scalar_properties, rst_cweight_t>::type
+    rst_weight_maps;
+
+void get_random_spanning_trees(GraphInterface& gi, size_t root, size_t n,
+                               boost::any weight_map, python::object otrees,
+                               rng_t& rng)
+{
+    multi_array_ref<int64_t,2> trees = get_array<int64_t,2>(otrees);
+
+    bool weighted = !weight_map.empty();
+    if (!weighted)
+        weight_map = rst_cweight_t();
+
+    uint64_t seed = rng();
+    seed = (seed << 32) | rng();
+
+    // the edges of sample i are written by a single thread
+    vector<size_t> pos(n, 0);
+    gt_dispatch<>(true)
+        ([&](auto& g, auto w)
+         {
+             random_spanning_trees(g, root, w, weighted, n, seed,
+                                   [&](size_t i, size_t e)
+                                   {
+                                       trees[i][pos[i]++] = e;
+                                   });
+         },
+         all_graph_views(), rst_weight_maps())
+        (gi.get_graph_view(), weight_map);
+}
+
+void get_random_spanning_tree_counts(GraphInterface& gi, size_t root, size_t n,
+                                     boost::any weight_map,
+                                     boost::any count_map, rng_t& rng)
+{
+    typedef eprop_map_t<int64_t>::type count_t;
+    auto count = any_cast<count_t>(count_map)
+        .get_unchecked(gi.get_edge_index_range());
+
+    bool weighted = !weight_map.empty();
+    if (!weighted)
+        weight_map = rst_cweight_t();
+
+    uint64_t seed = rng();
+    seed = (seed << 32) | rng();
+
+    gt_dispatch<>(true)
+        ([&](auto& g, auto w)
+         {
+             random_spanning_trees(g, root, w, weighted, n, seed,
+                                   [&](size_t, size_t e)
+                                   {
+                                       #pragma omp atomic
+                                       count.get_storage()[e]++;
+                                   });
+         },
+         all_graph_views(), rst_weight_maps())
+        (gi.get_graph_view(), weight_map);
+}
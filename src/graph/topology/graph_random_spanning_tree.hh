@@ -0,0 +1,170 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_RANDOM_SPANNING_TREE_HH
+#define GRAPH_RANDOM_SPANNING_TREE_HH
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "graph_util.hh"
+#include "random.hh"
+#include "../inference/support/parallel_rng.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Out-edges of the graph in compressed form, with the cumulative weights if
+// the edges are weighted, so that a random out-edge can be chosen in O(1)
+// (unweighted) or O(log k) (weighted) time. This is shared by all the samples.
+class wilson_edges_t
+{
+public:
+    template <class Graph, class Weight>
+    wilson_edges_t(const Graph& g, Weight w, bool weighted)
+        : _offset(num_vertices(g) + 1, 0), _weighted(weighted)
+    {
+        for (auto v : vertices_range(g))
+            _offset[v + 1] = out_degree(v, g);
+        std::partial_sum(_offset.begin(), _offset.end(), _offset.begin());
+        _target.resize(_offset.back());
+        _eidx.resize(_offset.back());
+        if (_weighted)
+            _cumw.resize(_offset.back());
+
+        auto eindex = get(edge_index_t(), g);
+        for (auto v : vertices_range(g))
+        {
+            size_t pos = _offset[v];
+            double W = 0;
+            for (auto e : out_edges_range(v, g))
+            {
+                _target[pos] = target(e, g);
+                _eidx[pos] = eindex[e];
+                if (_weighted)
+                {
+                    W += get(w, e);
+                    _cumw[pos] = W;
+                }
+                ++pos;
+            }
+        }
+    }
+
+    // position of a random out-edge of v, with probability proportional to
+    // its weight
+    template <class RNG>
+    size_t sample(size_t v, RNG& rng) const
+    {
+        size_t begin = _offset[v], end = _offset[v + 1];
+        if (!_weighted)
+        {
+            std::uniform_int_distribution<size_t> sample(begin, end - 1);
+            return sample(rng);
+        }
+        double W = _cumw[end - 1];
+        std::uniform_real_distribution<double> sample(0, W);
+        double r = sample(rng);
+        auto iter = std::upper_bound(_cumw.begin() + begin,
+                                     _cumw.begin() + end, r);
+        return std::min(size_t(iter - _cumw.begin()), end - 1);
+    }
+
+    size_t get_target(size_t pos) const { return _target[pos]; }
+    size_t get_edge_index(size_t pos) const { return _eidx[pos]; }
+
+private:
+    vector<size_t> _offset;
+    vector<size_t> _target;
+    vector<size_t> _eidx;
+    vector<double> _cumw;
+    bool _weighted;
+};
+
+// Per-thread workspace of Wilson's algorithm, reused between samples
+struct wilson_state_t
+{
+    vector<uint8_t> in_tree;
+    vector<size_t> next;
+};
+
+// Samples a random spanning tree (or arborescence oriented towards the root,
+// for directed graphs) with probability proportional to the product of its
+// edge weights, via loop-erased random walks [Wilson, STOC 1996], and calls
+// f(i) with the index i of each tree edge. All vertices must be able to reach
+// the root.
+template <class Graph, class RNG, class F>
+void wilson_tree(const Graph& g, size_t root, const wilson_edges_t& edges,
+                 wilson_state_t& state, RNG& rng, F&& f)
+{
+    auto& in_tree = state.in_tree;
+    auto& next = state.next;
+    in_tree.assign(num_vertices(g), false);
+    next.resize(num_vertices(g));
+
+    in_tree[root] = true;
+    for (auto v : vertices_range(g))
+    {
+        // random walk until the tree is hit; since next[] is overwritten at
+        // each visit, the loops are erased implicitly
+        size_t u = v;
+        while (!in_tree[u])
+        {
+            next[u] = edges.sample(u, rng);
+            u = edges.get_target(next[u]);
+        }
+
+        // add the loop-erased path to the tree
+        u = v;
+        while (!in_tree[u])
+        {
+            in_tree[u] = true;
+            f(edges.get_edge_index(next[u]));
+            u = edges.get_target(next[u]);
+        }
+    }
+}
+
+// Samples n trees in parallel, each with its own random stream, so that the
+// results do not depend on the number of threads. The function f(i, e) is
+// called with the sample index i and the edge index e of every tree edge, from
+// any thread.
+template <class Graph, class Weight, class F>
+void random_spanning_trees(const Graph& g, size_t root, Weight w,
+                           bool weighted, size_t n, uint64_t seed, F&& f)
+{
+    wilson_edges_t edges(g, w, weighted);
+
+    #pragma omp parallel if (n > 1 && n * num_vertices(g) > OPENMP_MIN_THRESH)
+    {
+        wilson_state_t state;
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < n; ++i)
+        {
+            counter_rng rng(seed, i);
+            wilson_tree(g, root, edges, state, rng,
+                        [&](size_t e) { f(i, e); });
+        }
+    }
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_RANDOM_SPANNING_TREE_HH
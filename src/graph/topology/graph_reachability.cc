@@ -0,0 +1,93 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "graph_filtering.hh"
+#include "graph.hh"
+#include "graph_properties.hh"
+#include "graph_selectors.hh"
+#include "numpy_bind.hh"
+#include "random.hh"
+
+#include "graph_reachability.hh"
+
+#include <boost/python.hpp>
+
+using namespace std;
+using namespace boost;
+using namespace graph_tool;
+
+constexpr size_t ReachabilityIndex::_null;
+
+void reach_build(ReachabilityIndex& idx, GraphInterface& gi, size_t n_labels,
+                 rng_t& rng)
+{
+    uint64_t seed = rng();
+    seed = (seed << 32) | rng();
+    run_action<graph_tool::detail::always_directed>()
+        (gi, [&](auto& g) { idx.build(g, n_labels, seed); })();
+}
+
+// reachability of the pairs (sources[i], targets[i]), which are split among
+// the threads
+python::object reach_query(ReachabilityIndex& idx, python::object osources,
+                           python::object otargets)
+{
+    auto sources = get_array<int64_t, 1>(osources);
+    auto targets = get_array<int64_t, 1>(otargets);
+    if (sources.size() != targets.size())
+        throw ValueException("the numbers of sources and targets differ");
+
+    size_t n = sources.size();
+    vector<uint8_t> reach(n);
+    string err;
+    #pragma omp parallel if (n > OPENMP_MIN_THRESH)
+    {
+        static thread_local ReachabilityIndex::query q;
+        #pragma omp for schedule(runtime)
+        for (size_t i = 0; i < n; ++i)
+        {
+            try
+            {
+                if (sources[i] < 0 || targets[i] < 0)
+                    throw ValueException("Invalid vertex index: " +
+                                         to_string(min(sources[i],
+                                                       targets[i])));
+                reach[i] = idx.reachable(sources[i], targets[i], q);
+            }
+            catch (ValueException& e)
+            {
+                #pragma omp critical
+                err = e.what();
+            }
+        }
+    }
+    if (!err.empty())
+        throw ValueException(err);
+    return wrap_vector_owned(reach);
+}
+
+void export_reachability()
+{
+    using namespace boost::python;
+    class_<ReachabilityIndex, std::shared_ptr<ReachabilityIndex>,
+           boost::noncopyable>("ReachabilityIndex")
+        .def("build", &reach_build)
+        .def("reachable", &reach_query)
+        .def("num_vertices", &ReachabilityIndex::num_vertices)
+        .def("num_components", &ReachabilityIndex::num_components)
+        .def("num_labels", &ReachabilityIndex::num_labels);
+}
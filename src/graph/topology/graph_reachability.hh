@@ -0,0 +1,466 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_REACHABILITY_HH
+#define GRAPH_REACHABILITY_HH
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <string>
+
+#include "graph_util.hh"
+#include "graph_exceptions.hh"
+#include "graph_parallel_traversal.hh"
+#include "graph_components.hh"
+
+namespace graph_tool
+{
+
+// Reachability index of a directed graph. The graph is condensed into the DAG
+// of its strong components, which are found in parallel, and numbered in
+// topological order by level: the length of the longest path that reaches
+// them from a component without in-edges. A component can only reach those of
+// higher level.
+//
+// Each component also gets a number of interval labels, as in GRAIL (H.
+// Yildirim, V. Chaoji and M. J. Zaki, "GRAIL: scalable reachability index for
+// large graphs", VLDB 2010): for each of a few randomized depth-first
+// traversals of the DAG, its post-order number, and the smallest one among its
+// descendants. If a reaches b, the interval of b is contained in that of a, so
+// that most negative queries are answered by comparing the labels, and the
+// others by a depth-first search pruned by them. The labels of the different
+// traversals are computed in parallel.
+//
+// The index does not keep a reference to the graph. Its size is O(V + k C +
+// C'), where C is the number of components, C' the number of edges between
+// them, and k the number of labels.
+class ReachabilityIndex
+{
+public:
+    // state of a query, which can be reused, but not shared between threads
+    struct query
+    {
+        std::vector<size_t> mark;
+        std::vector<size_t> stack;
+        size_t stamp = 0;
+    };
+
+    template <class Graph>
+    void build(const Graph& g, size_t n_labels, uint64_t seed)
+    {
+        size_t N = boost::num_vertices(g);
+        size_t nt = get_traversal_threads(N);
+
+        std::vector<size_t> rep;
+        parallel_strong_components(g, rep);
+
+        // provisional component numbers, by their first vertex
+        std::vector<size_t> id(N, _null);
+        _comp.clear();
+        _comp.resize(N, _null);
+        size_t C = 0;
+        for (auto v : vertices_range(g))
+        {
+            auto& c = id[rep[v]];
+            if (c == _null)
+                c = C++;
+            _comp[v] = c;
+        }
+
+        std::vector<size_t> size(C, 0);
+        for (auto v : vertices_range(g))
+            ++size[_comp[v]];
+
+        std::unique_ptr<std::atomic<size_t>[]> count(new std::atomic<size_t>[C]);
+        std::unique_ptr<std::atomic<uint8_t>[]> loop(new std::atomic<uint8_t>[C]);
+        for (size_t c = 0; c < C; ++c)
+        {
+            count[c] = 0;
+            loop[c] = false;
+        }
+
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 size_t a = _comp[source(e, g)], b = _comp[target(e, g)];
+                 if (a == b)
+                 {
+                     if (source(e, g) == target(e, g))
+                         loop[a].store(true, std::memory_order_relaxed);
+                     return;
+                 }
+                 count[a].fetch_add(1, std::memory_order_relaxed);
+             });
+
+        // edges between the components, with the repeated ones removed
+        std::vector<size_t> pos(C + 1, 0), out;
+        for (size_t c = 0; c < C; ++c)
+            pos[c + 1] = pos[c] + count[c];
+        out.resize(pos[C]);
+        for (size_t c = 0; c < C; ++c)
+            count[c] = pos[c];
+
+        parallel_edge_loop
+            (g,
+             [&](const auto& e)
+             {
+                 size_t a = _comp[source(e, g)], b = _comp[target(e, g)];
+                 if (a != b)
+                     out[count[a]++] = b;
+             });
+
+        std::vector<size_t> deg(C);
+        #pragma omp parallel for num_threads(nt) schedule(runtime)
+        for (size_t c = 0; c < C; ++c)
+        {
+            auto begin = out.begin() + pos[c];
+            auto end = out.begin() + pos[c + 1];
+            std::sort(begin, end);
+            deg[c] = std::unique(begin, end) - begin;
+        }
+
+        // levels, by Kahn's algorithm with work stealing
+        std::unique_ptr<std::atomic<size_t>[]> level(new std::atomic<size_t>[C]);
+        for (size_t c = 0; c < C; ++c)
+        {
+            count[c] = 0;
+            level[c] = 0;
+        }
+
+        #pragma omp parallel for num_threads(nt) schedule(runtime)
+        for (size_t c = 0; c < C; ++c)
+        {
+            for (size_t i = pos[c]; i < pos[c] + deg[c]; ++i)
+                count[out[i]].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::vector<size_t> init;
+        for (size_t c = 0; c < C; ++c)
+        {
+            if (count[c] == 0)
+                init.push_back(c);
+        }
+
+        work_stealing_loop
+            (init, nt,
+             [&](size_t a, auto& push)
+             {
+                 size_t l = level[a] + 1;
+                 for (size_t i = pos[a]; i < pos[a] + deg[a]; ++i)
+                 {
+                     size_t b = out[i];
+                     size_t lb = level[b].load(std::memory_order_relaxed);
+                     while (lb < l && !level[b].compare_exchange_weak(lb, l));
+                     if (count[b].fetch_sub(1) == 1)
+                         push(b);
+                 }
+             });
+
+        // renumbering in order of level, stable in the provisional number
+        size_t L = 0;
+        for (size_t c = 0; c < C; ++c)
+            L = std::max(L, level[c] + 1);
+        _level_pos.clear();
+        _level_pos.resize(L + 1, 0);
+        for (size_t c = 0; c < C; ++c)
+            ++_level_pos[level[c] + 1];
+        for (size_t l = 0; l < L; ++l)
+            _level_pos[l + 1] += _level_pos[l];
+
+        std::vector<size_t> perm(C), inv(C);
+        {
+            auto next = _level_pos;
+            for (size_t c = 0; c < C; ++c)
+            {
+                perm[c] = next[level[c]]++;
+                inv[perm[c]] = c;
+            }
+        }
+
+        _level.resize(C);
+        _cyclic.resize(C);
+        for (size_t c = 0; c < C; ++c)
+        {
+            _level[perm[c]] = level[c];
+            _cyclic[perm[c]] = size[c] > 1 || loop[c];
+        }
+
+        _out_pos.clear();
+        _out_pos.resize(C + 1, 0);
+        for (size_t c = 0; c < C; ++c)
+            _out_pos[c + 1] = _out_pos[c] + deg[inv[c]];
+        _out.resize(_out_pos[C]);
+
+        #pragma omp parallel for num_threads(nt) schedule(runtime)
+        for (size_t c = 0; c < C; ++c)
+        {
+            size_t o = inv[c];
+            for (size_t i = 0; i < deg[o]; ++i)
+                _out[_out_pos[c] + i] = perm[out[pos[o] + i]];
+            std::sort(_out.begin() + _out_pos[c],
+                      _out.begin() + _out_pos[c + 1]);
+        }
+
+        parallel_vertex_loop(g, [&](auto v) { _comp[v] = perm[_comp[v]]; });
+
+        // the vertices of each component, in index order
+        _member_pos.clear();
+        _member_pos.resize(C + 1, 0);
+        for (size_t c = 0; c < C; ++c)
+            _member_pos[perm[c] + 1] = size[c];
+        for (size_t c = 0; c < C; ++c)
+            _member_pos[c + 1] += _member_pos[c];
+        _members.resize(_member_pos[C]);
+        {
+            auto next = _member_pos;
+            for (auto v : vertices_range(g))
+                _members[next[_comp[v]]++] = v;
+        }
+
+        build_labels(n_labels, seed, nt);
+    }
+
+    // Is there a path of at least one edge from u to v?
+    bool reachable(size_t u, size_t v, query& q) const
+    {
+        size_t a = get_comp(u), b = get_comp(v);
+        if (a == b)
+            return _cyclic[a];
+        if (!maybe_reachable(a, b))
+            return false;
+
+        size_t C = num_components();
+        if (q.mark.size() != C)
+        {
+            q.mark.clear();
+            q.mark.resize(C, 0);
+            q.stamp = 0;
+        }
+        size_t stamp = ++q.stamp;
+
+        auto& stack = q.stack;
+        stack.clear();
+        stack.push_back(a);
+        q.mark[a] = stamp;
+        while (!stack.empty())
+        {
+            size_t c = stack.back();
+            stack.pop_back();
+            for (size_t i = _out_pos[c]; i < _out_pos[c + 1]; ++i)
+            {
+                size_t w = _out[i];
+                if (w == b)
+                    return true;
+                if (q.mark[w] == stamp || !maybe_reachable(w, b))
+                    continue;
+                q.mark[w] = stamp;
+                stack.push_back(w);
+            }
+        }
+        return false;
+    }
+
+    // Calls emit(a, b) for every pair of distinct components such that a
+    // reaches b, from a single thread. The reachable sets are computed as
+    // bit rows, in parallel for the components of the same level, from the
+    // highest level down, for blocks of target components of the size
+    // allowed by max_bytes for all the rows, so that the memory needed does
+    // not depend on the size of the closure.
+    template <class Emit>
+    void closure(size_t max_bytes, Emit&& emit) const
+    {
+        size_t C = num_components();
+        if (C == 0)
+            return;
+        size_t W = std::max(max_bytes / (8 * C), size_t(1));
+        W = std::min(W, (C + 63) / 64);
+        size_t B = 64 * W;
+
+        size_t nt = get_traversal_threads(C);
+        std::vector<uint64_t> rows;
+        for (size_t b0 = 0; b0 < C; b0 += B)
+        {
+            // only the components before the end of the block can reach it
+            size_t M = std::min(b0 + B, C);
+            rows.clear();
+            rows.resize(M * W, 0);
+
+            for (size_t l = _level[M - 1] + 1; l > 0; --l)
+            {
+                size_t begin = _level_pos[l - 1];
+                size_t end = std::min(_level_pos[l], M);
+                #pragma omp parallel for num_threads(nt) schedule(runtime) \
+                    if (end - begin > OPENMP_MIN_THRESH)
+                for (size_t c = begin; c < end; ++c)
+                {
+                    uint64_t* r = &rows[c * W];
+                    for (size_t i = _out_pos[c]; i < _out_pos[c + 1]; ++i)
+                    {
+                        size_t w = _out[i];
+                        if (w >= M)
+                            break;
+                        const uint64_t* rw = &rows[w * W];
+                        for (size_t k = 0; k < W; ++k)
+                            r[k] |= rw[k];
+                        if (w >= b0)
+                            r[(w - b0) / 64] |= uint64_t(1) << ((w - b0) % 64);
+                    }
+                }
+            }
+
+            for (size_t c = 0; c < M; ++c)
+            {
+                const uint64_t* r = &rows[c * W];
+                for (size_t k = 0; k < W; ++k)
+                {
+                    for (uint64_t x = r[k]; x != 0; x &= x - 1)
+                        emit(c, b0 + k * 64 + __builtin_ctzll(x));
+                }
+            }
+        }
+    }
+
+    size_t num_vertices() const { return _comp.size(); }
+    size_t num_components() const { return _level.size(); }
+    size_t num_labels() const
+    {
+        return _level.empty() ? 0 : _post.size() / _level.size();
+    }
+
+    // the component of vertex v, in topological order
+    size_t get_comp(size_t v) const
+    {
+        if (v >= _comp.size() || _comp[v] == _null)
+            throw ValueException("Invalid vertex index: " + std::to_string(v));
+        return _comp[v];
+    }
+
+    // whether the component is reachable from itself
+    bool is_cyclic(size_t c) const { return _cyclic[c]; }
+
+    std::pair<std::vector<size_t>::const_iterator,
+              std::vector<size_t>::const_iterator>
+    members(size_t c) const
+    {
+        return {_members.begin() + _member_pos[c],
+                _members.begin() + _member_pos[c + 1]};
+    }
+
+private:
+    bool maybe_reachable(size_t a, size_t b) const
+    {
+        if (_level[a] >= _level[b])
+            return false;
+        size_t C = num_components();
+        for (size_t i = a, j = b; i < _post.size(); i += C, j += C)
+        {
+            if (_low[i] > _low[j] || _post[j] > _post[i])
+                return false;
+        }
+        return true;
+    }
+
+    // Randomized post-order labels, where the roots and the out-edges of
+    // each component are visited from a random offset.
+    void build_labels(size_t n_labels, uint64_t seed, size_t nt)
+    {
+        size_t C = num_components();
+        _post.clear();
+        _post.resize(C * n_labels);
+        _low.clear();
+        _low.resize(C * n_labels);
+
+        size_t nt_labels = std::max(std::min(nt, n_labels), size_t(1));
+        #pragma omp parallel for num_threads(nt_labels) schedule(dynamic) \
+            if (nt_labels > 1)
+        for (size_t k = 0; k < n_labels; ++k)
+        {
+            uint64_t s = random_priority(seed, k);
+            size_t* post = &_post[k * C];
+            size_t* low = &_low[k * C];
+
+            std::vector<uint8_t> visited(C, false);
+            std::vector<std::pair<size_t, size_t>> stack; // component, step
+
+            std::vector<size_t> roots;
+            size_t n_roots = _level_pos.size() > 1 ? _level_pos[1] : 0;
+            for (size_t c = 0; c < n_roots; ++c)
+                roots.push_back(c);
+            std::mt19937_64 rng(s);
+            std::shuffle(roots.begin(), roots.end(), rng);
+
+            size_t n = 0;
+            for (auto r : roots)
+            {
+                visited[r] = true;
+                low[r] = _null;
+                stack.emplace_back(r, 0);
+                while (!stack.empty())
+                {
+                    auto& top = stack.back();
+                    size_t c = top.first;
+                    size_t d = _out_pos[c + 1] - _out_pos[c];
+                    if (top.second < d)
+                    {
+                        size_t i = (random_priority(s, c) + top.second) % d;
+                        ++top.second;
+                        size_t w = _out[_out_pos[c] + i];
+                        if (visited[w])
+                        {
+                            low[c] = std::min(low[c], low[w]);
+                            continue;
+                        }
+                        visited[w] = true;
+                        low[w] = _null;
+                        stack.emplace_back(w, 0);
+                        continue;
+                    }
+                    post[c] = n++;
+                    low[c] = std::min(low[c], post[c]);
+                    stack.pop_back();
+                    if (!stack.empty())
+                    {
+                        size_t p = stack.back().first;
+                        low[p] = std::min(low[p], low[c]);
+                    }
+                }
+            }
+        }
+    }
+
+    static constexpr size_t _null = std::numeric_limits<size_t>::max();
+
+    std::vector<size_t> _comp;        // component of each vertex
+    std::vector<size_t> _level;       // level of each component
+    std::vector<size_t> _level_pos;   // first component of each level
+    std::vector<uint8_t> _cyclic;     // component reaches itself
+    std::vector<size_t> _out_pos;     // out-edges of the components
+    std::vector<size_t> _out;
+    std::vector<size_t> _member_pos;  // vertices of the components
+    std::vector<size_t> _members;
+    std::vector<size_t> _post;        // labels, for each traversal
+    std::vector<size_t> _low;
+};
+
+} // namespace graph_tool
+
+#endif // GRAPH_REACHABILITY_HH
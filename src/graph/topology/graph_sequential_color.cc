@@ -18,6 +18,9 @@
 #include "graph_filtering.hh"
 #include "graph.hh"
 #include "graph_properties.hh"
+#include "random.hh"
+
+#include "graph_vertex_coloring.hh"
 
 #include <boost/graph/sequential_vertex_coloring.hpp>
 
@@ -49,3 +52,67 @@ size_t sequential_coloring(GraphInterface& gi, boost::any order,
          vertex_integer_properties(), int_properties())(order, color);
     return nc;
 }
+
+size_t parallel_coloring(GraphInterface& gi, string order, boost::any aorder,
+                         boost::any color, rng_t& rng)
+{
+    vector<uint64_t> key;
+    if (!aorder.empty())
+    {
+        // the ranks of the vertices in increasing order of the given values
+        run_action<>()
+            (gi,
+             [&](auto& g, auto o)
+             {
+                 vector<size_t> vs;
+                 for (auto v : vertices_range(g))
+                     vs.push_back(v);
+                 std::stable_sort(vs.begin(), vs.end(),
+                                  [&](auto u, auto v) { return o[u] < o[v]; });
+                 key.resize(num_vertices(g), 0);
+                 for (size_t i = 0; i < vs.size(); ++i)
+                     key[vs[i]] = i;
+             },
+             vertex_scalar_properties())(aorder);
+    }
+    else if (order == "largest-first")
+    {
+        run_action<>()
+            (gi, [&](auto& g) { largest_first_key(g, key); })();
+    }
+    else if (order == "smallest-last")
+    {
+        run_action<>()
+            (gi, [&](auto& g) { smallest_last_key(g, key); })();
+    }
+    else if (order == "random")
+    {
+        uint64_t seed = rng();
+        seed = (seed << 32) | rng();
+        run_action<>()
+            (gi, [&](auto& g) { random_key(g, seed, key); })();
+    }
+    else if (order == "index")
+    {
+        run_action<>()
+            (gi,
+             [&](auto& g)
+             {
+                 key.resize(num_vertices(g), 0);
+             })();
+    }
+    else
+    {
+        throw ValueException("invalid coloring order: " + order);
+    }
+
+    size_t nc = 0;
+    run_action<>()
+        (gi,
+         [&](auto& g, auto c)
+         {
+             nc = parallel_greedy_coloring(g, key, c);
+         },
+         int_properties())(color);
+    return nc;
+}
@@ -23,6 +23,9 @@
 #include <boost/graph/vf2_sub_graph_iso.hpp>
 #include <graph_python_interface.hh>
 
+#include "graph_subgraph_isomorphism.hh"
+#include "numpy_bind.hh"
+
 using namespace graph_tool;
 using namespace boost;
 using namespace std;
@@ -174,34 +177,22 @@ struct get_subgraphs
 
 };
 
-boost::python::object
-subgraph_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
-                     boost::any vertex_label1, boost::any vertex_label2,
-                     boost::any edge_label1, boost::any edge_label2,
-                     size_t max_n, bool induced, bool iso, bool generator)
+typedef vprop_map_t<int64_t>::type vlabel_t;
+typedef mpl::vector2<typename vlabel_t::unchecked_t,
+                     UnityPropertyMap<bool,
+                                      GraphInterface::vertex_t> > vertex_props_t;
+
+typedef eprop_map_t<int64_t>::type elabel_t;
+typedef mpl::vector2<typename elabel_t::unchecked_t,
+                     UnityPropertyMap<bool,
+                                      GraphInterface::edge_t> > edge_props_t;
+
+// replaces the labels by their unchecked versions, or by unity maps if they
+// are not given
+void get_match_labels(GraphInterface& gi1, GraphInterface& gi2,
+                      boost::any& vertex_label1, boost::any& vertex_label2,
+                      boost::any& edge_label1, boost::any& edge_label2)
 {
-    // typedef mpl::push_back<vertex_properties,
-    //                        UnityPropertyMap<bool,GraphInterface::vertex_t> >
-    //     ::type vertex_props_t;
-
-    // typedef mpl::push_back<edge_properties,
-    //                        UnityPropertyMap<bool,GraphInterface::edge_t> >
-    //     ::type edge_props_t;
-
-    typedef vprop_map_t<int64_t>::type vlabel_t;
-    typedef mpl::vector2<typename vlabel_t::unchecked_t,
-                         UnityPropertyMap<bool,
-                                          GraphInterface::vertex_t> > vertex_props_t;
-
-    typedef eprop_map_t<int64_t>::type elabel_t;
-    typedef mpl::vector2<typename elabel_t::unchecked_t,
-                         UnityPropertyMap<bool,
-                                          GraphInterface::edge_t> > edge_props_t;
-
-
-    if (gi1.get_directed() != gi2.get_directed())
-        return boost::python::object();
-
     if (vertex_label1.empty() || vertex_label2.empty())
     {
         vertex_label1 = vertex_label2 =
@@ -223,6 +214,19 @@ subgraph_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
         edge_label1 = any_cast<elabel_t>(edge_label1).get_unchecked(gi1.get_edge_index_range());
         edge_label2 = any_cast<elabel_t>(edge_label2).get_unchecked(gi2.get_edge_index_range());
     }
+}
+
+boost::python::object
+subgraph_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
+                     boost::any vertex_label1, boost::any vertex_label2,
+                     boost::any edge_label1, boost::any edge_label2,
+                     size_t max_n, bool induced, bool iso, bool generator)
+{
+    if (gi1.get_directed() != gi2.get_directed())
+        return boost::python::object();
+
+    get_match_labels(gi1, gi2, vertex_label1, vertex_label2, edge_label1,
+                     edge_label2);
 
     vector<vlabel_t> vmaps;
     if (!generator)
@@ -263,3 +267,42 @@ subgraph_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
 #endif
     }
 }
+
+// Parallel enumeration of subgraph matches, returned either as their count,
+// or as a flat array with one row of matched vertices per match.
+boost::python::object
+subgraph_isomorphism_parallel(GraphInterface& gi1, GraphInterface& gi2,
+                              boost::any vertex_label1,
+                              boost::any vertex_label2,
+                              boost::any edge_label1, boost::any edge_label2,
+                              size_t max_n, bool induced, bool count_only)
+{
+    if (gi1.get_directed() != gi2.get_directed())
+        throw ValueException("both graphs must have the same directionality");
+
+    get_match_labels(gi1, gi2, vertex_label1, vertex_label2, edge_label1,
+                     edge_label2);
+
+    size_t count = 0;
+    vector<int64_t> matches;
+    gt_dispatch<>()
+        ([&](auto& sub, auto& g, auto vlabel1, auto elabel1)
+         {
+             typedef decltype(vlabel1) vl_t;
+             typedef decltype(elabel1) el_t;
+             parallel_subgraph_matcher<std::remove_reference_t<decltype(sub)>,
+                                       std::remove_reference_t<decltype(g)>,
+                                       vl_t, vl_t, el_t, el_t>
+                 match(sub, g, vlabel1, any_cast<vl_t>(vertex_label2),
+                       elabel1, any_cast<el_t>(edge_label2), induced);
+             count = match(max_n, !count_only, matches);
+         },
+         all_graph_views(), all_graph_views(), vertex_props_t(),
+         edge_props_t())
+        (gi1.get_graph_view(), gi2.get_graph_view(), vertex_label1,
+         edge_label1);
+
+    if (count_only)
+        return boost::python::object(count);
+    return wrap_vector_owned(matches);
+}
@@ -0,0 +1,392 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_SUBGRAPH_ISOMORPHISM_HH
+#define GRAPH_SUBGRAPH_ISOMORPHISM_HH
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_parallel_traversal.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Parallel enumeration of the embeddings of a small pattern graph in a large
+// graph, as (induced or not) subgraph isomorphisms, by backtracking.
+//
+// The pattern vertices are matched in a fixed order, starting from the one of
+// largest degree, and then always the one with most edges to those already
+// placed, so that the candidates for each position can be taken from the
+// neighbors of an already matched vertex, instead of the whole graph. The
+// candidates are filtered by vertex label and degree before the edges to the
+// matched vertices are checked, with their labels compared as multisets (so
+// that parallel edges are matched with multiplicity).
+//
+// The search tree is split at its first two levels: the partial matches of
+// one and two vertices are the items of a work-stealing loop, and are
+// completed sequentially by the thread that takes them, so that the work of
+// a high-degree candidate is shared among the threads.
+template <class Pattern, class Graph, class VLabel1, class VLabel2,
+          class ELabel1, class ELabel2>
+class parallel_subgraph_matcher
+{
+public:
+    parallel_subgraph_matcher(const Pattern& sub, const Graph& g,
+                              VLabel1 vlabel1, VLabel2 vlabel2,
+                              ELabel1 elabel1, ELabel2 elabel2, bool induced)
+        : _g(g), _vlabel2(vlabel2), _elabel2(elabel2), _induced(induced),
+          _directed(graph_tool::is_directed(g))
+    {
+        vector<size_t> pos(num_vertices(sub));
+        for (auto u : vertices_range(sub))
+        {
+            pos[u] = _k++;
+            _plabel.push_back(get(vlabel1, u));
+            _pout.push_back(out_degree(u, sub));
+            _pin.push_back(_directed ? in_degreeS()(u, sub) : 0);
+        }
+
+        _pedges.resize(_k * _k);
+        for (auto u : vertices_range(sub))
+        {
+            for (auto e : out_edges_range(u, sub))
+                _pedges[pos[u] * _k + pos[target(e, sub)]]
+                    .push_back(get(elabel1, e));
+        }
+        for (auto& ls : _pedges)
+            std::sort(ls.begin(), ls.end());
+
+        build_order();
+    }
+
+    // Finds the matches (at most max_n, if max_n > 0), and returns their
+    // number. If store is true, they are appended to matches, as rows of k
+    // vertices of g, in the order of the vertices of the pattern.
+    size_t operator()(size_t max_n, bool store, vector<int64_t>& matches)
+    {
+        size_t nt = get_traversal_threads(num_vertices(_g));
+        vector<thread_state> states(nt);
+        for (auto& st : states)
+        {
+            st.m.resize(_k);
+            st.cand.resize(_k);
+        }
+
+        std::atomic<size_t> n_found(0);
+        std::atomic<bool> stop(false);
+
+        auto visit = [&](thread_state& st)
+            {
+                if (max_n > 0 && n_found.fetch_add(1) >= max_n)
+                {
+                    stop = true;
+                    return;
+                }
+                ++st.count;
+                if (store)
+                {
+                    size_t i = st.matches.size();
+                    st.matches.resize(i + _k);
+                    for (size_t j = 0; j < _k; ++j)
+                        st.matches[i + _order[j]] = st.m[j];
+                }
+            };
+
+        // first level, in index order
+        vector<item_t> init;
+        for (auto w : vertices_range(_g))
+        {
+            if (feasible(0, w, states[0]))
+                init.push_back({{1, size_t(w), 0}});
+        }
+
+        work_stealing_loop
+            (init, nt,
+             [&](const item_t& item, auto& push)
+             {
+                 if (stop)
+                     return;
+                 size_t tid = 0;
+#ifdef _OPENMP
+                 if (nt > 1)
+                     tid = omp_get_thread_num();
+#endif
+                 auto& st = states[tid];
+                 size_t depth = item[0];
+                 st.m[0] = item[1];
+                 if (depth > 1)
+                     st.m[1] = item[2];
+
+                 if (depth == _k)
+                 {
+                     visit(st);
+                     return;
+                 }
+
+                 if (depth == 1)
+                 {
+                     for_each_candidate(1, st,
+                                        [&](size_t w)
+                                        {
+                                            push({{2, st.m[0], w}});
+                                        });
+                     return;
+                 }
+
+                 extend(2, st, stop, visit);
+             });
+
+        size_t count = 0;
+        for (auto& st : states)
+        {
+            count += st.count;
+            if (store)
+                matches.insert(matches.end(), st.matches.begin(),
+                               st.matches.end());
+        }
+        return count;
+    }
+
+    size_t pattern_size() const { return _k; }
+
+private:
+    typedef std::array<size_t, 3> item_t; // depth, first two matches
+
+    struct thread_state
+    {
+        vector<size_t> m;                 // matched vertices, by position
+        vector<vector<size_t>> cand;      // candidates, by position
+        vector<int64_t> labels;
+        vector<int64_t> matches;
+        size_t count = 0;
+    };
+
+    void build_order()
+    {
+        auto connected = [&](size_t a, size_t b)
+            {
+                return !_pedges[a * _k + b].empty() ||
+                    !_pedges[b * _k + a].empty();
+            };
+
+        vector<uint8_t> placed(_k, false);
+        vector<size_t> links(_k, 0);
+        for (size_t i = 0; i < _k; ++i)
+        {
+            size_t best = _k;
+            for (size_t u = 0; u < _k; ++u)
+            {
+                if (placed[u])
+                    continue;
+                if (best == _k ||
+                    make_pair(links[u], _pout[u] + _pin[u]) >
+                    make_pair(links[best], _pout[best] + _pin[best]))
+                    best = u;
+            }
+            placed[best] = true;
+
+            // the first placed neighbor provides the candidates
+            size_t parent = _k;
+            bool out = true;
+            for (size_t j = 0; j < i; ++j)
+            {
+                if (connected(_order[j], best))
+                {
+                    parent = j;
+                    out = !_pedges[_order[j] * _k + best].empty();
+                    break;
+                }
+            }
+
+            _order.push_back(best);
+            _parent.push_back(parent);
+            _parent_out.push_back(out);
+
+            for (size_t u = 0; u < _k; ++u)
+            {
+                if (!placed[u] && connected(u, best))
+                    ++links[u];
+            }
+        }
+    }
+
+    // label and degree filter for position i
+    bool compatible(size_t i, size_t w) const
+    {
+        size_t u = _order[i];
+        if (int64_t(get(_vlabel2, w)) != _plabel[u])
+            return false;
+        if (out_degree(w, _g) < _pout[u])
+            return false;
+        if (_directed && in_degreeS()(w, _g) < _pin[u])
+            return false;
+        return true;
+    }
+
+    // do the edges x -> y of g match the edges a -> b of the pattern?
+    bool edges_match(size_t a, size_t b, size_t x, size_t y,
+                     vector<int64_t>& labels) const
+    {
+        auto& pl = _pedges[a * _k + b];
+        if (pl.empty() && !_induced)
+            return true;
+
+        labels.clear();
+        if (_directed)
+        {
+            if (out_degree(x, _g) <= in_degreeS()(y, _g))
+            {
+                for (auto e : out_edges_range(x, _g))
+                    if (size_t(target(e, _g)) == y)
+                        labels.push_back(get(_elabel2, e));
+            }
+            else
+            {
+                for (auto e : in_edges_range(y, _g))
+                    if (size_t(source(e, _g)) == x)
+                        labels.push_back(get(_elabel2, e));
+            }
+        }
+        else
+        {
+            if (out_degree(y, _g) < out_degree(x, _g))
+                std::swap(x, y);
+            for (auto e : out_edges_range(x, _g))
+                if (size_t(target(e, _g)) == y)
+                    labels.push_back(get(_elabel2, e));
+        }
+
+        if (labels.size() < pl.size() ||
+            (_induced && labels.size() != pl.size()))
+            return false;
+        std::sort(labels.begin(), labels.end());
+        if (_induced)
+            return labels == pl;
+        return std::includes(labels.begin(), labels.end(), pl.begin(),
+                             pl.end());
+    }
+
+    // can w be placed at position i, given the previous ones?
+    bool feasible(size_t i, size_t w, thread_state& st) const
+    {
+        if (!compatible(i, w))
+            return false;
+        for (size_t j = 0; j < i; ++j)
+        {
+            if (st.m[j] == w)
+                return false;
+        }
+        size_t u = _order[i];
+        if (!edges_match(u, u, w, w, st.labels))
+            return false;
+        for (size_t j = 0; j < i; ++j)
+        {
+            size_t p = _order[j];
+            size_t x = st.m[j];
+            if (!edges_match(u, p, w, x, st.labels))
+                return false;
+            if (_directed && !edges_match(p, u, x, w, st.labels))
+                return false;
+        }
+        return true;
+    }
+
+    template <class F>
+    void for_each_candidate(size_t i, thread_state& st, F&& f) const
+    {
+        auto& cand = st.cand[i];
+        cand.clear();
+        if (_parent[i] == _k)
+        {
+            for (auto w : vertices_range(_g))
+                cand.push_back(w);
+        }
+        else
+        {
+            size_t x = st.m[_parent[i]];
+            if (_parent_out[i])
+            {
+                for (auto e : out_edges_range(x, _g))
+                    cand.push_back(target(e, _g));
+            }
+            else
+            {
+                for (auto e : in_edges_range(x, _g))
+                    cand.push_back(source(e, _g));
+            }
+            // parallel edges give repeated candidates
+            std::sort(cand.begin(), cand.end());
+            cand.erase(std::unique(cand.begin(), cand.end()), cand.end());
+        }
+
+        for (auto w : cand)
+        {
+            if (feasible(i, w, st))
+                f(w);
+        }
+    }
+
+    template <class Visit>
+    void extend(size_t i, thread_state& st, std::atomic<bool>& stop,
+                Visit& visit) const
+    {
+        if (i == _k)
+        {
+            visit(st);
+            return;
+        }
+        for_each_candidate(i, st,
+                           [&](size_t w)
+                           {
+                               if (stop)
+                                   return;
+                               st.m[i] = w;
+                               extend(i + 1, st, stop, visit);
+                           });
+    }
+
+    const Graph& _g;
+    VLabel2 _vlabel2;
+    ELabel2 _elabel2;
+    bool _induced;
+    bool _directed;
+
+    size_t _k = 0;
+    vector<int64_t> _plabel;
+    vector<size_t> _pout;
+    vector<size_t> _pin;
+    vector<vector<int64_t>> _pedges;    // edge labels between positions
+
+    vector<size_t> _order;              // pattern vertex at each position
+    vector<size_t> _parent;             // position providing the candidates
+    vector<uint8_t> _parent_out;        // candidates are out-neighbors
+};
+
+} // graph_tool namespace
+
+#endif // GRAPH_SUBGRAPH_ISOMORPHISM_HH
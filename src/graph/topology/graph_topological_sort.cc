@@ -18,6 +18,7 @@
 #include "graph_filtering.hh"
 #include "graph.hh"
 #include "graph_properties.hh"
+#include "graph_parallel_traversal.hh"
 
 #include <boost/graph/topological_sort.hpp>
 
@@ -31,7 +32,18 @@ struct get_topological_sort
     void operator()(const Graph& g, vector<int32_t>& sort) const
     {
         sort.clear();
-        topological_sort(g, std::back_inserter(sort));
+        if (get_traversal_threads(num_vertices(g)) > 1)
+        {
+            vector<size_t> psort;
+            if (!parallel_topological_sort(g, psort))
+                throw not_a_dag();
+            // the order is reversed, as with topological_sort() below
+            sort.assign(psort.rbegin(), psort.rend());
+        }
+        else
+        {
+            topological_sort(g, std::back_inserter(sort));
+        }
     }
 };
 
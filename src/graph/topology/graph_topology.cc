@@ -28,12 +28,16 @@ using namespace std;
 bool check_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
                        boost::any ainv_map1, boost::any ainv_map2,
                        int64_t max_inv, boost::any aiso_map);
+python::tuple wl_hash(GraphInterface& gi, boost::any acolor, size_t max_iter);
 void get_kruskal_spanning_tree(GraphInterface& gi, boost::any weight_map,
                                boost::any tree_map);
 void get_prim_spanning_tree(GraphInterface& gi, size_t root,
                             boost::any weight_map, boost::any tree_map);
 bool topological_sort(GraphInterface& gi, vector<int32_t>& sort);
 void dominator_tree(GraphInterface& gi, size_t entry, boost::any pred_map);
+void dominator_tree_batch(python::object oedges, python::object oeoffset,
+                          python::object ovoffset, python::object oroots,
+                          python::object odom);
 void transitive_closure(GraphInterface& gi, GraphInterface& tcgi);
 bool is_planar(GraphInterface& gi, boost::any embed_map, boost::any kur_map);
 void maximal_planar(GraphInterface& gi);
@@ -43,14 +47,28 @@ python::object subgraph_isomorphism(GraphInterface& gi1, GraphInterface& gi2,
                                     boost::any edge_label1,
                                     boost::any edge_label2, size_t max_n,
                                     bool induced, bool iso, bool generator);
+python::object
+subgraph_isomorphism_parallel(GraphInterface& gi1, GraphInterface& gi2,
+                              boost::any vertex_label1,
+                              boost::any vertex_label2,
+                              boost::any edge_label1, boost::any edge_label2,
+                              size_t max_n, bool induced, bool count_only);
 double reciprocity(GraphInterface& gi);
 size_t sequential_coloring(GraphInterface& gi, boost::any order,
                            boost::any color);
+size_t parallel_coloring(GraphInterface& gi, string order, boost::any aorder,
+                         boost::any color, rng_t& rng);
 bool is_bipartite(GraphInterface& gi, boost::any part_map, bool find_cycle,
                   boost::python::list cycle);
 void get_random_spanning_tree(GraphInterface& gi, size_t root,
                               boost::any weight_map, boost::any tree_map,
                               rng_t& rng);
+void get_random_spanning_trees(GraphInterface& gi, size_t root, size_t n,
+                               boost::any weight_map, python::object otrees,
+                               rng_t& rng);
+void get_random_spanning_tree_counts(GraphInterface& gi, size_t root, size_t n,
+                                     boost::any weight_map,
+                                     boost::any count_map, rng_t& rng);
 vector<int32_t> get_tsp(GraphInterface& gi, size_t src, boost::any weight_map);
 
 void export_components();
@@ -62,25 +80,35 @@ void export_all_dists();
 void export_all_circuits();
 void export_diam();
 void export_random_matching();
+void export_parallel_matching();
 void export_maximal_vertex_set();
 void export_vertex_similarity();
+void export_minhash();
+void export_contraction_hierarchy();
+void export_reachability();
 
 
 BOOST_PYTHON_MODULE(libgraph_tool_topology)
 {
     def("check_isomorphism", &check_isomorphism);
+    def("wl_hash", &wl_hash);
     def("subgraph_isomorphism", &subgraph_isomorphism);
+    def("subgraph_isomorphism_parallel", &subgraph_isomorphism_parallel);
     def("get_kruskal_spanning_tree", &get_kruskal_spanning_tree);
     def("get_prim_spanning_tree", &get_prim_spanning_tree);
     def("topological_sort", &topological_sort);
     def("dominator_tree", &dominator_tree);
+    def("dominator_tree_batch", &dominator_tree_batch);
     def("transitive_closure", &transitive_closure);
     def("is_planar", &is_planar);
     def("maximal_planar", &maximal_planar);
     def("reciprocity", &reciprocity);
     def("sequential_coloring", &sequential_coloring);
+    def("parallel_coloring", &parallel_coloring);
     def("is_bipartite", &is_bipartite);
     def("random_spanning_tree", &get_random_spanning_tree);
+    def("random_spanning_trees", &get_random_spanning_trees);
+    def("random_spanning_tree_counts", &get_random_spanning_tree_counts);
     def("get_tsp", &get_tsp);
     export_components();
     export_kcore();
@@ -91,6 +119,10 @@ BOOST_PYTHON_MODULE(libgraph_tool_topology)
     export_all_circuits();
     export_diam();
     export_random_matching();
+    export_parallel_matching();
     export_maximal_vertex_set();
     export_vertex_similarity();
+    export_minhash();
+    export_contraction_hierarchy();
+    export_reachability();
 }
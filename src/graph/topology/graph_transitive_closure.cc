@@ -16,23 +16,51 @@
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include <boost/python.hpp>
-#include <boost/graph/transitive_closure.hpp>
 
 #include "graph.hh"
 #include "graph_filtering.hh"
 #include "graph_properties.hh"
+#include "graph_parallel_traversal.hh"
+
+#include "graph_reachability.hh"
 
 
 
 using namespace graph_tool;
 using namespace boost;
 
+// The graph is condensed into its strong components, and the components
+// reachable from each of them are found as bit rows, in parallel and in
+// topological order, for blocks of target components that fit in a bounded
+// amount of memory (see ReachabilityIndex::closure()). The closure edges are
+// then added between the members of the components.
 struct get_transitive_closure
 {
     template <class Graph,  class TCGraph>
     void operator()(Graph& g, TCGraph& tcg) const
     {
-        boost::transitive_closure(g, tcg);
+        size_t N = num_vertices(g);
+        for (size_t i = num_vertices(tcg); i < N; ++i)
+            add_vertex(tcg);
+
+        ReachabilityIndex idx;
+        idx.build(g, 0, 0);
+
+        auto add_edges = [&](size_t a, size_t b)
+            {
+                for (auto u : mk_range(idx.members(a)))
+                    for (auto v : mk_range(idx.members(b)))
+                        add_edge(vertex(u, tcg), vertex(v, tcg), tcg);
+            };
+
+        // the vertices of a cycle reach each other, and themselves
+        for (size_t c = 0; c < idx.num_components(); ++c)
+        {
+            if (idx.is_cyclic(c))
+                add_edges(c, c);
+        }
+
+        idx.closure(size_t(1) << 28, add_edges);
     }
 };
 
@@ -0,0 +1,176 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_VERTEX_COLORING_HH
+#define GRAPH_VERTEX_COLORING_HH
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graph_util.hh"
+#include "graph_parallel_traversal.hh"
+#include "graph_kcore.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Greedy coloring in the order given by key (in increasing order of key[v],
+// and of the vertex index for the same key), where each vertex gets the
+// smallest color not used by its neighbors (in either direction).
+//
+// This is done in parallel as in the algorithm of Jones and Plassmann: a
+// vertex is colored as soon as all its neighbors that precede it are, by work
+// stealing, with a counter of uncolored predecessors per vertex, as in the
+// parallel topological sort. Since every vertex sees the final colors of all
+// its predecessors, and none of its successors, the result is identical to the
+// sequential greedy coloring in the same order, regardless of the number of
+// threads. The depth of the computation is the longest path of decreasing
+// priority, which is small for the orders below. Returns the number of colors.
+template <class Graph, class ColorMap>
+size_t parallel_greedy_coloring(const Graph& g, const vector<uint64_t>& key,
+                                ColorMap color)
+{
+    size_t N = num_vertices(g);
+    size_t nt = get_traversal_threads(N);
+
+    auto before = [&](size_t u, size_t v)
+        {
+            return key[u] < key[v] || (key[u] == key[v] && u < v);
+        };
+
+    std::unique_ptr<std::atomic<size_t>[]> count(new std::atomic<size_t>[N]);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             size_t c = 0;
+             for (auto u : all_neighbors_range(v, g))
+             {
+                 if (before(u, v))
+                     ++c;
+             }
+             count[v].store(c, std::memory_order_relaxed);
+         });
+
+    vector<size_t> init;
+    for (auto v : vertices_range(g))
+    {
+        if (count[v] == 0)
+            init.push_back(v);
+    }
+
+    // colors used by the predecessors, marked with the index of the vertex
+    vector<vector<size_t>> mark(nt);
+    vector<size_t> max_color(nt, 0);
+
+    work_stealing_loop
+        (init, nt,
+         [&](size_t v, auto& push)
+         {
+             size_t tid = 0;
+#ifdef _OPENMP
+             if (nt > 1)
+                 tid = omp_get_thread_num();
+#endif
+             auto& m = mark[tid];
+             auto w = vertex(v, g);
+             for (auto u : all_neighbors_range(w, g))
+             {
+                 if (!before(u, v))
+                     continue;
+                 size_t c = color[u];
+                 if (c >= m.size())
+                     m.resize(c + 1, 0);
+                 m[c] = v + 1;
+             }
+
+             size_t c = 0;
+             while (c < m.size() && m[c] == v + 1)
+                 ++c;
+             color[w] = c;
+             max_color[tid] = std::max(max_color[tid], c + 1);
+
+             // the color is visible to those who see the decrement
+             for (auto u : all_neighbors_range(w, g))
+             {
+                 if (size_t(u) == v || before(u, v))
+                     continue;
+                 if (count[u].fetch_sub(1) == 1)
+                     push(u);
+             }
+         });
+
+    return *std::max_element(max_color.begin(), max_color.end());
+}
+
+// Keys for the largest-first order, by decreasing total degree.
+template <class Graph>
+void largest_first_key(const Graph& g, vector<uint64_t>& key)
+{
+    key.clear();
+    key.resize(num_vertices(g), 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             key[v] = numeric_limits<uint64_t>::max() - total_degreeS()(v, g);
+         });
+}
+
+// Keys for the smallest-last order, given by the reverse of the removal order
+// of the k-core decomposition, so that the vertices of the inner cores are
+// colored first. With several threads, the vertices removed in the same
+// frontier of the peeling get the same key (and are colored in index order).
+template <class Graph>
+void smallest_last_key(Graph& g, vector<uint64_t>& key)
+{
+    key.clear();
+    key.resize(num_vertices(g), 0);
+    vector<size_t> core(num_vertices(g));
+    kcore_decomposition(g, core.data(),
+                        [&](size_t v, size_t r)
+                        {
+                            key[v] = numeric_limits<uint64_t>::max() - r;
+                        });
+}
+
+// Keys for a random order.
+template <class Graph>
+void random_key(const Graph& g, uint64_t seed, vector<uint64_t>& key)
+{
+    key.clear();
+    key.resize(num_vertices(g), 0);
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             key[v] = random_priority(seed, v);
+         });
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_VERTEX_COLORING_HH
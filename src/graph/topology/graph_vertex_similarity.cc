@@ -129,6 +129,61 @@ void get_inv_log_weight_similarity_pairs(GraphInterface& gi,
 }
 
 
+python::object get_similarity_sparse(GraphInterface& gi, string sim_type,
+                                     bool self_loop, size_t top_k,
+                                     double threshold)
+{
+    vector<std::array<int64_t, 2>> pairs;
+    vector<double> sims;
+
+    gt_dispatch<>()
+        ([&](auto& g)
+         {
+             auto k = [&](auto v) -> double { return out_degree(v, g); };
+             auto one = [](auto) { return 1.; };
+             if (sim_type == "dice")
+             {
+                 sparse_pairs_similarity
+                     (g, self_loop, top_k, threshold, one,
+                      [&](auto u, auto v, double c)
+                      {
+                          return 2 * c / (k(u) + k(v));
+                      }, pairs, sims);
+             }
+             else if (sim_type == "jaccard")
+             {
+                 sparse_pairs_similarity
+                     (g, self_loop, top_k, threshold, one,
+                      [&](auto u, auto v, double c)
+                      {
+                          return c / (k(u) + k(v) - c);
+                      }, pairs, sims);
+             }
+             else if (sim_type == "inv-log-weight")
+             {
+                 sparse_pairs_similarity
+                     (g, false, top_k, threshold,
+                      [&](auto w)
+                      {
+                          if (graph_tool::is_directed(g))
+                              return 1. / log(in_degreeS()(w, g));
+                          else
+                              return 1. / log(out_degree(w, g));
+                      },
+                      [](auto, auto, double c) { return c; }, pairs, sims);
+             }
+             else
+             {
+                 throw ValueException("Invalid similarity type: " + sim_type);
+             }
+         },
+         all_graph_views())
+        (gi.get_graph_view());
+
+    return python::make_tuple(wrap_vector_owned<int64_t, 2>(pairs),
+                              wrap_vector_owned(sims));
+}
+
 void export_vertex_similarity()
 {
     python::def("dice_similarity", &get_dice_similarity);
@@ -138,4 +193,5 @@ void export_vertex_similarity()
     python::def("inv_log_weight_similarity", &get_inv_log_weight_similarity);
     python::def("inv_log_weight_similarity_pairs",
                 &get_inv_log_weight_similarity_pairs);
+    python::def("similarity_sparse", &get_similarity_sparse);
 };
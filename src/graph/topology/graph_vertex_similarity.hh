@@ -18,7 +18,12 @@
 #ifndef GRAPH_VERTEX_SIMILARITY_HH
 #define GRAPH_VERTEX_SIMILARITY_HH
 
+#include <vector>
+#include <array>
+#include <algorithm>
+
 #include "graph_util.hh"
+#include "graph_scratch.hh"
 
 namespace graph_tool
 {
@@ -98,33 +103,160 @@ double inv_log_weighted(Vertex u, Vertex v, Mark& mark, Graph& g)
 template <class Graph, class VMap, class Sim>
 void all_pairs_similarity(Graph& g, VMap s, Sim&& f)
 {
-    vector<bool> mask(num_vertices(g), false);
-    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-        firstprivate(mask)
-    parallel_vertex_loop_no_spawn
-        (g,
-         [&](auto v)
-         {
-             s[v].resize(num_vertices(g));
-             for (auto w : vertices_range(g))
-                 s[v][w] = f(v, w, mask);
-         });
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+    {
+        auto buf = get_scratch<stamped_buffer<uint8_t>>();
+        auto mask = buf->get_map(num_vertices(g), false);
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 s[v].resize(num_vertices(g));
+                 for (auto w : vertices_range(g))
+                     s[v][w] = f(v, w, mask);
+             });
+    }
 }
 
 template <class Graph, class Vlist, class Slist, class Sim>
 void some_pairs_similarity(Graph& g, Vlist& vlist, Slist& slist, Sim&& f)
 {
-    vector<bool> mask(num_vertices(g), false);
-    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-        firstprivate(mask)
-    parallel_loop_no_spawn
-        (vlist,
-         [&](size_t i, const auto& val)
-         {
-             size_t u = val[0];
-             size_t v = val[1];
-             slist[i] = f(u, v, mask);
-         });
+    #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH)
+    {
+        auto buf = get_scratch<stamped_buffer<uint8_t>>();
+        auto mask = buf->get_map(num_vertices(g), false);
+        parallel_loop_no_spawn
+            (vlist,
+             [&](size_t i, const auto& val)
+             {
+                 size_t u = val[0];
+                 size_t v = val[1];
+                 slist[i] = f(u, v, mask);
+             });
+    }
+}
+
+// Sparse all-pairs similarity, restricted to the pairs of distinct vertices
+// that share at least one neighbor (all other pairs have zero similarity).
+// For each vertex v, the weights w(x) of its distinct neighbors x (and of v
+// itself, if self_loop is true) are accumulated on the vertices pointing to
+// them, by walking the two-hop neighborhood with a per-thread dense counter,
+// and the similarity is obtained as f(v, u, c), where c is the accumulated
+// weight of u; this costs O(sum_x k_x^2) instead of O(<k> N^2).
+//
+// Only the pairs with a similarity larger or equal to threshold are kept, and,
+// if top_k > 0, at most the top_k most similar ones for each vertex, in
+// decreasing order of similarity (ties broken by vertex index). The result is
+// ordered by the first vertex.
+template <class Graph, class Weight, class Sim>
+void sparse_pairs_similarity(Graph& g, bool self_loop, size_t top_k,
+                             double threshold, Weight&& weight, Sim&& f,
+                             vector<std::array<int64_t, 2>>& pairs,
+                             vector<double>& sims)
+{
+    size_t N = num_vertices(g);
+
+    // per-vertex results are stored in per-thread buffers, and then moved to
+    // the final position given by their counts
+    vector<size_t> count(N, 0);
+    vector<vector<pair<size_t, size_t>>> blocks; // (vertex, start)
+    vector<vector<pair<double, size_t>>> results;
+
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH)
+    {
+        auto c_buf = get_scratch<stamped_buffer<double>>();
+        auto mark_buf = get_scratch<stamped_buffer<uint8_t>>();
+        auto c = c_buf->get_map(N, 0);
+        auto mark = mark_buf->get_map(N, false);
+        vector<size_t> touched, nbrs;
+        vector<pair<double, size_t>> cand;
+        vector<pair<size_t, size_t>> tblocks;
+        vector<pair<double, size_t>> tresults;
+
+        parallel_vertex_loop_no_spawn
+            (g,
+             [&](auto v)
+             {
+                 nbrs.clear();
+                 for (auto x : adjacent_vertices_range(v, g))
+                 {
+                     if (mark[x])
+                         continue;
+                     mark[x] = true;
+                     nbrs.push_back(x);
+                 }
+                 if (self_loop && !mark[v])
+                 {
+                     mark[v] = true;
+                     nbrs.push_back(v);
+                 }
+
+                 for (auto x : nbrs)
+                 {
+                     mark[x] = false;
+                     double wx = weight(x);
+                     for (auto e : in_or_out_edges_range(x, g))
+                     {
+                         auto u = graph_tool::is_directed(g) ?
+                             source(e, g) : target(e, g);
+                         if (size_t(u) == size_t(v))
+                             continue;
+                         if (c[u] == 0)
+                             touched.push_back(u);
+                         c[u] += wx;
+                     }
+                 }
+
+                 cand.clear();
+                 for (auto u : touched)
+                 {
+                     double s = f(v, u, c[u]);
+                     c[u] = 0;
+                     if (s >= threshold)
+                         cand.emplace_back(-s, u);
+                 }
+                 touched.clear();
+
+                 if (top_k > 0 && cand.size() > top_k)
+                 {
+                     std::nth_element(cand.begin(), cand.begin() + top_k,
+                                      cand.end());
+                     cand.resize(top_k);
+                 }
+                 std::sort(cand.begin(), cand.end());
+
+                 count[v] = cand.size();
+                 tblocks.emplace_back(v, tresults.size());
+                 tresults.insert(tresults.end(), cand.begin(), cand.end());
+             });
+
+        #pragma omp critical
+        {
+            blocks.push_back(std::move(tblocks));
+            results.push_back(std::move(tresults));
+        }
+    }
+
+    vector<size_t> pos(N + 1, 0);
+    for (size_t v = 0; v < N; ++v)
+        pos[v + 1] = pos[v] + count[v];
+    pairs.resize(pos[N]);
+    sims.resize(pos[N]);
+
+    #pragma omp parallel for if (pos[N] > OPENMP_MIN_THRESH) schedule(runtime)
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        for (auto& b : blocks[i])
+        {
+            size_t v = b.first;
+            for (size_t j = 0; j < count[v]; ++j)
+            {
+                auto& r = results[i][b.second + j];
+                pairs[pos[v] + j] = {{int64_t(v), int64_t(r.second)}};
+                sims[pos[v] + j] = -r.first;
+            }
+        }
+    }
 }
 
 } // graph_tool namespace
@@ -0,0 +1,146 @@
+// graph-tool -- a general graph modification and manipulation thingy
+//
+// Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 3
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef GRAPH_WL_HASH_HH
+#define GRAPH_WL_HASH_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "graph_util.hh"
+
+namespace graph_tool
+{
+using namespace std;
+using namespace boost;
+
+// Weisfeiler-Lehman color refinement
+// ==================================
+//
+// At each iteration, the color of every vertex is replaced by a hash of its
+// current color and of the multiset of the colors of its out-neighbors (and,
+// separately, in-neighbors, for directed graphs). The multisets are hashed as
+// sums of mixed values, which are independent of the order of the neighbors, so
+// that the whole procedure is invariant under isomorphism: isomorphic graphs
+// (with the same initial colors) end up with the same colors for
+// corresponding vertices, and hence with the same graph hash. The converse
+// does not hold in general (e.g. for regular graphs with uniform initial
+// colors), but non-isomorphic graphs are almost always distinguished.
+//
+// The refinement stops when the number of distinct colors no longer
+// increases, which is also invariant, or after max_iter iterations (if
+// nonzero).
+
+inline uint64_t wl_mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+template <class Graph, class Color>
+size_t wl_num_colors(Graph& g, Color& color)
+{
+    vector<uint64_t> cs;
+    cs.reserve(num_vertices(g));
+    for (auto v : vertices_range(g))
+        cs.push_back(color[v]);
+    std::sort(cs.begin(), cs.end());
+    return std::unique(cs.begin(), cs.end()) - cs.begin();
+}
+
+// returns the graph hash and the number of iterations performed
+template <class Graph, class Color>
+std::pair<uint64_t, size_t>
+wl_refine(Graph& g, Color color, size_t max_iter)
+{
+    typedef typename property_traits<Color>::value_type val_t;
+
+    constexpr uint64_t out_salt = 0x5851f42d4c957f2dULL;
+    constexpr uint64_t in_salt = 0x14057b7ef767814fULL;
+
+    vector<uint64_t> c(num_vertices(g)), nc(num_vertices(g));
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             c[v] = wl_mix(uint64_t(color[v]));
+         });
+
+    size_t ncolors = wl_num_colors(g, c);
+    size_t iter = 0;
+    while (max_iter == 0 || iter < max_iter)
+    {
+        parallel_vertex_loop
+            (g,
+             [&](auto v)
+             {
+                 uint64_t h_out = 0, h_in = 0;
+                 for (auto w : out_neighbors_range(v, g))
+                     h_out += wl_mix(c[w] ^ out_salt);
+                 if (graph_tool::is_directed(g))
+                 {
+                     for (auto w : in_neighbors_range(v, g))
+                         h_in += wl_mix(c[w] ^ in_salt);
+                 }
+                 nc[v] = wl_mix(c[v] ^ wl_mix(h_out ^ wl_mix(h_in)));
+             });
+        ++iter;
+
+        size_t nnew = wl_num_colors(g, nc);
+        c.swap(nc);
+        if (nnew <= ncolors)
+            break;
+        ncolors = nnew;
+    }
+
+    // the number of vertices must not include the filtered ones
+    size_t N = 0;
+    for (auto v : vertices_range(g))
+    {
+        (void) v;
+        ++N;
+    }
+
+    uint64_t h = wl_mix(N ^ wl_mix(iter));
+    uint64_t sum = 0;
+    #pragma omp parallel for schedule(runtime) reduction(+:sum) \
+        if (num_vertices(g) > OPENMP_MIN_THRESH)
+    for (size_t i = 0; i < num_vertices(g); ++i)
+    {
+        auto v = vertex(i, g);
+        if (!is_valid_vertex(v, g))
+            continue;
+        sum += wl_mix(c[v]);
+    }
+    h = wl_mix(h ^ sum);
+
+    parallel_vertex_loop
+        (g,
+         [&](auto v)
+         {
+             color[v] = val_t(c[v]);
+         });
+
+    return {h, iter};
+}
+
+} // graph_tool namespace
+
+#endif // GRAPH_WL_HASH_HH
@@ -28,23 +28,24 @@ using namespace boost;
 using namespace graph_tool;
 
 // find vertices which match a certain (inclusive) property range
-python::list
+python::object
 find_vertex_range(GraphInterface& gi, GraphInterface::deg_t deg,
-                  python::tuple range)
+                  python::tuple range, bool as_array)
 {
-    python::list ret;
+    python::object ret;
     run_action<>()(gi, std::bind(find_vertices(), std::placeholders::_1, std::ref(gi),
                                  std::placeholders::_2, std::ref(range),
-                                 std::ref(ret)),
+                                 as_array, std::ref(ret)),
                    all_selectors())(degree_selector(deg));
     return ret;
 }
 
 // find edges which match a certain (inclusive) property range
-python::list
-find_edge_range(GraphInterface& gi, boost::any eprop, python::tuple range)
+python::object
+find_edge_range(GraphInterface& gi, boost::any eprop, python::tuple range,
+                bool as_array)
 {
-    python::list ret;
+    python::object ret;
     typedef property_map_types::apply<value_types,
                                       GraphInterface::edge_index_map_t,
                                       mpl::bool_<true> >::type
@@ -53,7 +54,8 @@ find_edge_range(GraphInterface& gi, boost::any eprop, python::tuple range)
     GraphInterface::edge_index_map_t eindex =
         any_cast<GraphInterface::edge_index_map_t>(gi.get_edge_index());
     run_action<>()(gi, std::bind(find_edges(), std::placeholders::_1, std::ref(gi), eindex,
-                                 std::placeholders::_2, std::ref(range), std::ref(ret)),
+                                 std::placeholders::_2, std::ref(range), as_array,
+                                 std::ref(ret)),
                    all_edge_props())(eprop);
     return ret;
 }
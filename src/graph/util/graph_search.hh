@@ -21,6 +21,7 @@
 #include "graph_python_interface.hh"
 #include "graph_util.hh"
 #include "hash_map_wrap.hh"
+#include "numpy_bind.hh"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -56,97 +57,160 @@ bool operator<=(const string& s1, const string& s2)
     return (s1.size() <= s2.size());
 }
 
-// find vertices which match a certain (inclusive) property range
+// Collects the values passed by f(v, buf) to buf, for every vertex v, into
+// thread-local buffers, which are then concatenated into ret. Since the vertices
+// are statically partitioned into contiguous chunks, the result is in the same
+// order as a sequential loop, regardless of the number of threads.
+template <class Val, class Graph, class F>
+void collect_vertex_matches(const Graph& g, F&& f, std::vector<Val>& ret,
+                            size_t nt)
+{
+    size_t N = num_vertices(g);
+    std::vector<std::vector<Val>> bufs;
+    std::vector<size_t> offset;
+
+    #pragma omp parallel if (N > OPENMP_MIN_THRESH) num_threads(nt)
+    {
+        size_t nthreads = 1, t = 0;
+        #ifdef _OPENMP
+        nthreads = omp_get_num_threads();
+        t = omp_get_thread_num();
+        #endif
+
+        #pragma omp single
+        bufs.resize(nthreads);
+
+        auto& buf = bufs[t];
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < N; ++i)
+        {
+            auto v = vertex(i, g);
+            if (!is_valid_vertex(v, g))
+                continue;
+            f(v, buf);
+        }
+
+        #pragma omp single
+        {
+            offset.resize(nthreads + 1, 0);
+            for (size_t i = 0; i < nthreads; ++i)
+                offset[i + 1] = offset[i] + bufs[i].size();
+            ret.resize(offset.back());
+        }
+
+        std::copy(buf.begin(), buf.end(), ret.begin() + offset[t]);
+    }
+}
+
+// the maximum number of threads that can be used to compare values of the
+// given type
+template <class ValueType>
+size_t get_search_threads()
+{
+    size_t nt = 1;
+    #ifdef _OPENMP
+    nt = omp_get_max_threads();
+    if (std::is_convertible<ValueType,python::object>::value)
+        nt = 1; // python is not thread-safe
+    #endif
+    return nt;
+}
+
+// find vertices which match a certain (inclusive) property range; the result
+// is either an array of vertex indices, or a list of vertex descriptors
 struct find_vertices
 {
     template <class Graph, class DegreeSelector>
     void operator()(Graph& g, GraphInterface& gi, DegreeSelector deg,
-                    python::tuple& prange, python::list& ret) const
+                    python::tuple& prange, bool as_array,
+                    python::object& ret) const
     {
         typedef typename DegreeSelector::value_type value_type;
         pair<value_type,value_type> range;
         range.first = python::extract<value_type>(prange[0]);
         range.second = python::extract<value_type>(prange[1]);
 
-        #ifdef _OPENMP
-        size_t __attribute__ ((unused)) nt = omp_get_num_threads();
-        if (std::is_convertible<value_type,python::object>::value)
-            nt = 1; // python is not thread-safe
-        #endif
-
-        auto gp = retrieve_graph_view<Graph>(gi, g);
         bool is_eq = range.first == range.second;
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) num_threads(nt)
-        parallel_vertex_loop_no_spawn
+        std::vector<size_t> vs;
+        collect_vertex_matches
             (g,
-             [&](auto v)
+             [&](auto v, auto& buf)
              {
                  value_type val = deg(v, g);
                  if ((is_eq && (val == range.first)) ||
                      (!is_eq && (range.first <= val && val <= range.second)))
-                 {
-                     PythonVertex<Graph> pv(gp, v);
-                     auto& ret_ = ret;  // work around clang
-                     #pragma omp critical
-                     {
-                         ret_.append(pv);
-                     }
-                 }
-             });
+                     buf.push_back(v);
+             }, vs, get_search_threads<value_type>());
+
+        if (as_array)
+        {
+            ret = wrap_vector_owned(vs);
+            return;
+        }
+
+        auto gp = retrieve_graph_view<Graph>(gi, g);
+        python::list lret;
+        for (auto v : vs)
+            lret.append(PythonVertex<Graph>(gp, v));
+        ret = lret;
     }
 };
 
-// find edges which match a certain (inclusive) property range
+// find edges which match a certain (inclusive) property range; the result is
+// either a flattened array with rows [source, target, index], or a list of
+// edge descriptors
 struct find_edges
 {
     template <class Graph, class EdgeIndex, class EdgeProperty>
     void operator()(Graph& g, GraphInterface& gi, EdgeIndex eindex,
-                    EdgeProperty prop, python::tuple& prange, python::list& ret)
-        const
+                    EdgeProperty prop, python::tuple& prange, bool as_array,
+                    python::object& ret) const
     {
         typedef typename property_traits<EdgeProperty>::value_type value_type;
         pair<value_type,value_type> range;
         range.first = python::extract<value_type>(prange[0]);
         range.second = python::extract<value_type>(prange[1]);
 
-        gt_hash_set<size_t> edge_set;
-
-        #ifdef _OPENMP
-        size_t __attribute__ ((unused)) nt = omp_get_num_threads();
-        if (std::is_convertible<value_type,python::object>::value)
-            nt = 1; // python is not thread-safe
-        #endif
-
-        auto gp = retrieve_graph_view<Graph>(gi, g);
         bool is_eq = range.first == range.second;
 
-        #pragma omp parallel if (num_vertices(g) > OPENMP_MIN_THRESH) \
-            num_threads(nt)
-        parallel_edge_loop_no_spawn
-            (g,
-             [&](auto e)
+        // each undirected edge is visited only once, via the directed view
+        auto&& u = get_dir(g, typename is_directed::apply<Graph>::type());
+
+        typedef typename graph_traits<Graph>::edge_descriptor edge_t;
+        std::vector<edge_t> es;
+        collect_vertex_matches
+            (u,
+             [&](auto v, auto& buf)
              {
-                 if (!graph_tool::is_directed(g))
+                 for (auto e : out_edges_range(v, u))
                  {
-                     if (edge_set.find(eindex[e]) == edge_set.end())
-                         edge_set.insert(eindex[e]);
-                    else
-                        return;
+                     value_type val = get(prop, e);
+                     if ((is_eq && (val == range.first)) ||
+                         (!is_eq && (range.first <= val && val <= range.second)))
+                         buf.push_back(e);
                  }
+             }, es, get_search_threads<value_type>());
+
+        if (as_array)
+        {
+            std::vector<size_t> edges(3 * es.size());
+            for (size_t i = 0; i < es.size(); ++i)
+            {
+                edges[3 * i] = source(es[i], g);
+                edges[3 * i + 1] = target(es[i], g);
+                edges[3 * i + 2] = eindex[es[i]];
+            }
+            ret = wrap_vector_owned(edges);
+            return;
+        }
 
-                 value_type val = get(prop, e);
-                 if ((is_eq && (val == range.first)) ||
-                     (!is_eq && (range.first <= val && val <= range.second)))
-                 {
-                     PythonEdge<Graph> pe(gp, e);
-                     auto& ret_ = ret;  // work around clang
-                     #pragma omp critical
-                     {
-                         ret_.append(pe);
-                     }
-                 }
-             });
+        auto gp = retrieve_graph_view<Graph>(gi, g);
+        python::list lret;
+        for (auto& e : es)
+            lret.append(PythonEdge<Graph>(gp, e));
+        ret = lret;
     }
 };
 
@@ -36,9 +36,21 @@ Summary
    PropertyArray
    load_graph
    load_graph_from_csv
+   load_graph_from_edge_list
+   save_csr_arrays
+   load_csr_arrays
+   GraphLog
+   load_graph_log
+   graph_to_arrow
+   graph_from_arrow
+   save_graph_parquet
+   load_graph_parquet
    group_vector_property
    ungroup_vector_property
    map_property_values
+   transform_property_values
+   encode_string_property
+   decode_string_property
    infect_vertex_property
    edge_endpoint_property
    incident_edges_op
@@ -49,7 +61,23 @@ Summary
    openmp_set_num_threads
    openmp_get_schedule
    openmp_set_schedule
+   openmp_get_loop_tuning
+   openmp_set_loop_tuning
+   openmp_calibrate
+   openmp_set_thread_affinity
+   openmp_get_thread_affinity
+   numa_get_num_nodes
+   numa_set_first_touch
+   numa_get_first_touch
+   set_tracing
+   get_trace
+   save_trace
+   AlgorithmExecutor
+   submit_async
    show_config
+   get_load_times
+   add_load_hook
+   remove_load_hook
 
 
 This module provides:
@@ -116,19 +144,32 @@ from . import gt_io  # sets up libcore io routines
 import sys
 import os
 import re
+import warnings
 import gzip
 import bz2
 try:
     import lzma
 except ImportError:
     pass
+try:
+    import lz4.frame
+except ImportError:
+    pass
+try:
+    import pyarrow
+except ImportError:
+    pass
 import weakref
 import copy
+import pickle
 import textwrap
 import io
 import collections
 import itertools
 import csv
+import json
+import uuid
+import threading
 
 if sys.version_info < (3,):
     import StringIO
@@ -147,12 +188,26 @@ __all__ = ["Graph", "GraphView", "Vertex", "Edge", "VertexBase", "EdgeBase",
            "Vector_bool", "Vector_int16_t", "Vector_int32_t", "Vector_int64_t",
            "Vector_double", "Vector_long_double", "Vector_string",
            "Vector_size_t", "value_types", "load_graph", "load_graph_from_csv",
+           "load_graph_from_edge_list",
+           "save_csr_arrays", "load_csr_arrays", "GraphLog", "load_graph_log",
+           "graph_to_arrow", "graph_from_arrow", "save_graph_parquet",
+           "load_graph_parquet",
            "PropertyMap", "PropertyArray", "group_vector_property",
            "ungroup_vector_property", "map_property_values",
+           "transform_property_values", "encode_string_property",
+           "decode_string_property",
            "infect_vertex_property", "edge_endpoint_property",
            "incident_edges_op", "perfect_prop_hash", "seed_rng", "show_config",
            "openmp_enabled", "openmp_get_num_threads", "openmp_set_num_threads",
-           "openmp_get_schedule", "openmp_set_schedule", "__author__",
+           "openmp_get_schedule", "openmp_set_schedule",
+           "openmp_get_loop_tuning", "openmp_set_loop_tuning",
+           "openmp_calibrate",
+           "openmp_set_thread_affinity", "openmp_get_thread_affinity",
+           "numa_get_num_nodes", "numa_set_first_touch",
+           "numa_get_first_touch", "set_tracing", "get_trace",
+           "save_trace", "AlgorithmExecutor", "submit_async",
+           "get_load_times",
+           "add_load_hook", "remove_load_hook", "__author__",
            "__copyright__", "__URL__", "__version__"]
 
 # this is rather pointless, but it works around a sphinx bug
@@ -293,7 +348,12 @@ def show_config():
     print("install prefix:", info.install_prefix)
     print("python dir:", info.python_dir)
     print("graph filtering:", libcore.graph_filtering_enabled())
+    print("slim dispatch:", libcore.graph_slim_dispatch_enabled())
+    print("tracing:", libcore.graph_tracing_enabled())
+    print("edge arena:", libcore.graph_edge_arena_enabled())
     print("openmp:", libcore.openmp_enabled())
+    if libcore.openmp_enabled():
+        print("openmp loop tuning:", libcore.openmp_get_loop_tuning_enabled())
     print("uname:", " ".join(os.uname()))
 
 def terminal_size():
@@ -567,7 +627,10 @@ class PropertyMap(object):
            a scalar. For vector, string or object types, ``None`` is returned
            instead. For vector and string objects, indirect array access is
            provided via the :func:`~graph_tool.PropertyMap.get_2d_array()` and
-           :func:`~graph_tool.PropertyMap.set_2d_array()` member functions.
+           :func:`~graph_tool.PropertyMap.set_2d_array()` member functions. For
+           vectors of varying length, a flat representation is provided via
+           :func:`~graph_tool.PropertyMap.get_ragged_array()` and
+           :func:`~graph_tool.PropertyMap.set_ragged_array()`.
 
         .. warning::
 
@@ -710,13 +773,46 @@ class PropertyMap(object):
         r"""Return a two-dimensional array with a copy of the entries of the
         vector-valued property map. The parameter ``pos`` must be a sequence of
         integers which specifies the indexes of the property values which will
-        be used. """
+        be used.
+
+        The columns of the array correspond to the entries of the
+        :attr:`~PropertyMap.fa` attribute, i.e. to the vertices or edges that
+        are not filtered out, in the order of their indexes, also when some
+        edge indexes are unused after edges have been removed.
+
+        Examples
+        --------
+        >>> g = gt.Graph()
+        >>> g.add_edge_list([(0, 1), (1, 2), (2, 3), (3, 0)])
+        >>> x = g.new_edge_property("vector<double>")
+        >>> y = g.new_edge_property("double", vals=[1, 2, 3, 4])
+        >>> for e in g.edges():
+        ...     x[e] = [y[e], -y[e]]
+        >>> g.remove_edge(g.edge(1, 2))
+        >>> x.get_2d_array([0, 1])
+        array([[ 1.,  3.,  4.],
+               [-1., -3., -4.]])
+        >>> u = gt.GraphView(g, efilt=lambda e: e.source() != 2)
+        >>> u.own_property(x).get_2d_array([0])
+        array([[1., 4.]])
+        """
 
         if self.key_type() == "g":
             raise ValueError("Cannot create multidimensional array for graph property maps.")
         if "vector" not in self.value_type() and (len(pos) > 1 or pos[0] != 0):
             raise ValueError("Cannot create array of dimension %d (indexes %s) from non-vector property map of type '%s'." \
                              % (len(pos), str(pos), self.value_type()))
+        dtype = _vector_dtype(self.value_type())
+        if dtype is not None:
+            idx = self.__get_f_index()
+            a = numpy.zeros((len(pos), len(idx)), dtype=dtype)
+            libcore.vector_property_get_2d(self.get_graph()._Graph__graph,
+                                           _prop(self.key_type(),
+                                                 self.get_graph(), self),
+                                           idx,
+                                           numpy.asarray(pos, dtype="int64"),
+                                           a, self.key_type() == "e")
+            return a
         if "string" in self.value_type():
             if "vector" in self.value_type():
                 p = ungroup_vector_property(self, pos)
@@ -772,6 +868,27 @@ class PropertyMap(object):
                     self[v] = a[j]
             return
 
+        dtype = _vector_dtype(self.value_type())
+        if dtype is not None:
+            idx = self.__get_f_index()
+            a = numpy.asarray(a)
+            if a.ndim == 1:
+                a = a.reshape((1, -1))
+            if pos is None:
+                pos = range(a.shape[0])
+            if len(pos) != a.shape[0]:
+                raise ValueError("array has %d rows, but %d positions were given" %
+                                 (a.shape[0], len(pos)))
+            a = numpy.ascontiguousarray(numpy.broadcast_to(a, (len(pos), len(idx))),
+                                        dtype=dtype)
+            libcore.vector_property_set_2d(self.get_graph()._Graph__graph,
+                                           _prop(self.key_type(),
+                                                 self.get_graph(), self),
+                                           idx,
+                                           numpy.asarray(pos, dtype="int64"),
+                                           a, self.key_type() == "e")
+            return
+
         val = self.value_type()[7:-1]
         ps = []
         for i in range(a.shape[0]):
@@ -792,6 +909,71 @@ class PropertyMap(object):
                     ps[-1][v] = a[i, j]
         group_vector_property(ps, val, self, pos)
 
+    def get_ragged_array(self):
+        r"""Return the entries of the vector-valued property map as a pair
+        ``(values, offsets)`` of one-dimensional arrays, where the values for the
+        :math:`i`-th (unfiltered) vertex or edge are given by
+        ``values[offsets[i]:offsets[i+1]]``. Contrary to
+        :meth:`~PropertyMap.get_2d_array`, the vectors may have different
+        lengths. Only vectors of scalar types are supported.
+
+        .. note::
+
+           The arrays are a copy of the property values, obtained in a single
+           pass over the property map.
+
+        """
+        dtype = _vector_dtype(self.value_type())
+        if self.key_type() == "g" or dtype is None:
+            raise ValueError("Cannot create ragged array for property map of type '%s'." \
+                             % self.value_type())
+        return libcore.vector_property_get_ragged(self.get_graph()._Graph__graph,
+                                                  _prop(self.key_type(),
+                                                        self.get_graph(), self),
+                                                  self.__get_f_index(),
+                                                  self.key_type() == "e")
+
+    def set_ragged_array(self, values, offsets):
+        r"""Set the entries of the vector-valued property map from a pair
+        ``(values, offsets)`` of one-dimensional arrays, as returned by
+        :meth:`~PropertyMap.get_ragged_array`, such that the value for the
+        :math:`i`-th (unfiltered) vertex or edge becomes
+        ``values[offsets[i]:offsets[i+1]]``."""
+        dtype = _vector_dtype(self.value_type())
+        if self.key_type() == "g" or dtype is None:
+            raise ValueError("Cannot set ragged array for property map of type '%s'." \
+                             % self.value_type())
+        libcore.vector_property_set_ragged(self.get_graph()._Graph__graph,
+                                           _prop(self.key_type(),
+                                                 self.get_graph(), self),
+                                           self.__get_f_index(),
+                                           numpy.ascontiguousarray(values,
+                                                                   dtype=dtype),
+                                           numpy.ascontiguousarray(offsets,
+                                                                   dtype="int64"),
+                                           self.key_type() == "e")
+
+    def __get_f_index(self):
+        # indexes of the unfiltered descriptors, in the same order as the
+        # entries of the "fa" attribute
+        g = self.get_graph()
+        if self.__key_type == 'v':
+            N = g._Graph__graph.get_num_vertices(False)
+            filt = g.get_vertex_filter()
+        else:
+            N = g.edge_index_range
+            filt = g.get_edge_filter()
+            # as in the "fa" attribute, the edge filter can be used directly
+            # only if there are no index holes
+            if (g.get_vertex_filter()[0] is not None or
+                N != g.num_edges()):
+                filt = (g.new_edge_property("bool"), False)
+                libcore.mark_edges(g._Graph__graph, _prop("e", g, filt[0]))
+        idx = numpy.arange(N, dtype="int64")
+        if filt[0] is None:
+            return idx
+        return idx[filt[0].a[:N] == (not filt[1])]
+
     def is_writable(self):
         """Return True if the property is writable."""
         return self.__map.is_writable()
@@ -808,6 +990,41 @@ class PropertyMap(object):
         else:
             self[g] = val
 
+    def get_values(self, idx):
+        """Return the values of the property map for the vertices or edges with
+        indexes given by the sequence ``idx``. For scalar value types a
+        :class:`numpy.ndarray` is returned, otherwise a list.
+
+        This is equivalent to ``[self[g.vertex(i)] for i in idx]`` (or the
+        analogous expression for edges), but is done with a single call.
+
+        Examples
+        --------
+        >>> g = gt.Graph()
+        >>> g.add_vertex(5)
+        <...>
+        >>> x = g.new_vertex_property("double", vals=[0, 1, 2, 3, 4])
+        >>> x.get_values([4, 0, 2])
+        array([4., 0., 2.])
+        """
+        if self.key_type() == "g":
+            raise ValueError("Cannot get values by index for graph property maps.")
+        return self.__map.get_values(numpy.asarray(idx, dtype="int64"))
+
+    def set_values(self, idx, vals):
+        """Set the values of the property map for the vertices or edges with
+        indexes given by the sequence ``idx`` to the respective entries of
+        ``vals``. If ``idx`` contains repeated indexes, which of the
+        corresponding values is kept is unspecified."""
+        if self.key_type() == "g":
+            raise ValueError("Cannot set values by index for graph property maps.")
+        dtype = _scalar_dtypes.get(self.value_type(), None)
+        if dtype is not None:
+            vals = numpy.ascontiguousarray(vals, dtype=dtype)
+        elif not isinstance(vals, (list, tuple)):
+            vals = list(vals)
+        self.__map.set_values(numpy.asarray(idx, dtype="int64"), vals)
+
     def reserve(self, size):
         """Reserve enough space for ``size`` elements in underlying container. If the
            original size is already equal or larger, nothing will happen."""
@@ -830,10 +1047,25 @@ class PropertyMap(object):
         self.__map.resize(size)
         self.__map.shrink_to_fit()
 
+    def numa_interleave(self):
+        """Interleave the memory pages of the underlying container between all
+        NUMA nodes. This spreads the memory bandwidth evenly for property maps
+        which are read by all threads, and modified rarely. The placement is
+        lost if the container is reallocated. This has no effect on systems with
+        a single NUMA node."""
+        self.__map.numa_interleave()
+
     def data_ptr(self):
         """Return the pointer to memory where the data resides."""
         return self.__map.data_ptr()
 
+    def memory_usage(self):
+        """Return the amount of memory (in bytes) held by the property values,
+        including the storage of vector and string values, and any allocated
+        but unused capacity. The memory held by ``python::object`` values
+        themselves is not included."""
+        return self.__map.memory_usage()
+
     def __getstate__(self):
         g = self.get_graph()
         if g is None:
@@ -926,6 +1158,18 @@ def _check_prop_scalar(prop, name=None, floating=False):
                           (" floating" if floating else "")))
 
 
+_scalar_dtypes = {"bool": "uint8", "int16_t": "int16", "int32_t": "int32",
+                  "int64_t": "int64", "double": "float64",
+                  "long double": "longdouble"}
+
+def _vector_dtype(value_type):
+    # numpy dtype of the elements of a scalar vector value type, or None
+    ma = re.compile(r"vector<(.*)>").match(value_type)
+    if ma is None:
+        return None
+    t = _scalar_dtypes.get(ma.group(1), None)
+    return numpy.dtype(t) if t is not None else None
+
 def _check_prop_vector(prop, name=None, scalar=True, floating=False):
     scalars = ["bool", "int16_t", "int32_t", "int64_t", "unsigned long",
                "double", "long double"]
@@ -1085,7 +1329,8 @@ def ungroup_vector_property(vprop, pos, props=None):
             props[i][g] = vprop[g][pos[i]]
     return props
 
-def map_property_values(src_prop, tgt_prop, map_func):
+def map_property_values(src_prop, tgt_prop, map_func, vectorized=False,
+                        chunk_size=1 << 20):
     """Map the values of ``src_prop`` to ``tgt_prop`` according to the mapping
     function ``map_func``.
 
@@ -1097,6 +1342,14 @@ def map_property_values(src_prop, tgt_prop, map_func):
         Target property map.
     map_func : function or callable object
         Function mapping values of ``src_prop`` to values of ``tgt_prop``.
+    vectorized : bool (optional, default: ``False``)
+        If ``True``, ``map_func`` will be called with chunks of values at once
+        (as :class:`numpy.ndarray` for scalar types, or lists otherwise), and
+        must return a sequence of mapped values of the same length. Otherwise
+        it is called once for each distinct value.
+    chunk_size : int (optional, default: ``1 << 20``)
+        Maximum number of values passed to ``map_func`` in each call, if
+        ``vectorized == True``.
 
     Returns
     -------
@@ -1113,6 +1366,13 @@ def map_property_values(src_prop, tgt_prop, map_func):
      10  7  6 12 10  8  8 11  6  5 12  6 10 11  9 12  7  7  6 14  7  9  9  8 12
       6 16 12 11 14  6  9  6  8 10  9  7 10  7  7  4  9 14  9  5 10 12  9  6  6
       6 12]
+
+    The same, but with a vectorized function:
+
+    >>> gt.map_property_values(g.vp.label, label_len,
+    ...                        lambda x: [len(s) for s in x], vectorized=True)
+    >>> print(label_len.a[:5])
+    [ 6  8 14 11 12]
     """
 
     if src_prop.key_type() != tgt_prop.key_type():
@@ -1122,6 +1382,12 @@ def map_property_values(src_prop, tgt_prop, map_func):
     if k == "g":
         tgt_prop[g] = map_func(src_prop[g])
         return
+    if vectorized:
+        idx = src_prop._PropertyMap__get_f_index()
+        for i in range(0, len(idx), chunk_size):
+            chunk = idx[i:i + chunk_size]
+            tgt_prop.set_values(chunk, map_func(src_prop.get_values(chunk)))
+        return
     u = GraphView(g, directed=True, reversed=g.is_reversed(),
                   skip_properties=True)
     libcore.property_map_values(u._Graph__graph,
@@ -1129,6 +1395,148 @@ def map_property_values(src_prop, tgt_prop, map_func):
                                 _prop(k, g, tgt_prop),
                                 map_func, k == 'e')
 
+def transform_property_values(src_prop, tgt_prop, transform, params=()):
+    r"""Set the values of ``tgt_prop`` to an element-wise numeric transform of the
+    values of ``src_prop``, computed in parallel without calling any Python
+    function.
+
+    Parameters
+    ----------
+    src_prop : :class:`~graph_tool.PropertyMap`
+        Source property map, of scalar type.
+    tgt_prop : :class:`~graph_tool.PropertyMap`
+        Target property map, of scalar type.
+    transform : ``"affine"``, ``"log"``, ``"clip"`` or ``"lut"``
+        Transform to be applied to each value :math:`x`. It can be ``"affine"``
+        (:math:`ax + b`, with ``params = (a, b)``), ``"log"``
+        (:math:`\log x`), ``"clip"`` (:math:`\min(\max(x, a), b)`, with
+        ``params = (a, b)``) or ``"lut"`` (``params[x]``, where the source
+        values must be integers in the range ``[0, len(params))``).
+    params : sequence of floats (optional, default: ``()``)
+        Parameters of the transform.
+
+    Returns
+    -------
+    None
+
+    Examples
+    --------
+    >>> g = gt.Graph()
+    >>> g.add_vertex(4)
+    <...>
+    >>> x = g.new_vertex_property("int64_t", vals=[1, 2, 3, 4])
+    >>> y = g.new_vertex_property("double")
+    >>> gt.transform_property_values(x, y, "affine", (2, 1))
+    >>> print(y.a)
+    [ 3.  5.  7.  9.]
+    """
+
+    if src_prop.key_type() != tgt_prop.key_type():
+        raise ValueError("src_prop and tgt_prop must be of the same key type")
+    _check_prop_scalar(src_prop, "src_prop")
+    _check_prop_scalar(tgt_prop, "tgt_prop")
+    _check_prop_writable(tgt_prop, "tgt_prop")
+    g = src_prop.get_graph()
+    k = src_prop.key_type()
+    if k == "g":
+        raise ValueError("graph property maps are not supported")
+    u = GraphView(g, directed=True, reversed=g.is_reversed(),
+                  skip_properties=True)
+    libcore.property_transform_values(u._Graph__graph,
+                                      _prop(k, g, src_prop),
+                                      _prop(k, g, tgt_prop),
+                                      transform, list(params), k == 'e')
+
+def encode_string_property(prop, value_type="int32_t"):
+    r"""Encode a string-valued property map into an integer property map, where
+    each distinct string is replaced by a code given by the order of its first
+    appearance.
+
+    Parameters
+    ----------
+    prop : :class:`~graph_tool.PropertyMap`
+        Vertex or edge property map of type ``string``.
+    value_type : string (optional, default: ``"int32_t"``)
+        Integer value type of the returned property map.
+
+    Returns
+    -------
+    codes : :class:`~graph_tool.PropertyMap`
+        Property map with the integer codes.
+    labels : list of strings
+        Distinct values of ``prop``, such that ``labels[codes[x]] == prop[x]``.
+
+    Notes
+    -----
+    Since the codes are stored in a scalar property map, they can be accessed
+    via :meth:`~graph_tool.PropertyMap.get_array`, are saved compactly in the
+    ``gt`` format, and are much cheaper to compare, group or filter than the
+    original strings. The original property map can be recovered with
+    :func:`~graph_tool.decode_string_property`.
+
+    Examples
+    --------
+    >>> g = gt.Graph()
+    >>> g.add_vertex(4)
+    <...>
+    >>> name = g.new_vertex_property("string", vals=["a", "b", "a", "c"])
+    >>> codes, labels = gt.encode_string_property(name)
+    >>> print(codes.a, labels)
+    [0 1 0 2] ['a', 'b', 'c']
+    """
+
+    if prop.value_type() != "string":
+        raise ValueError("property map must be of type 'string'")
+    k = prop.key_type()
+    if k == "g":
+        raise ValueError("graph property maps are not supported")
+    g = prop.get_graph()
+    codes = g.new_property(k, value_type)
+    if codes.value_type() not in ["bool", "int16_t", "int32_t", "int64_t"]:
+        raise ValueError("value type must be an integer type, not '%s'" %
+                         value_type)
+    labels = libcore.encode_string_property(_prop(k, g, prop),
+                                            _prop(k, g, codes), k == "e")
+    return codes, list(labels)
+
+def decode_string_property(codes, labels):
+    r"""Return a string-valued property map with values ``labels[codes[x]]``,
+    reverting :func:`~graph_tool.encode_string_property`.
+
+    Parameters
+    ----------
+    codes : :class:`~graph_tool.PropertyMap`
+        Vertex or edge property map of integer type.
+    labels : list of strings
+        String values corresponding to each code.
+
+    Returns
+    -------
+    prop : :class:`~graph_tool.PropertyMap`
+        Property map of type ``string``.
+
+    Examples
+    --------
+    >>> g = gt.Graph()
+    >>> g.add_vertex(4)
+    <...>
+    >>> name = g.new_vertex_property("string", vals=["a", "b", "a", "c"])
+    >>> codes, labels = gt.encode_string_property(name)
+    >>> print(list(gt.decode_string_property(codes, labels)))
+    ['a', 'b', 'a', 'c']
+    """
+
+    if codes.value_type() not in ["bool", "int16_t", "int32_t", "int64_t"]:
+        raise ValueError("codes must be of integer type")
+    k = codes.key_type()
+    if k == "g":
+        raise ValueError("graph property maps are not supported")
+    g = codes.get_graph()
+    prop = g.new_property(k, "string")
+    libcore.decode_string_property(_prop(k, g, codes), _prop(k, g, prop),
+                                   [str(l) for l in labels], k == "e")
+    return prop
+
 def infect_vertex_property(g, prop, vals=None):
     """Propagate the `prop` values of vertices with value `val` to all their
     out-neighbors.
@@ -1313,8 +1721,24 @@ class InternalPropertyDict(dict):
 
     def __init__(self, g):
         self.g = weakref.ref(g)
+        self.lazy = {}
         dict.__init__(self)
 
+    def __missing__(self, key):
+        # properties that have not yet been read from file are loaded on first
+        # access
+        loader = self.lazy.pop(key, None)
+        if loader is None:
+            raise KeyError(key)
+        val = loader()
+        dict.__setitem__(self, key, val)
+        return val
+
+    def load_all(self):
+        """Load all properties which have not yet been read from file."""
+        for key in list(self.lazy.keys()):
+            self[key]
+
     @_require("key", tuple)
     @_require("val", PropertyMap)
     def __setitem__(self, key, val):
@@ -1331,11 +1755,41 @@ class InternalPropertyDict(dict):
     @_limit_args({"t": ["v", "e", "g"]})
     @_require("key", str, unicode)
     def __set_property(self, t, key, v):
+        self.lazy.pop((t, key), None)
         dict.__setitem__(self, (t, key), v)
 
     @_require("key", tuple)
     def __delitem__(self, key):
-        dict.__delitem__(self, key)
+        if key in self.lazy and not dict.__contains__(self, key):
+            del self.lazy[key]
+        else:
+            dict.__delitem__(self, key)
+
+    def __contains__(self, key):
+        return dict.__contains__(self, key) or key in self.lazy
+
+    def __len__(self):
+        return dict.__len__(self) + len(self.lazy)
+
+    def __iter__(self):
+        return iter(self.keys())
+
+    def get(self, key, default=None):
+        try:
+            return self[key]
+        except KeyError:
+            return default
+
+    def keys(self):
+        return list(dict.keys(self)) + list(self.lazy.keys())
+
+    def items(self):
+        self.load_all()
+        return dict.items(self)
+
+    def values(self):
+        self.load_all()
+        return dict.values(self)
 
     @_require("key", tuple)
     def setdefault(self, key, default=None):
@@ -1918,7 +2372,7 @@ class Graph(object):
         """
         return libcore.get_degree_list(self.__graph,
                                        numpy.asarray(vs, dtype="uint64"),
-                                       _prop("e", self, eweight), True)
+                                       _prop("e", self, eweight), "out")
 
     def get_in_degrees(self, vs, eweight=None):
         """Return a :class:`numpy.ndarray` containing the in-degrees of vertex list
@@ -1934,7 +2388,64 @@ class Graph(object):
         """
         return libcore.get_degree_list(self.__graph,
                                        numpy.asarray(vs, dtype="uint64"),
-                                       _prop("e", self, eweight), False)
+                                       _prop("e", self, eweight), "in")
+
+    def get_total_degrees(self, vs, eweight=None):
+        """Return a :class:`numpy.ndarray` containing the total degrees (i.e. the
+        sum of the in- and out-degrees) of vertex list ``vs``. If supplied, the
+        degrees will be weighted according to the edge
+        :class:`~graph_tool.PropertyMap` ``eweight``.
+
+        Examples
+        --------
+        >>> g = gt.collection.data["pgp-strong-2009"]
+        >>> g.get_total_degrees([42, 666])
+        array([40, 77], dtype=uint64)
+
+        """
+        return libcore.get_degree_list(self.__graph,
+                                       numpy.asarray(vs, dtype="uint64"),
+                                       _prop("e", self, eweight), "total")
+
+    def get_out_neighbors_array(self, vs):
+        """Return the out-neighbors of all vertices in the list ``vs``, as a
+        pair ``(neighbors, offsets)`` of :class:`numpy.ndarray` objects, such
+        that the out-neighbors of ``vs[i]`` are given by
+        ``neighbors[offsets[i]:offsets[i+1]]``.
+
+        Examples
+        --------
+        >>> g = gt.collection.data["pgp-strong-2009"]
+        >>> us, pos = g.get_out_neighbors_array([66, 42])
+        >>> us[pos[0]:pos[1]]
+        array([   63, 20369, 13980,  8687, 38674], dtype=uint64)
+
+        """
+        return libcore.get_neighbors_lists(self.__graph,
+                                           numpy.asarray(vs, dtype="uint64"),
+                                           True)
+
+    get_out_neighbours_array = get_out_neighbors_array
+
+    def get_in_neighbors_array(self, vs):
+        """Return the in-neighbors of all vertices in the list ``vs``, as a pair
+        ``(neighbors, offsets)`` of :class:`numpy.ndarray` objects, such that
+        the in-neighbors of ``vs[i]`` are given by
+        ``neighbors[offsets[i]:offsets[i+1]]``.
+
+        Examples
+        --------
+        >>> g = gt.collection.data["pgp-strong-2009"]
+        >>> us, pos = g.get_in_neighbors_array([66, 42])
+        >>> us[pos[0]:pos[1]]
+        array([ 8687, 20369, 38674], dtype=uint64)
+
+        """
+        return libcore.get_neighbors_lists(self.__graph,
+                                           numpy.asarray(vs, dtype="uint64"),
+                                           False)
+
+    get_in_neighbours_array = get_in_neighbors_array
 
     def add_vertex(self, n=1):
         """Add a vertex to the graph, and return it. If ``n != 1``, ``n``
@@ -2089,6 +2600,14 @@ class Graph(object):
         maps that will be filled with the remaining values at each row, if there
         are more than two.
 
+        .. note::
+
+           If ``edge_list`` is a :class:`~numpy.ndarray`, ``hashed == False``
+           and the graph is not filtered or reversed, the edges are inserted in
+           bulk: the adjacency lists are allocated exactly once with their final
+           sizes, and filled in parallel. The resulting graph, including the
+           edge indexes, is identical to inserting the edges one by one.
+
         """
         if eprops is None:
             eprops = ()
@@ -2130,6 +2649,29 @@ class Graph(object):
         enabled."""
         return self.__graph.get_keep_epos()
 
+    def set_fast_edge_lookup(self, fast=True):
+        r"""If ``fast == True`` the out-edges of vertices with large out-degree
+        :math:`k` will be kept sorted in an auxiliary index, so that
+        :meth:`~graph_tool.Graph.edge` (and all algorithms which test for the
+        existence of edges) runs in time :math:`O(\log k)` instead of
+        :math:`O(k)`. This requires an additional data structure of size
+        :math:`O(E)` to be kept at all times, and makes the insertion and
+        removal of edges of these vertices :math:`O(k)`. If ``fast == False``,
+        this data structure is destroyed.
+
+        .. note::
+
+           If there are parallel edges, the edge returned by
+           :meth:`~graph_tool.Graph.edge` with ``all_edges == False`` may be a
+           different one of them when this is enabled.
+        """
+        self.__graph.set_keep_out_index(fast)
+
+    def get_fast_edge_lookup(self):
+        r"""Return whether the fast :math:`O(\log k)` lookup of edges is
+        currently enabled."""
+        return self.__graph.get_keep_out_index()
+
     def clear(self):
         """Remove all vertices and edges from the graph."""
         self.__graph.clear()
@@ -2272,11 +2814,185 @@ class Graph(object):
         """
         self.__graph.re_index_edges()
 
+    def compact(self, ordered=False):
+        """Renumber the edge indexes so that they lie in the [0,
+        :meth:`~graph_tool.Graph.num_edges` - 1] range, preserving their
+        relative order (or, if ``ordered == True``, following the order of
+        :meth:`~graph_tool.Graph.edges`, which is the same as the one obtained
+        when the graph is saved and loaded again), and release all memory that
+        is no longer used by the adjacency lists. Differently from
+        :meth:`~graph_tool.Graph.reindex_edges`, all existing edge property maps
+        of the graph are remapped to the new indexes, and shrunk accordingly.
+
+        This is useful after many edges have been removed, since otherwise the
+        edge property maps need to be as large as the largest edge index ever
+        used. This operation is :math:`O(V + E + I)`, where :math:`I` is the
+        previous edge index range.
+        """
+        eprops = []
+        ptrs = set()
+        for pmap in self.__known_properties.values():
+            pmap = pmap()
+            if (pmap is None or pmap.key_type() != "e" or
+                not pmap.is_writable()):
+                continue
+            ptr = pmap.data_ptr()
+            if ptr != 0:
+                if ptr in ptrs:
+                    continue
+                ptrs.add(ptr)
+            eprops.append(_prop("e", self, pmap))
+        self.__graph.compact_edges(eprops, ordered)
+
+    def memory_usage(self):
+        """Return a dictionary with the amount of memory (in bytes) held by the
+        graph and its property maps, broken down by component.
+
+        The ``"graph"`` entry contains the memory used by the adjacency lists
+        (``"edge_lists"``), the optional edge position and out-edge lookup
+        indexes (``"edge_positions"`` and ``"out_index"``), the list of free
+        edge indexes (``"free_indexes"``), the filter masks (``"vertex_filter"``
+        and ``"edge_filter"``), and the frozen snapshot (``"frozen"``, see
+        :meth:`~graph_tool.Graph.freeze`). Reversed and undirected views do not
+        hold any additional memory.
+
+        The ``"vertex_properties"``, ``"edge_properties"`` and
+        ``"graph_properties"`` entries contain the memory used by each property
+        map of the graph which is still alive, keyed by its name if it is
+        internal. Property maps sharing the same storage, such as copies
+        obtained from graph views, are counted only once. The property maps
+        used as filter masks are not included here, since they are already
+        counted in the ``"graph"`` entry.
+
+        The ``"total"`` entry contains the sum of all the above.
 
-    def shrink_to_fit(self):
+        Examples
+        --------
+        >>> g = gt.Graph()
+        >>> g.add_vertex(100)
+        <...>
+        >>> g.vp.x = g.new_vertex_property("double", vals=np.ones(100))
+        >>> g.memory_usage()["vertex_properties"]["x"]
+        800
+        """
+        usage = {"graph": self.__graph.memory_usage()}
+        names = {}
+        for (k, name), pmap in self.__properties.items():
+            names[id(pmap)] = name
+        for k in ["vertex", "edge", "graph"]:
+            usage["%s_properties" % k] = {}
+        # the filter masks are accounted for in the "graph" entry
+        ptrs = set()
+        for filt in [self.get_vertex_filter()[0], self.get_edge_filter()[0]]:
+            if filt is not None:
+                ptrs.add(filt.data_ptr())
+        count = 0
+        # internal property maps first, so that they are reported by name
+        pmaps = list(self.__properties.values())
+        pmaps += [pmap() for pmap in self.__known_properties.values()]
+        for pmap in pmaps:
+            if pmap is None:
+                continue
+            k = pmap.key_type()
+            ptr = pmap.data_ptr() if k != "g" else id(pmap)
+            if ptr != 0:
+                if ptr in ptrs:
+                    continue
+                ptrs.add(ptr)
+            name = names.get(id(pmap), None)
+            if name is None:
+                name = "<unnamed %s #%d>" % (pmap.value_type(), count)
+                count += 1
+            key = {"v": "vertex", "e": "edge", "g": "graph"}[k]
+            usage["%s_properties" % key][name] = pmap.memory_usage()
+        usage["total"] = (sum(usage["graph"].values()) +
+                          sum(sum(usage["%s_properties" % k].values())
+                              for k in ["vertex", "edge", "graph"]))
+        return usage
+
+    def shrink_to_fit(self, properties=False):
         """Force the physical capacity of the underlying containers to match the graph's
-        actual size, potentially freeing memory back to the system."""
+        actual size, potentially freeing memory back to the system. If
+        ``properties == True``, the same is done for all property maps of the
+        graph."""
         self.__graph.shrink_to_fit()
+        if properties:
+            for pmap in self.__all_property_maps():
+                pmap.shrink_to_fit()
+
+    def numa_localize(self):
+        """Reallocate the adjacency lists in parallel, so that they are placed
+        in the NUMA nodes of the threads which will traverse them in parallel
+        loops. This is only useful if the threads are pinned to CPUs, see
+        :func:`~graph_tool.openmp_set_thread_affinity`, and should be called
+        after the graph has been constructed."""
+        self.__graph.numa_localize()
+
+    def reserve(self, num_vertices, num_edges=0, properties=False):
+        """Reserve memory for a total of ``num_vertices`` vertices and
+        (optionally) ``num_edges`` edges, to avoid repeated reallocation when
+        the graph is built incrementally. If ``properties == True``, the
+        property maps of the graph are also enlarged accordingly. This does not
+        change the number of vertices or edges in the graph."""
+        self.__graph.reserve(int(num_vertices), int(num_edges))
+        if properties:
+            E = self.edge_index_range + max(int(num_edges) - self.num_edges(), 0)
+            for pmap in self.__all_property_maps():
+                if pmap.key_type() == "v":
+                    pmap.reserve(int(num_vertices))
+                elif pmap.key_type() == "e":
+                    pmap.reserve(E)
+
+    def __all_property_maps(self):
+        # live property maps of the graph, excluding the ones sharing the same
+        # storage
+        ptrs = set()
+        for pmap in self.__known_properties.values():
+            pmap = pmap()
+            if pmap is None or pmap.key_type() == "g":
+                continue
+            ptr = pmap.data_ptr()
+            if ptr != 0:
+                if ptr in ptrs:
+                    continue
+                ptrs.add(ptr)
+            yield pmap
+
+    def freeze(self):
+        r"""Create an immutable, compressed-sparse-row snapshot of the graph,
+        where all adjacency lists are stored contiguously in memory. This
+        operation is :math:`O(V + E)`, and requires an additional amount of
+        memory comparable to the graph itself.
+
+        While the snapshot is valid, and no filters are active, several
+        read-only algorithms (e.g.
+        :func:`~graph_tool.centrality.pagerank`,
+        :func:`~graph_tool.clustering.local_clustering`,
+        :func:`~graph_tool.stats.distance_histogram` and
+        :func:`~graph_tool.search.bfs_iterator` with ``array=True``) will
+        operate on it instead of the regular adjacency list, which is
+        typically faster for large graphs.
+
+        .. warning::
+
+           The snapshot is not updated when the graph is modified. It is
+           discarded automatically if the number of vertices or edges (or the
+           edge index range) changes, but modifications which preserve these
+           (e.g. edge rewiring) are not detected. In this case
+           :meth:`~graph_tool.Graph.unfreeze` or
+           :meth:`~graph_tool.Graph.freeze` must be called after the
+           modification.
+        """
+        self.__graph.freeze()
+
+    def unfreeze(self):
+        r"""Discard the snapshot created by :meth:`~graph_tool.Graph.freeze`."""
+        self.__graph.unfreeze()
+
+    def is_frozen(self):
+        r"""Return whether a valid frozen snapshot of the graph exists. See
+        :meth:`~graph_tool.Graph.freeze`."""
+        return self.__graph.is_frozen()
 
     # Property map creation
 
@@ -2428,7 +3144,8 @@ class Graph(object):
     def __get_file_format(self, file_name):
         fmt = None
         for f in ["gt", "graphml", "xml", "dot", "gml"]:
-            names = ["." + f, ".%s.gz" % f, ".%s.bz2" % f, ".%s.xz" % f]
+            names = ["." + f, ".%s.gz" % f, ".%s.bz2" % f, ".%s.xz" % f,
+                     ".%s.zst" % f, ".%s.lz4" % f]
             for name in names:
                 if file_name.endswith(name):
                     fmt = f
@@ -2438,7 +3155,7 @@ class Graph(object):
         return fmt
 
     def load(self, file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
-             ignore_gp=None):
+             ignore_gp=None, lazy_properties=False):
         """Load graph from ``file_name`` (which can be either a string or a file-like
         object). The format is guessed from ``file_name``, or can be specified
         by ``fmt``, which can be either "gt", "graphml", "xml", "dot" or "gml".
@@ -2448,6 +3165,13 @@ class Graph(object):
         ``ignore_gp``, should contain a list of property names (vertex, edge or
         graph, respectively) which should be ignored when reading the file.
 
+        If ``lazy_properties == True`` and the file is an uncompressed "gt"
+        file, only the graph topology and the graph properties are read, and
+        each vertex and edge property is read from the file only when it is
+        first accessed. The file must not be modified in the meantime, and the
+        properties should be accessed before the graph topology is changed.
+        Otherwise, this option is ignored.
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
@@ -2468,6 +3192,11 @@ class Graph(object):
                 file_name = lzma.open(file_name, mode="rb")
             except NameError:
                 raise NotImplementedError("lzma compression is only available in Python >= 3.3")
+        if isinstance(file_name, (str, unicode)) and file_name.endswith(".lz4"):
+            try:
+                file_name = lz4.frame.open(file_name, mode="rb")
+            except NameError:
+                raise NotImplementedError("lz4 compression requires the 'lz4' Python module")
         if fmt == "graphml":
             fmt = "xml"
         if ignore_vp is None:
@@ -2476,19 +3205,38 @@ class Graph(object):
             ignore_ep = []
         if ignore_gp is None:
             ignore_gp = []
+        # the properties not yet read from a previous file refer to the graph
+        # that is about to be replaced
+        self.__properties.lazy.clear()
         if isinstance(file_name, (str, unicode)):
             props = self.__graph.read_from_file(_c_str(file_name), None,
                                                 _c_str(fmt), ignore_vp,
-                                                ignore_ep, ignore_gp)
+                                                ignore_ep, ignore_gp,
+                                                lazy_properties)
         else:
             props = self.__graph.read_from_file("", file_name, _c_str(fmt),
-                                                ignore_vp, ignore_ep, ignore_gp)
+                                                ignore_vp, ignore_ep, ignore_gp,
+                                                False)
         for name, prop in props[0].items():
             self.vertex_properties[name] = PropertyMap(prop, self, "v")
         for name, prop in props[1].items():
             self.edge_properties[name] = PropertyMap(prop, self, "e")
         for name, prop in props[2].items():
             self.graph_properties[name] = PropertyMap(prop, self, "g")
+        if len(props[3]) > 0:
+            state = self.__graph.get_modification_count()
+            g = weakref.ref(self)
+            # the file is read later, possibly from another working directory
+            def loader(t, offset, fname=_c_str(os.path.abspath(file_name))):
+                def load():
+                    u = g()
+                    if u.__graph.get_modification_count() != state:
+                        raise ValueError("cannot load property from file '%s': graph has been modified since it was loaded" % fname)
+                    prop = u.__graph.read_property_from_file(fname, offset)
+                    return PropertyMap(prop, u, t)
+                return load
+            for t, name, offset in props[3]:
+                self.__properties.lazy[(t, name)] = loader(t, offset)
         if "_Graph__save__vfilter" in self.graph_properties:
             self.set_vertex_filter(self.vertex_properties["_Graph__save__vfilter"],
                                    self.graph_properties["_Graph__save__vfilter"])
@@ -2504,12 +3252,18 @@ class Graph(object):
             del self.graph_properties["_Graph__reversed"]
         self.shrink_to_fit()
 
-    def save(self, file_name, fmt="auto"):
+    def save(self, file_name, fmt="auto", compact_adjacency=False):
         """Save graph to ``file_name`` (which can be either a string or a file-like
         object). The format is guessed from the ``file_name``, or can be
         specified by ``fmt``, which can be either "gt", "graphml", "xml", "dot"
         or "gml".  (Note that "graphml" and "xml" are synonyms).
 
+        If ``compact_adjacency == True`` and the format is "gt", the neighbor
+        lists are stored as variable-length differences between consecutive
+        neighbors, which is typically much smaller if the neighbor lists are
+        ordered. Files saved in this way cannot be read by versions of
+        graph-tool prior to 2.27.
+
         .. warning::
 
            The only file formats which are capable of perfectly preserving the
@@ -2548,6 +3302,11 @@ class Graph(object):
                 file_name = lzma.open(file_name, mode="wb")
             except NameError:
                 raise NotImplementedError("lzma compression is only available in Python >= 3.3")
+        if isinstance(file_name, (str, unicode)) and file_name.endswith(".lz4"):
+            try:
+                file_name = lz4.frame.open(file_name, mode="wb")
+            except NameError:
+                raise NotImplementedError("lz4 compression requires the 'lz4' Python module")
 
         props = [(_c_str(name[1]), prop._PropertyMap__map) for name, prop in \
                  u.__properties.items()]
@@ -2556,9 +3315,11 @@ class Graph(object):
             f = open(file_name, "w") # throw the appropriate exception, if
                                      # unable to open
             f.close()
-            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props)
+            u.__graph.write_to_file(_c_str(file_name), None, _c_str(fmt), props,
+                                    compact_adjacency)
         else:
-            u.__graph.write_to_file("", file_name, _c_str(fmt), props)
+            u.__graph.write_to_file("", file_name, _c_str(fmt), props,
+                                    compact_adjacency)
 
 
     # Directedness
@@ -2824,7 +3585,8 @@ class Graph(object):
 
     def purge_edges(self):
         """Remove all edges of the graph which are currently being filtered out. This
-        operation is not reversible.
+        operation is not reversible, and is performed in time :math:`O(V + E)`,
+        in parallel.
 
         .. note :
 
@@ -2836,6 +3598,42 @@ class Graph(object):
         self.__graph.purge_edges()
         self.set_edge_filter(None)
 
+    def materialize(self):
+        r"""Return a new :class:`~graph_tool.Graph` containing only the vertices
+        and edges of this graph which are not currently filtered out, with
+        contiguous vertex and edge indexes, together with a vertex and an edge
+        property map of the new graph containing the original vertex and edge
+        indexes, respectively.
+
+        This is a faster alternative to ``Graph(g, prune=True)``, since the
+        filters are evaluated only once, and the new graph is built in bulk,
+        in parallel. It is useful if many algorithms are run on a filtered graph
+        which keeps only a small fraction of the original one. Differently from
+        ``Graph(g, prune=True)``, no property maps are copied; they can be
+        obtained with the returned maps, e.g. ``prop.a[vmap.a]`` for a vertex
+        property map ``prop`` with a scalar value type.
+
+        This operation is :math:`O(V + E)`.
+
+        Examples
+        --------
+        >>> g = gt.random_graph(100, lambda: (3, 3))
+        >>> vfilt = g.new_vertex_property("bool")
+        >>> vfilt.a[:20] = True
+        >>> u = gt.GraphView(g, vfilt=vfilt)
+        >>> h, vmap, emap = u.materialize()
+        >>> print(h.num_vertices() == u.num_vertices(),
+        ...       h.num_edges() == u.num_edges())
+        True True
+        """
+        u = Graph(directed=self.is_directed())
+        u.set_reversed(self.is_reversed())
+        vmap = u.new_vertex_property("int64_t")
+        emap = u.new_edge_property("int64_t")
+        self.__graph.materialize(u.__graph, _prop("v", u, vmap),
+                                 _prop("e", u, emap))
+        return u, vmap, emap
+
     def get_filter_state(self):
         """Return a copy of the filter state of the graph."""
         self.__filter_state["directed"] = self.is_directed()
@@ -2884,6 +3682,50 @@ class Graph(object):
     # Pickling support
     # ================
 
+    def __reduce_ex__(self, protocol):
+        # With protocol 5, the adjacency and the arithmetic property values are
+        # exported as out-of-band buffers, avoiding the serialization via the
+        # "gt" format.
+        if (protocol < 5 or not hasattr(pickle, "PickleBuffer") or
+            isinstance(self, GraphView) or self.is_reversed() or
+            self.get_vertex_filter()[0] is not None or
+            self.get_edge_filter()[0] is not None):
+            return super(Graph, self).__reduce_ex__(protocol)
+        edges = self.get_edges()
+        eidx = edges[:, 2]
+        order = None
+        if not (len(eidx) == self.edge_index_range and
+                numpy.all(eidx == numpy.arange(len(eidx)))):
+            order = numpy.argsort(eidx)
+            edges = edges[order]
+            eidx = edges[:, 2]
+        state = dict(N=self.num_vertices(), directed=self.is_directed(),
+                     edges=pickle.PickleBuffer(numpy.ascontiguousarray(edges[:, :2])),
+                     props=[])
+        for (k, name), pmap in self.properties.items():
+            vt = pmap.value_type()
+            if k == "g":
+                vals = ("object", pmap[self])
+            elif vt in _scalar_dtypes:
+                a = pmap.a
+                if k == "e":
+                    a = a[eidx] if order is not None else a[:len(eidx)]
+                vals = ("array", pickle.PickleBuffer(numpy.ascontiguousarray(a)))
+            elif _vector_dtype(vt) is not None:
+                idx = (eidx if k == "e" else
+                       numpy.arange(self.num_vertices(), dtype="int64"))
+                v, o = libcore.vector_property_get_ragged(self.__graph,
+                                                          _prop(k, self, pmap),
+                                                          numpy.asarray(idx, dtype="int64"),
+                                                          k == "e")
+                vals = ("ragged", pickle.PickleBuffer(v), pickle.PickleBuffer(o))
+            else:
+                idx = (eidx if k == "e" else
+                       numpy.arange(self.num_vertices(), dtype="int64"))
+                vals = ("object", pmap.get_values(idx))
+            state["props"].append((k, name, vt, vals))
+        return (_unpickle_graph_buffers, (state,))
+
     def __getstate__(self):
         state = dict()
         sio = get_bytes_io()
@@ -2913,8 +3755,30 @@ class Graph(object):
         return self
     base = property(__get_base, doc="Base graph (self).")
 
+def _unpickle_graph_buffers(state):
+    g = Graph(directed=state["directed"])
+    g.add_vertex(state["N"])
+    edges = numpy.frombuffer(state["edges"], dtype="uint64").reshape((-1, 2))
+    g.add_edge_list(edges)
+    for k, name, vt, vals in state["props"]:
+        if k == "g":
+            pmap = g.new_graph_property(vt, vals[1])
+        else:
+            pmap = g.new_property(k, vt)
+            if vals[0] == "array":
+                pmap.a = numpy.frombuffer(vals[1], dtype=_scalar_dtypes[vt])
+            elif vals[0] == "ragged":
+                dtype = _vector_dtype(vt)
+                pmap.set_ragged_array(numpy.frombuffer(vals[1], dtype=dtype),
+                                      numpy.frombuffer(vals[2], dtype="int64"))
+            else:
+                N = g.num_vertices() if k == "v" else g.num_edges()
+                pmap.set_values(numpy.arange(N, dtype="int64"), vals[1])
+        g.properties[(k, name)] = pmap
+    return g
+
 def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
-               ignore_gp=None):
+               ignore_gp=None, lazy_properties=False):
     """Load a graph from ``file_name`` (which can be either a string or a file-like object).
 
     The format is guessed from ``file_name``, or can be specified by ``fmt``,
@@ -2933,7 +3797,7 @@ def load_graph(file_name, fmt="auto", ignore_vp=None, ignore_ep=None,
 
     """
     g = Graph()
-    g.load(file_name, fmt, ignore_vp, ignore_ep, ignore_gp)
+    g.load(file_name, fmt, ignore_vp, ignore_ep, ignore_gp, lazy_properties)
     return g
 
 def load_graph_from_csv(file_name, directed=True, eprop_types=None,
@@ -2990,6 +3854,11 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
             file_name = gzip.open(file_name, mode="r")
         elif file_name.endswith(".bz2"):
             file_name = bz2.open(file_name, mode="r")
+        elif file_name.endswith(".lz4"):
+            try:
+                file_name = lz4.frame.open(file_name, mode="rt")
+            except NameError:
+                raise NotImplementedError("lz4 compression requires the 'lz4' Python module")
         else:
             file_name = open(file_name, "r")
     _csv_options = {"delimiter": ",", "quotechar": '"'}
@@ -3040,6 +3909,875 @@ def load_graph_from_csv(file_name, directed=True, eprop_types=None,
     return g
 
 
+def load_graph_from_edge_list(file_name, directed=True, delimiter=None,
+                              comment="#", skip_first=False, ecols=(0, 1),
+                              eprop_types=None, eprop_names=None,
+                              hashed=False, binary=None):
+    """Load a graph from a file containing a list of edges and edge properties,
+    using a multi-threaded parser that reads the file in chunks.
+
+    Parameters
+    ----------
+    file_name : ``str`` or file-like object
+        File with the list of edges. If it ends with ``.gz``, ``.bz2``,
+        ``.zst``, ``.xz`` or ``.lz4`` it will be decompressed.
+    directed : ``bool`` (optional, default: ``True``)
+        Whether or not the graph is directed.
+    delimiter : ``str`` (optional, default: ``None``)
+        Characters that separate the columns of each line. If ``None``, the
+        columns are separated by any amount of white space.
+    comment : ``str`` (optional, default: ``"#"``)
+        Lines starting with any of these characters are ignored, as are empty
+        lines.
+    skip_first : ``bool`` (optional, default: ``False``)
+        If ``True`` the first line of the file will be skipped.
+    ecols : pair of ``int`` (optional, default: ``(0,1)``)
+        Line columns used as source and target for the edges.
+    eprop_types : list of ``str`` (optional, default: ``None``)
+        List of edge property types to be read from the remaining columns, in
+        order. If this is ``None``, ``len(eprop_names)`` properties of type
+        ``string`` are read.
+    eprop_names : list of ``str`` (optional, default: ``None``)
+        List of edge property names to be used for the remaining columns (if
+        this is ``None``, the properties will be called "c0, c1, ...").
+    hashed : ``bool`` (optional, default: ``False``)
+        If ``True``, the vertex values in the edge list are arbitrary
+        identifiers, mapped to vertex indices in the order in which they are
+        encountered, and stored in an internal vertex property map called
+        ``name``. Otherwise they must be non-negative integers that correspond
+        to the vertex indices.
+    binary : ``str`` (optional, default: ``None``)
+        If given, the file is not a text file, but a sequence of pairs of
+        integers of type ``"uint32_t"`` or ``"uint64_t"`` (in native byte
+        order) corresponding to the source and target of each edge. In this
+        case no edge properties are read, and the columns options are ignored.
+
+    Returns
+    -------
+    g : :class:`~graph_tool.Graph`
+        The loaded graph.
+
+    Notes
+    -----
+    Contrary to :func:`~graph_tool.load_graph_from_csv`, the file is parsed
+    entirely in C++, and only a bounded chunk of it is held in memory at any
+    time. Quoted values are not supported.
+
+    Examples
+    --------
+    >>> import os, tempfile, shutil
+    >>> path = tempfile.mkdtemp()
+    >>> fname = os.path.join(path, "edges.txt")
+    >>> with open(fname, "w") as f:
+    ...     print("# source target weight", file=f)
+    ...     print("a b 1.5", file=f)
+    ...     print("b c 2.5", file=f)
+    >>> g = gt.load_graph_from_edge_list(fname, hashed=True,
+    ...                                  eprop_types=["double"],
+    ...                                  eprop_names=["weight"])
+    >>> print(g.vp.name[1], g.ep.weight.a)
+    b [ 1.5  2.5]
+    >>> shutil.rmtree(path)
+    """
+
+    if binary is not None and binary not in ["uint32_t", "uint64_t"]:
+        raise ValueError("invalid binary type: " + str(binary))
+    if eprop_types is None:
+        eprop_types = ["string"] * (len(eprop_names) if eprop_names else 0)
+    if binary is not None:
+        eprop_types = []
+
+    g = Graph(directed=directed)
+    eprops = [g.new_ep(t) for t in eprop_types]
+    for p in eprops:
+        if p.value_type() == "python::object":
+            raise ValueError("edge properties of type 'object' are not supported")
+    name = None
+    if hashed:
+        name = g.new_vp("string" if binary is None else "int64_t")
+
+    if isinstance(file_name, (str, unicode)):
+        file_name = os.path.expanduser(file_name)
+        if file_name.endswith(".xz"):
+            try:
+                file_name = lzma.open(file_name, mode="rb")
+            except NameError:
+                raise NotImplementedError("lzma compression is only available in Python >= 3.3")
+        elif file_name.endswith(".lz4"):
+            try:
+                file_name = lz4.frame.open(file_name, mode="rb")
+            except NameError:
+                raise NotImplementedError("lz4 compression requires the 'lz4' Python module")
+        else:
+            open(file_name).close() # throw the appropriate exception, if not
+                                    # found
+    if isinstance(file_name, (str, unicode)):
+        fname, pfile = _c_str(file_name), None
+    else:
+        fname, pfile = "", file_name
+
+    width = {None: 0, "uint32_t": 4, "uint64_t": 8}[binary]
+    libcore.read_edge_list(g._Graph__graph, fname, pfile,
+                           delimiter if delimiter is not None else "",
+                           comment, skip_first, ecols[0], ecols[1], width,
+                           hashed, _prop("v", g, name),
+                           [_prop("e", g, p) for p in eprops])
+
+    for i, p in enumerate(eprops):
+        if eprop_names:
+            ename = eprop_names[i]
+        else:
+            ename = "c%d" % i
+        g.ep[ename] = p
+    if name is not None:
+        g.vp.name = name
+    return g
+
+def save_csr_arrays(g, path, props=None):
+    r"""Save the adjacency of graph ``g`` and the values of its scalar property maps
+    as uncompressed arrays in the directory ``path``, in compressed sparse row
+    (CSR) layout, so that they can be memory-mapped by
+    :func:`~graph_tool.load_csr_arrays`.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be saved. Filters are respected.
+    path : ``str``
+        Directory where the arrays are written (it will be created if it does
+        not exist). If it lies in a memory-backed file system, such as
+        ``/dev/shm``, the arrays are effectively held in shared memory.
+    props : list of :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex and edge property maps of scalar type to be saved. If not given,
+        all internal vertex and edge property maps of scalar type are saved.
+
+    Notes
+    -----
+    Vertices are renumbered contiguously, if ``g`` is filtered. The
+    out-edges of vertex ``v`` are given by the entries
+    ``out_offsets[v]:out_offsets[v+1]`` of the arrays ``out_targets`` and
+    ``out_eindex``, where the latter contains the position of the edge in
+    :meth:`~graph_tool.Graph.get_edges`, which is also the position of its
+    values in the edge property arrays. For directed graphs, the in-edges are
+    stored analogously in ``in_offsets``, ``in_sources`` and ``in_eindex``. For
+    undirected graphs, every edge appears in the out-edge lists of both
+    endpoints.
+
+    """
+    if not os.path.exists(path):
+        os.makedirs(path)
+    N = g.num_vertices(True)
+    edges = g.get_edges()
+    vidx = numpy.full(N, -1, dtype="int64")
+    vs = g.get_vertices()
+    vidx[vs] = numpy.arange(len(vs))
+
+    # edges are identified in the files by their position in get_edges()
+    eid = numpy.arange(len(edges), dtype="uint64")
+
+    def save_csr(prefix, s, t, e):
+        order = numpy.argsort(s, kind="stable")
+        offsets = numpy.zeros(len(vs) + 1, dtype="uint64")
+        numpy.cumsum(numpy.bincount(vidx[s], minlength=len(vs)),
+                     out=offsets[1:])
+        numpy.save(os.path.join(path, "%s_offsets.npy" % prefix), offsets)
+        numpy.save(os.path.join(path, "%s_%s.npy" %
+                                (prefix, "targets" if prefix == "out" else "sources")),
+                   vidx[t[order]])
+        numpy.save(os.path.join(path, "%s_eindex.npy" % prefix), e[order])
+
+    if g.is_directed():
+        save_csr("out", edges[:, 0], edges[:, 1], eid)
+        save_csr("in", edges[:, 1], edges[:, 0], eid)
+    else:
+        save_csr("out", numpy.concatenate((edges[:, 0], edges[:, 1])),
+                 numpy.concatenate((edges[:, 1], edges[:, 0])),
+                 numpy.concatenate((eid, eid)))
+
+    if props is None:
+        props = [(name, p) for (k, name), p in g.properties.items()
+                 if k != "g" and p.value_type() in _scalar_dtypes]
+    else:
+        props = [("%s%d" % (p.key_type(), i), p) for i, p in enumerate(props)]
+    meta = dict(num_vertices=len(vs), num_edges=len(edges),
+                directed=g.is_directed(), vertex_properties=[],
+                edge_properties=[])
+    for name, p in props:
+        if p.value_type() not in _scalar_dtypes or p.key_type() == "g":
+            raise ValueError("property map '%s' is not a vertex or edge property of scalar type" % name)
+        # the property names are kept only in the metadata, and the files are
+        # named by position, since the names may not be valid file names
+        if p.key_type() == "v":
+            a = p.a[vs]
+            names = meta["vertex_properties"]
+        else:
+            a = p.a[edges[:, 2]]
+            names = meta["edge_properties"]
+        numpy.save(os.path.join(path, "%sp_%d.npy" % (p.key_type(), len(names))),
+                   a)
+        names.append(name)
+    with open(os.path.join(path, "meta.json"), "w") as f:
+        json.dump(meta, f)
+
+def load_csr_arrays(path, mmap=True):
+    r"""Load the arrays written by :func:`~graph_tool.save_csr_arrays` from the
+    directory ``path``.
+
+    If ``mmap == True``, the arrays are memory-mapped read-only, instead of
+    being read into memory. In this case, all the processes that load the same
+    directory share the same physical pages, and loading is essentially
+    instantaneous.
+
+    A dictionary is returned with the entries ``"num_vertices"``,
+    ``"num_edges"``, ``"directed"``, the CSR arrays (``"out_offsets"``,
+    ``"out_targets"``, ``"out_eindex"`` and, for directed graphs, ``"in_offsets"``,
+    ``"in_sources"`` and ``"in_eindex"``), and the dictionaries
+    ``"vertex_properties"`` and ``"edge_properties"`` with the property
+    values.
+
+    Examples
+    --------
+    >>> import tempfile, shutil
+    >>> path = tempfile.mkdtemp()
+    >>> g = gt.collection.data["karate"]
+    >>> gt.save_csr_arrays(g, path)
+    >>> csr = gt.load_csr_arrays(path)
+    >>> o = csr["out_offsets"]
+    >>> print(sorted(csr["out_targets"][o[0]:o[1]]) ==
+    ...       sorted(g.get_out_neighbors(0)))
+    True
+    >>> shutil.rmtree(path)
+    """
+    with open(os.path.join(path, "meta.json")) as f:
+        meta = json.load(f)
+    mode = "r" if mmap else None
+    load = lambda name: numpy.load(os.path.join(path, name + ".npy"),
+                                   mmap_mode=mode)
+    csr = dict(num_vertices=meta["num_vertices"], num_edges=meta["num_edges"],
+               directed=meta["directed"])
+    ns = [("out", "targets")]
+    if meta["directed"]:
+        ns.append(("in", "sources"))
+    for prefix, nb in ns:
+        for name in ["offsets", nb, "eindex"]:
+            csr["%s_%s" % (prefix, name)] = load("%s_%s" % (prefix, name))
+    for k, key in [("v", "vertex_properties"), ("e", "edge_properties")]:
+        csr[key] = {name: load("%sp_%d" % (k, i))
+                    for i, name in enumerate(meta[key])}
+    return csr
+
+_graph_log_format = "graph-tool log"
+_graph_log_version = 1
+
+class GraphLog(object):
+    r"""Append-only log of the modifications of graph ``g``, which is
+    checkpointed to the file ``file_name``, in the "gt" format, and whose
+    subsequent changes are appended to the file ``log_file``.
+
+    The modifications must be done via the methods of this object, which apply
+    them to the graph and record them in the log. Saving them costs time
+    proportional to the size of the change, not of the graph. The graph can be
+    recovered with :func:`~graph_tool.load_graph_log`, and
+    :meth:`~graph_tool.GraphLog.checkpoint` compacts the log into a new
+    version of ``file_name``.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be logged. It cannot be filtered.
+    file_name : ``str``
+        Checkpoint file, saved in the "gt" format (it may be compressed
+        according to its extension).
+    log_file : ``str``
+        File where the modifications are appended.
+    append : ``bool`` (optional, default: ``False``)
+        If ``True``, the graph is not checkpointed, and the modifications are
+        appended to the existing log. In this case, ``g`` must have been
+        returned by :func:`~graph_tool.load_graph_log` with the same files, and
+        not modified since.
+
+    Notes
+    -----
+    The edges are identified in the log by their indexes. Because of this,
+    the checkpoint renumbers them with :meth:`~graph_tool.Graph.compact`, and
+    the graph must not be modified other than via this object, since otherwise
+    the indexes used while replaying the log would differ.
+
+    The records are pickled, hence logs should only be read from trusted
+    sources.
+
+    Examples
+    --------
+    >>> import os, tempfile, shutil
+    >>> path = tempfile.mkdtemp()
+    >>> fname = os.path.join(path, "graph.gt")
+    >>> lname = os.path.join(path, "graph.log")
+    >>> g = gt.Graph()
+    >>> log = gt.GraphLog(g, fname, lname)
+    >>> vs = log.add_vertex(10)
+    >>> log.add_edge_list([(0, 1), (1, 2), (2, 3)])
+    >>> log.set_property("e", "weight", g.edges(), [1., 2., 3.],
+    ...                  value_type="double")
+    >>> log.close()
+    >>> u = gt.load_graph_log(fname, lname)
+    >>> print(u.num_vertices(), u.num_edges(), u.ep.weight.a.tolist())
+    10 3 [1.0, 2.0, 3.0]
+    >>> shutil.rmtree(path)
+    """
+
+    def __init__(self, g, file_name, log_file, append=False):
+        if (g.get_vertex_filter()[0] is not None or
+            g.get_edge_filter()[0] is not None):
+            raise ValueError("filtered graphs cannot be logged")
+        self.g = g
+        self.file_name = os.path.expanduser(file_name)
+        self.log_file = os.path.expanduser(log_file)
+        self.log = None
+        if append:
+            # an incompletely written final record is discarded
+            with open(self.log_file, "r+b") as f:
+                log_id = _read_graph_log_header(f)["id"]
+                for end in _graph_log_records(f):
+                    pass
+                f.truncate(f.tell() if end is None else end)
+            self.log = open(self.log_file, "ab")
+            self.id = log_id
+        else:
+            self.checkpoint()
+
+    def __del__(self):
+        self.close()
+
+    def close(self):
+        """Close the log file."""
+        if self.log is not None:
+            self.log.close()
+            self.log = None
+
+    def checkpoint(self):
+        """Save the graph to the checkpoint file, and start an empty log. This
+        is :math:`O(V + E)`.
+
+        The checkpoint is first written to a temporary file, and is identified
+        with the log, so that an interrupted checkpoint never leaves an
+        inconsistent pair of files behind.
+        """
+        self.close()
+        g = self.g
+        g.compact(ordered=True)
+        log_id = uuid.uuid4().hex
+        g.gp["_Graph__log__id"] = g.new_gp("string", log_id)
+        try:
+            tmp = self.__tmp_name(self.file_name, log_id)
+            g.save(tmp, fmt="gt")
+        finally:
+            del g.gp["_Graph__log__id"]
+        _replace_file(tmp, self.file_name)
+
+        tmp = self.__tmp_name(self.log_file, log_id)
+        with open(tmp, "wb") as f:
+            pickle.dump(dict(format=_graph_log_format,
+                             version=_graph_log_version, id=log_id), f,
+                        protocol=pickle.HIGHEST_PROTOCOL)
+        _replace_file(tmp, self.log_file)
+        self.log = open(self.log_file, "ab")
+        self.id = log_id
+
+    @staticmethod
+    def __tmp_name(file_name, log_id):
+        # the extension is kept, since it determines the compression
+        d, base = os.path.split(file_name)
+        return os.path.join(d, ".%s.%s" % (log_id, base))
+
+    def __write(self, record):
+        if self.log is None:
+            raise ValueError("log file is closed")
+        pickle.dump(record, self.log, protocol=pickle.HIGHEST_PROTOCOL)
+        self.log.flush()
+
+    def add_vertex(self, n=1):
+        """Add ``n`` vertices to the graph, as in
+        :meth:`~graph_tool.Graph.add_vertex`."""
+        ret = self.g.add_vertex(n)
+        self.__write(("add_vertex", n))
+        return ret
+
+    def remove_vertex(self, vertex, fast=False):
+        """Remove a vertex, or an iterable of vertices, from the graph, as in
+        :meth:`~graph_tool.Graph.remove_vertex`."""
+        if isinstance(vertex, collections.Iterable):
+            vs = numpy.asarray([int(v) for v in vertex], dtype="int64")
+        else:
+            vs = numpy.asarray([int(vertex)], dtype="int64")
+        self.g.remove_vertex(vs, fast=fast)
+        self.__write(("remove_vertex", vs, fast))
+
+    def add_edge(self, source, target):
+        """Add an edge to the graph, and return it, as in
+        :meth:`~graph_tool.Graph.add_edge`."""
+        e = self.g.add_edge(source, target)
+        self.__write(("add_edges",
+                      numpy.array([[int(source), int(target)]], dtype="int64")))
+        return e
+
+    def add_edge_list(self, edge_list):
+        """Add a list of edges to the graph, given as an iterable of
+        ``(source, target)`` pairs of vertex indexes, or as a
+        :class:`~numpy.ndarray` of shape ``(E, 2)``, as in
+        :meth:`~graph_tool.Graph.add_edge_list`."""
+        edge_list = numpy.asarray(edge_list, dtype="int64").reshape((-1, 2))
+        self.g.add_edge_list(edge_list)
+        self.__write(("add_edges", edge_list))
+
+    def remove_edge(self, edge):
+        """Remove an edge, or an iterable of edges, from the graph."""
+        if isinstance(edge, EdgeBase):
+            edge = [edge]
+        es = list(edge)
+        idx = numpy.asarray([int(self.g.edge_index[e]) for e in es],
+                            dtype="int64")
+        for e in es:
+            self.g.remove_edge(e)
+        self.__write(("remove_edges", idx, self.g.get_fast_edge_removal()))
+
+    def set_property(self, key_type, name, keys, values, value_type=None):
+        """Set the values of the internal property map with the given
+        ``key_type`` (``"v"``, ``"e"`` or ``"g"``) and ``name``, for the
+        vertices or edges in ``keys``, to the corresponding entries of
+        ``values``. For graph properties, ``keys`` is ignored and ``values`` is
+        the value itself. If the property map does not yet exist, it is
+        created with type ``value_type``."""
+        g = self.g
+        k = (key_type, name)
+        if k not in g.properties:
+            if value_type is None:
+                raise ValueError("property map '%s' does not exist, and no value type was given" % name)
+            g.properties[k] = g.new_property(key_type, value_type)
+        p = g.properties[k]
+        value_type = p.value_type()
+        if key_type == "g":
+            p[g] = values
+            self.__write(("set", key_type, name, value_type, None, values))
+            return
+        if key_type == "v":
+            idx = numpy.asarray([int(v) for v in keys], dtype="int64")
+        else:
+            idx = numpy.asarray([int(g.edge_index[e]) for e in keys],
+                                dtype="int64")
+        if value_type in _scalar_dtypes:
+            values = numpy.asarray(values, dtype=_scalar_dtypes[value_type])
+        else:
+            values = list(values)
+        if len(values) != len(idx):
+            raise ValueError("number of values (%d) does not match the number of keys (%d)" %
+                             (len(values), len(idx)))
+        _set_logged_values(g, p, key_type, idx, values)
+        self.__write(("set", key_type, name, value_type, idx, values))
+
+def _replace_file(src, dst):
+    if sys.version_info >= (3, 3):
+        os.replace(src, dst)
+    else:
+        os.rename(src, dst)
+
+def _read_graph_log_header(f):
+    header = pickle.load(f)
+    if (not isinstance(header, dict) or
+        header.get("format") != _graph_log_format):
+        raise IOError("invalid graph log file")
+    if header.get("version") != _graph_log_version:
+        raise IOError("unsupported graph log version: %s" %
+                      str(header.get("version")))
+    return header
+
+def _graph_log_records(f, load=False):
+    # yields the records, or, if load == False, the position after each
+    # complete record, followed by the position where reading stopped (or None,
+    # if the end of the file was reached cleanly)
+    while True:
+        pos = f.tell()
+        try:
+            r = pickle.load(f)
+        except EOFError:
+            if not load:
+                yield None if f.tell() == pos else pos
+            return
+        except (pickle.UnpicklingError, ValueError, TypeError, IndexError,
+                AttributeError):
+            if not load:
+                yield pos
+            return
+        yield r if load else f.tell()
+
+def _logged_edges(g, idx):
+    # edge descriptors with the given indexes
+    es = g.get_edges()
+    emap = numpy.full(g.edge_index_range, -1, dtype="int64")
+    emap[es[:, 2]] = numpy.arange(len(es))
+    edges = []
+    for i in idx:
+        j = emap[i] if i < len(emap) else -1
+        if j < 0:
+            raise ValueError("invalid edge index in log: %d" % i)
+        s, t = es[j, 0], es[j, 1]
+        for e in g.edge(s, t, all_edges=True):
+            if g.edge_index[e] == i:
+                edges.append(e)
+                break
+    return edges
+
+def _set_logged_values(g, p, key_type, idx, values):
+    if p.value_type() in _scalar_dtypes:
+        p.a[idx] = values
+        return
+    if key_type == "v":
+        for i, x in zip(idx, values):
+            p[g.vertex(i)] = x
+    else:
+        for e, x in zip(_logged_edges(g, idx), values):
+            p[e] = x
+
+def _replay_graph_log(g, records):
+    # consecutive records of the same kind are merged, so that they are applied
+    # in bulk
+    def flush(batch):
+        op = batch[0][0]
+        if op == "add_vertex":
+            g.add_vertex(sum(r[1] for r in batch))
+        elif op == "add_edges":
+            g.add_edge_list(numpy.concatenate([r[1] for r in batch]))
+        elif op == "remove_edges":
+            g.set_fast_edge_removal(batch[0][2])
+            idx = numpy.concatenate([r[1] for r in batch])
+            for e in _logged_edges(g, idx):
+                g.remove_edge(e)
+        elif op == "remove_vertex":
+            g.remove_vertex(batch[0][1], fast=batch[0][2])
+        elif op == "set":
+            _, t, name, value_type, _, _ = batch[0]
+            k = (t, name)
+            if k not in g.properties:
+                g.properties[k] = g.new_property(t, value_type)
+            p = g.properties[k]
+            if t == "g":
+                p[g] = batch[-1][5]
+                return
+            idx = numpy.concatenate([r[4] for r in batch])
+            if value_type in _scalar_dtypes:
+                values = numpy.concatenate([r[5] for r in batch])
+            else:
+                values = list(itertools.chain(*[r[5] for r in batch]))
+            # keep only the last value of each key
+            _, pos = numpy.unique(idx[::-1], return_index=True)
+            pos = len(idx) - 1 - pos
+            idx = idx[pos]
+            if value_type in _scalar_dtypes:
+                values = values[pos]
+            else:
+                values = [values[i] for i in pos]
+            _set_logged_values(g, p, t, idx, values)
+
+    def key(r):
+        if r[0] == "set":
+            return (r[0], r[1], r[2])
+        if r[0] == "remove_edges":
+            return (r[0], r[2])
+        if r[0] == "remove_vertex":
+            return None
+        return r[0]
+
+    batch = []
+    for r in records:
+        if len(batch) > 0 and (key(r) is None or key(r) != key(batch[-1])):
+            flush(batch)
+            batch = []
+        batch.append(r)
+    if len(batch) > 0:
+        flush(batch)
+
+def load_graph_log(file_name, log_file):
+    r"""Load a graph written with :class:`~graph_tool.GraphLog`, from the
+    checkpoint file ``file_name`` and the log file ``log_file``.
+
+    The logged modifications are replayed in the order they were made, with
+    consecutive insertions of vertices and edges, and updates of the same
+    property map, being applied together in bulk. An incompletely written
+    final record, as left by an interrupted process, is ignored. If the log
+    does not belong to the checkpoint, e.g. because a checkpoint was
+    interrupted after the graph file was fully written, it is ignored
+    entirely.
+    """
+    g = load_graph(file_name, fmt="gt")
+    log_id = None
+    if "_Graph__log__id" in g.gp:
+        log_id = g.gp["_Graph__log__id"]
+        del g.gp["_Graph__log__id"]
+    log_file = os.path.expanduser(log_file)
+    if log_id is None or not os.path.exists(log_file):
+        return g
+    with open(log_file, "rb") as f:
+        if _read_graph_log_header(f)["id"] != log_id:
+            return g
+        _replay_graph_log(g, (r for r in _graph_log_records(f, True)))
+    return g
+
+def _arrow_column(p):
+    # Arrow array with the values of property map p, in the order of the "fa"
+    # attribute; scalar values are shared with the property map whenever
+    # possible
+    vt = p.value_type()
+    if vt in _scalar_dtypes:
+        a = p.fa
+        if vt == "bool":
+            return pyarrow.array(numpy.asarray(a, dtype="bool"))
+        a = numpy.ascontiguousarray(a)
+        return pyarrow.Array.from_buffers(pyarrow.from_numpy_dtype(a.dtype),
+                                          len(a), [None, pyarrow.py_buffer(a)])
+    if vt == "string":
+        codes, labels = encode_string_property(p)
+        return pyarrow.DictionaryArray.from_arrays(pyarrow.array(codes.fa),
+                                                   pyarrow.array(labels,
+                                                                 pyarrow.string()))
+    dtype = _vector_dtype(vt)
+    if dtype is not None:
+        values, offsets = p.get_ragged_array()
+        if vt == "vector<bool>":
+            values = numpy.asarray(values, dtype="bool")
+        return pyarrow.LargeListArray.from_arrays(pyarrow.array(offsets),
+                                                  pyarrow.array(values))
+    raise ValueError("property maps of type '%s' cannot be converted to Arrow arrays" % vt)
+
+def graph_to_arrow(g, vprops=None, eprops=None):
+    r"""Convert the graph ``g`` and its property maps into a pair of
+    :class:`pyarrow.Table` objects.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be converted. Filters are respected.
+    vprops : ``dict`` of :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property maps to be included, keyed by their column name. If not
+        given, all internal vertex property maps are included.
+    eprops : ``dict`` of :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Edge property maps to be included, keyed by their column name. If not
+        given, all internal edge property maps are included.
+
+    Returns
+    -------
+    vertices : :class:`pyarrow.Table`
+        Table with one row per vertex, and one column per vertex property map.
+    edges : :class:`pyarrow.Table`
+        Table with one row per edge, with the ``"source"`` and ``"target"``
+        columns containing the vertex indexes, followed by one column per edge
+        property map. Whether the graph is directed, and the number of
+        vertices, are stored in its schema metadata.
+
+    Notes
+    -----
+    Property maps of scalar type are converted into primitive arrays, and,
+    if the graph is not filtered and has no gaps in its edge indexes, these
+    share their memory with the property maps, without any copy. Such tables
+    become invalid if the graph or its property maps are modified, or if the
+    property maps are destroyed. String property maps are converted into
+    dictionary arrays via :func:`~graph_tool.encode_string_property`, and
+    vectors of scalar types into list arrays. Other types are not supported.
+
+    The edges are ordered by their index. If the graph is filtered, the
+    vertices are renumbered contiguously.
+
+    This function requires the :mod:`pyarrow` module.
+    """
+    try:
+        pyarrow
+    except NameError:
+        raise NotImplementedError("Arrow conversion requires the 'pyarrow' Python module")
+
+    if vprops is None:
+        vprops = dict(g.vp.items())
+    if eprops is None:
+        eprops = dict(g.ep.items())
+
+    vs = g.get_vertices()
+    edges = g.get_edges()
+    if len(edges) > 0 and (numpy.diff(edges[:, 2]) < 0).any():
+        edges = edges[numpy.argsort(edges[:, 2], kind="stable")]
+    if len(vs) != g._Graph__graph.get_num_vertices(False):
+        vidx = numpy.full(g._Graph__graph.get_num_vertices(False), -1,
+                          dtype="int64")
+        vidx[vs] = numpy.arange(len(vs))
+        s, t = vidx[edges[:, 0]], vidx[edges[:, 1]]
+    else:
+        s, t = edges[:, 0], edges[:, 1]
+
+    vnames = list(vprops.keys())
+    vtable = pyarrow.Table.from_arrays([_arrow_column(vprops[k])
+                                        for k in vnames], names=vnames)
+    enames = list(eprops.keys())
+    ecols = [pyarrow.array(numpy.ascontiguousarray(s)),
+             pyarrow.array(numpy.ascontiguousarray(t))]
+    ecols += [_arrow_column(eprops[k]) for k in enames]
+    etable = pyarrow.Table.from_arrays(ecols, names=["source", "target"] + enames)
+    meta = {b"graph_tool.directed": b"1" if g.is_directed() else b"0",
+            b"graph_tool.num_vertices": str(len(vs)).encode()}
+    etable = etable.replace_schema_metadata(meta)
+    return vtable, etable
+
+def _gt_value_type(t):
+    # graph-tool value type able to hold the values of Arrow type t
+    if pyarrow.types.is_boolean(t):
+        return "bool"
+    if pyarrow.types.is_integer(t):
+        if t.bit_width <= 8 or (t.bit_width == 16 and
+                                pyarrow.types.is_signed_integer(t)):
+            return "int16_t"
+        if t.bit_width == 16 or (t.bit_width == 32 and
+                                 pyarrow.types.is_signed_integer(t)):
+            return "int32_t"
+        return "int64_t"
+    if pyarrow.types.is_floating(t):
+        return "double"
+    if pyarrow.types.is_string(t) or pyarrow.types.is_large_string(t):
+        return "string"
+    if pyarrow.types.is_dictionary(t) and (pyarrow.types.is_string(t.value_type) or
+                                           pyarrow.types.is_large_string(t.value_type)):
+        return "string"
+    if pyarrow.types.is_list(t) or pyarrow.types.is_large_list(t):
+        vt = _gt_value_type(t.value_type)
+        if vt is not None and vt != "string":
+            return "vector<%s>" % vt
+    return None
+
+def _set_arrow_column(g, k, col):
+    # property map of key type k with the values of the Arrow column col
+    vt = _gt_value_type(col.type)
+    if vt is None:
+        raise ValueError("Arrow columns of type '%s' cannot be converted to property maps" % str(col.type))
+    if isinstance(col, pyarrow.ChunkedArray):
+        col = col.combine_chunks() if col.num_chunks != 1 else col.chunk(0)
+    if col.null_count > 0:
+        raise ValueError("Arrow columns with null values are not supported")
+    if vt == "string":
+        if not pyarrow.types.is_dictionary(col.type):
+            col = col.dictionary_encode()
+        codes = g.new_property(k, "int64_t")
+        codes.fa = col.indices.to_numpy(zero_copy_only=False)
+        return decode_string_property(codes, col.dictionary.to_pylist())
+    p = g.new_property(k, vt)
+    if vt.startswith("vector"):
+        offsets = numpy.asarray(col.offsets, dtype="int64")
+        values = col.values.to_numpy(zero_copy_only=False)
+        p.set_ragged_array(values[offsets[0]:offsets[-1]], offsets - offsets[0])
+    else:
+        p.fa = col.to_numpy(zero_copy_only=False)
+    return p
+
+def graph_from_arrow(edges, vertices=None, directed=None, source="source",
+                     target="target"):
+    r"""Create a graph from the :class:`pyarrow.Table` objects ``edges`` and
+    (optionally) ``vertices``, as returned by
+    :func:`~graph_tool.graph_to_arrow`.
+
+    Parameters
+    ----------
+    edges : :class:`pyarrow.Table`
+        Table with one row per edge. The columns ``source`` and ``target``
+        contain the vertex indexes of the endpoints, and the remaining columns
+        become internal edge property maps.
+    vertices : :class:`pyarrow.Table` (optional, default: ``None``)
+        Table with one row per vertex, whose columns become internal vertex
+        property maps.
+    directed : ``bool`` (optional, default: ``None``)
+        Whether the graph is directed. If not given, it is taken from the
+        metadata of ``edges``, if available, or is otherwise ``True``.
+    source : ``str`` (optional, default: ``"source"``)
+        Name of the column with the source vertices.
+    target : ``str`` (optional, default: ``"target"``)
+        Name of the column with the target vertices.
+
+    Returns
+    -------
+    g : :class:`~graph_tool.Graph`
+        The new graph.
+
+    Notes
+    -----
+    The edges are inserted in a single pass, and numeric columns are copied
+    directly into the storage of the property maps. Dictionary-encoded (or
+    plain) string columns are decoded via
+    :func:`~graph_tool.decode_string_property`, and list columns of numeric
+    values become vector-valued property maps. Columns must not contain null
+    values.
+
+    This function requires the :mod:`pyarrow` module.
+    """
+    try:
+        pyarrow
+    except NameError:
+        raise NotImplementedError("Arrow conversion requires the 'pyarrow' Python module")
+
+    meta = edges.schema.metadata or {}
+    if directed is None:
+        directed = meta.get(b"graph_tool.directed", b"1") != b"0"
+    N = 0
+    if b"graph_tool.num_vertices" in meta:
+        N = int(meta[b"graph_tool.num_vertices"])
+    if vertices is not None:
+        N = max(N, vertices.num_rows)
+
+    g = Graph(directed=directed)
+    g.add_vertex(N)
+    s = edges.column(source).to_numpy()
+    t = edges.column(target).to_numpy()
+    g.add_edge_list(numpy.column_stack((numpy.asarray(s, dtype="int64"),
+                                        numpy.asarray(t, dtype="int64"))))
+    for name in edges.column_names:
+        if name in (source, target):
+            continue
+        g.ep[name] = _set_arrow_column(g, "e", edges.column(name))
+    if vertices is not None:
+        for name in vertices.column_names:
+            g.vp[name] = _set_arrow_column(g, "v", vertices.column(name))
+    return g
+
+def save_graph_parquet(g, path, vprops=None, eprops=None, **kwargs):
+    r"""Save the graph ``g`` and its property maps as the Parquet files
+    ``vertices.parquet`` and ``edges.parquet`` in the directory ``path``, with
+    the layout described in :func:`~graph_tool.graph_to_arrow`. The remaining
+    keyword arguments are passed to :func:`pyarrow.parquet.write_table`.
+
+    This function requires the :mod:`pyarrow` module.
+    """
+    try:
+        import pyarrow.parquet
+    except ImportError:
+        raise NotImplementedError("Parquet files require the 'pyarrow' Python module")
+    if not os.path.exists(path):
+        os.makedirs(path)
+    vtable, etable = graph_to_arrow(g, vprops, eprops)
+    pyarrow.parquet.write_table(vtable, os.path.join(path, "vertices.parquet"),
+                                **kwargs)
+    pyarrow.parquet.write_table(etable, os.path.join(path, "edges.parquet"),
+                                **kwargs)
+
+def load_graph_parquet(path, directed=None):
+    r"""Load a graph from the Parquet files written by
+    :func:`~graph_tool.save_graph_parquet` in the directory ``path``, as
+    described in :func:`~graph_tool.graph_from_arrow`.
+
+    This function requires the :mod:`pyarrow` module.
+    """
+    try:
+        import pyarrow.parquet
+    except ImportError:
+        raise NotImplementedError("Parquet files require the 'pyarrow' Python module")
+    etable = pyarrow.parquet.read_table(os.path.join(path, "edges.parquet"))
+    vtable = None
+    if os.path.exists(os.path.join(path, "vertices.parquet")):
+        vtable = pyarrow.parquet.read_table(os.path.join(path,
+                                                         "vertices.parquet"))
+    return graph_from_arrow(etable, vtable, directed=directed)
+
+
 class GraphView(Graph):
     """A view of selected vertices or edges of another graph.
 
@@ -3067,7 +4805,10 @@ class GraphView(Graph):
     the graph view. If ``directed is None``, the directionality is inherited
     from ``g``.
 
-    If ``reversed == True``, the direction of the edges is reversed.
+    If ``reversed == True``, the direction of the edges is reversed. (If
+    graph-tool was compiled with ``--enable-slim-dispatch``, see
+    :func:`~graph_tool.show_config`, reversed views cannot be combined with
+    vertex or edge filters.)
 
     If ``vfilt`` or ``efilt`` is anything other than a
     :class:`~graph_tool.PropertyMap` instance, the instantiation running time is
@@ -3420,9 +5161,17 @@ def seed_rng(seed):
     import graph_tool
     graph_tool._rng = libcore.get_rng(seed)
 
+# Per-thread RNG overrides, used to give independent streams to computations
+# running concurrently in different Python threads (e.g. tempering replicas)
+_rng_local = threading.local()
+
 def _get_rng():
     global _rng
-    return _rng
+    rng = getattr(_rng_local, "rng", None)
+    return rng if rng is not None else _rng
+
+def _set_thread_rng(rng):
+    _rng_local.rng = rng
 
 # OpenMP Setup
 
@@ -3448,5 +5197,295 @@ def openmp_set_schedule(schedule, chunk=0):
     any of: ``"static"``, ``"dynamic"``, ``"guided"``, ``"auto"``."""
     return libcore.openmp_set_schedule(schedule, chunk)
 
+def _get_openmp_tuning_file():
+    return os.environ.get("GRAPH_TOOL_OPENMP_TUNING",
+                          os.path.join(os.path.expanduser("~"), ".cache",
+                                       "graph-tool", "openmp_tuning.json"))
+
+def openmp_get_loop_tuning():
+    """Return the tuning of the parallel loops, as a dictionary mapping each
+    loop class (``"vertex"``, ``"edge"``, ``"flat_edge"`` and ``"container"``)
+    to a tuple ``(thresh, schedule, chunk)``, or ``None`` if it is disabled
+    (see :func:`~graph_tool.openmp_calibrate`)."""
+    if not libcore.openmp_get_loop_tuning_enabled():
+        return None
+    return dict(libcore.openmp_get_loop_tuning())
+
+def openmp_set_loop_tuning(tuning):
+    """Set the tuning of the parallel loops, given as a dictionary in the format
+    returned by :func:`~graph_tool.openmp_get_loop_tuning`. The loops are only
+    run in parallel if they contain more than ``thresh`` elements, with the
+    given ``schedule`` (which can be ``"runtime"`` for the global one, see
+    :func:`~graph_tool.openmp_set_schedule`) and ``chunk`` size. The missing
+    loop classes keep their current values. If ``tuning`` is ``None``, the
+    tuning is disabled, and the compile-time threshold and global schedule are
+    used everywhere."""
+    if tuning is None:
+        libcore.openmp_set_loop_tuning_enabled(False)
+        return
+    for name, (thresh, schedule, chunk) in tuning.items():
+        libcore.openmp_set_loop_tuning(name, int(thresh), schedule, int(chunk))
+    libcore.openmp_set_loop_tuning_enabled(True)
+
+def openmp_calibrate(save=True, file_name=None):
+    """Calibrate the parallel loops for the current machine and number of
+    threads, and return the resulting tuning (see
+    :func:`~graph_tool.openmp_get_loop_tuning`), which is enabled.
+
+    For every class of loop, the minimum number of elements from which it is
+    worth spawning threads is determined by timing synthetic workloads with one
+    and all threads, and the OpenMP schedule of the vertex and edge loops is
+    chosen as the fastest for a workload with a broad degree distribution. This
+    takes a few seconds.
+
+    If ``save == True``, the tuning is saved to ``file_name``, from where it is
+    loaded automatically when graph-tool is imported with the same number of
+    threads. The default file name is ``~/.cache/graph-tool/openmp_tuning.json``,
+    which can be overridden with the ``GRAPH_TOOL_OPENMP_TUNING`` environment
+    variable.
+    """
+    libcore.openmp_calibrate_loops()
+    tuning = openmp_get_loop_tuning()
+    if save:
+        if file_name is None:
+            file_name = _get_openmp_tuning_file()
+        file_name = os.path.expanduser(file_name)
+        d = os.path.dirname(file_name)
+        if d != "" and not os.path.exists(d):
+            os.makedirs(d)
+        with open(file_name, "w") as f:
+            json.dump(dict(nthreads=openmp_get_num_threads(), tuning=tuning),
+                      f, indent=2)
+    return tuning
+
+def _load_openmp_tuning():
+    file_name = _get_openmp_tuning_file()
+    if not os.path.exists(file_name):
+        return
+    try:
+        with open(file_name) as f:
+            d = json.load(f)
+        if d["nthreads"] == openmp_get_num_threads():
+            openmp_set_loop_tuning(d["tuning"])
+    except (ValueError, KeyError, TypeError, IOError) as e:
+        warnings.warn("error loading the OpenMP tuning from '%s': %s" %
+                      (file_name, str(e)), RuntimeWarning)
+
+def openmp_set_thread_affinity(policy):
+    """Pin the OpenMP threads to CPUs. The policy can be any of: ``"compact"``,
+    where consecutive threads are placed on consecutive CPUs, filling one NUMA
+    node before the next; ``"spread"``, where the threads are distributed
+    round-robin between the NUMA nodes; or ``"none"``, which restores the
+    initial CPU affinity. The placement is lost if the number of threads is
+    changed afterwards. This is only supported on Linux."""
+    return libcore.openmp_set_thread_affinity(policy)
+
+def openmp_get_thread_affinity():
+    """Return the thread affinity policy set with
+    :func:`~graph_tool.openmp_set_thread_affinity`."""
+    return libcore.openmp_get_thread_affinity()
+
+def numa_get_num_nodes():
+    """Return the number of NUMA nodes in the system."""
+    return libcore.numa_get_num_nodes()
+
+def numa_set_first_touch(enabled):
+    """Enable or disable NUMA first-touch placement (disabled by default). If
+    enabled, large scalar property maps are initialized in parallel when they
+    are allocated, with the same static partition used by the parallel
+    algorithms, so that the memory pages end up on the NUMA nodes of the
+    threads that will access them. This requires the default ``"static"``
+    OpenMP schedule (see :func:`~graph_tool.openmp_set_schedule`), and the
+    threads to be pinned to CPUs (see
+    :func:`~graph_tool.openmp_set_thread_affinity`)."""
+    libcore.numa_set_first_touch(enabled)
+
+def numa_get_first_touch():
+    """Return ``True`` if NUMA first-touch placement is enabled."""
+    return libcore.numa_get_first_touch()
+
+# Tracing
+
+def set_tracing(enabled=True, capacity=None, clear=True):
+    """Enable or disable the tracing of the algorithms. This requires
+    graph-tool to be compiled with ``--enable-tracing``.
+
+    When enabled, each call of a C++ algorithm records the time spent in the
+    type dispatch (``"run_action"`` events) and in the algorithm itself
+    (``"kernel"`` events, with the type of the function as argument), together
+    with the named phases of the main algorithms (category ``"phase"``) and
+    counters (category ``"counter"``), such as the size of the graph, or the
+    number of bytes allocated for property maps. The events are kept in a ring
+    buffer of size ``capacity``, which overwrites the oldest events when full,
+    and can be retrieved with :func:`~graph_tool.get_trace` or
+    :func:`~graph_tool.save_trace`. If ``clear == True``, the buffer is
+    cleared."""
+    if capacity is not None:
+        libcore.trace_set_capacity(capacity)
+    elif clear:
+        libcore.trace_clear()
+    libcore.trace_set_enabled(enabled)
+
+def get_trace(clear=False, callback=None):
+    """Return the events recorded since tracing was enabled (see
+    :func:`~graph_tool.set_tracing`), as a list of dictionaries in the Chrome
+    trace event format, with times in microseconds. If ``callback`` is given,
+    it is instead called for each event, and nothing is returned. If ``clear ==
+    True``, the buffer is cleared afterwards."""
+    count, events = libcore.trace_get_events()
+    if count > len(events):
+        warnings.warn("%d trace events were overwritten; consider increasing "
+                      "the capacity of the trace buffer" %
+                      (count - len(events)), RuntimeWarning)
+    pid = os.getpid()
+    ret = []
+    for name, cat, ph, arg, ts, dur, value, tid in events:
+        e = dict(name=name, cat=cat, ph=ph, ts=ts / 1e3, pid=pid, tid=tid)
+        if ph == "X":
+            e["dur"] = dur / 1e3
+            if arg != "":
+                e["args"] = dict(arg=arg)
+        else:
+            e["args"] = {name: value}
+        if callback is not None:
+            callback(e)
+        else:
+            ret.append(e)
+    if clear:
+        libcore.trace_clear()
+    if callback is None:
+        return ret
+
+def save_trace(file_name, clear=False):
+    """Save the events recorded since tracing was enabled (see
+    :func:`~graph_tool.set_tracing`) to ``file_name`` in the Chrome trace
+    format, which can be visualized with ``chrome://tracing`` or Perfetto."""
+    import json
+    with open(file_name, "w") as f:
+        json.dump(dict(traceEvents=get_trace(clear=clear),
+                       displayTimeUnit="ns"), f)
+
+# Asynchronous execution
+
+class AlgorithmExecutor(object):
+    r"""Pool of ``max_workers`` threads that run graph-tool functions
+    concurrently, returning :class:`concurrent.futures.Future` objects.
+
+    Parameters
+    ----------
+    max_workers : ``int`` (optional, default: ``None``)
+        Maximum number of jobs running at the same time. If not given, the
+        number of OpenMP threads (see :func:`~graph_tool.openmp_get_num_threads`)
+        is used.
+    nthreads : ``int`` (optional, default: ``None``)
+        Number of OpenMP threads used by each job. If not given, the OpenMP
+        threads are split evenly between the ``max_workers`` jobs.
+
+    Notes
+    -----
+    The jobs run in Python threads, which release the GIL while the C++
+    algorithms are running, so that different algorithms (e.g. on different
+    graphs) can make use of all the cores at the same time. The arguments are
+    still converted, and the results returned, with the GIL held, so this is
+    only useful for jobs that spend most of their time in C++.
+
+    Each job uses its own random number generator, seeded from numpy's at
+    submission time, so that the results are reproducible, with
+    :func:`numpy.random.seed`, regardless of the order in which the jobs are
+    executed.
+
+    The same graph, or property maps, should not be modified by more than one
+    job at the same time.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> with gt.AlgorithmExecutor(max_workers=2) as ex:
+    ...     pr = ex.submit(gt.pagerank, g)
+    ...     c = ex.submit(gt.kcore_decomposition, g)
+    ...     pr, c = pr.result(), c.result()
+
+    The futures can also be awaited in :mod:`asyncio` code, via
+    :meth:`~graph_tool.AlgorithmExecutor.run_async`.
+    """
+
+    def __init__(self, max_workers=None, nthreads=None):
+        import concurrent.futures
+        if max_workers is None:
+            max_workers = openmp_get_num_threads()
+        self.max_workers = max(int(max_workers), 1)
+        if nthreads is None:
+            nthreads = openmp_get_num_threads() // self.max_workers
+        self.nthreads = max(int(nthreads), 1)
+        self._pool = \
+            concurrent.futures.ThreadPoolExecutor(max_workers=self.max_workers)
+
+    def _run(self, nthreads, rng, fn, args, kwargs):
+        # the number of threads is a per-thread OpenMP setting, so this does
+        # not affect the other jobs
+        if openmp_enabled():
+            libcore.openmp_set_num_threads(nthreads)
+        _set_thread_rng(rng)
+        try:
+            return fn(*args, **kwargs)
+        finally:
+            _set_thread_rng(None)
+
+    def submit_nthreads(self, nthreads, fn, *args, **kwargs):
+        """Schedule ``fn(*args, **kwargs)`` to be run with ``nthreads`` OpenMP
+        threads, and return a :class:`concurrent.futures.Future`."""
+        rng = libcore.split_rng(_get_rng())
+        return self._pool.submit(self._run, max(int(nthreads), 1), rng, fn,
+                                 args, kwargs)
+
+    def submit(self, fn, *args, **kwargs):
+        """Schedule ``fn(*args, **kwargs)`` to be run with the default number of
+        OpenMP threads, and return a :class:`concurrent.futures.Future`."""
+        return self.submit_nthreads(self.nthreads, fn, *args, **kwargs)
+
+    def run_async(self, fn, *args, **kwargs):
+        """Like :meth:`~graph_tool.AlgorithmExecutor.submit`, but return an
+        :mod:`asyncio` future, bound to the current event loop, which can be
+        awaited."""
+        import asyncio
+        return asyncio.wrap_future(self.submit(fn, *args, **kwargs))
+
+    def map(self, fn, *iterables):
+        """Return an iterator over ``fn(*args)`` for the elements ``args`` of
+        ``zip(*iterables)``, with the calls made concurrently."""
+        fs = [self.submit(fn, *args) for args in zip(*iterables)]
+        return (f.result() for f in fs)
+
+    def shutdown(self, wait=True):
+        """Free the resources of the pool, after waiting for the pending jobs
+        if ``wait == True``."""
+        self._pool.shutdown(wait=wait)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.shutdown(wait=True)
+        return False
+
+_default_executor = None
+_default_executor_lock = threading.Lock()
+
+def submit_async(fn, *args, **kwargs):
+    """Schedule ``fn(*args, **kwargs)`` to be run in a shared
+    :class:`~graph_tool.AlgorithmExecutor`, created with the default
+    parameters on first use, and return a :class:`concurrent.futures.Future`.
+    The result can be awaited in :mod:`asyncio` code with
+    :func:`asyncio.wrap_future`."""
+    global _default_executor
+    with _default_executor_lock:
+        if _default_executor is None:
+            _default_executor = AlgorithmExecutor()
+    return _default_executor.submit(fn, *args, **kwargs)
+
 if openmp_enabled() and os.environ.get("OMP_SCHEDULE") is None:
     openmp_set_schedule("static", 0)
+
+if openmp_enabled():
+    _load_openmp_tuning()
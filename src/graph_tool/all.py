@@ -41,6 +41,8 @@ except ImportError as e:
     pass
 from graph_tool.stats import *
 import graph_tool.stats
+from graph_tool.distributed import *
+import graph_tool.distributed
 from graph_tool.generation import *
 import graph_tool.generation
 from graph_tool.stats import *
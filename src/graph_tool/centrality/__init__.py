@@ -31,9 +31,13 @@ Summary
    :nosignatures:
 
    pagerank
+   batch_pagerank
+   local_pagerank
    betweenness
+   approx_betweenness
    central_point_dominance
    closeness
+   top_closeness
    eigenvector
    katz
    hits
@@ -49,18 +53,31 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_centrality")
 
-from .. import _prop, ungroup_vector_property, Vector_size_t
+from .. import _prop, group_vector_property, ungroup_vector_property, \
+    Vector_size_t, _get_rng
 from .. topology import shortest_distance
 import sys
 import numpy
 import numpy.linalg
 
-__all__ = ["pagerank", "betweenness", "central_point_dominance", "closeness",
-           "eigentrust", "eigenvector", "katz", "hits", "trust_transitivity"]
+__all__ = ["pagerank", "batch_pagerank", "local_pagerank", "betweenness", "approx_betweenness",
+           "central_point_dominance", "closeness", "top_closeness",
+           "eigentrust", "eigenvector",
+           "katz", "hits", "trust_transitivity"]
+
+def _new_trace(trace, max_iter):
+    # rows for the convergence trace of the iterative solvers, which are
+    # filled in place; the unused ones are left as NaN
+    n = (max_iter if max_iter > 0 else 10000) if trace else 0
+    return numpy.full((n, 3), numpy.nan)
+
+def _trim_trace(trace):
+    return trace[numpy.isfinite(trace[:, 1])]
 
 
 def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
-             max_iter=None, ret_iter=False):
+             max_iter=None, ret_iter=False, changed=None, trace=False,
+             precision="double"):
     r"""
     Calculate the PageRank of each vertex.
 
@@ -76,20 +93,43 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
     weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
         Edge weights. If omitted, a constant value of 1 will be used.
     prop : :class:`~graph_tool.PropertyMap`, optional (default: None)
-        Vertex property map to store the PageRank values. If supplied, it will
-        be used uninitialized.
+        Vertex property map to store the PageRank values. If supplied, its
+        values will be used as the initial guess of the iteration, so that a
+        previous solution can be used as a warm start.
     epsilon : float, optional (default: 1e-6)
         Convergence condition. The iteration will stop if the total delta of all
         vertices are below this value.
     max_iter : int, optional (default: None)
         If supplied, this will limit the total number of iterations.
     ret_iter : bool, optional (default: False)
-        If true, the total number of iterations is also returned.
+        If true, the total number of iterations (or of pushes, if ``changed`` is
+        given) is also returned.
+    changed : :class:`~numpy.ndarray` or list of pairs, optional (default: None)
+        If supplied, ``prop`` must contain the PageRank values before the edges
+        between the given pairs of vertices ``(s, t)`` were added to or removed
+        from the graph (which must have already happened), and they will be
+        updated incrementally, by propagating the residuals only from the
+        affected vertices, instead of iterating over the whole graph.
+    trace : bool, optional (default: ``False``)
+        If ``True``, an array of shape ``(n, 3)`` is also returned, with the
+        residual, the elapsed time in seconds, and the number of edges
+        processed so far, after each of the ``n`` iterations (nothing is recorded
+        if ``changed`` is given). At most ``max_iter``
+        (or 10000, if it is not given) iterations are recorded.
+    precision : ``"double"`` or ``"mixed"``, optional (default: ``"double"``)
+        If ``"mixed"``, the edge weights are stored and the iteration is done
+        with single-precision values, which halves the memory traffic, until
+        the limit of single precision is reached. The result is then checked,
+        and refined if necessary, by iterating in double precision until
+        ``epsilon`` is reached. The values are returned as ``double`` in
+        either case.
 
     Returns
     -------
     pagerank : :class:`~graph_tool.PropertyMap`
         A vertex property map containing the PageRank values.
+    trace : :class:`~numpy.ndarray`
+        The convergence trace, if ``trace == True``.
 
     See Also
     --------
@@ -212,20 +252,213 @@ def pagerank(g, damping=0.85, pers=None, weight=None, prop=None, epsilon=1e-6,
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
     """
 
+    if getattr(g, "_distributed", False):
+        from .. import distributed
+        distributed._unsupported("pagerank", pers=pers is not None,
+                                 prop=prop is not None,
+                                 changed=changed is not None, trace=trace)
+        return distributed.pagerank(g, damping, weight, epsilon, max_iter,
+                                    ret_iter)
     if max_iter is None:
         max_iter = 0
+    if precision not in ["double", "mixed"]:
+        raise ValueError("invalid precision: " + str(precision))
+    if changed is not None:
+        if prop is None:
+            raise ValueError("the previous PageRank values must be given " +
+                             "as 'prop' if 'changed' is supplied")
+        changed = numpy.asarray(changed, dtype="int64").ravel()
+        ic = libgraph_tool_centrality.\
+                get_pagerank_update(g._Graph__graph, _prop("v", g, prop),
+                                    _prop("v", g, pers), _prop("e", g, weight),
+                                    damping, epsilon, changed)
+        ret = (prop, ic) if ret_iter else (prop,)
+        if trace:
+            ret += (_new_trace(False, 0),)
+        return ret if len(ret) > 1 else ret[0]
     if prop is None:
         prop = g.new_vertex_property("double")
         N = len(prop.fa)
         prop.fa = pers.fa[:N] if pers is not None else 1. / g.num_vertices()
+    tr = _new_trace(trace, max_iter)
     ic = libgraph_tool_centrality.\
             get_pagerank(g._Graph__graph, _prop("v", g, prop),
                          _prop("v", g, pers), _prop("e", g, weight),
-                         damping, epsilon, max_iter)
+                         damping, epsilon, max_iter, tr,
+                         precision == "mixed")
+    ret = (prop, ic) if ret_iter else (prop,)
+    if trace:
+        ret += (_trim_trace(tr),)
+    return ret if len(ret) > 1 else ret[0]
+
+
+def batch_pagerank(g, pers, damping=0.85, weight=None, epsilon=1e-6,
+                   max_iter=None, ret_iter=False, precision="double"):
+    r"""Calculate the PageRank for many personalization vectors at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    pers : :class:`~numpy.ndarray`
+        Array of shape ``(N, K)``, where ``N`` is the number of vertices
+        (including those filtered out, with rows in the order of the vertex
+        index), containing ``K`` personalization vectors as columns.
+    damping : float, optional (default: 0.85)
+        Damping factor.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: 1e-6)
+        Convergence condition. The iteration will stop if the total delta of
+        all vertices are below this value, for every personalization vector.
+    max_iter : int, optional (default: None)
+        If supplied, this will limit the total number of iterations.
+    ret_iter : bool, optional (default: False)
+        If true, the total number of iterations is also returned.
+    precision : ``"double"`` or ``"mixed"``, optional (default: ``"double"``)
+        If ``"mixed"``, the edge weights are stored and the iteration is done
+        with single-precision values, which halves the memory traffic, until
+        the limit of single precision is reached. The result is then checked,
+        and refined if necessary, by iterating in double precision until
+        ``epsilon`` is reached. The values are returned as ``double`` in
+        either case.
+
+    Returns
+    -------
+    pagerank : :class:`~numpy.ndarray`
+        Array of shape ``(N, K)`` with the PageRank values for each
+        personalization vector.
+
+    See Also
+    --------
+    pagerank: PageRank centrality
+    local_pagerank: local approximation of the personalized PageRank
+
+    Notes
+    -----
+    This is equivalent to calling :func:`~graph_tool.centrality.pagerank` for
+    each column of ``pers``, but the graph is traversed only once per
+    iteration for all of them, and each edge updates the ``K`` values
+    contiguously, which is much faster than separate calls.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["polblogs"]
+    >>> pers = numpy.zeros((g.num_vertices(), 3))
+    >>> pers[0, 0] = pers[1, 1] = pers[2, 2] = 1
+    >>> pr = gt.batch_pagerank(g, pers)
+    >>> p = g.new_vertex_property("double", vals=pers[:, 1])
+    >>> print(numpy.allclose(pr[:, 1], gt.pagerank(g, pers=p).a, atol=1e-6))
+    True
+
+    """
+    if max_iter is None:
+        max_iter = 0
+    if precision not in ["double", "mixed"]:
+        raise ValueError("invalid precision: " + str(precision))
+    pers = numpy.array(pers, dtype="double", order="C")
+    if pers.ndim == 1:
+        pers = pers.reshape((-1, 1))
+    rank = pers.copy()
+    ic = libgraph_tool_centrality.\
+            get_batch_pagerank(g._Graph__graph, pers, rank,
+                               _prop("e", g, weight), damping, epsilon,
+                               max_iter, precision == "mixed")
     if ret_iter:
-        return prop, ic
+        return rank, ic
     else:
-        return prop
+        return rank
+
+
+def local_pagerank(g, seeds, vals=None, damping=0.85, weight=None,
+                   epsilon=1e-6, prop=None):
+    r"""Approximate the PageRank personalized by a few seed vertices, by
+    exploring only their neighborhood.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    seeds : iterable of ints or :class:`~graph_tool.Vertex`
+        Seed vertices.
+    vals : iterable of floats, optional (default: None)
+        Personalization values of the seed vertices, which must be
+        non-negative. If omitted, they will be all equal, and sum to one.
+    damping : float, optional (default: 0.85)
+        Damping factor.
+    weight : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Edge weights. If omitted, a constant value of 1 will be used.
+    epsilon : float, optional (default: 1e-6)
+        Precision of the approximation, relative to the (weighted)
+        out-degrees. Smaller values give better approximations, with a larger
+        explored region.
+    prop : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        If given, the values will be stored in this vertex property map, with
+        all other vertices set to zero. Otherwise, only the explored vertices
+        are returned.
+
+    Returns
+    -------
+    vertices : :class:`~numpy.ndarray`
+        Vertices with nonzero estimate, in increasing order. Only returned if
+        ``prop`` is not given.
+    pagerank : :class:`~numpy.ndarray` or :class:`~graph_tool.PropertyMap`
+        Estimated PageRank values of the returned vertices, or ``prop``, if it
+        is given.
+
+    See Also
+    --------
+    pagerank: PageRank centrality
+    batch_pagerank: PageRank for many personalization vectors
+
+    Notes
+    -----
+    This implements the push algorithm of [andersen-local-2006]_, which keeps
+    an estimate :math:`p(v)` and a residual :math:`r(v)`, starting with the
+    personalization values in the residual. A vertex with :math:`r(u) \geq
+    \epsilon d^{+}(u)` is pushed by adding :math:`(1-d)r(u)` to :math:`p(u)`,
+    and distributing :math:`d\,r(u)` to its out-neighbors in proportion to
+    the edge weights, until no such vertex is left. The result approximates
+    from below the PageRank computed with
+    :func:`~graph_tool.centrality.pagerank` with the same
+    personalization, and the running time is :math:`O(\sum_i
+    p_i/(\epsilon(1-d)))`, independently of the size of the graph.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["polblogs"]
+    >>> vs, pr = gt.local_pagerank(g, [0, 1], epsilon=1e-4)
+    >>> p = g.new_vertex_property("double")
+    >>> p.a[[0, 1]] = 0.5
+    >>> pr_exact = gt.pagerank(g, pers=p, epsilon=1e-10)
+    >>> print(numpy.abs(pr_exact.a[vs] - pr).max() < 1e-3)
+    True
+
+    References
+    ----------
+    .. [andersen-local-2006] R. Andersen, F. Chung, K. Lang, "Local graph
+       partitioning using PageRank vectors", FOCS 2006,
+       :doi:`10.1109/FOCS.2006.44`
+
+    """
+    seeds = numpy.asarray([int(v) for v in seeds], dtype="int64")
+    if vals is None:
+        vals = numpy.ones(len(seeds)) / max(len(seeds), 1)
+    vals = numpy.asarray(vals, dtype="double")
+    if len(vals) != len(seeds):
+        raise ValueError("the numbers of seeds and values differ")
+    if (vals < 0).any():
+        raise ValueError("the personalization values must be non-negative")
+    vs, pr = libgraph_tool_centrality.\
+            get_local_pagerank(g._Graph__graph, seeds, vals,
+                               _prop("e", g, weight), damping, epsilon)
+    if prop is None:
+        return vs, pr
+    prop.a = 0
+    prop.a[vs] = pr
+    return prop
 
 
 def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
@@ -354,6 +587,105 @@ def betweenness(g, pivots=None, vprop=None, eprop=None, weight=None, norm=True):
                             _prop("e", g, eprop), _prop("v", g, vprop), norm)
     return vprop, eprop
 
+def approx_betweenness(g, epsilon=0.01, delta=0.1, k=None, vprop=None,
+                       norm=True, ret_samples=False):
+    r"""Estimate the betweenness centrality of each vertex, by adaptive
+    sampling of shortest paths, with guaranteed accuracy.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    epsilon : ``float`` (optional, default: ``0.01``)
+        Maximum absolute error of the normalized betweenness values.
+    delta : ``float`` (optional, default: ``0.1``)
+        Maximum probability that the error exceeds ``epsilon``.
+    k : ``int`` (optional, default: ``None``)
+        If provided, only the ``k`` vertices of largest betweenness need to
+        be identified, which often requires far fewer samples.
+    vprop : :class:`~graph_tool.PropertyMap`, optional (default: None)
+        Vertex property map to store the vertex betweenness values.
+    norm : bool, optional (default: True)
+        Whether or not the betweenness values should be normalized.
+    ret_samples : bool, optional (default: False)
+        If ``True``, the number of sampled paths will also be returned.
+
+    Returns
+    -------
+    vertex_betweenness : A vertex property map with the estimated betweenness values.
+    top : :class:`~numpy.ndarray`
+        The ``k`` vertices with the largest estimated betweenness, in
+        decreasing order. Only returned if ``k`` is given.
+    n_samples : ``int``
+        Number of sampled paths. Only returned if ``ret_samples == True``.
+
+    See Also
+    --------
+    betweenness: exact betweenness centrality
+
+    Notes
+    -----
+    The betweenness centrality (see :func:`~graph_tool.centrality.betweenness`)
+    is estimated with the algorithm of [borassi-kadabra-2016]_: pairs of
+    distinct vertices are chosen uniformly at random, and a shortest path is
+    sampled uniformly between them, via a balanced bidirectional breadth-first
+    search. The fraction of the paths that go through each vertex estimates its
+    betweenness, and the sampling stops as soon as all estimates lie within
+    ``epsilon`` of the normalized values with probability at least ``1 -
+    delta``, or, if ``k`` is given, when the top ``k`` vertices are either
+    separated from the rest, or known to within ``epsilon``. The number of
+    samples never exceeds the bound of [riondato-fast-2016]_, which depends
+    only on the vertex diameter of the graph, irrespective of its size.
+
+    The edge weights are not taken into account.
+
+    The calculation is deterministic for a given state of the random number
+    generator, regardless of the number of threads.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    .. testcode:: approx_betweenness
+       :hide:
+
+       gt.seed_rng(42)
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> g = gt.GraphView(g, vfilt=gt.label_largest_component(g))
+    >>> vb, top = gt.approx_betweenness(g, epsilon=0.005, k=5)
+    >>> vb_exact, eb = gt.betweenness(g)
+    >>> print(abs(vb.fa - vb_exact.fa).max() < 0.005)
+    True
+
+    References
+    ----------
+    .. [borassi-kadabra-2016] M. Borassi, E. Natale, "KADABRA is an ADaptive
+       Algorithm for Betweenness via Random Approximation", ESA 2016,
+       :doi:`10.4230/LIPIcs.ESA.2016.20`
+    .. [riondato-fast-2016] M. Riondato, E. M. Kornaropoulos, "Fast
+       approximation of betweenness centrality through sampling", Data Mining
+       and Knowledge Discovery 30, 438 (2016),
+       :doi:`10.1007/s10618-015-0423-0`
+
+    """
+    if vprop is None:
+        vprop = g.new_vertex_property("double")
+    n_samples, top = \
+        libgraph_tool_centrality.get_approx_betweenness(g._Graph__graph,
+                                                        _prop("v", g, vprop),
+                                                        epsilon, delta,
+                                                        0 if k is None else k,
+                                                        norm, _get_rng())
+    ret = [vprop]
+    if k is not None:
+        ret.append(top)
+    if ret_samples:
+        ret.append(n_samples)
+    if len(ret) == 1:
+        return vprop
+    return tuple(ret)
+
 def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False):
     r"""
     Calculate the closeness centrality for each vertex.
@@ -487,6 +819,67 @@ def closeness(g, weight=None, source=None, vprop=None, norm=True, harmonic=False
         return c
 
 
+def top_closeness(g, k, norm=True, harmonic=False):
+    r"""Find the ``k`` vertices with the largest closeness centrality, without
+    computing it for every vertex.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : ``int``
+        Number of vertices to find.
+    norm : bool, optional (default: ``True``)
+        Whether or not the centrality values should be normalized.
+    harmonic : bool, optional (default: ``False``)
+        If true, the harmonic centrality is used instead.
+
+    Returns
+    -------
+    vertices : :class:`~numpy.ndarray`
+        The ``k`` vertices with the largest closeness, in decreasing order.
+    values : :class:`~numpy.ndarray`
+        Their closeness values, as given by
+        :func:`~graph_tool.centrality.closeness`.
+
+    See Also
+    --------
+    closeness: closeness centrality of every vertex
+
+    Notes
+    -----
+    This uses the algorithm of [bergamini-top-k-2016]_: the breadth-first
+    searches from the vertices most likely to be central are done first, and
+    every subsequent search is abandoned as soon as an upper bound on the
+    closeness of its source falls below the ``k``-th largest value found so
+    far. For most graphs only a small part of each search needs to be done.
+
+    Vertices that cannot reach any other vertex are never returned, and if
+    there are ties at the ``k``-th value, which ones are returned may depend
+    on the number of threads. The edge weights are not taken into account.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> g = gt.GraphView(g, vfilt=gt.label_largest_component(g))
+    >>> vs, c = gt.top_closeness(g, 5)
+    >>> print(abs(c - gt.closeness(g).a[vs]).max() < 1e-10)
+    True
+
+    References
+    ----------
+    .. [bergamini-top-k-2016] E. Bergamini, M. Borassi, P. Crescenzi,
+       A. Marino, H. Meyerhenke, "Computing top-k closeness centrality faster
+       in unweighted graphs", ALENEX 2016, :doi:`10.1137/1.9781611974317.6`
+
+    """
+    return libgraph_tool_centrality.get_top_closeness(g._Graph__graph, int(k),
+                                                      harmonic, norm)
+
+
 def central_point_dominance(g, betweenness):
     r"""
     Calculate the central point dominance of the graph, given the betweenness
@@ -545,7 +938,8 @@ def central_point_dominance(g, betweenness):
                                        _prop("v", g, betweenness))
 
 
-def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
+def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None,
+                solver="krylov", k=1, trace=False):
     r"""
     Calculate the eigenvector centrality of each vertex in the graph, as well as
     the largest eigenvalue.
@@ -558,19 +952,41 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
         Edge property map with the edge weights.
     vprop : :class:`~graph_tool.PropertyMap`, optional (default: ``None``)
         Vertex property map where the values of eigenvector must be stored. If
-        provided, it will be used uninitialized.
+        provided, its values will be used as the initial guess of the
+        iteration, so that a previous solution can be used as a warm start.
     epsilon : float, optional (default: ``1e-6``)
         Convergence condition. The iteration will stop if the total delta of all
-        vertices are below this value.
+        vertices are below this value (for ``solver == "power"``), or if the
+        norm of the residual :math:`|\mathbf{A}\mathbf{x} - \lambda\mathbf{x}|`
+        is below :math:`\epsilon\lambda` (for ``solver == "krylov"``).
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of iterations (or of
+        matrix-vector products, for ``solver == "krylov"``).
+    solver : ``"krylov"`` or ``"power"`` (optional, default: ``"krylov"``)
+        If ``"krylov"``, the thick-restart Lanczos method is used for undirected
+        graphs, and the Arnoldi method otherwise, which need far fewer passes
+        over the graph than the power method when the spectral gap is small.
+    k : int, optional (default: ``1``)
+        Number of leading eigenpairs to compute. Values larger than one are
+        only supported for undirected graphs, with ``solver == "krylov"``.
+    trace : bool, optional (default: ``False``)
+        If ``True``, an array of shape ``(n, 3)`` is also returned, with the
+        residual, the elapsed time in seconds, and the number of edges
+        processed so far, after each of the ``n`` iterations (or restart cycles,
+        for ``solver == "krylov"``). At most ``max_iter``
+        (or 10000, if it is not given) iterations are recorded.
 
     Returns
     -------
     eigenvalue : float
-        The largest eigenvalue of the (weighted) adjacency matrix.
+        The largest eigenvalue of the (weighted) adjacency matrix (or an array
+        with the ``k`` largest ones, if ``k > 1``).
     eigenvector : :class:`~graph_tool.PropertyMap`
-        A vertex property map containing the eigenvector values.
+        A vertex property map containing the eigenvector values (or a
+        ``vector<double>`` property map with the ``k`` leading eigenvectors, if
+        ``k > 1``).
+    trace : :class:`~numpy.ndarray`
+        The convergence trace, if ``trace == True``.
 
     See Also
     --------
@@ -594,11 +1010,14 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
     where :math:`\mathbf{A}` is the (weighted) adjacency matrix and
     :math:`\lambda` is the largest eigenvalue.
 
-    The algorithm uses the power method which has a topology-dependent complexity of
+    The power method has a topology-dependent complexity of
     :math:`O\left(N\times\frac{-\log\epsilon}{\log|\lambda_1/\lambda_2|}\right)`,
     where :math:`N` is the number of vertices, :math:`\epsilon` is the ``epsilon``
     parameter, and :math:`\lambda_1` and :math:`\lambda_2` are the largest and
     second largest eigenvalues of the (weighted) adjacency matrix, respectively.
+    The Krylov methods depend instead roughly on the square root of the
+    relative gap :math:`(\lambda_1-\lambda_2)/\lambda_1`, and are much faster
+    when it is small.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -654,19 +1073,51 @@ def eigenvector(g, weight=None, vprop=None, epsilon=1e-6, max_iter=None):
 
     """
 
-    if vprop is None:
-        vprop = g.new_vertex_property("double")
-        vprop.fa = 1. / g.num_vertices()
+    if solver not in ["krylov", "power"]:
+        raise ValueError("invalid solver: " + str(solver))
+    if k > 1 and (solver != "krylov" or g.is_directed()):
+        raise ValueError("more than one eigenpair can only be computed for " +
+                         "undirected graphs, with solver='krylov'")
     if max_iter is None:
         max_iter = 0
-    ee = libgraph_tool_centrality.\
-         get_eigenvector(g._Graph__graph, _prop("e", g, weight),
-                         _prop("v", g, vprop), epsilon, max_iter)
+    if k == 1 and vprop is None:
+        vprop = g.new_vertex_property("double")
+        vprop.fa = 1. / g.num_vertices()
+    tr = _new_trace(trace, max_iter)
+    if k > 1:
+        x = g.new_vertex_property("double")
+        x.fa = 1. / g.num_vertices()
+        ee, vecs, n = libgraph_tool_centrality.\
+                      get_eigenvector_krylov(g._Graph__graph,
+                                             _prop("e", g, weight),
+                                             _prop("v", g, x), epsilon,
+                                             max_iter, k, tr)
+        vecs = vecs.reshape((len(ee), -1))
+        props = []
+        for i in range(len(ee)):
+            x = g.new_vertex_property("double")
+            x.a = vecs[i, :len(x.a)]
+            props.append(x)
+        vprop = group_vector_property(props, value_type="double", prop=vprop)
+    elif solver == "krylov":
+        ee, vecs, n = libgraph_tool_centrality.\
+                      get_eigenvector_krylov(g._Graph__graph,
+                                             _prop("e", g, weight),
+                                             _prop("v", g, vprop), epsilon,
+                                             max_iter, 1, tr)
+        ee = ee[0]
+    else:
+        ee = libgraph_tool_centrality.\
+             get_eigenvector(g._Graph__graph, _prop("e", g, weight),
+                             _prop("v", g, vprop), epsilon, max_iter, tr)
+    if trace:
+        return ee, vprop, _trim_trace(tr)
     return ee, vprop
 
 
 def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
-         max_iter=None, norm=True):
+         max_iter=None, norm=True, changed=None, ret_iter=False,
+         solver="krylov", trace=False):
     r"""
     Calculate the Katz centrality of each vertex in the graph.
 
@@ -684,19 +1135,48 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
         provided, the global value of 1 will be used.
     vprop : :class:`~graph_tool.PropertyMap`, optional (default: ``None``)
         Vertex property map where the values of eigenvector must be stored. If
-        provided, it will be used uninitialized.
+        provided, its values will be used as the initial guess of the
+        iteration, so that a previous solution can be used as a warm start.
     epsilon : float, optional (default: ``1e-6``)
         Convergence condition. The iteration will stop if the total delta of all
-        vertices are below this value.
+        vertices are below this value (for ``solver == "power"``), or if the
+        norm of the residual of the linear system is below this value (for
+        ``solver == "krylov"``).
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of iterations (or of
+        matrix-vector products, for ``solver == "krylov"``).
     norm : bool, optional (default: ``True``)
         Whether or not the centrality values should be normalized.
+    changed : :class:`~numpy.ndarray` or list of pairs, optional (default: ``None``)
+        If supplied, ``vprop`` must contain the unnormalized values before the
+        edges between the given pairs of vertices ``(s, t)`` were added to or
+        removed from the graph (which must have already happened), and they
+        will be updated incrementally, by propagating the residuals only from
+        the affected vertices, instead of iterating over the whole graph. This
+        requires ``norm == False``.
+    ret_iter : bool, optional (default: ``False``)
+        If true, the number of pushes of the incremental update is also
+        returned (only if ``changed`` is given).
+    solver : ``"krylov"`` or ``"power"`` (optional, default: ``"krylov"``)
+        If ``"krylov"``, the linear system :math:`(\mathbf{1}-\alpha\mathbf{A})
+        \mathbf{x} = \mathbf{\beta}` is solved with the restarted GMRES
+        method, which needs far fewer passes over the graph than the
+        fixed-point iteration when :math:`\alpha` is close to the inverse of
+        the largest eigenvalue.
+    trace : bool, optional (default: ``False``)
+        If ``True``, an array of shape ``(n, 3)`` is also returned, with the
+        residual, the elapsed time in seconds, and the number of edges
+        processed so far, after each of the ``n`` iterations (or restart cycles,
+        for ``solver == "krylov"``; nothing is recorded if ``changed`` is
+        given). At most ``max_iter``
+        (or 10000, if it is not given) iterations are recorded.
 
     Returns
     -------
     centrality : :class:`~graph_tool.PropertyMap`
         A vertex property map containing the Katz centrality values.
+    trace : :class:`~numpy.ndarray`
+        The convergence trace, if ``trace == True``.
 
     See Also
     --------
@@ -772,19 +1252,40 @@ def katz(g, alpha=0.01, beta=None, weight=None, vprop=None, epsilon=1e-6,
        Weblogging Ecosystem (2005). :DOI:`10.1145/1134271.1134277`
     """
 
+    if changed is not None:
+        if vprop is None or norm:
+            raise ValueError("the previous unnormalized values must be " +
+                             "given as 'vprop', with norm=False, if " +
+                             "'changed' is supplied")
+        changed = numpy.asarray(changed, dtype="int64").ravel()
+        n = libgraph_tool_centrality.\
+             get_katz_update(g._Graph__graph, _prop("e", g, weight),
+                             _prop("v", g, vprop), _prop("v", g, beta),
+                             float(alpha), epsilon, changed)
+        ret = (vprop, n) if ret_iter else (vprop,)
+        if trace:
+            ret += (_new_trace(False, 0),)
+        return ret if len(ret) > 1 else ret[0]
     if vprop is None:
         vprop = g.new_vertex_property("double")
     if max_iter is None:
         max_iter = 0
+    if solver not in ["krylov", "power"]:
+        raise ValueError("invalid solver: " + str(solver))
+    tr = _new_trace(trace, max_iter)
     libgraph_tool_centrality.\
          get_katz(g._Graph__graph, _prop("e", g, weight), _prop("v", g, vprop),
-                  _prop("v", g, beta), float(alpha), epsilon, max_iter)
+                  _prop("v", g, beta), float(alpha), epsilon, max_iter,
+                  solver == "krylov", tr)
     if norm:
         vprop.fa = vprop.fa / numpy.linalg.norm(vprop.fa)
+    if trace:
+        return vprop, _trim_trace(tr)
     return vprop
 
 
-def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
+def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None,
+         solver="krylov", trace=False):
     r"""
     Calculate the authority and hub centralities of each vertex in the graph.
 
@@ -800,9 +1301,23 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
         Vertex property map where the hub centrality must be stored.
     epsilon : float, optional (default: ``1e-6``)
         Convergence condition. The iteration will stop if the total delta of all
-        vertices are below this value.
+        vertices are below this value (for ``solver == "power"``), or if the
+        relative norm of the residual of the eigenvector is below this value
+        (for ``solver == "krylov"``).
     max_iter : int, optional (default: ``None``)
-        If supplied, this will limit the total number of iterations.
+        If supplied, this will limit the total number of iterations (or of
+        matrix-vector products, for ``solver == "krylov"``).
+    solver : ``"krylov"`` or ``"power"`` (optional, default: ``"krylov"``)
+        If ``"krylov"``, the thick-restart Lanczos method is used for the
+        leading eigenvector of :math:`\mathbf{A}^T\mathbf{A}`, which needs far
+        fewer passes over the graph than the power method when the spectral
+        gap is small.
+    trace : bool, optional (default: ``False``)
+        If ``True``, an array of shape ``(n, 3)`` is also returned, with the
+        residual, the elapsed time in seconds, and the number of edges
+        processed so far, after each of the ``n`` iterations (or restart cycles,
+        for ``solver == "krylov"``). At most ``max_iter``
+        (or 10000, if it is not given) iterations are recorded.
 
     Returns
     -------
@@ -812,6 +1327,8 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
         A vertex property map containing the authority centrality values.
     y : :class:`~graph_tool.PropertyMap`
         A vertex property map containing the hub centrality values.
+    trace : :class:`~numpy.ndarray`
+        The convergence trace, if ``trace == True``.
 
     See Also
     --------
@@ -914,14 +1431,20 @@ def hits(g, weight=None, xprop=None, yprop=None, epsilon=1e-6, max_iter=None):
         yprop = g.new_vertex_property("double")
     if max_iter is None:
         max_iter = 0
+    if solver not in ["krylov", "power"]:
+        raise ValueError("invalid solver: " + str(solver))
+    tr = _new_trace(trace, max_iter)
     l = libgraph_tool_centrality.\
          get_hits(g._Graph__graph, _prop("e", g, weight), _prop("v", g, xprop),
-                  _prop("v", g, yprop), epsilon, max_iter)
+                  _prop("v", g, yprop), epsilon, max_iter, solver == "krylov",
+                  tr)
+    if trace:
+        return 1. / l, xprop, yprop, _trim_trace(tr)
     return 1. / l, xprop, yprop
 
 
 def eigentrust(g, trust_map, vprop=None, norm=False, epsilon=1e-6, max_iter=0,
-               ret_iter=False):
+               ret_iter=False, trace=False):
     r"""
     Calculate the eigentrust centrality of each vertex in the graph.
 
@@ -943,11 +1466,18 @@ def eigentrust(g, trust_map, vprop=None, norm=False, epsilon=1e-6, max_iter=0,
         If supplied, this will limit the total number of iterations.
     ret_iter : bool, optional (default: ``False``)
         If true, the total number of iterations is also returned.
+    trace : bool, optional (default: ``False``)
+        If ``True``, an array of shape ``(n, 3)`` is also returned, with the
+        residual, the elapsed time in seconds, and the number of edges
+        processed so far, after each of the ``n`` iterations. At most
+        ``max_iter`` (or 10000, if it is not given) iterations are recorded.
 
     Returns
     -------
     eigentrust : :class:`~graph_tool.PropertyMap`
         A vertex property map containing the eigentrust values.
+    trace : :class:`~numpy.ndarray`
+        The convergence trace, if ``trace == True``.
 
     See Also
     --------
@@ -1025,19 +1555,23 @@ def eigentrust(g, trust_map, vprop=None, norm=False, epsilon=1e-6, max_iter=0,
 
     if vprop is None:
         vprop = g.new_vertex_property("double")
+    if max_iter is None:
+        max_iter = 0
+    tr = _new_trace(trace, max_iter)
     i = libgraph_tool_centrality.\
            get_eigentrust(g._Graph__graph, _prop("e", g, trust_map),
-                          _prop("v", g, vprop), epsilon, max_iter)
+                          _prop("v", g, vprop), epsilon, max_iter, tr)
     if norm:
         vprop.get_array()[:] /= sum(vprop.get_array())
 
-    if ret_iter:
-        return vprop, i
-    else:
-        return vprop
+    ret = (vprop, i) if ret_iter else (vprop,)
+    if trace:
+        ret += (_trim_trace(tr),)
+    return ret if len(ret) > 1 else ret[0]
 
 
-def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
+def trust_transitivity(g, trust_map, source=None, target=None, vprop=None,
+                       min_trust=0, n_top=None):
     r"""
     Calculate the pervasive trust transitivity between chosen (or all) vertices
     in the graph.
@@ -1058,6 +1592,15 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     vprop : :class:`~graph_tool.PropertyMap` (optional, default: None)
         A vertex property map where the values of transitive trust must be
         stored.
+    min_trust : float (optional, default: ``0``)
+        Paths with a trust value below this threshold are ignored, i.e. the
+        vertices which can only be reached by them are treated as untrusted.
+        Since the trust can only decrease along a path, the searches are
+        stopped at this value, which can make them considerably faster.
+    n_top : int (optional, default: ``None``)
+        If given, and ``source`` is ``None``, only the ``n_top`` most trusted
+        sources of each target (other than itself) are returned, in sparse
+        form, instead of the full trust matrix.
 
     Returns
     -------
@@ -1069,6 +1612,13 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
         vertex to/from the rest of the network. If both `source` and `target`
         are specified, the result is a single float, with the corresponding
         trust value for the target.
+    targets : :class:`numpy.ndarray`
+        If ``n_top`` is given, the targets of the returned trust values.
+    sources : :class:`numpy.ndarray`
+        If ``n_top`` is given, the sources of the returned trust values.
+    trust : :class:`numpy.ndarray`
+        If ``n_top`` is given, the trust values, ordered by target and then in
+        decreasing order.
 
     See Also
     --------
@@ -1102,7 +1652,9 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     for obtaining the trust from all given sources is :math:`O(kV\log V)`, where
     :math:`k` is the in-degree of the target. Thus, the complexity for obtaining
     the complete trust matrix is :math:`O(EV\log V)`, where :math:`E` is the
-    number of edges in the network.
+    number of edges in the network. The searches only visit the vertices that
+    can be reached with non-zero trust, or with trust above ``min_trust``, so the
+    actual running time is usually much smaller.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -1169,10 +1721,16 @@ def trust_transitivity(g, trust_map, source=None, target=None, vprop=None):
     else:
         source = g.vertex_index[source]
 
-    libgraph_tool_centrality.\
+    if n_top is not None and n_top < 1:
+        raise ValueError("n_top must be positive, not %s" % str(n_top))
+
+    ret = libgraph_tool_centrality.\
             get_trust_transitivity(g._Graph__graph, source, target,
                                    _prop("e", g, trust_map),
-                                   _prop("v", g, vprop))
+                                   _prop("v", g, vprop), min_trust,
+                                   0 if n_top is None else n_top)
+    if n_top is not None and source == -1:
+        return ret
     if target != -1 or source != -1:
         vprop = ungroup_vector_property(vprop, [0])[0]
     if target != -1 and source != -1:
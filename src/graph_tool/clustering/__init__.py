@@ -33,6 +33,8 @@ Summary
 
    local_clustering
    global_clustering
+   average_local_clustering
+   LocalClusteringTracker
    extended_clustering
    motifs
    motif_significance
@@ -49,15 +51,16 @@ dl_import("from . import libgraph_tool_clustering as _gt")
 from .. import _degree, _prop, Graph, GraphView, PropertyMap, _get_rng
 from .. topology import isomorphism
 from .. generation import random_rewire
-from .. stats import vertex_hist
+from .. stats import vertex_hist, vertex_average
 
 from collections import defaultdict
 from numpy import *
 from numpy import random
 import sys
 
-__all__ = ["local_clustering", "global_clustering", "extended_clustering",
-           "motifs", "motif_significance"]
+__all__ = ["local_clustering", "global_clustering",
+           "average_local_clustering", "LocalClusteringTracker",
+           "extended_clustering", "motifs", "motif_significance"]
 
 
 def local_clustering(g, prop=None, undirected=True):
@@ -105,8 +108,10 @@ def local_clustering(g, prop=None, undirected=True):
     .. math::
        c'_i = 2c_i.
 
-    The implemented algorithm runs in :math:`O(|V|\left< k\right>^2)` time,
-    where :math:`\left< k\right>` is the average out-degree.
+    The triangles are counted with the "forward" algorithm, where the edges
+    are oriented from the lower to the higher degree endpoint, which runs in
+    :math:`O(|E|^{3/2})` time in the worst case, independently of the
+    presence of high-degree vertices.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -138,7 +143,7 @@ def local_clustering(g, prop=None, undirected=True):
     return prop
 
 
-def global_clustering(g):
+def global_clustering(g, sampled=False, epsilon=1e-3, max_samples=None):
     r"""
     Return the global clustering coefficient.
 
@@ -146,15 +151,26 @@ def global_clustering(g):
     ----------
     g : :class:`~graph_tool.Graph`
         Graph to be used.
+    sampled : bool (optional, default: ``False``)
+        If ``True``, the coefficient is estimated by wedge sampling, instead of
+        being computed exactly.
+    epsilon : float (optional, default: ``1e-3``)
+        Target standard error of the sampled estimate (only used if
+        ``sampled == True``).
+    max_samples : int (optional, default: ``None``)
+        If given, the maximum number of wedges sampled, even if ``epsilon`` is
+        not reached (only used if ``sampled == True``).
 
     Returns
     -------
     c : tuple of floats
-        Global clustering coefficient and standard deviation (jacknife method)
+        Global clustering coefficient and standard deviation (jacknife method,
+        or the standard error of the estimate, if ``sampled == True``)
 
     See Also
     --------
     local_clustering: local clustering coefficient
+    average_local_clustering: average local clustering coefficient
     extended_clustering: extended (generalized) clustering coefficient
     motifs: motif counting
 
@@ -167,8 +183,18 @@ def global_clustering(g):
        c = 3 \times \frac{\text{number of triangles}}
                           {\text{number of connected triples}}
 
-    The implemented algorithm runs in :math:`O(|V|\left< k\right>^2)` time,
-    where :math:`\left< k\right>` is the average (total) degree.
+    The triangles are counted with the "forward" algorithm, where the edges
+    are oriented from the lower to the higher degree endpoint, which runs in
+    :math:`O(|E|^{3/2})` time in the worst case, independently of the
+    presence of high-degree vertices.
+
+    If ``sampled == True``, connected triples (wedges) are sampled uniformly
+    at random, and :math:`c` is estimated as the fraction of them that are
+    closed [seshadhri-wedge-2014]_, until its standard error falls below
+    ``epsilon``. This requires :math:`O(|E| + 1/\epsilon^2)` time, so it is
+    much faster than the exact computation for large graphs. Parallel edges
+    and self-loops are never counted as closed wedges, so the estimate is
+    only unbiased for simple graphs.
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -189,14 +215,164 @@ def global_clustering(g):
     .. [newman-structure-2003] M. E. J. Newman, "The structure and function of
        complex networks", SIAM Review, vol. 45, pp. 167-256, 2003,
        :doi:`10.1137/S003614450342480`
+    .. [seshadhri-wedge-2014] C. Seshadhri, A. Pinar, and T. G. Kolda, "Wedge
+       sampling for computing clustering coefficients and triangle counts on
+       large graphs", Statistical Analysis and Data Mining, vol. 7,
+       pp. 294-307, 2014, :doi:`10.1002/sam.11224`
     """
 
     if g.is_directed():
         g = GraphView(g, directed=False, skip_properties=True)
+    if sampled:
+        c, c_err, n = _gt.sampled_clustering(g._Graph__graph, False, epsilon,
+                                             max_samples or 0, _get_rng())
+        return c, c_err
     c = _gt.global_clustering(g._Graph__graph)
     return c
 
 
+def average_local_clustering(g, sampled=False, epsilon=1e-3,
+                             max_samples=None):
+    r"""
+    Return the average local clustering coefficient of the undirected graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    sampled : bool (optional, default: ``False``)
+        If ``True``, the average is estimated by sampling vertices and pairs
+        of their neighbors, instead of being computed exactly.
+    epsilon : float (optional, default: ``1e-3``)
+        Target standard error of the sampled estimate (only used if
+        ``sampled == True``).
+    max_samples : int (optional, default: ``None``)
+        If given, the maximum number of samples, even if ``epsilon`` is not
+        reached (only used if ``sampled == True``).
+
+    Returns
+    -------
+    c : tuple of floats
+        Average local clustering coefficient and its standard error.
+
+    See Also
+    --------
+    local_clustering: local clustering coefficient
+    global_clustering: global clustering coefficient
+
+    Notes
+    -----
+    This is the average over all vertices of the values computed by
+    :func:`local_clustering` with ``undirected=True``, where the vertices with
+    fewer than two neighbors have a coefficient of zero.
+
+    If ``sampled == True``, a vertex is chosen uniformly at random, and a pair
+    of its neighbors is chosen uniformly at random, until the standard error
+    of the fraction of adjacent pairs falls below ``epsilon``. This requires
+    :math:`O(|E| + 1/\epsilon^2)` time. Parallel edges and self-loops are
+    never counted as adjacent pairs, so the estimate is only unbiased for
+    simple graphs.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["karate"]
+    >>> c, c_err = gt.average_local_clustering(g)
+    >>> print(round(c, 4))
+    0.5706
+    """
+
+    if g.is_directed():
+        g = GraphView(g, directed=False, skip_properties=True)
+    if sampled:
+        c, c_err, n = _gt.sampled_clustering(g._Graph__graph, True, epsilon,
+                                             max_samples or 0, _get_rng())
+        return c, c_err
+    return vertex_average(g, local_clustering(g))
+
+
+class LocalClusteringTracker(object):
+    r"""Maintain the local clustering coefficients of a graph while its edges
+    are added and removed.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used. If it is directed, the undirected clustering
+        coefficients are maintained.
+
+    Notes
+    -----
+    The number of triangles and of distinct neighbors of each vertex are
+    computed once, and then updated for each edge added or removed with
+    :meth:`add_edge` and :meth:`remove_edge`, by finding the common neighbors
+    of its endpoints, in :math:`O(k_s + k_t)` time. The clustering
+    coefficients of the endpoints and of their common neighbors are updated at
+    the same time, so that :attr:`clustering` is always current.
+
+    The coefficients are those of the simple graph obtained by merging the
+    parallel edges and ignoring the self-loops, both initially and after each
+    update. For simple graphs they are identical to the ones given by
+    :func:`local_clustering`. Edges added or removed from the graph other than
+    through this object, and vertex removals, are not tracked.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["karate"].copy()
+    >>> tracker = gt.LocalClusteringTracker(g)
+    >>> e = tracker.add_edge(g.vertex(0), g.vertex(9))
+    >>> tracker.remove_edge(e)
+    >>> c = gt.local_clustering(g)
+    >>> print(all(c.a == tracker.clustering.a))
+    True
+    """
+
+    def __init__(self, g):
+        self.g = g
+        if g.is_directed():
+            self._ug = GraphView(g, directed=False, skip_properties=True)
+        else:
+            self._ug = g
+        self.triangles = g.new_vertex_property("int64_t")
+        self.clustering = g.new_vertex_property("double")
+        self._degree = g.new_vertex_property("int64_t")
+        _gt.local_triangles(self._ug._Graph__graph,
+                            _prop("v", self._ug, self.triangles),
+                            _prop("v", self._ug, self._degree))
+        self._update(arange(self.g.num_vertices(True), dtype="int64"))
+
+    def _update(self, vs):
+        _gt.clustering_from_triangles(self._ug._Graph__graph,
+                                      _prop("v", self._ug, self.triangles),
+                                      _prop("v", self._ug, self._degree),
+                                      _prop("v", self._ug, self.clustering),
+                                      vs)
+
+    def add_edge(self, s, t):
+        """Add the edge ``(s, t)`` to the graph, update the clustering
+        coefficients, and return the new edge."""
+        s, t = int(s), int(t)
+        vs = _gt.edge_triangles_update(self._ug._Graph__graph,
+                                       _prop("v", self._ug, self.triangles),
+                                       _prop("v", self._ug, self._degree),
+                                       s, t, 1)
+        e = self.g.add_edge(s, t)
+        self._update(vs)
+        return e
+
+    def remove_edge(self, e):
+        """Remove the edge ``e`` from the graph, and update the clustering
+        coefficients."""
+        s, t = int(e.source()), int(e.target())
+        vs = _gt.edge_triangles_update(self._ug._Graph__graph,
+                                       _prop("v", self._ug, self.triangles),
+                                       _prop("v", self._ug, self._degree),
+                                       s, t, -1)
+        self.g.remove_edge(e)
+        self._update(vs)
+
+
 def extended_clustering(g, props=None, max_depth=3, undirected=False):
     r"""
     Return the extended clustering coefficients for all vertices.
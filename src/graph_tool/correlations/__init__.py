@@ -52,7 +52,7 @@ __all__ = ["assortativity", "scalar_assortativity", "corr_hist",
            "avg_combined_corr"]
 
 
-def assortativity(g, deg):
+def assortativity(g, deg, jackknife="sweep"):
     r"""
     Obtain the assortativity coefficient for the given graph.
 
@@ -63,6 +63,15 @@ def assortativity(g, deg):
     deg : string or :class:`~graph_tool.PropertyMap`
         degree type ("in", "out" or "total") or vertex property map, which
         specifies the vertex types.
+    jackknife : ``"sweep"``, ``"pairs"`` or ``None`` (optional, default: ``"sweep"``)
+        How the variance is computed. With ``"sweep"``, a second pass over all
+        edges is made after the coefficient is obtained. With ``"pairs"``, the
+        number of edges between each distinct pair of values is collected
+        during the first pass, and the variance is computed from it, with the
+        same result. This is faster when there are few such pairs (e.g. for
+        degrees or categorical types), but requires memory proportional to
+        their number. If ``None``, the variance is not computed, and ``nan`` is
+        returned instead.
 
     Returns
     -------
@@ -92,7 +101,10 @@ def assortativity(g, deg):
     i to a vertex of type j.
 
 
-    The variance is obtained with the `jackknife method`_.
+    The variance is obtained with the `jackknife method`_. Since the
+    coefficient with a single edge removed depends only on the values at its
+    endpoints, it can be computed from the number of edges between each pair
+    of values (see the ``jackknife`` parameter).
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -114,10 +126,11 @@ def assortativity(g, deg):
 
     """
     return libgraph_tool_correlations.\
-           assortativity_coefficient(g._Graph__graph, _degree(g, deg))
+           assortativity_coefficient(g._Graph__graph, _degree(g, deg),
+                                     jackknife if jackknife is not None else "none")
 
 
-def scalar_assortativity(g, deg):
+def scalar_assortativity(g, deg, jackknife="sweep"):
     r"""
     Obtain the scalar assortativity coefficient for the given graph.
 
@@ -128,6 +141,15 @@ def scalar_assortativity(g, deg):
     deg : string or :class:`~graph_tool.PropertyMap`
         degree type ("in", "out" or "total") or vertex property map, which
         specifies the vertex types.
+    jackknife : ``"sweep"``, ``"pairs"`` or ``None`` (optional, default: ``"sweep"``)
+        How the variance is computed. With ``"sweep"``, a second pass over all
+        edges is made after the coefficient is obtained. With ``"pairs"``, the
+        number of edges between each distinct pair of values is collected
+        during the first pass, and the variance is computed from it, with the
+        same result. This is faster when there are few such pairs (e.g. for
+        degrees or categorical types), but requires memory proportional to
+        their number. If ``None``, the variance is not computed, and ``nan`` is
+        returned instead.
 
     Returns
     -------
@@ -156,7 +178,10 @@ def scalar_assortativity(g, deg):
     :math:`e_{xy}` is the fraction of edges from a vertex of type
     x to a vertex of type y.
 
-    The variance is obtained with the `jackknife method`_.
+    The variance is obtained with the `jackknife method`_. Since the
+    coefficient with a single edge removed depends only on the values at its
+    endpoints, it can be computed from the number of edges between each pair
+    of values (see the ``jackknife`` parameter).
 
     If enabled during compilation, this algorithm runs in parallel.
 
@@ -178,7 +203,8 @@ def scalar_assortativity(g, deg):
     """
     return libgraph_tool_correlations.\
            scalar_assortativity_coefficient(g._Graph__graph,
-                                            _degree(g, deg))
+                                            _degree(g, deg),
+                                            jackknife if jackknife is not None else "none")
 
 
 def corr_hist(g, deg_source, deg_target, bins=[[0, 1], [0, 1]], weight=None,
@@ -0,0 +1,511 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# graph_tool -- a general graph manipulation python module
+#
+# Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""
+``graph_tool.distributed`` - Distributed graphs
+-----------------------------------------------
+
+This module allows a graph that does not fit in the memory of a single machine
+to be processed by several processes, possibly in different nodes, which
+communicate via MPI (using :mod:`mpi4py`).
+
+The graph is first split into ``nparts`` parts with
+:func:`~graph_tool.distributed.save_partitioned`, each containing a contiguous
+range of vertices and their adjacency. Each process (MPI rank) then opens only
+its own part, as a :class:`~graph_tool.distributed.DistributedGraph`, which
+can be passed directly to the supported algorithms:
+
+* :func:`~graph_tool.centrality.pagerank`
+* :func:`~graph_tool.topology.shortest_distance` (unweighted, from a single
+  source)
+* :func:`~graph_tool.topology.label_components` (undirected components)
+* :func:`~graph_tool.stats.vertex_hist` and
+  :func:`~graph_tool.stats.vertex_average` (degrees only)
+
+Instead of property maps, these return :class:`numpy.ndarray` objects with the
+values of the local vertices, in the order of their indexes, i.e. the value of
+vertex ``v`` is at position ``v - g.get_vertex_range()[0]``. Global quantities,
+such as histograms and averages, are identical in all ranks.
+
+The values of the neighbors owned by other ranks ("ghost" vertices) are
+exchanged once per iteration, in a single all-to-all communication step.
+
+For example, the following script can be run with ``mpirun -n 4 python
+script.py``, after the graph has been partitioned with
+``save_partitioned(g, "parts", 4)``:
+
+.. code-block:: python
+
+   from mpi4py import MPI
+   import graph_tool.all as gt
+   g = gt.DistributedGraph("parts", MPI.COMM_WORLD)
+   pr = gt.pagerank(g)
+   c, h = gt.label_components(g)
+
+Summary
++++++++
+
+.. autosummary::
+    :nosignatures:
+
+    save_partitioned
+    DistributedGraph
+
+Contents
+++++++++
+"""
+
+from __future__ import division, absolute_import, print_function
+
+import os
+import json
+import functools
+import numpy
+
+__all__ = ["save_partitioned", "DistributedGraph"]
+
+
+class _SerialComm(object):
+    """Trivial communicator with a single process, used when no MPI
+    communicator is given."""
+
+    def Get_rank(self):
+        return 0
+
+    def Get_size(self):
+        return 1
+
+    def allgather(self, x):
+        return [x]
+
+    def alltoall(self, xs):
+        return list(xs)
+
+
+_reduce_ops = dict(sum=numpy.add, min=numpy.minimum, max=numpy.maximum)
+
+def _allreduce(comm, x, op="sum"):
+    # the values are gathered and reduced with numpy, so that arrays are
+    # reduced element-wise with any of the operations
+    return functools.reduce(_reduce_ops[op], comm.allgather(x))
+
+
+def _balanced_boundaries(cost, nparts):
+    cum = numpy.cumsum(cost)
+    total = cum[-1] if len(cum) > 0 else 0
+    b = numpy.searchsorted(cum, total * numpy.arange(1, nparts) / nparts,
+                           side="right")
+    return numpy.concatenate(([0], b, [len(cost)])).astype("int64")
+
+
+def save_partitioned(g, path, nparts, eprops=None):
+    r"""Split the graph ``g`` into ``nparts`` parts, and save them in the
+    directory ``path``, so that they can be opened independently by
+    :class:`~graph_tool.distributed.DistributedGraph`.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be saved. Filters are respected.
+    path : ``str``
+        Directory where the parts are written (it will be created if it does
+        not exist).
+    nparts : ``int``
+        Number of parts, which must be equal to the number of processes that
+        will open them.
+    eprops : ``dict`` of :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Edge property maps of scalar type to be saved with the adjacency (e.g.
+        edge weights), indexed by name.
+
+    Notes
+    -----
+    Vertices are renumbered contiguously, if ``g`` is filtered. Each part
+    contains a contiguous range of vertices, chosen so that the sum of the
+    degrees (plus one) in each part is approximately the same.
+
+    Each part is stored in a subdirectory ``part_NNNNN``, in compressed sparse
+    row (CSR) layout, with the same conventions as
+    :func:`~graph_tool.save_csr_arrays`: ``out_offsets`` and ``out_targets``
+    for the out-edges of the local vertices, and ``in_offsets`` and
+    ``in_sources`` for their in-edges, if the graph is directed. The neighbors
+    are given by their global indexes. The values of the edge properties are
+    stored in the arrays ``out_ep_<name>`` and ``in_ep_<name>``, in the same
+    order. The vertex ranges and the global sizes are stored in the file
+    ``meta.json``.
+
+    The algorithm runs in :math:`O(V + E\log E)` time.
+
+    """
+    if nparts < 1:
+        raise ValueError("invalid number of parts: %d" % nparts)
+    if not os.path.exists(path):
+        os.makedirs(path)
+    if eprops is None:
+        eprops = {}
+    vs = g.get_vertices()
+    N = len(vs)
+    vidx = numpy.full(g.num_vertices(True), -1, dtype="int64")
+    vidx[vs] = numpy.arange(N)
+    edges = g.get_edges()
+    s = vidx[edges[:, 0]]
+    t = vidx[edges[:, 1]]
+    evals = {name: p.a[edges[:, 2]] for name, p in eprops.items()}
+
+    if g.is_directed():
+        dirs = {"out": (s, t, evals), "in": (t, s, evals)}
+    else:
+        dirs = {"out": (numpy.concatenate((s, t)), numpy.concatenate((t, s)),
+                        {name: numpy.concatenate((x, x))
+                         for name, x in evals.items()})}
+
+    cost = numpy.ones(N, dtype="int64")
+    for u, w, _ in dirs.values():
+        cost += numpy.bincount(u, minlength=N)
+    bounds = _balanced_boundaries(cost, nparts)
+
+    for k in range(nparts):
+        lo, hi = bounds[k], bounds[k + 1]
+        ppath = os.path.join(path, "part_%05d" % k)
+        if not os.path.exists(ppath):
+            os.makedirs(ppath)
+        for d, (u, w, ev) in dirs.items():
+            idx = numpy.where((u >= lo) & (u < hi))[0]
+            idx = idx[numpy.argsort(u[idx], kind="stable")]
+            offsets = numpy.zeros(hi - lo + 1, dtype="uint64")
+            numpy.cumsum(numpy.bincount(u[idx] - lo, minlength=hi - lo),
+                         out=offsets[1:])
+            numpy.save(os.path.join(ppath, "%s_offsets.npy" % d), offsets)
+            numpy.save(os.path.join(ppath, "%s_%s.npy" %
+                                    (d, "targets" if d == "out" else "sources")),
+                       w[idx])
+            for name, x in ev.items():
+                numpy.save(os.path.join(ppath, "%s_ep_%s.npy" % (d, name)),
+                           x[idx])
+
+    meta = dict(num_vertices=N, num_edges=len(edges),
+                directed=g.is_directed(), nparts=nparts,
+                boundaries=[int(x) for x in bounds],
+                edge_properties=sorted(eprops.keys()))
+    with open(os.path.join(path, "meta.json"), "w") as f:
+        json.dump(meta, f)
+
+
+class _Ghosts(object):
+    """Communication pattern of the neighbors in one direction: the positions
+    of the neighbors of each local edge in the extended (local + ghost) value
+    array, and the local vertices whose values must be sent to each peer."""
+
+    def __init__(self, comm, bounds, lo, hi, nbrs):
+        size = comm.Get_size()
+        remote = (nbrs < lo) | (nbrs >= hi)
+        self.ghosts = numpy.unique(nbrs[remote])
+        self.slots = nbrs - lo
+        self.slots[remote] = (hi - lo) + numpy.searchsorted(self.ghosts,
+                                                            nbrs[remote])
+        # the ghosts are sorted, hence grouped by their owners
+        self.recv_split = numpy.searchsorted(self.ghosts, bounds)
+        reqs = [self.ghosts[self.recv_split[p]:self.recv_split[p + 1]]
+                for p in range(size)]
+        self.send_idx = [r - lo for r in comm.alltoall(reqs)]
+
+
+class DistributedGraph(object):
+    r"""Part of a distributed graph, owned by the calling process.
+
+    Parameters
+    ----------
+    path : ``str``
+        Directory written by :func:`~graph_tool.distributed.save_partitioned`.
+    comm : :class:`mpi4py.MPI.Comm` (optional, default: ``None``)
+        MPI communicator. The part that is opened is the one with the same
+        number as the rank of the process, and the number of parts must be
+        equal to the size of the communicator. If not given, a single process
+        is assumed.
+    mmap : ``bool`` (optional, default: ``True``)
+        If ``True``, the arrays are memory-mapped, instead of read into memory.
+
+    Notes
+    -----
+    All the methods and the algorithms that accept this class must be called
+    collectively, i.e. by all the processes in the communicator.
+
+    """
+
+    _distributed = True
+
+    def __init__(self, path, comm=None, mmap=True):
+        self.comm = comm if comm is not None else _SerialComm()
+        with open(os.path.join(path, "meta.json")) as f:
+            meta = json.load(f)
+        rank, size = self.comm.Get_rank(), self.comm.Get_size()
+        if meta["nparts"] != size:
+            raise ValueError("the graph has %d parts, but the communicator has %d processes" %
+                             (meta["nparts"], size))
+        self._N = meta["num_vertices"]
+        self._E = meta["num_edges"]
+        self._directed = meta["directed"]
+        self._bounds = numpy.array(meta["boundaries"], dtype="int64")
+        self._lo, self._hi = int(self._bounds[rank]), int(self._bounds[rank + 1])
+        self.edge_properties = meta["edge_properties"]
+
+        ppath = os.path.join(path, "part_%05d" % rank)
+        mode = "r" if mmap else None
+        load = lambda name: numpy.load(os.path.join(ppath, name + ".npy"),
+                                       mmap_mode=mode)
+        dirs = ["out", "in"] if self._directed else ["out"]
+        self._offsets, self._nbrs, self._rows, self._ep = {}, {}, {}, {}
+        for d in dirs:
+            self._offsets[d] = load("%s_offsets" % d)
+            self._nbrs[d] = load("%s_%s" % (d, "targets" if d == "out"
+                                            else "sources"))
+            self._rows[d] = numpy.repeat(numpy.arange(self._hi - self._lo),
+                                         numpy.diff(self._offsets[d]).astype("int64"))
+            self._ep[d] = {name: load("%s_ep_%s" % (d, name))
+                           for name in self.edge_properties}
+        if not self._directed:
+            for x in [self._offsets, self._nbrs, self._rows, self._ep]:
+                x["in"] = x["out"]
+        self._ghosts = {}
+
+    def __repr__(self):
+        return "<DistributedGraph object, %s, with %d vertices and %d edges, part %d of %d, at 0x%x>" % \
+            ("directed" if self._directed else "undirected", self._N, self._E,
+             self.comm.Get_rank(), self.comm.Get_size(), id(self))
+
+    def num_vertices(self):
+        """Get the total number of vertices."""
+        return self._N
+
+    def num_edges(self):
+        """Get the total number of edges."""
+        return self._E
+
+    def is_directed(self):
+        """Get the directedness of the graph."""
+        return self._directed
+
+    def get_vertex_range(self):
+        """Return the range ``(begin, end)`` of the global indexes of the local
+        vertices."""
+        return self._lo, self._hi
+
+    def num_local_vertices(self):
+        """Get the number of local vertices."""
+        return self._hi - self._lo
+
+    def get_degrees(self, deg):
+        """Return the ``"in"``, ``"out"`` or ``"total"`` degrees of the local
+        vertices."""
+        if deg not in ["in", "out", "total"]:
+            raise ValueError("invalid degree type: " + str(deg))
+        if not self._directed:
+            deg = "out"
+        if deg == "total":
+            return self.get_degrees("in") + self.get_degrees("out")
+        return numpy.diff(self._offsets[deg]).astype("int64")
+
+    def _get_ghosts(self, d):
+        # the ghost structures are built collectively, when first needed
+        if not self._directed:
+            d = "out"
+        if d not in self._ghosts:
+            self._ghosts[d] = _Ghosts(self.comm, self._bounds, self._lo,
+                                      self._hi, numpy.asarray(self._nbrs[d]))
+        return self._ghosts[d]
+
+    def _pull(self, vals, d):
+        """Return the extended array with the values of the local vertices
+        followed by those of the ghosts of direction ``d``."""
+        gh = self._get_ghosts(d)
+        recv = self.comm.alltoall([vals[idx] for idx in gh.send_idx])
+        return numpy.concatenate([vals] + recv)
+
+    def _push(self, vals, ext, d, op):
+        """Reduce the values ``ext`` of the ghosts of direction ``d`` into the
+        values ``vals`` of their owners, in place."""
+        gh = self._get_ghosts(d)
+        n = self._hi - self._lo
+        s = gh.recv_split
+        recv = self.comm.alltoall([ext[n + s[p]:n + s[p + 1]]
+                                   for p in range(len(s) - 1)])
+        for idx, x in zip(gh.send_idx, recv):
+            _reduce_ops[op].at(vals, idx, x)
+        return vals
+
+
+def _unsupported(name, **kwargs):
+    for k, v in kwargs.items():
+        if v:
+            raise NotImplementedError("argument '%s' of %s() is not supported for distributed graphs" %
+                                      (k, name))
+
+
+def pagerank(g, damping=0.85, weight=None, epsilon=1e-6, max_iter=None,
+             ret_iter=False):
+    """Distributed version of :func:`~graph_tool.centrality.pagerank`, with
+    the same definition. The edge weights, if given, must be the name of a
+    property saved with the graph."""
+    if weight is not None and weight not in g.edge_properties:
+        raise ValueError("edge property '%s' was not saved with the graph" %
+                         str(weight))
+    n = g.num_local_vertices()
+    N = g.num_vertices()
+    rows, slots = g._rows["in"], g._get_ghosts("in").slots
+    if weight is None:
+        k = g.get_degrees("out").astype("float64")
+        w = None
+    else:
+        k = numpy.bincount(g._rows["out"], weights=g._ep["out"][weight],
+                           minlength=n)
+        w = numpy.asarray(g._ep["in"][weight], dtype="float64")
+    scale = numpy.zeros(n)
+    scale[k != 0] = 1. / k[k != 0]
+
+    r = numpy.full(n, 1. / N)
+    base = numpy.full(n, (1 - damping) / N)
+    niter = 0
+    while max_iter is None or niter < max_iter:
+        ext = g._pull(r * scale, "in")[slots]
+        if w is not None:
+            ext *= w
+        nr = base + damping * numpy.bincount(rows, weights=ext, minlength=n)
+        delta = _allreduce(g.comm, float(numpy.abs(nr - r).sum()))
+        r = nr
+        niter += 1
+        if delta < epsilon:
+            break
+    if ret_iter:
+        return r, niter
+    return r
+
+
+def shortest_distance(g, source):
+    """Distributed version of :func:`~graph_tool.topology.shortest_distance`,
+    for unweighted graphs and a single source. Unreachable vertices have the
+    maximum value of ``int32_t``."""
+    n = g.num_local_vertices()
+    lo, hi = g.get_vertex_range()
+    rows, slots = g._rows["out"], g._get_ghosts("out").slots
+    inf = numpy.iinfo("int32").max
+    dist = numpy.full(n, inf, dtype="int32")
+    frontier = numpy.zeros(n, dtype="bool")
+    if lo <= source < hi:
+        dist[source - lo] = 0
+        frontier[source - lo] = True
+
+    # level-synchronous search: the neighbors of the frontier are marked
+    # locally, and the marks of the ghosts are sent to their owners
+    level = 0
+    while _allreduce(g.comm, int(frontier.sum())) > 0:
+        mark = numpy.zeros(n + len(g._get_ghosts("out").ghosts), dtype="int32")
+        mark[slots[frontier[rows]]] = 1
+        reached = g._push(mark[:n].copy(), mark, "out", "max")
+        level += 1
+        frontier = (reached > 0) & (dist == inf)
+        dist[frontier] = level
+    return dist
+
+
+def label_components(g, directed=None):
+    """Distributed version of :func:`~graph_tool.topology.label_components`,
+    for undirected (or weak) components. The components are labelled in the
+    order of their smallest vertex."""
+    if directed is None:
+        directed = g.is_directed()
+    if directed:
+        raise NotImplementedError("strongly connected components are not supported for distributed graphs")
+    n = g.num_local_vertices()
+    lo, hi = g.get_vertex_range()
+    comm = g.comm
+    dirs = ["out", "in"] if g.is_directed() else ["out"]
+
+    # each vertex takes the smallest label of its neighbors, until nothing
+    # changes; in the end the label is the smallest vertex of the component
+    label = numpy.arange(lo, hi, dtype="int64")
+    changed = True
+    while changed:
+        nlabel = label.copy()
+        for d in dirs:
+            ext = g._pull(label, d)
+            numpy.minimum.at(nlabel, g._rows[d], ext[g._get_ghosts(d).slots])
+        changed = _allreduce(comm, int((nlabel != label).sum())) > 0
+        label = nlabel
+
+    # contiguous labels, from the ranks of the roots
+    roots = numpy.where(label == numpy.arange(lo, hi))[0]
+    counts = comm.allgather(len(roots))
+    C = sum(counts)
+    first = sum(counts[:comm.Get_rank()])
+    new = numpy.full(n, -1, dtype="int64")
+    new[roots] = first + numpy.arange(len(roots))
+
+    # the new label of each root is requested from its owner
+    ulabels, inv = numpy.unique(label, return_inverse=True)
+    split = numpy.searchsorted(ulabels, g._bounds)
+    size = len(g._bounds) - 1
+    reqs = comm.alltoall([ulabels[split[p]:split[p + 1]] for p in range(size)])
+    reps = comm.alltoall([new[r - lo] for r in reqs])
+    comp = numpy.concatenate(reps)[inv]
+    hist = _allreduce(comm, numpy.bincount(comp, minlength=C))
+    return comp.astype("int32"), hist
+
+
+def _hist_bins(comm, x, bins):
+    bins = numpy.asarray(bins, dtype="float64")
+    if len(bins) == 2:
+        # constant width, extended up to the largest value
+        delta = bins[1]
+        x = x[x >= bins[0]]
+        xmax = _allreduce(comm, float(x.max()) if len(x) > 0 else bins[0],
+                          "max")
+        nbins = int((xmax - bins[0]) // delta) + 1
+        return bins[0] + delta * numpy.arange(nbins + 1)
+    return bins
+
+
+def vertex_hist(g, deg, bins=[0, 1], float_count=True):
+    """Distributed version of :func:`~graph_tool.stats.vertex_hist`, for
+    degrees only."""
+    x = g.get_degrees(deg)
+    edges = _hist_bins(g.comm, x, bins)
+    if len(bins) == 2:
+        # the last bin is left-closed, like all the others
+        idx = ((x[x >= edges[0]] - edges[0]) // bins[1]).astype("int64")
+    else:
+        idx = numpy.searchsorted(edges, x, side="right") - 1
+        idx = idx[(x >= edges[0]) & (x < edges[-1])]
+    counts = numpy.bincount(idx, minlength=len(edges) - 1)[:len(edges) - 1]
+    counts = _allreduce(g.comm, counts)
+    if float_count:
+        counts = numpy.array(counts, dtype="float64")
+    if len(bins) == 2:
+        edges = edges.astype(numpy.asarray(bins).dtype)
+    return [counts, edges]
+
+
+def vertex_average(g, deg):
+    """Distributed version of :func:`~graph_tool.stats.vertex_average`, for
+    degrees only."""
+    x = g.get_degrees(deg).astype("float64")
+    a, aa, count = _allreduce(g.comm, numpy.array([x.sum(), (x ** 2).sum(),
+                                                   len(x)]))
+    a /= count
+    aa = numpy.sqrt((aa / count - a ** 2) / count)
+    return a, aa
@@ -22,6 +22,9 @@ from __future__ import division, absolute_import, print_function
 
 import sys
 import os.path
+import re
+import time
+import importlib
 
 try:
     from os import RTLD_LAZY, RTLD_GLOBAL
@@ -40,19 +43,121 @@ except ImportError:
             from ctypes import RTLD_GLOBAL
             dl_flags = RTLD_GLOBAL
 
-__all__ = ["dl_import"]
+__all__ = ["dl_import", "add_load_hook", "remove_load_hook", "get_load_times"]
+
+# load times (in seconds) of the compiled libraries, and functions to be called
+# when a library is loaded
+_load_times = {}
+_load_hooks = []
+
+try:
+    _timer = time.perf_counter
+except AttributeError:
+    _timer = time.time
+
+
+def add_load_hook(hook):
+    """Register a function ``hook(name, t)``, which will be called every time a
+    compiled library is loaded, with its full module name and the time ``t`` (in
+    seconds) it took to load it."""
+    _load_hooks.append(hook)
+
+
+def remove_load_hook(hook):
+    """Unregister a function previously registered with :func:`add_load_hook`."""
+    _load_hooks.remove(hook)
+
+
+def get_load_times():
+    """Return a dictionary with the load times (in seconds) of all compiled
+    libraries loaded so far, keyed by their full module names."""
+    return dict(_load_times)
+
+
+def _dlopen(module, package):
+    # RTLD_GLOBAL needs to be set in dlopen() if we want typeinfo and friends to
+    # work properly across DSO boundaries. See http://gcc.gnu.org/faq.html#dso
+
+    orig_dlopen_flags = sys.getdlopenflags()
+    sys.setdlopenflags(dl_flags)
+
+    try:
+        t = _timer()
+        mod = importlib.import_module(module, package)
+        t = _timer() - t
+    finally:
+        sys.setdlopenflags(orig_dlopen_flags)  # reset it to normal case to
+                                               # avoid unnecessary symbol
+                                               # collision
+
+    if mod.__name__ not in _load_times:
+        _load_times[mod.__name__] = t
+        for hook in list(_load_hooks):
+            hook(mod.__name__, t)
+    return mod
+
+
+class _LazyLibrary(object):
+    """Placeholder for a compiled library, which is only loaded when one of its
+    attributes is first accessed."""
+
+    def __init__(self, module, package, alias, global_dict):
+        self.__dict__["_LazyLibrary__args"] = (module, package, alias,
+                                               global_dict)
+        self.__dict__["_LazyLibrary__mod"] = None
+
+    def _load(self):
+        mod = self.__mod
+        if mod is None:
+            module, package, alias, global_dict = self.__args
+            mod = _dlopen(module, package)
+            self.__dict__["_LazyLibrary__mod"] = mod
+            # replace the placeholder in the namespace of the importer
+            if global_dict.get(alias) is self:
+                global_dict[alias] = mod
+        return mod
+
+    def __getattr__(self, attr):
+        return getattr(self._load(), attr)
+
+    def __setattr__(self, attr, val):
+        setattr(self._load(), attr, val)
+
+    def __dir__(self):
+        return dir(self._load())
+
+    def __repr__(self):
+        if self.__mod is not None:
+            return repr(self.__mod)
+        return "<lazily loaded library '%s'>" % self.__args[0]
+
+
+_import_re = re.compile(r"^\s*from\s+(\.+)\s+import\s+(\w+)(?:\s+as\s+(\w+))?\s*$")
 
 
 def dl_import(import_expr):
-    """Import module according to import_expr, but with RTLD_GLOBAL enabled."""
+    """Import module according to import_expr, but with RTLD_GLOBAL enabled.
+
+    If ``import_expr`` is of the form ``"from . import lib [as name]"``, the
+    library is only loaded when one of its attributes is first accessed.
+    """
     # we need to get the locals and globals of the _calling_ function. Thus, we
     # need to go deeper into the call stack
     call_frame = sys._getframe(1)
     local_dict = call_frame.f_locals
     global_dict = call_frame.f_globals
 
-    # RTLD_GLOBAL needs to be set in dlopen() if we want typeinfo and friends to
-    # work properly across DSO boundaries. See http://gcc.gnu.org/faq.html#dso
+    m = _import_re.match(import_expr)
+    if m is not None:
+        dots, name, alias = m.groups()
+        if alias is None:
+            alias = name
+        package = global_dict.get("__package__") or global_dict["__name__"]
+        lib = _LazyLibrary(dots + name, package, alias, global_dict)
+        global_dict[alias] = lib
+        if local_dict is not global_dict:
+            local_dict[alias] = lib
+        return
 
     orig_dlopen_flags = sys.getdlopenflags()
     sys.setdlopenflags(dl_flags)
@@ -38,6 +38,7 @@ Layout algorithms
    planar_layout
    random_layout
    get_hierarchy_control_points
+   LayoutStepper
 
 Graph drawing
 =============
@@ -86,7 +87,7 @@ dl_import("from . import libgraph_tool_layout")
 __all__ = ["graph_draw", "graphviz_draw", "fruchterman_reingold_layout",
            "arf_layout", "sfdp_layout", "planar_layout", "random_layout",
            "radial_tree_layout", "cairo_draw", "prop_to_size",
-           "get_hierarchy_control_points", "default_cm"]
+           "get_hierarchy_control_points", "default_cm", "LayoutStepper"]
 
 
 def random_layout(g, shape=None, pos=None, dim=2):
@@ -318,8 +319,48 @@ def fruchterman_reingold_layout(g, weight=None, a=None, r=1., scale=None,
     return pos
 
 
+class LayoutStepper(object):
+    r"""An incremental layout, as returned by :func:`~graph_tool.draw.sfdp_layout`
+    or :func:`~graph_tool.draw.arf_layout` with ``incremental=True``.
+
+    The layout is advanced a given number of iterations at a time with
+    :meth:`~LayoutStepper.step`, and the state of the algorithm is kept between
+    calls. The positions in :attr:`pos` are updated after each call. The graph
+    must not be modified while the layout is in progress.
+    """
+
+    def __init__(self, g, pos, state):
+        self._g = g     # the graph view used by the layout must be kept alive
+        self.pos = pos
+        self._state = state
+
+    def step(self, n=1):
+        r"""Do at most ``n`` iterations, or run until convergence if ``n == 0``,
+        and return the number of iterations done. The GIL is released during
+        the iterations, so that other Python threads can run meanwhile."""
+        return self._state.step(n)
+
+    def converged(self):
+        r"""Return ``True`` if the layout has converged, or reached the maximum
+        number of iterations."""
+        return self._state.converged()
+
+    def get_energy(self):
+        r"""Return the sum of the squared forces in the last iteration."""
+        return self._state.get_energy()
+
+    def get_delta(self):
+        r"""Return the displacement in the last iteration, which is compared
+        with the convergence criterion."""
+        return self._state.get_delta()
+
+    def get_iter(self):
+        r"""Return the number of iterations done so far."""
+        return self._state.get_iter()
+
 def arf_layout(g, weight=None, d=0.5, a=10, dt=0.001, epsilon=1e-6,
-               max_iter=1000, pos=None, dim=2):
+               max_iter=1000, pos=None, dim=2, theta=None, max_level=15,
+               incremental=False):
     r"""Calculate the ARF spring-block layout of the graph.
 
     Parameters
@@ -343,6 +384,18 @@ def arf_layout(g, weight=None, d=0.5, a=10, dt=0.001, epsilon=1e-6,
         Vector vertex property maps where the coordinates should be stored.
     dim : int (optional, default: ``2``)
         Number of coordinates per vertex.
+    theta : float (optional, default: ``None``)
+        Quadtree opening parameter, a.k.a. Barnes-Hut opening criterion, used to
+        approximate the repulsive forces if ``dim == 2``. If ``theta == 0``, the
+        forces are computed exactly. If not provided, it will be ``0.6`` for
+        two-dimensional layouts of graphs with more than 1000 vertices and
+        ``0`` otherwise.
+    max_level : int (optional, default: ``15``)
+        Maximum quadtree level.
+    incremental : bool (optional, default: ``False``)
+        If ``True``, no iterations are done, and a
+        :class:`~graph_tool.draw.LayoutStepper` is returned instead, with which
+        the layout can be advanced a few iterations at a time.
 
     Returns
     -------
@@ -353,7 +406,8 @@ def arf_layout(g, weight=None, d=0.5, a=10, dt=0.001, epsilon=1e-6,
     Notes
     -----
     This algorithm is defined in [geipel-self-organization-2007]_, and has
-    complexity :math:`O(V^2)`.
+    complexity :math:`O(V^2)` per iteration, or :math:`O(V\log V)` if
+    ``theta > 0``.
 
     Examples
     --------
@@ -391,10 +445,24 @@ def arf_layout(g, weight=None, d=0.5, a=10, dt=0.001, epsilon=1e-6,
         pos = random_layout(g, dim=dim)
     _check_prop_vector(pos, name="pos", floating=True)
 
+    if theta is None:
+        theta = 0.6 if dim == 2 and g.num_vertices() > 1000 else 0
+    if theta > 0 and dim != 2:
+        raise ValueError("the Barnes-Hut approximation ('theta > 0') is only " +
+                         "supported for 'dim == 2'")
+
     ug = GraphView(g, directed=False)
+    if incremental:
+        state = libgraph_tool_layout.arf_layout_stepper(ug._Graph__graph,
+                                                        _prop("v", g, pos),
+                                                        _prop("e", g, weight),
+                                                        d, a, dt, max_iter,
+                                                        epsilon, dim, theta,
+                                                        max_level)
+        return LayoutStepper(ug, pos, state)
     libgraph_tool_layout.arf_layout(ug._Graph__graph, _prop("v", g, pos),
                                     _prop("e", g, weight), d, a, dt, max_iter,
-                                    epsilon, dim)
+                                    epsilon, dim, theta, max_level)
     return pos
 
 
@@ -574,7 +642,8 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
                 init_step=None, cooling_step=0.95, adaptive_cooling=True,
                 epsilon=1e-2, max_iter=0, pos=None, multilevel=None,
                 coarse_method="hybrid", mivs_thres=0.9, ec_thres=0.75,
-                coarse_stack=None, weighted_coarse=False, verbose=False):
+                coarse_stack=None, weighted_coarse=False, callback=None,
+                offload=False, incremental=False, verbose=False):
     r"""Obtain the SFDP spring-block layout of the graph.
 
     Parameters
@@ -623,7 +692,9 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         Maximum number of iterations. If this value is ``0``, it runs until
         convergence.
     pos : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
-        Initial vertex layout. If not provided, it will be randomly chosen.
+        Initial vertex layout. If not provided, it will be randomly chosen. If
+        ``multilevel == True``, the coarse layouts will start from the average
+        positions of the vertices they contain.
     multilevel : bool (optional, default: ``None``)
         Use a multilevel layout algorithm. If ``None`` is given, it will be
         activated based on the size of the graph.
@@ -638,6 +709,21 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         coarsening stops.
     weighted_coarse : bool (optional, default: ``False``)
         Use weighted coarse graphs.
+    callback : function (optional, default: ``None``)
+        If given and ``multilevel == True``, this function will be called before
+        each level is laid out, with arguments ``(level, N, E, K)``, where
+        ``level`` counts from the coarsest level, ``N`` and ``E`` are the numbers
+        of vertices and edges of the level, and ``K`` is its optimal edge length.
+    offload : bool (optional, default: ``False``)
+        If ``True``, the forces are computed on an accelerator device (e.g. a
+        GPU) with OpenMP offloading, moving all vertices simultaneously at each
+        iteration. This requires graph-tool to have been compiled with
+        ``--enable-openmp-offload``.
+    incremental : bool (optional, default: ``False``)
+        If ``True``, no iterations are done, and a
+        :class:`~graph_tool.draw.LayoutStepper` is returned instead, with which
+        the layout can be advanced a few iterations at a time. This is not
+        supported with ``multilevel == True`` or ``offload == True``.
     verbose : bool (optional, default: ``False``)
         Provide verbose information.
 
@@ -652,6 +738,9 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
     This algorithm is defined in [hu-multilevel-2005]_, and has
     complexity :math:`O(V\log V)`.
 
+    The coarsening of the multilevel algorithm, and the layout of all levels,
+    is done entirely in C++, unless ``coarse_stack`` is given.
+
     Examples
     --------
     .. testcode::
@@ -682,6 +771,7 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
        http://www.mathematica-journal.com/issue/v10i1/graph_draw.html
     """
 
+    warm = pos is not None
     if pos is None:
         pos = random_layout(g, dim=2)
     _check_prop_vector(pos, name="pos", floating=True)
@@ -702,24 +792,48 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
         init_step = 2 * max(_avg_edge_distance(g, pos), K)
 
     if multilevel is None:
-        multilevel = g.num_vertices() > 1000
+        multilevel = not incremental and g.num_vertices() > 1000
+
+    if incremental and (multilevel or offload):
+        raise ValueError("'incremental' is not supported with 'multilevel' " +
+                         "or 'offload'.")
 
     if multilevel:
         if eweight is not None or vweight is not None:
             weighted_coarse = True
         if coarse_stack is None:
-            cgs = coarse_graphs(g, method=coarse_method,
-                                mivs_thres=mivs_thres,
-                                ec_thres=ec_thres,
-                                weighted_coarse=weighted_coarse,
-                                eweight=eweight,
-                                vweight=vweight,
-                                groups=groups,
-                                verbose=verbose)
-        else:
-            cgs = coarse_graph_stack(g, coarse_stack[0], coarse_stack[1],
-                                     eweight=eweight, vweight=vweight,
-                                     verbose=verbose)
+            if coarse_method not in ["hybrid", "mivs", "ec"]:
+                raise ValueError("invalid coarsening method: " +
+                                 str(coarse_method))
+            if vweight is not None and vweight.value_type() != "double":
+                vweight = vweight.copy("double")
+            if eweight is not None and eweight.value_type() != "double":
+                eweight = eweight.copy("double")
+            if groups is not None and groups.value_type() != "int32_t":
+                raise ValueError("'groups' property must be of type 'int32_t'.")
+            libgraph_tool_layout.sanitize_pos(g._Graph__graph,
+                                              _prop("v", g, pos))
+            libgraph_tool_layout.sfdp_layout_multilevel(g._Graph__graph,
+                                                        _prop("v", g, pos),
+                                                        _prop("v", g, vweight),
+                                                        _prop("e", g, eweight),
+                                                        _prop("v", g, pin),
+                                                        _prop("v", g, groups),
+                                                        (C, p, gamma, mu, mu_p),
+                                                        (coarse_method,
+                                                         mivs_thres, ec_thres,
+                                                         weighted_coarse),
+                                                        theta, cooling_step,
+                                                        max_level, epsilon,
+                                                        max_iter, warm,
+                                                        offload, callback,
+                                                        verbose,
+                                                        _get_rng())
+            pos = g_.own_property(pos)
+            return pos
+        cgs = coarse_graph_stack(g, coarse_stack[0], coarse_stack[1],
+                                 eweight=eweight, vweight=vweight,
+                                 verbose=verbose)
         for count, (u, pos, K, vcount, ecount) in enumerate(cgs):
             if verbose:
                 print("Positioning level:", count, u.num_vertices(), end=' ')
@@ -738,13 +852,14 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
                               # init_step=max(2 * K,
                               #               _avg_edge_distance(u, pos)),
                               multilevel=False,
+                              offload=offload,
                               verbose=False)
         pos = g_.own_property(pos)
         return pos
 
-    if g.num_vertices() <= 1:
+    if g.num_vertices() <= 1 and not incremental:
         return pos
-    if g.num_vertices() == 2:
+    if g.num_vertices() == 2 and not incremental:
         vs = [g.vertex(0, False), g.vertex(1, False)]
         pos[vs[0]] = [0, 0]
         pos[vs[1]] = [1, 1]
@@ -756,6 +871,22 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
     elif groups.value_type() != "int32_t":
         raise ValueError("'groups' property must be of type 'int32_t'.")
     libgraph_tool_layout.sanitize_pos(g._Graph__graph, _prop("v", g, pos))
+    if incremental:
+        state = libgraph_tool_layout.sfdp_layout_stepper(g._Graph__graph,
+                                                         _prop("v", g, pos),
+                                                         _prop("v", g, vweight),
+                                                         _prop("e", g, eweight),
+                                                         _prop("v", g, pin),
+                                                         (C, K, p, gamma, mu,
+                                                          mu_p,
+                                                          _prop("v", g, groups)),
+                                                         theta, init_step,
+                                                         cooling_step,
+                                                         max_level, epsilon,
+                                                         max_iter,
+                                                         not adaptive_cooling,
+                                                         verbose, _get_rng())
+        return LayoutStepper(g, g_.own_property(pos), state)
     libgraph_tool_layout.sfdp_layout(g._Graph__graph, _prop("v", g, pos),
                                      _prop("v", g, vweight),
                                      _prop("e", g, eweight),
@@ -763,7 +894,7 @@ def sfdp_layout(g, vweight=None, eweight=None, pin=None, groups=None, C=0.2,
                                      (C, K, p, gamma, mu, mu_p, _prop("v", g, groups)),
                                      theta, init_step, cooling_step, max_level,
                                      epsilon, max_iter, not adaptive_cooling,
-                                     verbose, _get_rng())
+                                     offload, verbose, _get_rng())
     pos = g_.own_property(pos)
     return pos
 
@@ -87,13 +87,6 @@ from .. stats import label_parallel_edges, label_self_loops
 
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_draw")
-try:
-    from .libgraph_tool_draw import vertex_attrs, edge_attrs, vertex_shape,\
-        edge_marker
-except ImportError:
-    msg = "Error importing cairo-based drawing library. " + \
-        "Was graph-tool compiled with cairomm support?"
-    warnings.warn(msg, RuntimeWarning)
 
 from .. draw import sfdp_layout, random_layout, _avg_edge_distance, \
     coarse_graphs, radial_tree_layout, prop_to_size
@@ -199,11 +192,19 @@ _etypes = {
     "seamless": "bool"
     }
 
-for k in list(_vtypes.keys()):
-    _vtypes[getattr(vertex_attrs, k)] = _vtypes[k]
+_attr_types_keyed = False
 
-for k in list(_etypes.keys()):
-    _etypes[getattr(edge_attrs, k)] = _etypes[k]
+def _attr_types(k):
+    # the attribute types are also keyed by the enum values of the compiled
+    # library, which are only added when they are first needed
+    global _attr_types_keyed
+    if not _attr_types_keyed:
+        for a in list(_vtypes.keys()):
+            _vtypes[getattr(libgraph_tool_draw.vertex_attrs, a)] = _vtypes[a]
+        for a in list(_etypes.keys()):
+            _etypes[getattr(libgraph_tool_draw.edge_attrs, a)] = _etypes[a]
+        _attr_types_keyed = True
+    return _vtypes if k == "v" else _etypes
 
 
 def shape_from_prop(shape, enum):
@@ -319,6 +320,11 @@ def centered_rotation(g, pos, text_pos=True):
     return angle
 
 def _convert(attr, val, cmap, pmap_default=False, g=None, k=None):
+    vertex_attrs = libgraph_tool_draw.vertex_attrs
+    edge_attrs = libgraph_tool_draw.edge_attrs
+    vertex_shape = libgraph_tool_draw.vertex_shape
+    edge_marker = libgraph_tool_draw.edge_marker
+
     try:
         cmap, alpha = cmap
     except (ValueError, TypeError):
@@ -460,9 +466,9 @@ def _convert(attr, val, cmap, pmap_default=False, g=None, k=None):
 
     if pmap_default and not isinstance(val, PropertyMap):
         if k == "v":
-            new_val = g.new_vertex_property(_vtypes[attr], val=val)
+            new_val = g.new_vertex_property(_attr_types("v")[attr], val=val)
         else:
-            new_val = g.new_edge_property(_etypes[attr], val=val)
+            new_val = g.new_edge_property(_attr_types("e")[attr], val=val)
         return new_val
 
     return val
@@ -474,9 +480,9 @@ def _attrs(attrs, d, g, cmap):
     for k, v in attrs.items():
         try:
             if d == "v":
-                attr = getattr(vertex_attrs, k)
+                attr = getattr(libgraph_tool_draw.vertex_attrs, k)
             else:
-                attr = getattr(edge_attrs, k)
+                attr = getattr(libgraph_tool_draw.edge_attrs, k)
         except AttributeError:
             warnings.warn("Unknown attribute: " + str(k), UserWarning)
             continue
@@ -491,9 +497,9 @@ def _convert_props(props, d, g, cmap, pmap_default=False):
     for k, v in props.items():
         try:
             if d == "v":
-                attr = getattr(vertex_attrs, k)
+                attr = getattr(libgraph_tool_draw.vertex_attrs, k)
             else:
-                attr = getattr(edge_attrs, k)
+                attr = getattr(libgraph_tool_draw.edge_attrs, k)
             nprops[k] = _convert(attr, v, cmap, pmap_default=pmap_default,
                                  g=g, k=d)
         except AttributeError:
@@ -553,7 +559,7 @@ def parse_props(prefix, args):
 def cairo_draw(g, pos, cr, vprops=None, eprops=None, vorder=None, eorder=None,
                nodesfirst=False, vcmap=default_cm, ecmap=default_cm,
                loop_angle=numpy.nan, parallel_distance=None, fit_view=False,
-               res=0, max_render_time=-1, **kwargs):
+               res=0, max_render_time=-1, tile_size=None, **kwargs):
     r"""Draw a graph to a :mod:`cairo` context.
 
     Parameters
@@ -605,6 +611,11 @@ def cairo_draw(g, pos, cr, vprops=None, eprops=None, vorder=None, eorder=None,
         If nonnegative, this function will return an iterator that will perform
         part of the drawing at each step, so that each iteration takes at most
         ``max_render_time`` milliseconds.
+    tile_size : int (optional, default: ``None``):
+        If given, and ``cr`` targets a :class:`~cairo.ImageSurface`, the
+        drawing is split into square tiles with this size in pixels, which are
+        rendered in parallel. This is not supported for vertex surfaces, and it
+        is ignored if ``max_render_time`` is nonnegative.
     vertex_* : :class:`~graph_tool.PropertyMap` or arbitrary types (optional, default: ``None``)
         Parameters following the pattern ``vertex_<prop-name>`` specify the
         vertex property with name ``<prop-name>``, as an alternative to the
@@ -699,6 +710,17 @@ def cairo_draw(g, pos, cr, vprops=None, eprops=None, vorder=None, eorder=None,
             parallel_distance = _defaults
         eprops["control_points"] = position_parallel_edges(g, pos, loop_angle,
                                                            parallel_distance)
+    if (tile_size is not None and max_render_time < 0 and
+        isinstance(cr.get_target(), cairo.ImageSurface)):
+        libgraph_tool_draw.cairo_draw_tiled(g._Graph__graph,
+                                            _prop("v", g, pos),
+                                            _prop("v", g, vorder),
+                                            _prop("e", g, eorder),
+                                            nodesfirst, vattrs, eattrs, vdefs,
+                                            edefs, res, tile_size, cr)
+        cr.restore()
+        return
+
     generator = libgraph_tool_draw.cairo_draw(g._Graph__graph,
                                               _prop("v", g, pos),
                                               _prop("v", g, vorder),
@@ -1072,7 +1094,7 @@ def graph_draw(g, pos=None, vprops=None, eprops=None, vorder=None, eorder=None,
 
     if "text" in vprops and ("text_color" not in vprops or vprops["text_color"] == "auto"):
         vcmap = kwargs.get("vcmap", default_cm)
-        bg = _convert(vertex_attrs.fill_color,
+        bg = _convert(libgraph_tool_draw.vertex_attrs.fill_color,
                       vprops.get("fill_color", _vdefaults["fill_color"]),
                       vcmap)
         bg_color = kwargs.get("bg_color", [1., 1., 1., 1.])
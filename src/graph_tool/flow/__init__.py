@@ -33,6 +33,8 @@ Summary
    boykov_kolmogorov_max_flow
    min_st_cut
    min_cut
+   karger_stein_min_cut
+   GomoryHuTree
 
 Contents
 ++++++++
@@ -82,10 +84,13 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_flow")
 
-from .. import _prop, _check_prop_scalar, _check_prop_writable, GraphView
+from .. import _prop, _check_prop_scalar, _check_prop_writable, GraphView, \
+    _get_rng
+import numpy, collections
 
 __all__ = ["edmonds_karp_max_flow", "push_relabel_max_flow",
-           "boykov_kolmogorov_max_flow", "min_st_cut", "min_cut"]
+           "boykov_kolmogorov_max_flow", "min_st_cut", "min_cut",
+           "karger_stein_min_cut", "GomoryHuTree"]
 
 
 def edmonds_karp_max_flow(g, source, target, capacity, residual=None):
@@ -415,21 +420,14 @@ def min_st_cut(g, source, capacity, residual):
     """
     if not g.is_directed():
         raise ValueError("The graph provided must be directed!")
-    augment = g.new_edge_property("bool")
-    libgraph_tool_flow.residual_graph(g._Graph__graph,
-                                      _prop("e", g, capacity),
-                                      _prop("e", g, residual),
-                                      _prop("e", g, augment))
-    em = g.new_edge_property("bool")
-    em.a = (residual.a[:len(em.a)] > 0) + augment.a
-    u = GraphView(g, efilt=em)
-    part = label_out_component(u, source)
-    part = g.own_property(part)
-
-    # cleanup augmented edges
-    u = GraphView(g, efilt=augment)
-    u.clear_edges()
-
+    if int(source) < 0:
+        raise ValueError("Invalid vertex index: %d" % int(source))
+    source = g.vertex(source)
+    part = g.new_vertex_property("bool")
+    libgraph_tool_flow.min_st_cut(g._Graph__graph, int(source),
+                                  _prop("e", g, capacity),
+                                  _prop("e", g, residual),
+                                  _prop("v", g, part))
     return part
 
 
@@ -498,4 +496,200 @@ def min_cut(g, weight):
                                     _prop("v", g, part))
     return mc, part
 
+def karger_stein_min_cut(g, weight=None, trials=None, epsilon=1e-3):
+    r"""
+    Get the minimum cut of an undirected graph with the randomized Karger-Stein
+    algorithm.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    weight : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Edge property map with the edge weights. If not provided, every edge
+        has unit weight.
+    trials : ``int`` (optional, default: ``None``)
+        Number of independent runs of the algorithm. If not provided, it is
+        chosen so that the error probability is at most ``epsilon``.
+    epsilon : ``float`` (optional, default: ``1e-3``)
+        Target error probability, used if ``trials`` is not given.
+
+    Returns
+    -------
+    min_cut : float
+        The value of the smallest cut found.
+    partition : :class:`~graph_tool.PropertyMap`
+        Boolean-valued vertex property map with the cut partition.
+    error : float
+        Upper bound on the probability that ``min_cut`` is not the minimum
+        cut.
+
+    Notes
+    -----
+    The algorithm is defined in [karger-new-1996]_. Each run contracts random
+    edges, chosen with probability proportional to their weights, down to
+    :math:`1 + N/\sqrt{2}` vertices, twice independently, and recurses on both
+    contracted graphs. It finds a minimum cut with probability
+    :math:`p = \Omega(1/\log N)`, and the error probability after :math:`T`
+    runs is bounded by :math:`(1-p)^T`, for the lower bound of :math:`p` given
+    in [motwani-randomized-1995]_. The runs are done in parallel.
+
+    The time complexity of each run is :math:`O(N^2\log N)`, compared to
+    :math:`O(VE + V^2 \log V)` for :func:`min_cut`, and
+    :math:`O(\log^2 N)` runs are needed for a small error probability. The
+    result is always a valid cut, and it is exact for graphs with at most six
+    vertices.
+
+    Edges with non-positive weights are ignored.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       gt.seed_rng(42)
+
+    >>> g = gt.load_graph("mincut-example.xml.gz")
+    >>> weight = g.edge_properties["weight"]
+    >>> mc, part, err = gt.karger_stein_min_cut(g, weight)
+    >>> print(mc, err < 1e-3)
+    4.0 True
+
+    References
+    ----------
+    .. [karger-new-1996] D. R. Karger and C. Stein, "A new approach to the
+       minimum cut problem", Journal of the ACM 43 (4), 601-640, 1996.
+       :doi:`10.1145/234533.234534`
+    .. [motwani-randomized-1995] R. Motwani and P. Raghavan, "Randomized
+       algorithms", Cambridge University Press, 1995.
+    """
+
+    if weight is not None:
+        _check_prop_scalar(weight, "weight")
+    if g.is_directed():
+        raise ValueError("The graph provided must be undirected!")
+
+    # lower bound on the success probability of a single run, with the same
+    # recursion depth as the C++ implementation
+    N = g.num_vertices()
+    if N <= 6:
+        p = 1.
+    else:
+        q = 3.
+        for k in range(int(numpy.ceil(2 * numpy.log2(N)))):
+            q += 1 + 1 / q
+        p = 4 / (q + 1)
+    if trials is None:
+        if p == 1:
+            trials = 1
+        else:
+            trials = int(numpy.ceil(numpy.log(epsilon) / numpy.log1p(-p)))
+    err = (1 - p) ** trials
+
+    part = g.new_vertex_property("bool")
+    mc = libgraph_tool_flow.min_cut_karger_stein(g._Graph__graph,
+                                                 _prop("e", g, weight),
+                                                 _prop("v", g, part),
+                                                 trials, _get_rng())
+    return mc, part, err
+
+
+class GomoryHuTree(object):
+    r"""Tree with the minimum cuts between all pairs of vertices of an undirected
+    graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph` (optional, default: ``None``)
+        Undirected graph to be used. If not given, the tree is empty, and should
+        be read from a file with :meth:`load`.
+    capacity : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Edge property map with the edge capacities. If not provided, every edge
+        has unit capacity.
+
+    Notes
+    -----
+
+    The tree is a flow-equivalent tree, obtained with Gusfield's algorithm
+    [gusfield-very-1990]_: it spans the same vertices as the graph, and the
+    value of the minimum cut between any two vertices is the smallest weight
+    in the tree path between them, which is found in time proportional to the
+    length of the path.
+
+    The tree is built with :math:`N-1` minimum cuts, obtained with the
+    Boykov-Kolmogorov algorithm. They are computed in parallel, in batches,
+    and the result does not depend on the number of threads. Queries for many
+    pairs are answered in parallel as well.
+
+    The tree does not keep a reference to the graph, and must be built again
+    if the graph or the capacities are changed. It can be saved to disk with
+    :meth:`save`, and read back with :meth:`load`.
+
+    Examples
+    --------
+    >>> g = gt.load_graph("mincut-example.xml.gz")
+    >>> weight = g.edge_properties["weight"]
+    >>> gh = gt.GomoryHuTree(g, weight)
+    >>> mc, part = gt.min_cut(g, weight)
+    >>> print(gh.min_cut(0, range(1, g.num_vertices())).min() == mc)
+    True
+
+    References
+    ----------
+    .. [gusfield-very-1990] D. Gusfield, "Very simple methods for all pairs
+       network flow analysis", SIAM Journal on Computing 19 (1), 143-155,
+       1990. :doi:`10.1137/0219009`
+    """
+
+    def __init__(self, g=None, capacity=None):
+        self._gh = libgraph_tool_flow.GomoryHuTree()
+        if g is not None:
+            if g.is_directed():
+                raise ValueError("The graph provided must be undirected!")
+            if capacity is not None:
+                _check_prop_scalar(capacity, "capacity")
+            self._gh.build(g._Graph__graph, _prop("e", g, capacity))
+
+    def __len__(self):
+        return self._gh.num_vertices()
+
+    def min_cut(self, source, target):
+        """Return the value of the minimum cut between ``source`` and
+        ``target``, which is :data:`numpy.inf` if they are the same. Either of
+        them may be an iterable of vertices, in which case an array of values is
+        returned, for every pair given by :func:`numpy.broadcast`."""
+        scalar = True
+        vs = []
+        for v in [source, target]:
+            if isinstance(v, collections.Iterable):
+                scalar = False
+                vs.append(numpy.asarray(v, dtype="int64"))
+            else:
+                vs.append(numpy.asarray(int(v), dtype="int64"))
+        source, target = numpy.broadcast_arrays(*vs)
+        c = self._gh.min_cut(numpy.ascontiguousarray(source.ravel()),
+                             numpy.ascontiguousarray(target.ravel()))
+        if scalar:
+            return c[0]
+        return c.reshape(source.shape)
+
+    def tree(self):
+        """Return a tuple ``(parent, weight)`` of arrays, with the parent of each
+        vertex in the tree, and the weight of the tree edge to it. The parent is
+        ``-1`` for the root, and for vertices not in the graph."""
+        return self._gh.tree()
+
+    def save(self, file):
+        """Save the tree to ``file``, which must be a path. The format is binary,
+        and not portable between machines of different byte order."""
+        self._gh.save(file)
+
+    @staticmethod
+    def load(file):
+        """Return a :class:`GomoryHuTree` read from ``file``, which must have
+        been written with :meth:`save`."""
+        gh = GomoryHuTree()
+        gh._gh.load(file)
+        return gh
+
 from .. topology import label_out_component
@@ -41,6 +41,7 @@ Summary
    complete_graph
    circular_graph
    condensation_graph
+   stream_graph
 
 Contents
 ++++++++
@@ -59,19 +60,20 @@ from .. import Graph, GraphView, _check_prop_scalar, _prop, _limit_args, \
 from .. stats import label_parallel_edges, label_self_loops
 import inspect
 import types
+import os
 import numpy
 import numpy.random
 
 __all__ = ["random_graph", "random_rewire", "generate_sbm", "predecessor_tree",
            "line_graph", "graph_union", "triangulation", "lattice",
            "geometric_graph", "price_network", "complete_graph",
-           "circular_graph", "condensation_graph"]
+           "circular_graph", "condensation_graph", "stream_graph"]
 
 
 def random_graph(N, deg_sampler, directed=True,
                  parallel_edges=False, self_loops=False, block_membership=None,
                  block_type="int", degree_block=False,
-                 random=True, verbose=False, **kwargs):
+                 random=True, parallel=False, verbose=False, **kwargs):
     r"""
     Generate a random graph, with a given degree distribution and (optionally)
     vertex-vertex correlation.
@@ -131,6 +133,11 @@ def random_graph(N, deg_sampler, directed=True,
     random : bool (optional, default: ``True``)
         If ``True``, the returned graph is randomized. Otherwise a deterministic
         placement of the edges will be used.
+    parallel : bool (optional, default: ``False``)
+        If ``True``, the edges are placed by randomly pairing the stubs
+        (half-edges) in parallel, instead of deterministically, and, if
+        ``random == True``, the same option is passed to
+        :func:`~graph_tool.generation.random_rewire`. See notes below.
     verbose : bool (optional, default: ``False``)
         If ``True``, verbose information is displayed.
 
@@ -157,6 +164,16 @@ def random_graph(N, deg_sampler, directed=True,
     The complexity is :math:`O(V + E)` if parallel edges are allowed, and
     :math:`O(V + E \times\text{n-iter})` if parallel edges are not allowed.
 
+    If ``parallel == True``, the list of stubs is shuffled and paired in
+    parallel, yielding a sample of the configuration model. If parallel edges
+    or self-loops are not allowed, the offending edges are repeatedly swapped
+    with randomly chosen edges until none remain, which requires
+    :math:`O(E\log E)` work per round, but usually only a few rounds. The
+    edges are then inserted in bulk. The degrees are still sampled
+    sequentially, since ``deg_sampler`` is a Python function. This is useful
+    for very large graphs, but the result depends on the number of threads,
+    besides the seed.
+
 
     .. note ::
 
@@ -402,7 +419,7 @@ def random_graph(N, deg_sampler, directed=True,
     libgraph_tool_generation.gen_graph(g._Graph__graph, N, sampler_wrap,
                                        not parallel_edges,
                                        not self_loops, not directed,
-                                       _get_rng(), verbose, True)
+                                       _get_rng(), verbose, True, parallel)
     g.set_directed(directed)
 
     if degree_block:
@@ -443,7 +460,7 @@ def random_graph(N, deg_sampler, directed=True,
         g.set_fast_edge_removal(True)
         random_rewire(g, parallel_edges=parallel_edges,
                       self_loops=self_loops, verbose=verbose,
-                      block_membership=bm, **kwargs)
+                      block_membership=bm, parallel=parallel, **kwargs)
         g.set_fast_edge_removal(False)
 
     if bm is None:
@@ -458,7 +475,8 @@ def random_graph(N, deg_sampler, directed=True,
 def random_rewire(g, model="configuration", n_iter=1, edge_sweep=True,
                   parallel_edges=False, self_loops=False, configuration=True,
                   edge_probs=None, block_membership=None, cache_probs=True,
-                  persist=False, pin=None, ret_fail=False, verbose=False):
+                  persist=False, pin=None, ret_fail=False, verbose=False,
+                  parallel=False):
     r"""Shuffle the graph in-place, following a variety of possible statistical
     models, chosen via the parameter ``model``.
 
@@ -573,6 +591,16 @@ def random_rewire(g, model="configuration", n_iter=1, edge_sweep=True,
         will be left unmodified in the graph.
     verbose : bool (optional, default: ``False``)
         If ``True``, verbose information is displayed.
+    parallel : bool (optional, default: ``False``)
+        If ``True``, the edge moves are performed by several threads at the
+        same time, with a lock on the vertices involved in each move, and the
+        graph is modified only at the end. Every move is accepted with the
+        same probability as in the sequential algorithm, but the order in
+        which they are done depends on the scheduling of the threads, hence the
+        result is not reproducible, even with a fixed seed. This is only
+        available for the ``"erdos"``, ``"configuration"`` and
+        ``"constrained-configuration"`` models, and is ignored if
+        ``edge_sweep == False``.
 
 
     Returns
@@ -838,13 +866,14 @@ def random_rewire(g, model="configuration", n_iter=1, edge_sweep=True,
                                                     _prop("e", g, pin),
                                                     _prop("v", g, block_membership),
                                                     cache_probs,
-                                                    _get_rng(), verbose)
+                                                    _get_rng(), verbose,
+                                                    parallel)
     if not fast:
         g.set_fast_edge_removal(False)
     return pcount
 
 def generate_sbm(b, probs, out_degs=None, in_degs=None, directed=False,
-                 micro_ers=False, micro_degs=False):
+                 micro_ers=False, micro_degs=False, parallel=False):
     r"""Generate a random graph by sampling from the Poisson or microcanonical
     stochastic block model.
 
@@ -877,6 +906,12 @@ def generate_sbm(b, probs, out_degs=None, in_degs=None, directed=False,
         parameters ``out_degs`` and ``in_degs``, and they will not fluctuate
         between samples. (If ``micro_degs == True`` it implies ``micro_ers ==
         True``.)
+    parallel : ``bool`` (optional, default: ``False``)
+        If true, the edges are sampled in parallel, with the pairs of groups
+        split among the threads, each with an independent random number
+        generator, and inserted in bulk. The result is deterministic for a
+        given seed and number of threads, but differs from the sequential
+        one. This is not available if ``micro_degs == True``.
 
 
     Returns
@@ -1021,6 +1056,27 @@ def generate_sbm(b, probs, out_degs=None, in_degs=None, directed=False,
 
     """
 
+    if parallel and micro_degs:
+        raise ValueError("parallel sampling is not available if micro_degs == True")
+
+    g, b, r, s, p, in_degs, out_degs = _sbm_params(b, probs, out_degs, in_degs,
+                                                   directed, micro_degs)
+
+    libgraph_tool_generation.gen_sbm(g._Graph__graph,
+                                     _prop("v", g, b),
+                                     r, s, p,
+                                     _prop("v", g, in_degs),
+                                     _prop("v", g, out_degs),
+                                     micro_ers,
+                                     micro_degs,
+                                     parallel,
+                                     _get_rng())
+    return g
+
+def _sbm_params(b, probs, out_degs, in_degs, directed, micro_degs):
+    """Return an edgeless graph with the vertices of the SBM, the group and
+    degree properties, and the nonzero entries of ``probs``."""
+
     g = Graph()
     g.add_vertex(len(b))
     b = g.new_vp("int", b)
@@ -1054,17 +1110,9 @@ def generate_sbm(b, probs, out_degs=None, in_degs=None, directed=False,
 
     g.set_directed(directed)
 
-    libgraph_tool_generation.gen_sbm(g._Graph__graph,
-                                     _prop("v", g, b),
-                                     numpy.asarray(r, dtype="int64"),
-                                     numpy.asarray(s, dtype="int64"),
-                                     numpy.asarray(p, dtype=p_type),
-                                     _prop("v", g, in_degs),
-                                     _prop("v", g, out_degs),
-                                     micro_ers,
-                                     micro_degs,
-                                     _get_rng())
-    return g
+    return (g, b, numpy.asarray(r, dtype="int64"),
+            numpy.asarray(s, dtype="int64"), numpy.asarray(p, dtype=p_type),
+            in_degs, out_degs)
 
 def predecessor_tree(g, pred_map):
     """Return a graph from a list of predecessors given by the ``pred_map`` vertex property."""
@@ -1659,6 +1707,12 @@ def geometric_graph(points, radius, ranges=None):
     embedded in a N-dimensional euclidean space which are at a distance equal to
     or smaller than a given radius.
 
+    The points are sorted into a grid of cells of width at least equal to the
+    radius, along at most three dimensions, and only the points in neighboring
+    cells are compared. The cells are processed in parallel. For points that
+    are uniformly distributed, the complexity is :math:`O(N + E)`, where
+    :math:`E` is the number of edges.
+
     See Also
     --------
     triangulation: 2D or 3D triangulation
@@ -1709,9 +1763,8 @@ def geometric_graph(points, radius, ranges=None):
 
     g = Graph(directed=False)
     pos = g.new_vertex_property("vector<double>")
-    if type(points) != numpy.ndarray:
-        points = numpy.array(points)
-    if len(points.shape) < 2:
+    points = numpy.asarray(points, dtype="float")
+    if len(points.shape) != 2:
         raise ValueError("points list must be a two-dimensional array!")
     if ranges is not None:
         periodic = True
@@ -1729,7 +1782,8 @@ def geometric_graph(points, radius, ranges=None):
     return g, pos
 
 
-def price_network(N, m=1, c=None, gamma=1, directed=True, seed_graph=None):
+def price_network(N, m=1, c=None, gamma=1, directed=True, seed_graph=None,
+                  fast=False):
     r"""A generalized version of Price's -- or Barabási-Albert if undirected -- preferential attachment network model.
 
     Parameters
@@ -1749,6 +1803,12 @@ def price_network(N, m=1, c=None, gamma=1, directed=True, seed_graph=None):
     seed_graph : :class:`~graph_tool.Graph` (optional, default: ``None``)
         If provided, this graph will be used as the starting point of the
         algorithm.
+    fast : bool (optional, default: ``False``)
+        If ``True``, the targets are sampled in constant time from the list of
+        edge endpoints if ``gamma == 1`` and ``c >= 0``, or in time
+        :math:`O(\log N)` from a binary tree of the vertex weights otherwise,
+        both with memory :math:`O(N + E)`. The distribution of the generated
+        graphs is the same, but not the graph obtained for a given seed.
 
     Returns
     -------
@@ -1791,7 +1851,8 @@ def price_network(N, m=1, c=None, gamma=1, directed=True, seed_graph=None):
     number of vertices added so far. If this behaviour is undesired, a proper
     seed graph with :math:`V \ge m` vertices must be provided.
 
-    This algorithm runs in :math:`O(V\log V)` time.
+    This algorithm runs in :math:`O(V\log V)` time, or in :math:`O(V)` time
+    if ``fast == True``, ``gamma == 1`` and ``c >= 0``.
 
     See Also
     --------
@@ -1863,7 +1924,8 @@ def price_network(N, m=1, c=None, gamma=1, directed=True, seed_graph=None):
         N -= g.num_vertices()
     else:
         g = seed_graph
-    libgraph_tool_generation.price(g._Graph__graph, N, gamma, c, m, _get_rng())
+    libgraph_tool_generation.price(g._Graph__graph, N, gamma, c, m, fast,
+                                   _get_rng())
     return g
 
 def condensation_graph(g, prop, vweight=None, eweight=None, avprops=None,
@@ -2048,6 +2110,105 @@ def condensation_graph(g, prop, vweight=None, eweight=None, avprops=None,
                                                     parallel_edges)
     return gp, cprop, vcount, ecount, r_avp, r_aep
 
+def stream_graph(file_name, model, binary=None, **kwargs):
+    r"""Generate a graph from one of the given models, and write its edges
+    directly to a file, without building the graph in memory.
+
+    Parameters
+    ----------
+    file_name : ``str``
+        Path of the output file. If it ends with ``.gz``, ``.bz2`` or ``.zst``
+        it will be compressed accordingly.
+    model : ``str``
+        The generator used, which must be one of ``"complete"``,
+        ``"circular"``, ``"lattice"`` or ``"sbm"``, corresponding to
+        :func:`~graph_tool.generation.complete_graph`,
+        :func:`~graph_tool.generation.circular_graph`,
+        :func:`~graph_tool.generation.lattice` and
+        :func:`~graph_tool.generation.generate_sbm`, respectively.
+    binary : ``str`` (optional, default: ``None``)
+        If given, the edges are written as pairs of integers of type
+        ``"uint32_t"`` or ``"uint64_t"`` (in native byte order). Otherwise each
+        line of the file contains the source and target of an edge, separated
+        by a space.
+    **kwargs : Keyword parameter list
+        The parameters of the corresponding generator function. For ``"sbm"``,
+        ``micro_degs == True`` and ``parallel`` are not accepted.
+
+    Returns
+    -------
+    N : ``int``
+        Number of vertices of the generated graph.
+    E : ``int``
+        Number of edges written.
+
+    Notes
+    -----
+    Each thread buffers a bounded chunk of edges at a time, so the memory used
+    does not depend on the number of edges. The file can be read back with
+    :func:`~graph_tool.load_graph_from_edge_list`, with the same ``binary``
+    parameter (the ``directed`` parameter must be set accordingly). Since
+    isolated vertices do not appear in an edge list, the number of vertices is
+    returned separately.
+
+    For ``"sbm"`` the pairs of groups are processed in parallel, as with
+    :func:`~graph_tool.generation.generate_sbm` with ``parallel == True``, so
+    the edges written are deterministic for a given seed and number of threads,
+    but their order in the file is not.
+
+    Examples
+    --------
+    >>> import os, tempfile, shutil
+    >>> path = tempfile.mkdtemp()
+    >>> fname = os.path.join(path, "lattice.txt")
+    >>> N, E = gt.stream_graph(fname, "lattice", shape=[10, 10])
+    >>> g = gt.load_graph_from_edge_list(fname, directed=False)
+    >>> print(N, E, g.num_edges())
+    100 180 180
+    >>> shutil.rmtree(path)
+    """
+
+    width = {None: 0, "uint32_t": 4, "uint64_t": 8}.get(binary, None)
+    if width is None:
+        raise ValueError("invalid binary type: " + str(binary))
+    file_name = _c_str(os.path.expanduser(file_name))
+
+    if model == "complete":
+        kwargs = dict(dict(self_loops=False, directed=False), **kwargs)
+        return libgraph_tool_generation.stream_complete(file_name, width,
+                                                        kwargs["N"],
+                                                        kwargs["directed"],
+                                                        kwargs["self_loops"])
+    elif model == "circular":
+        kwargs = dict(dict(k=1, self_loops=False, directed=False), **kwargs)
+        return libgraph_tool_generation.stream_circular(file_name, width,
+                                                        kwargs["N"],
+                                                        kwargs["k"],
+                                                        kwargs["directed"],
+                                                        kwargs["self_loops"])
+    elif model == "lattice":
+        kwargs = dict(dict(periodic=False), **kwargs)
+        return libgraph_tool_generation.stream_lattice(file_name, width,
+                                                       kwargs["shape"],
+                                                       kwargs["periodic"])
+    elif model == "sbm":
+        kwargs = dict(dict(out_degs=None, in_degs=None, directed=False,
+                           micro_ers=False, micro_degs=False), **kwargs)
+        if kwargs["micro_degs"]:
+            raise ValueError("cannot stream the SBM if micro_degs == True")
+        g, b, r, s, p, in_degs, out_degs = \
+            _sbm_params(kwargs["b"], kwargs["probs"], kwargs["out_degs"],
+                        kwargs["in_degs"], kwargs["directed"], False)
+        return libgraph_tool_generation.stream_sbm(g._Graph__graph,
+                                                   file_name, width,
+                                                   _prop("v", g, b), r, s, p,
+                                                   _prop("v", g, in_degs),
+                                                   _prop("v", g, out_degs),
+                                                   kwargs["micro_ers"],
+                                                   _get_rng())
+    else:
+        raise ValueError("invalid model: " + str(model))
+
 class Sampler(libgraph_tool_generation.Sampler):
     def __init__(self, values, probs):
         libgraph_tool_generation.Sampler.__init__(self, values, probs)
@@ -2061,5 +2222,10 @@ class DynamicSampler(libgraph_tool_generation.DynamicSampler):
             values = probs = []
         libgraph_tool_generation.DynamicSampler.__init__(self, values, probs)
 
-    def sample(self):
-        return libgraph_tool_generation.DynamicSampler.sample(self, _get_rng())
\ No newline at end of file
+    def sample(self, n=None):
+        """Sample one item, or, if ``n`` is given, an array of ``n`` items
+        sampled independently (in the order of the internal tree, not in
+        random order)."""
+        if n is None:
+            return libgraph_tool_generation.DynamicSampler.sample(self, _get_rng())
+        return libgraph_tool_generation.DynamicSampler.sample_n(self, n, _get_rng())
\ No newline at end of file
@@ -63,11 +63,23 @@ Sampling and minimization
    mcmc_equilibrate
    mcmc_anneal
    mcmc_multilevel
+   mcmc_online_update
+   mcmc_chains
    multicanonical_equilibrate
    MulticanonicalState
    bisection_minimize
    hierarchy_minimize
 
+Checkpointing
+=============
+
+.. autosummary::
+   :nosignatures:
+
+   save_checkpoint
+   load_checkpoint
+   wait_checkpoint
+
 Auxiliary functions
 ===================
 
@@ -80,6 +92,8 @@ Auxiliary functions
    microstate_entropy
    half_edge_graph
    get_block_edge_gradient
+   set_sweep_stats
+   get_sweep_stats
 
 Auxiliary classes
 =================
@@ -88,6 +102,7 @@ Auxiliary classes
    :nosignatures:
 
    PartitionHist
+   PartitionHashHist
    BlockPairHist
 
 Semiparametric stochastic block model inference
@@ -116,6 +131,7 @@ Large-scale descriptors
    :nosignatures:
 
    modularity
+   maximize_modularity
 
 Contents
 ++++++++
@@ -136,11 +152,16 @@ __all__ = ["minimize_blockmodel_dl",
            "mcmc_equilibrate",
            "mcmc_anneal",
            "mcmc_multilevel",
+           "mcmc_online_update",
+           "mcmc_chains",
            "TemperingState",
            "multicanonical_equilibrate",
            "MulticanonicalState",
            "bisection_minimize",
            "hierarchy_minimize",
+           "save_checkpoint",
+           "load_checkpoint",
+           "wait_checkpoint",
            "EMBlockState",
            "em_infer",
            "model_entropy",
@@ -148,11 +169,15 @@ __all__ = ["minimize_blockmodel_dl",
            "bethe_entropy",
            "microstate_entropy",
            "PartitionHist",
+           "PartitionHashHist",
            "BlockPairHist",
            "half_edge_graph",
            "get_block_edge_gradient",
+           "set_sweep_stats",
+           "get_sweep_stats",
            "get_hierarchy_tree",
-           "modularity"]
+           "modularity",
+           "maximize_modularity"]
 
 from . blockmodel import *
 from . overlap_blockmodel import *
@@ -164,3 +189,4 @@ from . minimize import *
 from . blockmodel_em import *
 from . util import *
 from . modularity import *
+from . checkpoint import *
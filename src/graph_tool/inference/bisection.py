@@ -70,7 +70,8 @@ def get_ent(state, mcmc_multilevel_args):
     S = state.entropy(**dict(entropy_args))
     return S
 
-def get_state_dl(B, b_cache, mcmc_multilevel_args={}, verbose=False):
+def get_state_dl(B, b_cache, mcmc_multilevel_args={}, callback=None,
+                 verbose=False):
     if B in b_cache:
         return b_cache[B][0]
     Bs = sorted(b_cache.keys())
@@ -84,10 +85,12 @@ def get_state_dl(B, b_cache, mcmc_multilevel_args={}, verbose=False):
                                                          (B, B_prev)))))
     dl = get_ent(state, mcmc_multilevel_args)
     b_cache[B] = (dl, state)
+    if callback is not None:
+        callback(B, dl, state)
     return dl
 
 def bisection_minimize(init_states, random_bisection=False,
-                       mcmc_multilevel_args={}, verbose=False):
+                       mcmc_multilevel_args={}, callback=None, verbose=False):
     r"""Find the best order (number of groups) given an initial set of states by
     performing a one-dimension minimization, using a Fibonacci (or golden
     section) search.
@@ -101,6 +104,10 @@ def bisection_minimize(init_states, random_bisection=False,
         instead of using the golden rule.
     mcmc_multilevel_args : ``dict`` (optional, default: ``{}``)
         Arguments to be passed to :func:`~graph_tool.inference.mcmc_multilevel`.
+    callback : function (optional, default: ``None``)
+        If given, it will be called as ``callback(B, S, state)`` each time a
+        new order ``B`` is evaluated, with the entropy ``S`` of the
+        corresponding ``state``, which should not be modified.
     verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
         If ``True``, progress information will be shown. Optionally, this
         accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
@@ -111,7 +118,8 @@ def bisection_minimize(init_states, random_bisection=False,
     Returns
     -------
     min_state : Any state class (e.g. :class:`~graph_tool.inference.BlockState`)
-        State with minimal entropy in the interval.
+        State with minimal entropy in the interval. This is a copy if it is one
+        of the initial states.
 
     Notes
     -----
@@ -120,6 +128,10 @@ def bisection_minimize(init_states, random_bisection=False,
     the order of a given state, and uses the value of ``state.entropy(**args)``
     for the minimization, with ``args`` obtained from ``mcmc_multilevel_args``.
 
+    The initial states are not modified, and are therefore not copied. Only
+    the states inside the current bracket, and the best one found so far, are
+    kept during the search.
+
     References
     ----------
 
@@ -134,7 +146,7 @@ def bisection_minimize(init_states, random_bisection=False,
     b_cache = {}
     for state in init_states:
         b_cache[state.get_nonempty_B()] = (get_ent(state, mcmc_multilevel_args),
-                                           state.copy())
+                                           state)
 
     max_B = max(b_cache.keys())
     min_B = min(b_cache.keys())
@@ -143,6 +155,7 @@ def bisection_minimize(init_states, random_bisection=False,
     kwargs = dict(b_cache=b_cache,
                   mcmc_multilevel_args=dict(mcmc_multilevel_args,
                                             b_cache=b_cache),
+                  callback=callback,
                   verbose=verbose_push(verbose, (" " * 4)))
 
     # Initial bracketing
@@ -198,7 +211,10 @@ def bisection_minimize(init_states, random_bisection=False,
                 print(verbose_pad(verbose) +
                       "Best result: B = %d, S = %.16g" % (best_B, min_dl))
 
-            return b_cache[best_B][1]
+            state = b_cache[best_B][1]
+            if any(state is s for s in init_states):
+                state = state.copy()
+            return state
 
         if f_x < f_mid:
             if max_B - mid_B > mid_B - min_B:
@@ -25,7 +25,7 @@ if sys.version_info < (3,):
 
 from .. import _degree, _prop, Graph, GraphView, libcore, _get_rng, PropertyMap, \
     conv_pickle_state, Vector_size_t, Vector_double, group_vector_property, \
-    perfect_prop_hash
+    perfect_prop_hash, openmp_get_num_threads
 from .. generation import condensation_graph, random_rewire, generate_sbm
 from .. stats import label_self_loops, remove_parallel_edges, remove_self_loops
 from .. spectral import adjacency
@@ -37,14 +37,35 @@ import copy
 import collections
 from collections import OrderedDict
 import itertools
+import functools
 import warnings
 
 from . util import *
+from . util import _parallel_map
 
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_inference as libinference")
 
-from . libgraph_tool_inference import PartitionHist, BlockPairHist
+# The histogram types are defined in the compiled library, which is only loaded
+# when they are first instantiated.
+
+def PartitionHist():
+    r"""Return a new histogram of partitions, implemented in C++. Its interface
+    supports querying and setting using :class:`Vector_int32_t` as keys, and
+    ints as values."""
+    return libinference.PartitionHist()
+
+def PartitionHashHist():
+    r"""Return a new histogram of partitions keyed by 64-bit hashes, implemented
+    in C++. Its interface supports querying using the hashes as keys, and
+    floats as values."""
+    return libinference.PartitionHashHist()
+
+def BlockPairHist():
+    r"""Return a new histogram of block pairs, implemented in C++. Its
+    interface supports querying and setting using pairs of ints as keys, and
+    ints as values."""
+    return libinference.BlockPairHist()
 
 __test__ = False
 
@@ -56,6 +77,29 @@ def _bm_test():
     global __test__
     return __test__
 
+def _cached_entropy(entropy):
+    """Decorator for the ``entropy()`` method of the block states, which returns
+    the value tracked incrementally from the sweeps, if it is still valid (see
+    :meth:`BlockState._update_entropy_cache`). Otherwise the entropy is
+    computed, and it becomes the new tracked value."""
+
+    @functools.wraps(entropy)
+    def wrapper(self, *args, **kwargs):
+        # only the entropy of the most derived class is cached
+        method = type(self).entropy
+        if len(args) > 0 or getattr(method, "__func__", method) is not wrapper:
+            return entropy(self, *args, **kwargs)
+        key = self._get_entropy_key(kwargs)
+        cache = getattr(self, "_entropy_cache", None)
+        if (key is not None and cache is not None and cache[0] == key and
+            cache[2] == self._state.get_mod_count()):
+            return cache[1]
+        S = entropy(self, **kwargs)
+        if key is not None:
+            self._entropy_cache = (key, S, self._state.get_mod_count(), 0)
+        return S
+    return wrapper
+
 def get_block_graph(g, B, b, vcount=None, ecount=None, rec=None, drec=None):
     if isinstance(ecount, libinference.unity_eprop_t):
         ecount = None
@@ -242,8 +286,10 @@ class BlockState(object):
         If ``True``, partition description length computed will allow for empty
         groups.
     max_BE : ``int`` (optional, default: ``1000``)
-        If the number of blocks exceeds this value, a sparse matrix is used for
-        the block graph. Otherwise a dense matrix will be used.
+        If the number of blocks exceeds this value, a compact index of the
+        block graph is used, which is a dense matrix of 32-bit indices if the
+        block graph is dense enough, or a hash table otherwise. Otherwise a
+        dense matrix of edges will be used.
 
     """
 
@@ -578,6 +624,51 @@ class BlockState(object):
             ps.update(nps)
             for i, (k, v) in enumerate(ps.items()):
                 ws[i] = v
+        self._entropy_cache = None
+
+    def set_neighbor_hist(self, enabled=True):
+        r"""Enable or disable the caching of per-vertex histograms of the
+        neighbors' blocks.
+
+        If enabled, the neighbor-block distribution of every vertex is kept
+        up-to-date as vertices change blocks, and is used to sample move
+        proposals, compute their probabilities, and obtain the affected entries
+        of the block matrix, in time proportional to the number of distinct
+        neighboring blocks, rather than the degree of the vertex. This speeds up
+        sweeps over graphs with high-degree vertices, at the expense of
+        additional memory and a slightly larger cost per accepted move.
+
+        The histograms are only used for states without edge covariates.
+        """
+        self._state.set_neighbor_hist(enabled)
+
+    def set_prune_block_edges(self, enabled=True):
+        r"""Enable or disable the removal of edges of the block graph
+        (:attr:`~graph_tool.inference.BlockState.bg`) when the number of edges
+        between the corresponding pair of blocks drops to zero.
+
+        By default, an edge of the block graph is kept once created, so that
+        the block graph accumulates all block pairs that were ever occupied
+        during the sweeps. If enabled, the block graph only contains the
+        occupied pairs, and the indices of the removed edges are reused. This
+        also enables fast edge removal in the block graph (see
+        :meth:`~graph_tool.Graph.set_fast_edge_removal`), so that each removal
+        takes :math:`O(1)` time.
+
+        The edges are not removed for states with edge covariates, or while the
+        state is coupled to another one (e.g. during sweeps of a
+        :class:`~graph_tool.inference.NestedBlockState`).
+
+        .. warning::
+
+           This should not be enabled if the block graph is being used by
+           another state, e.g. one obtained via
+           :meth:`~graph_tool.inference.BlockState.get_block_state`, since
+           its edges would be removed underneath it.
+        """
+        if enabled:
+            self.bg.set_fast_edge_removal(True)
+        self._state.set_prune_block_edges(enabled)
 
     def __repr__(self):
         return "<BlockState object with %d blocks (%d nonempty),%s%s for graph %s, at 0x%x>" % \
@@ -626,6 +717,10 @@ class BlockState(object):
                                Lrecdx=kwargs.pop("Lrecdx", self.Lrecdx.copy()),
                                epsilon=kwargs.pop("epsilon",self.epsilon.copy()),
                                **kwargs)
+            if self._state.get_neighbor_hist():
+                state.set_neighbor_hist(True)
+            if self._state.get_prune_block_edges():
+                state.set_prune_block_edges(True)
         else:
             state = OverlapBlockState(self.g if g is None else g,
                                       b=self.b.copy() if b is None else b,
@@ -908,6 +1003,35 @@ class BlockState(object):
         sizes :math:`n_r`."""
         return self.wr
 
+    # Number of sweeps after which the entropy tracked incrementally is
+    # computed again from scratch, to avoid the accumulation of rounding errors.
+    entropy_resync = 1000
+
+    def _get_entropy_key(self, entropy_args):
+        """Returns a hashable key identifying the entropy terms selected by
+        ``entropy_args``, or ``None`` if they cannot be cached."""
+        if _bm_test() or "callback" in entropy_args:
+            return None
+        eargs = dict(self._entropy_args, **entropy_args)
+        eargs.pop("test", None)
+        return (self.B,) + tuple(sorted(eargs.items()))
+
+    def _update_entropy_cache(self, entropy_args, mod_count, dS):
+        """Updates the tracked entropy value with the difference ``dS`` of a
+        sweep that used ``entropy_args``, and started when the modification
+        count of the state was ``mod_count``."""
+        cache = getattr(self, "_entropy_cache", None)
+        if cache is None:
+            return
+        key = self._get_entropy_key(entropy_args)
+        if (key != cache[0] or mod_count != cache[2] or
+            cache[3] + 1 >= self.entropy_resync):
+            self._entropy_cache = None
+            return
+        self._entropy_cache = (key, cache[1] + dS, self._state.get_mod_count(),
+                               cache[3] + 1)
+
+    @_cached_entropy
     def entropy(self, adjacency=True, dl=True, partition_dl=True,
                 degree_dl=True, degree_dl_kind="distributed", edges_dl=True,
                 dense=False, multigraph=True, deg_entropy=True,
@@ -1219,6 +1343,38 @@ class BlockState(object):
             self._state.move_vertices(numpy.asarray(v, dtype="uint64"),
                                       numpy.asarray(s, dtype="uint64"))
 
+    def snapshot(self):
+        r"""Returns a checkpoint of the current partition, that can be passed
+        later to :meth:`~graph_tool.inference.BlockState.restore`.
+
+        After this is called, the state keeps a log of all subsequent vertex
+        moves (including those done by the MCMC sweeps), which is used to undo
+        them. This is much cheaper than :meth:`~graph_tool.inference.BlockState.copy`,
+        since only the moved vertices need to be updated.
+
+        .. note::
+
+           Only the vertex moves are recorded; vertex merges, removals and
+           additions done via
+           :meth:`~graph_tool.inference.BlockState.merge_vertices`,
+           :meth:`~graph_tool.inference.BlockState.remove_vertex` and
+           :meth:`~graph_tool.inference.BlockState.add_vertex` are not
+           undone. The log is released with
+           :meth:`~graph_tool.inference.BlockState.clear_snapshots`.
+        """
+        return self._state.snapshot()
+
+    def restore(self, s):
+        r"""Undoes all vertex moves done after the checkpoint ``s`` was
+        obtained with :meth:`~graph_tool.inference.BlockState.snapshot`. The
+        checkpoints taken after ``s`` become invalid, but ``s`` and the ones
+        taken before it remain valid."""
+        self._state.restore(s)
+
+    def clear_snapshots(self):
+        r"""Stops recording vertex moves, and invalidates all checkpoints."""
+        self._state.clear_snapshots()
+
     def remove_vertex(self, v):
         r"""Remove vertex ``v`` from its current group.
 
@@ -1397,7 +1553,8 @@ class BlockState(object):
 
     def mcmc_sweep(self, beta=1., c=1., d=.1, niter=1, entropy_args={},
                    allow_vacate=True, sequential=True, deterministic=False,
-                   parallel=False, vertices=None, verbose=False, **kwargs):
+                   parallel=False, schedule="uniform", min_weight=.1,
+                   vertices=None, verbose=False, **kwargs):
         r"""Perform ``niter`` sweeps of a Metropolis-Hastings acceptance-rejection
         sampling MCMC to sample network partitions.
 
@@ -1437,6 +1594,24 @@ class BlockState(object):
 
                If ``parallel == True``, the asymptotic exactness of the MCMC
                sampling is not guaranteed.
+        schedule : ``str`` (optional, default: ``"uniform"``)
+            How the vertices are chosen for move attempts. If
+            ``schedule == "uniform"``, they are chosen according to
+            ``sequential`` and ``deterministic``. Otherwise, they are sampled
+            with a probability proportional to ``min_weight`` plus their
+            recent activity, which is set to one when the vertex or one of its
+            neighbors is moved, and is halved whenever a move attempt of the
+            vertex fails. The activities are kept between calls, so that the
+            vertices that have stopped moving are attempted less often. If
+            ``schedule == "adaptive"``, the sampling probabilities are only
+            updated at the end of each sweep, so that each individual move
+            satisfies detailed balance. If ``schedule == "greedy"``, they are
+            updated after every move attempt, which concentrates the attempts
+            more strongly, but does not preserve detailed balance.
+        min_weight : ``float`` (optional, default: ``.1``)
+            Minimum sampling weight of inactive vertices, relative to a weight
+            of ``1 + min_weight`` for the most active ones. Only has an effect
+            if ``schedule != "uniform"``.
         vertices : ``list`` of ints (optional, default: ``None``)
             If provided, this should be a list of vertices which will be
             moved. Otherwise, all vertices will.
@@ -1482,6 +1657,13 @@ class BlockState(object):
         mcmc_state.vlist.a = vertices
         mcmc_state.E = self.get_E()
         mcmc_state.state = self._state
+        schedules = ["uniform", "adaptive", "greedy"]
+        if schedule not in schedules:
+            raise ValueError("invalid schedule: " + str(schedule))
+        mcmc_state.schedule = schedules.index(schedule)
+        if getattr(self, "_sweep_activity", None) is None:
+            self._sweep_activity = Vector_double()
+        mcmc_state.activity = self._sweep_activity
 
         dispatch = kwargs.pop("dispatch", True)
         test = kwargs.pop("test", True)
@@ -1489,10 +1671,12 @@ class BlockState(object):
             if _bm_test() and test:
                 assert self._check_clabel(), "invalid clabel before sweep"
                 Si = self.entropy(**entropy_args)
+            mod_count = self._state.get_mod_count()
             try:
                 dS, nmoves = self._mcmc_sweep_dispatch(mcmc_state)
             finally:
                 self.B = max(int(self.b.fa.max()) + 1, self.B)
+            self._update_entropy_cache(entropy_args, mod_count, dS)
 
             if _bm_test() and test:
                 Sff = self.entropy(**dmask(entropy_args, ["callback"]))
@@ -1518,7 +1702,8 @@ class BlockState(object):
 
     def multiflip_mcmc_sweep(self, a=1., beta=1., c=1., d=.1, niter=1,
                              entropy_args={}, allow_vacate=True,
-                             sequential=True, verbose=False, **kwargs):
+                             sequential=True, parallel=False, verbose=False,
+                             **kwargs):
         r"""Perform ``niter`` sweeps of a Metropolis-Hastings acceptance-rejection
         sampling MCMC with multiple simultaneous moves to sample network
         partitions.
@@ -1547,6 +1732,16 @@ class BlockState(object):
             :meth:`graph_tool.inference.BlockState.entropy`.
         allow_vacate : ``bool`` (optional, default: ``True``)
             Allow groups to be vacated.
+        parallel : ``bool`` (optional, default: ``False``)
+            If ``parallel == True``, the moves of groups of nodes are proposed
+            and evaluated in parallel, and are then applied in sequence. A
+            move is evaluated again before it is applied if it involves a
+            group affected by a previous move.
+
+            .. warning::
+
+               If ``parallel == True``, the asymptotic exactness of the MCMC
+               sampling is not guaranteed.
         verbose : ``bool`` (optional, default: ``False``)
             If ``verbose == True``, detailed information will be displayed.
 
@@ -1593,10 +1788,12 @@ class BlockState(object):
 
             nmoves = -(mcmc_state.maccept.a * arange(len(mcmc_state.maccept.a))).sum()
 
+            mod_count = self._state.get_mod_count()
             try:
                 dS, rnmoves = self._multiflip_mcmc_sweep_dispatch(mcmc_state)
             finally:
                 self.B = max(int(self.b.fa.max()) + 1, self.B)
+            self._update_entropy_cache(entropy_args, mod_count, dS)
 
             nmoves += (mcmc_state.maccept.a * arange(len(mcmc_state.maccept.a))).sum()
 
@@ -1705,10 +1902,12 @@ class BlockState(object):
             assert self._check_clabel(), "invalid clabel before sweep"
             Si = self.entropy(**entropy_args)
 
+        mod_count = self._state.get_mod_count()
         try:
             dS, nmoves, nattempts = self._gibbs_sweep_dispatch(gibbs_state)
         finally:
             self.B = max(int(self.b.fa.max()) + 1, self.B)
+        self._update_entropy_cache(entropy_args, mod_count, dS)
 
         if _bm_test() and test:
             assert self._check_clabel(), "invalid clabel after sweep"
@@ -1732,7 +1931,8 @@ class BlockState(object):
             return libinference.multicanonical_sweep(multicanonical_state,
                                                      self._state, _get_rng())
 
-    def multicanonical_sweep(self, m_state, multiflip=False, **kwargs):
+    def multicanonical_sweep(self, m_state, multiflip=False, window=None,
+                             **kwargs):
         r"""Perform ``niter`` sweeps of a non-Markovian multicanonical sampling using the
         Wang-Landau algorithm.
 
@@ -1744,6 +1944,12 @@ class BlockState(object):
         multiflip : ``bool`` (optional, default: ``False``)
             If ``True``, ``multiflip_mcmc_sweep()`` will be used, otherwise
             ``mcmc_sweep()``.
+        window : pair of ``float`` (optional, default: ``None``)
+            If given, the sampling is restricted to the entropy window
+            ``(S_lo, S_hi)``, and the density of states is only updated inside
+            it. If the state lies outside the window, only moves that do not
+            take it further away are accepted. If not given, the whole range
+            of ``m_state`` is used.
         **kwargs : Keyword parameter list
             The remaining parameters will be passed to
             ``multiflip_mcmc_sweep()`` or ``mcmc_sweep()``.
@@ -1771,7 +1977,7 @@ class BlockState(object):
         kwargs["sequential"] = False
         kwargs["beta"] = 1
 
-        args = dmask(locals(), ["self", "kwargs"])
+        args = dmask(locals(), ["self", "kwargs", "window"])
         multi_state = DictState(args)
 
         entropy_args = kwargs.get("entropy_args", {})
@@ -1792,6 +1998,9 @@ class BlockState(object):
         multi_state.S_max = m_state._S_max
         multi_state.hist = m_state._hist
         multi_state.dens = m_state._density
+        if window is None:
+            window = (m_state._S_min, m_state._S_max)
+        multi_state.w_min, multi_state.w_max = window
 
         if (multi_state.S < multi_state.S_min or
             multi_state.S > multi_state.S_max):
@@ -1827,7 +2036,8 @@ class BlockState(object):
                                                     hist[1], hist[2])
 
     def exhaustive_sweep(self, entropy_args={}, callback=None, density=None,
-                         vertices=None, initial_partition=None, max_iter=None):
+                         vertices=None, initial_partition=None, max_iter=None,
+                         nthreads=None):
         r"""Perform an exhaustive loop over all possible network partitions.
 
         Parameters
@@ -1854,6 +2064,10 @@ class BlockState(object):
             iteration.
         max_iter : ``int`` (optional, default: ``None``)
             If provided, this will limit the total number of iterations.
+        nthreads : ``int`` (optional, default: ``None``)
+            Number of threads used to compute the density of states, if
+            ``density`` is given and ``max_iter`` is not. If not provided, the
+            number of OpenMP threads is used.
 
         Returns
         -------
@@ -1876,26 +2090,38 @@ class BlockState(object):
         This algorithm has an :math:`O(B^N)` complexity, where :math:`B` is the
         number of blocks, and :math:`N` is the number of vertices.
 
+        When computing the density of states, the enumeration is split among
+        several threads by fixing the blocks of the last vertices in
+        ``vertices``, with each thread working on a separate copy of the state,
+        and accumulating its own histogram.
+
         """
 
-        exhaustive_state = DictState(dict(max_iter=max_iter if max_iter is not None else 0))
-        entropy_args = dict(self._entropy_args, **entropy_args)
-        exhaustive_state.entropy_args = get_entropy_args(entropy_args)
-        exhaustive_state.vlist = Vector_size_t()
-        if vertices is None:
-            vertices = self.g.vertex_index.copy().fa
-            if self.is_weighted:
-                # ignore vertices with zero weight
-                vw = self.vweight.fa
-                vertices = vertices[vw > 0]
-        if initial_partition is None:
-            initial_partition = zeros(len(vertices), dtype="uint64")
-        self.move_vertex(vertices, initial_partition)
-        exhaustive_state.vlist.resize(len(vertices))
-        exhaustive_state.vlist.a = vertices
-        exhaustive_state.S = self.entropy(**entropy_args)
-        exhaustive_state.state = self._state
-        exhaustive_state.b_min = b_min = self.g.new_vp("int32_t")
+        if (density is not None and callback is None and max_iter is None
+            and nthreads != 1):
+            if nthreads is None:
+                nthreads = openmp_get_num_threads()
+            if vertices is None:
+                vertices = self.g.vertex_index.copy().fa
+                if self.is_weighted:
+                    vertices = vertices[self.vweight.fa > 0]
+            vertices = numpy.asarray(vertices, dtype="int64")
+            if initial_partition is None:
+                initial_partition = zeros(len(vertices), dtype="uint64")
+            initial_partition = numpy.asarray(initial_partition, dtype="uint64")
+            B = self.bg.num_vertices()
+            k = 0
+            while B ** k < 4 * nthreads and k < len(vertices) - 1:
+                k += 1
+            if nthreads > 1 and k > 0:
+                return self._exhaustive_dens_parallel(entropy_args, density,
+                                                      vertices,
+                                                      initial_partition, B, k,
+                                                      nthreads)
+
+        exhaustive_state, b_min = \
+            self._get_exhaustive_state(entropy_args, vertices,
+                                       initial_partition, max_iter)
 
         if density is not None:
             density = (density[0], density[1],
@@ -1918,6 +2144,54 @@ class BlockState(object):
         else:
             return b_min
 
+    def _get_exhaustive_state(self, entropy_args, vertices, initial_partition,
+                              max_iter):
+        exhaustive_state = DictState(dict(max_iter=max_iter if max_iter is not None else 0))
+        entropy_args = dict(self._entropy_args, **entropy_args)
+        exhaustive_state.entropy_args = get_entropy_args(entropy_args)
+        exhaustive_state.vlist = Vector_size_t()
+        if vertices is None:
+            vertices = self.g.vertex_index.copy().fa
+            if self.is_weighted:
+                # ignore vertices with zero weight
+                vw = self.vweight.fa
+                vertices = vertices[vw > 0]
+        if initial_partition is None:
+            initial_partition = zeros(len(vertices), dtype="uint64")
+        self.move_vertex(vertices, initial_partition)
+        exhaustive_state.vlist.resize(len(vertices))
+        exhaustive_state.vlist.a = vertices
+        exhaustive_state.S = self.entropy(**entropy_args)
+        exhaustive_state.state = self._state
+        exhaustive_state.b_min = b_min = self.g.new_vp("int32_t")
+        return exhaustive_state, b_min
+
+    def _exhaustive_dens_parallel(self, entropy_args, density, vertices,
+                                  initial_partition, B, k, nthreads):
+        n = len(vertices) - k
+        prefixes = list(itertools.product(range(B), repeat=k))
+
+        def sweep(i):
+            state = self.copy(B=B)
+            state.move_vertex(vertices[n:], prefixes[i])
+            exhaustive_state, b_min = \
+                state._get_exhaustive_state(entropy_args, vertices[:n],
+                                            initial_partition[:n], None)
+            hist = numpy.zeros(density[2], dtype="uint64")
+            S_min = state._exhaustive_sweep_dispatch(exhaustive_state, None,
+                                                     (density[0], density[1],
+                                                      hist))
+            return hist, S_min, b_min
+
+        rets = _parallel_map(sweep, [None] * len(prefixes), nthreads)
+
+        self.move_vertex(vertices, initial_partition)
+
+        hist = sum(r[0] for r in rets)
+        S_min, b_min = min(((r[1], r[2]) for r in rets), key=lambda x: x[0])
+        Ss = numpy.linspace(density[0], density[1], len(hist))
+        return (Ss, hist), b_min
+
     def _merge_sweep_dispatch(self, merge_state):
         if not self.is_weighted:
             raise ValueError("state must be weighted to perform merges")
@@ -2136,7 +2410,8 @@ class BlockState(object):
                                       update)
         return p
 
-    def collect_partition_histogram(self, h=None, update=1, unlabel=True):
+    def collect_partition_histogram(self, h=None, update=1, unlabel=True,
+                                    hashed=False):
         r"""Collect a histogram of partitions.
 
         This should be called multiple times, e.g. after repeated runs of the
@@ -2152,10 +2427,15 @@ class BlockState(object):
         unlabel : bool (optional, default: ``True``)
             If ``True``, the partition will be relabeled so that only one entry
             for all its label permutations will be considered in the histogram.
+        hashed : bool (optional, default: ``False``)
+            If ``True`` and ``h`` is not given, a
+            :class:`~graph_tool.inference.PartitionHashHist` will be created,
+            which stores only a 64-bit hash of each partition, instead of a full
+            copy.
 
         Returns
         -------
-        h : :class:`~graph_tool.inference.PartitionHist` (optional, default: ``None``)
+        h : :class:`~graph_tool.inference.PartitionHist` or :class:`~graph_tool.inference.PartitionHashHist`
             Updated Partition histogram.
 
         Examples
@@ -2180,7 +2460,7 @@ class BlockState(object):
         """
 
         if h is None:
-            h = PartitionHist()
+            h = PartitionHashHist() if hashed else PartitionHist()
         libinference.collect_partitions(_prop("v", self.g, self.b),
                                         h, update, unlabel)
         return h
@@ -2468,7 +2748,7 @@ def microstate_entropy(h, unlabel=True):
 
     Parameters
     ----------
-    h : :class:`~graph_tool.inference.PartitionHist` (optional, default: ``None``)
+    h : :class:`~graph_tool.inference.PartitionHist` or :class:`~graph_tool.inference.PartitionHashHist`
         Partition histogram.
     unlabel : bool (optional, default: ``True``)
         If ``True``, it is assumed that partition were relabeled so that only
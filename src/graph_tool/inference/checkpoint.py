@@ -0,0 +1,221 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# graph_tool -- a general graph manipulation python module
+#
+# Copyright (C) 2006-2017 Tiago de Paula Peixoto <tiago@skewed.de>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+from __future__ import division, absolute_import, print_function
+import sys
+if sys.version_info < (3,):
+    range = xrange
+
+from .. import _get_rng
+from .. dl_import import dl_import
+dl_import("from . import libgraph_tool_inference as libinference")
+
+import mmap
+import numpy
+
+from . nested_blockmodel import NestedBlockState
+
+_magic = b"GTCKPT01"
+_writer = None
+
+def _get_writer():
+    global _writer
+    if _writer is None:
+        _writer = libinference.CheckpointWriter()
+    return _writer
+
+def _state_arrays(state):
+    arrays = []
+    if isinstance(state, NestedBlockState):
+        bs = state.get_bs()
+        arrays.append(("nested_L", numpy.array([len(bs)], dtype="int64")))
+        for l, b in enumerate(bs):
+            arrays.append(("b_%d" % l, numpy.asarray(b, dtype="int32")))
+    else:
+        arrays.append(("b", numpy.asarray(state.b.fa, dtype="int32")))
+        for i, ps in enumerate(getattr(state, "wparams", [])):
+            arrays.append(("wparams_%d" % i, numpy.array(ps.a)))
+    return arrays
+
+def _m_state_arrays(m_state):
+    return [("mc_density", numpy.array(m_state._density.a)),
+            ("mc_hist", numpy.array(m_state._hist.a)),
+            ("mc_perm_hist", numpy.array(m_state._perm_hist)),
+            ("mc_range", numpy.array([m_state._S_min, m_state._S_max],
+                                     dtype="float64")),
+            # the Wang-Landau modification factor, or NaN if not yet set
+            ("mc_f", numpy.array([numpy.nan if m_state._f is None
+                                  else m_state._f], dtype="float64"))]
+
+def save_checkpoint(path, state=None, m_state=None, arrays={}, rng=True,
+                    wait=False):
+    r"""Save a binary checkpoint of the inference state to ``path``.
+
+    Parameters
+    ----------
+    path : ``str``
+        Destination file.
+    state : Any block state class (optional, default: ``None``)
+        If given, its partition (and edge covariate hyperparameters, if any)
+        will be saved. For a :class:`~graph_tool.inference.NestedBlockState`
+        the partitions at every level are saved.
+    m_state : :class:`~graph_tool.inference.MulticanonicalState` (optional, default: ``None``)
+        If given, its density of states, histograms and current Wang-Landau
+        modification factor will be saved.
+    arrays : ``dict`` (optional, default: ``{}``)
+        Additional named arrays to be saved, e.g. marginal accumulators.
+    rng : ``bool`` (optional, default: ``True``)
+        If ``True``, the state of the global random number generator will be
+        saved.
+    wait : ``bool`` (optional, default: ``False``)
+        If ``True``, the function will only return after the file has been
+        written.
+
+    Notes
+    -----
+
+    All the data are copied before the function returns, and the file is
+    written by a background thread, so that the state may be modified
+    immediately afterwards. The file is first written to ``path + ".tmp"``, and
+    then renamed to ``path``, so that a previous checkpoint is never left in a
+    corrupt state. Only one write can be pending at a time; a further call
+    will wait for the previous one to finish.
+
+    The file consists of a sequence of named raw arrays aligned to 16 bytes, so
+    that :func:`~graph_tool.inference.load_checkpoint` can map them directly
+    into memory without parsing.
+    """
+    sections = []
+    if state is not None:
+        sections.extend(_state_arrays(state))
+    if m_state is not None:
+        sections.extend(_m_state_arrays(m_state))
+    for k, a in arrays.items():
+        sections.append(("array:" + k, numpy.asarray(a)))
+    if rng:
+        s = _get_rng().get_state().encode("ascii")
+        sections.append(("rng", numpy.frombuffer(s, dtype="uint8")))
+
+    sections = [(k, a.dtype.str, numpy.ascontiguousarray(a).tobytes())
+                for k, a in sections]
+    writer = _get_writer()
+    writer.write(path, sections)
+    if wait:
+        writer.wait()
+
+def wait_checkpoint():
+    r"""Wait until any pending checkpoint write has finished, and raise an
+    exception if it failed."""
+    _get_writer().wait()
+
+def _read_sections(path, use_mmap):
+    with open(path, "rb") as f:
+        if use_mmap:
+            buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        else:
+            buf = f.read()
+    if bytes(buf[:8]) != _magic:
+        raise ValueError("not a graph-tool checkpoint file: " + path)
+    u64 = numpy.dtype("uint64")
+    def get(pos):
+        return int(numpy.frombuffer(buf, dtype=u64, count=1, offset=pos)[0])
+    N = get(8)
+    pos = 16
+    sections = {}
+    for i in range(N):
+        l = get(pos)
+        name = bytes(buf[pos + 8:pos + 8 + l]).decode("utf-8")
+        pos += 8 + l
+        l = get(pos)
+        dtype = numpy.dtype(bytes(buf[pos + 8:pos + 8 + l]).decode("ascii"))
+        pos += 8 + l
+        nbytes = get(pos)
+        pos += 8
+        pos += (16 - pos % 16) % 16
+        sections[name] = numpy.frombuffer(buf, dtype=dtype,
+                                          count=nbytes // dtype.itemsize,
+                                          offset=pos)
+        pos += nbytes
+    return sections
+
+def load_checkpoint(path, state=None, m_state=None, rng=True, mmap=True):
+    r"""Load a binary checkpoint saved with
+    :func:`~graph_tool.inference.save_checkpoint`.
+
+    Parameters
+    ----------
+    path : ``str``
+        Checkpoint file.
+    state : Any block state class (optional, default: ``None``)
+        If given, a copy of this state with the partition (and hyperparameters)
+        stored in the checkpoint will be returned.
+    m_state : :class:`~graph_tool.inference.MulticanonicalState` (optional, default: ``None``)
+        If given, its density of states, histograms and Wang-Landau
+        modification factor will be overwritten with the values in the
+        checkpoint.
+    rng : ``bool`` (optional, default: ``True``)
+        If ``True``, the state of the global random number generator will be
+        restored.
+    mmap : ``bool`` (optional, default: ``True``)
+        If ``True``, the file will be memory-mapped, and the returned arrays
+        will be read-only views into it.
+
+    Returns
+    -------
+    state : Block state class
+        Restored state, if ``state`` was given, otherwise ``None``.
+    arrays : ``dict``
+        Additional arrays passed to
+        :func:`~graph_tool.inference.save_checkpoint`.
+    """
+    sections = _read_sections(path, mmap)
+
+    if state is not None:
+        if isinstance(state, NestedBlockState):
+            L = int(sections["nested_L"][0])
+            state = state.copy(bs=[numpy.array(sections["b_%d" % l])
+                                   for l in range(L)])
+        else:
+            b = state.g.new_vp("int32_t")
+            b.fa = sections["b"]
+            state = state.copy(b=b)
+            for i, ps in enumerate(getattr(state, "wparams", [])):
+                ps.a[:] = sections["wparams_%d" % i]
+            state._entropy_cache = None
+
+    if m_state is not None:
+        S_min, S_max = sections["mc_range"]
+        if len(m_state._hist.a) != len(sections["mc_hist"]):
+            m_state.__init__(m_state._g, S_min, S_max,
+                             len(sections["mc_hist"]))
+        m_state._S_min, m_state._S_max = S_min, S_max
+        m_state._density.a[:] = sections["mc_density"]
+        m_state._hist.a[:] = sections["mc_hist"]
+        m_state._perm_hist[:] = sections["mc_perm_hist"]
+        if "mc_f" in sections:
+            f = float(sections["mc_f"][0])
+            m_state._f = None if numpy.isnan(f) else f
+
+    if rng and "rng" in sections:
+        _get_rng().set_state(sections["rng"].tobytes().decode("ascii"))
+
+    arrays = dict((k[len("array:"):], a) for k, a in sections.items()
+                  if k.startswith("array:"))
+    return state, arrays
@@ -45,7 +45,7 @@ from .. generation import graph_union
 from .. stats import vertex_hist
 
 from . blockmodel import *
-from . blockmodel import _bm_test
+from . blockmodel import _bm_test, _cached_entropy
 from . overlap_blockmodel import *
 
 class LayeredBlockState(OverlapBlockState, BlockState):
@@ -785,6 +785,7 @@ class LayeredBlockState(OverlapBlockState, BlockState):
                     return False
         return True
 
+    @_cached_entropy
     def entropy(self, adjacency=True, dl=True, partition_dl=True,
                 degree_dl=True, degree_dl_kind="distributed", edges_dl=True,
                 dense=False, multigraph=True, deg_entropy=True, exact=True,
@@ -1051,11 +1052,11 @@ class LayeredBlockState(OverlapBlockState, BlockState):
                     return libinference.exhaustive_layered_sweep_iter(exhaustive_state,
                                                                       self._state)
                 else:
-                    return libinference.exhaustive_layered_sweep_dens(exhaustive_state,
-                                                                      self._state,
-                                                                      hist[0],
-                                                                      hist[1],
-                                                                      hist[2])
+                    return libinference.exhaustive_layered_dens(exhaustive_state,
+                                                                self._state,
+                                                                hist[0],
+                                                                hist[1],
+                                                                hist[2])
         else:
             if callback is not None:
                 return libinference.exhaustive_layered_overlap_sweep(exhaustive_state,
@@ -23,15 +23,20 @@ import sys
 if sys.version_info < (3,):
     range = xrange
 
-from .. import Vector_size_t, Vector_double
+from .. import Vector_size_t, Vector_double, libcore, _get_rng
 
 import numpy
 from . util import *
+from . util import _parallel_map
+
+from .. dl_import import dl_import
+dl_import("from . import libgraph_tool_inference as libinference")
 
 def mcmc_equilibrate(state, wait=1000, nbreaks=2, max_niter=numpy.inf,
                      force_niter=None, epsilon=0, gibbs=False, multiflip=False,
                      mcmc_args={}, entropy_args={}, history=False,
-                     callback=None, verbose=False):
+                     callback=None, checkpoint=None, checkpoint_interval=100,
+                     verbose=False):
     r"""Equilibrate a MCMC with a given starting state.
 
     Parameters
@@ -68,6 +73,12 @@ def mcmc_equilibrate(state, wait=1000, nbreaks=2, max_niter=numpy.inf,
         function must accept the current state as an argument, and its return
         value must be either `None` or a (possibly empty) list of values that
         will be append to the history, if ``history == True``.
+    checkpoint : ``str`` (optional, default: ``None``)
+        If given, a binary checkpoint of the state will be written to this file
+        every ``checkpoint_interval`` iterations, and at the end of the run,
+        using :func:`~graph_tool.inference.save_checkpoint`.
+    checkpoint_interval : ``int`` (optional, default: ``100``)
+        Number of iterations between checkpoints.
     verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
         If ``True``, progress information will be shown. Optionally, this
         accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
@@ -166,9 +177,17 @@ def mcmc_equilibrate(state, wait=1000, nbreaks=2, max_niter=numpy.inf,
         if history:
             hist.append(tuple([S, nmoves] + extra))
 
+        if checkpoint is not None and niter % checkpoint_interval == 0:
+            from . checkpoint import save_checkpoint
+            save_checkpoint(checkpoint, state)
+
         if niter >= max_niter:
             break
 
+    if checkpoint is not None:
+        from . checkpoint import save_checkpoint
+        save_checkpoint(checkpoint, state, wait=True)
+
     if history:
         return hist
     else:
@@ -370,6 +389,328 @@ def mcmc_multilevel(state, B, r=2, b_cache=None, anneal=False,
             b_cache[B_next] = (state.entropy(**entropy_args), state)
     return state
 
+def mcmc_online_update(state, edges, niter=1, hops=1, global_interval=10,
+                       global_niter=1, mcmc_args={}, verbose=False):
+    r"""Incorporate a batch of new edges into a partition, and refine it with
+    MCMC sweeps localized around the modified region.
+
+    Parameters
+    ----------
+    state : :class:`~graph_tool.inference.BlockState`
+        State to be updated. The underlying graph will be modified by
+        the addition of the new edges.
+    edges : iterable of pairs of ints
+        New edges, given as ``(source, target)`` pairs. Vertex indices larger or
+        equal to the current number of vertices will cause new vertices to be
+        added to the graph.
+    niter : ``int`` (optional, default: ``1``)
+        Number of localized sweeps to perform.
+    hops : ``int`` (optional, default: ``1``)
+        The localized sweeps will include every vertex within this number of
+        hops from the endpoints of the new edges.
+    global_interval : ``int`` (optional, default: ``10``)
+        After every ``global_interval`` calls for the same state, ``global_niter``
+        sweeps over all vertices will also be performed. If ``0``, global sweeps
+        are never performed.
+    global_niter : ``int`` (optional, default: ``1``)
+        Number of global sweeps performed periodically.
+    mcmc_args : ``dict`` (optional, default: ``{}``)
+        Arguments to be passed to ``state.mcmc_sweep``.
+    verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
+        If ``True``, progress information will be shown. Optionally, this
+        accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
+        where ``level`` is a positive integer that specifies the level of
+        detail, and ``prefix`` is a string that is prepended to the all output
+        messages.
+
+    Returns
+    -------
+    state : :class:`~graph_tool.inference.BlockState`
+        The updated state. This is the same object as the one given, unless new
+        vertices were added, in which case a new state is constructed.
+    dS : ``float``
+        Entropy difference of the sweeps performed (excluding the change due to
+        the new edges themselves).
+    nmoves : ``int``
+        Number of vertices moved.
+
+    Notes
+    -----
+    The endpoints of the new edges are temporarily removed from their groups,
+    the edges are added to the graph, and the endpoints are returned to their
+    groups, so that the state remains consistent without being rebuilt. New
+    vertices are placed in the group of one of their neighbors (if any), and
+    then the whole state is rebuilt, which requires :math:`O(N + E)` time.
+
+    Only states without edge weights or covariates that are not coupled to
+    upper levels of a hierarchy are supported.
+    """
+
+    from . blockmodel import BlockState
+
+    if type(state) is not BlockState:
+        raise ValueError("online updates require a plain BlockState, not: " +
+                         str(type(state)))
+    if (state.is_weighted or len(state.rec_types) > 0 or
+        getattr(state, "_coupled_state", None) is not None):
+        raise ValueError("online updates are not supported for weighted, " +
+                         "covariate or hierarchical states")
+
+    g = state.g
+    edges = numpy.asarray(edges, dtype="int64").reshape((-1, 2))
+    if len(edges) == 0:
+        return state, 0., 0
+
+    N = g.num_vertices()
+    N_new = max(int(edges.max()) + 1, N)
+
+    if N_new == N:
+        vs = numpy.unique(edges)
+        bs = state.b.fa[vs].copy()
+        state.remove_vertex(vs)
+        g.add_edge_list(edges)
+        state.add_vertex(vs, bs)
+        state._state.rebuild_neighbor_sampler()
+        state._state.clear_egroups()
+        if state._state.is_partition_stats_enabled():
+            state._state.disable_partition_stats()
+            state._state.enable_partition_stats()
+    else:
+        count = getattr(state, "_online_count", 0)
+        g.add_vertex(N_new - N)
+        g.add_edge_list(edges)
+
+        # place the new vertices in the group of an already placed neighbor,
+        # propagating through chains of new vertices
+        b = state.b.copy()
+        b.a[N:] = -1
+        changed = True
+        while changed:
+            changed = False
+            for u, v in edges:
+                for x, y in ((u, v), (v, u)):
+                    if b[x] == -1 and b[y] != -1:
+                        b[x] = b[y]
+                        changed = True
+        ba = b.a
+        if (ba == -1).any():
+            ba[ba == -1] = numpy.bincount(ba[:N]).argmax()
+
+        merge_map = state.merge_map.copy()
+        merge_map.a[N:] = numpy.arange(N, N_new)
+
+        state = state.copy(b=b, B=state.B, merge_map=merge_map)
+        state._online_count = count
+
+    region = set(int(v) for v in numpy.unique(edges))
+    frontier = list(region)
+    for h in range(hops):
+        nfrontier = []
+        for v in frontier:
+            for u in g.vertex(v).all_neighbors():
+                u = int(u)
+                if u not in region:
+                    region.add(u)
+                    nfrontier.append(u)
+        frontier = nfrontier
+
+    dS, nmoves = state.mcmc_sweep(**dict(mcmc_args, niter=niter,
+                                         vertices=sorted(region)))
+    if check_verbose(verbose):
+        print(verbose_pad(verbose) +
+              u"local sweep: %d vertices  ΔS: %#12.6g  moves: %5d" %
+              (len(region), dS, nmoves))
+
+    state._online_count = getattr(state, "_online_count", 0) + 1
+    if global_interval > 0 and state._online_count % global_interval == 0:
+        gdS, gnmoves = state.mcmc_sweep(**dict(mcmc_args,
+                                               niter=global_niter))
+        dS += gdS
+        nmoves += gnmoves
+        if check_verbose(verbose):
+            print(verbose_pad(verbose) +
+                  u"global sweep:  ΔS: %#12.6g  moves: %5d" % (gdS, gnmoves))
+
+    return state, dS, nmoves
+
+
+def mcmc_chains(state, nchains=16, niter=1000, gibbs=False, multiflip=False,
+                mcmc_args={}, marginals=False, callback=None, nthreads=None,
+                verbose=False):
+    r"""Run several independent MCMC chains starting from the same state,
+    concurrently, and gather their results.
+
+    Parameters
+    ----------
+    state : Any state class (e.g. :class:`~graph_tool.inference.BlockState`)
+        Initial state. This state is not modified; each chain runs on a copy,
+        obtained via ``state.copy()``.
+    nchains : ``int`` (optional, default: ``16``)
+        Number of chains.
+    niter : ``int`` (optional, default: ``1000``)
+        Number of sweeps performed by each chain.
+    gibbs : ``bool`` (optional, default: ``False``)
+        If ``True``, each step will call ``state.gibbs_sweep`` instead of
+        ``state.mcmc_sweep``.
+    multiflip : ``bool`` (optional, default: ``False``)
+        If ``True``, each step will call ``state.multiflip_mcmc_sweep`` instead
+        of ``state.mcmc_sweep``.
+    mcmc_args : ``dict`` (optional, default: ``{}``)
+        Arguments to be passed to the sweep function. The entropy arguments in
+        ``mcmc_args["entropy_args"]`` are also used for the initial entropy.
+    marginals : ``bool`` (optional, default: ``False``)
+        If ``True``, the vertex marginals of each chain will be collected after
+        every sweep, via ``state.collect_vertex_marginals()``.
+    callback : ``function`` (optional, default: ``None``)
+        If given, this function will be called after each sweep of every chain,
+        as ``callback(i, state)``, where ``i`` is the chain index.
+    nthreads : ``int`` (optional, default: ``None``)
+        Number of threads used to run the chains. If not given, one thread per
+        chain is used.
+    verbose : ``bool`` (optional, default: ``False``)
+        If ``True``, progress information will be shown.
+
+    Returns
+    -------
+    S : :class:`~numpy.ndarray` of shape ``(nchains, niter + 1)``
+        Entropy trace of each chain, starting with the initial entropy.
+    nmoves : :class:`~numpy.ndarray` of shape ``(nchains, niter)``
+        Number of nodes moved in each sweep of each chain.
+    states : ``list`` of states
+        Final state of each chain.
+    pvs : ``list`` of :class:`~graph_tool.PropertyMap`
+        Vertex marginals of each chain. Only returned if ``marginals == True``.
+
+    Notes
+    -----
+    All chains belong to the same process, and their states are copies that
+    share the observed graph and its edge and vertex properties (including any
+    edge covariates), which are only read during the sweeps. Only the partition
+    and the quantities derived from it (e.g. the block graph and the matrix of
+    edge counts) are kept separately for each chain.
+
+    The chains run concurrently in separate threads, each with its own random
+    number generator, seeded from graph-tool's global one. Since the sweep
+    algorithms release the GIL, this uses one core per chain. The entropy
+    traces are computed incrementally from the entropy differences returned by
+    the sweeps.
+    """
+
+    if gibbs:
+        algo = "gibbs_sweep"
+    elif multiflip:
+        algo = "multiflip_mcmc_sweep"
+    else:
+        algo = "mcmc_sweep"
+
+    states = [state.copy() for i in range(nchains)]
+    rngs = [libcore.split_rng(_get_rng()) for i in range(nchains)]
+    S = numpy.zeros((nchains, niter + 1))
+    entropy_args = mcmc_args.get("entropy_args", {})
+    S[:, 0] = state.entropy(**entropy_args)
+    nmoves = numpy.zeros((nchains, niter), dtype="int")
+    pvs = [None] * nchains
+
+    def run(i):
+        st = states[i]
+        sweep = getattr(st, algo)
+        for j in range(niter):
+            ret = sweep(**dict(mcmc_args, entropy_args=dict(entropy_args)))
+            S[i, j + 1] = S[i, j] + ret[0]
+            nmoves[i, j] = ret[1]
+            if marginals:
+                pvs[i] = st.collect_vertex_marginals(pvs[i])
+            if callback is not None:
+                callback(i, st)
+        if check_verbose(verbose):
+            print(verbose_pad(verbose) +
+                  u"chain %d: S: %g, ΔS: %g" % (i, S[i, -1], S[i, -1] - S[i, 0]))
+
+    _parallel_map(run, rngs, nthreads)
+
+    if marginals:
+        return S, nmoves, states, pvs
+    return S, nmoves, states
+
+def set_sweep_stats(enabled=True, dS_hist=False, reset=True):
+    r"""Enable or disable the collection of telemetry in the sweep algorithms,
+    i.e. ``mcmc_sweep()``, ``multiflip_mcmc_sweep()``, ``gibbs_sweep()`` and
+    ``merge_sweep()`` of all state classes.
+
+    Parameters
+    ----------
+    enabled : ``bool`` (optional, default: ``True``)
+        If ``True``, the statistics will be collected.
+    dS_hist : ``bool`` (optional, default: ``False``)
+        If ``True``, a histogram of the entropy differences of the proposed
+        moves will be collected as well.
+    reset : ``bool`` (optional, default: ``True``)
+        If ``True``, the statistics collected so far will be discarded.
+
+    Notes
+    -----
+    The statistics are accumulated by each thread separately, and are summed
+    by :func:`~graph_tool.inference.get_sweep_stats`. When disabled, they
+    incur no measurable overhead.
+    """
+    libinference.set_sweep_stats(enabled, dS_hist)
+    if reset:
+        libinference.reset_sweep_stats()
+
+def get_sweep_stats(reset=False):
+    r"""Return the telemetry collected by the sweep algorithms since it was
+    enabled with :func:`~graph_tool.inference.set_sweep_stats`.
+
+    Parameters
+    ----------
+    reset : ``bool`` (optional, default: ``False``)
+        If ``True``, the statistics will be reset after they are returned.
+
+    Returns
+    -------
+    stats : ``dict``
+        Dictionary with the following keys:
+
+        ``"proposals"``
+            Number of move proposals made.
+        ``"null_moves"``
+            Number of proposals that were skipped, e.g. because the move is
+            not allowed.
+        ``"self_moves"``
+            Number of proposals to the current state of the node (for merge
+            sweeps, to a candidate already evaluated).
+        ``"accepted"``
+            Number of moves performed.
+        ``"acceptance"``
+            Fraction of the non-null proposals that were accepted.
+        ``"proposal_time"``, ``"dS_time"``, ``"move_time"``
+            Time in seconds spent proposing moves, computing their entropy
+            differences, and performing them, summed over all threads.
+        ``"dS_hist"``, ``"dS_bins"``
+            Histogram of the entropy differences of the proposals, and its bin
+            edges, which are logarithmically spaced powers of two with
+            :math:`|dS| \in [2^{-16}, 2^{16})`, with a central bin for
+            smaller values. Only present if enabled via
+            :func:`~graph_tool.inference.set_sweep_stats`.
+
+    Notes
+    -----
+    This should not be called while a sweep is running in another thread.
+    """
+    stats = libinference.get_sweep_stats()
+    hist = numpy.array(stats["dS_hist"], dtype="int64")
+    if hist.sum() > 0:
+        edges = 2. ** numpy.arange(-16, 16)
+        stats["dS_hist"] = hist
+        stats["dS_bins"] = numpy.concatenate(([-numpy.inf], -edges[::-1],
+                                              edges, [numpy.inf]))
+    else:
+        del stats["dS_hist"]
+    n = stats["proposals"] - stats["null_moves"]
+    stats["acceptance"] = stats["accepted"] / n if n > 0 else numpy.nan
+    if reset:
+        libinference.reset_sweep_stats()
+    return stats
 
 class MulticanonicalState(object):
     r"""The density of states of a multicanonical Monte Carlo algorithm. It is used
@@ -406,8 +747,9 @@ class MulticanonicalState(object):
         return state
 
     def __setstate__(self, state):
-        g, S_min, S_max, density, hist, phist, self._f = state
+        g, S_min, S_max, density, hist, phist, f = state
         self.__init__(g, S_min, S_max, len(hist))
+        self._f = f
         self._density.a[:] = density
         self._hist.a[:] = hist
         self._perm_hist[:] = phist
@@ -496,14 +838,18 @@ class MulticanonicalState(object):
 
 def multicanonical_equilibrate(state, m_state, f_range=(1., 1e-6), r=2,
                                flatness=.95, allow_gaps=True, callback=None,
-                               multicanonical_args={}, verbose=False):
+                               multicanonical_args={}, windows=None,
+                               nthreads=None, verbose=False):
     r"""Equilibrate a multicanonical Monte Carlo sampling using the Wang-Landau
     algorithm.
 
     Parameters
     ----------
-    state : Any state class (e.g. :class:`~graph_tool.inference.BlockState`)
-        Initial state. This state will be modified during the algorithm.
+    state : Any state class (e.g. :class:`~graph_tool.inference.BlockState`) or ``list`` of states
+        Initial state. This state will be modified during the algorithm. If a
+        list of states is given, each one is used as an independent walker,
+        and the walkers are run concurrently, sharing the same density of
+        states (see notes below).
     m_state :  :class:`~graph_tool.inference.MulticanonicalState`
         Initial multicanonical state, where the state density will be stored.
     f_range : ``tuple`` of two floats (optional, default: ``(1., 1e-6)``)
@@ -522,6 +868,12 @@ def multicanonical_equilibrate(state, m_state, f_range=(1., 1e-6), r=2,
     multicanonical_args : ``dict`` (optional, default: ``{}``)
         Arguments to be passed to ``state.multicanonical_sweep`` (e.g.
         :meth:`graph_tool.inference.BlockState.multicanonical_sweep`).
+    windows : ``list`` of pairs of ``float`` (optional, default: ``None``)
+        Entropy windows ``(S_lo, S_hi)`` of each walker, if a list of states is
+        given. If not given, all walkers sample the whole range of ``m_state``.
+    nthreads : ``int`` (optional, default: ``None``)
+        Maximum number of threads used to run the walkers. If not given, one
+        thread per walker is used.
     verbose : ``bool`` or ``tuple`` (optional, default: ``False``)
         If ``True``, progress information will be shown. Optionally, this
         accepts arguments of the type ``tuple`` of the form ``(level, prefix)``
@@ -535,6 +887,17 @@ def multicanonical_equilibrate(state, m_state, f_range=(1., 1e-6), r=2,
     niter : ``int``
         Number of iterations required for convergence.
 
+    Notes
+    -----
+
+    With several walkers, the histogram and density of states of ``m_state``
+    are updated concurrently by all of them, each with its own random number
+    generator, as in the replica-exchange Wang-Landau scheme of
+    [vogel-generic-2013]_. Each walker only updates the density inside its own
+    window, and after each iteration the windows of neighboring walkers are
+    exchanged whenever both walkers lie inside the window of the other. Since
+    the sweeps release the GIL, each walker runs on its own core.
+
     References
     ----------
 
@@ -546,24 +909,59 @@ def multicanonical_equilibrate(state, m_state, f_range=(1., 1e-6), r=2,
        "Wang-Landau algorithm: A theoretical analysis of the saturation of
        the error", J. Chem. Phys. 127, 184105 (2007),
        :doi:`10.1063/1.2803061`, :arxiv:`cond-mat/0702414`
+    .. [vogel-generic-2013] Thomas Vogel, Ying Wai Li, Thomas Wüst, David
+       P. Landau, "Generic, hierarchical framework for massively parallel
+       Wang-Landau sampling", Phys. Rev. Lett. 110, 210603 (2013),
+       :doi:`10.1103/PhysRevLett.110.210603`, :arxiv:`1305.1585`
     """
 
+    walkers = isinstance(state, (list, tuple))
+    if walkers:
+        states = list(state)
+        if windows is None:
+            windows = [(m_state._S_min, m_state._S_max)] * len(states)
+        windows = list(windows)
+        if len(windows) != len(states):
+            raise ValueError("states and windows must be of the same size")
+        rngs = [libcore.split_rng(_get_rng()) for s in states]
+        eargs = multicanonical_args.get("entropy_args", {})
+
     count = 0
     if m_state._f is None:
         m_state._f = f_range[0]
     while m_state._f >= f_range[1]:
-        state.multicanonical_sweep(m_state, **multicanonical_args)
+        if walkers:
+            def sweep(i):
+                return states[i].multicanonical_sweep(m_state,
+                                                      window=windows[i],
+                                                      **multicanonical_args)
+            _parallel_map(sweep, rngs, nthreads)
+
+            Ss = [s.entropy(**eargs) for s in states]
+            for i in range(len(states) - 1):
+                if (windows[i + 1][0] <= Ss[i] < windows[i + 1][1] and
+                    windows[i][0] <= Ss[i + 1] < windows[i][1]):
+                    for x in [states, rngs, Ss]:
+                        x[i], x[i + 1] = x[i + 1], x[i]
+        else:
+            state.multicanonical_sweep(m_state, **multicanonical_args)
         hf = m_state.get_flatness(allow_gaps=allow_gaps)
 
         if callback is not None:
             callback(state, m_state)
 
         if check_verbose(verbose):
-            print(verbose_pad(verbose) +
-                  "count: %d  f: %#8.8g  flatness: %#8.8g  nonempty bins: %d  S: %#8.8g  B: %d" % \
-                  (count, m_state._f, hf, (m_state._hist.a > 0).sum(),
-                   state.entropy(**multicanonical_args.get("entropy_args", {})),
-                   state.get_nonempty_B()))
+            if walkers:
+                print(verbose_pad(verbose) +
+                      "count: %d  f: %#8.8g  flatness: %#8.8g  nonempty bins: %d  S: (%#8.8g, %#8.8g)" % \
+                      (count, m_state._f, hf, (m_state._hist.a > 0).sum(),
+                       min(Ss), max(Ss)))
+            else:
+                print(verbose_pad(verbose) +
+                      "count: %d  f: %#8.8g  flatness: %#8.8g  nonempty bins: %d  S: %#8.8g  B: %d" % \
+                      (count, m_state._f, hf, (m_state._hist.a > 0).sum(),
+                       state.entropy(**multicanonical_args.get("entropy_args", {})),
+                       state.get_nonempty_B()))
 
         if hf > flatness:
             m_state._f /= r
@@ -588,21 +986,60 @@ class TemperingState(object):
         Initial parallel states.
     betas : list of floats
         Inverse temperature values.
+    nthreads : ``int`` (optional, default: ``None``)
+        Number of threads used to sweep the replicas concurrently. If not
+        given, one thread per replica is used.
+
+    Notes
+    -----
+    The replicas are swept concurrently in separate threads, each with its own
+    random number generator, seeded from graph-tool's global one. Since the
+    sweep algorithms release the GIL, this uses one core per replica. Swaps
+    exchange the temperatures of neighboring replicas, and the entropy of each
+    replica is tracked incrementally from the entropy differences of the
+    sweeps, so that no full entropy computation is needed for the swaps. The
+    number of attempted and accepted swaps between each pair of neighboring
+    temperatures are kept in the attributes ``swap_attempts`` and
+    ``swap_accepts``.
     """
 
-    def __init__(self, states, betas):
+    def __init__(self, states, betas, nthreads=None):
         if not (len(states) == len(betas)):
             raise ValueError("states and betas must be of the same size")
         self.states = states
         self.betas = betas
+        self.nthreads = nthreads
+        self.rngs = [libcore.split_rng(_get_rng()) for s in states]
+        self.swap_attempts = numpy.zeros(max(len(states) - 1, 0), dtype="int")
+        self.swap_accepts = numpy.zeros(max(len(states) - 1, 0), dtype="int")
+        self._S = None
+        self._S_args = None
+
+    def __getstate__(self):
+        # the per-replica generators are not pickled, and are seeded again
+        # from the global one
+        state = dict(self.__dict__)
+        del state["rngs"]
+        return state
+
+    def __setstate__(self, state):
+        self.__dict__.update(state)
+        self.rngs = [libcore.split_rng(_get_rng()) for s in self.states]
 
     def entropy(self, **kwargs):
         """Returns the weighted sum of the entropy of the parallel states. All keyword
         arguments are propagated to the individual states' `entropy()`
-        method.
+        method. This also resets the entropy values tracked for the swaps.
         """
-        return sum(beta * s.entropy(**kwargs) for
-                   s, beta in zip(self.states, self.betas))
+        self._S = [s.entropy(**kwargs) for s in self.states]
+        self._S_args = dict(kwargs)
+        return sum(beta * S for S, beta in zip(self._S, self.betas))
+
+    def _get_S(self, eargs):
+        if self._S is None or self._S_args != eargs:
+            self._S = [s.entropy(**eargs) for s in self.states]
+            self._S_args = dict(eargs)
+        return self._S
 
     def states_swap(self, **kwargs):
         """Perform a full sweep of the parallel states, where swaps are attempted. All
@@ -612,46 +1049,53 @@ class TemperingState(object):
         verbose = kwargs.get("verbose", False)
         eargs = kwargs.get("entropy_args", {})
 
+        S = self._get_S(eargs)
+
         idx = numpy.arange(len(self.states) - 1)
         numpy.random.shuffle(idx)
         nswaps = 0
         dS = 0
         for i in idx:
-            s1 = self.states[i]
-            s2 = self.states[i + 1]
             b1 = self.betas[i]
             b2 = self.betas[i + 1]
 
-            P1_f = -b2 * s1.entropy(**eargs)
-            P2_f = -b1 * s2.entropy(**eargs)
-
-            P1_b = -b1 * s1.entropy(**eargs)
-            P2_b = -b2 * s2.entropy(**eargs)
-
-            ddS = -(P1_f + P2_f - P1_b - P2_b)
+            ddS = (b2 - b1) * (S[i] - S[i + 1])
             a = exp(-ddS)
 
+            self.swap_attempts[i] += 1
             if numpy.random.random() < a:
-                self.states[i + 1], self.states[i] = \
-                            self.states[i], self.states[i + 1]
+                for x in [self.states, self.rngs, S]:
+                    x[i + 1], x[i] = x[i], x[i + 1]
+                self.swap_accepts[i] += 1
                 nswaps += 1
                 dS += ddS
                 if check_verbose(verbose):
                     print(verbose_pad(verbose)
-                          + u"swapped states: %d [β = (%g,%g)] <-> %d [β = (%g,%g)], a:" % \
-                          (i, b1, db1, i + 1, b2, db2, a))
+                          + u"swapped states: %d [β = %g] <-> %d [β = %g], a: %g" % \
+                          (i, b1, i + 1, b2, a))
         return dS, nswaps
 
     def states_move(self, sweep_algo, **kwargs):
         """Perform a full sweep of the parallel states, where state moves are
         attempted by calling `sweep_algo(state, beta=beta, **kwargs)`."""
+        entropy_args = kwargs.get("entropy_args", {})
+        S = self._get_S(entropy_args)
+
+        def sweep(i):
+            return sweep_algo(self.states[i], beta=self.betas[i],
+                              **dict(kwargs,
+                                     entropy_args=dict(entropy_args)))[:2]
+        try:
+            rets = _parallel_map(sweep, self.rngs, self.nthreads)
+        except BaseException:
+            self._S = None
+            raise
+
         dS = 0
         nmoves = 0
-        for state, beta in zip(self.states, self.betas):
-            entropy_args = dict(kwargs.get("entropy_args", {}))
-            ret = sweep_algo(state, beta=beta,
-                             **dict(kwargs, entropy_args=entropy_args))[:2]
-            dS += ret[0] * beta
+        for i, ret in enumerate(rets):
+            S[i] += ret[0]
+            dS += ret[0] * self.betas[i]
             nmoves += ret[1]
         return dS, nmoves
 
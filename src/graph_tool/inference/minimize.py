@@ -31,6 +31,7 @@ from . blockmodel import *
 from . overlap_blockmodel import *
 from . layered_blockmodel import *
 from . nested_blockmodel import *
+from . modularity import maximize_modularity
 
 def default_args(mcmc_args={}, anneal_args={}, mcmc_equilibrate_args={},
                  shrink_args={}, mcmc_multilevel_args={}, overlap=False):
@@ -116,8 +117,9 @@ def get_states(g, B_min=None, B_max=None, b_min=None, b_max=None, deg_corr=True,
 
 def minimize_blockmodel_dl(g, B_min=None, B_max=None, b_min=None, b_max=None,
                            deg_corr=True, overlap=False, nonoverlap_init=True,
-                           layers=False, state_args={}, bisection_args={},
-                           mcmc_args={}, anneal_args={},
+                           layers=False, modularity_init=False,
+                           modularity_args={}, state_args={},
+                           bisection_args={}, mcmc_args={}, anneal_args={},
                            mcmc_equilibrate_args={}, shrink_args={},
                            mcmc_multilevel_args={}, verbose=False):
     """Fit the stochastic block model.
@@ -143,6 +145,16 @@ def minimize_blockmodel_dl(g, B_min=None, B_max=None, b_min=None, b_max=None,
         will be used.
     layers : ``bool`` (optional, default: ``False``)
         If ``True``, the layered version of the model will be used.
+    modularity_init : ``bool`` (optional, default: ``False``)
+        If ``True``, and ``b_max`` is not given, the partition found by
+        :func:`~graph_tool.inference.maximize_modularity` will be used as the
+        partition with the maximum number of blocks, instead of one block per
+        vertex. This avoids the slow initial merges, but it also limits the
+        number of blocks to the number of communities found; larger values of
+        ``gamma`` in ``modularity_args`` yield more communities.
+    modularity_args : ``dict`` (optional, default: ``{}``)
+        Arguments to be passed to
+        :func:`~graph_tool.inference.maximize_modularity`.
     state_args : ``dict`` (optional, default: ``{}``)
         Arguments to be passed to appropriate state constructor (e.g.
         :class:`~graph_tool.inference.BlockState`,
@@ -289,6 +301,13 @@ def minimize_blockmodel_dl(g, B_min=None, B_max=None, b_min=None, b_max=None,
     if clabel is None:
         clabel = state_args.get("pclabel", None)
 
+    if modularity_init and b_max is None and (not overlap or nonoverlap_init):
+        b_max = maximize_modularity(g, **modularity_args)
+        if clabel is not None:
+            # the blocks cannot span several constraint labels
+            bc = numpy.array([b_max.fa, clabel.fa]).T
+            b_max.fa = numpy.unique(bc, axis=0, return_inverse=True)[1]
+
     min_state, max_state = get_states(g, B_min=B_min, B_max=B_max, b_min=b_min,
                                       b_max=b_max, deg_corr=deg_corr,
                                       overlap=overlap,
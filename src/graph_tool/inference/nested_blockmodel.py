@@ -676,10 +676,16 @@ class NestedBlockState(object):
         verbose = kwargs.get("verbose", False)
         entropy_args = kwargs.get("entropy_args", {})
 
+        # the coupling between levels persists across sweeps, and only needs
+        # to be redone if the hierarchy has changed
         for l in range(len(self.levels) - 1):
             eargs = dict(self.hentropy_args,
                          edges_dl=(l + 1 == len(self.levels) - 1),
                          recs=False)
+            cstate = self.levels[l]._coupled_state
+            if (cstate is not None and cstate[0] is self.levels[l + 1] and
+                cstate[1] == eargs):
+                continue
             self.levels[l]._couple_state(self.levels[l + 1], eargs)
 
         dS = 0
@@ -712,8 +718,15 @@ class NestedBlockState(object):
 
                 self.levels[l]._set_bclabel(self.levels[l + 1])
 
-            self.levels[l]._state.sync_emat()
-            if l > 0:
+            # a level needs to be resynchronized only if it was modified since
+            # its last sweep, i.e. by moves at the level below
+            state = self.levels[l]
+            mod_count = state._state.get_mod_count()
+            synced = getattr(state, "_h_mod_count", None) == mod_count
+
+            if not synced:
+                state._state.sync_emat()
+            if l > 0 and not synced:
                 self.levels[l]._state.clear_egroups()
                 self.levels[l]._state.rebuild_neighbor_sampler()
 
@@ -727,7 +740,7 @@ class NestedBlockState(object):
             else:
                 args = dict(kwargs, entropy_args=eargs, c=c[l])
 
-            if l > 0:
+            if l > 0 and not synced:
                 N_ = self.levels[l].get_N()
                 idx_ = self.levels[l].wr.a == 0
                 rs = arange(len(idx_), dtype="int")
@@ -739,6 +752,7 @@ class NestedBlockState(object):
                     reverse_map(rs, self.levels[l].empty_pos)
 
             ret = algo(self.levels[l], **args)
+            state._h_mod_count = state._state.get_mod_count()
 
             dS += ret[0]
             nmoves += ret[1]
@@ -853,7 +867,8 @@ class NestedBlockState(object):
                                                             str(entropy_args))
         return dS, nmoves
 
-    def collect_partition_histogram(self, h=None, update=1):
+    def collect_partition_histogram(self, h=None, update=1, unlabel=True,
+                                    hashed=False):
         r"""Collect a histogram of partitions.
 
         This should be called multiple times, e.g. after repeated runs of the
@@ -866,18 +881,27 @@ class NestedBlockState(object):
         update : float (optional, default: ``1``)
             Each call increases the current count by the amount given by this
             parameter.
+        unlabel : bool (optional, default: ``True``)
+            If ``True``, the partition at each level will be relabeled so that
+            only one entry for all its label permutations will be considered in
+            the histogram.
+        hashed : bool (optional, default: ``False``)
+            If ``True`` and ``h`` is not given, a
+            :class:`~graph_tool.inference.PartitionHashHist` will be created,
+            which stores only a 64-bit hash of each hierarchical partition,
+            instead of a full copy.
 
         Returns
         -------
-        h : :class:`~graph_tool.inference.PartitionHist` (optional, default: ``None``)
+        h : :class:`~graph_tool.inference.PartitionHist` or :class:`~graph_tool.inference.PartitionHashHist`
             Updated Partition histogram.
 
         """
 
         if h is None:
-            h = PartitionHist()
+            h = PartitionHashHist() if hashed else PartitionHist()
         bs = [_prop("v", state.g, state.b) for state in self.levels]
-        libinference.collect_hierarchical_partitions(bs, h, update)
+        libinference.collect_hierarchical_partitions(bs, h, update, unlabel)
         return h
 
     def draw(self, **kwargs):
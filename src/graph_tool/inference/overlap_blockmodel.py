@@ -37,7 +37,7 @@ from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_inference as libinference")
 
 from . blockmodel import *
-from . blockmodel import _bm_test
+from . blockmodel import _bm_test, _cached_entropy
 
 class OverlapBlockState(BlockState):
     r"""The overlapping stochastic block model state of a given graph.
@@ -442,6 +442,7 @@ class OverlapBlockState(BlockState):
                                      _prop("v", self.base_g, b))
         return b
 
+    @_cached_entropy
     def entropy(self, adjacency=True, dl=True, partition_dl=True,
                 degree_dl=True, degree_dl_kind="distributed", edges_dl=True,
                 dense=False, multigraph=True, deg_entropy=True, recs=True,
@@ -26,11 +26,53 @@ if sys.version_info < (3,):
 import scipy.special
 from numpy import *
 
-from .. import PropertyMap
+from .. import PropertyMap, _set_thread_rng
+import threading
 
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_inference as libinference")
 
+def _parallel_map(f, rngs, nthreads=None):
+    """Returns ``[f(i) for i in range(len(rngs))]``, with the calls made
+    concurrently in up to ``nthreads`` threads (by default one per call), and
+    with ``rngs[i]`` replacing graph-tool's global RNG during call ``i``. This
+    gives actual parallelism when ``f`` spends its time in C++ code that
+    releases the GIL, such as the MCMC sweeps."""
+    N = len(rngs)
+    rets = [None] * N
+    errors = []
+    tasks = list(range(N))
+    lock = threading.Lock()
+
+    def worker():
+        while True:
+            with lock:
+                if len(tasks) == 0 or len(errors) > 0:
+                    return
+                i = tasks.pop()
+            _set_thread_rng(rngs[i])
+            try:
+                rets[i] = f(i)
+            except BaseException:
+                with lock:
+                    errors.append(sys.exc_info())
+            finally:
+                _set_thread_rng(None)
+
+    if nthreads is None:
+        nthreads = N
+    nthreads = max(min(nthreads, N), 1)
+    threads = [threading.Thread(target=worker) for i in range(nthreads - 1)]
+    for t in threads:
+        t.start()
+    worker()
+    for t in threads:
+        t.join()
+
+    if len(errors) > 0:
+        raise errors[0][1]
+    return rets
+
 class DictState(dict):
     """Dictionary with (key,value) pairs accessible via attributes."""
     def __init__(self, d):
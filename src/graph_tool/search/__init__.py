@@ -36,18 +36,23 @@ Summary
 
    bfs_search
    bfs_iterator
+   bfs_events
    dfs_search
    dfs_iterator
+   dfs_events
    dijkstra_search
    dijkstra_iterator
+   dijkstra_events
    astar_search
    astar_iterator
+   astar_implicit
    bellman_ford_search
    BFSVisitor
    DFSVisitor
    DijkstraVisitor
    BellmanFordVisitor
    AStarVisitor
+   SearchWorkspace
    StopSearch
 
 Examples
@@ -92,14 +97,38 @@ if sys.version_info < (3,):
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_search")
 
-from .. import _prop, _python_type, _get_null_vertex
+from .. import _prop, _python_type, _get_null_vertex, libcore
 import weakref
+import collections
+import ctypes
 import numpy
 
-__all__ = ["bfs_search", "bfs_iterator", "BFSVisitor", "dfs_search",
-           "dfs_iterator", "DFSVisitor", "dijkstra_search", "dijkstra_iterator",
+__all__ = ["bfs_search", "bfs_iterator", "bfs_events", "BFSVisitor",
+           "dfs_search", "dfs_iterator", "dfs_events", "DFSVisitor",
+           "dijkstra_search", "dijkstra_iterator", "dijkstra_events",
            "DijkstraVisitor", "bellman_ford_search", "BellmanFordVisitor",
-           "astar_search", "astar_iterator", "AStarVisitor", "StopSearch"]
+           "astar_search", "astar_iterator", "astar_implicit", "AStarVisitor",
+           "AStarSuccessors", "AStarHeuristic", "AStarGoal", "SearchWorkspace",
+           "StopSearch", "search_events"]
+
+# The event codes used by bfs_events(), dfs_events() and dijkstra_events() are
+# the positions in this tuple, which must match the search_event enum in
+# graph_search_events.hh.
+search_events = ("initialize_vertex", "start_vertex", "discover_vertex",
+                 "examine_vertex", "finish_vertex", "examine_edge",
+                 "tree_edge", "non_tree_edge", "gray_target", "black_target",
+                 "back_edge", "forward_or_cross_edge", "edge_relaxed",
+                 "edge_not_relaxed")
+
+_bfs_events = ("initialize_vertex", "discover_vertex", "examine_vertex",
+               "finish_vertex", "examine_edge", "tree_edge", "non_tree_edge",
+               "gray_target", "black_target")
+_dfs_events = ("initialize_vertex", "start_vertex", "discover_vertex",
+               "finish_vertex", "examine_edge", "tree_edge", "back_edge",
+               "forward_or_cross_edge")
+_dijkstra_events = ("initialize_vertex", "discover_vertex", "examine_vertex",
+                    "finish_vertex", "examine_edge", "edge_relaxed",
+                    "edge_not_relaxed")
 
 
 class BFSVisitor(object):
@@ -295,7 +324,7 @@ def bfs_search(g, source=None, visitor=BFSVisitor()):
     except StopSearch:
         pass
 
-def bfs_iterator(g, source=None, array=False):
+def bfs_iterator(g, source=None, array=False, workspace=None):
     r"""Return an iterator of the edges corresponding to a breath-first traversal of
     the graph.
 
@@ -310,6 +339,9 @@ def bfs_iterator(g, source=None, array=False):
     array : ``bool`` (optional, default: ``False``)
         If ``True``, a :class:`numpy.ndarray` will the edge endpoints be
         returned instead.
+    workspace : :class:`~graph_tool.search.SearchWorkspace` (optional, default: ``None``)
+        If given, the search buffers are taken from it, and the predecessors
+        of the reached vertices are left there. Requires ``array == True``.
 
     Returns
     -------
@@ -360,12 +392,105 @@ def bfs_iterator(g, source=None, array=False):
         source = _get_null_vertex()
     else:
         source = int(source)
+    if workspace is not None:
+        if not array:
+            raise ValueError("a workspace can only be used with array=True")
+        return libgraph_tool_search.bfs_search_array_ws(g._Graph__graph, source,
+                                                        workspace._ws)
     if not array:
         return libgraph_tool_search.bfs_search_generator(g._Graph__graph, source)
     else:
         return libgraph_tool_search.bfs_search_array(g._Graph__graph, source)
 
 
+def bfs_events(g, source=None, events=None, prune=None, efilt=None,
+               chunk_size=None):
+    r"""Record the events of a breadth-first search into arrays.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    source : :class:`~graph_tool.Vertex` (optional, default: ``None``)
+        Source vertex. If unspecified, all vertices will be traversed, by
+        iterating over starting vertices according to their index in increasing
+        order.
+    events : list of ``str`` (optional, default: ``None``)
+        Names of the events to be recorded, among ``"initialize_vertex"``, ``"discover_vertex"``,
+        ``"examine_vertex"``, ``"finish_vertex"``, ``"examine_edge"``,
+        ``"tree_edge"``, ``"non_tree_edge"``, ``"gray_target"`` and
+        ``"black_target"``. If not given, all of them are recorded.
+    prune : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property map. The vertices for which it is nonzero are still
+        reached by the search, but their out-edges are not followed.
+    efilt : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Edge property map. Only the edges for which it is nonzero are
+        followed.
+    chunk_size : ``int`` (optional, default: ``None``)
+        If given, the events are returned by an iterator over arrays of at
+        most this many rows, which are produced as the search progresses,
+        instead of all at once.
+
+    Returns
+    -------
+    events : :class:`numpy.ndarray` or iterator
+        An array of shape ``(n, 4)`` with one row per event, in the order in
+        which they happened, containing the event code (its position in
+        :data:`~graph_tool.search.search_events`), the vertex (or the source
+        of the edge), the target of the edge, and the edge index. The last two
+        columns are ``-1`` for vertex events. If ``chunk_size`` is given, this
+        will be an iterator over such arrays instead.
+
+    See Also
+    --------
+    bfs_search: Breadth-first search with a visitor
+    dfs_events: Depth-first search events
+    dijkstra_events: Dijkstra's search events
+
+    Notes
+    -----
+
+    This is equivalent to :func:`~graph_tool.search.bfs_search` with a visitor
+    that records the selected events, but the events are stored into arrays
+    while the search runs in C++, so that there is no Python call per event.
+    If ``chunk_size`` is given, the search is suspended each time a chunk is
+    full, and resumed when the next one is requested, so that it can be
+    abandoned early, and the memory used stays bounded.
+
+    Pruning with ``prune`` differs from filtering the vertices with a
+    :class:`~graph_tool.GraphView`: the pruned vertices are discovered, and
+    the search only stops there.
+
+    The time complexity is :math:`O(V + E)`.
+
+    Examples
+    --------
+
+    Only the neighbours of the source are reached if all the other vertices
+    are pruned:
+
+    >>> prune = g.new_vertex_property("bool", val=True)
+    >>> prune[g.vertex(0)] = False
+    >>> ev = gt.bfs_events(g, g.vertex(0), events=["tree_edge"], prune=prune)
+    >>> for code, s, t, e in ev:
+    ...    print(gt.search_events[code], name[s], "->", name[t])
+    tree_edge Bob -> Eve
+    tree_edge Bob -> Chuck
+    tree_edge Bob -> Carlos
+    tree_edge Bob -> Isaac
+
+    """
+    if source is None:
+        source = _get_null_vertex()
+    else:
+        source = int(source)
+    mask, prune, efilt, chunk_size = _event_args(g, events, _bfs_events, prune,
+                                                 efilt, chunk_size)
+    ret = libgraph_tool_search.bfs_search_events(g._Graph__graph, source, mask,
+                                                 chunk_size, prune, efilt)
+    return _event_ret(ret, chunk_size)
+
+
 class DFSVisitor(object):
     r"""
     A visitor object that is invoked at the event-points inside the
@@ -668,6 +793,77 @@ def dfs_iterator(g, source=None, array=False):
     else:
         return libgraph_tool_search.dfs_search_array(g._Graph__graph, source)
 
+def dfs_events(g, source=None, events=None, prune=None, efilt=None,
+               chunk_size=None):
+    r"""Record the events of a depth-first search into arrays.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    source : :class:`~graph_tool.Vertex` (optional, default: ``None``)
+        Source vertex. If unspecified, all vertices will be traversed, by
+        iterating over starting vertices according to their index in increasing
+        order.
+    events : list of ``str`` (optional, default: ``None``)
+        Names of the events to be recorded, among ``"initialize_vertex"``, ``"start_vertex"``,
+        ``"discover_vertex"``, ``"finish_vertex"``, ``"examine_edge"``,
+        ``"tree_edge"``, ``"back_edge"`` and ``"forward_or_cross_edge"``. If
+        not given, all of them are recorded.
+    prune : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property map. The vertices for which it is nonzero are still
+        reached by the search, but their out-edges are not followed.
+    efilt : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Edge property map. Only the edges for which it is nonzero are
+        followed.
+    chunk_size : ``int`` (optional, default: ``None``)
+        If given, the events are returned by an iterator over arrays of at
+        most this many rows, which are produced as the search progresses,
+        instead of all at once.
+
+    Returns
+    -------
+    events : :class:`numpy.ndarray` or iterator
+        An array of shape ``(n, 4)`` with one row per event, in the order in
+        which they happened, containing the event code (its position in
+        :data:`~graph_tool.search.search_events`), the vertex (or the source
+        of the edge), the target of the edge, and the edge index. The last two
+        columns are ``-1`` for vertex events. If ``chunk_size`` is given, this
+        will be an iterator over such arrays instead.
+
+    See Also
+    --------
+    dfs_search: Depth-first search with a visitor
+    bfs_events: Breadth-first search events
+    dijkstra_events: Dijkstra's search events
+
+    Notes
+    -----
+
+    This is equivalent to :func:`~graph_tool.search.dfs_search` with a visitor
+    that records the selected events, but the events are stored into arrays
+    while the search runs in C++, so that there is no Python call per event.
+    If ``chunk_size`` is given, the search is suspended each time a chunk is
+    full, and resumed when the next one is requested, so that it can be
+    abandoned early, and the memory used stays bounded.
+
+    Pruning with ``prune`` differs from filtering the vertices with a
+    :class:`~graph_tool.GraphView`: the pruned vertices are discovered, and
+    the search only stops there.
+
+    The time complexity is :math:`O(V + E)`.
+    """
+    if source is None:
+        source = _get_null_vertex()
+    else:
+        source = int(source)
+    mask, prune, efilt, chunk_size = _event_args(g, events, _dfs_events, prune,
+                                                 efilt, chunk_size)
+    ret = libgraph_tool_search.dfs_search_events(g._Graph__graph, source, mask,
+                                                 chunk_size, prune, efilt)
+    return _event_ret(ret, chunk_size)
+
+
 class DijkstraVisitor(object):
     r"""A visitor object that is invoked at the event-points inside the
     :func:`~graph_tool.search.dijkstra_search` algorithm. By default, it
@@ -972,7 +1168,8 @@ def dijkstra_search(g, weight, source=None, visitor=DijkstraVisitor(), dist_map=
     return dist_map, pred_map
 
 def dijkstra_iterator(g, weight, source=None, dist_map=None, combine=None,
-                      compare=None, zero=0, infinity=numpy.inf, array=False):
+                      compare=None, zero=0, infinity=numpy.inf, array=False,
+                      workspace=None):
     r"""Return an iterator of the edges corresponding to a Dijkstra traversal of
     the graph.
 
@@ -1004,6 +1201,11 @@ def dijkstra_iterator(g, weight, source=None, dist_map=None, combine=None,
     array : ``bool`` (optional, default: ``False``)
         If ``True``, a :class:`numpy.ndarray` will the edge endpoints be
         returned instead.
+    workspace : :class:`~graph_tool.search.SearchWorkspace` (optional, default: ``None``)
+        If given, the search buffers are taken from it, and the distances and
+        predecessors of the reached vertices are left there, instead of in
+        ``dist_map``. Requires ``array == True``, and can be used neither
+        with ``dist_map``, nor with ``combine`` or ``compare``.
 
     Returns
     -------
@@ -1051,27 +1253,37 @@ def dijkstra_iterator(g, weight, source=None, dist_map=None, combine=None,
 
     """
 
-    if dist_map is None:
-        dist_map = g.new_vertex_property(weight.value_type())
+    if workspace is not None:
+        _check_workspace(array, dist_map, combine, compare)
+        dist_type = weight.value_type()
+    else:
+        if dist_map is None:
+            dist_map = g.new_vertex_property(weight.value_type())
+        dist_type = dist_map.value_type()
 
     try:
-        if dist_map.value_type() != "python::object":
-            zero = _python_type(dist_map.value_type())(zero)
+        if dist_type != "python::object":
+            zero = _python_type(dist_type)(zero)
     except OverflowError:
         zero = (weight.a.max() + 1) * g.num_vertices()
-        zero = _python_type(dist_map.value_type())(zero)
+        zero = _python_type(dist_type)(zero)
 
     try:
-        if dist_map.value_type() != "python::object":
-            infinity = _python_type(dist_map.value_type())(infinity)
+        if dist_type != "python::object":
+            infinity = _python_type(dist_type)(infinity)
     except OverflowError:
         infinity = (weight.a.max() + 1) * g.num_vertices()
-        infinity = _python_type(dist_map.value_type())(infinity)
+        infinity = _python_type(dist_type)(infinity)
 
     if source is None:
         source = _get_null_vertex()
     else:
         source = int(source)
+    if workspace is not None:
+        return libgraph_tool_search.dijkstra_array_ws(g._Graph__graph, source,
+                                                      _prop("e", g, weight),
+                                                      zero, infinity,
+                                                      workspace._ws)
     if compare is None and combine is None:
         if not array:
             return libgraph_tool_search.dijkstra_generator_fast(g._Graph__graph,
@@ -1106,6 +1318,105 @@ def dijkstra_iterator(g, weight, source=None, dist_map=None, combine=None,
                                                        zero, infinity)
 
 
+def dijkstra_events(g, weight, source=None, dist_map=None, zero=0,
+                    infinity=numpy.inf, events=None, prune=None, efilt=None,
+                    chunk_size=None):
+    r"""Record the events of a Dijkstra search into arrays.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    weight : :class:`~graph_tool.PropertyMap`
+        Edge property map with weight values.
+    source : :class:`~graph_tool.Vertex` (optional, default: ``None``)
+        Source vertex. If unspecified, all vertices will be traversed, by
+        iterating over starting vertices according to their index in increasing
+        order.
+    dist_map : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        A vertex property map where the distances from the source will be
+        stored.
+    zero : int or float (optional, default: ``0``)
+         Value assumed to correspond to a distance of zero.
+    infinity : int or float (optional, default: ``numpy.inf``)
+         Value assumed to correspond to a distance of infinity.
+    events : list of ``str`` (optional, default: ``None``)
+        Names of the events to be recorded, among ``"initialize_vertex"``, ``"discover_vertex"``,
+        ``"examine_vertex"``, ``"finish_vertex"``, ``"examine_edge"``,
+        ``"edge_relaxed"`` and ``"edge_not_relaxed"``. If
+        not given, all of them are recorded.
+    prune : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property map. The vertices for which it is nonzero are still
+        reached by the search, but their out-edges are not followed.
+    efilt : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Edge property map. Only the edges for which it is nonzero are
+        followed.
+    chunk_size : ``int`` (optional, default: ``None``)
+        If given, the events are returned by an iterator over arrays of at
+        most this many rows, which are produced as the search progresses,
+        instead of all at once.
+
+    Returns
+    -------
+    events : :class:`numpy.ndarray` or iterator
+        An array of shape ``(n, 4)`` with one row per event, in the order in
+        which they happened, containing the event code (its position in
+        :data:`~graph_tool.search.search_events`), the vertex (or the source
+        of the edge), the target of the edge, and the edge index. The last two
+        columns are ``-1`` for vertex events. If ``chunk_size`` is given, this
+        will be an iterator over such arrays instead.
+
+    See Also
+    --------
+    dijkstra_search: Dijkstra's search with a visitor
+    bfs_events: Breadth-first search events
+    dfs_events: Depth-first search events
+
+    Notes
+    -----
+
+    This is equivalent to :func:`~graph_tool.search.dijkstra_search` with a visitor
+    that records the selected events, but the events are stored into arrays
+    while the search runs in C++, so that there is no Python call per event.
+    If ``chunk_size`` is given, the search is suspended each time a chunk is
+    full, and resumed when the next one is requested, so that it can be
+    abandoned early, and the memory used stays bounded.
+
+    Pruning with ``prune`` differs from filtering the vertices with a
+    :class:`~graph_tool.GraphView`: the pruned vertices are discovered, and
+    the search only stops there.
+
+    The distances in ``dist_map`` are those known when the event happened, so
+    that, for instance, the distance of a vertex is final at its
+    ``"examine_vertex"`` event.
+
+    The time complexity is :math:`O(E + V\log V)`.
+    """
+    if dist_map is None:
+        dist_map = g.new_vertex_property(weight.value_type())
+    dist_type = _python_type(dist_map.value_type())
+    try:
+        zero = dist_type(zero)
+    except OverflowError:
+        zero = dist_type((weight.a.max() + 1) * g.num_vertices())
+    try:
+        infinity = dist_type(infinity)
+    except OverflowError:
+        infinity = dist_type((weight.a.max() + 1) * g.num_vertices())
+    if source is None:
+        source = _get_null_vertex()
+    else:
+        source = int(source)
+    mask, prune, efilt, chunk_size = _event_args(g, events, _dijkstra_events,
+                                                 prune, efilt, chunk_size)
+    ret = libgraph_tool_search.dijkstra_events(g._Graph__graph, source,
+                                               _prop("v", g, dist_map),
+                                               _prop("e", g, weight),
+                                               zero, infinity, mask,
+                                               chunk_size, prune, efilt)
+    return _event_ret(ret, chunk_size)
+
+
 class BellmanFordVisitor(object):
     r"""A visitor object that is invoked at the event-points inside the
     :func:`~graph_tool.search.bellman_ford_search` algorithm. By default, it
@@ -1843,7 +2154,7 @@ def astar_search(g, source, weight, visitor=AStarVisitor(),
 
 def astar_iterator(g, source, weight, heuristic=lambda v: 1, dist_map=None,
                    combine=None, compare=None, zero=0, infinity=numpy.inf,
-                   array=False):
+                   array=False, workspace=None):
     r"""Return an iterator of the edges corresponding to an :math:`A^*` traversal of
     the graph.
 
@@ -1877,6 +2188,11 @@ def astar_iterator(g, source, weight, heuristic=lambda v: 1, dist_map=None,
     array : ``bool`` (optional, default: ``False``)
         If ``True``, a :class:`numpy.ndarray` will the edge endpoints be
         returned instead.
+    workspace : :class:`~graph_tool.search.SearchWorkspace` (optional, default: ``None``)
+        If given, the search buffers are taken from it, and the distances and
+        predecessors of the reached vertices are left there, instead of in
+        ``dist_map``. Requires ``array == True``, and can be used neither
+        with ``dist_map``, nor with ``combine`` or ``compare``.
 
     Returns
     -------
@@ -1929,23 +2245,34 @@ def astar_iterator(g, source, weight, heuristic=lambda v: 1, dist_map=None,
 
     """
 
-    if dist_map is None:
-        dist_map = g.new_vertex_property(weight.value_type())
+    if workspace is not None:
+        _check_workspace(array, dist_map, combine, compare)
+        dist_type = weight.value_type()
+    else:
+        if dist_map is None:
+            dist_map = g.new_vertex_property(weight.value_type())
+        dist_type = dist_map.value_type()
 
     try:
-        if dist_map.value_type() != "python::object":
-            zero = _python_type(dist_map.value_type())(zero)
+        if dist_type != "python::object":
+            zero = _python_type(dist_type)(zero)
     except OverflowError:
         zero = (weight.a.max() + 1) * g.num_vertices()
-        zero = _python_type(dist_map.value_type())(zero)
+        zero = _python_type(dist_type)(zero)
 
     try:
-        if dist_map.value_type() != "python::object":
-            infinity = _python_type(dist_map.value_type())(infinity)
+        if dist_type != "python::object":
+            infinity = _python_type(dist_type)(infinity)
     except OverflowError:
         infinity = (weight.a.max() + 1) * g.num_vertices()
-        infinity = _python_type(dist_map.value_type())(infinity)
-
+        infinity = _python_type(dist_type)(infinity)
+
+    if workspace is not None:
+        return libgraph_tool_search.astar_array_ws(g._Graph__graph,
+                                                   int(source),
+                                                   _prop("e", g, weight),
+                                                   zero, infinity, heuristic,
+                                                   workspace._ws)
     if compare is None and combine is None:
         if not array:
             return libgraph_tool_search.astar_generator_fast(g._Graph__graph,
@@ -1979,6 +2306,220 @@ def astar_iterator(g, source, weight, heuristic=lambda v: 1, dist_map=None,
                                                     compare, combine,
                                                     zero, infinity, heuristic)
 
+def _event_args(g, events, valid, prune, efilt, chunk_size):
+    if events is None:
+        events = valid
+    mask = 0
+    for ev in events:
+        if ev not in valid:
+            raise ValueError("invalid event for this search: '%s'" % ev)
+        mask |= 1 << search_events.index(ev)
+    if prune is not None and prune.value_type() != "bool":
+        prune = prune.copy("bool")
+    if efilt is not None and efilt.value_type() != "bool":
+        efilt = efilt.copy("bool")
+    if chunk_size is None:
+        chunk_size = 0
+    elif chunk_size < 1:
+        raise ValueError("chunk_size must be positive")
+    return mask, _prop("v", g, prune), _prop("e", g, efilt), chunk_size
+
+def _event_ret(ret, chunk_size):
+    if chunk_size == 0:
+        return ret.reshape((-1, 4))
+    return ret
+
+
+# C signatures of the callbacks of astar_implicit()
+AStarSuccessors = ctypes.CFUNCTYPE(ctypes.c_size_t, ctypes.c_uint64,
+                                   ctypes.POINTER(ctypes.c_uint64),
+                                   ctypes.POINTER(ctypes.c_double),
+                                   ctypes.c_size_t, ctypes.c_void_p)
+AStarHeuristic = ctypes.CFUNCTYPE(ctypes.c_double, ctypes.c_uint64,
+                                  ctypes.c_void_p)
+AStarGoal = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_uint64, ctypes.c_void_p)
+
+def _cfunc_address(f):
+    if f is None:
+        return 0
+    if isinstance(f, int):
+        return f
+    return ctypes.cast(f, ctypes.c_void_p).value
+
+def astar_implicit(source, successors, heuristic=None, target=None,
+                   is_goal=None, data=None, max_expansions=None):
+    r"""Find a least-cost path in an implicit state space with the :math:`A^*`
+    algorithm, using compiled successor and heuristic functions.
+
+    Parameters
+    ----------
+    source : ``int``
+        Initial state, as a 64-bit unsigned integer.
+    successors : C function pointer
+        Function with the C signature ``size_t succ(uint64_t state, uint64_t*
+        states, double* costs, size_t max, void* data)``, which writes at most
+        ``max`` successors of ``state``, and the non-negative costs of
+        reaching them, and returns the total number of successors. If this is
+        larger than ``max``, it is called again with enough space.
+    heuristic : C function pointer (optional, default: ``None``)
+        Function with the C signature ``double h(uint64_t state, void*
+        data)``, returning an estimate of the remaining cost to the goal, which
+        should not be an overestimate. If not given, zero is assumed, and the
+        search reduces to Dijkstra's algorithm.
+    target : ``int`` (optional, default: ``None``)
+        Goal state. Either this or ``is_goal`` must be given.
+    is_goal : C function pointer (optional, default: ``None``)
+        Function with the C signature ``int goal(uint64_t state, void*
+        data)``, returning a nonzero value for the goal states.
+    data : ``int`` or :mod:`ctypes` object (optional, default: ``None``)
+        Pointer passed untouched as the last argument of the callbacks.
+    max_expansions : ``int`` (optional, default: ``None``)
+        If given, the search is abandoned after this many states are expanded.
+
+    Returns
+    -------
+    path : :class:`numpy.ndarray`
+        The states along the path found, from the source to the goal, or an
+        empty array if there is none.
+    cost : ``float``
+        The cost of the path, or ``inf`` if there is none.
+    n_expanded : ``int``
+        Number of expanded states.
+    n_generated : ``int``
+        Number of generated states.
+
+    Notes
+    -----
+
+    The function pointers can be given as integer addresses (e.g. from
+    :mod:`cffi` via ``int(ffi.cast("uintptr_t", f))``, or from a function
+    loaded from a shared library), or as :mod:`ctypes` function objects, for
+    which :data:`AStarSuccessors`, :data:`AStarHeuristic` and
+    :data:`AStarGoal` provide the prototypes.
+
+    Unlike :func:`~graph_tool.search.astar_search` with ``implicit=True``, the
+    states are not added to a graph, and the whole search runs in C++,
+    without holding the GIL, so that compiled callbacks can expand millions
+    of states per second. The open set is a 4-ary heap, and the closed set a
+    hash table from the states to a compact node array. The heuristic need
+    not be consistent, since closed states are reopened if their cost is
+    improved. The states :math:`2^{64}-1` and :math:`2^{64}-2` are reserved.
+
+    Callbacks written in Python via :mod:`ctypes` also work, but reacquire the
+    GIL at every call, which defeats the purpose.
+
+    Examples
+    --------
+
+    A walk on the integers, where each step costs one:
+
+    >>> @gt.AStarSuccessors
+    ... def succ(s, states, costs, m, data):
+    ...     if m >= 2:
+    ...         states[0], states[1] = s + 1, max(s, 1) - 1
+    ...         costs[0] = costs[1] = 1
+    ...     return 2
+    >>> path, cost, n_exp, n_gen = gt.astar_implicit(10, succ, target=15)
+    >>> print(path, cost)
+    [10 11 12 13 14 15] 5.0
+    """
+    if target is None and is_goal is None:
+        raise ValueError("either target or is_goal must be given")
+    if data is not None and not isinstance(data, int):
+        data = ctypes.cast(data, ctypes.c_void_p).value
+    if max_expansions is None:
+        max_expansions = numpy.iinfo(numpy.uint64).max
+    target = 0 if target is None else int(target)
+    return libgraph_tool_search.astar_implicit_cfunc(int(source), target,
+                                                     _cfunc_address(successors),
+                                                     _cfunc_address(heuristic),
+                                                     _cfunc_address(is_goal),
+                                                     data or 0,
+                                                     int(max_expansions))
+
+
+def _check_workspace(array, dist_map, combine, compare):
+    if not array:
+        raise ValueError("a workspace can only be used with array=True")
+    if dist_map is not None:
+        raise ValueError("a workspace cannot be used together with dist_map")
+    if combine is not None or compare is not None:
+        raise ValueError("a workspace cannot be used together with combine " +
+                         "or compare")
+
+
+class SearchWorkspace(object):
+    r"""Search buffers that are kept between successive searches.
+
+    Searching from a vertex normally requires color, distance and predecessor
+    maps covering the whole graph, which are allocated and initialized before
+    the search starts. If many searches are done on a large graph, each
+    exploring only a small part of it, this costs much more than the searches
+    themselves. If a :class:`SearchWorkspace` is passed to
+    :func:`~graph_tool.search.bfs_iterator`,
+    :func:`~graph_tool.search.dijkstra_iterator`,
+    :func:`~graph_tool.search.astar_iterator` or
+    :func:`~graph_tool.topology.shortest_distance`, its buffers are used
+    instead, and are reset in constant time between searches, so that each
+    search only costs the part of the graph it explores.
+
+    The results of the last search done with the workspace remain available
+    via :meth:`dist`, :meth:`pred` and :meth:`reached`, until the next one is
+    started.
+
+    Notes
+    -----
+
+    The buffers are reset by tagging each entry with the search in which it
+    was last written, so that entries of previous searches are simply treated
+    as unset. A workspace should not be used by more than one search at the
+    same time.
+
+    Examples
+    --------
+
+    >>> g = gt.load_graph("search_example.xml")
+    >>> weight = g.ep["weight"]
+    >>> ws = gt.SearchWorkspace()
+    >>> for v in g.vertices():
+    ...     d = gt.shortest_distance(g, v, [2, 5], weights=weight, workspace=ws)
+    ...     d_ = gt.shortest_distance(g, v, [2, 5], weights=weight)
+    ...     assert all(d == d_)
+    >>> elist = gt.bfs_iterator(g, g.vertex(0), array=True, workspace=ws)
+    >>> print(all(ws.pred(elist[:, 1]) == elist[:, 0]))
+    True
+    """
+
+    def __init__(self):
+        self._ws = libcore.SearchWorkspace()
+
+    def __get(self, f, vs):
+        if vs is None:
+            return f(numpy.asarray(self.reached(), dtype="int64"))
+        if isinstance(vs, collections.Iterable):
+            return f(numpy.asarray(vs, dtype="int64"))
+        return f(numpy.array([int(vs)], dtype="int64"))[0]
+
+    def dist(self, vs=None):
+        """Return the distances found in the last search to the vertex or
+        vertices ``vs``, or to all reached vertices if ``vs`` is ``None``. The
+        vertices that were not reached have an infinite distance, i.e. the
+        largest value of the distance type if it is an integer."""
+        return self.__get(self._ws.get_dist, vs)
+
+    def pred(self, vs=None):
+        """Return the predecessors in the search tree of the last search of the
+        vertex or vertices ``vs``, or of all reached vertices if ``vs`` is
+        ``None``. The source and the vertices that were not reached are their
+        own predecessors."""
+        return self.__get(self._ws.get_pred, vs)
+
+    def reached(self):
+        """Return an array with the vertices reached in the last search, in the
+        order in which they were reached."""
+        return self._ws.get_reached()
+
+
 class StopSearch(Exception):
     """If this exception is raised from inside any search visitor object, the search is aborted."""
     pass
@@ -32,7 +32,13 @@ Summary
    laplacian
    incidence
    transition
+   diffusion
+   randomized_svd
    modularity_matrix
+   hashimoto
+   hashimoto_eig
+   spectral_embedding
+   fiedler_vector
 
 Contents
 ++++++++
@@ -40,7 +46,8 @@ Contents
 
 from __future__ import division, absolute_import, print_function
 
-from .. import _degree, _prop, Graph, GraphView, _limit_args
+from .. import _degree, _prop, Graph, GraphView, PropertyMap, _limit_args, \
+    _get_rng
 from .. stats import label_self_loops
 import numpy
 import scipy.sparse
@@ -49,10 +56,88 @@ import scipy.sparse.linalg
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_spectral")
 
-__all__ = ["adjacency", "laplacian", "incidence", "transition", "modularity_matrix"]
+__all__ = ["adjacency", "laplacian", "incidence", "transition", "diffusion",
+           "randomized_svd", "modularity_matrix", "hashimoto", "hashimoto_eig",
+           "spectral_embedding", "fiedler_vector"]
 
 
-def adjacency(g, weight=None, index=None):
+class _MatrixOperator(scipy.sparse.linalg.LinearOperator):
+    """Matrix-free :class:`~scipy.sparse.linalg.LinearOperator`, whose
+    products are computed directly from the graph by ``matmat(x, ret,
+    transpose)``, for blocks of vectors given by the columns of ``x``. The
+    dimension is the number of vertices, if ``N`` is not given."""
+
+    def __init__(self, g, matmat, N=None):
+        if N is None:
+            N = g.num_vertices()
+        scipy.sparse.linalg.LinearOperator.__init__(self, "float64", (N, N))
+        self.__g = g
+        self.__matmat = matmat
+
+    def __prod(self, x, transpose):
+        x = numpy.asarray(x, dtype="float64")
+        M = x.shape[0]
+        x = numpy.ascontiguousarray(x.reshape((M, -1)))
+        ret = numpy.zeros(x.shape, dtype="float64")
+        self.__matmat(x, ret, transpose)
+        return ret
+
+    def _matvec(self, x):
+        return self.__prod(x, False)
+
+    def _matmat(self, x):
+        return self.__prod(x, False)
+
+    def _rmatvec(self, x):
+        return self.__prod(x, True)
+
+    def _rmatmat(self, x):
+        return self.__prod(x, True)
+
+
+def _get_arrays(nnz, N, csr):
+    # output arrays of the matrices, in CSR format if the rows are given by
+    # the contiguous default index, otherwise in COO format
+    data = numpy.zeros(nnz, dtype="double")
+    j = numpy.zeros(nnz, dtype="int32")
+    if csr:
+        i = numpy.zeros(0, dtype="int32")
+        indptr = numpy.zeros(N + 1, dtype="int64")
+    else:
+        i = numpy.zeros(nnz, dtype="int32")
+        indptr = numpy.zeros(0, dtype="int64")
+    return data, i, j, indptr
+
+
+def _get_matrix(data, i, j, indptr, shape):
+    if len(indptr) > 0:
+        m = scipy.sparse.csr_matrix((data, j, indptr), shape=shape)
+        m.sum_duplicates()
+    else:
+        m = scipy.sparse.coo_matrix((data, (i, j)), shape=shape)
+        m = m.tocsr()
+    return m
+
+
+def _get_shape(g, i, j, indptr):
+    if len(indptr) > 0 or len(i) == 0:
+        V = g.num_vertices()
+    else:
+        V = max(g.num_vertices(), max(i.max() + 1, j.max() + 1))
+    return (V, V)
+
+
+def _get_index(g, index):
+    if index is None:
+        if g.get_vertex_filter()[0] is not None:
+            index = g.new_vertex_property("int64_t")
+            index.fa = numpy.arange(g.num_vertices())
+        else:
+            index = g.vertex_index
+    return index
+
+
+def adjacency(g, weight=None, index=None, operator=False):
     r"""Return the adjacency matrix of the graph.
 
     Parameters
@@ -64,11 +149,19 @@ def adjacency(g, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a matrix-free :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead, whose products with vectors (or blocks of
+        vectors) are computed directly from the graph, in parallel, without
+        storing the matrix. In this case, the indexes must lie in the range
+        :math:`[0, N-1]`, where :math:`N` is the number of vertices.
 
     Returns
     -------
     a : :class:`~scipy.sparse.csr_matrix`
         The (sparse) adjacency matrix.
+        If ``operator == True``, a :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead.
 
     Notes
     -----
@@ -135,34 +228,30 @@ def adjacency(g, weight=None, index=None):
     .. [wikipedia-adjacency] http://en.wikipedia.org/wiki/Adjacency_matrix
     """
 
-    if index is None:
-        if g.get_vertex_filter()[0] is not None:
-            index = g.new_vertex_property("int64_t")
-            index.fa = numpy.arange(g.num_vertices())
-        else:
-            index = g.vertex_index
+    csr = index is None
+    index = _get_index(g, index)
+
+    if operator:
+        vindex = _prop("v", g, index)
+        eweight = _prop("e", g, weight)
+        return _MatrixOperator(g, lambda x, ret, transpose:
+                               libgraph_tool_spectral.\
+                               adjacency_matmat(g._Graph__graph, vindex,
+                                                eweight, x, ret, transpose))
 
     E = g.num_edges() if g.is_directed() else 2 * g.num_edges()
 
-    data = numpy.zeros(E, dtype="double")
-    i = numpy.zeros(E, dtype="int32")
-    j = numpy.zeros(E, dtype="int32")
+    data, i, j, indptr = _get_arrays(E, g.num_vertices(), csr)
 
     libgraph_tool_spectral.adjacency(g._Graph__graph, _prop("v", g, index),
-                                     _prop("e", g, weight), data, i, j)
-
-    if E > 0:
-        V = max(g.num_vertices(), max(i.max() + 1, j.max() + 1))
-    else:
-        V = g.num_vertices()
+                                     _prop("e", g, weight), data, i, j, indptr)
 
-    m = scipy.sparse.coo_matrix((data, (i,j)), shape=(V, V))
-    m = m.tocsr()
-    return m
+    return _get_matrix(data, i, j, indptr, _get_shape(g, i, j, indptr))
 
 
 @_limit_args({"deg": ["total", "in", "out"]})
-def laplacian(g, deg="total", normalized=False, weight=None, index=None):
+def laplacian(g, deg="total", normalized=False, weight=None, index=None,
+              operator=False):
     r"""Return the Laplacian matrix of the graph.
 
     Parameters
@@ -178,11 +267,19 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a matrix-free :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead, whose products with vectors (or blocks of
+        vectors) are computed directly from the graph, in parallel, without
+        storing the matrix. In this case, the indexes must lie in the range
+        :math:`[0, N-1]`, where :math:`N` is the number of vertices.
 
     Returns
     -------
     l : :class:`~scipy.sparse.csr_matrix`
         The (sparse) Laplacian matrix.
+        If ``operator == True``, a :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead.
 
     Notes
     -----
@@ -284,12 +381,19 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
     .. [wikipedia-laplacian] http://en.wikipedia.org/wiki/Laplacian_matrix
     """
 
-    if index is None:
-        if g.get_vertex_filter()[0] is not None:
-            index = g.new_vertex_property("int64_t")
-            index.fa = numpy.arange(g.num_vertices())
+    csr = index is None
+    index = _get_index(g, index)
+
+    if operator:
+        vindex = _prop("v", g, index)
+        eweight = _prop("e", g, weight)
+        if normalized:
+            matmat = libgraph_tool_spectral.norm_laplacian_matmat
         else:
-            index = g.vertex_index
+            matmat = libgraph_tool_spectral.laplacian_matmat
+        return _MatrixOperator(g, lambda x, ret, transpose:
+                               matmat(g._Graph__graph, vindex, eweight, deg,
+                                      x, ret, transpose))
 
     V = g.num_vertices()
     nself = int(label_self_loops(g, mark_only=True).a.sum())
@@ -298,24 +402,18 @@ def laplacian(g, deg="total", normalized=False, weight=None, index=None):
         E *= 2
 
     N = E + g.num_vertices()
-    data = numpy.zeros(N, dtype="double")
-    i = numpy.zeros(N, dtype="int32")
-    j = numpy.zeros(N, dtype="int32")
+    data, i, j, indptr = _get_arrays(N, g.num_vertices(), csr)
 
     if normalized:
         libgraph_tool_spectral.norm_laplacian(g._Graph__graph, _prop("v", g, index),
-                                              _prop("e", g, weight), deg, data, i, j)
+                                              _prop("e", g, weight), deg, data,
+                                              i, j, indptr)
     else:
         libgraph_tool_spectral.laplacian(g._Graph__graph, _prop("v", g, index),
-                                         _prop("e", g, weight), deg, data, i, j)
-    if E > 0:
-        V = max(g.num_vertices(), max(i.max() + 1, j.max() + 1))
-    else:
-        V = g.num_vertices()
+                                         _prop("e", g, weight), deg, data, i,
+                                         j, indptr)
 
-    m = scipy.sparse.coo_matrix((data, (i, j)), shape=(V, V))
-    m = m.tocsr()
-    return m
+    return _get_matrix(data, i, j, indptr, _get_shape(g, i, j, indptr))
 
 
 def incidence(g, vindex=None, eindex=None):
@@ -382,12 +480,8 @@ def incidence(g, vindex=None, eindex=None):
     .. [wikipedia-incidence] http://en.wikipedia.org/wiki/Incidence_matrix
     """
 
-    if vindex is None:
-        if g.get_edge_filter()[0] is not None:
-            vindex = g.new_vertex_property("int64_t")
-            vindex.fa = numpy.arange(g.num_vertices())
-        else:
-            vindex = g.vertex_index
+    csr = vindex is None
+    vindex = _get_index(g, vindex)
 
     if eindex is None:
         if g.get_edge_filter()[0] is not None:
@@ -401,17 +495,17 @@ def incidence(g, vindex=None, eindex=None):
     if E == 0:
         raise ValueError("Cannot construct incidence matrix for a graph with no edges.")
 
-    data = numpy.zeros(2 * E, dtype="double")
-    i = numpy.zeros(2 * E, dtype="int32")
-    j = numpy.zeros(2 * E, dtype="int32")
+    data, i, j, indptr = _get_arrays(2 * E, g.num_vertices(), csr)
 
     libgraph_tool_spectral.incidence(g._Graph__graph, _prop("v", g, vindex),
-                                     _prop("e", g, eindex), data, i, j)
-    m = scipy.sparse.coo_matrix((data, (i,j)))
-    m = m.tocsr()
-    return m
+                                     _prop("e", g, eindex), data, i, j, indptr)
+    if csr:
+        shape = (g.num_vertices(), j.max() + 1)
+    else:
+        shape = None
+    return _get_matrix(data, i, j, indptr, shape)
 
-def transition(g, weight=None, index=None):
+def transition(g, weight=None, index=None, operator=False):
     r"""Return the transition matrix of the graph.
 
     Parameters
@@ -423,11 +517,19 @@ def transition(g, weight=None, index=None):
     index : :class:`~graph_tool.PropertyMap` (optional, default: None)
         Vertex property map specifying the row/column indexes. If not provided, the
         internal vertex index is used.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a matrix-free :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead, whose products with vectors (or blocks of
+        vectors) are computed directly from the graph, in parallel, without
+        storing the matrix. In this case, the indexes must lie in the range
+        :math:`[0, N-1]`, where :math:`N` is the number of vertices.
 
     Returns
     -------
     T : :class:`~scipy.sparse.csr_matrix`
         The (sparse) transition matrix.
+        If ``operator == True``, a :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead.
 
     Notes
     -----
@@ -488,30 +590,225 @@ def transition(g, weight=None, index=None):
     .. [wikipedia-transition] https://en.wikipedia.org/wiki/Stochastic_matrix
     """
 
-    if index is None:
-        if g.get_vertex_filter()[0] is not None:
-            index = g.new_vertex_property("int64_t")
-            index.fa = numpy.arange(g.num_vertices())
-        else:
-            index = g.vertex_index
+    csr = index is None
+    index = _get_index(g, index)
+
+    if operator:
+        vindex = _prop("v", g, index)
+        eweight = _prop("e", g, weight)
+        return _MatrixOperator(g, lambda x, ret, transpose:
+                               libgraph_tool_spectral.\
+                               transition_matmat(g._Graph__graph, vindex,
+                                                 eweight, x, ret, transpose))
 
     E = g.num_edges() if g.is_directed() else 2 * g.num_edges()
-    data = numpy.zeros(E, dtype="double")
-    i = numpy.zeros(E, dtype="int32")
-    j = numpy.zeros(E, dtype="int32")
+    data, i, j, indptr = _get_arrays(E, g.num_vertices(), csr)
 
     libgraph_tool_spectral.transition(g._Graph__graph, _prop("v", g, index),
-                                      _prop("e", g, weight), data, i, j)
+                                      _prop("e", g, weight), data, i, j,
+                                      indptr)
 
-    if E > 0:
-        V = max(g.num_vertices(), max(i.max() + 1, j.max() + 1))
+    return _get_matrix(data, i, j, indptr, _get_shape(g, i, j, indptr))
+
+
+
+def diffusion(g, x, t, weight=None, normalized=False, transpose=False,
+              index=None, steps=None):
+    r"""Return the result of applying the transition (or normalized adjacency)
+    matrix of the graph ``t`` times to a vector, or a block of vectors.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    x : :class:`~numpy.ndarray` or :class:`~graph_tool.PropertyMap`
+        Array of shape ``(N,)`` or ``(N, k)``, where :math:`N` is the number of
+        vertices, with the rows ordered as those of the matrix, or a scalar
+        vertex property map.
+    t : int
+        Number of products.
+    weight : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Edge property map with the edge weights.
+    normalized : bool (optional, default: ``False``)
+        If ``True``, the normalized adjacency matrix
+        :math:`\mathbf{D}^{-1/2}\mathbf{A}\mathbf{D}^{-1/2}` is used,
+        instead of the transition matrix :math:`\mathbf{T}` of
+        :func:`transition`.
+    transpose : bool (optional, default: ``False``)
+        If ``True``, the transposed matrix is used.
+    index : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Vertex property map specifying the row/column indexes, which must lie
+        in the range :math:`[0, N-1]`. If not provided, the internal vertex
+        index is used.
+    steps : list of ints (optional, default: ``None``)
+        If given, the results after each of these numbers of products (which
+        must lie in :math:`[1, t]`) are returned, instead of only the last one.
+
+    Returns
+    -------
+    y : :class:`~numpy.ndarray` or :class:`~graph_tool.PropertyMap`
+        The result :math:`\mathbf{M}^t\mathbf{x}`, with the same shape as
+        ``x``, or a property map of type ``double`` if ``x`` is a property
+        map. If ``steps`` is given, an array with an extra leading dimension
+        is returned, with one slice per step (or a list of property maps).
+
+    Notes
+    -----
+    With ``transpose == False``, the entries of :math:`\mathbf{T}^t\mathbf{x}`
+    are the probabilities of the positions of a random walk after :math:`t`
+    steps, given the initial probabilities in :math:`\mathbf{x}`, and with
+    ``transpose == True``, the entries of :math:`(\mathbf{T}^T)^t\mathbf{x}`
+    are the expected values of :math:`\mathbf{x}` at the end of the walks
+    started at each vertex.
+
+    The matrix is copied once in compressed form, and each product is then
+    done in parallel over the rows for all the ``k`` vectors at once,
+    alternating between two buffers, in time :math:`O(k(|V| + |E|))`, without
+    the overhead of building a :mod:`scipy.sparse` matrix, or of the
+    intermediate arrays.
+
+    Examples
+    --------
+    >>> g = gt.lattice([10, 10])
+    >>> x = np.zeros(g.num_vertices())
+    >>> x[0] = 1
+    >>> p = gt.diffusion(g, x, 10, steps=range(1, 11))
+    >>> print(p.shape)
+    (10, 100)
+    >>> print(p.sum(axis=1))
+    [1. 1. 1. 1. 1. 1. 1. 1. 1. 1.]
+    """
+
+    prop = isinstance(x, PropertyMap)
+    if prop:
+        if index is not None:
+            raise ValueError("index cannot be given if x is a property map")
+        if x.key_type() != "v":
+            raise ValueError("x must be a vertex property map")
+        x = x.fa
+    t = int(t)
+    if t < 0:
+        raise ValueError("the number of products must be non-negative")
+
+    x = numpy.asarray(x, dtype="float64")
+    shape = x.shape
+    N = g.num_vertices()
+    if shape[0] != N or len(shape) > 2:
+        raise ValueError("x must have shape (N,) or (N, k), where N is the "
+                         "number of vertices")
+    x = numpy.ascontiguousarray(x.reshape((N, -1)))
+
+    last = steps is None
+    if last:
+        steps = [t] if t > 0 else []
+    steps = numpy.asarray(sorted(set(steps)), dtype="int64")
+
+    index = _get_index(g, index)
+    ret = numpy.zeros((len(steps),) + x.shape, dtype="float64")
+    libgraph_tool_spectral.diffusion(g._Graph__graph, _prop("v", g, index),
+                                     _prop("e", g, weight), normalized,
+                                     transpose, t, steps, x, ret)
+    if last:
+        ret = ret[0] if t > 0 else x.copy()
+        ret = ret.reshape(shape)
     else:
-        V = g.num_vertices()
-    m = scipy.sparse.coo_matrix((data, (i,j)), shape=(V, V))
-    m = m.tocsr()
-    return m
+        ret = ret.reshape((len(steps),) + shape)
+
+    if prop:
+        if last:
+            return g.new_vertex_property("double", vals=ret)
+        return [g.new_vertex_property("double", vals=y) for y in ret]
+    return ret
 
+def randomized_svd(g, k, weight=None, normalized=False, index=None,
+                   oversampling=10, n_iter=2):
+    r"""Return an approximate truncated singular value decomposition of the
+    adjacency matrix of the graph, obtained by random sketching.
 
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : int
+        Number of singular values and vectors.
+    weight : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Edge property map with the edge weights.
+    normalized : bool (optional, default: ``False``)
+        If ``True``, the normalized adjacency matrix
+        :math:`\mathbf{D}_{\text{in}}^{-1/2}\mathbf{A}\mathbf{D}_{\text{out}}^{-1/2}`
+        is used instead, where the diagonal matrices contain the weighted in-
+        and out-degrees (which are the same for undirected graphs).
+    index : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Vertex property map specifying the row/column indexes, which must lie
+        in the range :math:`[0, N-1]`. If not provided, the internal vertex
+        index is used.
+    oversampling : int (optional, default: ``10``)
+        Number of random vectors used in addition to ``k``.
+    n_iter : int (optional, default: ``2``)
+        Number of power iterations.
+
+    Returns
+    -------
+    U : :class:`~numpy.ndarray`
+        Array of shape ``(N, k)``, with the left singular vectors as columns.
+    S : :class:`~numpy.ndarray`
+        The ``k`` largest singular values, in decreasing order.
+    V : :class:`~numpy.ndarray`
+        Array of shape ``(N, k)``, with the right singular vectors as columns,
+        so that :math:`\mathbf{A} \approx \mathbf{U}\operatorname{diag}(\mathbf{S})\mathbf{V}^T`.
+
+    Notes
+    -----
+    This implements the randomized range finder of [halko-finding-2011]_: the
+    matrix is multiplied by a block of :math:`l = k + p` Gaussian random
+    vectors, where :math:`p` is the oversampling, followed by ``n_iter``
+    products with :math:`\mathbf{A}\mathbf{A}^T`, with orthonormalization in
+    between. The decomposition is then computed exactly in the resulting
+    subspace. The accuracy improves with the oversampling and the number of
+    power iterations, and more quickly if the singular values decay fast.
+
+    The products are done directly from the graph, in parallel, for the whole
+    block at once, with :math:`2(n_\text{iter} + 1)` passes over the edges,
+    and in total time :math:`O(l(|V| + |E|)n_\text{iter} + l^2|V|)`, without
+    building the matrix. This uses the random number generator of
+    :mod:`graph_tool`.
+
+    Examples
+    --------
+    .. testsetup:: randomized_svd
+
+       gt.seed_rng(42)
+
+    >>> g = gt.collection.data["polblogs"]
+    >>> U, S, V = gt.randomized_svd(g, 10)
+    >>> print(U.shape, V.shape)
+    (1490, 10) (1490, 10)
+
+    References
+    ----------
+    .. [halko-finding-2011] N. Halko, P. G. Martinsson, and J. A. Tropp,
+       "Finding Structure with Randomness: Probabilistic Algorithms for
+       Constructing Approximate Matrix Decompositions", SIAM Rev. 53, 217
+       (2011), :doi:`10.1137/090771806`
+    """
+
+    N = g.num_vertices()
+    k = int(k)
+    if k < 1 or k > N:
+        raise ValueError("the number of singular values must lie in [1, N], "
+                         "where N is the number of vertices")
+    if oversampling < 0 or n_iter < 0:
+        raise ValueError("oversampling and n_iter must be non-negative")
+    l = min(k + int(oversampling), N)
+
+    index = _get_index(g, index)
+    U = numpy.zeros((N, k), dtype="float64")
+    S = numpy.zeros(k, dtype="float64")
+    V = numpy.zeros((N, k), dtype="float64")
+    libgraph_tool_spectral.randomized_svd(g._Graph__graph, _prop("v", g, index),
+                                          _prop("e", g, weight), normalized, l,
+                                          int(n_iter), U, S, V, _get_rng())
+    return U, S, V
 
 def modularity_matrix(g, weight=None, index=None):
     r"""Return the modularity matrix of the graph.
@@ -587,7 +884,7 @@ def modularity_matrix(g, weight=None, index=None):
        :doi:`10.1103/PhysRevE.69.026113`
     """
 
-    A = adjacency(g, weight=weight, index=index)
+    A = adjacency(g, weight=weight, index=index, operator=True)
     if g.is_directed():
         k_in = g.degree_property_map("in", weight=weight).fa
     else:
@@ -601,14 +898,14 @@ def modularity_matrix(g, weight=None, index=None):
         M = x.shape[0]
         if len(x.shape) > 1:
             x = x.reshape(M)
-        nx = A * x - k_out * numpy.dot(k_in, x) / E2
+        nx = A.matvec(x) - k_out * numpy.dot(k_in, x) / E2
         return nx
 
     def rmatvec(x):
         M = x.shape[0]
         if len(x.shape) > 1:
             x = x.reshape(M)
-        nx = A.T * x - k_in * numpy.dot(k_out, x) / E2
+        nx = A.rmatvec(x) - k_in * numpy.dot(k_out, x) / E2
         return nx
 
     B = scipy.sparse.linalg.LinearOperator((g.num_vertices(), g.num_vertices()),
@@ -616,3 +913,343 @@ def modularity_matrix(g, weight=None, index=None):
                                            dtype="float")
 
     return B
+
+
+def _hashimoto_index(g, index, compact):
+    if compact:
+        index = _get_index(g, index)
+        M = 2 * g.num_vertices()
+    else:
+        if index is None:
+            if g.get_edge_filter()[0] is not None:
+                index = g.new_edge_property("int64_t")
+                index.fa = numpy.arange(g.num_edges())
+            else:
+                index = g.edge_index
+        if index is g.edge_index:
+            M = g.edge_index_range
+        elif g.num_edges() > 0:
+            M = int(index.fa.max()) + 1
+        else:
+            M = 0
+        if not g.is_directed():
+            M *= 2
+    return index, M
+
+
+def hashimoto(g, index=None, compact=False, operator=False):
+    r"""Return the Hashimoto (or non-backtracking) matrix of a graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    index : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Edge property map specifying the row/column indexes, or a vertex
+        property map if ``compact == True``. If not provided, the internal edge
+        (or vertex) index is used.
+    compact : bool (optional, default: ``False``)
+        If ``True``, the compact :math:`2|V|\times 2|V|` version of the matrix
+        is returned. This is only available for undirected graphs.
+    operator : bool (optional, default: ``False``)
+        If ``True``, a matrix-free :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead, whose products with vectors are computed directly
+        from the graph, in parallel, in time :math:`O(|E|)`, without storing
+        the matrix. In this case, the indexes must lie in the range
+        :math:`[0, |E|-1]` (or :math:`[0, |V|-1]`, if ``compact == True``).
+
+    Returns
+    -------
+    H : :class:`~scipy.sparse.csr_matrix`
+        The (sparse) Hashimoto matrix.
+        If ``operator == True``, a :class:`~scipy.sparse.linalg.LinearOperator`
+        is returned instead.
+
+    See Also
+    --------
+    hashimoto_eig: leading eigenpair of the Hashimoto matrix
+
+    Notes
+    -----
+    The Hashimoto (or non-backtracking) matrix [hashimoto]_ is defined over
+    the directed edges of the graph as
+
+    .. math::
+
+        h_{k\to l,i\to j} =
+        \begin{cases}
+            1 & \text{if } l = i \text{ and } k \neq j,\\
+            0 & \text{otherwise}.
+        \end{cases}
+
+    For directed graphs, the rows and columns correspond to the edges
+    themselves, with the indexes given by ``index``. For undirected graphs,
+    each edge :math:`(i,j)` with index :math:`e` corresponds to two directed
+    edges, with indexes :math:`2e` for the direction towards the largest
+    vertex index, and :math:`2e+1` for the opposite one. Self-loops of
+    undirected graphs are not supported.
+
+    The compact version of the matrix [krzakala-spectral]_ is defined as
+
+    .. math::
+
+        \boldsymbol{B}' = \left(\begin{array}{c c}
+                           \boldsymbol{A} & -\boldsymbol{1} \\
+                           \boldsymbol{D}-\boldsymbol{1} & \boldsymbol{0}
+                           \end{array}\right)
+
+    where :math:`\boldsymbol{A}` is the adjacency matrix, and
+    :math:`\boldsymbol{D}` is the diagonal matrix with the node degrees. For
+    simple graphs, its eigenvalues are the same as those of the full matrix,
+    except for :math:`|E|-|V|` eigenvalues equal to :math:`1` and
+    :math:`-1` (this is the Ihara-Bass formula), so it can be used for the
+    spectrum instead, with vectors of size :math:`2|V|` instead of
+    :math:`2|E|`.
+
+    The full matrix is built in parallel, in time :math:`O(\sum_i k_i^2)`,
+    which is also its number of non-zero entries.
+
+    References
+    ----------
+    .. [hashimoto] Hashimoto, Ki-ichiro. "Zeta functions of finite graphs and
+       representations of p-adic groups." Automorphic forms and geometry of
+       arithmetic varieties. 1989. 211-280. :doi:`10.1016/B978-0-12-330580-0.50015-X`
+    .. [krzakala-spectral] Florent Krzakala, Cristopher Moore, Elchanan Mossel,
+       Joe Neeman, Allan Sly, Lenka Zdeborová, and Pan Zhang, "Spectral
+       redemption in clustering sparse networks", PNAS 110 (52) 20935-20940,
+       2013. :doi:`10.1073/pnas.1312486110`, :arxiv:`1306.5550`
+    """
+
+    if compact and g.is_directed():
+        raise ValueError("the compact Hashimoto matrix is only available for "
+                         "undirected graphs")
+
+    index, M = _hashimoto_index(g, index, compact)
+
+    if operator:
+        if compact:
+            pindex = _prop("v", g, index)
+            kernel = libgraph_tool_spectral.compact_nonbacktracking_matvec
+        else:
+            pindex = _prop("e", g, index)
+            kernel = libgraph_tool_spectral.nonbacktracking_matvec
+        def matmat(x, ret, transpose):
+            y = numpy.zeros(M, dtype="float64")
+            for l in range(x.shape[1]):
+                kernel(g._Graph__graph, pindex,
+                       numpy.ascontiguousarray(x[:, l]), y, transpose)
+                ret[:, l] = y
+        return _MatrixOperator(g, matmat, M)
+
+    if compact:
+        N = g.num_vertices()
+        A = adjacency(g, index=index)
+        k = numpy.zeros(N)
+        k[index.fa] = g.degree_property_map("out").fa
+        I = scipy.sparse.identity(N)
+        return scipy.sparse.bmat([[A, -I], [scipy.sparse.diags(k - 1), None]],
+                                 format="csr")
+
+    i, j = libgraph_tool_spectral.nonbacktracking(g._Graph__graph,
+                                                  _prop("e", g, index))
+    if len(i) > 0:
+        M = max(M, i.max() + 1, j.max() + 1)
+    data = numpy.ones(len(i), dtype="double")
+    m = scipy.sparse.coo_matrix((data, (i, j)), shape=(M, M))
+    m = m.tocsr()
+    return m
+
+
+def hashimoto_eig(g, index=None, compact=False, epsilon=1e-8, max_iter=None):
+    r"""Return the leading eigenvalue and eigenvector of the Hashimoto (or
+    non-backtracking) matrix of a graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    index : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Edge (or vertex, if ``compact == True``) property map specifying the
+        indexes, as in :func:`hashimoto`.
+    compact : bool (optional, default: ``False``)
+        If ``True``, the compact :math:`2|V|\times 2|V|` version of the matrix
+        is used, as in :func:`hashimoto`.
+    epsilon : float (optional, default: ``1e-8``)
+        Convergence criterion, as a bound on the residual relative to the
+        eigenvalue.
+    max_iter : int (optional, default: ``None``)
+        Maximum number of matrix-vector products. If ``None``, there is no
+        limit.
+
+    Returns
+    -------
+    eig : float
+        The leading eigenvalue.
+    vec : :class:`~numpy.ndarray`
+        The leading eigenvector, normalized, with non-negative sum, and the
+        entries ordered as the rows of :func:`hashimoto`.
+
+    Notes
+    -----
+    This uses the Arnoldi method with explicit restarts, with the
+    matrix-free products of :func:`hashimoto` done in parallel, in time
+    :math:`O(|E|)` each, without building the matrix. With ``compact == True``,
+    only vectors of size :math:`2|V|` are needed, and the eigenvalue is the
+    same for simple graphs. For other eigenpairs, the operator returned by
+    :func:`hashimoto` with ``operator == True`` can be passed to
+    :func:`scipy.sparse.linalg.eigs`.
+    """
+
+    if compact and g.is_directed():
+        raise ValueError("the compact Hashimoto matrix is only available for "
+                         "undirected graphs")
+    if g.num_edges() == 0:
+        raise ValueError("the Hashimoto matrix of a graph with no edges is empty")
+
+    index, M = _hashimoto_index(g, index, compact)
+    if compact:
+        pindex = _prop("v", g, index)
+    else:
+        pindex = _prop("e", g, index)
+    if max_iter is None:
+        max_iter = 0
+    eig, vec, n_matvec = \
+        libgraph_tool_spectral.nonbacktracking_eig(g._Graph__graph, pindex,
+                                                   compact, M, epsilon,
+                                                   max_iter)
+    return eig, vec
+
+def spectral_embedding(g, k=2, weight=None, normalized=False, vprop=None,
+                       epsilon=1e-8, max_iter=None, multilevel=False):
+    r"""Return the eigenvectors of the Laplacian of a graph with the smallest
+    eigenvalues.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : int (optional, default: ``2``)
+        Number of eigenvectors.
+    weight : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Edge property map with the edge weights.
+    normalized : bool (optional, default: ``False``)
+        If ``True``, the normalized Laplacian is used, otherwise the
+        combinatorial one, as in :func:`laplacian`.
+    vprop : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property map of type ``vector<double>`` where the eigenvectors
+        are stored. If ``None``, a new one is created.
+    epsilon : float (optional, default: ``1e-8``)
+        Convergence criterion, as a bound on the residual relative to the
+        spectral radius.
+    max_iter : int (optional, default: ``None``)
+        Maximum number of matrix-vector products. If ``None``, there is no
+        limit.
+    multilevel : bool (optional, default: ``False``)
+        If ``True``, the starting vector is obtained from coarsened versions
+        of the graph (see below).
+
+    Returns
+    -------
+    evals : :class:`~numpy.ndarray`
+        The ``k`` smallest eigenvalues, in increasing order.
+    vprop : :class:`~graph_tool.PropertyMap`
+        Vertex property map with the corresponding (normalized) eigenvectors,
+        so that ``vprop[v][i]`` is the entry of vertex ``v`` in the ``i``-th
+        eigenvector.
+
+    Notes
+    -----
+    The eigenvectors are those of :math:`\mathbf{L} = \mathbf{D} -
+    \mathbf{A}`, or of :math:`\mathbf{L} = \mathbf{I} -
+    \mathbf{D}^{-1/2}\mathbf{A}\mathbf{D}^{-1/2}` if ``normalized ==
+    True``. The graph is always considered as undirected, and self-loops do
+    not contribute to the product.
+
+    They are found with the thick-restart Lanczos method on the operator
+    :math:`s\mathbf{I} - \mathbf{L}`, where :math:`s` is a bound on the
+    largest eigenvalue of :math:`\mathbf{L}`, with the products done in
+    parallel, in time :math:`O(|V| + |E|)` each, without building the matrix.
+
+    With ``multilevel == True``, the graph is coarsened recursively by
+    heavy-edge matching, the eigenvectors of the coarsest graph are
+    interpolated back and smoothed at each level, and the result is used as
+    the starting vector. This can reduce the number of iterations for large
+    graphs, and does not change the result beyond the convergence
+    criterion. The coarsening is random, and uses the random number generator
+    of :mod:`graph_tool`.
+
+    Examples
+    --------
+    .. testsetup:: spectral_embedding
+
+       gt.seed_rng(42)
+
+    >>> g = gt.lattice([10, 10])
+    >>> ew, x = gt.spectral_embedding(g, k=3)
+    >>> print(ew)  # doctest: +SKIP
+    [0.         0.09788697 0.09788697]
+    """
+
+    if g.num_vertices() == 0:
+        raise ValueError("the Laplacian of a graph with no vertices is empty")
+    if k < 1 or k > g.num_vertices():
+        raise ValueError("the number of eigenvectors must lie in [1, N], "
+                         "where N is the number of vertices")
+    if vprop is None:
+        vprop = g.new_vertex_property("vector<double>")
+    elif vprop.value_type() != "vector<double>":
+        raise ValueError("vprop must be of type 'vector<double>'")
+    if max_iter is None:
+        max_iter = 0
+    evals, n_matvec = \
+        libgraph_tool_spectral.spectral_embedding(g._Graph__graph,
+                                                  _prop("e", g, weight),
+                                                  _prop("v", g, vprop),
+                                                  normalized, k, epsilon,
+                                                  max_iter, multilevel,
+                                                  _get_rng())
+    return evals, vprop
+
+def fiedler_vector(g, weight=None, normalized=False, epsilon=1e-8,
+                   max_iter=None, multilevel=False):
+    r"""Return the Fiedler vector of a graph, i.e. the eigenvector of its
+    Laplacian with the second smallest eigenvalue.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    weight : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Edge property map with the edge weights.
+    normalized : bool (optional, default: ``False``)
+        If ``True``, the normalized Laplacian is used.
+    epsilon : float (optional, default: ``1e-8``)
+        Convergence criterion, as in :func:`spectral_embedding`.
+    max_iter : int (optional, default: ``None``)
+        Maximum number of matrix-vector products, as in
+        :func:`spectral_embedding`.
+    multilevel : bool (optional, default: ``False``)
+        If ``True``, the multilevel starting vector of
+        :func:`spectral_embedding` is used.
+
+    Returns
+    -------
+    ev : float
+        The second smallest eigenvalue (the algebraic connectivity, if
+        ``normalized == False``).
+    x : :class:`~graph_tool.PropertyMap`
+        Vertex property map of type ``double`` with the Fiedler vector.
+
+    Notes
+    -----
+    This is :func:`spectral_embedding` with ``k == 2``. If the graph is
+    disconnected, the eigenvalue is zero, and the vector is not unique.
+    """
+
+    if g.num_vertices() < 2:
+        raise ValueError("the Fiedler vector requires at least two vertices")
+    evals, x = spectral_embedding(g, k=2, weight=weight, normalized=normalized,
+                                  epsilon=epsilon, max_iter=max_iter,
+                                  multilevel=multilevel)
+    return evals[1], \
+        g.new_vertex_property("double", vals=x.get_2d_array([1])[0])
@@ -30,14 +30,17 @@ Summary
 
    vertex_hist
    edge_hist
+   HistogramAccumulator
    vertex_average
    edge_average
+   graph_profile
    label_parallel_edges
    remove_parallel_edges
    label_self_loops
    remove_self_loops
    remove_labeled_edges
    distance_histogram
+   neighborhood_function
 
 Contents
 ++++++++
@@ -49,15 +52,17 @@ from __future__ import division, absolute_import, print_function
 from .. dl_import import dl_import
 dl_import("from . import libgraph_tool_stats")
 
-from .. import _degree, _prop, _get_rng, GraphView, PropertyMap
+from .. import _degree, _prop, _get_rng, Graph, GraphView, PropertyMap
 from numpy import *
 import numpy
+import os
 import sys
 
-__all__ = ["vertex_hist", "edge_hist", "vertex_average", "edge_average",
+__all__ = ["vertex_hist", "edge_hist", "HistogramAccumulator",
+           "vertex_average", "edge_average", "graph_profile",
            "label_parallel_edges", "remove_parallel_edges",
            "label_self_loops", "remove_self_loops", "remove_labeled_edges",
-           "distance_histogram"]
+           "distance_histogram", "neighborhood_function"]
 
 
 def vertex_hist(g, deg, bins=[0, 1], float_count=True):
@@ -117,6 +122,10 @@ def vertex_hist(g, deg, bins=[0, 1], float_count=True):
              29.,   28.,    6.,    1.,    1.,    0.,    1.]), array([ 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16], dtype=uint...)]
     """
 
+    if getattr(g, "_distributed", False):
+        from .. import distributed
+        return distributed.vertex_hist(g, deg, bins, float_count)
+
     ret = libgraph_tool_stats.\
           get_vertex_histogram(g._Graph__graph, _degree(g, deg),
                                [float(x) for x in bins])
@@ -187,6 +196,122 @@ def edge_hist(g, eprop, bins=[0, 1], float_count=True):
     return [array(ret[0], dtype="float64") if float_count else ret[0], ret[1]]
 
 
+class HistogramAccumulator(object):
+    r"""Histogram of a degree type or property accumulated over several graphs,
+    which can be given as graph files read as a stream.
+
+    Parameters
+    ----------
+    kind : ``"vertex"``, ``"edge"`` or ``"corr"``
+        Whether the histogram is over the vertices, as with
+        :func:`vertex_hist`, the edges, as with :func:`edge_hist`, or the pairs
+        of adjacent vertices, as with
+        :func:`~graph_tool.correlations.corr_hist`.
+    deg : string or pair of strings
+        Degree type ("in", "out" or "total") or name of the vertex property,
+        for ``kind == "vertex"``, name of the edge property, for
+        ``kind == "edge"``, or a pair of degree types or vertex property
+        names, for the source and target vertices, for ``kind == "corr"``.
+    bins : list of bins (optional, default: ``[0, 1]``)
+        List of bins to be used for the histogram, as with
+        :func:`vertex_hist`, or, for ``kind == "corr"``, a pair of such lists
+        (default: ``[[0, 1], [0, 1]]``).
+
+    Notes
+    -----
+    The counts are accumulated with :meth:`add`, which can be called with a
+    :class:`~graph_tool.Graph`, or with the file name or file object of a graph
+    in the ``gt`` format. In the latter case, the file is read as a stream,
+    without loading the graph into memory: only the value of each vertex is
+    kept, for degrees, vertex properties and correlation histograms, and
+    nothing at all for edge properties. The vertex and edge properties in the
+    file are read only if they are used. Correlation histograms need two
+    passes over the adjacency in the file; file objects are rewound for the
+    second one.
+
+    Examples
+    --------
+    >>> g1 = gt.collection.data["karate"]
+    >>> g2 = gt.collection.data["dolphins"]
+    >>> acc = gt.HistogramAccumulator("vertex", "out")
+    >>> acc.add(g1)
+    >>> acc.add(g2)
+    >>> h = acc.get()
+    >>> print(h[0].sum() == g1.num_vertices() + g2.num_vertices())
+    True
+    """
+
+    def __init__(self, kind, deg, bins=None):
+        if kind not in ["vertex", "edge", "corr"]:
+            raise ValueError("invalid histogram kind: " + str(kind))
+        self.kind = kind
+        self.deg = deg
+        if bins is None:
+            bins = [[0, 1], [0, 1]] if kind == "corr" else [0, 1]
+        if kind == "corr":
+            self.bins = [[float(x) for x in bins[0]],
+                         [float(x) for x in bins[1]]]
+            self._acc = libgraph_tool_stats.\
+                HistogramAccumulator2([numpy.asarray(b, dtype="float64")
+                                       for b in self.bins])
+        else:
+            self.bins = [float(x) for x in bins]
+            self._acc = libgraph_tool_stats.\
+                HistogramAccumulator1([numpy.asarray(self.bins,
+                                                     dtype="float64")])
+
+    def add(self, source):
+        """Add the counts of ``source``, which is either a
+        :class:`~graph_tool.Graph`, or the file name or file object of a graph
+        in the ``gt`` format."""
+        if isinstance(source, Graph):
+            self._add_graph(source)
+            return
+        if isinstance(source, str):
+            fname, fobj = os.path.expanduser(source), None
+        else:
+            fname, fobj = "", source
+        if self.kind == "vertex":
+            libgraph_tool_stats.stream_vertex_histogram(self._acc, fname, fobj,
+                                                        self.deg)
+        elif self.kind == "edge":
+            libgraph_tool_stats.stream_edge_histogram(self._acc, fname, fobj,
+                                                      self.deg)
+        else:
+            libgraph_tool_stats.stream_corr_histogram(self._acc, fname, fobj,
+                                                      self.deg[0], self.deg[1])
+
+    def _add_graph(self, g):
+        def vprop(d):
+            return d if d in ["in", "out", "total"] else g.vp[d]
+        if self.kind == "vertex":
+            h = vertex_hist(g, vprop(self.deg), self.bins, float_count=False)
+            bins = [h[1]]
+        elif self.kind == "edge":
+            h = edge_hist(g, g.ep[self.deg], self.bins, float_count=False)
+            bins = [h[1]]
+        else:
+            from .. correlations import corr_hist
+            h = corr_hist(g, vprop(self.deg[0]), vprop(self.deg[1]), self.bins,
+                          float_count=False)
+            bins = h[1]
+        self._acc.put_counts(numpy.asarray(h[0], dtype="uint64"),
+                             [numpy.asarray(b, dtype="float64") for b in bins])
+
+    def get(self, float_count=True):
+        """Return the accumulated histogram, as a pair with the counts and the
+        bin edges, in the same form as :func:`vertex_hist`, or
+        :func:`~graph_tool.correlations.corr_hist`, for ``kind ==
+        "corr"``."""
+        counts = self._acc.get_counts()
+        if float_count:
+            counts = array(counts, dtype="float64")
+        bins = list(self._acc.get_bins())
+        if self.kind != "corr":
+            bins = bins[0]
+        return [counts, bins]
+
+
 def vertex_average(g, deg):
     """
     Return the average of the given degree or vertex property.
@@ -234,6 +359,10 @@ def vertex_average(g, deg):
     (4.96, 0.067988234276233406)
     """
 
+    if getattr(g, "_distributed", False):
+        from .. import distributed
+        return distributed.vertex_average(g, deg)
+
     if isinstance(deg, PropertyMap) and "string" in deg.value_type():
         raise ValueError("Cannot calculate average of property type: " + deg.value_type())
     a, aa, count  = libgraph_tool_stats.\
@@ -311,6 +440,94 @@ def edge_average(g, eprop):
     return a, aa
 
 
+def graph_profile(g, deg, stats, eprop=None, deg2=None, bins=[0, 1],
+                  jackknife="pairs", float_count=True):
+    r"""
+    Compute several statistics of the graph in a single pass over the vertices
+    and edges.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    deg : string or :class:`~graph_tool.PropertyMap`
+        Degree type ("in", "out" or "total") or scalar vertex property map, on
+        which the vertex statistics are based.
+    stats : list of strings
+        Statistics to be computed, which can be any of ``"vertex_hist"``,
+        ``"vertex_average"``, ``"edge_average"``, ``"assortativity"``,
+        ``"scalar_assortativity"``, ``"combined_corr"`` and ``"self_loops"``.
+    eprop : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Scalar edge property map, required for ``"edge_average"``.
+    deg2 : string or :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Degree type or scalar vertex property map, required for
+        ``"combined_corr"``, whose average is obtained as a function of ``deg``.
+    bins : list of bins (optional, default: ``[0, 1]``)
+        Bins used for ``"vertex_hist"`` and ``"combined_corr"``, in the same
+        format as in :func:`vertex_hist`.
+    jackknife : ``"pairs"``, ``"sweep"`` or ``None`` (optional, default: ``"pairs"``)
+        How the variance of the assortativity coefficients is computed, as in
+        :func:`~graph_tool.correlations.assortativity`. With ``"sweep"``, an
+        additional pass over the edges is needed.
+    float_count : bool (optional, default: ``True``)
+        If True, the counts of ``"vertex_hist"`` will be returned as floats.
+
+    Returns
+    -------
+    profile : dict
+        Dictionary with the requested statistics as keys, and values in the
+        same form as returned by :func:`vertex_hist`, :func:`vertex_average`,
+        :func:`edge_average`, :func:`~graph_tool.correlations.assortativity`,
+        :func:`~graph_tool.correlations.scalar_assortativity` and
+        :func:`~graph_tool.correlations.avg_combined_corr`, respectively, and
+        the number of self-loops for ``"self_loops"``.
+
+    See Also
+    --------
+    vertex_hist : Vertex histograms.
+    vertex_average : Average of vertex degree, properties.
+    edge_average : Average of edge properties.
+
+    Notes
+    -----
+    This is equivalent to calling the individual functions one after another,
+    but the graph is traversed only once, with all statistics accumulated at
+    the same time. Vector-valued and non-numeric properties are not supported.
+
+    The algorithm runs in :math:`O(|V| + |E|)` time.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    """
+
+    if jackknife is None:
+        jackknife = "none"
+    if "edge_average" in stats:
+        if eprop is None:
+            raise ValueError("an edge property is required for 'edge_average'")
+    if "combined_corr" in stats and deg2 is None:
+        raise ValueError("'deg2' is required for 'combined_corr'")
+    ret = libgraph_tool_stats.\
+          get_graph_profile(g._Graph__graph, _degree(g, deg),
+                            [str(s) for s in stats], _prop("e", g, eprop),
+                            _degree(g, deg2 if deg2 is not None else deg),
+                            jackknife, [float(x) for x in bins])
+    profile = {}
+    for s in stats:
+        x = ret[s]
+        if s == "vertex_hist":
+            x = [array(x[0], dtype="float64") if float_count else x[0], x[1]]
+        elif s in ["vertex_average", "edge_average"]:
+            a, aa, count = x
+            a /= count
+            aa = sqrt((aa / count - a ** 2) / count)
+            x = (a, aa)
+        elif s == "combined_corr":
+            x = [x[0], x[1], x[2]]
+        profile[s] = x
+    return profile
+
+
 def remove_labeled_edges(g, label):
     """Remove every edge `e` such that `label[e] != 0`."""
     u = GraphView(g, directed=True, reversed=g.is_reversed(),
@@ -339,8 +556,7 @@ def label_parallel_edges(g, mark_only=False, eprop=None):
 def remove_parallel_edges(g):
     """Remove all parallel edges from the graph. Only one edge from each
     parallel edge set is left."""
-    eprop = label_parallel_edges(g)
-    remove_labeled_edges(g, eprop)
+    libgraph_tool_stats.remove_parallel_edges(g._Graph__graph)
 
 
 def label_self_loops(g, mark_only=False, eprop=None):
@@ -405,6 +621,7 @@ def distance_histogram(g, weight=None, bins=[0, 1], samples=None,
     edge_hist : Edge histograms.
     vertex_average : Average of vertex degree, properties.
     distance_histogram : Shortest-distance histogram.
+    neighborhood_function : Approximate cumulative distance distribution.
 
     Notes
     -----
@@ -442,3 +659,87 @@ def distance_histogram(g, weight=None, bins=[0, 1], samples=None,
         ret = libgraph_tool_stats.\
               distance_histogram(g._Graph__graph, _prop("e", g, weight), bins)
     return [array(ret[0], dtype="float64") if float_count else ret[0], ret[1]]
+
+
+def neighborhood_function(g, log2m=8, max_dist=None, q=0.9):
+    r"""
+    Return an approximation of the neighborhood function of the graph, together
+    with its effective diameter and average distance.
+
+    Parameters
+    ----------
+    g : :class:`Graph`
+        Graph to be used.
+    log2m : int (optional, default: 8)
+        Base-2 logarithm of the number of registers of each counter, between 4
+        and 16.
+    max_dist : int (optional, default: None)
+        If supplied, distances larger than this value are not considered.
+    q : float (optional, default: 0.9)
+        Fraction of the pairs of distinct (connected) vertices used for the
+        effective diameter.
+
+    Returns
+    -------
+    nf : :class:`numpy.ndarray`
+        Estimated number of pairs of vertices :math:`(v, u)`, including
+        :math:`v = u`, such that :math:`u` is at distance at most :math:`t`
+        from :math:`v`, for :math:`t = 0, 1, \dots`.
+    eff_diam : float
+        Effective diameter, i.e. the interpolated distance within which a
+        fraction ``q`` of the pairs of distinct connected vertices are found.
+    avg_dist : float
+        Average distance between pairs of distinct connected vertices.
+
+    See Also
+    --------
+    distance_histogram : Shortest-distance histogram.
+
+    Notes
+    -----
+    The neighborhood function is approximated with the HyperANF algorithm
+    [boldi-hyperanf-2011]_, where each vertex keeps a HyperLogLog counter of
+    the vertices within a given distance. The counters at distance :math:`t+1`
+    are obtained from those of the out-neighbors at distance :math:`t`, and
+    therefore the graph is traversed only as many times as its diameter. The
+    relative standard deviation of each count is approximately
+    :math:`1.04/\sqrt{2^\text{log2m}}`.
+
+    The algorithm runs in :math:`O(2^\text{log2m}(V + E)D)` time, where
+    :math:`D` is the diameter, and :math:`O(2^{\text{log2m}+1}V)` memory.
+
+    Edge weights cannot be used; the result for the distance histogram of
+    weighted graphs can be obtained with :func:`distance_histogram` with a
+    given number of samples instead.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    References
+    ----------
+    .. [boldi-hyperanf-2011] P. Boldi, M. Rosa and S. Vigna, "HyperANF:
+       approximating the neighbourhood function of very large graphs on a
+       budget", Proceedings of the 20th international conference on World
+       Wide Web, 625-634 (2011), :doi:`10.1145/1963405.1963493`
+    """
+
+    if max_dist is None:
+        max_dist = g.num_vertices()
+    nf = libgraph_tool_stats.neighborhood_function(g._Graph__graph,
+                                                   int(log2m), int(max_dist),
+                                                   _get_rng())
+    nf = array(nf, dtype="float64")
+
+    # pairs of distinct vertices; the counts may decrease slightly due
+    # to the estimation errors
+    c = maximum.accumulate(nf - nf[0])
+    if len(c) < 2 or c[-1] <= 0:
+        return nf, nan, nan
+    h = diff(c)
+    avg_dist = (arange(1, len(c)) * h).sum() / c[-1]
+
+    t = searchsorted(c, q * c[-1])
+    if t == 0:
+        eff_diam = 0.
+    else:
+        eff_diam = (t - 1) + (q * c[-1] - c[t - 1]) / (c[t] - c[t - 1])
+    return nf, eff_diam, avg_dist
@@ -30,31 +30,46 @@ Summary
 
    shortest_distance
    shortest_path
+   ContractionHierarchy
    all_shortest_paths
    all_predecessors
    all_paths
    all_circuits
+   count_circuits
    pseudo_diameter
+   diameter
+   eccentricity
    similarity
    vertex_similarity
+   vertex_minhash
+   graph_minhash
+   minhash_similarity
    isomorphism
+   wl_hash
    subgraph_isomorphism
    mark_subgraph
    max_cardinality_matching
+   approx_max_weight_matching
    max_independent_vertex_set
    min_spanning_tree
    random_spanning_tree
+   random_spanning_trees
    dominator_tree
+   dominator_tree_batch
    topological_sort
    transitive_closure
+   ReachabilityIndex
    tsp_tour
    sequential_vertex_coloring
+   parallel_vertex_coloring
    label_components
    label_biconnected_components
    label_largest_component
    label_out_component
    vertex_percolation
    edge_percolation
+   vertex_percolation_batch
+   edge_percolation_batch
    kcore_decomposition
    is_bipartite
    is_DAG
@@ -74,21 +89,30 @@ dl_import("from . import libgraph_tool_topology")
 
 from .. import _prop, Vector_int32_t, _check_prop_writable, \
      _check_prop_scalar, _check_prop_vector, Graph, PropertyMap, GraphView,\
-     libcore, _get_rng, _degree, perfect_prop_hash, _limit_args
+     libcore, _get_rng, _degree, perfect_prop_hash, _limit_args, \
+     _scalar_dtypes
 from .. stats import label_self_loops
 import random, sys, numpy, collections
 
-__all__ = ["isomorphism", "subgraph_isomorphism", "mark_subgraph",
-           "max_cardinality_matching", "max_independent_vertex_set",
-           "min_spanning_tree", "random_spanning_tree", "dominator_tree",
-           "topological_sort", "transitive_closure", "tsp_tour",
-           "sequential_vertex_coloring", "label_components",
+__all__ = ["isomorphism", "wl_hash", "subgraph_isomorphism", "mark_subgraph",
+           "max_cardinality_matching", "approx_max_weight_matching",
+           "max_independent_vertex_set",
+           "min_spanning_tree", "random_spanning_tree",
+           "random_spanning_trees", "dominator_tree",
+           "dominator_tree_batch",
+           "topological_sort", "transitive_closure",
+           "ReachabilityIndex", "tsp_tour",
+           "sequential_vertex_coloring",
+           "parallel_vertex_coloring", "label_components",
            "label_largest_component", "label_biconnected_components",
            "label_out_component", "vertex_percolation", "edge_percolation",
+           "vertex_percolation_batch", "edge_percolation_batch",
            "kcore_decomposition", "shortest_distance", "shortest_path",
-           "all_shortest_paths", "all_predecessors", "all_paths",
-           "all_circuits", "pseudo_diameter", "is_bipartite", "is_DAG",
+           "ContractionHierarchy", "all_shortest_paths", "all_predecessors", "all_paths",
+           "all_circuits", "count_circuits", "pseudo_diameter", "diameter",
+           "eccentricity", "is_bipartite", "is_DAG",
            "is_planar", "make_maximal_planar", "similarity", "vertex_similarity",
+           "vertex_minhash", "graph_minhash", "minhash_similarity",
            "edge_reciprocity"]
 
 def similarity(g1, g2, eweight1=None, eweight2=None, label1=None, label2=None,
@@ -233,7 +257,8 @@ def similarity(g1, g2, eweight1=None, eweight2=None, label1=None, label2=None,
 
 @_limit_args({"sim_type": ["dice", "jaccard", "inv-log-weight"]})
 def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
-                      sim_map=None):
+                      sim_map=None, top_k=None, threshold=None, sketch=None,
+                      sketch_bits=None):
     r"""Return the similarity between pairs of vertices.
 
     Parameters
@@ -253,6 +278,24 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
         If provided, and ``vertex_pairs is None``, the vertex similarities will
         be stored in this vector-valued property. Otherwise, a new one will be
         created.
+    top_k : ``int`` (optional, default: ``None``)
+        If provided, and ``vertex_pairs is None``, only the ``top_k`` most
+        similar vertices to each vertex will be returned, in sparse form (see
+        below).
+    threshold : ``float`` (optional, default: ``None``)
+        If provided, and ``vertex_pairs is None``, only the pairs with a
+        similarity larger or equal to ``threshold`` will be returned, in sparse
+        form (see below).
+    sketch : :class:`numpy.ndarray` (optional, default: ``None``)
+        If provided, it should be an array of vertex MinHash sketches, as
+        returned by :func:`~graph_tool.topology.vertex_minhash`, from which the
+        ``"dice"`` and ``"jaccard"`` similarities will be estimated, instead of
+        computed exactly. In this case, ``self_loops`` is ignored (it is
+        determined by the sketches), and ``top_k`` and ``threshold`` cannot be
+        used.
+    sketch_bits : ``int`` (optional, default: ``None``)
+        Number of bits kept in each entry of ``sketch``. If not provided, the
+        size of its data type is used.
 
     Returns
     -------
@@ -261,6 +304,11 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
         with the corresponding similarities, otherwise it will be a
         vector-valued vertex :class:`~graph_tool.PropertyMap`, with the
         similarities to all other vertices.
+    pairs, similarities : :class:`numpy.ndarray`, :class:`numpy.ndarray`
+        If ``top_k`` or ``threshold`` were supplied, an array of shape ``(M,
+        2)`` with the selected vertex pairs, sorted by the first vertex and in
+        decreasing order of similarity, and an array of length ``M`` with their
+        similarities.
 
     Notes
     -----
@@ -296,6 +344,18 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
     ``vertex_pairs is None``, otherwise with :math:`O(\left<k\right>P)` where
     :math:`P` is the length of ``vertex_pairs``.
 
+    If ``top_k`` or ``threshold`` is given, only the pairs of distinct vertices
+    that share at least one neighbor are considered (all others have zero
+    similarity), which are found by walking the two-hop neighborhood of each
+    vertex. This requires :math:`O(\sum_v k_v^2)` time and only memory
+    proportional to the size of the output, so it can be used with graphs for
+    which the full :math:`N\times N` similarity matrix would not fit in
+    memory.
+
+    If ``sketch`` is given, each similarity is estimated in time :math:`O(k)`,
+    where :math:`k` is the size of the sketches, independently of the degrees
+    (see :func:`~graph_tool.topology.vertex_minhash`).
+
     If enabled during compilation, this algorithm runs in parallel.
 
     Examples
@@ -341,6 +401,49 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
        7, pages 1019–1031 (2007), :doi:`10.1002/asi.20591`
     """
 
+    if sim_type not in ["dice", "jaccard", "inv-log-weight"]:
+        raise ValueError("invalid similarity type: " + str(sim_type))
+
+    if sketch is not None:
+        if sim_type == "inv-log-weight":
+            raise ValueError("sketches can only be used with the 'dice' " +
+                             "and 'jaccard' similarities")
+        if top_k is not None or threshold is not None:
+            raise ValueError("top_k and threshold cannot be used together " +
+                             "with sketch")
+        sketch = numpy.asarray(sketch)
+        if sketch_bits is None:
+            sketch_bits = 8 * sketch.dtype.itemsize
+        sketch = numpy.ascontiguousarray(sketch, dtype="uint64")
+        if vertex_pairs is None:
+            if sim_map is None:
+                s = g.new_vp("vector<double>")
+            else:
+                s = sim_map
+            libgraph_tool_topology.minhash_similarity(g._Graph__graph,
+                                                      sim_type, sketch,
+                                                      sketch_bits,
+                                                      _prop("v", g, s))
+        else:
+            vertex_pairs = numpy.asarray(vertex_pairs, dtype="int64")
+            s = numpy.zeros(vertex_pairs.shape[0], dtype="double")
+            libgraph_tool_topology.\
+                minhash_similarity_pairs(g._Graph__graph, sim_type, sketch,
+                                         sketch_bits, vertex_pairs, s)
+        return s
+
+    if top_k is not None or threshold is not None:
+        if vertex_pairs is not None:
+            raise ValueError("top_k and threshold cannot be used together " +
+                             "with vertex_pairs")
+        if top_k is not None and top_k <= 0:
+            raise ValueError("top_k must be positive")
+        ret = libgraph_tool_topology.\
+            similarity_sparse(g._Graph__graph, sim_type, self_loops,
+                              top_k if top_k is not None else 0,
+                              threshold if threshold is not None else -numpy.inf)
+        return ret[0], ret[1]
+
     if vertex_pairs is None:
         if sim_map is None:
             s = g.new_vp("vector<double>")
@@ -374,8 +477,212 @@ def vertex_similarity(g, sim_type="jaccard", vertex_pairs=None, self_loops=True,
                                                 s)
     return s
 
+def _get_sketch_dtype(bits):
+    if bits < 1 or bits > 64:
+        raise ValueError("the number of bits must be between 1 and 64: %d" %
+                         bits)
+    for t in ["uint8", "uint16", "uint32"]:
+        if bits <= 8 * numpy.dtype(t).itemsize:
+            return numpy.dtype(t)
+    return numpy.dtype("uint64")
+
+def vertex_minhash(g, k=128, bits=64, label=None, self_loops=True, seed=0):
+    r"""Return the MinHash sketches of the neighborhoods of every vertex.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : ``int`` (optional, default: ``128``)
+        Number of hash functions, i.e. the size of each sketch.
+    bits : ``int`` (optional, default: ``64``)
+        Number of bits kept from each hash value (b-bit MinHash), between ``1``
+        and ``64``. The sketches are stored in the smallest unsigned integer
+        type that fits them.
+    label : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Scalar vertex labels used to identify the neighbors. If not supplied,
+        the vertex indexes are used.
+    self_loops : bool (optional, default: ``True``)
+        If ``True``, vertices will be considered adjacent to themselves.
+    seed : ``int`` (optional, default: ``0``)
+        Seed of the hash functions. Only sketches computed with the same
+        ``seed``, ``k`` and ``bits`` can be compared.
+
+    Returns
+    -------
+    sketch : :class:`numpy.ndarray`
+        Array of shape ``(N, k)``, where row ``v`` is the sketch of the set of
+        (out-)neighbors of vertex ``v``. The rows of filtered-out vertices are
+        undefined.
+
+    Notes
+    -----
+    The MinHash sketch of a set :math:`X` is the vector :math:`s_i(X) =
+    \min_{x\in X}h_i(x)` of the minimum values of :math:`k` independent hash
+    functions :math:`h_i` over its elements. Since
+    :math:`P(s_i(X)=s_i(Y))` is the Jaccard similarity
+    :math:`|X\cap Y|/|X\cup Y|`, it can be estimated in time :math:`O(k)` from
+    the fraction of equal entries, with a standard deviation of at most
+    :math:`1/(2\sqrt{k})` [broder-resemblance-1997]_. If only the lowest
+    :math:`b` bits of each entry are kept [li-bbit-2010]_, the sketches take
+    less space, at the cost of spurious collisions with probability
+    :math:`2^{-b}`, which are corrected for in the estimates.
+
+    The sketches can be compared with
+    :func:`~graph_tool.topology.minhash_similarity`, or passed to
+    :func:`~graph_tool.topology.vertex_similarity`. Since the neighbors are
+    identified by their labels, sketches of different graphs (e.g. snapshots
+    of the same network) can also be compared.
+
+    The algorithm runs with complexity :math:`O(k(V + E))`.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["polbooks"]
+    >>> s = gt.vertex_minhash(g, k=1024)
+    >>> pairs = [(0, 1), (0, 2), (3, 4)]
+    >>> exact = gt.vertex_similarity(g, vertex_pairs=pairs)
+    >>> approx = gt.vertex_similarity(g, vertex_pairs=pairs, sketch=s)
+    >>> abs(exact - approx).max() < .05
+    True
+
+    References
+    ----------
+    .. [broder-resemblance-1997] Andrei Z. Broder, "On the resemblance and
+       containment of documents", Proceedings of Compression and Complexity of
+       Sequences, 21-29 (1997), :doi:`10.1109/SEQUEN.1997.666900`
+    .. [li-bbit-2010] Ping Li and Arnd Christian König, "b-Bit minwise
+       hashing", Proceedings of the 19th International Conference on World Wide
+       Web, 671-680 (2010), :doi:`10.1145/1772690.1772759`
+    """
+    dtype = _get_sketch_dtype(bits)
+    if label is None:
+        label = g.vertex_index
+    _check_prop_scalar(label, name="label")
+    sketch = numpy.zeros((g.num_vertices(ignore_filter=True), k),
+                         dtype="uint64")
+    libgraph_tool_topology.vertex_minhash(g._Graph__graph, _prop("v", g, label),
+                                          sketch, seed, bits, self_loops)
+    return sketch.astype(dtype)
+
+def graph_minhash(g, k=128, bits=64, label=None, seed=0):
+    r"""Return the MinHash sketch of the edge set of the graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    k : ``int`` (optional, default: ``128``)
+        Number of hash functions, i.e. the size of the sketch.
+    bits : ``int`` (optional, default: ``64``)
+        Number of bits kept from each hash value (b-bit MinHash), between ``1``
+        and ``64``.
+    label : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Scalar vertex labels used to identify the endpoints of the edges. If not
+        supplied, the vertex indexes are used.
+    seed : ``int`` (optional, default: ``0``)
+        Seed of the hash functions. Only sketches computed with the same
+        ``seed``, ``k`` and ``bits`` can be compared.
+
+    Returns
+    -------
+    sketch : :class:`numpy.ndarray`
+        Array of length ``k`` with the sketch of the graph.
+
+    Notes
+    -----
+    Each edge is identified by the labels of its endpoints (unordered, if the
+    graph is undirected), so that parallel edges are counted only once. The
+    sketches of two graphs can be compared with
+    :func:`~graph_tool.topology.minhash_similarity` in time :math:`O(k)`,
+    giving an estimate of the Jaccard similarity of their edge sets, or of the
+    unweighted adjacency similarity computed by
+    :func:`~graph_tool.topology.similarity` (with ``sim_type="dice"``). See
+    :func:`~graph_tool.topology.vertex_minhash` for details.
+
+    The algorithm runs with complexity :math:`O(kE + V)`.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
 
-def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
+       import numpy.random
+       numpy.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.collection.data["football"]
+    >>> u = gt.GraphView(g, efilt=np.random.random(g.num_edges()) < .9)
+    >>> s = gt.minhash_similarity(gt.graph_minhash(u, k=1024),
+    ...                           gt.graph_minhash(g, k=1024), sim_type="dice")
+    >>> abs(s - gt.similarity(u, g)) < .05
+    True
+    """
+    dtype = _get_sketch_dtype(bits)
+    if label is None:
+        label = g.vertex_index
+    _check_prop_scalar(label, name="label")
+    sketch = numpy.zeros(k, dtype="uint64")
+    libgraph_tool_topology.graph_minhash(g._Graph__graph, _prop("v", g, label),
+                                         sketch, seed, bits)
+    return sketch.astype(dtype)
+
+@_limit_args({"sim_type": ["dice", "jaccard"]})
+def minhash_similarity(s1, s2, sim_type="jaccard", bits=None):
+    r"""Return the similarity estimated from two MinHash sketches.
+
+    Parameters
+    ----------
+    s1 : :class:`numpy.ndarray`
+        First sketch, or array of sketches along the last dimension.
+    s2 : :class:`numpy.ndarray`
+        Second sketch, or array of sketches along the last dimension, with a
+        shape compatible with ``s1``.
+    sim_type : ``str`` (optional, default: ``"jaccard"``)
+        Type of similarity, either ``"jaccard"`` or ``"dice"``.
+    bits : ``int`` (optional, default: ``None``)
+        Number of bits kept in each entry of the sketches. If not provided, the
+        size of their data type is used.
+
+    Returns
+    -------
+    similarity : ``float`` or :class:`numpy.ndarray`
+        Estimated similarity, or array of similarities if arrays of sketches
+        were given (e.g. the rows of two arrays returned by
+        :func:`~graph_tool.topology.vertex_minhash`).
+
+    Notes
+    -----
+    The Jaccard similarity is estimated as the fraction :math:`f` of equal
+    entries, or :math:`(f - 2^{-b})/(1 - 2^{-b})` for :math:`b < 64` bits, and
+    the Dice similarity as :math:`2J/(1+J)`. The estimate takes time
+    :math:`O(k)`. See :func:`~graph_tool.topology.vertex_minhash` and
+    :func:`~graph_tool.topology.graph_minhash`.
+    """
+    s1 = numpy.asarray(s1)
+    s2 = numpy.asarray(s2)
+    if s1.shape[-1] != s2.shape[-1]:
+        raise ValueError("sketches of different sizes: %d, %d" %
+                         (s1.shape[-1], s2.shape[-1]))
+    if bits is None:
+        bits = 8 * max(s1.dtype.itemsize, s2.dtype.itemsize)
+    J = (s1 == s2).mean(axis=-1)
+    if bits < 64:
+        c = 2. ** -bits
+        J = numpy.maximum((J - c) / (1 - c), 0)
+    if sim_type == "dice":
+        J = 2 * J / (1 + J)
+    if numpy.ndim(J) == 0:
+        return float(J)
+    return J
+
+
+def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False,
+                refine=True):
     r"""Check whether two graphs are isomorphic.
 
     Parameters
@@ -393,6 +700,10 @@ def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
     isomap : ``bool`` (optional, default: ``False``)
         If ``True``, a vertex :class:`~graph_tool.PropertyMap` with the
         isomorphism mapping is returned as well.
+    refine : ``bool`` (optional, default: ``True``)
+        If ``True``, the graphs are first compared by their Weisfeiler-Lehman
+        hashes (see :func:`~graph_tool.topology.wl_hash`), and the refined
+        vertex colors are used as invariants in the isomorphism search.
 
     Returns
     -------
@@ -403,6 +714,15 @@ def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
          first graph which maps its vertices to their corresponding vertices of
          the second graph.
 
+    Notes
+    -----
+    If ``refine == True``, most pairs of non-isomorphic graphs are rejected in
+    time :math:`O(V + E)`, without any search, since their Weisfeiler-Lehman
+    hashes differ. Otherwise, only the vertices with the same refined colors
+    are matched against each other, which greatly reduces the search space,
+    except for highly symmetric graphs (e.g. regular graphs without vertex
+    invariants), where the refinement does not split the vertices.
+
     Examples
     --------
     .. testcode::
@@ -436,8 +756,6 @@ def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
         d = g2.degree_property_map("total")
         vertex_inv2.fa += (vertex_inv2.fa.max() + 1) * d.a
 
-    inv_max = max(vertex_inv1.fa.max(),vertex_inv2.fa.max()) + 1
-
     l1 = label_self_loops(g1, mark_only=True)
     if l1.fa.max() > 0:
         g1 = GraphView(g1, efilt=1 - l1.fa)
@@ -446,6 +764,26 @@ def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
     if l2.fa.max() > 0:
         g2 = GraphView(g2, efilt=1 - l2.fa)
 
+    if refine:
+        if (g1.num_vertices() != g2.num_vertices() or
+            g1.num_edges() != g2.num_edges() or
+            g1.is_directed() != g2.is_directed()):
+            return (False, imap) if isomap else False
+        h1, c1 = wl_hash(g1, vertex_inv1, return_colors=True)
+        h2, c2 = wl_hash(g2, vertex_inv2, return_colors=True)
+        if h1 != h2:
+            return (False, imap) if isomap else False
+
+        # the invariants must be contiguous integers
+        c = numpy.unique(numpy.concatenate((c1.fa, c2.fa)),
+                         return_inverse=True)[1]
+        vertex_inv1 = g1.new_vp("int64_t")
+        vertex_inv1.fa = c[:g1.num_vertices()]
+        vertex_inv2 = g2.new_vp("int64_t")
+        vertex_inv2.fa = c[g1.num_vertices():]
+
+    inv_max = max(vertex_inv1.fa.max(),vertex_inv2.fa.max()) + 1
+
     iso = libgraph_tool_topology.\
            check_isomorphism(g1._Graph__graph, g2._Graph__graph,
                              _prop("v", g1, vertex_inv1),
@@ -458,8 +796,96 @@ def isomorphism(g1, g2, vertex_inv1=None, vertex_inv2=None, isomap=False):
         return iso
 
 
+def wl_hash(g, vertex_label=None, max_iter=0, return_colors=False):
+    r"""Return the Weisfeiler-Lehman hash of the graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    vertex_label : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Scalar vertex labels used as initial colors. If not supplied, all
+        vertices start with the same color.
+    max_iter : ``int`` (optional, default: ``0``)
+        Maximum number of refinement iterations. If ``0``, the refinement
+        proceeds until the colors are stable.
+    return_colors : ``bool`` (optional, default: ``False``)
+        If ``True``, the refined vertex colors are returned as well.
+
+    Returns
+    -------
+    hash : ``int``
+        64-bit hash of the graph.
+    colors : :class:`~graph_tool.PropertyMap`
+        Vertex property map with the refined colors, which are hash values
+        (only returned if ``return_colors == True``).
+
+    Notes
+    -----
+    The Weisfeiler-Lehman (or color refinement) algorithm
+    [weisfeiler-lehman-1968]_ [shervashidze-weisfeiler-lehman-2011]_
+    iteratively replaces the color of each vertex by a hash of its current
+    color and of the multiset of colors of its neighbors (in- and
+    out-neighbors separately, for directed graphs), until the number of
+    distinct colors no longer increases. The hash of the graph is computed from
+    the resulting multiset of colors.
+
+    Isomorphic graphs (with the same vertex labels) always have the same hash,
+    and corresponding vertices have the same colors, so that the hash can be
+    used to index a collection of graphs, and to reject non-isomorphic pairs
+    immediately, as done by :func:`~graph_tool.topology.isomorphism`. The
+    converse does not hold: some non-isomorphic graphs, such as regular graphs
+    of the same degree and size, cannot be distinguished by the refinement.
+
+    The hash depends neither on the vertex ordering nor on the number of
+    threads, but it is only guaranteed to be stable across versions of
+    graph-tool with the same implementation.
+
+    The algorithm runs in time :math:`O(I(V\log V + E))`, where :math:`I` is the
+    number of iterations, which is at most :math:`V`, but typically very small.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["karate"]
+    >>> u = gt.Graph(g, vorder=g.new_vp("int", vals=np.random.permutation(g.num_vertices())))
+    >>> gt.wl_hash(g) == gt.wl_hash(u)
+    True
+    >>> u.add_edge(0, 1)
+    <...>
+    >>> gt.wl_hash(g) == gt.wl_hash(u)
+    False
+
+    References
+    ----------
+    .. [weisfeiler-lehman-1968] Boris Weisfeiler and Andrei A. Lehman, "A
+       reduction of a graph to a canonical form and an algebra arising during
+       this reduction", Nauchno-Technicheskaya Informatsia 2(9), 12-16 (1968).
+    .. [shervashidze-weisfeiler-lehman-2011] Nino Shervashidze, Pascal
+       Schweitzer, Erik Jan van Leeuwen, Kurt Mehlhorn, and Karsten
+       M. Borgwardt, "Weisfeiler-Lehman graph kernels", Journal of Machine
+       Learning Research 12, 2539-2561 (2011).
+    """
+    color = g.new_vp("int64_t")
+    if vertex_label is not None:
+        _check_prop_scalar(vertex_label, name="vertex_label")
+        a = vertex_label.a
+        if a.dtype.kind == "f":
+            # floating point labels are hashed by their bit pattern
+            color.a = numpy.asarray(a, dtype="float64").view("int64")
+        else:
+            color.a = a
+    h, niter = libgraph_tool_topology.wl_hash(g._Graph__graph,
+                                              _prop("v", g, color), max_iter)
+    if return_colors:
+        return h, color
+    return h
+
+
 def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
-                         induced=False, subgraph=True, generator=False):
+                         induced=False, subgraph=True, generator=False,
+                         count=False, as_array=False):
     r"""Obtain all subgraph isomorphisms of `sub` in `g` (or at most `max_n` subgraphs, if `max_n > 0`).
 
 
@@ -491,6 +917,12 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
         If ``True``, a generator will be returned, instead of a list. This is
         useful if the number of isomorphisms is too large to store in memory. If
         ``generator == True``, the option ``max_n`` is ignored.
+    count : bool (optional, default: ``False``)
+        If ``True``, only the number of matches is returned.
+    as_array : bool (optional, default: ``False``)
+        If ``True``, the matches are returned as a :class:`numpy.ndarray` of
+        shape ``(M, N)``, where ``N`` is the number of vertices of ``sub``, and
+        ``M`` the number of matches, instead of a list of property maps.
 
     Returns
     -------
@@ -498,6 +930,11 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
         List (or generator) containing vertex property map objects which
         indicate different isomorphism mappings. The property maps vertices in
         `sub` to the corresponding vertex index in `g`.
+    matches : :class:`numpy.ndarray` or ``int``
+        If ``as_array == True``, an array where each row is a match, containing
+        the vertices of ``g`` corresponding to those of ``sub``, in the order of
+        :meth:`~graph_tool.Graph.get_vertices`. If ``count == True``, the
+        number of matches.
 
     Notes
     -----
@@ -507,6 +944,15 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
     of the two graphs. Time complexity is :math:`O(V^2)` in the best case and
     :math:`O(V!\times V)` in the worst case.
 
+    If ``count == True`` or ``as_array == True`` (which require ``subgraph ==
+    True`` and ``generator == False``), a different backtracking algorithm is
+    used instead, where the vertices of ``sub`` are matched in order of
+    connectivity, and the candidates are taken from the neighbors of the
+    vertices already matched, and filtered by label and degree. The top levels
+    of the search tree are split among threads with work stealing, so that the
+    algorithm runs in parallel, if enabled during compilation. In this case, the
+    order of the matches is arbitrary.
+
     Examples
     --------
     >>> from numpy.random import poisson
@@ -578,6 +1024,23 @@ def subgraph_isomorphism(sub, g, max_n=0, vertex_label=None, edge_label=None,
     elif edge_label[0].value_type() != "int64_t":
         edge_label = perfect_prop_hash(edge_label, htype="int64_t")
 
+    if count or as_array:
+        if not subgraph:
+            raise ValueError("count and as_array require subgraph == True")
+        if generator:
+            raise ValueError("count and as_array cannot be used together " +
+                             "with generator == True")
+        ret = libgraph_tool_topology.\
+              subgraph_isomorphism_parallel(sub._Graph__graph, g._Graph__graph,
+                                            _prop("v", sub, vertex_label[0]),
+                                            _prop("v", g, vertex_label[1]),
+                                            _prop("e", sub, edge_label[0]),
+                                            _prop("e", g, edge_label[1]),
+                                            max_n, induced, count)
+        if count:
+            return ret
+        return ret.reshape((-1, sub.num_vertices()))
+
     vmaps = libgraph_tool_topology.\
             subgraph_isomorphism(sub._Graph__graph, g._Graph__graph,
                                  _prop("v", sub, vertex_label[0]),
@@ -652,6 +1115,12 @@ def min_spanning_tree(g, weights=None, root=None, tree_map=None):
     The algorithm runs with :math:`O(E\log E)` complexity, or :math:`O(E\log V)`
     if `root` is specified.
 
+    If enabled during compilation, and `root` is not specified, large graphs
+    are processed in parallel with Borůvka's algorithm, with complexity
+    :math:`O(E\log V)`. If there are edges with the same weight, the tree
+    found may differ from the sequential one (but it will have the same total
+    weight).
+
     Examples
     --------
     .. testcode::
@@ -820,6 +1289,90 @@ def random_spanning_tree(g, weights=None, root=None, tree_map=None):
     return tree_map
 
 
+def random_spanning_trees(g, n, weights=None, root=None, counts=False):
+    r"""Sample ``n`` independent random spanning trees of a given graph, in
+    parallel.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    n : ``int``
+        Number of trees to be sampled.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: `None`)
+        The edge weights. If provided, the probability of a particular spanning
+        tree being selected is the product of its edge weights.
+    root : :class:`~graph_tool.Vertex` (optional, default: `None`)
+        Root of the spanning trees, which is the same for all samples. If not
+        provided, it will be selected randomly.
+    counts : ``bool`` (optional, default: ``False``)
+        If ``True``, only the number of trees that contain each edge is
+        returned, instead of the trees themselves.
+
+    Returns
+    -------
+    trees : :class:`numpy.ndarray`
+        Array of shape ``(n, V - 1)``, where each row contains the edge indexes
+        of a spanning tree (only returned if ``counts == False``).
+    counts : :class:`~graph_tool.PropertyMap`
+        Edge property map with the number of sampled trees that contain each
+        edge (only returned if ``counts == True``).
+
+    Notes
+    -----
+    The trees are sampled with Wilson's algorithm, as in
+    :func:`~graph_tool.topology.random_spanning_tree`, with each sample
+    running in a single thread, with its own random stream and a workspace
+    that is reused between samples. The results depend only on the state of
+    the random number generator, not on the number of threads. For directed
+    graphs, the trees are arborescences oriented towards ``root``, and there
+    must be a path from every vertex to it.
+
+    With ``counts == True``, the memory requirements are only :math:`O(V +
+    E)`, independently of ``n``. For undirected graphs, the probability that
+    an edge :math:`(u,v)` belongs to a uniform random spanning tree is its
+    weight times the effective resistance :math:`R_{uv}` between its
+    endpoints, which can thus be estimated from the counts.
+
+    The running time is :math:`O(n	au)`, with :math:`	au` being the mean
+    hitting time of a random walk on the graph (see
+    :func:`~graph_tool.topology.random_spanning_tree`), divided by the number
+    of threads.
+
+    Examples
+    --------
+    >>> g = gt.collection.data["karate"]
+    >>> c = gt.random_spanning_trees(g, 10000, counts=True)
+    >>> R = c.fa / 10000         # estimated effective resistances
+    >>> abs(R.sum() - (g.num_vertices() - 1)) < 1e-8
+    True
+    """
+    if root is None:
+        root = g.vertex(numpy.random.randint(0, g.num_vertices()),
+                        use_index=False)
+
+    l = label_out_component(GraphView(g, reversed=True), root)
+    u = GraphView(g, vfilt=l)
+    if u.num_vertices() != g.num_vertices():
+        raise ValueError("There must be a path from all vertices to the root vertex: %d" % int(root) )
+
+    if weights is not None:
+        _check_prop_scalar(weights, name="weights")
+
+    if counts:
+        c = g.new_ep("int64_t")
+        libgraph_tool_topology.\
+            random_spanning_tree_counts(g._Graph__graph, int(root), n,
+                                        _prop("e", g, weights),
+                                        _prop("e", g, c), _get_rng())
+        return c
+    trees = numpy.zeros((n, max(g.num_vertices() - 1, 0)), dtype="int64")
+    libgraph_tool_topology.\
+        random_spanning_trees(g._Graph__graph, int(root), n,
+                              _prop("e", g, weights), trees, _get_rng())
+    return trees
+
+
 def dominator_tree(g, root, dom_map=None):
     """Return a vertex property map the dominator vertices for each vertex.
 
@@ -838,12 +1391,18 @@ def dominator_tree(g, root, dom_map=None):
         The dominator map. It contains for each vertex, the index of its
         dominator vertex.
 
+    See Also
+    --------
+    dominator_tree_batch: Dominator trees of many graphs at once.
+
     Notes
     -----
     A vertex u dominates a vertex v, if every path of directed graph from the
-    entry to v must go through u.
+    entry to v must go through u. The root and the vertices that are not
+    reachable from it are left unchanged in ``dom_map``.
 
-    The algorithm runs with :math:`O((V+E)\log (V+E))` complexity.
+    The Semi-NCA algorithm [georgiadis-finding-2006]_ is used, which runs with
+    :math:`O((V+E)\log (V+E))` complexity, without recursion.
 
     Examples
     --------
@@ -867,7 +1426,9 @@ def dominator_tree(g, root, dom_map=None):
 
     References
     ----------
-    .. [dominator-bgl] http://www.boost.org/libs/graph/doc/lengauer_tarjan_dominator.htm
+    .. [georgiadis-finding-2006] L. Georgiadis, R. E. Tarjan, and R. F.
+       Werneck, "Finding dominators in practice", Journal of Graph Algorithms
+       and Applications 10, 69 (2006), :doi:`10.7155/jgaa.00119`
 
     """
     if dom_map is None:
@@ -882,6 +1443,85 @@ def dominator_tree(g, root, dom_map=None):
                               _prop("v", g, dom_map))
     return dom_map
 
+def dominator_tree_batch(graphs, roots):
+    r"""Return the dominator trees of many graphs, which are computed in
+    parallel.
+
+    Parameters
+    ----------
+    graphs : list of :class:`~graph_tool.Graph` or of ``(N, edges)`` tuples
+        Directed graphs to be used. Instead of a graph, a tuple may be given
+        with the number of vertices ``N``, and an array of shape ``(E, 2)``
+        with the source and target of each edge.
+    roots : list of :class:`~graph_tool.Vertex` or ``int``
+        The root vertex of each graph.
+
+    Returns
+    -------
+    doms : list of :class:`~numpy.ndarray`
+        Arrays with the index of the immediate dominator of each vertex, for
+        each graph, or ``-1`` for the root and for the vertices that are not
+        reachable from it.
+
+    See Also
+    --------
+    dominator_tree: Dominator tree of a single graph.
+
+    Notes
+    -----
+    This is equivalent to calling :func:`~graph_tool.topology.dominator_tree`
+    for each graph, but the graphs are passed to C++ all at once, and
+    processed in parallel, which is much faster if they are many and
+    small. Filtered vertices are treated as isolated.
+
+    For each graph, the algorithm runs with :math:`O((V+E)\log (V+E))`
+    complexity.
+
+    If enabled during compilation, this algorithm runs in parallel, over the
+    graphs.
+
+    Examples
+    --------
+    >>> g1 = gt.Graph()
+    >>> g1.add_edge_list([(0, 1), (1, 2), (0, 2), (2, 3)])
+    >>> g2 = (3, [(0, 1), (1, 2), (2, 0)])
+    >>> for dom in gt.dominator_tree_batch([g1, g2], [0, 0]):
+    ...     print(dom)
+    [-1  0  0  2]
+    [-1  0  1]
+
+    """
+
+    if len(graphs) != len(roots):
+        raise ValueError("the number of roots must be equal to the number of graphs")
+    es = [numpy.zeros((0, 2), dtype="int64")]
+    eoffset = [0]
+    voffset = [0]
+    for g in graphs:
+        if isinstance(g, Graph):
+            if not g.is_directed():
+                raise ValueError("dominator tree requires a directed graph.")
+            N = g.num_vertices(True)
+            e = g.get_edges()[:, :2]
+        else:
+            N, e = g
+            e = numpy.asarray(e, dtype="int64").reshape((-1, 2))
+            if len(e) > 0 and (e.min() < 0 or e.max() >= N):
+                raise ValueError("invalid vertex in edge list")
+        es.append(e)
+        eoffset.append(eoffset[-1] + len(e))
+        voffset.append(voffset[-1] + N)
+    roots = numpy.array([int(r) for r in roots], dtype="int64")
+    N = numpy.diff(voffset)
+    if numpy.any((roots < 0) | (roots >= N)):
+        raise ValueError("invalid root vertex")
+    edges = numpy.ascontiguousarray(numpy.concatenate(es), dtype="int64")
+    dom = numpy.empty(voffset[-1], dtype="int32")
+    libgraph_tool_topology.\
+        dominator_tree_batch(edges, numpy.array(eoffset, dtype="int64"),
+                             numpy.array(voffset, dtype="int64"), roots, dom)
+    return [dom[voffset[i]:voffset[i+1]] for i in range(len(graphs))]
+
 
 def topological_sort(g):
     """
@@ -938,6 +1578,14 @@ def transitive_closure(g):
     edge) from u to v. The transitive_closure() function transforms the input
     graph g into the transitive closure graph tc.
 
+    The graph is first condensed into the acyclic graph of its strong
+    components, and the sets of components reachable from each of them are
+    computed as bit sets, in parallel and in topological order. This is done
+    for blocks of target components at a time, so that the memory needed
+    besides the result is bounded. If only some reachability queries are
+    needed, :class:`~graph_tool.topology.ReachabilityIndex` answers them
+    without building the closure.
+
     The time complexity (worst-case) is :math:`O(VE)`.
 
     Examples
@@ -967,6 +1615,99 @@ def transitive_closure(g):
     return tg
 
 
+class ReachabilityIndex(object):
+    r"""Index for fast repeated reachability queries in a directed graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Directed graph to be indexed.
+    labels : ``int`` (optional, default: ``2``)
+        Number of interval labels per component.
+
+    Notes
+    -----
+
+    The graph is condensed into the acyclic graph of its strong components,
+    which are found in parallel, and each component is given ``labels`` pairs
+    of interval labels, from randomized depth-first traversals of the
+    condensed graph, as in GRAIL [yildirim-grail]_. If a vertex ``u`` reaches
+    ``v``, the intervals of ``v`` are contained in those of ``u``, and the
+    topological level of ``u`` is smaller than that of ``v``, which answers
+    most negative queries directly. The remaining ones are answered by a
+    depth-first search in the condensed graph, pruned by the labels.
+
+    The index uses :math:`O(V + kC + E_C)` memory, where :math:`C` is the
+    number of strong components, :math:`E_C` the number of edges between
+    them, and :math:`k` the number of labels, instead of the
+    :math:`O(V^2)` of the full :func:`~graph_tool.topology.transitive_closure`.
+    The labels are computed in parallel, as are the queries for many pairs.
+
+    The index does not keep a reference to the graph, and must be built again
+    if the graph is changed. The random labels are determined by the global
+    random number generator, but the answers are always exact.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       import numpy.random
+       numpy.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.random_graph(100, lambda: (1, 1))
+    >>> idx = gt.ReachabilityIndex(g)
+    >>> r = idx.reachable(0, g.get_vertices())
+    >>> tc = gt.transitive_closure(g)
+    >>> print(numpy.array_equal(numpy.nonzero(r)[0],
+    ...                         numpy.sort(tc.get_out_neighbors(0))))
+    True
+
+    References
+    ----------
+    .. [yildirim-grail] Hilmi Yildirim, Vineet Chaoji, Mohammed J. Zaki,
+       "GRAIL: scalable reachability index for large graphs", Proceedings of
+       the VLDB Endowment 3, 276-284 (2010), :doi:`10.14778/1920841.1920879`
+    """
+
+    def __init__(self, g, labels=2):
+        if not g.is_directed():
+            raise ValueError("graph must be directed for a reachability index; " +
+                             "use label_components() for undirected graphs.")
+        self._idx = libgraph_tool_topology.ReachabilityIndex()
+        self._idx.build(g._Graph__graph, labels, _get_rng())
+
+    def __len__(self):
+        return self._idx.num_vertices()
+
+    def num_components(self):
+        """Return the number of strong components of the indexed graph."""
+        return self._idx.num_components()
+
+    def reachable(self, source, target):
+        """Return whether there is a path of at least one edge from ``source``
+        to ``target`` (so that a vertex only reaches itself if it belongs to a
+        cycle). Either of them may be an iterable of vertices, in which case a
+        Boolean array is returned, for every pair given by
+        :func:`numpy.broadcast`."""
+        scalar = True
+        vs = []
+        for v in [source, target]:
+            if isinstance(v, collections.Iterable):
+                scalar = False
+                vs.append(numpy.asarray(v, dtype="int64"))
+            else:
+                vs.append(numpy.asarray(int(v), dtype="int64"))
+        source, target = numpy.broadcast_arrays(*vs)
+        r = self._idx.reachable(numpy.ascontiguousarray(source.ravel()),
+                                numpy.ascontiguousarray(target.ravel()))
+        r = numpy.asarray(r, dtype="bool")
+        if scalar:
+            return bool(r[0])
+        return r.reshape(source.shape)
+
+
 def label_components(g, vprop=None, directed=None, attractors=False):
     """
     Label the components to which each vertex in the graph belongs. If the
@@ -1008,6 +1749,12 @@ def label_components(g, vprop=None, directed=None, attractors=False):
 
     The algorithm runs in :math:`O(V + E)` time.
 
+    If enabled during compilation, this algorithm runs in parallel for large
+    graphs, using concurrent union-find for undirected graphs, and the
+    forward-backward algorithm with trimming for strongly connected
+    components. In the latter case the components are labeled in the order of
+    their first vertex, which differs from the sequential labeling.
+
     Examples
     --------
     .. testcode::
@@ -1032,6 +1779,12 @@ def label_components(g, vprop=None, directed=None, attractors=False):
      False False False False  True False  True False False]
     """
 
+    if getattr(g, "_distributed", False):
+        from .. import distributed
+        distributed._unsupported("label_components", vprop=vprop is not None,
+                                 attractors=attractors)
+        return distributed.label_components(g, directed)
+
     if vprop is None:
         vprop = g.new_vertex_property("int32_t")
 
@@ -1424,6 +2177,133 @@ def edge_percolation(g, edges):
                        edges, max_size)
     return max_size, tree
 
+def _percolation_orders(L, orders, samples):
+    if orders is None:
+        if samples is None:
+            raise ValueError("either orders or samples must be given")
+        orders = numpy.zeros((0, 0), dtype="int64")
+        max_size = numpy.zeros((samples, L), dtype="uint64")
+        return orders, max_size, True
+    orders = numpy.asarray(orders, dtype="int64")
+    if orders.ndim != 2:
+        raise ValueError("orders must be a two-dimensional array")
+    max_size = numpy.zeros(orders.shape, dtype="uint64")
+    return orders, max_size, False
+
+def vertex_percolation_batch(g, vertices, orders=None, samples=None):
+    """Compute the size of the largest component as vertices are (virtually)
+    removed from the graph, for many orders of removal at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    vertices : :class:`numpy.ndarray` or iterable of ints
+        List of vertices.
+    orders : :class:`numpy.ndarray` (optional, default: ``None``)
+        Array of shape ``(R, L)``, where each row contains positions in
+        ``vertices``, in reversed order of removal.
+    samples : ``int`` (optional, default: ``None``)
+        If ``orders`` is not given, this number of uniformly random orders of
+        ``vertices`` will be used instead.
+
+    Returns
+    -------
+    size : :class:`numpy.ndarray`
+        Array of shape ``(R, L)``, where ``size[r, i]`` is the size of the
+        largest component prior to removal of vertex ``i`` in order ``r``.
+
+    Notes
+    -----
+    This gives the same result as calling :func:`vertex_percolation` for each
+    order, but the orders are processed in parallel, each with its own compact
+    union-find structure, and without the need to store the component labels.
+
+    The algorithm runs in :math:`O(R(V + E))` time.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.random_graph(1000, lambda: geometric(1./4) + 1, directed=False)
+    >>> sizes = gt.vertex_percolation_batch(g, g.get_vertices(), samples=100)
+    >>> sizes.shape
+    (100, 1000)
+
+    References
+    ----------
+    .. [newman-ziff] M. E. J. Newman, R. M. Ziff, "A fast Monte Carlo algorithm
+       for site or bond percolation", Phys. Rev. E 64, 016706 (2001)
+       :doi:`10.1103/PhysRevE.64.016706`, :arxiv:`cond-mat/0101295`
+
+    """
+    vertices = numpy.asarray(vertices, dtype="uint64")
+    orders, max_size, random_order = _percolation_orders(len(vertices), orders,
+                                                         samples)
+    u = GraphView(g, directed=False)
+    libgraph_tool_topology.\
+        percolate_vertex_batch(u._Graph__graph, vertices, orders,
+                               random_order, max_size, _get_rng())
+    return max_size
+
+def edge_percolation_batch(g, edges, orders=None, samples=None):
+    """Compute the size of the largest component as edges are (virtually)
+    removed from the graph, for many orders of removal at once.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    edges : :class:`numpy.ndarray` or iterable of pairs of ints
+        List of edges, with the same format as in :func:`edge_percolation`.
+    orders : :class:`numpy.ndarray` (optional, default: ``None``)
+        Array of shape ``(R, L)``, where each row contains positions in
+        ``edges``, in reversed order of removal.
+    samples : ``int`` (optional, default: ``None``)
+        If ``orders`` is not given, this number of uniformly random orders of
+        ``edges`` will be used instead.
+
+    Returns
+    -------
+    size : :class:`numpy.ndarray`
+        Array of shape ``(R, L)``, where ``size[r, i]`` is the size of the
+        largest component prior to removal of edge ``i`` in order ``r``.
+
+    Notes
+    -----
+    This gives the same result as calling :func:`edge_percolation` for each
+    order, but the orders are processed in parallel, each with its own compact
+    union-find structure, and without the need to store the component labels.
+
+    The algorithm runs in :math:`O(R(V + E))` time.
+
+    If enabled during compilation, this algorithm runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.random_graph(1000, lambda: geometric(1./4) + 1, directed=False)
+    >>> sizes = gt.edge_percolation_batch(g, g.get_edges()[:,:2], samples=100)
+    >>> sizes.shape[0]
+    100
+
+    References
+    ----------
+    .. [newman-ziff] M. E. J. Newman, R. M. Ziff, "A fast Monte Carlo algorithm
+       for site or bond percolation", Phys. Rev. E 64, 016706 (2001)
+       :doi:`10.1103/PhysRevE.64.016706`, :arxiv:`cond-mat/0101295`
+
+    """
+    edges = numpy.asarray(edges, dtype="uint64")
+    if edges.ndim != 2 or edges.shape[1] != 2:
+        raise ValueError("edges must be an array of shape (E, 2)")
+    orders, max_size, random_order = _percolation_orders(len(edges), orders,
+                                                         samples)
+    u = GraphView(g, directed=False)
+    libgraph_tool_topology.\
+        percolate_edge_batch(u._Graph__graph, edges, orders, random_order,
+                             max_size, _get_rng())
+    return max_size
+
 def kcore_decomposition(g, vprop=None):
     """Perform a k-core decomposition of the given graph.
 
@@ -1498,11 +2378,35 @@ def kcore_decomposition(g, vprop=None):
     return vprop
 
 
+def _point_dist(g, source, target, weights, dist_type, path=False):
+    reached, dist, vlist = \
+        libgraph_tool_topology.get_point_dist(g._Graph__graph, int(source),
+                                              int(target),
+                                              _prop("e", g, weights), path)
+    dtype = numpy.dtype(_scalar_dtypes[dist_type])
+    if not reached:
+        if numpy.issubdtype(dtype, numpy.integer):
+            dist = numpy.iinfo(dtype).max
+        else:
+            dist = numpy.inf
+    return dtype.type(dist), vlist
+
+def _get_delta(delta_stepping):
+    if delta_stepping is False or delta_stepping is None:
+        return -1.
+    if delta_stepping is True:
+        return 0.
+    if delta_stepping <= 0:
+        raise ValueError("delta_stepping must be a positive bucket width, " +
+                         "instead of: " + str(delta_stepping))
+    return float(delta_stepping)
+
 def shortest_distance(g, source=None, target=None, weights=None,
                       negative_weights=False, max_dist=None, directed=None,
                       dense=False, dist_map=None, pred_map=False,
-                      return_reached=False):
-    """Calculate the distance from a source to a target vertex, or to of all
+                      return_reached=False, delta_stepping=False,
+                      workspace=None):
+    r"""Calculate the distance from a source to a target vertex, or to of all
     vertices from a given source, or the all pairs shortest paths, if the source
     is not specified.
 
@@ -1565,6 +2469,22 @@ def shortest_distance(g, source=None, target=None, weights=None,
 
     return_reached : ``bool`` (optional, default: ``False``)
         If ``True``, return an array of visited vertices.
+    delta_stepping : ``bool`` or ``float`` (optional, default: ``False``)
+        If not ``False``, and both ``source`` and ``weights`` are given, the
+        parallel delta-stepping algorithm [delta-stepping]_ is used instead of
+        Dijkstra's. If a positive number is given, it is used as the bucket
+        width :math:`\Delta`, otherwise it is chosen from the weight
+        distribution. The weights must be non-negative. Ignored if
+        ``negative_weights == True``.
+    workspace : :class:`~graph_tool.search.SearchWorkspace` (optional, default: ``None``)
+        If given, the search buffers are taken from it, and the distances and
+        predecessors are left there, instead of in property maps, so that the
+        cost of the search does not depend on the size of the graph, but only
+        on the part of it that is explored. Requires ``source`` to be given,
+        and can be used neither with ``dist_map``, ``pred_map``,
+        ``return_reached``, ``negative_weights`` nor ``delta_stepping``. If
+        ``target`` is given, its distances are returned, as usual, otherwise
+        the workspace itself is returned.
 
     Returns
     -------
@@ -1587,14 +2507,30 @@ def shortest_distance(g, source=None, target=None, weights=None,
     search (BFS) or Dijkstra's algorithm [dijkstra]_, if weights are given. If
     ``negative_weights == True``, the Bellman-Ford algorithm is used
     [bellman-ford]_, which accepts negative weights, as long as there are no
-    negative loops. If source is not given, the distances are calculated with
-    Johnson's algorithm [johnson-apsp]_. If dense=True, the Floyd-Warshall
-    algorithm [floyd-warshall-apsp]_ is used instead.
+    negative loops. It runs in parallel, relaxing at each round only the
+    vertices whose distances changed in the previous one, and negative loops
+    are detected as soon as they appear in the predecessor tree, instead of
+    after :math:`V` rounds. If a single target is given (and neither ``dist_map``,
+    ``pred_map``, ``max_dist`` nor ``return_reached`` are), a bidirectional
+    search is done instead, which stops as soon as the searches from the
+    source and from the target meet. If ``delta_stepping`` is given, the weighted distances
+    are computed in parallel, by relaxing all vertices in the same distance
+    bucket of width :math:`\Delta` at once. The predecessor tree and the
+    order of the reached vertices may then differ from Dijkstra's, among
+    paths of equal length. If source is not given, the distances are calculated with
+    Johnson's algorithm [johnson-apsp]_, where the vertex potentials are
+    obtained with the parallel Bellman-Ford search above, and the Dijkstra
+    searches from all sources are run in parallel. If dense=True, the
+    Floyd-Warshall algorithm [floyd-warshall-apsp]_ is used instead.
 
     If there is no path between two vertices, the computed distance will
     correspond to the maximum value allowed by the value type of ``dist_map``,
     or ``inf`` in case of floating point types.
 
+    For many point-to-point queries on the same graph, a
+    :class:`~graph_tool.topology.ContractionHierarchy` can be built once
+    instead, which answers them much faster.
+
     If source is specified, the algorithm runs in :math:`O(V + E)` time, or
     :math:`O(V \log V)` if weights are given. If ``negative_weights == True``,
     the complexity is :math:`O(VE)`. If source is not specified, it runs in
@@ -1668,9 +2604,24 @@ def shortest_distance(g, source=None, target=None, weights=None,
     .. [johnson-apsp] http://www.boost.org/libs/graph/doc/johnson_all_pairs_shortest.html
     .. [floyd-warshall-apsp] http://www.boost.org/libs/graph/doc/floyd_warshall_shortest.html
     .. [bellman-ford] http://www.boost.org/libs/graph/doc/bellman_ford_shortest.html
+    .. [delta-stepping] U. Meyer, P. Sanders, "Delta-stepping: a
+       parallelizable shortest path algorithm", Journal of Algorithms 49,
+       114-152 (2003), :doi:`10.1016/S0196-6774(03)00076-2`
 
     """
 
+    if getattr(g, "_distributed", False):
+        from .. import distributed
+        distributed._unsupported("shortest_distance", source=source is None,
+                                 target=target is not None,
+                                 weights=weights is not None,
+                                 max_dist=max_dist is not None,
+                                 directed=directed is not None,
+                                 dist_map=dist_map is not None,
+                                 pred_map=pred_map,
+                                 return_reached=return_reached)
+        return distributed.shortest_distance(g, int(source))
+
     tgtlist = False
     if isinstance(target, collections.Iterable):
         tgtlist = True
@@ -1685,6 +2636,37 @@ def shortest_distance(g, source=None, target=None, weights=None,
     else:
         dist_type = weights.value_type()
 
+    if workspace is not None:
+        if source is None:
+            raise ValueError("a workspace requires a source vertex")
+        if (dist_map is not None or isinstance(pred_map, PropertyMap) or
+            pred_map or return_reached):
+            raise ValueError("a workspace cannot be used with dist_map, " +
+                             "pred_map or return_reached")
+        if negative_weights or delta_stepping is not False:
+            raise ValueError("a workspace cannot be used with " +
+                             "negative_weights or delta_stepping")
+        if directed is not None:
+            g = GraphView(g, directed=directed)
+        libgraph_tool_topology.get_dists_ws(g._Graph__graph, int(source),
+                                            target, _prop("e", g, weights),
+                                            float(max_dist or 0),
+                                            workspace._ws)
+        if len(target) == 0:
+            return workspace
+        dist = workspace.dist(target)
+        return dist if tgtlist else dist[0]
+
+    if (source is not None and len(target) == 1 and not tgtlist and
+        dist_map is None and not isinstance(pred_map, PropertyMap) and
+        not pred_map and not return_reached and not max_dist and
+        not negative_weights and delta_stepping is False):
+        # a single point-to-point distance: use a bidirectional search, which
+        # does not need to touch the whole graph
+        if directed is not None:
+            g = GraphView(g, directed=directed)
+        return _point_dist(g, source, target[0], weights, dist_type)[0]
+
     if dist_map is None:
         if source is not None:
             dist_map = g.new_vertex_property(dist_type)
@@ -1716,6 +2698,11 @@ def shortest_distance(g, source=None, target=None, weights=None,
                 raise ValueError("supplied pred_map must be of value type 'int64_t'")
         else:
             pmap = u.copy_property(u.vertex_index, value_type="int64_t")
+        delta = _get_delta(delta_stepping)
+        if (delta >= 0 and not negative_weights and weights is not None and
+            weights.fa.size > 0 and weights.fa.min() < 0):
+            raise ValueError("delta_stepping requires non-negative edge " +
+                             "weights")
         reached = libcore.Vector_size_t()
         libgraph_tool_topology.get_dists(u._Graph__graph,
                                          int(source),
@@ -1724,7 +2711,7 @@ def shortest_distance(g, source=None, target=None, weights=None,
                                          _prop("e", u, weights),
                                          _prop("v", u, pmap),
                                          float(max_dist),
-                                         negative_weights, reached)
+                                         negative_weights, delta, reached)
     else:
         libgraph_tool_topology.get_all_dists(u._Graph__graph,
                                              _prop("v", u, dist_map),
@@ -1786,8 +2773,16 @@ def shortest_path(g, source, target, weights=None, negative_weights=False,
     True``, the Bellman-Ford algorithm is used [bellman-ford]_, which accepts
     negative weights, as long as there are no negative loops.
 
+    Unless ``pred_map`` or ``negative_weights`` are given, the search is
+    bidirectional, i.e. it proceeds simultaneously from the source and
+    (backwards) from the target, and stops as soon as both meet. This
+    usually explores a much smaller part of the graph than a search from the
+    source alone.
+
     The algorithm runs in :math:`O(V + E)` time, or :math:`O(V \log V)` if
-    weights are given.
+    weights are given. For many queries on the same graph, a
+    :class:`~graph_tool.topology.ContractionHierarchy` can be built once
+    instead, which answers them much faster.
 
     Examples
     --------
@@ -1818,25 +2813,33 @@ def shortest_path(g, source, target, weights=None, negative_weights=False,
     .. [bellman-ford] http://www.boost.org/libs/graph/doc/bellman_ford_shortest.html
     """
 
-    if pred_map is None:
-        pred_map = shortest_distance(g, source, target, weights=weights,
-                                     negative_weights=negative_weights,
-                                     pred_map=True)[1]
-
-    if pred_map[target] == int(target):  # no path to target
-        return [], []
+    if pred_map is None and not negative_weights:
+        # bidirectional search, without a full predecessor map
+        dist_type = "int32_t" if weights is None else weights.value_type()
+        vlist = _point_dist(g, source, target, weights, dist_type,
+                            path=True)[1]
+        if len(vlist) < 2:  # no path to target
+            return [], []
+        vlist = [g.vertex(v) for v in vlist]
+    else:
+        if pred_map is None:
+            pred_map = shortest_distance(g, source, target, weights=weights,
+                                         negative_weights=negative_weights,
+                                         pred_map=True)[1]
+        if pred_map[target] == int(target):  # no path to target
+            return [], []
+        vlist = [target]
+        v = target
+        while v != source:
+            v = g.vertex(pred_map[v])
+            vlist.insert(0, v)
 
-    vlist = [target]
     elist = []
-
     if weights is not None:
         max_w = weights.a.max() + 1
     else:
         max_w = None
-
-    v = target
-    while v != source:
-        p = g.vertex(pred_map[v])
+    for p, v in zip(vlist[:-1], vlist[1:]):
         min_w = max_w
         pe = None
         s = None
@@ -1850,11 +2853,133 @@ def shortest_path(g, source, target, weights=None, negative_weights=False,
                 else:
                     pe = e
                     break
-        elist.insert(0, pe)
-        vlist.insert(0, p)
-        v = p
+        elist.append(pe)
     return vlist, elist
 
+
+class ContractionHierarchy(object):
+    r"""Index for fast repeated point-to-point shortest path queries.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph` (optional, default: ``None``)
+        Graph to be indexed. If not given, the hierarchy is empty, and should
+        be read from a file with :meth:`load`.
+    weights : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        The edge weights, which must be non-negative. If not provided, every
+        edge has unit weight.
+    directed : ``bool`` (optional, default:``None``)
+        Treat graph as directed or not, independently of its actual
+        directionality.
+
+    Notes
+    -----
+
+    The graph is preprocessed into a contraction hierarchy [geisberger-ch]_:
+    the vertices are removed one by one in order of importance, and
+    "shortcut" edges are added between their neighbours whenever they lie on
+    the only shortest path between them. Each query is then a bidirectional
+    Dijkstra search in which both sides only move towards vertices removed
+    later, which visits only a tiny fraction of the graph in road-like
+    networks, and answers a query in a few microseconds.
+
+    The preprocessing is done in parallel, by removing in each round an
+    independent set of vertices at once, and its result only depends on the
+    graph, not on the number of threads. Distance queries for many pairs are
+    answered in parallel as well.
+
+    The hierarchy does not keep a reference to the graph, and must be built
+    again if the graph or the weights are changed. It can be saved to disk
+    with :meth:`save`, and read back with :meth:`load`.
+
+    The preprocessing time and the number of shortcuts depend strongly on the
+    structure of the graph: they are small for networks with a hierarchical
+    or low-dimensional structure, such as road networks, but can grow
+    quadratically for random graphs, for which repeated Dijkstra searches are
+    preferable.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       import numpy.random
+       numpy.random.seed(42)
+       gt.seed_rng(42)
+
+    >>> g = gt.lattice([50, 50])
+    >>> w = g.new_ep("double", numpy.random.random(g.num_edges()))
+    >>> ch = gt.ContractionHierarchy(g, weights=w)
+    >>> d = ch.distance(0, [10, 100, 2499])
+    >>> d_ = gt.shortest_distance(g, 0, [10, 100, 2499], weights=w)
+    >>> print(numpy.allclose(d, d_))
+    True
+
+    References
+    ----------
+    .. [geisberger-ch] R. Geisberger, P. Sanders, D. Schultes, and
+       D. Delling, "Contraction hierarchies: faster and simpler hierarchical
+       routing in road networks", Experimental Algorithms (WEA 2008),
+       319-333, :doi:`10.1007/978-3-540-68552-4_24`
+    """
+
+    def __init__(self, g=None, weights=None, directed=None):
+        self._ch = libgraph_tool_topology.ContractionHierarchy()
+        if g is not None:
+            if directed is not None:
+                g = GraphView(g, directed=directed)
+            self._ch.build(g._Graph__graph, _prop("e", g, weights))
+
+    def __len__(self):
+        return self._ch.num_vertices()
+
+    def num_shortcuts(self):
+        """Return the number of shortcuts added to the graph."""
+        return self._ch.num_shortcuts()
+
+    def distance(self, source, target):
+        """Return the distance from ``source`` to ``target``, or
+        :data:`numpy.inf` if it is not reachable. Either of them may be an
+        iterable of vertices, in which case an array of distances is returned,
+        for every pair given by :func:`numpy.broadcast`: e.g. all the
+        distances from a single source to several targets, or the distances
+        between the corresponding elements of two arrays."""
+        scalar = True
+        vs = []
+        for v in [source, target]:
+            if isinstance(v, collections.Iterable):
+                scalar = False
+                vs.append(numpy.asarray(v, dtype="int64"))
+            else:
+                vs.append(numpy.asarray(int(v), dtype="int64"))
+        source, target = numpy.broadcast_arrays(*vs)
+        d = self._ch.distance(numpy.ascontiguousarray(source.ravel()),
+                              numpy.ascontiguousarray(target.ravel()))
+        if scalar:
+            return d[0]
+        return d.reshape(source.shape)
+
+    def path(self, source, target):
+        """Return a tuple ``(vlist, dist)``, where ``vlist`` is an array with the
+        indices of the vertices in a shortest path from ``source`` to
+        ``target``, and ``dist`` its length. If ``target`` is not reachable,
+        ``vlist`` is empty, and ``dist`` is :data:`numpy.inf`."""
+        dist, vlist = self._ch.path(int(source), int(target))
+        return vlist, dist
+
+    def save(self, file):
+        """Save the hierarchy to ``file``, which must be a path. The format is
+        binary, and not portable between machines of different byte order."""
+        self._ch.save(file)
+
+    @staticmethod
+    def load(file):
+        """Return a :class:`ContractionHierarchy` read from ``file``, which
+        must have been written with :meth:`save`."""
+        ch = ContractionHierarchy()
+        ch._ch.load(file)
+        return ch
+
 def all_predecessors(g, dist_map, pred_map, weights=None, epsilon=1e-8):
     """Return a property map with all possible predecessors in the search tree
         determined by ``dist_map`` and ``pred_map``.
@@ -2030,7 +3155,17 @@ def all_paths(g, source, target, cutoff=None):
                                                          _prop("v", g, visited))
     return path_iterator
 
-def all_circuits(g, unique=False):
+def _circuit_vertex(g, vertex):
+    # index of the vertex the circuits must contain, or -1 for none; invalid
+    # and filtered out vertices are rejected, since the C++ code would otherwise
+    # silently ignore them
+    if vertex is None:
+        return -1
+    if int(vertex) < 0:
+        raise ValueError("Invalid vertex index: %d" % int(vertex))
+    return int(g.vertex(vertex))
+
+def all_circuits(g, unique=False, vertex=None):
     """Return an iterator over all the cycles in a directed graph.
 
     Parameters
@@ -2039,17 +3174,28 @@ def all_circuits(g, unique=False):
         A directed graph to be used.
     unique : ``bool`` (optional, default: None)
         If ``True``, parallel edges and self-loops will be ignored.
+    vertex : :class:`~graph_tool.Vertex` or ``int`` (optional, default: ``None``)
+        If given, only the circuits that contain this vertex are returned. A
+        :class:`ValueError` is raised if it is not a vertex of ``g``.
 
     Returns
     -------
     cycle_iterator : iterator over a sequence of integers
         Iterator over sequences of vertices that form a circuit.
 
+    See Also
+    --------
+    count_circuits: Count the circuits, without iterating over them.
+
     Notes
     -----
     This algorithm [hawick-enumerating-2008]_ runs in worse time
     :math:`O[(V + E)(C + 1)]`, where :math:`C` is the number of circuits.
 
+    Every circuit is returned starting from its vertex with the smallest
+    index. Hence, if ``vertex`` is given, only the circuits that start from a
+    vertex with a smaller or equal index need to be searched.
+
     Examples
     --------
     .. testcode::
@@ -2075,10 +3221,78 @@ def all_circuits(g, unique=False):
 
     if not g.is_directed():
         raise ValueError("The graph must be directed.")
+    vertex = _circuit_vertex(g, vertex)
     circuits_iterator = libgraph_tool_topology.get_all_circuits(g._Graph__graph,
-                                                                unique)
+                                                                unique, vertex)
     return circuits_iterator
 
+def count_circuits(g, unique=False, vertex=None, vertex_counts=False):
+    """Count the circuits of a directed graph, according to their lengths.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        A directed graph to be used.
+    unique : ``bool`` (optional, default: None)
+        If ``True``, parallel edges and self-loops will be ignored.
+    vertex : :class:`~graph_tool.Vertex` or ``int`` (optional, default: ``None``)
+        If given, only the circuits that contain this vertex are counted. A
+        :class:`ValueError` is raised if it is not a vertex of ``g``.
+    vertex_counts : ``bool`` (optional, default: ``False``)
+        If ``True``, the number of circuits that contain each vertex is also
+        returned.
+
+    Returns
+    -------
+    hist : :class:`~numpy.ndarray`
+        Number of circuits of each length, i.e. ``hist[l]`` is the number of
+        circuits with ``l`` vertices.
+    counts : :class:`~graph_tool.VertexPropertyMap`
+        Number of circuits that contain each vertex (only returned if
+        ``vertex_counts == True``).
+
+    See Also
+    --------
+    all_circuits: Iterate over all the circuits.
+
+    Notes
+    -----
+    The circuits are found as in :func:`~graph_tool.topology.all_circuits`,
+    but they are only counted, instead of being returned one by one, which
+    avoids the overhead of creating the sequences in Python. This algorithm
+    runs in worse time :math:`O[(V + E)(C + 1)]`, where :math:`C` is the
+    number of circuits.
+
+    If enabled during compilation, this algorithm runs in parallel, over the
+    starting vertices of the circuits.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       gt.seed_rng(42)
+
+    >>> g = gt.random_graph(10, lambda: (1, 1))
+    >>> hist, counts = gt.count_circuits(g, vertex_counts=True)
+    >>> print(hist)
+    [0 0 0 0 1 0 1]
+    >>> print(counts.a)
+    [1 1 1 1 1 1 1 1 1 1]
+
+    """
+
+    if not g.is_directed():
+        raise ValueError("The graph must be directed.")
+    vertex = _circuit_vertex(g, vertex)
+    counts = g.new_vp("int64_t") if vertex_counts else None
+    hist = libgraph_tool_topology.get_all_circuits_count(g._Graph__graph,
+                                                         unique, vertex,
+                                                         _prop("v", g, counts))
+    if vertex_counts:
+        return hist, counts
+    return hist
+
 
 def pseudo_diameter(g, source=None, weights=None):
     """
@@ -2158,6 +3372,118 @@ def pseudo_diameter(g, source=None, weights=None):
     return dist, (g.vertex(source), g.vertex(target))
 
 
+def diameter(g):
+    r"""Compute the exact (unweighted) diameter of the graph.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+
+    Returns
+    -------
+    diameter : int
+        The largest distance between two vertices in the same component.
+    end_points : pair of :class:`~graph_tool.Vertex`
+        Two vertices at that distance.
+
+    Notes
+    -----
+    For undirected graphs, this uses the iFUB algorithm [crescenzi-ifub-2013]_:
+    a central vertex is found by a double sweep, and the eccentricities of the
+    vertices farthest from it are computed until the diameter found is at
+    least twice the distance to the remaining ones. Vertices whose upper bound
+    for the eccentricity, obtained from the previous searches as in
+    [takes-bounding-2011]_, is not larger than the diameter found so far are
+    skipped. The number of searches needed is typically very small for
+    empirical networks, in which case the running time is close to
+    :math:`O(V + E)`, although it is :math:`O(V(V + E))` in the worst case.
+
+    For directed graphs, the bounds do not hold, and a search is done from
+    every vertex.
+
+    Each breadth-first search runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.lattice([10, 10])
+    >>> dist, ends = gt.diameter(g)
+    >>> print(dist)
+    18
+
+    References
+    ----------
+    .. [crescenzi-ifub-2013] Pilu Crescenzi, Roberto Grossi, Michel Habib,
+       Leonardo Lanzi, Andrea Marino, "On computing the diameter of real-world
+       undirected graphs", Theoretical Computer Science 514, 84-95 (2013),
+       :doi:`10.1016/j.tcs.2012.09.018`
+    .. [takes-bounding-2011] Frank W. Takes, Walter A. Kosters, "Determining
+       the diameter of small world networks", Proc. 20th ACM International
+       Conference on Information and Knowledge Management, pp. 1191-1196
+       (2011), :doi:`10.1145/2063576.2063748`
+    """
+
+    diam, s, t, n_bfs = \
+        libgraph_tool_topology.get_exact_diam(g._Graph__graph, libcore.any())
+    return diam, (g.vertex(s), g.vertex(t))
+
+
+def eccentricity(g, ecc=None):
+    r"""Compute the exact (unweighted) eccentricity of every vertex.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    ecc : :class:`~graph_tool.PropertyMap` (optional, default: ``None``)
+        Vertex property map of type ``int64_t`` where the eccentricities will
+        be stored.
+
+    Returns
+    -------
+    ecc : :class:`~graph_tool.PropertyMap`
+        Vertex property map with the largest distance from each vertex to the
+        others in its component.
+
+    Notes
+    -----
+    For undirected graphs, this uses the bounding-diameters algorithm
+    [takes-eccentricity-2013]_, which keeps lower and upper bounds for the
+    eccentricity of every vertex, tightened by each breadth-first search, and
+    chooses the next source alternately as the vertex with the largest upper
+    and the smallest lower bound, until all bounds meet. This typically
+    requires a small fraction of the :math:`V` searches of the naive
+    algorithm.
+
+    For directed graphs, the bounds do not hold, and a search is done from
+    every vertex.
+
+    Each breadth-first search runs in parallel.
+
+    Examples
+    --------
+    >>> g = gt.lattice([10, 10])
+    >>> ecc = gt.eccentricity(g)
+    >>> print(ecc.a.min(), ecc.a.max())
+    10 18
+
+    References
+    ----------
+    .. [takes-eccentricity-2013] Frank W. Takes, Walter A. Kosters, "Computing
+       the eccentricity distribution of large graphs", Algorithms 6, 100-118
+       (2013), :doi:`10.3390/a6010100`
+    """
+
+    if ecc is None:
+        ecc = g.new_vertex_property("int64_t")
+    elif ecc.value_type() != "int64_t":
+        raise ValueError("the eccentricity property map must be of type " +
+                         "'int64_t', not '%s'" % ecc.value_type())
+    libgraph_tool_topology.get_exact_diam(g._Graph__graph,
+                                          _prop("v", g, ecc))
+    return ecc
+
+
 def is_bipartite(g, partition=False, find_odd_cycle=False):
     """Test if the graph is bipartite.
 
@@ -2440,7 +3766,7 @@ def is_DAG(g):
 
 
 def max_cardinality_matching(g, heuristic=False, weight=None, minimize=True,
-                             match=None):
+                             match=None, bipartite=False):
     r"""Find a maximum cardinality matching in the graph.
 
     Parameters
@@ -2458,6 +3784,12 @@ def max_cardinality_matching(g, heuristic=False, weight=None, minimize=True,
         be maximized. This option has no effect if ``heuristic == False``.
     match : :class:`~graph_tool.PropertyMap` (optional, default: `None`)
         Edge property map where the matching will be specified.
+    bipartite : bool or :class:`~graph_tool.PropertyMap` (optional, default: `False`)
+        If `True`, the graph is assumed to be bipartite, and a faster parallel
+        algorithm is used. A boolean vertex property map with the partition of
+        the vertices may be given instead, otherwise it is obtained with
+        :func:`is_bipartite`. This option has no effect if
+        ``heuristic == True``.
 
     Returns
     -------
@@ -2470,6 +3802,12 @@ def max_cardinality_matching(g, heuristic=False, weight=None, minimize=True,
     share a common vertex. A *maximum cardinality matching* has maximum size
     over all matchings in the graph.
 
+    If ``bipartite`` is given, the maximum matching is found with the parallel
+    Pothen-Fan algorithm [azad-multithreaded-2012]_, starting from a
+    Karp-Sipser greedy matching. Its worst-case time complexity is
+    :math:`O(VE)`, but it is usually much faster, and it scales with the number
+    of threads. The edges between vertices of the same partition are ignored.
+
     If the parameter ``weight`` is provided, as well as ``heuristic == True`` a
     matching with maximum cardinality *and* maximum (or minimum) weight is
     returned.
@@ -2519,6 +3857,10 @@ def max_cardinality_matching(g, heuristic=False, weight=None, minimize=True,
     .. [matching-heuristic] B. Hendrickson and R. Leland. "A Multilevel Algorithm
        for Partitioning Graphs." In S. Karin, editor, Proc. Supercomputing ’95,
        San Diego. ACM Press, New York, 1995, :doi:`10.1145/224170.224228`
+    .. [azad-multithreaded-2012] A. Azad, M. Halappanavar, S. Rajamanickam,
+       E. G. Boman, A. Khan and A. Pothen, "Multithreaded algorithms for
+       maximum matching in bipartite graphs", IPDPS 2012,
+       :doi:`10.1109/IPDPS.2012.82`
 
     """
     if match is None:
@@ -2529,7 +3871,16 @@ def max_cardinality_matching(g, heuristic=False, weight=None, minimize=True,
         _check_prop_scalar(weight, "weight")
 
     u = GraphView(g, directed=False)
-    if not heuristic:
+    if not heuristic and bipartite is not False:
+        if bipartite is True:
+            is_bi, bipartite = is_bipartite(u, partition=True)
+            if not is_bi:
+                raise ValueError("The graph provided is not bipartite!")
+        libgraph_tool_topology.\
+                bipartite_matching(u._Graph__graph, _prop("v", u, bipartite),
+                                   _prop("e", u, match))
+        return match, True
+    elif not heuristic:
         check = libgraph_tool_flow.\
                 max_cardinality_matching(u._Graph__graph, _prop("e", u, match))
         return match, check
@@ -2540,6 +3891,77 @@ def max_cardinality_matching(g, heuristic=False, weight=None, minimize=True,
         return match
 
 
+def approx_max_weight_matching(g, weight=None, match=None):
+    r"""Find a matching with at least half of the maximum weight.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    weight : :class:`~graph_tool.PropertyMap` (optional, default: `None`)
+        Edge property map with the edge weights. If not provided, every edge
+        has unit weight.
+    match : :class:`~graph_tool.PropertyMap` (optional, default: `None`)
+        Edge property map where the matching will be specified.
+
+    Returns
+    -------
+    match : :class:`~graph_tool.PropertyMap`
+        Boolean edge property map where the matching is specified.
+
+    Notes
+    -----
+    The matching is formed by the locally dominant edges
+    [preis-linear-1999]_ [manne-parallel-2007]_: every vertex points to its
+    heaviest unmatched neighbour, and the edges whose endpoints point to each
+    other are matched, which is repeated until no vertex has an unmatched
+    neighbour. The total weight is at least half of the maximum, and with unit
+    weights the matching is maximal, i.e. its size is at least half of the
+    maximum cardinality.
+
+    The rounds are done in parallel, and the result is the same as the one
+    given by the greedy algorithm that matches the edges in order of
+    decreasing weight (with ties broken by the edge index), independently of
+    the number of threads. The algorithm runs in time :math:`O(V + E)` for
+    most graphs.
+
+    Examples
+    --------
+    .. testcode::
+       :hide:
+
+       numpy.random.seed(43)
+       gt.seed_rng(43)
+
+    >>> g = gt.GraphView(gt.price_network(300), directed=False)
+    >>> w = g.new_ep("double", numpy.random.random(g.num_edges()))
+    >>> match = gt.approx_max_weight_matching(g, w)
+    >>> print(match.a.sum() <= g.num_vertices() / 2)
+    True
+
+    References
+    ----------
+    .. [preis-linear-1999] R. Preis, "Linear time 1/2-approximation algorithm
+       for maximum weighted matching in general graphs", STACS 1999,
+       :doi:`10.1007/3-540-49116-3_24`
+    .. [manne-parallel-2007] F. Manne and R. H. Bisseling, "A parallel
+       approximation algorithm for the weighted maximum matching problem",
+       PPAM 2007, :doi:`10.1007/978-3-540-68111-3_74`
+    """
+    if match is None:
+        match = g.new_edge_property("bool")
+    _check_prop_scalar(match, "match")
+    _check_prop_writable(match, "match")
+    if weight is not None:
+        _check_prop_scalar(weight, "weight")
+
+    u = GraphView(g, directed=False)
+    libgraph_tool_topology.\
+        locally_dominant_matching(u._Graph__graph, _prop("e", u, weight),
+                                  _prop("e", u, match))
+    return match
+
+
 def max_independent_vertex_set(g, high_deg=False, mivs=None):
     r"""Find a maximal independent vertex set in the graph.
 
@@ -2564,8 +3986,12 @@ def max_independent_vertex_set(g, high_deg=False, mivs=None):
     other vertex to the set forces the set to contain an edge between two
     vertices of the set.
 
-    This implements the algorithm described in [mivs-luby]_, which runs in time
-    :math:`O(V + E)`.
+    This computes the greedy maximal independent set in order of increasing
+    degree (or decreasing, if ``high_deg == True``), with ties broken randomly,
+    in parallel, as described in [mivs-blelloch]_, which is a deterministic
+    variant of the algorithm of [mivs-luby]_. It runs in time
+    :math:`O(V + E)`, and the result depends only on the state of the random
+    number generator, not on the number of threads.
 
     Examples
     --------
@@ -2596,6 +4022,10 @@ def max_independent_vertex_set(g, high_deg=False, mivs=None):
     .. [mivs-luby] Luby, M., "A simple parallel algorithm for the maximal independent set problem",
        Proc. 17th Symposium on Theory of Computing, Association for Computing Machinery, pp. 1-10, (1985)
        :doi:`10.1145/22145.22146`.
+    .. [mivs-blelloch] Guy E. Blelloch, Jeremy T. Fineman, Julian Shun, "Greedy
+       sequential maximal independent set and matching are parallel on
+       average", Proc. 24th ACM Symposium on Parallelism in Algorithms and
+       Architectures, pp. 308-317, (2012) :doi:`10.1145/2312005.2312058`.
 
     """
     if mivs is None:
@@ -2764,4 +4194,75 @@ def sequential_vertex_coloring(g, order=None, color=None):
     return color
 
 
+def parallel_vertex_coloring(g, order="largest-first", color=None):
+    r"""Returns a greedy vertex coloring of the graph, computed in parallel.
+
+    Parameters
+    ----------
+    g : :class:`~graph_tool.Graph`
+        Graph to be used.
+    order : ``str`` or :class:`~graph_tool.PropertyMap` (optional, default: ``"largest-first"``)
+        Order with which the vertices will be colored. It can be one of
+        ``"largest-first"`` (by decreasing degree), ``"smallest-last"`` (by the
+        reverse of the order in which the vertices are removed in the
+        :func:`~graph_tool.topology.kcore_decomposition`), ``"random"`` or
+        ``"index"``, or a scalar vertex property map, in which case the vertices
+        are colored in increasing order of its values. Ties are always broken
+        by the vertex index.
+    color : :class:`~graph_tool.PropertyMap` (optional, default: None)
+        Integer-valued vertex property map to store the colors.
+
+    Returns
+    -------
+    color : :class:`~graph_tool.PropertyMap`
+        Integer-valued vertex property map with the vertex colors.
+
+    Notes
+    -----
+    Each vertex gets the smallest color not used by its neighbors (in either
+    direction, if the graph is directed) that precede it in the given order,
+    as in :func:`~graph_tool.topology.sequential_vertex_coloring`. The
+    vertices are colored in parallel as soon as all their preceding neighbors
+    are, following [jones-parallel-1993]_, and the result is identical to the
+    sequential greedy coloring in the same order, independently of the number
+    of threads.
+
+    The ``"smallest-last"`` order is computed in parallel by peeling, where
+    the vertices removed at the same time are colored in index order, so that
+    the coloring obtained with and without OpenMP can differ in this case.
+
+    The time complexity is :math:`O(V + E)`, and the ``"random"`` order is
+    determined by the global random number generator.
+
+    Examples
+    --------
+    >>> g = gt.lattice([10, 10])
+    >>> colors = gt.parallel_vertex_coloring(g)
+    >>> print(colors.a.max() + 1)
+    2
+
+    References
+    ----------
+    .. [jones-parallel-1993] Mark T. Jones, Paul E. Plassmann, "A parallel graph
+       coloring heuristic", SIAM J. Sci. Comput. 14, 654 (1993),
+       :doi:`10.1137/0914041`
+    .. [graph-coloring] http://en.wikipedia.org/wiki/Graph_coloring
+
+    """
+
+    if color is None:
+        color = g.new_vertex_property("int")
+
+    if isinstance(order, PropertyMap):
+        aorder = _prop("v", g, order)
+        order = ""
+    else:
+        aorder = libcore.any()
+
+    libgraph_tool_topology.\
+        parallel_coloring(g._Graph__graph, order, aorder,
+                          _prop("v", g, color), _get_rng())
+    return color
+
+
 from .. flow import libgraph_tool_flow
\ No newline at end of file
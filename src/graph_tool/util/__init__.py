@@ -47,49 +47,126 @@ from .. import _degree, _prop, _converter
 __all__ = ["find_vertex", "find_vertex_range", "find_edge", "find_edge_range"]
 
 
-def find_vertex(g, prop, match):
+def _find_ret(g, ret, out, edges):
+    if out == "list":
+        return ret
+    ret = ret.astype("int64")
+    if edges:
+        ret = ret.reshape((-1, 3))
+    if out == "array":
+        return ret
+    if edges:
+        filt = g.new_edge_property("bool")
+        filt.a[ret[:, 2]] = True
+    else:
+        filt = g.new_vertex_property("bool")
+        filt.a[ret] = True
+    return filt
+
+
+def _check_out(out):
+    if out not in ["list", "array", "filter"]:
+        raise ValueError("invalid value for 'out': " + str(out))
+    return out != "list"
+
+
+def find_vertex(g, prop, match, out="list"):
     """Find all vertices `v` for which `prop[v] = match`. The parameter prop
     can be either a :class:`~graph_tool.PropertyMap` or string with value "in",
-    "out" or "total", representing a degree type."""
+    "out" or "total", representing a degree type.
+
+    The parameter ``out`` determines the type of the result: if ``out ==
+    "list"``, a list of vertex descriptors is returned; if ``out ==
+    "array"``, a :class:`numpy.ndarray` is returned, containing the vertex
+    indices; if ``out == "filter"``, a boolean vertex
+    :class:`~graph_tool.PropertyMap` is returned, marking the matches, which
+    can be used directly with :class:`~graph_tool.GraphView`. The last
+    two options avoid the creation of a Python object per match, and should be
+    preferred when the number of matches is large.
+
+    The search is performed in parallel, and the matches are always returned
+    in the same order as the vertices are iterated.
+    """
     if prop in ["in", "out", "total"]:
         val = int(match)
     else:
         val = _converter(prop.value_type())(match)
     ret = libgraph_tool_util.\
           find_vertex_range(g._Graph__graph, _degree(g, prop),
-                            (val, val))
-    return ret
+                            (val, val), _check_out(out))
+    return _find_ret(g, ret, out, False)
 
 
-def find_vertex_range(g, prop, range):
+def find_vertex_range(g, prop, range, out="list"):
     """Find all vertices `v` for which `range[0] <= prop[v] <= range[1]`. The
     parameter prop can be either a :class:`~graph_tool.PropertyMap` or string
-    with value"in", "out" or "total", representing a degree type."""
+    with value"in", "out" or "total", representing a degree type.
+
+    The parameter ``out`` determines the type of the result: if ``out ==
+    "list"``, a list of vertex descriptors is returned; if ``out ==
+    "array"``, a :class:`numpy.ndarray` is returned, containing the vertex
+    indices; if ``out == "filter"``, a boolean vertex
+    :class:`~graph_tool.PropertyMap` is returned, marking the matches, which
+    can be used directly with :class:`~graph_tool.GraphView`. The last
+    two options avoid the creation of a Python object per match, and should be
+    preferred when the number of matches is large.
+
+    The search is performed in parallel, and the matches are always returned
+    in the same order as the vertices are iterated.
+    """
     if prop in ["in", "out", "total"]:
         convert = lambda x: int(x)
     else:
         convert = _converter(prop.value_type())
     ret = libgraph_tool_util.\
           find_vertex_range(g._Graph__graph, _degree(g, prop),
-                            (convert(range[0]), convert(range[1])))
-    return ret
+                            (convert(range[0]), convert(range[1])),
+                            _check_out(out))
+    return _find_ret(g, ret, out, False)
 
 
-def find_edge(g, prop, match):
+def find_edge(g, prop, match, out="list"):
     """Find all edges `e` for which `prop[e] = match`. The parameter prop
-    must be a :class:`~graph_tool.PropertyMap`."""
+    must be a :class:`~graph_tool.PropertyMap`.
+
+    The parameter ``out`` determines the type of the result: if ``out ==
+    "list"``, a list of edge descriptors is returned; if ``out == "array"``,
+    a :class:`numpy.ndarray` is returned, containing the rows ``[source,
+    target, index]`` for each edge; if ``out == "filter"``, a boolean edge
+    :class:`~graph_tool.PropertyMap` is returned, marking the matches, which
+    can be used directly with :class:`~graph_tool.GraphView`. The last
+    two options avoid the creation of a Python object per match, and should be
+    preferred when the number of matches is large.
+
+    The search is performed in parallel, and the matches are always returned
+    in the same order as the edges are iterated.
+    """
     val = _converter(prop.value_type())(match)
     ret = libgraph_tool_util.\
           find_edge_range(g._Graph__graph, _prop("e", g, prop),
-                          (val, val))
-    return ret
+                          (val, val), _check_out(out))
+    return _find_ret(g, ret, out, True)
 
 
-def find_edge_range(g, prop, range):
+def find_edge_range(g, prop, range, out="list"):
     """Find all edges `e` for which `range[0] <= prop[e] <= range[1]`. The
-    parameter prop can be either a :class:`~graph_tool.PropertyMap`."""
+    parameter prop can be either a :class:`~graph_tool.PropertyMap`.
+
+    The parameter ``out`` determines the type of the result: if ``out ==
+    "list"``, a list of edge descriptors is returned; if ``out == "array"``,
+    a :class:`numpy.ndarray` is returned, containing the rows ``[source,
+    target, index]`` for each edge; if ``out == "filter"``, a boolean edge
+    :class:`~graph_tool.PropertyMap` is returned, marking the matches, which
+    can be used directly with :class:`~graph_tool.GraphView`. The last
+    two options avoid the creation of a Python object per match, and should be
+    preferred when the number of matches is large.
+
+    The search is performed in parallel, and the matches are always returned
+    in the same order as the edges are iterated.
+    """
     convert = _converter(prop.value_type())
     ret = libgraph_tool_util.\
           find_edge_range(g._Graph__graph, _prop("e", g, prop),
-                          (convert(range[0]), convert(range[1])))
-    return ret
+                          (convert(range[0]), convert(range[1])),
+                          _check_out(out))
+    return _find_ret(g, ret, out, True)